@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/Span.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// A bump allocator for lots of small objects that all die together, like the nodes of a syntax tree.
+// Allocating is just bumping a pointer, and everything is destroyed and freed at once along with the arena.
+// NOTE: Objects can't be freed individually, so nothing that's allocated here may be ref-counted or owned.
+class Arena {
+    AK_MAKE_NONCOPYABLE(Arena);
+    AK_MAKE_NONMOVABLE(Arena);
+
+public:
+    static constexpr size_t default_chunk_size = 16 * KiB;
+
+    explicit Arena(size_t chunk_size = default_chunk_size)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    ~Arena() { clear(); }
+
+    [[nodiscard]] void* allocate(size_t size, size_t alignment = alignof(void*))
+    {
+        VERIFY(alignment && !(alignment & (alignment - 1)));
+        auto padding = current_padding_for(alignment);
+        if (!m_current_chunk || m_offset + padding + size > m_current_chunk->size) {
+            add_chunk(size + alignment - 1);
+            padding = current_padding_for(alignment);
+        }
+        auto* data = m_current_chunk->data() + m_offset + padding;
+        m_offset += padding + size;
+        m_bytes_allocated += size;
+        return data;
+    }
+
+    template<typename T, typename... Args>
+    [[nodiscard]] T& make(Args&&... args)
+    {
+        if constexpr (IsTriviallyDestructible<T>) {
+            return *new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+        } else {
+            auto* object = new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+            auto& destructor = *new (allocate(sizeof(Destructor), alignof(Destructor))) Destructor;
+            destructor.object = object;
+            destructor.destroy = [](void* object) { static_cast<T*>(object)->~T(); };
+            destructor.next = m_destructors;
+            m_destructors = &destructor;
+            return *object;
+        }
+    }
+
+    // NOTE: The elements are left uninitialized, so this is only for trivial types.
+    template<typename T>
+    [[nodiscard]] Span<T> allocate_array(size_t count)
+    {
+        static_assert(IsTrivial<T>);
+        if (!count)
+            return {};
+        return { static_cast<T*>(allocate(sizeof(T) * count, alignof(T))), count };
+    }
+
+    // Destroys everything, but keeps the first chunk around for whatever's allocated next.
+    void clear()
+    {
+        // Later objects may refer to earlier ones, so they're destroyed in reverse order.
+        for (auto* destructor = m_destructors; destructor; destructor = destructor->next)
+            destructor->destroy(destructor->object);
+        m_destructors = nullptr;
+
+        Chunk* chunk_to_keep = nullptr;
+        while (m_current_chunk) {
+            auto* previous = m_current_chunk->previous;
+            if (previous || m_current_chunk->size != m_chunk_size)
+                kfree(m_current_chunk);
+            else
+                chunk_to_keep = m_current_chunk;
+            m_current_chunk = previous;
+        }
+        m_current_chunk = chunk_to_keep;
+        m_offset = 0;
+        m_bytes_allocated = 0;
+    }
+
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+
+private:
+    struct Chunk {
+        Chunk* previous { nullptr };
+        size_t size { 0 };
+
+        u8* data() { return reinterpret_cast<u8*>(this + 1); }
+    };
+
+    struct Destructor {
+        Destructor* next { nullptr };
+        void* object { nullptr };
+        void (*destroy)(void*) { nullptr };
+    };
+
+    size_t current_padding_for(size_t alignment) const
+    {
+        if (!m_current_chunk)
+            return 0;
+        auto address = reinterpret_cast<FlatPtr>(m_current_chunk->data()) + m_offset;
+        return ((address + alignment - 1) & ~(alignment - 1)) - address;
+    }
+
+    void add_chunk(size_t minimum_size)
+    {
+        // Anything that doesn't fit a regular chunk gets one of its own.
+        auto size = max(m_chunk_size, minimum_size);
+        auto* chunk = static_cast<Chunk*>(kmalloc(sizeof(Chunk) + size));
+        VERIFY(chunk);
+        chunk->previous = m_current_chunk;
+        chunk->size = size;
+        m_current_chunk = chunk;
+        m_offset = 0;
+    }
+
+    size_t m_chunk_size { 0 };
+    Chunk* m_current_chunk { nullptr };
+    size_t m_offset { 0 };
+    size_t m_bytes_allocated { 0 };
+    Destructor* m_destructors { nullptr };
+};
+
+}
+
+using AK::Arena;
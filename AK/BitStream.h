@@ -19,19 +19,19 @@ public:
     {
     }
 
+    // NOTE: Reading bytes always starts at the next byte boundary.
     size_t read(Bytes bytes) override
     {
         if (has_any_error())
             return 0;
 
-        size_t nread = 0;
-        if (bytes.size() >= 1) {
-            if (m_next_byte.has_value()) {
-                bytes[0] = m_next_byte.value();
-                m_next_byte.clear();
+        align_to_byte_boundary();
 
-                ++nread;
-            }
+        size_t nread = 0;
+        while (nread < bytes.size() && m_bit_count > 0) {
+            bytes[nread++] = m_bit_buffer & 0xff;
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
         }
 
         return nread + m_stream.read(bytes.slice(nread));
@@ -47,44 +47,49 @@ public:
         return true;
     }
 
-    bool unreliable_eof() const override { return !m_next_byte.has_value() && m_stream.unreliable_eof(); }
+    bool unreliable_eof() const override { return m_bit_count == 0 && m_stream.unreliable_eof(); }
 
     bool discard_or_error(size_t count) override
     {
-        if (count >= 1) {
-            if (m_next_byte.has_value()) {
-                m_next_byte.clear();
-                --count;
-            }
+        align_to_byte_boundary();
+
+        while (count > 0 && m_bit_count > 0) {
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
+            --count;
         }
 
         return m_stream.discard_or_error(count);
     }
 
-    u32 read_bits(size_t count)
+    // Returns the next count bits without consuming them. Bits past the end of the stream read as zeros,
+    // which is only an error once something actually tries to consume them.
+    // NOTE: This reads whole bytes ahead of the bits that end up being consumed, which read() hands out later on.
+    u32 peek_bits(size_t count)
     {
-        u32 result = 0;
-
-        size_t nread = 0;
-        while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
-                return 0;
-            }
-
-            if (m_next_byte.has_value()) {
-                const auto bit = (m_next_byte.value() >> m_bit_offset) & 1;
-                result |= bit << nread;
-                ++nread;
+        VERIFY(count <= 32);
+        refill(count);
+        return m_bit_buffer & ((1ull << count) - 1);
+    }
 
-                if (m_bit_offset++ == 7)
-                    m_next_byte.clear();
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
-            }
+    bool discard_bits(size_t count)
+    {
+        refill(count);
+        if (count > m_bit_count) {
+            set_fatal_error();
+            return false;
         }
 
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+        return true;
+    }
+
+    u32 read_bits(size_t count)
+    {
+        auto result = peek_bits(count);
+        if (!discard_bits(count))
+            return 0;
         return result;
     }
 
@@ -92,8 +97,9 @@ public:
 
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value())
-            m_next_byte.clear();
+        auto bits_past_byte_boundary = m_bit_count % 8;
+        m_bit_buffer >>= bits_past_byte_boundary;
+        m_bit_count -= bits_past_byte_boundary;
     }
 
     bool handle_any_error() override
@@ -103,8 +109,21 @@ public:
     }
 
 private:
-    Optional<u8> m_next_byte;
-    size_t m_bit_offset { 0 };
+    // Only reads as many bytes as it takes to have count bits (if the stream has them), so that we don't read further
+    // ahead of the consumed bits than we need to.
+    void refill(size_t count)
+    {
+        while (m_bit_count < count) {
+            u8 byte;
+            if (m_stream.read({ &byte, sizeof(byte) }) == 0)
+                return;
+            m_bit_buffer |= static_cast<u64>(byte) << m_bit_count;
+            m_bit_count += 8;
+        }
+    }
+
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
     InputStream& m_stream;
 };
 
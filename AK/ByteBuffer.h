@@ -144,6 +144,11 @@ public:
         m_size = 0;
     }
 
+    void clear_with_capacity()
+    {
+        m_size = 0;
+    }
+
     ALWAYS_INLINE void resize(size_t new_size)
     {
         if (new_size <= m_size) {
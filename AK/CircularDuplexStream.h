@@ -69,6 +69,43 @@ public:
         return nread;
     }
 
+    // Appends count bytes copied from distance bytes back, the way an LZ77 back reference does. If count is larger than
+    // distance, the copy overlaps itself, and the last distance bytes get repeated.
+    bool write_from_seekback(size_t distance, size_t count)
+    {
+        if (distance == 0 || distance > Capacity || distance > m_total_written || count > Capacity - m_queue.size()) {
+            set_recoverable_error();
+            return false;
+        }
+
+        auto* storage = m_queue.m_storage;
+        size_t destination = (m_queue.head_index() + m_queue.size()) % Capacity;
+        size_t source = (destination + Capacity - distance) % Capacity;
+
+        m_queue.m_size += count;
+        m_total_written += count;
+
+        if (distance < sizeof(u64)) {
+            // The source and the destination overlap too much to copy in chunks that are worth it.
+            for (size_t idx = 0; idx < count; ++idx) {
+                storage[destination] = storage[source];
+                destination = destination + 1 == Capacity ? 0 : destination + 1;
+                source = source + 1 == Capacity ? 0 : source + 1;
+            }
+            return true;
+        }
+
+        // A chunk of at most distance bytes only ever reads bytes before they get overwritten.
+        while (count > 0) {
+            auto chunk = min(min(count, distance), min(Capacity - source, Capacity - destination));
+            __builtin_memmove(storage + destination, storage + source, chunk);
+            destination = (destination + chunk) % Capacity;
+            source = (source + chunk) % Capacity;
+            count -= chunk;
+        }
+        return true;
+    }
+
     bool read_or_error(Bytes bytes) override
     {
         if (m_queue.size() < bytes.size()) {
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace AK {
+
+// significand * 10^exponent
+struct DecimalFloatingPoint {
+    u64 significand { 0 };
+    i32 exponent { 0 };
+};
+
+// Returns the double closest to significand * 10^exponent, with ties going to the even one.
+// This uses the Eisel-Lemire algorithm, which only needs a couple of 64-bit multiplications
+// and never has to fall back to big integer arithmetic, as long as the significand is exact.
+double decimal_to_double(u64 significand, i32 exponent, bool is_negative = false);
+
+// Returns the decimal with the fewest digits that still turns back into the same double, using Ryu.
+// If there are several, it's the one closest to the exact value. All trailing zeros end up in the exponent.
+// NOTE: The value has to be finite and positive.
+DecimalFloatingPoint shortest_decimal_representation(double);
+
+}
+
+using AK::decimal_to_double;
+using AK::DecimalFloatingPoint;
+using AK::shortest_decimal_representation;
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/FlyString.h>
 #include <AK/HashTable.h>
 #include <AK/Optional.h>
@@ -31,9 +32,38 @@ static HashTable<StringImpl*, FlyStringImplTraits>& fly_impls()
     return *s_table;
 }
 
+// FlyStrings get created on more than one thread (e.g. by the CSS parser running on a thread pool), so the table
+// is guarded by a spinlock. It's only ever held for a single lookup, which is too short to be worth sleeping for.
+static Atomic<bool> s_table_lock;
+
+class FlyStringTableLocker {
+public:
+    FlyStringTableLocker()
+    {
+        while (s_table_lock.exchange(true, AK::MemoryOrder::memory_order_acquire))
+            ;
+    }
+    ~FlyStringTableLocker() { s_table_lock.store(false, AK::MemoryOrder::memory_order_release); }
+};
+
 void FlyString::did_destroy_impl(Badge<StringImpl>, StringImpl& impl)
 {
-    fly_impls().remove(&impl);
+    FlyStringTableLocker locker;
+    // Another thread may have replaced this impl while it was on its way out, see try_adopt_fly_impl().
+    auto it = fly_impls().find(&impl);
+    if (it != fly_impls().end() && *it == &impl)
+        fly_impls().remove(it);
+}
+
+// Returns a reference to the impl in the table, unless its last reference is being dropped on another thread
+// right now. In that case, it gets evicted from the table so that a new one can take its place.
+static RefPtr<StringImpl> try_adopt_fly_impl(HashTable<StringImpl*, FlyStringImplTraits>::Iterator it)
+{
+    VERIFY((*it)->is_fly());
+    if ((*it)->try_ref())
+        return adopt_ref(**it);
+    fly_impls().remove(it);
+    return nullptr;
 }
 
 FlyString::FlyString(const String& string)
@@ -44,33 +74,34 @@ FlyString::FlyString(const String& string)
         m_impl = string.impl();
         return;
     }
-    auto it = fly_impls().find(const_cast<StringImpl*>(string.impl()));
-    if (it == fly_impls().end()) {
-        fly_impls().set(const_cast<StringImpl*>(string.impl()));
-        string.impl()->set_fly({}, true);
-        m_impl = string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
+    FlyStringTableLocker locker;
+    if (auto it = fly_impls().find(const_cast<StringImpl*>(string.impl())); it != fly_impls().end()) {
+        m_impl = try_adopt_fly_impl(it);
+        if (m_impl)
+            return;
     }
+    fly_impls().set(const_cast<StringImpl*>(string.impl()));
+    string.impl()->set_fly({}, true);
+    m_impl = string.impl();
 }
 
 FlyString::FlyString(StringView const& string)
 {
     if (string.is_null())
         return;
+    FlyStringTableLocker locker;
     auto it = fly_impls().find(string.hash(), [&](auto& candidate) {
         return string == candidate;
     });
-    if (it == fly_impls().end()) {
-        auto new_string = string.to_string();
-        fly_impls().set(new_string.impl());
-        new_string.impl()->set_fly({}, true);
-        m_impl = new_string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
+    if (it != fly_impls().end()) {
+        m_impl = try_adopt_fly_impl(it);
+        if (m_impl)
+            return;
     }
+    auto new_string = string.to_string();
+    fly_impls().set(new_string.impl());
+    new_string.impl()->set_fly({}, true);
+    m_impl = new_string.impl();
 }
 
 template<typename T>
@@ -126,15 +157,20 @@ bool FlyString::operator==(const String& other) const
     if (!other.impl())
         return false;
 
-    if (length() != other.length())
+    // There's only ever one fly impl for any given string, so if they're both fly, they'd have to be the same.
+    if (other.impl()->is_fly())
         return false;
 
-    return !__builtin_memcmp(characters(), other.characters(), length());
+    return *m_impl == *other.impl();
 }
 
 bool FlyString::operator==(const StringView& string) const
 {
-    return *this == String(string);
+    if (!m_impl)
+        return string.is_null();
+    if (string.is_null())
+        return false;
+    return view() == string;
 }
 
 bool FlyString::operator==(const char* string) const
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/HashFunctions.h>
+#include <AK/IterationDecision.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <AK/kmalloc.h>
@@ -24,73 +25,126 @@ enum class HashSetExistingEntryBehavior {
     Replace
 };
 
-template<typename HashTableType, typename T, typename BucketType>
+// The metadata for one slot of a HashTable.
+// Full slots store the low 7 bits of their hash (so the top bit is clear), everything else has it set.
+enum class HashTableControl : i8 {
+    Empty = -128,
+    Deleted = -2,
+    // Marks the end of the table for iterators.
+    Sentinel = -1,
+};
+
+// A group of control bytes that are looked at all at once, using plain 64-bit arithmetic ("SIMD within a register").
+// NOTE: We don't use actual SIMD instructions here, since this is also used in the kernel, which can't touch the vector registers.
+class HashTableControlGroup {
+public:
+    static constexpr size_t width = 8;
+
+    // A bitmask with the top bit set in the bytes that matched. Iterating over it yields the indices of those bytes.
+    class Mask {
+    public:
+        explicit Mask(u64 bits)
+            : m_bits(bits)
+        {
+        }
+
+        explicit operator bool() const { return m_bits != 0; }
+        size_t lowest_index() const { return __builtin_ctzll(m_bits) / 8; }
+        void remove_lowest() { m_bits &= m_bits - 1; }
+
+    private:
+        u64 m_bits { 0 };
+    };
+
+    explicit HashTableControlGroup(const i8* controls)
+    {
+        __builtin_memcpy(&m_bytes, controls, sizeof(m_bytes));
+    }
+
+    // NOTE: This may have false positives (but never false negatives), so the caller has to check the actual values anyway.
+    Mask match(u8 hash_bits) const
+    {
+        auto matches = m_bytes ^ (lsbs * hash_bits);
+        return Mask((matches - lsbs) & ~matches & msbs);
+    }
+
+    Mask match_empty() const { return Mask(m_bytes & (~m_bytes << 6) & msbs); }
+    Mask match_empty_or_deleted() const { return Mask(m_bytes & (~m_bytes << 7) & msbs); }
+
+private:
+    static constexpr u64 lsbs = 0x0101010101010101ull;
+    static constexpr u64 msbs = 0x8080808080808080ull;
+
+    u64 m_bytes { 0 };
+};
+
+template<typename HashTableType, typename T>
 class HashTableIterator {
     friend HashTableType;
 
 public:
-    bool operator==(const HashTableIterator& other) const { return m_bucket == other.m_bucket; }
-    bool operator!=(const HashTableIterator& other) const { return m_bucket != other.m_bucket; }
-    T& operator*() { return *m_bucket->slot(); }
-    T* operator->() { return m_bucket->slot(); }
+    bool operator==(const HashTableIterator& other) const { return m_slot == other.m_slot; }
+    bool operator!=(const HashTableIterator& other) const { return m_slot != other.m_slot; }
+    T& operator*() { return *m_slot; }
+    T* operator->() { return m_slot; }
     void operator++() { skip_to_next(); }
 
 private:
     void skip_to_next()
     {
-        if (!m_bucket)
+        if (!m_slot)
             return;
         do {
-            ++m_bucket;
-            if (m_bucket->used)
-                return;
-        } while (!m_bucket->end);
-        if (m_bucket->end)
-            m_bucket = nullptr;
+            ++m_control;
+            ++m_slot;
+        } while (*m_control < 0 && *m_control != (i8)HashTableControl::Sentinel);
+        if (*m_control == (i8)HashTableControl::Sentinel) {
+            m_control = nullptr;
+            m_slot = nullptr;
+        }
     }
 
-    explicit HashTableIterator(BucketType* bucket)
-        : m_bucket(bucket)
+    HashTableIterator(const i8* control, T* slot)
+        : m_control(control)
+        , m_slot(slot)
     {
     }
 
-    BucketType* m_bucket { nullptr };
+    const i8* m_control { nullptr };
+    T* m_slot { nullptr };
 };
 
+// An open addressing hash table in the style of Google's SwissTable.
+//
+// Next to the slots, there's one control byte per slot, saying whether it's empty, deleted, or full,
+// and for full slots, 7 bits of their hash. Lookups look at a whole group of control bytes at once,
+// and only compare the values whose hash bits match, so even long probe sequences stay cheap.
+// Removing a value only leaves a tombstone behind if a lookup could have probed past it.
 template<typename T, typename TraitsForT>
 class HashTable {
-    static constexpr size_t load_factor_in_percent = 60;
-
-    struct Bucket {
-        bool used;
-        bool deleted;
-        bool end;
-        alignas(T) u8 storage[sizeof(T)];
-
-        T* slot() { return reinterpret_cast<T*>(storage); }
-        const T* slot() const { return reinterpret_cast<const T*>(storage); }
-    };
+    using Control = HashTableControl;
+    using Group = HashTableControlGroup;
 
 public:
     HashTable() = default;
-    explicit HashTable(size_t capacity) { rehash(capacity); }
+    explicit HashTable(size_t capacity) { ensure_capacity(capacity); }
 
     ~HashTable()
     {
-        if (!m_buckets)
+        if (!m_controls)
             return;
 
         for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                m_buckets[i].slot()->~T();
+            if (is_full(m_controls[i]))
+                m_slots[i].~T();
         }
 
-        kfree(m_buckets);
+        kfree(m_controls);
     }
 
     HashTable(const HashTable& other)
     {
-        rehash(other.capacity());
+        ensure_capacity(other.size());
         for (auto& it : other)
             set(it);
     }
@@ -103,15 +157,17 @@ public:
     }
 
     HashTable(HashTable&& other) noexcept
-        : m_buckets(other.m_buckets)
+        : m_controls(other.m_controls)
+        , m_slots(other.m_slots)
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
-        , m_deleted_count(other.m_deleted_count)
+        , m_growth_left(other.m_growth_left)
     {
+        other.m_controls = nullptr;
+        other.m_slots = nullptr;
         other.m_size = 0;
         other.m_capacity = 0;
-        other.m_deleted_count = 0;
-        other.m_buckets = nullptr;
+        other.m_growth_left = 0;
     }
 
     HashTable& operator=(HashTable&& other) noexcept
@@ -123,10 +179,11 @@ public:
 
     friend void swap(HashTable& a, HashTable& b) noexcept
     {
-        swap(a.m_buckets, b.m_buckets);
+        swap(a.m_controls, b.m_controls);
+        swap(a.m_slots, b.m_slots);
         swap(a.m_size, b.m_size);
         swap(a.m_capacity, b.m_capacity);
-        swap(a.m_deleted_count, b.m_deleted_count);
+        swap(a.m_growth_left, b.m_growth_left);
     }
 
     [[nodiscard]] bool is_empty() const { return !m_size; }
@@ -144,7 +201,12 @@ public:
     void ensure_capacity(size_t capacity)
     {
         VERIFY(capacity >= size());
-        rehash(capacity * 2);
+        if (capacity <= max_size_for_capacity(m_capacity))
+            return;
+        size_t new_capacity = Group::width;
+        while (max_size_for_capacity(new_capacity) < capacity)
+            new_capacity *= 2;
+        rehash(new_capacity);
     }
 
     bool contains(const T& value) const
@@ -152,36 +214,36 @@ public:
         return find(value) != end();
     }
 
-    using Iterator = HashTableIterator<HashTable, T, Bucket>;
+    using Iterator = HashTableIterator<HashTable, T>;
 
     Iterator begin()
     {
         for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                return Iterator(&m_buckets[i]);
+            if (is_full(m_controls[i]))
+                return Iterator(&m_controls[i], &m_slots[i]);
         }
         return end();
     }
 
     Iterator end()
     {
-        return Iterator(nullptr);
+        return Iterator(nullptr, nullptr);
     }
 
-    using ConstIterator = HashTableIterator<const HashTable, const T, const Bucket>;
+    using ConstIterator = HashTableIterator<const HashTable, const T>;
 
     ConstIterator begin() const
     {
         for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                return ConstIterator(&m_buckets[i]);
+            if (is_full(m_controls[i]))
+                return ConstIterator(&m_controls[i], &m_slots[i]);
         }
         return end();
     }
 
     ConstIterator end() const
     {
-        return ConstIterator(nullptr);
+        return ConstIterator(nullptr, nullptr);
     }
 
     void clear()
@@ -192,20 +254,26 @@ public:
     template<typename U = T>
     HashSetResult set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace)
     {
-        auto& bucket = lookup_for_writing(value);
-        if (bucket.used) {
+        auto hash = mix_hash(TraitsForT::hash(value));
+        if (auto* slot = lookup_with_hash(hash, [&](auto& other) { return TraitsForT::equals(other, value); })) {
             if (existing_entry_behaviour == HashSetExistingEntryBehavior::Keep)
                 return HashSetResult::KeptExistingEntry;
-            (*bucket.slot()) = forward<U>(value);
+            *slot = forward<U>(value);
             return HashSetResult::ReplacedExistingEntry;
         }
 
-        new (bucket.slot()) T(forward<U>(value));
-        bucket.used = true;
-        if (bucket.deleted) {
-            bucket.deleted = false;
-            --m_deleted_count;
+        if (m_capacity == 0)
+            grow_or_clean_up();
+        auto index = find_slot_for_insertion(hash);
+        if (m_growth_left == 0 && m_controls[index] == (i8)Control::Empty) {
+            grow_or_clean_up();
+            index = find_slot_for_insertion(hash);
         }
+
+        new (&m_slots[index]) T(forward<U>(value));
+        if (m_controls[index] == (i8)Control::Empty)
+            --m_growth_left;
+        m_controls[index] = hash_bits(hash);
         ++m_size;
         return HashSetResult::InsertedNewEntry;
     }
@@ -213,7 +281,7 @@ public:
     template<typename Finder>
     Iterator find(unsigned hash, Finder finder)
     {
-        return Iterator(lookup_with_hash(hash, move(finder)));
+        return iterator_for(lookup_with_hash(mix_hash(hash), move(finder)));
     }
 
     Iterator find(const T& value)
@@ -224,7 +292,7 @@ public:
     template<typename Finder>
     ConstIterator find(unsigned hash, Finder finder) const
     {
-        return ConstIterator(lookup_with_hash(hash, move(finder)));
+        return const_iterator_for(lookup_with_hash(mix_hash(hash), move(finder)));
     }
 
     ConstIterator find(const T& value) const
@@ -244,111 +312,154 @@ public:
 
     void remove(Iterator iterator)
     {
-        VERIFY(iterator.m_bucket);
-        auto& bucket = *iterator.m_bucket;
-        VERIFY(bucket.used);
-        VERIFY(!bucket.end);
-        VERIFY(!bucket.deleted);
-        bucket.slot()->~T();
-        bucket.used = false;
-        bucket.deleted = true;
+        VERIFY(iterator.m_slot);
+        size_t index = iterator.m_slot - m_slots;
+        VERIFY(index < m_capacity);
+        VERIFY(is_full(m_controls[index]));
+        m_slots[index].~T();
         --m_size;
-        ++m_deleted_count;
-    }
 
-private:
-    void insert_during_rehash(T&& value)
-    {
-        auto& bucket = lookup_for_writing(value);
-        new (bucket.slot()) T(move(value));
-        bucket.used = true;
+        // If this group still has an empty slot, no lookup ever looked past it, so nobody needs a tombstone here.
+        Group group(&m_controls[index - index % Group::width]);
+        if (group.match_empty()) {
+            m_controls[index] = (i8)Control::Empty;
+            ++m_growth_left;
+        } else {
+            m_controls[index] = (i8)Control::Deleted;
+        }
     }
 
-    void rehash(size_t new_capacity)
-    {
-        new_capacity = max(new_capacity, static_cast<size_t>(4));
-        new_capacity = kmalloc_good_size(new_capacity * sizeof(Bucket)) / sizeof(Bucket);
-
-        auto* old_buckets = m_buckets;
-        auto old_capacity = m_capacity;
-
-        m_buckets = (Bucket*)kmalloc(sizeof(Bucket) * (new_capacity + 1));
-        __builtin_memset(m_buckets, 0, sizeof(Bucket) * (new_capacity + 1));
-        m_capacity = new_capacity;
-        m_deleted_count = 0;
+private:
+    static bool is_full(i8 control) { return control >= 0; }
 
-        m_buckets[m_capacity].end = true;
+    // We take the hash apart, so every bit of it has to count, even if the traits produce something like an identity hash.
+    static u32 mix_hash(unsigned hash) { return int_hash(hash); }
+    static i8 hash_bits(u32 hash) { return hash & 0x7f; }
+    size_t first_group_index(u32 hash) const { return (hash >> 7) & (group_count() - 1); }
+    size_t group_count() const { return m_capacity / Group::width; }
 
-        if (!old_buckets)
-            return;
+    // Keep at least one in eight slots empty, so that lookups always have somewhere to stop.
+    static constexpr size_t max_size_for_capacity(size_t capacity) { return capacity - capacity / 8; }
 
-        for (size_t i = 0; i < old_capacity; ++i) {
-            auto& old_bucket = old_buckets[i];
-            if (old_bucket.used) {
-                insert_during_rehash(move(*old_bucket.slot()));
-                old_bucket.slot()->~T();
-            }
+    // Probes the groups in triangular steps, which visits all of them since there's a power of two of them.
+    template<typename Callback>
+    void for_each_group_in_probe_sequence(u32 hash, Callback callback) const
+    {
+        size_t group_index = first_group_index(hash);
+        for (size_t step = 1; step <= group_count(); ++step) {
+            if (callback(group_index * Group::width) == IterationDecision::Break)
+                return;
+            group_index = (group_index + step) & (group_count() - 1);
         }
-
-        kfree(old_buckets);
     }
 
     template<typename Finder>
-    Bucket* lookup_with_hash(unsigned hash, Finder finder) const
+    T* lookup_with_hash(u32 hash, Finder finder) const
     {
         if (is_empty())
             return nullptr;
 
-        for (;;) {
-            auto& bucket = m_buckets[hash % m_capacity];
-
-            if (bucket.used && finder(*bucket.slot()))
-                return &bucket;
-
-            if (!bucket.used && !bucket.deleted)
-                return nullptr;
+        T* result = nullptr;
+        for_each_group_in_probe_sequence(hash, [&](size_t group_start) {
+            Group group(&m_controls[group_start]);
+            for (auto matches = group.match(hash_bits(hash)); matches; matches.remove_lowest()) {
+                auto index = group_start + matches.lowest_index();
+                if (finder(m_slots[index])) {
+                    result = &m_slots[index];
+                    return IterationDecision::Break;
+                }
+            }
+            if (group.match_empty())
+                return IterationDecision::Break;
+            return IterationDecision::Continue;
+        });
+        return result;
+    }
 
-            hash = double_hash(hash);
-        }
+    size_t find_slot_for_insertion(u32 hash) const
+    {
+        VERIFY(m_capacity > 0);
+        size_t result = m_capacity;
+        for_each_group_in_probe_sequence(hash, [&](size_t group_start) {
+            auto matches = Group(&m_controls[group_start]).match_empty_or_deleted();
+            if (!matches)
+                return IterationDecision::Continue;
+            result = group_start + matches.lowest_index();
+            return IterationDecision::Break;
+        });
+        VERIFY(result < m_capacity);
+        return result;
     }
 
-    const Bucket* lookup_for_reading(const T& value) const
+    void grow_or_clean_up()
     {
-        return lookup_with_hash(TraitsForT::hash(value), [&value](auto& entry) { return TraitsForT::equals(entry, value); });
+        // If enough of the used up space is tombstones, just get rid of them.
+        if (m_capacity > 0 && m_size <= m_capacity * 25 / 32)
+            rehash(m_capacity);
+        else
+            rehash(max(m_capacity * 2, Group::width));
     }
 
-    Bucket& lookup_for_writing(const T& value)
+    static size_t slots_offset(size_t capacity)
     {
-        if (should_grow())
-            rehash(capacity() * 2);
+        // One extra control byte for the sentinel.
+        return round_up_to_power_of_two(capacity + 1, max(alignof(T), sizeof(void*)));
+    }
 
-        auto hash = TraitsForT::hash(value);
-        Bucket* first_empty_bucket = nullptr;
-        for (;;) {
-            auto& bucket = m_buckets[hash % m_capacity];
+    void rehash(size_t new_capacity)
+    {
+        VERIFY(new_capacity >= Group::width);
+        VERIFY((new_capacity & (new_capacity - 1)) == 0);
 
-            if (bucket.used && TraitsForT::equals(*bucket.slot(), value))
-                return bucket;
+        auto* old_controls = m_controls;
+        auto* old_slots = m_slots;
+        auto old_capacity = m_capacity;
 
-            if (!bucket.used) {
-                if (!first_empty_bucket)
-                    first_empty_bucket = &bucket;
+        auto* memory = (u8*)kmalloc(slots_offset(new_capacity) + sizeof(T) * new_capacity);
+        VERIFY(memory);
+        m_controls = reinterpret_cast<i8*>(memory);
+        m_slots = reinterpret_cast<T*>(memory + slots_offset(new_capacity));
+        __builtin_memset(m_controls, (u8)Control::Empty, new_capacity);
+        m_controls[new_capacity] = (i8)Control::Sentinel;
+        m_capacity = new_capacity;
+        m_growth_left = max_size_for_capacity(new_capacity) - m_size;
 
-                if (!bucket.deleted)
-                    return *const_cast<Bucket*>(first_empty_bucket);
-            }
+        if (!old_controls)
+            return;
 
-            hash = double_hash(hash);
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!is_full(old_controls[i]))
+                continue;
+            auto hash = mix_hash(TraitsForT::hash(old_slots[i]));
+            auto index = find_slot_for_insertion(hash);
+            new (&m_slots[index]) T(move(old_slots[i]));
+            m_controls[index] = hash_bits(hash);
+            old_slots[i].~T();
         }
+
+        kfree(old_controls);
     }
 
-    [[nodiscard]] size_t used_bucket_count() const { return m_size + m_deleted_count; }
-    [[nodiscard]] bool should_grow() const { return ((used_bucket_count() + 1) * 100) >= (m_capacity * load_factor_in_percent); }
+    Iterator iterator_for(T* slot)
+    {
+        if (!slot)
+            return end();
+        return Iterator(&m_controls[slot - m_slots], slot);
+    }
+
+    ConstIterator const_iterator_for(const T* slot) const
+    {
+        if (!slot)
+            return end();
+        return ConstIterator(&m_controls[slot - m_slots], slot);
+    }
 
-    Bucket* m_buckets { nullptr };
+    i8* m_controls { nullptr };
+    T* m_slots { nullptr };
     size_t m_size { 0 };
     size_t m_capacity { 0 };
-    size_t m_deleted_count { 0 };
+    // How many empty slots we can still fill before we have to rehash.
+    size_t m_growth_left { 0 };
 };
 
 }
@@ -4,78 +4,60 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CharacterTypes.h>
+#include <AK/FloatingPointStringConversions.h>
+#include <AK/FlyString.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonParser.h>
+#include <AK/JsonTokenizer.h>
 #include <ctype.h>
+#ifndef KERNEL
+#    include <stdlib.h>
+#endif
 
 namespace AK {
 
-String JsonParser::consume_and_unescape_string()
+Optional<StringView> JsonParser::consume_string_without_escapes()
 {
-    if (!consume_specific('"'))
+    if (peek() != '"')
         return {};
-    StringBuilder final_sb;
-
-    for (;;) {
-        size_t peek_index = m_index;
-        char ch = 0;
-        for (;;) {
-            if (peek_index == m_input.length())
-                break;
-            ch = m_input[peek_index];
-            if (ch == '"' || ch == '\\')
-                break;
-            ++peek_index;
-        }
+    size_t end = m_index + 1;
+    for (; end < m_input.length(); ++end) {
+        char ch = m_input[end];
+        if (ch == '\\')
+            return {};
+        if (ch == '"')
+            break;
+    }
+    if (end == m_input.length())
+        return {};
+    auto string = m_input.substring_view(m_index + 1, end - m_index - 1);
+    m_index = end + 1;
+    return string;
+}
 
-        while (peek_index != m_index) {
-            final_sb.append(m_input[m_index]);
-            m_index++;
-        }
+String JsonParser::consume_and_unescape_string()
+{
+    // Most strings don't have any escapes in them, and those can be copied straight out of the input.
+    if (auto string = consume_string_without_escapes(); string.has_value())
+        return *string;
 
-        if (m_index == m_input.length())
-            break;
+    if (!consume_specific('"'))
+        return {};
+    size_t start = m_index;
+    for (; m_index < m_input.length(); ++m_index) {
+        char ch = m_input[m_index];
         if (ch == '"')
             break;
-        if (ch != '\\') {
-            final_sb.append(consume());
-            continue;
-        }
-        ignore();
-        char escaped_ch = consume();
-        switch (escaped_ch) {
-        case 'n':
-            final_sb.append('\n');
-            break;
-        case 'r':
-            final_sb.append('\r');
-            break;
-        case 't':
-            final_sb.append('\t');
-            break;
-        case 'b':
-            final_sb.append('\b');
-            break;
-        case 'f':
-            final_sb.append('\f');
-            break;
-        case 'u': {
-            auto code_point = AK::StringUtils::convert_to_uint_from_hex(consume(4));
-            if (code_point.has_value())
-                final_sb.append_code_point(code_point.value());
-            else
-                final_sb.append('?');
-        } break;
-        default:
-            final_sb.append(escaped_ch);
-            break;
-        }
+        if (ch == '\\')
+            ++m_index;
     }
-    if (!consume_specific('"'))
+    if (m_index >= m_input.length())
         return {};
-
-    return final_sb.to_string();
+    auto string = m_input.substring_view(start, m_index - start);
+    ignore();
+    return JsonTokenizer::unescape(string);
 }
 
 Optional<JsonValue> JsonParser::parse_object()
@@ -88,7 +70,13 @@ Optional<JsonValue> JsonParser::parse_object()
         if (peek() == '}')
             break;
         ignore_while(isspace);
-        auto name = consume_and_unescape_string();
+        // Objects tend to have the same few keys over and over again (think arrays of objects),
+        // so keys are interned, which only allocates the first time we come across each of them.
+        String name;
+        if (auto key = consume_string_without_escapes(); key.has_value())
+            name = FlyString(*key);
+        else
+            name = consume_and_unescape_string();
         if (name.is_null())
             return {};
         ignore_while(isspace);
@@ -179,29 +167,48 @@ Optional<JsonValue> JsonParser::parse_number()
 
 #ifndef KERNEL
     if (is_double) {
-        // FIXME: This logic looks shaky.
-        int whole = 0;
-        auto to_signed_result = number_string.to_uint();
-        if (to_signed_result.has_value()) {
-            whole = to_signed_result.value();
-        } else {
-            auto number = number_string.to_int();
-            if (!number.has_value())
-                return {};
-            whole = number.value();
-        }
+        bool is_negative = !number_string.is_empty() && number_string[0] == '-';
+        auto whole_string = is_negative ? number_string.substring_view(1) : number_string;
+        if (whole_string.is_empty() || fraction_string.is_empty())
+            return {};
 
-        auto fraction_string_uint = fraction_string.to_uint();
-        if (!fraction_string_uint.has_value())
+        // A double has at most 17 significant digits, anything past the 19th only matters for rounding.
+        constexpr size_t max_significant_digits = 19;
+        u64 significand = 0;
+        i32 exponent = 0;
+        size_t significant_digits = 0;
+        bool dropped_digits = false;
+        auto consume_digits = [&](StringView digits, bool after_decimal_point) {
+            for (auto ch : digits) {
+                if (!is_ascii_digit(ch))
+                    return false;
+                if (significant_digits < max_significant_digits) {
+                    significand = significand * 10 + (ch - '0');
+                    if (significand != 0)
+                        ++significant_digits;
+                    if (after_decimal_point)
+                        --exponent;
+                } else {
+                    dropped_digits |= ch != '0';
+                    if (!after_decimal_point)
+                        ++exponent;
+                }
+            }
+            return true;
+        };
+        if (!consume_digits(whole_string, false) || !consume_digits(fraction_string, true))
             return {};
-        int fraction = fraction_string_uint.value();
-        fraction *= (whole < 0) ? -1 : 1;
 
-        auto divider = 1;
-        for (size_t i = 0; i < fraction_buffer.size(); ++i) {
-            divider *= 10;
+        auto result = decimal_to_double(significand, exponent, is_negative);
+        // The digits we dropped can only make a difference if they push the number past the middle between two doubles.
+        if (dropped_digits && result != decimal_to_double(significand + 1, exponent, is_negative)) {
+            StringBuilder builder;
+            builder.append(number_string);
+            builder.append('.');
+            builder.append(fraction_string);
+            result = strtod(builder.to_string().characters(), nullptr);
         }
-        value = JsonValue((double)whole + ((double)fraction / divider));
+        value = JsonValue(result);
     } else {
 #endif
         auto to_unsigned_result = number_string.to_uint();
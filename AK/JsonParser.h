@@ -23,6 +23,7 @@ public:
 private:
     Optional<JsonValue> parse_helper();
 
+    Optional<StringView> consume_string_without_escapes();
     String consume_and_unescape_string();
     Optional<JsonValue> parse_array();
     Optional<JsonValue> parse_object();
@@ -31,8 +32,6 @@ private:
     Optional<JsonValue> parse_false();
     Optional<JsonValue> parse_true();
     Optional<JsonValue> parse_null();
-
-    String m_last_string_starting_with_character[256];
 };
 
 }
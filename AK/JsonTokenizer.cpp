@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/GenericLexer.h>
+#include <AK/JsonTokenizer.h>
+#include <AK/StringBuilder.h>
+
+namespace AK {
+
+static JsonToken make_token(JsonToken::Type type, StringView text = {}, bool has_escapes = false)
+{
+    return { type, text, has_escapes };
+}
+
+bool JsonToken::string_equals(const StringView& string) const
+{
+    if (type != Type::Key && type != Type::String)
+        return false;
+    if (!has_escapes)
+        return text == string;
+    return JsonTokenizer::unescape(text) == string;
+}
+
+String JsonToken::to_string() const
+{
+    if (has_escapes)
+        return JsonTokenizer::unescape(text);
+    return text;
+}
+
+String JsonTokenizer::unescape(const StringView& string)
+{
+    StringBuilder builder(string.length());
+    GenericLexer lexer(string);
+    while (!lexer.is_eof()) {
+        // NOTE: This also consumes the backslash, if there is one.
+        builder.append(lexer.consume_until('\\'));
+        if (lexer.is_eof())
+            break;
+        char escaped_ch = lexer.consume();
+        switch (escaped_ch) {
+        case 'n':
+            builder.append('\n');
+            break;
+        case 'r':
+            builder.append('\r');
+            break;
+        case 't':
+            builder.append('\t');
+            break;
+        case 'b':
+            builder.append('\b');
+            break;
+        case 'f':
+            builder.append('\f');
+            break;
+        case 'u': {
+            auto code_point = AK::StringUtils::convert_to_uint_from_hex(lexer.consume(4));
+            if (code_point.has_value())
+                builder.append_code_point(code_point.value());
+            else
+                builder.append('?');
+        } break;
+        default:
+            builder.append(escaped_ch);
+            break;
+        }
+    }
+    return builder.to_string();
+}
+
+JsonToken JsonTokenizer::fail()
+{
+    m_state = State::Failed;
+    return {};
+}
+
+void JsonTokenizer::skip_whitespace()
+{
+    while (m_index < m_input.length() && is_ascii_space(m_input[m_index]))
+        ++m_index;
+}
+
+Optional<JsonToken> JsonTokenizer::read_string(JsonToken::Type type)
+{
+    if (m_index >= m_input.length() || m_input[m_index] != '"')
+        return {};
+    size_t start = m_index + 1;
+    bool has_escapes = false;
+    for (size_t i = start; i < m_input.length(); ++i) {
+        char ch = m_input[i];
+        if (ch == '\\') {
+            has_escapes = true;
+            ++i;
+            continue;
+        }
+        if (ch == '"') {
+            m_index = i + 1;
+            return make_token(type, m_input.substring_view(start, i - start), has_escapes);
+        }
+    }
+    return {};
+}
+
+JsonToken JsonTokenizer::finish_value(JsonToken token)
+{
+    m_state = m_containers.is_empty() ? State::Done : State::ExpectCommaOrEnd;
+    return token;
+}
+
+JsonToken JsonTokenizer::read_value()
+{
+    if (m_index >= m_input.length())
+        return fail();
+
+    auto read_literal = [&](StringView literal, JsonToken::Type type) {
+        if (!m_input.substring_view(m_index).starts_with(literal))
+            return fail();
+        auto token = make_token(type, m_input.substring_view(m_index, literal.length()));
+        m_index += literal.length();
+        return finish_value(token);
+    };
+
+    char ch = m_input[m_index];
+    switch (ch) {
+    case '{':
+        ++m_index;
+        m_containers.append(true);
+        m_state = State::ExpectKeyOrObjectEnd;
+        return make_token(JsonToken::Type::ObjectStart);
+    case '[':
+        ++m_index;
+        m_containers.append(false);
+        m_state = State::ExpectValueOrArrayEnd;
+        return make_token(JsonToken::Type::ArrayStart);
+    case '"': {
+        auto token = read_string(JsonToken::Type::String);
+        if (!token.has_value())
+            return fail();
+        return finish_value(token.release_value());
+    }
+    case 't':
+        return read_literal("true"sv, JsonToken::Type::True);
+    case 'f':
+        return read_literal("false"sv, JsonToken::Type::False);
+    case 'n':
+        return read_literal("null"sv, JsonToken::Type::Null);
+    default:
+        break;
+    }
+
+    if (ch != '-' && !is_ascii_digit(ch))
+        return fail();
+    size_t start = m_index++;
+    while (m_index < m_input.length()) {
+        ch = m_input[m_index];
+        if (!is_ascii_digit(ch) && ch != '.' && ch != 'e' && ch != 'E' && ch != '+' && ch != '-')
+            break;
+        ++m_index;
+    }
+    return finish_value(make_token(JsonToken::Type::Number, m_input.substring_view(start, m_index - start)));
+}
+
+JsonToken JsonTokenizer::read_key()
+{
+    auto token = read_string(JsonToken::Type::Key);
+    if (!token.has_value())
+        return fail();
+    skip_whitespace();
+    if (m_index >= m_input.length() || m_input[m_index] != ':')
+        return fail();
+    ++m_index;
+    m_state = State::ExpectValue;
+    return token.release_value();
+}
+
+JsonToken JsonTokenizer::next()
+{
+    skip_whitespace();
+    switch (m_state) {
+    case State::Failed:
+        return {};
+    case State::Done:
+        if (m_index != m_input.length())
+            return fail();
+        return make_token(JsonToken::Type::EndOfInput);
+    case State::ExpectValue:
+        return read_value();
+    case State::ExpectValueOrArrayEnd:
+        if (m_index < m_input.length() && m_input[m_index] == ']') {
+            ++m_index;
+            m_containers.take_last();
+            return finish_value(make_token(JsonToken::Type::ArrayEnd));
+        }
+        return read_value();
+    case State::ExpectKey:
+        return read_key();
+    case State::ExpectKeyOrObjectEnd:
+        if (m_index < m_input.length() && m_input[m_index] == '}') {
+            ++m_index;
+            m_containers.take_last();
+            return finish_value(make_token(JsonToken::Type::ObjectEnd));
+        }
+        return read_key();
+    case State::ExpectCommaOrEnd: {
+        if (m_index >= m_input.length())
+            return fail();
+        bool in_object = m_containers.last();
+        char ch = m_input[m_index++];
+        if (ch == ',') {
+            skip_whitespace();
+            if (in_object)
+                return read_key();
+            return read_value();
+        }
+        if (ch == (in_object ? '}' : ']')) {
+            m_containers.take_last();
+            return finish_value(make_token(in_object ? JsonToken::Type::ObjectEnd : JsonToken::Type::ArrayEnd));
+        }
+        return fail();
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+bool JsonTokenizer::skip_value(const JsonToken& token)
+{
+    if (token.type != JsonToken::Type::ObjectStart && token.type != JsonToken::Type::ArrayStart)
+        return token.is_value();
+    auto depth = m_containers.size();
+    while (m_containers.size() >= depth) {
+        if (next().is_error())
+            return false;
+    }
+    return true;
+}
+
+bool JsonTokenizer::next_is(JsonToken::Type type)
+{
+    auto token = next();
+    if (token.type == type)
+        return true;
+    fail();
+    return false;
+}
+
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringUtils.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+struct JsonToken {
+    enum class Type {
+        Error,
+        EndOfInput,
+        ObjectStart,
+        ObjectEnd,
+        ArrayStart,
+        ArrayEnd,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+    };
+
+    Type type { Type::Error };
+    // For keys and strings, this is what's between the quotes, with any escapes still in it.
+    // For numbers, it's the number exactly as it was written.
+    StringView text;
+    bool has_escapes { false };
+
+    bool is_error() const { return type == Type::Error; }
+    bool is_value() const { return type == Type::ObjectStart || type == Type::ArrayStart || type >= Type::String; }
+
+    // Compares keys and strings with what they mean, as opposed to how they were written.
+    bool string_equals(const StringView&) const;
+    // NOTE: This only allocates if there's anything to unescape.
+    String to_string() const;
+
+    template<typename T>
+    Optional<T> to_integer() const
+    {
+        if (type != Type::Number)
+            return {};
+        if constexpr (IsSigned<T>)
+            return StringUtils::convert_to_int<T>(text);
+        else
+            return StringUtils::convert_to_uint<T>(text);
+    }
+};
+
+// A streaming JSON reader: it walks the input one token at a time, validating the structure as it goes,
+// without ever building a JsonValue or copying anything out of the input.
+// Use this instead of JsonParser for large inputs that only need to be looked at once.
+class JsonTokenizer {
+public:
+    explicit JsonTokenizer(const StringView& input)
+        : m_input(input)
+    {
+    }
+
+    // Returns Error for malformed input, and keeps returning it from then on.
+    JsonToken next();
+
+    // Skips the rest of the value that the given token (which was just returned by next()) starts.
+    bool skip_value(const JsonToken&);
+
+    // Like next(), but for when the caller knows what it wants; anything else is an error.
+    bool next_is(JsonToken::Type);
+
+    // NOTE: The input is expected to be what's between the quotes of a JSON string.
+    static String unescape(const StringView&);
+
+private:
+    enum class State {
+        ExpectValue,
+        ExpectValueOrArrayEnd,
+        ExpectKey,
+        ExpectKeyOrObjectEnd,
+        ExpectCommaOrEnd,
+        Done,
+        Failed,
+    };
+
+    JsonToken fail();
+    JsonToken read_value();
+    JsonToken read_key();
+    JsonToken finish_value(JsonToken);
+    Optional<JsonToken> read_string(JsonToken::Type);
+    void skip_whitespace();
+
+    StringView m_input;
+    size_t m_index { 0 };
+    State m_state { State::ExpectValue };
+    // true for objects, false for arrays.
+    Vector<bool, 32> m_containers;
+};
+
+}
+
+using AK::JsonToken;
+using AK::JsonTokenizer;
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// A bounded queue that any number of threads can enqueue into and dequeue from at the same time, without locks.
+// This is Dmitry Vyukov's design: every slot has a sequence number that tells producers and consumers whose turn
+// it is, so each operation only needs a single compare-and-swap on the shared position in the common case.
+// Enqueueing into a full queue or dequeueing from an empty one fails instead of waiting.
+template<typename T, size_t Capacity>
+class MPMCQueue {
+    AK_MAKE_NONCOPYABLE(MPMCQueue);
+    AK_MAKE_NONMOVABLE(MPMCQueue);
+
+    static_assert(Capacity >= 2 && !(Capacity & (Capacity - 1)), "MPMCQueue capacity must be a power of two");
+
+public:
+    MPMCQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            m_cells[i].sequence.store(i, AK::MemoryOrder::memory_order_relaxed);
+    }
+
+    ~MPMCQueue()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    [[nodiscard]] bool try_enqueue(T&& value)
+    {
+        Cell* cell;
+        auto position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[position & (Capacity - 1)];
+            auto sequence = cell->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - position);
+            if (difference == 0) {
+                if (m_enqueue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // The consumer of the previous round hasn't freed this slot yet, so we're full.
+                return false;
+            } else {
+                position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(move(value));
+        cell->sequence.store(position + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool try_enqueue(const T& value)
+    {
+        T copy = value;
+        return try_enqueue(move(copy));
+    }
+
+    [[nodiscard]] Optional<T> try_dequeue()
+    {
+        Cell* cell;
+        auto position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[position & (Capacity - 1)];
+            auto sequence = cell->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - (position + 1));
+            if (difference == 0) {
+                if (m_dequeue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // Nobody has put anything into this slot yet, so we're empty.
+                return {};
+            } else {
+                position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+        auto* element = reinterpret_cast<T*>(cell->storage);
+        Optional<T> value = move(*element);
+        element->~T();
+        // The slot is free again, for whoever enqueues one full round later.
+        cell->sequence.store(position + Capacity, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // NOTE: This is only a snapshot, and may be off while other threads are in the middle of an operation.
+    size_t size() const
+    {
+        auto enqueue_position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        auto dequeue_position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        return enqueue_position >= dequeue_position ? enqueue_position - dequeue_position : 0;
+    }
+    bool is_empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Cell {
+        Atomic<size_t> sequence;
+        alignas(T) u8 storage[sizeof(T)];
+    };
+
+    Cell m_cells[Capacity];
+    // Producers and consumers each get (at least) a cache line of their own.
+    // NOTE: This pads instead of using alignas(), since we don't have an over-aligned operator new.
+    [[maybe_unused]] u8 m_padding_before_enqueue_position[64];
+    Atomic<size_t> m_enqueue_position { 0 };
+    [[maybe_unused]] u8 m_padding_before_dequeue_position[64];
+    Atomic<size_t> m_dequeue_position { 0 };
+};
+
+}
+
+using AK::MPMCQueue;
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+namespace Detail {
+
+// Below this size, runs are sorted with insertion sort instead of being split any further.
+constexpr size_t merge_sort_insertion_sort_threshold = 16;
+
+template<typename Collection, typename Buffer, typename LessThan>
+void merge_sort_impl(Collection& col, size_t begin, size_t end, Buffer& buffer, LessThan& less_than)
+{
+    size_t size = end - begin;
+    if (size <= merge_sort_insertion_sort_threshold) {
+        for (size_t i = begin + 1; i < end; ++i) {
+            if (!less_than(col[i], col[i - 1]))
+                continue;
+            auto value = move(col[i]);
+            size_t j = i;
+            do {
+                col[j] = move(col[j - 1]);
+                --j;
+            } while (j > begin && less_than(value, col[j - 1]));
+            col[j] = move(value);
+        }
+        return;
+    }
+
+    // Sorting both halves depth-first keeps the data we work on small enough to stay in the cache.
+    size_t middle = begin + size / 2;
+    merge_sort_impl(col, begin, middle, buffer, less_than);
+    merge_sort_impl(col, middle, end, buffer, less_than);
+
+    // If the halves are already in order, there's nothing to merge.
+    if (!less_than(col[middle], col[middle - 1]))
+        return;
+
+    // Everything on the left that doesn't come after the first element on the right is already in place.
+    size_t low = begin;
+    size_t high = middle - 1;
+    while (low < high) {
+        size_t probe = low + (high - low) / 2;
+        if (less_than(col[middle], col[probe]))
+            high = probe;
+        else
+            low = probe + 1;
+    }
+
+    // Move the rest of the left half out of the way, and merge it with the right half back into place.
+    buffer.clear_with_capacity();
+    for (size_t i = low; i < middle; ++i)
+        buffer.unchecked_append(move(col[i]));
+
+    size_t left = 0;
+    size_t right = middle;
+    size_t out = low;
+    while (left < buffer.size() && right < end) {
+        if (less_than(col[right], buffer[left]))
+            col[out++] = move(col[right++]);
+        else
+            col[out++] = move(buffer[left++]);
+    }
+    // Whatever is left of the right half is already where it belongs.
+    while (left < buffer.size())
+        col[out++] = move(buffer[left++]);
+    buffer.clear_with_capacity();
+}
+
+}
+
+/* This is a stable merge sort: elements that compare equal keep their order.
+ * It sorts runs of a few elements with insertion sort, skips merging halves
+ * that are already in order, and only ever needs room for half of the
+ * collection on the side.
+ * NOTE: less_than is always passed the element that currently comes later in
+ *       the collection first, which makes it easy to implement on top of a
+ *       three-way comparison that has to be called in order.
+ * The buffer overload lets callers provide the scratch space themselves, for
+ * when elements must not be stored just anywhere (e.g. GC-managed values).
+ */
+template<typename Collection, typename Buffer, typename LessThan>
+void merge_sort(Collection& collection, Buffer& buffer, LessThan less_than)
+{
+    if (collection.size() < 2)
+        return;
+    buffer.ensure_capacity(collection.size() / 2);
+    Detail::merge_sort_impl(collection, 0, collection.size(), buffer, less_than);
+}
+
+template<typename Collection, typename LessThan>
+void merge_sort(Collection& collection, LessThan less_than)
+{
+    Vector<RemoveCV<RemoveReference<decltype(collection[0])>>> buffer;
+    merge_sort(collection, buffer, move(less_than));
+}
+
+template<typename Collection>
+void merge_sort(Collection& collection)
+{
+    merge_sort(collection, [](auto& a, auto& b) { return a < b; });
+}
+
+}
+
+using AK::merge_sort;
@@ -7,13 +7,15 @@
 #pragma once
 
 #include <AK/StdLibExtras.h>
+#include <AK/Types.h>
 
 namespace AK {
 
 /* This is a dual pivot quick sort. It is quite a bit faster than the single
- * pivot quick_sort below. The other quick_sort below should only be used when
- * you are stuck with simple iterators to a container and you don't have access
- * to the container itself.
+ * pivot quick_sort below, but unlike pattern_defeating_quick_sort() it can
+ * still go quadratic on unlucky input. The other quick_sort below should only
+ * be used when you are stuck with simple iterators to a container and you
+ * don't have access to the container itself.
  */
 template<typename Collection, typename LessThan>
 void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_than)
@@ -89,6 +91,321 @@ void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_th
     }
 }
 
+namespace Detail {
+
+// Below this size, partitioning any further isn't worth it and insertion sort is faster.
+constexpr size_t pdq_insertion_sort_threshold = 24;
+// Above this size, the pivot is the median of three medians of three ("ninther"), rather than just one median of three.
+constexpr size_t pdq_ninther_threshold = 128;
+// How many elements partial_insertion_sort() may move before it gives up.
+constexpr size_t pdq_partial_insertion_sort_limit = 8;
+// How many elements are looked at in one go when partitioning.
+constexpr size_t pdq_block_size = 64;
+
+template<typename Collection, typename LessThan>
+void insertion_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    for (size_t i = begin + 1; i < end; ++i) {
+        for (size_t j = i; j > begin && less_than(col[j], col[j - 1]); --j)
+            swap(col[j], col[j - 1]);
+    }
+}
+
+// Like insertion_sort(), but gives up and returns false once more than a few elements had to be moved.
+template<typename Collection, typename LessThan>
+bool partial_insertion_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    if (end - begin < 2)
+        return true;
+
+    size_t moved = 0;
+    for (size_t i = begin + 1; i < end; ++i) {
+        size_t j = i;
+        for (; j > begin && less_than(col[j], col[j - 1]); --j)
+            swap(col[j], col[j - 1]);
+        moved += i - j;
+        if (moved > pdq_partial_insertion_sort_limit)
+            return false;
+    }
+    return true;
+}
+
+template<typename Collection, typename LessThan>
+void sift_down(Collection& col, size_t begin, size_t root, size_t size, LessThan& less_than)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= size)
+            return;
+        if (child + 1 < size && less_than(col[begin + child], col[begin + child + 1]))
+            ++child;
+        if (!less_than(col[begin + root], col[begin + child]))
+            return;
+        swap(col[begin + root], col[begin + child]);
+        root = child;
+    }
+}
+
+template<typename Collection, typename LessThan>
+void heap_sort(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t size = end - begin;
+    for (size_t i = size / 2; i-- > 0;)
+        sift_down(col, begin, i, size, less_than);
+    for (size_t i = size - 1; i > 0; --i) {
+        swap(col[begin], col[begin + i]);
+        sift_down(col, begin, 0, i, less_than);
+    }
+}
+
+// Puts the elements at a, b and c in order.
+template<typename Collection, typename LessThan>
+void sort3(Collection& col, size_t a, size_t b, size_t c, LessThan& less_than)
+{
+    if (less_than(col[b], col[a]))
+        swap(col[a], col[b]);
+    if (less_than(col[c], col[b]))
+        swap(col[b], col[c]);
+    if (less_than(col[b], col[a]))
+        swap(col[a], col[b]);
+}
+
+struct PartitionResult {
+    size_t pivot;
+    bool was_already_partitioned;
+};
+
+// Partitions [begin, end) around the pivot at begin. Elements equal to the pivot end up on its right.
+// NOTE: This expects an element that isn't less than the pivot at end - 1, which picking the pivot takes care of.
+//
+// Rather than branching on every comparison, this collects the positions of misplaced elements on both
+// sides a block at a time, and only then swaps them, as described in "BlockQuicksort: How Branch
+// Mispredictions don't affect Quicksort" by Stefan Edelkamp and Armin Weiss.
+template<typename Collection, typename LessThan>
+PartitionResult partition_right(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t first = begin;
+    size_t last = end;
+
+    // The pivot stays where it is until the very end, so this is safe to use all along.
+    auto&& pivot = col[begin];
+
+    while (less_than(col[++first], pivot)) {
+    }
+
+    // If nothing before first was less than the pivot, there's no sentinel stopping us from running off the start.
+    if (first - 1 == begin) {
+        while (first < last && !less_than(col[--last], pivot)) {
+        }
+    } else {
+        while (!less_than(col[--last], pivot)) {
+        }
+    }
+
+    bool was_already_partitioned = first >= last;
+    if (!was_already_partitioned) {
+        swap(col[first], col[last]);
+        ++first;
+
+        u8 offsets_left[pdq_block_size];
+        u8 offsets_right[pdq_block_size];
+        size_t offsets_left_base = first;
+        size_t offsets_right_base = last;
+        size_t left_count = 0;
+        size_t right_count = 0;
+        size_t left_start = 0;
+        size_t right_start = 0;
+
+        while (first < last) {
+            // Only refill the blocks that ran empty, splitting what's left between them if they both did.
+            size_t unknown_count = last - first;
+            size_t left_split = left_count == 0 ? (right_count == 0 ? unknown_count / 2 : unknown_count) : 0;
+            size_t right_split = right_count == 0 ? (unknown_count - left_split) : 0;
+
+            size_t left_limit = min(left_split, pdq_block_size);
+            for (size_t i = 0; i < left_limit; ++i) {
+                offsets_left[left_count] = i;
+                left_count += !less_than(col[first], pivot);
+                ++first;
+            }
+            size_t right_limit = min(right_split, pdq_block_size);
+            for (size_t i = 0; i < right_limit;) {
+                offsets_right[right_count] = ++i;
+                right_count += less_than(col[--last], pivot);
+            }
+
+            size_t count = min(left_count, right_count);
+            for (size_t i = 0; i < count; ++i)
+                swap(col[offsets_left_base + offsets_left[left_start + i]], col[offsets_right_base - offsets_right[right_start + i]]);
+
+            left_count -= count;
+            right_count -= count;
+            left_start += count;
+            right_start += count;
+            if (left_count == 0) {
+                left_start = 0;
+                offsets_left_base = first;
+            }
+            if (right_count == 0) {
+                right_start = 0;
+                offsets_right_base = last;
+            }
+        }
+
+        // One of the blocks may still have misplaced elements, which go to the far end of their side.
+        if (left_count) {
+            while (left_count--)
+                swap(col[offsets_left_base + offsets_left[left_start + left_count]], col[--last]);
+            first = last;
+        }
+        if (right_count) {
+            while (right_count--)
+                swap(col[offsets_right_base - offsets_right[right_start + right_count]], col[first++]);
+        }
+    }
+
+    size_t pivot_position = first - 1;
+    swap(col[begin], col[pivot_position]);
+    return { pivot_position, was_already_partitioned };
+}
+
+// Partitions [begin, end) around the pivot at begin, but puts elements equal to the pivot on its left.
+// This is used when the pivot is equal to the element right before begin, which means everything equal
+// to it is already in its final place, so only the elements greater than it have to be sorted any further.
+template<typename Collection, typename LessThan>
+size_t partition_left(Collection& col, size_t begin, size_t end, LessThan& less_than)
+{
+    size_t first = begin;
+    size_t last = end;
+
+    auto&& pivot = col[begin];
+
+    while (less_than(pivot, col[--last])) {
+    }
+
+    if (last + 1 == end) {
+        while (first < last && !less_than(pivot, col[++first])) {
+        }
+    } else {
+        while (!less_than(pivot, col[++first])) {
+        }
+    }
+
+    while (first < last) {
+        swap(col[first], col[last]);
+        while (less_than(pivot, col[--last])) {
+        }
+        while (!less_than(pivot, col[++first])) {
+        }
+    }
+
+    swap(col[begin], col[last]);
+    return last;
+}
+
+template<typename Collection, typename LessThan>
+void pattern_defeating_quick_sort_impl(Collection& col, size_t begin, size_t end, LessThan& less_than, size_t bad_partitions_allowed, bool is_leftmost)
+{
+    for (;;) {
+        size_t size = end - begin;
+        if (size < pdq_insertion_sort_threshold) {
+            insertion_sort(col, begin, end, less_than);
+            return;
+        }
+
+        size_t half = size / 2;
+        if (size > pdq_ninther_threshold) {
+            sort3(col, begin, begin + half, end - 1, less_than);
+            sort3(col, begin + 1, begin + half - 1, end - 2, less_than);
+            sort3(col, begin + 2, begin + half + 1, end - 3, less_than);
+            sort3(col, begin + half - 1, begin + half, begin + half + 1, less_than);
+            swap(col[begin], col[begin + half]);
+        } else {
+            sort3(col, begin + half, begin, end - 1, less_than);
+        }
+
+        // If the element before us is equal to the pivot, we're in a run of equal elements.
+        // Everything equal to the pivot can be put in its final place right away, which keeps
+        // inputs with lots of duplicates from going quadratic.
+        if (!is_leftmost && !less_than(col[begin - 1], col[begin])) {
+            begin = partition_left(col, begin, end, less_than) + 1;
+            continue;
+        }
+
+        auto result = partition_right(col, begin, end, less_than);
+        size_t pivot = result.pivot;
+        size_t left_size = pivot - begin;
+        size_t right_size = end - (pivot + 1);
+
+        bool is_highly_unbalanced = left_size < size / 8 || right_size < size / 8;
+        if (is_highly_unbalanced) {
+            // Too many bad pivots, someone may be feeding us adversarial input. Heap sort is never quadratic.
+            if (--bad_partitions_allowed == 0) {
+                heap_sort(col, begin, end, less_than);
+                return;
+            }
+
+            // Shuffle some elements around to break up whatever pattern made us pick a bad pivot.
+            if (left_size >= pdq_insertion_sort_threshold) {
+                swap(col[begin], col[begin + left_size / 4]);
+                swap(col[pivot - 1], col[pivot - left_size / 4]);
+                if (left_size > pdq_ninther_threshold) {
+                    swap(col[begin + 1], col[begin + left_size / 4 + 1]);
+                    swap(col[begin + 2], col[begin + left_size / 4 + 2]);
+                    swap(col[pivot - 2], col[pivot - left_size / 4 - 1]);
+                    swap(col[pivot - 3], col[pivot - left_size / 4 - 2]);
+                }
+            }
+            if (right_size >= pdq_insertion_sort_threshold) {
+                swap(col[pivot + 1], col[pivot + 1 + right_size / 4]);
+                swap(col[end - 1], col[end - right_size / 4]);
+                if (right_size > pdq_ninther_threshold) {
+                    swap(col[pivot + 2], col[pivot + 2 + right_size / 4]);
+                    swap(col[pivot + 3], col[pivot + 3 + right_size / 4]);
+                    swap(col[end - 2], col[end - 1 - right_size / 4]);
+                    swap(col[end - 3], col[end - 2 - right_size / 4]);
+                }
+            }
+        } else if (result.was_already_partitioned) {
+            // A good pivot that didn't have to move anything hints at (almost) sorted input, so try finishing up cheaply.
+            if (partial_insertion_sort(col, begin, pivot, less_than) && partial_insertion_sort(col, pivot + 1, end, less_than))
+                return;
+        }
+
+        // Recur into the smaller part to keep the stack depth logarithmic.
+        if (left_size < right_size) {
+            pattern_defeating_quick_sort_impl(col, begin, pivot, less_than, bad_partitions_allowed, is_leftmost);
+            begin = pivot + 1;
+            is_leftmost = false;
+        } else {
+            pattern_defeating_quick_sort_impl(col, pivot + 1, end, less_than, bad_partitions_allowed, false);
+            end = pivot;
+        }
+    }
+}
+
+}
+
+/* This is a pattern-defeating quick sort (pdqsort), as described by Orson Peters.
+ * It's an introsort: a quick sort that switches to insertion sort for small
+ * partitions, and to heap sort when it keeps picking bad pivots, so it is
+ * O(n log n) even on adversarial input. On top of that, it finishes (almost)
+ * sorted input in linear time and handles runs of equal elements well.
+ * It sorts the half-open range [start, end) of the collection, and only ever
+ * swaps elements, so it also works with proxy types like the ones qsort() uses.
+ * NOTE: This sort is not stable, use merge_sort() from AK/MergeSort.h if you need that.
+ */
+template<typename Collection, typename LessThan>
+void pattern_defeating_quick_sort(Collection& col, size_t start, size_t end, LessThan less_than)
+{
+    if (end - start < 2)
+        return;
+    size_t bad_partitions_allowed = 1;
+    for (size_t size = end - start; size > 1; size >>= 1)
+        ++bad_partitions_allowed;
+    Detail::pattern_defeating_quick_sort_impl(col, start, end, less_than, bad_partitions_allowed, true);
+}
+
 template<typename Iterator, typename LessThan>
 void single_pivot_quick_sort(Iterator start, Iterator end, LessThan less_than)
 {
@@ -139,13 +456,13 @@ void quick_sort(Iterator start, Iterator end, LessThan less_than)
 template<typename Collection, typename LessThan>
 void quick_sort(Collection& collection, LessThan less_than)
 {
-    dual_pivot_quick_sort(collection, 0, collection.size() - 1, move(less_than));
+    pattern_defeating_quick_sort(collection, 0, collection.size(), move(less_than));
 }
 
 template<typename Collection>
 void quick_sort(Collection& collection)
 {
-    dual_pivot_quick_sort(collection, 0, collection.size() - 1,
+    pattern_defeating_quick_sort(collection, 0, collection.size(),
         [](auto& a, auto& b) { return a < b; });
 }
 
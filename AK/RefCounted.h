@@ -39,61 +39,118 @@ constexpr auto call_one_ref_left_if_present(...) -> FalseType
     return {};
 }
 
+// Objects that never leave the thread they were created on don't have to pay for a locked instruction
+// every time they're referenced, so they can opt out of keeping their ref count atomic.
+enum class RefCountPolicy {
+    Atomic,
+    NonAtomic,
+};
+
+namespace Detail {
+
+template<RefCountPolicy>
+class RefCount;
+
+template<>
+class RefCount<RefCountPolicy::Atomic> {
+public:
+    using ValueType = unsigned int;
+
+    ALWAYS_INLINE ValueType increment() { return m_value.fetch_add(1, AK::MemoryOrder::memory_order_relaxed); }
+    ALWAYS_INLINE ValueType decrement() { return m_value.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel); }
+    ALWAYS_INLINE ValueType load() const { return m_value.load(AK::MemoryOrder::memory_order_relaxed); }
+    ALWAYS_INLINE bool compare_exchange(ValueType& expected, ValueType desired)
+    {
+        return m_value.compare_exchange_strong(expected, desired, AK::MemoryOrder::memory_order_acquire);
+    }
+
+private:
+    Atomic<ValueType> m_value { 1 };
+};
+
+template<>
+class RefCount<RefCountPolicy::NonAtomic> {
+public:
+    using ValueType = unsigned int;
+
+    ALWAYS_INLINE ValueType increment() { return m_value++; }
+    ALWAYS_INLINE ValueType decrement() { return m_value--; }
+    ALWAYS_INLINE ValueType load() const { return m_value; }
+    ALWAYS_INLINE bool compare_exchange(ValueType& expected, ValueType desired)
+    {
+        if (m_value != expected) {
+            expected = m_value;
+            return false;
+        }
+        m_value = desired;
+        return true;
+    }
+
+private:
+    ValueType m_value { 1 };
+};
+
+}
+
+template<RefCountPolicy policy = RefCountPolicy::Atomic>
 class RefCountedBase {
     AK_MAKE_NONCOPYABLE(RefCountedBase);
     AK_MAKE_NONMOVABLE(RefCountedBase);
 
 public:
-    using RefCountType = unsigned int;
+    using RefCountType = typename Detail::RefCount<policy>::ValueType;
     using AllowOwnPtr = FalseType;
 
     void ref() const
     {
-        auto old_ref_count = m_ref_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        auto old_ref_count = m_ref_count.increment();
         VERIFY(old_ref_count > 0);
         VERIFY(!Checked<RefCountType>::addition_would_overflow(old_ref_count, 1));
     }
 
     [[nodiscard]] bool try_ref() const
     {
-        RefCountType expected = m_ref_count.load(AK::MemoryOrder::memory_order_relaxed);
+        RefCountType expected = m_ref_count.load();
         for (;;) {
             if (expected == 0)
                 return false;
             VERIFY(!Checked<RefCountType>::addition_would_overflow(expected, 1));
-            if (m_ref_count.compare_exchange_strong(expected, expected + 1, AK::MemoryOrder::memory_order_acquire))
+            if (m_ref_count.compare_exchange(expected, expected + 1))
                 return true;
         }
     }
 
     [[nodiscard]] RefCountType ref_count() const
     {
-        return m_ref_count.load(AK::MemoryOrder::memory_order_relaxed);
+        return m_ref_count.load();
     }
 
 protected:
     RefCountedBase() = default;
     ~RefCountedBase()
     {
-        VERIFY(m_ref_count.load(AK::MemoryOrder::memory_order_relaxed) == 0);
+        VERIFY(m_ref_count.load() == 0);
     }
 
     RefCountType deref_base() const
     {
-        auto old_ref_count = m_ref_count.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel);
+        auto old_ref_count = m_ref_count.decrement();
         VERIFY(old_ref_count > 0);
         return old_ref_count - 1;
     }
 
-    mutable Atomic<RefCountType> m_ref_count { 1 };
+    mutable Detail::RefCount<policy> m_ref_count;
 };
 
 template<typename T>
-class RefCounted : public RefCountedBase {
+inline constexpr bool IsRefCounted = IsBaseOf<RefCountedBase<RefCountPolicy::Atomic>, T> || IsBaseOf<RefCountedBase<RefCountPolicy::NonAtomic>, T>;
+
+template<typename T, RefCountPolicy policy = RefCountPolicy::Atomic>
+class RefCounted : public RefCountedBase<policy> {
 public:
     bool unref() const
     {
-        auto new_ref_count = deref_base();
+        auto new_ref_count = this->deref_base();
         if (new_ref_count == 0) {
             call_will_be_destroyed_if_present(static_cast<const T*>(this));
             delete static_cast<const T*>(this);
@@ -107,4 +164,6 @@ public:
 
 }
 
+using AK::IsRefCounted;
 using AK::RefCounted;
+using AK::RefCountPolicy;
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// A fixed-size ring buffer for handing values from exactly one producer thread to exactly one consumer thread.
+// Neither side ever takes a lock or waits for the other; enqueueing into a full ring or dequeueing from an
+// empty one just fails, and it's up to the caller to decide whether to retry, drop or go to sleep.
+template<typename T, size_t Capacity>
+class SPSCRing {
+    AK_MAKE_NONCOPYABLE(SPSCRing);
+    AK_MAKE_NONMOVABLE(SPSCRing);
+
+    static_assert(Capacity >= 2 && !(Capacity & (Capacity - 1)), "SPSCRing capacity must be a power of two");
+
+public:
+    SPSCRing() = default;
+
+    ~SPSCRing()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    // Producer side.
+    [[nodiscard]] bool try_enqueue(T&& value)
+    {
+        auto tail = m_tail.load(AK::MemoryOrder::memory_order_relaxed);
+        if (tail - m_cached_head == Capacity) {
+            m_cached_head = m_head.load(AK::MemoryOrder::memory_order_acquire);
+            if (tail - m_cached_head == Capacity)
+                return false;
+        }
+        new (slot(tail)) T(move(value));
+        m_tail.store(tail + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool try_enqueue(const T& value)
+    {
+        T copy = value;
+        return try_enqueue(move(copy));
+    }
+
+    // Consumer side.
+    [[nodiscard]] Optional<T> try_dequeue()
+    {
+        auto head = m_head.load(AK::MemoryOrder::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(AK::MemoryOrder::memory_order_acquire);
+            if (head == m_cached_tail)
+                return {};
+        }
+        auto* element = slot(head);
+        Optional<T> value = move(*element);
+        element->~T();
+        m_head.store(head + 1, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // NOTE: These are only a snapshot, the other side may have moved on by the time they return.
+    size_t size() const { return m_tail.load(AK::MemoryOrder::memory_order_acquire) - m_head.load(AK::MemoryOrder::memory_order_acquire); }
+    bool is_empty() const { return size() == 0; }
+    bool is_full() const { return size() >= Capacity; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    T* slot(size_t index) { return reinterpret_cast<T*>(&m_storage[(index & (Capacity - 1)) * sizeof(T)]); }
+
+    // The two sides each get (at least) a cache line of their own, along with their view of the other side's position,
+    // so they only ever touch each other's line when the ring looks full or empty.
+    // NOTE: This pads instead of using alignas(), since we don't have an over-aligned operator new.
+    Atomic<size_t> m_head { 0 };
+    size_t m_cached_tail { 0 };
+    [[maybe_unused]] u8 m_padding_after_head[64];
+    Atomic<size_t> m_tail { 0 };
+    size_t m_cached_head { 0 };
+    [[maybe_unused]] u8 m_padding_after_tail[64];
+    alignas(T) u8 m_storage[Capacity * sizeof(T)];
+};
+
+}
+
+using AK::SPSCRing;
@@ -435,6 +435,9 @@ inline constexpr bool IsTrivial = __is_trivial(T);
 template<typename T>
 inline constexpr bool IsTriviallyCopyable = __is_trivially_copyable(T);
 
+template<typename T>
+inline constexpr bool IsTriviallyDestructible = __has_trivial_destructor(T);
+
 template<typename T>
 auto declval() -> T;
 
@@ -469,6 +472,7 @@ using AK::Detail::IsSame;
 using AK::Detail::IsSigned;
 using AK::Detail::IsTrivial;
 using AK::Detail::IsTriviallyCopyable;
+using AK::Detail::IsTriviallyDestructible;
 using AK::Detail::IsUnion;
 using AK::Detail::IsUnsigned;
 using AK::Detail::IsVoid;
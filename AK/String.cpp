@@ -17,7 +17,7 @@ namespace AK {
 
 bool String::operator==(const FlyString& fly_string) const
 {
-    return *this == String(fly_string.impl());
+    return fly_string == *this;
 }
 
 bool String::operator==(const String& other) const
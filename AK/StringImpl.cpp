@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/FlyString.h>
 #include <AK/HashTable.h>
 #include <AK/Memory.h>
@@ -25,6 +26,26 @@ StringImpl& StringImpl::the_empty_stringimpl()
     return *s_the_empty_stringimpl;
 }
 
+// Single characters are so common (think tokenizers and separators) that every one of them gets a shared StringImpl.
+// NOTE: These get created lazily, possibly by several threads at once, so they're only published once they're complete.
+static Atomic<StringImpl*> s_single_character_stringimpls[256];
+
+StringImpl& StringImpl::the_single_character_stringimpl(char ch)
+{
+    auto& slot = s_single_character_stringimpls[static_cast<u8>(ch)];
+    if (auto* stringimpl = slot.load(AK::MemoryOrder::memory_order_acquire))
+        return *stringimpl;
+
+    char* buffer;
+    auto new_stringimpl = create_uninitialized(1, buffer);
+    buffer[0] = ch;
+    StringImpl* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, new_stringimpl.ptr(), AK::MemoryOrder::memory_order_acq_rel))
+        return new_stringimpl.leak_ref();
+    // Someone else got there first, so ours goes away and we use theirs.
+    return *expected;
+}
+
 StringImpl::StringImpl(ConstructWithInlineBufferTag, size_t length)
     : m_length(length)
 {
@@ -69,6 +90,8 @@ RefPtr<StringImpl> StringImpl::create(const char* cstring, size_t length, Should
 
     if (!length)
         return the_empty_stringimpl();
+    if (length == 1)
+        return the_single_character_stringimpl(cstring[0]);
 
     char* buffer;
     auto new_stringimpl = create_uninitialized(length, buffer);
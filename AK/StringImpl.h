@@ -35,6 +35,7 @@ public:
     }
 
     static StringImpl& the_empty_stringimpl();
+    static StringImpl& the_single_character_stringimpl(char);
 
     ~StringImpl();
 
@@ -53,8 +54,12 @@ public:
 
     bool operator==(const StringImpl& other) const
     {
+        if (this == &other)
+            return true;
         if (length() != other.length())
             return false;
+        if (m_has_hash && other.m_has_hash && m_hash != other.m_hash)
+            return false;
         return !__builtin_memcmp(characters(), other.characters(), length());
     }
 
@@ -8,6 +8,7 @@
 #include <AK/Assertions.h>
 #include <AK/Format.h>
 #include <AK/Utf8View.h>
+#include <AK/Vector.h>
 
 namespace AK {
 
@@ -90,6 +91,14 @@ Utf8View Utf8View::unicode_substring_view(size_t code_point_offset, size_t code_
     VERIFY_NOT_REACHED();
 }
 
+// Checks 8 bytes at once, which is most of the work for text that's mostly ASCII.
+ALWAYS_INLINE static bool is_ascii_word(const unsigned char* ptr)
+{
+    u64 word;
+    __builtin_memcpy(&word, ptr, sizeof(word));
+    return !(word & 0x8080808080808080ull);
+}
+
 static inline bool decode_first_byte(
     unsigned char byte,
     size_t& out_code_point_length_in_bytes,
@@ -125,7 +134,15 @@ static inline bool decode_first_byte(
 bool Utf8View::validate(size_t& valid_bytes) const
 {
     valid_bytes = 0;
-    for (auto ptr = begin_ptr(); ptr < end_ptr(); ptr++) {
+    auto* ptr = begin_ptr();
+    auto* end = end_ptr();
+    while (ptr < end) {
+        if (end - ptr >= 8 && is_ascii_word(ptr)) {
+            ptr += 8;
+            valid_bytes += 8;
+            continue;
+        }
+
         size_t code_point_length_in_bytes;
         u32 value;
         bool first_byte_makes_sense = decode_first_byte(*ptr, code_point_length_in_bytes, value);
@@ -133,13 +150,13 @@ bool Utf8View::validate(size_t& valid_bytes) const
             return false;
 
         for (size_t i = 1; i < code_point_length_in_bytes; i++) {
-            ptr++;
-            if (ptr >= end_ptr())
+            if (ptr + i >= end)
                 return false;
-            if (*ptr >> 6 != 2)
+            if (ptr[i] >> 6 != 2)
                 return false;
         }
 
+        ptr += code_point_length_in_bytes;
         valid_bytes += code_point_length_in_bytes;
     }
 
@@ -149,12 +166,65 @@ bool Utf8View::validate(size_t& valid_bytes) const
 size_t Utf8View::calculate_length() const
 {
     size_t length = 0;
-    for ([[maybe_unused]] auto code_point : *this) {
+    auto iterator = begin();
+    while (!iterator.done()) {
+        if (iterator.m_length >= 8 && is_ascii_word(iterator.m_ptr)) {
+            iterator.m_ptr += 8;
+            iterator.m_length -= 8;
+            length += 8;
+            continue;
+        }
+        ++iterator;
         ++length;
     }
     return length;
 }
 
+void Utf8View::append_code_points_to(Vector<u32>& code_points) const
+{
+    // There can't be more code points than bytes.
+    code_points.ensure_capacity(code_points.size() + byte_length());
+    auto iterator = begin();
+    while (!iterator.done()) {
+        if (iterator.m_length >= 8 && is_ascii_word(iterator.m_ptr)) {
+            for (size_t i = 0; i < 8; ++i)
+                code_points.unchecked_append(iterator.m_ptr[i]);
+            iterator.m_ptr += 8;
+            iterator.m_length -= 8;
+            continue;
+        }
+        code_points.unchecked_append(*iterator);
+        ++iterator;
+    }
+}
+
+void Utf8View::append_utf16_code_units_to(Vector<u16>& code_units) const
+{
+    // Only 4-byte sequences turn into surrogate pairs, so there can't be more code units than bytes either.
+    code_units.ensure_capacity(code_units.size() + byte_length());
+    auto iterator = begin();
+    while (!iterator.done()) {
+        if (iterator.m_length >= 8 && is_ascii_word(iterator.m_ptr)) {
+            for (size_t i = 0; i < 8; ++i)
+                code_units.unchecked_append(iterator.m_ptr[i]);
+            iterator.m_ptr += 8;
+            iterator.m_length -= 8;
+            continue;
+        }
+        u32 code_point = *iterator;
+        ++iterator;
+        if (code_point > 0x10ffff)
+            code_point = 0xfffd;
+        if (code_point < 0x10000) {
+            code_units.unchecked_append(code_point);
+            continue;
+        }
+        code_point -= 0x10000;
+        code_units.unchecked_append(0xd800 | (code_point >> 10));
+        code_units.unchecked_append(0xdc00 | (code_point & 0x3ff));
+    }
+}
+
 bool Utf8View::starts_with(const Utf8View& start) const
 {
     if (start.is_empty())
@@ -189,7 +259,7 @@ bool Utf8CodePointIterator::operator!=(const Utf8CodePointIterator& other) const
     return !(*this == other);
 }
 
-Utf8CodePointIterator& Utf8CodePointIterator::operator++()
+void Utf8CodePointIterator::skip_non_ascii_code_point()
 {
     VERIFY(m_length > 0);
 
@@ -200,12 +270,11 @@ Utf8CodePointIterator& Utf8CodePointIterator::operator++()
         dbgln("Expected code point size {} is too big for the remaining length {}. Moving forward one byte.", code_point_length_in_bytes, m_length);
         m_ptr += 1;
         m_length -= 1;
-        return *this;
+        return;
     }
 
     m_ptr += code_point_length_in_bytes;
     m_length -= code_point_length_in_bytes;
-    return *this;
 }
 
 size_t Utf8CodePointIterator::underlying_code_point_length_in_bytes() const
@@ -235,7 +304,7 @@ ReadonlyBytes Utf8CodePointIterator::underlying_code_point_bytes() const
     return { m_ptr, underlying_code_point_length_in_bytes() };
 }
 
-u32 Utf8CodePointIterator::operator*() const
+u32 Utf8CodePointIterator::decode_non_ascii_code_point() const
 {
     VERIFY(m_length > 0);
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Forward.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 
@@ -23,8 +24,26 @@ public:
 
     bool operator==(const Utf8CodePointIterator&) const;
     bool operator!=(const Utf8CodePointIterator&) const;
-    Utf8CodePointIterator& operator++();
-    u32 operator*() const;
+
+    // ASCII is by far the most common case, so it doesn't need a call into the decoder.
+    Utf8CodePointIterator& operator++()
+    {
+        if (m_length > 0 && *m_ptr < 0x80) {
+            ++m_ptr;
+            --m_length;
+            return *this;
+        }
+        skip_non_ascii_code_point();
+        return *this;
+    }
+
+    u32 operator*() const
+    {
+        if (m_length > 0 && *m_ptr < 0x80)
+            return *m_ptr;
+        return decode_non_ascii_code_point();
+    }
+
     // NOTE: This returns {} if the peek is at or past EOF.
     Optional<u32> peek(size_t offset = 0) const;
 
@@ -44,6 +63,9 @@ public:
 
 private:
     Utf8CodePointIterator(const unsigned char*, size_t);
+    void skip_non_ascii_code_point();
+    u32 decode_non_ascii_code_point() const;
+
     const unsigned char* m_ptr { nullptr };
     size_t m_length;
 };
@@ -81,6 +103,11 @@ public:
         return byte_offset_of(it);
     }
 
+    // These decode the whole view at once, which is a lot faster than going through the iterator for mostly-ASCII text.
+    // Invalid sequences turn into U+FFFD, just like they do when iterating.
+    void append_code_points_to(Vector<u32>&) const;
+    void append_utf16_code_units_to(Vector<u16>&) const;
+
     bool validate(size_t& valid_bytes) const;
     bool validate() const
     {
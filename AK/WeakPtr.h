@@ -179,7 +179,7 @@ template<typename T>
 template<typename U>
 inline WeakPtr<U> Weakable<T>::make_weak_ptr() const
 {
-    if constexpr (IsBaseOf<RefCountedBase, T>) {
+    if constexpr (IsRefCounted<T>) {
         // Checking m_being_destroyed isn't sufficient when dealing with
         // a RefCounted type.The reference count will drop to 0 before the
         // destructor is invoked and revoke_weak_ptrs is called. So, try
@@ -203,7 +203,7 @@ inline WeakPtr<U> Weakable<T>::make_weak_ptr() const
 
     WeakPtr<U> weak_ptr(m_link);
 
-    if constexpr (IsBaseOf<RefCountedBase, T>) {
+    if constexpr (IsRefCounted<T>) {
         // Now drop the reference we temporarily added
         if (static_cast<const T*>(this)->unref()) {
             // We just dropped the last reference, which should have called
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// io_ring_create() returns a file descriptor for a pair of rings that live in memory shared with the kernel.
+// Map it with mmap(nullptr, io_ring_mapping_size(entries), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0).
+// The mapping starts with an IORingHeader, the offsets in it lead to the rings themselves.
+//
+// To submit, fill in the submission at index (tail & mask) and then bump the submission tail.
+// io_ring_enter() starts everything between the head and the tail, and moves the head along.
+// Completions are written at index (tail & mask) of the completion ring, and userspace
+// moves the completion head along after consuming them.
+
+enum class IORingOpcode : u8 {
+    Nop = 0,
+    Read,
+    Write,
+    Accept,
+    Recv,
+    Send,
+    Fsync,
+};
+
+struct [[gnu::packed]] IORingSubmission {
+    IORingOpcode opcode;
+    u8 reserved[3];
+    i32 fd;
+    // For Read and Write, an offset of -1 uses (and advances) the file offset, like read() and write().
+    i64 offset;
+    // For Accept, this is where the peer address goes, with length being the size of that buffer.
+    u64 buffer;
+    u32 length;
+    // For Recv and Send, these are the usual MSG_* flags. For Accept, SOCK_NONBLOCK and SOCK_CLOEXEC.
+    u32 flags;
+    u64 user_data;
+};
+static_assert(sizeof(IORingSubmission) == 40);
+
+struct [[gnu::packed]] IORingCompletion {
+    u64 user_data;
+    // The return value of the operation, a negative errno on failure.
+    i32 result;
+    u32 reserved;
+};
+static_assert(sizeof(IORingCompletion) == 16);
+
+struct [[gnu::packed]] IORingQueueHeader {
+    u32 head;
+    u32 tail;
+    u32 mask;
+    u32 entries_offset;
+};
+
+struct [[gnu::packed]] IORingHeader {
+    IORingQueueHeader submissions;
+    IORingQueueHeader completions;
+};
+
+// The completion ring has twice as many entries as the submission ring.
+constexpr size_t io_ring_completion_entries(size_t entries) { return 2 * entries; }
+
+constexpr size_t io_ring_mapping_size(size_t entries)
+{
+    size_t size = sizeof(IORingHeader) + entries * sizeof(IORingSubmission) + io_ring_completion_entries(entries) * sizeof(IORingCompletion);
+    return (size + 4095) & ~(size_t)4095;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// /proc/all_binary has the same information as /proc/all, in a form that's much cheaper to produce and to parse.
+//
+// It starts with a ProcessStatisticsHeader, followed by process_count processes.
+// Every process is a ProcessStatisticsEntry, followed by its strings in the order of their
+// *_length fields (without null terminators), followed by thread_count threads.
+// Every thread is a ThreadStatisticsEntry, followed by its strings in the same manner.
+
+constexpr u32 PROCESS_STATISTICS_MAGIC = 0x50535441; // "PSTA"
+constexpr u32 PROCESS_STATISTICS_VERSION = 1;
+
+struct [[gnu::packed]] ProcessStatisticsHeader {
+    u32 magic;
+    u32 version;
+    u32 process_count;
+};
+
+struct [[gnu::packed]] ProcessStatisticsEntry {
+    i32 pid;
+    i32 pgid;
+    i32 pgp;
+    i32 sid;
+    u32 uid;
+    u32 gid;
+    i32 ppid;
+    u32 nfds;
+    u8 kernel;
+    u8 dumpable;
+    u16 reserved;
+    u64 amount_virtual;
+    u64 amount_resident;
+    u64 amount_shared;
+    u64 amount_dirty_private;
+    u64 amount_clean_inode;
+    u64 amount_purgeable_volatile;
+    u64 amount_purgeable_nonvolatile;
+    u32 thread_count;
+    u32 name_length;
+    u32 executable_length;
+    u32 tty_length;
+    u32 pledge_length;
+    u32 veil_length;
+};
+
+struct [[gnu::packed]] ThreadStatisticsEntry {
+    i32 tid;
+    u32 times_scheduled;
+    u32 ticks_user;
+    u32 ticks_kernel;
+    u32 cpu;
+    u32 priority;
+    u32 cpu_affinity;
+    u32 syscall_count;
+    u32 inode_faults;
+    u32 zero_faults;
+    u32 cow_faults;
+    u32 file_read_bytes;
+    u32 file_write_bytes;
+    u32 unix_socket_read_bytes;
+    u32 unix_socket_write_bytes;
+    u32 ipv4_socket_read_bytes;
+    u32 ipv4_socket_write_bytes;
+    u32 state_length;
+    u32 name_length;
+};
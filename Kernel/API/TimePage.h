@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The kernel updates this page on every timer tick and maps it read-only into every process,
+// so that reading the coarse clocks doesn't have to go through a syscall.
+// Its address is passed to the program in the auxiliary vector, as AT_TIME_PAGE.
+//
+// The kernel bumps update1 before changing anything and sets update2 to the same value once it's done.
+// Readers have to read update2 first, then the clocks, then update1, and try again unless both were the same.
+
+struct TimePageClock {
+    i64 seconds;
+    u32 nanoseconds;
+};
+
+struct TimePage {
+    volatile u32 update1;
+    TimePageClock monotonic_coarse;
+    TimePageClock realtime_coarse;
+    // The kernel can tell the time more precisely than the coarse clocks (because it can read the HPET main counter),
+    // so anyone who wants CLOCK_MONOTONIC or CLOCK_MONOTONIC_RAW still has to ask it.
+    // NOTE: This doesn't change after boot.
+    u32 monotonic_is_more_precise_than_coarse;
+    volatile u32 update2;
+    // Which of the PERF_EVENT_USERSPACE_TRACEPOINTS should be recorded with perf_event(), because all processes are
+    // being profiled. It's left out of the update1/update2 dance, since it's read on its own.
+    volatile u32 tracepoint_event_mask;
+};
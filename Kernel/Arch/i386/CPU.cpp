@@ -26,6 +26,7 @@
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
+#include <Kernel/Tasklet.h>
 #include <Kernel/Thread.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
@@ -43,6 +44,8 @@ READONLY_AFTER_INIT static DescriptorTablePointer s_idtr;
 READONLY_AFTER_INIT static IDTEntry s_idt[256];
 
 static GenericInterruptHandler* s_interrupt_handler[GENERIC_INTERRUPT_HANDLERS_COUNT];
+// NOTE: This is recursive since turning a handler into a shared one registers handlers again.
+static RecursiveSpinLock s_interrupt_handlers_lock;
 
 static EntropySource s_entropy_source_interrupts { EntropySource::Static::Interrupts };
 
@@ -404,6 +407,7 @@ static void unimp_trap()
 
 GenericInterruptHandler& get_interrupt_handler(u8 interrupt_number)
 {
+    ScopedSpinLock lock(s_interrupt_handlers_lock);
     auto*& handler_slot = s_interrupt_handler[interrupt_number];
     VERIFY(handler_slot != nullptr);
     return *handler_slot;
@@ -418,6 +422,7 @@ static void revert_to_unused_handler(u8 interrupt_number)
 void register_generic_interrupt_handler(u8 interrupt_number, GenericInterruptHandler& handler)
 {
     VERIFY(interrupt_number < GENERIC_INTERRUPT_HANDLERS_COUNT);
+    ScopedSpinLock lock(s_interrupt_handlers_lock);
     auto*& handler_slot = s_interrupt_handler[interrupt_number];
     if (handler_slot != nullptr) {
         if (handler_slot->type() == HandlerType::UnhandledInterruptHandler) {
@@ -726,6 +731,7 @@ void handle_interrupt(TrapFrame* trap)
     VERIFY(regs.isr_number >= IRQ_VECTOR_BASE && regs.isr_number <= (IRQ_VECTOR_BASE + GENERIC_INTERRUPT_HANDLERS_COUNT));
     u8 irq = (u8)(regs.isr_number - 0x50);
     s_entropy_source_interrupts.add_random_event(irq);
+    PerformanceManager::add_irq_event(irq);
     auto* handler = s_interrupt_handler[irq];
     VERIFY(handler);
     handler->increment_invoking_counter();
@@ -816,6 +822,10 @@ FlatPtr read_cr3()
 
 void write_cr3(FlatPtr cr3)
 {
+    // Publish the new page directory before loading it, so that anyone changing
+    // its mappings from now on knows to send us a TLB shootdown.
+    if (Processor::is_initialized())
+        Processor::current().set_active_cr3(cr3);
     // NOTE: If you're here from a GPF crash, it's very likely that a PDPT entry is incorrect, not this!
 #if ARCH(I386)
     asm volatile("mov %%eax, %%cr3" ::"a"(cr3)
@@ -922,11 +932,15 @@ UNMAP_AFTER_INIT void write_xcr0(u64 value)
 }
 
 READONLY_AFTER_INIT FPUState Processor::s_clean_fpu_state;
+READONLY_AFTER_INIT bool Processor::s_kernel_can_use_sse2;
 
 READONLY_AFTER_INIT static ProcessorContainer s_processors {};
 READONLY_AFTER_INIT volatile u32 Processor::g_total_processors;
 static volatile bool s_smp_enabled;
 
+// Above this many pages, reloading CR3 beats invalidating pages one at a time.
+static constexpr size_t FLUSH_TLB_FULL_THRESHOLD = 32;
+
 ProcessorContainer& Processor::processors()
 {
     return s_processors;
@@ -1099,6 +1113,34 @@ UNMAP_AFTER_INIT void Processor::cpu_setup()
     }
 }
 
+bool Processor::try_enter_kernel_fpu_section(u32& prev_flags)
+{
+    if (!s_kernel_can_use_sse2 || !is_initialized())
+        return false;
+    auto& processor = current();
+    processor.enter_critical(prev_flags);
+    // NOTE: The current thread's FPU state only lives in the registers until we switch away from it,
+    //       and we can't switch away while we're in a critical section, so we can borrow its buffer.
+    auto* current_thread = processor.m_current_thread;
+    if (!current_thread || processor.m_in_kernel_fpu_section) {
+        processor.leave_critical(prev_flags);
+        return false;
+    }
+    processor.m_in_kernel_fpu_section = true;
+    asm volatile("fxsave %0"
+                 : "=m"(current_thread->fpu_state()));
+    return true;
+}
+
+void Processor::leave_kernel_fpu_section(u32 prev_flags)
+{
+    auto& processor = current();
+    VERIFY(processor.m_in_kernel_fpu_section);
+    asm volatile("fxrstor %0" ::"m"(processor.m_current_thread->fpu_state()));
+    processor.m_in_kernel_fpu_section = false;
+    processor.leave_critical(prev_flags);
+}
+
 String Processor::features_string() const
 {
     StringBuilder builder;
@@ -1183,6 +1225,7 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     m_cpu = cpu;
     m_in_irq = 0;
     m_in_critical = 0;
+    m_in_kernel_fpu_section = false;
 
     m_invoke_scheduler_async = false;
     m_scheduler_initialized = false;
@@ -1231,6 +1274,9 @@ UNMAP_AFTER_INIT void Processor::initialize(u32 cpu)
         asm volatile("fninit");
         asm volatile("fxsave %0"
                      : "=m"(s_clean_fpu_state));
+
+        // NOTE: We only save the state that fxsave knows about, so the kernel sticks to SSE2 even if there's AVX.
+        s_kernel_can_use_sse2 = has_feature(CPUFeature::SSE2);
     }
 
     m_info = new ProcessorInfo(*this);
@@ -1811,8 +1857,10 @@ void Processor::exit_trap(TrapFrame& trap)
 
     smp_process_pending_messages();
 
-    if (!m_in_irq && !m_in_critical)
+    if (!m_in_irq && !m_in_critical) {
+        Tasklet::run_scheduled_on_current_processor();
         check_invoke_scheduler();
+    }
 
     auto* current_thread = Processor::current_thread();
     if (current_thread) {
@@ -1844,6 +1892,12 @@ void Processor::check_invoke_scheduler()
 
 void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 {
+    if (page_count > FLUSH_TLB_FULL_THRESHOLD && is_user_address(vaddr)) {
+        // Invalidating this many pages one by one is slower than simply dropping
+        // every non-global (i.e. userspace) translation by reloading CR3.
+        write_cr3(read_cr3());
+        return;
+    }
     auto ptr = vaddr.as_ptr();
     while (page_count > 0) {
         // clang-format off
@@ -1859,12 +1913,42 @@ void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 
 void Processor::flush_tlb(const PageDirectory* page_directory, VirtualAddress vaddr, size_t page_count)
 {
-    if (s_smp_enabled && (!is_user_address(vaddr) || Process::current()->thread_count() > 1))
+    if (!s_smp_enabled) {
+        flush_tlb_local(vaddr, page_count);
+        return;
+    }
+    if (!is_user_address(vaddr)) {
+        // Kernel mappings are shared by every page directory.
         smp_broadcast_flush_tlb(page_directory, vaddr, page_count);
+        return;
+    }
+
+    // User mappings can only be cached by processors that currently have this
+    // page directory loaded, so those are the only ones we need to interrupt.
+    ScopedCritical critical;
+    u32 cpu_mask = processors_using_page_directory(*page_directory) & ~(1u << Processor::id());
+    if (cpu_mask)
+        smp_multicast_flush_tlb(cpu_mask, page_directory, vaddr, page_count);
     else
         flush_tlb_local(vaddr, page_count);
 }
 
+u32 Processor::processors_using_page_directory(const PageDirectory& page_directory)
+{
+    // Make sure the page table updates we're flushing for are visible before we
+    // look at which page directories are loaded. A processor switching to this
+    // page directory after this point will load the new translations anyway.
+    atomic_thread_fence(AK::MemoryOrder::memory_order_seq_cst);
+    auto cr3 = page_directory.cr3();
+    u32 cpu_mask = 0;
+    for_each(
+        [&](Processor& proc) {
+            if (proc.active_cr3() == cr3)
+                cpu_mask |= 1u << proc.get_id();
+        });
+    return cpu_mask;
+}
+
 static volatile ProcessorMessage* s_message_pool;
 
 void Processor::smp_return_to_pool(ProcessorMessage& msg)
@@ -2095,6 +2179,24 @@ void Processor::smp_broadcast_message(ProcessorMessage& msg)
         APIC::the().broadcast_ipi();
 }
 
+void Processor::smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg)
+{
+    auto& cur_proc = Processor::current();
+    VERIFY(!(cpu_mask & (1u << cur_proc.get_id())));
+    VERIFY(cpu_mask);
+
+    dbgln_if(SMP_DEBUG, "SMP[{}]: Multicast message {} to cpus: {:#x} proc: {}", cur_proc.get_id(), VirtualAddress(&msg), cpu_mask, VirtualAddress(&cur_proc));
+
+    atomic_store(&msg.refs, (u32)__builtin_popcount(cpu_mask), AK::MemoryOrder::memory_order_release);
+    for_each(
+        [&](Processor& proc) {
+            if (cpu_mask & (1u << proc.get_id())) {
+                if (proc.smp_queue_message(msg))
+                    APIC::the().send_ipi(proc.get_id());
+            }
+        });
+}
+
 void Processor::smp_broadcast_wait_sync(ProcessorMessage& msg)
 {
     auto& cur_proc = Processor::current();
@@ -2179,6 +2281,21 @@ void Processor::smp_broadcast_flush_tlb(const PageDirectory* page_directory, Vir
     smp_broadcast_wait_sync(msg);
 }
 
+void Processor::smp_multicast_flush_tlb(u32 cpu_mask, const PageDirectory* page_directory, VirtualAddress vaddr, size_t page_count)
+{
+    auto& msg = smp_get_from_pool();
+    msg.async = false;
+    msg.type = ProcessorMessage::FlushTlb;
+    msg.flush_tlb.page_directory = page_directory;
+    msg.flush_tlb.ptr = vaddr.as_ptr();
+    msg.flush_tlb.page_count = page_count;
+    smp_multicast_message(cpu_mask, msg);
+    // While the other processors handle this request, we'll flush ours
+    flush_tlb_local(vaddr, page_count);
+    // Now wait until everybody is done as well
+    smp_broadcast_wait_sync(msg);
+}
+
 void Processor::smp_broadcast_halt()
 {
     // We don't want to use a message, because this could have been triggered
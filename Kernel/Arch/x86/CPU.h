@@ -121,6 +121,7 @@ public:
         UserSupervisor = 1 << 2,
         WriteThrough = 1 << 3,
         CacheDisabled = 1 << 4,
+        Accessed = 1 << 5,
         Global = 1 << 8,
         NoExecute = 0x8000000000000000ULL,
     };
@@ -140,6 +141,9 @@ public:
     bool is_cache_disabled() const { return raw() & CacheDisabled; }
     void set_cache_disabled(bool b) { set_bit(CacheDisabled, b); }
 
+    bool is_accessed() const { return raw() & Accessed; }
+    void set_accessed(bool b) { set_bit(Accessed, b); }
+
     bool is_global() const { return raw() & Global; }
     void set_global(bool b) { set_bit(Global, b); }
 
@@ -653,8 +657,15 @@ class Processor {
     Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_in_critical;
     static Atomic<u32> s_idle_cpu_mask;
 
+    // The page directory currently loaded on this processor. Without PCIDs,
+    // loading CR3 drops all non-global TLB entries, so this is the only user
+    // address space that this processor may have cached translations for.
+    Atomic<FlatPtr> m_active_cr3 { 0 };
+
     TSS m_tss;
     static FPUState s_clean_fpu_state;
+    static bool s_kernel_can_use_sse2;
+    bool m_in_kernel_fpu_section;
     CPUFeature m_features;
     static volatile u32 g_total_processors; // atomic
     u8 m_physical_address_bit_width;
@@ -686,6 +697,7 @@ class Processor {
     bool smp_queue_message(ProcessorMessage& msg);
     static void smp_unicast_message(u32 cpu, ProcessorMessage& msg, bool async);
     static void smp_broadcast_message(ProcessorMessage& msg);
+    static void smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg);
     static void smp_broadcast_wait_sync(ProcessorMessage& msg);
     static void smp_broadcast_halt();
 
@@ -827,6 +839,12 @@ public:
         write_fs_u32(__builtin_offsetof(Processor, m_current_thread), FlatPtr(&current_thread));
     }
 
+    // NOTE: Unlike current_thread(), this can be asked about any processor, but it may be out of date by the time we look at it.
+    ALWAYS_INLINE Thread* last_known_current_thread() const
+    {
+        return AK::atomic_load(&m_current_thread, AK::memory_order_relaxed);
+    }
+
     ALWAYS_INLINE static Thread* idle_thread()
     {
         // See comment in Processor::current_thread
@@ -944,12 +962,24 @@ public:
         return s_clean_fpu_state;
     }
 
+    // The SSE registers hold the current thread's state while we're in the kernel. This stashes that state away,
+    // so the kernel can use them until leave_kernel_fpu_section(). Interrupts are disabled in the meantime, so
+    // only use this for short stretches of work that can't fault on user memory.
+    // Returns false if SSE2 can't be used right now, in which case the caller has to make do without.
+    static bool try_enter_kernel_fpu_section(u32& prev_flags);
+    static void leave_kernel_fpu_section(u32 prev_flags);
+
     static void smp_enable();
     bool smp_process_pending_messages();
 
     static void smp_broadcast(Function<void()>, bool async);
     static void smp_unicast(u32 cpu, Function<void()>, bool async);
     static void smp_broadcast_flush_tlb(const PageDirectory*, VirtualAddress, size_t);
+    static void smp_multicast_flush_tlb(u32 cpu_mask, const PageDirectory*, VirtualAddress, size_t);
+    static u32 processors_using_page_directory(const PageDirectory&);
+
+    ALWAYS_INLINE FlatPtr active_cr3() const { return m_active_cr3.load(AK::MemoryOrder::memory_order_acquire); }
+    ALWAYS_INLINE void set_active_cr3(FlatPtr cr3) { m_active_cr3.store(cr3, AK::MemoryOrder::memory_order_seq_cst); }
     static u32 smp_wake_n_idle_processors(u32 wake_count);
 
     static void deferred_call_queue(Function<void()> callback);
@@ -1024,6 +1054,29 @@ private:
     bool m_valid { false };
 };
 
+class ScopedKernelFPUSection {
+    AK_MAKE_NONCOPYABLE(ScopedKernelFPUSection);
+    AK_MAKE_NONMOVABLE(ScopedKernelFPUSection);
+
+public:
+    ScopedKernelFPUSection()
+    {
+        m_entered = Processor::try_enter_kernel_fpu_section(m_prev_flags);
+    }
+
+    ~ScopedKernelFPUSection()
+    {
+        if (m_entered)
+            Processor::leave_kernel_fpu_section(m_prev_flags);
+    }
+
+    bool is_entered() const { return m_entered; }
+
+private:
+    u32 m_prev_flags { 0 };
+    bool m_entered { false };
+};
+
 struct TrapFrame {
     u32 prev_irq_level;
     TrapFrame* next_trap;
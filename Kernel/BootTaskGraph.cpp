@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/BootTaskGraph.h>
+#include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT BootTaskGraph::BootTaskGraph(bool parallel)
+    : m_parallel(parallel)
+{
+}
+
+UNMAP_AFTER_INIT BootTaskGraph::TaskID BootTaskGraph::add(const char* name, Function<void()> function, Vector<TaskID> dependencies)
+{
+    TaskID id = m_tasks.size();
+    for (auto dependency : dependencies)
+        VERIFY(dependency < id);
+    auto task = make<Task>();
+    task->graph = this;
+    task->name = name;
+    task->function = move(function);
+    task->dependencies = move(dependencies);
+    m_tasks.append(move(task));
+    return id;
+}
+
+bool BootTaskGraph::dependencies_are_done(const Task& task) const
+{
+    VERIFY(m_lock.is_locked());
+    for (auto dependency : task.dependencies) {
+        if (!m_tasks[dependency].is_done)
+            return false;
+    }
+    return true;
+}
+
+UNMAP_AFTER_INIT void BootTaskGraph::run_task(Task& task)
+{
+    auto start_time = TimeManagement::the().uptime_ms();
+    task.function();
+    auto end_time = TimeManagement::the().uptime_ms();
+    dmesgln("Boot: {} took {} ms (done at {} ms)", task.name, end_time - start_time, end_time);
+}
+
+// NOTE: This isn't UNMAP_AFTER_INIT, since the thread may still be on its way out when run() returns.
+void BootTaskGraph::task_main(void* data)
+{
+    auto& task = *static_cast<Task*>(data);
+    auto& graph = *task.graph;
+
+    for (;;) {
+        {
+            ScopedSpinLock lock(graph.m_lock);
+            if (graph.dependencies_are_done(task))
+                break;
+        }
+        // NOTE: If a dependency finishes before we get to wait, the wake-up isn't lost, since we are the only waiter.
+        //       The queue remembers it, and this returns right away.
+        task.wait_queue.wait_forever(task.name);
+    }
+
+    graph.run_task(task);
+
+    ScopedSpinLock lock(graph.m_lock);
+    task.is_done = true;
+    TaskID id = &task - &graph.m_tasks[0];
+    for (auto& other_task : graph.m_tasks) {
+        if (!other_task.is_done && other_task.dependencies.contains_slow(id))
+            other_task.wait_queue.wake_all();
+    }
+    ++graph.m_done_count;
+    graph.m_all_done_wait_queue.wake_all();
+}
+
+UNMAP_AFTER_INIT void BootTaskGraph::run()
+{
+    if (!m_parallel) {
+        for (auto& task : m_tasks)
+            run_task(task);
+        return;
+    }
+
+    for (auto& task : m_tasks) {
+        auto thread = Process::current()->create_kernel_thread(task_main, &task, THREAD_PRIORITY_NORMAL, String::formatted("Boot: {}", task.name), THREAD_AFFINITY_DEFAULT, false);
+        VERIFY(thread);
+    }
+
+    for (;;) {
+        {
+            ScopedSpinLock lock(m_lock);
+            if (m_done_count == m_tasks.size())
+                break;
+        }
+        m_all_done_wait_queue.wait_forever("BootTaskGraph");
+    }
+}
+
+}
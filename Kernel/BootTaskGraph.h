@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// Runs the steps of bringing up the system, each in a kernel thread of its own.
+//
+// A task only starts once all the tasks it depends on are done, so anything that has to happen in order
+// (like finding the root filesystem before mounting it) is spelled out as a dependency, and everything
+// else is free to run at the same time. How long every task took goes to the kernel log.
+class BootTaskGraph {
+    AK_MAKE_NONCOPYABLE(BootTaskGraph);
+    AK_MAKE_NONMOVABLE(BootTaskGraph);
+
+public:
+    using TaskID = size_t;
+
+    // If not parallel, the tasks run one after another in the calling thread, in the order they were added.
+    explicit BootTaskGraph(bool parallel);
+
+    // NOTE: A task can only depend on tasks that were added before it, so there can't be any cycles.
+    TaskID add(const char* name, Function<void()>, Vector<TaskID> dependencies = {});
+
+    // Returns once every task is done.
+    void run();
+
+private:
+    struct Task {
+        BootTaskGraph* graph { nullptr };
+        const char* name { nullptr };
+        Function<void()> function;
+        Vector<TaskID> dependencies;
+        bool is_done { false };
+        // Only the task's own thread waits on this, for its dependencies.
+        WaitQueue wait_queue;
+    };
+
+    static void task_main(void*);
+    void run_task(Task&);
+    bool dependencies_are_done(const Task&) const;
+
+    NonnullOwnPtrVector<Task> m_tasks;
+    bool m_parallel { true };
+
+    SpinLock<u8> m_lock;
+    size_t m_done_count { 0 };
+    // Only the thread in run() waits on this.
+    WaitQueue m_all_done_wait_queue;
+};
+
+}
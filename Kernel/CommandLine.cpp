@@ -102,6 +102,11 @@ UNMAP_AFTER_INIT bool CommandLine::is_smp_enabled() const
     return lookup("smp"sv).value_or("off"sv) == "on"sv;
 }
 
+UNMAP_AFTER_INIT bool CommandLine::is_parallel_boot_enabled() const
+{
+    return lookup("parallel_boot"sv).value_or("on"sv) == "on"sv;
+}
+
 UNMAP_AFTER_INIT bool CommandLine::is_vmmouse_enabled() const
 {
     return lookup("vmmouse"sv).value_or("on") == "on"sv;
@@ -124,6 +129,11 @@ UNMAP_AFTER_INIT bool CommandLine::is_legacy_time_enabled() const
     return lookup("time"sv).value_or("modern"sv) == "legacy"sv;
 }
 
+UNMAP_AFTER_INIT bool CommandLine::is_tickless_idle_enabled() const
+{
+    return lookup("tickless"sv).value_or("off"sv) == "on"sv;
+}
+
 UNMAP_AFTER_INIT bool CommandLine::is_force_pio() const
 {
     return contains("force_pio"sv);
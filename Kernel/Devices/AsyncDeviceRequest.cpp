@@ -41,11 +41,14 @@ AsyncDeviceRequest::~AsyncDeviceRequest()
 
 void AsyncDeviceRequest::request_finished()
 {
+    will_finish(get_request_result());
+
     if (m_parent_request)
         m_parent_request->sub_request_finished(*this);
 
-    // Trigger processing the next request
-    m_device.process_next_queued_request({}, *this);
+    // Trigger processing the next request, unless some other request did our work and takes care of that.
+    if (!m_is_merged)
+        m_device.process_next_queued_request({}, *this);
 
     // Wake anyone who may be waiting
     m_queue.wake_all();
@@ -74,11 +77,11 @@ void AsyncDeviceRequest::add_sub_request(NonnullRefPtr<AsyncDeviceRequest> sub_r
     VERIFY(sub_request->m_parent_request == nullptr);
     sub_request->m_parent_request = this;
 
+    // NOTE: The sub-request isn't started here, it's up to the caller to submit it to its device afterwards.
+    //       That way, it can't complete before we know about it, and it waits its turn on the device.
     ScopedSpinLock lock(m_lock);
     VERIFY(!is_completed_result(m_result));
     m_sub_requests_pending.append(sub_request);
-    if (m_result == Started)
-        sub_request->do_start(move(lock));
 }
 
 void AsyncDeviceRequest::sub_request_finished(AsyncDeviceRequest& sub_request)
@@ -126,6 +129,15 @@ void AsyncDeviceRequest::sub_request_finished(AsyncDeviceRequest& sub_request)
         request_finished();
 }
 
+void AsyncDeviceRequest::mark_as_merged()
+{
+    ScopedSpinLock lock(m_lock);
+    VERIFY(m_result == Pending);
+    VERIFY(m_sub_requests_pending.is_empty());
+    m_result = Started;
+    m_is_merged = true;
+}
+
 void AsyncDeviceRequest::complete(RequestResult result)
 {
     VERIFY(result == Success || result == Failure || result == MemoryFault);
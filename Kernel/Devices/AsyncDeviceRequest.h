@@ -23,6 +23,7 @@ extern WorkQueue* g_io_work;
 class AsyncDeviceRequest : public RefCounted<AsyncDeviceRequest> {
     AK_MAKE_NONCOPYABLE(AsyncDeviceRequest);
     AK_MAKE_NONMOVABLE(AsyncDeviceRequest);
+    friend class Device;
 
 public:
     enum [[nodiscard]] RequestResult {
@@ -73,6 +74,10 @@ public:
 
     void complete(RequestResult result);
 
+    // Marks a waiting request as started without starting it, because another request does its work.
+    // That request is responsible for completing it, which then doesn't start anything new on the device.
+    void mark_as_merged();
+
     void set_private(void* priv)
     {
         VERIFY(!m_private || !priv);
@@ -121,6 +126,9 @@ protected:
 
     RequestResult get_request_result() const;
 
+    // Called once the request has its result, before anyone waiting for it is woken up.
+    virtual void will_finish(RequestResult) { }
+
 private:
     void sub_request_finished(AsyncDeviceRequest&);
     void request_finished();
@@ -141,7 +149,9 @@ private:
 
     AsyncDeviceRequest* m_parent_request { nullptr };
     RequestResult m_result { Pending };
+    bool m_is_merged { false };
     IntrusiveListNode<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>> m_list_node;
+    IntrusiveListNode<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>> m_device_list_node;
 
     typedef IntrusiveList<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>, &AsyncDeviceRequest::m_list_node> AsyncDeviceSubRequestList;
 
@@ -19,11 +19,67 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
 {
 }
 
+RefPtr<AsyncBlockDeviceRequest> AsyncBlockDeviceRequest::try_create_merged(Device& device, NonnullRefPtrVector<AsyncBlockDeviceRequest>&& requests)
+{
+    VERIFY(requests.size() > 1);
+    auto& first_request = requests.first();
+    u32 block_count = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        VERIFY(i == 0 || requests[i - 1].can_merge_with(requests[i]));
+        block_count += requests[i].block_count();
+    }
+
+    size_t size = block_count * first_request.m_block_device.block_size();
+    auto merge_buffer = KBuffer::try_create_with_size(size, Region::Access::Read | Region::Access::Write, "Merged Block Device Request", AllocationStrategy::AllocateNow);
+    if (!merge_buffer)
+        return {};
+    auto request = adopt_ref_if_nonnull(new AsyncBlockDeviceRequest(device, first_request.request_type(), first_request.block_index(), block_count, UserOrKernelBuffer::for_kernel_buffer(merge_buffer->data()), size));
+    if (!request)
+        return {};
+    for (auto& merged_request : requests)
+        merged_request.mark_as_merged();
+    request->m_merge_buffer = merge_buffer.release_nonnull();
+    request->m_merged_requests = move(requests);
+    return request;
+}
+
+bool AsyncBlockDeviceRequest::can_merge_with(const AsyncBlockDeviceRequest& next) const
+{
+    return m_request_type == next.m_request_type
+        && m_block_index + m_block_count == next.m_block_index
+        && m_buffer.is_kernel_buffer() && next.m_buffer.is_kernel_buffer();
+}
+
 void AsyncBlockDeviceRequest::start()
 {
+    if (m_request_type == Write) {
+        size_t offset = 0;
+        for (auto& merged_request : m_merged_requests) {
+            size_t size = merged_request.block_count() * m_block_device.block_size();
+            if (!merged_request.buffer().read(m_merge_buffer->data() + offset, size)) {
+                complete(MemoryFault);
+                return;
+            }
+            offset += size;
+        }
+    }
     m_block_device.start_request(*this);
 }
 
+void AsyncBlockDeviceRequest::will_finish(RequestResult result)
+{
+    size_t offset = 0;
+    for (auto& merged_request : m_merged_requests) {
+        size_t size = merged_request.block_count() * m_block_device.block_size();
+        auto merged_result = result;
+        if (m_request_type == Read && result == Success && !merged_request.buffer().write(m_merge_buffer->data() + offset, size))
+            merged_result = MemoryFault;
+        merged_request.complete(merged_result);
+        offset += size;
+    }
+    m_merged_requests.clear();
+}
+
 BlockDevice::~BlockDevice()
 {
 }
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <Kernel/Devices/Device.h>
+#include <Kernel/KBuffer.h>
 
 namespace Kernel {
 
@@ -21,6 +23,11 @@ public:
     AsyncBlockDeviceRequest(Device& block_device, RequestType request_type,
         u64 block_index, u32 block_count, const UserOrKernelBuffer& buffer, size_t buffer_size);
 
+    // Creates a request that does the work of several waiting requests for consecutive blocks at once.
+    // The data goes through a buffer of its own, so only requests with kernel buffers can be merged.
+    static RefPtr<AsyncBlockDeviceRequest> try_create_merged(Device&, NonnullRefPtrVector<AsyncBlockDeviceRequest>&&);
+    bool can_merge_with(const AsyncBlockDeviceRequest& next) const;
+
     RequestType request_type() const { return m_request_type; }
     u64 block_index() const { return m_block_index; }
     u32 block_count() const { return m_block_count; }
@@ -29,6 +36,7 @@ public:
     size_t buffer_size() const { return m_buffer_size; }
 
     virtual void start() override;
+    virtual void will_finish(RequestResult) override;
     virtual const char* name() const override
     {
         switch (m_request_type) {
@@ -48,6 +56,8 @@ private:
     const u32 m_block_count;
     UserOrKernelBuffer m_buffer;
     const size_t m_buffer_size;
+    OwnPtr<KBuffer> m_merge_buffer;
+    NonnullRefPtrVector<AsyncBlockDeviceRequest> m_merged_requests;
 };
 
 class BlockDevice : public Device {
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Devices/BlockRequestQueue.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+static constexpr Time READ_DEADLINE = Time::from_milliseconds(500);
+static constexpr Time WRITE_DEADLINE = Time::from_milliseconds(5000);
+static constexpr size_t BATCH_SIZE = 16;
+// How many read batches may go by while writes are waiting.
+static constexpr size_t MAX_WRITE_STARVED_COUNT = 2;
+
+void BlockRequestQueue::append(NonnullRefPtr<AsyncBlockDeviceRequest> request)
+{
+    bool is_read = request->request_type() == AsyncBlockDeviceRequest::Read;
+    auto& queue = is_read ? m_reads : m_writes;
+    auto deadline = TimeManagement::the().monotonic_time() + (is_read ? READ_DEADLINE : WRITE_DEADLINE);
+
+    // Keep the queue sorted by block index, behind any requests for the same block so those stay in order.
+    size_t index = queue.size();
+    while (index > 0 && queue[index - 1].request->block_index() > request->block_index())
+        --index;
+    queue.insert(index, Entry { move(request), deadline });
+}
+
+size_t BlockRequestQueue::index_of_next_request(const Vector<Entry>& queue) const
+{
+    VERIFY(!queue.is_empty());
+    for (size_t i = 0; i < queue.size(); ++i) {
+        if (queue[i].request->block_index() >= m_next_block_index)
+            return i;
+    }
+    // We've gone past the end, so start from the bottom again.
+    return 0;
+}
+
+void BlockRequestQueue::start_new_batch(const Time& now)
+{
+    bool should_write = m_reads.is_empty() || (!m_writes.is_empty() && m_write_starved_count >= MAX_WRITE_STARVED_COUNT);
+    if (should_write) {
+        m_batch_direction = Direction::Write;
+        m_write_starved_count = 0;
+    } else {
+        m_batch_direction = Direction::Read;
+        if (!m_writes.is_empty())
+            ++m_write_starved_count;
+    }
+    m_batch_remaining = BATCH_SIZE;
+
+    auto& queue = queue_for(m_batch_direction);
+    size_t oldest_index = 0;
+    for (size_t i = 1; i < queue.size(); ++i) {
+        if (queue[i].deadline < queue[oldest_index].deadline)
+            oldest_index = i;
+    }
+    if (queue[oldest_index].deadline <= now) {
+        ++m_stats.expired_request_count;
+        m_next_block_index = queue[oldest_index].request->block_index();
+    }
+}
+
+RefPtr<AsyncBlockDeviceRequest> BlockRequestQueue::take_next(Device& device, size_t max_merged_block_count)
+{
+    if (is_empty())
+        return {};
+
+    if (m_batch_remaining == 0 || queue_for(m_batch_direction).is_empty())
+        start_new_batch(TimeManagement::the().monotonic_time());
+
+    auto& queue = queue_for(m_batch_direction);
+    size_t index = index_of_next_request(queue);
+    --m_batch_remaining;
+
+    // Pick up everything that continues right where this request ends, as long as the driver can handle it in one go.
+    size_t count = 1;
+    u32 block_count = queue[index].request->block_count();
+    while (index + count < queue.size()) {
+        auto& next_request = *queue[index + count].request;
+        if (!queue[index + count - 1].request->can_merge_with(next_request) || block_count + next_request.block_count() > max_merged_block_count)
+            break;
+        block_count += next_request.block_count();
+        ++count;
+    }
+
+    RefPtr<AsyncBlockDeviceRequest> request;
+    if (count > 1) {
+        NonnullRefPtrVector<AsyncBlockDeviceRequest> merged_requests;
+        for (size_t i = 0; i < count; ++i)
+            merged_requests.append(queue[index + i].request);
+        request = AsyncBlockDeviceRequest::try_create_merged(device, move(merged_requests));
+        if (request) {
+            dbgln_if(BLOCK_REQUEST_QUEUE_DEBUG, "BlockRequestQueue: Merged {} requests into blocks {}-{}", count, request->block_index(), request->block_index() + request->block_count() - 1);
+            m_stats.merged_request_count += count;
+        } else {
+            // We couldn't get a buffer for the merged request, but the first one can still go on its own.
+            count = 1;
+        }
+    }
+    if (!request)
+        request = queue[index].request;
+
+    queue.remove(index, count);
+    m_next_block_index = request->block_index() + request->block_count();
+    ++m_stats.dispatched_request_count;
+    return request;
+}
+
+}
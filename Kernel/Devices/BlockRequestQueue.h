@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <Kernel/Devices/BlockDevice.h>
+
+namespace Kernel {
+
+// Holds the requests that are waiting for a block device, and decides in which order they're started.
+//
+// Reads and writes are kept apart, each sorted by block index. Requests are handed out in batches that
+// sweep upwards through one of them, so the device sees mostly ascending block indices. Reads are
+// preferred, since someone is usually waiting for them, but writes only get passed over so many times
+// in a row. Every request also has a deadline, and a batch starts at the oldest request once that passed.
+// Waiting requests for consecutive blocks are merged into a single larger request when they're started.
+//
+// NOTE: This doesn't have a lock of its own, the device calls into it with its requests lock held.
+class BlockRequestQueue {
+public:
+    struct Stats {
+        size_t dispatched_request_count { 0 };
+        size_t merged_request_count { 0 };
+        size_t expired_request_count { 0 };
+    };
+
+    BlockRequestQueue() = default;
+
+    bool is_empty() const { return m_reads.is_empty() && m_writes.is_empty(); }
+
+    void append(NonnullRefPtr<AsyncBlockDeviceRequest>);
+    RefPtr<AsyncBlockDeviceRequest> take_next(Device&, size_t max_merged_block_count);
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Entry {
+        NonnullRefPtr<AsyncBlockDeviceRequest> request;
+        Time deadline;
+    };
+
+    enum class Direction {
+        Read,
+        Write,
+    };
+
+    Vector<Entry>& queue_for(Direction direction) { return direction == Direction::Read ? m_reads : m_writes; }
+    void start_new_batch(const Time& now);
+    size_t index_of_next_request(const Vector<Entry>&) const;
+
+    Vector<Entry> m_reads;
+    Vector<Entry> m_writes;
+    Direction m_batch_direction { Direction::Read };
+    size_t m_batch_remaining { 0 };
+    size_t m_write_starved_count { 0 };
+    u64 m_next_block_index { 0 };
+    Stats m_stats;
+};
+
+}
@@ -7,11 +7,14 @@
 #include <AK/Singleton.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
+#include <Kernel/SpinLock.h>
 #include <LibC/errno_numbers.h>
 
 namespace Kernel {
 
 static AK::Singleton<HashMap<u32, Device*>> s_all_devices;
+// NOTE: Drivers get initialized in parallel at boot, so devices can come and go on several processors at once.
+static RecursiveSpinLock s_all_devices_lock;
 
 HashMap<u32, Device*>& Device::all_devices()
 {
@@ -20,12 +23,14 @@ HashMap<u32, Device*>& Device::all_devices()
 
 void Device::for_each(Function<void(Device&)> callback)
 {
+    ScopedSpinLock lock(s_all_devices_lock);
     for (auto& entry : all_devices())
         callback(*entry.value);
 }
 
 Device* Device::get_device(unsigned major, unsigned minor)
 {
+    ScopedSpinLock lock(s_all_devices_lock);
     auto it = all_devices().find(encoded_device(major, minor));
     if (it == all_devices().end())
         return nullptr;
@@ -37,6 +42,7 @@ Device::Device(unsigned major, unsigned minor)
     , m_minor(minor)
 {
     u32 device_id = encoded_device(major, minor);
+    ScopedSpinLock lock(s_all_devices_lock);
     auto it = all_devices().find(device_id);
     if (it != all_devices().end()) {
         dbgln("Already registered {},{}: {}", major, minor, it->value->class_name());
@@ -47,6 +53,7 @@ Device::Device(unsigned major, unsigned minor)
 
 Device::~Device()
 {
+    ScopedSpinLock lock(s_all_devices_lock);
     all_devices().remove(encoded_device(m_major, m_minor));
 }
 
@@ -60,15 +67,43 @@ String Device::absolute_path(const FileDescription&) const
     return absolute_path();
 }
 
+void Device::submit_request(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    ScopedSpinLock lock(m_requests_lock);
+    if (m_started_request_count < max_started_requests()) {
+        ++m_started_request_count;
+        m_started_requests.append(request);
+        request->do_start(move(lock));
+    } else {
+        queue_waiting_request(move(request));
+    }
+}
+
+void Device::queue_waiting_request(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    VERIFY(m_requests_lock.is_locked());
+    m_waiting_requests.append(request);
+}
+
+RefPtr<AsyncDeviceRequest> Device::take_next_waiting_request()
+{
+    VERIFY(m_requests_lock.is_locked());
+    return m_waiting_requests.take_first();
+}
+
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest& completed_request)
 {
     ScopedSpinLock lock(m_requests_lock);
-    VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
+    VERIFY(m_started_request_count > 0);
+    // NOTE: With more than one request in flight, they don't necessarily complete in the order they were started.
+    VERIFY(m_started_requests.contains(completed_request));
+    m_started_requests.remove(const_cast<AsyncDeviceRequest&>(completed_request));
+    --m_started_request_count;
+
+    if (auto next = take_next_waiting_request()) {
+        ++m_started_request_count;
+        m_started_requests.append(*next);
+        next->do_start(move(lock));
     }
 
     evaluate_block_conditions();
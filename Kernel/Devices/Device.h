@@ -48,23 +48,32 @@ public:
 
     void process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest&);
 
+    // How many requests the driver is able to work on at the same time.
+    virtual size_t max_started_requests() const { return 1; }
+
     template<typename AsyncRequestType, typename... Args>
     NonnullRefPtr<AsyncRequestType> make_request(Args&&... args)
     {
         auto request = adopt_ref(*new AsyncRequestType(*this, forward<Args>(args)...));
-        ScopedSpinLock lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
-        m_requests.append(request);
-        if (was_empty)
-            request->do_start(move(lock));
+        submit_request(request);
         return request;
     }
 
+    // Starts the request right away if the driver has room for it, otherwise it waits its turn.
+    void submit_request(NonnullRefPtr<AsyncDeviceRequest>);
+
 protected:
     Device(unsigned major, unsigned minor);
     void set_uid(uid_t uid) { m_uid = uid; }
     void set_gid(gid_t gid) { m_gid = gid; }
 
+    // Requests that can't be started right away are handed to queue_waiting_request(), and
+    // take_next_waiting_request() decides which one to start once the driver is ready for more.
+    // Both are called with the requests lock held. By default, requests are started in order.
+    virtual void queue_waiting_request(NonnullRefPtr<AsyncDeviceRequest>);
+    virtual RefPtr<AsyncDeviceRequest> take_next_waiting_request();
+    SpinLock<u8>& requests_lock() const { return m_requests_lock; }
+
     static HashMap<u32, Device*>& all_devices();
 
 private:
@@ -73,8 +82,10 @@ private:
     uid_t m_uid { 0 };
     gid_t m_gid { 0 };
 
-    SpinLock<u8> m_requests_lock;
-    DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_requests;
+    mutable SpinLock<u8> m_requests_lock;
+    IntrusiveList<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>, &AsyncDeviceRequest::m_device_list_node> m_started_requests;
+    IntrusiveList<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>, &AsyncDeviceRequest::m_device_list_node> m_waiting_requests;
+    size_t m_started_request_count { 0 };
 };
 
 }
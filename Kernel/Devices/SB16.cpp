@@ -13,6 +13,7 @@
 #include <Kernel/Thread.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
+#include <LibC/sys/ioctl_numbers.h>
 
 namespace Kernel {
 #define SB16_DEFAULT_IRQ 5
@@ -174,9 +175,9 @@ KResultOr<size_t> SB16::read(FileDescription&, u64, UserOrKernelBuffer&, size_t)
     return 0;
 }
 
-void SB16::dma_start(uint32_t length)
+void SB16::dma_start(uint32_t offset, uint32_t length)
 {
-    const auto addr = m_dma_region->physical_page(0)->paddr().get();
+    const auto addr = m_dma_region->physical_page(0)->paddr().get() + offset;
     const u8 channel = 5; // 16-bit samples use DMA channel 5 (on the master DMA controller)
     const u8 mode = 0x48;
 
@@ -189,14 +190,15 @@ void SB16::dma_start(uint32_t length)
     // Write the DMA mode for the transfer
     IO::out8(0xd6, (channel % 4) | mode);
 
-    // Write the offset of the buffer
-    u16 offset = (addr / 2) % 65536;
-    IO::out8(0xc4, (u8)offset);
-    IO::out8(0xc4, (u8)(offset >> 8));
+    // Write the offset of the buffer (in 16-bit words)
+    u16 word_offset = (addr / 2) % 65536;
+    IO::out8(0xc4, (u8)word_offset);
+    IO::out8(0xc4, (u8)(word_offset >> 8));
 
-    // Write the transfer length
-    IO::out8(0xc6, (u8)(length - 1));
-    IO::out8(0xc6, (u8)((length - 1) >> 8));
+    // Write the transfer length (in 16-bit words)
+    u16 word_count = length / 2 - 1;
+    IO::out8(0xc6, (u8)word_count);
+    IO::out8(0xc6, (u8)(word_count >> 8));
 
     // Write the buffer
     IO::out8(0x8b, addr >> 16);
@@ -205,6 +207,30 @@ void SB16::dma_start(uint32_t length)
     IO::out8(0xd4, (channel % 4));
 }
 
+void SB16::start_period(size_t index)
+{
+    VERIFY(m_lock.is_locked());
+    auto length = m_period_lengths[index];
+    dma_start(index * max_period_size, length);
+
+    // 16-bit single-cycle output.
+    // FIXME: Implement auto-initialized output.
+    u8 command = 0xb0;
+    u8 mode = (u8)SampleFormat::Signed | (u8)SampleFormat::Stereo;
+
+    u16 sample_count = length / sizeof(i16);
+    if (mode & (u8)SampleFormat::Stereo)
+        sample_count /= 2;
+
+    sample_count -= 1;
+
+    dsp_write(command);
+    dsp_write(mode);
+    dsp_write((u8)sample_count);
+    dsp_write((u8)(sample_count >> 8));
+    m_is_playing = true;
+}
+
 void SB16::handle_irq(const RegisterState&)
 {
     // Stop sound output ready for the next block.
@@ -214,13 +240,42 @@ void SB16::handle_irq(const RegisterState&)
     if (m_major_version >= 4)
         IO::in8(DSP_R_ACK); // 16 bit interrupt
 
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_is_playing) {
+            m_is_playing = false;
+            m_next_period = (m_next_period + 1) % period_count;
+            --m_queued_period_count;
+            // Keep the card busy with the period that is already waiting, so there's no gap while the writer catches up.
+            if (m_queued_period_count > 0)
+                start_period(m_next_period);
+        }
+    }
+
     m_irq_queue.wake_all();
 }
 
-void SB16::wait_for_irq()
+int SB16::ioctl(FileDescription&, unsigned request, FlatPtr arg)
 {
-    m_irq_queue.wait_forever("SB16");
-    disable_irq();
+    switch (request) {
+    case SOUNDCARD_IOCTL_GET_PERIOD_SIZE: {
+        auto* out = (size_t*)arg;
+        size_t value = m_period_size;
+        if (!copy_to_user(out, &value))
+            return -EFAULT;
+        return 0;
+    }
+    case SOUNDCARD_IOCTL_SET_PERIOD_SIZE: {
+        // Periods have to hold whole frames of 16-bit stereo samples.
+        if (arg < 64 || arg > max_period_size || arg % 4 != 0)
+            return -EINVAL;
+        ScopedSpinLock lock(m_lock);
+        m_period_size = arg;
+        return 0;
+    }
+    default:
+        return -EINVAL;
+    }
 }
 
 KResultOr<size_t> SB16::write(FileDescription&, u64, const UserOrKernelBuffer& data, size_t length)
@@ -239,40 +294,40 @@ KResultOr<size_t> SB16::write(FileDescription&, u64, const UserOrKernelBuffer& d
 
     dbgln_if(SB16_DEBUG, "SB16: Writing buffer of {} bytes", length);
 
-    VERIFY(length <= PAGE_SIZE);
-    const int BLOCK_SIZE = 32 * 1024;
-    if (length > BLOCK_SIZE) {
-        return ENOSPC;
+    // The data goes out in periods, each of which has to wait for a free half of the DMA buffer.
+    size_t nwritten = 0;
+    while (nwritten < length) {
+        size_t index;
+        size_t period_length;
+        for (;;) {
+            {
+                ScopedSpinLock lock(m_lock);
+                if (m_queued_period_count < period_count) {
+                    index = (m_next_period + m_queued_period_count) % period_count;
+                    period_length = min(length - nwritten, m_period_size);
+                    break;
+                }
+            }
+            // The IRQ handler wakes us up once the card is done with a period, and the wakeup sticks if it comes first.
+            m_irq_queue.wait_forever("SB16");
+        }
+
+        // Only this period has to be copied, and the card won't touch its half of the buffer until it's queued.
+        if (!data.read(m_dma_region->vaddr().offset(index * max_period_size).as_ptr(), nwritten, period_length))
+            return EFAULT;
+
+        ScopedSpinLock lock(m_lock);
+        m_period_lengths[index] = period_length;
+        ++m_queued_period_count;
+        if (!m_is_playing) {
+            const int sample_rate = 44100;
+            set_sample_rate(sample_rate);
+            enable_irq();
+            start_period(index);
+        }
+        nwritten += period_length;
     }
-
-    u8 mode = (u8)SampleFormat::Signed | (u8)SampleFormat::Stereo;
-
-    const int sample_rate = 44100;
-    set_sample_rate(sample_rate);
-    if (!data.read(m_dma_region->vaddr().as_ptr(), length))
-        return EFAULT;
-    dma_start(length);
-
-    // 16-bit single-cycle output.
-    // FIXME: Implement auto-initialized output.
-    u8 command = 0xb0;
-
-    u16 sample_count = length / sizeof(i16);
-    if (mode & (u8)SampleFormat::Stereo)
-        sample_count /= 2;
-
-    sample_count -= 1;
-
-    cli();
-    enable_irq();
-
-    dsp_write(command);
-    dsp_write(mode);
-    dsp_write((u8)sample_count);
-    dsp_write((u8)(sample_count >> 8));
-
-    wait_for_irq();
-    return length;
+    return nwritten;
 }
 
 }
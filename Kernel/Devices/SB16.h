@@ -9,6 +9,7 @@
 #include <Kernel/Devices/CharacterDevice.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/PhysicalAddress.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/WaitQueue.h>
 
@@ -31,6 +32,7 @@ public:
     virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override;
     virtual bool can_write(const FileDescription&, size_t) const override { return true; }
+    virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg) override;
 
     virtual const char* purpose() const override { return class_name(); }
 
@@ -46,8 +48,8 @@ private:
     virtual const char* class_name() const override { return "SB16"; }
 
     void initialize();
-    void wait_for_irq();
-    void dma_start(uint32_t length);
+    void dma_start(uint32_t offset, uint32_t length);
+    void start_period(size_t index);
     void set_sample_rate(uint16_t hz);
     void dsp_write(u8 value);
     static u8 dsp_read();
@@ -55,9 +57,23 @@ private:
     void set_irq_register(u8 irq_number);
     void set_irq_line(u8 irq_number);
 
+    // Output is double-buffered: while the card plays one period out of one half of the DMA buffer, the next one
+    // waits in the other half, and the interrupt for the end of the first one starts the second one right away.
+    // A write only blocks while both halves are taken, so the writer wakes up as soon as there's room for a period.
+    static constexpr size_t period_count = 2;
+    static constexpr size_t max_period_size = PAGE_SIZE / period_count;
+
     OwnPtr<Region> m_dma_region;
     int m_major_version { 0 };
 
+    size_t m_period_size { max_period_size };
+    // Guards the state of the periods, which the IRQ handler changes as well.
+    SpinLock<u8> m_lock;
+    size_t m_period_lengths[period_count] {};
+    size_t m_next_period { 0 };
+    size_t m_queued_period_count { 0 };
+    bool m_is_playing { false };
+
     WaitQueue m_irq_queue;
 };
 }
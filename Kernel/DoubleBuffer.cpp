@@ -16,11 +16,13 @@ inline void DoubleBuffer::compute_lockfree_metadata()
     m_space_for_writing = m_capacity - m_write_buffer->size;
 }
 
-DoubleBuffer::DoubleBuffer(size_t capacity)
+DoubleBuffer::DoubleBuffer(size_t capacity, size_t max_capacity)
     : m_write_buffer(&m_buffer1)
     , m_read_buffer(&m_buffer2)
     , m_storage(KBuffer::create_with_size(capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer"))
     , m_capacity(capacity)
+    , m_initial_capacity(capacity)
+    , m_max_capacity(max(capacity, max_capacity))
 {
     m_buffer1.data = m_storage.data();
     m_buffer1.size = 0;
@@ -29,6 +31,55 @@ DoubleBuffer::DoubleBuffer(size_t capacity)
     m_space_for_writing = capacity;
 }
 
+void DoubleBuffer::use_storage(KBuffer&& storage, size_t capacity)
+{
+    // Everything that hasn't been read yet becomes the new write buffer, so it's read (in order) after the next flip.
+    size_t unread_size = m_read_buffer->size - m_read_buffer_index;
+    size_t pending_size = unread_size + m_write_buffer->size;
+    VERIFY(pending_size <= capacity);
+    memcpy(storage.data(), m_read_buffer->data + m_read_buffer_index, unread_size);
+    memcpy(storage.data() + unread_size, m_write_buffer->data, m_write_buffer->size);
+
+    m_storage = move(storage);
+    m_capacity = capacity;
+    m_write_buffer = &m_buffer1;
+    m_read_buffer = &m_buffer2;
+    m_buffer1.data = m_storage.data();
+    m_buffer1.size = pending_size;
+    m_buffer2.data = m_storage.data() + capacity;
+    m_buffer2.size = 0;
+    m_read_buffer_index = 0;
+    compute_lockfree_metadata();
+}
+
+void DoubleBuffer::grow_to_fit(size_t size)
+{
+    VERIFY(m_lock.is_locked());
+    size_t pending_size = m_read_buffer->size - m_read_buffer_index + m_write_buffer->size;
+    size_t new_capacity = m_capacity;
+    while (new_capacity < m_max_capacity && new_capacity < pending_size + size)
+        new_capacity = min(new_capacity * 2, m_max_capacity);
+    // Growing only makes sense if there's more room for writing afterwards.
+    if (new_capacity <= pending_size || new_capacity - pending_size <= m_space_for_writing)
+        return;
+
+    auto storage = KBufferImpl::try_create_with_size(new_capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer");
+    if (!storage)
+        return;
+    use_storage(KBuffer(move(storage)), new_capacity);
+}
+
+void DoubleBuffer::shrink_if_empty()
+{
+    VERIFY(m_lock.is_locked());
+    if (!m_empty || m_capacity == m_initial_capacity)
+        return;
+    auto storage = KBufferImpl::try_create_with_size(m_initial_capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer");
+    if (!storage)
+        return;
+    use_storage(KBuffer(move(storage)), m_initial_capacity);
+}
+
 void DoubleBuffer::flip()
 {
     if (m_storage.is_null())
@@ -45,6 +96,8 @@ ssize_t DoubleBuffer::write(const UserOrKernelBuffer& data, size_t size)
     if (!size || m_storage.is_null())
         return 0;
     Locker locker(m_lock);
+    if (size > m_space_for_writing && m_capacity < m_max_capacity)
+        grow_to_fit(size);
     size_t bytes_to_write = min(size, m_space_for_writing);
     u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
     if (!data.read(write_ptr, bytes_to_write))
@@ -70,6 +123,7 @@ ssize_t DoubleBuffer::read(UserOrKernelBuffer& data, size_t size)
         return -EFAULT;
     m_read_buffer_index += nread;
     compute_lockfree_metadata();
+    shrink_if_empty();
     if (m_unblock_callback && m_space_for_writing > 0)
         m_unblock_callback();
     return (ssize_t)nread;
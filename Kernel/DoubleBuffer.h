@@ -14,9 +14,15 @@
 
 namespace Kernel {
 
+// NOTE: If it's given a maximum capacity, the buffer grows (up to that) whenever a write doesn't fit,
+//       so big writes go through in one piece. It goes back to its initial capacity once it's drained.
 class DoubleBuffer {
 public:
-    explicit DoubleBuffer(size_t capacity = 65536);
+    explicit DoubleBuffer(size_t capacity = 65536)
+        : DoubleBuffer(capacity, capacity)
+    {
+    }
+    DoubleBuffer(size_t capacity, size_t max_capacity);
 
     [[nodiscard]] ssize_t write(const UserOrKernelBuffer&, size_t);
     [[nodiscard]] ssize_t write(const u8* data, size_t size)
@@ -49,6 +55,9 @@ public:
 private:
     void flip();
     void compute_lockfree_metadata();
+    void grow_to_fit(size_t size);
+    void shrink_if_empty();
+    void use_storage(KBuffer&&, size_t capacity);
 
     struct InnerBuffer {
         u8* data { nullptr };
@@ -63,6 +72,8 @@ private:
     KBuffer m_storage;
     Function<void()> m_unblock_callback;
     size_t m_capacity { 0 };
+    size_t m_initial_capacity { 0 };
+    size_t m_max_capacity { 0 };
     size_t m_read_buffer_index { 0 };
     size_t m_space_for_writing { 0 };
     bool m_empty { true };
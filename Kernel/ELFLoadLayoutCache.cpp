@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/Debug.h>
+#include <Kernel/ELFLoadLayoutCache.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/Region.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
+#include <LibELF/Image.h>
+
+namespace Kernel {
+
+static AK::Singleton<ELFLoadLayoutCache> s_the;
+
+static constexpr size_t MAXIMUM_ELF_LOAD_LAYOUT_CACHE_ENTRIES = 64;
+
+ELFLoadLayoutCache& ELFLoadLayoutCache::the()
+{
+    return *s_the;
+}
+
+ELFLoadLayoutCache::ELFLoadLayoutCache()
+{
+}
+
+KResultOr<NonnullRefPtr<ELFLoadLayout>> ELFLoadLayoutCache::create_layout(Inode& inode)
+{
+    auto vmobject = SharedInodeVMObject::create_with_inode(inode);
+    size_t executable_size = inode.size();
+
+    auto region = MM.allocate_kernel_region_with_vmobject(*vmobject, page_round_up(executable_size), "ELF load layout", Region::Access::Read);
+    if (!region) {
+        dbgln("Could not allocate memory for ELF");
+        return ENOMEM;
+    }
+
+    auto elf_image = ELF::Image(region->vaddr().as_ptr(), executable_size);
+    if (!elf_image.is_valid())
+        return ENOEXEC;
+
+    auto layout = adopt_ref_if_nonnull(new ELFLoadLayout);
+    if (!layout)
+        return ENOMEM;
+    if (elf_image.is_dynamic())
+        layout->type = ET_DYN;
+    else if (elf_image.is_executable())
+        layout->type = ET_EXEC;
+    else if (elf_image.is_relocatable())
+        layout->type = ET_REL;
+    layout->entry = elf_image.entry();
+
+    KResult result = KSuccess;
+    elf_image.for_each_program_header([&](const ELF::Image::ProgramHeader& program_header) {
+        if (program_header.type() != PT_LOAD && program_header.type() != PT_TLS)
+            return IterationDecision::Continue;
+
+        // Anything we copy rather than map has to be within the file.
+        if (program_header.type() == PT_TLS || program_header.is_writable()) {
+            if (!elf_image.is_within_image(program_header.raw_data(), program_header.size_in_image())) {
+                dbgln("Shenanigans! ELF {} header sneaks outside of executable.", program_header.type() == PT_TLS ? "PT_TLS" : "writable PT_LOAD");
+                result = ENOEXEC;
+                return IterationDecision::Break;
+            }
+        }
+
+        layout->segments.append({
+            program_header.type(),
+            program_header.vaddr(),
+            program_header.size_in_memory(),
+            program_header.size_in_image(),
+            program_header.offset(),
+            program_header.alignment(),
+            program_header.is_readable(),
+            program_header.is_writable(),
+            program_header.is_executable(),
+        });
+
+        if (program_header.type() == PT_LOAD) {
+            auto segment_start = program_header.vaddr().get();
+            auto segment_end = segment_start + program_header.size_in_memory();
+            if (layout->load_range_start == 0 || segment_start < layout->load_range_start)
+                layout->load_range_start = segment_start;
+            if (layout->load_range_end == 0 || segment_end > layout->load_range_end)
+                layout->load_range_end = segment_end;
+        }
+        return IterationDecision::Continue;
+    });
+
+    if (result.is_error())
+        return result;
+    return layout.release_nonnull();
+}
+
+KResultOr<NonnullRefPtr<ELFLoadLayout>> ELFLoadLayoutCache::layout_for(Inode& inode)
+{
+    auto identifier = inode.identifier();
+    auto metadata = inode.metadata();
+    u64 generation;
+    {
+        Locker locker(m_lock);
+        auto it = m_entries.find(identifier);
+        if (it != m_entries.end()) {
+            if (it->value.mtime == metadata.mtime && it->value.size == metadata.size) {
+                dbgln_if(EXEC_DEBUG, "ELFLoadLayoutCache: Hit for {}", identifier);
+                return it->value.layout;
+            }
+            m_entries.remove(it);
+        }
+        generation = m_generation;
+    }
+
+    auto layout_or_error = create_layout(inode);
+    if (layout_or_error.is_error())
+        return layout_or_error.error();
+    auto layout = layout_or_error.release_value();
+
+    Locker locker(m_lock);
+    // If the file changed while we were looking at it, this layout may already be stale.
+    if (generation != m_generation)
+        return layout;
+    if (m_entries.size() >= MAXIMUM_ELF_LOAD_LAYOUT_CACHE_ENTRIES)
+        m_entries.remove(m_entries.begin());
+    m_entries.set(identifier, { metadata.mtime, metadata.size, layout });
+    return layout;
+}
+
+void ELFLoadLayoutCache::invalidate(InodeIdentifier identifier)
+{
+    Locker locker(m_lock);
+    ++m_generation;
+    m_entries.remove(identifier);
+}
+
+}
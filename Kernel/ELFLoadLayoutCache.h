@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Lock.h>
+#include <Kernel/VirtualAddress.h>
+#include <LibC/elf.h>
+
+namespace Kernel {
+
+class Inode;
+
+// Everything execve() needs to know about an ELF object to map it, already validated.
+// NOTE: The segments are in program header order, and only PT_LOAD and PT_TLS ones are kept.
+struct ELFLoadLayout : public RefCounted<ELFLoadLayout> {
+    struct Segment {
+        u32 type { PT_NULL };
+        VirtualAddress vaddr;
+        size_t size_in_memory { 0 };
+        size_t size_in_image { 0 };
+        size_t offset { 0 };
+        size_t alignment { 0 };
+        bool is_readable { false };
+        bool is_writable { false };
+        bool is_executable { false };
+    };
+
+    Elf32_Half type { ET_NONE };
+    VirtualAddress entry;
+    // The range covered by all PT_LOAD segments, before relocation.
+    FlatPtr load_range_start { 0 };
+    FlatPtr load_range_end { 0 };
+    Vector<Segment> segments;
+};
+
+// Remembers the load layouts of recently executed programs and their interpreter, so that starting
+// one again doesn't have to map the whole file into the kernel and parse its headers all over again.
+// An entry is dropped as soon as the file is written to or deleted.
+class ELFLoadLayoutCache {
+public:
+    static ELFLoadLayoutCache& the();
+
+    ELFLoadLayoutCache();
+
+    KResultOr<NonnullRefPtr<ELFLoadLayout>> layout_for(Inode&);
+    void invalidate(InodeIdentifier);
+
+private:
+    struct Entry {
+        time_t mtime { 0 };
+        off_t size { 0 };
+        NonnullRefPtr<ELFLoadLayout> layout;
+    };
+
+    static KResultOr<NonnullRefPtr<ELFLoadLayout>> create_layout(Inode&);
+
+    Lock m_lock { "ELFLoadLayoutCache" };
+    HashMap<InodeIdentifier, Entry> m_entries;
+    // Bumped on every invalidation, so a layout that was read while the file changed doesn't get cached.
+    u64 m_generation { 0 };
+};
+
+}
@@ -5,9 +5,11 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
 
 namespace Kernel {
 
@@ -16,14 +18,26 @@ struct CacheEntry {
     BlockBasedFS::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    bool is_dirty { false };
 };
 
+// Once this many entries are dirty, we ask the SyncTask to start writing them back.
+static constexpr size_t WRITEBACK_SOFT_THRESHOLD_DIVISOR = 8;
+// Once this many entries are dirty, writers have to write them back themselves before they may dirty any more.
+static constexpr size_t WRITEBACK_HARD_THRESHOLD_DIVISOR = 2;
+// Runs of adjacent dirty blocks are written back with a single write of up to this size.
+static constexpr size_t WRITEBACK_BUFFER_SIZE = 64 * KiB;
+// Runs of adjacent uncached blocks are read in with a single read of up to this size.
+static constexpr size_t READ_BUFFER_SIZE = 64 * KiB;
+
 class DiskCache {
 public:
     explicit DiskCache(BlockBasedFS& fs)
         : m_fs(fs)
         , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
         , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
+        , m_writeback_buffer(KBuffer::create_with_size(max(WRITEBACK_BUFFER_SIZE, m_fs.block_size())))
+        , m_read_buffer(KBuffer::create_with_size(max(READ_BUFFER_SIZE, m_fs.block_size())))
     {
         for (size_t i = 0; i < m_entry_count; ++i) {
             entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
@@ -36,21 +50,38 @@ public:
     bool is_dirty() const { return m_dirty; }
     void set_dirty(bool b) { m_dirty = b; }
 
+    size_t dirty_count() const { return m_dirty_count; }
+    bool is_above_soft_writeback_threshold() const { return m_dirty_count >= m_entry_count / WRITEBACK_SOFT_THRESHOLD_DIVISOR; }
+    bool is_above_hard_writeback_threshold() const { return m_dirty_count >= m_entry_count / WRITEBACK_HARD_THRESHOLD_DIVISOR; }
+
+    bool is_writeback_requested() const { return m_writeback_requested; }
+    void set_writeback_requested(bool b) { m_writeback_requested = b; }
+
     void mark_all_clean()
     {
-        while (auto* entry = m_dirty_list.first())
+        while (auto* entry = m_dirty_list.first()) {
+            entry->is_dirty = false;
             m_clean_list.prepend(*entry);
+        }
         m_dirty = false;
+        m_dirty_count = 0;
+        m_writeback_requested = false;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
+        if (!entry.is_dirty)
+            ++m_dirty_count;
+        entry.is_dirty = true;
         m_dirty_list.prepend(entry);
         m_dirty = true;
     }
 
     void mark_clean(CacheEntry& entry)
     {
+        if (entry.is_dirty)
+            --m_dirty_count;
+        entry.is_dirty = false;
         m_clean_list.prepend(entry);
     }
 
@@ -59,8 +90,13 @@ public:
         if (auto it = m_hash.find(block_index); it != m_hash.end()) {
             auto& entry = const_cast<CacheEntry&>(*it->value);
             VERIFY(entry.block_index == block_index);
+            // Keep the lists in LRU order, so eviction always picks the least recently used clean entry.
+            if (!entry.is_dirty)
+                m_clean_list.prepend(entry);
+            ++m_stats.hits;
             return entry;
         }
+        ++m_stats.misses;
 
         if (m_clean_list.is_empty()) {
             // Not a single clean entry! Flush writes and try again.
@@ -74,7 +110,11 @@ public:
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        // NOTE: Entries that were never used still claim block 0, make sure we don't unhash the real one.
+        if (auto it = m_hash.find(new_entry.block_index); it != m_hash.end() && it->value == &new_entry) {
+            m_hash.remove(it);
+            ++m_stats.evictions;
+        }
         m_hash.set(block_index, &new_entry);
 
         new_entry.block_index = block_index;
@@ -93,6 +133,71 @@ public:
             callback(entry);
     }
 
+    // Writes the given entries back to disk, in block order, coalescing runs of adjacent blocks into single writes.
+    // NOTE: This doesn't mark the entries clean, since callers may be iterating the dirty list.
+    size_t write_back(Vector<CacheEntry*, 32>& entries)
+    {
+        quick_sort(entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+
+        auto block_size = m_fs.block_size();
+        auto max_blocks_per_write = m_writeback_buffer.size() / block_size;
+        size_t write_count = 0;
+        for (size_t i = 0; i < entries.size();) {
+            size_t run_length = 1;
+            while (i + run_length < entries.size()
+                && run_length < max_blocks_per_write
+                && entries[i + run_length]->block_index.value() == entries[i]->block_index.value() + run_length)
+                ++run_length;
+
+            u8* data = entries[i]->data;
+            if (run_length > 1) {
+                for (size_t j = 0; j < run_length; ++j)
+                    memcpy(m_writeback_buffer.data() + j * block_size, entries[i + j]->data, block_size);
+                data = m_writeback_buffer.data();
+            }
+
+            auto base_offset = entries[i]->block_index.value() * block_size;
+            auto seek_result = m_fs.file_description().seek(base_offset, SEEK_SET);
+            VERIFY(!seek_result.is_error());
+            // FIXME: Should this error path be surfaced somehow?
+            auto data_buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+            [[maybe_unused]] auto rc = m_fs.file_description().write(data_buffer, run_length * block_size);
+
+            i += run_length;
+            ++write_count;
+        }
+        m_stats.writebacks += write_count;
+        m_stats.blocks_written_back += entries.size();
+        return write_count;
+    }
+
+    size_t max_blocks_per_read() const { return m_read_buffer.size() / m_fs.block_size(); }
+
+    // Reads in the data for a run of entries for adjacent blocks with a single device read.
+    KResult read_in(const Vector<CacheEntry*, 32>& entries) const
+    {
+        VERIFY(!entries.is_empty());
+        VERIFY(entries.size() <= max_blocks_per_read());
+        auto block_size = m_fs.block_size();
+        auto read_buffer = UserOrKernelBuffer::for_kernel_buffer(m_read_buffer.data());
+        auto result = m_fs.read_device_blocks(entries.first()->block_index, entries.size(), read_buffer);
+        if (result.is_error())
+            return result;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            VERIFY(entries[i]->block_index.value() == entries.first()->block_index.value() + i);
+            memcpy(entries[i]->data, m_read_buffer.data() + i * block_size, block_size);
+            entries[i]->has_data = true;
+        }
+        return KSuccess;
+    }
+
+    BlockBasedFS::CacheStats stats() const
+    {
+        auto stats = m_stats;
+        stats.dirty_bytes = m_dirty_count * m_fs.block_size();
+        return stats;
+    }
+
 private:
     BlockBasedFS& m_fs;
     size_t m_entry_count { 10000 };
@@ -101,7 +206,12 @@ private:
     mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_dirty_list;
     KBuffer m_cached_block_data;
     KBuffer m_entries;
+    KBuffer m_writeback_buffer;
+    mutable KBuffer m_read_buffer;
+    size_t m_dirty_count { 0 };
     bool m_dirty { false };
+    bool m_writeback_requested { false };
+    mutable BlockBasedFS::CacheStats m_stats;
 };
 
 BlockBasedFS::BlockBasedFS(FileDescription& file_description)
@@ -146,6 +256,14 @@ KResult BlockBasedFS::write_block(BlockIndex index, const UserOrKernelBuffer& da
 
     cache().mark_dirty(entry);
     entry.has_data = true;
+
+    if (cache().is_above_hard_writeback_threshold()) {
+        // We're dirtying blocks faster than the SyncTask can write them back, so this writer gets to help out.
+        flush_writes_impl();
+    } else if (cache().is_above_soft_writeback_threshold() && !cache().is_writeback_requested()) {
+        cache().set_writeback_requested(true);
+        SyncTask::request_writeback();
+    }
     return KSuccess;
 }
 
@@ -256,14 +374,70 @@ KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernel
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
-    auto out = buffer;
+
+    if (!allow_cache) {
+        // Make sure the disk has what's in the cache, then read the whole range with as few requests as possible.
+        const_cast<BlockBasedFS*>(this)->flush_writes_impl();
+        return read_device_blocks(index, count, buffer);
+    }
+
+    // Blocks that aren't cached yet get read in runs, so adjacent misses only cost a single device read.
+    Vector<CacheEntry*, 32> missing_entries;
+    size_t first_missing = 0;
+    auto read_in_missing_entries = [&]() -> KResult {
+        if (missing_entries.is_empty())
+            return KSuccess;
+        auto result = cache().read_in(missing_entries);
+        if (result.is_error())
+            return result;
+        for (size_t i = 0; i < missing_entries.size(); ++i) {
+            if (!buffer.write(missing_entries[i]->data, (first_missing + i) * block_size(), block_size()))
+                return EFAULT;
+        }
+        missing_entries.clear_with_capacity();
+        return KSuccess;
+    };
+
     for (unsigned i = 0; i < count; ++i) {
-        auto result = read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache);
+        auto& entry = cache().get(BlockIndex { index.value() + i });
+        if (!entry.has_data) {
+            if (missing_entries.is_empty())
+                first_missing = i;
+            missing_entries.append(&entry);
+            if (missing_entries.size() == cache().max_blocks_per_read()) {
+                auto result = read_in_missing_entries();
+                if (result.is_error())
+                    return result;
+            }
+            continue;
+        }
+        auto result = read_in_missing_entries();
         if (result.is_error())
             return result;
-        out = out.offset(block_size());
+        if (!buffer.write(entry.data, i * block_size(), block_size()))
+            return EFAULT;
     }
+    return read_in_missing_entries();
+}
 
+KResult BlockBasedFS::read_device_blocks(BlockIndex index, size_t count, UserOrKernelBuffer& buffer) const
+{
+    VERIFY(m_lock.is_locked());
+    auto seek_result = file_description().seek(index.value() * block_size(), SEEK_SET);
+    if (seek_result.is_error())
+        return seek_result.error();
+    // NOTE: The device splits this up into as few requests as its driver allows, but it's free to return early.
+    size_t total_size = count * block_size();
+    size_t nread = 0;
+    while (nread < total_size) {
+        auto chunk_buffer = buffer.offset(nread);
+        auto result = file_description().read(chunk_buffer, total_size - nread);
+        if (result.is_error())
+            return result.error();
+        if (result.value() == 0)
+            return EIO;
+        nread += result.value();
+    }
     return KSuccess;
 }
 
@@ -274,16 +448,10 @@ void BlockBasedFS::flush_specific_block_if_needed(BlockIndex index)
         return;
     Vector<CacheEntry*, 32> cleaned_entries;
     cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        if (entry.block_index != index) {
-            size_t base_offset = entry.block_index.value() * block_size();
-            auto seek_result = file_description().seek(base_offset, SEEK_SET);
-            VERIFY(!seek_result.is_error());
-            // FIXME: Should this error path be surfaced somehow?
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(entry_data_buffer, block_size());
+        if (entry.block_index != index)
             cleaned_entries.append(&entry);
-        }
     });
+    cache().write_back(cleaned_entries);
     // NOTE: We make a separate pass to mark entries clean since marking them clean
     //       moves them out of the dirty list which would disturb the iteration above.
     for (auto* entry : cleaned_entries)
@@ -295,18 +463,13 @@ void BlockBasedFS::flush_writes_impl()
     Locker locker(m_lock);
     if (!cache().is_dirty())
         return;
-    u32 count = 0;
+    Vector<CacheEntry*, 32> dirty_entries;
     cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        u32 base_offset = entry.block_index.value() * block_size();
-        auto seek_result = file_description().seek(base_offset, SEEK_SET);
-        VERIFY(!seek_result.is_error());
-        // FIXME: Should this error path be surfaced somehow?
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        [[maybe_unused]] auto rc = file_description().write(entry_data_buffer, block_size());
-        ++count;
+        dirty_entries.append(&entry);
     });
+    auto write_count = cache().write_back(dirty_entries);
     cache().mark_all_clean();
-    dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    dbgln("{}: Flushed {} blocks to disk in {} writes", class_name(), dirty_entries.size(), write_count);
 }
 
 void BlockBasedFS::flush_writes()
@@ -314,6 +477,14 @@ void BlockBasedFS::flush_writes()
     flush_writes_impl();
 }
 
+BlockBasedFS::CacheStats BlockBasedFS::cache_stats() const
+{
+    Locker locker(m_lock);
+    if (!m_cache)
+        return {};
+    return m_cache->stats();
+}
+
 DiskCache& BlockBasedFS::cache() const
 {
     if (!m_cache)
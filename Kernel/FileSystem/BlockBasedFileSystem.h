@@ -18,6 +18,19 @@ public:
 
     size_t logical_block_size() const { return m_logical_block_size; };
 
+    virtual bool supports_page_cache() const override { return true; }
+    virtual bool is_block_based() const override { return true; }
+
+    struct CacheStats {
+        size_t hits { 0 };
+        size_t misses { 0 };
+        size_t evictions { 0 };
+        size_t dirty_bytes { 0 };
+        size_t writebacks { 0 };
+        size_t blocks_written_back { 0 };
+    };
+    CacheStats cache_stats() const;
+
     virtual void flush_writes() override;
     void flush_writes_impl();
 
@@ -39,7 +52,10 @@ protected:
     size_t m_logical_block_size { 512 };
 
 private:
+    friend class DiskCache;
+
     DiskCache& cache() const;
+    KResult read_device_blocks(BlockIndex, size_t count, UserOrKernelBuffer&) const;
     void flush_specific_block_if_needed(BlockIndex index);
 
     mutable OwnPtr<DiskCache> m_cache;
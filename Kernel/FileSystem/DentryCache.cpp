@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashFunctions.h>
+#include <AK/Singleton.h>
+#include <Kernel/FileSystem/DentryCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+static AK::Singleton<DentryCache> s_the;
+
+static constexpr size_t MAXIMUM_DENTRY_CACHE_ENTRIES = 8192;
+
+DentryCache& DentryCache::the()
+{
+    return *s_the;
+}
+
+DentryCache::DentryCache()
+{
+}
+
+unsigned DentryCache::hash_for(InodeIdentifier parent, StringView name)
+{
+    return pair_int_hash(pair_int_hash(parent.fsid(), parent.index().value()), name.hash());
+}
+
+RefPtr<Inode> DentryCache::lookup(Inode& parent, StringView name)
+{
+    if (!parent.fs().supports_dentry_cache())
+        return parent.lookup(name);
+
+    auto parent_identifier = parent.identifier();
+    u64 generation;
+    {
+        Locker locker(m_lock);
+        auto it = m_entries.find(hash_for(parent_identifier, name), [&](auto& entry) {
+            return entry.key.parent == parent_identifier && entry.key.name == name;
+        });
+        if (it != m_entries.end()) {
+            ++m_hit_count;
+            m_lru_list.prepend(*it->value);
+            return it->value->inode;
+        }
+        ++m_miss_count;
+        generation = m_generation;
+    }
+
+    auto inode = parent.lookup(name);
+
+    Vector<NonnullOwnPtr<Entry>> evicted_entries;
+    {
+        Locker locker(m_lock);
+        // If the directory changed while we were looking, this result may already be stale.
+        if (generation != m_generation)
+            return inode;
+        auto entry = adopt_own_if_nonnull(new Entry { { parent_identifier, name }, inode, {} });
+        if (!entry)
+            return inode;
+        if (m_entries.size() >= MAXIMUM_DENTRY_CACHE_ENTRIES)
+            remove_least_recently_used_entries(MAXIMUM_DENTRY_CACHE_ENTRIES / 16, evicted_entries);
+        m_lru_list.prepend(*entry);
+        m_entries.set(entry->key, entry.release_nonnull());
+    }
+    return inode;
+}
+
+void DentryCache::remove_least_recently_used_entries(size_t count, Vector<NonnullOwnPtr<Entry>>& removed_entries)
+{
+    VERIFY(m_lock.is_locked());
+    while (count-- > 0 && !m_lru_list.is_empty()) {
+        auto* entry = m_lru_list.last();
+        m_lru_list.remove(*entry);
+        auto it = m_entries.find(entry->key);
+        VERIFY(it != m_entries.end());
+        removed_entries.append(move(it->value));
+        m_entries.remove(it);
+    }
+}
+
+template<typename Predicate>
+void DentryCache::remove_entries_if(Predicate predicate)
+{
+    // NOTE: Letting go of an inode may end up calling back into the filesystem, so we do that without holding our lock.
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    {
+        Locker locker(m_lock);
+        ++m_generation;
+        Vector<Key> keys_to_remove;
+        for (auto& it : m_entries) {
+            if (predicate(*it.value))
+                keys_to_remove.append(it.key);
+        }
+        for (auto& key : keys_to_remove) {
+            auto it = m_entries.find(key);
+            VERIFY(it != m_entries.end());
+            m_lru_list.remove(*it->value);
+            removed_entries.append(move(it->value));
+            m_entries.remove(it);
+        }
+    }
+}
+
+void DentryCache::invalidate(InodeIdentifier parent, StringView name)
+{
+    OwnPtr<Entry> removed_entry;
+    {
+        Locker locker(m_lock);
+        ++m_generation;
+        auto it = m_entries.find(hash_for(parent, name), [&](auto& entry) {
+            return entry.key.parent == parent && entry.key.name == name;
+        });
+        if (it == m_entries.end())
+            return;
+        m_lru_list.remove(*it->value);
+        removed_entry = move(it->value);
+        m_entries.remove(it);
+    }
+}
+
+void DentryCache::invalidate_children_of(InodeIdentifier parent)
+{
+    remove_entries_if([&](auto& entry) {
+        return entry.key.parent == parent;
+    });
+}
+
+void DentryCache::evict_all_on(u32 fsid)
+{
+    remove_entries_if([&](auto& entry) {
+        return entry.key.parent.fsid() == fsid;
+    });
+}
+
+void DentryCache::shrink()
+{
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    Locker locker(m_lock);
+    remove_least_recently_used_entries(ceil_div(m_entries.size(), (size_t)2), removed_entries);
+}
+
+DentryCache::Stats DentryCache::stats() const
+{
+    Locker locker(m_lock);
+    Stats stats;
+    stats.entry_count = m_entries.size();
+    for (auto& it : m_entries) {
+        if (!it.value->inode)
+            ++stats.negative_entry_count;
+    }
+    stats.hit_count = m_hit_count;
+    stats.miss_count = m_miss_count;
+    return stats;
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/String.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Lock.h>
+
+namespace Kernel {
+
+// The dentry cache remembers the results of Inode::lookup() for filesystems that reliably report
+// changes to their directories through Inode::did_add_child() and Inode::did_remove_child().
+// Failed lookups are cached as well, since path-heavy programs probe for lots of files that don't exist.
+class DentryCache {
+public:
+    static DentryCache& the();
+
+    DentryCache();
+
+    RefPtr<Inode> lookup(Inode& parent, StringView name);
+
+    void invalidate(InodeIdentifier parent, StringView name);
+    void invalidate_children_of(InodeIdentifier parent);
+    void evict_all_on(u32 fsid);
+
+    // Drops the least recently used half of the cache.
+    void shrink();
+
+    struct Stats {
+        size_t entry_count { 0 };
+        size_t negative_entry_count { 0 };
+        size_t hit_count { 0 };
+        size_t miss_count { 0 };
+    };
+    Stats stats() const;
+
+private:
+    struct Key {
+        InodeIdentifier parent;
+        String name;
+
+        bool operator==(const Key& other) const { return parent == other.parent && name == other.name; }
+    };
+
+    struct KeyTraits : public GenericTraits<Key> {
+        static unsigned hash(const Key& key) { return hash_for(key.parent, key.name); }
+    };
+
+    struct Entry {
+        Key key;
+        // A null inode means that the lookup failed.
+        RefPtr<Inode> inode;
+        IntrusiveListNode<Entry> lru_list_node;
+    };
+
+    static unsigned hash_for(InodeIdentifier parent, StringView name);
+
+    template<typename Predicate>
+    void remove_entries_if(Predicate);
+    void remove_least_recently_used_entries(size_t count, Vector<NonnullOwnPtr<Entry>>& removed_entries);
+
+    mutable Lock m_lock { "DentryCache" };
+    HashMap<Key, NonnullOwnPtr<Entry>, KeyTraits> m_entries;
+    // The most recently used entry is at the front.
+    IntrusiveList<Entry, RawPtr<Entry>, &Entry::lru_list_node> m_lru_list;
+    // Bumped on every invalidation, so a lookup that raced with a directory change doesn't get cached.
+    u64 m_generation { 0 };
+
+    size_t m_hit_count { 0 };
+    size_t m_miss_count { 0 };
+};
+
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    // Like poll(), we always want to hear about errors and hangups.
+    auto flags = BlockFlags::Exception;
+    if (events & EPOLLIN)
+        flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        flags |= BlockFlags::ReadPriority;
+    return flags;
+}
+
+static u32 events_for_unblocked_flags(BlockFlags flags, u32 requested_events)
+{
+    u32 events = 0;
+    if (has_flag(flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(flags, BlockFlags::ReadHangUp) && (requested_events & EPOLLRDHUP))
+        events |= EPOLLRDHUP;
+    if (has_flag(flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+KResultOr<NonnullRefPtr<EPoll>> EPoll::create()
+{
+    auto epoll = adopt_ref_if_nonnull(new EPoll);
+    if (!epoll)
+        return ENOMEM;
+    return epoll.release_nonnull();
+}
+
+EPoll::~EPoll()
+{
+    Locker locker(m_lock);
+    m_watches.clear();
+}
+
+EPoll::Watch::Watch(EPoll& epoll, int fd, FileDescription& description, const epoll_event& event)
+    : m_epoll(epoll)
+    , m_fd(fd)
+    , m_description(description.make_weak_ptr())
+    , m_file(description.file())
+    , m_event(event)
+{
+    // This will put us on the ready list right away, so we find out whether the file is already ready.
+    bool was_added = m_file->block_condition().add_blocker(*this, nullptr);
+    VERIFY(was_added);
+}
+
+EPoll::Watch::~Watch()
+{
+    // NOTE: Once we're out of the block condition, nobody can put us on the ready list again.
+    m_file->block_condition().remove_blocker(*this, nullptr);
+    ScopedSpinLock lock(m_epoll.m_ready_lock);
+    m_epoll.m_ready_watches.remove(*this);
+}
+
+bool EPoll::Watch::unblock(bool, void*)
+{
+    m_epoll.mark_as_ready(*this);
+    // We want to stay in the block condition, so we never "unblock".
+    return false;
+}
+
+void EPoll::mark_as_ready(Watch& watch)
+{
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        if (watch.m_is_disabled || watch.m_ready_list_node.is_in_list())
+            return;
+        m_ready_watches.append(watch);
+    }
+    evaluate_block_conditions();
+}
+
+bool EPoll::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(m_ready_lock);
+    return !m_ready_watches.is_empty();
+}
+
+KResult EPoll::add_watch(int fd, FileDescription& description, const epoll_event& event)
+{
+    // NOTE: Watching another EPoll would let a pair of them watch each other forever.
+    if (description.is_epoll())
+        return EINVAL;
+
+    Locker locker(m_lock);
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        // The fd might have been closed and reused for something else since the old watch was added.
+        if (it->value->m_description.unsafe_ptr() == &description)
+            return EEXIST;
+        m_watches.remove(it);
+    }
+
+    auto watch = adopt_own_if_nonnull(new Watch(*this, fd, description, event));
+    if (!watch)
+        return ENOMEM;
+    m_watches.set(fd, watch.release_nonnull());
+    dbgln_if(EPOLL_DEBUG, "EPoll: Watching fd {} for events {:#x}", fd, event.events);
+    return KSuccess;
+}
+
+KResult EPoll::modify_watch(int fd, const epoll_event& event)
+{
+    Locker locker(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end())
+        return ENOENT;
+    auto& watch = *it->value;
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        watch.m_event = event;
+        watch.m_is_disabled = false;
+    }
+    // The file might be ready for the new events already.
+    mark_as_ready(watch);
+    return KSuccess;
+}
+
+KResult EPoll::remove_watch(int fd)
+{
+    Locker locker(m_lock);
+    if (!m_watches.remove(fd))
+        return ENOENT;
+    dbgln_if(EPOLL_DEBUG, "EPoll: No longer watching fd {}", fd);
+    return KSuccess;
+}
+
+KResultOr<size_t> EPoll::collect_events(Vector<epoll_event>& events, size_t max_events)
+{
+    Locker locker(m_lock);
+
+    Vector<Watch*, 32> changed_watches;
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        while (!m_ready_watches.is_empty()) {
+            auto* watch = m_ready_watches.take_first();
+            if (!changed_watches.try_append(watch)) {
+                m_ready_watches.prepend(*watch);
+                break;
+            }
+        }
+    }
+
+    Vector<Watch*, 32> watches_to_put_back;
+    Vector<Watch*, 32> watches_still_ready;
+    auto put_back = [&](auto& watches) {
+        for (auto* watch : watches) {
+            if (!watch->m_is_disabled)
+                m_ready_watches.append(*watch);
+        }
+    };
+
+    for (auto* watch : changed_watches) {
+        if (events.size() == max_events) {
+            if (!watches_to_put_back.try_append(watch))
+                return ENOMEM;
+            continue;
+        }
+
+        auto description = watch->m_description.strong_ref();
+        if (!description) {
+            // The description is gone, so there's nothing left to watch.
+            dbgln_if(EPOLL_DEBUG, "EPoll: fd {} went away, dropping its watch", watch->m_fd);
+            m_watches.remove(watch->m_fd);
+            continue;
+        }
+
+        // NOTE: The event only ever changes with m_lock held, so we don't need the ready lock to look at it.
+        u32 requested_events = watch->m_event.events;
+        auto ready_events = events_for_unblocked_flags(description->should_unblock(block_flags_for_events(requested_events)), requested_events);
+        if (ready_events == 0)
+            continue;
+
+        if (!events.try_append({ ready_events, watch->m_event.data }))
+            return ENOMEM;
+
+        if (requested_events & EPOLLONESHOT) {
+            ScopedSpinLock lock(m_ready_lock);
+            watch->m_is_disabled = true;
+        } else if (!(requested_events & EPOLLET)) {
+            // Level-triggered watches have to be looked at again next time.
+            if (!watches_still_ready.try_append(watch))
+                return ENOMEM;
+        }
+    }
+
+    {
+        // NOTE: Watches that just got reported go to the back, so nobody starves the others.
+        ScopedSpinLock lock(m_ready_lock);
+        put_back(watches_to_put_back);
+        put_back(watches_still_ready);
+    }
+    return events.size();
+}
+
+}
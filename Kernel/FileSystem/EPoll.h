@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <AK/WeakPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// An interest set of file descriptors that stays registered between waits.
+//
+// Every watched file gets a persistent watch on its block condition, so when the file's
+// state changes, the watch puts itself on the ready list. Waiting only has to look at the
+// ready list, instead of asking every file whether it's ready like select() and poll() do.
+//
+// Level-triggered watches stay on the ready list for as long as their file is ready.
+// Edge-triggered (EPOLLET) watches are reported once, and then again only after the next
+// change in their file's state. EPOLLONESHOT watches are disabled after they're reported,
+// until they get re-armed with EPOLL_CTL_MOD.
+class EPoll final : public File {
+public:
+    static KResultOr<NonnullRefPtr<EPoll>> create();
+    virtual ~EPoll() override;
+
+    KResult add_watch(int fd, FileDescription&, const epoll_event&);
+    KResult modify_watch(int fd, const epoll_event&);
+    KResult remove_watch(int fd);
+
+    // Takes up to max_events events off the ready list, without blocking.
+    KResultOr<size_t> collect_events(Vector<epoll_event>& events, size_t max_events);
+
+    // ^File
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return ":epoll:"; }
+    virtual const char* class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+
+private:
+    // NOTE: This is never actually blocked on. It just sits in the watched file's block condition,
+    //       so it gets told whenever something about the file changes.
+    class Watch final : public Thread::FileBlocker {
+    public:
+        Watch(EPoll&, int fd, FileDescription&, const epoll_event&);
+        virtual ~Watch() override;
+
+        virtual const char* state_string() const override { return "Watching"; }
+        virtual void not_blocking(bool) override { VERIFY_NOT_REACHED(); }
+        virtual bool unblock(bool from_add_blocker, void*) override;
+
+        EPoll& m_epoll;
+        int m_fd { -1 };
+        WeakPtr<FileDescription> m_description;
+        // NOTE: This keeps the block condition we're in alive, even after the description is gone.
+        NonnullRefPtr<File> m_file;
+        epoll_event m_event;
+        bool m_is_disabled { false };
+        IntrusiveListNode<Watch> m_ready_list_node;
+
+        using ReadyList = IntrusiveList<Watch, RawPtr<Watch>, &Watch::m_ready_list_node>;
+    };
+
+    EPoll() { }
+
+    // NOTE: A watch on the ready list only means that its file's state changed. Whether it's actually
+    //       ready is checked when collecting events, so we never have to ask a file from inside
+    //       its own block condition.
+    void mark_as_ready(Watch&);
+
+    mutable Lock m_lock { "EPoll" };
+    HashMap<int, NonnullOwnPtr<Watch>> m_watches;
+
+    mutable SpinLock<u8> m_ready_lock;
+    Watch::ReadyList m_ready_watches;
+};
+
+}
@@ -917,12 +917,13 @@ KResult Ext2FSInode::resize(u64 new_size)
         m_block_list = this->compute_block_list();
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks_or_error = fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before);
+        auto blocks_or_error = allocate_data_blocks(blocks_needed_after - blocks_needed_before);
         if (blocks_or_error.is_error())
             return blocks_or_error.error();
         if (!m_block_list.try_append(blocks_or_error.release_value()))
             return ENOMEM;
     } else if (blocks_needed_after < blocks_needed_before) {
+        discard_preallocated_blocks();
         if constexpr (EXT2_VERY_DEBUG) {
             dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
             for (auto block_index : m_block_list) {
@@ -968,6 +969,61 @@ KResult Ext2FSInode::resize(u64 new_size)
     return KSuccess;
 }
 
+// Growing regular files get a preallocation window of this many blocks (or of their current size, if that's bigger)
+// reserved right behind their last block, so that many small appends still end up in one contiguous run on disk.
+static constexpr size_t MINIMUM_PREALLOCATION_WINDOW_BLOCKS = 8;
+static constexpr size_t MAXIMUM_PREALLOCATION_WINDOW_BLOCKS = 256;
+
+KResultOr<Vector<BlockBasedFS::BlockIndex>> Ext2FSInode::allocate_data_blocks(size_t count)
+{
+    VERIFY(m_lock.is_locked());
+    Vector<BlockBasedFS::BlockIndex> blocks;
+    if (!blocks.try_ensure_capacity(count))
+        return ENOMEM;
+
+    // The preallocated blocks always follow on from the end of the block list, so use them up first.
+    auto preallocated_block_count = min(count, m_preallocated_blocks.size());
+    blocks.append(m_preallocated_blocks.data(), preallocated_block_count);
+    m_preallocated_blocks.remove(0, preallocated_block_count);
+    if (blocks.size() == count)
+        return blocks;
+
+    BlockBasedFS::BlockIndex goal = 0;
+    if (!blocks.is_empty())
+        goal = blocks.last().value() + 1;
+    else if (!m_block_list.is_empty() && m_block_list.last() != 0)
+        goal = m_block_list.last().value() + 1;
+
+    auto remaining_count = count - blocks.size();
+    size_t window = 0;
+    if (Kernel::is_regular_file(m_raw_inode.i_mode))
+        window = clamp(m_block_list.size() + count, MINIMUM_PREALLOCATION_WINDOW_BLOCKS, MAXIMUM_PREALLOCATION_WINDOW_BLOCKS);
+    if (remaining_count + window > fs().super_block().s_free_blocks_count)
+        window = 0;
+
+    auto new_blocks_or_error = fs().allocate_blocks(fs().group_index_from_inode(index()), remaining_count + window, goal);
+    if (new_blocks_or_error.is_error()) {
+        // Give back whatever we took from the preallocation window, the caller won't be using it.
+        m_preallocated_blocks.prepend(move(blocks));
+        return new_blocks_or_error.error();
+    }
+    auto new_blocks = new_blocks_or_error.release_value();
+    blocks.append(new_blocks.data(), remaining_count);
+    VERIFY(m_preallocated_blocks.is_empty());
+    m_preallocated_blocks.append(new_blocks.data() + remaining_count, window);
+    return blocks;
+}
+
+void Ext2FSInode::discard_preallocated_blocks()
+{
+    Locker locker(m_lock);
+    for (auto block_index : m_preallocated_blocks) {
+        if (auto result = fs().set_block_allocation_state(block_index, false); result.is_error())
+            dbgln("Ext2FSInode[{}]::discard_preallocated_blocks(): Failed to free block {}: {}", identifier(), block_index, result.error());
+    }
+    m_preallocated_blocks.clear();
+}
+
 KResultOr<ssize_t> Ext2FSInode::write_bytes(off_t offset, ssize_t count, const UserOrKernelBuffer& data, FileDescription* description)
 {
     VERIFY(offset >= 0);
@@ -1109,6 +1165,7 @@ KResult Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries)
 {
     Locker locker(m_lock);
     auto block_size = fs().block_size();
+    invalidate_directory_index();
 
     // Calculate directory size and record length of entries so that
     // the following constraints are met:
@@ -1165,6 +1222,128 @@ KResult Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries)
     return KSuccess;
 }
 
+void Ext2FSInode::invalidate_directory_index()
+{
+    // We don't maintain hashed directory indices, so don't leave a stale one behind for others to trust.
+    if (!(m_raw_inode.i_flags & EXT2_INDEX_FL))
+        return;
+    m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
+    set_metadata_dirty(true);
+}
+
+KResult Ext2FSInode::add_directory_entry(const StringView& name, InodeIndex child_index, u8 file_type)
+{
+    VERIFY(m_lock.is_locked());
+    VERIFY(name.length() <= EXT2_NAME_LEN);
+    auto block_size = fs().block_size();
+    auto record_length = EXT2_DIR_REC_LEN(name.length());
+
+    if (m_block_list.is_empty())
+        m_block_list = compute_block_list();
+
+    // Directories are always made up of whole blocks. If this one somehow isn't, rewrite it from scratch.
+    if (size() != m_block_list.size() * block_size) {
+        Vector<Ext2FSDirectoryEntry> entries;
+        KResult result = traverse_as_directory([&](auto& entry) {
+            entries.append({ entry.name, entry.inode.index(), entry.file_type });
+            return true;
+        });
+        if (result.is_error())
+            return result;
+        entries.empend(name, child_index, file_type);
+        return write_directory(entries);
+    }
+
+    invalidate_directory_index();
+
+    u8 buffer[max_block_size];
+    auto buf = UserOrKernelBuffer::for_kernel_buffer(buffer);
+
+    auto write_entry = [&](size_t offset, size_t entry_record_length) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(buffer + offset);
+        entry->inode = child_index.value();
+        entry->rec_len = entry_record_length;
+        entry->name_len = name.length();
+        entry->file_type = file_type;
+        memcpy(entry->name, name.characters_without_null_termination(), name.length());
+    };
+
+    // Try to fit the new entry into the slack space behind the last entry in the last block.
+    // This way, adding an entry only costs us a single block write, regardless of the directory's size.
+    if (!m_block_list.is_empty()) {
+        auto block_index = m_block_list.last();
+        if (auto result = fs().read_block(block_index, &buf, block_size); result.is_error())
+            return result;
+
+        size_t offset = 0;
+        auto* last_entry = reinterpret_cast<ext2_dir_entry_2*>(buffer);
+        for (;;) {
+            last_entry = reinterpret_cast<ext2_dir_entry_2*>(buffer + offset);
+            if (last_entry->rec_len < EXT2_DIR_REC_LEN(0) || offset + last_entry->rec_len > block_size) {
+                dbgln("Ext2FSInode[{}]::add_directory_entry(): Corrupt directory entry in block {}", identifier(), block_index);
+                return EIO;
+            }
+            if (offset + last_entry->rec_len == block_size)
+                break;
+            offset += last_entry->rec_len;
+        }
+
+        size_t used_length = last_entry->inode ? EXT2_DIR_REC_LEN(last_entry->name_len) : 0;
+        if (last_entry->rec_len - used_length >= record_length) {
+            size_t free_length = last_entry->rec_len - used_length;
+            if (used_length)
+                last_entry->rec_len = used_length;
+            write_entry(offset + used_length, free_length);
+            return fs().write_block(block_index, buf, block_size);
+        }
+    }
+
+    // No room left, so grow the directory by a block that holds just the new entry.
+    if (auto result = resize(size() + block_size); result.is_error())
+        return result;
+    memset(buffer, 0, block_size);
+    write_entry(0, block_size);
+    return fs().write_block(m_block_list.last(), buf, block_size);
+}
+
+KResult Ext2FSInode::remove_directory_entry(const StringView& name)
+{
+    VERIFY(m_lock.is_locked());
+    auto block_size = fs().block_size();
+
+    if (m_block_list.is_empty())
+        m_block_list = compute_block_list();
+
+    u8 buffer[max_block_size];
+    auto buf = UserOrKernelBuffer::for_kernel_buffer(buffer);
+
+    for (auto& block_index : m_block_list) {
+        if (auto result = fs().read_block(block_index, &buf, block_size); result.is_error())
+            return result;
+
+        ext2_dir_entry_2* previous_entry = nullptr;
+        for (size_t offset = 0; offset < block_size;) {
+            auto* entry = reinterpret_cast<ext2_dir_entry_2*>(buffer + offset);
+            if (entry->rec_len < EXT2_DIR_REC_LEN(0) || offset + entry->rec_len > block_size) {
+                dbgln("Ext2FSInode[{}]::remove_directory_entry(): Corrupt directory entry in block {}", identifier(), block_index);
+                return EIO;
+            }
+            if (entry->inode != 0 && name == StringView(entry->name, entry->name_len)) {
+                invalidate_directory_index();
+                // Hand the entry's space to the one in front of it, or just mark it unused if it's the first in its block.
+                if (previous_entry)
+                    previous_entry->rec_len += entry->rec_len;
+                else
+                    entry->inode = 0;
+                return fs().write_block(block_index, buf, block_size);
+            }
+            previous_entry = entry;
+            offset += entry->rec_len;
+        }
+    }
+    return ENOENT;
+}
+
 KResultOr<NonnullRefPtr<Inode>> Ext2FSInode::create_child(const String& name, mode_t mode, dev_t dev, uid_t uid, gid_t gid)
 {
     if (::is_directory(mode))
@@ -1182,31 +1361,19 @@ KResult Ext2FSInode::add_child(Inode& child, const StringView& name, mode_t mode
 
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child(): Adding inode {} with name '{}' and mode {:o} to directory {}", identifier(), child.index(), name, mode, index());
 
-    Vector<Ext2FSDirectoryEntry> entries;
-    bool name_already_exists = false;
-    KResult result = traverse_as_directory([&](auto& entry) {
-        if (name == entry.name) {
-            name_already_exists = true;
-            return false;
-        }
-        entries.append({ entry.name, entry.inode.index(), entry.file_type });
-        return true;
-    });
-
-    if (result.is_error())
-        return result;
+    if (!populate_lookup_cache())
+        return EIO;
 
-    if (name_already_exists) {
+    if (m_lookup_cache.contains(name)) {
         dbgln("Ext2FSInode[{}]::add_child(): Name '{}' already exists", identifier(), name);
         return EEXIST;
     }
 
-    result = child.increment_link_count();
+    KResult result = child.increment_link_count();
     if (result.is_error())
         return result;
 
-    entries.empend(name, child.index(), to_ext2_file_type(mode));
-    result = write_directory(entries);
+    result = add_directory_entry(name, child.index(), to_ext2_file_type(mode));
     if (result.is_error())
         return result;
 
@@ -1228,16 +1395,7 @@ KResult Ext2FSInode::remove_child(const StringView& name)
 
     InodeIdentifier child_id { fsid(), child_inode_index };
 
-    Vector<Ext2FSDirectoryEntry> entries;
-    KResult result = traverse_as_directory([&](auto& entry) {
-        if (name != entry.name)
-            entries.append({ entry.name, entry.inode.index(), entry.file_type });
-        return true;
-    });
-    if (result.is_error())
-        return result;
-
-    result = write_directory(entries);
+    KResult result = remove_directory_entry(name);
     if (result.is_error())
         return result;
 
@@ -1281,10 +1439,10 @@ bool Ext2FS::write_ext2_inode(InodeIndex inode, const ext2_inode& e2inode)
     return write_block(block_index, buffer, inode_size(), offset) >= 0;
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> KResultOr<Vector<BlockIndex>>
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> KResultOr<Vector<BlockIndex>>
 {
     Locker locker(m_lock);
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -1292,6 +1450,35 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks:");
     blocks.ensure_capacity(count);
 
+    if (goal != 0 && goal >= first_block_index() && goal.value() < super_block().s_blocks_count) {
+        // Try to carry on right where the caller's previous allocation ended, so that growing files stay contiguous.
+        auto goal_group_index = group_index_from_block_index(goal);
+        auto& bgd = group_descriptor(goal_group_index);
+        if (bgd.bg_free_blocks_count) {
+            auto cached_bitmap_or_error = get_bitmap_block(bgd.bg_block_bitmap);
+            if (cached_bitmap_or_error.is_error())
+                return cached_bitmap_or_error.error();
+            auto& cached_bitmap = *cached_bitmap_or_error.value();
+
+            int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
+            auto block_bitmap = cached_bitmap.bitmap(blocks_in_group);
+
+            unsigned index_in_group = (goal.value() - first_block_index().value()) - ((goal_group_index.value() - 1) * blocks_per_group());
+            for (size_t bit_index = index_in_group % blocks_per_group(); blocks.size() < count && bit_index < (size_t)blocks_in_group && !block_bitmap.get(bit_index); ++bit_index) {
+                BlockIndex block_index = goal.value() + blocks.size();
+                if (auto result = set_block_allocation_state(block_index, true); result.is_error()) {
+                    dbgln("Ext2FS: Failed to allocate block {} in allocate_blocks()", block_index);
+                    return result;
+                }
+                blocks.unchecked_append(block_index);
+            }
+            dbgln_if(EXT2_DEBUG, "Ext2FS: allocated {} blocks at goal {} [{}]", blocks.size(), goal, goal_group_index);
+        }
+        preferred_group_index = goal_group_index;
+    }
+    if (blocks.size() == count)
+        return blocks;
+
     auto group_index = preferred_group_index;
 
     if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
@@ -1677,17 +1864,24 @@ KResult Ext2FSInode::increment_link_count()
 
 KResult Ext2FSInode::decrement_link_count()
 {
-    Locker locker(m_lock);
-    if (fs().is_readonly())
-        return EROFS;
-    VERIFY(m_raw_inode.i_links_count);
+    {
+        Locker locker(m_lock);
+        if (fs().is_readonly())
+            return EROFS;
+        VERIFY(m_raw_inode.i_links_count);
 
-    --m_raw_inode.i_links_count;
-    set_metadata_dirty(true);
-    if (m_raw_inode.i_links_count == 0)
-        did_delete_self();
+        --m_raw_inode.i_links_count;
+        set_metadata_dirty(true);
+        if (m_raw_inode.i_links_count != 0)
+            return KSuccess;
+        discard_preallocated_blocks();
+    }
+
+    // NOTE: This evicts us from the page cache, which takes the paging lock of our VMObject.
+    //       Whoever holds that may be reading from us and waiting for m_lock, so we must not hold it here.
+    did_delete_self();
 
-    if (ref_count() == 1 && m_raw_inode.i_links_count == 0)
+    if (ref_count() == 1)
         fs().uncache_inode(index());
 
     return KSuccess;
@@ -1785,6 +1979,11 @@ KResult Ext2FS::prepare_to_unmount() const
             return EBUSY;
     }
 
+    for (auto& it : m_inode_cache) {
+        if (it.value)
+            it.value->discard_preallocated_blocks();
+    }
+
     m_inode_cache.clear();
     return KSuccess;
 }
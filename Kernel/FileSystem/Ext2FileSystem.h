@@ -57,10 +57,15 @@ private:
     virtual KResult chown(uid_t, gid_t) override;
     virtual KResult truncate(u64) override;
     virtual KResultOr<int> get_block_address(int) override;
+    virtual void discard_preallocated_blocks() override;
 
     KResult write_directory(Vector<Ext2FSDirectoryEntry>&);
+    KResult add_directory_entry(const StringView& name, InodeIndex, u8 file_type);
+    KResult remove_directory_entry(const StringView& name);
+    void invalidate_directory_index();
     bool populate_lookup_cache() const;
     KResult resize(u64);
+    KResultOr<Vector<BlockBasedFS::BlockIndex>> allocate_data_blocks(size_t count);
     KResult write_indirect_block(BlockBasedFS::BlockIndex, Span<BlockBasedFS::BlockIndex>);
     KResult grow_doubly_indirect_block(BlockBasedFS::BlockIndex, size_t, Span<BlockBasedFS::BlockIndex>, Vector<BlockBasedFS::BlockIndex>&, unsigned&);
     KResult shrink_doubly_indirect_block(BlockBasedFS::BlockIndex, size_t, size_t, unsigned&);
@@ -77,6 +82,7 @@ private:
     Ext2FSInode(Ext2FS&, InodeIndex);
 
     mutable Vector<BlockBasedFS::BlockIndex> m_block_list;
+    Vector<BlockBasedFS::BlockIndex> m_preallocated_blocks;
     mutable HashMap<String, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode;
 };
@@ -103,6 +109,7 @@ public:
     virtual KResult prepare_to_unmount() const override;
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_dentry_cache() const override { return true; }
 
     virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntryView& entry) const override;
 
@@ -137,7 +144,7 @@ private:
 
     BlockIndex first_block_index() const;
     KResultOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    KResultOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    KResultOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
@@ -9,6 +9,7 @@
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/RefCounted.h>
+#include <AK/Weakable.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -23,8 +24,10 @@ public:
     virtual ~FileDescriptionData() = default;
 };
 
-class FileDescription : public RefCounted<FileDescription> {
-    MAKE_SLAB_ALLOCATED(FileDescription)
+class FileDescription
+    : public RefCounted<FileDescription>
+    , public Weakable<FileDescription> {
+    MAKE_SLAB_CACHED(FileDescription)
 public:
     static KResultOr<NonnullRefPtr<FileDescription>> create(Custody&);
     static KResultOr<NonnullRefPtr<FileDescription>> create(File&);
@@ -81,6 +84,12 @@ public:
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_io_ring() const;
+    IORing* io_ring();
+
+    bool is_epoll() const;
+    EPoll* epoll();
+
     bool is_master_pty() const;
     const MasterPTY* master_pty() const;
     MasterPTY* master_pty();
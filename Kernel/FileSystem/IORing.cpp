@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+KResultOr<NonnullRefPtr<IORing>> IORing::create(Process& process, size_t entries)
+{
+    if (entries == 0 || entries > max_entries || (entries & (entries - 1)) != 0)
+        return EINVAL;
+
+    size_t size = io_ring_mapping_size(entries);
+    auto vmobject = AnonymousVMObject::create_with_size(size, AllocationStrategy::AllocateNow);
+    if (!vmobject)
+        return ENOMEM;
+    auto region = MM.allocate_kernel_region_with_vmobject(*vmobject, size, "IORing", Region::Access::Read | Region::Access::Write);
+    if (!region)
+        return ENOMEM;
+    auto ring = adopt_ref_if_nonnull(new IORing(process, entries, vmobject.release_nonnull(), region.release_nonnull()));
+    if (!ring)
+        return ENOMEM;
+    return ring.release_nonnull();
+}
+
+IORing::IORing(Process& process, size_t entries, NonnullRefPtr<AnonymousVMObject> vmobject, NonnullOwnPtr<Region> region)
+    : m_owner_pid(process.pid())
+    , m_entries(entries)
+    , m_vmobject(move(vmobject))
+    , m_region(move(region))
+{
+    memset(m_region->vaddr().as_ptr(), 0, m_region->size());
+    header().submissions.mask = entries - 1;
+    header().submissions.entries_offset = sizeof(IORingHeader);
+    header().completions.mask = io_ring_completion_entries(entries) - 1;
+    header().completions.entries_offset = sizeof(IORingHeader) + entries * sizeof(IORingSubmission);
+}
+
+IORing::~IORing()
+{
+}
+
+KResultOr<Region*> IORing::mmap(Process& process, FileDescription&, const Range& range, u64 offset, int prot, bool shared)
+{
+    if (offset != 0 || !shared)
+        return EINVAL;
+    if (range.size() != m_vmobject->size())
+        return EINVAL;
+    return process.space().allocate_region_with_vmobject(range, m_vmobject, offset, "IORing", prot, true);
+}
+
+bool IORing::can_read(const FileDescription&, size_t) const
+{
+    // NOTE: This gets called while we're posting completions, so it must not take our lock.
+    return unconsumed_completions_count() > 0;
+}
+
+size_t IORing::unconsumed_completions_count() const
+{
+    u32 head = AK::atomic_load(&header().completions.head, AK::memory_order_acquire);
+    // If userspace put garbage into the head, treat the ring as full rather than overwriting anything.
+    return min((size_t)(m_completion_tail - head), io_ring_completion_entries(m_entries));
+}
+
+void IORing::post_completion(u64 user_data, i32 result)
+{
+    VERIFY(m_lock.is_locked());
+    VERIFY(unconsumed_completions_count() < io_ring_completion_entries(m_entries));
+    auto& completion = completions()[m_completion_tail & (io_ring_completion_entries(m_entries) - 1)];
+    completion.user_data = user_data;
+    completion.result = result;
+    completion.reserved = 0;
+    ++m_completion_tail;
+    AK::atomic_store(&header().completions.tail, m_completion_tail, AK::memory_order_release);
+    evaluate_block_conditions();
+}
+
+KResultOr<size_t> IORing::enter(size_t to_submit, size_t min_complete)
+{
+    // NOTE: The buffers in the submissions are addresses in the owner's address space.
+    if (Process::current()->pid() != m_owner_pid)
+        return EPERM;
+
+    Locker locker(m_lock);
+    u32 tail = AK::atomic_load(&header().submissions.tail, AK::memory_order_acquire);
+    if (tail - m_submission_head > m_entries)
+        return EINVAL;
+
+    size_t submitted_count = 0;
+    while (submitted_count < to_submit && m_submission_head != tail) {
+        // Every operation we take on has to have a completion entry waiting for it.
+        if (unconsumed_completions_count() + m_pending_operations.size() >= io_ring_completion_entries(m_entries))
+            break;
+        IORingSubmission submission;
+        memcpy(&submission, const_cast<IORingSubmission*>(&submissions()[m_submission_head & (m_entries - 1)]), sizeof(submission));
+        ++m_submission_head;
+        AK::atomic_store(&header().submissions.head, m_submission_head, AK::memory_order_release);
+        submit(submission);
+        ++submitted_count;
+    }
+
+    while (unconsumed_completions_count() < min_complete && !m_pending_operations.is_empty()) {
+        Thread::SelectBlocker::FDVector fds_info;
+        for (auto& operation : m_pending_operations) {
+            bool wants_read = operation.submission.opcode == IORingOpcode::Read || operation.submission.opcode == IORingOpcode::Recv || operation.submission.opcode == IORingOpcode::Accept;
+            if (!fds_info.try_append({ *operation.description, wants_read ? BlockFlags::Read : BlockFlags::Write }))
+                return ENOMEM;
+        }
+
+        // Let other threads submit more while we wait.
+        locker.unlock();
+        bool was_interrupted = Thread::current()->block<Thread::SelectBlocker>({}, fds_info).was_interrupted();
+        locker.lock();
+        if (was_interrupted) {
+            if (submitted_count > 0)
+                break;
+            return EINTR;
+        }
+
+        for (size_t i = 0; i < m_pending_operations.size();) {
+            if (!is_ready(m_pending_operations[i])) {
+                ++i;
+                continue;
+            }
+            auto operation = m_pending_operations.take(i);
+            complete(operation);
+        }
+    }
+    return submitted_count;
+}
+
+void IORing::submit(const IORingSubmission& submission)
+{
+    VERIFY(m_lock.is_locked());
+    Operation operation { submission, nullptr };
+    if (submission.opcode != IORingOpcode::Nop) {
+        operation.description = Process::current()->file_description(submission.fd);
+        if (!operation.description) {
+            post_completion(submission.user_data, -EBADF);
+            return;
+        }
+        // An operation on the ring itself would keep it alive forever.
+        if (operation.description->is_io_ring()) {
+            post_completion(submission.user_data, -EINVAL);
+            return;
+        }
+    }
+
+    if (is_ready(operation)) {
+        complete(operation);
+        return;
+    }
+    if (!m_pending_operations.try_append(move(operation)))
+        post_completion(submission.user_data, -ENOMEM);
+}
+
+bool IORing::is_ready(const Operation& operation) const
+{
+    switch (operation.submission.opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Recv:
+    case IORingOpcode::Accept:
+        return operation.description->can_read();
+    case IORingOpcode::Write:
+    case IORingOpcode::Send:
+        return operation.description->can_write();
+    default:
+        return true;
+    }
+}
+
+void IORing::complete(Operation& operation)
+{
+    auto result = perform(operation);
+    i32 value = result.is_error() ? result.error().error() : (i32)min(result.value(), (size_t)NumericLimits<i32>::max());
+    post_completion(operation.submission.user_data, value);
+}
+
+KResultOr<size_t> IORing::perform(Operation& operation)
+{
+    auto& submission = operation.submission;
+    if (submission.opcode == IORingOpcode::Nop)
+        return 0;
+
+    auto& description = *operation.description;
+    auto buffer = UserOrKernelBuffer::for_user_buffer((u8*)(FlatPtr)submission.buffer, submission.length);
+    if (!buffer.has_value())
+        return EFAULT;
+
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+        if (!description.is_readable())
+            return EBADF;
+        if (description.is_directory())
+            return EISDIR;
+        if (submission.offset == -1)
+            return description.read(buffer.value(), submission.length);
+        if (submission.offset < 0)
+            return EINVAL;
+        if (!description.file().is_seekable())
+            return ESPIPE;
+        return description.file().read(description, submission.offset, buffer.value(), submission.length);
+    case IORingOpcode::Write:
+        if (!description.is_writable())
+            return EBADF;
+        if (submission.offset == -1)
+            return description.write(buffer.value(), submission.length);
+        if (submission.offset < 0)
+            return EINVAL;
+        if (!description.file().is_seekable())
+            return ESPIPE;
+        return description.file().write(description, submission.offset, buffer.value(), submission.length);
+    case IORingOpcode::Accept: {
+        REQUIRE_PROMISE(accept);
+        if (!description.is_socket())
+            return ENOTSOCK;
+        if (!description.socket()->can_accept())
+            return EAGAIN;
+        socklen_t address_size = submission.length;
+        auto fd_or_error = Process::current()->accept_pending_connection(description, Userspace<sockaddr*>((FlatPtr)submission.buffer), address_size, submission.flags);
+        if (fd_or_error.is_error())
+            return fd_or_error.error();
+        return (size_t)fd_or_error.value();
+    }
+    case IORingOpcode::Recv: {
+        if (!description.is_socket())
+            return ENOTSOCK;
+        auto& socket = *description.socket();
+        if (socket.is_shut_down_for_reading())
+            return 0;
+        Time timestamp {};
+        return socket.recvfrom(description, buffer.value(), submission.length, submission.flags, {}, {}, timestamp);
+    }
+    case IORingOpcode::Send: {
+        if (!description.is_socket())
+            return ENOTSOCK;
+        auto& socket = *description.socket();
+        if (socket.is_shut_down_for_writing())
+            return EPIPE;
+        return socket.sendto(description, buffer.value(), submission.length, submission.flags, {}, 0);
+    }
+    case IORingOpcode::Fsync: {
+        auto* inode = description.inode();
+        if (!inode)
+            return EINVAL;
+        inode->flush_metadata();
+        inode->fs().flush_writes();
+        return 0;
+    }
+    default:
+        return EINVAL;
+    }
+}
+
+}
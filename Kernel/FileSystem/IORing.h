@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/VM/AnonymousVMObject.h>
+
+namespace Kernel {
+
+// A pair of submission and completion rings in memory that's shared with userspace, see Kernel/API/IORing.h.
+//
+// io_ring_enter() starts all new submissions. Operations that can go ahead right away are performed
+// immediately. Those that would have to wait for their file (like a recv() on a socket without data)
+// are put aside, and get performed once their file is ready. That happens while a thread is waiting
+// for completions in io_ring_enter(), so a single thread can keep any number of them in flight.
+class IORing final : public File {
+public:
+    static constexpr size_t max_entries = 4096;
+
+    static KResultOr<NonnullRefPtr<IORing>> create(Process&, size_t entries);
+    virtual ~IORing() override;
+
+    KResultOr<size_t> enter(size_t to_submit, size_t min_complete);
+
+    // ^File
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return ENOTSUP; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return ENOTSUP; }
+    virtual KResultOr<Region*> mmap(Process&, FileDescription&, const Range&, u64 offset, int prot, bool shared) override;
+    virtual String absolute_path(const FileDescription&) const override { return ":io-ring:"; }
+    virtual const char* class_name() const override { return "IORing"; }
+    virtual bool is_io_ring() const override { return true; }
+
+private:
+    struct Operation {
+        IORingSubmission submission;
+        RefPtr<FileDescription> description;
+    };
+
+    IORing(Process&, size_t entries, NonnullRefPtr<AnonymousVMObject>, NonnullOwnPtr<Region>);
+
+    volatile IORingHeader& header() const { return *(volatile IORingHeader*)m_region->vaddr().as_ptr(); }
+    volatile IORingSubmission* submissions() const { return (volatile IORingSubmission*)(m_region->vaddr().as_ptr() + sizeof(IORingHeader)); }
+    volatile IORingCompletion* completions() const { return (volatile IORingCompletion*)(m_region->vaddr().as_ptr() + sizeof(IORingHeader) + m_entries * sizeof(IORingSubmission)); }
+
+    size_t unconsumed_completions_count() const;
+    void post_completion(u64 user_data, i32 result);
+
+    void submit(const IORingSubmission&);
+    bool is_ready(const Operation&) const;
+    KResultOr<size_t> perform(Operation&);
+    void complete(Operation&);
+    KResult wait_for_pending_operations();
+
+    ProcessID m_owner_pid { 0 };
+    size_t m_entries { 0 };
+    NonnullRefPtr<AnonymousVMObject> m_vmobject;
+    NonnullOwnPtr<Region> m_region;
+
+    // NOTE: We keep our own copies of the indices we own, so userspace scribbling over them can't confuse us.
+    u32 m_submission_head { 0 };
+    u32 m_completion_tail { 0 };
+    Vector<Operation> m_pending_operations;
+
+    mutable Lock m_lock { "IORing" };
+};
+
+}
@@ -10,12 +10,16 @@
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
 #include <Kernel/API/InodeWatcherEvent.h>
+#include <Kernel/ELFLoadLayoutCache.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/VM/PageCache.h>
+#include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
@@ -143,6 +147,11 @@ KResult Inode::decrement_link_count()
     return ENOTIMPL;
 }
 
+RefPtr<PhysicalPage> Inode::physical_page_for_shared_mapping(size_t)
+{
+    return nullptr;
+}
+
 void Inode::set_shared_vmobject(SharedInodeVMObject& vmobject)
 {
     Locker locker(m_lock);
@@ -218,6 +227,8 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier const&, String const& name)
 {
+    DentryCache::the().invalidate(identifier(), name);
+
     Locker locker(m_lock);
 
     for (auto& watcher : m_watchers) {
@@ -227,6 +238,8 @@ void Inode::did_add_child(InodeIdentifier const&, String const& name)
 
 void Inode::did_remove_child(InodeIdentifier const&, String const& name)
 {
+    DentryCache::the().invalidate(identifier(), name);
+
     Locker locker(m_lock);
 
     if (name == "." || name == "..") {
@@ -241,6 +254,8 @@ void Inode::did_remove_child(InodeIdentifier const&, String const& name)
 
 void Inode::did_modify_contents()
 {
+    ELFLoadLayoutCache::the().invalidate(identifier());
+
     Locker locker(m_lock);
     for (auto& watcher : m_watchers) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::ContentModified);
@@ -249,6 +264,13 @@ void Inode::did_modify_contents()
 
 void Inode::did_delete_self()
 {
+    // NOTE: The page cache reads from the inode while holding the paging lock, so callers mustn't be holding m_lock.
+    // Don't let the page cache keep a deleted inode (and its blocks) around.
+    PageCache::the().evict(*this);
+    // If this was a directory, its inode index may soon be reused for a different one.
+    DentryCache::the().invalidate_children_of(identifier());
+    ELFLoadLayoutCache::the().invalidate(identifier());
+
     Locker locker(m_lock);
     for (auto& watcher : m_watchers) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::Deleted);
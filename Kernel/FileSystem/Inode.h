@@ -66,6 +66,11 @@ public:
     virtual KResultOr<NonnullRefPtr<Custody>> resolve_as_link(Custody& base, RefPtr<Custody>* out_parent, int options, int symlink_recursion_level) const;
 
     virtual KResultOr<int> get_block_address(int) { return ENOTSUP; }
+    // Filesystems that reserve blocks ahead of time for growing files should give them back here.
+    virtual void discard_preallocated_blocks() { }
+    // Filesystems that keep file data in physical pages can hand those out here, so shared
+    // mappings of the file map them directly instead of paging in a copy.
+    virtual RefPtr<PhysicalPage> physical_page_for_shared_mapping(size_t page_index);
 
     LocalSocket* socket() { return m_socket.ptr(); }
     const LocalSocket* socket() const { return m_socket.ptr(); }
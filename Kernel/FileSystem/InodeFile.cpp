@@ -10,6 +10,7 @@
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/PageCache.h>
 #include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 #include <LibC/errno_numbers.h>
@@ -31,7 +32,11 @@ KResultOr<size_t> InodeFile::read(FileDescription& description, u64 offset, User
     if (Checked<off_t>::addition_would_overflow(offset, count))
         return EOVERFLOW;
 
-    auto result = m_inode->read_bytes(offset, count, buffer, &description);
+    KResultOr<ssize_t> result(KSuccess);
+    if (!description.is_direct() && PageCache::is_cacheable(*m_inode))
+        result = PageCache::the().read(*m_inode, offset, count, buffer);
+    else
+        result = m_inode->read_bytes(offset, count, buffer, &description);
     if (result.is_error())
         return result.error();
     auto nread = result.value();
@@ -53,6 +58,7 @@ KResultOr<size_t> InodeFile::write(FileDescription& description, u64 offset, con
 
     auto nwritten = result.value();
     if (nwritten > 0) {
+        PageCache::the().did_write(*m_inode, offset, data, nwritten);
         auto mtime_result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds());
         Thread::current()->did_file_write(nwritten);
         evaluate_block_conditions();
@@ -116,11 +122,20 @@ KResult InodeFile::truncate(u64 size)
 {
     if (auto result = m_inode->truncate(size); result.is_error())
         return result;
+    PageCache::the().did_truncate(*m_inode, size);
     if (auto result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds()); result.is_error())
         return result;
     return KSuccess;
 }
 
+KResult InodeFile::close()
+{
+    // Nobody is going to keep appending through this description, so there's no point in holding on to any
+    // blocks the filesystem reserved for the file to grow into.
+    m_inode->discard_preallocated_blocks();
+    return File::close();
+}
+
 KResult InodeFile::chown(FileDescription& description, uid_t uid, gid_t gid)
 {
     VERIFY(description.inode() == m_inode);
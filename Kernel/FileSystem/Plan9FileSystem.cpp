@@ -6,6 +6,7 @@
 
 #include <Kernel/FileSystem/Plan9FileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
@@ -16,7 +17,6 @@ NonnullRefPtr<Plan9FS> Plan9FS::create(FileDescription& file_description)
 
 Plan9FS::Plan9FS(FileDescription& file_description)
     : FileBackedFS(file_description)
-    , m_completion_blocker(*this)
 {
 }
 
@@ -411,12 +411,12 @@ bool Plan9FS::Blocker::unblock(u16 tag)
 {
     {
         ScopedSpinLock lock(m_lock);
+        // NOTE: There can be many requests in flight, so this might be about somebody else's reply.
+        if (m_completion->tag != tag)
+            return false;
         if (m_did_unblock)
             return false;
         m_did_unblock = true;
-
-        if (m_completion->tag != tag)
-            return false;
         if (!m_completion->result.is_error())
             m_message = move(*m_completion->message);
     }
@@ -467,27 +467,13 @@ void Plan9FS::Plan9FSBlockCondition::unblock_all()
 
 void Plan9FS::Plan9FSBlockCondition::try_unblock(Plan9FS::Blocker& blocker)
 {
-    if (m_fs.is_complete(*blocker.completion())) {
+    // NOTE: This gets called from Thread::block() with spinlocks held, so we can't take the FS lock here.
+    if (blocker.is_completed()) {
         ScopedSpinLock lock(m_lock);
         blocker.unblock(blocker.completion()->tag);
     }
 }
 
-bool Plan9FS::is_complete(const ReceiveCompletion& completion)
-{
-    Locker locker(m_lock);
-    if (m_completions.contains(completion.tag)) {
-        // If it's still in the map then it can't be complete
-        VERIFY(!completion.completed);
-        return false;
-    }
-
-    // if it's not in the map anymore, it must be complete. But we MUST
-    // hold m_lock to be able to check completion.completed!
-    VERIFY(completion.completed);
-    return true;
-}
-
 KResult Plan9FS::post_message(Message& message, RefPtr<ReceiveCompletion> completion)
 {
     auto& buffer = message.build();
@@ -595,12 +581,26 @@ KResult Plan9FS::post_message_and_explicitly_ignore_reply(Message& message)
 
 KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message)
 {
-    auto request_type = message.type();
-    auto tag = message.tag();
-    auto completion = adopt_ref(*new ReceiveCompletion(tag));
+    auto completion_or_error = post_message_expecting_reply(message);
+    if (completion_or_error.is_error())
+        return completion_or_error.error();
+    return wait_for_reply(message, completion_or_error.release_value());
+}
+
+KResultOr<NonnullRefPtr<Plan9FS::ReceiveCompletion>> Plan9FS::post_message_expecting_reply(Message& message)
+{
+    auto completion = adopt_ref_if_nonnull(new ReceiveCompletion(message.tag()));
+    if (!completion)
+        return ENOMEM;
     auto result = post_message(message, completion);
     if (result.is_error())
         return result;
+    return completion.release_nonnull();
+}
+
+KResult Plan9FS::wait_for_reply(Message& message, NonnullRefPtr<ReceiveCompletion> completion)
+{
+    auto request_type = message.type();
     if (Thread::current()->block<Plan9FS::Blocker>({}, *this, message, completion).was_interrupted())
         return EINTR;
 
@@ -728,6 +728,62 @@ KResult Plan9FSInode::ensure_open_for_mode(int mode)
     }
 }
 
+KResultOr<Plan9FSInode::ReadAhead*> Plan9FSInode::wait_for_read_ahead(u64 offset) const
+{
+    VERIFY(m_lock.is_locked());
+    // Anything before the offset isn't going to be read anytime soon.
+    while (!m_read_ahead.is_empty() && !m_read_ahead.first().contains(offset) && m_read_ahead.first().offset < offset)
+        m_read_ahead.take_first();
+    if (m_read_ahead.is_empty() || !m_read_ahead.first().contains(offset)) {
+        m_read_ahead.clear();
+        return nullptr;
+    }
+
+    auto& read_ahead = m_read_ahead.first();
+    if (!read_ahead.has_reply) {
+        auto result = fs().wait_for_reply(*read_ahead.message, read_ahead.completion);
+        if (result.is_error()) {
+            // NOTE: If we got interrupted, the reply will still arrive, and we can pick it up next time.
+            if (result.error() != -EINTR)
+                m_read_ahead.clear();
+            return result;
+        }
+        read_ahead.data = read_ahead.message->read_data();
+        read_ahead.has_reply = true;
+    }
+    return &read_ahead;
+}
+
+void Plan9FSInode::start_read_ahead(u64 offset) const
+{
+    VERIFY(m_lock.is_locked());
+    u32 chunk_size = fs().adjust_buffer_size(NumericLimits<ssize_t>::max());
+    Optional<u64> file_size;
+    if (m_cached_metadata.has_value())
+        file_size = m_cached_metadata->size;
+
+    while (m_read_ahead.size() < max_read_ahead_requests) {
+        if (!m_read_ahead.is_empty()) {
+            auto& last = m_read_ahead.last();
+            // A short reply means we've hit the end of the file.
+            if (last.has_reply && last.data.length() < last.size)
+                return;
+            offset = last.offset + last.size;
+        }
+        if (file_size.has_value() && offset >= file_size.value())
+            return;
+
+        auto message = adopt_own_if_nonnull(new Plan9FS::Message { fs(), Plan9FS::Message::Type::Tread });
+        if (!message)
+            return;
+        *message << fid() << offset << chunk_size;
+        auto completion_or_error = fs().post_message_expecting_reply(*message);
+        if (completion_or_error.is_error())
+            return;
+        m_read_ahead.append({ offset, chunk_size, message.release_nonnull(), completion_or_error.release_value(), false, {} });
+    }
+}
+
 KResultOr<ssize_t> Plan9FSInode::read_bytes(off_t offset, ssize_t size, UserOrKernelBuffer& buffer, FileDescription*) const
 {
     auto result = const_cast<Plan9FSInode&>(*this).ensure_open_for_mode(O_RDONLY);
@@ -736,34 +792,58 @@ KResultOr<ssize_t> Plan9FSInode::read_bytes(off_t offset, ssize_t size, UserOrKe
 
     size = fs().adjust_buffer_size(size);
 
-    Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
-    StringView data;
-
-    // Try readlink first.
-    bool readlink_succeded = false;
+    // Try readlink first, but only if this might actually be a symlink. Otherwise every read at the start
+    // of a regular file would cost us an extra round trip.
     if (fs().m_remote_protocol_version >= Plan9FS::ProtocolVersion::v9P2000L && offset == 0) {
-        message << fid();
-        result = fs().post_message_and_wait_for_a_reply(message);
-        if (result.is_success()) {
-            readlink_succeded = true;
-            message >> data;
+        auto metadata = this->metadata();
+        if (metadata.mode == 0 || metadata.is_symlink()) {
+            Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
+            message << fid();
+            result = fs().post_message_and_wait_for_a_reply(message);
+            if (result.is_success()) {
+                StringView data;
+                message >> data;
+                size_t nread = min(data.length(), (size_t)size);
+                if (!buffer.write(data.characters_without_null_termination(), nread))
+                    return EFAULT;
+                return nread;
+            }
         }
     }
 
-    if (!readlink_succeded) {
-        message = Plan9FS::Message { fs(), Plan9FS::Message::Type::Tread };
+    Locker locker(m_lock);
+    bool is_sequential = (u64)offset == m_next_sequential_offset;
+
+    size_t nread = 0;
+    auto read_ahead_or_error = wait_for_read_ahead(offset);
+    if (read_ahead_or_error.is_error())
+        return read_ahead_or_error.error();
+    if (auto* read_ahead = read_ahead_or_error.value()) {
+        auto data = read_ahead->data;
+        size_t offset_in_data = offset - read_ahead->offset;
+        nread = offset_in_data < data.length() ? min(data.length() - offset_in_data, (size_t)size) : 0;
+        if (!buffer.write(data.characters_without_null_termination() + offset_in_data, nread))
+            return EFAULT;
+        if (offset + nread >= read_ahead->offset + read_ahead->size)
+            m_read_ahead.take_first();
+    } else {
+        Plan9FS::Message message { fs(), Plan9FS::Message::Type::Tread };
         message << fid() << (u64)offset << (u32)size;
         result = fs().post_message_and_wait_for_a_reply(message);
         if (result.is_error())
             return result.error();
-        data = message.read_data();
-    }
+        auto data = message.read_data();
 
-    // Guard against the server returning more data than requested.
-    size_t nread = min(data.length(), (size_t)size);
-    if (!buffer.write(data.characters_without_null_termination(), nread))
-        return EFAULT;
+        // Guard against the server returning more data than requested.
+        nread = min(data.length(), (size_t)size);
+        if (!buffer.write(data.characters_without_null_termination(), nread))
+            return EFAULT;
+    }
 
+    m_next_sequential_offset = offset + nread;
+    // Keep a few reads in flight ahead of a sequential reader, so it doesn't have to wait for a round trip every time.
+    if (is_sequential && nread > 0)
+        start_read_ahead(offset + nread);
     return nread;
 }
 
@@ -788,10 +868,40 @@ KResultOr<ssize_t> Plan9FSInode::write_bytes(off_t offset, ssize_t size, const U
 
     u32 nwritten;
     message >> nwritten;
+    invalidate_caches();
     return nwritten;
 }
 
+void Plan9FSInode::invalidate_caches()
+{
+    Locker locker(m_lock);
+    m_read_ahead.clear();
+    m_cached_metadata = {};
+}
+
 InodeMetadata Plan9FSInode::metadata() const
+{
+    Locker locker(m_lock);
+    auto now = TimeManagement::the().monotonic_time();
+    if (m_cached_metadata.has_value() && now - m_metadata_fetch_time < metadata_cache_lifetime)
+        return m_cached_metadata.value();
+
+    auto metadata_or_error = fetch_metadata();
+    if (metadata_or_error.is_error()) {
+        // Just return blank metadata; hopefully that's enough to result in an
+        // error at some upper layer. Ideally, there would be a way for
+        // Inode::metadata() to return failure.
+        InodeMetadata metadata;
+        metadata.inode = identifier();
+        return metadata;
+    }
+
+    m_cached_metadata = metadata_or_error.value();
+    m_metadata_fetch_time = now;
+    return m_cached_metadata.value();
+}
+
+KResultOr<InodeMetadata> Plan9FSInode::fetch_metadata() const
 {
     InodeMetadata metadata;
     metadata.inode = identifier();
@@ -800,12 +910,8 @@ InodeMetadata Plan9FSInode::metadata() const
     Plan9FS::Message message { fs(), Plan9FS::Message::Type::Tgetattr };
     message << fid() << (u64)GetAttrMask::Basic;
     auto result = fs().post_message_and_wait_for_a_reply(message);
-    if (result.is_error()) {
-        // Just return blank metadata; hopefully that's enough to result in an
-        // error at some upper layer. Ideally, there would be a way for
-        // Inode::metadata() to return failure.
-        return metadata;
-    }
+    if (result.is_error())
+        return result;
 
     u64 valid;
     Plan9FS::qid qid;
@@ -984,6 +1090,7 @@ KResult Plan9FSInode::truncate(u64 new_size)
         u64 mtime_sec = 0;
         u64 mtime_nsec = 0;
         message << fid() << (u64)valid << mode << uid << gid << new_size << atime_sec << atime_nsec << mtime_sec << mtime_nsec;
+        invalidate_caches();
         return fs().post_message_and_wait_for_a_reply(message);
     } else {
         // TODO: wstat version
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Atomic.h>
+#include <AK/Vector.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/KBufferBuilder.h>
@@ -28,6 +29,9 @@ public:
 
     virtual NonnullRefPtr<Inode> root_inode() const override;
 
+    // What we ask the server for. Larger messages mean fewer round trips for big reads and writes.
+    static constexpr size_t preferred_max_message_size = 256 * KiB;
+
     u16 allocate_tag() { return m_next_tag++; }
     u32 allocate_fid() { return m_next_fid++; }
 
@@ -52,10 +56,7 @@ private:
 
     class Plan9FSBlockCondition : public Thread::BlockCondition {
     public:
-        Plan9FSBlockCondition(Plan9FS& fs)
-            : m_fs(fs)
-        {
-        }
+        Plan9FSBlockCondition() = default;
 
         void unblock_completed(u16);
         void unblock_all();
@@ -65,7 +66,6 @@ private:
         virtual bool should_add_blocker(Thread::Blocker&, void*) override;
 
     private:
-        Plan9FS& m_fs;
         mutable SpinLock<u8> m_lock;
     };
 
@@ -87,10 +87,13 @@ private:
             , m_message(message)
             , m_completion(move(completion))
         {
-            set_block_condition(fs.m_completion_blocker);
+            // If the reply is already here, we don't get added, and pick it up in not_blocking() instead.
+            if (!set_block_condition(fs.m_completion_blocker))
+                m_should_block = false;
         }
         virtual const char* state_string() const override { return "Waiting"; }
         virtual Type blocker_type() const override { return Type::Plan9FS; }
+        virtual bool should_block() override { return m_should_block; }
         virtual void not_blocking(bool) override;
 
         const NonnullRefPtr<ReceiveCompletion>& completion() const { return m_completion; }
@@ -109,17 +112,19 @@ private:
         Plan9FS& m_fs;
         Message& m_message;
         NonnullRefPtr<ReceiveCompletion> m_completion;
+        bool m_should_block { true };
         bool m_did_unblock { false };
     };
     friend class Blocker;
 
     virtual const char* class_name() const override { return "Plan9FS"; }
 
-    bool is_complete(const ReceiveCompletion&);
     KResult post_message(Message&, RefPtr<ReceiveCompletion>);
     KResult do_read(u8* buffer, size_t);
     KResult read_and_dispatch_one_message();
     KResult post_message_and_wait_for_a_reply(Message&);
+    KResultOr<NonnullRefPtr<ReceiveCompletion>> post_message_expecting_reply(Message&);
+    KResult wait_for_reply(Message&, NonnullRefPtr<ReceiveCompletion>);
     KResult post_message_and_explicitly_ignore_reply(Message&);
 
     ProtocolVersion parse_protocol_version(const StringView&) const;
@@ -133,7 +138,7 @@ private:
     Atomic<u32> m_next_fid { 1 };
 
     ProtocolVersion m_remote_protocol_version { ProtocolVersion::v9P2000 };
-    size_t m_max_message_size { 4 * KiB };
+    size_t m_max_message_size { preferred_max_message_size };
 
     Lock m_send_lock { "Plan9FS send" };
     Plan9FSBlockCondition m_completion_blocker;
@@ -209,6 +214,34 @@ private:
     int m_open_mode { 0 };
     KResult ensure_open_for_mode(int mode);
 
+    KResultOr<InodeMetadata> fetch_metadata() const;
+    void invalidate_caches();
+
+    // A Tread that we sent ahead of time, because it looked like someone was reading the file sequentially.
+    struct ReadAhead {
+        u64 offset { 0 };
+        u32 size { 0 };
+        NonnullOwnPtr<Plan9FS::Message> message;
+        NonnullRefPtr<Plan9FS::ReceiveCompletion> completion;
+        bool has_reply { false };
+        StringView data;
+
+        bool contains(u64 position) const { return position >= offset && position < offset + size; }
+    };
+    static constexpr size_t max_read_ahead_requests = 4;
+
+    KResultOr<ReadAhead*> wait_for_read_ahead(u64 offset) const;
+    void start_read_ahead(u64 offset) const;
+
+    // All of these are protected by m_lock.
+    mutable Vector<ReadAhead, max_read_ahead_requests> m_read_ahead;
+    mutable u64 m_next_sequential_offset { 0 };
+
+    // Attributes are fetched from the server at most this often, unless we change them ourselves.
+    static constexpr Time metadata_cache_lifetime = Time::from_milliseconds(1000);
+    mutable Optional<InodeMetadata> m_cached_metadata;
+    mutable Time m_metadata_fetch_time;
+
     Plan9FS& fs() { return reinterpret_cast<Plan9FS&>(Inode::fs()); }
     Plan9FS& fs() const
     {
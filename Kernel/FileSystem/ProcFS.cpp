@@ -10,6 +10,7 @@
 #include <AK/JsonValue.h>
 #include <AK/ScopeGuard.h>
 #include <AK/UBSanitizer.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Arch/x86/ProcessorInfo.h>
 #include <Kernel/CommandLine.h>
@@ -18,7 +19,9 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Devices/HID/HIDManagement.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/ProcFS.h>
@@ -27,11 +30,13 @@
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/KBufferBuilder.h>
+#include <Kernel/LockStatistics.h>
 #include <Kernel/Module.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/PCI/Access.h>
@@ -39,9 +44,12 @@
 #include <Kernel/Process.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Storage/StorageDevice.h>
 #include <Kernel/TTY/TTY.h>
 #include <Kernel/VM/AnonymousVMObject.h>
+#include <Kernel/VM/CompressedPage.h>
 #include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
 #include <LibC/errno_numbers.h>
 
 namespace Kernel {
@@ -65,10 +73,12 @@ enum ProcFileType {
     __FI_Root_Start,
     FI_Root_df,
     FI_Root_all,
+    FI_Root_all_binary,
     FI_Root_memstat,
     FI_Root_cpuinfo,
     FI_Root_dmesg,
     FI_Root_interrupts,
+    FI_Root_locks,
     FI_Root_dmi,
     FI_Root_smbios_entry_point,
     FI_Root_keymap,
@@ -387,7 +397,7 @@ static bool procfs$interrupts(InodeIdentifier, KBufferBuilder& builder)
         obj.add("purpose", handler.purpose());
         obj.add("interrupt_line", handler.interrupt_number());
         obj.add("controller", handler.controller());
-        obj.add("cpu_handler", 0); // FIXME: Determine the responsible CPU for each interrupt handler.
+        obj.add("cpu_handler", handler.responsible_processor());
         obj.add("device_sharing", (unsigned)handler.sharing_devices_count());
         obj.add("call_count", (unsigned)handler.get_invoking_count());
     });
@@ -395,6 +405,39 @@ static bool procfs$interrupts(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$locks(InodeIdentifier, KBufferBuilder& builder)
+{
+    JsonObjectSerializer<KBufferBuilder> json { builder };
+    json.add("enabled", (bool)LOCK_STATISTICS);
+    json.add("dropped_sites", LockStatistics::dropped_site_count());
+    auto array = json.add_array("sites");
+    LockStatistics::for_each_site([&array](const LockStatistics::Site& site) {
+        auto obj = array.add_object();
+        switch (site.lock_type()) {
+        case LockStatistics::LockType::Lock:
+            obj.add("type", "Lock");
+            break;
+        case LockStatistics::LockType::SpinLock:
+            obj.add("type", "SpinLock");
+            break;
+        case LockStatistics::LockType::RecursiveSpinLock:
+            obj.add("type", "RecursiveSpinLock");
+            break;
+        }
+        obj.add("name", site.lock_name() ? site.lock_name() : "");
+        obj.add("file", site.filename());
+        obj.add("line", site.line_number());
+        obj.add("function", site.function_name());
+        obj.add("acquisitions", site.acquisitions());
+        obj.add("contended_acquisitions", site.contended_acquisitions());
+        obj.add("total_wait_cycles", site.total_wait_cycles());
+        obj.add("max_hold_cycles", site.max_hold_cycles());
+    });
+    array.finish();
+    json.finish();
+    return true;
+}
+
 static bool procfs$keymap(InodeIdentifier, KBufferBuilder& builder)
 {
     JsonObjectSerializer<KBufferBuilder> json { builder };
@@ -418,6 +461,14 @@ static bool procfs$devices(InodeIdentifier, KBufferBuilder& builder)
             obj.add("type", "character");
         else
             VERIFY_NOT_REACHED();
+
+        if (device.is_disk_device()) {
+            auto stats = static_cast<const StorageDevice&>(device).request_queue_stats();
+            auto request_queue = obj.add_object("request_queue");
+            request_queue.add("dispatched_requests", stats.dispatched_request_count);
+            request_queue.add("merged_requests", stats.merged_request_count);
+            request_queue.add("expired_requests", stats.expired_request_count);
+        }
     });
     array.finish();
     return true;
@@ -461,7 +512,8 @@ static bool procfs$profile(InodeIdentifier, KBufferBuilder& builder)
     if (!g_global_perf_events)
         return false;
 
-    return g_global_perf_events->to_json(builder);
+    // NOTE: Reading this takes the events out, so it can be read over and over while profiling, without the buffer filling up.
+    return g_global_perf_events->consume_to_json(builder);
 }
 
 static bool procfs$pid_perf_events(InodeIdentifier identifier, KBufferBuilder& builder)
@@ -680,6 +732,17 @@ static bool procfs$df(InodeIdentifier, KBufferBuilder& builder)
             fs_object.add("source", static_cast<const FileBackedFS&>(fs).file_description().absolute_path());
         else
             fs_object.add("source", "none");
+
+        if (fs.is_block_based()) {
+            auto cache_stats = static_cast<const BlockBasedFS&>(fs).cache_stats();
+            auto cache_object = fs_object.add_object("block_cache");
+            cache_object.add("hits", cache_stats.hits);
+            cache_object.add("misses", cache_stats.misses);
+            cache_object.add("evictions", cache_stats.evictions);
+            cache_object.add("dirty_bytes", cache_stats.dirty_bytes);
+            cache_object.add("writebacks", cache_stats.writebacks);
+            cache_object.add("blocks_written_back", cache_stats.blocks_written_back);
+        }
     });
     array.finish();
     return true;
@@ -710,6 +773,10 @@ static bool procfs$cpuinfo(InodeIdentifier, KBufferBuilder& builder)
 
 static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
 {
+    // NOTE: These take the page cache and dentry cache locks, so they have to happen before we disable interrupts.
+    auto page_cache_stats = PageCache::the().stats();
+    auto dentry_cache_stats = DentryCache::the().stats();
+
     InterruptDisabler disabler;
 
     kmalloc_stats stats;
@@ -720,6 +787,7 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     auto user_physical_pages_used = MM.user_physical_pages_used();
     auto user_physical_pages_committed = MM.user_physical_pages_committed();
     auto user_physical_pages_uncommitted = MM.user_physical_pages_uncommitted();
+    auto user_physical_pages_pre_zeroed = MM.pre_zeroed_user_physical_pages();
 
     auto super_physical_total = MM.super_physical_pages();
     auto super_physical_used = MM.super_physical_pages_used();
@@ -733,10 +801,56 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     json.add("user_physical_available", user_physical_pages_total - user_physical_pages_used);
     json.add("user_physical_committed", user_physical_pages_committed);
     json.add("user_physical_uncommitted", user_physical_pages_uncommitted);
+    json.add("user_physical_pre_zeroed", user_physical_pages_pre_zeroed);
+    {
+        auto compressed_page_stats = CompressedPage::stats();
+        auto compressed_pages = json.add_object("compressed_pages");
+        compressed_pages.add("pages", compressed_page_stats.page_count);
+        compressed_pages.add("compressed_bytes", compressed_page_stats.compressed_bytes);
+    }
+    {
+        auto page_cache = json.add_object("page_cache");
+        page_cache.add("cached_inodes", page_cache_stats.cached_inode_count);
+        page_cache.add("resident_pages", page_cache_stats.resident_page_count);
+        page_cache.add("hits", page_cache_stats.hit_count);
+        page_cache.add("misses", page_cache_stats.miss_count);
+        page_cache.add("reclaimed_pages", page_cache_stats.reclaimed_page_count);
+    }
+    {
+        auto dentry_cache = json.add_object("dentry_cache");
+        dentry_cache.add("entries", dentry_cache_stats.entry_count);
+        dentry_cache.add("negative_entries", dentry_cache_stats.negative_entry_count);
+        dentry_cache.add("hits", dentry_cache_stats.hit_count);
+        dentry_cache.add("misses", dentry_cache_stats.miss_count);
+    }
     json.add("super_physical_allocated", super_physical_used);
     json.add("super_physical_available", super_physical_total - super_physical_used);
     json.add("kmalloc_call_count", stats.kmalloc_call_count);
     json.add("kfree_call_count", stats.kfree_call_count);
+    {
+        auto caches = json.add_array("kmalloc_processor_caches");
+        for_each_kmalloc_processor_cache_stats([&caches](auto& cache_stats) {
+            auto cache = caches.add_object();
+            cache.add("processor", cache_stats.processor);
+            cache.add("allocation_hits", cache_stats.allocation_hits);
+            cache.add("allocation_misses", cache_stats.allocation_misses);
+            cache.add("free_hits", cache_stats.free_hits);
+            cache.add("free_misses", cache_stats.free_misses);
+            cache.add("bytes_cached", cache_stats.bytes_cached);
+        });
+    }
+    {
+        auto caches = json.add_array("slab_caches");
+        for_each_slab_cache_stats([&caches](auto& cache_stats) {
+            auto cache = caches.add_object();
+            cache.add("name", cache_stats.name);
+            cache.add("object_size", cache_stats.object_size);
+            cache.add("slab_count", cache_stats.slab_count);
+            cache.add("num_allocated", cache_stats.num_allocated);
+            cache.add("num_free", cache_stats.num_free);
+            cache.add("num_fallback_allocations", cache_stats.num_fallback_allocations);
+        });
+    }
     slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
         auto prefix = String::formatted("slab_{}", slab_size);
         json.add(String::formatted("{}_num_allocated", prefix), num_allocated);
@@ -746,42 +860,47 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
-static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
+static String pledge_string(const Process& process)
 {
-    JsonArraySerializer array { builder };
-
-    // Keep this in sync with CProcessStatistics.
-    auto build_process = [&](const Process& process) {
-        auto process_object = array.add_object();
-
-        if (process.is_user_process()) {
-            StringBuilder pledge_builder;
+    if (!process.is_user_process())
+        return {};
+    StringBuilder pledge_builder;
 
 #define __ENUMERATE_PLEDGE_PROMISE(promise)      \
     if (process.has_promised(Pledge::promise)) { \
         pledge_builder.append(#promise " ");     \
     }
-            ENUMERATE_PLEDGE_PROMISES
+    ENUMERATE_PLEDGE_PROMISES
 #undef __ENUMERATE_PLEDGE_PROMISE
 
-            process_object.add("pledge", pledge_builder.to_string());
+    return pledge_builder.to_string();
+}
 
-            switch (process.veil_state()) {
-            case VeilState::None:
-                process_object.add("veil", "None");
-                break;
-            case VeilState::Dropped:
-                process_object.add("veil", "Dropped");
-                break;
-            case VeilState::Locked:
-                process_object.add("veil", "Locked");
-                break;
-            }
-        } else {
-            process_object.add("pledge", String());
-            process_object.add("veil", String());
-        }
+static StringView veil_string(const Process& process)
+{
+    if (!process.is_user_process())
+        return {};
+    switch (process.veil_state()) {
+    case VeilState::None:
+        return "None";
+    case VeilState::Dropped:
+        return "Dropped";
+    case VeilState::Locked:
+        return "Locked";
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
+{
+    JsonArraySerializer array { builder };
+
+    // Keep this in sync with CProcessStatistics.
+    auto build_process = [&](const Process& process) {
+        auto process_object = array.add_object();
 
+        process_object.add("pledge", pledge_string(process));
+        process_object.add("veil", veil_string(process));
         process_object.add("pid", process.pid().value());
         process_object.add("pgid", process.tty() ? process.tty()->pgid().value() : 0);
         process_object.add("pgp", process.pgid().value());
@@ -816,6 +935,7 @@ static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
             thread_object.add("state", thread.state_string());
             thread_object.add("cpu", thread.cpu());
             thread_object.add("priority", thread.priority());
+            thread_object.add("cpu_affinity", thread.affinity() & Scheduler::schedulable_processors_mask());
             thread_object.add("syscall_count", thread.syscall_count());
             thread_object.add("inode_faults", thread.inode_faults());
             thread_object.add("zero_faults", thread.zero_faults());
@@ -838,6 +958,92 @@ static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$all_binary(InodeIdentifier, KBufferBuilder& builder)
+{
+    // Keep this in sync with procfs$all and Kernel/API/ProcessStatistics.h.
+    auto append_entry = [&](const auto& entry) {
+        builder.append_bytes({ &entry, sizeof(entry) });
+    };
+
+    auto build_process = [&](const Process& process) {
+        auto pledge = pledge_string(process);
+        auto veil = veil_string(process);
+        auto executable = process.executable() ? process.executable()->absolute_path() : String::empty();
+        StringView tty = process.tty() ? process.tty()->tty_name() : "notty";
+
+        ProcessStatisticsEntry entry {};
+        entry.pid = process.pid().value();
+        entry.pgid = process.tty() ? process.tty()->pgid().value() : 0;
+        entry.pgp = process.pgid().value();
+        entry.sid = process.sid().value();
+        entry.uid = process.uid();
+        entry.gid = process.gid();
+        entry.ppid = process.ppid().value();
+        entry.nfds = process.number_of_open_file_descriptors();
+        entry.kernel = process.is_kernel_process();
+        entry.dumpable = process.is_dumpable();
+        entry.amount_virtual = process.space().amount_virtual();
+        entry.amount_resident = process.space().amount_resident();
+        entry.amount_shared = process.space().amount_shared();
+        entry.amount_dirty_private = process.space().amount_dirty_private();
+        entry.amount_clean_inode = process.space().amount_clean_inode();
+        entry.amount_purgeable_volatile = process.space().amount_purgeable_volatile();
+        entry.amount_purgeable_nonvolatile = process.space().amount_purgeable_nonvolatile();
+        // NOTE: The thread count has to match the threads we actually write out.
+        process.for_each_thread([&](const Thread&) {
+            ++entry.thread_count;
+        });
+        entry.name_length = process.name().length();
+        entry.executable_length = executable.length();
+        entry.tty_length = tty.length();
+        entry.pledge_length = pledge.length();
+        entry.veil_length = veil.length();
+        append_entry(entry);
+        builder.append(process.name());
+        builder.append(executable);
+        builder.append(tty);
+        builder.append(pledge);
+        builder.append(veil);
+
+        process.for_each_thread([&](const Thread& thread) {
+            StringView state = thread.state_string();
+            auto name = thread.name();
+            ThreadStatisticsEntry thread_entry {};
+            thread_entry.tid = thread.tid().value();
+            thread_entry.times_scheduled = thread.times_scheduled();
+            thread_entry.ticks_user = thread.ticks_in_user();
+            thread_entry.ticks_kernel = thread.ticks_in_kernel();
+            thread_entry.cpu = thread.cpu();
+            thread_entry.priority = thread.priority();
+            thread_entry.cpu_affinity = thread.affinity() & Scheduler::schedulable_processors_mask();
+            thread_entry.syscall_count = thread.syscall_count();
+            thread_entry.inode_faults = thread.inode_faults();
+            thread_entry.zero_faults = thread.zero_faults();
+            thread_entry.cow_faults = thread.cow_faults();
+            thread_entry.file_read_bytes = thread.file_read_bytes();
+            thread_entry.file_write_bytes = thread.file_write_bytes();
+            thread_entry.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+            thread_entry.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+            thread_entry.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+            thread_entry.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+            thread_entry.state_length = state.length();
+            thread_entry.name_length = name.length();
+            append_entry(thread_entry);
+            builder.append(state);
+            builder.append(name);
+        });
+    };
+
+    ScopedSpinLock lock(g_scheduler_lock);
+    auto processes = Process::all_processes();
+    ProcessStatisticsHeader header { PROCESS_STATISTICS_MAGIC, PROCESS_STATISTICS_VERSION, (u32)processes.size() + 1 };
+    append_entry(header);
+    build_process(*Scheduler::colonel());
+    for (auto& process : processes)
+        build_process(process);
+    return true;
+}
+
 struct SysVariable {
     String name;
     enum class Type : u8 {
@@ -971,6 +1177,7 @@ bool ProcFS::initialize()
     static Lockable<bool>* kmalloc_stack_helper;
     static Lockable<bool>* ubsan_deadly_helper;
     static Lockable<bool>* caps_lock_to_ctrl_helper;
+    static Lockable<bool>* tcp_cubic_helper;
 
     if (kmalloc_stack_helper == nullptr) {
         kmalloc_stack_helper = new Lockable<bool>();
@@ -987,6 +1194,12 @@ bool ProcFS::initialize()
         ProcFS::add_sys_bool("caps_lock_to_ctrl", *caps_lock_to_ctrl_helper, [] {
             Kernel::g_caps_lock_remapped_to_ctrl.exchange(caps_lock_to_ctrl_helper->resource());
         });
+        // New TCP connections use CUBIC for congestion control, unless this is turned off and they use NewReno instead.
+        tcp_cubic_helper = new Lockable<bool>();
+        tcp_cubic_helper->resource() = TCPCongestionControl::default_algorithm() == TCPCongestionControl::Algorithm::Cubic;
+        ProcFS::add_sys_bool("tcp_cubic", *tcp_cubic_helper, [] {
+            TCPCongestionControl::set_default_algorithm(tcp_cubic_helper->resource() ? TCPCongestionControl::Algorithm::Cubic : TCPCongestionControl::Algorithm::NewReno);
+        });
     }
     return true;
 }
@@ -1689,12 +1902,14 @@ ProcFS::ProcFS()
     m_entries.resize(FI_MaxStaticFileIndex);
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
+    m_entries[FI_Root_all_binary] = { "all_binary", FI_Root_all_binary, false, procfs$all_binary };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_dmesg] = { "dmesg", FI_Root_dmesg, true, procfs$dmesg };
     m_entries[FI_Root_self] = { "self", FI_Root_self, false, procfs$self };
     m_entries[FI_Root_pci] = { "pci", FI_Root_pci, false, procfs$pci };
     m_entries[FI_Root_interrupts] = { "interrupts", FI_Root_interrupts, false, procfs$interrupts };
+    m_entries[FI_Root_locks] = { "locks", FI_Root_locks, true, procfs$locks };
     m_entries[FI_Root_dmi] = { "DMI", FI_Root_dmi, false, procfs$dmi };
     m_entries[FI_Root_smbios_entry_point] = { "smbios_entry_point", FI_Root_smbios_entry_point, false, procfs$smbios_entry_point };
     m_entries[FI_Root_keymap] = { "keymap", FI_Root_keymap, false, procfs$keymap };
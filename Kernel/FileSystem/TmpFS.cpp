@@ -7,6 +7,8 @@
 #include <Kernel/FileSystem/TmpFS.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
 #include <LibC/limits.h>
 
 namespace Kernel {
@@ -129,23 +131,42 @@ KResult TmpFSInode::traverse_as_directory(Function<bool(const FS::DirectoryEntry
 
 KResultOr<ssize_t> TmpFSInode::read_bytes(off_t offset, ssize_t size, UserOrKernelBuffer& buffer, FileDescription*) const
 {
-    Locker locker(m_lock, Lock::Mode::Shared);
     VERIFY(!is_directory());
     VERIFY(size >= 0);
     VERIFY(offset >= 0);
 
-    if (!m_content)
-        return 0;
-
-    if (offset >= m_metadata.size)
-        return 0;
-
-    if (static_cast<off_t>(size) > m_metadata.size - offset)
-        size = m_metadata.size - offset;
+    u8 page_buffer[PAGE_SIZE];
+    ssize_t nread = 0;
+    while (nread < size) {
+        off_t position = offset + nread;
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t nchunk;
+        RefPtr<PhysicalPage> page;
+        {
+            // NOTE: We can't hold the lock while copying into the buffer. It may be a mapping of
+            //        this very file, and paging that in needs the lock exclusively.
+            Locker locker(m_lock, Lock::Mode::Shared);
+            if (position >= m_metadata.size)
+                break;
+            nchunk = min(min(PAGE_SIZE - offset_in_page, (size_t)(size - nread)), (size_t)(m_metadata.size - position));
+            page = m_pages[position / PAGE_SIZE];
+        }
 
-    if (!buffer.write(m_content->data() + offset, size))
-        return EFAULT;
-    return size;
+        if (!page) {
+            if (!buffer.memset(0, nread, nchunk))
+                return EFAULT;
+        } else {
+            {
+                ScopedSpinLock lock(s_mm_lock);
+                memcpy(page_buffer, MM.quickmap_page(*page) + offset_in_page, nchunk);
+                MM.unquickmap_page();
+            }
+            if (!buffer.write(page_buffer, nread, nchunk))
+                return EFAULT;
+        }
+        nread += nchunk;
+    }
+    return nread;
 }
 
 KResultOr<ssize_t> TmpFSInode::write_bytes(off_t offset, ssize_t size, const UserOrKernelBuffer& buffer, FileDescription*)
@@ -159,39 +180,92 @@ KResultOr<ssize_t> TmpFSInode::write_bytes(off_t offset, ssize_t size, const Use
         return result;
 
     off_t old_size = m_metadata.size;
-    off_t new_size = m_metadata.size;
-    if ((offset + size) > new_size)
-        new_size = offset + size;
+    if (offset + size > old_size) {
+        if (auto resize_result = resize(offset + size); resize_result.is_error())
+            return resize_result;
+    }
 
-    if (new_size > old_size) {
-        if (m_content && m_content->capacity() >= (size_t)new_size) {
-            m_content->set_size(new_size);
-        } else {
-            // Grow the content buffer 2x the new sizeto accommodate repeating write() calls.
-            // Note that we're not actually committing physical memory to the buffer
-            // until it's needed. We only grow VM here.
-
-            // FIXME: Fix this so that no memcpy() is necessary, and we can just grow the
-            //        KBuffer and it will add physical pages as needed while keeping the
-            //        existing ones.
-            auto tmp = KBuffer::try_create_with_size(new_size * 2);
-            if (!tmp)
-                return ENOMEM;
-            tmp->set_size(new_size);
-            if (m_content)
-                memcpy(tmp->data(), m_content->data(), old_size);
-            m_content = move(tmp);
+    u8 page_buffer[PAGE_SIZE];
+    ssize_t nwritten = 0;
+    KResult error = KSuccess;
+    while (nwritten < size) {
+        off_t position = offset + nwritten;
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t nchunk = min(PAGE_SIZE - offset_in_page, (size_t)(size - nwritten));
+        // NOTE: The buffer may be a mapping of this very file, so we fetch the data before touching the page.
+        if (!buffer.read(page_buffer, nwritten, nchunk)) {
+            error = EFAULT;
+            break;
         }
-        m_metadata.size = new_size;
-        set_metadata_dirty(true);
-        set_metadata_dirty(false);
+        auto page = ensure_page(position / PAGE_SIZE, nchunk == PAGE_SIZE);
+        if (!page) {
+            error = ENOMEM;
+            break;
+        }
+        {
+            ScopedSpinLock lock(s_mm_lock);
+            memcpy(MM.quickmap_page(*page) + offset_in_page, page_buffer, nchunk);
+            MM.unquickmap_page();
+        }
+        nwritten += nchunk;
     }
 
-    if (!buffer.read(m_content->data() + offset, size)) // TODO: partial reads?
-        return EFAULT;
+    // Don't leave the file grown past what we actually managed to write.
+    if (nwritten < size && m_metadata.size > max(old_size, offset + nwritten))
+        (void)resize(max(old_size, offset + nwritten));
+    if (m_metadata.size != old_size)
+        notify_watchers();
 
+    if (nwritten == 0 && error.is_error())
+        return error;
     did_modify_contents();
-    return size;
+    return nwritten;
+}
+
+KResult TmpFSInode::resize(u64 new_size)
+{
+    VERIFY(m_lock.is_locked());
+    u64 old_size = m_metadata.size;
+    if (new_size == old_size)
+        return KSuccess;
+
+    // The slots we add are holes, so growing the file doesn't allocate or copy any of its data.
+    size_t new_page_count = ceil_div(new_size, (u64)PAGE_SIZE);
+    if (!m_pages.try_grow_capacity(new_page_count) || !m_pages.try_resize(new_page_count))
+        return ENOMEM;
+
+    // Whatever is past the end of the file in its last page may be stale (from before shrinking it,
+    // or from a write through a mapping), so clear it out before it becomes part of the file.
+    u64 boundary = min(old_size, new_size);
+    size_t offset_in_page = boundary % PAGE_SIZE;
+    if (offset_in_page != 0) {
+        if (auto& page = m_pages[boundary / PAGE_SIZE]) {
+            ScopedSpinLock lock(s_mm_lock);
+            memset(MM.quickmap_page(*page) + offset_in_page, 0, PAGE_SIZE - offset_in_page);
+            MM.unquickmap_page();
+        }
+    }
+
+    m_metadata.size = new_size;
+    return KSuccess;
+}
+
+RefPtr<PhysicalPage> TmpFSInode::ensure_page(size_t page_index, bool will_overwrite_entire_page)
+{
+    VERIFY(m_lock.is_locked());
+    auto& page = m_pages[page_index];
+    if (!page)
+        page = MM.allocate_user_physical_page(will_overwrite_entire_page ? MemoryManager::ShouldZeroFill::No : MemoryManager::ShouldZeroFill::Yes);
+    return page;
+}
+
+RefPtr<PhysicalPage> TmpFSInode::physical_page_for_shared_mapping(size_t page_index)
+{
+    Locker locker(m_lock);
+    if (is_directory() || page_index >= m_pages.size())
+        return nullptr;
+    // A hole needs a real page now, otherwise writes through the mapping wouldn't end up in the file.
+    return ensure_page(page_index, false);
 }
 
 RefPtr<Inode> TmpFSInode::lookup(StringView name)
@@ -316,28 +390,17 @@ KResult TmpFSInode::truncate(u64 size)
     Locker locker(m_lock);
     VERIFY(!is_directory());
 
-    if (size == 0)
-        m_content.clear();
-    else if (!m_content) {
-        m_content = KBuffer::try_create_with_size(size);
-        if (!m_content)
-            return ENOMEM;
-    } else if (static_cast<size_t>(size) < m_content->capacity()) {
-        size_t prev_size = m_metadata.size;
-        m_content->set_size(size);
-        if (prev_size < static_cast<size_t>(size))
-            memset(m_content->data() + prev_size, 0, size - prev_size);
-    } else {
-        size_t prev_size = m_metadata.size;
-        auto tmp = KBuffer::try_create_with_size(size);
-        if (!tmp)
-            return ENOMEM;
-        memcpy(tmp->data(), m_content->data(), prev_size);
-        m_content = move(tmp);
-    }
-
-    m_metadata.size = size;
+    u64 old_size = m_metadata.size;
+    if (auto result = resize(size); result.is_error())
+        return result;
     notify_watchers();
+    locker.unlock();
+
+    // Shared mappings may still be holding on to the pages we just dropped.
+    if (size < old_size) {
+        if (auto vmobject = shared_vmobject())
+            vmobject->release_pages_from(ceil_div(size, (u64)PAGE_SIZE));
+    }
     return KSuccess;
 }
 
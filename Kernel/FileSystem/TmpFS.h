@@ -10,7 +10,7 @@
 #include <AK/Optional.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
-#include <Kernel/KBuffer.h>
+#include <Kernel/VM/PhysicalPage.h>
 
 namespace Kernel {
 
@@ -27,6 +27,7 @@ public:
     virtual const char* class_name() const override { return "TmpFS"; }
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_dentry_cache() const override { return true; }
 
     virtual NonnullRefPtr<Inode> root_inode() const override;
 
@@ -70,6 +71,7 @@ public:
     virtual KResult set_atime(time_t) override;
     virtual KResult set_ctime(time_t) override;
     virtual KResult set_mtime(time_t) override;
+    virtual RefPtr<PhysicalPage> physical_page_for_shared_mapping(size_t page_index) override;
     virtual void one_ref_left() override;
 
 private:
@@ -79,10 +81,15 @@ private:
 
     void notify_watchers();
 
+    KResult resize(u64 new_size);
+    RefPtr<PhysicalPage> ensure_page(size_t page_index, bool will_overwrite_entire_page);
+
     InodeMetadata m_metadata;
     InodeIdentifier m_parent;
 
-    OwnPtr<KBuffer> m_content;
+    // The file's data, one page per slot, shared with any mappings of the file.
+    // A null slot is a hole that reads back as zeroes.
+    Vector<RefPtr<PhysicalPage>> m_pages;
     struct Child {
         String name;
         NonnullRefPtr<TmpFSInode> inode;
@@ -15,6 +15,7 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
 class File;
 class FileDescription;
 class FutexQueue;
@@ -23,6 +24,7 @@ class Inode;
 class InodeIdentifier;
 class SharedInodeVMObject;
 class InodeWatcher;
+class IORing;
 class KBuffer;
 class KResult;
 class LocalSocket;
@@ -29,20 +29,23 @@ u32 FutexQueue::wake_n_requeue(u32 wake_count, const Function<FutexQueue*()>& ge
     dbgln_if(FUTEXQUEUE_DEBUG, "FutexQueue @ {}: wake_n_requeue({}, {})", this, wake_count, requeue_count);
 
     u32 did_wake = 0, did_requeue = 0;
-    do_unblock([&](Thread::Blocker& b, void* data, bool& stop_iterating) {
-        VERIFY(data);
-        VERIFY(b.blocker_type() == Thread::Blocker::Type::Futex);
-        auto& blocker = static_cast<Thread::FutexBlocker&>(b);
-
-        dbgln_if(FUTEXQUEUE_DEBUG, "FutexQueue @ {}: wake_n_requeue unblocking {}", this, *static_cast<Thread*>(data));
-        VERIFY(did_wake < wake_count);
-        if (blocker.unblock()) {
-            if (++did_wake >= wake_count)
-                stop_iterating = true;
-            return true;
-        }
-        return false;
-    });
+    // NOTE: Waking nobody and moving everyone over to the target is perfectly fine.
+    if (wake_count > 0) {
+        do_unblock([&](Thread::Blocker& b, void* data, bool& stop_iterating) {
+            VERIFY(data);
+            VERIFY(b.blocker_type() == Thread::Blocker::Type::Futex);
+            auto& blocker = static_cast<Thread::FutexBlocker&>(b);
+
+            dbgln_if(FUTEXQUEUE_DEBUG, "FutexQueue @ {}: wake_n_requeue unblocking {}", this, *static_cast<Thread*>(data));
+            VERIFY(did_wake < wake_count);
+            if (blocker.unblock()) {
+                if (++did_wake >= wake_count)
+                    stop_iterating = true;
+                return true;
+            }
+            return false;
+        });
+    }
     is_empty = is_empty_locked();
     if (requeue_count > 0) {
         auto blockers_to_requeue = do_take_blockers(requeue_count);
@@ -104,6 +107,37 @@ u32 FutexQueue::wake_n(u32 wake_count, const Optional<u32>& bitset, bool& is_emp
     return did_wake;
 }
 
+void FutexQueue::lend_priority_to_pi_owner(Thread& owner, u32 priority)
+{
+    if (m_pi_owner != &owner) {
+        if (m_pi_owner)
+            m_pi_owner->disinherit_priority(m_inherited_priority);
+        m_pi_owner = owner;
+    }
+    owner.inherit_priority(m_inherited_priority, priority);
+}
+
+void FutexQueue::did_lock_pi(Thread& new_owner)
+{
+    if (m_pi_owner) {
+        m_pi_owner->disinherit_priority(m_inherited_priority);
+        m_pi_owner = nullptr;
+    }
+    // Whoever's still waiting from before lends the new owner their priority as well.
+    if (m_inherited_priority.priority())
+        lend_priority_to_pi_owner(new_owner, 0);
+}
+
+void FutexQueue::did_unlock_pi()
+{
+    if (m_pi_owner) {
+        m_pi_owner->disinherit_priority(m_inherited_priority);
+        m_pi_owner = nullptr;
+    }
+    if (is_empty())
+        m_inherited_priority.reset();
+}
+
 u32 FutexQueue::wake_all(bool& is_empty)
 {
     ScopedSpinLock lock(m_lock);
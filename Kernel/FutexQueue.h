@@ -33,6 +33,12 @@ public:
 
     virtual void vmobject_deleted(VMObject&) override;
 
+    // Priority inheritance for FUTEX_LOCK_PI and FUTEX_UNLOCK_PI.
+    // NOTE: These are protected by the lock of the futex queues this queue is in, not by m_lock.
+    void lend_priority_to_pi_owner(Thread& owner, u32 priority);
+    void did_lock_pi(Thread& new_owner);
+    void did_unlock_pi();
+
 protected:
     virtual bool should_add_blocker(Thread::Blocker& b, void* data) override;
 
@@ -42,6 +48,10 @@ private:
     const FlatPtr m_user_address_or_offset;
     WeakPtr<VMObject> m_vmobject;
     const bool m_is_global;
+
+    // The owner of a priority inheriting futex, while threads are waiting for it.
+    RefPtr<Thread> m_pi_owner;
+    InheritedPriority m_inherited_priority;
 };
 
 }
@@ -217,6 +217,7 @@ void FramebufferConsole::set_resolution(size_t width, size_t height, size_t pitc
 
     // Just to start cleanly, we clean the entire framebuffer
     memset(m_framebuffer_region->vaddr().as_ptr(), 0, pitch * height);
+    flush(0, 0, width, height);
 
     ConsoleManagement::the().resolution_was_changed();
 }
@@ -259,6 +260,7 @@ void FramebufferConsole::clear(size_t x, size_t y, size_t length) const
             memset(offset_in_framebuffer, 0, width() * sizeof(u32));
             offset_in_framebuffer = (u32*)((u8*)offset_in_framebuffer + width() * 4);
         }
+        flush(0, y * 8, width(), 8);
         return;
     }
     for (size_t index = 0; index < length; index++) {
@@ -269,6 +271,7 @@ void FramebufferConsole::clear(size_t x, size_t y, size_t length) const
                 y = 0;
         }
         clear_glyph(x, y);
+        flush_glyph(x, y);
     }
 }
 
@@ -282,10 +285,17 @@ void FramebufferConsole::clear_glyph(size_t x, size_t y) const
     }
 }
 
+void FramebufferConsole::flush(size_t x, size_t y, size_t width, size_t height) const
+{
+    if (m_flush_callback)
+        m_flush_callback(x, y, width, height);
+}
+
 void FramebufferConsole::enable()
 {
     ScopedSpinLock lock(m_lock);
     memset(m_framebuffer_region->vaddr().as_ptr(), 0, height() * width() * sizeof(u32));
+    flush(0, 0, width(), height());
     m_enabled.store(true);
 }
 void FramebufferConsole::disable()
@@ -333,6 +343,7 @@ void FramebufferConsole::write(size_t x, size_t y, char ch, Color background, Co
         }
         offset_in_framebuffer = (u32*)((u8*)offset_in_framebuffer + width() * 4);
     }
+    flush_glyph(x, y);
     m_x = x + 1;
     if (m_x >= max_column()) {
         m_x = 0;
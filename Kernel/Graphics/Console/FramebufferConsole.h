@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/RefCounted.h>
 #include <AK/Types.h>
 #include <Kernel/Graphics/Console/Console.h>
@@ -18,6 +19,10 @@ public:
 
     void set_resolution(size_t width, size_t height, size_t pitch);
 
+    // Adapters that only show the parts of the framebuffer they're told about get told from here, in pixels.
+    using FlushCallback = Function<void(size_t x, size_t y, size_t width, size_t height)>;
+    void set_flush_callback(FlushCallback callback) { m_flush_callback = move(callback); }
+
     virtual size_t bytes_per_base_glyph() const override;
     virtual size_t chars_per_line() const override;
 
@@ -41,10 +46,13 @@ public:
 
 protected:
     void clear_glyph(size_t x, size_t y) const;
+    void flush(size_t x, size_t y, size_t width, size_t height) const;
+    void flush_glyph(size_t x, size_t y) const { flush(x * 8, y * 8, 8, 8); }
     FramebufferConsole(PhysicalAddress, size_t width, size_t height, size_t pitch);
     OwnPtr<Region> m_framebuffer_region;
     PhysicalAddress m_framebuffer_address;
     size_t m_pitch;
     mutable SpinLock<u8> m_lock;
+    FlushCallback m_flush_callback;
 };
 }
@@ -20,6 +20,7 @@
 
 #define MAX_RESOLUTION_WIDTH 4096
 #define MAX_RESOLUTION_HEIGHT 2160
+#define MAX_FLUSH_RECTS_PER_BATCH 16
 
 namespace Kernel {
 
@@ -162,6 +163,38 @@ int FramebufferDevice::ioctl(FileDescription&, unsigned request, FlatPtr arg)
         m_graphics_adapter->set_y_offset(m_output_port_index, arg == 0 ? 0 : m_framebuffer_height);
         return 0;
     }
+    case FB_IOCTL_FLUSH_RECTS: {
+        if (!m_graphics_adapter->partial_flush_support())
+            return -ENOTIMPL;
+        FBRects user_rects;
+        if (!copy_from_user(&user_rects, (FBRects*)arg))
+            return -EFAULT;
+        // NOTE: Userspace can't do anything useful with the framebuffer while the console has it.
+        if (!m_graphical_writes_enabled)
+            return 0;
+
+        auto framebuffer_height = framebuffer_size_in_bytes() / m_framebuffer_pitch;
+        FBRect rects[MAX_FLUSH_RECTS_PER_BATCH];
+        for (size_t first_rect = 0; first_rect < user_rects.count; first_rect += MAX_FLUSH_RECTS_PER_BATCH) {
+            auto rect_count = min<size_t>(user_rects.count - first_rect, MAX_FLUSH_RECTS_PER_BATCH);
+            if (!copy_n_from_user(rects, user_rects.rects + first_rect, rect_count))
+                return -EFAULT;
+            size_t clipped_rect_count = 0;
+            for (size_t i = 0; i < rect_count; ++i) {
+                auto& rect = rects[i];
+                if (rect.x >= m_framebuffer_width || rect.y >= framebuffer_height)
+                    continue;
+                rect.width = min<size_t>(rect.width, m_framebuffer_width - rect.x);
+                rect.height = min<size_t>(rect.height, framebuffer_height - rect.y);
+                if (rect.width == 0 || rect.height == 0)
+                    continue;
+                rects[clipped_rect_count++] = rect;
+            }
+            if (clipped_rect_count > 0)
+                m_graphics_adapter->flush_rectangles(m_output_port_index, { rects, clipped_rect_count });
+        }
+        return 0;
+    }
     case FB_IOCTL_GET_RESOLUTION: {
         auto* user_resolution = (FBResolution*)arg;
         FBResolution resolution;
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <AK/Types.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/PhysicalAddress.h>
+#include <LibC/sys/ioctl_numbers.h>
 
 namespace Kernel {
 class GraphicsDevice : public RefCounted<GraphicsDevice> {
@@ -18,6 +20,7 @@ public:
         VGACompatible,
         Bochs,
         SVGA,
+        VirtIO,
         Raw
     };
     virtual ~GraphicsDevice() = default;
@@ -34,6 +37,11 @@ public:
     virtual bool try_to_set_resolution(size_t output_port_index, size_t width, size_t height) = 0;
     virtual bool set_y_offset(size_t output_port_index, size_t y) = 0;
 
+    // Adapters that don't keep scanning out the framebuffer by themselves have to be told which parts of it changed.
+    // NOTE: The rectangles are in framebuffer coordinates, they're already clipped to the framebuffer.
+    virtual bool partial_flush_support() const { return false; }
+    virtual void flush_rectangles(size_t, Span<const FBRect>) { }
+
 protected:
     GraphicsDevice() = default;
 
@@ -14,8 +14,10 @@
 #include <Kernel/Graphics/GraphicsManagement.h>
 #include <Kernel/Graphics/IntelNativeGraphicsAdapter.h>
 #include <Kernel/Graphics/VGACompatibleAdapter.h>
+#include <Kernel/Graphics/VirtIOGraphicsAdapter.h>
 #include <Kernel/IO.h>
 #include <Kernel/Multiboot.h>
+#include <Kernel/PCI/IDs.h>
 #include <Kernel/Panic.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 
@@ -57,6 +59,11 @@ UNMAP_AFTER_INIT RefPtr<GraphicsDevice> GraphicsManagement::determine_graphics_d
     if ((id.vendor_id == 0x1234 && id.device_id == 0x1111) || (id.vendor_id == 0x80ee && id.device_id == 0xbeef)) {
         return BochsGraphicsAdapter::initialize(address);
     }
+    if (id.vendor_id == (u16)PCIVendorID::VirtIO && id.device_id == (u16)PCIDeviceID::VirtIOGPU && !kernel_command_line().disable_virtio()) {
+        // NOTE: If this is a virtio-vga device, it can still be driven as a plain VGA adapter below.
+        if (auto adapter = VirtIOGraphicsAdapter::try_to_initialize(address))
+            return adapter;
+    }
     if (PCI::get_class(address) == 0x3 && PCI::get_subclass(address) == 0x0) {
         if (id.vendor_id == 0x8086) {
             auto adapter = IntelNativeGraphicsAdapter::initialize(address);
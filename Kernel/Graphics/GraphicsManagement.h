@@ -21,10 +21,12 @@ namespace Kernel {
 class BochsGraphicsAdapter;
 class IntelNativeGraphicsAdapter;
 class VGACompatibleAdapter;
+class VirtIOGraphicsAdapter;
 class GraphicsManagement {
     friend class BochsGraphicsAdapter;
     friend class IntelNativeGraphicsAdapter;
     friend class VGACompatibleAdapter;
+    friend class VirtIOGraphicsAdapter;
     AK_MAKE_ETERNAL
 
 public:
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Graphics/VirtIOGPU.h>
+#include <Kernel/PCI/IDs.h>
+
+namespace Kernel {
+
+#define VIRTIO_GPU_CMD_GET_DISPLAY_INFO 0x0100
+#define VIRTIO_GPU_CMD_RESOURCE_CREATE_2D 0x0101
+#define VIRTIO_GPU_CMD_RESOURCE_UNREF 0x0102
+#define VIRTIO_GPU_CMD_SET_SCANOUT 0x0103
+#define VIRTIO_GPU_CMD_RESOURCE_FLUSH 0x0104
+#define VIRTIO_GPU_CMD_TRANSFER_TO_HOST_2D 0x0105
+#define VIRTIO_GPU_CMD_RESOURCE_ATTACH_BACKING 0x0106
+#define VIRTIO_GPU_CMD_RESOURCE_DETACH_BACKING 0x0107
+
+#define VIRTIO_GPU_RESP_OK_NODATA 0x1100
+#define VIRTIO_GPU_RESP_OK_DISPLAY_INFO 0x1101
+#define VIRTIO_GPU_RESP_ERR_UNSPEC 0x1200
+
+#define VIRTIO_GPU_FORMAT_B8G8R8X8_UNORM 2
+#define VIRTIO_GPU_MAX_SCANOUTS 16
+#define VIRTIO_GPU_EVENT_DISPLAY (1 << 0)
+
+// virtio_gpu_config
+#define VIRTIO_GPU_CONFIG_EVENTS_READ 0x0
+#define VIRTIO_GPU_CONFIG_EVENTS_CLEAR 0x4
+
+struct [[gnu::packed]] VirtIOGPUControlHeader {
+    u32 type;
+    u32 flags;
+    u64 fence_id;
+    u32 context_id;
+    u32 padding;
+};
+
+struct [[gnu::packed]] VirtIOGPURect {
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+};
+
+struct [[gnu::packed]] VirtIOGPUDisplayInfoResponse {
+    VirtIOGPUControlHeader header;
+    struct [[gnu::packed]] {
+        VirtIOGPURect rect;
+        u32 enabled;
+        u32 flags;
+    } modes[VIRTIO_GPU_MAX_SCANOUTS];
+};
+
+struct [[gnu::packed]] VirtIOGPUResourceCreate2D {
+    VirtIOGPUControlHeader header;
+    u32 resource_id;
+    u32 format;
+    u32 width;
+    u32 height;
+};
+
+struct [[gnu::packed]] VirtIOGPUResourceUnref {
+    VirtIOGPUControlHeader header;
+    u32 resource_id;
+    u32 padding;
+};
+
+struct [[gnu::packed]] VirtIOGPUSetScanout {
+    VirtIOGPUControlHeader header;
+    VirtIOGPURect rect;
+    u32 scanout_id;
+    u32 resource_id;
+};
+
+struct [[gnu::packed]] VirtIOGPUResourceFlush {
+    VirtIOGPUControlHeader header;
+    VirtIOGPURect rect;
+    u32 resource_id;
+    u32 padding;
+};
+
+struct [[gnu::packed]] VirtIOGPUTransferToHost2D {
+    VirtIOGPUControlHeader header;
+    VirtIOGPURect rect;
+    u64 offset;
+    u32 resource_id;
+    u32 padding;
+};
+
+// NOTE: The framebuffer is physically contiguous, so it only ever needs one memory entry.
+struct [[gnu::packed]] VirtIOGPUResourceAttachBacking {
+    VirtIOGPUControlHeader header;
+    u32 resource_id;
+    u32 entry_count;
+    u64 address;
+    u32 length;
+    u32 padding;
+};
+
+struct [[gnu::packed]] VirtIOGPUResourceDetachBacking {
+    VirtIOGPUControlHeader header;
+    u32 resource_id;
+    u32 padding;
+};
+
+static VirtIOGPUControlHeader make_header(u32 type)
+{
+    return { type, 0, 0, 0, 0 };
+}
+
+static VirtIOGPURect to_virtio_rect(const FBRect& rect)
+{
+    return { rect.x, rect.y, rect.width, rect.height };
+}
+
+UNMAP_AFTER_INIT OwnPtr<VirtIOGPU> VirtIOGPU::try_to_initialize(PCI::Address address)
+{
+    auto id = PCI::get_id(address);
+    if (id.vendor_id != (u16)PCIVendorID::VirtIO || id.device_id != (u16)PCIDeviceID::VirtIOGPU)
+        return {};
+    auto gpu = adopt_own_if_nonnull(new VirtIOGPU(address));
+    if (!gpu)
+        return {};
+    if (!gpu->initialize())
+        return {};
+    return gpu;
+}
+
+UNMAP_AFTER_INIT VirtIOGPU::VirtIOGPU(PCI::Address address)
+    : VirtIODevice(address, "VirtIOGPU")
+{
+}
+
+VirtIOGPU::~VirtIOGPU()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIOGPU::initialize()
+{
+    if (!get_config(ConfigurationType::Device)) {
+        dbgln("{}: Device has no configuration", m_class_name);
+        return false;
+    }
+
+    // NOTE: We don't want 3D (VIRTIO_GPU_F_VIRGL), or anything else on top of plain 2D.
+    bool success = negotiate_features([&](u64) {
+        return 0;
+    });
+    if (!success || !setup_queues(1))
+        return false;
+    finish_init();
+
+    auto& queue = get_queue(CONTROLQ);
+    queue.disable_interrupts();
+    m_max_queued_commands = min<size_t>(max_queued_commands, queue.size() / 2);
+    if (m_max_queued_commands < 2) {
+        dbgln("{}: Control queue is too small", m_class_name);
+        return false;
+    }
+    m_commands_region = MM.allocate_contiguous_kernel_region(page_round_up(max_queued_commands * command_slot_size), "VirtIOGPU Commands", Region::Access::Read | Region::Access::Write);
+    if (!m_commands_region)
+        return false;
+    return true;
+}
+
+u8* VirtIOGPU::command_slot(size_t slot_index) const
+{
+    return m_commands_region->vaddr().offset(slot_index * command_slot_size).as_ptr();
+}
+
+void VirtIOGPU::queue_command(const void* request, size_t request_size, size_t response_size)
+{
+    VERIFY(m_operation_lock.is_locked());
+    VERIFY(m_queued_command_count < m_max_queued_commands);
+    VERIFY(request_size <= command_response_offset);
+    VERIFY(command_response_offset + response_size <= command_slot_size);
+    auto slot_index = m_queued_command_count++;
+    auto* slot = command_slot(slot_index);
+    memcpy(slot, request, request_size);
+    memset(slot + command_response_offset, 0, response_size);
+    m_queued_commands[slot_index] = { request_size, response_size };
+}
+
+bool VirtIOGPU::submit_queued_commands()
+{
+    VERIFY(m_operation_lock.is_locked());
+    auto command_count = m_queued_command_count;
+    m_queued_command_count = 0;
+    if (command_count == 0)
+        return true;
+
+    auto& queue = get_queue(CONTROLQ);
+    auto commands_address = m_commands_region->physical_page(0)->paddr();
+    {
+        ScopedSpinLock queue_lock(queue.lock());
+        for (size_t i = 0; i < command_count; ++i) {
+            auto slot_address = commands_address.offset(i * command_slot_size);
+            VirtIOQueueChain chain(queue);
+            // NOTE: Every earlier command is done by now, so there's always room for all of ours.
+            bool was_added = chain.add_buffer_to_chain(slot_address, m_queued_commands[i].request_size, BufferType::DeviceReadable);
+            was_added = was_added && chain.add_buffer_to_chain(slot_address.offset(command_response_offset), m_queued_commands[i].response_size, BufferType::DeviceWritable);
+            VERIFY(was_added);
+            chain.submit_to_queue();
+        }
+        notify_queue_if_needed(CONTROLQ);
+    }
+
+    for (size_t completed_count = 0; completed_count < command_count;) {
+        {
+            ScopedSpinLock queue_lock(queue.lock());
+            size_t used;
+            auto chain = queue.pop_used_buffer_chain(used);
+            if (!chain.is_empty()) {
+                chain.release_buffer_slots_to_queue();
+                ++completed_count;
+                continue;
+            }
+        }
+        Processor::wait_check();
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < command_count; ++i) {
+        auto& request = *reinterpret_cast<const VirtIOGPUControlHeader*>(command_slot(i));
+        auto& response = *reinterpret_cast<const VirtIOGPUControlHeader*>(command_slot(i) + command_response_offset);
+        if (response.type >= VIRTIO_GPU_RESP_ERR_UNSPEC) {
+            dbgln("{}: Command {:#04x} failed with {:#04x}", m_class_name, request.type, response.type);
+            success = false;
+        }
+    }
+    return success;
+}
+
+Optional<FBRect> VirtIOGPU::query_display_rectangle()
+{
+    static_assert(command_response_offset + sizeof(VirtIOGPUDisplayInfoResponse) <= command_slot_size);
+    ScopedSpinLock lock(m_operation_lock);
+    queue_command(make_header(VIRTIO_GPU_CMD_GET_DISPLAY_INFO), sizeof(VirtIOGPUDisplayInfoResponse));
+    if (!submit_queued_commands())
+        return {};
+    auto& response = *reinterpret_cast<const VirtIOGPUDisplayInfoResponse*>(command_slot(0) + command_response_offset);
+    if (response.header.type != VIRTIO_GPU_RESP_OK_DISPLAY_INFO)
+        return {};
+    // NOTE: We only drive the first scanout.
+    auto& mode = response.modes[0];
+    if (!mode.enabled || mode.rect.width == 0 || mode.rect.height == 0)
+        return {};
+    return FBRect { mode.rect.x, mode.rect.y, mode.rect.width, mode.rect.height };
+}
+
+bool VirtIOGPU::set_framebuffer(PhysicalAddress framebuffer_address, size_t width, size_t height)
+{
+    ScopedSpinLock lock(m_operation_lock);
+    auto resource_id = m_next_resource_id++;
+
+    // NOTE: The new resource shares the framebuffer with the old one, which keeps being shown until the new one is ready.
+    VirtIOGPUResourceCreate2D create { make_header(VIRTIO_GPU_CMD_RESOURCE_CREATE_2D), resource_id, VIRTIO_GPU_FORMAT_B8G8R8X8_UNORM, (u32)width, (u32)height };
+    queue_command(create);
+    VirtIOGPUResourceAttachBacking attach { make_header(VIRTIO_GPU_CMD_RESOURCE_ATTACH_BACKING), resource_id, 1, framebuffer_address.get(), (u32)(width * height * sizeof(u32)), 0 };
+    queue_command(attach);
+    VirtIOGPUSetScanout scanout { make_header(VIRTIO_GPU_CMD_SET_SCANOUT), { 0, 0, (u32)width, (u32)height }, 0, resource_id };
+    queue_command(scanout);
+    bool success = submit_queued_commands();
+
+    // Whichever resource isn't shown now goes away.
+    auto unused_resource_id = success ? m_resource_id : resource_id;
+    if (unused_resource_id != 0) {
+        VirtIOGPUResourceDetachBacking detach { make_header(VIRTIO_GPU_CMD_RESOURCE_DETACH_BACKING), unused_resource_id, 0 };
+        queue_command(detach);
+        VirtIOGPUResourceUnref unref { make_header(VIRTIO_GPU_CMD_RESOURCE_UNREF), unused_resource_id, 0 };
+        queue_command(unref);
+        submit_queued_commands();
+    }
+    if (!success)
+        return false;
+
+    m_resource_id = resource_id;
+    m_framebuffer_width = width;
+    m_framebuffer_height = height;
+    queue_flush({ 0, 0, (unsigned)width, (unsigned)height });
+    return submit_queued_commands();
+}
+
+void VirtIOGPU::queue_flush(const FBRect& rect)
+{
+    VERIFY(m_operation_lock.is_locked());
+    u64 offset = ((u64)rect.y * m_framebuffer_width + rect.x) * sizeof(u32);
+    VirtIOGPUTransferToHost2D transfer { make_header(VIRTIO_GPU_CMD_TRANSFER_TO_HOST_2D), to_virtio_rect(rect), offset, m_resource_id, 0 };
+    queue_command(transfer);
+    VirtIOGPUResourceFlush flush { make_header(VIRTIO_GPU_CMD_RESOURCE_FLUSH), to_virtio_rect(rect), m_resource_id, 0 };
+    queue_command(flush);
+}
+
+void VirtIOGPU::flush_rectangles(Span<const FBRect> rects)
+{
+    ScopedSpinLock lock(m_operation_lock);
+    if (m_resource_id == 0)
+        return;
+    for (auto& rect : rects) {
+        if (rect.x + rect.width > m_framebuffer_width || rect.y + rect.height > m_framebuffer_height)
+            continue;
+        if (m_queued_command_count + 2 > m_max_queued_commands)
+            submit_queued_commands();
+        queue_flush(rect);
+    }
+    submit_queued_commands();
+}
+
+bool VirtIOGPU::handle_device_config_change()
+{
+    auto& config = *get_config(ConfigurationType::Device);
+    u32 events = config_read32(config, VIRTIO_GPU_CONFIG_EVENTS_READ);
+    // FIXME: Follow the host when it resizes the display. WindowServer can't be told about a new resolution yet.
+    if (events & VIRTIO_GPU_EVENT_DISPLAY)
+        dbgln_if(VIRTIO_DEBUG, "{}: Display configuration changed", m_class_name);
+    config_write32(config, VIRTIO_GPU_CONFIG_EVENTS_CLEAR, events);
+    return true;
+}
+
+void VirtIOGPU::handle_queue_update(u16 queue_index)
+{
+    // NOTE: submit_queued_commands() polls for the used buffers by itself.
+    VERIFY(queue_index == CONTROLQ);
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Span.h>
+#include <Kernel/VirtIO/VirtIO.h>
+#include <LibC/sys/ioctl_numbers.h>
+
+namespace Kernel {
+
+// The virtio-gpu device itself, driven in 2D mode. VirtIOGraphicsAdapter puts a framebuffer on top of it.
+//
+// The device shows a copy of our framebuffer that it keeps on the host, so nothing shows up until we tell it
+// which parts of the framebuffer changed. In turn, the host only has to redraw those parts.
+class VirtIOGPU final : public VirtIODevice {
+public:
+    static OwnPtr<VirtIOGPU> try_to_initialize(PCI::Address);
+    virtual ~VirtIOGPU() override;
+
+    // ^IRQHandler
+    virtual const char* purpose() const override { return m_class_name.characters(); }
+
+    // The size the host would like the display to be, if it has an opinion.
+    Optional<FBRect> query_display_rectangle();
+    // Shows a width x height framebuffer of 32-bit pixels, which has to be physically contiguous.
+    bool set_framebuffer(PhysicalAddress, size_t width, size_t height);
+    // Copies these parts of the framebuffer over to the host, and shows them.
+    // NOTE: This can be called from anywhere, since it doesn't wait for an interrupt.
+    void flush_rectangles(Span<const FBRect>);
+
+private:
+    static constexpr u16 CONTROLQ = 0;
+    static constexpr size_t max_queued_commands = 16;
+    // Every command has its request, and then its response, in a slot of this size in m_commands_region.
+    static constexpr size_t command_slot_size = 512;
+    static constexpr size_t command_response_offset = 64;
+
+    explicit VirtIOGPU(PCI::Address);
+    bool initialize();
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    template<typename T>
+    void queue_command(const T& request, size_t response_size = 24)
+    {
+        static_assert(sizeof(T) <= command_response_offset);
+        queue_command(&request, sizeof(T), response_size);
+    }
+    void queue_command(const void* request, size_t request_size, size_t response_size);
+    // Hands all queued commands to the device at once, and waits for it to be done with them.
+    bool submit_queued_commands();
+    u8* command_slot(size_t slot_index) const;
+
+    // Takes up two command slots, one to copy the rectangle over to the host and one to show it.
+    void queue_flush(const FBRect&);
+
+    // Commands are few and quick, so we poll for them instead of taking an interrupt. This works before there's a scheduler, too.
+    SpinLock<u8> m_operation_lock;
+    OwnPtr<Region> m_commands_region;
+    struct QueuedCommand {
+        size_t request_size { 0 };
+        size_t response_size { 0 };
+    };
+    Array<QueuedCommand, max_queued_commands> m_queued_commands;
+    size_t m_queued_command_count { 0 };
+    size_t m_max_queued_commands { 0 };
+
+    size_t m_framebuffer_width { 0 };
+    size_t m_framebuffer_height { 0 };
+    u32 m_resource_id { 0 };
+    u32 m_next_resource_id { 1 };
+};
+
+}
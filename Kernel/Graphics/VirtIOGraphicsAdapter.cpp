@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <Kernel/Graphics/GraphicsManagement.h>
+#include <Kernel/Graphics/VirtIOGraphicsAdapter.h>
+
+namespace Kernel {
+
+// We leave room for switching up to this resolution later, if there's enough memory for it.
+static constexpr size_t max_preallocated_width = 1920;
+static constexpr size_t max_preallocated_height = 1080;
+
+UNMAP_AFTER_INIT RefPtr<VirtIOGraphicsAdapter> VirtIOGraphicsAdapter::try_to_initialize(PCI::Address address)
+{
+    auto gpu = VirtIOGPU::try_to_initialize(address);
+    if (!gpu)
+        return {};
+    auto adapter = adopt_ref(*new VirtIOGraphicsAdapter(gpu.release_nonnull()));
+    if (!adapter->initialize())
+        return {};
+    return adapter;
+}
+
+UNMAP_AFTER_INIT VirtIOGraphicsAdapter::VirtIOGraphicsAdapter(NonnullOwnPtr<VirtIOGPU> gpu)
+    : m_gpu(move(gpu))
+{
+}
+
+VirtIOGraphicsAdapter::~VirtIOGraphicsAdapter()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIOGraphicsAdapter::initialize()
+{
+    size_t width = 1024;
+    size_t height = 768;
+    if (auto display_rectangle = m_gpu->query_display_rectangle(); display_rectangle.has_value()) {
+        width = display_rectangle.value().width;
+        height = display_rectangle.value().height;
+    }
+
+    auto preallocated_size = page_round_up(max(width * height, max_preallocated_width * max_preallocated_height) * sizeof(u32));
+    m_framebuffer_pages = MM.allocate_contiguous_user_physical_pages(preallocated_size);
+    if (m_framebuffer_pages.is_empty())
+        m_framebuffer_pages = MM.allocate_contiguous_user_physical_pages(page_round_up(width * height * sizeof(u32)));
+    if (m_framebuffer_pages.is_empty()) {
+        dbgln("VirtIOGraphicsAdapter: Couldn't allocate a framebuffer for {}x{}", width, height);
+        return false;
+    }
+
+    m_framebuffer_console = Graphics::FramebufferConsole::initialize(m_framebuffer_pages[0].paddr(), width, height, width * sizeof(u32));
+    if (!try_to_set_resolution(0, width, height))
+        return false;
+    m_framebuffer_console->set_flush_callback([this](size_t x, size_t y, size_t width, size_t height) {
+        FBRect rect { (unsigned)x, (unsigned)y, (unsigned)width, (unsigned)height };
+        m_gpu->flush_rectangles({ &rect, 1 });
+    });
+    // FIXME: This is a very wrong way to do this...
+    if (!GraphicsManagement::the().m_console)
+        GraphicsManagement::the().m_console = m_framebuffer_console;
+
+    dmesgln("VirtIOGraphicsAdapter: {}x{}, room for up to {} KiB of framebuffer", width, height, m_framebuffer_pages.size() * PAGE_SIZE / KiB);
+    return true;
+}
+
+UNMAP_AFTER_INIT void VirtIOGraphicsAdapter::initialize_framebuffer_devices()
+{
+    m_framebuffer_device = FramebufferDevice::create(*this, 0, m_framebuffer_pages[0].paddr(), m_framebuffer_width, m_framebuffer_height, m_framebuffer_width * sizeof(u32));
+    m_framebuffer_device->initialize();
+}
+
+bool VirtIOGraphicsAdapter::try_to_set_resolution(size_t output_port_index, size_t width, size_t height)
+{
+    VERIFY(output_port_index == 0);
+    if (width == 0 || height == 0 || Checked<size_t>::multiplication_would_overflow(width, height, sizeof(u32)))
+        return false;
+    if (width * height * sizeof(u32) > m_framebuffer_pages.size() * PAGE_SIZE)
+        return false;
+    if (!m_gpu->set_framebuffer(m_framebuffer_pages[0].paddr(), width, height))
+        return false;
+    m_framebuffer_width = width;
+    m_framebuffer_height = height;
+    dbgln("VirtIOGraphicsAdapter: resolution set to {}x{}", width, height);
+    m_framebuffer_console->set_resolution(width, height, width * sizeof(u32));
+    return true;
+}
+
+bool VirtIOGraphicsAdapter::set_y_offset(size_t output_port_index, size_t y_offset)
+{
+    VERIFY(output_port_index == 0);
+    return y_offset == 0;
+}
+
+void VirtIOGraphicsAdapter::flush_rectangles(size_t output_port_index, Span<const FBRect> rects)
+{
+    VERIFY(output_port_index == 0);
+    m_gpu->flush_rectangles(rects);
+}
+
+void VirtIOGraphicsAdapter::enable_consoles()
+{
+    ScopedSpinLock lock(m_console_mode_switch_lock);
+    VERIFY(m_framebuffer_console);
+    m_console_enabled = true;
+    if (m_framebuffer_device)
+        m_framebuffer_device->deactivate_writes();
+    m_framebuffer_console->enable();
+}
+
+void VirtIOGraphicsAdapter::disable_consoles()
+{
+    ScopedSpinLock lock(m_console_mode_switch_lock);
+    VERIFY(m_framebuffer_console);
+    VERIFY(m_framebuffer_device);
+    m_console_enabled = false;
+    m_framebuffer_console->disable();
+    m_framebuffer_device->activate_writes();
+    // The graphical image got put back into the framebuffer, so the host has to see all of it again.
+    FBRect rect { 0, 0, (unsigned)m_framebuffer_width, (unsigned)m_framebuffer_height };
+    m_gpu->flush_rectangles({ &rect, 1 });
+}
+
+}
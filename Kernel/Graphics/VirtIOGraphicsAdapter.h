@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <Kernel/Graphics/Console/FramebufferConsole.h>
+#include <Kernel/Graphics/FramebufferDevice.h>
+#include <Kernel/Graphics/GraphicsDevice.h>
+#include <Kernel/Graphics/VirtIOGPU.h>
+#include <Kernel/VM/PhysicalPage.h>
+
+namespace Kernel {
+
+class GraphicsManagement;
+
+// A display adapter on top of a virtio-gpu device.
+// NOTE: There's no double buffering, since flipping would make the host redraw the whole screen every time.
+class VirtIOGraphicsAdapter final : public GraphicsDevice {
+    friend class GraphicsManagement;
+
+public:
+    static RefPtr<VirtIOGraphicsAdapter> try_to_initialize(PCI::Address);
+    virtual ~VirtIOGraphicsAdapter() override;
+
+    virtual bool framebuffer_devices_initialized() const override { return !m_framebuffer_device.is_null(); }
+
+    virtual bool modesetting_capable() const override { return true; }
+    virtual bool double_framebuffering_capable() const override { return false; }
+    virtual bool partial_flush_support() const override { return true; }
+
+private:
+    explicit VirtIOGraphicsAdapter(NonnullOwnPtr<VirtIOGPU>);
+    bool initialize();
+
+    // ^GraphicsDevice
+    virtual bool try_to_set_resolution(size_t output_port_index, size_t width, size_t height) override;
+    virtual bool set_y_offset(size_t output_port_index, size_t y) override;
+    virtual void flush_rectangles(size_t output_port_index, Span<const FBRect>) override;
+    virtual void initialize_framebuffer_devices() override;
+    virtual Type type() const override { return Type::VirtIO; }
+    virtual void enable_consoles() override;
+    virtual void disable_consoles() override;
+
+    NonnullOwnPtr<VirtIOGPU> m_gpu;
+
+    // NOTE: This has room for the largest resolution we can switch to.
+    NonnullRefPtrVector<PhysicalPage> m_framebuffer_pages;
+    size_t m_framebuffer_width { 0 };
+    size_t m_framebuffer_height { 0 };
+
+    RefPtr<FramebufferDevice> m_framebuffer_device;
+    RefPtr<Graphics::FramebufferConsole> m_framebuffer_console;
+    SpinLock<u8> m_console_mode_switch_lock;
+    bool m_console_enabled { false };
+};
+
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Debug.h>
+#include <Kernel/HardwarePerformanceCounters.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/PerformanceManager.h>
+
+namespace Kernel {
+
+#define MSR_IA32_PMC0 0xc1
+#define MSR_IA32_PERFEVTSEL0 0x186
+#define MSR_IA32_FIXED_CTR0 0x309
+#define MSR_IA32_FIXED_CTR_CTRL 0x38d
+#define MSR_IA32_PERF_GLOBAL_STATUS 0x38e
+#define MSR_IA32_PERF_GLOBAL_CTRL 0x38f
+#define MSR_IA32_PERF_GLOBAL_OVF_CTRL 0x390
+
+#define PERFEVTSEL_USR (1 << 16)
+#define PERFEVTSEL_OS (1 << 17)
+#define PERFEVTSEL_INT (1 << 20)
+#define PERFEVTSEL_EN (1 << 22)
+
+// Every fixed-function counter has 4 bits in IA32_FIXED_CTR_CTRL.
+#define FIXED_CTR_CTRL_OS 0x1
+#define FIXED_CTR_CTRL_USR 0x2
+#define FIXED_CTR_CTRL_PMI 0x8
+
+struct ArchitecturalEvent {
+    int event_type;
+    // The bit in CPUID.0AH:EBX that says this event is *not* available.
+    u8 unavailable_bit;
+    u8 event_select;
+    u8 unit_mask;
+    // Which fixed-function counter counts this, if any does.
+    Optional<u8> fixed_counter;
+    // How many events make a sample. These aim for about a thousand samples per second on a busy processor.
+    u32 period;
+};
+
+static const ArchitecturalEvent s_architectural_events[] = {
+    { PERF_EVENT_INSTRUCTIONS, 1, 0xc0, 0x00, 0, 1'000'000 },
+    { PERF_EVENT_CYCLES, 0, 0x3c, 0x00, 1, 1'000'000 },
+    { PERF_EVENT_CACHE_MISS, 4, 0x2e, 0x41, {}, 1'000 },
+    { PERF_EVENT_BRANCH_MISS, 6, 0xc5, 0x00, {}, 10'000 },
+};
+
+static AK::Singleton<HardwarePerformanceCounters> s_the;
+
+HardwarePerformanceCounters& HardwarePerformanceCounters::the()
+{
+    return *s_the;
+}
+
+HardwarePerformanceCounters::HardwarePerformanceCounters()
+{
+    if (!MSR::have() || !APIC::initialized() || CPUID(0).eax() < 0xa)
+        return;
+
+    CPUID id(0xa);
+    m_version = id.eax() & 0xff;
+    m_general_counter_count = (id.eax() >> 8) & 0xff;
+    m_general_counter_width = (id.eax() >> 16) & 0xff;
+    u8 event_vector_length = (id.eax() >> 24) & 0xff;
+    m_unavailable_events = id.ebx() | ~((1u << min<u8>(event_vector_length, 31)) - 1);
+    if (m_version >= 2) {
+        m_fixed_counter_count = id.edx() & 0x1f;
+        m_fixed_counter_width = (id.edx() >> 5) & 0xff;
+    }
+
+    dbgln_if(PROFILING_DEBUG, "HardwarePerformanceCounters: Version {}, {} general-purpose counters ({} bits), {} fixed-function counters ({} bits)",
+        m_version, m_general_counter_count, m_general_counter_width, m_fixed_counter_count, m_fixed_counter_width);
+}
+
+KResult HardwarePerformanceCounters::enable(u64 events)
+{
+    VERIFY((events & event_mask) != 0);
+    if (!is_supported())
+        return ENOTSUP;
+
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_enable_count++ > 0)
+            return KSuccess;
+
+        m_counter_count = 0;
+        u8 next_general_counter = 0;
+        for (auto& event : s_architectural_events) {
+            if (!(events & event.event_type))
+                continue;
+            if (m_unavailable_events & (1u << event.unavailable_bit)) {
+                --m_enable_count;
+                return ENOTSUP;
+            }
+            Counter counter;
+            counter.event_type = event.event_type;
+            counter.period = event.period;
+            if (event.fixed_counter.has_value() && event.fixed_counter.value() < m_fixed_counter_count) {
+                counter.is_fixed = true;
+                counter.index = event.fixed_counter.value();
+            } else {
+                if (next_general_counter >= m_general_counter_count) {
+                    --m_enable_count;
+                    return ENOTSUP;
+                }
+                counter.index = next_general_counter++;
+                counter.event_select = event.event_select;
+                counter.unit_mask = event.unit_mask;
+            }
+            m_counters[m_counter_count++] = counter;
+        }
+    }
+
+    update_all_processors();
+    return KSuccess;
+}
+
+void HardwarePerformanceCounters::disable()
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        VERIFY(m_enable_count > 0);
+        if (--m_enable_count > 0)
+            return;
+    }
+    update_all_processors();
+}
+
+u32 HardwarePerformanceCounters::counter_msr(const Counter& counter) const
+{
+    return counter.is_fixed ? MSR_IA32_FIXED_CTR0 + counter.index : MSR_IA32_PMC0 + counter.index;
+}
+
+void HardwarePerformanceCounters::restart(const Counter& counter)
+{
+    // The counter counts up, so it overflows after `period` events.
+    // NOTE: Writing a general-purpose counter only sets its lower 32 bits, and sign-extends them.
+    auto width = counter.is_fixed ? m_fixed_counter_width : m_general_counter_width;
+    u32 high = width > 32 ? (1u << (width - 32)) - 1 : 0;
+    MSR msr(counter_msr(counter));
+    msr.set(-counter.period, high);
+}
+
+bool HardwarePerformanceCounters::has_overflowed(const Counter& counter)
+{
+    auto width = counter.is_fixed ? m_fixed_counter_width : m_general_counter_width;
+    u32 low, high;
+    MSR msr(counter_msr(counter));
+    msr.get(low, high);
+    if (width > 32)
+        return !(high & (1u << (width - 33)));
+    return !(low & 0x80000000);
+}
+
+void HardwarePerformanceCounters::update_current_processor()
+{
+    ScopedSpinLock lock(m_lock);
+
+    // Stop everything first, so the counters don't run while we set them up.
+    if (m_version >= 2)
+        MSR(MSR_IA32_PERF_GLOBAL_CTRL).set(0, 0);
+    if (m_fixed_counter_count > 0)
+        MSR(MSR_IA32_FIXED_CTR_CTRL).set(0, 0);
+    for (u8 i = 0; i < min<u8>(m_general_counter_count, max_counter_count); ++i)
+        MSR(MSR_IA32_PERFEVTSEL0 + i).set(0, 0);
+
+    if (m_enable_count == 0) {
+        APIC::the().disable_performance_counter_interrupt();
+        return;
+    }
+
+    u32 fixed_control = 0;
+    u32 global_control_low = 0;
+    u32 global_control_high = 0;
+    for (size_t i = 0; i < m_counter_count; ++i) {
+        auto& counter = m_counters[i];
+        restart(counter);
+        if (counter.is_fixed) {
+            fixed_control |= (FIXED_CTR_CTRL_OS | FIXED_CTR_CTRL_USR | FIXED_CTR_CTRL_PMI) << (counter.index * 4);
+            global_control_high |= 1u << counter.index;
+        } else {
+            MSR(MSR_IA32_PERFEVTSEL0 + counter.index).set(counter.event_select | (counter.unit_mask << 8) | PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_INT | PERFEVTSEL_EN, 0);
+            global_control_low |= 1u << counter.index;
+        }
+    }
+
+    APIC::the().enable_performance_counter_interrupt();
+    if (fixed_control)
+        MSR(MSR_IA32_FIXED_CTR_CTRL).set(fixed_control, 0);
+    if (m_version >= 2)
+        MSR(MSR_IA32_PERF_GLOBAL_CTRL).set(global_control_low, global_control_high);
+}
+
+void HardwarePerformanceCounters::update_all_processors()
+{
+    // NOTE: This doesn't wait for the other processors, so it's fine to call while holding a spinlock.
+    //       Updating looks at the current state instead of being told what to do, so it doesn't matter
+    //       in which order the updates get to a processor either.
+    if (Processor::count() > 1) {
+        Processor::smp_broadcast([] {
+            HardwarePerformanceCounters::the().update_current_processor();
+        },
+            true);
+    }
+    ScopedCritical critical;
+    update_current_processor();
+}
+
+void HardwarePerformanceCounters::handle_overflow(const RegisterState& regs)
+{
+    Array<Counter, max_counter_count> overflowed_counters;
+    size_t overflowed_counter_count = 0;
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_enable_count == 0)
+            return;
+
+        for (size_t i = 0; i < m_counter_count; ++i) {
+            auto& counter = m_counters[i];
+            if (!has_overflowed(counter))
+                continue;
+            restart(counter);
+            overflowed_counters[overflowed_counter_count++] = counter;
+        }
+
+        if (m_version >= 2) {
+            u32 status_low, status_high;
+            MSR(MSR_IA32_PERF_GLOBAL_STATUS).get(status_low, status_high);
+            MSR(MSR_IA32_PERF_GLOBAL_OVF_CTRL).set(status_low, status_high);
+        }
+        APIC::the().enable_performance_counter_interrupt();
+    }
+
+    auto* current_thread = Thread::current();
+    // FIXME: Like the profile timer, we don't collect samples while idle.
+    if (!current_thread || current_thread == Processor::current().idle_thread())
+        return;
+    for (size_t i = 0; i < overflowed_counter_count; ++i)
+        PerformanceManager::add_hardware_counter_sample_event(*current_thread, regs, overflowed_counters[i].event_type, overflowed_counters[i].period);
+}
+
+}
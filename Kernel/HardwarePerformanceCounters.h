@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Types.h>
+#include <Kernel/KResult.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// The performance monitoring counters of the processors, as described by Intel's "architectural performance monitoring".
+//
+// While profiling, every processor counts each of the requested events in a counter of its own, which starts out
+// `period` events away from overflowing. When it overflows, the local APIC raises an interrupt, which records a sample
+// of whatever was running (just like the profile timer does) and starts the counter over.
+class HardwarePerformanceCounters {
+public:
+    static constexpr u64 event_mask = PERF_EVENT_CYCLES | PERF_EVENT_INSTRUCTIONS | PERF_EVENT_CACHE_MISS | PERF_EVENT_BRANCH_MISS;
+
+    static HardwarePerformanceCounters& the();
+
+    HardwarePerformanceCounters();
+
+    bool is_supported() const { return m_version > 0; }
+
+    // Starts counting the hardware events in the mask on every processor. If the counters are already
+    // in use, they keep counting what they were counting before.
+    KResult enable(u64 events);
+    void disable();
+
+    // Called from the local APIC's performance counter interrupt.
+    void handle_overflow(const RegisterState&);
+
+private:
+    struct Counter {
+        int event_type { 0 };
+        u32 period { 0 };
+        // Fixed-function counters count one specific event, general-purpose ones count whatever they're told to.
+        bool is_fixed { false };
+        u8 index { 0 };
+        u8 event_select { 0 };
+        u8 unit_mask { 0 };
+    };
+
+    static constexpr size_t max_counter_count = 4;
+
+    u32 counter_msr(const Counter&) const;
+    void restart(const Counter&);
+    bool has_overflowed(const Counter&);
+
+    // Makes the counters of the current processor match m_enable_count and m_counters.
+    void update_current_processor();
+    void update_all_processors();
+
+    u8 m_version { 0 };
+    u8 m_general_counter_count { 0 };
+    u8 m_general_counter_width { 0 };
+    u8 m_fixed_counter_count { 0 };
+    u8 m_fixed_counter_width { 0 };
+    // The architectural events this processor can't count (CPUID.0AH:EBX).
+    u32 m_unavailable_events { 0 };
+
+    SpinLock<u8> m_lock;
+    size_t m_enable_count { 0 };
+    Array<Counter, max_counter_count> m_counters;
+    size_t m_counter_count { 0 };
+};
+
+}
@@ -5,10 +5,14 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/IntrusiveList.h>
+#include <AK/IntrusiveRedBlackTree.h>
 #include <AK/Memory.h>
+#include <AK/ScopeGuard.h>
 #include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/SpinLock.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/Region.h>
 
 #define SANITIZE_SLABS
@@ -157,6 +161,253 @@ void slab_dealloc(void* ptr, size_t slab_size)
     VERIFY_NOT_REACHED();
 }
 
+static constexpr size_t SLAB_CACHE_SLAB_SIZE = 64 * KiB;
+static constexpr size_t SLAB_CACHE_OBJECT_ALIGNMENT = 16;
+static constexpr size_t SLAB_CACHE_MINIMUM_OBJECTS_PER_SLAB = 8;
+
+class SlabCache {
+    AK_MAKE_NONCOPYABLE(SlabCache);
+    AK_MAKE_NONMOVABLE(SlabCache);
+
+public:
+    explicit SlabCache(StringView name)
+        : m_name(name)
+    {
+    }
+
+    void* allocate(size_t object_size)
+    {
+        if (!m_object_size) {
+            VERIFY(round_up_to_power_of_two(object_size, SLAB_CACHE_OBJECT_ALIGNMENT) * SLAB_CACHE_MINIMUM_OBJECTS_PER_SLAB + sizeof(Slab) <= SLAB_CACHE_SLAB_SIZE);
+            m_object_size = round_up_to_power_of_two(object_size, SLAB_CACHE_OBJECT_ALIGNMENT);
+        }
+        VERIFY(object_size <= m_object_size);
+
+        for (;;) {
+            if (auto* object = allocate_from_slabs()) {
+#ifdef SANITIZE_SLABS
+                memset(object, SLAB_ALLOC_SCRUB_BYTE, m_object_size);
+#endif
+                return object;
+            }
+            if (!try_grow()) {
+                m_num_fallback_allocations++;
+                return kmalloc(m_object_size);
+            }
+        }
+    }
+
+    void deallocate(void* ptr)
+    {
+        VERIFY(ptr);
+        ScopedSpinLock lock(m_lock);
+        auto* slab = m_slabs.find_largest_not_above((FlatPtr)ptr);
+        if (!slab || !slab->contains(ptr)) {
+            // This object was handed out by kmalloc while we couldn't grow.
+            lock.unlock();
+            kfree(ptr);
+            return;
+        }
+        VERIFY(((FlatPtr)ptr - slab->first_object()) % m_object_size == 0);
+
+        auto* object = (FreeObject*)ptr;
+#ifdef SANITIZE_SLABS
+        memset(object, SLAB_DEALLOC_SCRUB_BYTE, m_object_size);
+#endif
+        if (!slab->freelist)
+            move_slab(*slab, m_partial_slabs);
+        object->next = slab->freelist;
+        slab->freelist = object;
+        slab->free_count++;
+        m_num_allocated--;
+    }
+
+    size_t reclaim_empty_slabs()
+    {
+        Slab::List empty_slabs;
+        {
+            ScopedSpinLock lock(m_lock);
+            for (auto it = m_partial_slabs.begin(); it != m_partial_slabs.end();) {
+                auto& slab = *it;
+                ++it;
+                if (slab.free_count != slab.capacity)
+                    continue;
+                m_slabs.remove(slab.tree_node.key);
+                empty_slabs.append(slab);
+                m_slab_count--;
+            }
+        }
+
+        // Destroying a slab's region may itself free objects into a slab cache
+        // (e.g. the Region cache), so we must not be holding our lock here.
+        size_t reclaimed_slabs = 0;
+        while (auto* slab = empty_slabs.take_first()) {
+            auto region = move(slab->region);
+            slab->~Slab();
+            region = nullptr;
+            reclaimed_slabs++;
+        }
+        return reclaimed_slabs;
+    }
+
+    slab_cache_stats stats() const
+    {
+        ScopedSpinLock lock(m_lock);
+        slab_cache_stats stats;
+        stats.name = m_name;
+        stats.object_size = m_object_size;
+        stats.slab_count = m_slab_count;
+        stats.num_allocated = m_num_allocated;
+        for (auto& slab : m_partial_slabs)
+            stats.num_free += slab.free_count;
+        stats.num_fallback_allocations = m_num_fallback_allocations;
+        return stats;
+    }
+
+private:
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    // Every slab starts with this header, followed by as many objects as fit.
+    struct Slab {
+        Slab(NonnullOwnPtr<Region>&& region, size_t object_size)
+            : tree_node(region->vaddr().get())
+            , region(move(region))
+            , capacity((SLAB_CACHE_SLAB_SIZE - first_object_offset()) / object_size)
+        {
+            auto* objects = (u8*)first_object();
+            for (size_t i = capacity; i > 0; --i) {
+                auto* object = (FreeObject*)(objects + (i - 1) * object_size);
+                object->next = freelist;
+                freelist = object;
+            }
+            free_count = capacity;
+        }
+
+        static constexpr size_t first_object_offset() { return round_up_to_power_of_two(sizeof(Slab), SLAB_CACHE_OBJECT_ALIGNMENT); }
+        FlatPtr first_object() const { return (FlatPtr)this + first_object_offset(); }
+        bool contains(void* ptr) const { return (FlatPtr)ptr >= first_object() && (FlatPtr)ptr < (FlatPtr)this + SLAB_CACHE_SLAB_SIZE; }
+
+        IntrusiveRedBlackTreeNode<FlatPtr> tree_node;
+        IntrusiveListNode<Slab> list_node;
+        OwnPtr<Region> region;
+        FreeObject* freelist { nullptr };
+        size_t free_count { 0 };
+        size_t capacity { 0 };
+
+        using List = IntrusiveList<Slab, RawPtr<Slab>, &Slab::list_node>;
+    };
+
+    void* allocate_from_slabs()
+    {
+        ScopedSpinLock lock(m_lock);
+        auto* slab = m_partial_slabs.first();
+        if (!slab)
+            return nullptr;
+        auto* object = slab->freelist;
+        slab->freelist = object->next;
+        slab->free_count--;
+        if (!slab->freelist)
+            move_slab(*slab, m_full_slabs);
+        m_num_allocated++;
+        return object;
+    }
+
+    bool try_grow()
+    {
+        if (!MemoryManager::is_initialized())
+            return false;
+
+        // If we're holding some other spinlock, pulling a fresh slab from the
+        // MemoryManager might need that very lock. Grow once we're out of it.
+        if (Processor::current().in_critical()) {
+            if (!m_grow_pending.exchange(true)) {
+                Processor::deferred_call_queue([this] {
+                    m_grow_pending.store(false);
+                    grow();
+                });
+            }
+            return false;
+        }
+
+        return grow();
+    }
+
+    bool grow()
+    {
+        // Growing allocates a Region, which may come from a slab cache itself.
+        // If we end up back here while already growing, fall back to kmalloc.
+        if (m_growing.exchange(true))
+            return false;
+        ScopeGuard guard([&] { m_growing.store(false); });
+
+        auto region = MM.allocate_kernel_region(SLAB_CACHE_SLAB_SIZE, m_name, Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+        if (!region)
+            return false;
+        auto* slab = new (region->vaddr().as_ptr()) Slab(region.release_nonnull(), m_object_size);
+
+        // Slabs aren't aligned to their size, so we keep them in a tree keyed
+        // by base address to find the slab that owns any given object.
+        ScopedSpinLock lock(m_lock);
+        m_slabs.insert(*slab);
+        m_partial_slabs.append(*slab);
+        m_slab_count++;
+        return true;
+    }
+
+    void move_slab(Slab& slab, Slab::List& list)
+    {
+        VERIFY(m_lock.is_locked());
+        slab.list_node.remove();
+        list.append(slab);
+    }
+
+    StringView m_name;
+    size_t m_object_size { 0 };
+    mutable SpinLock<u8> m_lock;
+    Atomic<bool> m_growing { false };
+    Atomic<bool> m_grow_pending { false };
+    IntrusiveRedBlackTree<FlatPtr, Slab, &Slab::tree_node> m_slabs;
+    Slab::List m_partial_slabs;
+    Slab::List m_full_slabs;
+    size_t m_slab_count { 0 };
+    size_t m_num_allocated { 0 };
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_num_fallback_allocations { 0 };
+};
+
+static SlabCache s_slab_caches[] = {
+#define __ENUMERATE_SLAB_CACHE(type) SlabCache { #type },
+    ENUMERATE_SLAB_CACHES
+#undef __ENUMERATE_SLAB_CACHE
+};
+
+static_assert(sizeof(s_slab_caches) / sizeof(s_slab_caches[0]) == (size_t)SlabCacheID::__Count);
+
+void* slab_cache_alloc(SlabCacheID id, size_t object_size)
+{
+    return s_slab_caches[(size_t)id].allocate(object_size);
+}
+
+void slab_cache_dealloc(SlabCacheID id, void* ptr)
+{
+    s_slab_caches[(size_t)id].deallocate(ptr);
+}
+
+size_t slab_cache_reclaim_empty_slabs()
+{
+    size_t reclaimed_slabs = 0;
+    for (auto& cache : s_slab_caches)
+        reclaimed_slabs += cache.reclaim_empty_slabs();
+    return reclaimed_slabs;
+}
+
+void for_each_slab_cache_stats(Function<void(const slab_cache_stats&)> callback)
+{
+    for (auto& cache : s_slab_caches)
+        callback(cache.stats());
+}
+
 void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)> callback)
 {
     for_each_allocator([&](auto& allocator) {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/StringView.h>
 #include <AK/Types.h>
 
 namespace Kernel {
@@ -19,6 +20,37 @@ void slab_dealloc(void*, size_t slab_size);
 void slab_alloc_init();
 void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)>);
 
+// Named object caches for hot kernel types. Unlike the fixed-size slabs above,
+// these grow on demand by pulling slabs from the MemoryManager, and give their
+// empty slabs back when physical memory runs low.
+#define ENUMERATE_SLAB_CACHES               \
+    __ENUMERATE_SLAB_CACHE(Thread)          \
+    __ENUMERATE_SLAB_CACHE(FileDescription) \
+    __ENUMERATE_SLAB_CACHE(Region)          \
+    __ENUMERATE_SLAB_CACHE(PhysicalPage)    \
+    __ENUMERATE_SLAB_CACHE(PacketWithTimestamp)
+
+enum class SlabCacheID {
+#define __ENUMERATE_SLAB_CACHE(type) type,
+    ENUMERATE_SLAB_CACHES
+#undef __ENUMERATE_SLAB_CACHE
+        __Count
+};
+
+struct slab_cache_stats {
+    StringView name;
+    size_t object_size { 0 };
+    size_t slab_count { 0 };
+    size_t num_allocated { 0 };
+    size_t num_free { 0 };
+    size_t num_fallback_allocations { 0 };
+};
+
+void* slab_cache_alloc(SlabCacheID, size_t object_size);
+void slab_cache_dealloc(SlabCacheID, void*);
+size_t slab_cache_reclaim_empty_slabs();
+void for_each_slab_cache_stats(Function<void(const slab_cache_stats&)>);
+
 #define MAKE_SLAB_ALLOCATED(type)                                                          \
 public:                                                                                    \
     [[nodiscard]] void* operator new(size_t) noexcept { return slab_alloc(sizeof(type)); } \
@@ -26,4 +58,11 @@ public:
                                                                                            \
 private:
 
+#define MAKE_SLAB_CACHED(type)                                                                                      \
+public:                                                                                                             \
+    [[nodiscard]] void* operator new(size_t) noexcept { return slab_cache_alloc(SlabCacheID::type, sizeof(type)); } \
+    void operator delete(void* ptr) noexcept { slab_cache_dealloc(SlabCacheID::type, ptr); }                        \
+                                                                                                                    \
+private:
+
 }
@@ -10,6 +10,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/CPU.h>
@@ -29,6 +30,11 @@
 #define POOL_SIZE (2 * MiB)
 #define ETERNAL_RANGE_SIZE (2 * MiB)
 
+// Allocations of up to this many chunks are served from per-processor magazines
+#define MAGAZINE_SIZE_CLASSES 8
+#define MAGAZINE_CAPACITY 32
+#define MAGAZINE_PROCESSORS 8
+
 static RecursiveSpinLock s_lock; // needs to be recursive because of dump_backtrace()
 
 static void kmalloc_allocate_backup_memory();
@@ -188,14 +194,113 @@ __attribute__((section(".heap"))) static u8 kmalloc_eternal_heap[ETERNAL_RANGE_S
 __attribute__((section(".heap"))) static u8 kmalloc_pool_heap[POOL_SIZE];
 
 static size_t g_kmalloc_bytes_eternal = 0;
-static size_t g_kmalloc_call_count;
-static size_t g_kfree_call_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> g_kmalloc_call_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> g_kfree_call_count;
 static size_t g_nested_kfree_calls;
 bool g_dump_kmalloc_stacks;
 
 static u8* s_next_eternal_ptr;
 READONLY_AFTER_INIT static u8* s_end_of_eternal_range;
 
+// Every processor keeps a small stack ("magazine") of recently freed blocks
+// for each of the smallest size classes. Blocks in a magazine are still
+// allocated as far as the global heap is concerned, so most kmalloc() and
+// kfree() calls don't need to take s_lock at all. Magazines are refilled
+// from and flushed to the global heap in batches of half their capacity.
+struct KmallocMagazine {
+    size_t count { 0 };
+    void* blocks[MAGAZINE_CAPACITY];
+};
+
+struct KmallocProcessorCache {
+    KmallocMagazine magazines[MAGAZINE_SIZE_CLASSES];
+    size_t allocation_hits { 0 };
+    size_t allocation_misses { 0 };
+    size_t free_hits { 0 };
+    size_t free_misses { 0 };
+};
+
+static KmallocProcessorCache s_processor_caches[MAGAZINE_PROCESSORS];
+
+static KmallocProcessorCache* current_processor_cache()
+{
+    // NOTE: kmalloc() is used before the processor structures have been set up.
+    if (!Processor::is_initialized())
+        return nullptr;
+    VERIFY(Processor::current().in_critical());
+    auto id = Processor::id();
+    if (id >= MAGAZINE_PROCESSORS)
+        return nullptr;
+    return &s_processor_caches[id];
+}
+
+static void* kmalloc_from_processor_cache(size_t size)
+{
+    auto chunks = KmallocGlobalHeap::HeapType::HeapType::calculate_chunks_for_bytes(size);
+    if (chunks > MAGAZINE_SIZE_CLASSES)
+        return nullptr;
+
+    ScopedCritical critical;
+    auto* cache = current_processor_cache();
+    if (!cache)
+        return nullptr;
+
+    auto& magazine = cache->magazines[chunks - 1];
+    auto usable_size = KmallocGlobalHeap::HeapType::HeapType::usable_bytes_for_chunks(chunks);
+    if (magazine.count > 0) {
+        ++cache->allocation_hits;
+        void* ptr = magazine.blocks[--magazine.count];
+        if constexpr (KMALLOC_SCRUB_BYTE != 0)
+            __builtin_memset(ptr, KMALLOC_SCRUB_BYTE, usable_size);
+        return ptr;
+    }
+
+    ++cache->allocation_misses;
+    ScopedSpinLock lock(s_lock);
+    // Refill half the magazine and hand out one more block right away.
+    while (magazine.count < MAGAZINE_CAPACITY / 2) {
+        void* ptr = g_kmalloc_global->m_heap.allocate(usable_size);
+        if (!ptr)
+            break;
+        magazine.blocks[magazine.count++] = ptr;
+    }
+    return g_kmalloc_global->m_heap.allocate(usable_size);
+}
+
+static bool kfree_to_processor_cache(void* ptr)
+{
+    auto chunks = KmallocGlobalHeap::HeapType::HeapType::allocation_size_in_chunks(ptr);
+    if (chunks > MAGAZINE_SIZE_CLASSES)
+        return false;
+
+    ScopedCritical critical;
+    auto* cache = current_processor_cache();
+    if (!cache)
+        return false;
+
+    if constexpr (KFREE_SCRUB_BYTE != 0)
+        __builtin_memset(ptr, KFREE_SCRUB_BYTE, KmallocGlobalHeap::HeapType::HeapType::usable_bytes_for_chunks(chunks));
+
+    auto& magazine = cache->magazines[chunks - 1];
+    if (magazine.count < MAGAZINE_CAPACITY) {
+        ++cache->free_hits;
+        magazine.blocks[magazine.count++] = ptr;
+        return true;
+    }
+
+    ++cache->free_misses;
+    ScopedSpinLock lock(s_lock);
+    // Flush the older half of the magazine (and this block) back to the global heap.
+    constexpr size_t flush_count = MAGAZINE_CAPACITY / 2;
+    for (size_t i = 0; i < flush_count; ++i)
+        g_kmalloc_global->m_heap.deallocate(magazine.blocks[i]);
+    for (size_t i = flush_count; i < MAGAZINE_CAPACITY; ++i)
+        magazine.blocks[i - flush_count] = magazine.blocks[i];
+    magazine.count -= flush_count;
+    g_kmalloc_global->m_heap.deallocate(ptr);
+    return true;
+}
+
 static void kmalloc_allocate_backup_memory()
 {
     g_kmalloc_global->allocate_backup_memory();
@@ -244,15 +349,19 @@ void* kmalloc_eternal(size_t size)
 void* kmalloc(size_t size)
 {
     kmalloc_verify_nospinlock_held();
-    ScopedSpinLock lock(s_lock);
     ++g_kmalloc_call_count;
 
     if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+        ScopedSpinLock lock(s_lock);
         dbgln("kmalloc({})", size);
         Kernel::dump_backtrace();
     }
 
-    void* ptr = g_kmalloc_global->m_heap.allocate(size);
+    void* ptr = kmalloc_from_processor_cache(size);
+    if (!ptr) {
+        ScopedSpinLock lock(s_lock);
+        ptr = g_kmalloc_global->m_heap.allocate(size);
+    }
     if (!ptr) {
         PANIC("kmalloc: Out of memory (requested size: {})", size);
     }
@@ -272,8 +381,18 @@ void kfree(void* ptr)
         return;
 
     kmalloc_verify_nospinlock_held();
-    ScopedSpinLock lock(s_lock);
     ++g_kfree_call_count;
+
+    if (kfree_to_processor_cache(ptr)) {
+        Thread* current_thread = Thread::current();
+        if (!current_thread)
+            current_thread = Processor::idle_thread();
+        if (current_thread)
+            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+        return;
+    }
+
+    ScopedSpinLock lock(s_lock);
     ++g_nested_kfree_calls;
 
     if (g_nested_kfree_calls == 1) {
@@ -339,3 +458,24 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
 }
+
+void for_each_kmalloc_processor_cache_stats(Function<void(const kmalloc_processor_cache_stats&)> callback)
+{
+    auto processor_count = min((size_t)Processor::count(), (size_t)MAGAZINE_PROCESSORS);
+    for (size_t id = 0; id < processor_count; ++id) {
+        kmalloc_processor_cache_stats stats {};
+        {
+            // The counters are only ever updated by their own processor, so a
+            // slightly stale snapshot is fine here.
+            auto& cache = s_processor_caches[id];
+            stats.processor = id;
+            stats.allocation_hits = cache.allocation_hits;
+            stats.allocation_misses = cache.allocation_misses;
+            stats.free_hits = cache.free_hits;
+            stats.free_misses = cache.free_misses;
+            for (size_t i = 0; i < MAGAZINE_SIZE_CLASSES; ++i)
+                stats.bytes_cached += cache.magazines[i].count * (i + 1) * CHUNK_SIZE;
+        }
+        callback(stats);
+    }
+}
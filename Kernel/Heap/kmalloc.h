@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/Types.h>
 #include <Kernel/Debug.h>
 
@@ -35,6 +36,16 @@ struct kmalloc_stats {
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
+struct kmalloc_processor_cache_stats {
+    size_t processor;
+    size_t allocation_hits;
+    size_t allocation_misses;
+    size_t free_hits;
+    size_t free_misses;
+    size_t bytes_cached;
+};
+void for_each_kmalloc_processor_cache_stats(Function<void(const kmalloc_processor_cache_stats&)>);
+
 extern bool g_dump_kmalloc_stacks;
 
 inline void* operator new(size_t, void* p) { return p; }
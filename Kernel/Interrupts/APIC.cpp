@@ -12,6 +12,7 @@
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Arch/x86/ProcessorInfo.h>
 #include <Kernel/Debug.h>
+#include <Kernel/HardwarePerformanceCounters.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
@@ -22,6 +23,7 @@
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/TypedMapping.h>
 
+#define IRQ_APIC_PERFORMANCE_COUNTER (0xfb - IRQ_VECTOR_BASE)
 #define IRQ_APIC_TIMER (0xfc - IRQ_VECTOR_BASE)
 #define IRQ_APIC_IPI (0xfd - IRQ_VECTOR_BASE)
 #define IRQ_APIC_ERR (0xfe - IRQ_VECTOR_BASE)
@@ -33,6 +35,7 @@
 
 #define APIC_BASE_MSR 0x1b
 
+#define APIC_REG_ID 0x20
 #define APIC_REG_EOI 0xb0
 #define APIC_REG_LD 0xd0
 #define APIC_REG_DF 0xe0
@@ -116,6 +119,37 @@ public:
 private:
 };
 
+class APICPerformanceCounterInterruptHandler final : public GenericInterruptHandler {
+public:
+    explicit APICPerformanceCounterInterruptHandler(u8 interrupt_vector)
+        : GenericInterruptHandler(interrupt_vector, true)
+    {
+    }
+    virtual ~APICPerformanceCounterInterruptHandler()
+    {
+    }
+
+    static void initialize(u8 interrupt_number)
+    {
+        auto* handler = new APICPerformanceCounterInterruptHandler(interrupt_number);
+        handler->register_interrupt_handler();
+    }
+
+    virtual void handle_interrupt(const RegisterState&) override;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual const char* purpose() const override { return "Performance Counter Handler"; }
+    virtual const char* controller() const override { return nullptr; }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+private:
+};
+
 bool APIC::initialized()
 {
     return s_apic.is_initialized();
@@ -400,7 +434,10 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
     auto apic_id = read_register(APIC_REG_LD) >> 24;
     Processor::current().info().set_apic_id(apic_id);
 
-    dbgln_if(APIC_DEBUG, "Enabling local APIC for CPU #{}, logical APIC ID: {}", cpu, apic_id);
+    m_physical_apic_ids[cpu] = read_register(APIC_REG_ID) >> 24;
+    m_processors_with_known_apic_id.fetch_or(1u << cpu, AK::MemoryOrder::memory_order_release);
+
+    dbgln_if(APIC_DEBUG, "Enabling local APIC for CPU #{}, logical APIC ID: {}, physical APIC ID: {}", cpu, apic_id, m_physical_apic_ids[cpu]);
 
     if (cpu == 0) {
         SpuriousInterruptHandler::initialize(IRQ_APIC_SPURIOUS);
@@ -411,6 +448,9 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
 
         // register IPI interrupt vector
         APICIPIInterruptHandler::initialize(IRQ_APIC_IPI);
+
+        // register performance counter overflow interrupt vector
+        APICPerformanceCounterInterruptHandler::initialize(IRQ_APIC_PERFORMANCE_COUNTER);
     }
 
     // set spurious interrupt vector
@@ -428,6 +468,24 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
     write_register(APIC_REG_TPR, 0);
 }
 
+void APIC::enable_performance_counter_interrupt()
+{
+    // NOTE: The processor masks this again whenever it delivers the interrupt.
+    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(IRQ_APIC_PERFORMANCE_COUNTER + IRQ_VECTOR_BASE, 0));
+}
+
+void APIC::disable_performance_counter_interrupt()
+{
+    write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
+}
+
+Optional<u8> APIC::physical_apic_id(u32 cpu) const
+{
+    if (cpu >= m_physical_apic_ids.size() || !(m_processors_with_known_apic_id.load(AK::MemoryOrder::memory_order_acquire) & (1u << cpu)))
+        return {};
+    return m_physical_apic_ids[cpu];
+}
+
 Thread* APIC::get_idle_thread(u32 cpu) const
 {
     VERIFY(cpu > 0);
@@ -541,7 +599,7 @@ void APIC::setup_local_timer(u32 ticks, TimerMode timer_mode, bool enable)
     }
     write_register(APIC_REG_TIMER_CONFIGURATION, config);
 
-    if (timer_mode == TimerMode::Periodic)
+    if (timer_mode == TimerMode::Periodic || timer_mode == TimerMode::OneShot)
         write_register(APIC_REG_TIMER_INITIAL_COUNT, ticks / get_timer_divisor());
 }
 
@@ -578,6 +636,17 @@ bool APICErrInterruptHandler::eoi()
     return true;
 }
 
+void APICPerformanceCounterInterruptHandler::handle_interrupt(const RegisterState& regs)
+{
+    HardwarePerformanceCounters::the().handle_overflow(regs);
+}
+
+bool APICPerformanceCounterInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
 bool HardwareTimer<GenericInterruptHandler>::eoi()
 {
     APIC::the().eoi();
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
 #include <Kernel/Time/HardwareTimer.h>
 #include <Kernel/VM/MemoryManager.h>
@@ -32,7 +34,11 @@ public:
     void broadcast_ipi();
     void send_ipi(u32 cpu);
     static u8 spurious_interrupt_vector();
+    void enable_performance_counter_interrupt();
+    void disable_performance_counter_interrupt();
     Thread* get_idle_thread(u32 cpu) const;
+    // The ID message signaled interrupts have to be addressed to, once the processor has enabled its local APIC.
+    Optional<u8> physical_apic_id(u32 cpu) const;
     u32 enabled_processor_count() const { return m_processor_enabled_cnt; }
 
     APICTimer* initialize_timers(HardwareTimerBase&);
@@ -97,6 +103,8 @@ private:
     u32 m_processor_cnt { 0 };
     u32 m_processor_enabled_cnt { 0 };
     APICTimer* m_apic_timer { nullptr };
+    Array<u8, 8> m_physical_apic_ids;
+    Atomic<u32> m_processors_with_known_apic_id { 0 };
 
     static PhysicalAddress get_base();
     static void set_base(const PhysicalAddress& base);
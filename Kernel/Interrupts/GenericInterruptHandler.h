@@ -45,6 +45,8 @@ public:
     virtual HandlerType type() const = 0;
     virtual const char* purpose() const = 0;
     virtual const char* controller() const = 0;
+    // The processor this interrupt gets delivered to.
+    virtual u32 responsible_processor() const { return 0; }
 
     virtual bool eoi() = 0;
     ALWAYS_INLINE void increment_invoking_counter()
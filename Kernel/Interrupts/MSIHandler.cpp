@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+#include <Kernel/SpinLock.h>
+
+namespace Kernel {
+
+// The interrupt numbers we hand out for message signaled interrupts. The ones below are left to the
+// IOAPICs (and the syscall gate), the ones above are taken by the local APIC's own interrupts.
+static constexpr u8 FIRST_MSI_INTERRUPT_NUMBER = 0x50;
+static constexpr u8 LAST_MSI_INTERRUPT_NUMBER = 0xaa;
+static constexpr size_t MSI_INTERRUPT_NUMBER_COUNT = LAST_MSI_INTERRUPT_NUMBER - FIRST_MSI_INTERRUPT_NUMBER + 1;
+
+static SpinLock<u8> s_interrupt_numbers_lock;
+static bool s_interrupt_number_in_use[MSI_INTERRUPT_NUMBER_COUNT];
+
+OwnPtr<MSIHandler> MSIHandler::try_create(const char* purpose)
+{
+    Optional<u8> interrupt_number;
+    {
+        ScopedSpinLock lock(s_interrupt_numbers_lock);
+        for (size_t i = 0; i < MSI_INTERRUPT_NUMBER_COUNT; ++i) {
+            if (s_interrupt_number_in_use[i])
+                continue;
+            s_interrupt_number_in_use[i] = true;
+            interrupt_number = FIRST_MSI_INTERRUPT_NUMBER + i;
+            break;
+        }
+    }
+    if (!interrupt_number.has_value()) {
+        dbgln("MSIHandler: Out of interrupt vectors for {}", purpose);
+        return {};
+    }
+
+    auto handler = adopt_own_if_nonnull(new MSIHandler(interrupt_number.value(), purpose));
+    if (!handler) {
+        ScopedSpinLock lock(s_interrupt_numbers_lock);
+        s_interrupt_number_in_use[interrupt_number.value() - FIRST_MSI_INTERRUPT_NUMBER] = false;
+        return {};
+    }
+    handler->register_interrupt_handler();
+    dbgln_if(IRQ_DEBUG, "MSIHandler: Vector {:#02x} for {}", handler->vector(), purpose);
+    return handler;
+}
+
+MSIHandler::MSIHandler(u8 interrupt_number, const char* purpose)
+    : GenericInterruptHandler(interrupt_number, true)
+    , m_purpose(purpose)
+{
+}
+
+MSIHandler::~MSIHandler()
+{
+    unregister_interrupt_handler();
+    ScopedSpinLock lock(s_interrupt_numbers_lock);
+    s_interrupt_number_in_use[interrupt_number() - FIRST_MSI_INTERRUPT_NUMBER] = false;
+}
+
+void MSIHandler::handle_interrupt(const RegisterState& regs)
+{
+    if (m_callback)
+        m_callback(regs);
+}
+
+bool MSIHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
+}
@@ -6,34 +6,49 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
-#include <Kernel/PCI/Definitions.h>
 
 namespace Kernel {
 
+// One vector of a message signaled interrupt. The device writes the vector straight to the local APIC of
+// the processor it's routed to, so unlike a pin-based interrupt it's never shared and has no IRQController.
 class MSIHandler final : public GenericInterruptHandler {
 public:
-    virtual ~MSIHandler();
-
-    virtual void handle_interrupt(RegisterState&) override { }
+    using Callback = Function<void(const RegisterState&)>;
 
-    void enable_irq();
-    void disable_irq();
+    // Takes one of the interrupt vectors set aside for message signaled interrupts, or returns null if they're all in use.
+    static OwnPtr<MSIHandler> try_create(const char* purpose);
+    virtual ~MSIHandler();
 
+    virtual void handle_interrupt(const RegisterState&) override;
     virtual bool eoi() override;
 
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual const char* purpose() const override { return m_purpose; }
+    virtual const char* controller() const override { return "MSI"; }
+    virtual u32 responsible_processor() const override { return m_processor; }
+
     virtual size_t sharing_devices_count() const override { return 0; }
     virtual bool is_shared_handler() const override { return false; }
-    virtual bool is_sharing_with_others() const override { return m_shared_with_others; }
+    virtual bool is_sharing_with_others() const override { return false; }
 
-protected:
-    void change_irq_number(u8 irq);
-    explicit MSIHandler(PCI::Address);
+    // The vector the device has to put into its message data.
+    u8 vector() const { return interrupt_number() + IRQ_VECTOR_BASE; }
+
+    void set_callback(Callback callback) { m_callback = move(callback); }
+    // NOTE: This only remembers where the interrupt goes, telling the device is up to the caller.
+    void set_responsible_processor(u32 processor) { m_processor = processor; }
 
 private:
-    bool m_shared_with_others;
-    bool m_enabled;
+    MSIHandler(u8 interrupt_number, const char* purpose);
+
+    const char* m_purpose { nullptr };
+    Callback m_callback;
+    u32 m_processor { 0 };
 };
+
 }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Demangle.h>
+#include <AK/QuickSort.h>
 #include <AK/TemporaryChange.h>
 #include <Kernel/Arch/x86/SmapDisabler.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -43,11 +44,20 @@ const KernelSymbol* symbolicate_kernel_address(FlatPtr address)
 {
     if (address < g_lowest_kernel_symbol_address || address > g_highest_kernel_symbol_address)
         return nullptr;
-    for (unsigned i = 0; i < s_symbol_count; ++i) {
-        if (address < s_symbols[i + 1].address)
-            return &s_symbols[i];
+
+    // The symbols are sorted by address, so look for the last one that starts at or before the address.
+    size_t low = 0;
+    size_t high = s_symbol_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (s_symbols[middle].address <= address)
+            low = middle + 1;
+        else
+            high = middle;
     }
-    return nullptr;
+    if (low == 0)
+        return nullptr;
+    return &s_symbols[low - 1];
 }
 
 UNMAP_AFTER_INIT static void load_kernel_sybols_from_data(const KBuffer& buffer)
@@ -66,9 +76,24 @@ UNMAP_AFTER_INIT static void load_kernel_sybols_from_data(const KBuffer& buffer)
 
     dmesgln("Loading kernel symbol table...");
 
+    // Every line is 8 hex digits, " T ", a name and a newline, so the names (with their null terminators
+    // instead of the newlines) all fit into one block, instead of each getting an allocation of their own.
+    size_t symbols_size = (const char*)buffer.end_pointer() - bufptr;
+    size_t line_overhead = s_symbol_count * (8 + 3);
+    if (symbols_size < line_overhead) {
+        dmesgln("Kernel symbol table is truncated");
+        s_symbol_count = 0;
+        return;
+    }
+    size_t names_size = symbols_size - line_overhead + 1;
+    char* names = static_cast<char*>(kmalloc_eternal(names_size));
+    char* names_end = names + names_size;
+    char* next_name = names;
+
     size_t current_symbol_index = 0;
+    bool is_sorted = true;
 
-    while (bufptr < buffer.end_pointer()) {
+    while (bufptr < buffer.end_pointer() && current_symbol_index < s_symbol_count) {
         for (size_t i = 0; i < 8; ++i)
             address = (address << 4) | parse_hex_digit(*(bufptr++));
         bufptr += 3;
@@ -80,11 +105,15 @@ UNMAP_AFTER_INIT static void load_kernel_sybols_from_data(const KBuffer& buffer)
         }
         auto& ksym = s_symbols[current_symbol_index];
         ksym.address = address;
-        char* name = static_cast<char*>(kmalloc_eternal((bufptr - start_of_name) + 1));
-        memcpy(name, start_of_name, bufptr - start_of_name);
-        name[bufptr - start_of_name] = '\0';
-        ksym.name = name;
-
+        size_t name_length = bufptr - start_of_name;
+        VERIFY(next_name + name_length + 1 <= names_end);
+        memcpy(next_name, start_of_name, name_length);
+        next_name[name_length] = '\0';
+        ksym.name = next_name;
+        next_name += name_length + 1;
+
+        if (current_symbol_index > 0 && ksym.address < s_symbols[current_symbol_index - 1].address)
+            is_sorted = false;
         if (ksym.address < g_lowest_kernel_symbol_address)
             g_lowest_kernel_symbol_address = ksym.address;
         if (ksym.address > g_highest_kernel_symbol_address)
@@ -93,6 +122,13 @@ UNMAP_AFTER_INIT static void load_kernel_sybols_from_data(const KBuffer& buffer)
         ++bufptr;
         ++current_symbol_index;
     }
+    s_symbol_count = current_symbol_index;
+
+    // NOTE: mkmap.sh writes the symbols in address order, but symbolicate_kernel_address() relies on it, so make sure.
+    if (!is_sorted) {
+        dmesgln("Kernel symbol table isn't sorted by address, sorting it");
+        quick_sort(s_symbols, s_symbols + s_symbol_count, [](auto& a, auto& b) { return a.address < b.address; });
+    }
     g_kernel_symbols_available = true;
 }
 
@@ -13,7 +13,7 @@
 
 namespace Kernel {
 
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
 void Lock::lock(Mode mode, const SourceLocation& location)
 #else
 void Lock::lock(Mode mode)
@@ -25,8 +25,15 @@ void Lock::lock(Mode mode)
     VERIFY(mode != Mode::Unlocked);
     auto current_thread = Thread::current();
     ScopedCritical critical; // in case we're not in a critical section already
+#if LOCK_STATISTICS
+    Optional<u64> contended_since;
+#endif
     for (;;) {
         if (m_lock.exchange(true, AK::memory_order_acq_rel) != false) {
+#if LOCK_STATISTICS
+            if (!contended_since.has_value())
+                contended_since = LockStatistics::now();
+#endif
             // I don't know *who* is using "m_lock", so just yield.
             Scheduler::yield_from_critical();
             continue;
@@ -42,6 +49,9 @@ void Lock::lock(Mode mode)
             VERIFY(m_shared_holders.is_empty());
             if (mode == Mode::Exclusive) {
                 m_holder = current_thread;
+                // Whoever's still waiting from before lends us their priority as well.
+                if (current_thread && m_inherited_priority.priority())
+                    current_thread->inherit_priority(m_inherited_priority, 0);
             } else {
                 VERIFY(mode == Mode::Shared);
                 m_shared_holders.set(current_thread, 1);
@@ -53,6 +63,9 @@ void Lock::lock(Mode mode)
             if (current_thread) {
                 current_thread->holding_lock(*this, 1, location);
             }
+#endif
+#if LOCK_STATISTICS
+            did_acquire(location, contended_since);
 #endif
             m_queue.should_block(true);
             m_lock.store(false, AK::memory_order_release);
@@ -77,6 +90,9 @@ void Lock::lock(Mode mode)
 
 #if LOCK_DEBUG
             current_thread->holding_lock(*this, 1, location);
+#endif
+#if LOCK_STATISTICS
+            did_acquire(location, contended_since);
 #endif
             m_lock.store(false, AK::memory_order_release);
             return;
@@ -99,6 +115,9 @@ void Lock::lock(Mode mode)
 
 #if LOCK_DEBUG
             current_thread->holding_lock(*this, 1, location);
+#endif
+#if LOCK_STATISTICS
+            did_acquire(location, contended_since);
 #endif
             m_lock.store(false, AK::memory_order_release);
             return;
@@ -106,7 +125,13 @@ void Lock::lock(Mode mode)
         default:
             VERIFY_NOT_REACHED();
         }
+        if (current_mode == Mode::Exclusive && current_thread)
+            m_holder->inherit_priority(m_inherited_priority, current_thread->effective_priority());
         m_lock.store(false, AK::memory_order_release);
+#if LOCK_STATISTICS
+        if (!contended_since.has_value())
+            contended_since = LockStatistics::now();
+#endif
         dbgln_if(LOCK_TRACE_DEBUG, "Lock::lock @ {} ({}) waiting...", this, m_name);
         m_queue.wait_forever(m_name);
         dbgln_if(LOCK_TRACE_DEBUG, "Lock::lock @ {} ({}) waited", this, m_name);
@@ -139,8 +164,10 @@ void Lock::unlock()
             case Mode::Exclusive:
                 VERIFY(m_holder == current_thread);
                 VERIFY(m_shared_holders.is_empty());
-                if (m_times_locked == 0)
+                if (m_times_locked == 0) {
                     m_holder = nullptr;
+                    disinherit_priority(current_thread);
+                }
                 break;
             case Mode::Shared: {
                 VERIFY(!m_holder);
@@ -163,6 +190,9 @@ void Lock::unlock()
                 VERIFY(current_mode == Mode::Exclusive ? !m_holder : m_shared_holders.is_empty());
                 m_mode = Mode::Unlocked;
                 m_queue.should_block(false);
+#if LOCK_STATISTICS
+                did_release();
+#endif
             }
 
 #if LOCK_DEBUG
@@ -206,11 +236,15 @@ auto Lock::force_unlock_if_locked(u32& lock_count_to_restore) -> Mode
                 m_holder->holding_lock(*this, -(int)m_times_locked, {});
 #endif
                 m_holder = nullptr;
+                disinherit_priority(current_thread);
                 VERIFY(m_times_locked > 0);
                 lock_count_to_restore = m_times_locked;
                 m_times_locked = 0;
                 m_mode = Mode::Unlocked;
                 m_queue.should_block(false);
+#if LOCK_STATISTICS
+                did_release();
+#endif
                 m_lock.store(false, AK::memory_order_release);
                 previous_mode = Mode::Exclusive;
                 break;
@@ -239,6 +273,9 @@ auto Lock::force_unlock_if_locked(u32& lock_count_to_restore) -> Mode
                 if (m_times_locked == 0) {
                     m_mode = Mode::Unlocked;
                     m_queue.should_block(false);
+#if LOCK_STATISTICS
+                    did_release();
+#endif
                 }
                 m_lock.store(false, AK::memory_order_release);
                 previous_mode = Mode::Shared;
@@ -261,7 +298,7 @@ auto Lock::force_unlock_if_locked(u32& lock_count_to_restore) -> Mode
     }
 }
 
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
 void Lock::restore_lock(Mode mode, u32 lock_count, const SourceLocation& location)
 #else
 void Lock::restore_lock(Mode mode, u32 lock_count)
@@ -272,6 +309,9 @@ void Lock::restore_lock(Mode mode, u32 lock_count)
     VERIFY(!Processor::current().in_irq());
     auto current_thread = Thread::current();
     ScopedCritical critical; // in case we're not in a critical section already
+#if LOCK_STATISTICS
+    Optional<u64> contended_since;
+#endif
     for (;;) {
         if (m_lock.exchange(true, AK::memory_order_acq_rel) == false) {
             switch (mode) {
@@ -287,7 +327,12 @@ void Lock::restore_lock(Mode mode, u32 lock_count)
                 VERIFY(!m_holder);
                 VERIFY(m_shared_holders.is_empty());
                 m_holder = current_thread;
+                if (current_thread && m_inherited_priority.priority())
+                    current_thread->inherit_priority(m_inherited_priority, 0);
                 m_queue.should_block(true);
+#if LOCK_STATISTICS
+                did_acquire(location, contended_since);
+#endif
                 m_lock.store(false, AK::memory_order_release);
 
 #if LOCK_DEBUG
@@ -311,6 +356,9 @@ void Lock::restore_lock(Mode mode, u32 lock_count)
                 // There may be other shared lock holders already, but we should not have an entry yet
                 VERIFY(set_result == AK::HashSetResult::InsertedNewEntry);
                 m_queue.should_block(true);
+#if LOCK_STATISTICS
+                did_acquire(location, contended_since);
+#endif
                 m_lock.store(false, AK::memory_order_release);
 
 #if LOCK_DEBUG
@@ -324,15 +372,48 @@ void Lock::restore_lock(Mode mode, u32 lock_count)
 
             m_lock.store(false, AK::memory_order_relaxed);
         }
+#if LOCK_STATISTICS
+        if (!contended_since.has_value())
+            contended_since = LockStatistics::now();
+#endif
         // I don't know *who* is using "m_lock", so just yield.
         Scheduler::yield_from_critical();
     }
 }
 
+// NOTE: This is called with m_lock held, when the thread lets go of an exclusively held lock.
+void Lock::disinherit_priority(Thread* thread)
+{
+    if (!thread)
+        return;
+    thread->disinherit_priority(m_inherited_priority);
+    if (m_queue.is_empty())
+        m_inherited_priority.reset();
+}
+
 void Lock::clear_waiters()
 {
     VERIFY(m_mode != Mode::Shared);
     m_queue.wake_all();
 }
 
+#if LOCK_STATISTICS
+// NOTE: These are called with m_lock held, after m_times_locked has been updated.
+void Lock::did_acquire(const SourceLocation& location, Optional<u64> contended_since)
+{
+    auto* site = LockStatistics::did_acquire(location, LockStatistics::LockType::Lock, m_name, m_statistics_site, contended_since);
+    // Taking the lock again while it's held doesn't count as holding it for longer.
+    if (m_acquired_at == 0) {
+        m_statistics_site = site;
+        m_acquired_at = LockStatistics::now();
+    }
+}
+
+void Lock::did_release()
+{
+    LockStatistics::did_release(m_statistics_site, m_acquired_at);
+    m_acquired_at = 0;
+}
+#endif
+
 }
@@ -11,8 +11,12 @@
 #include <AK/HashMap.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Debug.h>
 #include <Kernel/Forward.h>
 #include <Kernel/LockMode.h>
+#if LOCK_STATISTICS
+#    include <Kernel/LockStatistics.h>
+#endif
 #include <Kernel/WaitQueue.h>
 
 namespace Kernel {
@@ -30,7 +34,7 @@ public:
     }
     ~Lock() = default;
 
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
     void lock(Mode mode = Mode::Exclusive, const SourceLocation& location = SourceLocation::current());
     void restore_lock(Mode, u32, const SourceLocation& location = SourceLocation::current());
 #else
@@ -60,6 +64,13 @@ public:
     }
 
 private:
+    void disinherit_priority(Thread*);
+
+#if LOCK_STATISTICS
+    void did_acquire(const SourceLocation&, Optional<u64> contended_since);
+    void did_release();
+#endif
+
     Atomic<bool> m_lock { false };
     const char* m_name { nullptr };
     WaitQueue m_queue;
@@ -76,18 +87,28 @@ private:
     // lock.
     RefPtr<Thread> m_holder;
     HashMap<Thread*, u32> m_shared_holders;
+
+    // The threads waiting for an exclusively held lock lend their priority to the holder.
+    // NOTE: Shared holders don't inherit anything, there's no telling which of them a waiter is waiting for.
+    InheritedPriority m_inherited_priority;
+
+#if LOCK_STATISTICS
+    // Where the lock was first taken since it was last unlocked, and when (or 0 if it's unlocked). Protected by m_lock.
+    LockStatistics::Site* m_statistics_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 class Locker {
 public:
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
     ALWAYS_INLINE explicit Locker(Lock& l, Lock::Mode mode = Lock::Mode::Exclusive, const SourceLocation& location = SourceLocation::current())
 #else
     ALWAYS_INLINE explicit Locker(Lock& l, Lock::Mode mode = Lock::Mode::Exclusive)
 #endif
         : m_lock(l)
     {
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
         m_lock.lock(mode, location);
 #else
         m_lock.lock(mode);
@@ -106,7 +127,7 @@ public:
         m_lock.unlock();
     }
 
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
     ALWAYS_INLINE void lock(Lock::Mode mode = Lock::Mode::Exclusive, const SourceLocation& location = SourceLocation::current())
 #else
     ALWAYS_INLINE void lock(Lock::Mode mode = Lock::Mode::Exclusive)
@@ -115,7 +136,7 @@ public:
         VERIFY(!m_locked);
         m_locked = true;
 
-#if LOCK_DEBUG
+#if LOCK_DEBUG || LOCK_STATISTICS
         m_lock.lock(mode, location);
 #else
         m_lock.lock(mode);
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashFunctions.h>
+#include <Kernel/LockStatistics.h>
+
+namespace Kernel {
+
+// NOTE: The table lives in .bss, so it's ready before anything gets to take a lock.
+static constexpr size_t site_count = 2048;
+static LockStatistics::Site s_sites[site_count];
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> s_dropped_site_count;
+
+LockStatistics::Site* LockStatistics::find_or_create_site(const SourceLocation& location, LockType lock_type, const char* lock_name)
+{
+    // NOTE: Locations in inline functions have a copy of the file name in every translation unit,
+    //       so this hashes (and compares) what the file name says, not where it is.
+    auto hash = pair_int_hash(location.filename().hash(), location.line_number());
+    for (size_t i = 0; i < site_count; ++i) {
+        auto& site = s_sites[(hash + i) % site_count];
+        auto state = site.m_state.load(AK::MemoryOrder::memory_order_acquire);
+        if (state == Site::State::Empty) {
+            if (site.m_state.compare_exchange_strong(state, Site::State::Claimed, AK::MemoryOrder::memory_order_acq_rel)) {
+                site.m_filename = location.filename();
+                site.m_function_name = location.function_name();
+                site.m_line_number = location.line_number();
+                site.m_lock_type = lock_type;
+                site.m_lock_name = lock_name;
+                site.m_state.store(Site::State::Ready, AK::MemoryOrder::memory_order_release);
+                return &site;
+            }
+        }
+        // Someone else is filling this one in right now, it won't take long.
+        while (state == Site::State::Claimed) {
+            Processor::wait_check();
+            state = site.m_state.load(AK::MemoryOrder::memory_order_acquire);
+        }
+        if (site.m_line_number == location.line_number() && site.m_filename == location.filename())
+            return &site;
+    }
+    s_dropped_site_count++;
+    return nullptr;
+}
+
+LockStatistics::Site* LockStatistics::did_acquire(const SourceLocation& location, LockType lock_type, const char* lock_name, Site* hint, Optional<u64> contended_since)
+{
+    auto* site = hint && hint->is_at(location) ? hint : find_or_create_site(location, lock_type, lock_name);
+    if (!site)
+        return nullptr;
+    site->m_acquisitions.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    if (contended_since.has_value()) {
+        site->m_contended_acquisitions.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        site->m_total_wait_cycles.fetch_add(now() - contended_since.value(), AK::MemoryOrder::memory_order_relaxed);
+    }
+    return site;
+}
+
+void LockStatistics::did_release(Site* site, u64 acquired_at)
+{
+    if (!site)
+        return;
+    auto hold_cycles = now() - acquired_at;
+    auto max_hold_cycles = site->m_max_hold_cycles.load(AK::MemoryOrder::memory_order_relaxed);
+    while (hold_cycles > max_hold_cycles) {
+        if (site->m_max_hold_cycles.compare_exchange_strong(max_hold_cycles, hold_cycles, AK::MemoryOrder::memory_order_relaxed))
+            break;
+    }
+}
+
+void LockStatistics::for_each_site(Function<void(const Site&)> callback)
+{
+    for (auto& site : s_sites) {
+        if (site.m_state.load(AK::MemoryOrder::memory_order_acquire) == Site::State::Ready)
+            callback(site);
+    }
+}
+
+size_t LockStatistics::dropped_site_count()
+{
+    return s_dropped_site_count.load();
+}
+
+}
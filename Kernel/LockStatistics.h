@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/SourceLocation.h>
+#include <AK/Types.h>
+#include <Kernel/Arch/x86/CPU.h>
+
+namespace Kernel {
+
+// How often, and for how long, the kernel's locks are fought over.
+//
+// Every place in the code that takes a lock (as told by its SourceLocation) is a site of its own, which counts
+// how many times it took a lock, how many of those times it had to wait for someone else to let go first,
+// how long it waited in total, and the longest it held on to a lock. Times are in TSC cycles.
+//
+// NOTE: The locks only report to this when the kernel is built with LOCK_STATISTICS.
+//       Since every lock does, nothing in here may take a lock or allocate memory.
+class LockStatistics {
+public:
+    enum class LockType : u8 {
+        Lock,
+        SpinLock,
+        RecursiveSpinLock,
+    };
+
+    class Site {
+        friend class LockStatistics;
+
+    public:
+        StringView filename() const { return m_filename; }
+        StringView function_name() const { return m_function_name; }
+        u32 line_number() const { return m_line_number; }
+        LockType lock_type() const { return m_lock_type; }
+        // The name of the first lock taken here, if it has one.
+        const char* lock_name() const { return m_lock_name; }
+
+        u64 acquisitions() const { return m_acquisitions.load(AK::MemoryOrder::memory_order_relaxed); }
+        u64 contended_acquisitions() const { return m_contended_acquisitions.load(AK::MemoryOrder::memory_order_relaxed); }
+        u64 total_wait_cycles() const { return m_total_wait_cycles.load(AK::MemoryOrder::memory_order_relaxed); }
+        u64 max_hold_cycles() const { return m_max_hold_cycles.load(AK::MemoryOrder::memory_order_relaxed); }
+
+    private:
+        bool is_at(const SourceLocation& location) const
+        {
+            return m_filename.characters_without_null_termination() == location.filename().characters_without_null_termination() && m_line_number == location.line_number();
+        }
+
+        enum class State : u8 {
+            Empty,
+            Claimed,
+            Ready,
+        };
+        Atomic<State> m_state;
+
+        StringView m_filename;
+        StringView m_function_name;
+        const char* m_lock_name { nullptr };
+        u32 m_line_number { 0 };
+        LockType m_lock_type { LockType::Lock };
+
+        Atomic<u64> m_acquisitions;
+        Atomic<u64> m_contended_acquisitions;
+        Atomic<u64> m_total_wait_cycles;
+        Atomic<u64> m_max_hold_cycles;
+    };
+
+    static u64 now() { return read_tsc(); }
+
+    // Called right after a lock was taken at the given location. If it had to wait, contended_since is when it started to.
+    // The site the lock was taken at last time is a good hint for where it's being taken at this time.
+    static Site* did_acquire(const SourceLocation&, LockType, const char* lock_name, Site* hint, Optional<u64> contended_since);
+    // Called right before the lock that was taken at the site at acquired_at is let go of.
+    static void did_release(Site*, u64 acquired_at);
+
+    static void for_each_site(Function<void(const Site&)>);
+    // How many sites didn't fit in the table, and aren't being counted.
+    static size_t dropped_site_count();
+
+private:
+    static Site* find_or_create_site(const SourceLocation&, LockType, const char* lock_name);
+};
+
+}
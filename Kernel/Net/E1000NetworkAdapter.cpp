@@ -8,6 +8,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
 #include <Kernel/PCI/IDs.h>
+#include <Kernel/Process.h>
 
 namespace Kernel {
 
@@ -78,6 +79,21 @@ namespace Kernel {
 #define CMD_VLE (1 << 6)  // VLAN Packet Enable
 #define CMD_IDE (1 << 7)  // Interrupt Delay Enable
 
+// Extended Transmit Descriptors (in the upper half of the second dword)
+#define DTYP_CONTEXT (0 << 20)
+#define DTYP_DATA (1 << 20)
+#define TUCMD_TCP (1 << 24)  // Packet Is TCP
+#define TUCMD_IP (1 << 25)   // Packet Is IPv4
+#define TUCMD_TSE (1 << 26)  // TCP Segmentation Enable
+#define TUCMD_DEXT (1 << 29) // Extension
+#define DCMD_EOP (1 << 24)   // End of Packet
+#define DCMD_IFCS (1 << 25)  // Insert FCS
+#define DCMD_TSE (1 << 26)   // TCP Segmentation Enable
+#define DCMD_RS (1 << 27)    // Report Status
+#define DCMD_DEXT (1 << 29)  // Extension
+#define POPTS_IXSM (1 << 0)  // Insert IP Checksum
+#define POPTS_TXSM (1 << 1)  // Insert TCP Checksum
+
 // TCTL Register
 
 #define TCTL_EN (1 << 1)      // Transmit Enable
@@ -181,8 +197,18 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_link()
 UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_interrupts()
 {
     out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO | INTERRUPT_TXDW);
     in32(REG_INTERRUPT_CAUSE_READ);
+
+    // NOTE: The cards that can do MSI-X would want their IVAR set up first, so we stick to plain MSI.
+    m_message_signaled_interrupts = PCI::MessageSignaledInterrupts::try_create(pci_address(), 1, class_name(), PCI::MessageSignaledInterrupts::AllowMSIX::No);
+    if (m_message_signaled_interrupts) {
+        m_message_signaled_interrupts->set_handler(0, [this](auto& regs) {
+            handle_irq(regs);
+        });
+        m_message_signaled_interrupts->enable();
+        return;
+    }
     enable_irq();
 }
 
@@ -246,8 +272,13 @@ void E1000NetworkAdapter::handle_irq(const RegisterState&)
     if (status & INTERRUPT_RXO) {
         dbgln_if(E1000_DEBUG, "E1000: RX buffer overrun");
     }
-    if (status & INTERRUPT_RXT0) {
-        receive();
+    if (status & (INTERRUPT_RXT0 | INTERRUPT_RXO)) {
+        // Leave the receiving to poll_receive(), and don't bother us again until it's caught up.
+        // During a burst of packets, that way we take one interrupt instead of one per packet.
+        if (!m_rx_poll_queued.exchange(true)) {
+            out32(REG_INTERRUPT_MASK_CLEAR, INTERRUPT_RXT0 | INTERRUPT_RXO);
+            m_rx_tasklet.schedule();
+        }
     }
 
     m_wait_queue.wake_all();
@@ -314,10 +345,10 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
     for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
         auto& descriptor = rx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 RX buffer", Region::Access::Read | Region::Access::Write);
-        VERIFY(region);
-        m_rx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_rx_buffers_regions[i].physical_page(0)->paddr().get();
+        auto packet = acquire_packet_buffer(rx_buffer_size);
+        VERIFY(packet);
+        m_rx_packets[i] = packet;
+        descriptor.addr = packet->buffer.impl().region().physical_page(0)->paddr().get();
         descriptor.status = 0;
     }
 
@@ -327,20 +358,16 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
     out32(REG_RXDESCHEAD, 0);
     out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_2048);
 }
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
 {
+    m_tx_buffers_region = MM.allocate_contiguous_kernel_region(number_of_tx_descriptors * tx_buffer_size, "E1000 TX buffers", Region::Access::Read | Region::Access::Write);
+    VERIFY(m_tx_buffers_region);
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    for (size_t i = 0; i < number_of_tx_descriptors; ++i) {
-        auto& descriptor = tx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 TX buffer", Region::Access::Read | Region::Access::Write);
-        VERIFY(region);
-        m_tx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_tx_buffers_regions[i].physical_page(0)->paddr().get();
-        descriptor.cmd = 0;
-    }
+    for (size_t i = 0; i < number_of_tx_descriptors; ++i)
+        tx_descriptors[i].cmd = 0;
 
     out32(REG_TXDESCLO, m_tx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_TXDESCHI, 0);
@@ -409,51 +436,163 @@ u32 E1000NetworkAdapter::in32(u16 address)
     return m_io_base.offset(address).in<u32>();
 }
 
+void E1000NetworkAdapter::transmit_descriptors(size_t tx_end, volatile uint8_t& last_status)
+{
+    VERIFY(m_tx_lock.is_locked());
+    cli();
+    if (!m_message_signaled_interrupts)
+        enable_irq();
+    out32(REG_TXDESCTAIL, tx_end);
+    for (;;) {
+        if (last_status) {
+            sti();
+            break;
+        }
+        m_wait_queue.wait_forever("E1000NetworkAdapter");
+    }
+}
+
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 {
+    VERIFY(payload.size() <= tx_buffer_size);
+    Locker locker(m_tx_lock);
     disable_irq();
     size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
     dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
     auto& descriptor = tx_descriptors[tx_current];
-    VERIFY(payload.size() <= 8192);
-    auto* vptr = (void*)m_tx_buffers_regions[tx_current].vaddr().as_ptr();
-    memcpy(vptr, payload.data(), payload.size());
+    size_t buffer_offset = tx_current * tx_buffer_size;
+    memcpy(m_tx_buffers_region->vaddr().offset(buffer_offset).as_ptr(), payload.data(), payload.size());
+    descriptor.addr = m_tx_buffers_region->physical_page(buffer_offset / PAGE_SIZE)->paddr().offset(buffer_offset % PAGE_SIZE).get();
     descriptor.length = payload.size();
+    descriptor.cso = 0;
     descriptor.status = 0;
+    descriptor.css = 0;
+    descriptor.special = 0;
     descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
     dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
+    transmit_descriptors((tx_current + 1) % number_of_tx_descriptors, descriptor.status);
+    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
+}
+
+void E1000NetworkAdapter::send_raw_with_tcp_offload(PacketWithTimestamp& packet, const TCPOffload& offload)
+{
+    auto& buffer = packet.buffer;
+    auto& region = buffer.impl().region();
+    size_t header_size = offload.tcp_header_offset + offload.tcp_header_size;
+    VERIFY(header_size <= buffer.size() && header_size <= PAGE_SIZE);
+    size_t payload_size = buffer.size() - header_size;
+    bool should_segment = offload.segment_size != 0;
+
+    Locker locker(m_tx_lock);
+    disable_irq();
+    size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
+    dbgln_if(E1000_DEBUG, "E1000: Sending packet with TCP offload ({} bytes, segment size {})", buffer.size(), offload.segment_size);
+    auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
+
+    // First, tell the card where the headers are, and what it should fill in.
+    // NOTE: The IPv4 checksum is at offset 10 in its header, and the TCP checksum is at offset 16 in its.
+    auto& context = *(e1000_tx_context_desc*)&tx_descriptors[tx_current];
+    context.ipcss = layer3_payload_offset();
+    context.ipcso = layer3_payload_offset() + 10;
+    context.ipcse = offload.tcp_header_offset - 1;
+    context.tucss = offload.tcp_header_offset;
+    context.tucso = offload.tcp_header_offset + 16;
+    context.tucse = 0;
+    context.paylen_dtyp_tucmd = (should_segment ? payload_size : 0) | DTYP_CONTEXT | TUCMD_DEXT | TUCMD_IP | TUCMD_TCP | (should_segment ? TUCMD_TSE : 0);
+    context.status = 0;
+    context.hdrlen = should_segment ? header_size : 0;
+    context.mss = offload.segment_size;
     tx_current = (tx_current + 1) % number_of_tx_descriptors;
-    cli();
-    enable_irq();
-    out32(REG_TXDESCTAIL, tx_current);
-    for (;;) {
-        if (descriptor.status) {
-            sti();
-            break;
+
+    // Then hand the card the headers and every page of payload straight out of the packet buffer.
+    // NOTE: The card redoes the IPv4 checksum for every segment, since the length and identification change.
+    u8 popts = POPTS_TXSM | (should_segment ? POPTS_IXSM : 0);
+    e1000_tx_data_desc* last_descriptor = nullptr;
+    size_t descriptor_count = 1;
+    auto add_data_descriptors = [&](size_t offset, size_t end) {
+        while (offset < end) {
+            size_t length = min(end - offset, PAGE_SIZE - offset % PAGE_SIZE);
+            VERIFY(++descriptor_count < number_of_tx_descriptors);
+            auto& descriptor = *(e1000_tx_data_desc*)&tx_descriptors[tx_current];
+            descriptor.addr = region.physical_page(offset / PAGE_SIZE)->paddr().offset(offset % PAGE_SIZE).get();
+            descriptor.length_dtyp_dcmd = length | DTYP_DATA | DCMD_DEXT | DCMD_IFCS | (should_segment ? DCMD_TSE : 0);
+            descriptor.status = 0;
+            descriptor.popts = popts;
+            descriptor.special = 0;
+            last_descriptor = &descriptor;
+            tx_current = (tx_current + 1) % number_of_tx_descriptors;
+            offset += length;
         }
-        m_wait_queue.wait_forever("E1000NetworkAdapter");
-    }
-    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
+    };
+    add_data_descriptors(0, header_size);
+    add_data_descriptors(header_size, buffer.size());
+    VERIFY(last_descriptor);
+    last_descriptor->length_dtyp_dcmd = last_descriptor->length_dtyp_dcmd | DCMD_EOP | DCMD_RS;
+
+    dbgln_if(E1000_DEBUG, "E1000: Using {} tx descriptors (head is at {})", descriptor_count, in32(REG_TXDESCHEAD));
+    transmit_descriptors(tx_current, last_descriptor->status);
+    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)last_descriptor->status);
 }
 
-void E1000NetworkAdapter::receive()
+bool E1000NetworkAdapter::has_received_packets()
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
+    u32 rx_current = (in32(REG_RXDESCTAIL) + 1) % number_of_rx_descriptors;
+    return rx_descriptors[rx_current].status & 1;
+}
+
+size_t E1000NetworkAdapter::receive(size_t budget)
+{
+    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    size_t received_count = 0;
+    while (received_count < budget) {
+        u32 rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
         rx_current = (rx_current + 1) % number_of_rx_descriptors;
-        if (!(rx_descriptors[rx_current].status & 1))
+        auto& descriptor = rx_descriptors[rx_current];
+        if (!(descriptor.status & 1))
             break;
-        auto* buffer = m_rx_buffers_regions[rx_current].vaddr().as_ptr();
-        u16 length = rx_descriptors[rx_current].length;
-        VERIFY(length <= 8192);
-        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
-        did_receive({ buffer, length });
-        rx_descriptors[rx_current].status = 0;
+        u16 length = descriptor.length;
+        VERIFY(length <= rx_buffer_size);
+        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet in slot {} ({} bytes)", rx_current, length);
+
+        // The packet goes up as it is, and the slot gets a new buffer for the next one.
+        // If we can't get another buffer, we drop the packet and reuse its buffer instead.
+        auto& packet = m_rx_packets[rx_current];
+        if (auto new_packet = acquire_packet_buffer(rx_buffer_size)) {
+            packet->buffer.set_size(length);
+            packet->timestamp = kgettimeofday();
+            did_receive(packet.release_nonnull());
+            packet = move(new_packet);
+            descriptor.addr = packet->buffer.impl().region().physical_page(0)->paddr().get();
+        } else {
+            dbgln("E1000: Dropping packet because we're out of packet buffers");
+        }
+
+        descriptor.status = 0;
         out32(REG_RXDESCTAIL, rx_current);
+        ++received_count;
+    }
+    return received_count;
+}
+
+bool E1000NetworkAdapter::poll_receive(size_t budget)
+{
+    VERIFY(m_rx_poll_queued);
+    budget = min(budget, rx_poll_budget);
+    if (receive(budget) == budget) {
+        // There's probably more where that came from, but let others have a turn first.
+        return true;
+    }
+
+    m_rx_poll_queued = false;
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_RXT0 | INTERRUPT_RXO);
+    // A packet may have come in after we looked, and the interrupt for it may be gone already.
+    if (has_received_packets() && !m_rx_poll_queued.exchange(true)) {
+        out32(REG_INTERRUPT_MASK_CLEAR, INTERRUPT_RXT0 | INTERRUPT_RXO);
+        return true;
     }
+    return false;
 }
 
 }
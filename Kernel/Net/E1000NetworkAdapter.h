@@ -6,14 +6,18 @@
 
 #pragma once
 
-#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/OwnPtr.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Lock.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/PCI/Access.h>
 #include <Kernel/PCI/Device.h>
+#include <Kernel/PCI/MSI.h>
 #include <Kernel/Random.h>
+#include <Kernel/Tasklet.h>
 
 namespace Kernel {
 
@@ -27,6 +31,9 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_tcp_offload(PacketWithTimestamp&, const TCPOffload&) override;
+    virtual bool has_tcp_checksum_offload() const override { return true; }
+    virtual size_t tcp_segmentation_max_payload_size() const override { return tso_max_payload_size; }
     virtual bool link_up() override;
 
     virtual const char* purpose() const override { return class_name(); }
@@ -58,6 +65,28 @@ protected:
         volatile uint16_t special { 0 };
     };
 
+    // Sets up the checksum offload and segmentation for the data descriptors after it.
+    struct [[gnu::packed]] e1000_tx_context_desc {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint32_t paylen_dtyp_tucmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t hdrlen { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
+    struct [[gnu::packed]] e1000_tx_data_desc {
+        volatile uint64_t addr { 0 };
+        volatile uint32_t length_dtyp_dcmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t popts { 0 };
+        volatile uint16_t special { 0 };
+    };
+
     virtual void detect_eeprom();
     virtual u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -67,6 +96,8 @@ protected:
 
     void initialize_rx_descriptors();
     void initialize_tx_descriptors();
+    // Hands the descriptors up to tx_end to the card, and waits until it's done with the last one.
+    void transmit_descriptors(size_t tx_end, volatile uint8_t& last_status);
 
     void out8(u16 address, u8);
     void out16(u16 address, u16);
@@ -75,22 +106,42 @@ protected:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    // Hands up to budget received packets to the network stack, and returns how many there were.
+    size_t receive(size_t budget);
+    // Called from m_rx_tasklet, returns true if there's more to receive.
+    bool poll_receive(size_t budget);
+    bool has_received_packets();
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
     OwnPtr<Region> m_rx_descriptors_region;
     OwnPtr<Region> m_tx_descriptors_region;
-    NonnullOwnPtrVector<Region> m_rx_buffers_regions;
-    NonnullOwnPtrVector<Region> m_tx_buffers_regions;
+    // Only send_raw() copies into these, offloaded packets are sent straight out of their packet buffers.
+    OwnPtr<Region> m_tx_buffers_region;
+    Lock m_tx_lock { "E1000 TX" };
     OwnPtr<Region> m_mmio_region;
     u8 m_interrupt_line { 0 };
+    // Used instead of the interrupt pin if the card can do it.
+    OwnPtr<PCI::MessageSignaledInterrupts> m_message_signaled_interrupts;
     bool m_has_eeprom { false };
     bool m_use_mmio { false };
     EntropySource m_entropy_source;
 
     static constexpr size_t number_of_rx_descriptors = 32;
-    static constexpr size_t number_of_tx_descriptors = 8;
+    static constexpr size_t number_of_tx_descriptors = 32;
+    static constexpr size_t tx_buffer_size = 2048;
+    // NOTE: A packet this big takes up to 11 descriptors: a context descriptor, one for the headers, and one per page of payload.
+    static constexpr size_t tso_max_payload_size = 32 * KiB;
+    // NOTE: This has to fit in a single page, so the card can DMA straight into a packet buffer.
+    static constexpr size_t rx_buffer_size = 2048;
+    static constexpr size_t rx_poll_budget = 64;
+
+    // The card receives right into these packets, which then go up the stack as they are.
+    // Every slot gets a fresh packet buffer when its packet is handed up.
+    Array<RefPtr<PacketWithTimestamp>, number_of_rx_descriptors> m_rx_packets;
+    // Set while receiving is left to poll_receive() with the RX interrupts masked.
+    Atomic<bool> m_rx_poll_queued { false };
+    Tasklet m_rx_tasklet { [this](size_t budget) { return poll_receive(budget); } };
 
     WaitQueue m_wait_queue;
 };
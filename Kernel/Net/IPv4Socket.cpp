@@ -174,6 +174,42 @@ bool IPv4Socket::can_write(const FileDescription&, size_t) const
     return true;
 }
 
+RefPtr<ReusePortGroup> ReusePortGroup::create(IPv4Socket& first_socket)
+{
+    auto group = adopt_ref_if_nonnull(new ReusePortGroup);
+    if (!group || !group->try_add(first_socket))
+        return {};
+    return group;
+}
+
+KResult IPv4Socket::share_port_with(IPv4Socket& bound_socket)
+{
+    // Only sockets of the same user get to share a port, so nobody can take over another user's traffic.
+    if (!reuse_port() || !bound_socket.reuse_port() || origin_uid() != bound_socket.origin_uid())
+        return EADDRINUSE;
+    VERIFY(!m_reuse_port_group);
+    if (!bound_socket.m_reuse_port_group) {
+        bound_socket.m_reuse_port_group = ReusePortGroup::create(bound_socket);
+        if (!bound_socket.m_reuse_port_group)
+            return ENOMEM;
+    }
+    if (!bound_socket.m_reuse_port_group->try_add(*this))
+        return ENOMEM;
+    m_reuse_port_group = bound_socket.m_reuse_port_group;
+    return KSuccess;
+}
+
+IPv4Socket* IPv4Socket::leave_reuse_port_group()
+{
+    if (!m_reuse_port_group)
+        return nullptr;
+    auto group = move(m_reuse_port_group);
+    group->remove(*this);
+    if (group->is_empty())
+        return nullptr;
+    return &group->first();
+}
+
 PortAllocationResult IPv4Socket::allocate_local_port_if_needed()
 {
     Locker locker(lock());
@@ -587,20 +623,41 @@ int IPv4Socket::ioctl(FileDescription&, unsigned request, FlatPtr arg)
         if (!adapter)
             return -ENODEV;
 
-        switch (request) {
-        case SIOCADDRT:
-            if (!Process::current()->is_superuser())
-                return -EPERM;
+        if (!Process::current()->is_superuser())
+            return -EPERM;
+        if ((route.rt_flags & RTF_UP) != RTF_UP)
+            return -EINVAL; // FIXME: Find the correct value to return
+
+        IPv4Address gateway;
+        if (route.rt_flags & RTF_GATEWAY) {
             if (route.rt_gateway.sa_family != AF_INET)
                 return -EAFNOSUPPORT;
-            if ((route.rt_flags & (RTF_UP | RTF_GATEWAY)) != (RTF_UP | RTF_GATEWAY))
-                return -EINVAL; // FIXME: Find the correct value to return
-            adapter->set_ipv4_gateway(IPv4Address(((sockaddr_in&)route.rt_gateway).sin_addr.s_addr));
-            return 0;
+            gateway = IPv4Address(((sockaddr_in&)route.rt_gateway).sin_addr.s_addr);
+        }
+        auto destination = IPv4Address(((sockaddr_in&)route.rt_dst).sin_addr.s_addr);
+        auto netmask = IPv4Address(((sockaddr_in&)route.rt_genmask).sin_addr.s_addr);
+
+        // NOTE: The default route is the adapter's gateway, so it keeps showing up in /proc/net/adapters.
+        bool is_default_route = netmask.is_zero();
+        if (is_default_route && gateway.is_zero())
+            return -EINVAL;
+
+        switch (request) {
+        case SIOCADDRT:
+            if (is_default_route) {
+                adapter->set_ipv4_gateway(gateway);
+                return 0;
+            }
+            return (int)add_route(destination, netmask, gateway, *adapter);
 
         case SIOCDELRT:
-            // FIXME: Support gateway deletion
-            return 0;
+            if (is_default_route) {
+                if (adapter->ipv4_gateway() != gateway)
+                    return -ESRCH;
+                adapter->set_ipv4_gateway({});
+                return 0;
+            }
+            return (int)delete_route(destination, netmask, gateway, *adapter);
         }
 
         return -EINVAL;
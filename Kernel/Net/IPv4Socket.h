@@ -21,6 +21,28 @@ class NetworkAdapter;
 class TCPPacket;
 class TCPSocket;
 
+// The sockets with SO_REUSEPORT that are bound to the same address and port.
+// Every incoming flow goes to one of them, picked by the hash of the flow, so the load gets spread
+// over all of them while every packet of a flow still ends up with the same socket.
+//
+// NOTE: The group is only ever touched with the lock of the table of bound sockets held.
+class ReusePortGroup : public RefCounted<ReusePortGroup> {
+public:
+    static RefPtr<ReusePortGroup> create(IPv4Socket& first_socket);
+
+    bool try_add(IPv4Socket& socket) { return m_sockets.try_append(&socket); }
+    void remove(IPv4Socket& socket) { m_sockets.remove_first_matching([&](auto* entry) { return entry == &socket; }); }
+
+    bool is_empty() const { return m_sockets.is_empty(); }
+    IPv4Socket& first() { return *m_sockets.first(); }
+    IPv4Socket& socket_for_flow(unsigned flow_hash) { return *m_sockets[flow_hash % m_sockets.size()]; }
+
+private:
+    ReusePortGroup() = default;
+
+    Vector<IPv4Socket*, 4> m_sockets;
+};
+
 struct PortAllocationResult {
     KResultOr<u16> error_or_port;
     bool did_allocate;
@@ -92,6 +114,16 @@ protected:
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    size_t receive_buffer_space() const { return m_receive_buffer.space_for_writing(); }
+
+    // Both of these expect the lock of the protocol's table of bound sockets to be held.
+    // Puts us into the ReusePortGroup of a socket that's already bound where we want to be, if both of us allow it.
+    KResult share_port_with(IPv4Socket& bound_socket);
+    // Returns who should take our place in the table of bound sockets, if anyone.
+    IPv4Socket* leave_reuse_port_group();
+
+    ReusePortGroup* reuse_port_group() { return m_reuse_port_group; }
+
 private:
     virtual bool is_ipv4() const override { return true; }
 
@@ -129,6 +161,8 @@ private:
     BufferMode m_buffer_mode { BufferMode::Packets };
 
     Optional<KBuffer> m_scratch_buffer;
+
+    RefPtr<ReusePortGroup> m_reuse_port_group;
 };
 
 }
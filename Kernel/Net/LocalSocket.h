@@ -93,8 +93,11 @@ private:
     bool m_accept_side_fd_open { false };
     sockaddr_un m_address { 0, { 0 } };
 
-    DoubleBuffer m_for_client;
-    DoubleBuffer m_for_server;
+    // Big IPC messages (like bitmaps) should get through in one write instead of being chopped up.
+    static constexpr size_t buffer_capacity = 64 * KiB;
+    static constexpr size_t max_buffer_capacity = 1 * MiB;
+    DoubleBuffer m_for_client { buffer_capacity, max_buffer_capacity };
+    DoubleBuffer m_for_server { buffer_capacity, max_buffer_capacity };
 
     NonnullRefPtrVector<FileDescription> m_fds_for_client;
     NonnullRefPtrVector<FileDescription> m_fds_for_server;
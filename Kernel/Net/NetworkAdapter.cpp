@@ -13,6 +13,8 @@
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
+#include <Kernel/Net/Routing.h>
+#include <Kernel/Net/TCP.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
 #include <Kernel/StdLib.h>
@@ -34,6 +36,20 @@ void NetworkAdapter::send_packet(ReadonlyBytes packet)
     send_raw(packet);
 }
 
+void NetworkAdapter::send_packet_with_tcp_offload(PacketWithTimestamp& packet, const TCPOffload& offload)
+{
+    size_t payload_size = packet.buffer.size() - offload.tcp_header_offset - offload.tcp_header_size;
+    if (offload.segment_size) {
+        VERIFY(payload_size <= tcp_segmentation_max_payload_size());
+        m_packets_out += max(ceil_div(payload_size, offload.segment_size), (size_t)1);
+    } else {
+        VERIFY(has_tcp_checksum_offload());
+        m_packets_out++;
+    }
+    m_bytes_out += packet.buffer.size();
+    send_raw_with_tcp_offload(packet, offload);
+}
+
 void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet)
 {
     size_t size_in_bytes = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -49,7 +65,8 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    // NOTE: TCP packets that the adapter segments for us can be bigger than the MTU.
+    VERIFY(ipv4_packet_size <= mtu() || (protocol == IPv4Protocol::TCP && payload_size <= sizeof(TCPPacket) + tcp_segmentation_max_payload_size()));
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer.size() == ethernet_frame_size);
@@ -72,13 +89,15 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
 
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
 {
-    InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
-
-    if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
-        return;
+    {
+        ScopedSpinLock lock(m_packet_queue_lock);
+        m_packets_in++;
+        m_bytes_in += payload.size();
+
+        if (m_packet_queue_size == max_packet_buffers) {
+            // FIXME: Keep track of the number of dropped packets
+            return;
+        }
     }
 
     auto packet = acquire_packet_buffer(payload.size());
@@ -89,43 +108,55 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
 
     memcpy(packet->buffer.data(), payload.data(), payload.size());
 
-    m_packet_queue.append(*packet);
-    m_packet_queue_size++;
+    {
+        ScopedSpinLock lock(m_packet_queue_lock);
+        m_packet_queue.append(*packet);
+        m_packet_queue_size++;
+    }
+
+    if (on_receive)
+        on_receive();
+}
+
+void NetworkAdapter::did_receive(NonnullRefPtr<PacketWithTimestamp> packet)
+{
+    {
+        ScopedSpinLock lock(m_packet_queue_lock);
+        m_packets_in++;
+        m_bytes_in += packet->buffer.size();
+
+        if (m_packet_queue_size == max_packet_buffers) {
+            // FIXME: Keep track of the number of dropped packets
+            m_unused_packets.append(packet);
+            return;
+        }
+        m_packet_queue.append(packet);
+        m_packet_queue_size++;
+    }
 
     if (on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+RefPtr<PacketWithTimestamp> NetworkAdapter::dequeue_packet()
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock lock(m_packet_queue_lock);
     if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
+        return {};
     m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer.data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    return m_packet_queue.take_first();
 }
 
 RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
 {
-    InterruptDisabler disabler;
-    if (m_unused_packets.is_empty()) {
-        auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-        auto packet = adopt_ref_if_nonnull(new PacketWithTimestamp { move(buffer), kgettimeofday() });
-        if (!packet)
-            return nullptr;
-        packet->buffer.set_size(size);
-        return packet;
+    RefPtr<PacketWithTimestamp> packet;
+    {
+        ScopedSpinLock lock(m_packet_queue_lock);
+        if (!m_unused_packets.is_empty())
+            packet = m_unused_packets.take_first();
     }
 
-    auto packet = m_unused_packets.take_first();
-    if (packet->buffer.capacity() >= size) {
+    if (packet && packet->buffer.capacity() >= size) {
         packet->timestamp = kgettimeofday();
         packet->buffer.set_size(size);
         return packet;
@@ -141,23 +172,26 @@ RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
 
 void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock lock(m_packet_queue_lock);
     m_unused_packets.append(packet);
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
 {
     m_ipv4_address = address;
+    invalidate_routes();
 }
 
 void NetworkAdapter::set_ipv4_netmask(const IPv4Address& netmask)
 {
     m_ipv4_netmask = netmask;
+    invalidate_routes();
 }
 
 void NetworkAdapter::set_ipv4_gateway(const IPv4Address& gateway)
 {
     m_ipv4_gateway = gateway;
+    invalidate_routes();
 }
 
 void NetworkAdapter::set_interface_name(const PCI::Address& pci_address)
@@ -13,6 +13,7 @@
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
@@ -28,6 +29,9 @@ class NetworkAdapter;
 using NetworkByteBuffer = AK::Detail::ByteBuffer<1500>;
 
 struct PacketWithTimestamp : public RefCounted<PacketWithTimestamp> {
+    MAKE_SLAB_CACHED(PacketWithTimestamp);
+
+public:
     PacketWithTimestamp(KBuffer buffer, Time timestamp)
         : buffer(move(buffer))
         , timestamp(timestamp)
@@ -39,6 +43,14 @@ struct PacketWithTimestamp : public RefCounted<PacketWithTimestamp> {
     IntrusiveListNode<PacketWithTimestamp, RefPtr<PacketWithTimestamp>> packet_node;
 };
 
+// Tells an adapter where the TCP segment in a packet is, so it can fill in the checksum (and possibly segment it) by itself.
+struct TCPOffload {
+    size_t tcp_header_offset { 0 };
+    size_t tcp_header_size { 0 };
+    // If this is nonzero, the adapter cuts the payload into segments of at most this many bytes.
+    size_t segment_size { 0 };
+};
+
 class NetworkAdapter : public RefCounted<NetworkAdapter>
     , public Weakable<NetworkAdapter> {
 public:
@@ -61,7 +73,8 @@ public:
     void send(const MACAddress&, const ARPPacket&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    // The packet goes back to us with release_packet_buffer() once it's been handled.
+    RefPtr<PacketWithTimestamp> dequeue_packet();
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
 
@@ -83,12 +96,23 @@ public:
 
     void send_packet(ReadonlyBytes);
 
+    // NOTE: A packet sent with checksum offload only has the pseudo-header sum in its checksum field.
+    //       With segmentation, that sum leaves out the length, since the adapter adds that per segment.
+    virtual bool has_tcp_checksum_offload() const { return false; }
+    // The biggest TCP payload the adapter segments by itself, or 0 if it can't.
+    virtual size_t tcp_segmentation_max_payload_size() const { return 0; }
+    // The adapter sends straight out of the packet buffer, so it has to stay untouched until this returns.
+    void send_packet_with_tcp_offload(PacketWithTimestamp&, const TCPOffload&);
+
 protected:
     NetworkAdapter();
     void set_interface_name(const PCI::Address&);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
+    // Queues a packet the driver received right into one of our packet buffers, without copying it.
+    void did_receive(NonnullRefPtr<PacketWithTimestamp>);
     virtual void send_raw(ReadonlyBytes) = 0;
+    virtual void send_raw_with_tcp_offload(PacketWithTimestamp&, const TCPOffload&) { VERIFY_NOT_REACHED(); }
 
     void set_loopback_name();
 
@@ -103,6 +127,8 @@ private:
 
     using PacketList = IntrusiveList<PacketWithTimestamp, RefPtr<PacketWithTimestamp>, &PacketWithTimestamp::packet_node>;
 
+    // NOTE: Packets get queued from the IRQ handler, and taken off by whichever processor runs the NetworkTask.
+    SpinLock<u8> m_packet_queue_lock;
     PacketList m_packet_queue;
     size_t m_packet_queue_size { 0 };
     PacketList m_unused_packets;
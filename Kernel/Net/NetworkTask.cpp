@@ -18,25 +18,50 @@
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
+#include <Kernel/Net/TCPTimerWheel.h>
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
 
 namespace Kernel {
 
+// Incoming packets are spread over one worker per processor by hashing their flow, so packets of different
+// connections get handled in parallel, while all packets of any one connection are handled in order by the
+// same worker. The first worker is the NetworkTask itself, which also takes the packets off the adapters.
+class NetworkWorker {
+public:
+    struct QueuedPacket {
+        NonnullRefPtr<NetworkAdapter> adapter;
+        NonnullRefPtr<PacketWithTimestamp> packet;
+    };
+
+    void enqueue(QueuedPacket&&);
+    // Returns false if there was nothing to handle.
+    bool handle_queued_packets();
+
+    RefPtr<Thread> thread;
+    WaitQueue wait_queue;
+
+private:
+    static constexpr size_t max_queued_packets = 1024;
+
+    SpinLock<u8> m_queue_lock;
+    Vector<QueuedPacket> m_queue;
+};
+
+static void handle_packet(const PacketWithTimestamp&);
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
 static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
 static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
 static void handle_udp(const IPv4Packet&, const Time& packet_timestamp);
 static void handle_tcp(const IPv4Packet&, const Time& packet_timestamp);
-static void send_delayed_tcp_ack(RefPtr<TCPSocket> socket);
-static void flush_delayed_tcp_acks();
-static void retransmit_tcp_packets();
+static void handle_expired_tcp_timers();
 
 static Thread* network_task = nullptr;
-static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
+static Vector<NetworkWorker*>* workers;
 
 [[noreturn]] static void NetworkTask_main(void*);
+[[noreturn]] static void NetworkWorker_main(void*);
 
 void NetworkTask::spawn()
 {
@@ -47,15 +72,92 @@ void NetworkTask::spawn()
 
 bool NetworkTask::is_current()
 {
-    return Thread::current() == network_task;
+    auto* current_thread = Thread::current();
+    if (current_thread == network_task)
+        return true;
+    if (!workers)
+        return false;
+    for (auto* worker : *workers) {
+        if (worker->thread == current_thread)
+            return true;
+    }
+    return false;
+}
+
+void NetworkWorker::enqueue(QueuedPacket&& queued_packet)
+{
+    {
+        ScopedSpinLock lock(m_queue_lock);
+        if (m_queue.size() < max_queued_packets && m_queue.try_append(move(queued_packet))) {
+            lock.unlock();
+            wait_queue.wake_all();
+            return;
+        }
+    }
+    dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dropping packet, worker queue is full");
+    queued_packet.adapter->release_packet_buffer(*queued_packet.packet);
+}
+
+bool NetworkWorker::handle_queued_packets()
+{
+    Vector<QueuedPacket> packets;
+    {
+        ScopedSpinLock lock(m_queue_lock);
+        packets = move(m_queue);
+    }
+    for (auto& queued_packet : packets) {
+        handle_packet(*queued_packet.packet);
+        queued_packet.adapter->release_packet_buffer(*queued_packet.packet);
+    }
+    return !packets.is_empty();
+}
+
+// Picks the worker for a packet, so that every packet of a TCP connection or UDP flow ends up with the same one.
+static NetworkWorker& worker_for_packet(const PacketWithTimestamp& packet)
+{
+    auto& first_worker = *workers->first();
+    if (workers->size() == 1)
+        return first_worker;
+
+    // NOTE: Anything that isn't obviously TCP or UDP over IPv4 goes to the first worker, which takes care of validating it.
+    size_t packet_size = packet.buffer.size();
+    if (packet_size < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return first_worker;
+    auto& eth = *(const EthernetFrameHeader*)packet.buffer.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return first_worker;
+    auto& ipv4_packet = *static_cast<const IPv4Packet*>(eth.payload());
+    if (ipv4_packet.protocol() != (u8)IPv4Protocol::TCP && ipv4_packet.protocol() != (u8)IPv4Protocol::UDP)
+        return first_worker;
+
+    // Both TCP and UDP headers start with the source and destination ports.
+    size_t ports_offset = sizeof(EthernetFrameHeader) + ipv4_packet.internet_header_length() * sizeof(u32);
+    if (packet_size < ports_offset + 2 * sizeof(u16))
+        return first_worker;
+    auto* ports = (const NetworkOrdered<u16>*)(packet.buffer.data() + ports_offset);
+    IPv4SocketTuple tuple(ipv4_packet.destination(), ports[1], ipv4_packet.source(), ports[0]);
+    return *workers->at(Traits<IPv4SocketTuple>::hash(tuple) % workers->size());
 }
 
 void NetworkTask_main(void*)
 {
-    delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
+    auto* new_workers = new Vector<NetworkWorker*>;
+    auto& first_worker = *new NetworkWorker;
+    first_worker.thread = Thread::current();
+    new_workers->append(&first_worker);
+    for (u32 cpu = 1; cpu < Processor::count(); ++cpu) {
+        auto* worker = new NetworkWorker;
+        worker->thread = Process::current()->create_kernel_thread(NetworkWorker_main, worker, THREAD_PRIORITY_NORMAL, String::formatted("NetworkTask #{}", cpu), 1u << cpu, false);
+        if (!worker->thread) {
+            dmesgln("NetworkTask: Couldn't create a worker thread for CPU #{}", cpu);
+            delete worker;
+            break;
+        }
+        new_workers->append(worker);
+    }
+    workers = new_workers;
+    dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Handling packets with {} workers", workers->size());
 
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -66,60 +168,77 @@ void NetworkTask_main(void*)
         }
 
         adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
+            first_worker.wait_queue.wake_all();
         };
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
+    auto dequeue_and_dispatch_packets = [&] {
+        bool did_dequeue_any = false;
         NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
+            while (auto packet = adapter.dequeue_packet()) {
+                dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet->buffer.size());
+                did_dequeue_any = true;
+                auto& worker = worker_for_packet(*packet);
+                worker.enqueue({ adapter, packet.release_nonnull() });
+            }
         });
-        return packet_size;
+        return did_dequeue_any;
     };
 
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
+    // Only the first worker looks after the TCP timers, so it has to be woken up
+    // when one gets armed to go off before it was going to wake up anyway.
+    TCPTimerWheel::the().on_earlier_deadline = [&] {
+        first_worker.wait_queue.wake_all();
+    };
 
     for (;;) {
-        flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
-            auto timeout_time = Time::from_milliseconds(500);
+        handle_expired_tcp_timers();
+        bool did_dequeue_any = dequeue_and_dispatch_packets();
+        bool did_handle_any = first_worker.handle_queued_packets();
+        if (!did_dequeue_any && !did_handle_any) {
+            auto time_until_next_deadline = TCPTimerWheel::the().time_until_next_deadline();
+            if (!time_until_next_deadline.has_value()) {
+                [[maybe_unused]] auto result = first_worker.wait_queue.wait_on({}, "NetworkTask");
+                continue;
+            }
+            auto timeout_time = time_until_next_deadline.value();
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
-            [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask");
-            continue;
+            [[maybe_unused]] auto result = first_worker.wait_queue.wait_on(timeout, "NetworkTask");
         }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
-            continue;
-        }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
-        dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
+    }
+}
 
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
-            break;
-        case EtherType::IPv6:
-            // ignore
-            break;
-        default:
-            dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
-        }
+void NetworkWorker_main(void* data)
+{
+    auto& worker = *static_cast<NetworkWorker*>(data);
+    for (;;) {
+        if (!worker.handle_queued_packets())
+            [[maybe_unused]] auto result = worker.wait_queue.wait_on({}, "NetworkTask");
+    }
+}
+
+void handle_packet(const PacketWithTimestamp& packet)
+{
+    size_t packet_size = packet.buffer.size();
+    if (packet_size < sizeof(EthernetFrameHeader)) {
+        dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
+        return;
+    }
+    auto& eth = *(const EthernetFrameHeader*)packet.buffer.data();
+    dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, packet_size);
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, packet_size, packet.timestamp);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
     }
 }
 
@@ -282,7 +401,8 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         ipv4_packet.destination(), udp_packet.destination_port(),
         udp_packet.length());
 
-    auto socket = UDPSocket::from_port(udp_packet.destination_port());
+    IPv4SocketTuple flow(ipv4_packet.destination(), udp_packet.destination_port(), ipv4_packet.source(), udp_packet.source_port());
+    auto socket = UDPSocket::from_port(udp_packet.destination_port(), Traits<IPv4SocketTuple>::hash(flow));
     if (!socket) {
         dbgln_if(UDP_DEBUG, "handle_udp: No local UDP socket for {}:{}", ipv4_packet.destination(), udp_packet.destination_port());
         return;
@@ -297,38 +417,6 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
 }
 
-void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
-{
-    VERIFY(socket->lock().is_locked());
-    if (!socket->should_delay_next_ack()) {
-        [[maybe_unused]] auto result = socket->send_ack();
-        return;
-    }
-
-    delayed_ack_sockets->set(move(socket));
-}
-
-void flush_delayed_tcp_acks()
-{
-    Vector<RefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
-        Locker locker(socket->lock());
-        if (socket->should_delay_next_ack()) {
-            remaining_sockets.append(socket);
-            continue;
-        }
-        [[maybe_unused]] auto result = socket->send_ack();
-    }
-
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
-        if (remaining_sockets.size() > 0)
-            dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
-        for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
-    }
-}
-
 void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
 {
     if (ipv4_packet.payload_size() < sizeof(TCPPacket)) {
@@ -430,6 +518,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->process_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -455,14 +544,14 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             return;
         case TCPFlags::ACK | TCPFlags::FIN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
-            send_delayed_tcp_ack(socket);
+            socket->send_delayed_ack();
             socket->set_state(TCPSocket::State::Closed);
             socket->set_error(TCPSocket::Error::FINDuringConnect);
             socket->set_setup_state(Socket::SetupState::Completed);
             return;
         case TCPFlags::ACK | TCPFlags::RST:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            send_delayed_tcp_ack(socket);
+            socket->send_delayed_ack();
             socket->set_state(TCPSocket::State::Closed);
             socket->set_error(TCPSocket::Error::RSTDuringConnect);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -601,7 +690,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
                 socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
 
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
-            send_delayed_tcp_ack(socket);
+            socket->send_delayed_ack();
             socket->set_state(TCPSocket::State::CloseWait);
             socket->set_connected(false);
             return;
@@ -612,27 +701,18 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                socket->send_delayed_ack();
             }
         }
     }
 }
 
-void retransmit_tcp_packets()
+void handle_expired_tcp_timers()
 {
-    // We must keep the sockets alive until after we've unlocked the hash table
-    // in case retransmit_packets() realizes that it wants to close the socket.
-    NonnullRefPtrVector<TCPSocket, 16> sockets;
-    {
-        Locker locker(TCPSocket::sockets_for_retransmit().lock(), LockMode::Shared);
-        for (auto& socket : TCPSocket::sockets_for_retransmit().resource())
-            sockets.append(*socket);
-    }
-
-    for (auto& socket : sockets) {
-        Locker socket_locker(socket.lock());
-        socket.retransmit_packets();
-    }
+    NonnullRefPtrVector<TCPSocket> sockets;
+    TCPTimerWheel::the().take_expired(sockets);
+    for (auto& socket : sockets)
+        socket.handle_timer_expiry();
 }
 
 }
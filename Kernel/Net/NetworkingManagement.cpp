@@ -18,6 +18,7 @@
 #include <Kernel/Net/RTL8139NetworkAdapter.h>
 #include <Kernel/Net/RTL8168NetworkAdapter.h>
 #include <Kernel/Panic.h>
+#include <Kernel/VirtIO/VirtIONetworkAdapter.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 
 namespace Kernel {
@@ -86,6 +87,10 @@ UNMAP_AFTER_INIT RefPtr<NetworkAdapter> NetworkingManagement::determine_network_
         return candidate;
     if (auto candidate = NE2000NetworkAdapter::try_to_initialize(address); !candidate.is_null())
         return candidate;
+    if (!kernel_command_line().disable_virtio()) {
+        if (auto candidate = VirtIONetworkAdapter::try_to_initialize(address); !candidate.is_null())
+            return candidate;
+    }
     return {};
 }
 
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
+#include <AK/HashFunctions.h>
 #include <AK/HashMap.h>
 #include <AK/Singleton.h>
 #include <Kernel/Debug.h>
@@ -17,6 +19,117 @@ namespace Kernel {
 
 static AK::Singleton<Lockable<HashMap<IPv4Address, MACAddress>>> s_arp_table;
 
+struct Route {
+    IPv4Address destination;
+    u8 prefix_length { 0 };
+    // Zero if the destination is directly connected.
+    IPv4Address gateway;
+    NonnullRefPtr<NetworkAdapter> adapter;
+    // The addresses of our own adapters are routed through the loopback adapter, whatever the socket is bound to.
+    bool is_local { false };
+};
+
+static bool address_bit(const IPv4Address& address, size_t index)
+{
+    return (address[index / 8] >> (7 - index % 8)) & 1;
+}
+
+static u8 prefix_length_of(const IPv4Address& netmask)
+{
+    u8 length = 0;
+    while (length < 32 && address_bit(netmask, length))
+        ++length;
+    return length;
+}
+
+// A binary trie of routes by destination prefix, for longest-prefix-match lookups that take
+// at most 32 steps, no matter how many adapters and routes there are.
+class RoutingTable {
+public:
+    explicit RoutingTable(u32 generation)
+        : m_generation(generation)
+    {
+    }
+
+    u32 generation() const { return m_generation; }
+
+    void add(const Route& route)
+    {
+        auto* node = &m_root;
+        for (size_t i = 0; i < route.prefix_length; ++i) {
+            auto& child = node->children[address_bit(route.destination, i)];
+            if (!child)
+                child = make<Node>();
+            node = child.ptr();
+        }
+        node->routes.append(route);
+    }
+
+    // Finds the most specific route to the target that the callback accepts.
+    template<typename Callback>
+    Route* find(const IPv4Address& target, Callback accept)
+    {
+        Array<Node*, 33> path;
+        size_t depth = 0;
+        auto* node = &m_root;
+        while (node) {
+            path[depth++] = node;
+            if (depth == path.size())
+                break;
+            node = node->children[address_bit(target, depth - 1)].ptr();
+        }
+        while (depth--) {
+            for (auto& route : path[depth]->routes) {
+                if (accept(route))
+                    return &route;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    struct Node {
+        OwnPtr<Node> children[2];
+        Vector<Route, 1> routes;
+    };
+
+    u32 m_generation { 0 };
+    Node m_root;
+};
+
+static AK::Singleton<Lockable<OwnPtr<RoutingTable>>> s_routing_table;
+static AK::Singleton<Lockable<Vector<Route>>> s_static_routes;
+// Bumped whenever anything the routing table is made from changes, so the table gets rebuilt.
+static Atomic<u32> s_routing_table_generation { 1 };
+
+// Every processor keeps a small direct-mapped cache of its recent routing decisions, so sending
+// to the same few destinations over and over doesn't have to go through the routing table and
+// the ARP table (and their locks) every time.
+struct RouteCacheEntry {
+    u32 generation { 0 };
+    IPv4Address target;
+    IPv4Address source;
+    const NetworkAdapter* through { nullptr };
+    RoutingDecision decision;
+};
+
+static constexpr size_t route_cache_size = 64;
+static RouteCacheEntry s_route_cache[ProcessorContainer {}.size()][route_cache_size];
+// Bumped whenever a cached decision may have become wrong. Entries from an older generation are ignored.
+static Atomic<u32> s_route_cache_generation { 1 };
+
+static RouteCacheEntry& route_cache_entry(const IPv4Address& target, const IPv4Address& source)
+{
+    VERIFY(Processor::current().in_critical());
+    return s_route_cache[Processor::id()][pair_int_hash(target.to_u32(), source.to_u32()) % route_cache_size];
+}
+
+void invalidate_routes()
+{
+    s_routing_table_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+    s_route_cache_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+}
+
 class ARPTableBlocker : public Thread::Blocker {
 public:
     ARPTableBlocker(IPv4Address ip_addr, Optional<MACAddress>& addr);
@@ -107,7 +220,11 @@ Lockable<HashMap<IPv4Address, MACAddress>>& arp_table()
 void update_arp_table(const IPv4Address& ip_addr, const MACAddress& addr)
 {
     Locker locker(arp_table().lock());
+    auto old_addr = arp_table().resource().get(ip_addr);
     arp_table().resource().set(ip_addr, addr);
+    // NOTE: Failed lookups never get cached, so a new entry can't make a cached decision wrong.
+    if (old_addr.has_value() && !(old_addr.value() == addr))
+        s_route_cache_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
     s_arp_table_block_condition->unblock(ip_addr, addr);
 
     if constexpr (ROUTING_DEBUG) {
@@ -128,7 +245,75 @@ static MACAddress multicast_ethernet_address(IPv4Address const& address)
     return MACAddress { 0x01, 0x00, 0x5e, (u8)(address[1] & 0x7f), address[2], address[3] };
 }
 
-RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, const RefPtr<NetworkAdapter> through)
+static void rebuild_routing_table_if_needed()
+{
+    auto generation = s_routing_table_generation.load(AK::MemoryOrder::memory_order_acquire);
+    {
+        Locker locker(s_routing_table->lock(), Lock::Mode::Shared);
+        auto& table = s_routing_table->resource();
+        if (table && table->generation() == generation)
+            return;
+    }
+
+    // NOTE: We don't hold the routing table lock while going through the adapters, in case
+    //       someone goes through the adapters and routes something at the same time.
+    NonnullRefPtrVector<NetworkAdapter> adapters;
+    NetworkingManagement::the().for_each([&](auto& adapter) {
+        adapters.append(adapter);
+    });
+
+    auto table = make<RoutingTable>(generation);
+    auto loopback_adapter = NetworkingManagement::the().loopback_adapter();
+    for (auto& adapter : adapters) {
+        if (!adapter.ipv4_address().is_zero())
+            table->add({ adapter.ipv4_address(), 32, {}, *loopback_adapter, true });
+        table->add({ adapter.ipv4_address(), prefix_length_of(adapter.ipv4_netmask()), {}, adapter });
+        if (!adapter.ipv4_gateway().is_zero())
+            table->add({ {}, 0, adapter.ipv4_gateway(), adapter });
+    }
+    {
+        Locker locker(s_static_routes->lock(), Lock::Mode::Shared);
+        for (auto& route : s_static_routes->resource())
+            table->add(route);
+    }
+
+    Locker locker(s_routing_table->lock());
+    s_routing_table->resource() = move(table);
+    dbgln_if(ROUTING_DEBUG, "Routing: Rebuilt the routing table (generation {})", generation);
+}
+
+KResult add_route(const IPv4Address& destination, const IPv4Address& netmask, const IPv4Address& gateway, NetworkAdapter& adapter)
+{
+    auto prefix_length = prefix_length_of(netmask);
+    {
+        Locker locker(s_static_routes->lock());
+        auto& routes = s_static_routes->resource();
+        for (auto& route : routes) {
+            if (route.destination == destination && route.prefix_length == prefix_length && route.gateway == gateway && route.adapter.ptr() == &adapter)
+                return EEXIST;
+        }
+        routes.append({ destination, prefix_length, gateway, adapter });
+    }
+    invalidate_routes();
+    return KSuccess;
+}
+
+KResult delete_route(const IPv4Address& destination, const IPv4Address& netmask, const IPv4Address& gateway, NetworkAdapter& adapter)
+{
+    auto prefix_length = prefix_length_of(netmask);
+    {
+        Locker locker(s_static_routes->lock());
+        bool removed = s_static_routes->resource().remove_first_matching([&](auto& route) {
+            return route.destination == destination && route.prefix_length == prefix_length && route.gateway == gateway && route.adapter.ptr() == &adapter;
+        });
+        if (!removed)
+            return ESRCH;
+    }
+    invalidate_routes();
+    return KSuccess;
+}
+
+static RoutingDecision route_to_uncached(const IPv4Address& target, const IPv4Address& source, const RefPtr<NetworkAdapter> through)
 {
     auto matches = [&](auto& adapter) {
         if (!through)
@@ -147,66 +332,48 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
     if (target[0] == 127)
         return if_matches(*NetworkingManagement::the().loopback_adapter(), NetworkingManagement::the().loopback_adapter()->mac_address());
 
-    auto target_addr = target.to_u32();
-    auto source_addr = source.to_u32();
-
-    RefPtr<NetworkAdapter> local_adapter = nullptr;
-    RefPtr<NetworkAdapter> gateway_adapter = nullptr;
+    rebuild_routing_table_if_needed();
 
-    NetworkingManagement::the().for_each([source_addr, &target_addr, &local_adapter, &gateway_adapter, &matches, &through](NetworkAdapter& adapter) {
-        auto adapter_addr = adapter.ipv4_address().to_u32();
-        auto adapter_mask = adapter.ipv4_netmask().to_u32();
+    RefPtr<NetworkAdapter> adapter = nullptr;
+    IPv4Address next_hop_ip;
+    {
+        Locker locker(s_routing_table->lock(), Lock::Mode::Shared);
+        auto* route = s_routing_table->resource()->find(target, [&](Route& route) {
+            if (route.is_local)
+                return true;
+            auto& adapter = *route.adapter;
+            if (!adapter.link_up() || (adapter.ipv4_address().is_zero() && !through))
+                return false;
+            if (!source.is_zero() && source != adapter.ipv4_address())
+                return false;
+            return matches(adapter);
+        });
 
-        if (target_addr == adapter_addr) {
-            local_adapter = NetworkingManagement::the().loopback_adapter();
-            return;
+        if (!route) {
+            dbgln_if(ROUTING_DEBUG, "Routing: Couldn't find a suitable adapter for route to {}", target);
+            return { nullptr, {} };
         }
 
-        if (!adapter.link_up() || (adapter_addr == 0 && !through))
-            return;
-
-        if (source_addr != 0 && source_addr != adapter_addr)
-            return;
-
-        if ((target_addr & adapter_mask) == (adapter_addr & adapter_mask) && matches(adapter))
-            local_adapter = adapter;
-
-        if (adapter.ipv4_gateway().to_u32() != 0 && matches(adapter))
-            gateway_adapter = adapter;
-    });
-
-    if (local_adapter && target == local_adapter->ipv4_address())
-        return { local_adapter, local_adapter->mac_address() };
-
-    if (!local_adapter && !gateway_adapter) {
-        dbgln_if(ROUTING_DEBUG, "Routing: Couldn't find a suitable adapter for route to {}", target);
-        return { nullptr, {} };
+        adapter = route->adapter;
+        if (route->gateway.is_zero()) {
+            dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (direct): {} ({}/{}) for {}",
+                adapter->name(),
+                adapter->ipv4_address(),
+                adapter->ipv4_netmask(),
+                target);
+            next_hop_ip = target;
+        } else {
+            dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (using gateway {}): {} ({}/{}) for {}",
+                route->gateway,
+                adapter->name(),
+                adapter->ipv4_address(),
+                adapter->ipv4_netmask(),
+                target);
+            next_hop_ip = route->gateway;
+        }
     }
 
-    RefPtr<NetworkAdapter> adapter = nullptr;
-    IPv4Address next_hop_ip;
-
-    if (local_adapter) {
-        dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (direct): {} ({}/{}) for {}",
-            local_adapter->name(),
-            local_adapter->ipv4_address(),
-            local_adapter->ipv4_netmask(),
-            target);
-
-        adapter = local_adapter;
-        next_hop_ip = target;
-    } else if (gateway_adapter) {
-        dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (using gateway {}): {} ({}/{}) for {}",
-            gateway_adapter->ipv4_gateway(),
-            gateway_adapter->name(),
-            gateway_adapter->ipv4_address(),
-            gateway_adapter->ipv4_netmask(),
-            target);
-        adapter = gateway_adapter;
-        next_hop_ip = gateway_adapter->ipv4_gateway();
-    } else {
-        return { nullptr, {} };
-    }
+    auto target_addr = target.to_u32();
 
     // If it's a broadcast, we already know everything we need to know.
     // FIXME: We should also deal with the case where `target_addr` is
@@ -221,7 +388,7 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
         return { adapter, multicast_ethernet_address(target) };
 
     {
-        Locker locker(arp_table().lock());
+        Locker locker(arp_table().lock(), Lock::Mode::Shared);
         auto addr = arp_table().resource().get(next_hop_ip);
         if (addr.has_value()) {
             dbgln_if(ROUTING_DEBUG, "Routing: Using cached ARP entry for {} ({})", next_hop_ip, addr.value().to_string());
@@ -261,4 +428,29 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
     return { nullptr, {} };
 }
 
+RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, const RefPtr<NetworkAdapter> through)
+{
+    auto generation = s_route_cache_generation.load(AK::MemoryOrder::memory_order_acquire);
+    {
+        ScopedCritical critical;
+        auto& entry = route_cache_entry(target, source);
+        // NOTE: Only the adapter's link state isn't covered by the generation, so we look at it every time.
+        if (entry.generation == generation && entry.target == target && entry.source == source && entry.through == through.ptr() && entry.decision.adapter->link_up())
+            return entry.decision;
+    }
+
+    auto decision = route_to_uncached(target, source, through);
+    if (decision.is_zero())
+        return decision;
+
+    ScopedCritical critical;
+    auto& entry = route_cache_entry(target, source);
+    entry.generation = generation;
+    entry.target = target;
+    entry.source = source;
+    entry.through = through.ptr();
+    entry.decision = decision;
+    return decision;
+}
+
 }
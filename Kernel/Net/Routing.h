@@ -19,6 +19,13 @@ struct RoutingDecision {
 };
 
 void update_arp_table(const IPv4Address&, const MACAddress&);
+
+// Routes are looked up in a routing table made from the adapters' own addresses, netmasks and gateways,
+// and the static routes that have been added. Call this whenever any of those change.
+void invalidate_routes();
+KResult add_route(const IPv4Address& destination, const IPv4Address& netmask, const IPv4Address& gateway, NetworkAdapter&);
+KResult delete_route(const IPv4Address& destination, const IPv4Address& netmask, const IPv4Address& gateway, NetworkAdapter&);
+
 RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, const RefPtr<NetworkAdapter> through = nullptr);
 
 Lockable<HashMap<IPv4Address, MACAddress>>& arp_table();
@@ -136,6 +136,18 @@ KResult Socket::setsockopt(int level, int option, Userspace<const void*> user_va
             return ENOTSUP;
         }
         return KSuccess;
+    case SO_REUSEPORT: {
+        if (user_value_size != sizeof(int))
+            return EINVAL;
+        int reuse_port;
+        if (!copy_from_user(&reuse_port, static_ptr_cast<const int*>(user_value)))
+            return EFAULT;
+        // NOTE: This only matters when binding, so it can't be changed afterwards.
+        if (setup_state() != SetupState::Unstarted || m_role != Role::None)
+            return EINVAL;
+        m_reuse_port = reuse_port;
+        return KSuccess;
+    }
     default:
         dbgln("setsockopt({}) at SOL_SOCKET not implemented.", option);
         return ENOPROTOOPT;
@@ -219,6 +231,17 @@ KResult Socket::getsockopt(FileDescription&, int level, int option, Userspace<vo
         if (!copy_to_user(value_size, &size))
             return EFAULT;
         return KSuccess;
+    case SO_REUSEPORT: {
+        if (size < sizeof(int))
+            return EINVAL;
+        int reuse_port = m_reuse_port;
+        if (!copy_to_user(static_ptr_cast<int*>(value), &reuse_port))
+            return EFAULT;
+        size = sizeof(int);
+        if (!copy_to_user(value_size, &size))
+            return EFAULT;
+        return KSuccess;
+    }
     default:
         dbgln("setsockopt({}) at SOL_SOCKET not implemented.", option);
         return ENOPROTOOPT;
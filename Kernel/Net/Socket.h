@@ -115,6 +115,7 @@ public:
     const Time& send_timeout() const { return m_send_timeout; }
 
     bool wants_timestamp() const { return m_timestamp; }
+    bool reuse_port() const { return m_reuse_port; }
 
 protected:
     Socket(int domain, int type, int protocol);
@@ -154,6 +155,7 @@ private:
     Time m_receive_timeout {};
     Time m_send_timeout {};
     int m_timestamp { 0 };
+    bool m_reuse_port { false };
 
     NonnullRefPtrVector<Socket> m_pending;
 };
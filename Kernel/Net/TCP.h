@@ -21,6 +21,15 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NOP = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +47,40 @@ private:
 
 static_assert(sizeof(TCPOptionMSS) == 4);
 
+// RFC 7323
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::WindowScale };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(sizeof(TCPOptionWindowScale) == 3);
+
+// RFC 2018
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::SACKPermitted };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) };
+};
+
+static_assert(sizeof(TCPOptionSACKPermitted) == 2);
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(sizeof(TCPSACKBlock) == 8);
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -77,6 +120,36 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const
+    {
+        if (header_size() <= sizeof(TCPPacket))
+            return {};
+        return { ((const u8*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) };
+    }
+
+    // Calls the callback with the kind and the data of every well-formed option.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        auto bytes = options();
+        for (size_t offset = 0; offset < bytes.size();) {
+            auto kind = (TCPOptionKind)bytes[offset];
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NOP) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= bytes.size())
+                return;
+            size_t length = bytes[offset + 1];
+            if (length < 2 || offset + length > bytes.size())
+                return;
+            callback(kind, bytes.slice(offset + 2, length - 2));
+            offset += length;
+        }
+    }
+
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+static Atomic<TCPCongestionControl::Algorithm> s_default_algorithm { TCPCongestionControl::Algorithm::Cubic };
+
+TCPCongestionControl::Algorithm TCPCongestionControl::default_algorithm()
+{
+    return s_default_algorithm.load(AK::MemoryOrder::memory_order_relaxed);
+}
+
+void TCPCongestionControl::set_default_algorithm(Algorithm algorithm)
+{
+    s_default_algorithm.store(algorithm, AK::MemoryOrder::memory_order_relaxed);
+}
+
+OwnPtr<TCPCongestionControl> TCPCongestionControl::create(Algorithm algorithm, size_t mss)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return adopt_own_if_nonnull(new NewRenoCongestionControl(mss));
+    case Algorithm::Cubic:
+        return adopt_own_if_nonnull(new CubicCongestionControl(mss));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+TCPCongestionControl::TCPCongestionControl(size_t mss)
+    : m_mss(mss)
+{
+    // RFC 6928: Start out with ten segments, but no more than 14600 bytes.
+    m_congestion_window = min(10 * mss, max(2 * mss, (size_t)14600));
+}
+
+void TCPCongestionControl::grow_in_slow_start(size_t acked_bytes)
+{
+    m_congestion_window += min(acked_bytes, 2 * m_mss);
+}
+
+NewRenoCongestionControl::NewRenoCongestionControl(size_t mss)
+    : TCPCongestionControl(mss)
+{
+}
+
+void NewRenoCongestionControl::on_ack(size_t acked_bytes, const Time&, const Time&)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(acked_bytes);
+        return;
+    }
+
+    // Grow by one segment per window's worth of acknowledged data.
+    m_bytes_acked += acked_bytes;
+    if (m_bytes_acked >= m_congestion_window) {
+        m_bytes_acked -= m_congestion_window;
+        m_congestion_window += m_mss;
+    }
+}
+
+void NewRenoCongestionControl::on_congestion_event(size_t bytes_in_flight, const Time&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_mss);
+    m_congestion_window = m_slow_start_threshold;
+    m_bytes_acked = 0;
+}
+
+void NewRenoCongestionControl::on_retransmit_timeout(size_t bytes_in_flight, const Time&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_mss);
+    m_congestion_window = m_mss;
+    m_bytes_acked = 0;
+}
+
+// The window shrinks to beta = 7/10 of itself on a loss, and C = 4/10 is how fast it grows back.
+static constexpr u64 cubic_beta_numerator = 7;
+static constexpr u64 cubic_beta_denominator = 10;
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 2642245; // The cube root of the biggest u64, rounded up.
+    while (low < high) {
+        u64 middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+CubicCongestionControl::CubicCongestionControl(size_t mss)
+    : TCPCongestionControl(mss)
+{
+}
+
+void CubicCongestionControl::on_ack(size_t acked_bytes, const Time& now, const Time& smoothed_round_trip_time)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(acked_bytes);
+        return;
+    }
+
+    u64 mss = m_mss;
+    u64 window = m_congestion_window;
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        if (window < m_last_max_window) {
+            // K = cbrt((W_max - cwnd) / C), in segments and seconds, which makes this milliseconds.
+            u64 missing_bytes = m_last_max_window - window;
+            m_time_to_last_max_window = integer_cube_root(missing_bytes * 2'500'000'000 / mss);
+        } else {
+            m_time_to_last_max_window = 0;
+            m_last_max_window = window;
+        }
+        m_tcp_friendly_window = window;
+    }
+
+    // W_cubic(t) = C * (t - K)^3 + W_max, looking one round trip ahead like RFC 8312 says.
+    i64 elapsed = (now - m_epoch_start.value() + smoothed_round_trip_time).to_milliseconds();
+    i64 distance = clamp(elapsed - m_time_to_last_max_window, (i64)-100'000, (i64)100'000);
+    i64 offset_in_millisegments = 4 * distance * distance * distance / 10'000'000;
+    i64 target = (i64)m_last_max_window + offset_in_millisegments * (i64)mss / 1000;
+    target = clamp(target, (i64)window, (i64)(window * 3 / 2));
+
+    if ((u64)target > window)
+        window += max((u64)(target - window) * acked_bytes / window, (u64)1);
+
+    // W_est grows by 3 * (1 - beta) / (1 + beta) segments per window's worth of ACKs, like a standard TCP with our beta.
+    constexpr u64 tcp_friendly_factor_in_thousandths = 3000 * (cubic_beta_denominator - cubic_beta_numerator) / (cubic_beta_denominator + cubic_beta_numerator);
+    m_tcp_friendly_window += mss * acked_bytes * tcp_friendly_factor_in_thousandths / (1000 * window);
+    window = max(window, (u64)m_tcp_friendly_window);
+
+    m_congestion_window = window;
+}
+
+void CubicCongestionControl::reduce_window()
+{
+    // Fast convergence: If we didn't even make it back to the last maximum, let go of some more for newer flows.
+    if (m_congestion_window < m_last_max_window)
+        m_last_max_window = (u64)m_congestion_window * (cubic_beta_denominator + cubic_beta_numerator) / (2 * cubic_beta_denominator);
+    else
+        m_last_max_window = m_congestion_window;
+    m_slow_start_threshold = max((size_t)((u64)m_congestion_window * cubic_beta_numerator / cubic_beta_denominator), 2 * m_mss);
+    m_epoch_start.clear();
+}
+
+void CubicCongestionControl::on_congestion_event(size_t, const Time&)
+{
+    reduce_window();
+    m_congestion_window = m_slow_start_threshold;
+}
+
+void CubicCongestionControl::on_retransmit_timeout(size_t, const Time&)
+{
+    reduce_window();
+    m_congestion_window = m_mss;
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Decides how much unacknowledged data a TCP connection may have in flight.
+//
+// The socket tells it about every ACK for new data and about every loss it detects,
+// and never sends more than congestion_window() bytes ahead of what's been acknowledged.
+// Recovering from the loss itself (which segments to send again) is up to the socket.
+class TCPCongestionControl {
+public:
+    enum class Algorithm {
+        NewReno,
+        Cubic,
+    };
+
+    static Algorithm default_algorithm();
+    static void set_default_algorithm(Algorithm);
+    static OwnPtr<TCPCongestionControl> create(Algorithm, size_t mss);
+
+    virtual ~TCPCongestionControl() = default;
+
+    virtual const char* name() const = 0;
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    // Called for every ACK that acknowledges new data while we're not recovering from a loss.
+    virtual void on_ack(size_t acked_bytes, const Time& now, const Time& smoothed_round_trip_time) = 0;
+    // Called when duplicate ACKs make us retransmit and go into fast recovery.
+    virtual void on_congestion_event(size_t bytes_in_flight, const Time& now) = 0;
+    // Called when the retransmission timer goes off.
+    virtual void on_retransmit_timeout(size_t bytes_in_flight, const Time& now) = 0;
+
+protected:
+    explicit TCPCongestionControl(size_t mss);
+
+    // RFC 5681 and RFC 3465: Grow by at most two segments per ACK in slow start.
+    void grow_in_slow_start(size_t acked_bytes);
+
+    size_t m_mss { 0 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+};
+
+// RFC 5681 and RFC 6582
+class NewRenoCongestionControl final : public TCPCongestionControl {
+public:
+    explicit NewRenoCongestionControl(size_t mss);
+
+    virtual const char* name() const override { return "NewReno"; }
+
+    virtual void on_ack(size_t acked_bytes, const Time& now, const Time& smoothed_round_trip_time) override;
+    virtual void on_congestion_event(size_t bytes_in_flight, const Time& now) override;
+    virtual void on_retransmit_timeout(size_t bytes_in_flight, const Time& now) override;
+
+private:
+    // Bytes acknowledged since the window last grew by a segment in congestion avoidance.
+    size_t m_bytes_acked { 0 };
+};
+
+// RFC 8312
+//
+// NOTE: There's no floating point in the kernel, so the cubic function is worked out
+//       in whole segments and milliseconds.
+class CubicCongestionControl final : public TCPCongestionControl {
+public:
+    explicit CubicCongestionControl(size_t mss);
+
+    virtual const char* name() const override { return "CUBIC"; }
+
+    virtual void on_ack(size_t acked_bytes, const Time& now, const Time& smoothed_round_trip_time) override;
+    virtual void on_congestion_event(size_t bytes_in_flight, const Time& now) override;
+    virtual void on_retransmit_timeout(size_t bytes_in_flight, const Time& now) override;
+
+private:
+    void reduce_window();
+
+    // The window (in bytes) right before the last reduction.
+    size_t m_last_max_window { 0 };
+    // When the current congestion avoidance epoch started, if it has.
+    Optional<Time> m_epoch_start;
+    // How long (in milliseconds) after the epoch start the window is back at m_last_max_window.
+    i64 m_time_to_last_max_window { 0 };
+    // What a standard TCP would have for a window (in bytes), so we're never slower than it.
+    size_t m_tcp_friendly_window { 0 };
+};
+
+}
@@ -16,6 +16,7 @@
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
+#include <Kernel/Net/TCPTimerWheel.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
 
@@ -23,9 +24,11 @@ namespace Kernel {
 
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
-    Locker locker(sockets_by_tuple().lock(), Lock::Mode::Shared);
-    for (auto& it : sockets_by_tuple().resource())
-        callback(*it.value);
+    sockets_by_tuple().for_each_shard([&](auto& shard) {
+        Locker locker(shard.lock(), Lock::Mode::Shared);
+        for (auto& it : shard.resource())
+            callback(*it.value);
+    });
 }
 
 void TCPSocket::set_state(State new_state)
@@ -41,8 +44,9 @@ void TCPSocket::set_state(State new_state)
         m_role = Role::Connected;
 
     if (new_state == State::Closed) {
-        Locker locker(closing_sockets().lock());
-        closing_sockets().resource().remove(tuple());
+        auto& closing_shard = closing_sockets().shard_for(tuple());
+        Locker locker(closing_shard.lock());
+        closing_shard.resource().remove(tuple());
 
         if (m_originator)
             release_to_originator();
@@ -52,47 +56,54 @@ void TCPSocket::set_state(State new_state)
         evaluate_block_conditions();
 }
 
-static AK::Singleton<Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>> s_socket_closing;
+static AK::Singleton<ShardedSocketTupleMap<RefPtr<TCPSocket>>> s_socket_closing;
 
-Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_sockets()
+ShardedSocketTupleMap<RefPtr<TCPSocket>>& TCPSocket::closing_sockets()
 {
     return *s_socket_closing;
 }
 
-static AK::Singleton<Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>> s_socket_tuples;
+static AK::Singleton<ShardedSocketTupleMap<TCPSocket*>> s_socket_tuples;
 
-Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& TCPSocket::sockets_by_tuple()
+ShardedSocketTupleMap<TCPSocket*>& TCPSocket::sockets_by_tuple()
 {
     return *s_socket_tuples;
 }
 
 RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
 {
-    Locker locker(sockets_by_tuple().lock(), Lock::Mode::Shared);
-
-    auto exact_match = sockets_by_tuple().resource().get(tuple);
-    if (exact_match.has_value())
-        return { *exact_match.value() };
+    auto find = [&](const IPv4SocketTuple& key) -> RefPtr<TCPSocket> {
+        auto& shard = sockets_by_tuple().shard_for(key);
+        Locker locker(shard.lock(), Lock::Mode::Shared);
+        auto match = shard.resource().get(key);
+        if (!match.has_value())
+            return {};
+        auto* socket = match.value();
+        // Listeners that share their port take turns by connection.
+        if (auto* group = socket->reuse_port_group())
+            socket = static_cast<TCPSocket*>(&group->socket_for_flow(Traits<IPv4SocketTuple>::hash(tuple)));
+        // NOTE: A socket that's being destroyed is still in the map until its destructor takes it out.
+        if (!socket->try_ref())
+            return {};
+        return adopt_ref(*socket);
+    };
 
-    auto address_tuple = IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0);
-    auto address_match = sockets_by_tuple().resource().get(address_tuple);
-    if (address_match.has_value())
-        return { *address_match.value() };
+    if (auto exact_match = find(tuple))
+        return exact_match;
 
-    auto wildcard_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
-    auto wildcard_match = sockets_by_tuple().resource().get(wildcard_tuple);
-    if (wildcard_match.has_value())
-        return { *wildcard_match.value() };
+    if (auto address_match = find(IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0)))
+        return address_match;
 
-    return {};
+    return find(IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0));
 }
 RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address, u16 new_local_port, const IPv4Address& new_peer_address, u16 new_peer_port)
 {
     auto tuple = IPv4SocketTuple(new_local_address, new_local_port, new_peer_address, new_peer_port);
 
+    auto& shard = sockets_by_tuple().shard_for(tuple);
     {
-        Locker locker(sockets_by_tuple().lock(), Lock::Mode::Shared);
-        if (sockets_by_tuple().resource().contains(tuple))
+        Locker locker(shard.lock(), Lock::Mode::Shared);
+        if (shard.resource().contains(tuple))
             return {};
     }
 
@@ -109,9 +120,10 @@ RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address,
     client->set_direction(Direction::Incoming);
     client->set_originator(*this);
 
-    Locker locker(sockets_by_tuple().lock());
+    // NOTE: The caller holds our lock, which is what keeps m_pending_release_for_accept consistent.
     m_pending_release_for_accept.set(tuple, client);
-    sockets_by_tuple().resource().set(tuple, client);
+    Locker locker(shard.lock());
+    shard.resource().set(tuple, client);
 
     return client;
 }
@@ -134,15 +146,26 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 TCPSocket::TCPSocket(int protocol)
     : IPv4Socket(SOCK_STREAM, protocol)
 {
-    m_last_retransmit_time = kgettimeofday();
+    m_retransmit_timer_start = kgettimeofday();
 }
 
 TCPSocket::~TCPSocket()
 {
-    Locker locker(sockets_by_tuple().lock());
-    sockets_by_tuple().resource().remove(tuple());
+    {
+        auto& shard = sockets_by_tuple().shard_for(tuple());
+        Locker locker(shard.lock());
+        auto* successor = leave_reuse_port_group();
+        // NOTE: We may never have made it into the map, for example if listen() found the port taken.
+        auto it = shard.resource().find(tuple());
+        if (it != shard.resource().end() && it->value == this) {
+            if (successor)
+                it->value = static_cast<TCPSocket*>(successor);
+            else
+                shard.resource().remove(it);
+        }
+    }
 
-    dequeue_for_retransmit();
+    TCPTimerWheel::the().cancel(*this);
 
     dbgln_if(TCP_SOCKET_DEBUG, "~TCPSocket in state {}", to_string(state()));
 }
@@ -172,8 +195,18 @@ KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = send_mss(*routing_decision.adapter);
+    // If the adapter does the segmenting for us, we can hand it a lot more in one go.
+    size_t max_data_length = max(mss, routing_decision.adapter->tcp_segmentation_max_payload_size());
+    {
+        // Don't go past the window, but always send at least one segment, like we did before there was one.
+        // NOTE: Only write() waits for can_write(), sendmsg() just goes ahead.
+        Locker locker(m_not_acked_lock, Lock::Mode::Shared);
+        size_t window = send_window();
+        size_t room = window > m_not_acked_size ? window - m_not_acked_size : 0;
+        max_data_length = max(mss, min(max_data_length, room));
+    }
+    data_length = min(data_length, max_data_length);
     int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision);
     if (err < 0)
         return KResult((ErrnoCode)-err);
@@ -195,8 +228,32 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // RFC 7323 and RFC 2018: Offer window scaling and SACK in our SYN, and agree to them in our SYN-ACK if the peer did.
+    u8 options[sizeof(TCPOptionMSS) + 1 + sizeof(TCPOptionWindowScale) + 2 + sizeof(TCPOptionSACKPermitted)];
+    size_t options_size = 0;
+    auto append_option = [&](const void* option, size_t size) {
+        VERIFY(options_size + size <= sizeof(options));
+        memcpy(options + options_size, option, size);
+        options_size += size;
+    };
+    if (flags & TCPFlags::SYN) {
+        TCPOptionMSS mss_option { (u16)(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket)) };
+        append_option(&mss_option, sizeof(mss_option));
+        bool is_syn_ack = flags & TCPFlags::ACK;
+        u8 nop = (u8)TCPOptionKind::NOP;
+        if (!is_syn_ack || m_window_scaling_enabled) {
+            TCPOptionWindowScale window_scale_option { receive_window_scale };
+            append_option(&nop, 1);
+            append_option(&window_scale_option, sizeof(window_scale_option));
+        }
+        if (!is_syn_ack || m_selective_acks_enabled) {
+            TCPOptionSACKPermitted sack_permitted_option;
+            append_option(&nop, 1);
+            append_option(&nop, 1);
+            append_option(&sack_permitted_option, sizeof(sack_permitted_option));
+        }
+    }
+    VERIFY(options_size % sizeof(u32) == 0);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -210,7 +267,7 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(receive_window_to_advertise(flags & TCPFlags::SYN));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -218,6 +275,7 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     if (flags & TCPFlags::ACK) {
         m_last_ack_number_sent = m_ack_number;
         m_last_ack_sent_time = kgettimeofday();
+        m_delayed_ack_pending = false;
         tcp_packet.set_ack_number(m_ack_number);
     }
 
@@ -227,57 +285,202 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     }
 
     if (flags & TCPFlags::SYN) {
+        m_last_received_ack_number = m_sequence_number;
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+    memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), options, options_size);
+
+    auto& adapter = *routing_decision.adapter;
+    Optional<TCPOffload> offload;
+    size_t mss = send_mss(adapter);
+    if (payload_size > mss) {
+        offload = TCPOffload { ipv4_payload_offset, tcp_header_size, mss };
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), 0));
+    } else if (adapter.has_tcp_checksum_offload()) {
+        offload = TCPOffload { ipv4_payload_offset, tcp_header_size, 0 };
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), tcp_header_size + payload_size));
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
-
-    routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
+    if (offload.has_value())
+        adapter.send_packet_with_tcp_offload(*packet, offload.value());
+    else
+        adapter.send_packet({ packet->buffer.data(), packet->buffer.size() });
 
     m_packets_out++;
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         Locker locker(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+        auto now = kgettimeofday();
+        bool was_empty = m_not_acked.is_empty();
+        if (was_empty)
+            m_retransmit_timer_start = now;
+        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, adapter, 0, offload, now });
         m_not_acked_size += payload_size;
-        enqueue_for_retransmit();
+        // NOTE: If something was in flight already, the timer is armed already.
+        if (was_empty)
+            TCPTimerWheel::the().schedule(*this, m_retransmit_timeout);
     } else {
-        routing_decision.adapter->release_packet_buffer(*packet);
+        adapter.release_packet_buffer(*packet);
     }
 
     return KSuccess;
 }
 
+// Sequence numbers wrap around, so they have to be compared relative to each other.
+static bool sequence_number_is_before(u32 a, u32 b)
+{
+    return (i32)(a - b) < 0;
+}
+
+static bool sequence_number_is_at_or_before(u32 a, u32 b)
+{
+    return (i32)(a - b) <= 0;
+}
+
+void TCPSocket::process_syn_options(const TCPPacket& packet)
+{
+    VERIFY(packet.has_syn());
+    m_window_scaling_enabled = false;
+    m_selective_acks_enabled = false;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                m_peer_mss = max((data[0] << 8) | data[1], 64);
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == 1) {
+                m_window_scaling_enabled = true;
+                // RFC 7323: Anything bigger than 14 is treated as 14.
+                m_send_window_scale = min(data[0], (u8)14);
+            }
+            break;
+        case TCPOptionKind::SACKPermitted:
+            m_selective_acks_enabled = true;
+            break;
+        default:
+            break;
+        }
+    });
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) peer MSS is {}, window scaling {}, SACK {}", this, m_peer_mss, m_window_scaling_enabled ? m_send_window_scale : -1, m_selective_acks_enabled);
+
+    m_congestion_control = TCPCongestionControl::create(TCPCongestionControl::default_algorithm(), m_peer_mss);
+}
+
+size_t TCPSocket::send_mss(const NetworkAdapter& adapter) const
+{
+    return min(adapter.mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), (size_t)m_peer_mss);
+}
+
+size_t TCPSocket::send_window() const
+{
+    size_t window = m_send_window_size;
+    if (m_congestion_control)
+        window = min(window, m_congestion_control->congestion_window());
+    // NOTE: Even with the peer's window closed, we let one segment through, so we find out when it opens again.
+    return max(window, (size_t)m_peer_mss);
+}
+
+u16 TCPSocket::receive_window_to_advertise(bool is_syn) const
+{
+    // NOTE: The receive buffer also takes the headers of every packet, so leave some room for those.
+    size_t space = receive_buffer_space();
+    space -= space / 32;
+    // RFC 7323: The window in a SYN is never scaled.
+    if (!is_syn && m_window_scaling_enabled)
+        space >>= receive_window_scale;
+    return min(space, (size_t)NumericLimits<u16>::max());
+}
+
+void TCPSocket::update_round_trip_time(const Time& round_trip_time)
+{
+    // RFC 6298, section 2
+    i64 sample = round_trip_time.to_microseconds();
+    i64 smoothed;
+    i64 variation;
+    if (!m_smoothed_round_trip_time.has_value()) {
+        smoothed = sample;
+        variation = sample / 2;
+    } else {
+        smoothed = m_smoothed_round_trip_time->to_microseconds();
+        variation = m_round_trip_time_variation.to_microseconds();
+        i64 difference = smoothed > sample ? smoothed - sample : sample - smoothed;
+        variation = (3 * variation + difference) / 4;
+        smoothed = (7 * smoothed + sample) / 8;
+    }
+    m_smoothed_round_trip_time = Time::from_microseconds(smoothed);
+    m_round_trip_time_variation = Time::from_microseconds(variation);
+
+    i64 timeout_in_milliseconds = (smoothed + max(4 * variation, (i64)1000)) / 1000;
+    timeout_in_milliseconds = clamp(timeout_in_milliseconds, minimum_retransmit_timeout_in_milliseconds, maximum_retransmit_timeout_in_milliseconds);
+    m_retransmit_timeout = Time::from_milliseconds(timeout_in_milliseconds);
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) RTT sample {}us, SRTT {}us, RTTVAR {}us, RTO {}ms", this, sample, smoothed, variation, timeout_in_milliseconds);
+}
+
+void TCPSocket::mark_selectively_acked_packets(const TCPPacket& packet)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            TCPSACKBlock block;
+            memcpy(&block, data.offset(offset), sizeof(block));
+            for (auto& outgoing_packet : m_not_acked) {
+                auto& tcp_packet = *(const TCPPacket*)(outgoing_packet.buffer->buffer.data() + outgoing_packet.ipv4_payload_offset);
+                if (sequence_number_is_at_or_before(block.left_edge, tcp_packet.sequence_number()) && sequence_number_is_at_or_before(outgoing_packet.ack_number, block.right_edge))
+                    outgoing_packet.is_selectively_acked = true;
+            }
+        }
+    });
+}
+
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
+    if (packet.has_syn() && state() != State::Listen)
+        process_syn_options(packet);
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        auto now = kgettimeofday();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
+        if (sequence_number_is_at_or_before(m_last_received_ack_number, ack_number)) {
+            u32 window = packet.window_size();
+            if (!packet.has_syn() && m_window_scaling_enabled)
+                window <<= m_send_window_scale;
+            m_send_window_size = window;
+        }
+
         int removed = 0;
+        size_t acked_bytes = 0;
+        Optional<Time> round_trip_time;
         Locker locker(m_not_acked_lock);
+        if (m_selective_acks_enabled && !packet.has_syn())
+            mark_selectively_acked_packets(packet);
+
         while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
+            auto& outgoing_packet = m_not_acked.first();
 
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", outgoing_packet.ack_number);
 
-            if (packet.ack_number <= ack_number) {
-                auto old_adapter = packet.adapter.strong_ref();
+            if (sequence_number_is_at_or_before(outgoing_packet.ack_number, ack_number)) {
+                auto old_adapter = outgoing_packet.adapter.strong_ref();
                 if (old_adapter)
-                    old_adapter->release_packet_buffer(*packet.buffer);
-                TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-                auto payload_size = packet.buffer->buffer.data() + packet.buffer->buffer.size() - (u8*)tcp_packet.payload();
+                    old_adapter->release_packet_buffer(*outgoing_packet.buffer);
+                TCPPacket& tcp_packet = *(TCPPacket*)(outgoing_packet.buffer->buffer.data() + outgoing_packet.ipv4_payload_offset);
+                auto payload_size = outgoing_packet.buffer->buffer.data() + outgoing_packet.buffer->buffer.size() - (u8*)tcp_packet.payload();
                 m_not_acked_size -= payload_size;
+                acked_bytes += payload_size;
+                // Karn's algorithm: Only packets that went out once tell us anything about the round trip time.
+                if (outgoing_packet.tx_counter == 0)
+                    round_trip_time = now - outgoing_packet.sent_time;
                 evaluate_block_conditions();
                 m_not_acked.take_first();
                 removed++;
@@ -286,9 +489,41 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
             }
         }
 
+        if (removed > 0) {
+            if (round_trip_time.has_value())
+                update_round_trip_time(round_trip_time.value());
+            m_retransmit_attempts = 0;
+            m_retransmit_timer_start = now;
+            m_received_duplicate_acks = 0;
+            if (m_recovery_point.has_value()) {
+                if (sequence_number_is_at_or_before(m_recovery_point.value(), ack_number)) {
+                    m_recovery_point.clear();
+                } else {
+                    // RFC 6582: A partial ACK means the next segment got lost as well.
+                    retransmit_first_unacked_packet();
+                }
+            } else if (m_congestion_control) {
+                m_congestion_control->on_ack(acked_bytes, now, m_smoothed_round_trip_time.value_or(m_retransmit_timeout));
+            }
+        } else if (ack_number == m_last_received_ack_number && !m_not_acked.is_empty() && size == packet.header_size() && !packet.has_syn() && !packet.has_fin()) {
+            // RFC 5681: Three duplicate ACKs in a row mean that a segment was lost, so send it again right away.
+            if (++m_received_duplicate_acks == 3 && !m_recovery_point.has_value()) {
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) got three duplicate ACKs for {}, retransmitting", this, ack_number);
+                if (m_congestion_control)
+                    m_congestion_control->on_congestion_event(m_not_acked_size, now);
+                m_recovery_point = m_sequence_number;
+                retransmit_first_unacked_packet();
+            }
+        }
+
+        if (sequence_number_is_before(m_last_received_ack_number, ack_number))
+            m_last_received_ack_number = ack_number;
+
         if (m_not_acked.is_empty()) {
             m_retransmit_attempts = 0;
-            dequeue_for_retransmit();
+            m_recovery_point.clear();
+            if (!m_delayed_ack_pending)
+                TCPTimerWheel::the().cancel(*this);
         }
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
@@ -314,6 +549,18 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
+void TCPSocket::send_delayed_ack()
+{
+    VERIFY(lock().is_locked());
+    if (!should_delay_next_ack()) {
+        [[maybe_unused]] auto result = send_ack();
+        return;
+    }
+
+    m_delayed_ack_pending = true;
+    TCPTimerWheel::the().schedule(*this, m_last_ack_sent_time + Time::from_milliseconds(500) - kgettimeofday());
+}
+
 NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
 {
     struct [[gnu::packed]] PseudoHeader {
@@ -355,6 +602,29 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
     return ~(checksum & 0xffff);
 }
 
+NetworkOrdered<u16> TCPSocket::compute_tcp_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length)
+{
+    struct [[gnu::packed]] PseudoHeader {
+        IPv4Address source;
+        IPv4Address destination;
+        u8 zero;
+        u8 protocol;
+        NetworkOrdered<u16> payload_size;
+    };
+
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length };
+
+    // NOTE: Unlike compute_tcp_checksum(), this isn't inverted, since the adapter keeps adding to it.
+    u32 checksum = 0;
+    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
+    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
+        checksum += w[i];
+        if (checksum > 0xffff)
+            checksum = (checksum >> 16) + (checksum & 0xffff);
+    }
+    return checksum & 0xffff;
+}
+
 KResult TCPSocket::protocol_bind()
 {
     if (has_specific_local_address() && !m_adapter) {
@@ -369,10 +639,14 @@ KResult TCPSocket::protocol_bind()
 KResult TCPSocket::protocol_listen(bool did_allocate_port)
 {
     if (!did_allocate_port) {
-        Locker socket_locker(sockets_by_tuple().lock());
-        if (sockets_by_tuple().resource().contains(tuple()))
-            return EADDRINUSE;
-        sockets_by_tuple().resource().set(tuple(), this);
+        auto& shard = sockets_by_tuple().shard_for(tuple());
+        Locker socket_locker(shard.lock());
+        if (auto bound_socket = shard.resource().get(tuple()); bound_socket.has_value()) {
+            if (auto result = share_port_with(*bound_socket.value()); result.is_error())
+                return result;
+        } else {
+            shard.resource().set(tuple(), this);
+        }
     }
 
     set_direction(Direction::Passive);
@@ -434,14 +708,15 @@ KResultOr<u16> TCPSocket::protocol_allocate_local_port()
     constexpr u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
     u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
 
-    Locker locker(sockets_by_tuple().lock());
     for (u16 port = first_scan_port;;) {
         IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
 
-        auto it = sockets_by_tuple().resource().find(proposed_tuple);
-        if (it == sockets_by_tuple().resource().end()) {
+        // NOTE: Every port we try is likely in a different shard, so we only ever hold one shard's lock.
+        auto& shard = sockets_by_tuple().shard_for(proposed_tuple);
+        Locker locker(shard.lock());
+        if (!shard.resource().contains(proposed_tuple)) {
             set_local_port(port);
-            sockets_by_tuple().resource().set(proposed_tuple, this);
+            shard.resource().set(proposed_tuple, this);
             return port;
         }
         ++port;
@@ -491,47 +766,68 @@ KResult TCPSocket::close()
     }
 
     if (state() != State::Closed && state() != State::Listen) {
-        Locker locker(closing_sockets().lock());
-        closing_sockets().resource().set(tuple(), *this);
+        auto& closing_shard = closing_sockets().shard_for(tuple());
+        Locker locker(closing_shard.lock());
+        closing_shard.resource().set(tuple(), *this);
     }
     return result;
 }
 
-static AK::Singleton<Lockable<HashTable<TCPSocket*>>> s_sockets_for_retransmit;
-
-Lockable<HashTable<TCPSocket*>>& TCPSocket::sockets_for_retransmit()
+void TCPSocket::handle_timer_expiry()
 {
-    return *s_sockets_for_retransmit;
+    Locker locker(lock());
+    if (m_delayed_ack_pending && !should_delay_next_ack())
+        [[maybe_unused]] auto result = send_ack();
+    bool has_unacked_packets;
+    {
+        Locker not_acked_locker(m_not_acked_lock, Lock::Mode::Shared);
+        has_unacked_packets = !m_not_acked.is_empty();
+    }
+    if (has_unacked_packets)
+        retransmit_packets();
+    update_timer();
 }
 
-void TCPSocket::enqueue_for_retransmit()
+void TCPSocket::update_timer()
 {
-    Locker locker(sockets_for_retransmit().lock());
-    sockets_for_retransmit().resource().set(this);
+    VERIFY(lock().is_locked());
+    Optional<Time> deadline;
+    if (m_delayed_ack_pending)
+        deadline = m_last_ack_sent_time + Time::from_milliseconds(500);
+    {
+        Locker locker(m_not_acked_lock, Lock::Mode::Shared);
+        if (!m_not_acked.is_empty() && state() != State::Closed) {
+            auto retransmit_at = retransmit_deadline();
+            if (!deadline.has_value() || retransmit_at < deadline.value())
+                deadline = retransmit_at;
+        }
+    }
+
+    if (!deadline.has_value()) {
+        TCPTimerWheel::the().cancel(*this);
+        return;
+    }
+    TCPTimerWheel::the().schedule(*this, deadline.value() - kgettimeofday());
 }
 
-void TCPSocket::dequeue_for_retransmit()
+Time TCPSocket::retransmit_deadline() const
 {
-    Locker locker(sockets_for_retransmit().lock());
-    sockets_for_retransmit().resource().remove(this);
+    // RFC 6298 says we must do exponential backoff - even for SYN packets.
+    auto retransmit_timeout = m_retransmit_timeout;
+    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
+        retransmit_timeout = min(retransmit_timeout + retransmit_timeout, Time::from_milliseconds(maximum_retransmit_timeout_in_milliseconds));
+    return m_retransmit_timer_start + retransmit_timeout;
 }
 
 void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
-
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
-
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (now < retransmit_deadline())
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
-    m_last_retransmit_time = now;
+    m_retransmit_timer_start = now;
     ++m_retransmit_attempts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
@@ -541,42 +837,75 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
+    Locker locker(m_not_acked_lock);
+    if (m_not_acked.is_empty())
+        return;
+
+    if (m_congestion_control)
+        m_congestion_control->on_retransmit_timeout(m_not_acked_size, now);
+    m_recovery_point = m_sequence_number;
+    m_received_duplicate_acks = 0;
+    // RFC 2018: After a timeout, the peer may have thrown away what it told us about with SACK blocks.
+    for (auto& packet : m_not_acked)
+        packet.is_selectively_acked = false;
+
+    // Everything after the first packet goes out again as the partial ACKs for it come in.
+    retransmit_first_unacked_packet();
+}
+
+void TCPSocket::retransmit_first_unacked_packet()
+{
+    VERIFY(m_not_acked_lock.is_locked());
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return;
 
-    Locker locker(m_not_acked_lock, Lock::Mode::Shared);
     for (auto& packet : m_not_acked) {
-        packet.tx_counter++;
-
-        if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-            dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                local_address(), local_port(),
-                peer_address(), peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
-        }
+        if (packet.is_selectively_acked)
+            continue;
+        retransmit_packet(packet, routing_decision);
+        return;
+    }
+}
 
-        size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-        if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-            // FIXME: Add support for this. This can happen if after a route change
-            // we ended up on another adapter which doesn't have the same layer 2 type
-            // like the previous adapter.
-            VERIFY_NOT_REACHED();
-        }
-        routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-            local_address(), routing_decision.next_hop, peer_address(),
-            IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
-        routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
-        m_packets_out++;
-        m_bytes_out += packet.buffer->buffer.size();
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    auto& adapter = *routing_decision.adapter;
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
     }
+
+    size_t ipv4_payload_offset = adapter.ipv4_payload_offset();
+    bool can_offload = !packet.offload.has_value()
+        || (packet.offload->segment_size ? adapter.tcp_segmentation_max_payload_size() > 0 : adapter.has_tcp_checksum_offload());
+    if (ipv4_payload_offset != packet.ipv4_payload_offset || !can_offload) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // (or the same offloading capabilities) like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+    adapter.fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
+    if (packet.offload.has_value())
+        adapter.send_packet_with_tcp_offload(*packet.buffer, packet.offload.value());
+    else
+        adapter.send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
+    packet.sent_time = kgettimeofday();
+    m_packets_out++;
+    m_bytes_out += packet.buffer->buffer.size();
 }
 
 bool TCPSocket::can_write(const FileDescription& file_description, size_t size) const
@@ -588,7 +917,7 @@ bool TCPSocket::can_write(const FileDescription& file_description, size_t size)
         return true;
 
     Locker lock(m_not_acked_lock);
-    return m_not_acked_size + size <= m_send_window_size;
+    return m_not_acked_size < send_window();
 }
 
 }
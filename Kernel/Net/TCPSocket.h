@@ -8,13 +8,43 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
+// A map keyed by socket tuples that's split into shards with a lock each, so that looking up
+// (and adding and removing) the sockets of different connections rarely has to wait on the same lock.
+template<typename ValueType>
+class ShardedSocketTupleMap {
+public:
+    using Shard = Lockable<HashMap<IPv4SocketTuple, ValueType>>;
+
+    Shard& shard_for(const IPv4SocketTuple& tuple)
+    {
+        // NOTE: The hash is mixed once more, otherwise every key in a shard would end up
+        //       in the same few buckets of the shard's hash map.
+        return m_shards[int_hash(Traits<IPv4SocketTuple>::hash(tuple)) % shard_count];
+    }
+
+    template<typename Callback>
+    void for_each_shard(Callback callback)
+    {
+        for (auto& shard : m_shards)
+            callback(shard);
+    }
+
+private:
+    static constexpr size_t shard_count = 64;
+    Shard m_shards[shard_count];
+};
+
 class TCPSocket final : public IPv4Socket {
 public:
     static void for_each(Function<void(const TCPSocket&)>);
@@ -138,13 +168,17 @@ public:
     KResult send_ack(bool allow_duplicate = false);
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    // Takes the MSS, window scaling and SACK options out of the peer's SYN.
+    void process_syn_options(const TCPPacket&);
 
     bool should_delay_next_ack() const;
+    // Sends an ACK for what we've received, unless it can wait for more to come in.
+    void send_delayed_ack();
 
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
+    static ShardedSocketTupleMap<TCPSocket*>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
 
-    static Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& closing_sockets();
+    static ShardedSocketTupleMap<RefPtr<TCPSocket>>& closing_sockets();
 
     RefPtr<TCPSocket> create_client(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port);
     void set_originator(TCPSocket& originator) { m_originator = originator; }
@@ -152,8 +186,8 @@ public:
     void release_to_originator();
     void release_for_accept(RefPtr<TCPSocket>);
 
-    static Lockable<HashTable<TCPSocket*>>& sockets_for_retransmit();
-    void retransmit_packets();
+    // Called by the NetworkTask when the timer armed in the TCPTimerWheel goes off.
+    void handle_timer_expiry();
 
     virtual KResult close() override;
 
@@ -167,6 +201,8 @@ private:
     virtual const char* class_name() const override { return "TCPSocket"; }
 
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
+    // This is what goes into the checksum field for an adapter that finishes the checksum by itself.
+    static NetworkOrdered<u16> compute_tcp_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length);
 
     virtual void shut_down_for_writing() override;
 
@@ -178,8 +214,22 @@ private:
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen(bool did_allocate_port) override;
 
-    void enqueue_for_retransmit();
-    void dequeue_for_retransmit();
+    friend class TCPTimerWheel;
+
+    void retransmit_packets();
+    // When the retransmission timer goes off, including the backoff for the retransmissions so far.
+    Time retransmit_deadline() const;
+    // Arms the timer for the earliest of the pending delayed ACK and the next retransmission.
+    void update_timer();
+
+    // The most we put into one segment, which depends on the adapter as well as on the peer.
+    size_t send_mss(const NetworkAdapter&) const;
+    // How much we may have in flight, according to both the peer and the congestion controller.
+    size_t send_window() const;
+    u16 receive_window_to_advertise(bool is_syn) const;
+    void update_round_trip_time(const Time&);
+    void mark_selectively_acked_packets(const TCPPacket&);
+    void retransmit_first_unacked_packet();
 
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
@@ -200,8 +250,15 @@ private:
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        // Set if the adapter fills in the checksum (and possibly segments the packet) for us.
+        Optional<TCPOffload> offload;
+        Time sent_time;
+        // The peer told us it has this packet with a SACK block, but it hasn't been acknowledged yet.
+        bool is_selectively_acked { false };
     };
 
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+
     mutable Lock m_not_acked_lock { "TCPSocket unacked packets" };
     SinglyLinkedList<OutgoingPacket> m_not_acked;
     size_t m_not_acked_size { 0 };
@@ -213,11 +270,40 @@ private:
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
+    // RFC 6298: The retransmission timeout follows the smoothed round trip time and its variation.
+    static constexpr i64 minimum_retransmit_timeout_in_milliseconds = 1000;
+    static constexpr i64 maximum_retransmit_timeout_in_milliseconds = 60000;
+    Optional<Time> m_smoothed_round_trip_time;
+    Time m_round_trip_time_variation;
+    Time m_retransmit_timeout { Time::from_milliseconds(minimum_retransmit_timeout_in_milliseconds) };
+    // When the retransmission timer was (re)started, which happens when data goes out with nothing else in flight,
+    // when new data is acknowledged, and on every retransmission.
+    Time m_retransmit_timer_start;
+
+    OwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_last_received_ack_number { 0 };
+    u32 m_received_duplicate_acks { 0 };
+    // While we're recovering from a loss, this is the sequence number we had sent up to when we noticed it.
+    Optional<u32> m_recovery_point;
+
+    // The peer's window, already scaled.
     u32 m_send_window_size { 64 * KiB };
+    u16 m_peer_mss { 536 };
+    // RFC 7323: Our 256 KiB receive buffer needs the window to be shifted by 3 to fit into 16 bits.
+    static constexpr u8 receive_window_scale = 3;
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    bool m_selective_acks_enabled { false };
+
+    // We've received something that we haven't sent an ACK for yet, because it's being delayed.
+    bool m_delayed_ack_pending { false };
+
+    IntrusiveListNode<TCPSocket> m_timer_wheel_node;
+    u64 m_timer_wheel_tick { 0 };
+
+    using TimerWheelList = IntrusiveList<TCPSocket, RawPtr<TCPSocket>, &TCPSocket::m_timer_wheel_node>;
 };
 
 }
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/Net/Routing.h>
+#include <Kernel/Net/TCPTimerWheel.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+static AK::Singleton<TCPTimerWheel> s_the;
+
+TCPTimerWheel& TCPTimerWheel::the()
+{
+    return *s_the;
+}
+
+u64 TCPTimerWheel::current_tick()
+{
+    // NOTE: This follows the monotonic clock, so setting the time doesn't make all the timers go off (or get stuck).
+    return TimeManagement::the().monotonic_time().to_milliseconds() / tick_in_milliseconds;
+}
+
+void TCPTimerWheel::schedule(TCPSocket& socket, const Time& delay)
+{
+    bool should_wake = false;
+    {
+        ScopedSpinLock lock(m_lock);
+        // Round up, so the timer never goes off before its deadline.
+        u64 ticks = (max<i64>(delay.to_milliseconds(), 0) + tick_in_milliseconds - 1) / tick_in_milliseconds;
+        u64 tick = max(current_tick() + ticks, m_next_tick_to_expire);
+        if (socket.m_timer_wheel_node.is_in_list()) {
+            if (socket.m_timer_wheel_tick <= tick)
+                return;
+            socket.m_timer_wheel_node.remove();
+        }
+        socket.m_timer_wheel_tick = tick;
+        m_slots[tick % slot_count].append(socket);
+        if (tick < m_next_wakeup_tick) {
+            m_next_wakeup_tick = tick;
+            should_wake = true;
+        }
+    }
+    if (should_wake && on_earlier_deadline)
+        on_earlier_deadline();
+}
+
+void TCPTimerWheel::cancel(TCPSocket& socket)
+{
+    ScopedSpinLock lock(m_lock);
+    if (socket.m_timer_wheel_node.is_in_list())
+        socket.m_timer_wheel_node.remove();
+}
+
+void TCPTimerWheel::take_expired(NonnullRefPtrVector<TCPSocket>& sockets)
+{
+    ScopedSpinLock lock(m_lock);
+    u64 now = current_tick();
+    if (now < m_next_tick_to_expire)
+        return;
+
+    // If we're more than a whole revolution behind, going around once still finds everything.
+    u64 ticks_to_expire = min<u64>(now - m_next_tick_to_expire + 1, slot_count);
+    for (u64 i = 0; i < ticks_to_expire; ++i) {
+        auto& slot = m_slots[(m_next_tick_to_expire + i) % slot_count];
+        for (auto it = slot.begin(); it != slot.end();) {
+            auto& socket = *it;
+            ++it;
+            // This one is due on a later revolution of the wheel.
+            if (socket.m_timer_wheel_tick > now)
+                continue;
+            socket.m_timer_wheel_node.remove();
+            // NOTE: A socket that's being destroyed will cancel its timer as soon as we let go of the lock.
+            if (socket.try_ref())
+                sockets.append(adopt_ref(socket));
+        }
+    }
+    m_next_tick_to_expire = now + 1;
+}
+
+Optional<Time> TCPTimerWheel::time_until_next_deadline()
+{
+    ScopedSpinLock lock(m_lock);
+    u64 now = current_tick();
+    m_next_wakeup_tick = NumericLimits<u64>::max();
+    u64 first_tick = max(now, m_next_tick_to_expire);
+    // NOTE: The first slot that isn't empty may only have timers for a later revolution,
+    //       in which case we wake up early and look again.
+    for (u64 tick = first_tick; tick < first_tick + slot_count; ++tick) {
+        if (m_slots[tick % slot_count].is_empty())
+            continue;
+        m_next_wakeup_tick = tick;
+        return Time::from_milliseconds((i64)(tick - now) * tick_in_milliseconds);
+    }
+    return {};
+}
+
+}
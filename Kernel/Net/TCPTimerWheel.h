@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Time.h>
+#include <Kernel/Net/TCPSocket.h>
+#include <Kernel/SpinLock.h>
+
+namespace Kernel {
+
+// The retransmission and delayed ACK timers of all TCP sockets.
+//
+// Every socket with a timer sits in one of the slots of a hashed timing wheel, so arming,
+// re-arming and cancelling a timer is O(1), and expiring them only touches the slots that
+// time has moved past, instead of every socket in the system.
+// A socket has at most one timer, which goes off at the earliest of its deadlines.
+class TCPTimerWheel {
+public:
+    static TCPTimerWheel& the();
+
+    // Arms the socket's timer to go off after the given delay, unless it's already armed to go off earlier.
+    void schedule(TCPSocket&, const Time& delay);
+    void cancel(TCPSocket&);
+
+    // Takes the sockets whose timers have gone off out of the wheel.
+    void take_expired(NonnullRefPtrVector<TCPSocket>&);
+    // How long until the next timer goes off, if there's one. The wheel remembers this, and calls
+    // on_earlier_deadline if a timer gets armed to go off before that.
+    Optional<Time> time_until_next_deadline();
+
+    Function<void()> on_earlier_deadline;
+
+private:
+    static constexpr size_t slot_count = 256;
+    static constexpr i64 tick_in_milliseconds = 10;
+
+    static u64 current_tick();
+
+    SpinLock<u8> m_lock;
+    TCPSocket::TimerWheelList m_slots[slot_count];
+    // The first tick that take_expired() hasn't gone through yet.
+    u64 m_next_tick_to_expire { 0 };
+    u64 m_next_wakeup_tick { NumericLimits<u64>::max() };
+};
+
+}
@@ -29,7 +29,7 @@ Lockable<HashMap<u16, UDPSocket*>>& UDPSocket::sockets_by_port()
     return *s_map;
 }
 
-SocketHandle<UDPSocket> UDPSocket::from_port(u16 port)
+SocketHandle<UDPSocket> UDPSocket::from_port(u16 port, unsigned flow_hash)
 {
     RefPtr<UDPSocket> socket;
     {
@@ -39,6 +39,8 @@ SocketHandle<UDPSocket> UDPSocket::from_port(u16 port)
             return {};
         socket = (*it).value;
         VERIFY(socket);
+        if (auto* group = socket->reuse_port_group())
+            socket = static_cast<UDPSocket*>(&group->socket_for_flow(flow_hash));
     }
     return { *socket };
 }
@@ -51,7 +53,15 @@ UDPSocket::UDPSocket(int protocol)
 UDPSocket::~UDPSocket()
 {
     Locker locker(sockets_by_port().lock());
-    sockets_by_port().resource().remove(local_port());
+    auto* successor = leave_reuse_port_group();
+    // NOTE: We may never have made it into the map, for example if bind() found the port taken.
+    auto it = sockets_by_port().resource().find(local_port());
+    if (it != sockets_by_port().resource().end() && it->value == this) {
+        if (successor)
+            it->value = static_cast<UDPSocket*>(successor);
+        else
+            sockets_by_port().resource().remove(it);
+    }
 }
 
 KResultOr<NonnullRefPtr<UDPSocket>> UDPSocket::create(int protocol)
@@ -132,8 +142,8 @@ KResultOr<u16> UDPSocket::protocol_allocate_local_port()
 KResult UDPSocket::protocol_bind()
 {
     Locker locker(sockets_by_port().lock());
-    if (sockets_by_port().resource().contains(local_port()))
-        return EADDRINUSE;
+    if (auto bound_socket = sockets_by_port().resource().get(local_port()); bound_socket.has_value())
+        return share_port_with(*bound_socket.value());
     sockets_by_port().resource().set(local_port(), this);
     return KSuccess;
 }
@@ -16,7 +16,8 @@ public:
     static KResultOr<NonnullRefPtr<UDPSocket>> create(int protocol);
     virtual ~UDPSocket() override;
 
-    static SocketHandle<UDPSocket> from_port(u16);
+    // If there are several sockets on the port (with SO_REUSEPORT), the hash of the flow picks one of them.
+    static SocketHandle<UDPSocket> from_port(u16, unsigned flow_hash = 0);
     static void for_each(Function<void(const UDPSocket&)>);
 
 private:
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Kernel/PCI/Access.h>
+#include <Kernel/SpinLock.h>
 
 namespace Kernel {
 namespace PCI {
@@ -31,6 +32,9 @@ private:
 
     virtual uint8_t segment_start_bus(u32) const override { return 0x0; }
     virtual uint8_t segment_end_bus(u32) const override { return 0xFF; }
+
+    // NOTE: Selecting the field and then accessing it takes two port accesses, and nobody else may select another field in between.
+    SpinLock<u8> m_access_lock;
 };
 
 }
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/PCI/Access.h>
+#include <Kernel/PCI/MSI.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+namespace PCI {
+
+#define MSI_CONTROL 0x2
+#define MSI_ADDRESS_LOW 0x4
+#define MSI_ADDRESS_HIGH 0x8
+#define MSI_DATA_32 0x8
+#define MSI_DATA_64 0xc
+#define MSI_CONTROL_ENABLE (1 << 0)
+#define MSI_CONTROL_MULTIPLE_MESSAGE_ENABLE (0b111 << 4)
+#define MSI_CONTROL_64BIT (1 << 7)
+
+#define MSIX_CONTROL 0x2
+#define MSIX_TABLE 0x4
+#define MSIX_CONTROL_TABLE_SIZE 0x7ff
+#define MSIX_CONTROL_FUNCTION_MASK (1 << 14)
+#define MSIX_CONTROL_ENABLE (1 << 15)
+#define MSIX_TABLE_BIR 0x7
+#define MSIX_TABLE_ENTRY_SIZE 16
+#define MSIX_ENTRY_ADDRESS_LOW 0
+#define MSIX_ENTRY_ADDRESS_HIGH 1
+#define MSIX_ENTRY_DATA 2
+#define MSIX_ENTRY_VECTOR_CONTROL 3
+#define MSIX_VECTOR_MASKED (1 << 0)
+
+// See Intel SDM Volume 3, 10.11 "Message Signalled Interrupts": Fixed delivery, edge triggered, physical destination.
+#define MSI_ADDRESS_BASE 0xfee00000
+#define MSI_ADDRESS_DESTINATION_SHIFT 12
+
+static Atomic<u32> s_next_processor;
+
+static Optional<Capability> find_capability(Address address, u8 id)
+{
+    for (auto& capability : get_capabilities(address)) {
+        if (capability.id() == id)
+            return capability;
+    }
+    return {};
+}
+
+UNMAP_AFTER_INIT OwnPtr<MessageSignaledInterrupts> MessageSignaledInterrupts::try_create(Address address, size_t wanted_count, const char* purpose, AllowMSIX allow_msix)
+{
+    VERIFY(wanted_count > 0);
+    // Without a local APIC nothing would receive the messages.
+    if (!APIC::initialized())
+        return {};
+
+    Optional<Capability> capability;
+    OwnPtr<Region> msix_table_region;
+    size_t msix_table_offset = 0;
+    size_t count = 1;
+    if (allow_msix == AllowMSIX::Yes)
+        capability = find_capability(address, PCI_CAPABILITY_MSIX);
+    if (capability.has_value()) {
+        u16 control = capability->read16(MSIX_CONTROL);
+        size_t table_size = (control & MSIX_CONTROL_TABLE_SIZE) + 1;
+        count = min(wanted_count, table_size);
+        u32 table = capability->read32(MSIX_TABLE);
+        // FIXME: This assumes the BAR is a memory BAR below 4 GiB.
+        PhysicalAddress table_address((get_BAR(address, table & MSIX_TABLE_BIR) & ~0xf) + (table & ~MSIX_TABLE_BIR));
+        msix_table_offset = table_address.offset_in_page();
+        msix_table_region = MM.allocate_kernel_region(table_address.page_base(), page_round_up(msix_table_offset + table_size * MSIX_TABLE_ENTRY_SIZE), "MSI-X Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+        if (!msix_table_region)
+            return {};
+    } else {
+        capability = find_capability(address, PCI_CAPABILITY_MSI);
+        if (!capability.has_value())
+            return {};
+        // NOTE: MSI can do up to 32 vectors, but they'd have to be consecutive and all go to the same processor.
+    }
+
+    NonnullOwnPtrVector<MSIHandler> handlers;
+    for (size_t i = 0; i < count; ++i) {
+        auto handler = MSIHandler::try_create(purpose);
+        if (!handler)
+            break;
+        handlers.append(handler.release_nonnull());
+    }
+    if (handlers.is_empty())
+        return {};
+
+    auto interrupts = adopt_own_if_nonnull(new MessageSignaledInterrupts(address, capability.release_value(), move(msix_table_region), msix_table_offset, move(handlers)));
+    if (!interrupts)
+        return {};
+    for (size_t i = 0; i < interrupts->count(); ++i)
+        interrupts->route_to_processor(i, s_next_processor.fetch_add(1, AK::MemoryOrder::memory_order_relaxed) % Processor::count());
+    dmesgln("{}: Using {} {} vector(s) for {}", address, interrupts->count(), interrupts->is_msix() ? "MSI-X" : "MSI", purpose);
+    return interrupts;
+}
+
+MessageSignaledInterrupts::MessageSignaledInterrupts(Address address, Capability capability, OwnPtr<Region> msix_table_region, size_t msix_table_offset, NonnullOwnPtrVector<MSIHandler> handlers)
+    : m_address(address)
+    , m_capability(capability)
+    , m_msix_table_region(move(msix_table_region))
+    , m_msix_table_offset(msix_table_offset)
+    , m_handlers(move(handlers))
+{
+    // Make sure nothing gets delivered before we're told to.
+    if (is_msix()) {
+        m_capability.write16(MSIX_CONTROL, m_capability.read16(MSIX_CONTROL) | MSIX_CONTROL_FUNCTION_MASK);
+        for (size_t i = 0; i < count(); ++i)
+            msix_table_entry(i)[MSIX_ENTRY_VECTOR_CONTROL] = MSIX_VECTOR_MASKED;
+    } else {
+        m_capability.write16(MSI_CONTROL, m_capability.read16(MSI_CONTROL) & ~MSI_CONTROL_ENABLE);
+    }
+}
+
+MessageSignaledInterrupts::~MessageSignaledInterrupts()
+{
+    disable();
+}
+
+volatile u32* MessageSignaledInterrupts::msix_table_entry(size_t index)
+{
+    VERIFY(is_msix());
+    return (volatile u32*)(m_msix_table_region->vaddr().as_ptr() + m_msix_table_offset + index * MSIX_TABLE_ENTRY_SIZE);
+}
+
+void MessageSignaledInterrupts::set_handler(size_t index, MSIHandler::Callback callback)
+{
+    InterruptDisabler disabler;
+    m_handlers[index].set_callback(move(callback));
+}
+
+void MessageSignaledInterrupts::route_to_processor(size_t index, u32 processor)
+{
+    // Fall back to the boot processor if the other one hasn't come up yet.
+    if (!APIC::the().physical_apic_id(processor).has_value())
+        processor = 0;
+    m_handlers[index].set_responsible_processor(processor);
+    write_message(index);
+}
+
+void MessageSignaledInterrupts::write_message(size_t index)
+{
+    auto& handler = m_handlers[index];
+    u32 message_address = MSI_ADDRESS_BASE | (u32)APIC::the().physical_apic_id(handler.responsible_processor()).value_or(0) << MSI_ADDRESS_DESTINATION_SHIFT;
+    u32 message_data = handler.vector();
+
+    if (is_msix()) {
+        // NOTE: The entry is masked while we change it, so the device never sees half an update.
+        auto* entry = msix_table_entry(index);
+        u32 vector_control = entry[MSIX_ENTRY_VECTOR_CONTROL];
+        entry[MSIX_ENTRY_VECTOR_CONTROL] = vector_control | MSIX_VECTOR_MASKED;
+        entry[MSIX_ENTRY_ADDRESS_LOW] = message_address;
+        entry[MSIX_ENTRY_ADDRESS_HIGH] = 0;
+        entry[MSIX_ENTRY_DATA] = message_data;
+        entry[MSIX_ENTRY_VECTOR_CONTROL] = vector_control;
+        return;
+    }
+
+    VERIFY(index == 0);
+    u16 control = m_capability.read16(MSI_CONTROL);
+    m_capability.write16(MSI_CONTROL, control & ~MSI_CONTROL_ENABLE);
+    m_capability.write32(MSI_ADDRESS_LOW, message_address);
+    if (control & MSI_CONTROL_64BIT) {
+        m_capability.write32(MSI_ADDRESS_HIGH, 0);
+        m_capability.write16(MSI_DATA_64, message_data);
+    } else {
+        m_capability.write16(MSI_DATA_32, message_data);
+    }
+    // We only ever use a single message.
+    control &= ~MSI_CONTROL_MULTIPLE_MESSAGE_ENABLE;
+    m_capability.write16(MSI_CONTROL, m_enabled ? (control | MSI_CONTROL_ENABLE) : (control & ~MSI_CONTROL_ENABLE));
+}
+
+void MessageSignaledInterrupts::enable()
+{
+    if (m_enabled)
+        return;
+    m_enabled = true;
+    // A device that sends messages must not also use its interrupt pin.
+    disable_interrupt_line(m_address);
+    if (is_msix()) {
+        for (size_t i = 0; i < count(); ++i)
+            msix_table_entry(i)[MSIX_ENTRY_VECTOR_CONTROL] = 0;
+        u16 control = m_capability.read16(MSIX_CONTROL);
+        m_capability.write16(MSIX_CONTROL, (control | MSIX_CONTROL_ENABLE) & ~MSIX_CONTROL_FUNCTION_MASK);
+        return;
+    }
+    m_capability.write16(MSI_CONTROL, m_capability.read16(MSI_CONTROL) | MSI_CONTROL_ENABLE);
+}
+
+void MessageSignaledInterrupts::disable()
+{
+    if (!m_enabled)
+        return;
+    m_enabled = false;
+    if (is_msix()) {
+        u16 control = m_capability.read16(MSIX_CONTROL);
+        m_capability.write16(MSIX_CONTROL, control & ~MSIX_CONTROL_ENABLE);
+        return;
+    }
+    m_capability.write16(MSI_CONTROL, m_capability.read16(MSI_CONTROL) & ~MSI_CONTROL_ENABLE);
+}
+
+}
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+#include <Kernel/PCI/Definitions.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+namespace PCI {
+
+// The message signaled interrupts of a PCI device.
+//
+// A device with MSI-X gets as many interrupt vectors as it (and we) can spare, and each of them can be
+// routed to a different processor, so for example every queue of a device can interrupt the processor
+// that uses it. A device with plain MSI gets a single vector.
+// New vectors are spread over the processors. Nothing gets delivered until enable() is called, after which
+// the device's interrupt pin is left alone.
+class MessageSignaledInterrupts {
+public:
+    enum class AllowMSIX {
+        No,
+        Yes,
+    };
+
+    // Returns null if the device can't do message signaled interrupts (or they aren't usable right now),
+    // in which case the driver has to stick to the interrupt pin.
+    static OwnPtr<MessageSignaledInterrupts> try_create(Address, size_t wanted_count, const char* purpose, AllowMSIX = AllowMSIX::Yes);
+    ~MessageSignaledInterrupts();
+
+    bool is_msix() const { return m_msix_table_region; }
+    size_t count() const { return m_handlers.size(); }
+
+    void set_handler(size_t index, MSIHandler::Callback);
+    // Makes interrupt `index` go to the given processor from now on.
+    void route_to_processor(size_t index, u32 processor);
+    u32 processor_for(size_t index) const { return m_handlers[index].responsible_processor(); }
+
+    void enable();
+    void disable();
+
+private:
+    MessageSignaledInterrupts(Address, Capability, OwnPtr<Region> msix_table_region, size_t msix_table_offset, NonnullOwnPtrVector<MSIHandler>);
+
+    volatile u32* msix_table_entry(size_t index);
+    void write_message(size_t index);
+
+    Address m_address;
+    Capability m_capability;
+    OwnPtr<Region> m_msix_table_region;
+    size_t m_msix_table_offset { 0 };
+    NonnullOwnPtrVector<MSIHandler> m_handlers;
+    bool m_enabled { false };
+};
+
+}
+}
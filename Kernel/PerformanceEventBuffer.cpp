@@ -18,7 +18,49 @@ namespace Kernel {
 
 PerformanceEventBuffer::PerformanceEventBuffer(NonnullOwnPtr<KBuffer> buffer)
     : m_buffer(move(buffer))
+    , m_ring_count(min<size_t>(Processor::count(), max_ring_count))
 {
+    auto* events = reinterpret_cast<PerformanceEvent*>(m_buffer->data());
+    size_t ring_size = m_buffer->size() / sizeof(PerformanceEvent) / m_ring_count;
+    VERIFY(ring_size >= 2);
+    for (size_t i = 0; i < m_ring_count; ++i) {
+        m_rings[i].events = events + i * ring_size;
+        m_rings[i].size = ring_size;
+    }
+}
+
+void PerformanceEventBuffer::clear()
+{
+    for (size_t i = 0; i < m_ring_count; ++i) {
+        m_rings[i].tail.store(m_rings[i].head.load(AK::MemoryOrder::memory_order_acquire), AK::MemoryOrder::memory_order_release);
+        m_rings[i].lost_events.store(0, AK::MemoryOrder::memory_order_relaxed);
+    }
+}
+
+size_t PerformanceEventBuffer::capacity() const
+{
+    size_t capacity = 0;
+    for (size_t i = 0; i < m_ring_count; ++i)
+        capacity += m_rings[i].size - 1;
+    return capacity;
+}
+
+size_t PerformanceEventBuffer::count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_ring_count; ++i) {
+        auto& ring = m_rings[i];
+        count += ring.count(ring.head.load(AK::MemoryOrder::memory_order_acquire), ring.tail.load(AK::MemoryOrder::memory_order_acquire));
+    }
+    return count;
+}
+
+size_t PerformanceEventBuffer::lost_event_count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_ring_count; ++i)
+        count += m_rings[i].lost_events.load(AK::MemoryOrder::memory_order_relaxed);
+    return count;
 }
 
 NEVER_INLINE KResult PerformanceEventBuffer::append(int type, FlatPtr arg1, FlatPtr arg2, const StringView& arg3, Thread* current_thread)
@@ -58,9 +100,6 @@ static Vector<FlatPtr, PerformanceEvent::max_stack_frame_count> raw_backtrace(Fl
 KResult PerformanceEventBuffer::append_with_eip_and_ebp(ProcessID pid, ThreadID tid,
     u32 eip, u32 ebp, int type, u32 lost_samples, FlatPtr arg1, FlatPtr arg2, const StringView& arg3)
 {
-    if (count() >= capacity())
-        return ENOBUFS;
-
     if ((g_profiling_event_mask & type) == 0)
         return EINVAL;
 
@@ -126,6 +165,16 @@ KResult PerformanceEventBuffer::append_with_eip_and_ebp(ProcessID pid, ThreadID
         event.data.context_switch.next_pid = arg1;
         event.data.context_switch.next_tid = arg2;
         break;
+    case PERF_EVENT_THREAD_BLOCK:
+        event.data.thread_block.blocker_type = arg1;
+        memset(event.data.thread_block.blocker, 0, sizeof(event.data.thread_block.blocker));
+        if (!arg3.is_empty())
+            memcpy(event.data.thread_block.blocker, arg3.characters_without_null_termination(), min(arg3.length(), sizeof(event.data.thread_block.blocker) - 1));
+        break;
+    case PERF_EVENT_THREAD_WAKEUP:
+        event.data.thread_wakeup.waker_pid = arg1;
+        event.data.thread_wakeup.waker_tid = arg2;
+        break;
     case PERF_EVENT_KMALLOC:
         event.data.kmalloc.size = arg1;
         event.data.kmalloc.ptr = arg2;
@@ -136,6 +185,29 @@ KResult PerformanceEventBuffer::append_with_eip_and_ebp(ProcessID pid, ThreadID
         break;
     case PERF_EVENT_PAGE_FAULT:
         break;
+    case PERF_EVENT_CYCLES:
+    case PERF_EVENT_INSTRUCTIONS:
+    case PERF_EVENT_CACHE_MISS:
+    case PERF_EVENT_BRANCH_MISS:
+        event.data.hardware_counter_sample.period = arg1;
+        break;
+    case PERF_EVENT_SYSCALL_ENTER:
+    case PERF_EVENT_SYSCALL_EXIT:
+        event.data.syscall.function = arg1;
+        event.data.syscall.result = arg2;
+        break;
+    case PERF_EVENT_IRQ:
+        event.data.irq.irq = arg1;
+        break;
+    case PERF_EVENT_IPC_SEND:
+    case PERF_EVENT_IPC_RECEIVE:
+        event.data.ipc_message.endpoint_magic = arg1;
+        event.data.ipc_message.message_id = arg2;
+        break;
+    case PERF_EVENT_EVENT_LOOP_DISPATCH:
+        event.data.event_loop_dispatch.event_type = arg1;
+        event.data.event_loop_dispatch.duration_us = arg2;
+        break;
     default:
         return EINVAL;
     }
@@ -147,24 +219,53 @@ KResult PerformanceEventBuffer::append_with_eip_and_ebp(ProcessID pid, ThreadID
     event.pid = pid.value();
     event.tid = tid.value();
     event.timestamp = TimeManagement::the().uptime_ms();
-    at(m_count++) = event;
-    return KSuccess;
-}
 
-PerformanceEvent& PerformanceEventBuffer::at(size_t index)
-{
-    VERIFY(index < capacity());
-    auto* events = reinterpret_cast<PerformanceEvent*>(m_buffer->data());
-    return events[index];
+    // NOTE: Staying on this processor (with interrupts off) makes us the only one touching the head of its ring.
+    ScopedCritical critical;
+    auto& ring = m_rings[Processor::id() % m_ring_count];
+    auto head = ring.head.load(AK::MemoryOrder::memory_order_relaxed);
+    auto next_head = (head + 1) % ring.size;
+    if (next_head == ring.tail.load(AK::MemoryOrder::memory_order_acquire)) {
+        ring.lost_events.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return ENOBUFS;
+    }
+    ring.events[head] = event;
+    ring.head.store(next_head, AK::MemoryOrder::memory_order_release);
+    return KSuccess;
 }
 
 template<typename Serializer>
-bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
+bool PerformanceEventBuffer::to_json_impl(Serializer& object, bool consume) const
 {
+    // NOTE: Events that get appended while we're going through the rings are left for next time.
+    size_t positions[max_ring_count];
+    size_t ends[max_ring_count];
+    for (size_t i = 0; i < m_ring_count; ++i) {
+        positions[i] = m_rings[i].tail.load(AK::MemoryOrder::memory_order_acquire);
+        ends[i] = m_rings[i].head.load(AK::MemoryOrder::memory_order_acquire);
+    }
+
+    object.add("lost_events", static_cast<u64>(lost_event_count()));
     auto array = object.add_array("events");
     bool seen_first_sample = false;
-    for (size_t i = 0; i < m_count; ++i) {
-        auto& event = at(i);
+    for (;;) {
+        // Every ring is in order already, so merging them only has to look at the first event of each.
+        const PerformanceEvent* next_event = nullptr;
+        size_t next_ring = 0;
+        for (size_t i = 0; i < m_ring_count; ++i) {
+            if (positions[i] == ends[i])
+                continue;
+            auto& candidate = m_rings[i].events[positions[i]];
+            if (!next_event || candidate.timestamp < next_event->timestamp) {
+                next_event = &candidate;
+                next_ring = i;
+            }
+        }
+        if (!next_event)
+            break;
+        positions[next_ring] = (positions[next_ring] + 1) % m_rings[next_ring].size;
+
+        auto& event = *next_event;
         auto event_object = array.add_object();
         switch (event.type) {
         case PERF_EVENT_SAMPLE:
@@ -214,6 +315,16 @@ bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
             event_object.add("next_pid", static_cast<u64>(event.data.context_switch.next_pid));
             event_object.add("next_tid", static_cast<u64>(event.data.context_switch.next_tid));
             break;
+        case PERF_EVENT_THREAD_BLOCK:
+            event_object.add("type", "thread_block");
+            event_object.add("blocker_type", static_cast<u64>(event.data.thread_block.blocker_type));
+            event_object.add("blocker", event.data.thread_block.blocker);
+            break;
+        case PERF_EVENT_THREAD_WAKEUP:
+            event_object.add("type", "thread_wakeup");
+            event_object.add("waker_pid", static_cast<u64>(event.data.thread_wakeup.waker_pid));
+            event_object.add("waker_tid", static_cast<u64>(event.data.thread_wakeup.waker_tid));
+            break;
         case PERF_EVENT_KMALLOC:
             event_object.add("type", "kmalloc");
             event_object.add("ptr", static_cast<u64>(event.data.kmalloc.ptr));
@@ -227,6 +338,50 @@ bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
         case PERF_EVENT_PAGE_FAULT:
             event_object.add("type", "page_fault");
             break;
+        case PERF_EVENT_CYCLES:
+            event_object.add("type", "cycles");
+            event_object.add("period", static_cast<u64>(event.data.hardware_counter_sample.period));
+            break;
+        case PERF_EVENT_INSTRUCTIONS:
+            event_object.add("type", "instructions");
+            event_object.add("period", static_cast<u64>(event.data.hardware_counter_sample.period));
+            break;
+        case PERF_EVENT_CACHE_MISS:
+            event_object.add("type", "cache_miss");
+            event_object.add("period", static_cast<u64>(event.data.hardware_counter_sample.period));
+            break;
+        case PERF_EVENT_BRANCH_MISS:
+            event_object.add("type", "branch_miss");
+            event_object.add("period", static_cast<u64>(event.data.hardware_counter_sample.period));
+            break;
+        case PERF_EVENT_SYSCALL_ENTER:
+            event_object.add("type", "syscall_enter");
+            event_object.add("function", event.data.syscall.function);
+            break;
+        case PERF_EVENT_SYSCALL_EXIT:
+            event_object.add("type", "syscall_exit");
+            event_object.add("function", event.data.syscall.function);
+            event_object.add("result", static_cast<i32>(event.data.syscall.result));
+            break;
+        case PERF_EVENT_IRQ:
+            event_object.add("type", "irq");
+            event_object.add("irq", event.data.irq.irq);
+            break;
+        case PERF_EVENT_IPC_SEND:
+            event_object.add("type", "ipc_send");
+            event_object.add("endpoint_magic", event.data.ipc_message.endpoint_magic);
+            event_object.add("message_id", event.data.ipc_message.message_id);
+            break;
+        case PERF_EVENT_IPC_RECEIVE:
+            event_object.add("type", "ipc_receive");
+            event_object.add("endpoint_magic", event.data.ipc_message.endpoint_magic);
+            event_object.add("message_id", event.data.ipc_message.message_id);
+            break;
+        case PERF_EVENT_EVENT_LOOP_DISPATCH:
+            event_object.add("type", "event_loop_dispatch");
+            event_object.add("event_type", event.data.event_loop_dispatch.event_type);
+            event_object.add("duration_us", event.data.event_loop_dispatch.duration_us);
+            break;
         }
         event_object.add("pid", event.pid);
         event_object.add("tid", event.tid);
@@ -243,13 +398,24 @@ bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
     }
     array.finish();
     object.finish();
+
+    if (consume) {
+        for (size_t i = 0; i < m_ring_count; ++i)
+            m_rings[i].tail.store(ends[i], AK::MemoryOrder::memory_order_release);
+    }
     return true;
 }
 
 bool PerformanceEventBuffer::to_json(KBufferBuilder& builder) const
 {
     JsonObjectSerializer object(builder);
-    return to_json_impl(object);
+    return to_json_impl(object, false);
+}
+
+bool PerformanceEventBuffer::consume_to_json(KBufferBuilder& builder)
+{
+    JsonObjectSerializer object(builder);
+    return to_json_impl(object, true);
 }
 
 OwnPtr<PerformanceEventBuffer> PerformanceEventBuffer::try_create_with_size(size_t buffer_size)
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/KResult.h>
 
@@ -52,6 +53,17 @@ struct [[gnu::packed]] ContextSwitchPerformanceEvent {
     u32 next_tid;
 };
 
+struct [[gnu::packed]] ThreadBlockPerformanceEvent {
+    u32 blocker_type;
+    char blocker[32];
+};
+
+// NOTE: The event itself is about the thread that's woken up, this is about the thread that woke it up.
+struct [[gnu::packed]] ThreadWakeupPerformanceEvent {
+    pid_t waker_pid;
+    u32 waker_tid;
+};
+
 struct [[gnu::packed]] KMallocPerformanceEvent {
     size_t size;
     FlatPtr ptr;
@@ -62,8 +74,34 @@ struct [[gnu::packed]] KFreePerformanceEvent {
     FlatPtr ptr;
 };
 
+struct [[gnu::packed]] HardwareCounterSamplePerformanceEvent {
+    // How many of the counted events this sample stands for.
+    u32 period;
+};
+
+struct [[gnu::packed]] SyscallPerformanceEvent {
+    u32 function;
+    // Only there for PERF_EVENT_SYSCALL_EXIT.
+    FlatPtr result;
+};
+
+struct [[gnu::packed]] IRQPerformanceEvent {
+    u32 irq;
+};
+
+struct [[gnu::packed]] IPCMessagePerformanceEvent {
+    u32 endpoint_magic;
+    i32 message_id;
+};
+
+// NOTE: This is recorded once the event has been dispatched, so the dispatch started duration_us before the timestamp.
+struct [[gnu::packed]] EventLoopDispatchPerformanceEvent {
+    u32 event_type;
+    u32 duration_us;
+};
+
 struct [[gnu::packed]] PerformanceEvent {
-    u16 type { 0 };
+    u32 type { 0 };
     u8 stack_size { 0 };
     u32 pid { 0 };
     u32 tid { 0 };
@@ -78,8 +116,15 @@ struct [[gnu::packed]] PerformanceEvent {
         ProcessExecPerformanceEvent process_exec;
         ThreadCreatePerformanceEvent thread_create;
         ContextSwitchPerformanceEvent context_switch;
+        ThreadBlockPerformanceEvent thread_block;
+        ThreadWakeupPerformanceEvent thread_wakeup;
         KMallocPerformanceEvent kmalloc;
         KFreePerformanceEvent kfree;
+        HardwareCounterSamplePerformanceEvent hardware_counter_sample;
+        SyscallPerformanceEvent syscall;
+        IRQPerformanceEvent irq;
+        IPCMessagePerformanceEvent ipc_message;
+        EventLoopDispatchPerformanceEvent event_loop_dispatch;
     } data;
     static constexpr size_t max_stack_frame_count = 64;
     FlatPtr stack[max_stack_frame_count];
@@ -90,6 +135,9 @@ enum class ProcessEventType {
     Exec
 };
 
+// Every processor appends to its own ring of events, so appending never takes a lock or waits for
+// another processor, and the events can be taken out (and make room for new ones) while profiling goes on.
+// When they're serialized, the events of all the processors are merged by their timestamps.
 class PerformanceEventBuffer {
 public:
     static OwnPtr<PerformanceEventBuffer> try_create_with_size(size_t buffer_size);
@@ -98,32 +146,42 @@ public:
     KResult append_with_eip_and_ebp(ProcessID pid, ThreadID tid, u32 eip, u32 ebp,
         int type, u32 lost_samples, FlatPtr arg1, FlatPtr arg2, const StringView& arg3);
 
-    void clear()
-    {
-        m_count = 0;
-    }
+    void clear();
 
-    size_t capacity() const { return m_buffer->size() / sizeof(PerformanceEvent); }
-    size_t count() const { return m_count; }
-    const PerformanceEvent& at(size_t index) const
-    {
-        return const_cast<PerformanceEventBuffer&>(*this).at(index);
-    }
+    size_t capacity() const;
+    size_t count() const;
+    // How many events didn't fit, because nobody took the earlier ones out in time.
+    size_t lost_event_count() const;
 
     bool to_json(KBufferBuilder&) const;
+    // Like to_json(), but the events are taken out of the buffer.
+    bool consume_to_json(KBufferBuilder&);
 
     void add_process(const Process&, ProcessEventType event_type);
 
 private:
+    static constexpr size_t max_ring_count = ProcessorContainer {}.size();
+
+    // NOTE: Only the processor that owns the ring moves the head, and only the consumer moves the tail.
+    //       One slot is always kept empty, so head == tail means the ring is empty.
+    struct Ring {
+        PerformanceEvent* events { nullptr };
+        size_t size { 0 };
+        Atomic<size_t> head { 0 };
+        Atomic<size_t> tail { 0 };
+        Atomic<size_t> lost_events { 0 };
+
+        size_t count(size_t head, size_t tail) const { return (head + size - tail) % size; }
+    };
+
     explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
 
     template<typename Serializer>
-    bool to_json_impl(Serializer&) const;
-
-    PerformanceEvent& at(size_t index);
+    bool to_json_impl(Serializer&, bool consume) const;
 
-    size_t m_count { 0 };
     NonnullOwnPtr<KBuffer> m_buffer;
+    size_t m_ring_count { 0 };
+    mutable Ring m_rings[max_ring_count];
 };
 
 extern bool g_profiling_all_threads;
@@ -67,6 +67,17 @@ public:
         }
     }
 
+    inline static void add_hardware_counter_sample_event(Thread& current_thread, const RegisterState& regs, int event_type, u32 period)
+    {
+        if (current_thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append_with_eip_and_ebp(
+                current_thread.pid(), current_thread.tid(),
+                regs.eip, regs.ebp, event_type, 0, period, 0, nullptr);
+        }
+    }
+
     inline static void add_mmap_perf_event(Process& current_process, Region const& region)
     {
         if (auto* event_buffer = current_process.current_perf_events_buffer()) {
@@ -85,9 +96,34 @@ public:
     {
         if (current_thread.is_profiling_suppressed())
             return;
-        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+        auto* event_buffer = current_thread.process().current_perf_events_buffer();
+        if (event_buffer) {
             [[maybe_unused]] auto res = event_buffer->append(PERF_EVENT_CONTEXT_SWITCH, next_thread.pid().value(), next_thread.tid().value(), nullptr);
         }
+        // NOTE: The profile of the next thread's process needs this too, to tell how long the thread waited to run.
+        if (auto* next_event_buffer = next_thread.process().current_perf_events_buffer(); next_event_buffer && next_event_buffer != event_buffer) {
+            [[maybe_unused]] auto res = next_event_buffer->append(PERF_EVENT_CONTEXT_SWITCH, next_thread.pid().value(), next_thread.tid().value(), nullptr, &next_thread);
+        }
+    }
+
+    inline static void add_thread_block_event(Thread& thread, const Thread::Blocker& blocker)
+    {
+        if (thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto res = event_buffer->append(PERF_EVENT_THREAD_BLOCK, (FlatPtr)blocker.blocker_type(), 0, blocker.state_string(), &thread);
+        }
+    }
+
+    // NOTE: The stack in this event is the waker's, if there's one, so it's easy to see what woke the thread up.
+    inline static void add_thread_wakeup_event(Thread& thread, Thread* waker)
+    {
+        if (thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto res = event_buffer->append(PERF_EVENT_THREAD_WAKEUP,
+                waker ? waker->pid().value() : 0, waker ? waker->tid().value() : 0, nullptr, &thread);
+        }
     }
 
     inline static void add_kmalloc_perf_event(Thread& current_thread, size_t size, FlatPtr ptr)
@@ -119,6 +155,44 @@ public:
         }
     }
 
+    // NOTE: The syscall and IRQ events only have the userspace address they came from (if any), instead of a whole
+    //       stack, so that tracing them doesn't slow everything down too much.
+    inline static void add_syscall_enter_event(Thread& current_thread, const RegisterState& regs, FlatPtr function)
+    {
+        if (current_thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append_with_eip_and_ebp(
+                current_thread.pid(), current_thread.tid(),
+                regs.eip, 0, PERF_EVENT_SYSCALL_ENTER, 0, function, 0, nullptr);
+        }
+    }
+
+    inline static void add_syscall_exit_event(Thread& current_thread, const RegisterState& regs, FlatPtr function)
+    {
+        if (current_thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append_with_eip_and_ebp(
+                current_thread.pid(), current_thread.tid(),
+                regs.eip, 0, PERF_EVENT_SYSCALL_EXIT, 0, function, regs.eax, nullptr);
+        }
+    }
+
+    // Interrupts don't belong to any process, so these are only recorded when everything is being profiled.
+    // They're put down to the thread that was interrupted, if there was one.
+    inline static void add_irq_event(u8 irq)
+    {
+        if (!g_profiling_all_threads || !(g_profiling_event_mask & PERF_EVENT_IRQ))
+            return;
+        auto* current_thread = Thread::current();
+        ProcessID pid = current_thread ? current_thread->pid() : ProcessID(0);
+        ThreadID tid = current_thread ? current_thread->tid() : ThreadID(0);
+        VERIFY(g_global_perf_events);
+        [[maybe_unused]] auto rc = g_global_perf_events->append_with_eip_and_ebp(
+            pid, tid, 0, 0, PERF_EVENT_IRQ, 0, irq, 0, nullptr);
+    }
+
     inline static void timer_tick(RegisterState const& regs)
     {
         static Time last_wakeup;
@@ -17,6 +17,7 @@
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/HardwarePerformanceCounters.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Module.h>
@@ -372,6 +373,7 @@ RefPtr<FileDescription> Process::file_description(int fd) const
 {
     if (fd < 0)
         return nullptr;
+    ScopedSpinLock lock(m_fds_lock);
     if (static_cast<size_t>(fd) < m_fds.size())
         return m_fds[fd].description();
     return nullptr;
@@ -381,6 +383,7 @@ int Process::fd_flags(int fd) const
 {
     if (fd < 0)
         return -1;
+    ScopedSpinLock lock(m_fds_lock);
     if (static_cast<size_t>(fd) < m_fds.size())
         return m_fds[fd].flags();
     return -1;
@@ -405,6 +408,33 @@ int Process::alloc_fd(int first_candidate_fd)
     return -EMFILE;
 }
 
+void Process::set_file_description(int fd, NonnullRefPtr<FileDescription>&& description, u32 flags)
+{
+    RefPtr<FileDescription> previous_description;
+    {
+        ScopedSpinLock lock(m_fds_lock);
+        previous_description = m_fds[fd].description();
+        m_fds[fd].set(move(description), flags);
+    }
+    // NOTE: Dropping the last reference to a description may sleep, so that happens out here.
+}
+
+void Process::clear_file_description(int fd)
+{
+    RefPtr<FileDescription> previous_description;
+    {
+        ScopedSpinLock lock(m_fds_lock);
+        previous_description = m_fds[fd].description();
+        m_fds[fd].clear();
+    }
+}
+
+void Process::set_fd_flags(int fd, u32 flags)
+{
+    ScopedSpinLock lock(m_fds_lock);
+    m_fds[fd].set_flags(flags);
+}
+
 Time kgettimeofday()
 {
     return TimeManagement::now();
@@ -498,6 +528,7 @@ void Process::finalize()
         if (m_perf_event_buffer) {
             dump_perfcore();
             TimeManagement::the().disable_profile_timer();
+            disable_hardware_performance_counters_if_needed();
         }
     }
 
@@ -713,6 +744,14 @@ bool Process::create_perf_events_buffer_if_needed()
     return !!m_perf_event_buffer;
 }
 
+void Process::disable_hardware_performance_counters_if_needed()
+{
+    if (!m_profiling_with_hardware_counters)
+        return;
+    HardwarePerformanceCounters::the().disable();
+    m_profiling_with_hardware_counters = false;
+}
+
 void Process::delete_perf_events_buffer()
 {
     if (m_perf_event_buffer)
@@ -329,6 +329,7 @@ public:
     KResultOr<int> sys$ptsname(int fd, Userspace<char*>, size_t);
     KResultOr<pid_t> sys$fork(RegisterState&);
     KResultOr<int> sys$execve(Userspace<const Syscall::SC_execve_params*>);
+    KResultOr<pid_t> sys$posix_spawn(Userspace<const Syscall::SC_posix_spawn_params*>);
     KResultOr<int> sys$dup2(int old_fd, int new_fd);
     KResultOr<int> sys$sigaction(int signum, Userspace<const sigaction*> act, Userspace<sigaction*> old_act);
     KResultOr<int> sys$sigprocmask(int how, Userspace<const sigset_t*> set, Userspace<sigset_t*> old_set);
@@ -369,6 +370,8 @@ public:
     KResultOr<int> sys$shutdown(int sockfd, int how);
     KResultOr<ssize_t> sys$sendmsg(int sockfd, Userspace<const struct msghdr*>, int flags);
     KResultOr<ssize_t> sys$recvmsg(int sockfd, Userspace<struct msghdr*>, int flags);
+    KResultOr<int> sys$sendmmsg(Userspace<const Syscall::SC_sendmmsg_params*>);
+    KResultOr<int> sys$recvmmsg(Userspace<const Syscall::SC_recvmmsg_params*>);
     KResultOr<int> sys$getsockopt(Userspace<const Syscall::SC_getsockopt_params*>);
     KResultOr<int> sys$setsockopt(Userspace<const Syscall::SC_setsockopt_params*>);
     KResultOr<int> sys$getsockname(Userspace<const Syscall::SC_getsockname_params*>);
@@ -376,6 +379,10 @@ public:
     KResultOr<int> sys$socketpair(Userspace<const Syscall::SC_socketpair_params*>);
     KResultOr<int> sys$sched_setparam(pid_t pid, Userspace<const struct sched_param*>);
     KResultOr<int> sys$sched_getparam(pid_t pid, Userspace<struct sched_param*>);
+    KResultOr<int> sys$sched_setaffinity(pid_t pid, size_t cpusetsize, Userspace<const cpu_set_t*>);
+    KResultOr<int> sys$sched_getaffinity(pid_t pid, size_t cpusetsize, Userspace<cpu_set_t*>);
+    KResultOr<int> sys$sched_setscheduler(pid_t pid, int policy, Userspace<const struct sched_param*>);
+    KResultOr<int> sys$sched_getscheduler(pid_t pid);
     KResultOr<int> sys$create_thread(void* (*)(void*), Userspace<const Syscall::SC_create_thread_params*>);
     [[noreturn]] void sys$exit_thread(Userspace<void*>, Userspace<void*>, size_t);
     KResultOr<int> sys$join_thread(pid_t tid, Userspace<void**> exit_value);
@@ -404,6 +411,7 @@ public:
     KResultOr<int> sys$ptrace(Userspace<const Syscall::SC_ptrace_params*>);
     KResultOr<int> sys$sendfd(int sockfd, int fd);
     KResultOr<int> sys$recvfd(int sockfd, int options);
+    KResultOr<ssize_t> sys$sendfile(Userspace<const Syscall::SC_sendfile_params*>);
     KResultOr<long> sys$sysconf(int name);
     KResultOr<int> sys$disown(ProcessID);
     KResultOr<FlatPtr> sys$allocate_tls(Userspace<const char*> initial_data, size_t);
@@ -412,10 +420,18 @@ public:
     KResultOr<int> sys$anon_create(size_t, int options);
     KResultOr<int> sys$statvfs(Userspace<const Syscall::SC_statvfs_params*> user_params);
     KResultOr<int> sys$fstatvfs(int fd, statvfs* buf);
+    KResultOr<int> sys$io_ring_create(unsigned entries, int options);
+    KResultOr<int> sys$io_ring_enter(int fd, unsigned to_submit, unsigned min_complete);
+    KResultOr<int> sys$epoll_create(int flags);
+    KResultOr<int> sys$epoll_ctl(int epoll_fd, int op, int fd, Userspace<const epoll_event*>);
+    KResultOr<int> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
 
     template<bool sockname, typename Params>
     int get_sock_or_peer_name(const Params&);
 
+    // Accepts a connection that's waiting on the socket and gives it a new fd. Used by accept4() and IORing.
+    KResultOr<int> accept_pending_connection(FileDescription& accepting_socket_description, Userspace<sockaddr*> user_address, socklen_t& address_size, int flags);
+
     static void initialize();
 
     [[noreturn]] void crash(int signal, u32 eip, bool out_of_memory = false);
@@ -445,7 +461,7 @@ public:
 
     KResult exec(String path, Vector<String> arguments, Vector<String> environment, int recusion_depth = 0);
 
-    KResultOr<LoadResult> load(NonnullRefPtr<FileDescription> main_program_description, RefPtr<FileDescription> interpreter_description, const Elf32_Ehdr& main_program_header);
+    KResultOr<LoadResult> load(NonnullRefPtr<FileDescription> main_program_description, RefPtr<FileDescription> interpreter_description);
 
     bool is_superuser() const { return euid() == 0; }
 
@@ -527,15 +543,24 @@ private:
     bool dump_perfcore();
     bool create_perf_events_buffer_if_needed();
     void delete_perf_events_buffer();
+    void disable_hardware_performance_counters_if_needed();
 
-    KResult do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags, const Elf32_Ehdr& main_program_header);
+    KResult do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags);
     KResultOr<ssize_t> do_write(FileDescription&, const UserOrKernelBuffer&, size_t);
 
     KResultOr<int> do_statvfs(String path, statvfs* buf);
 
+    KResultOr<FlatPtr> resize_anonymous_mapping(const Range& old_range, size_t new_size);
+
     KResultOr<RefPtr<FileDescription>> find_elf_interpreter_for_executable(const String& path, const Elf32_Ehdr& elf_header, int nread, size_t file_size);
 
+    static bool copy_user_strings(const Syscall::StringListArgument&, Vector<String>& output);
+    KResult apply_posix_spawn_file_action(const Syscall::SC_posix_spawn_file_action&, const String& path);
+
     int alloc_fd(int first_candidate_fd = 0);
+    void set_file_description(int fd, NonnullRefPtr<FileDescription>&&, u32 flags = 0);
+    void clear_file_description(int fd);
+    void set_fd_flags(int fd, u32 flags);
 
     KResult do_kill(Process&, int signal);
     KResult do_killpg(ProcessGroupID pgrp, int signal);
@@ -600,12 +625,16 @@ private:
         u32 m_flags { 0 };
     };
     Vector<FileDescriptionAndFlags> m_fds;
+    // NOTE: Changing the file descriptor table needs both the big lock and m_fds_lock, looking at it needs either one.
+    //       This lets syscalls like read() and write() get at their file descriptions without the big lock.
+    mutable SpinLock<u8> m_fds_lock;
 
     mutable RecursiveSpinLock m_thread_list_lock;
 
     const bool m_is_kernel_process;
     bool m_dead { false };
     bool m_profiling { false };
+    bool m_profiling_with_hardware_counters { false };
     Atomic<bool, AK::MemoryOrder::memory_order_relaxed> m_is_stopped { false };
     bool m_should_dump_core { false };
 
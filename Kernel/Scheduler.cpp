@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Time.h>
@@ -31,15 +32,35 @@ public:
     WeakPtr<Thread> m_pending_beneficiary;
     const char* m_pending_donate_reason { nullptr };
     bool m_in_scheduler { true };
+
+    // How much of the current real-time window has gone by, and how much of it real-time threads used.
+    u32 m_ticks_in_realtime_window { 0 };
+    u32 m_realtime_ticks_in_realtime_window { 0 };
+    // Set once real-time threads have used up their share of the window, until the next one begins.
+    bool m_realtime_throttled { false };
 };
 
 RecursiveSpinLock g_scheduler_lock;
 
+// Real-time threads may use up to REALTIME_RUNTIME_TICKS out of every REALTIME_WINDOW_TICKS ticks on each processor.
+// Once they have, they only get to run when nothing else wants to, so a busy real-time thread can't lock everyone else out.
+static constexpr u32 REALTIME_WINDOW_TICKS = 250;
+static constexpr u32 REALTIME_RUNTIME_TICKS = 237;
+
 static u32 time_slice_for(const Thread& thread)
 {
     // One time slice unit == 4ms (assuming 250 ticks/second)
     if (thread.is_idle_thread())
         return 1;
+    switch (thread.scheduling_policy()) {
+    case Thread::SchedulingPolicy::FIFO:
+        // FIFO threads run until they block, yield, or something more important comes along.
+        return NumericLimits<u32>::max();
+    case Thread::SchedulingPolicy::RoundRobin:
+        return 25;
+    case Thread::SchedulingPolicy::Other:
+        break;
+    }
     return 2;
 }
 
@@ -51,34 +72,72 @@ READONLY_AFTER_INIT static Process* s_colonel_process;
 struct ThreadReadyQueue {
     IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_ready_queue_node> thread_list;
 };
-static SpinLock<u8> g_ready_queues_lock;
-static u32 g_ready_queues_mask;
-static constexpr u32 g_ready_queue_buckets = sizeof(g_ready_queues_mask) * 8;
-READONLY_AFTER_INIT static ThreadReadyQueue* g_ready_queues; // g_ready_queue_buckets entries
+
+// Every processor owns its own set of ready queues, so that processors
+// picking their next thread don't contend on a single global lock.
+// Processors that run out of work steal from their peers.
+struct ThreadReadyQueues {
+    SpinLock<u8> lock;
+    u32 mask { 0 };
+    static constexpr u32 buckets = sizeof(mask) * 8;
+    Array<ThreadReadyQueue, buckets> queues;
+
+    Thread* pull_next_runnable_thread(u32 affinity_mask, u32 bucket_mask);
+};
+static constexpr u32 g_ready_queue_buckets = ThreadReadyQueues::buckets;
+static constexpr u32 g_ready_queues_count = sizeof(THREAD_AFFINITY_DEFAULT) * 8; // One per affinity bit
+READONLY_AFTER_INIT static ThreadReadyQueues* g_ready_queues; // g_ready_queues_count entries
 static void dump_thread_list();
 
+// The first buckets are for real-time threads, and are strictly ordered by priority.
+static constexpr u32 g_realtime_ready_queue_buckets = 24;
+static constexpr u32 g_realtime_ready_queue_mask = (1u << g_realtime_ready_queue_buckets) - 1;
+
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
-    // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
+    // Converts the effective priority in the range of THREAD_PRIORITY_MIN...THREAD_EFFECTIVE_PRIORITY_MAX
     // to a index into g_ready_queues where 0 is the highest priority bucket
-    VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
+    VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_EFFECTIVE_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
-    auto priority_bucket = ((thread_priority_count - (thread_priority - THREAD_PRIORITY_MIN)) / thread_priority_count) * (g_ready_queue_buckets - 1);
+    if (thread_priority > THREAD_PRIORITY_MAX) {
+        // NOTE: Neighbouring real-time priorities may share a bucket, in which case they take turns.
+        auto priority_bucket = (THREAD_EFFECTIVE_PRIORITY_MAX - thread_priority) * g_realtime_ready_queue_buckets / thread_priority_count;
+        VERIFY(priority_bucket < g_realtime_ready_queue_buckets);
+        return priority_bucket;
+    }
+    auto priority_bucket = g_realtime_ready_queue_buckets + ((thread_priority_count - (thread_priority - THREAD_PRIORITY_MIN)) / thread_priority_count) * (g_ready_queue_buckets - g_realtime_ready_queue_buckets - 1);
     VERIFY(priority_bucket < g_ready_queue_buckets);
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static u32 ready_queues_processor_for([[maybe_unused]] const Thread& thread)
 {
-    auto affinity_mask = 1u << Processor::current().id();
+#if SCHEDULE_ON_ALL_PROCESSORS
+    // Prefer the processor the thread last ran on, its caches are most
+    // likely to still be warm. Otherwise, pick the first processor the
+    // thread's affinity allows. Idle processors will steal it if needed.
+    auto affinity = thread.affinity();
+    auto processor_count = min(Processor::count(), g_ready_queues_count);
+    auto last_cpu = thread.cpu();
+    if (last_cpu < processor_count && (affinity & (1u << last_cpu)))
+        return last_cpu;
+    for (u32 cpu = 0; cpu < processor_count; cpu++) {
+        if (affinity & (1u << cpu))
+            return cpu;
+    }
+#endif
+    return 0;
+}
 
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority_mask = g_ready_queues_mask;
+Thread* ThreadReadyQueues::pull_next_runnable_thread(u32 affinity_mask, u32 bucket_mask)
+{
+    ScopedSpinLock queues_lock(lock);
+    auto priority_mask = mask & bucket_mask;
     while (priority_mask != 0) {
         auto priority = __builtin_ffsl(priority_mask);
         VERIFY(priority > 0);
-        auto& ready_queue = g_ready_queues[--priority];
+        auto& ready_queue = queues[--priority];
         for (auto& thread : ready_queue.thread_list) {
             VERIFY(thread.m_runnable_priority == (int)priority);
             if (thread.is_active())
@@ -88,7 +147,7 @@ Thread& Scheduler::pull_next_runnable_thread()
             thread.m_runnable_priority = -1;
             ready_queue.thread_list.remove(thread);
             if (ready_queue.thread_list.is_empty())
-                g_ready_queues_mask &= ~(1u << priority);
+                mask &= ~(1u << priority);
             // Mark it as active because we are using this thread. This is similar
             // to comparing it with Processor::current_thread, but when there are
             // multiple processors there's no easy way to check whether the thread
@@ -100,18 +159,80 @@ Thread& Scheduler::pull_next_runnable_thread()
             // switching to it.
             // FIXME: Figure out a better way maybe?
             thread.set_active(true);
-            return thread;
+            return &thread;
         }
         priority_mask &= ~(1u << priority);
     }
+    return nullptr;
+}
+
+static Thread* pull_next_runnable_thread_from_any_queue(u32 current_cpu, u32 bucket_mask)
+{
+    auto affinity_mask = 1u << current_cpu;
+
+    if (auto* thread = g_ready_queues[current_cpu].pull_next_runnable_thread(affinity_mask, bucket_mask))
+        return thread;
+
+    // Our own queues are empty, try to steal work from the other processors.
+    auto processor_count = min(Processor::count(), g_ready_queues_count);
+    for (u32 i = 1; i < processor_count; i++) {
+        auto victim_cpu = (current_cpu + i) % processor_count;
+        if (auto* thread = g_ready_queues[victim_cpu].pull_next_runnable_thread(affinity_mask, bucket_mask)) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", current_cpu, *thread, victim_cpu);
+            return thread;
+        }
+    }
+    return nullptr;
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto& processor = Processor::current();
+    auto current_cpu = processor.id();
+
+    // Real-time threads that have used up their share of the processor go after everyone else.
+    if (processor.get_scheduler_data().m_realtime_throttled) {
+        if (auto* thread = pull_next_runnable_thread_from_any_queue(current_cpu, ~g_realtime_ready_queue_mask))
+            return *thread;
+    }
+    if (auto* thread = pull_next_runnable_thread_from_any_queue(current_cpu, NumericLimits<u32>::max()))
+        return *thread;
     return *Processor::idle_thread();
 }
 
+void Scheduler::preempt_for(Thread& thread)
+{
+    VERIFY(g_scheduler_lock.own_lock());
+    // Only real-time threads cut in, everyone else waits for the current time slice to run out.
+    if (thread.effective_priority() <= THREAD_PRIORITY_MAX || thread.m_runnable_priority < 0)
+        return;
+    auto cpu = thread.m_runnable_queue_cpu;
+    auto& processor = Processor::by_id(cpu);
+    if (processor.get_scheduler_data().m_realtime_throttled)
+        return;
+    auto* running_thread = processor.last_known_current_thread();
+    if (running_thread && !running_thread->is_idle_thread() && running_thread->effective_priority() >= thread.effective_priority())
+        return;
+    if (cpu == Processor::id()) {
+        Processor::current().invoke_scheduler_async();
+        return;
+    }
+    // NOTE: Idle processors have been woken up already.
+    if (!running_thread || running_thread->is_idle_thread())
+        return;
+    Processor::smp_unicast(
+        cpu, [] {
+            Processor::current().invoke_scheduler_async();
+        },
+        true);
+}
+
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
     if (thread.is_idle_thread())
         return true;
-    ScopedSpinLock lock(g_ready_queues_lock);
+    auto& ready_queues = g_ready_queues[thread.m_runnable_queue_cpu];
+    ScopedSpinLock lock(ready_queues.lock);
     auto priority = thread.m_runnable_priority;
     if (priority < 0) {
         VERIFY(!thread.m_ready_queue_node.is_in_list());
@@ -121,31 +242,46 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (check_affinity && !(thread.affinity() & (1 << Processor::current().id())))
         return false;
 
-    VERIFY(g_ready_queues_mask & (1u << priority));
-    auto& ready_queue = g_ready_queues[priority];
+    VERIFY(ready_queues.mask & (1u << priority));
+    auto& ready_queue = ready_queues.queues[priority];
     thread.m_runnable_priority = -1;
     ready_queue.thread_list.remove(thread);
     if (ready_queue.thread_list.is_empty())
-        g_ready_queues_mask &= ~(1u << priority);
+        ready_queues.mask &= ~(1u << priority);
     return true;
 }
 
+u32 Scheduler::schedulable_processors_mask()
+{
+#if SCHEDULE_ON_ALL_PROCESSORS
+    auto processor_count = min(Processor::count(), g_ready_queues_count);
+    if (processor_count >= 32)
+        return THREAD_AFFINITY_DEFAULT;
+    return (1u << processor_count) - 1;
+#else
+    return 1u;
+#endif
+}
+
 void Scheduler::queue_runnable_thread(Thread& thread)
 {
     VERIFY(g_scheduler_lock.own_lock());
     if (thread.is_idle_thread())
         return;
-    auto priority = thread_priority_to_priority_index(thread.priority());
+    auto priority = thread_priority_to_priority_index(thread.effective_priority());
+    auto cpu = ready_queues_processor_for(thread);
 
-    ScopedSpinLock lock(g_ready_queues_lock);
+    auto& ready_queues = g_ready_queues[cpu];
+    ScopedSpinLock lock(ready_queues.lock);
     VERIFY(thread.m_runnable_priority < 0);
     thread.m_runnable_priority = (int)priority;
+    thread.m_runnable_queue_cpu = cpu;
     VERIFY(!thread.m_ready_queue_node.is_in_list());
-    auto& ready_queue = g_ready_queues[priority];
+    auto& ready_queue = ready_queues.queues[priority];
     bool was_empty = ready_queue.thread_list.is_empty();
     ready_queue.thread_list.append(thread);
     if (was_empty)
-        g_ready_queues_mask |= (1u << priority);
+        ready_queues.mask |= (1u << priority);
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -439,7 +575,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
     RefPtr<Thread> idle_thread;
     g_finalizer_wait_queue = new WaitQueue;
-    g_ready_queues = new ThreadReadyQueue[g_ready_queue_buckets];
+    g_ready_queues = new ThreadReadyQueues[g_ready_queues_count];
 
     g_finalizer_has_work.store(false, AK::MemoryOrder::memory_order_release);
     s_colonel_process = Process::create_kernel_process(idle_thread, "colonel", idle_loop, nullptr, 1).leak_ref();
@@ -488,6 +624,29 @@ void Scheduler::timer_tick(const RegisterState& regs)
         return; // TODO: This prevents scheduling on other CPUs!
 #endif
 
+    auto& scheduler_data = Processor::current().get_scheduler_data();
+    if (++scheduler_data.m_ticks_in_realtime_window >= REALTIME_WINDOW_TICKS) {
+        bool was_throttled = scheduler_data.m_realtime_throttled;
+        scheduler_data.m_ticks_in_realtime_window = 0;
+        scheduler_data.m_realtime_ticks_in_realtime_window = 0;
+        scheduler_data.m_realtime_throttled = false;
+        // Let the real-time threads we've been holding back have their turn again.
+        if (was_throttled) {
+            Processor::current().invoke_scheduler_async();
+            (void)current_thread->tick();
+            return;
+        }
+    }
+    if (current_thread->effective_priority() > THREAD_PRIORITY_MAX && !scheduler_data.m_realtime_throttled) {
+        if (++scheduler_data.m_realtime_ticks_in_realtime_window >= REALTIME_RUNTIME_TICKS) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Throttling real-time threads for the rest of the window", Processor::id());
+            scheduler_data.m_realtime_throttled = true;
+            Processor::current().invoke_scheduler_async();
+            (void)current_thread->tick();
+            return;
+        }
+    }
+
     if (current_thread->tick())
         return;
 
@@ -536,9 +695,25 @@ void Scheduler::idle_loop(void*)
     dbgln("Scheduler[{}]: idle loop running", proc.get_id());
     VERIFY(are_interrupts_enabled());
 
+    bool tickless_idle = TimeManagement::the().is_tickless_idle_enabled();
+
     for (;;) {
         proc.idle_begin();
-        asm("hlt");
+        if (tickless_idle) {
+            cli();
+            bool stopped_tick = TimeManagement::the().enter_tickless_idle();
+            // NOTE: sti only takes effect after the next instruction, so no
+            // interrupt can sneak in between re-enabling interrupts and halting.
+            asm("sti\n"
+                "hlt");
+            if (stopped_tick) {
+                cli();
+                TimeManagement::the().exit_tickless_idle();
+                sti();
+            }
+        } else {
+            asm("hlt");
+        }
 
         proc.idle_end();
         VERIFY_INTERRUPTS_ENABLED();
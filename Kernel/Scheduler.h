@@ -50,6 +50,9 @@ public:
     static Thread& pull_next_runnable_thread();
     static bool dequeue_runnable_thread(Thread&, bool = false);
     static void queue_runnable_thread(Thread&);
+    // Makes the processor the thread is queued on switch to it as soon as possible, if it's more important than what's running there.
+    static void preempt_for(Thread&);
+    static u32 schedulable_processors_mask();
     static void dump_scheduler_state();
 };
 
@@ -9,8 +9,13 @@
 #include <AK/Atomic.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Debug.h>
 #include <Kernel/Forward.h>
 
+#if LOCK_STATISTICS
+#    include <Kernel/LockStatistics.h>
+#endif
+
 namespace Kernel {
 
 template<typename BaseType = u32>
@@ -21,19 +26,37 @@ class SpinLock {
 public:
     SpinLock() = default;
 
+#if LOCK_STATISTICS
+    ALWAYS_INLINE u32 lock(const SourceLocation& location = SourceLocation::current())
+#else
     ALWAYS_INLINE u32 lock()
+#endif
     {
         u32 prev_flags;
         Processor::current().enter_critical(prev_flags);
+#if LOCK_STATISTICS
+        Optional<u64> contended_since;
+        if (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
+            contended_since = LockStatistics::now();
+            while (m_lock.exchange(1, AK::memory_order_acquire) != 0)
+                Processor::wait_check();
+        }
+        m_statistics_site = LockStatistics::did_acquire(location, LockStatistics::LockType::SpinLock, nullptr, m_statistics_site, contended_since);
+        m_acquired_at = LockStatistics::now();
+#else
         while (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
             Processor::wait_check();
         }
+#endif
         return prev_flags;
     }
 
     ALWAYS_INLINE void unlock(u32 prev_flags)
     {
         VERIFY(is_locked());
+#if LOCK_STATISTICS
+        LockStatistics::did_release(m_statistics_site, m_acquired_at);
+#endif
         m_lock.store(0, AK::memory_order_release);
         Processor::current().leave_critical(prev_flags);
     }
@@ -50,6 +73,11 @@ public:
 
 private:
     Atomic<BaseType> m_lock { 0 };
+#if LOCK_STATISTICS
+    // Where the lock was taken, and when. Only the holder of the lock touches these.
+    LockStatistics::Site* m_statistics_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 class RecursiveSpinLock {
@@ -59,19 +87,38 @@ class RecursiveSpinLock {
 public:
     RecursiveSpinLock() = default;
 
+#if LOCK_STATISTICS
+    ALWAYS_INLINE u32 lock(const SourceLocation& location = SourceLocation::current())
+#else
     ALWAYS_INLINE u32 lock()
+#endif
     {
         auto& proc = Processor::current();
         FlatPtr cpu = FlatPtr(&proc);
         u32 prev_flags;
         proc.enter_critical(prev_flags);
         FlatPtr expected = 0;
+#if LOCK_STATISTICS
+        Optional<u64> contended_since;
+#endif
         while (!m_lock.compare_exchange_strong(expected, cpu, AK::memory_order_acq_rel)) {
             if (expected == cpu)
                 break;
+#if LOCK_STATISTICS
+            if (!contended_since.has_value())
+                contended_since = LockStatistics::now();
+#endif
             Processor::wait_check();
             expected = 0;
         }
+#if LOCK_STATISTICS
+        // NOTE: Taking the lock again doesn't count as holding it for longer.
+        auto* site = LockStatistics::did_acquire(location, LockStatistics::LockType::RecursiveSpinLock, nullptr, m_statistics_site, contended_since);
+        if (m_recursions == 0) {
+            m_statistics_site = site;
+            m_acquired_at = LockStatistics::now();
+        }
+#endif
         m_recursions++;
         return prev_flags;
     }
@@ -80,8 +127,12 @@ public:
     {
         VERIFY(m_recursions > 0);
         VERIFY(m_lock.load(AK::memory_order_relaxed) == FlatPtr(&Processor::current()));
-        if (--m_recursions == 0)
+        if (--m_recursions == 0) {
+#if LOCK_STATISTICS
+            LockStatistics::did_release(m_statistics_site, m_acquired_at);
+#endif
             m_lock.store(0, AK::memory_order_release);
+        }
         Processor::current().leave_critical(prev_flags);
     }
 
@@ -103,6 +154,10 @@ public:
 private:
     Atomic<FlatPtr> m_lock { 0 };
     u32 m_recursions { 0 };
+#if LOCK_STATISTICS
+    LockStatistics::Site* m_statistics_site { nullptr };
+    u64 m_acquired_at { 0 };
+#endif
 };
 
 template<typename LockType>
@@ -114,11 +169,19 @@ public:
     ScopedSpinLock() = delete;
     ScopedSpinLock& operator=(ScopedSpinLock&&) = delete;
 
+#if LOCK_STATISTICS
+    ScopedSpinLock(LockType& lock, const SourceLocation& location = SourceLocation::current())
+#else
     ScopedSpinLock(LockType& lock)
+#endif
         : m_lock(&lock)
     {
         VERIFY(m_lock);
+#if LOCK_STATISTICS
+        m_prev_flags = m_lock->lock(location);
+#else
         m_prev_flags = m_lock->lock();
+#endif
         m_have_lock = true;
     }
 
@@ -139,11 +202,19 @@ public:
         }
     }
 
+#if LOCK_STATISTICS
+    ALWAYS_INLINE void lock(const SourceLocation& location = SourceLocation::current())
+#else
     ALWAYS_INLINE void lock()
+#endif
     {
         VERIFY(m_lock);
         VERIFY(!m_have_lock);
+#if LOCK_STATISTICS
+        m_prev_flags = m_lock->lock(location);
+#else
         m_prev_flags = m_lock->lock();
+#endif
         m_have_lock = true;
     }
 
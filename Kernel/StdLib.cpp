@@ -203,6 +203,67 @@ Optional<u32> user_atomic_fetch_xor_relaxed(volatile u32* var, u32 val)
     return Kernel::safe_atomic_fetch_xor_relaxed(var, val);
 }
 
+// Copies and fills at least this big are worth stashing away the FPU state for.
+static constexpr size_t sse2_threshold = PAGE_SIZE;
+// How much we do in one go, since we can't take interrupts while we're using SSE.
+static constexpr size_t sse2_chunk_size = 64 * KiB;
+
+// NOTE: The kernel is built without SSE, so the compiler won't touch the XMM registers behind our back.
+//       These expect dest to be 16-byte aligned, and n to be a multiple of 64.
+static void sse2_memcpy(u8* dest, const u8* src, size_t n)
+{
+    for (; n; n -= 64, dest += 64, src += 64) {
+        asm volatile(
+            "movdqu 0(%1), %%xmm0\n"
+            "movdqu 16(%1), %%xmm1\n"
+            "movdqu 32(%1), %%xmm2\n"
+            "movdqu 48(%1), %%xmm3\n"
+            "movdqa %%xmm0, 0(%0)\n"
+            "movdqa %%xmm1, 16(%0)\n"
+            "movdqa %%xmm2, 32(%0)\n"
+            "movdqa %%xmm3, 48(%0)\n" ::"r"(dest),
+            "r"(src)
+            : "memory");
+    }
+}
+
+static void sse2_memset(u8* dest, u8 c, size_t n)
+{
+    alignas(16) u32 pattern[4];
+    for (auto& dword : pattern)
+        dword = explode_byte(c);
+    asm volatile("movdqa %0, %%xmm0" ::"m"(pattern));
+    for (; n; n -= 64, dest += 64) {
+        asm volatile(
+            "movdqa %%xmm0, 0(%0)\n"
+            "movdqa %%xmm0, 16(%0)\n"
+            "movdqa %%xmm0, 32(%0)\n"
+            "movdqa %%xmm0, 48(%0)\n" ::"r"(dest)
+            : "memory");
+    }
+}
+
+// Does the bulk of a big copy or fill with SSE2, and returns how many bytes it got through.
+// The caller takes care of the unaligned head and whatever's left at the end.
+template<typename Callback>
+static size_t do_with_sse2(FlatPtr dest, size_t n, Callback callback)
+{
+    size_t head = (16 - (dest & 0xf)) & 0xf;
+    if (n < sse2_threshold + head)
+        return 0;
+    size_t done = 0;
+    size_t bulk = (n - head) & ~(size_t)63;
+    while (done < bulk) {
+        size_t chunk = min(bulk - done, sse2_chunk_size);
+        Kernel::ScopedKernelFPUSection fpu_section;
+        if (!fpu_section.is_entered())
+            break;
+        callback(head + done, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
 extern "C" {
 
 bool copy_to_user(void* dest_ptr, const void* src_ptr, size_t n)
@@ -241,6 +302,19 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
     size_t src = (size_t)src_ptr;
+
+    if (n >= sse2_threshold) {
+        size_t head = (16 - (dest & 0xf)) & 0xf;
+        size_t done = do_with_sse2(dest, n, [&](size_t offset, size_t count) {
+            sse2_memcpy((u8*)dest + offset, (const u8*)src + offset, count);
+        });
+        if (done) {
+            memcpy(dest_ptr, src_ptr, head);
+            memcpy((u8*)dest_ptr + head + done, (const u8*)src_ptr + head + done, n - head - done);
+            return dest_ptr;
+        }
+    }
+
     // FIXME: Support starting at an unaligned address.
     if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
         size_t size_ts = n / sizeof(size_t);
@@ -293,6 +367,19 @@ const void* memmem(const void* haystack, size_t haystack_length, const void* nee
 void* memset(void* dest_ptr, int c, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
+
+    if (n >= sse2_threshold) {
+        size_t head = (16 - (dest & 0xf)) & 0xf;
+        size_t done = do_with_sse2(dest, n, [&](size_t offset, size_t count) {
+            sse2_memset((u8*)dest + offset, (u8)c, count);
+        });
+        if (done) {
+            memset(dest_ptr, c, head);
+            memset((u8*)dest_ptr + head + done, c, n - head - done);
+            return dest_ptr;
+        }
+    }
+
     // FIXME: Support starting at an unaligned address.
     if (!(dest & 0x3) && n >= 12) {
         size_t size_ts = n / sizeof(size_t);
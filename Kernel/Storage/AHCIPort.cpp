@@ -20,6 +20,11 @@
 
 namespace Kernel {
 
+// Every request gets one PRDT entry per DMA buffer page, so this bounds the size of a single request.
+static constexpr size_t DMA_BUFFER_PAGE_COUNT = 16;
+// Every queued command needs its own DMA buffers and command table, so we don't use all 32 slots.
+static constexpr size_t MAX_COMMAND_QUEUE_DEPTH = 8;
+
 NonnullRefPtr<AHCIPort> AHCIPort::create(const AHCIPortHandler& handler, volatile AHCI::PortRegisters& registers, u32 port_index)
 {
     return adopt_ref(*new AHCIPort(handler, registers, port_index));
@@ -45,16 +50,28 @@ AHCIPort::AHCIPort(const AHCIPortHandler& handler, volatile AHCI::PortRegisters&
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list page at {}", representative_port_index(), m_command_list_page->paddr());
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: FIS receive page at {}", representative_port_index(), m_command_list_page->paddr());
 
-    for (size_t index = 0; index < 1; index++) {
-        m_dma_buffers.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
-    for (size_t index = 0; index < 1; index++) {
-        m_command_table_pages.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
+    allocate_command_slots(1);
     m_command_list_region = MM.allocate_kernel_region(m_command_list_page->paddr(), PAGE_SIZE, "AHCI Port Command List", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list region at {}", representative_port_index(), m_command_list_region->vaddr());
 }
 
+bool AHCIPort::allocate_command_slots(size_t count)
+{
+    while (m_command_table_pages.size() < count) {
+        auto page = MM.allocate_supervisor_physical_page();
+        if (!page)
+            return false;
+        m_command_table_pages.append(page.release_nonnull());
+    }
+    while (m_dma_buffers.size() < count * DMA_BUFFER_PAGE_COUNT) {
+        auto page = MM.allocate_supervisor_physical_page();
+        if (!page)
+            return false;
+        m_dma_buffers.append(page.release_nonnull());
+    }
+    return true;
+}
+
 void AHCIPort::clear_sata_error_register() const
 {
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Clearing SATA error register.", representative_port_index());
@@ -85,6 +102,12 @@ void AHCIPort::handle_interrupt()
         });
         return;
     }
+    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::SDB) && m_command_queue_depth > 1) {
+        // The disk tells us about finished queued commands by clearing their PxSACT bits.
+        g_io_work->queue([this]() {
+            complete_queued_commands();
+        });
+    }
     if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS)) {
         m_wait_for_completion = false;
 
@@ -125,12 +148,25 @@ bool AHCIPort::is_interrupts_enabled() const
 void AHCIPort::recover_from_fatal_error()
 {
     Locker locker(m_lock);
-    ScopedSpinLock lock(m_hard_lock);
-    dmesgln("{}: AHCI Port {} fatal error, shutting down!", m_parent_handler->hba_controller()->pci_address(), representative_port_index());
-    dmesgln("{}: AHCI Port {} fatal error, SError {}", m_parent_handler->hba_controller()->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
-    stop_command_list_processing();
-    stop_fis_receiving();
-    m_interrupt_enable.clear();
+    {
+        ScopedSpinLock lock(m_hard_lock);
+        dmesgln("{}: AHCI Port {} fatal error, shutting down!", m_parent_handler->hba_controller()->pci_address(), representative_port_index());
+        dmesgln("{}: AHCI Port {} fatal error, SError {}", m_parent_handler->hba_controller()->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
+        stop_command_list_processing();
+        stop_fis_receiving();
+        m_interrupt_enable.clear();
+    }
+
+    // Nothing that was queued is going to finish now, so don't leave anyone waiting for it.
+    Vector<NonnullRefPtr<AsyncBlockDeviceRequest>, 32> failed_requests;
+    for (auto& command : m_queued_commands) {
+        if (!command.request)
+            continue;
+        failed_requests.append(command.request.release_nonnull());
+        command.scatter_list = nullptr;
+    }
+    for (auto& request : failed_requests)
+        request->complete(AsyncDeviceRequest::Failure);
 }
 
 void AHCIPort::eject()
@@ -290,7 +326,16 @@ bool AHCIPort::initialize(ScopedSpinLock<SpinLock<u8>>& main_lock)
             m_port_registers.cmd = m_port_registers.cmd | (1 << 24);
         }
 
-        dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size);
+        // Use native command queuing if both the HBA and the disk support it (word 76, bit 8).
+        m_command_queue_depth = 1;
+        if (!is_atapi_attached() && m_parent_handler->hba_capabilities().native_command_queuing_supported && (identify_block->serial_ata_capabilities & (1 << 8))) {
+            size_t device_queue_depth = (identify_block->queue_depth & 0x1f) + 1;
+            size_t queue_depth = min(min(device_queue_depth, m_parent_handler->hba_capabilities().max_command_list_entries_count), MAX_COMMAND_QUEUE_DEPTH);
+            if (queue_depth > 1 && allocate_command_slots(queue_depth))
+                m_command_queue_depth = queue_depth;
+        }
+
+        dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}, Queue depth={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size, m_command_queue_depth);
 
         // FIXME: We don't support ATAPI devices yet, so for now we don't "create" them
         if (!is_atapi_attached()) {
@@ -420,25 +465,39 @@ void AHCIPort::set_sleep_state() const
     m_port_registers.cmd = (m_port_registers.cmd & 0x0ffffff) | (0b1000 << 28);
 }
 
+size_t AHCIPort::max_blocks_per_request() const
+{
+    VERIFY(m_connected_device);
+    // NOTE: access_device() takes the block count as a u8.
+    return min(DMA_BUFFER_PAGE_COUNT * PAGE_SIZE / m_connected_device->block_size(), (size_t)NumericLimits<u8>::max());
+}
+
 size_t AHCIPort::calculate_descriptors_count(size_t block_count) const
 {
     VERIFY(m_connected_device);
     size_t needed_dma_regions_count = page_round_up((block_count * m_connected_device->block_size())) / PAGE_SIZE;
-    VERIFY(needed_dma_regions_count <= m_dma_buffers.size());
+    VERIFY(needed_dma_regions_count <= DMA_BUFFER_PAGE_COUNT);
     return needed_dma_regions_count;
 }
 
-Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+RefPtr<ScatterGatherList> AHCIPort::create_scatter_list(AsyncBlockDeviceRequest& request, u8 command_slot)
 {
     VERIFY(m_lock.is_locked());
     VERIFY(request.block_count() > 0);
 
+    // Every command slot has its own set of DMA buffers.
     NonnullRefPtrVector<PhysicalPage> allocated_dma_regions;
+    size_t first_dma_buffer_index = command_slot * DMA_BUFFER_PAGE_COUNT;
     for (size_t index = 0; index < calculate_descriptors_count(request.block_count()); index++) {
-        allocated_dma_regions.append(m_dma_buffers.at(index));
+        allocated_dma_regions.append(m_dma_buffers.at(first_dma_buffer_index + index));
     }
+    return ScatterGatherList::create(request, move(allocated_dma_regions), m_connected_device->block_size(), "AHCI Scattered DMA");
+}
 
-    m_current_scatter_list = ScatterGatherList::create(request, move(allocated_dma_regions), m_connected_device->block_size());
+Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+{
+    VERIFY(m_lock.is_locked());
+    m_current_scatter_list = create_scatter_list(request, 0);
     if (!m_current_scatter_list)
         return AsyncDeviceRequest::Failure;
     if (request.request_type() == AsyncBlockDeviceRequest::Write) {
@@ -451,6 +510,11 @@ Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_li
 
 void AHCIPort::start_request(AsyncBlockDeviceRequest& request)
 {
+    if (m_command_queue_depth > 1) {
+        start_queued_request(request);
+        return;
+    }
+
     Locker locker(m_lock);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start", representative_port_index());
     VERIFY(!m_current_request);
@@ -483,6 +547,151 @@ void AHCIPort::complete_current_request(AsyncDeviceRequest::RequestResult result
     current_request->complete(result);
 }
 
+void AHCIPort::start_queued_request(AsyncBlockDeviceRequest& request)
+{
+    Locker locker(m_lock);
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Queued request start", representative_port_index());
+
+    if (!is_operable()) {
+        locker.unlock();
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+
+    // NOTE: The Device never starts more requests than our queue depth, so there's always a free tag.
+    Optional<u8> tag;
+    for (size_t index = 0; index < m_command_queue_depth; index++) {
+        if (!m_queued_commands[index].request) {
+            tag = index;
+            break;
+        }
+    }
+    VERIFY(tag.has_value());
+
+    auto scatter_list = create_scatter_list(request, tag.value());
+    if (!scatter_list) {
+        locker.unlock();
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+    if (request.request_type() == AsyncBlockDeviceRequest::Write) {
+        if (!request.read_from_buffer(request.buffer(), scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count())) {
+            locker.unlock();
+            request.complete(AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+
+    auto& command = m_queued_commands[tag.value()];
+    command.request = request;
+    command.scatter_list = move(scatter_list);
+    if (!issue_queued_command(tag.value())) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Queued request failure.", representative_port_index());
+        command = {};
+        locker.unlock();
+        request.complete(AsyncDeviceRequest::Failure);
+    }
+}
+
+bool AHCIPort::issue_queued_command(u8 tag)
+{
+    VERIFY(m_connected_device);
+    VERIFY(is_operable());
+    VERIFY(m_lock.is_locked());
+    auto& command = m_queued_commands[tag];
+    VERIFY(command.request);
+    VERIFY(command.scatter_list);
+    ScopedSpinLock lock(m_hard_lock);
+
+    auto& request = *command.request;
+    auto direction = request.request_type();
+    auto lba = request.block_index();
+    auto block_count = request.block_count();
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Queue a {}, tag {}, lba {}, block count {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", tag, lba, block_count);
+
+    auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
+    command_list_entries[tag].ctba = m_command_table_pages[tag].paddr().get();
+    command_list_entries[tag].ctbau = 0;
+    command_list_entries[tag].prdbc = 0;
+    command_list_entries[tag].prdtl = command.scatter_list->scatters_count();
+    // NOTE: The AHCI specification doesn't allow the P bit to be set for queued commands.
+    command_list_entries[tag].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
+
+    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[tag].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+    if (!command_table_region)
+        return false;
+    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    memset(const_cast<u8*>(command_table.command_fis), 0, 64);
+    memset(const_cast<u8*>(command_table.atapi_command), 0, 32);
+
+    size_t scatter_entry_index = 0;
+    size_t data_transfer_count = block_count * m_connected_device->block_size();
+    for (auto scatter_page : command.scatter_list->vmobject().physical_pages()) {
+        VERIFY(data_transfer_count != 0);
+        VERIFY(scatter_page);
+        size_t byte_count = min(data_transfer_count, (size_t)PAGE_SIZE);
+        command_table.descriptors[scatter_entry_index].base_high = 0;
+        command_table.descriptors[scatter_entry_index].base_low = scatter_page->paddr().get();
+        command_table.descriptors[scatter_entry_index].byte_count = byte_count - 1;
+        data_transfer_count -= byte_count;
+        scatter_entry_index++;
+    }
+
+    // READ/WRITE FPDMA QUEUED carry the sector count in the features field, and the tag in bits 7:3 of the count field.
+    auto& fis = *(volatile FIS::HostToDevice::Register*)command_table.command_fis;
+    fis.header.fis_type = (u8)FIS::Type::RegisterHostToDevice;
+    fis.header.port_muliplier = (u8)FIS::HeaderAttributes::C;
+    fis.command = direction == AsyncBlockDeviceRequest::RequestType::Write ? ATA_CMD_WRITE_FPDMA_QUEUED : ATA_CMD_READ_FPDMA_QUEUED;
+    fis.features_low = block_count & 0xff;
+    fis.features_high = (block_count >> 8) & 0xff;
+    fis.count = tag << 3;
+    fis.device = ATA_USE_LBA_ADDRESSING;
+    fis.lba_high[0] = (lba >> 24) & 0xff;
+    fis.lba_high[1] = (lba >> 32) & 0xff;
+    fis.lba_high[2] = (lba >> 40) & 0xff;
+    fis.lba_low[0] = lba & 0xff;
+    fis.lba_low[1] = (lba >> 8) & 0xff;
+    fis.lba_low[2] = (lba >> 16) & 0xff;
+
+    full_memory_barrier();
+    // The tag has to be marked active in PxSACT before the command is issued.
+    m_port_registers.sact = 1u << tag;
+    m_port_registers.ci = 1u << tag;
+    full_memory_barrier();
+    return true;
+}
+
+void AHCIPort::complete_queued_commands()
+{
+    Locker locker(m_lock);
+
+    Vector<NonnullRefPtr<AsyncBlockDeviceRequest>, 32> finished_requests;
+    Vector<AsyncDeviceRequest::RequestResult, 32> results;
+    {
+        u32 active_tags = m_port_registers.sact | m_port_registers.ci;
+        for (size_t tag = 0; tag < m_command_queue_depth; tag++) {
+            auto& command = m_queued_commands[tag];
+            if (!command.request || (active_tags & (1u << tag)))
+                continue;
+            auto request = command.request.release_nonnull();
+            auto scatter_list = move(command.scatter_list);
+            auto result = AsyncDeviceRequest::Success;
+            if (request->request_type() == AsyncBlockDeviceRequest::Read) {
+                if (!request->write_to_buffer(request->buffer(), scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request->block_count())) {
+                    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Queued request failure, memory fault occurred when reading in data.", representative_port_index());
+                    result = AsyncDeviceRequest::MemoryFault;
+                }
+            }
+            finished_requests.append(move(request));
+            results.append(result);
+        }
+    }
+
+    // NOTE: Completing a request may start the next one, which could then reuse a tag we just looked at.
+    for (size_t i = 0; i < finished_requests.size(); i++)
+        finished_requests[i]->complete(results[i]);
+}
+
 bool AHCIPort::spin_until_ready() const
 {
     VERIFY(m_lock.is_locked());
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <Kernel/Devices/Device.h>
@@ -43,6 +44,9 @@ public:
     bool is_atapi_attached() const { return m_port_registers.sig == (u32)AHCI::DeviceSignature::ATAPI; };
 
     RefPtr<StorageDevice> connected_device() const { return m_connected_device; }
+    size_t max_blocks_per_request() const;
+    // With native command queuing, this many requests can be in flight at once.
+    size_t command_queue_depth() const { return m_command_queue_depth; }
 
     bool reset();
     UNMAP_AFTER_INIT bool initialize_without_reset();
@@ -72,8 +76,14 @@ private:
     void complete_current_request(AsyncDeviceRequest::RequestResult);
     bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
     size_t calculate_descriptors_count(size_t block_count) const;
+    RefPtr<ScatterGatherList> create_scatter_list(AsyncBlockDeviceRequest&, u8 command_slot);
     [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
 
+    bool allocate_command_slots(size_t count);
+    void start_queued_request(AsyncBlockDeviceRequest&);
+    bool issue_queued_command(u8 tag);
+    void complete_queued_commands();
+
     ALWAYS_INLINE bool is_interrupts_enabled() const;
 
     bool spin_until_ready() const;
@@ -120,6 +130,15 @@ private:
     AHCI::PortInterruptEnableBitField m_interrupt_enable;
 
     RefPtr<ScatterGatherList> m_current_scatter_list;
+
+    // NOTE: We use the command slot index as the NCQ tag.
+    struct QueuedCommand {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        RefPtr<ScatterGatherList> scatter_list;
+    };
+    Array<QueuedCommand, 32> m_queued_commands;
+    size_t m_command_queue_depth { 1 };
+
     bool m_disabled_by_firmware { false };
 };
 }
@@ -29,7 +29,15 @@ AHCIPortHandler::AHCIPortHandler(AHCIController& controller, u8 irq, AHCI::Maske
 
     // Clear pending interrupts, if there are any!
     m_pending_ports_interrupts.set_all();
-    enable_irq();
+    m_message_signaled_interrupts = PCI::MessageSignaledInterrupts::try_create(controller.pci_address(), 1, purpose());
+    if (m_message_signaled_interrupts) {
+        m_message_signaled_interrupts->set_handler(0, [this](auto& regs) {
+            handle_irq(regs);
+        });
+        m_message_signaled_interrupts->enable();
+    } else {
+        enable_irq();
+    }
 
     if (kernel_command_line().ahci_reset_mode() == AHCIResetMode::Aggressive) {
         for (auto index : taken_ports.to_vector()) {
@@ -12,6 +12,7 @@
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Lock.h>
+#include <Kernel/PCI/MSI.h>
 #include <Kernel/PhysicalAddress.h>
 #include <Kernel/Random.h>
 #include <Kernel/Storage/AHCIController.h>
@@ -69,5 +70,7 @@ private:
     NonnullRefPtrVector<PhysicalPage> m_identify_metadata_pages;
     AHCI::MaskedBitField m_taken_ports;
     AHCI::MaskedBitField m_pending_ports_interrupts;
+    // Used instead of the interrupt pin if the controller can do it.
+    OwnPtr<PCI::MessageSignaledInterrupts> m_message_signaled_interrupts;
 };
 }
@@ -11,6 +11,9 @@
 
 namespace Kernel {
 
+// Every DMA buffer page gets its own PRDT entry, so this bounds the size of a single request.
+static constexpr size_t DMA_BUFFER_PAGE_COUNT = 16;
+
 UNMAP_AFTER_INIT NonnullRefPtr<BMIDEChannel> BMIDEChannel::create(const IDEController& ide_controller, IDEChannel::IOAddressGroup io_group, IDEChannel::ChannelType type)
 {
     return adopt_ref(*new BMIDEChannel(ide_controller, io_group, type));
@@ -38,18 +41,65 @@ UNMAP_AFTER_INIT void BMIDEChannel::initialize()
     VERIFY(m_io_group.bus_master_base().has_value());
     // Let's try to set up DMA transfers.
     PCI::enable_bus_mastering(m_parent_controller->pci_address());
+    auto fall_back_to_pio = [&] {
+        dbgln("BMIDEChannel: Couldn't set up DMA, falling back to PIO");
+        m_prdt_page = nullptr;
+        m_dma_buffer_pages.clear();
+    };
     m_prdt_page = MM.allocate_supervisor_physical_page();
-    m_dma_buffer_page = MM.allocate_supervisor_physical_page();
-    if (m_dma_buffer_page.is_null() || m_prdt_page.is_null())
-        return;
+    if (m_prdt_page.is_null())
+        return fall_back_to_pio();
+    for (size_t index = 0; index < DMA_BUFFER_PAGE_COUNT; index++) {
+        auto page = MM.allocate_supervisor_physical_page();
+        if (page.is_null())
+            return fall_back_to_pio();
+        m_dma_buffer_pages.append(page.release_nonnull());
+    }
     m_prdt_region = MM.allocate_kernel_region(m_prdt_page->paddr(), PAGE_SIZE, "IDE PRDT", Region::Access::Read | Region::Access::Write);
-    m_dma_buffer_region = MM.allocate_kernel_region(m_dma_buffer_page->paddr(), PAGE_SIZE, "IDE DMA region", Region::Access::Read | Region::Access::Write);
-    prdt().end_of_table = 0x8000;
+    if (!m_prdt_region)
+        return fall_back_to_pio();
+    m_dma_available = true;
 
     // clear bus master interrupt status
     m_io_group.bus_master_base().value().offset(2).out<u8>(m_io_group.bus_master_base().value().offset(2).in<u8>() | 4);
 }
 
+size_t BMIDEChannel::max_sectors_per_request() const
+{
+    if (!m_dma_available)
+        return IDEChannel::max_sectors_per_request();
+    return m_dma_buffer_pages.size() * PAGE_SIZE / 512;
+}
+
+bool BMIDEChannel::prepare_scatter_list()
+{
+    VERIFY(m_current_request);
+    VERIFY(!m_current_scatter_list);
+    size_t transfer_size = 512 * m_current_request->block_count();
+    size_t page_count = page_round_up(transfer_size) / PAGE_SIZE;
+    VERIFY(page_count <= m_dma_buffer_pages.size());
+
+    NonnullRefPtrVector<PhysicalPage> pages;
+    for (size_t index = 0; index < page_count; index++)
+        pages.append(m_dma_buffer_pages[index]);
+    m_current_scatter_list = ScatterGatherList::create(*m_current_request, move(pages), 512, "IDE Scattered DMA");
+    if (!m_current_scatter_list)
+        return false;
+
+    // One descriptor per page, the last one covering whatever is left of the transfer.
+    size_t index = 0;
+    for (auto& page : m_current_scatter_list->vmobject().physical_pages()) {
+        VERIFY(page);
+        prdt()[index].offset = page->paddr().get();
+        prdt()[index].size = min(transfer_size, (size_t)PAGE_SIZE);
+        prdt()[index].end_of_table = 0;
+        transfer_size -= prdt()[index].size;
+        index++;
+    }
+    prdt()[index - 1].end_of_table = 0x8000;
+    return true;
+}
+
 static void print_ide_status(u8 status)
 {
     dbgln("BMIDEChannel: print_ide_status: DRQ={} BSY={}, DRDY={}, DSC={}, DF={}, CORR={}, IDX={}, ERR={}",
@@ -63,8 +113,11 @@ static void print_ide_status(u8 status)
         (status & ATA_SR_ERR) != 0);
 }
 
-void BMIDEChannel::handle_irq(const RegisterState&)
+void BMIDEChannel::handle_irq(const RegisterState& regs)
 {
+    if (!m_dma_available)
+        return IDEChannel::handle_irq(regs);
+
     u8 status = m_io_group.io_base().offset(ATA_REG_STATUS).in<u8>();
 
     m_entropy_source.add_random_event(status);
@@ -119,9 +172,12 @@ void BMIDEChannel::complete_current_request(AsyncDeviceRequest::RequestResult re
         auto current_request = m_current_request;
         m_current_request.clear();
 
+        auto scatter_list = move(m_current_scatter_list);
+
         if (result == AsyncDeviceRequest::Success) {
             if (current_request->request_type() == AsyncBlockDeviceRequest::Read) {
-                if (!current_request->write_to_buffer(current_request->buffer(), m_dma_buffer_region->vaddr().as_ptr(), 512 * current_request->block_count())) {
+                VERIFY(scatter_list);
+                if (!current_request->write_to_buffer(current_request->buffer(), scatter_list->dma_region().as_ptr(), 512 * current_request->block_count())) {
                     lock.unlock();
                     current_request->complete(AsyncDeviceRequest::MemoryFault);
                     return;
@@ -140,6 +196,9 @@ void BMIDEChannel::complete_current_request(AsyncDeviceRequest::RequestResult re
 
 void BMIDEChannel::ata_write_sectors(bool slave_request, u16 capabilities)
 {
+    if (!m_dma_available)
+        return IDEChannel::ata_write_sectors(slave_request, capabilities);
+
     VERIFY(m_lock.is_locked());
     VERIFY(!m_current_request.is_null());
     VERIFY(m_current_request->block_count() <= 256);
@@ -147,10 +206,12 @@ void BMIDEChannel::ata_write_sectors(bool slave_request, u16 capabilities)
     ScopedSpinLock m_lock(m_request_lock);
     dbgln_if(PATA_DEBUG, "BMIDEChannel::ata_write_sectors ({} x {})", m_current_request->block_index(), m_current_request->block_count());
 
-    prdt().offset = m_dma_buffer_page->paddr().get();
-    prdt().size = 512 * m_current_request->block_count();
+    if (!prepare_scatter_list()) {
+        complete_current_request(AsyncDeviceRequest::Failure);
+        return;
+    }
 
-    if (!m_current_request->read_from_buffer(m_current_request->buffer(), m_dma_buffer_region->vaddr().as_ptr(), 512 * m_current_request->block_count())) {
+    if (!m_current_request->read_from_buffer(m_current_request->buffer(), m_current_scatter_list->dma_region().as_ptr(), 512 * m_current_request->block_count())) {
         complete_current_request(AsyncDeviceRequest::MemoryFault);
         return;
     }
@@ -160,7 +221,6 @@ void BMIDEChannel::ata_write_sectors(bool slave_request, u16 capabilities)
     m_io_group.io_base().offset(ATA_REG_HDDEVSEL).out<u8>(0xA0 | ((slave_request ? 1 : 0) << 4));
     IO::delay(10);
 
-    VERIFY(prdt().size <= PAGE_SIZE);
     VERIFY(m_io_group.bus_master_base().has_value());
     // Stop bus master
     m_io_group.bus_master_base().value().out<u8>(0);
@@ -179,6 +239,9 @@ void BMIDEChannel::ata_write_sectors(bool slave_request, u16 capabilities)
 
 void BMIDEChannel::send_ata_io_command(LBAMode lba_mode, Direction direction) const
 {
+    if (!m_dma_available)
+        return IDEChannel::send_ata_io_command(lba_mode, direction);
+
     if (lba_mode != LBAMode::FortyEightBit) {
         m_io_group.io_base().offset(ATA_REG_COMMAND).out<u8>(direction == Direction::Read ? ATA_CMD_READ_DMA : ATA_CMD_WRITE_DMA);
     } else {
@@ -188,6 +251,9 @@ void BMIDEChannel::send_ata_io_command(LBAMode lba_mode, Direction direction) co
 
 void BMIDEChannel::ata_read_sectors(bool slave_request, u16 capabilities)
 {
+    if (!m_dma_available)
+        return IDEChannel::ata_read_sectors(slave_request, capabilities);
+
     VERIFY(m_lock.is_locked());
     VERIFY(!m_current_request.is_null());
     VERIFY(m_current_request->block_count() <= 256);
@@ -200,10 +266,10 @@ void BMIDEChannel::ata_read_sectors(bool slave_request, u16 capabilities)
     m_io_group.io_base().offset(ATA_REG_HDDEVSEL).out<u8>(0xA0 | ((slave_request ? 1 : 0) << 4));
     IO::delay(10);
 
-    prdt().offset = m_dma_buffer_page->paddr().get();
-    prdt().size = 512 * m_current_request->block_count();
-
-    VERIFY(prdt().size <= PAGE_SIZE);
+    if (!prepare_scatter_list()) {
+        complete_current_request(AsyncDeviceRequest::Failure);
+        return;
+    }
 
     VERIFY(m_io_group.bus_master_base().has_value());
     // Stop bus master
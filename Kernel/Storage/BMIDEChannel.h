@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <Kernel/Storage/IDEChannel.h>
+#include <Kernel/VM/ScatterGatherList.h>
 
 namespace Kernel {
 
@@ -29,7 +31,8 @@ public:
     static NonnullRefPtr<BMIDEChannel> create(const IDEController&, u8 irq, IDEChannel::IOAddressGroup, IDEChannel::ChannelType type);
     virtual ~BMIDEChannel() override {};
 
-    virtual bool is_dma_enabled() const override { return true; };
+    virtual bool is_dma_enabled() const override { return m_dma_available; };
+    virtual size_t max_sectors_per_request() const override;
 
 private:
     BMIDEChannel(const IDEController&, IDEChannel::IOAddressGroup, IDEChannel::ChannelType type);
@@ -37,6 +40,7 @@ private:
     void initialize();
 
     void complete_current_request(AsyncDeviceRequest::RequestResult);
+    [[nodiscard]] bool prepare_scatter_list();
 
     //^ IRQHandler
     virtual void handle_irq(const RegisterState&) override;
@@ -46,10 +50,12 @@ private:
     virtual void ata_read_sectors(bool, u16);
     virtual void ata_write_sectors(bool, u16);
 
-    PhysicalRegionDescriptor& prdt() { return *reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_region->vaddr().as_ptr()); }
+    PhysicalRegionDescriptor* prdt() { return reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_region->vaddr().as_ptr()); }
     OwnPtr<Region> m_prdt_region;
-    OwnPtr<Region> m_dma_buffer_region;
     RefPtr<PhysicalPage> m_prdt_page;
-    RefPtr<PhysicalPage> m_dma_buffer_page;
+    NonnullRefPtrVector<PhysicalPage> m_dma_buffer_pages;
+    RefPtr<ScatterGatherList> m_current_scatter_list;
+    // NOTE: If the PRDT or the DMA buffers couldn't be allocated, everything goes through the PIO paths of IDEChannel.
+    bool m_dma_available { false };
 };
 }
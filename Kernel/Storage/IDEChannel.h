@@ -102,6 +102,8 @@ public:
     virtual const char* purpose() const override { return "PATA Channel"; }
 
     virtual bool is_dma_enabled() const { return false; }
+    // NOTE: PIO transfers go one sector per interrupt, so this only bounds how much a single command asks for.
+    virtual size_t max_sectors_per_request() const { return 128; }
 
 private:
     void complete_current_request(AsyncDeviceRequest::RequestResult);
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel::NVMe {
+
+enum class Limits : u16 {
+    AdminQueueEntries = 32,
+    IOQueueEntries = 64,
+};
+
+// Controller registers live at the start of BAR0, the doorbells follow at 0x1000.
+struct [[gnu::packed]] ControllerRegisters {
+    u64 cap;   /* Controller Capabilities */
+    u32 vs;    /* Version */
+    u32 intms; /* Interrupt Mask Set */
+    u32 intmc; /* Interrupt Mask Clear */
+    u32 cc;    /* Controller Configuration */
+    u32 reserved;
+    u32 csts; /* Controller Status */
+    u32 nssr; /* NVM Subsystem Reset */
+    u32 aqa;  /* Admin Queue Attributes */
+    u64 asq;  /* Admin Submission Queue Base Address */
+    u64 acq;  /* Admin Completion Queue Base Address */
+};
+
+static constexpr size_t doorbells_offset = 0x1000;
+
+namespace Capabilities {
+constexpr u64 max_queue_entries(u64 cap) { return (cap & 0xffff) + 1; }
+constexpr u64 timeout_in_milliseconds(u64 cap) { return ((cap >> 24) & 0xff) * 500; }
+constexpr u64 doorbell_stride(u64 cap) { return (u64)4 << ((cap >> 32) & 0xf); }
+}
+
+enum ControllerConfiguration : u32 {
+    Enable = 1 << 0,
+    // NOTE: These are the log2 of the entry sizes, 64 bytes for submissions and 16 bytes for completions.
+    IOSubmissionQueueEntrySize = 6 << 16,
+    IOCompletionQueueEntrySize = 4 << 20,
+};
+
+enum ControllerStatus : u32 {
+    Ready = 1 << 0,
+    FatalStatus = 1 << 1,
+};
+
+enum class AdminCommand : u8 {
+    DeleteIOSubmissionQueue = 0x00,
+    CreateIOSubmissionQueue = 0x01,
+    DeleteIOCompletionQueue = 0x04,
+    CreateIOCompletionQueue = 0x05,
+    Identify = 0x06,
+    SetFeatures = 0x09,
+};
+
+enum class IOCommand : u8 {
+    Write = 0x01,
+    Read = 0x02,
+};
+
+enum class IdentifyStructure : u32 {
+    Namespace = 0x00,
+    Controller = 0x01,
+    ActiveNamespaceList = 0x02,
+};
+
+enum class Feature : u32 {
+    NumberOfQueues = 0x07,
+};
+
+// Queue flags for the Create I/O Completion/Submission Queue commands.
+enum QueueFlags : u32 {
+    PhysicallyContiguous = 1 << 0,
+    InterruptsEnabled = 1 << 1,
+};
+
+struct [[gnu::packed]] SubmissionQueueEntry {
+    u8 opcode;
+    u8 flags;
+    u16 command_id;
+    u32 namespace_id;
+    u32 reserved[2];
+    u64 metadata_pointer;
+    u64 data_pointer[2];     /* PRP Entry 1 and 2 */
+    u32 command_specific[6]; /* Command Dword 10 to 15 */
+};
+static_assert(sizeof(SubmissionQueueEntry) == 64);
+
+struct [[gnu::packed]] CompletionQueueEntry {
+    u32 command_specific;
+    u32 reserved;
+    u16 submission_queue_head;
+    u16 submission_queue_id;
+    u16 command_id;
+    u16 status; /* Bit 0 - Phase Tag, Bit 1 to 15 - Status Field */
+};
+static_assert(sizeof(CompletionQueueEntry) == 16);
+
+constexpr bool is_successful_status(u16 status) { return (status >> 1) == 0; }
+
+// We only look at a few fields of the Identify Controller data structure.
+namespace IdentifyController {
+static constexpr size_t serial_number_offset = 4;
+static constexpr size_t serial_number_length = 20;
+static constexpr size_t model_number_offset = 24;
+static constexpr size_t model_number_length = 40;
+static constexpr size_t maximum_data_transfer_size_offset = 77;
+}
+
+struct [[gnu::packed]] LBAFormat {
+    u16 metadata_size;
+    u8 lba_data_size; /* log2 of the logical block size */
+    u8 relative_performance;
+};
+
+struct [[gnu::packed]] IdentifyNamespace {
+    u64 size;
+    u64 capacity;
+    u64 utilization;
+    u8 features;
+    u8 lba_formats_count;
+    u8 formatted_lba_size; /* Bit 0 to 3 - Index into lba_formats */
+    u8 reserved[101];
+    LBAFormat lba_formats[16];
+};
+
+}
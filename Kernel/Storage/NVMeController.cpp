@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Debug.h>
+#include <Kernel/IO.h>
+#include <Kernel/Storage/NVMeController.h>
+#include <Kernel/Storage/NVMeNameSpace.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// More queues than this don't buy us anything, each CPU only ever submits to one of them.
+static constexpr size_t MAX_IO_QUEUES = 4;
+
+static size_t s_controller_count;
+
+static NonnullOwnPtr<Region> map_controller_registers(PCI::Address address)
+{
+    PhysicalAddress registers_address(PCI::get_BAR0(address) & ~0xf);
+    // We need to know the doorbell stride before we know how much to map.
+    u64 capabilities;
+    {
+        auto region = MM.allocate_kernel_region(registers_address.page_base(), PAGE_SIZE, "NVMe Controller Registers", Region::Access::Read, Region::Cacheable::No);
+        VERIFY(region);
+        capabilities = ((volatile NVMe::ControllerRegisters*)region->vaddr().as_ptr())->cap;
+    }
+    size_t size = NVMe::doorbells_offset + 2 * (MAX_IO_QUEUES + 1) * NVMe::Capabilities::doorbell_stride(capabilities);
+    auto region = MM.allocate_kernel_region(registers_address.page_base(), page_round_up(size), "NVMe Controller Registers", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+    return region.release_nonnull();
+}
+
+UNMAP_AFTER_INIT RefPtr<NVMeController> NVMeController::initialize(PCI::Address address)
+{
+    auto controller = adopt_ref(*new NVMeController(address, s_controller_count));
+    if (!controller->initialize())
+        return {};
+    s_controller_count++;
+    return controller;
+}
+
+UNMAP_AFTER_INIT NVMeController::NVMeController(PCI::Address address, size_t controller_index)
+    : PCI::DeviceController(address)
+    , IRQHandler(PCI::get_interrupt_line(address))
+    , m_registers_region(map_controller_registers(address))
+    , m_controller_index(controller_index)
+{
+}
+
+NVMeController::~NVMeController()
+{
+}
+
+volatile u32* NVMeController::submission_doorbell(u16 queue_id) const
+{
+    VERIFY(queue_id <= MAX_IO_QUEUES);
+    return (volatile u32*)(m_registers_region->vaddr().as_ptr() + NVMe::doorbells_offset + (2 * queue_id) * NVMe::Capabilities::doorbell_stride(m_capabilities));
+}
+
+volatile u32* NVMeController::completion_doorbell(u16 queue_id) const
+{
+    VERIFY(queue_id <= MAX_IO_QUEUES);
+    return (volatile u32*)(m_registers_region->vaddr().as_ptr() + NVMe::doorbells_offset + (2 * queue_id + 1) * NVMe::Capabilities::doorbell_stride(m_capabilities));
+}
+
+bool NVMeController::wait_for_ready(bool ready) const
+{
+    size_t timeout = NVMe::Capabilities::timeout_in_milliseconds(m_capabilities);
+    for (size_t elapsed = 0; elapsed <= timeout; elapsed++) {
+        u32 status = registers().csts;
+        if (status & NVMe::ControllerStatus::FatalStatus)
+            return false;
+        if (!!(status & NVMe::ControllerStatus::Ready) == ready)
+            return true;
+        IO::delay(1000);
+    }
+    return false;
+}
+
+bool NVMeController::reset()
+{
+    registers().cc = registers().cc & ~NVMe::ControllerConfiguration::Enable;
+    full_memory_barrier();
+    if (!wait_for_ready(false))
+        return false;
+    dbgln_if(NVME_DEBUG, "{}: NVMe Controller reset", pci_address());
+    return true;
+}
+
+bool NVMeController::shutdown()
+{
+    TODO();
+}
+
+Optional<NVMe::CompletionQueueEntry> NVMeController::submit_admin_command(NVMe::SubmissionQueueEntry& entry)
+{
+    auto completion = m_admin_queue->submit_and_wait(entry, NVMe::Capabilities::timeout_in_milliseconds(m_capabilities));
+    if (!completion.has_value())
+        return {};
+    if (!NVMe::is_successful_status(completion->status)) {
+        dbgln("{}: NVMe admin command {:#02x} failed with status {:#04x}", pci_address(), entry.opcode, completion->status >> 1);
+        return {};
+    }
+    return completion;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::initialize()
+{
+    m_capabilities = registers().cap;
+    dbgln_if(NVME_DEBUG, "{}: NVMe Controller Version = 0x{:08x}, Capabilities = 0x{:016x}", pci_address(), (u32)registers().vs, m_capabilities);
+
+    if (!reset()) {
+        dmesgln("{}: NVMe controller reset failed", pci_address());
+        return false;
+    }
+
+    PCI::enable_bus_mastering(pci_address());
+
+    size_t admin_queue_entries = min((u64)NVMe::Limits::AdminQueueEntries, NVMe::Capabilities::max_queue_entries(m_capabilities));
+    m_admin_queue = NVMeQueue::create(0, admin_queue_entries, submission_doorbell(0), completion_doorbell(0));
+    m_identify_region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "NVMe Identify", Region::Access::Read | Region::Access::Write);
+    if (!m_admin_queue || !m_identify_region)
+        return false;
+
+    registers().aqa = (admin_queue_entries - 1) << 16 | (admin_queue_entries - 1);
+    registers().asq = m_admin_queue->submission_queue_address().get();
+    registers().acq = m_admin_queue->completion_queue_address().get();
+    // NOTE: Leaving CC.MPS at zero selects 4 KiB memory pages, which is what our PRP entries describe.
+    registers().cc = NVMe::ControllerConfiguration::IOSubmissionQueueEntrySize | NVMe::ControllerConfiguration::IOCompletionQueueEntrySize | NVMe::ControllerConfiguration::Enable;
+    full_memory_barrier();
+    if (!wait_for_ready(true)) {
+        dmesgln("{}: NVMe controller failed to become ready", pci_address());
+        return false;
+    }
+
+    if (!identify_controller() || !create_io_queues())
+        return false;
+    identify_namespaces();
+
+    if (m_message_signaled_interrupts) {
+        m_message_signaled_interrupts->enable();
+    } else {
+        PCI::enable_interrupt_line(pci_address());
+        enable_irq();
+    }
+    return true;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::identify_controller()
+{
+    NVMe::SubmissionQueueEntry entry {};
+    entry.opcode = (u8)NVMe::AdminCommand::Identify;
+    entry.data_pointer[0] = m_identify_region->physical_page(0)->paddr().get();
+    entry.command_specific[0] = (u32)NVMe::IdentifyStructure::Controller;
+    if (!submit_admin_command(entry).has_value())
+        return false;
+
+    auto* data = m_identify_region->vaddr().as_ptr();
+    // The maximum data transfer size is a power of two in units of the minimum memory page size, zero means no limit.
+    u8 maximum_data_transfer_size = data[NVMe::IdentifyController::maximum_data_transfer_size_offset];
+    if (maximum_data_transfer_size != 0) {
+        size_t minimum_page_size = (size_t)4096 << ((m_capabilities >> 48) & 0xf);
+        if (maximum_data_transfer_size < 16)
+            m_max_transfer_size = min(m_max_transfer_size, minimum_page_size << maximum_data_transfer_size);
+    }
+
+    auto model = StringView((const char*)data + NVMe::IdentifyController::model_number_offset, NVMe::IdentifyController::model_number_length).trim_whitespace();
+    dmesgln("{}: NVMe controller found: Model={}, Max transfer size={}", pci_address(), model, m_max_transfer_size);
+    return true;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::create_io_queues()
+{
+    size_t wanted_queues = min((size_t)Processor::count(), MAX_IO_QUEUES);
+
+    NVMe::SubmissionQueueEntry set_features {};
+    set_features.opcode = (u8)NVMe::AdminCommand::SetFeatures;
+    set_features.command_specific[0] = (u32)NVMe::Feature::NumberOfQueues;
+    set_features.command_specific[1] = (wanted_queues - 1) << 16 | (wanted_queues - 1);
+    auto completion = submit_admin_command(set_features);
+    if (!completion.has_value())
+        return false;
+    // The controller tells us how many queues it actually allocated, which may be more or less than we asked for.
+    size_t granted_submission_queues = (completion->command_specific & 0xffff) + 1;
+    size_t granted_completion_queues = (completion->command_specific >> 16) + 1;
+    size_t queues_count = min(wanted_queues, min(granted_submission_queues, granted_completion_queues));
+
+    // NOTE: Vector 0 would also get the admin queue's interrupts, but we poll that one anyway.
+    m_message_signaled_interrupts = PCI::MessageSignaledInterrupts::try_create(pci_address(), queues_count, purpose());
+    if (m_message_signaled_interrupts) {
+        for (size_t i = 0; i < m_message_signaled_interrupts->count(); i++) {
+            m_message_signaled_interrupts->route_to_processor(i, i % Processor::count());
+            m_message_signaled_interrupts->set_handler(i, [this, i](auto& regs) {
+                handle_message_signaled_interrupt(regs, i);
+            });
+        }
+    }
+
+    size_t entries_count = min((u64)NVMe::Limits::IOQueueEntries, NVMe::Capabilities::max_queue_entries(m_capabilities));
+    for (u16 queue_id = 1; queue_id <= queues_count; queue_id++) {
+        auto queue = NVMeQueue::create(queue_id, entries_count, submission_doorbell(queue_id), completion_doorbell(queue_id));
+        if (!queue || !queue->allocate_command_slots())
+            break;
+
+        // Without MSI-X, all queues share interrupt vector 0, which is either our single MSI vector or the pin-based interrupt.
+        u32 interrupt_vector = 0;
+        if (m_message_signaled_interrupts && m_message_signaled_interrupts->is_msix())
+            interrupt_vector = (queue_id - 1) % m_message_signaled_interrupts->count();
+        NVMe::SubmissionQueueEntry create_completion_queue {};
+        create_completion_queue.opcode = (u8)NVMe::AdminCommand::CreateIOCompletionQueue;
+        create_completion_queue.data_pointer[0] = queue->completion_queue_address().get();
+        create_completion_queue.command_specific[0] = (entries_count - 1) << 16 | queue_id;
+        create_completion_queue.command_specific[1] = interrupt_vector << 16 | NVMe::QueueFlags::PhysicallyContiguous | NVMe::QueueFlags::InterruptsEnabled;
+        if (!submit_admin_command(create_completion_queue).has_value())
+            break;
+
+        NVMe::SubmissionQueueEntry create_submission_queue {};
+        create_submission_queue.opcode = (u8)NVMe::AdminCommand::CreateIOSubmissionQueue;
+        create_submission_queue.data_pointer[0] = queue->submission_queue_address().get();
+        create_submission_queue.command_specific[0] = (entries_count - 1) << 16 | queue_id;
+        create_submission_queue.command_specific[1] = (u32)queue_id << 16 | NVMe::QueueFlags::PhysicallyContiguous;
+        if (!submit_admin_command(create_submission_queue).has_value())
+            break;
+
+        m_io_queues.append(queue.release_nonnull());
+    }
+
+    if (m_io_queues.is_empty()) {
+        dmesgln("{}: NVMe controller failed to create any I/O queues", pci_address());
+        return false;
+    }
+    dbgln_if(NVME_DEBUG, "{}: NVMe controller created {} I/O queues with {} entries each", pci_address(), m_io_queues.size(), entries_count);
+    return true;
+}
+
+UNMAP_AFTER_INIT void NVMeController::identify_namespaces()
+{
+    NVMe::SubmissionQueueEntry entry {};
+    entry.opcode = (u8)NVMe::AdminCommand::Identify;
+    entry.data_pointer[0] = m_identify_region->physical_page(0)->paddr().get();
+    entry.command_specific[0] = (u32)NVMe::IdentifyStructure::ActiveNamespaceList;
+    if (!submit_admin_command(entry).has_value())
+        return;
+
+    Vector<u32> namespace_ids;
+    auto* active_namespaces = (const u32*)m_identify_region->vaddr().as_ptr();
+    for (size_t i = 0; i < PAGE_SIZE / sizeof(u32) && active_namespaces[i] != 0; i++)
+        namespace_ids.append(active_namespaces[i]);
+
+    for (auto namespace_id : namespace_ids) {
+        NVMe::SubmissionQueueEntry identify_namespace {};
+        identify_namespace.opcode = (u8)NVMe::AdminCommand::Identify;
+        identify_namespace.namespace_id = namespace_id;
+        identify_namespace.data_pointer[0] = m_identify_region->physical_page(0)->paddr().get();
+        identify_namespace.command_specific[0] = (u32)NVMe::IdentifyStructure::Namespace;
+        if (!submit_admin_command(identify_namespace).has_value())
+            continue;
+
+        auto& data = *(const NVMe::IdentifyNamespace*)m_identify_region->vaddr().as_ptr();
+        auto& format = data.lba_formats[data.formatted_lba_size & 0xf];
+        size_t block_size = (size_t)1 << format.lba_data_size;
+        if (data.size == 0 || block_size < 512 || block_size > PAGE_SIZE || format.metadata_size != 0) {
+            dbgln("{}: NVMe namespace {} has an unsupported format, ignoring", pci_address(), namespace_id);
+            continue;
+        }
+        dmesgln("{}: NVMe namespace {}: Capacity={}, Block size={}", pci_address(), namespace_id, data.size * block_size, block_size);
+        m_namespaces.append(NVMeNameSpace::create(*this, namespace_id, block_size, data.size));
+    }
+}
+
+void NVMeController::handle_irq(const RegisterState&)
+{
+    // NOTE: All queues share the one interrupt, so we simply look at every one of them.
+    for (auto& queue : m_io_queues)
+        queue.handle_completions();
+}
+
+void NVMeController::handle_message_signaled_interrupt(const RegisterState& regs, size_t index)
+{
+    if (!m_message_signaled_interrupts->is_msix()) {
+        handle_irq(regs);
+        return;
+    }
+    for (size_t i = index; i < m_io_queues.size(); i += m_message_signaled_interrupts->count())
+        m_io_queues[i].handle_completions();
+}
+
+RefPtr<StorageDevice> NVMeController::device(u32 index) const
+{
+    if (index >= m_namespaces.size())
+        return {};
+    return m_namespaces[index];
+}
+
+size_t NVMeController::devices_count() const
+{
+    return m_namespaces.size();
+}
+
+void NVMeController::start_request(const StorageDevice& device, AsyncBlockDeviceRequest& request)
+{
+    auto& name_space = static_cast<const NVMeNameSpace&>(device);
+    // Prefer the queue that belongs to this CPU, so CPUs don't contend on each other's queue locks.
+    size_t preferred_queue = Processor::id() % m_io_queues.size();
+    for (size_t i = 0; i < m_io_queues.size(); i++) {
+        auto& queue = m_io_queues[(preferred_queue + i) % m_io_queues.size()];
+        if (queue.submit_request(request, name_space.namespace_id(), name_space.block_size()))
+            return;
+    }
+    dbgln("{}: NVMe controller has no free command slots", pci_address());
+    request.complete(AsyncDeviceRequest::Failure);
+}
+
+void NVMeController::complete_current_request(AsyncDeviceRequest::RequestResult)
+{
+    VERIFY_NOT_REACHED();
+}
+
+}
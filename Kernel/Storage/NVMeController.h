@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/PCI/MSI.h>
+#include <Kernel/Storage/NVMe.h>
+#include <Kernel/Storage/NVMeQueue.h>
+#include <Kernel/Storage/StorageController.h>
+#include <Kernel/Storage/StorageDevice.h>
+
+namespace Kernel {
+
+class AsyncBlockDeviceRequest;
+class NVMeNameSpace;
+class NVMeController final : public StorageController
+    , public PCI::DeviceController
+    , public IRQHandler {
+    friend class NVMeNameSpace;
+    AK_MAKE_ETERNAL
+public:
+    UNMAP_AFTER_INIT static RefPtr<NVMeController> initialize(PCI::Address address);
+    virtual ~NVMeController() override;
+
+    virtual RefPtr<StorageDevice> device(u32 index) const override;
+    virtual bool reset() override;
+    virtual bool shutdown() override;
+    virtual size_t devices_count() const override;
+    virtual void start_request(const StorageDevice&, AsyncBlockDeviceRequest&) override;
+    virtual void complete_current_request(AsyncDeviceRequest::RequestResult) override;
+
+    size_t controller_index() const { return m_controller_index; }
+    size_t io_queues_count() const { return m_io_queues.size(); }
+    size_t max_transfer_size() const { return m_max_transfer_size; }
+
+    // ^IRQHandler
+    virtual const char* purpose() const override { return "NVMe Controller"; }
+
+private:
+    UNMAP_AFTER_INIT NVMeController(PCI::Address address, size_t controller_index);
+    UNMAP_AFTER_INIT bool initialize();
+    UNMAP_AFTER_INIT bool identify_controller();
+    UNMAP_AFTER_INIT bool create_io_queues();
+    UNMAP_AFTER_INIT void identify_namespaces();
+
+    //^ IRQHandler
+    virtual void handle_irq(const RegisterState&) override;
+    void handle_message_signaled_interrupt(const RegisterState&, size_t index);
+
+    bool wait_for_ready(bool ready) const;
+    Optional<NVMe::CompletionQueueEntry> submit_admin_command(NVMe::SubmissionQueueEntry&);
+    volatile u32* submission_doorbell(u16 queue_id) const;
+    volatile u32* completion_doorbell(u16 queue_id) const;
+    volatile NVMe::ControllerRegisters& registers() const { return *(volatile NVMe::ControllerRegisters*)m_registers_region->vaddr().as_ptr(); }
+
+    NonnullOwnPtr<Region> m_registers_region;
+    OwnPtr<Region> m_identify_region;
+    RefPtr<NVMeQueue> m_admin_queue;
+    NonnullRefPtrVector<NVMeQueue> m_io_queues;
+    NonnullRefPtrVector<NVMeNameSpace> m_namespaces;
+    // If we have these, I/O queue N reports to vector N % count(), which goes to the processor that submits to the queue.
+    OwnPtr<PCI::MessageSignaledInterrupts> m_message_signaled_interrupts;
+    u64 m_capabilities { 0 };
+    size_t m_controller_index { 0 };
+    size_t m_max_transfer_size { NVMeQueue::max_transfer_size };
+};
+}
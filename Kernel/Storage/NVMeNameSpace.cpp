@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Storage/NVMeController.h>
+#include <Kernel/Storage/NVMeNameSpace.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullRefPtr<NVMeNameSpace> NVMeNameSpace::create(const NVMeController& controller, u32 namespace_id, size_t block_size, u64 max_addressable_block)
+{
+    return adopt_ref(*new NVMeNameSpace(controller, namespace_id, block_size, max_addressable_block));
+}
+
+UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(const NVMeController& controller, u32 namespace_id, size_t block_size, u64 max_addressable_block)
+    : StorageDevice(controller, block_size, max_addressable_block)
+    , m_controller(controller)
+    , m_namespace_id(namespace_id)
+{
+}
+
+NVMeNameSpace::~NVMeNameSpace()
+{
+}
+
+const char* NVMeNameSpace::class_name() const
+{
+    return "NVMeNameSpace";
+}
+
+size_t NVMeNameSpace::max_blocks_per_request() const
+{
+    return m_controller->max_transfer_size() / block_size();
+}
+
+size_t NVMeNameSpace::max_started_requests() const
+{
+    // All namespaces of a controller share its command slots, so each one only gets its fair share.
+    size_t command_slots_count = m_controller->io_queues_count() * NVMeQueue::max_commands_in_flight;
+    return max(command_slots_count / max(m_controller->devices_count(), (size_t)1), (size_t)1);
+}
+
+void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
+{
+    m_controller->start_request(*this, request);
+}
+
+String NVMeNameSpace::device_name() const
+{
+    return String::formatted("nvme{}n{}", m_controller->controller_index(), m_namespace_id);
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/Storage/StorageDevice.h>
+
+namespace Kernel {
+
+class NVMeController;
+class NVMeNameSpace final : public StorageDevice {
+    friend class NVMeController;
+
+public:
+    static NonnullRefPtr<NVMeNameSpace> create(const NVMeController&, u32 namespace_id, size_t block_size, u64 max_addressable_block);
+    virtual ~NVMeNameSpace() override;
+
+    u32 namespace_id() const { return m_namespace_id; }
+
+    // ^StorageDevice
+    virtual size_t max_blocks_per_request() const override;
+
+    // ^Device
+    virtual size_t max_started_requests() const override;
+
+    // ^BlockDevice
+    virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual String device_name() const override;
+
+private:
+    NVMeNameSpace(const NVMeController&, u32 namespace_id, size_t block_size, u64 max_addressable_block);
+
+    // ^DiskDevice
+    virtual const char* class_name() const override;
+
+    NonnullRefPtr<NVMeController> m_controller;
+    u32 m_namespace_id { 0 };
+};
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/IO.h>
+#include <Kernel/Storage/NVMeQueue.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+// Every command slot gets this much room in the PRP lists page, which is enough for a maximum sized transfer.
+static constexpr size_t PRP_LIST_STRIDE = 128;
+static_assert((NVMeQueue::max_transfer_size / PAGE_SIZE) * sizeof(u64) <= PRP_LIST_STRIDE);
+static_assert(NVMeQueue::max_commands_in_flight * PRP_LIST_STRIDE <= PAGE_SIZE);
+
+RefPtr<NVMeQueue> NVMeQueue::create(u16 queue_id, size_t entries_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell)
+{
+    auto submission_queue_region = MM.allocate_contiguous_kernel_region(page_round_up(entries_count * sizeof(NVMe::SubmissionQueueEntry)), "NVMe Submission Queue", Region::Access::Read | Region::Access::Write, PAGE_SIZE, Region::Cacheable::No);
+    auto completion_queue_region = MM.allocate_contiguous_kernel_region(page_round_up(entries_count * sizeof(NVMe::CompletionQueueEntry)), "NVMe Completion Queue", Region::Access::Read | Region::Access::Write, PAGE_SIZE, Region::Cacheable::No);
+    if (!submission_queue_region || !completion_queue_region)
+        return {};
+    memset(submission_queue_region->vaddr().as_ptr(), 0, submission_queue_region->size());
+    memset(completion_queue_region->vaddr().as_ptr(), 0, completion_queue_region->size());
+    return adopt_ref_if_nonnull(new NVMeQueue(queue_id, entries_count, submission_queue_region.release_nonnull(), completion_queue_region.release_nonnull(), submission_doorbell, completion_doorbell));
+}
+
+NVMeQueue::NVMeQueue(u16 queue_id, size_t entries_count, NonnullOwnPtr<Region> submission_queue_region, NonnullOwnPtr<Region> completion_queue_region, volatile u32* submission_doorbell, volatile u32* completion_doorbell)
+    : m_queue_id(queue_id)
+    , m_entries_count(entries_count)
+    , m_submission_queue_region(move(submission_queue_region))
+    , m_completion_queue_region(move(completion_queue_region))
+    , m_submission_doorbell(submission_doorbell)
+    , m_completion_doorbell(completion_doorbell)
+{
+}
+
+NVMeQueue::~NVMeQueue()
+{
+}
+
+bool NVMeQueue::allocate_command_slots()
+{
+    VERIFY(m_entries_count > max_commands_in_flight);
+    m_prp_lists_region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "NVMe PRP Lists", Region::Access::Read | Region::Access::Write);
+    if (!m_prp_lists_region)
+        return false;
+
+    for (size_t slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        auto& slot = m_command_slots[slot_index];
+        // NOTE: The buffer is physically contiguous, so the PRP list for it never changes.
+        slot.dma_region = MM.allocate_contiguous_kernel_region(max_transfer_size, "NVMe DMA Buffer", Region::Access::Read | Region::Access::Write);
+        if (!slot.dma_region)
+            return false;
+        auto* prp_list = (u64*)(m_prp_lists_region->vaddr().as_ptr() + slot_index * PRP_LIST_STRIDE);
+        for (size_t page_index = 1; page_index < max_transfer_size / PAGE_SIZE; page_index++)
+            prp_list[page_index - 1] = slot.dma_region->physical_page(page_index)->paddr().get();
+    }
+    return true;
+}
+
+void NVMeQueue::submit(const NVMe::SubmissionQueueEntry& entry)
+{
+    VERIFY(m_lock.is_locked());
+    memcpy(const_cast<NVMe::SubmissionQueueEntry*>(&submission_queue()[m_submission_queue_tail]), &entry, sizeof(entry));
+    m_submission_queue_tail = (m_submission_queue_tail + 1) % m_entries_count;
+    full_memory_barrier();
+    *m_submission_doorbell = m_submission_queue_tail;
+}
+
+Optional<NVMe::CompletionQueueEntry> NVMeQueue::take_completion()
+{
+    VERIFY(m_lock.is_locked());
+    auto& entry = completion_queue()[m_completion_queue_head];
+    // The controller flips the phase tag every time it wraps around, so stale entries still have the old one.
+    if ((entry.status & 1) != m_completion_queue_phase)
+        return {};
+    full_memory_barrier();
+    NVMe::CompletionQueueEntry completion;
+    memcpy(&completion, const_cast<NVMe::CompletionQueueEntry*>(&entry), sizeof(completion));
+
+    if (++m_completion_queue_head == m_entries_count) {
+        m_completion_queue_head = 0;
+        m_completion_queue_phase ^= 1;
+    }
+    *m_completion_doorbell = m_completion_queue_head;
+    return completion;
+}
+
+Optional<NVMe::CompletionQueueEntry> NVMeQueue::submit_and_wait(NVMe::SubmissionQueueEntry& entry, size_t timeout_in_milliseconds)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        entry.command_id = m_submission_queue_tail;
+        submit(entry);
+    }
+    for (size_t elapsed = 0; elapsed <= timeout_in_milliseconds; elapsed++) {
+        {
+            ScopedSpinLock lock(m_lock);
+            if (auto completion = take_completion(); completion.has_value()) {
+                VERIFY(completion->command_id == entry.command_id);
+                return completion;
+            }
+        }
+        IO::delay(1000);
+    }
+    dbgln("NVMeQueue {}: Command {:#02x} timed out", m_queue_id, entry.opcode);
+    return {};
+}
+
+bool NVMeQueue::submit_request(AsyncBlockDeviceRequest& request, u32 namespace_id, size_t block_size)
+{
+    size_t transfer_size = request.block_count() * block_size;
+    VERIFY(transfer_size > 0 && transfer_size <= max_transfer_size);
+
+    Optional<u16> slot_index;
+    {
+        ScopedSpinLock lock(m_lock);
+        for (size_t index = 0; index < m_command_slots.size(); index++) {
+            if (m_command_slots[index].dma_region && !m_command_slots[index].is_reserved) {
+                m_command_slots[index].is_reserved = true;
+                slot_index = index;
+                break;
+            }
+        }
+    }
+    if (!slot_index.has_value())
+        return false;
+
+    auto& slot = m_command_slots[slot_index.value()];
+    bool is_write = request.request_type() == AsyncBlockDeviceRequest::Write;
+    if (is_write && !request.read_from_buffer(request.buffer(), slot.dma_region->vaddr().as_ptr(), transfer_size)) {
+        {
+            ScopedSpinLock lock(m_lock);
+            slot.is_reserved = false;
+        }
+        request.complete(AsyncDeviceRequest::MemoryFault);
+        return true;
+    }
+
+    NVMe::SubmissionQueueEntry entry {};
+    entry.opcode = (u8)(is_write ? NVMe::IOCommand::Write : NVMe::IOCommand::Read);
+    entry.command_id = slot_index.value();
+    entry.namespace_id = namespace_id;
+    entry.data_pointer[0] = slot.dma_region->physical_page(0)->paddr().get();
+    size_t page_count = page_round_up(transfer_size) / PAGE_SIZE;
+    if (page_count == 2)
+        entry.data_pointer[1] = slot.dma_region->physical_page(1)->paddr().get();
+    else if (page_count > 2)
+        entry.data_pointer[1] = m_prp_lists_region->physical_page(0)->paddr().offset(slot_index.value() * PRP_LIST_STRIDE).get();
+    entry.command_specific[0] = request.block_index() & 0xffffffff;
+    entry.command_specific[1] = request.block_index() >> 32;
+    entry.command_specific[2] = request.block_count() - 1;
+
+    dbgln_if(NVME_DEBUG, "NVMeQueue {}: {} {} blocks at {} in slot {}", m_queue_id, is_write ? "Write" : "Read", request.block_count(), request.block_index(), slot_index.value());
+
+    ScopedSpinLock lock(m_lock);
+    slot.request = request;
+    slot.transfer_size = transfer_size;
+    slot.is_completed = false;
+    submit(entry);
+    return true;
+}
+
+bool NVMeQueue::handle_completions()
+{
+    ScopedSpinLock lock(m_lock);
+    bool any_completed = false;
+    while (true) {
+        auto completion = take_completion();
+        if (!completion.has_value())
+            break;
+        if (completion->command_id >= m_command_slots.size() || !m_command_slots[completion->command_id].request) {
+            dbgln("NVMeQueue {}: Completion for unknown command {}", m_queue_id, completion->command_id);
+            continue;
+        }
+        auto& slot = m_command_slots[completion->command_id];
+        slot.is_completed = true;
+        slot.status = completion->status;
+        any_completed = true;
+    }
+
+    // Now schedule copying the data out as soon as we leave the irq handler.
+    // This is important so that we can safely access the buffers, which could
+    // trigger page faults.
+    if (any_completed && !m_finish_queued) {
+        m_finish_queued = true;
+        g_io_work->queue([this]() {
+            finish_completed_commands();
+        });
+    }
+    return any_completed;
+}
+
+void NVMeQueue::finish_completed_commands()
+{
+    Vector<size_t, max_commands_in_flight> completed_slots;
+    {
+        ScopedSpinLock lock(m_lock);
+        m_finish_queued = false;
+        for (size_t index = 0; index < m_command_slots.size(); index++) {
+            if (!m_command_slots[index].is_completed)
+                continue;
+            // NOTE: The slot stays reserved until we're done with its buffer.
+            m_command_slots[index].is_completed = false;
+            completed_slots.append(index);
+        }
+    }
+
+    for (auto index : completed_slots) {
+        auto& slot = m_command_slots[index];
+        auto request = slot.request.release_nonnull();
+        auto result = AsyncDeviceRequest::Success;
+        if (!NVMe::is_successful_status(slot.status)) {
+            dbgln("NVMeQueue {}: Command in slot {} failed with status {:#04x}", m_queue_id, index, slot.status >> 1);
+            result = AsyncDeviceRequest::Failure;
+        } else if (request->request_type() == AsyncBlockDeviceRequest::Read) {
+            if (!request->write_to_buffer(request->buffer(), slot.dma_region->vaddr().as_ptr(), slot.transfer_size))
+                result = AsyncDeviceRequest::MemoryFault;
+        }
+        {
+            ScopedSpinLock lock(m_lock);
+            slot.is_reserved = false;
+        }
+        request->complete(result);
+    }
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Storage/NVMe.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// A submission queue together with the completion queue it reports to.
+// The admin queue only ever has a single command in flight, which we poll for.
+// I/O queues have a small number of command slots, each with its own DMA buffer.
+class NVMeQueue : public RefCounted<NVMeQueue> {
+public:
+    static constexpr size_t max_commands_in_flight = 8;
+    static constexpr size_t max_transfer_size = 64 * KiB;
+
+    static RefPtr<NVMeQueue> create(u16 queue_id, size_t entries_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell);
+    ~NVMeQueue();
+
+    u16 queue_id() const { return m_queue_id; }
+    size_t entries_count() const { return m_entries_count; }
+    PhysicalAddress submission_queue_address() const { return m_submission_queue_region->physical_page(0)->paddr(); }
+    PhysicalAddress completion_queue_address() const { return m_completion_queue_region->physical_page(0)->paddr(); }
+
+    // Submits a command and busy-waits for its completion. Only meant for the admin queue.
+    Optional<NVMe::CompletionQueueEntry> submit_and_wait(NVMe::SubmissionQueueEntry&, size_t timeout_in_milliseconds);
+
+    bool allocate_command_slots();
+    // Returns false if all command slots are in use.
+    bool submit_request(AsyncBlockDeviceRequest&, u32 namespace_id, size_t block_size);
+
+    // Called from the interrupt handler. Returns true if any of our commands finished.
+    bool handle_completions();
+
+private:
+    NVMeQueue(u16 queue_id, size_t entries_count, NonnullOwnPtr<Region> submission_queue_region, NonnullOwnPtr<Region> completion_queue_region, volatile u32* submission_doorbell, volatile u32* completion_doorbell);
+
+    volatile NVMe::SubmissionQueueEntry* submission_queue() { return (volatile NVMe::SubmissionQueueEntry*)m_submission_queue_region->vaddr().as_ptr(); }
+    volatile NVMe::CompletionQueueEntry* completion_queue() { return (volatile NVMe::CompletionQueueEntry*)m_completion_queue_region->vaddr().as_ptr(); }
+
+    void submit(const NVMe::SubmissionQueueEntry&);
+    Optional<NVMe::CompletionQueueEntry> take_completion();
+    void finish_completed_commands();
+
+    struct CommandSlot {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        bool is_reserved { false };
+        bool is_completed { false };
+        u16 status { 0 };
+        size_t transfer_size { 0 };
+        OwnPtr<Region> dma_region;
+    };
+
+    u16 m_queue_id { 0 };
+    size_t m_entries_count { 0 };
+    u16 m_submission_queue_tail { 0 };
+    u16 m_completion_queue_head { 0 };
+    u16 m_completion_queue_phase { 1 };
+    NonnullOwnPtr<Region> m_submission_queue_region;
+    NonnullOwnPtr<Region> m_completion_queue_region;
+    OwnPtr<Region> m_prp_lists_region;
+    volatile u32* m_submission_doorbell { nullptr };
+    volatile u32* m_completion_doorbell { nullptr };
+    Array<CommandSlot, max_commands_in_flight> m_command_slots;
+    bool m_finish_queued { false };
+    mutable SpinLock<u8> m_lock;
+};
+
+}
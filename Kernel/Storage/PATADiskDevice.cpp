@@ -36,6 +36,11 @@ const char* PATADiskDevice::class_name() const
     return "PATADiskDevice";
 }
 
+size_t PATADiskDevice::max_blocks_per_request() const
+{
+    return m_channel->max_sectors_per_request();
+}
+
 void PATADiskDevice::start_request(AsyncBlockDeviceRequest& request)
 {
     m_channel->start_request(request, is_slave(), m_capabilities);
@@ -40,6 +40,9 @@ public:
     static NonnullRefPtr<PATADiskDevice> create(const IDEController&, IDEChannel&, DriveType, InterfaceType, u16, u64);
     virtual ~PATADiskDevice() override;
 
+    // ^StorageDevice
+    virtual size_t max_blocks_per_request() const override;
+
     // ^BlockDevice
     virtual void start_request(AsyncBlockDeviceRequest&) override;
     virtual String device_name() const override;
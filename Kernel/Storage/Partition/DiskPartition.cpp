@@ -33,8 +33,10 @@ const DiskPartitionMetadata& DiskPartition::metadata() const
 
 void DiskPartition::start_request(AsyncBlockDeviceRequest& request)
 {
-    request.add_sub_request(m_device->make_request<AsyncBlockDeviceRequest>(request.request_type(),
+    auto sub_request = adopt_ref(*new AsyncBlockDeviceRequest(*m_device, request.request_type(),
         request.block_index() + m_metadata.start_block(), request.block_count(), request.buffer(), request.buffer_size()));
+    request.add_sub_request(sub_request);
+    m_device->submit_request(move(sub_request));
 }
 
 KResultOr<size_t> DiskPartition::read(FileDescription& fd, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
@@ -28,6 +28,8 @@ public:
     // ^Device
     virtual mode_t required_mode() const override { return 0600; }
     virtual String device_name() const override;
+    // The disk queues and schedules our requests along with everyone else's, so we just pass them all on.
+    virtual size_t max_started_requests() const override { return NumericLimits<size_t>::max(); }
 
     const DiskPartitionMetadata& metadata() const;
 
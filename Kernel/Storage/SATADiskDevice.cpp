@@ -33,6 +33,16 @@ const char* SATADiskDevice::class_name() const
     return "SATADiskDevice";
 }
 
+size_t SATADiskDevice::max_blocks_per_request() const
+{
+    return m_port->max_blocks_per_request();
+}
+
+size_t SATADiskDevice::max_started_requests() const
+{
+    return m_port->command_queue_depth();
+}
+
 void SATADiskDevice::start_request(AsyncBlockDeviceRequest& request)
 {
     m_port->start_request(request);
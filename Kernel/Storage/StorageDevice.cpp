@@ -37,45 +37,62 @@ NonnullRefPtr<StorageController> StorageDevice::controller() const
     return m_storage_controller;
 }
 
-KResultOr<size_t> StorageDevice::read(FileDescription&, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
+void StorageDevice::queue_waiting_request(NonnullRefPtr<AsyncDeviceRequest> request)
 {
-    unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
-    ssize_t remaining = len % block_size();
+    VERIFY(requests_lock().is_locked());
+    m_request_queue.append(static_ptr_cast<AsyncBlockDeviceRequest>(request));
+}
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
+RefPtr<AsyncDeviceRequest> StorageDevice::take_next_waiting_request()
+{
+    VERIFY(requests_lock().is_locked());
+    return m_request_queue.take_next(*this, max_blocks_per_request());
+}
 
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
-        remaining = 0;
-    }
+BlockRequestQueue::Stats StorageDevice::request_queue_stats() const
+{
+    ScopedSpinLock lock(requests_lock());
+    return m_request_queue.stats();
+}
+
+KResultOr<size_t> StorageDevice::read(FileDescription&, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
+{
+    u64 index = offset / block_size();
+    size_t whole_blocks = len / block_size();
+    ssize_t remaining = len % block_size();
 
     dbgln_if(STORAGE_DEVICE_DEBUG, "StorageDevice::read() index={}, whole_blocks={}, remaining={}", index, whole_blocks, remaining);
 
-    if (whole_blocks > 0) {
-        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, whole_blocks, outbuf, whole_blocks * block_size());
+    off_t pos = 0;
+    // NOTE: A device that can't take a single block per request would have us loop here forever.
+    VERIFY(max_blocks_per_request() > 0);
+    while (whole_blocks > 0) {
+        size_t block_count = min(whole_blocks, max_blocks_per_request());
+        auto chunk_buffer = outbuf.offset(pos);
+        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, block_count, chunk_buffer, block_count * block_size());
         auto result = read_request->wait();
         if (result.wait_result().was_interrupted())
             return EINTR;
         switch (result.request_result()) {
         case AsyncDeviceRequest::Failure:
         case AsyncDeviceRequest::Cancelled:
+            if (pos > 0)
+                return pos;
             return EIO;
         case AsyncDeviceRequest::MemoryFault:
             return EFAULT;
         default:
             break;
         }
+        index += block_count;
+        whole_blocks -= block_count;
+        pos += block_count * block_size();
     }
 
-    off_t pos = whole_blocks * block_size();
-
     if (remaining > 0) {
         auto data = ByteBuffer::create_uninitialized(block_size());
         auto data_buffer = UserOrKernelBuffer::for_kernel_buffer(data.data());
-        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index + whole_blocks, 1, data_buffer, block_size());
+        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, 1, data_buffer, block_size());
         auto result = read_request->wait();
         if (result.wait_result().was_interrupted())
             return EINTR;
@@ -104,39 +121,38 @@ bool StorageDevice::can_read(const FileDescription&, size_t offset) const
 
 KResultOr<size_t> StorageDevice::write(FileDescription&, u64 offset, const UserOrKernelBuffer& inbuf, size_t len)
 {
-    unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    u64 index = offset / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
-        remaining = 0;
-    }
-
     dbgln_if(STORAGE_DEVICE_DEBUG, "StorageDevice::write() index={}, whole_blocks={}, remaining={}", index, whole_blocks, remaining);
 
-    if (whole_blocks > 0) {
-        auto write_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Write, index, whole_blocks, inbuf, whole_blocks * block_size());
+    off_t pos = 0;
+    // NOTE: A device that can't take a single block per request would have us loop here forever.
+    VERIFY(max_blocks_per_request() > 0);
+    while (whole_blocks > 0) {
+        size_t block_count = min(whole_blocks, max_blocks_per_request());
+        auto chunk_buffer = inbuf.offset(pos);
+        auto write_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Write, index, block_count, chunk_buffer, block_count * block_size());
         auto result = write_request->wait();
         if (result.wait_result().was_interrupted())
             return EINTR;
         switch (result.request_result()) {
         case AsyncDeviceRequest::Failure:
         case AsyncDeviceRequest::Cancelled:
+            if (pos > 0)
+                return pos;
             return EIO;
         case AsyncDeviceRequest::MemoryFault:
             return EFAULT;
         default:
             break;
         }
+        index += block_count;
+        whole_blocks -= block_count;
+        pos += block_count * block_size();
     }
 
-    off_t pos = whole_blocks * block_size();
-
     // since we can only write in block_size() increments, if we want to do a
     // partial write, we have to read the block's content first, modify it,
     // then write the whole block back to the disk.
@@ -145,7 +161,7 @@ KResultOr<size_t> StorageDevice::write(FileDescription&, u64 offset, const UserO
         auto data_buffer = UserOrKernelBuffer::for_kernel_buffer(data.data());
 
         {
-            auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index + whole_blocks, 1, data_buffer, block_size());
+            auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, 1, data_buffer, block_size());
             auto result = read_request->wait();
             if (result.wait_result().was_interrupted())
                 return EINTR;
@@ -166,7 +182,7 @@ KResultOr<size_t> StorageDevice::write(FileDescription&, u64 offset, const UserO
             return EFAULT;
 
         {
-            auto write_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Write, index + whole_blocks, 1, data_buffer, block_size());
+            auto write_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Write, index, 1, data_buffer, block_size());
             auto result = write_request->wait();
             if (result.wait_result().was_interrupted())
                 return EINTR;
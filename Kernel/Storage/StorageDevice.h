@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Devices/BlockRequestQueue.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Storage/Partition/DiskPartition.h>
@@ -23,6 +24,9 @@ public:
 
     NonnullRefPtr<StorageController> controller() const;
 
+    // Larger reads and writes are split up into several requests of at most this many blocks.
+    virtual size_t max_blocks_per_request() const { return PAGE_SIZE / block_size(); }
+
     // ^BlockDevice
     virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual bool can_read(const FileDescription&, size_t) const override;
@@ -31,6 +35,9 @@ public:
 
     // ^Device
     virtual mode_t required_mode() const override { return 0600; }
+    virtual bool is_disk_device() const override { return true; }
+
+    BlockRequestQueue::Stats request_queue_stats() const;
 
 protected:
     StorageDevice(const StorageController&, size_t, u64);
@@ -38,10 +45,15 @@ protected:
     // ^DiskDevice
     virtual const char* class_name() const override;
 
+    // ^Device
+    virtual void queue_waiting_request(NonnullRefPtr<AsyncDeviceRequest>) override;
+    virtual RefPtr<AsyncDeviceRequest> take_next_waiting_request() override;
+
 private:
     NonnullRefPtr<StorageController> m_storage_controller;
     NonnullRefPtrVector<DiskPartition> m_partitions;
     u64 m_max_addressable_block;
+    BlockRequestQueue m_request_queue;
 };
 
 }
@@ -12,11 +12,13 @@
 #include <Kernel/Panic.h>
 #include <Kernel/Storage/AHCIController.h>
 #include <Kernel/Storage/IDEController.h>
+#include <Kernel/Storage/NVMeController.h>
 #include <Kernel/Storage/Partition/EBRPartitionTable.h>
 #include <Kernel/Storage/Partition/GUIDPartitionTable.h>
 #include <Kernel/Storage/Partition/MBRPartitionTable.h>
 #include <Kernel/Storage/RamdiskController.h>
 #include <Kernel/Storage/StorageManagement.h>
+#include <Kernel/VirtIO/VirtIOBlockController.h>
 
 namespace Kernel {
 
@@ -57,6 +59,14 @@ UNMAP_AFTER_INIT NonnullRefPtrVector<StorageController> StorageManagement::enume
             if (PCI::get_class(address) == 0x1 && PCI::get_subclass(address) == 0x6 && PCI::get_programming_interface(address) == 0x1) {
                 controllers.append(AHCIController::initialize(address));
             }
+            if (PCI::get_class(address) == 0x1 && PCI::get_subclass(address) == 0x8 && PCI::get_programming_interface(address) == 0x2) {
+                if (auto controller = NVMeController::initialize(address))
+                    controllers.append(controller.release_nonnull());
+            }
+            if (!kernel_command_line().disable_virtio()) {
+                if (auto controller = VirtIOBlockController::try_to_initialize(address))
+                    controllers.append(controller.release_nonnull());
+            }
         });
     }
     controllers.append(RamdiskController::initialize());
@@ -7,6 +7,7 @@
 #include <Kernel/API/Syscall.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Panic.h>
+#include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/ThreadTracer.h>
 #include <Kernel/VM/MemoryManager.h>
@@ -70,8 +71,14 @@ UNMAP_AFTER_INIT void initialize()
 #pragma GCC diagnostic ignored "-Wcast-function-type"
 typedef KResultOr<FlatPtr> (Process::*Handler)(FlatPtr, FlatPtr, FlatPtr);
 typedef KResultOr<FlatPtr> (Process::*HandlerWithRegisterState)(RegisterState&);
-#define __ENUMERATE_SYSCALL(x) reinterpret_cast<Handler>(&Process::sys$##x),
-static const Handler s_syscall_table[] = {
+
+struct HandlerMetadata {
+    Handler handler;
+    NeedsBigProcessLock needs_lock;
+};
+
+#define __ENUMERATE_SYSCALL(sys_call, needs_lock) { reinterpret_cast<Handler>(&Process::sys$##sys_call), needs_lock },
+static const HandlerMetadata s_syscall_table[] = {
     ENUMERATE_SYSCALLS(__ENUMERATE_SYSCALL)
 };
 #undef __ENUMERATE_SYSCALL
@@ -83,6 +90,21 @@ KResultOr<FlatPtr> handle(RegisterState& regs, FlatPtr function, FlatPtr arg1, F
     auto& process = current_thread->process();
     current_thread->did_syscall();
 
+    if (function >= Function::__Count) {
+        dbgln("Unknown syscall {} requested ({:08x}, {:08x}, {:08x})", function, arg1, arg2, arg3);
+        return ENOSYS;
+    }
+
+    auto& syscall_metadata = s_syscall_table[function];
+    if (syscall_metadata.handler == nullptr) {
+        dbgln("Null syscall {} requested, you probably need to rebuild this program!", function);
+        return ENOSYS;
+    }
+
+    Optional<Locker> big_lock_locker;
+    if (syscall_metadata.needs_lock == NeedsBigProcessLock::Yes)
+        big_lock_locker.emplace(process.big_lock());
+
     if (function == SC_exit || function == SC_exit_thread) {
         // These syscalls need special handling since they never return to the caller.
 
@@ -106,21 +128,11 @@ KResultOr<FlatPtr> handle(RegisterState& regs, FlatPtr function, FlatPtr arg1, F
 
     if (function == SC_fork || function == SC_sigreturn) {
         // These syscalls want the RegisterState& rather than individual parameters.
-        auto handler = (HandlerWithRegisterState)s_syscall_table[function];
+        auto handler = (HandlerWithRegisterState)syscall_metadata.handler;
         return (process.*(handler))(regs);
     }
 
-    if (function >= Function::__Count) {
-        dbgln("Unknown syscall {} requested ({:08x}, {:08x}, {:08x})", function, arg1, arg2, arg3);
-        return ENOSYS;
-    }
-
-    if (s_syscall_table[function] == nullptr) {
-        dbgln("Null syscall {} requested, you probably need to rebuild this program!", function);
-        return ENOSYS;
-    }
-
-    return (process.*(s_syscall_table[function]))(arg1, arg2, arg3);
+    return (process.*(syscall_metadata.handler))(arg1, arg2, arg3);
 }
 
 }
@@ -158,42 +170,49 @@ NEVER_INLINE void syscall_handler(TrapFrame* trap)
         PANIC("Syscall from process with IOPL != 0");
     }
 
-    // NOTE: We take the big process lock before inspecting memory regions.
-    process.big_lock().lock();
-
     if (!MM.validate_user_stack(process, VirtualAddress(regs.userspace_esp))) {
         dbgln("Invalid stack pointer: {:p}", regs.userspace_esp);
         handle_crash(regs, "Bad stack on syscall entry", SIGSTKFLT);
     }
 
-    auto* calling_region = MM.find_user_region_from_vaddr(process.space(), VirtualAddress(regs.eip));
-    if (!calling_region) {
-        dbgln("Syscall from {:p} which has no associated region", regs.eip);
-        handle_crash(regs, "Syscall from unknown region", SIGSEGV);
-    }
+    // NOTE: Not every syscall takes the big process lock, so the address space lock keeps
+    //       the calling region around while we look at it. We can't crash while holding it though.
+    auto calling_region_crash_description = [&]() -> const char* {
+        ScopedSpinLock lock(process.space().get_lock());
+        auto* calling_region = MM.find_user_region_from_vaddr(process.space(), VirtualAddress(regs.eip));
+        if (!calling_region) {
+            dbgln("Syscall from {:p} which has no associated region", regs.eip);
+            return "Syscall from unknown region";
+        }
 
-    if (calling_region->is_writable()) {
-        dbgln("Syscall from writable memory at {:p}", regs.eip);
-        handle_crash(regs, "Syscall from writable memory", SIGSEGV);
-    }
+        if (calling_region->is_writable()) {
+            dbgln("Syscall from writable memory at {:p}", regs.eip);
+            return "Syscall from writable memory";
+        }
 
-    if (process.space().enforces_syscall_regions() && !calling_region->is_syscall_region()) {
-        dbgln("Syscall from non-syscall region");
-        handle_crash(regs, "Syscall from non-syscall region", SIGSEGV);
-    }
+        if (process.space().enforces_syscall_regions() && !calling_region->is_syscall_region()) {
+            dbgln("Syscall from non-syscall region");
+            return "Syscall from non-syscall region";
+        }
+        return nullptr;
+    }();
+    if (calling_region_crash_description)
+        handle_crash(regs, calling_region_crash_description, SIGSEGV);
 
     auto function = regs.eax;
     auto arg1 = regs.edx;
     auto arg2 = regs.ecx;
     auto arg3 = regs.ebx;
 
+    PerformanceManager::add_syscall_enter_event(*current_thread, regs, function);
+
     auto result = Syscall::handle(regs, function, arg1, arg2, arg3);
     if (result.is_error())
         regs.eax = result.error();
     else
         regs.eax = result.value();
 
-    process.big_lock().unlock();
+    PerformanceManager::add_syscall_exit_event(*current_thread, regs, function);
 
     if (auto tracer = process.tracer(); tracer && tracer->is_tracing_syscalls()) {
         tracer->set_trace_syscalls(false);
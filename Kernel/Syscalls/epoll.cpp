@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+KResultOr<int> Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto epoll_or_error = EPoll::create();
+    if (epoll_or_error.is_error())
+        return epoll_or_error.error();
+
+    auto description_or_error = FileDescription::create(*epoll_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    auto description = description_or_error.release_value();
+    description->set_readable(true);
+
+    u32 fd_flags = 0;
+    if (flags & EPOLL_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    set_file_description(fd, move(description), fd_flags);
+    return fd;
+}
+
+KResultOr<int> Process::sys$epoll_ctl(int epoll_fd, int op, int fd, Userspace<const epoll_event*> user_event)
+{
+    REQUIRE_PROMISE(stdio);
+
+    auto epoll_description = file_description(epoll_fd);
+    if (!epoll_description)
+        return EBADF;
+    auto* epoll = epoll_description->epoll();
+    if (!epoll)
+        return EINVAL;
+
+    // NOTE: Removing a watch doesn't need the fd to still be open, it might have been closed already.
+    if (op == EPOLL_CTL_DEL)
+        return epoll->remove_watch(fd);
+
+    epoll_event event;
+    if (!copy_from_user(&event, user_event))
+        return EFAULT;
+
+    auto description = file_description(fd);
+    if (!description)
+        return EBADF;
+
+    switch (op) {
+    case EPOLL_CTL_ADD:
+        return epoll->add_watch(fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll->modify_watch(fd, event);
+    default:
+        return EINVAL;
+    }
+}
+
+KResultOr<int> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto description = file_description(params.epoll_fd);
+    if (!description)
+        return EBADF;
+    auto* epoll = description->epoll();
+    if (!epoll)
+        return EINVAL;
+
+    Thread::BlockTimeout timeout;
+    bool should_block = true;
+    if (params.timeout) {
+        auto timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        should_block = !timeout_time->is_zero();
+        // NOTE: This turns into an absolute deadline, so it stays the same no matter how often we wake up.
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask && !copy_from_user(&sigmask, params.sigmask))
+        return EFAULT;
+
+    auto current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    // There can't be more watches than there are fds, so there's no point in having room for more events.
+    size_t max_events = min((size_t)params.max_events, (size_t)m_max_open_file_descriptors);
+    Vector<epoll_event> events;
+    if (!events.try_ensure_capacity(max_events))
+        return ENOMEM;
+
+    while (true) {
+        auto result = epoll->collect_events(events, max_events);
+        if (result.is_error())
+            return result.error();
+        if (!events.is_empty() || !should_block)
+            break;
+
+        // Something changed when the EPoll becomes readable, but that something may not have made
+        // any of the watched files ready, so we might have to go around a few times.
+        Thread::SelectBlocker::FDVector fds_info;
+        fds_info.append({ *description, BlockFlags::Read });
+        auto block_result = current_thread->block<Thread::SelectBlocker>(timeout, fds_info);
+        if (block_result.was_interrupted())
+            return EINTR;
+        if (block_result.timed_out())
+            should_block = false;
+    }
+
+    if (!events.is_empty() && !copy_to_user(params.events, events.data(), events.size() * sizeof(epoll_event)))
+        return EFAULT;
+    return (int)events.size();
+}
+
+}
@@ -9,6 +9,7 @@
 #include <AK/TemporaryChange.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/Debug.h>
+#include <Kernel/ELFLoadLayoutCache.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/PerformanceManager.h>
@@ -22,7 +23,6 @@
 #include <Kernel/VM/SharedInodeVMObject.h>
 #include <LibC/limits.h>
 #include <LibELF/AuxiliaryVector.h>
-#include <LibELF/Image.h>
 #include <LibELF/Validation.h>
 
 namespace Kernel {
@@ -40,7 +40,7 @@ struct LoadResult {
     WeakPtr<Region> stack_region;
 };
 
-static Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base, FlatPtr entry_eip, uid_t uid, uid_t euid, gid_t gid, gid_t egid, String executable_path, int main_program_fd);
+static Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base, FlatPtr entry_eip, uid_t uid, uid_t euid, gid_t gid, gid_t egid, String executable_path, int main_program_fd, VirtualAddress time_page);
 
 static bool validate_stack_size(const Vector<String>& arguments, const Vector<String>& environment)
 {
@@ -146,47 +146,7 @@ static KResultOr<FlatPtr> make_userspace_stack_for_main_thread(Region& region, V
     return new_esp;
 }
 
-struct RequiredLoadRange {
-    FlatPtr start { 0 };
-    FlatPtr end { 0 };
-};
-
-static KResultOr<RequiredLoadRange> get_required_load_range(FileDescription& program_description)
-{
-    auto& inode = *(program_description.inode());
-    auto vmobject = SharedInodeVMObject::create_with_inode(inode);
-
-    size_t executable_size = inode.size();
-
-    auto region = MM.allocate_kernel_region_with_vmobject(*vmobject, page_round_up(executable_size), "ELF memory range calculation", Region::Access::Read);
-    if (!region) {
-        dbgln("Could not allocate memory for ELF");
-        return ENOMEM;
-    }
-
-    auto elf_image = ELF::Image(region->vaddr().as_ptr(), executable_size);
-    if (!elf_image.is_valid()) {
-        return EINVAL;
-    }
-
-    RequiredLoadRange range {};
-    elf_image.for_each_program_header([&range](const auto& pheader) {
-        if (pheader.type() != PT_LOAD)
-            return;
-
-        auto region_start = (FlatPtr)pheader.vaddr().as_ptr();
-        auto region_end = region_start + pheader.size_in_memory();
-        if (range.start == 0 || region_start < range.start)
-            range.start = region_start;
-        if (range.end == 0 || region_end > range.end)
-            range.end = region_end;
-    });
-
-    VERIFY(range.end > range.start);
-    return range;
-};
-
-static KResultOr<FlatPtr> get_load_offset(const Elf32_Ehdr& main_program_header, FileDescription& main_program_description, FileDescription* interpreter_description)
+static KResultOr<FlatPtr> get_load_offset(const ELFLoadLayout& main_program_layout, const ELFLoadLayout* interpreter_layout)
 {
     constexpr FlatPtr load_range_start = 0x08000000;
     constexpr FlatPtr load_range_size = 65536 * PAGE_SIZE; // 2**16 * PAGE_SIZE = 256MB
@@ -196,49 +156,46 @@ static KResultOr<FlatPtr> get_load_offset(const Elf32_Ehdr& main_program_header,
         return page_round_down(start + get_good_random<FlatPtr>() % size);
     });
 
-    if (main_program_header.e_type == ET_DYN) {
+    if (main_program_layout.type == ET_DYN) {
         return random_load_offset_in_range(load_range_start, load_range_size);
     }
 
-    if (main_program_header.e_type != ET_EXEC)
+    if (main_program_layout.type != ET_EXEC)
         return EINVAL;
 
-    auto main_program_load_range_result = get_required_load_range(main_program_description);
-    if (main_program_load_range_result.is_error())
-        return main_program_load_range_result.error();
-
-    auto main_program_load_range = main_program_load_range_result.value();
+    auto main_program_load_range_start = main_program_layout.load_range_start;
+    auto main_program_load_range_end = main_program_layout.load_range_end;
+    VERIFY(main_program_load_range_end > main_program_load_range_start);
 
-    RequiredLoadRange selected_range {};
-
-    if (interpreter_description) {
-        auto interpreter_load_range_result = get_required_load_range(*interpreter_description);
-        if (interpreter_load_range_result.is_error())
-            return interpreter_load_range_result.error();
+    FlatPtr selected_range_start = 0;
+    FlatPtr selected_range_end = 0;
 
-        auto interpreter_size_in_memory = interpreter_load_range_result.value().end - interpreter_load_range_result.value().start;
+    if (interpreter_layout) {
+        auto interpreter_size_in_memory = interpreter_layout->load_range_end - interpreter_layout->load_range_start;
         auto interpreter_load_range_end = load_range_start + load_range_size - interpreter_size_in_memory;
 
         // No intersection
-        if (main_program_load_range.end < load_range_start || main_program_load_range.start > interpreter_load_range_end)
+        if (main_program_load_range_end < load_range_start || main_program_load_range_start > interpreter_load_range_end)
             return random_load_offset_in_range(load_range_start, load_range_size);
 
-        RequiredLoadRange first_available_part = { load_range_start, main_program_load_range.start };
-        RequiredLoadRange second_available_part = { main_program_load_range.end, interpreter_load_range_end };
-
         // Select larger part
-        if (first_available_part.end - first_available_part.start > second_available_part.end - second_available_part.start)
-            selected_range = first_available_part;
-        else
-            selected_range = second_available_part;
-    } else
-        selected_range = main_program_load_range;
+        if (main_program_load_range_start - load_range_start > interpreter_load_range_end - main_program_load_range_end) {
+            selected_range_start = load_range_start;
+            selected_range_end = main_program_load_range_start;
+        } else {
+            selected_range_start = main_program_load_range_end;
+            selected_range_end = interpreter_load_range_end;
+        }
+    } else {
+        selected_range_start = main_program_load_range_start;
+        selected_range_end = main_program_load_range_end;
+    }
 
     // If main program is too big and leaves us without enough space for adequate loader randomization
-    if (selected_range.end - selected_range.start < minimum_load_offset_randomization_size)
+    if (selected_range_end - selected_range_start < minimum_load_offset_randomization_size)
         return E2BIG;
 
-    return random_load_offset_in_range(selected_range.start, selected_range.end - selected_range.start);
+    return random_load_offset_in_range(selected_range_start, selected_range_end - selected_range_start);
 }
 
 enum class ShouldAllocateTls {
@@ -251,7 +208,7 @@ enum class ShouldAllowSyscalls {
     Yes,
 };
 
-static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, FileDescription& object_description,
+static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, FileDescription& object_description, const ELFLoadLayout& layout,
     FlatPtr load_offset, ShouldAllocateTls should_allocate_tls, ShouldAllowSyscalls should_allow_syscalls)
 {
     auto& inode = *(object_description.inode());
@@ -263,17 +220,6 @@ static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, Fil
 
     size_t executable_size = inode.size();
 
-    auto executable_region = MM.allocate_kernel_region_with_vmobject(*vmobject, page_round_up(executable_size), "ELF loading", Region::Access::Read);
-    if (!executable_region) {
-        dbgln("Could not allocate memory for ELF loading");
-        return ENOMEM;
-    }
-
-    auto elf_image = ELF::Image(executable_region->vaddr().as_ptr(), executable_size);
-
-    if (!elf_image.is_valid())
-        return ENOEXEC;
-
     Region* master_tls_region { nullptr };
     size_t master_tls_size = 0;
     size_t master_tls_alignment = 0;
@@ -284,74 +230,61 @@ static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, Fil
 
     MemoryManager::enter_space(*new_space);
 
-    KResult ph_load_result = KSuccess;
-    elf_image.for_each_program_header([&](const ELF::Image::ProgramHeader& program_header) {
-        if (program_header.type() == PT_TLS) {
-            VERIFY(should_allocate_tls == ShouldAllocateTls::Yes);
-            VERIFY(program_header.size_in_memory());
+    // NOTE: The layout has already made sure that everything we copy here is within the file.
+    auto copy_segment_to_user = [&](u8* destination, const ELFLoadLayout::Segment& segment) -> KResult {
+        auto buffer = UserOrKernelBuffer::for_user_buffer(destination, segment.size_in_image);
+        if (!buffer.has_value())
+            return EFAULT;
+        auto nread_or_error = inode.read_bytes(segment.offset, segment.size_in_image, buffer.value(), &object_description);
+        if (nread_or_error.is_error())
+            return nread_or_error.error();
+        if ((size_t)nread_or_error.value() != segment.size_in_image)
+            return ENOEXEC;
+        return KSuccess;
+    };
 
-            if (!elf_image.is_within_image(program_header.raw_data(), program_header.size_in_image())) {
-                dbgln("Shenanigans! ELF PT_TLS header sneaks outside of executable.");
-                ph_load_result = ENOEXEC;
-                return IterationDecision::Break;
-            }
+    auto load_segment = [&](const ELFLoadLayout::Segment& segment) -> KResult {
+        if (segment.type == PT_TLS) {
+            VERIFY(should_allocate_tls == ShouldAllocateTls::Yes);
+            VERIFY(segment.size_in_memory);
 
-            auto range = new_space->allocate_range({}, program_header.size_in_memory());
-            if (!range.has_value()) {
-                ph_load_result = ENOMEM;
-                return IterationDecision::Break;
-            }
+            auto range = new_space->allocate_range({}, segment.size_in_memory);
+            if (!range.has_value())
+                return ENOMEM;
 
             auto region_or_error = new_space->allocate_region(range.value(), String::formatted("{} (master-tls)", elf_name), PROT_READ | PROT_WRITE, AllocationStrategy::Reserve);
-            if (region_or_error.is_error()) {
-                ph_load_result = region_or_error.error();
-                return IterationDecision::Break;
-            }
+            if (region_or_error.is_error())
+                return region_or_error.error();
 
             master_tls_region = region_or_error.value();
-            master_tls_size = program_header.size_in_memory();
-            master_tls_alignment = program_header.alignment();
+            master_tls_size = segment.size_in_memory;
+            master_tls_alignment = segment.alignment;
 
-            if (!copy_to_user(master_tls_region->vaddr().as_ptr(), program_header.raw_data(), program_header.size_in_image())) {
-                ph_load_result = EFAULT;
-                return IterationDecision::Break;
-            }
-            return IterationDecision::Continue;
+            return copy_segment_to_user(master_tls_region->vaddr().as_ptr(), segment);
         }
-        if (program_header.type() != PT_LOAD)
-            return IterationDecision::Continue;
+        VERIFY(segment.type == PT_LOAD);
 
-        if (program_header.is_writable()) {
+        if (segment.is_writable) {
             // Writable section: create a copy in memory.
-            VERIFY(program_header.size_in_memory());
-            VERIFY(program_header.alignment() == PAGE_SIZE);
-
-            if (!elf_image.is_within_image(program_header.raw_data(), program_header.size_in_image())) {
-                dbgln("Shenanigans! Writable ELF PT_LOAD header sneaks outside of executable.");
-                ph_load_result = ENOEXEC;
-                return IterationDecision::Break;
-            }
+            VERIFY(segment.size_in_memory);
+            VERIFY(segment.alignment == PAGE_SIZE);
 
             int prot = 0;
-            if (program_header.is_readable())
+            if (segment.is_readable)
                 prot |= PROT_READ;
-            if (program_header.is_writable())
+            if (segment.is_writable)
                 prot |= PROT_WRITE;
-            auto region_name = String::formatted("{} (data-{}{})", elf_name, program_header.is_readable() ? "r" : "", program_header.is_writable() ? "w" : "");
+            auto region_name = String::formatted("{} (data-{}{})", elf_name, segment.is_readable ? "r" : "", segment.is_writable ? "w" : "");
 
-            auto range_base = VirtualAddress { page_round_down(program_header.vaddr().offset(load_offset).get()) };
-            auto range_end = VirtualAddress { page_round_up(program_header.vaddr().offset(load_offset).offset(program_header.size_in_memory()).get()) };
+            auto range_base = VirtualAddress { page_round_down(segment.vaddr.offset(load_offset).get()) };
+            auto range_end = VirtualAddress { page_round_up(segment.vaddr.offset(load_offset).offset(segment.size_in_memory).get()) };
 
             auto range = new_space->allocate_range(range_base, range_end.get() - range_base.get());
-            if (!range.has_value()) {
-                ph_load_result = ENOMEM;
-                return IterationDecision::Break;
-            }
+            if (!range.has_value())
+                return ENOMEM;
             auto region_or_error = new_space->allocate_region(range.value(), region_name, prot, AllocationStrategy::Reserve);
-            if (region_or_error.is_error()) {
-                ph_load_result = region_or_error.error();
-                return IterationDecision::Break;
-            }
+            if (region_or_error.is_error())
+                return region_or_error.error();
 
             // It's not always the case with PIE executables (and very well shouldn't be) that the
             // virtual address in the program header matches the one we end up giving the process.
@@ -360,49 +293,44 @@ static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, Fil
             // FIXME: There's an opportunity to munmap, or at least mprotect, the padding space between
             //     the .text and .data PT_LOAD sections of the executable.
             //     Accessing it would definitely be a bug.
-            auto page_offset = program_header.vaddr();
+            auto page_offset = segment.vaddr;
             page_offset.mask(~PAGE_MASK);
-            if (!copy_to_user((u8*)region_or_error.value()->vaddr().as_ptr() + page_offset.get(), program_header.raw_data(), program_header.size_in_image())) {
-                ph_load_result = EFAULT;
-                return IterationDecision::Break;
-            }
-            return IterationDecision::Continue;
+            return copy_segment_to_user((u8*)region_or_error.value()->vaddr().as_ptr() + page_offset.get(), segment);
         }
 
         // Non-writable section: map the executable itself in memory.
-        VERIFY(program_header.size_in_memory());
-        VERIFY(program_header.alignment() == PAGE_SIZE);
+        VERIFY(segment.size_in_memory);
+        VERIFY(segment.alignment == PAGE_SIZE);
         int prot = 0;
-        if (program_header.is_readable())
+        if (segment.is_readable)
             prot |= PROT_READ;
-        if (program_header.is_writable())
+        if (segment.is_writable)
             prot |= PROT_WRITE;
-        if (program_header.is_executable())
+        if (segment.is_executable)
             prot |= PROT_EXEC;
-        auto range = new_space->allocate_range(program_header.vaddr().offset(load_offset), program_header.size_in_memory());
-        if (!range.has_value()) {
-            ph_load_result = ENOMEM;
-            return IterationDecision::Break;
-        }
-        auto region_or_error = new_space->allocate_region_with_vmobject(range.value(), *vmobject, program_header.offset(), elf_name, prot, true);
-        if (region_or_error.is_error()) {
-            ph_load_result = region_or_error.error();
-            return IterationDecision::Break;
-        }
+        auto range = new_space->allocate_range(segment.vaddr.offset(load_offset), segment.size_in_memory);
+        if (!range.has_value())
+            return ENOMEM;
+        auto region_or_error = new_space->allocate_region_with_vmobject(range.value(), *vmobject, segment.offset, elf_name, prot, true);
+        if (region_or_error.is_error())
+            return region_or_error.error();
         if (should_allow_syscalls == ShouldAllowSyscalls::Yes)
             region_or_error.value()->set_syscall_region(true);
-        if (program_header.offset() == 0)
+        if (segment.offset == 0)
             load_base_address = (FlatPtr)region_or_error.value()->vaddr().as_ptr();
-        return IterationDecision::Continue;
-    });
+        return KSuccess;
+    };
 
-    if (ph_load_result.is_error()) {
-        dbgln("do_exec: Failure loading program ({})", ph_load_result.error());
-        return ph_load_result;
+    for (auto& segment : layout.segments) {
+        auto result = load_segment(segment);
+        if (result.is_error()) {
+            dbgln("do_exec: Failure loading program ({})", result.error());
+            return result;
+        }
     }
 
-    if (!elf_image.entry().offset(load_offset).get()) {
-        dbgln("do_exec: Failure loading program, entry pointer is invalid! {})", elf_image.entry().offset(load_offset));
+    if (!layout.entry.offset(load_offset).get()) {
+        dbgln("do_exec: Failure loading program, entry pointer is invalid! {})", layout.entry.offset(load_offset));
         return ENOEXEC;
     }
 
@@ -421,7 +349,7 @@ static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, Fil
     return LoadResult {
         move(new_space),
         load_base_address,
-        elf_image.entry().offset(load_offset).get(),
+        layout.entry.offset(load_offset).get(),
         executable_size,
         AK::try_make_weak_ptr(master_tls_region),
         master_tls_size,
@@ -430,7 +358,7 @@ static KResultOr<LoadResult> load_elf_object(NonnullOwnPtr<Space> new_space, Fil
     };
 }
 
-KResultOr<LoadResult> Process::load(NonnullRefPtr<FileDescription> main_program_description, RefPtr<FileDescription> interpreter_description, const Elf32_Ehdr& main_program_header)
+KResultOr<LoadResult> Process::load(NonnullRefPtr<FileDescription> main_program_description, RefPtr<FileDescription> interpreter_description)
 {
     auto new_space = Space::create(*this, nullptr);
     if (!new_space)
@@ -440,13 +368,25 @@ KResultOr<LoadResult> Process::load(NonnullRefPtr<FileDescription> main_program_
         MemoryManager::enter_process_paging_scope(*this);
     });
 
-    auto load_offset = get_load_offset(main_program_header, main_program_description, interpreter_description);
+    auto main_program_layout = ELFLoadLayoutCache::the().layout_for(*main_program_description->inode());
+    if (main_program_layout.is_error())
+        return main_program_layout.error();
+
+    RefPtr<ELFLoadLayout> interpreter_layout;
+    if (interpreter_description) {
+        auto interpreter_layout_or_error = ELFLoadLayoutCache::the().layout_for(*interpreter_description->inode());
+        if (interpreter_layout_or_error.is_error())
+            return interpreter_layout_or_error.error();
+        interpreter_layout = interpreter_layout_or_error.release_value();
+    }
+
+    auto load_offset = get_load_offset(*main_program_layout.value(), interpreter_layout.ptr());
     if (load_offset.is_error()) {
         return load_offset.error();
     }
 
     if (interpreter_description.is_null()) {
-        auto result = load_elf_object(new_space.release_nonnull(), main_program_description, load_offset.value(), ShouldAllocateTls::Yes, ShouldAllowSyscalls::No);
+        auto result = load_elf_object(new_space.release_nonnull(), main_program_description, *main_program_layout.value(), load_offset.value(), ShouldAllocateTls::Yes, ShouldAllowSyscalls::No);
         if (result.is_error())
             return result.error();
 
@@ -457,7 +397,7 @@ KResultOr<LoadResult> Process::load(NonnullRefPtr<FileDescription> main_program_
         return result;
     }
 
-    auto interpreter_load_result = load_elf_object(new_space.release_nonnull(), *interpreter_description, load_offset.value(), ShouldAllocateTls::No, ShouldAllowSyscalls::Yes);
+    auto interpreter_load_result = load_elf_object(new_space.release_nonnull(), *interpreter_description, *interpreter_layout, load_offset.value(), ShouldAllocateTls::No, ShouldAllowSyscalls::Yes);
 
     if (interpreter_load_result.is_error())
         return interpreter_load_result.error();
@@ -470,7 +410,7 @@ KResultOr<LoadResult> Process::load(NonnullRefPtr<FileDescription> main_program_
     return interpreter_load_result;
 }
 
-KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags, const Elf32_Ehdr& main_program_header)
+KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags)
 {
     VERIFY(is_user_process());
     VERIFY(!Processor::current().in_critical());
@@ -488,7 +428,7 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
 
     auto main_program_metadata = main_program_description->metadata();
 
-    auto load_result_or_error = load(main_program_description, interpreter_description, main_program_header);
+    auto load_result_or_error = load(main_program_description, interpreter_description);
     if (load_result_or_error.is_error()) {
         dbgln("do_exec: Failed to load main program or interpreter for {}", path);
         return load_result_or_error.error();
@@ -500,6 +440,12 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
         return ENOMEM;
     }
 
+    auto time_page_range = load_result_or_error.value().space->allocate_range({}, PAGE_SIZE);
+    if (!time_page_range.has_value()) {
+        dbgln("do_exec: Failed to allocate VM for time page");
+        return ENOMEM;
+    }
+
     // We commit to the new executable at this point. There is no turning back!
 
     // Prevent other processes from attaching to us with ptrace while we're doing this.
@@ -547,6 +493,11 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
 
     signal_trampoline_region.value()->set_syscall_region(true);
 
+    auto time_page_region = m_space->allocate_region_with_vmobject(time_page_range.value(), TimeManagement::the().time_page_region().vmobject(), 0, "Time page", PROT_READ, true);
+    if (time_page_region.is_error()) {
+        VERIFY_NOT_REACHED();
+    }
+
     m_executable = main_program_description->custody();
     m_arguments = arguments;
     m_environment = environment;
@@ -557,15 +508,12 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
 
     m_coredump_metadata.clear();
 
-    auto current_thread = Thread::current();
-    current_thread->clear_signals();
-
     clear_futex_queues_on_exec();
 
     for (size_t i = 0; i < m_fds.size(); ++i) {
         auto& description_and_flags = m_fds[i];
         if (description_and_flags.description() && description_and_flags.flags() & FD_CLOEXEC)
-            description_and_flags = {};
+            clear_file_description(i);
     }
 
     int main_program_fd = -1;
@@ -575,9 +523,11 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
         auto seek_result = main_program_description->seek(0, SEEK_SET);
         VERIFY(!seek_result.is_error());
         main_program_description->set_readable(true);
-        m_fds[main_program_fd].set(move(main_program_description), FD_CLOEXEC);
+        set_file_description(main_program_fd, move(main_program_description), FD_CLOEXEC);
     }
 
+    // NOTE: The kernel (and posix_spawn()) exec programs in processes other than their own.
+    auto current_thread = Thread::current();
     new_main_thread = nullptr;
     if (&current_thread->process() == this) {
         new_main_thread = current_thread;
@@ -588,8 +538,9 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
         });
     }
     VERIFY(new_main_thread);
+    new_main_thread->clear_signals();
 
-    auto auxv = generate_auxiliary_vector(load_result.load_base, load_result.entry_eip, uid(), euid(), gid(), egid(), path, main_program_fd);
+    auto auxv = generate_auxiliary_vector(load_result.load_base, load_result.entry_eip, uid(), euid(), gid(), egid(), path, main_program_fd, time_page_region.value()->vaddr());
 
     // NOTE: We create the new stack before disabling interrupts since it will zero-fault
     //       and we don't want to deal with faults after this point.
@@ -663,7 +614,7 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
     return KSuccess;
 }
 
-static Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base, FlatPtr entry_eip, uid_t uid, uid_t euid, gid_t gid, gid_t egid, String executable_path, int main_program_fd)
+static Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base, FlatPtr entry_eip, uid_t uid, uid_t euid, gid_t gid, gid_t egid, String executable_path, int main_program_fd, VirtualAddress time_page)
 {
     Vector<ELF::AuxiliaryValue> auxv;
     // PHDR/EXECFD
@@ -696,6 +647,8 @@ static Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base,
 
     auxv.append({ ELF::AuxiliaryValue::ExecFileDescriptor, main_program_fd });
 
+    auxv.append({ ELF::AuxiliaryValue::TimePage, time_page.as_ptr() });
+
     auxv.append({ ELF::AuxiliaryValue::Null, 0L });
     return auxv;
 }
@@ -879,7 +832,7 @@ KResult Process::exec(String path, Vector<String> arguments, Vector<String> envi
     // are cleaned up by the time we yield-teleport below.
     Thread* new_main_thread = nullptr;
     u32 prev_flags = 0;
-    auto result = do_exec(move(description), move(arguments), move(environment), move(interpreter_description), new_main_thread, prev_flags, *main_program_header);
+    auto result = do_exec(move(description), move(arguments), move(environment), move(interpreter_description), new_main_thread, prev_flags);
     if (result.is_error())
         return result;
 
@@ -903,6 +856,29 @@ KResult Process::exec(String path, Vector<String> arguments, Vector<String> envi
     return KSuccess;
 }
 
+bool Process::copy_user_strings(const Syscall::StringListArgument& list, Vector<String>& output)
+{
+    if (!list.length)
+        return true;
+    Checked size = sizeof(*list.strings);
+    size *= list.length;
+    if (size.has_overflow())
+        return false;
+    Vector<Syscall::StringArgument, 32> strings;
+    if (!strings.try_resize(list.length))
+        return false;
+    if (!copy_from_user(strings.data(), list.strings, list.length * sizeof(*list.strings)))
+        return false;
+    for (size_t i = 0; i < list.length; ++i) {
+        auto string = copy_string_from_user(strings[i]);
+        if (string.is_null())
+            return false;
+        if (!output.try_append(move(string)))
+            return false;
+    }
+    return true;
+}
+
 KResultOr<int> Process::sys$execve(Userspace<const Syscall::SC_execve_params*> user_params)
 {
     REQUIRE_PROMISE(exec);
@@ -924,28 +900,6 @@ KResultOr<int> Process::sys$execve(Userspace<const Syscall::SC_execve_params*> u
         path = path_arg.value()->view();
     }
 
-    auto copy_user_strings = [](const auto& list, auto& output) {
-        if (!list.length)
-            return true;
-        Checked size = sizeof(*list.strings);
-        size *= list.length;
-        if (size.has_overflow())
-            return false;
-        Vector<Syscall::StringArgument, 32> strings;
-        if (!strings.try_resize(list.length))
-            return false;
-        if (!copy_from_user(strings.data(), list.strings, list.length * sizeof(*list.strings)))
-            return false;
-        for (size_t i = 0; i < list.length; ++i) {
-            auto string = copy_string_from_user(strings[i]);
-            if (string.is_null())
-                return false;
-            if (!output.try_append(move(string)))
-                return false;
-        }
-        return true;
-    };
-
     Vector<String> arguments;
     if (!copy_user_strings(params.arguments, arguments))
         return EFAULT;
@@ -27,13 +27,13 @@ KResultOr<int> Process::sys$fcntl(int fd, int cmd, u32 arg)
         int new_fd = alloc_fd(arg_fd);
         if (new_fd < 0)
             return new_fd;
-        m_fds[new_fd].set(*description);
+        set_file_description(new_fd, *description);
         return new_fd;
     }
     case F_GETFD:
         return m_fds[fd].flags();
     case F_SETFD:
-        m_fds[fd].set_flags(arg);
+        set_fd_flags(fd, arg);
         break;
     case F_GETFL:
         return description->file_flags();
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -65,6 +66,14 @@ KResultOr<pid_t> Process::sys$fork(RegisterState& regs)
 
     {
         ScopedSpinLock lock(space().get_lock());
+        FlatPtr lowest_cow_address = 0;
+        FlatPtr highest_cow_address = 0;
+        ScopeGuard flush_guard([&] {
+            // Cloning made our own private regions copy-on-write. Flush all of
+            // them in one go rather than sending a TLB shootdown per region.
+            if (highest_cow_address)
+                MM.flush_tlb(&space().page_directory(), VirtualAddress(lowest_cow_address), (highest_cow_address - lowest_cow_address) / PAGE_SIZE);
+        });
         for (auto& region : space().regions()) {
             dbgln_if(FORK_DEBUG, "fork: cloning Region({}) '{}' @ {}", region, region->name(), region->vaddr());
             auto region_clone = region->clone(*child);
@@ -74,8 +83,16 @@ KResultOr<pid_t> Process::sys$fork(RegisterState& regs)
                 return ENOMEM;
             }
 
+            if (!region->is_shared()) {
+                if (!highest_cow_address || region->vaddr().get() < lowest_cow_address)
+                    lowest_cow_address = region->vaddr().get();
+                highest_cow_address = max(highest_cow_address, region->range().end().get());
+            }
+
+            // NOTE: The child's page tables get populated as it faults its pages in, so forking
+            //       costs us the pages the child touches rather than everything the parent has mapped.
             auto& child_region = child->space().add_region(region_clone.release_nonnull());
-            child_region.map(child->space().page_directory(), ShouldFlushTLB::No);
+            child_region.map_lazily(child->space().page_directory());
 
             if (region == m_master_tls_region.unsafe_ptr())
                 child->m_master_tls_region = child_region;
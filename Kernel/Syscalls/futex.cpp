@@ -31,6 +31,8 @@ FutexQueue::FutexQueue(FlatPtr user_address_or_offset, VMObject* vmobject)
 
 FutexQueue::~FutexQueue()
 {
+    if (m_pi_owner)
+        m_pi_owner->disinherit_priority(m_inherited_priority);
     if (m_is_global) {
         if (auto vmobject = m_vmobject.strong_ref())
             vmobject->unregister_on_deleted_handler(*this);
@@ -99,8 +101,7 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
     switch (cmd) {
     case FUTEX_WAIT:
     case FUTEX_WAIT_BITSET:
-    case FUTEX_REQUEUE:
-    case FUTEX_CMP_REQUEUE: {
+    case FUTEX_LOCK_PI: {
         if (params.timeout) {
             auto timeout_time = copy_time_from_user(params.timeout);
             if (!timeout_time.has_value())
@@ -128,6 +129,9 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
     // acquiring the queue lock
     RefPtr<VMObject> vmobject, vmobject2;
     if (!is_private) {
+        // NOTE: This syscall doesn't take the big lock, but munmap() and friends do, so we take it
+        //       here to make sure the regions stick around while we look at them.
+        Locker locker(big_lock());
         auto region = space().find_region_containing(Range { VirtualAddress { user_address_or_offset }, sizeof(u32) });
         if (!region)
             return EFAULT;
@@ -142,7 +146,7 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
             if (!region2)
                 return EFAULT;
             vmobject2 = region2->vmobject();
-            user_address_or_offset2 = region->offset_in_vmobject_from_vaddr(VirtualAddress(user_address_or_offset2));
+            user_address_or_offset2 = region2->offset_in_vmobject_from_vaddr(VirtualAddress(user_address_or_offset2));
             break;
         }
         }
@@ -266,10 +270,93 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
         return woken_or_requeued;
     };
 
+    auto do_lock_pi = [&]() -> int {
+        auto& current_thread = *Thread::current();
+        u32 tid = current_thread.tid().value();
+        for (;;) {
+            auto user_value = user_atomic_load_relaxed(params.userspace_address);
+            if (!user_value.has_value())
+                return EFAULT;
+            u32 value = user_value.value();
+            u32 owner_tid = value & FUTEX_TID_MASK;
+            if (owner_tid == tid)
+                return EDEADLK;
+
+            auto futex_queue = find_futex_queue(vmobject.ptr(), user_address_or_offset, true);
+            VERIFY(futex_queue);
+
+            if (owner_tid == 0) {
+                // Whoever's still waiting has to hear from us when we unlock it.
+                u32 new_value = tid | (futex_queue->is_empty() ? 0 : FUTEX_WAITERS);
+                auto did_exchange = user_atomic_compare_exchange_relaxed(params.userspace_address, value, new_value);
+                if (!did_exchange.has_value())
+                    return EFAULT;
+                if (!did_exchange.value())
+                    continue;
+                atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
+                futex_queue->did_lock_pi(current_thread);
+                if (futex_queue->is_empty())
+                    remove_futex_queue(vmobject, user_address_or_offset);
+                return 0;
+            }
+
+            if (!(value & FUTEX_WAITERS)) {
+                auto did_exchange = user_atomic_compare_exchange_relaxed(params.userspace_address, value, value | FUTEX_WAITERS);
+                if (!did_exchange.has_value())
+                    return EFAULT;
+                if (!did_exchange.value())
+                    continue;
+            }
+
+            // NOTE: Only threads of our own process can hold a private futex, so we don't let anyone else inherit from us.
+            auto owner = Thread::from_tid(owner_tid);
+            if (owner && (!is_private || &owner->process() == this))
+                futex_queue->lend_priority_to_pi_owner(*owner, current_thread.effective_priority());
+
+            lock.unlock();
+            Thread::BlockResult block_result = futex_queue->wait_on(timeout, 0);
+            lock.lock();
+            if (block_result == Thread::BlockResult::InterruptedByTimeout) {
+                if (futex_queue->is_empty())
+                    remove_futex_queue(vmobject, user_address_or_offset);
+                return ETIMEDOUT;
+            }
+        }
+    };
+
+    auto do_unlock_pi = [&]() -> int {
+        u32 tid = Thread::current()->tid().value();
+        auto user_value = user_atomic_load_relaxed(params.userspace_address);
+        if (!user_value.has_value())
+            return EFAULT;
+        if ((user_value.value() & FUTEX_TID_MASK) != tid)
+            return EPERM;
+
+        bool is_empty = true;
+        if (auto futex_queue = find_futex_queue(vmobject.ptr(), user_address_or_offset, false)) {
+            futex_queue->did_unlock_pi();
+            // The thread we wake up takes the futex over when it gets the queue lock, unless someone beats it to it.
+            futex_queue->wake_n(1, {}, is_empty);
+            if (is_empty)
+                remove_futex_queue(vmobject, user_address_or_offset);
+        }
+        // NOTE: Leaving FUTEX_WAITERS set keeps anyone else from taking the futex without going through us.
+        atomic_thread_fence(AK::MemoryOrder::memory_order_release);
+        if (!user_atomic_store_relaxed(params.userspace_address, is_empty ? 0 : FUTEX_WAITERS))
+            return EFAULT;
+        return 0;
+    };
+
     switch (cmd) {
     case FUTEX_WAIT:
         return do_wait(0);
 
+    case FUTEX_LOCK_PI:
+        return do_lock_pi();
+
+    case FUTEX_UNLOCK_PI:
+        return do_unlock_pi();
+
     case FUTEX_WAKE:
         return do_wake(vmobject.ptr(), user_address_or_offset, params.val, {});
 
@@ -279,7 +366,7 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
         auto op = _FUTEX_OP(params.val3);
         if (op & FUTEX_OP_ARG_SHIFT) {
             op_arg = 1 << op_arg;
-            op &= FUTEX_OP_ARG_SHIFT;
+            op &= ~FUTEX_OP_ARG_SHIFT;
         }
         atomic_thread_fence(AK::MemoryOrder::memory_order_release);
         switch (op) {
@@ -29,13 +29,13 @@ KResultOr<int> Process::sys$create_inode_watcher(u32 flags)
     if (description_or_error.is_error())
         return description_or_error.error();
 
-    m_fds[fd].set(description_or_error.release_value());
+    set_file_description(fd, description_or_error.release_value());
     m_fds[fd].description()->set_readable(true);
 
     if (flags & static_cast<unsigned>(InodeWatcherFlags::Nonblock))
         m_fds[fd].description()->set_blocking(false);
     if (flags & static_cast<unsigned>(InodeWatcherFlags::CloseOnExec))
-        m_fds[fd].set_flags(m_fds[fd].flags() | FD_CLOEXEC);
+        set_fd_flags(fd, fd_flags(fd) | FD_CLOEXEC);
 
     return fd;
 }
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+KResultOr<int> Process::sys$io_ring_create(unsigned entries, int options)
+{
+    REQUIRE_PROMISE(stdio);
+
+    if (options & ~O_CLOEXEC)
+        return EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto ring_or_error = IORing::create(*this, entries);
+    if (ring_or_error.is_error())
+        return ring_or_error.error();
+
+    auto description_or_error = FileDescription::create(*ring_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    auto description = description_or_error.release_value();
+    description->set_readable(true);
+    description->set_writable(true);
+
+    u32 fd_flags = 0;
+    if (options & O_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    set_file_description(fd, move(description), fd_flags);
+    return fd;
+}
+
+KResultOr<int> Process::sys$io_ring_enter(int fd, unsigned to_submit, unsigned min_complete)
+{
+    REQUIRE_PROMISE(stdio);
+
+    auto description = file_description(fd);
+    if (!description)
+        return EBADF;
+    auto* ring = description->io_ring();
+    if (!ring)
+        return EINVAL;
+
+    auto result = ring->enter(to_submit, min_complete);
+    if (result.is_error())
+        return result.error();
+    return (int)result.value();
+}
+
+}
@@ -466,6 +466,34 @@ KResultOr<int> Process::sys$madvise(Userspace<void*> address, size_t size, int a
             return EPERM;
         return region->is_volatile(VirtualAddress(address), size) ? 0 : 1;
     }
+    bool set_large_pages = advice & MADV_HUGEPAGE;
+    bool clear_large_pages = advice & MADV_NOHUGEPAGE;
+    if (set_large_pages && clear_large_pages)
+        return EINVAL;
+    if (set_large_pages || clear_large_pages) {
+        if (!region->vmobject().is_anonymous())
+            return EPERM;
+        region->set_large_pages_enabled(set_large_pages);
+        // Remapping the region switches any suitable 2 MiB ranges over to (or
+        // back from) large pages right away.
+        region->remap();
+        return 0;
+    }
+    bool set_mergeable = advice & MADV_MERGEABLE;
+    bool clear_mergeable = advice & MADV_UNMERGEABLE;
+    if (set_mergeable && clear_mergeable)
+        return EINVAL;
+    if (set_mergeable || clear_mergeable) {
+        if (!region->vmobject().is_anonymous() || region->is_shared())
+            return EPERM;
+        region->set_mergeable(set_mergeable);
+        if (set_mergeable && region->are_large_pages_enabled()) {
+            // The PageMergingTask only merges pages that have a page table entry of their own.
+            region->set_large_pages_enabled(false);
+            region->remap();
+        }
+        return 0;
+    }
     return EINVAL;
 }
 
@@ -513,6 +541,49 @@ KResultOr<int> Process::sys$munmap(Userspace<void*> addr, size_t size)
     return 0;
 }
 
+// Grows or shrinks an anonymous mapping without moving it, so nothing has to be copied.
+// NOTE: Growing maps a new region right after the old one, so a mapping that has been grown is made up of
+//       several regions. If anything else is mapped right after it, this fails and the caller has to move it.
+KResultOr<FlatPtr> Process::resize_anonymous_mapping(const Range& old_range, size_t new_size)
+{
+    auto range_or_error = expand_range_to_page_boundaries(old_range.base().get(), new_size);
+    if (range_or_error.is_error())
+        return range_or_error.error().error();
+    auto new_range = range_or_error.value();
+
+    if (new_range.size() == old_range.size())
+        return old_range.base().get();
+
+    if (new_range.size() < old_range.size()) {
+        auto result = space().unmap_mmap_range(new_range.end(), old_range.size() - new_range.size());
+        if (result.is_error())
+            return result.error();
+        return old_range.base().get();
+    }
+
+    auto* last_region = space().find_region_containing({ old_range.end().offset(-PAGE_SIZE), PAGE_SIZE });
+    if (!last_region || last_region->range().end() != old_range.end())
+        return EINVAL;
+    if (!last_region->is_mmap())
+        return EPERM;
+    if (!last_region->vmobject().is_anonymous() || last_region->is_shared() || last_region->is_stack())
+        return EINVAL;
+
+    auto extension_range = space().allocate_range(old_range.end(), new_range.size() - old_range.size());
+    if (!extension_range.has_value())
+        return ENOMEM;
+
+    auto region_or_error = space().allocate_region(extension_range.value(), last_region->name(), region_access_flags_to_prot(last_region->access()), AllocationStrategy::Reserve);
+    if (region_or_error.is_error())
+        return region_or_error.error().error();
+    auto& region = *region_or_error.value();
+    region.set_mmap(true);
+
+    PerformanceManager::add_mmap_perf_event(*this, region);
+
+    return old_range.base().get();
+}
+
 KResultOr<FlatPtr> Process::sys$mremap(Userspace<const Syscall::SC_mremap_params*> user_params)
 {
     REQUIRE_PROMISE(stdio);
@@ -527,6 +598,9 @@ KResultOr<FlatPtr> Process::sys$mremap(Userspace<const Syscall::SC_mremap_params
 
     auto old_range = range_or_error.value();
 
+    if (params.flags & MAP_ANONYMOUS)
+        return resize_anonymous_mapping(old_range, params.new_size);
+
     auto* old_region = space().find_region_from_range(old_range);
     if (!old_region)
         return EINVAL;
@@ -71,7 +71,7 @@ KResultOr<int> Process::sys$open(Userspace<const Syscall::SC_open_params*> user_
         return ENXIO;
 
     u32 fd_flags = (options & O_CLOEXEC) ? FD_CLOEXEC : 0;
-    m_fds[fd].set(move(description), fd_flags);
+    set_file_description(fd, move(description), fd_flags);
     return fd;
 }
 
@@ -83,7 +83,7 @@ KResultOr<int> Process::sys$close(int fd)
     if (!description)
         return EBADF;
     int rc = description->close();
-    m_fds[fd] = {};
+    clear_file_description(fd);
     return rc;
 }
 
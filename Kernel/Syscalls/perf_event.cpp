@@ -13,6 +13,9 @@ KResultOr<int> Process::sys$perf_event(int type, FlatPtr arg1, FlatPtr arg2)
 {
     auto events_buffer = current_perf_events_buffer();
     if (!events_buffer) {
+        // NOTE: The tracepoints are only for profiling everything, and may still fire just after that has stopped.
+        if (type & PERF_EVENT_USERSPACE_TRACEPOINTS)
+            return EINVAL;
         if (!create_perf_events_buffer_if_needed())
             return ENOMEM;
         events_buffer = perf_events();
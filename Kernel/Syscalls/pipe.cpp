@@ -30,13 +30,13 @@ KResultOr<int> Process::sys$pipe(int pipefd[2], int flags)
         return open_writer_result.error();
 
     int reader_fd = alloc_fd();
-    m_fds[reader_fd].set(open_reader_result.release_value(), fd_flags);
+    set_file_description(reader_fd, open_reader_result.release_value(), fd_flags);
     m_fds[reader_fd].description()->set_readable(true);
     if (!copy_to_user(&pipefd[0], &reader_fd))
         return EFAULT;
 
     int writer_fd = alloc_fd();
-    m_fds[writer_fd].set(open_writer_result.release_value(), fd_flags);
+    set_file_description(writer_fd, open_writer_result.release_value(), fd_flags);
     m_fds[writer_fd].description()->set_writable(true);
     if (!copy_to_user(&pipefd[1], &writer_fd))
         return EFAULT;
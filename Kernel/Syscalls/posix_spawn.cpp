@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/PerformanceManager.h>
+#include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibC/limits.h>
+
+namespace Kernel {
+
+// NOTE: This is called on the new process before it gets to run, but with the spawning process as the current one.
+//       The path has already been copied out of the spawning process.
+KResult Process::apply_posix_spawn_file_action(const Syscall::SC_posix_spawn_file_action& action, const String& path)
+{
+    switch (action.type) {
+    case Syscall::PosixSpawnFileActionType::Open: {
+        if (action.fd < 0 || action.fd >= m_max_open_file_descriptors)
+            return EBADF;
+        if (action.flags & (O_NOFOLLOW_NOERROR | O_UNLINK_INTERNAL))
+            return EINVAL;
+        if (action.flags & O_WRONLY)
+            REQUIRE_PROMISE(wpath);
+        else if (action.flags & O_RDONLY)
+            REQUIRE_PROMISE(rpath);
+        if (action.flags & O_CREAT)
+            REQUIRE_PROMISE(cpath);
+
+        auto description_or_error = VFS::the().open(path, action.flags, (action.mode & 0777) & ~umask(), current_directory());
+        if (description_or_error.is_error())
+            return description_or_error.error();
+        auto description = description_or_error.release_value();
+        if (description->inode() && description->inode()->socket())
+            return ENXIO;
+        set_file_description(action.fd, move(description), (action.flags & O_CLOEXEC) ? FD_CLOEXEC : 0);
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Close: {
+        auto description = file_description(action.fd);
+        if (!description)
+            return EBADF;
+        auto result = description->close();
+        clear_file_description(action.fd);
+        return result;
+    }
+    case Syscall::PosixSpawnFileActionType::Dup2: {
+        auto description = file_description(action.fd);
+        if (!description)
+            return EBADF;
+        if (action.new_fd < 0 || action.new_fd >= m_max_open_file_descriptors)
+            return EBADF;
+        // NOTE: Unlike in dup2(), duplicating a file descriptor onto itself clears FD_CLOEXEC.
+        set_file_description(action.new_fd, description.release_nonnull());
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Chdir: {
+        REQUIRE_PROMISE(rpath);
+        auto directory_or_error = VFS::the().open_directory(path, current_directory());
+        if (directory_or_error.is_error())
+            return directory_or_error.error();
+        m_cwd = *directory_or_error.value();
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Fchdir: {
+        auto description = file_description(action.fd);
+        if (!description)
+            return EBADF;
+        if (!description->is_directory())
+            return ENOTDIR;
+        if (!description->metadata().may_execute(*this))
+            return EACCES;
+        m_cwd = description->custody();
+        return KSuccess;
+    }
+    }
+    return EINVAL;
+}
+
+// Unlike fork() followed by execve(), this never copies our address space: the new process is
+// built straight from the executable, with the file actions and attributes applied in here.
+KResultOr<pid_t> Process::sys$posix_spawn(Userspace<const Syscall::SC_posix_spawn_params*> user_params)
+{
+    REQUIRE_PROMISE(proc);
+    REQUIRE_PROMISE(exec);
+
+    Syscall::SC_posix_spawn_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.arguments.length > ARG_MAX || params.environment.length > ARG_MAX)
+        return E2BIG;
+
+    String path;
+    {
+        auto path_arg = get_syscall_path_argument(params.path);
+        if (path_arg.is_error())
+            return path_arg.error();
+        path = path_arg.value()->view();
+    }
+
+    Vector<String> arguments;
+    if (!copy_user_strings(params.arguments, arguments))
+        return EFAULT;
+
+    Vector<String> environment;
+    if (!copy_user_strings(params.environment, environment))
+        return EFAULT;
+
+    // NOTE: exec() switches to the address space of the new process, so everything
+    //       it needs from ours has to be copied before that.
+    Vector<Syscall::SC_posix_spawn_file_action> file_actions;
+    Vector<String> file_action_paths;
+    if (params.file_action_count > 0) {
+        Checked size = sizeof(Syscall::SC_posix_spawn_file_action);
+        size *= params.file_action_count;
+        if (size.has_overflow())
+            return EFAULT;
+        if (!file_actions.try_resize(params.file_action_count) || !file_action_paths.try_resize(params.file_action_count))
+            return ENOMEM;
+        if (!copy_n_from_user(file_actions.data(), params.file_actions, params.file_action_count))
+            return EFAULT;
+        for (size_t i = 0; i < file_actions.size(); ++i) {
+            auto type = file_actions[i].type;
+            if (type != Syscall::PosixSpawnFileActionType::Open && type != Syscall::PosixSpawnFileActionType::Chdir)
+                continue;
+            auto path_arg = get_syscall_path_argument(file_actions[i].path);
+            if (path_arg.is_error())
+                return path_arg.error();
+            file_action_paths[i] = path_arg.value()->view();
+        }
+    }
+
+    int flags = params.attribute_flags;
+    if ((flags & POSIX_SPAWN_SETPGROUP) && params.pgroup < 0)
+        return EINVAL;
+    if ((flags & POSIX_SPAWN_SETSCHEDPARAM) && (params.priority < THREAD_PRIORITY_MIN || params.priority > THREAD_PRIORITY_MAX))
+        return EINVAL;
+
+    RefPtr<Thread> child_first_thread;
+    auto child = Process::create(child_first_thread, m_name, uid(), gid(), pid(), false, m_cwd, nullptr, m_tty);
+    if (!child || !child_first_thread)
+        return ENOMEM;
+    child->m_root_directory = m_root_directory;
+    child->m_root_directory_relative_to_global_root = m_root_directory_relative_to_global_root;
+    child->m_fds = m_fds;
+    child->m_pg = m_pg;
+
+    {
+        ProtectedDataMutationScope scope { *child };
+        child->m_promises = m_promises;
+        child->m_execpromises = m_execpromises;
+        child->m_has_promises = m_has_promises;
+        child->m_has_execpromises = m_has_execpromises;
+        child->m_sid = m_sid;
+        child->m_extra_gids = m_extra_gids;
+        child->m_umask = m_umask;
+        if (!(flags & POSIX_SPAWN_RESETIDS)) {
+            child->m_euid = m_euid;
+            child->m_egid = m_egid;
+        }
+    }
+
+    if (flags & POSIX_SPAWN_SETPGROUP) {
+        ProcessGroupID new_pgid = params.pgroup ? ProcessGroupID(params.pgroup) : child->pid().value();
+        if (new_pgid != child->pid().value()) {
+            // The group has to exist already, and be in our session.
+            auto new_sid = get_sid_from_pgid(new_pgid);
+            if (new_sid == -1 || new_sid != sid())
+                return EPERM;
+        }
+        child->m_pg = ProcessGroup::find_or_create(new_pgid);
+        if (!child->m_pg)
+            return ENOMEM;
+    }
+
+    if (flags & POSIX_SPAWN_SETSID) {
+        child->m_pg = ProcessGroup::create(ProcessGroupID(child->pid().value()));
+        if (!child->m_pg)
+            return ENOMEM;
+        child->m_tty = nullptr;
+        ProtectedDataMutationScope scope { *child };
+        child->m_sid = child->pid().value();
+    }
+
+    if (flags & POSIX_SPAWN_SETSCHEDPARAM) {
+        ScopedSpinLock lock(g_scheduler_lock);
+        child_first_thread->set_priority((u32)params.priority);
+    }
+
+    // NOTE: There's nothing to do for POSIX_SPAWN_SETSIGMASK and POSIX_SPAWN_SETSIGDEF,
+    //       since exec() resets the signal mask and all signal dispositions anyway.
+
+    for (size_t i = 0; i < file_actions.size(); ++i) {
+        auto result = child->apply_posix_spawn_file_action(file_actions[i], file_action_paths[i]);
+        if (result.is_error()) {
+            dbgln_if(EXEC_DEBUG, "posix_spawn: File action {} for {} failed: {}", i, path, result.error());
+            return result;
+        }
+    }
+
+    PerformanceManager::add_process_created_event(*child);
+
+    auto result = child->exec(path, move(arguments), move(environment));
+    // exec() sets up the new program from inside its address space, so we have to come back to ours.
+    MemoryManager::enter_space(space());
+    if (result.is_error())
+        return result;
+
+    {
+        ScopedSpinLock lock(g_processes_lock);
+        g_processes->prepend(*child);
+    }
+
+    auto child_pid = child->pid().value();
+    // We need to leak one reference so we don't destroy the Process,
+    // which will be dropped by Process::reap
+    (void)child.leak_ref();
+    return child_pid;
+}
+
+}
@@ -7,6 +7,7 @@
 #include <Kernel/CoreDump.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/HardwarePerformanceCounters.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/Time/TimeManagement.h>
@@ -16,6 +17,7 @@ namespace Kernel {
 bool g_profiling_all_threads;
 PerformanceEventBuffer* g_global_perf_events;
 u64 g_profiling_event_mask;
+static bool s_profiling_all_threads_with_hardware_counters;
 
 KResultOr<int> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
 {
@@ -34,6 +36,13 @@ KResultOr<int> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
         ScopedSpinLock lock(g_processes_lock);
         if (!TimeManagement::the().enable_profile_timer())
             return ENOTSUP;
+        if ((event_mask & HardwarePerformanceCounters::event_mask) && !s_profiling_all_threads_with_hardware_counters) {
+            if (auto result = HardwarePerformanceCounters::the().enable(event_mask); result.is_error()) {
+                TimeManagement::the().disable_profile_timer();
+                return result;
+            }
+            s_profiling_all_threads_with_hardware_counters = true;
+        }
         g_profiling_all_threads = true;
         PerformanceManager::add_process_created_event(*Scheduler::colonel());
         Process::for_each([](auto& process) {
@@ -41,6 +50,7 @@ KResultOr<int> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
             return IterationDecision::Continue;
         });
         g_profiling_event_mask = event_mask;
+        TimeManagement::the().set_tracepoint_event_mask(event_mask & PERF_EVENT_USERSPACE_TRACEPOINTS);
         return 0;
     }
 
@@ -63,6 +73,14 @@ KResultOr<int> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
         process->set_profiling(false);
         return ENOTSUP;
     }
+    if ((event_mask & HardwarePerformanceCounters::event_mask) && !process->m_profiling_with_hardware_counters) {
+        if (auto result = HardwarePerformanceCounters::the().enable(event_mask); result.is_error()) {
+            TimeManagement::the().disable_profile_timer();
+            process->set_profiling(false);
+            return result;
+        }
+        process->m_profiling_with_hardware_counters = true;
+    }
     return 0;
 }
 
@@ -76,7 +94,12 @@ KResultOr<int> Process::sys$profiling_disable(pid_t pid)
         ScopedCritical critical;
         if (!TimeManagement::the().disable_profile_timer())
             return ENOTSUP;
+        if (s_profiling_all_threads_with_hardware_counters) {
+            HardwarePerformanceCounters::the().disable();
+            s_profiling_all_threads_with_hardware_counters = false;
+        }
         g_profiling_all_threads = false;
+        TimeManagement::the().set_tracepoint_event_mask(0);
         return 0;
     }
 
@@ -91,6 +114,7 @@ KResultOr<int> Process::sys$profiling_disable(pid_t pid)
     // FIXME: If we enabled the profile timer and it's not supported, how do we disable it now?
     if (!TimeManagement::the().disable_profile_timer())
         return ENOTSUP;
+    process->disable_hardware_performance_counters_if_needed();
     process->set_profiling(false);
     return 0;
 }
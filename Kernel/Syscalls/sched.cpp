@@ -84,4 +84,153 @@ KResultOr<int> Process::sys$sched_getparam(pid_t pid, Userspace<struct sched_par
     return 0;
 }
 
+KResultOr<int> Process::sys$sched_setscheduler(pid_t pid, int policy, Userspace<const struct sched_param*> user_param)
+{
+    REQUIRE_PROMISE(proc);
+    struct sched_param desired_param;
+    if (!copy_from_user(&desired_param, user_param))
+        return EFAULT;
+
+    Thread::SchedulingPolicy desired_policy;
+    switch (policy) {
+    case SCHED_FIFO:
+        desired_policy = Thread::SchedulingPolicy::FIFO;
+        break;
+    case SCHED_RR:
+        desired_policy = Thread::SchedulingPolicy::RoundRobin;
+        break;
+    case SCHED_OTHER:
+    case SCHED_BATCH:
+        desired_policy = Thread::SchedulingPolicy::Other;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    if (desired_param.sched_priority < THREAD_PRIORITY_MIN || desired_param.sched_priority > THREAD_PRIORITY_MAX)
+        return EINVAL;
+
+    // Real-time threads get to run before everyone else, so only the superuser may make them.
+    if (desired_policy != Thread::SchedulingPolicy::Other && !is_superuser())
+        return EPERM;
+
+    auto* peer = Thread::current();
+    ScopedSpinLock lock(g_scheduler_lock);
+    if (pid != 0) {
+        // FIXME: PID/TID BUG
+        // The entire process is supposed to be affected.
+        peer = Thread::from_tid(pid);
+    }
+
+    if (!peer)
+        return ESRCH;
+
+    if (!is_superuser() && euid() != peer->process().uid() && uid() != peer->process().uid())
+        return EPERM;
+
+    peer->set_scheduling_policy(desired_policy, (u32)desired_param.sched_priority);
+    return 0;
+}
+
+KResultOr<int> Process::sys$sched_getscheduler(pid_t pid)
+{
+    REQUIRE_PROMISE(proc);
+    auto* peer = Thread::current();
+    ScopedSpinLock lock(g_scheduler_lock);
+    if (pid != 0) {
+        // FIXME: PID/TID BUG
+        // The entire process is supposed to be affected.
+        peer = Thread::from_tid(pid);
+    }
+
+    if (!peer)
+        return ESRCH;
+
+    switch (peer->scheduling_policy()) {
+    case Thread::SchedulingPolicy::FIFO:
+        return SCHED_FIFO;
+    case Thread::SchedulingPolicy::RoundRobin:
+        return SCHED_RR;
+    case Thread::SchedulingPolicy::Other:
+        break;
+    }
+    return SCHED_OTHER;
+}
+
+KResultOr<int> Process::sys$sched_setaffinity(pid_t pid, size_t cpusetsize, Userspace<const cpu_set_t*> user_mask)
+{
+    REQUIRE_PROMISE(proc);
+    if (cpusetsize < sizeof(cpu_set_t))
+        return EINVAL;
+
+    cpu_set_t desired_mask;
+    if (!copy_from_user(&desired_mask, user_mask))
+        return EFAULT;
+
+    // Silently ignore processors that don't exist (or that we don't schedule on),
+    // but refuse masks that would leave the thread with nowhere to run.
+    u32 affinity = desired_mask.__bits & Scheduler::schedulable_processors_mask();
+    if (affinity == 0)
+        return EINVAL;
+
+    bool needs_migration = false;
+    {
+        auto* peer = Thread::current();
+        ScopedSpinLock lock(g_scheduler_lock);
+        if (pid != 0) {
+            // FIXME: PID/TID BUG
+            // The entire process is supposed to be affected.
+            peer = Thread::from_tid(pid);
+        }
+
+        if (!peer)
+            return ESRCH;
+
+        if (!is_superuser() && euid() != peer->process().uid() && uid() != peer->process().uid())
+            return EPERM;
+
+        peer->set_affinity(affinity);
+        needs_migration = peer == Thread::current() && !(affinity & (1u << Processor::id()));
+    }
+
+    // If we're no longer allowed to run on this processor, give it up
+    // right away so another processor can pick us up.
+    if (needs_migration)
+        Thread::current()->yield_without_holding_big_lock();
+    return 0;
+}
+
+KResultOr<int> Process::sys$sched_getaffinity(pid_t pid, size_t cpusetsize, Userspace<cpu_set_t*> user_mask)
+{
+    REQUIRE_PROMISE(proc);
+    if (cpusetsize < sizeof(cpu_set_t))
+        return EINVAL;
+
+    u32 affinity;
+    {
+        auto* peer = Thread::current();
+        ScopedSpinLock lock(g_scheduler_lock);
+        if (pid != 0) {
+            // FIXME: PID/TID BUG
+            // The entire process is supposed to be affected.
+            peer = Thread::from_tid(pid);
+        }
+
+        if (!peer)
+            return ESRCH;
+
+        if (!is_superuser() && euid() != peer->process().uid() && uid() != peer->process().uid())
+            return EPERM;
+
+        affinity = peer->affinity() & Scheduler::schedulable_processors_mask();
+    }
+
+    cpu_set_t mask {
+        affinity
+    };
+    if (!copy_to_user(user_mask, &mask))
+        return EFAULT;
+    return 0;
+}
+
 }
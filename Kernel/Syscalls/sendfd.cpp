@@ -58,7 +58,7 @@ KResultOr<int> Process::sys$recvfd(int sockfd, int options)
     if (options & O_CLOEXEC)
         fd_flags |= FD_CLOEXEC;
 
-    m_fds[new_fd].set(*received_descriptor_or_error.value(), fd_flags);
+    set_file_description(new_fd, *received_descriptor_or_error.value(), fd_flags);
     return new_fd;
 }
 
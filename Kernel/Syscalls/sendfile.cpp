@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+#include <Kernel/VM/PageCache.h>
+
+namespace Kernel {
+
+static constexpr size_t SENDFILE_CHUNK_SIZE = 64 * KiB;
+
+KResultOr<ssize_t> Process::sys$sendfile(Userspace<const Syscall::SC_sendfile_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.count > static_cast<size_t>(NumericLimits<ssize_t>::max()))
+        return EINVAL;
+    if (params.count == 0)
+        return 0;
+
+    auto in_description = file_description(params.in_fd);
+    if (!in_description)
+        return EBADF;
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    // The data is pulled straight out of the inode (and the page cache), so only inode files can be a source.
+    if (!in_description->file().is_inode() || !in_description->inode())
+        return EINVAL;
+
+    auto out_description = file_description(params.out_fd);
+    if (!out_description)
+        return EBADF;
+    if (!out_description->is_writable())
+        return EBADF;
+
+    off_t offset = in_description->offset();
+    if (params.offset) {
+        if (!copy_from_user(&offset, params.offset))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+    }
+
+    auto chunk = KBuffer::try_create_with_size(min(page_round_up(params.count), SENDFILE_CHUNK_SIZE), Region::Access::Read | Region::Access::Write, "sendfile");
+    if (!chunk)
+        return ENOMEM;
+    auto chunk_buffer = UserOrKernelBuffer::for_kernel_buffer(chunk->data());
+
+    auto& inode = *in_description->inode();
+    bool use_page_cache = !in_description->is_direct() && PageCache::is_cacheable(inode);
+    size_t total_nsent = 0;
+    KResult error = KSuccess;
+    while (total_nsent < params.count) {
+        auto nread_to_try = min(params.count - total_nsent, chunk->size());
+        auto nread_or_error = use_page_cache
+            ? PageCache::the().read(inode, offset, nread_to_try, chunk_buffer)
+            : inode.read_bytes(offset, nread_to_try, chunk_buffer, in_description);
+        if (nread_or_error.is_error()) {
+            error = nread_or_error.error();
+            break;
+        }
+        auto nread = static_cast<size_t>(nread_or_error.value());
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, chunk_buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            error = nwritten_or_error.error();
+            break;
+        }
+        auto nwritten = static_cast<size_t>(nwritten_or_error.value());
+        offset += nwritten;
+        total_nsent += nwritten;
+        if (nwritten < nread)
+            break;
+    }
+
+    if (total_nsent == 0 && error.is_error())
+        return error;
+
+    if (params.offset) {
+        if (!copy_to_user(params.offset, &offset))
+            return EFAULT;
+    } else {
+        auto seek_result = in_description->seek(offset, SEEK_SET);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+
+    return total_nsent;
+}
+
+}
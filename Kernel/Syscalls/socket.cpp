@@ -8,6 +8,7 @@
 #include <Kernel/Net/IPv4Socket.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel {
@@ -29,7 +30,7 @@ void Process::setup_socket_fd(int fd, NonnullRefPtr<FileDescription> description
         flags |= FD_CLOEXEC;
     if (type & SOCK_NONBLOCK)
         description->set_blocking(false);
-    m_fds[fd].set(*description, flags);
+    set_file_description(fd, *description, flags);
 }
 
 KResultOr<int> Process::sys$socket(int domain, int type, int protocol)
@@ -96,9 +97,6 @@ KResultOr<int> Process::sys$accept4(Userspace<const Syscall::SC_accept4_params*>
     if (user_address && !copy_from_user(&address_size, static_ptr_cast<const socklen_t*>(user_address_size)))
         return EFAULT;
 
-    int accepted_socket_fd = alloc_fd();
-    if (accepted_socket_fd < 0)
-        return accepted_socket_fd;
     auto accepting_socket_description = file_description(accepting_socket_fd);
     if (!accepting_socket_description)
         return EBADF;
@@ -115,6 +113,24 @@ KResultOr<int> Process::sys$accept4(Userspace<const Syscall::SC_accept4_params*>
             return EAGAIN;
         }
     }
+
+    auto accepted_socket_fd_or_error = accept_pending_connection(*accepting_socket_description, user_address, address_size, flags);
+    if (accepted_socket_fd_or_error.is_error())
+        return accepted_socket_fd_or_error.error();
+    if (user_address && !copy_to_user(user_address_size, &address_size))
+        return EFAULT;
+    return accepted_socket_fd_or_error.value();
+}
+
+KResultOr<int> Process::accept_pending_connection(FileDescription& accepting_socket_description, Userspace<sockaddr*> user_address, socklen_t& address_size, int flags)
+{
+    auto& socket = *accepting_socket_description.socket();
+    VERIFY(socket.can_accept());
+
+    int accepted_socket_fd = alloc_fd();
+    if (accepted_socket_fd < 0)
+        return accepted_socket_fd;
+
     auto accepted_socket = socket.accept();
     VERIFY(accepted_socket);
 
@@ -124,8 +140,6 @@ KResultOr<int> Process::sys$accept4(Userspace<const Syscall::SC_accept4_params*>
         accepted_socket->get_peer_address((sockaddr*)address_buffer, &address_size);
         if (!copy_to_user(user_address, address_buffer, address_size))
             return EFAULT;
-        if (!copy_to_user(user_address_size, &address_size))
-            return EFAULT;
     }
 
     auto accepted_socket_description_result = FileDescription::create(*accepted_socket);
@@ -139,7 +153,7 @@ KResultOr<int> Process::sys$accept4(Userspace<const Syscall::SC_accept4_params*>
     int fd_flags = 0;
     if (flags & SOCK_CLOEXEC)
         fd_flags |= FD_CLOEXEC;
-    m_fds[accepted_socket_fd].set(accepted_socket_description_result.release_value(), fd_flags);
+    set_file_description(accepted_socket_fd, accepted_socket_description_result.release_value(), fd_flags);
 
     // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
     accepted_socket->set_setup_state(Socket::SetupState::Completed);
@@ -179,9 +193,8 @@ KResultOr<int> Process::sys$shutdown(int sockfd, int how)
     return socket.shutdown(how);
 }
 
-KResultOr<ssize_t> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
+static KResultOr<ssize_t> send_message(FileDescription& description, Userspace<const struct msghdr*> user_msg, int flags)
 {
-    REQUIRE_PROMISE(stdio);
     struct msghdr msg;
     if (!copy_from_user(&msg, user_msg))
         return EFAULT;
@@ -197,27 +210,31 @@ KResultOr<ssize_t> Process::sys$sendmsg(int sockfd, Userspace<const struct msghd
     Userspace<const sockaddr*> user_addr((FlatPtr)msg.msg_name);
     socklen_t addr_length = msg.msg_namelen;
 
-    auto description = file_description(sockfd);
-    if (!description)
-        return EBADF;
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
+    auto& socket = *description.socket();
     if (socket.is_shut_down_for_writing())
         return EPIPE;
     auto data_buffer = UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len);
     if (!data_buffer.has_value())
         return EFAULT;
-    auto result = socket.sendto(*description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, addr_length);
+    auto result = socket.sendto(description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, addr_length);
     if (result.is_error())
         return result.error();
     return result.value();
 }
 
-KResultOr<ssize_t> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+KResultOr<ssize_t> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
 {
     REQUIRE_PROMISE(stdio);
+    auto description = file_description(sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    return send_message(*description, user_msg, flags);
+}
 
+static KResultOr<ssize_t> receive_message(FileDescription& description, Userspace<struct msghdr*> user_msg, int flags)
+{
     struct msghdr msg;
     if (!copy_from_user(&msg, user_msg))
         return EFAULT;
@@ -233,27 +250,22 @@ KResultOr<ssize_t> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> us
     Userspace<sockaddr*> user_addr((FlatPtr)msg.msg_name);
     Userspace<socklen_t*> user_addr_length(msg.msg_name ? (FlatPtr)&user_msg.unsafe_userspace_ptr()->msg_namelen : 0);
 
-    auto description = file_description(sockfd);
-    if (!description)
-        return EBADF;
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
+    auto& socket = *description.socket();
 
     if (socket.is_shut_down_for_reading())
         return 0;
 
-    bool original_blocking = description->is_blocking();
+    bool original_blocking = description.is_blocking();
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(false);
+        description.set_blocking(false);
 
     auto data_buffer = UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len);
     if (!data_buffer.has_value())
         return EFAULT;
     Time timestamp {};
-    auto result = socket.recvfrom(*description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
+    auto result = socket.recvfrom(description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(original_blocking);
+        description.set_blocking(original_blocking);
 
     if (result.is_error())
         return result.error();
@@ -288,6 +300,94 @@ KResultOr<ssize_t> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> us
     return result.value();
 }
 
+KResultOr<ssize_t> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    auto description = file_description(sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    return receive_message(*description, user_msg, flags);
+}
+
+// Same as Linux, so nobody can make us loop forever in one go.
+static constexpr unsigned max_messages_per_batch = 1024;
+
+KResultOr<int> Process::sys$sendmmsg(Userspace<const Syscall::SC_sendmmsg_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendmmsg_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto description = file_description(params.sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+
+    unsigned count = min(params.count, max_messages_per_batch);
+    for (unsigned i = 0; i < count; ++i) {
+        auto* user_message = &params.messages[i];
+        auto result = send_message(*description, Userspace<const struct msghdr*>((FlatPtr)&user_message->msg_hdr), params.flags);
+        // NOTE: If some of the messages went out already, the caller finds out about the error with the next one it sends.
+        if (result.is_error()) {
+            if (i > 0)
+                return (int)i;
+            return result.error();
+        }
+        unsigned length = result.value();
+        if (!copy_to_user(&user_message->msg_len, &length))
+            return EFAULT;
+    }
+    return (int)count;
+}
+
+KResultOr<int> Process::sys$recvmmsg(Userspace<const Syscall::SC_recvmmsg_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_recvmmsg_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    Optional<Time> deadline;
+    if (params.timeout) {
+        auto timeout = copy_time_from_user(params.timeout);
+        if (!timeout.has_value())
+            return EFAULT;
+        deadline = TimeManagement::the().monotonic_time() + timeout.value();
+    }
+
+    auto description = file_description(params.sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+
+    int flags = params.flags;
+    unsigned count = min(params.count, max_messages_per_batch);
+    for (unsigned i = 0; i < count; ++i) {
+        auto* user_message = &params.messages[i];
+        auto result = receive_message(*description, Userspace<struct msghdr*>((FlatPtr)&user_message->msg_hdr), flags);
+        // NOTE: If we got some messages already, the caller finds out about the error with the next call.
+        if (result.is_error()) {
+            if (i > 0)
+                return (int)i;
+            return result.error();
+        }
+        unsigned length = result.value();
+        if (!copy_to_user(&user_message->msg_len, &length))
+            return EFAULT;
+        // Like on Linux, the timeout is only looked at between messages.
+        if (deadline.has_value() && TimeManagement::the().monotonic_time() >= deadline.value())
+            return (int)(i + 1);
+        if (flags & MSG_WAITFORONE)
+            flags |= MSG_DONTWAIT;
+    }
+    return (int)count;
+}
+
 template<bool sockname, typename Params>
 int Process::get_sock_or_peer_name(const Params& params)
 {
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Tasklet.h>
+
+namespace Kernel {
+
+// How many tasklet runs a processor does every time it leaves an interrupt. Whatever is left over
+// waits for the next interrupt, which is at most a timer tick away.
+static constexpr size_t MAX_RUNS_PER_INTERRUPT = 4;
+
+// NOTE: Only its own processor touches a queue, and only with interrupts disabled.
+static Array<Tasklet::List, 8> s_scheduled_tasklets;
+
+Tasklet::Tasklet(Callback callback)
+    : m_callback(move(callback))
+{
+}
+
+Tasklet::~Tasklet()
+{
+    VERIFY(m_state == State::Idle);
+}
+
+void Tasklet::queue_on_current_processor()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    s_scheduled_tasklets[Processor::id()].append(*this);
+}
+
+void Tasklet::schedule()
+{
+    auto state = m_state.load(AK::MemoryOrder::memory_order_relaxed);
+    for (;;) {
+        switch (state) {
+        case State::Idle:
+            if (m_state.compare_exchange_strong(state, State::Scheduled, AK::MemoryOrder::memory_order_acq_rel)) {
+                InterruptDisabler disabler;
+                queue_on_current_processor();
+                return;
+            }
+            break;
+        case State::Running:
+            if (m_state.compare_exchange_strong(state, State::RunningAndScheduled, AK::MemoryOrder::memory_order_acq_rel))
+                return;
+            break;
+        case State::Scheduled:
+        case State::RunningAndScheduled:
+            return;
+        }
+    }
+}
+
+void Tasklet::run_scheduled_on_current_processor()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    auto& processor = Processor::current();
+    auto& queue = s_scheduled_tasklets[processor.id()];
+    if (queue.is_empty())
+        return;
+
+    // Pretend we're still in an interrupt handler, so tasklets can't block, the scheduler
+    // waits until we're done, and nested interrupts don't start running tasklets themselves.
+    auto& in_irq = processor.in_irq();
+    VERIFY(in_irq == 0);
+    in_irq = 1;
+
+    for (size_t run = 0; run < MAX_RUNS_PER_INTERRUPT; ++run) {
+        auto* tasklet = queue.take_first();
+        if (!tasklet)
+            break;
+        tasklet->m_state.store(State::Running, AK::MemoryOrder::memory_order_release);
+
+        sti();
+        bool has_more = tasklet->m_callback(budget);
+        cli();
+
+        auto state = State::Running;
+        if (!has_more && tasklet->m_state.compare_exchange_strong(state, State::Idle, AK::MemoryOrder::memory_order_acq_rel))
+            continue;
+        tasklet->m_state.store(State::Scheduled, AK::MemoryOrder::memory_order_release);
+        tasklet->queue_on_current_processor();
+    }
+
+    in_irq = 0;
+}
+
+}
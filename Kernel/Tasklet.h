@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Work that an interrupt handler leaves to be done right after the interrupt, on the processor that took it.
+//
+// Tasklets run as soon as the processor is back out of all interrupt handlers, with interrupts enabled, but
+// they can't block or be preempted, just like interrupt handlers. Every run only gets a small budget, and a
+// tasklet that has more work left goes to the back of the line, so a busy device can't hog the processor.
+// Anything that may block or fault (like copying to a userspace buffer) still has to go to a WorkQueue.
+//
+// A tasklet never runs on two processors at once. Scheduling it while it's queued does nothing, and
+// scheduling it while it's running makes it run again afterwards.
+class Tasklet {
+    AK_MAKE_NONCOPYABLE(Tasklet);
+    AK_MAKE_NONMOVABLE(Tasklet);
+
+public:
+    static constexpr size_t budget = 64;
+
+    // Does up to `budget` units of work (what a unit is, is up to the tasklet), and returns true if there's more to do.
+    using Callback = Function<bool(size_t budget)>;
+
+    explicit Tasklet(Callback);
+    ~Tasklet();
+
+    // Meant to be called from interrupt handlers. From anywhere else, the tasklet only runs after the next interrupt.
+    void schedule();
+
+    // Called when the current processor leaves its outermost interrupt, with interrupts disabled.
+    static void run_scheduled_on_current_processor();
+
+private:
+    enum class State : u8 {
+        Idle,
+        Scheduled,
+        Running,
+        RunningAndScheduled,
+    };
+
+    void queue_on_current_processor();
+
+    Callback m_callback;
+    Atomic<State> m_state { State::Idle };
+    IntrusiveListNode<Tasklet> m_list_node;
+
+public:
+    using List = IntrusiveList<Tasklet, RawPtr<Tasklet>, &Tasklet::m_list_node>;
+};
+
+}
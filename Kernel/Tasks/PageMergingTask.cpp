@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/WeakPtr.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/PageMergingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// How long we wait between going through the mergeable regions.
+static constexpr i64 SECONDS_BETWEEN_PASSES = 5;
+// How many pages we look at before letting go of the locks.
+static constexpr size_t PAGES_PER_BATCH = 256;
+// How many pages a pass remembers the contents of. Pages we see after that may still get merged into these.
+static constexpr size_t MAX_CANDIDATES = 64 * KiB;
+
+struct MergeCandidate {
+    WeakPtr<Region> region;
+    size_t page_index { 0 };
+};
+
+// The first page we've seen with each hash during the current pass.
+using MergeCandidates = HashMap<u32, MergeCandidate>;
+
+// Goes through the mergeable regions of the process, a batch of pages at a time. Returns how many pages it merged.
+static size_t scan_process(Process& process, MergeCandidates& candidates)
+{
+    size_t merged_count = 0;
+    FlatPtr cursor = 0;
+    for (;;) {
+        // NOTE: Holding the big lock keeps the process from exec'ing (and replacing its address space) on us.
+        Locker locker(process.big_lock());
+        if (process.is_dead())
+            break;
+        auto& space = process.space();
+        ScopedSpinLock mm_lock(s_mm_lock);
+        ScopedSpinLock space_lock(space.get_lock());
+
+        Region* region = nullptr;
+        for (auto& candidate : space.regions()) {
+            if (candidate->range().end().get() > cursor && candidate->is_mergeable()) {
+                region = candidate.ptr();
+                break;
+            }
+        }
+        if (!region)
+            break;
+
+        size_t first_page_index = cursor > region->vaddr().get() ? (cursor - region->vaddr().get()) / PAGE_SIZE : 0;
+        size_t page_count = min(region->page_count() - first_page_index, PAGES_PER_BATCH);
+        for (size_t i = first_page_index; i < first_page_index + page_count; ++i) {
+            auto hash = region->hash_page_for_merging(i);
+            if (!hash.has_value())
+                continue;
+            auto it = candidates.find(hash.value());
+            if (it == candidates.end()) {
+                if (candidates.size() < MAX_CANDIDATES)
+                    candidates.set(hash.value(), { region->make_weak_ptr(), i });
+                continue;
+            }
+            // NOTE: A region that's going away has to take the MM lock to unmap itself, so it's still around if we can get to it.
+            auto* other_region = it->value.region.unsafe_ptr();
+            if (!other_region) {
+                it->value = { region->make_weak_ptr(), i };
+                continue;
+            }
+            if (region->try_merge_page(i, *other_region, it->value.page_index))
+                ++merged_count;
+        }
+        cursor = region->vaddr_from_page_index(first_page_index + page_count).get();
+    }
+    return merged_count;
+}
+
+UNMAP_AFTER_INIT void PageMergingTask::spawn()
+{
+    RefPtr<Thread> page_merging_thread;
+    Process::create_kernel_process(page_merging_thread, "PageMergingTask", [] {
+        Thread::current()->set_priority(THREAD_PRIORITY_MIN);
+        for (;;) {
+            (void)Thread::current()->sleep(Time::from_seconds(SECONDS_BETWEEN_PASSES));
+
+            MergeCandidates candidates;
+            size_t merged_count = 0;
+            for (auto& process : Process::all_processes()) {
+                if (process.is_kernel_process())
+                    continue;
+                merged_count += scan_process(process, candidates);
+            }
+            if (merged_count)
+                dbgln_if(PAGE_FAULT_DEBUG, "PageMergingTask: Merged {} pages", merged_count);
+        }
+    });
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/PageReclaimTask.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
+
+namespace Kernel {
+
+// Once free memory drops below 1/AGING_FRACTION of all user memory, we start keeping track of which pages
+// are in use. Below 1/COMPRESSION_FRACTION, we first evict what we can from the page cache, and then compress
+// the pages that haven't been used in a while.
+static constexpr size_t AGING_FRACTION = 4;
+static constexpr size_t COMPRESSION_FRACTION = 16;
+// How many aging passes a page has to sit through untouched before it's cold enough to be compressed.
+static constexpr u8 COLD_PAGE_AGE = 4;
+// How many pages we look at before letting go of the locks.
+static constexpr size_t PAGES_PER_BATCH = 512;
+
+// Goes through the user regions of the process, a batch of pages at a time. Returns how many pages it compressed.
+static size_t scan_process(Process& process, bool compress, size_t pages_wanted)
+{
+    size_t compressed_count = 0;
+    FlatPtr cursor = 0;
+    for (;;) {
+        // NOTE: Holding the big lock keeps the process from exec'ing (and replacing its address space) on us.
+        Locker locker(process.big_lock());
+        if (process.is_dead())
+            break;
+        auto& space = process.space();
+        ScopedSpinLock mm_lock(s_mm_lock);
+        ScopedSpinLock space_lock(space.get_lock());
+
+        Region* region = nullptr;
+        for (auto& candidate : space.regions()) {
+            if (candidate->range().end().get() > cursor) {
+                region = candidate.ptr();
+                break;
+            }
+        }
+        if (!region)
+            break;
+
+        size_t first_page_index = cursor > region->vaddr().get() ? (cursor - region->vaddr().get()) / PAGE_SIZE : 0;
+        size_t page_count = min(region->page_count() - first_page_index, PAGES_PER_BATCH);
+        region->age_pages(first_page_index, page_count);
+        if (compress && compressed_count < pages_wanted)
+            compressed_count += region->compress_cold_pages(first_page_index, page_count, COLD_PAGE_AGE);
+        cursor = region->vaddr_from_page_index(first_page_index + page_count).get();
+    }
+    return compressed_count;
+}
+
+UNMAP_AFTER_INIT void PageReclaimTask::spawn()
+{
+    RefPtr<Thread> page_reclaim_thread;
+    Process::create_kernel_process(page_reclaim_thread, "PageReclaimTask", [] {
+        Thread::current()->set_priority(THREAD_PRIORITY_MIN);
+        for (;;) {
+            MM.wait_for_page_reclaim_demand(Time::from_seconds(1));
+
+            // Page faults and anonymous allocations never go through the page cache, so shrink it from here.
+            PageCache::the().reclaim_if_needed();
+
+            size_t available = MM.user_physical_pages_uncommitted();
+            if (available >= MM.user_physical_pages() / AGING_FRACTION)
+                continue;
+            size_t compression_reserve = MM.user_physical_pages() / COMPRESSION_FRACTION;
+            if (available < compression_reserve) {
+                // Clean cached file pages that nobody has mapped can simply be dropped and read back later, which
+                // is a lot cheaper than compressing anonymous memory. So we only compress what the cache can't cover.
+                auto reclaimed_count = PageCache::the().reclaim(compression_reserve - available);
+                if (reclaimed_count)
+                    dbgln_if(PAGE_FAULT_DEBUG, "PageReclaimTask: Reclaimed {} page cache pages", reclaimed_count);
+                available = MM.user_physical_pages_uncommitted();
+            }
+            bool compress = available < compression_reserve;
+            size_t pages_wanted = compress ? compression_reserve - available : 0;
+
+            size_t compressed_count = 0;
+            for (auto& process : Process::all_processes()) {
+                if (process.is_kernel_process())
+                    continue;
+                compressed_count += scan_process(process, compress && compressed_count < pages_wanted, pages_wanted - min(compressed_count, pages_wanted));
+            }
+            if (compressed_count)
+                dbgln_if(PAGE_FAULT_DEBUG, "PageReclaimTask: Compressed {} pages", compressed_count);
+        }
+    });
+}
+
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT void PageZeroingTask::spawn()
+{
+    RefPtr<Thread> page_zeroing_thread;
+    Process::create_kernel_process(page_zeroing_thread, "PageZeroingTask", [] {
+        // Keep the pool of pre-zeroed pages topped up, so that first-touch page
+        // faults don't have to zero their pages inline.
+        Thread::current()->set_priority(THREAD_PRIORITY_MIN);
+        for (;;) {
+            while (MM.pre_zero_one_page())
+                ;
+            MM.wait_for_pre_zeroed_page_demand();
+        }
+    });
+}
+
+}
@@ -4,13 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Singleton.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+static AK::Singleton<WaitQueue> s_writeback_wait_queue;
+
 UNMAP_AFTER_INIT void SyncTask::spawn()
 {
     RefPtr<Thread> syncd_thread;
@@ -18,9 +22,16 @@ UNMAP_AFTER_INIT void SyncTask::spawn()
         dbgln("SyncTask is running");
         for (;;) {
             VFS::the().sync();
-            (void)Thread::current()->sleep(Time::from_seconds(1));
+            // Sync at least once a second, or sooner if a filesystem is piling up dirty blocks.
+            auto timeout = Time::from_seconds(1);
+            (void)s_writeback_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "SyncTask");
         }
     });
 }
 
+void SyncTask::request_writeback()
+{
+    s_writeback_wait_queue->wake_all();
+}
+
 }
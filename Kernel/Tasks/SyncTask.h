@@ -10,5 +10,6 @@ namespace Kernel {
 class SyncTask {
 public:
     static void spawn();
+    static void request_writeback();
 };
 }
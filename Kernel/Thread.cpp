@@ -15,6 +15,7 @@
 #include <Kernel/KSyms.h>
 #include <Kernel/Panic.h>
 #include <Kernel/PerformanceEventBuffer.h>
+#include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Thread.h>
@@ -141,6 +142,9 @@ Thread::~Thread()
 
         // We shouldn't be queued
         VERIFY(m_runnable_priority < 0);
+
+        // A user thread may well have died while holding a priority inheriting futex.
+        m_inherited_priorities.clear();
     }
     {
         ScopedSpinLock lock(g_tid_map_lock);
@@ -189,6 +193,7 @@ void Thread::unblock(u8 signal)
         m_blocker->set_interrupted_by_signal(signal);
     }
     m_blocker = nullptr;
+    PerformanceManager::add_thread_wakeup_event(*this, Thread::current());
     if (Thread::current() == this) {
         set_state(Thread::Running);
         return;
@@ -197,6 +202,11 @@ void Thread::unblock(u8 signal)
     set_state(Thread::Runnable);
 }
 
+void Thread::add_block_perf_event(const Blocker& blocker)
+{
+    PerformanceManager::add_thread_block_event(*this, blocker);
+}
+
 void Thread::set_should_die()
 {
     if (m_should_die) {
@@ -344,6 +354,58 @@ void Thread::relock_process(LockMode previous_locked, u32 lock_count_to_restore)
     }
 }
 
+void Thread::inherit_priority(InheritedPriority& inherited_priority, u32 priority)
+{
+    ScopedSpinLock lock(g_scheduler_lock);
+    inherited_priority.m_priority = max(inherited_priority.m_priority, priority);
+    if (!inherited_priority.m_list_node.is_in_list())
+        m_inherited_priorities.append(inherited_priority);
+    update_inherited_priority();
+}
+
+void Thread::disinherit_priority(InheritedPriority& inherited_priority)
+{
+    ScopedSpinLock lock(g_scheduler_lock);
+    if (inherited_priority.m_list_node.is_in_list())
+        m_inherited_priorities.remove(inherited_priority);
+    update_inherited_priority();
+}
+
+void Thread::update_inherited_priority()
+{
+    VERIFY(g_scheduler_lock.own_lock());
+    u32 inherited = 0;
+    for (auto& inherited_priority : m_inherited_priorities)
+        inherited = max(inherited, inherited_priority.m_priority);
+    if (inherited == m_inherited_priority)
+        return;
+    auto previous_priority = effective_priority();
+    m_inherited_priority = inherited;
+    dbgln_if(THREAD_DEBUG, "{} now inherits priority {}", *this, inherited);
+    requeue_if_effective_priority_changed(previous_priority);
+}
+
+void Thread::set_scheduling_policy(SchedulingPolicy policy, u32 priority)
+{
+    ScopedSpinLock lock(g_scheduler_lock);
+    auto previous_priority = effective_priority();
+    m_scheduling_policy = policy;
+    m_priority = priority;
+    requeue_if_effective_priority_changed(previous_priority);
+}
+
+void Thread::requeue_if_effective_priority_changed(u32 previous_priority)
+{
+    VERIFY(g_scheduler_lock.own_lock());
+    if (effective_priority() == previous_priority)
+        return;
+    // If we're waiting in a ready queue, move over to the one for our new priority right away.
+    if (Scheduler::dequeue_runnable_thread(*this)) {
+        Scheduler::queue_runnable_thread(*this);
+        Scheduler::preempt_for(*this);
+    }
+}
+
 auto Thread::sleep(clockid_t clock_id, const Time& duration, Time* remaining_time) -> BlockResult
 {
     VERIFY(state() == Thread::Running);
@@ -932,6 +994,7 @@ void Thread::set_state(State new_state, u8 stop_signal)
     if (m_state == Runnable) {
         Scheduler::queue_runnable_thread(*this);
         Processor::smp_wake_n_idle_processors(1);
+        Scheduler::preempt_for(*this);
     } else if (m_state == Stopped) {
         // We don't want to restore to Running state, only Runnable!
         m_stop_state = previous_state != Running ? previous_state : Runnable;
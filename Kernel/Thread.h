@@ -23,6 +23,7 @@
 #include <Kernel/Arch/x86/SafeMem.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/KResult.h>
 #include <Kernel/LockMode.h>
 #include <Kernel/Scheduler.h>
@@ -59,19 +60,43 @@ struct ThreadSpecificData {
 #define THREAD_PRIORITY_NORMAL 30
 #define THREAD_PRIORITY_HIGH 50
 #define THREAD_PRIORITY_MAX 99
+// The highest effective priority there is, that of a real-time thread with THREAD_PRIORITY_MAX.
+#define THREAD_EFFECTIVE_PRIORITY_MAX (2 * THREAD_PRIORITY_MAX)
 
 #define THREAD_AFFINITY_DEFAULT 0xffffffff
 
+// Something that one thread holds at a time, and that other threads may have to wait for (like an exclusively held
+// Lock). While they're waiting, the holder runs with the highest of their priorities, so it gets out of their way
+// as soon as it can, instead of the waiters being stuck behind whatever the holder has to wait for.
+// NOTE: The priority outlives the holder, whoever takes over while threads are still waiting inherits it as well.
+//       It's up to the owner of this to reset() it once nobody's waiting anymore.
+class InheritedPriority {
+public:
+    u32 priority() const { return m_priority; }
+    void reset() { m_priority = 0; }
+
+private:
+    friend class Thread;
+
+    u32 m_priority { 0 };
+    IntrusiveListNode<InheritedPriority> m_list_node;
+
+public:
+    using List = IntrusiveList<InheritedPriority, RawPtr<InheritedPriority>, &InheritedPriority::m_list_node>;
+};
+
 class Thread
     : public RefCounted<Thread>
     , public Weakable<Thread> {
     AK_MAKE_NONCOPYABLE(Thread);
     AK_MAKE_NONMOVABLE(Thread);
+    MAKE_SLAB_CACHED(Thread);
 
     friend class Process;
     friend class ProtectedProcessBase;
     friend class Scheduler;
     friend struct ThreadReadyQueue;
+    friend struct ThreadReadyQueues;
 
     static SpinLock<u8> g_tid_map_lock;
     static HashMap<ThreadID, Thread*>* g_tid_map;
@@ -96,6 +121,28 @@ public:
     void set_priority(u32 p) { m_priority = p; }
     u32 priority() const { return m_priority; }
 
+    enum class SchedulingPolicy : u8 {
+        Other,
+        // Real-time threads always run before every other thread, in order of their priority.
+        // A FIFO thread runs until it blocks or yields, a round-robin thread only for a time slice at a time.
+        FIFO,
+        RoundRobin,
+    };
+    SchedulingPolicy scheduling_policy() const { return m_scheduling_policy; }
+    bool is_realtime() const { return m_scheduling_policy != SchedulingPolicy::Other; }
+    void set_scheduling_policy(SchedulingPolicy, u32 priority);
+
+    // Real-time priorities rank above all the others.
+    u32 base_priority() const { return is_realtime() ? THREAD_PRIORITY_MAX + m_priority : m_priority; }
+    // The priority the scheduler goes by, which includes any priority we've inherited from threads waiting on us.
+    u32 effective_priority() const { return max(base_priority(), m_inherited_priority); }
+
+    // Called when a thread with the given priority waits for something we hold, or when we take over something
+    // that threads are still waiting for (with a priority of 0).
+    void inherit_priority(InheritedPriority&, u32 priority);
+    // Called when we let go of it.
+    void disinherit_priority(InheritedPriority&);
+
     void detach()
     {
         ScopedSpinLock lock(m_lock);
@@ -840,6 +887,7 @@ public:
             blocker.begin_blocking({});
 
             set_state(Thread::Blocked);
+            add_block_perf_event(blocker);
         }
 
         scheduler_lock.unlock();
@@ -1137,8 +1185,12 @@ public:
 private:
     Thread(NonnullRefPtr<Process>, NonnullOwnPtr<Region>, NonnullRefPtr<Timer>);
 
+    void update_inherited_priority();
+    void requeue_if_effective_priority_changed(u32 previous_priority);
+
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    u32 m_runnable_queue_cpu { 0 };
 
     friend class WaitQueue;
 
@@ -1263,6 +1315,10 @@ private:
     State m_state { Invalid };
     String m_name;
     u32 m_priority { THREAD_PRIORITY_NORMAL };
+    SchedulingPolicy m_scheduling_policy { SchedulingPolicy::Other };
+    // The highest priority of the things in m_inherited_priorities. Protected by g_scheduler_lock.
+    u32 m_inherited_priority { 0 };
+    InheritedPriority::List m_inherited_priorities;
 
     State m_stop_state { Invalid };
 
@@ -1281,6 +1337,7 @@ private:
     void yield_without_holding_big_lock();
     void donate_without_holding_big_lock(RefPtr<Thread>&, const char*);
     void yield_while_not_holding_big_lock();
+    void add_block_perf_event(const Blocker&);
     void drop_thread_count(bool);
 };
 
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/NumericLimits.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/APIC.h>
@@ -134,6 +135,14 @@ void APICTimer::enable_local_timer()
     APIC::the().setup_local_timer(m_timer_period, m_timer_mode, true);
 }
 
+void APICTimer::enable_local_timer_one_shot(u64 nanoseconds)
+{
+    // NOTE: m_timer_period is measured in bus clock ticks per timer tick
+    u64 bus_ticks_per_second = (u64)m_timer_period * m_frequency;
+    u64 ticks = (nanoseconds * bus_ticks_per_second) / 1'000'000'000ull;
+    APIC::the().setup_local_timer((u32)min(ticks, (u64)NumericLimits<u32>::max()), APIC::TimerMode::OneShot, true);
+}
+
 void APICTimer::disable_local_timer()
 {
     APIC::the().setup_local_timer(0, APIC::TimerMode::OneShot, false);
@@ -34,6 +34,7 @@ public:
     void will_be_destroyed() { HardwareTimer<GenericInterruptHandler>::will_be_destroyed(); }
     void enable_local_timer();
     void disable_local_timer();
+    void enable_local_timer_one_shot(u64 nanoseconds);
 
 private:
     explicit APICTimer(u8, Function<void(const RegisterState&)>);
@@ -75,6 +75,7 @@ void TimeManagement::set_epoch_time(Time ts)
     // FIXME: Should use AK::Time internally
     m_epoch_time = ts.to_timespec();
     m_remaining_epoch_time_adjustment = { 0, 0 };
+    update_time_page();
 }
 
 Time TimeManagement::monotonic_time(TimePrecision precision) const
@@ -143,6 +144,17 @@ UNMAP_AFTER_INIT void TimeManagement::initialize(u32 cpu)
         if (auto* apic_timer = APIC::the().initialize_timers(*s_the->m_system_timer)) {
             dmesgln("Time: Using APIC timer as system timer");
             s_the->set_system_timer(*apic_timer);
+
+            // We can only skip ticks if we can still tell how much time has
+            // passed once we wake up again, which requires the HPET main counter.
+            if (kernel_command_line().is_tickless_idle_enabled()) {
+                if (s_the->m_can_query_precise_time) {
+                    dmesgln("Time: Tickless idle enabled");
+                    s_the->m_tickless_idle_enabled = true;
+                } else {
+                    dmesgln("Time: Tickless idle requires HPET, staying periodic");
+                }
+            }
         }
     } else {
         VERIFY(s_the.is_initialized());
@@ -174,6 +186,10 @@ time_t TimeManagement::boot_time() const
 
 UNMAP_AFTER_INIT TimeManagement::TimeManagement()
 {
+    // This has to exist before the first timer tick, since that updates it.
+    m_time_page_region = MM.allocate_kernel_region(PAGE_SIZE, "Time page", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+    VERIFY(m_time_page_region);
+
     bool probe_non_legacy_hardware_timers = !(kernel_command_line().is_legacy_time_enabled());
     if (ACPI::is_enabled()) {
         if (!ACPI::Parser::the()->x86_specific_flags().cmos_rtc_not_present) {
@@ -194,6 +210,9 @@ UNMAP_AFTER_INIT TimeManagement::TimeManagement()
     } else if (!probe_and_set_legacy_hardware_timers()) {
         VERIFY_NOT_REACHED();
     }
+
+    time_page().monotonic_is_more_precise_than_coarse = m_can_query_precise_time;
+    update_time_page();
 }
 
 Time TimeManagement::now()
@@ -339,6 +358,25 @@ void TimeManagement::update_time(const RegisterState&)
     TimeManagement::the().increment_time_since_boot();
 }
 
+TimePage& TimeManagement::time_page()
+{
+    return *static_cast<TimePage*>((void*)m_time_page_region->vaddr().as_ptr());
+}
+
+void TimeManagement::update_time_page()
+{
+    auto& page = time_page();
+    u32 update_iteration = AK::atomic_fetch_add(&page.update1, 1u, AK::MemoryOrder::memory_order_acquire);
+    page.monotonic_coarse = { (i64)m_seconds_since_boot, (u32)(((u64)m_ticks_this_second * 1000000000ull) / m_time_ticks_per_second) };
+    page.realtime_coarse = { (i64)m_epoch_time.tv_sec, (u32)m_epoch_time.tv_nsec };
+    AK::atomic_store(&page.update2, update_iteration + 1, AK::MemoryOrder::memory_order_release);
+}
+
+void TimeManagement::set_tracepoint_event_mask(u32 event_mask)
+{
+    AK::atomic_store(&time_page().tracepoint_event_mask, event_mask, AK::MemoryOrder::memory_order_relaxed);
+}
+
 void TimeManagement::increment_time_since_boot_hpet()
 {
     VERIFY(!m_time_keeper_timer.is_null());
@@ -358,6 +396,7 @@ void TimeManagement::increment_time_since_boot_hpet()
     m_ticks_this_second = ticks_this_second;
     // TODO: Apply m_remaining_epoch_time_adjustment
     timespec_add(m_epoch_time, { (time_t)(delta_ns / 1000000000), (long)(delta_ns % 1000000000) }, m_epoch_time);
+    update_time_page();
     m_update2.store(update_iteration + 1, AK::MemoryOrder::memory_order_release);
 }
 
@@ -388,6 +427,7 @@ void TimeManagement::increment_time_since_boot()
         ++m_seconds_since_boot;
         m_ticks_this_second = 0;
     }
+    update_time_page();
     m_update2.store(update_iteration + 1, AK::MemoryOrder::memory_order_release);
 }
 
@@ -400,6 +440,38 @@ void TimeManagement::system_timer_tick(const RegisterState& regs)
     Scheduler::timer_tick(regs);
 }
 
+bool TimeManagement::enter_tickless_idle()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(m_tickless_idle_enabled);
+    auto* apic_timer = APIC::the().get_timer();
+    VERIFY(apic_timer);
+
+    // Don't stop the tick while profiling, the samples are taken on every tick.
+    if (m_profile_enable_count.load() > 0)
+        return false;
+
+    auto idle_duration = Time::from_milliseconds(MAXIMUM_TICKLESS_IDLE_MILLISECONDS);
+    if (auto deadline = TimerQueue::the().next_monotonic_deadline(); deadline.has_value())
+        idle_duration = min(idle_duration, deadline.value() - monotonic_time(TimePrecision::Precise));
+
+    // Stopping the tick for less than a tick isn't worth reprogramming the timer twice.
+    auto tick_duration = Time::from_nanoseconds(1'000'000'000ll / apic_timer->ticks_per_second());
+    if (idle_duration <= tick_duration)
+        return false;
+
+    apic_timer->enable_local_timer_one_shot(idle_duration.to_nanoseconds());
+    return true;
+}
+
+void TimeManagement::exit_tickless_idle()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    auto* apic_timer = APIC::the().get_timer();
+    VERIFY(apic_timer);
+    apic_timer->enable_local_timer();
+}
+
 bool TimeManagement::enable_profile_timer()
 {
     if (!m_profile_timer)
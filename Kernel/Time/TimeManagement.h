@@ -7,9 +7,11 @@
 #pragma once
 
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/Time.h>
 #include <AK/Types.h>
+#include <Kernel/API/TimePage.h>
 #include <Kernel/KResult.h>
 #include <Kernel/UnixTypes.h>
 
@@ -17,8 +19,10 @@ namespace Kernel {
 
 #define OPTIMAL_TICKS_PER_SECOND_RATE 250
 #define OPTIMAL_PROFILE_TICKS_PER_SECOND_RATE 1000
+#define MAXIMUM_TICKLESS_IDLE_MILLISECONDS 1000
 
 class HardwareTimerBase;
+class Region;
 
 enum class TimePrecision {
     Coarse = 0,
@@ -59,6 +63,10 @@ public:
     bool enable_profile_timer();
     bool disable_profile_timer();
 
+    bool is_tickless_idle_enabled() const { return m_tickless_idle_enabled; }
+    bool enter_tickless_idle();
+    void exit_tickless_idle();
+
     u64 uptime_ms() const;
     static Time now();
 
@@ -71,6 +79,11 @@ public:
 
     bool can_query_precise_time() const { return m_can_query_precise_time; }
 
+    // This gets mapped into every process, see Kernel/API/TimePage.h.
+    Region& time_page_region() { return *m_time_page_region; }
+    // Tells userspace which of its tracepoints to record, see Kernel/API/TimePage.h.
+    void set_tracepoint_event_mask(u32);
+
 private:
     bool probe_and_set_legacy_hardware_timers();
     bool probe_and_set_non_legacy_hardware_timers();
@@ -80,6 +93,9 @@ private:
     void set_system_timer(HardwareTimerBase&);
     static void system_timer_tick(const RegisterState&);
 
+    TimePage& time_page();
+    void update_time_page();
+
     // Variables between m_update1 and m_update2 are synchronized
     Atomic<u32> m_update1 { 0 };
     u32 m_ticks_this_second { 0 };
@@ -95,8 +111,12 @@ private:
     RefPtr<HardwareTimerBase> m_system_timer;
     RefPtr<HardwareTimerBase> m_time_keeper_timer;
 
+    bool m_tickless_idle_enabled { false };
+
     Atomic<u32> m_profile_enable_count { 0 };
     RefPtr<HardwareTimerBase> m_profile_timer;
+
+    OwnPtr<Region> m_time_page_region;
 };
 
 }
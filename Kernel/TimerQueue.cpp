@@ -263,6 +263,23 @@ void TimerQueue::fire()
         fire_timers(m_timer_queue_realtime);
 }
 
+Optional<Time> TimerQueue::next_monotonic_deadline()
+{
+    ScopedSpinLock lock(g_timerqueue_lock);
+
+    Optional<Time> deadline;
+    if (!m_timer_queue_monotonic.list.is_empty())
+        deadline = m_timer_queue_monotonic.next_timer_due;
+    if (!m_timer_queue_realtime.list.is_empty()) {
+        // Translate the realtime deadline into the monotonic clock
+        auto& time_management = TimeManagement::the();
+        auto realtime_deadline = m_timer_queue_realtime.next_timer_due - time_management.epoch_time(TimePrecision::Coarse) + time_management.monotonic_time(TimePrecision::Coarse);
+        if (!deadline.has_value() || realtime_deadline < deadline.value())
+            deadline = realtime_deadline;
+    }
+    return deadline;
+}
+
 void TimerQueue::update_next_timer_due(Queue& queue)
 {
     VERIFY(g_timerqueue_lock.is_locked());
@@ -9,6 +9,7 @@
 #include <AK/Function.h>
 #include <AK/InlineLinkedList.h>
 #include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Time.h>
@@ -83,6 +84,7 @@ public:
         return cancel_timer(*move(timer));
     }
     void fire();
+    Optional<Time> next_monotonic_deadline();
 
 private:
     struct Queue {
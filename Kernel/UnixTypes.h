@@ -62,8 +62,22 @@ enum {
     PERF_EVENT_KMALLOC = 2048,
     PERF_EVENT_KFREE = 4096,
     PERF_EVENT_PAGE_FAULT = 8192,
+    PERF_EVENT_CYCLES = 16384,
+    PERF_EVENT_INSTRUCTIONS = 32768,
+    PERF_EVENT_CACHE_MISS = 65536,
+    PERF_EVENT_BRANCH_MISS = 131072,
+    PERF_EVENT_THREAD_BLOCK = 262144,
+    PERF_EVENT_THREAD_WAKEUP = 524288,
+    PERF_EVENT_SYSCALL_ENTER = 1048576,
+    PERF_EVENT_SYSCALL_EXIT = 2097152,
+    PERF_EVENT_IRQ = 4194304,
+    PERF_EVENT_IPC_SEND = 8388608,
+    PERF_EVENT_IPC_RECEIVE = 16777216,
+    PERF_EVENT_EVENT_LOOP_DISPATCH = 33554432,
 };
 
+#define PERF_EVENT_USERSPACE_TRACEPOINTS (PERF_EVENT_IPC_SEND | PERF_EVENT_IPC_RECEIVE | PERF_EVENT_EVENT_LOOP_DISPATCH)
+
 #define WNOHANG 1
 #define WUNTRACED 2
 #define WSTOPPED WUNTRACED
@@ -101,6 +115,10 @@ enum {
 #define MADV_SET_VOLATILE 0x100
 #define MADV_SET_NONVOLATILE 0x200
 #define MADV_GET_VOLATILE 0x400
+#define MADV_HUGEPAGE 0x800
+#define MADV_NOHUGEPAGE 0x1000
+#define MADV_MERGEABLE 0x2000
+#define MADV_UNMERGEABLE 0x4000
 
 #define F_DUPFD 0
 #define F_GETFD 1
@@ -111,6 +129,14 @@ enum {
 
 #define FD_CLOEXEC 1
 
+#define POSIX_SPAWN_RESETIDS (1 << 0)
+#define POSIX_SPAWN_SETPGROUP (1 << 1)
+#define POSIX_SPAWN_SETSCHEDPARAM (1 << 2)
+#define POSIX_SPAWN_SETSCHEDULER (1 << 3)
+#define POSIX_SPAWN_SETSIGDEF (1 << 4)
+#define POSIX_SPAWN_SETSIGMASK (1 << 5)
+#define POSIX_SPAWN_SETSID (1 << 6)
+
 #define _FUTEX_OP_SHIFT_OP 28
 #define _FUTEX_OP_MASK_OP 0xf
 #define _FUTEX_OP_SHIFT_CMP 24
@@ -144,6 +170,8 @@ enum {
 #define FUTEX_REQUEUE 3
 #define FUTEX_CMP_REQUEUE 4
 #define FUTEX_WAKE_OP 5
+#define FUTEX_LOCK_PI 6
+#define FUTEX_UNLOCK_PI 7
 #define FUTEX_WAIT_BITSET 9
 #define FUTEX_WAKE_BITSET 10
 
@@ -153,6 +181,10 @@ enum {
 
 #define FUTEX_BITSET_MATCH_ANY 0xffffffff
 
+// The value of a priority inheriting futex is the TID of the thread holding it (or 0), and whether anyone's waiting for it.
+#define FUTEX_WAITERS 0x80000000
+#define FUTEX_TID_MASK 0x3fffffff
+
 #define S_IFMT 0170000
 #define S_IFDIR 0040000
 #define S_IFCHR 0020000
@@ -480,6 +512,33 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN (1u << 0)
+#define EPOLLPRI (1u << 1)
+#define EPOLLOUT (1u << 2)
+#define EPOLLERR (1u << 3)
+#define EPOLLHUP (1u << 4)
+#define EPOLLRDHUP (1u << 13)
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_CLOEXEC O_CLOEXEC
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -504,6 +563,7 @@ struct pollfd {
 #define MSG_PEEK 0x4
 #define MSG_OOB 0x8
 #define MSG_DONTWAIT 0x40
+#define MSG_WAITFORONE 0x10000
 
 #define SOL_SOCKET 1
 
@@ -519,6 +579,8 @@ enum {
     SO_BINDTODEVICE,
     SO_KEEPALIVE,
     SO_TIMESTAMP,
+    SO_BROADCAST,
+    SO_REUSEPORT,
 };
 
 enum {
@@ -635,10 +697,26 @@ struct msghdr {
     int msg_flags;
 };
 
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
 struct sched_param {
     int sched_priority;
 };
 
+#define SCHED_FIFO 0
+#define SCHED_RR 1
+#define SCHED_OTHER 2
+#define SCHED_BATCH 3
+
+#define CPU_SETSIZE 32
+
+typedef struct {
+    u32 __bits;
+} cpu_set_t;
+
 struct ifreq {
 #define IFNAMSIZ 16
     char ifr_name[IFNAMSIZ];
@@ -675,6 +753,7 @@ struct ifreq {
 };
 
 struct rtentry {
+    struct sockaddr rt_dst;     /* the target address */
     struct sockaddr rt_gateway; /* the gateway address */
     struct sockaddr rt_genmask; /* the target network mask */
     unsigned short int rt_flags;
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashFunctions.h>
 #include <Kernel/Arch/x86/SmapDisabler.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Process.h>
@@ -47,9 +48,8 @@ RefPtr<VMObject> AnonymousVMObject::clone()
         return {};
     }
 
-    // Both original and clone become COW. So create a COW map for ourselves
-    // or reset all pages to be copied again if we were previously cloned
-    ensure_or_reset_cow_map();
+    // Both original and clone become COW, so all of our pages need to be copied again
+    mark_all_pages_as_cow();
 
     // FIXME: If this allocation fails, we need to rollback all changes.
     return adopt_ref_if_nonnull(new AnonymousVMObject(*this));
@@ -133,13 +133,14 @@ AnonymousVMObject::AnonymousVMObject(const AnonymousVMObject& other)
     , m_unused_committed_pages(other.m_unused_committed_pages)
     , m_cow_map()                                                      // do *not* clone this
     , m_shared_committed_cow_pages(other.m_shared_committed_cow_pages) // share the pool
+    , m_compressed_pages(other.m_compressed_pages)
 {
     // We can't really "copy" a spinlock. But we're holding it. Clear in the clone
     VERIFY(other.m_lock.is_locked());
     m_lock.initialize();
 
     // The clone also becomes COW
-    ensure_or_reset_cow_map();
+    mark_all_pages_as_cow();
 
     if (m_unused_committed_pages > 0) {
         // The original vmobject didn't use up all committed pages. When
@@ -197,6 +198,8 @@ int AnonymousVMObject::purge_impl()
             if (phys_page && !phys_page->is_shared_zero_page()) {
                 VERIFY(!phys_page->is_lazy_committed_page());
                 ++purged_in_range;
+            } else if (!phys_page && m_compressed_pages.remove(i)) {
+                ++purged_in_range;
             }
             phys_page = MM.shared_zero_page();
         }
@@ -395,19 +398,72 @@ RefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(size_t page_inde
     return MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
 }
 
+bool AnonymousVMObject::try_populate_large_page(size_t first_page_index)
+{
+    VERIFY(first_page_index + PAGES_PER_LARGE_PAGE <= page_count());
+
+    // Volatile pages may be purged one by one, which doesn't mix well with
+    // backing them by one large physical allocation.
+    if (is_any_volatile())
+        return false;
+
+    auto is_untouched = [this](size_t page_index) {
+        auto& page = m_physical_pages[page_index];
+        return page && (page->is_shared_zero_page() || page->is_lazy_committed_page());
+    };
+
+    {
+        ScopedSpinLock lock(m_lock);
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            if (!is_untouched(first_page_index + i))
+                return false;
+        }
+    }
+
+    // We draw these from the uncommitted pool, and give back whatever we had
+    // committed for this range once the pages are in place.
+    auto physical_pages = MM.allocate_contiguous_user_physical_pages(LARGE_PAGE_SIZE, LARGE_PAGE_SIZE);
+    if (physical_pages.is_empty())
+        return false;
+
+    size_t committed_pages_to_release = 0;
+    {
+        ScopedSpinLock lock(m_lock);
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            // Someone got to this range while we weren't looking; if so the
+            // pages we allocated are simply returned when we go out of scope.
+            if (!is_untouched(first_page_index + i))
+                return false;
+        }
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            auto& page = m_physical_pages[first_page_index + i];
+            if (page->is_lazy_committed_page())
+                committed_pages_to_release++;
+            page = physical_pages[i];
+        }
+        VERIFY(m_unused_committed_pages >= committed_pages_to_release);
+        m_unused_committed_pages -= committed_pages_to_release;
+    }
+    if (committed_pages_to_release)
+        MM.uncommit_user_physical_pages(committed_pages_to_release);
+    return true;
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
         m_cow_map = Bitmap { page_count(), true };
+    else if (m_all_pages_are_cow)
+        m_cow_map.fill(true);
+    m_all_pages_are_cow = false;
     return m_cow_map;
 }
 
-void AnonymousVMObject::ensure_or_reset_cow_map()
+void AnonymousVMObject::mark_all_pages_as_cow()
 {
-    if (m_cow_map.is_null())
-        ensure_cow_map();
-    else
-        m_cow_map.fill(true);
+    // NOTE: We don't need the bitmap until the first page stops being COW, so we don't allocate
+    //       (or fill) it while forking, which would cost us a bit for every page we have.
+    m_all_pages_are_cow = true;
 }
 
 bool AnonymousVMObject::should_cow(size_t page_index, bool is_shared) const
@@ -417,6 +473,8 @@ bool AnonymousVMObject::should_cow(size_t page_index, bool is_shared) const
         return true;
     if (is_shared)
         return false;
+    if (m_all_pages_are_cow)
+        return true;
     return !m_cow_map.is_null() && m_cow_map.get(page_index);
 }
 
@@ -427,6 +485,8 @@ void AnonymousVMObject::set_should_cow(size_t page_index, bool cow)
 
 size_t AnonymousVMObject::cow_pages() const
 {
+    if (m_all_pages_are_cow)
+        return page_count();
     if (m_cow_map.is_null())
         return 0;
     return m_cow_map.count_slow(true);
@@ -490,4 +550,224 @@ PageFaultResponse AnonymousVMObject::handle_cow_fault(size_t page_index, Virtual
     return PageFaultResponse::Continue;
 }
 
+bool AnonymousVMObject::try_compress_page(Region& region, size_t page_index)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(&region.vmobject() == this);
+
+    RefPtr<PhysicalPage> page;
+    {
+        ScopedSpinLock lock(m_lock);
+        auto& page_slot = m_physical_pages[page_index];
+        if (!page_slot || page_slot->is_shared_zero_page() || page_slot->is_lazy_committed_page())
+            return false;
+        // If anyone else holds on to the page (a COW sibling, say), compressing it wouldn't free anything.
+        if (page_slot->ref_count() != 1 || !page_slot->may_return_to_freelist())
+            return false;
+        // Purging volatile pages is cheaper than compressing them.
+        if (!is_nonvolatile(page_index))
+            return false;
+        page = move(page_slot);
+    }
+
+    // With the page unmapped, nobody can change it while we're compressing it.
+    // NOTE: We're holding the MM lock, so nobody can fault it back in until we're done either.
+    region.remap_vmobject_page(page_index);
+
+    u8 compressed_data[CompressedPage::max_compressed_size];
+    size_t compressed_size = 0;
+    bool is_zero = true;
+    {
+        auto* data = MM.quickmap_page(*page);
+        for (size_t i = 0; i < PAGE_SIZE / sizeof(FlatPtr); ++i) {
+            if (reinterpret_cast<const FlatPtr*>(data)[i] != 0) {
+                is_zero = false;
+                break;
+            }
+        }
+        if (!is_zero)
+            compressed_size = CompressedPage::compress({ data, PAGE_SIZE }, { compressed_data, sizeof(compressed_data) });
+        MM.unquickmap_page();
+    }
+
+    RefPtr<CompressedPage> compressed_page;
+    if (compressed_size)
+        compressed_page = CompressedPage::try_create({ compressed_data, compressed_size });
+
+    ScopedSpinLock lock(m_lock);
+    auto& page_slot = m_physical_pages[page_index];
+    VERIFY(page_slot.is_null());
+    bool freed_page = is_zero || compressed_page;
+    if (is_zero) {
+        page_slot = MM.shared_zero_page();
+    } else if (compressed_page) {
+        dbgln_if(PAGE_FAULT_DEBUG, "Compressed page {} of {:p} to {} bytes", page_index, this, compressed_size);
+        m_compressed_pages.set(page_index, compressed_page.release_nonnull());
+    } else {
+        page_slot = move(page);
+    }
+    lock.unlock();
+
+    if (!page_slot.is_null())
+        region.remap_vmobject_page(page_index);
+    return freed_page;
+}
+
+bool AnonymousVMObject::has_compressed_page(size_t page_index) const
+{
+    ScopedSpinLock lock(m_lock);
+    return m_compressed_pages.contains(page_index);
+}
+
+PageFaultResponse AnonymousVMObject::handle_compressed_page_fault(size_t page_index)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    // NOTE: Allocating may have to purge volatile memory (which takes our lock), so we do it first.
+    auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (page.is_null()) {
+        dmesgln("MM: handle_compressed_page_fault was unable to allocate a physical page");
+        return PageFaultResponse::OutOfMemory;
+    }
+
+    ScopedSpinLock lock(m_lock);
+    auto compressed_page = m_compressed_pages.get(page_index);
+    // Someone else may have faulted it back in, or purged it, while we were allocating.
+    if (!compressed_page.has_value())
+        return PageFaultResponse::Continue;
+    VERIFY(m_physical_pages[page_index].is_null());
+
+    auto* data = MM.quickmap_page(*page);
+    compressed_page.value()->decompress_into({ data, PAGE_SIZE });
+    MM.unquickmap_page();
+
+    m_physical_pages[page_index] = move(page);
+    m_compressed_pages.remove(page_index);
+    return PageFaultResponse::Continue;
+}
+
+RefPtr<PhysicalPage> AnonymousVMObject::mergeable_page(size_t page_index)
+{
+    ScopedSpinLock lock(m_lock);
+    // NOTE: The first write to a merged page gets a copy of its own. If that came out of the committed COW pages,
+    //       it could use up the ones set aside for the pages we actually shared with a clone.
+    if (m_shared_committed_cow_pages)
+        return {};
+    auto& page = m_physical_pages[page_index];
+    if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page() || !page->may_return_to_freelist())
+        return {};
+    // Volatile pages may get purged at any moment, so there's no point in merging them.
+    if (!is_nonvolatile(page_index))
+        return {};
+    return page;
+}
+
+void AnonymousVMObject::write_protect_page(Region& region, size_t page_index)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        if (should_cow(page_index, false))
+            return;
+        set_should_cow(page_index, true);
+    }
+    region.remap_vmobject_page(page_index);
+}
+
+bool AnonymousVMObject::have_same_contents(PhysicalPage& page, PhysicalPage& other_page)
+{
+    // NOTE: There's only one quickmap slot, so one of the pages has to be copied out first.
+    u8 contents[PAGE_SIZE];
+    memcpy(contents, MM.quickmap_page(page), PAGE_SIZE);
+    MM.unquickmap_page();
+    bool same = !memcmp(contents, MM.quickmap_page(other_page), PAGE_SIZE);
+    MM.unquickmap_page();
+    return same;
+}
+
+bool AnonymousVMObject::is_all_zeroes(PhysicalPage& page)
+{
+    auto* data = reinterpret_cast<const FlatPtr*>(MM.quickmap_page(page));
+    bool is_zero = true;
+    for (size_t i = 0; i < PAGE_SIZE / sizeof(FlatPtr); ++i) {
+        if (data[i] != 0) {
+            is_zero = false;
+            break;
+        }
+    }
+    MM.unquickmap_page();
+    return is_zero;
+}
+
+Optional<u32> AnonymousVMObject::hash_page_for_merging(Region& region, size_t page_index)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(&region.vmobject() == this);
+
+    auto page = mergeable_page(page_index);
+    if (!page)
+        return {};
+
+    u32 hash = 0;
+    bool is_zero = true;
+    {
+        auto* data = reinterpret_cast<const u32*>(MM.quickmap_page(*page));
+        for (size_t i = 0; i < PAGE_SIZE / sizeof(u32); ++i) {
+            hash = pair_int_hash(hash, data[i]);
+            if (data[i] != 0)
+                is_zero = false;
+        }
+        MM.unquickmap_page();
+    }
+    if (!is_zero)
+        return hash;
+
+    // NOTE: Writing to a write-protected page faults, and the fault handler waits for the MM lock,
+    //       so if the page is still all zeroes once it's write-protected, it stays that way.
+    write_protect_page(region, page_index);
+    if (!is_all_zeroes(*page))
+        return {};
+    {
+        ScopedSpinLock lock(m_lock);
+        auto& page_slot = m_physical_pages[page_index];
+        if (page_slot != page)
+            return {};
+        page_slot = MM.shared_zero_page();
+    }
+    region.remap_vmobject_page(page_index);
+    dbgln_if(PAGE_FAULT_DEBUG, "Merged page {} of {:p} into the shared zero page", page_index, this);
+    return {};
+}
+
+bool AnonymousVMObject::try_merge_page(Region& region, size_t page_index, AnonymousVMObject& other, Region& other_region, size_t other_page_index)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(&region.vmobject() == this);
+    VERIFY(&other_region.vmobject() == &other);
+
+    auto page = mergeable_page(page_index);
+    auto other_page = other.mergeable_page(other_page_index);
+    if (!page || !other_page || page == other_page)
+        return false;
+    // Our page is the one that goes away, so nobody but its slot (and us) may be holding on to it.
+    if (page->ref_count() != 2)
+        return false;
+
+    // Once both pages are COW, the first write to either one of them gets a copy of its own.
+    // NOTE: Just like with zero pages, nobody can change them while we're comparing them.
+    write_protect_page(region, page_index);
+    other.write_protect_page(other_region, other_page_index);
+    if (!have_same_contents(*page, *other_page))
+        return false;
+
+    {
+        ScopedSpinLock lock(m_lock);
+        auto& page_slot = m_physical_pages[page_index];
+        if (page_slot != page)
+            return false;
+        page_slot = other_page;
+    }
+    region.remap_vmobject_page(page_index);
+    dbgln_if(PAGE_FAULT_DEBUG, "Merged page {} of {:p} with page {} of {:p}", page_index, this, other_page_index, &other);
+    return true;
+}
+
 }
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <Kernel/PhysicalAddress.h>
 #include <Kernel/VM/AllocationStrategy.h>
+#include <Kernel/VM/CompressedPage.h>
 #include <Kernel/VM/PageFaultResponse.h>
 #include <Kernel/VM/PurgeablePageRanges.h>
 #include <Kernel/VM/VMObject.h>
@@ -27,11 +29,22 @@ public:
     virtual RefPtr<VMObject> clone() override;
 
     RefPtr<PhysicalPage> allocate_committed_page(size_t);
+    bool try_populate_large_page(size_t first_page_index);
     PageFaultResponse handle_cow_fault(size_t, VirtualAddress);
     size_t cow_pages() const;
     bool should_cow(size_t page_index, bool) const;
     void set_should_cow(size_t page_index, bool);
 
+    // Compressing pages is up to the PageReclaimTask, which calls this with the MM lock held,
+    // for VMObjects that only the given region maps.
+    bool try_compress_page(Region&, size_t page_index);
+    bool has_compressed_page(size_t page_index) const;
+    PageFaultResponse handle_compressed_page_fault(size_t page_index);
+
+    // Merging identical pages is up to the PageMergingTask, which calls these with the MM lock held.
+    Optional<u32> hash_page_for_merging(Region&, size_t page_index);
+    bool try_merge_page(Region&, size_t page_index, AnonymousVMObject& other, Region& other_region, size_t other_page_index);
+
     void register_purgeable_page_ranges(PurgeablePageRanges&);
     void unregister_purgeable_page_ranges(PurgeablePageRanges&);
 
@@ -132,6 +145,10 @@ private:
     size_t count_needed_commit_pages_for_nonvolatile_range(const VolatilePageRange&);
     size_t mark_committed_pages_for_nonvolatile_range(const VolatilePageRange&, size_t);
     bool is_nonvolatile(size_t page_index);
+    RefPtr<PhysicalPage> mergeable_page(size_t page_index);
+    void write_protect_page(Region&, size_t page_index);
+    static bool have_same_contents(PhysicalPage&, PhysicalPage&);
+    static bool is_all_zeroes(PhysicalPage&);
 
     AnonymousVMObject& operator=(const AnonymousVMObject&) = delete;
     AnonymousVMObject& operator=(AnonymousVMObject&&) = delete;
@@ -140,7 +157,7 @@ private:
     virtual bool is_anonymous() const override { return true; }
 
     Bitmap& ensure_cow_map();
-    void ensure_or_reset_cow_map();
+    void mark_all_pages_as_cow();
 
     VolatilePageRanges m_volatile_ranges_cache;
     bool m_volatile_ranges_cache_dirty { true };
@@ -148,9 +165,15 @@ private:
     size_t m_unused_committed_pages { 0 };
 
     Bitmap m_cow_map;
+    // While this is set, every page is COW and m_cow_map is stale.
+    bool m_all_pages_are_cow { false };
 
     // We share a pool of committed cow-pages with clones
     RefPtr<CommittedCowPages> m_shared_committed_cow_pages;
+
+    // The pages that have been compressed. Their slots in m_physical_pages are null.
+    // NOTE: We share these with our clones, each of which decompresses its own copy.
+    HashMap<size_t, NonnullRefPtr<CompressedPage>> m_compressed_pages;
 };
 
 }
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StdLibExtras.h>
+#include <Kernel/Heap/kmalloc.h>
+#include <Kernel/VM/CompressedPage.h>
+
+namespace Kernel {
+
+// The compressed data is a series of sequences, each of which is a token byte, some literal bytes to copy,
+// and a match to copy from earlier in the output. The high nibble of the token is the number of literals,
+// the low one is the length of the match (minus min_match_length). If a nibble is 15, more length bytes
+// follow it, and they keep going for as long as they are 255. The match has a 16-bit little-endian offset.
+// The last sequence only has literals, and ends the data.
+static constexpr size_t min_match_length = 4;
+static constexpr size_t hash_bits = 10;
+
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> s_page_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> s_compressed_bytes;
+
+static u32 hash_at(const u8* data)
+{
+    u32 value;
+    __builtin_memcpy(&value, data, sizeof(value));
+    return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+size_t CompressedPage::compress(ReadonlyBytes input, Bytes output)
+{
+    // Where we last saw a 4-byte string with each hash, plus one (so zero means never).
+    u16 last_seen[1 << hash_bits] {};
+    size_t in = 0;
+    size_t out = 0;
+    size_t literal_start = 0;
+
+    auto write_byte = [&](u8 byte) {
+        if (out >= output.size())
+            return false;
+        output[out++] = byte;
+        return true;
+    };
+    auto write_extra_length = [&](size_t length) {
+        for (; length >= 255; length -= 255) {
+            if (!write_byte(255))
+                return false;
+        }
+        return write_byte(length);
+    };
+    auto write_sequence = [&](size_t literal_end, size_t match_offset, size_t match_length) {
+        size_t literal_length = literal_end - literal_start;
+        size_t match_nibble = match_length ? match_length - min_match_length : 0;
+        if (!write_byte((min<size_t>(literal_length, 15) << 4) | min<size_t>(match_nibble, 15)))
+            return false;
+        if (literal_length >= 15 && !write_extra_length(literal_length - 15))
+            return false;
+        if (out + literal_length > output.size())
+            return false;
+        __builtin_memcpy(output.data() + out, input.data() + literal_start, literal_length);
+        out += literal_length;
+        if (!match_length)
+            return true;
+        if (!write_byte(match_offset & 0xff) || !write_byte(match_offset >> 8))
+            return false;
+        if (match_nibble >= 15 && !write_extra_length(match_nibble - 15))
+            return false;
+        return true;
+    };
+
+    while (in + min_match_length <= input.size()) {
+        auto hash = hash_at(input.offset(in));
+        size_t candidate = last_seen[hash];
+        last_seen[hash] = in + 1;
+        if (!candidate || __builtin_memcmp(input.offset(candidate - 1), input.offset(in), min_match_length) != 0) {
+            ++in;
+            continue;
+        }
+        size_t match_start = candidate - 1;
+        size_t match_length = min_match_length;
+        while (in + match_length < input.size() && input[match_start + match_length] == input[in + match_length])
+            ++match_length;
+        if (!write_sequence(in, in - match_start, match_length))
+            return 0;
+        in += match_length;
+        literal_start = in;
+    }
+    if (!write_sequence(input.size(), 0, 0))
+        return 0;
+    return out;
+}
+
+void CompressedPage::decompress_into(Bytes output) const
+{
+    size_t in = 0;
+    size_t out = 0;
+    auto read_length = [&](size_t length) {
+        if (length != 15)
+            return length;
+        u8 byte;
+        do {
+            VERIFY(in < m_size);
+            byte = m_data[in++];
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    for (;;) {
+        VERIFY(in < m_size);
+        u8 token = m_data[in++];
+        size_t literal_length = read_length(token >> 4);
+        VERIFY(in + literal_length <= m_size && out + literal_length <= output.size());
+        __builtin_memcpy(output.offset(out), m_data + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == m_size)
+            break;
+
+        VERIFY(in + 2 <= m_size);
+        size_t match_offset = m_data[in] | (m_data[in + 1] << 8);
+        in += 2;
+        size_t match_length = read_length(token & 0xf) + min_match_length;
+        VERIFY(match_offset && match_offset <= out && out + match_length <= output.size());
+        // NOTE: The match may overlap what it's copying, so this has to go byte by byte.
+        for (size_t i = 0; i < match_length; ++i, ++out)
+            output[out] = output[out - match_offset];
+    }
+    VERIFY(out == output.size());
+}
+
+RefPtr<CompressedPage> CompressedPage::try_create(ReadonlyBytes compressed_data)
+{
+    auto* slot = kmalloc(sizeof(CompressedPage) + compressed_data.size());
+    if (!slot)
+        return {};
+    auto* page = new (slot) CompressedPage(compressed_data.size());
+    __builtin_memcpy(page->m_data, compressed_data.data(), compressed_data.size());
+    s_page_count++;
+    s_compressed_bytes += compressed_data.size();
+    return adopt_ref(*page);
+}
+
+void CompressedPage::operator delete(void* page)
+{
+    s_page_count--;
+    s_compressed_bytes -= static_cast<CompressedPage*>(page)->m_size;
+    kfree(page);
+}
+
+CompressedPage::Stats CompressedPage::stats()
+{
+    return { s_page_count.load(), s_compressed_bytes.load() };
+}
+
+}
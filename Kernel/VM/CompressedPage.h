@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// The contents of an anonymous page that has been compressed (with a small LZ77 codec in
+// the spirit of LZ4) to make room in physical memory while nobody is using it.
+// It lives on the kernel heap until the page is faulted back in.
+class CompressedPage : public RefCounted<CompressedPage> {
+public:
+    // Pages that don't compress to at most this much stay uncompressed, it's not worth it.
+    static constexpr size_t max_compressed_size = PAGE_SIZE * 3 / 4;
+
+    // Compresses a page into the output buffer, and returns how much of it was used.
+    // Returns 0 if the page doesn't compress to the size of the buffer.
+    static size_t compress(ReadonlyBytes page, Bytes output);
+    static RefPtr<CompressedPage> try_create(ReadonlyBytes compressed_data);
+
+    void operator delete(void*);
+
+    void decompress_into(Bytes page) const;
+
+    size_t size() const { return m_size; }
+
+    struct Stats {
+        size_t page_count { 0 };
+        size_t compressed_bytes { 0 };
+    };
+    static Stats stats();
+
+private:
+    explicit CompressedPage(size_t size)
+        : m_size(size)
+    {
+    }
+
+    size_t m_size { 0 };
+    u8 m_data[0];
+};
+
+}
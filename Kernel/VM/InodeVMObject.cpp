@@ -26,6 +26,32 @@ InodeVMObject::InodeVMObject(const InodeVMObject& other)
         m_dirty_pages.set(i, other.m_dirty_pages.get(i));
 }
 
+static constexpr size_t MAXIMUM_READ_AHEAD_PAGES = 32;
+
+size_t InodeVMObject::read_ahead_page_count_for_fault(size_t page_index) const
+{
+    VERIFY(m_paging_lock.is_locked());
+    size_t window = 1;
+    if (page_index != 0 && page_index == m_read_ahead_next_page_index)
+        window = min(m_read_ahead_window * 2, MAXIMUM_READ_AHEAD_PAGES);
+
+    // Only read ahead into pages that aren't already resident.
+    size_t page_count = 1;
+    while (page_count < window && page_index + page_count < this->page_count()) {
+        if (!m_physical_pages[page_index + page_count].is_null())
+            break;
+        ++page_count;
+    }
+    return page_count;
+}
+
+void InodeVMObject::did_read_ahead(size_t page_index, size_t page_count)
+{
+    VERIFY(m_paging_lock.is_locked());
+    m_read_ahead_next_page_index = page_index + page_count;
+    m_read_ahead_window = page_count;
+}
+
 InodeVMObject::~InodeVMObject()
 {
 }
@@ -73,6 +99,19 @@ int InodeVMObject::release_all_clean_pages_impl()
     return count;
 }
 
+void InodeVMObject::release_pages_from(size_t first_page_index)
+{
+    Locker locker(m_paging_lock);
+    InterruptDisabler disabler;
+    for (size_t i = first_page_index; i < page_count(); ++i) {
+        m_physical_pages[i] = nullptr;
+        m_dirty_pages.set(i, false);
+    }
+    for_each_region([](auto& region) {
+        region.remap();
+    });
+}
+
 u32 InodeVMObject::writable_mappings() const
 {
     u32 count = 0;
@@ -20,13 +20,19 @@ public:
     const Inode& inode() const { return *m_inode; }
 
     size_t amount_dirty() const;
+    bool is_page_dirty(size_t page_index) const { return m_dirty_pages.get(page_index); }
     size_t amount_clean() const;
 
     int release_all_clean_pages();
+    // Forgets about every page from first_page_index onwards, whether it's dirty or not.
+    void release_pages_from(size_t first_page_index);
 
     u32 writable_mappings() const;
     u32 executable_mappings() const;
 
+    size_t read_ahead_page_count_for_fault(size_t page_index) const;
+    void did_read_ahead(size_t page_index, size_t page_count);
+
 protected:
     explicit InodeVMObject(Inode&, size_t);
     explicit InodeVMObject(const InodeVMObject&);
@@ -41,6 +47,11 @@ protected:
 
     NonnullRefPtr<Inode> m_inode;
     Bitmap m_dirty_pages;
+
+    // The read-ahead window doubles for every fault that picks up right where
+    // the previous one left off, and collapses back to a single page otherwise.
+    size_t m_read_ahead_next_page_index { 0 };
+    size_t m_read_ahead_window { 1 };
 };
 
 }
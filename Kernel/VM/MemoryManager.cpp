@@ -6,10 +6,12 @@
 
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
+#include <AK/Singleton.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/CMOS.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Process.h>
@@ -20,6 +22,7 @@
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PhysicalRegion.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/WaitQueue.h>
 
 extern u8* start_of_kernel_image;
 extern u8* end_of_kernel_image;
@@ -46,6 +49,10 @@ namespace Kernel {
 static MemoryManager* s_the;
 RecursiveSpinLock s_mm_lock;
 
+static constexpr size_t PRE_ZEROED_PAGE_POOL_SIZE = 256;
+static AK::Singleton<WaitQueue> s_pre_zeroed_pages_wait_queue;
+static AK::Singleton<WaitQueue> s_page_reclaim_wait_queue;
+
 MemoryManager& MM
 {
     return *s_the;
@@ -77,6 +84,8 @@ UNMAP_AFTER_INIT MemoryManager::MemoryManager()
     // By using a tag we don't have to query the VMObject for every page
     // whether it was committed or not
     m_lazy_committed_page = allocate_committed_user_physical_page();
+
+    m_pre_zeroed_pages.ensure_capacity(PRE_ZEROED_PAGE_POOL_SIZE);
 }
 
 UNMAP_AFTER_INIT MemoryManager::~MemoryManager()
@@ -307,7 +316,7 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
 
     auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
     const PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -323,8 +332,14 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
-    PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present()) {
+    PageDirectoryEntry* pde = &pd[page_directory_index];
+    if (pde->is_present() && pde->is_huge()) {
+        if (!split_large_page(page_directory, vaddr))
+            return nullptr;
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+        pde = &pd[page_directory_index];
+    }
+    if (!pde->is_present()) {
         bool did_purge = false;
         auto page_table = allocate_user_physical_page(ShouldZeroFill::Yes, &did_purge);
         if (!page_table) {
@@ -336,22 +351,22 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
             // of the purging process. So we need to re-map the pd in this case to ensure
             // we're writing to the correct underlying physical page
             pd = quickmap_pd(page_directory, page_directory_table_index);
-            VERIFY(&pde == &pd[page_directory_index]); // Sanity check
+            VERIFY(pde == &pd[page_directory_index]); // Sanity check
 
-            VERIFY(!pde.is_present()); // Should have not changed
+            VERIFY(!pde->is_present()); // Should have not changed
         }
-        pde.set_page_table_base(page_table->paddr().get());
-        pde.set_user_allowed(true);
-        pde.set_present(true);
-        pde.set_writable(true);
-        pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+        pde->set_page_table_base(page_table->paddr().get());
+        pde->set_user_allowed(true);
+        pde->set_present(true);
+        pde->set_writable(true);
+        pde->set_global(&page_directory == m_kernel_page_directory.ptr());
         // Use page_directory_table_index and page_directory_index as key
         // This allows us to release the page table entry when no longer needed
         auto result = page_directory.m_page_tables.set(vaddr.get() & ~0x1fffff, move(page_table));
         VERIFY(result == AK::HashSetResult::InsertedNewEntry);
     }
 
-    return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
+    return &quickmap_pt(PhysicalAddress((FlatPtr)pde->page_table_base()))[page_table_index];
 }
 
 void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress vaddr, bool is_last_release)
@@ -365,6 +380,13 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge()) {
+        // Large pages are only ever installed for 2 MiB ranges that lie entirely
+        // within one region, and regions are always unmapped as a whole, so we
+        // can drop the whole large page on the first release.
+        pde.clear();
+        return;
+    }
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -390,6 +412,72 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+PageDirectoryEntry* MemoryManager::ensure_large_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    VERIFY(vaddr.get() % LARGE_PAGE_SIZE == 0);
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    if (pd[page_directory_index].is_present() && !pd[page_directory_index].is_huge()) {
+        // The caller owns this whole 2 MiB range, so nobody else can have
+        // anything mapped through this page table. We can simply drop it.
+        pd[page_directory_index].clear();
+        auto result = page_directory.m_page_tables.remove(vaddr.get());
+        VERIFY(result);
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+    }
+    return &pd[page_directory_index];
+}
+
+bool MemoryManager::split_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    // Someone wants to map individual pages inside a large page, so we need to
+    // replace it with a page table that maps the same memory with 4 KiB pages.
+    auto page_table = allocate_user_physical_page(ShouldZeroFill::No);
+    if (!page_table) {
+        dbgln("MM: Unable to allocate page table to split large page at {}", vaddr);
+        return false;
+    }
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    VERIFY(pde.is_present() && pde.is_huge());
+
+    auto* pt = quickmap_pt(page_table->paddr());
+    FlatPtr base = (FlatPtr)pde.page_table_base();
+    for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto& pte = pt[i];
+        pte.clear();
+        pte.set_physical_page_base(base + i * PAGE_SIZE);
+        pte.set_writable(pde.is_writable());
+        pte.set_user_allowed(pde.is_user_allowed());
+        pte.set_write_through(pde.is_write_through());
+        pte.set_cache_disabled(pde.is_cache_disabled());
+        pte.set_global(pde.is_global());
+        pte.set_execute_disabled(pde.is_execute_disabled());
+        pte.set_present(true);
+    }
+
+    pde.set_huge(false);
+    pde.set_execute_disabled(false);
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_writable(true);
+    auto result = page_directory.m_page_tables.set(vaddr.get() & ~0x1fffff, page_table.release_nonnull());
+    VERIFY(result == AK::HashSetResult::InsertedNewEntry);
+    return true;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     auto mm_data = new MemoryManagerData;
@@ -533,8 +621,14 @@ bool MemoryManager::commit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
     ScopedSpinLock lock(s_mm_lock);
-    if (m_user_physical_pages_uncommitted < page_count)
-        return false;
+    if (m_user_physical_pages_uncommitted < page_count) {
+        // The pre-zeroed pages are really free memory, so give them back if we need them.
+        release_pre_zeroed_pages();
+        if (m_user_physical_pages_uncommitted < page_count) {
+            request_page_reclaim();
+            return false;
+        }
+    }
 
     m_user_physical_pages_uncommitted -= page_count;
     m_user_physical_pages_committed += page_count;
@@ -597,9 +691,86 @@ RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
     return page;
 }
 
+RefPtr<PhysicalPage> MemoryManager::take_pre_zeroed_page(bool committed)
+{
+    VERIFY(s_mm_lock.own_lock());
+    if (m_pre_zeroed_pages.is_empty())
+        return {};
+
+    auto page = m_pre_zeroed_pages.take_last();
+    if (committed) {
+        // Pre-zeroed pages were taken out of the uncommitted pool, so trade
+        // one of the committed pages for it.
+        VERIFY(m_user_physical_pages_committed > 0);
+        m_user_physical_pages_committed--;
+        m_user_physical_pages_uncommitted++;
+    }
+
+    if (m_pre_zeroing_enabled && m_pre_zeroed_pages.size() < PRE_ZEROED_PAGE_POOL_SIZE / 2 && !m_pre_zeroed_page_demand_pending.exchange(true)) {
+        // We're holding the MM lock, so let the PageZeroingTask know once we're out of here.
+        Processor::deferred_call_queue([] {
+            s_pre_zeroed_pages_wait_queue->wake_one();
+        });
+    }
+    return page;
+}
+
+void MemoryManager::release_pre_zeroed_pages()
+{
+    VERIFY(s_mm_lock.own_lock());
+    // Dropping the last reference returns each page to the uncommitted pool.
+    m_pre_zeroed_pages.clear_with_capacity();
+}
+
+bool MemoryManager::pre_zero_one_page()
+{
+    ScopedSpinLock lock(s_mm_lock);
+    if (m_pre_zeroed_pages.size() >= PRE_ZEROED_PAGE_POOL_SIZE)
+        return false;
+    // Don't hoard pages when memory is getting tight.
+    if (m_user_physical_pages_uncommitted < PRE_ZEROED_PAGE_POOL_SIZE * 4)
+        return false;
+
+    auto page = find_free_user_physical_page(false);
+    if (!page)
+        return false;
+    auto* ptr = quickmap_page(*page);
+    memset(ptr, 0, PAGE_SIZE);
+    unquickmap_page();
+    m_pre_zeroed_pages.unchecked_append(page.release_nonnull());
+    return true;
+}
+
+void MemoryManager::wait_for_pre_zeroed_page_demand()
+{
+    m_pre_zeroing_enabled = true;
+    m_pre_zeroed_page_demand_pending = false;
+    s_pre_zeroed_pages_wait_queue->wait_forever("PageZeroingTask");
+}
+
+void MemoryManager::request_page_reclaim()
+{
+    if (m_page_reclaim_demand_pending.exchange(true))
+        return;
+    // We're usually holding the MM lock, so let the PageReclaimTask know once we're out of here.
+    Processor::deferred_call_queue([] {
+        s_page_reclaim_wait_queue->wake_one();
+    });
+}
+
+void MemoryManager::wait_for_page_reclaim_demand(const Time& timeout)
+{
+    m_page_reclaim_demand_pending = false;
+    (void)s_page_reclaim_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "PageReclaimTask");
+}
+
 NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page(ShouldZeroFill should_zero_fill)
 {
     ScopedSpinLock lock(s_mm_lock);
+    if (should_zero_fill == ShouldZeroFill::Yes) {
+        if (auto page = take_pre_zeroed_page(true))
+            return page.release_nonnull();
+    }
     auto page = find_free_user_physical_page(true);
     if (should_zero_fill == ShouldZeroFill::Yes) {
         auto* ptr = quickmap_page(*page);
@@ -612,7 +783,16 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
     ScopedSpinLock lock(s_mm_lock);
+    if (did_purge)
+        *did_purge = false;
+    if (should_zero_fill == ShouldZeroFill::Yes) {
+        if (auto page = take_pre_zeroed_page(false))
+            return page;
+    }
+
     auto page = find_free_user_physical_page(false);
+    if (!page)
+        page = take_pre_zeroed_page(false);
     bool purged_pages = false;
 
     if (!page) {
@@ -631,8 +811,18 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             }
             return IterationDecision::Continue;
         });
+        if (!page) {
+            // Next, we give back the empty slabs held by the kernel object caches.
+            if (auto reclaimed_slabs = slab_cache_reclaim_empty_slabs()) {
+                dbgln("MM: Reclaimed {} empty slabs from kernel object caches", reclaimed_slabs);
+                page = find_free_user_physical_page(false);
+                purged_pages = true;
+            }
+        }
         if (!page) {
             dmesgln("MM: no user physical pages available");
+            // The page cache may be sitting on memory that it can give back, but only outside the MM lock.
+            request_page_reclaim();
             return {};
         }
     }
@@ -676,7 +866,7 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
     for (auto& region : m_super_physical_regions) {
         physical_pages = region.take_contiguous_free_pages(count, true, physical_alignment);
         if (!physical_pages.is_empty())
-            continue;
+            break;
     }
 
     if (physical_pages.is_empty()) {
@@ -695,6 +885,42 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
     return physical_pages;
 }
 
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_user_physical_pages(size_t size, size_t physical_alignment)
+{
+    VERIFY(!(size % PAGE_SIZE));
+    size_t count = ceil_div(size, static_cast<size_t>(PAGE_SIZE));
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        // We need to make sure we don't touch pages that we have committed to
+        if (m_user_physical_pages_uncommitted < count) {
+            request_page_reclaim();
+            return {};
+        }
+
+        for (auto& region : m_user_physical_regions) {
+            physical_pages = region.take_contiguous_free_pages(count, false, physical_alignment);
+            if (!physical_pages.is_empty())
+                break;
+        }
+        if (physical_pages.is_empty())
+            return {};
+
+        m_user_physical_pages_uncommitted -= count;
+        m_user_physical_pages_used += count;
+    }
+
+    // NOTE: This can be a whole large page worth of memory, so we zero it without holding s_mm_lock.
+    //       quickmap_page() only takes the lock for as long as it takes to install the mapping.
+    for (auto& page : physical_pages) {
+        InterruptDisabler disabler;
+        auto* ptr = quickmap_page(page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+    return physical_pages;
+}
+
 RefPtr<PhysicalPage> MemoryManager::allocate_supervisor_physical_page()
 {
     ScopedSpinLock lock(s_mm_lock);
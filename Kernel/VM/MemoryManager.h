@@ -20,6 +20,10 @@
 
 namespace Kernel {
 
+// With PAE, a single page directory entry can map 2 MiB of contiguous memory.
+static constexpr size_t LARGE_PAGE_SIZE = 2 * MiB;
+static constexpr size_t PAGES_PER_LARGE_PAGE = LARGE_PAGE_SIZE / PAGE_SIZE;
+
 constexpr bool page_round_up_would_wrap(FlatPtr x)
 {
     return x > 0xfffff000u;
@@ -102,10 +106,12 @@ class MemoryManager {
     AK_MAKE_ETERNAL
     friend class PageDirectory;
     friend class PhysicalPage;
+    friend class PageCache;
     friend class PhysicalRegion;
     friend class AnonymousVMObject;
     friend class Region;
     friend class VMObject;
+    friend class TmpFSInode;
 
 public:
     static MemoryManager& the();
@@ -128,6 +134,8 @@ public:
     static void enter_process_paging_scope(Process&);
     static void enter_space(Space&);
 
+    static void flush_tlb(const PageDirectory*, VirtualAddress, size_t page_count = 1);
+
     bool validate_user_stack(const Process&, VirtualAddress) const;
 
     enum class ShouldZeroFill {
@@ -141,7 +149,14 @@ public:
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size, size_t physical_alignment = PAGE_SIZE);
+    NonnullRefPtrVector<PhysicalPage> allocate_contiguous_user_physical_pages(size_t size, size_t physical_alignment = PAGE_SIZE);
     void deallocate_user_physical_page(const PhysicalPage&);
+
+    bool pre_zero_one_page();
+    void wait_for_pre_zeroed_page_demand();
+    unsigned pre_zeroed_user_physical_pages() const { return m_pre_zeroed_pages.size(); }
+    // The PageReclaimTask waits here between passes, and gets woken up early when we run out of memory.
+    void wait_for_page_reclaim_demand(const Time& timeout);
     void deallocate_supervisor_physical_page(const PhysicalPage&);
 
     OwnPtr<Region> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, size_t physical_alignment = PAGE_SIZE, Region::Cacheable = Region::Cacheable::Yes);
@@ -201,13 +216,15 @@ private:
     void protect_kernel_image();
     void parse_memory_map();
     static void flush_tlb_local(VirtualAddress, size_t page_count = 1);
-    static void flush_tlb(const PageDirectory*, VirtualAddress, size_t page_count = 1);
 
     static Region* kernel_region_from_vaddr(VirtualAddress);
 
     static Region* find_region_from_vaddr(VirtualAddress);
 
     RefPtr<PhysicalPage> find_free_user_physical_page(bool);
+    RefPtr<PhysicalPage> take_pre_zeroed_page(bool committed);
+    void release_pre_zeroed_pages();
+    void request_page_reclaim();
     u8* quickmap_page(PhysicalPage&);
     void unquickmap_page();
 
@@ -217,12 +234,21 @@ private:
     PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry* ensure_pte(PageDirectory&, VirtualAddress);
     void release_pte(PageDirectory&, VirtualAddress, bool);
+    PageDirectoryEntry* ensure_large_pde(PageDirectory&, VirtualAddress);
+    bool split_large_page(PageDirectory&, VirtualAddress);
 
     RefPtr<PageDirectory> m_kernel_page_directory;
 
     RefPtr<PhysicalPage> m_shared_zero_page;
     RefPtr<PhysicalPage> m_lazy_committed_page;
 
+    // Pages zeroed ahead of time by the PageZeroingTask. These are allocated
+    // out of the uncommitted pool, so they don't count as free.
+    Vector<NonnullRefPtr<PhysicalPage>> m_pre_zeroed_pages;
+    Atomic<bool> m_pre_zeroing_enabled { false };
+    Atomic<bool> m_pre_zeroed_page_demand_pending { false };
+    Atomic<bool> m_page_reclaim_demand_pending { false };
+
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_user_physical_pages { 0 };
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_user_physical_pages_used { 0 };
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_user_physical_pages_committed { 0 };
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AllOf.h>
+#include <AK/Singleton.h>
+#include <Kernel/FileSystem/DentryCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
+#include <Kernel/VM/PhysicalPage.h>
+
+namespace Kernel {
+
+static AK::Singleton<PageCache> s_the;
+
+// Files larger than this are read around the cache, so that a single huge file can't
+// make us allocate an enormous physical page slot table.
+static constexpr u64 MAXIMUM_CACHEABLE_FILE_SIZE = 256 * MiB;
+
+// When free memory drops below 1/RESERVE_FRACTION of all user memory, we start giving cached pages back.
+static constexpr size_t RESERVE_FRACTION = 16;
+static constexpr size_t RECLAIM_BATCH_PAGES = 64;
+
+PageCache& PageCache::the()
+{
+    return *s_the;
+}
+
+PageCache::PageCache()
+{
+}
+
+PageCache::Entry::Entry(NonnullRefPtr<SharedInodeVMObject> vmobject)
+    : vmobject(move(vmobject))
+    , referenced_pages(this->vmobject->page_count(), false)
+{
+}
+
+bool PageCache::is_cacheable(const Inode& inode)
+{
+    return inode.fs().supports_page_cache() && inode.metadata().is_regular_file();
+}
+
+RefPtr<PageCache::Entry> PageCache::find_entry(Inode& inode) const
+{
+    Locker locker(m_lock);
+    auto it = m_entries.find(&inode);
+    if (it == m_entries.end())
+        return {};
+    return it->value;
+}
+
+RefPtr<PageCache::Entry> PageCache::ensure_entry(Inode& inode)
+{
+    if (auto entry = find_entry(inode))
+        return entry;
+
+    if (inode.size() > MAXIMUM_CACHEABLE_FILE_SIZE)
+        return {};
+
+    // NOTE: Creating the VMObject takes the inode lock, so we do it before taking our own.
+    auto vmobject = SharedInodeVMObject::create_with_inode(inode);
+    auto new_entry = adopt_ref_if_nonnull(new Entry(move(vmobject)));
+    if (!new_entry)
+        return {};
+
+    Locker locker(m_lock);
+    // Someone else may have beaten us to it while we weren't holding the lock.
+    if (auto it = m_entries.find(&inode); it != m_entries.end())
+        return it->value;
+    m_entries.set(&inode, *new_entry);
+    m_clock.append(*new_entry);
+    return new_entry;
+}
+
+KResultOr<ssize_t> PageCache::read(Inode& inode, u64 offset, size_t count, UserOrKernelBuffer& buffer)
+{
+    reclaim_if_needed();
+
+    auto entry = ensure_entry(inode);
+    if (!entry)
+        return inode.read_bytes(offset, count, buffer, nullptr);
+
+    u64 size = inode.size();
+    if (offset >= size)
+        return 0;
+    count = min((u64)count, size - offset);
+
+    auto& vmobject = static_cast<VMObject&>(*entry->vmobject);
+    Locker locker(vmobject.m_paging_lock);
+
+    u8 page_buffer[PAGE_SIZE];
+    size_t nread = 0;
+    while (nread < count) {
+        u64 position = offset + nread;
+        size_t page_index = position / PAGE_SIZE;
+        if (page_index >= vmobject.page_count()) {
+            // The file has grown past the end of its VMObject, read the rest straight from the inode.
+            auto remaining_buffer = buffer.offset(nread);
+            auto result = inode.read_bytes(position, count - nread, remaining_buffer, nullptr);
+            if (result.is_error()) {
+                if (nread > 0)
+                    break;
+                return result.error();
+            }
+            nread += result.value();
+            break;
+        }
+
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t nchunk = min(PAGE_SIZE - offset_in_page, count - nread);
+        auto& page_slot = vmobject.m_physical_pages[page_index];
+
+        if (page_slot.is_null()) {
+            auto page_buffer_as_buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
+            auto result = inode.read_bytes((u64)page_index * PAGE_SIZE, PAGE_SIZE, page_buffer_as_buffer, nullptr);
+            if (result.is_error()) {
+                if (nread > 0)
+                    break;
+                return result.error();
+            }
+            if ((size_t)result.value() < PAGE_SIZE)
+                memset(page_buffer + result.value(), 0, PAGE_SIZE - result.value());
+
+            // If we can't get a page for the cache, that's fine, the caller still gets their data.
+            if (auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No)) {
+                ScopedSpinLock lock(s_mm_lock);
+                memcpy(MM.quickmap_page(*page), page_buffer, PAGE_SIZE);
+                MM.unquickmap_page();
+                page_slot = move(page);
+            }
+            ++m_miss_count;
+        } else {
+            ScopedSpinLock lock(s_mm_lock);
+            memcpy(page_buffer, MM.quickmap_page(*page_slot), PAGE_SIZE);
+            MM.unquickmap_page();
+            ++m_hit_count;
+        }
+
+        if (!buffer.write(page_buffer + offset_in_page, nread, nchunk)) {
+            if (nread > 0)
+                break;
+            return EFAULT;
+        }
+        entry->referenced_pages.set(page_index, true);
+        nread += nchunk;
+    }
+    return nread;
+}
+
+void PageCache::release_pages(Entry& entry, size_t first_page_index, size_t page_count)
+{
+    auto& vmobject = static_cast<VMObject&>(*entry.vmobject);
+    VERIFY(vmobject.m_paging_lock.is_locked());
+    VERIFY(first_page_index + page_count <= vmobject.page_count());
+
+    bool released_any = false;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        for (size_t i = first_page_index; i < first_page_index + page_count; ++i) {
+            // Dirty pages hold changes that only exist in memory, so they have to stay.
+            if (vmobject.m_physical_pages[i].is_null() || entry.vmobject->is_page_dirty(i))
+                continue;
+            vmobject.m_physical_pages[i] = nullptr;
+            entry.referenced_pages.set(i, false);
+            released_any = true;
+        }
+    }
+    if (released_any) {
+        vmobject.for_each_region([](auto& region) {
+            region.remap();
+        });
+    }
+}
+
+void PageCache::did_write(Inode& inode, u64 offset, const UserOrKernelBuffer& data, size_t count)
+{
+    auto entry = find_entry(inode);
+    if (!entry)
+        return;
+
+    auto& vmobject = static_cast<VMObject&>(*entry->vmobject);
+    Locker locker(vmobject.m_paging_lock);
+
+    u8 chunk_buffer[PAGE_SIZE];
+    size_t nupdated = 0;
+    while (nupdated < count) {
+        u64 position = offset + nupdated;
+        size_t page_index = position / PAGE_SIZE;
+        // Pages past the end of the VMObject were never cached.
+        if (page_index >= vmobject.page_count())
+            break;
+
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t nchunk = min(PAGE_SIZE - offset_in_page, count - nupdated);
+        auto& page_slot = vmobject.m_physical_pages[page_index];
+        if (!page_slot.is_null()) {
+            // NOTE: The data may live in userspace, so fetch it before we take the MM lock.
+            if (data.read(chunk_buffer, nupdated, nchunk)) {
+                ScopedSpinLock lock(s_mm_lock);
+                memcpy(MM.quickmap_page(*page_slot) + offset_in_page, chunk_buffer, nchunk);
+                MM.unquickmap_page();
+            } else {
+                // The data made it to the inode but we can't see it anymore, so the page would go stale.
+                release_pages(*entry, page_index, 1);
+            }
+        }
+        nupdated += nchunk;
+    }
+}
+
+void PageCache::did_truncate(Inode& inode, u64 size)
+{
+    auto entry = find_entry(inode);
+    if (!entry)
+        return;
+
+    auto& vmobject = static_cast<VMObject&>(*entry->vmobject);
+    {
+        Locker locker(vmobject.m_paging_lock);
+        size_t page_index = size / PAGE_SIZE;
+        size_t offset_in_page = size % PAGE_SIZE;
+        // The page containing the new end of the file stays, but whatever was past the end is gone,
+        // so growing the file again doesn't resurrect stale data.
+        if (offset_in_page != 0 && page_index < vmobject.page_count() && !vmobject.m_physical_pages[page_index].is_null()) {
+            ScopedSpinLock lock(s_mm_lock);
+            memset(MM.quickmap_page(*vmobject.m_physical_pages[page_index]) + offset_in_page, 0, PAGE_SIZE - offset_in_page);
+            MM.unquickmap_page();
+        }
+    }
+    // Everything after that is past the end of the file now, dirty or not.
+    entry->vmobject->release_pages_from(min(ceil_div(size, (u64)PAGE_SIZE), (u64)vmobject.page_count()));
+}
+
+void PageCache::remove_entries_if(Function<bool(const Entry&)> predicate)
+{
+    Vector<NonnullRefPtr<Entry>> removed_entries;
+    {
+        Locker locker(m_lock);
+        for (auto& it : m_entries) {
+            if (predicate(*it.value))
+                removed_entries.append(it.value);
+        }
+        for (auto& entry : removed_entries) {
+            m_clock.remove(entry);
+            m_entries.remove(&entry->vmobject->inode());
+        }
+    }
+
+    // Let go of the cached data right away, rather than whenever the VMObject happens to die.
+    for (auto& entry : removed_entries) {
+        Locker locker(static_cast<VMObject&>(*entry->vmobject).m_paging_lock);
+        release_pages(entry, 0, entry->vmobject->page_count());
+    }
+}
+
+void PageCache::evict(Inode& inode)
+{
+    remove_entries_if([&](auto& entry) {
+        return &entry.vmobject->inode() == &inode;
+    });
+}
+
+void PageCache::evict_all_on(const FS& fs)
+{
+    remove_entries_if([&](auto& entry) {
+        return &entry.vmobject->inode().fs() == &fs;
+    });
+}
+
+size_t PageCache::sweep(Entry& entry, size_t page_count)
+{
+    auto& vmobject = static_cast<VMObject&>(*entry.vmobject);
+    Locker locker(vmobject.m_paging_lock);
+
+    size_t released_count = 0;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        for (size_t i = 0; i < vmobject.page_count() && released_count < page_count; ++i) {
+            if (vmobject.m_physical_pages[i].is_null() || entry.vmobject->is_page_dirty(i))
+                continue;
+            // Give recently used pages a second chance.
+            if (entry.referenced_pages.get(i)) {
+                entry.referenced_pages.set(i, false);
+                continue;
+            }
+            vmobject.m_physical_pages[i] = nullptr;
+            ++released_count;
+        }
+    }
+    // The VMObject wasn't mapped when we picked it, but make sure nobody raced us to it.
+    if (released_count > 0) {
+        vmobject.for_each_region([](auto& region) {
+            region.remap();
+        });
+    }
+    return released_count;
+}
+
+size_t PageCache::reclaim(size_t page_count)
+{
+    Locker locker(m_lock);
+
+    size_t released_count = 0;
+    Vector<NonnullRefPtr<Entry>> empty_entries;
+
+    // Every entry gets visited at most twice: the first visit may only clear the referenced bits.
+    size_t visits_left = m_entries.size() * 2;
+    while (released_count < page_count && visits_left-- > 0 && !m_clock.is_empty()) {
+        auto& entry = *m_clock.first();
+        m_clock.append(entry);
+
+        // Pages of mapped files are kept alive by their mappings, there's no point in dropping them here.
+        if (entry.vmobject->is_mapped())
+            continue;
+
+        released_count += sweep(entry, page_count - released_count);
+
+        auto& vmobject = *entry.vmobject;
+        if (all_of(vmobject.physical_pages().begin(), vmobject.physical_pages().end(), [](auto& page) { return page.is_null(); }))
+            empty_entries.append(entry);
+    }
+
+    // Entries without any resident pages only keep their inode alive, so let go of them.
+    for (auto& entry : empty_entries) {
+        m_clock.remove(entry);
+        m_entries.remove(&entry->vmobject->inode());
+    }
+
+    m_reclaimed_page_count += released_count;
+    return released_count;
+}
+
+void PageCache::reclaim_if_needed()
+{
+    size_t reserve = MM.user_physical_pages() / RESERVE_FRACTION;
+    size_t available = MM.user_physical_pages_uncommitted();
+    if (available >= reserve)
+        return;
+    reclaim(max(reserve - available, RECLAIM_BATCH_PAGES));
+    // Cached path lookups pin their inodes, give some of those back too.
+    DentryCache::the().shrink();
+}
+
+PageCache::Stats PageCache::stats() const
+{
+    Locker locker(m_lock);
+    Stats stats;
+    stats.cached_inode_count = m_entries.size();
+    for (auto& it : m_entries) {
+        for (auto& page : it.value->vmobject->physical_pages()) {
+            if (!page.is_null())
+                ++stats.resident_page_count;
+        }
+    }
+    stats.hit_count = m_hit_count;
+    stats.miss_count = m_miss_count;
+    stats.reclaimed_page_count = m_reclaimed_page_count;
+    return stats;
+}
+
+}
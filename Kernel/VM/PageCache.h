@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/RefCounted.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Lock.h>
+#include <Kernel/UserOrKernelBuffer.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
+
+namespace Kernel {
+
+// The page cache keeps the contents of regular files resident in the physical pages of
+// their SharedInodeVMObject. Since shared file mappings use that very same VMObject,
+// read(), sendfile() and mmap() of a file all share a single cached copy of its data.
+//
+// The cache doesn't have a fixed size. It grows as long as there is free memory around,
+// and gives pages back (picking the victims with the CLOCK algorithm) once free memory
+// drops below a reserve.
+class PageCache {
+public:
+    static PageCache& the();
+
+    PageCache();
+
+    static bool is_cacheable(const Inode&);
+
+    KResultOr<ssize_t> read(Inode&, u64 offset, size_t count, UserOrKernelBuffer&);
+
+    // Copies freshly written data into any cached pages covering the given range. The pages are updated
+    // rather than dropped, since they may be shared with a MAP_SHARED mapping that has changes of its own.
+    void did_write(Inode&, u64 offset, const UserOrKernelBuffer&, size_t count);
+    void did_truncate(Inode&, u64 size);
+
+    void evict(Inode&);
+    void evict_all_on(const FS&);
+
+    size_t reclaim(size_t page_count);
+    // Gives cached pages back if free memory has dropped below the reserve.
+    void reclaim_if_needed();
+
+    struct Stats {
+        size_t cached_inode_count { 0 };
+        size_t resident_page_count { 0 };
+        size_t hit_count { 0 };
+        size_t miss_count { 0 };
+        size_t reclaimed_page_count { 0 };
+    };
+    Stats stats() const;
+
+private:
+    struct Entry : public RefCounted<Entry> {
+        explicit Entry(NonnullRefPtr<SharedInodeVMObject>);
+
+        NonnullRefPtr<SharedInodeVMObject> vmobject;
+        Bitmap referenced_pages;
+        IntrusiveListNode<Entry> clock_list_node;
+    };
+
+    RefPtr<Entry> ensure_entry(Inode&);
+    RefPtr<Entry> find_entry(Inode&) const;
+    void remove_entries_if(Function<bool(const Entry&)>);
+    size_t sweep(Entry&, size_t page_count);
+    static void release_pages(Entry&, size_t first_page_index, size_t page_count);
+
+    mutable Lock m_lock { "PageCache" };
+    HashMap<const Inode*, NonnullRefPtr<Entry>> m_entries;
+    // The clock hand always points at the first entry in this list.
+    IntrusiveList<Entry, RawPtr<Entry>, &Entry::clock_list_node> m_clock;
+
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_hit_count { 0 };
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_miss_count { 0 };
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_reclaimed_page_count { 0 };
+};
+
+}
@@ -19,7 +19,7 @@ class PhysicalPage {
     friend class PageDirectory;
     friend class VMObject;
 
-    MAKE_SLAB_ALLOCATED(PhysicalPage);
+    MAKE_SLAB_CACHED(PhysicalPage);
     AK_MAKE_NONMOVABLE(PhysicalPage);
 
 public:
@@ -45,6 +45,11 @@ public:
 
     bool is_shared_zero_page() const;
     bool is_lazy_committed_page() const;
+    bool may_return_to_freelist() const { return m_may_return_to_freelist; }
+
+    // How many page aging passes in a row have found this page untouched.
+    u8 age() const { return m_age; }
+    void set_age(u8 age) { m_age = age; }
 
 private:
     PhysicalPage(PhysicalAddress paddr, bool supervisor, bool may_return_to_freelist = true);
@@ -55,6 +60,7 @@ private:
     Atomic<u32> m_ref_count { 1 };
     bool m_may_return_to_freelist { true };
     bool m_supervisor { false };
+    u8 m_age { 0 };
     PhysicalAddress m_paddr;
 };
 
@@ -47,26 +47,26 @@ unsigned PhysicalRegion::finalize_capacity()
 NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
 {
     VERIFY(m_pages);
-    VERIFY(m_used != m_pages);
-
-    NonnullRefPtrVector<PhysicalPage> physical_pages;
-    physical_pages.ensure_capacity(count);
+    if (m_used == m_pages)
+        return {};
 
     auto first_contiguous_page = find_contiguous_free_pages(count, physical_alignment);
+    if (!first_contiguous_page.has_value())
+        return {};
 
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    physical_pages.ensure_capacity(count);
     for (size_t index = 0; index < count; index++)
-        physical_pages.append(PhysicalPage::create(m_lower.offset(PAGE_SIZE * (index + first_contiguous_page)), supervisor));
+        physical_pages.append(PhysicalPage::create(m_lower.offset(PAGE_SIZE * (index + first_contiguous_page.value())), supervisor));
     return physical_pages;
 }
 
-unsigned PhysicalRegion::find_contiguous_free_pages(size_t count, size_t physical_alignment)
+Optional<unsigned> PhysicalRegion::find_contiguous_free_pages(size_t count, size_t physical_alignment)
 {
     VERIFY(count != 0);
     VERIFY(physical_alignment % PAGE_SIZE == 0);
     // search from the last page we allocated
-    auto range = find_and_allocate_contiguous_range(count, physical_alignment / PAGE_SIZE);
-    VERIFY(range.has_value());
-    return range.value();
+    return find_and_allocate_contiguous_range(count, physical_alignment / PAGE_SIZE);
 }
 
 Optional<unsigned> PhysicalRegion::find_one_free_page()
@@ -112,7 +112,8 @@ Optional<unsigned> PhysicalRegion::find_and_allocate_contiguous_range(size_t cou
         auto lower_page = m_lower.get() / PAGE_SIZE;
         page = ((lower_page + page + alignment - 1) & ~(alignment - 1)) - lower_page;
     }
-    if (found_pages_count >= count) {
+    // Aligning the start may have eaten into the range we found.
+    if (found_pages_count >= count + (page - first_index.value())) {
         m_bitmap.set_range<true>(page, count);
         m_used += count;
         m_free_hint = first_index.value() + count + 1; // Just a guess
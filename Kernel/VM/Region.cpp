@@ -8,6 +8,7 @@
 #include <AK/StringView.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Panic.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
@@ -19,6 +20,9 @@
 
 namespace Kernel {
 
+// When paging in from an inode, also map the cached pages in this aligned window around the fault.
+static constexpr size_t FAULT_AROUND_PAGES = 16;
+
 Region::Region(const Range& range, NonnullRefPtr<VMObject> vmobject, size_t offset_in_vmobject, OwnPtr<KString> name, Region::Access access, Cacheable cacheable, bool shared)
     : PurgeablePageRanges(vmobject)
     , m_range(range)
@@ -90,6 +94,8 @@ OwnPtr<Region> Region::clone(Process& new_owner)
         region->set_mmap(m_mmap);
         region->set_shared(m_shared);
         region->set_syscall_region(is_syscall_region());
+        region->set_large_pages_enabled(m_large_pages);
+        region->set_mergeable(m_mergeable);
         return region;
     }
 
@@ -101,7 +107,9 @@ OwnPtr<Region> Region::clone(Process& new_owner)
         return {};
 
     // Set up a COW region. The parent (this) region becomes COW as well!
-    remap();
+    // NOTE: The caller is responsible for flushing the TLB, since fork() does that
+    //       once for all regions instead of once per region.
+    map(*m_page_directory, ShouldFlushTLB::No);
     auto clone_region = Region::create_user_accessible(
         &new_owner, m_range, vmobject_clone.release_nonnull(), m_offset_in_vmobject, m_name ? m_name->try_clone() : OwnPtr<KString> {}, access(), m_cacheable ? Cacheable::Yes : Cacheable::No, m_shared);
     if (m_vmobject->is_anonymous())
@@ -114,6 +122,8 @@ OwnPtr<Region> Region::clone(Process& new_owner)
     }
     clone_region->set_syscall_region(is_syscall_region());
     clone_region->set_mmap(m_mmap);
+    clone_region->set_large_pages_enabled(m_large_pages);
+    clone_region->set_mergeable(m_mergeable);
     return clone_region;
 }
 
@@ -267,6 +277,89 @@ bool Region::map_individual_page_impl(size_t page_index)
     return true;
 }
 
+bool Region::can_map_large_page(size_t page_index) const
+{
+    if (!m_large_pages || !is_user() || !vmobject().is_anonymous())
+        return false;
+    if (!is_readable() && !is_writable())
+        return false;
+    if (vaddr_from_page_index(page_index).get() % LARGE_PAGE_SIZE != 0)
+        return false;
+    if (page_index + PAGES_PER_LARGE_PAGE > page_count())
+        return false;
+
+    // We can only use a large page if the whole 2 MiB range is backed by
+    // physically contiguous (and suitably aligned) pages that all want to be
+    // mapped the same way.
+    auto* first_page = physical_page(page_index);
+    if (!first_page || first_page->paddr().get() % LARGE_PAGE_SIZE != 0)
+        return false;
+    for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto* page = physical_page(page_index + i);
+        if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page())
+            return false;
+        if (page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if (should_cow(page_index + i))
+            return false;
+    }
+    return true;
+}
+
+bool Region::map_large_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().own_lock());
+    auto page_vaddr = vaddr_from_page_index(page_index);
+
+    bool user_allowed = page_vaddr.get() >= 0x00800000 && is_user_address(page_vaddr);
+    if (is_mmap() && !user_allowed) {
+        PANIC("About to map mmap'ed page at a kernel address");
+    }
+
+    auto* pde = MM.ensure_large_pde(*m_page_directory, page_vaddr);
+    if (!pde)
+        return false;
+    pde->clear();
+    pde->set_page_table_base(physical_page(page_index)->paddr().get());
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_writable(is_writable());
+    if (Processor::current().has_feature(CPUFeature::NX))
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(user_allowed);
+    pde->set_present(true);
+    return true;
+}
+
+bool Region::try_populate_large_page(size_t page_index, ScopedSpinLock<RecursiveSpinLock>& mm_lock)
+{
+    VERIFY(vmobject().is_anonymous());
+    if (!m_large_pages || !is_user())
+        return false;
+
+    auto large_page_vaddr = VirtualAddress(vaddr_from_page_index(page_index).get() & ~(LARGE_PAGE_SIZE - 1));
+    if (large_page_vaddr < vaddr())
+        return false;
+    auto first_page_index = (large_page_vaddr.get() - vaddr().get()) / PAGE_SIZE;
+    if (first_page_index + PAGES_PER_LARGE_PAGE > page_count())
+        return false;
+
+    auto first_page_index_in_vmobject = translate_to_vmobject_page(first_page_index);
+    auto& vmobject = static_cast<AnonymousVMObject&>(*m_vmobject);
+
+    // Zeroing a whole large page takes a while, so don't hold everyone else's page faults up meanwhile.
+    // The vmobject rechecks the range before it installs the pages, and our paging lock is still held.
+    mm_lock.unlock();
+    VERIFY(!s_mm_lock.own_lock());
+    bool populated = vmobject.try_populate_large_page(first_page_index_in_vmobject);
+    mm_lock.lock();
+    VERIFY_INTERRUPTS_DISABLED();
+    if (!populated)
+        return false;
+    dbgln_if(PAGE_FAULT_DEBUG, "      >> POPULATED LARGE PAGE {}", large_page_vaddr);
+    return remap_vmobject_page_range(first_page_index_in_vmobject, PAGES_PER_LARGE_PAGE);
+}
+
 bool Region::do_remap_vmobject_page_range(size_t page_index, size_t page_count)
 {
     bool success = true;
@@ -278,6 +371,14 @@ bool Region::do_remap_vmobject_page_range(size_t page_index, size_t page_count)
     ScopedSpinLock page_lock(m_page_directory->get_lock());
     size_t index = page_index;
     while (index < page_index + page_count) {
+        if (index + PAGES_PER_LARGE_PAGE <= page_index + page_count && can_map_large_page(index)) {
+            if (!map_large_page_impl(index)) {
+                success = false;
+                break;
+            }
+            index += PAGES_PER_LARGE_PAGE;
+            continue;
+        }
         if (!map_individual_page_impl(index)) {
             success = false;
             break;
@@ -314,7 +415,7 @@ bool Region::do_remap_vmobject_page(size_t page_index, bool with_flush)
     if (!translate_vmobject_page(page_index))
         return true; // not an error, region doesn't map this page
     ScopedSpinLock page_lock(m_page_directory->get_lock());
-    VERIFY(physical_page(page_index));
+    // NOTE: If the page isn't there (because it's been compressed), this unmaps it.
     bool success = map_individual_page_impl(page_index);
     if (with_flush)
         MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index));
@@ -338,6 +439,111 @@ bool Region::remap_vmobject_page(size_t page_index, bool with_flush)
     return success;
 }
 
+static bool can_reclaim_pages_of(const Region& region)
+{
+    // NOTE: We stay away from anything that the kernel or another region may be looking at.
+    return region.is_user() && !region.is_shared() && region.vmobject().is_anonymous() && !region.vmobject().is_shared_by_multiple_regions();
+}
+
+void Region::age_pages(size_t first_page_index, size_t page_count)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(first_page_index + page_count <= this->page_count());
+    if (!m_page_directory || !can_reclaim_pages_of(*this))
+        return;
+
+    ScopedSpinLock page_lock(m_page_directory->get_lock());
+    bool cleared_any = false;
+    Optional<FlatPtr> page_table_vaddr;
+    PageTableEntry* page_table = nullptr;
+    for (size_t i = first_page_index; i < first_page_index + page_count; ++i) {
+        auto& page = physical_page_slot(i);
+        if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page())
+            continue;
+        // Look up each page table once, rather than once for every page in it.
+        auto page_vaddr = vaddr_from_page_index(i).get();
+        if (page_table_vaddr != (page_vaddr & ~(LARGE_PAGE_SIZE - 1))) {
+            page_table_vaddr = page_vaddr & ~(LARGE_PAGE_SIZE - 1);
+            page_table = MM.pte(*m_page_directory, VirtualAddress(page_table_vaddr.value()));
+        }
+        // Pages without a page table entry (including those in a large page) don't age, we don't know about them.
+        if (!page_table)
+            continue;
+        auto& pte = page_table[(page_vaddr >> 12) & 0x1ff];
+        if (!pte.is_present())
+            continue;
+        if (pte.is_accessed()) {
+            pte.set_accessed(false);
+            page->set_age(0);
+            cleared_any = true;
+        } else if (page->age() < NumericLimits<u8>::max()) {
+            page->set_age(page->age() + 1);
+        }
+    }
+    // The processors won't set the accessed bits again for translations they have cached.
+    if (cleared_any)
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(first_page_index), page_count);
+}
+
+size_t Region::compress_cold_pages(size_t first_page_index, size_t page_count, u8 min_age)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(first_page_index + page_count <= this->page_count());
+    if (!m_page_directory || !can_reclaim_pages_of(*this))
+        return 0;
+
+    auto& vmobject = static_cast<AnonymousVMObject&>(*m_vmobject);
+    size_t compressed_count = 0;
+    for (size_t i = first_page_index; i < first_page_index + page_count; ++i) {
+        auto* page = physical_page(i);
+        if (!page || page->age() < min_age)
+            continue;
+        // Only pages that age_pages() has seen in a page table entry of their own.
+        if (!has_own_page_table_entry(i))
+            continue;
+        if (vmobject.try_compress_page(*this, translate_to_vmobject_page(i)))
+            ++compressed_count;
+    }
+    return compressed_count;
+}
+
+bool Region::has_own_page_table_entry(size_t page_index)
+{
+    VERIFY(m_page_directory);
+    ScopedSpinLock page_lock(m_page_directory->get_lock());
+    auto* pte = MM.pte(*m_page_directory, vaddr_from_page_index(page_index));
+    return pte && pte->is_present();
+}
+
+Optional<u32> Region::hash_page_for_merging(size_t page_index)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_index < page_count());
+    if (!m_page_directory || !m_mergeable || !can_reclaim_pages_of(*this))
+        return {};
+    // NOTE: Pages in a large page would have to be merged all at once, so we leave them alone.
+    if (!has_own_page_table_entry(page_index))
+        return {};
+    return static_cast<AnonymousVMObject&>(*m_vmobject).hash_page_for_merging(*this, translate_to_vmobject_page(page_index));
+}
+
+bool Region::try_merge_page(size_t page_index, Region& other, size_t other_page_index)
+{
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_index < page_count());
+    if (this == &other && page_index == other_page_index)
+        return false;
+    if (other_page_index >= other.page_count() || !other.m_page_directory || !other.m_mergeable || !can_reclaim_pages_of(other))
+        return false;
+    if (!m_page_directory || !m_mergeable || !can_reclaim_pages_of(*this))
+        return false;
+    if (!has_own_page_table_entry(page_index) || !other.has_own_page_table_entry(other_page_index))
+        return false;
+    auto& vmobject = static_cast<AnonymousVMObject&>(*m_vmobject);
+    auto& other_vmobject = static_cast<AnonymousVMObject&>(*other.m_vmobject);
+    return vmobject.try_merge_page(*this, translate_to_vmobject_page(page_index), other_vmobject, other, other.translate_to_vmobject_page(other_page_index));
+}
+
 void Region::unmap(ShouldDeallocateVirtualMemoryRange deallocate_range)
 {
     ScopedSpinLock lock(s_mm_lock);
@@ -379,6 +585,12 @@ bool Region::map(PageDirectory& page_directory, ShouldFlushTLB should_flush_tlb)
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+        if (can_map_large_page(page_index)) {
+            if (!map_large_page_impl(page_index))
+                break;
+            page_index += PAGES_PER_LARGE_PAGE;
+            continue;
+        }
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -391,6 +603,15 @@ bool Region::map(PageDirectory& page_directory, ShouldFlushTLB should_flush_tlb)
     return false;
 }
 
+void Region::map_lazily(PageDirectory& page_directory)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    if (is_user() && !is_shared()) {
+        VERIFY(!vmobject().is_shared_inode());
+    }
+    set_page_directory(page_directory);
+}
+
 void Region::remap()
 {
     VERIFY(m_page_directory);
@@ -415,19 +636,41 @@ PageFaultResponse Region::handle_fault(const PageFault& fault, ScopedSpinLock<Re
         }
 
         auto& page_slot = physical_page_slot(page_index_in_region);
-        if (page_slot->is_lazy_committed_page()) {
+        if (page_slot.is_null() && vmobject().is_anonymous()) {
+            auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(*m_vmobject);
+            auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
+            if (anonymous_vmobject.has_compressed_page(page_index_in_vmobject)) {
+                dbgln_if(PAGE_FAULT_DEBUG, "NP(compressed) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+                auto response = anonymous_vmobject.handle_compressed_page_fault(page_index_in_vmobject);
+                if (response != PageFaultResponse::Continue)
+                    return response;
+            }
+        }
+        if (!page_slot.is_null() && page_slot->is_lazy_committed_page()) {
             auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
             page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page(page_index_in_vmobject);
             remap_vmobject_page(page_index_in_vmobject);
             return PageFaultResponse::Continue;
         }
+        if (!page_slot.is_null()) {
+            // The page is there, it just hasn't been mapped yet (see map_lazily()).
+            dbgln_if(PAGE_FAULT_DEBUG, "NP(lazy) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+            if (fault.is_write() && is_writable() && should_cow(page_index_in_region)) {
+                if (page_slot->is_shared_zero_page())
+                    return handle_zero_fault(page_index_in_region, mm_lock);
+                return handle_cow_fault(page_index_in_region);
+            }
+            if (!remap_vmobject_page(translate_to_vmobject_page(page_index_in_region)))
+                return PageFaultResponse::OutOfMemory;
+            return PageFaultResponse::Continue;
+        }
 #ifdef MAP_SHARED_ZERO_PAGE_LAZILY
         if (fault.is_read()) {
             page_slot = MM.shared_zero_page();
             remap_vmobject_page(translate_to_vmobject_page(page_index_in_region));
             return PageFaultResponse::Continue;
         }
-        return handle_zero_fault(page_index_in_region);
+        return handle_zero_fault(page_index_in_region, mm_lock);
 #else
         dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
         return PageFaultResponse::ShouldCrash;
@@ -439,7 +682,7 @@ PageFaultResponse Region::handle_fault(const PageFault& fault, ScopedSpinLock<Re
         auto* phys_page = physical_page(page_index_in_region);
         if (phys_page->is_shared_zero_page() || phys_page->is_lazy_committed_page()) {
             dbgln_if(PAGE_FAULT_DEBUG, "NP(zero) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
-            return handle_zero_fault(page_index_in_region);
+            return handle_zero_fault(page_index_in_region, mm_lock);
         }
         return handle_cow_fault(page_index_in_region);
     }
@@ -447,7 +690,7 @@ PageFaultResponse Region::handle_fault(const PageFault& fault, ScopedSpinLock<Re
     return PageFaultResponse::ShouldCrash;
 }
 
-PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
+PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, ScopedSpinLock<RecursiveSpinLock>& mm_lock)
 {
     VERIFY_INTERRUPTS_DISABLED();
     VERIFY(vmobject().is_anonymous());
@@ -468,6 +711,9 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
+    if (try_populate_large_page(page_index_in_region, mm_lock))
+        return PageFaultResponse::Continue;
+
     if (page_slot->is_lazy_committed_page()) {
         page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page(page_index_in_vmobject);
         dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED COMMITTED {}", page_slot->paddr());
@@ -535,7 +781,38 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region, Scoped
     if (current_thread)
         current_thread->did_inode_fault();
 
+    if (inode_vmobject.is_shared_inode()) {
+        // If the inode's data already lives in physical pages, map its page directly.
+        // NOTE: Handing out the page may take the inode lock, so we can't hold on to ours.
+        mm_lock.unlock();
+        RefPtr<PhysicalPage> inode_page;
+        {
+            ScopedLockRelease release_paging_lock(vmobject().m_paging_lock);
+            inode_page = inode_vmobject.inode().physical_page_for_shared_mapping(page_index_in_vmobject);
+        }
+        mm_lock.lock();
+        if (inode_page) {
+            if (vmobject_physical_page_entry.is_null())
+                vmobject_physical_page_entry = move(inode_page);
+            if (!remap_vmobject_page(page_index_in_vmobject))
+                return PageFaultResponse::OutOfMemory;
+            return PageFaultResponse::Continue;
+        }
+    }
+
+    // If this looks like a sequential scan through the file, read a bunch of the
+    // following pages while we're at it, so we don't have to fault for each one.
+    size_t page_count_to_read = inode_vmobject.read_ahead_page_count_for_fault(page_index_in_vmobject);
+    VERIFY(page_count_to_read >= 1);
+
     u8 page_buffer[PAGE_SIZE];
+    OwnPtr<KBuffer> read_ahead_buffer;
+    if (page_count_to_read > 1) {
+        read_ahead_buffer = KBuffer::try_create_with_size(page_count_to_read * PAGE_SIZE, Region::Access::Read | Region::Access::Write, "Inode read-ahead");
+        if (!read_ahead_buffer)
+            page_count_to_read = 1;
+    }
+    u8* data = read_ahead_buffer ? read_ahead_buffer->data() : page_buffer;
     auto& inode = inode_vmobject.inode();
 
     // Reading the page may block, so release the MM lock temporarily
@@ -544,8 +821,8 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region, Scoped
     KResultOr<ssize_t> result(KSuccess);
     {
         ScopedLockRelease release_paging_lock(vmobject().m_paging_lock);
-        auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
-        result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, PAGE_SIZE, buffer, nullptr);
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+        result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, page_count_to_read * PAGE_SIZE, buffer, nullptr);
     }
 
     mm_lock.lock();
@@ -555,36 +832,62 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region, Scoped
         return PageFaultResponse::ShouldCrash;
     }
     auto nread = result.value();
-    if (nread < PAGE_SIZE) {
-        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
-        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
-    }
-
-    vmobject_physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
-    if (vmobject_physical_page_entry.is_null()) {
-        dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
-        return PageFaultResponse::OutOfMemory;
+    if (nread < (ssize_t)(page_count_to_read * PAGE_SIZE)) {
+        // If we read less than we asked for, zero out the rest to avoid leaking uninitialized data.
+        memset(data + nread, 0, page_count_to_read * PAGE_SIZE - nread);
+        // There's no point in keeping pages that are entirely past the end of the file.
+        page_count_to_read = max((size_t)1, ceil_div((size_t)nread, (size_t)PAGE_SIZE));
     }
+    inode_vmobject.did_read_ahead(page_index_in_vmobject, page_count_to_read);
+
+    for (size_t i = 0; i < page_count_to_read; ++i) {
+        auto& physical_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject + i];
+        // We let go of the paging lock while reading, and someone may have paged in
+        // one of the read-ahead pages in the meantime. If so, theirs is just as good.
+        if (!physical_page_entry.is_null())
+            continue;
+
+        physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (physical_page_entry.is_null()) {
+            if (i != 0)
+                break;
+            dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
+            return PageFaultResponse::OutOfMemory;
+        }
 
-    u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
-    {
-        void* fault_at;
-        if (!safe_memcpy(dest_ptr, page_buffer, PAGE_SIZE, fault_at)) {
-            if ((u8*)fault_at >= dest_ptr && (u8*)fault_at <= dest_ptr + PAGE_SIZE)
-                dbgln("      >> inode fault: error copying data to {}/{}, failed at {}",
-                    vmobject_physical_page_entry->paddr(),
-                    VirtualAddress(dest_ptr),
-                    VirtualAddress(fault_at));
-            else
-                VERIFY_NOT_REACHED();
+        u8* dest_ptr = MM.quickmap_page(*physical_page_entry);
+        {
+            void* fault_at;
+            if (!safe_memcpy(dest_ptr, data + i * PAGE_SIZE, PAGE_SIZE, fault_at)) {
+                if ((u8*)fault_at >= dest_ptr && (u8*)fault_at <= dest_ptr + PAGE_SIZE)
+                    dbgln("      >> inode fault: error copying data to {}/{}, failed at {}",
+                        physical_page_entry->paddr(),
+                        VirtualAddress(dest_ptr),
+                        VirtualAddress(fault_at));
+                else
+                    VERIFY_NOT_REACHED();
+            }
         }
+        MM.unquickmap_page();
     }
-    MM.unquickmap_page();
 
-    remap_vmobject_page(page_index_in_vmobject);
+    fault_around(page_index_in_vmobject);
     return PageFaultResponse::Continue;
 }
 
+void Region::fault_around(size_t page_index_in_vmobject)
+{
+    // Map the neighbours of the faulting page as well, if they're already in
+    // memory. This way, touching them later won't cost us another page fault.
+    auto first_page_index_in_vmobject = translate_to_vmobject_page(0);
+    auto window_start = page_index_in_vmobject & ~(FAULT_AROUND_PAGES - 1);
+    auto window_end = window_start + FAULT_AROUND_PAGES;
+    window_start = max(window_start, first_page_index_in_vmobject);
+    window_end = min(window_end, first_page_index_in_vmobject + page_count());
+    VERIFY(page_index_in_vmobject >= window_start && page_index_in_vmobject < window_end);
+    remap_vmobject_page_range(window_start, window_end - window_start);
+}
+
 RefPtr<Process> Region::get_owner()
 {
     return m_owner.strong_ref();
@@ -8,6 +8,7 @@
 
 #include <AK/EnumBits.h>
 #include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
 #include <Kernel/Arch/x86/CPU.h>
@@ -33,7 +34,7 @@ class Region final
     , public PurgeablePageRanges {
     friend class MemoryManager;
 
-    MAKE_SLAB_ALLOCATED(Region)
+    MAKE_SLAB_CACHED(Region)
 public:
     enum Access : u8 {
         None = 0,
@@ -203,6 +204,8 @@ public:
 
     void set_page_directory(PageDirectory&);
     bool map(PageDirectory&, ShouldFlushTLB = ShouldFlushTLB::Yes);
+    // Like map(), but doesn't populate any page table entries. The pages get mapped one at a time as they're faulted in.
+    void map_lazily(PageDirectory&);
     enum class ShouldDeallocateVirtualMemoryRange {
         No,
         Yes,
@@ -212,6 +215,20 @@ public:
     void remap();
 
     bool remap_vmobject_page_range(size_t page_index, size_t page_count);
+    bool remap_vmobject_page(size_t index, bool with_flush = true);
+
+    // These are used by the PageReclaimTask, with the MM lock held.
+    // Makes the pages that haven't been accessed since the last time a little older.
+    void age_pages(size_t first_page_index, size_t page_count);
+    // Compresses the pages in the range that are at least min_age old, and returns how many it compressed.
+    size_t compress_cold_pages(size_t first_page_index, size_t page_count, u8 min_age);
+
+    // These are used by the PageMergingTask, with the MM lock held.
+    // Hashes the contents of the page, if it may be merged with another one. Pages full of zeroes
+    // are merged into the shared zero page right away, and don't get a hash.
+    Optional<u32> hash_page_for_merging(size_t page_index);
+    // Makes the page share the other region's physical page (copy-on-write), if their contents are the same.
+    bool try_merge_page(size_t page_index, Region& other, size_t other_page_index);
 
     bool is_volatile(VirtualAddress vaddr, size_t size) const;
     enum class SetVolatileError {
@@ -226,11 +243,20 @@ public:
     bool is_syscall_region() const { return m_syscall_region; }
     void set_syscall_region(bool b) { m_syscall_region = b; }
 
+    bool are_large_pages_enabled() const { return m_large_pages; }
+    void set_large_pages_enabled(bool b) { m_large_pages = b; }
+
+    bool is_mergeable() const { return m_mergeable; }
+    void set_mergeable(bool b) { m_mergeable = b; }
+
 private:
     Region(const Range&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, OwnPtr<KString>, Region::Access access, Cacheable, bool shared);
 
     bool do_remap_vmobject_page_range(size_t page_index, size_t page_count);
 
+    // Whether the page is mapped with a page table entry of its own (and not as part of a large page).
+    bool has_own_page_table_entry(size_t page_index);
+
     void set_access_bit(Access access, bool b)
     {
         if (b)
@@ -240,13 +266,16 @@ private:
     }
 
     bool do_remap_vmobject_page(size_t index, bool with_flush = true);
-    bool remap_vmobject_page(size_t index, bool with_flush = true);
 
     PageFaultResponse handle_cow_fault(size_t page_index);
     PageFaultResponse handle_inode_fault(size_t page_index, ScopedSpinLock<RecursiveSpinLock>&);
-    PageFaultResponse handle_zero_fault(size_t page_index);
+    PageFaultResponse handle_zero_fault(size_t page_index, ScopedSpinLock<RecursiveSpinLock>&);
 
     bool map_individual_page_impl(size_t page_index);
+    void fault_around(size_t page_index_in_vmobject);
+    bool can_map_large_page(size_t page_index) const;
+    bool map_large_page_impl(size_t page_index);
+    bool try_populate_large_page(size_t page_index, ScopedSpinLock<RecursiveSpinLock>&);
 
     void register_purgeable_page_ranges();
     void unregister_purgeable_page_ranges();
@@ -262,6 +291,8 @@ private:
     bool m_stack : 1 { false };
     bool m_mmap : 1 { false };
     bool m_syscall_region : 1 { false };
+    bool m_large_pages : 1 { false };
+    bool m_mergeable : 1 { false };
     WeakPtr<Process> m_owner;
     IntrusiveListNode<Region> m_list_node;
 
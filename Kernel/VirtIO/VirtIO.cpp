@@ -30,6 +30,11 @@ UNMAP_AFTER_INIT void VirtIO::detect()
             [[maybe_unused]] auto& unused = adopt_ref(*new VirtIORNG(address)).leak_ref();
             break;
         }
+        case (u16)PCIDeviceID::VirtIOBlock:
+        case (u16)PCIDeviceID::VirtIONetwork:
+        case (u16)PCIDeviceID::VirtIOGPU:
+            // NOTE: These are picked up by StorageManagement, NetworkingManagement and GraphicsManagement.
+            break;
         default:
             dbgln_if(VIRTIO_DEBUG, "VirtIO: Unknown VirtIO device with ID: {}", id.device_id);
             break;
@@ -204,10 +209,7 @@ bool VirtIODevice::accept_device_features(u64 device_features, u64 accepted_feat
         accepted_features &= ~(VIRTIO_F_RING_PACKED);
     }
 
-    // TODO: implement indirect descriptors to allow queue_size buffers instead of buffers totalling (PAGE_SIZE * queue_size) bytes
-    if (is_feature_set(device_features, VIRTIO_F_INDIRECT_DESC)) {
-        // accepted_features |= VIRTIO_F_INDIRECT_DESC;
-    }
+    // NOTE: VIRTIO_F_INDIRECT_DESC is left to the drivers that build indirect descriptor tables.
 
     if (is_feature_set(device_features, VIRTIO_F_IN_ORDER)) {
         accepted_features |= VIRTIO_F_IN_ORDER;
@@ -271,6 +273,15 @@ bool VirtIODevice::setup_queue(u16 queue_index)
     if (queue->is_null())
         return false;
 
+    if (m_message_signaled_interrupts) {
+        u16 vector = 1 + queue_index % (m_message_signaled_interrupts->count() - 1);
+        config_write16(*m_common_cfg, COMMON_CFG_QUEUE_MSIX_VECTOR, vector);
+        if (config_read16(*m_common_cfg, COMMON_CFG_QUEUE_MSIX_VECTOR) != vector) {
+            dbgln("{}: Queue[{}] refused MSI-X vector {}", m_class_name, queue_index, vector);
+            return false;
+        }
+    }
+
     config_write64(*m_common_cfg, COMMON_CFG_QUEUE_DESC, queue->descriptor_area().get());
     config_write64(*m_common_cfg, COMMON_CFG_QUEUE_DRIVER, queue->driver_area().get());
     config_write64(*m_common_cfg, COMMON_CFG_QUEUE_DEVICE, queue->device_area().get());
@@ -293,6 +304,36 @@ bool VirtIODevice::activate_queue(u16 queue_index)
     return true;
 }
 
+bool VirtIODevice::setup_message_signaled_interrupts()
+{
+    if (!m_common_cfg || m_queue_count == 0)
+        return false;
+    // NOTE: VirtIO devices only do MSI-X, and we need at least one interrupt for the queues besides the configuration one.
+    auto interrupts = PCI::MessageSignaledInterrupts::try_create(pci_address(), m_queue_count + 1, m_class_name.characters());
+    if (!interrupts || !interrupts->is_msix() || interrupts->count() < 2)
+        return false;
+
+    for (size_t i = 0; i < interrupts->count(); i++) {
+        if (i > 0)
+            interrupts->route_to_processor(i, (i - 1) % Processor::count());
+        interrupts->set_handler(i, [this, i](auto&) {
+            handle_message_signaled_interrupt(i);
+        });
+    }
+    interrupts->enable();
+
+    config_write16(*m_common_cfg, COMMON_CFG_MSIX_CONFIG, 0);
+    if (config_read16(*m_common_cfg, COMMON_CFG_MSIX_CONFIG) != 0) {
+        dbgln("{}: Device refused MSI-X, sticking to the interrupt pin", m_class_name);
+        interrupts->disable();
+        PCI::enable_interrupt_line(pci_address());
+        return false;
+    }
+    disable_irq();
+    m_message_signaled_interrupts = move(interrupts);
+    return true;
+}
+
 bool VirtIODevice::setup_queues(u16 requested_queue_count)
 {
     VERIFY(!m_did_setup_queues);
@@ -314,6 +355,7 @@ bool VirtIODevice::setup_queues(u16 requested_queue_count)
     }
 
     dbgln_if(VIRTIO_DEBUG, "{}: Setting up {} queues", m_class_name, m_queue_count);
+    setup_message_signaled_interrupts();
     for (u16 i = 0; i < m_queue_count; i++) {
         if (!setup_queue(i))
             return false;
@@ -342,23 +384,43 @@ u8 VirtIODevice::isr_status()
     return config_read8(*m_isr_cfg, 0);
 }
 
+void VirtIODevice::handle_device_config_interrupt()
+{
+    dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Device config interrupt!", m_class_name);
+    if (!handle_device_config_change()) {
+        set_status_bit(DEVICE_STATUS_FAILED);
+        dbgln("{}: Failed to handle device config change!", m_class_name);
+    }
+}
+
+void VirtIODevice::handle_message_signaled_interrupt(size_t index)
+{
+    if (index == 0)
+        return handle_device_config_interrupt();
+    size_t queue_interrupt_count = m_message_signaled_interrupts->count() - 1;
+    for (size_t i = index - 1; i < m_queues.size(); i += queue_interrupt_count) {
+        if (get_queue(i).new_data_available())
+            handle_queue_update(i);
+    }
+}
+
 void VirtIODevice::handle_irq(const RegisterState&)
 {
     u8 isr_type = isr_status();
-    if (isr_type & DEVICE_CONFIG_INTERRUPT) {
-        dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Device config interrupt!", m_class_name);
-        if (!handle_device_config_change()) {
-            set_status_bit(DEVICE_STATUS_FAILED);
-            dbgln("{}: Failed to handle device config change!", m_class_name);
-        }
-    }
+    if (isr_type & DEVICE_CONFIG_INTERRUPT)
+        handle_device_config_interrupt();
     if (isr_type & QUEUE_INTERRUPT) {
         dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Queue interrupt!", m_class_name);
+        // NOTE: All queues share this interrupt, so every one of them may have something for us.
+        bool any_queue_updated = false;
         for (size_t i = 0; i < m_queues.size(); i++) {
-            if (get_queue(i).new_data_available())
-                return handle_queue_update(i);
+            if (!get_queue(i).new_data_available())
+                continue;
+            any_queue_updated = true;
+            handle_queue_update(i);
         }
-        dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
+        if (!any_queue_updated)
+            dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
     }
     if (isr_type & ~(QUEUE_INTERRUPT | DEVICE_CONFIG_INTERRUPT))
         dbgln("{}: Handling interrupt with unknown type: {}", m_class_name, isr_type);
@@ -370,6 +432,13 @@ void VirtIODevice::supply_chain_and_notify(u16 queue_index, VirtIOQueueChain& ch
     VERIFY(&chain.queue() == &queue);
     VERIFY(queue.lock().is_locked());
     chain.submit_to_queue();
+    notify_queue_if_needed(queue_index);
+}
+
+void VirtIODevice::notify_queue_if_needed(u16 queue_index)
+{
+    auto& queue = get_queue(queue_index);
+    VERIFY(queue.lock().is_locked());
     if (queue.should_notify())
         notify_queue(queue_index);
 }
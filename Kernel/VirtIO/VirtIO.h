@@ -11,6 +11,7 @@
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/PCI/Access.h>
 #include <Kernel/PCI/Device.h>
+#include <Kernel/PCI/MSI.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VirtIO/VirtIOQueue.h>
 
@@ -61,6 +62,9 @@ namespace Kernel {
 #define COMMON_CFG_QUEUE_DRIVER 0x28
 #define COMMON_CFG_QUEUE_DEVICE 0x30
 
+// Written to a vector register to say that there's no message signaled interrupt for it, and read back if the device refused the one we asked for.
+#define VIRTIO_MSI_NO_VECTOR 0xffff
+
 #define QUEUE_INTERRUPT 0x1
 #define DEVICE_CONFIG_INTERRUPT 0x2
 
@@ -160,9 +164,14 @@ protected:
     void mask_status_bits(u8 status_mask);
     void set_status_bit(u8);
     u64 get_device_features();
+    // NOTE: If the device can do MSI-X, every queue gets an interrupt of its own (if there are enough to go around),
+    //       and queue N interrupts processor N, so a driver that gives each processor its queue also gets its
+    //       completions there. Otherwise all queues share the interrupt pin.
     bool setup_queues(u16 requested_queue_count = 0);
     void finish_init();
 
+    u16 queue_count() const { return m_queue_count; }
+
     VirtIOQueue& get_queue(u16 queue_index)
     {
         VERIFY(queue_index < m_queue_count);
@@ -196,6 +205,8 @@ protected:
     }
 
     void supply_chain_and_notify(u16 queue_index, VirtIOQueueChain& chain);
+    // Lets a driver that supplies a whole batch of chains with submit_to_queue() tell the device about them all at once.
+    void notify_queue_if_needed(u16 queue_index);
 
     virtual bool handle_device_config_change() = 0;
     virtual void handle_queue_update(u16 queue_index) = 0;
@@ -215,6 +226,8 @@ private:
 
     bool accept_device_features(u64 device_features, u64 accepted_features);
 
+    bool setup_message_signaled_interrupts();
+    void handle_message_signaled_interrupt(size_t index);
     bool setup_queue(u16 queue_index);
     bool activate_queue(u16 queue_index);
     void notify_queue(u16 queue_index);
@@ -222,6 +235,7 @@ private:
     void reset_device();
 
     u8 isr_status();
+    void handle_device_config_interrupt();
     virtual void handle_irq(const RegisterState&) override;
 
     NonnullOwnPtrVector<VirtIOQueue> m_queues;
@@ -230,6 +244,9 @@ private:
     const Configuration* m_notify_cfg { nullptr }; // Cached due to high usage
     const Configuration* m_isr_cfg { nullptr };    // Cached due to high usage
 
+    // Interrupt 0 is for configuration changes, and queue N reports to interrupt 1 + N % (count() - 1).
+    OwnPtr<PCI::MessageSignaledInterrupts> m_message_signaled_interrupts;
+
     IOAddress m_io_base;
     MappedMMIO m_mmio[6];
     u16 m_queue_count { 0 };
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/PCI/IDs.h>
+#include <Kernel/VirtIO/VirtIOBlockController.h>
+#include <Kernel/VirtIO/VirtIOBlockDevice.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+#define VIRTIO_BLK_F_SEG_MAX (1 << 2)
+#define VIRTIO_BLK_F_RO (1 << 5)
+#define VIRTIO_BLK_F_BLK_SIZE (1 << 6)
+#define VIRTIO_BLK_F_MQ (1 << 12)
+
+// virtio_blk_config
+#define VIRTIO_BLK_CONFIG_CAPACITY 0x0
+#define VIRTIO_BLK_CONFIG_SEG_MAX 0xc
+#define VIRTIO_BLK_CONFIG_BLK_SIZE 0x14
+#define VIRTIO_BLK_CONFIG_NUM_QUEUES 0x22
+
+#define VIRTIO_BLK_T_IN 0
+#define VIRTIO_BLK_T_OUT 1
+
+#define VIRTIO_BLK_S_OK 0
+
+// NOTE: The device always counts in these, whatever its block size is.
+static constexpr size_t virtio_sector_size = 512;
+
+// More queues than this don't buy us anything, each processor only ever submits to one of them.
+static constexpr size_t max_request_queues = 8;
+static constexpr size_t max_requests_per_queue = 32;
+static constexpr size_t max_data_pages_per_request = 16;
+
+// Every slot has its request header, then its status byte, then its indirect descriptor table in here.
+static constexpr size_t slot_header_stride = 512;
+static constexpr size_t slot_status_offset = 16;
+static constexpr size_t slot_indirect_table_offset = 32;
+static_assert(slot_indirect_table_offset + (max_data_pages_per_request + 2) * sizeof(VirtIOQueue::VirtIOQueueDescriptor) <= slot_header_stride);
+
+struct [[gnu::packed]] VirtIOBlockRequestHeader {
+    u32 type;
+    u32 reserved;
+    u64 sector;
+};
+
+static size_t s_controller_count;
+
+UNMAP_AFTER_INIT RefPtr<VirtIOBlockController> VirtIOBlockController::try_to_initialize(PCI::Address address)
+{
+    auto id = PCI::get_id(address);
+    if (id.vendor_id != (u16)PCIVendorID::VirtIO || id.device_id != (u16)PCIDeviceID::VirtIOBlock)
+        return {};
+    auto controller = adopt_ref(*new VirtIOBlockController(address, s_controller_count));
+    if (!controller->initialize())
+        return {};
+    s_controller_count++;
+    return controller;
+}
+
+UNMAP_AFTER_INIT VirtIOBlockController::VirtIOBlockController(PCI::Address address, size_t controller_index)
+    : VirtIODevice(address, "VirtIOBlock")
+    , m_controller_index(controller_index)
+{
+}
+
+VirtIOBlockController::~VirtIOBlockController()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIOBlockController::initialize()
+{
+    auto* config = get_config(ConfigurationType::Device);
+    if (!config) {
+        dbgln("{}: Device has no configuration", m_class_name);
+        return false;
+    }
+
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        for (u64 feature : { (u64)VIRTIO_BLK_F_SEG_MAX, (u64)VIRTIO_BLK_F_RO, (u64)VIRTIO_BLK_F_BLK_SIZE, (u64)VIRTIO_BLK_F_MQ, VIRTIO_F_INDIRECT_DESC }) {
+            if (is_feature_set(supported_features, feature))
+                negotiated |= feature;
+        }
+        return negotiated;
+    });
+    if (!success)
+        return false;
+
+    u64 capacity = 0;
+    u32 block_size = virtio_sector_size;
+    u32 segment_count_limit = 0;
+    u16 queue_count = 1;
+    read_config_atomic([&]() {
+        capacity = config_read32(*config, VIRTIO_BLK_CONFIG_CAPACITY) | (u64)config_read32(*config, VIRTIO_BLK_CONFIG_CAPACITY + 4) << 32;
+        if (is_feature_accepted(VIRTIO_BLK_F_BLK_SIZE))
+            block_size = config_read32(*config, VIRTIO_BLK_CONFIG_BLK_SIZE);
+        if (is_feature_accepted(VIRTIO_BLK_F_SEG_MAX))
+            segment_count_limit = config_read32(*config, VIRTIO_BLK_CONFIG_SEG_MAX);
+        if (is_feature_accepted(VIRTIO_BLK_F_MQ))
+            queue_count = config_read16(*config, VIRTIO_BLK_CONFIG_NUM_QUEUES);
+    });
+    if (block_size < virtio_sector_size || block_size > PAGE_SIZE || block_size % virtio_sector_size != 0) {
+        dbgln("{}: Unsupported block size {}", m_class_name, block_size);
+        return false;
+    }
+
+    queue_count = max<size_t>(min<size_t>(queue_count, min<size_t>(Processor::count(), max_request_queues)), 1);
+    if (!setup_queues(queue_count))
+        return false;
+
+    m_use_indirect_descriptors = is_feature_accepted(VIRTIO_F_INDIRECT_DESC);
+    m_is_read_only = is_feature_accepted(VIRTIO_BLK_F_RO);
+    // NOTE: Every page of data is a segment of its own, since the pages of a data buffer aren't contiguous.
+    m_max_data_pages_per_request = max_data_pages_per_request;
+    if (segment_count_limit > 0)
+        m_max_data_pages_per_request = min<size_t>(m_max_data_pages_per_request, segment_count_limit);
+
+    for (u16 queue_index = 0; queue_index < queue_count; queue_index++) {
+        auto request_queue = make<RequestQueue>();
+        request_queue->queue_index = queue_index;
+        if (!allocate_request_slots(*request_queue))
+            return false;
+        m_request_queues.append(move(request_queue));
+    }
+    finish_init();
+
+    dmesgln("{}: {} blocks of {} bytes, {} queue(s), {} requests in flight{}{}", m_class_name, capacity * virtio_sector_size / block_size, block_size,
+        m_request_queues.size(), max_requests_in_flight(), m_use_indirect_descriptors ? ", indirect descriptors" : "", m_is_read_only ? ", read-only" : "");
+    m_device = VirtIOBlockDevice::create(*this, block_size, capacity * virtio_sector_size / block_size);
+    return true;
+}
+
+UNMAP_AFTER_INIT bool VirtIOBlockController::allocate_request_slots(RequestQueue& request_queue)
+{
+    auto& queue = get_queue(request_queue.queue_index);
+    // Without indirect descriptors, a request takes up a descriptor for its header, one per page of data, and one for its status.
+    size_t slot_count = queue.size();
+    if (!m_use_indirect_descriptors) {
+        if (queue.size() < 3)
+            return false;
+        m_max_data_pages_per_request = min<size_t>(m_max_data_pages_per_request, queue.size() - 2);
+        slot_count = queue.size() / (m_max_data_pages_per_request + 2);
+    }
+    slot_count = min(slot_count, max_requests_per_queue);
+
+    request_queue.slot_headers_region = MM.allocate_contiguous_kernel_region(page_round_up(slot_count * slot_header_stride), "VirtIOBlock Request Headers", Region::Access::Read | Region::Access::Write);
+    if (!request_queue.slot_headers_region)
+        return false;
+    if (!request_queue.slot_for_descriptor.try_resize(queue.size()) || !request_queue.slots.try_resize(slot_count))
+        return false;
+    for (auto& slot : request_queue.slots) {
+        slot.data_region = MM.allocate_kernel_region(m_max_data_pages_per_request * PAGE_SIZE, "VirtIOBlock DMA Buffer", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+        if (!slot.data_region)
+            return false;
+    }
+    return true;
+}
+
+size_t VirtIOBlockController::max_requests_in_flight() const
+{
+    size_t count = 0;
+    for (auto& request_queue : m_request_queues)
+        count += request_queue.slots.size();
+    return count;
+}
+
+RefPtr<StorageDevice> VirtIOBlockController::device(u32 index) const
+{
+    if (index != 0)
+        return {};
+    return m_device;
+}
+
+u8* VirtIOBlockController::slot_header(const RequestQueue& request_queue, size_t slot_index) const
+{
+    return request_queue.slot_headers_region->vaddr().as_ptr() + slot_index * slot_header_stride;
+}
+
+PhysicalAddress VirtIOBlockController::slot_header_address(const RequestQueue& request_queue, size_t slot_index) const
+{
+    return request_queue.slot_headers_region->physical_page(0)->paddr().offset(slot_index * slot_header_stride);
+}
+
+void VirtIOBlockController::start_request(const StorageDevice&, AsyncBlockDeviceRequest& request)
+{
+    if (m_is_read_only && request.request_type() == AsyncBlockDeviceRequest::Write) {
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+    // Prefer the queue that belongs to this processor, so processors don't contend on each other's queue locks.
+    size_t preferred_queue = Processor::id() % m_request_queues.size();
+    for (size_t i = 0; i < m_request_queues.size(); i++) {
+        if (submit_request(m_request_queues[(preferred_queue + i) % m_request_queues.size()], request))
+            return;
+    }
+    dbgln("{}: No free request slots", m_class_name);
+    request.complete(AsyncDeviceRequest::Failure);
+}
+
+bool VirtIOBlockController::submit_request(RequestQueue& request_queue, AsyncBlockDeviceRequest& request)
+{
+    auto& queue = get_queue(request_queue.queue_index);
+    size_t block_size = m_device->block_size();
+    size_t transfer_size = request.block_count() * block_size;
+    VERIFY(transfer_size > 0 && transfer_size <= max_transfer_size());
+
+    Optional<size_t> slot_index;
+    {
+        ScopedSpinLock lock(queue.lock());
+        for (size_t index = 0; index < request_queue.slots.size(); index++) {
+            if (!request_queue.slots[index].is_reserved) {
+                request_queue.slots[index].is_reserved = true;
+                slot_index = index;
+                break;
+            }
+        }
+    }
+    if (!slot_index.has_value())
+        return false;
+
+    auto& slot = request_queue.slots[slot_index.value()];
+    bool is_write = request.request_type() == AsyncBlockDeviceRequest::Write;
+    if (is_write && !request.read_from_buffer(request.buffer(), slot.data_region->vaddr().as_ptr(), transfer_size)) {
+        {
+            ScopedSpinLock lock(queue.lock());
+            slot.is_reserved = false;
+        }
+        request.complete(AsyncDeviceRequest::MemoryFault);
+        return true;
+    }
+
+    auto* header_bytes = slot_header(request_queue, slot_index.value());
+    auto& header = *(VirtIOBlockRequestHeader*)header_bytes;
+    header.type = is_write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+    header.reserved = 0;
+    header.sector = request.block_index() * (block_size / virtio_sector_size);
+    header_bytes[slot_status_offset] = 0xff;
+
+    auto header_address = slot_header_address(request_queue, slot_index.value());
+    auto data_buffer_type = is_write ? BufferType::DeviceReadable : BufferType::DeviceWritable;
+    size_t page_count = page_round_up(transfer_size) / PAGE_SIZE;
+
+    dbgln_if(VIRTIO_DEBUG, "{}: {} {} blocks at {} in slot {} of queue {}", m_class_name, is_write ? "Write" : "Read", request.block_count(), request.block_index(), slot_index.value(), request_queue.queue_index);
+
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    bool added;
+    if (m_use_indirect_descriptors) {
+        auto* table = (VirtIOQueue::VirtIOQueueDescriptor*)(header_bytes + slot_indirect_table_offset);
+        size_t descriptor_count = 0;
+        auto add_descriptor = [&](PhysicalAddress address, size_t length, BufferType buffer_type) {
+            table[descriptor_count] = { address.get(), (u32)length, (u16)((u16)buffer_type | VIRTQ_DESC_F_NEXT), (u16)(descriptor_count + 1) };
+            descriptor_count++;
+        };
+        add_descriptor(header_address, sizeof(VirtIOBlockRequestHeader), BufferType::DeviceReadable);
+        for (size_t page_index = 0; page_index < page_count; page_index++)
+            add_descriptor(slot.data_region->physical_page(page_index)->paddr(), min<size_t>(PAGE_SIZE, transfer_size - page_index * PAGE_SIZE), data_buffer_type);
+        add_descriptor(header_address.offset(slot_status_offset), 1, BufferType::DeviceWritable);
+        table[descriptor_count - 1].flags &= ~VIRTQ_DESC_F_NEXT;
+        added = chain.add_indirect_table_to_chain(header_address.offset(slot_indirect_table_offset), descriptor_count);
+    } else {
+        added = chain.add_buffer_to_chain(header_address, sizeof(VirtIOBlockRequestHeader), BufferType::DeviceReadable);
+        for (size_t page_index = 0; added && page_index < page_count; page_index++)
+            added = chain.add_buffer_to_chain(slot.data_region->physical_page(page_index)->paddr(), min<size_t>(PAGE_SIZE, transfer_size - page_index * PAGE_SIZE), data_buffer_type);
+        if (added)
+            added = chain.add_buffer_to_chain(header_address.offset(slot_status_offset), 1, BufferType::DeviceWritable);
+    }
+    // NOTE: There are never more requests in flight than the queue has room for, so this can't run out of descriptors.
+    VERIFY(added);
+
+    request_queue.slot_for_descriptor[chain.start_index().value()] = slot_index.value();
+    slot.request = request;
+    slot.transfer_size = transfer_size;
+    slot.is_completed = false;
+    supply_chain_and_notify(request_queue.queue_index, chain);
+    return true;
+}
+
+bool VirtIOBlockController::handle_device_config_change()
+{
+    // FIXME: Pick up the new capacity when the disk gets resized.
+    return true;
+}
+
+void VirtIOBlockController::handle_queue_update(u16 queue_index)
+{
+    auto& request_queue = m_request_queues[queue_index];
+    auto& queue = get_queue(queue_index);
+    ScopedSpinLock lock(queue.lock());
+    bool any_completed = false;
+    size_t used;
+    for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+        auto slot_index = request_queue.slot_for_descriptor[chain.start_index().value()];
+        chain.release_buffer_slots_to_queue();
+        auto& slot = request_queue.slots[slot_index];
+        if (!slot.request) {
+            dbgln("{}: Completion for unknown request in slot {} of queue {}", m_class_name, slot_index, queue_index);
+            continue;
+        }
+        slot.is_completed = true;
+        any_completed = true;
+    }
+
+    // Now schedule copying the data out as soon as we leave the irq handler.
+    // This is important so that we can safely access the buffers, which could
+    // trigger page faults.
+    if (any_completed && !request_queue.finish_queued) {
+        request_queue.finish_queued = true;
+        g_io_work->queue([this, &request_queue]() {
+            finish_completed_requests(request_queue);
+        });
+    }
+}
+
+void VirtIOBlockController::finish_completed_requests(RequestQueue& request_queue)
+{
+    auto& queue = get_queue(request_queue.queue_index);
+    Vector<size_t, max_requests_per_queue> completed_slots;
+    {
+        ScopedSpinLock lock(queue.lock());
+        request_queue.finish_queued = false;
+        for (size_t index = 0; index < request_queue.slots.size(); index++) {
+            if (!request_queue.slots[index].is_completed)
+                continue;
+            // NOTE: The slot stays reserved until we're done with its buffer.
+            request_queue.slots[index].is_completed = false;
+            completed_slots.append(index);
+        }
+    }
+
+    for (auto index : completed_slots) {
+        auto& slot = request_queue.slots[index];
+        auto request = slot.request.release_nonnull();
+        auto result = AsyncDeviceRequest::Success;
+        u8 status = slot_header(request_queue, index)[slot_status_offset];
+        if (status != VIRTIO_BLK_S_OK) {
+            dbgln("{}: Request in slot {} of queue {} failed with status {}", m_class_name, index, request_queue.queue_index, status);
+            result = AsyncDeviceRequest::Failure;
+        } else if (request->request_type() == AsyncBlockDeviceRequest::Read) {
+            if (!request->write_to_buffer(request->buffer(), slot.data_region->vaddr().as_ptr(), slot.transfer_size))
+                result = AsyncDeviceRequest::MemoryFault;
+        }
+        {
+            ScopedSpinLock lock(queue.lock());
+            slot.is_reserved = false;
+        }
+        request->complete(result);
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/Storage/StorageController.h>
+#include <Kernel/Storage/StorageDevice.h>
+#include <Kernel/VirtIO/VirtIO.h>
+
+namespace Kernel {
+
+class AsyncBlockDeviceRequest;
+class VirtIOBlockDevice;
+
+// A virtio-blk device, which has exactly one disk behind it.
+//
+// Every processor gets a request queue of its own if the device can do multiple queues (and if there's
+// MSI-X, its completions come back to that processor too). If the device can do indirect descriptors,
+// a request takes up a single slot in its queue no matter how many pages of data it has.
+class VirtIOBlockController final : public StorageController
+    , public VirtIODevice {
+    friend class VirtIOBlockDevice;
+
+public:
+    static RefPtr<VirtIOBlockController> try_to_initialize(PCI::Address);
+    virtual ~VirtIOBlockController() override;
+
+    // ^StorageController
+    virtual RefPtr<StorageDevice> device(u32 index) const override;
+    virtual size_t devices_count() const override { return m_device ? 1 : 0; }
+    virtual void start_request(const StorageDevice&, AsyncBlockDeviceRequest&) override;
+
+    size_t controller_index() const { return m_controller_index; }
+    size_t max_transfer_size() const { return m_max_data_pages_per_request * PAGE_SIZE; }
+    size_t max_requests_in_flight() const;
+
+    // ^IRQHandler
+    virtual const char* purpose() const override { return m_class_name.characters(); }
+
+private:
+    VirtIOBlockController(PCI::Address, size_t controller_index);
+    bool initialize();
+
+    // ^StorageController
+    virtual bool reset() override { return false; }
+    virtual bool shutdown() override { return false; }
+    virtual void complete_current_request(AsyncDeviceRequest::RequestResult) override { VERIFY_NOT_REACHED(); }
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    struct RequestSlot {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        bool is_reserved { false };
+        bool is_completed { false };
+        size_t transfer_size { 0 };
+        // NOTE: The data goes through here, since the request's buffer may be in userspace.
+        OwnPtr<Region> data_region;
+    };
+
+    struct RequestQueue {
+        u16 queue_index { 0 };
+        Vector<RequestSlot> slots;
+        // The header, status byte and indirect descriptor table of every slot.
+        OwnPtr<Region> slot_headers_region;
+        // Which slot the chain starting at each descriptor belongs to.
+        Vector<u16> slot_for_descriptor;
+        bool finish_queued { false };
+    };
+
+    bool allocate_request_slots(RequestQueue&);
+    bool submit_request(RequestQueue&, AsyncBlockDeviceRequest&);
+    void finish_completed_requests(RequestQueue&);
+
+    u8* slot_header(const RequestQueue&, size_t slot_index) const;
+    PhysicalAddress slot_header_address(const RequestQueue&, size_t slot_index) const;
+
+    RefPtr<VirtIOBlockDevice> m_device;
+    NonnullOwnPtrVector<RequestQueue> m_request_queues;
+    size_t m_controller_index { 0 };
+    size_t m_max_data_pages_per_request { 0 };
+    bool m_use_indirect_descriptors { false };
+    bool m_is_read_only { false };
+};
+
+}
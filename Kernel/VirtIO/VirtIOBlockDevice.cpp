@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/VirtIO/VirtIOBlockController.h>
+#include <Kernel/VirtIO/VirtIOBlockDevice.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullRefPtr<VirtIOBlockDevice> VirtIOBlockDevice::create(const VirtIOBlockController& controller, size_t block_size, u64 max_addressable_block)
+{
+    return adopt_ref(*new VirtIOBlockDevice(controller, block_size, max_addressable_block));
+}
+
+UNMAP_AFTER_INIT VirtIOBlockDevice::VirtIOBlockDevice(const VirtIOBlockController& controller, size_t block_size, u64 max_addressable_block)
+    : StorageDevice(controller, block_size, max_addressable_block)
+    , m_controller(controller)
+{
+}
+
+VirtIOBlockDevice::~VirtIOBlockDevice()
+{
+}
+
+const char* VirtIOBlockDevice::class_name() const
+{
+    return "VirtIOBlockDevice";
+}
+
+size_t VirtIOBlockDevice::max_blocks_per_request() const
+{
+    return m_controller->max_transfer_size() / block_size();
+}
+
+size_t VirtIOBlockDevice::max_started_requests() const
+{
+    return m_controller->max_requests_in_flight();
+}
+
+void VirtIOBlockDevice::start_request(AsyncBlockDeviceRequest& request)
+{
+    m_controller->start_request(*this, request);
+}
+
+String VirtIOBlockDevice::device_name() const
+{
+    // FIXME: This runs out of letters after 26 disks.
+    return String::formatted("vd{:c}", 'a' + (char)m_controller->controller_index());
+}
+
+}
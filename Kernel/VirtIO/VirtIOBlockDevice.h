@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/Storage/StorageDevice.h>
+
+namespace Kernel {
+
+class VirtIOBlockController;
+class VirtIOBlockDevice final : public StorageDevice {
+    friend class VirtIOBlockController;
+
+public:
+    static NonnullRefPtr<VirtIOBlockDevice> create(const VirtIOBlockController&, size_t block_size, u64 max_addressable_block);
+    virtual ~VirtIOBlockDevice() override;
+
+    // ^StorageDevice
+    virtual size_t max_blocks_per_request() const override;
+
+    // ^Device
+    virtual size_t max_started_requests() const override;
+
+    // ^BlockDevice
+    virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual String device_name() const override;
+
+private:
+    VirtIOBlockDevice(const VirtIOBlockController&, size_t block_size, u64 max_addressable_block);
+
+    // ^DiskDevice
+    virtual const char* class_name() const override;
+
+    NonnullRefPtr<VirtIOBlockController> m_controller;
+};
+
+}
@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MACAddress.h>
+#include <Kernel/Debug.h>
+#include <Kernel/PCI/IDs.h>
+#include <Kernel/Process.h>
+#include <Kernel/VirtIO/VirtIONetworkAdapter.h>
+
+namespace Kernel {
+
+#define VIRTIO_NET_F_CSUM ((u64)1 << 0)
+#define VIRTIO_NET_F_MAC ((u64)1 << 5)
+#define VIRTIO_NET_F_HOST_TSO4 ((u64)1 << 11)
+#define VIRTIO_NET_F_MRG_RXBUF ((u64)1 << 15)
+#define VIRTIO_NET_F_STATUS ((u64)1 << 16)
+
+// virtio_net_config
+#define VIRTIO_NET_CONFIG_MAC 0x0
+#define VIRTIO_NET_CONFIG_STATUS 0x6
+
+#define VIRTIO_NET_S_LINK_UP 1
+
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+#define VIRTIO_NET_HDR_GSO_NONE 0
+#define VIRTIO_NET_HDR_GSO_TCPV4 1
+
+// The TCP checksum is at offset 16 in its header.
+static constexpr size_t tcp_checksum_offset = 16;
+
+UNMAP_AFTER_INIT RefPtr<VirtIONetworkAdapter> VirtIONetworkAdapter::try_to_initialize(PCI::Address address)
+{
+    auto id = PCI::get_id(address);
+    if (id.vendor_id != (u16)PCIVendorID::VirtIO || id.device_id != (u16)PCIDeviceID::VirtIONetwork)
+        return {};
+    auto adapter = adopt_ref_if_nonnull(new VirtIONetworkAdapter(address));
+    if (!adapter)
+        return {};
+    if (adapter->initialize())
+        return adapter;
+    return {};
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::VirtIONetworkAdapter(PCI::Address address)
+    : VirtIODevice(address, "VirtIONetworkAdapter")
+{
+    set_interface_name(pci_address());
+}
+
+VirtIONetworkAdapter::~VirtIONetworkAdapter()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIONetworkAdapter::initialize()
+{
+    auto* config = get_config(ConfigurationType::Device);
+    if (!config) {
+        dbgln("{}: Device has no configuration", m_class_name);
+        return false;
+    }
+
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        for (u64 feature : { VIRTIO_NET_F_CSUM, VIRTIO_NET_F_MAC, VIRTIO_NET_F_MRG_RXBUF, VIRTIO_NET_F_STATUS }) {
+            if (is_feature_set(supported_features, feature))
+                negotiated |= feature;
+        }
+        // NOTE: The device can only segment packets if it also fills in their checksums.
+        // FIXME: Ask for VIRTIO_NET_F_GUEST_CSUM once the network stack checks the checksums of what it receives,
+        //        until then there's nothing to save by having the device check them for us.
+        if (is_feature_set(negotiated, VIRTIO_NET_F_CSUM) && is_feature_set(supported_features, VIRTIO_NET_F_HOST_TSO4))
+            negotiated |= VIRTIO_NET_F_HOST_TSO4;
+        return negotiated;
+    });
+    if (!success)
+        return false;
+
+    m_has_mergeable_receive_buffers = is_feature_accepted(VIRTIO_NET_F_MRG_RXBUF);
+    m_has_checksum_offload = is_feature_accepted(VIRTIO_NET_F_CSUM);
+    m_has_segmentation_offload = is_feature_accepted(VIRTIO_NET_F_HOST_TSO4);
+    m_has_link_status = is_feature_accepted(VIRTIO_NET_F_STATUS);
+    // NOTE: Only legacy devices that don't merge receive buffers leave out the buffer count.
+    m_header_size = (is_feature_accepted(VIRTIO_F_VERSION_1) || m_has_mergeable_receive_buffers) ? sizeof(VirtIONetworkHeader) : sizeof(VirtIONetworkHeader) - sizeof(u16);
+    // NOTE: A packet the device segments for us has its headers in front of the payload, and those fit in a page.
+    m_tx_buffer_size = m_has_segmentation_offload ? tso_max_payload_size + PAGE_SIZE : PAGE_SIZE;
+
+    if (is_feature_accepted(VIRTIO_NET_F_MAC)) {
+        MACAddress mac;
+        read_config_atomic([&]() {
+            for (size_t i = 0; i < 6; i++)
+                mac[i] = config_read8(*config, VIRTIO_NET_CONFIG_MAC + i);
+        });
+        set_mac_address(mac);
+    } else {
+        // FIXME: Make up a random MAC address, and tell the device about it over the control queue.
+        dbgln("{}: Device has no MAC address", m_class_name);
+        return false;
+    }
+
+    if (!setup_queues(2))
+        return false;
+
+    auto& rx_queue = get_queue(RECEIVEQ);
+    auto& tx_queue = get_queue(TRANSMITQ);
+    // Every buffer we give the device is a chain of its header and the packet.
+    size_t rx_slot_count = min<size_t>(rx_queue.size() / 2, max_rx_slots);
+    size_t tx_slot_count = min<size_t>(tx_queue.size() / 2, max_tx_slots);
+    if (rx_slot_count == 0 || tx_slot_count == 0)
+        return false;
+
+    m_headers_region = MM.allocate_contiguous_kernel_region(page_round_up((rx_slot_count + tx_slot_count) * header_stride), "VirtIONetworkAdapter Headers", Region::Access::Read | Region::Access::Write);
+    if (!m_headers_region)
+        return false;
+    if (!m_rx_slots.try_resize(rx_slot_count) || !m_tx_slots.try_resize(tx_slot_count))
+        return false;
+    if (!m_rx_slot_for_descriptor.try_resize(rx_queue.size()) || !m_tx_slot_for_descriptor.try_resize(tx_queue.size()))
+        return false;
+    for (auto& slot : m_tx_slots) {
+        slot.buffer = MM.allocate_contiguous_kernel_region(m_tx_buffer_size, "VirtIONetworkAdapter TX Buffer", Region::Access::Read | Region::Access::Write);
+        if (!slot.buffer)
+            return false;
+    }
+    {
+        ScopedSpinLock lock(rx_queue.lock());
+        for (size_t slot_index = 0; slot_index < m_rx_slots.size(); slot_index++) {
+            m_rx_slots[slot_index] = acquire_packet_buffer(rx_buffer_size);
+            if (!m_rx_slots[slot_index] || !supply_receive_buffer(slot_index))
+                return false;
+        }
+        notify_queue_if_needed(RECEIVEQ);
+    }
+    finish_init();
+
+    dmesgln("{}: MAC address: {}, {} receive and {} transmit slots{}{}{}", m_class_name, mac_address().to_string(), m_rx_slots.size(), m_tx_slots.size(),
+        m_has_mergeable_receive_buffers ? ", mergeable receive buffers" : "", m_has_checksum_offload ? ", checksum offload" : "", m_has_segmentation_offload ? ", segmentation offload" : "");
+    return true;
+}
+
+auto VirtIONetworkAdapter::header(size_t header_index) const -> VirtIONetworkHeader&
+{
+    return *(VirtIONetworkHeader*)(m_headers_region->vaddr().as_ptr() + header_index * header_stride);
+}
+
+PhysicalAddress VirtIONetworkAdapter::header_address(size_t header_index) const
+{
+    return m_headers_region->physical_page(0)->paddr().offset(header_index * header_stride);
+}
+
+bool VirtIONetworkAdapter::link_up()
+{
+    if (!m_has_link_status)
+        return true;
+    u16 status = 0;
+    read_config_atomic([&]() {
+        status = config_read16(*get_config(ConfigurationType::Device), VIRTIO_NET_CONFIG_STATUS);
+    });
+    return status & VIRTIO_NET_S_LINK_UP;
+}
+
+bool VirtIONetworkAdapter::handle_device_config_change()
+{
+    // NOTE: The only thing that changes is the link status, which we read whenever someone asks.
+    dbgln_if(VIRTIO_DEBUG, "{}: Link is {}", m_class_name, link_up() ? "up" : "down");
+    return true;
+}
+
+void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
+{
+    if (queue_index == RECEIVEQ) {
+        // Leave receiving to the tasklet, and don't bother us again until it has caught up.
+        if (!m_rx_poll_queued.exchange(true)) {
+            get_queue(RECEIVEQ).disable_interrupts();
+            m_rx_tasklet.schedule();
+        }
+        return;
+    }
+    VERIFY(queue_index == TRANSMITQ);
+    {
+        ScopedSpinLock lock(get_queue(TRANSMITQ).lock());
+        reclaim_transmit_slots();
+    }
+    m_tx_wait_queue.wake_all();
+}
+
+bool VirtIONetworkAdapter::supply_receive_buffer(size_t slot_index)
+{
+    auto& queue = get_queue(RECEIVEQ);
+    VERIFY(queue.lock().is_locked());
+    auto& packet = m_rx_slots[slot_index];
+    VirtIOQueueChain chain(queue);
+    if (!chain.add_buffer_to_chain(header_address(rx_header_index(slot_index)), m_header_size, BufferType::DeviceWritable)
+        || !chain.add_buffer_to_chain(packet->buffer.impl().region().physical_page(0)->paddr(), rx_buffer_size, BufferType::DeviceWritable)) {
+        chain.release_buffer_slots_to_queue();
+        return false;
+    }
+    m_rx_slot_for_descriptor[chain.start_index().value()] = slot_index;
+    // NOTE: The caller tells the device about its new buffers once it's done supplying them.
+    chain.submit_to_queue();
+    return true;
+}
+
+void VirtIONetworkAdapter::copy_from_receive_slot(size_t slot_index, size_t offset, size_t length, u8* destination) const
+{
+    VERIFY(offset + length <= m_header_size + rx_buffer_size);
+    if (offset < m_header_size) {
+        size_t length_in_header = min(length, m_header_size - offset);
+        memcpy(destination, (const u8*)&header(rx_header_index(slot_index)) + offset, length_in_header);
+        destination += length_in_header;
+        length -= length_in_header;
+        offset = m_header_size;
+    }
+    memcpy(destination, m_rx_slots[slot_index]->buffer.data() + offset - m_header_size, length);
+}
+
+void VirtIONetworkAdapter::receive_packet(size_t slot_index, size_t used_length)
+{
+    auto& queue = get_queue(RECEIVEQ);
+    VERIFY(queue.lock().is_locked());
+    if (used_length < m_header_size) {
+        dbgln("{}: Dropping packet that's too short for its header ({} bytes)", m_class_name, used_length);
+        supply_receive_buffer(slot_index);
+        return;
+    }
+    size_t buffer_count = m_has_mergeable_receive_buffers ? max<u16>(header(rx_header_index(slot_index)).buffer_count, 1) : 1;
+    size_t frame_size = used_length - m_header_size;
+    dbgln_if(VIRTIO_DEBUG, "{}: Received {} bytes in {} buffer(s), starting with slot {}", m_class_name, frame_size, buffer_count, slot_index);
+
+    if (buffer_count == 1) {
+        // The packet goes up as it is, and the slot gets a new buffer for the next one.
+        // If we can't get another buffer, we drop the packet and reuse its buffer instead.
+        auto& packet = m_rx_slots[slot_index];
+        if (auto new_packet = acquire_packet_buffer(rx_buffer_size)) {
+            packet->buffer.set_size(frame_size);
+            packet->timestamp = kgettimeofday();
+            did_receive(packet.release_nonnull());
+            packet = move(new_packet);
+        } else {
+            dbgln("{}: Dropping packet because we're out of packet buffers", m_class_name);
+        }
+        supply_receive_buffer(slot_index);
+        return;
+    }
+
+    // The device spread this packet over several buffers, so it has to be put back together.
+    // NOTE: The device uses all of a packet's buffers before it tells us about any of them.
+    auto merged_packet = acquire_packet_buffer(buffer_count * (m_header_size + rx_buffer_size));
+    if (merged_packet)
+        copy_from_receive_slot(slot_index, m_header_size, frame_size, merged_packet->buffer.data());
+    supply_receive_buffer(slot_index);
+    for (size_t i = 1; i < buffer_count; i++) {
+        size_t used;
+        auto chain = queue.pop_used_buffer_chain(used);
+        if (chain.is_empty()) {
+            dbgln("{}: Packet is missing {} of its {} buffers", m_class_name, buffer_count - i, buffer_count);
+            merged_packet = nullptr;
+            break;
+        }
+        auto continuation_slot_index = m_rx_slot_for_descriptor[chain.start_index().value()];
+        chain.release_buffer_slots_to_queue();
+        if (merged_packet) {
+            copy_from_receive_slot(continuation_slot_index, 0, used, merged_packet->buffer.data() + frame_size);
+            frame_size += used;
+        }
+        supply_receive_buffer(continuation_slot_index);
+    }
+    if (!merged_packet) {
+        dbgln("{}: Dropping packet of {} buffers", m_class_name, buffer_count);
+        return;
+    }
+    merged_packet->buffer.set_size(frame_size);
+    did_receive(merged_packet.release_nonnull());
+}
+
+size_t VirtIONetworkAdapter::receive(size_t budget)
+{
+    auto& queue = get_queue(RECEIVEQ);
+    ScopedSpinLock lock(queue.lock());
+    size_t received_count = 0;
+    while (received_count < budget) {
+        size_t used;
+        auto chain = queue.pop_used_buffer_chain(used);
+        if (chain.is_empty())
+            break;
+        auto slot_index = m_rx_slot_for_descriptor[chain.start_index().value()];
+        chain.release_buffer_slots_to_queue();
+        receive_packet(slot_index, used);
+        ++received_count;
+    }
+    // Tell the device about all the buffers we gave back at once, instead of once per packet.
+    if (received_count > 0)
+        notify_queue_if_needed(RECEIVEQ);
+    return received_count;
+}
+
+bool VirtIONetworkAdapter::poll_receive(size_t budget)
+{
+    VERIFY(m_rx_poll_queued);
+    budget = min(budget, rx_poll_budget);
+    if (receive(budget) == budget) {
+        // There's probably more where that came from, but let others have a turn first.
+        return true;
+    }
+
+    auto& queue = get_queue(RECEIVEQ);
+    m_rx_poll_queued = false;
+    queue.enable_interrupts();
+    // A packet may have come in after we looked, and the interrupt for it may be gone already.
+    full_memory_barrier();
+    if (queue.new_data_available() && !m_rx_poll_queued.exchange(true)) {
+        queue.disable_interrupts();
+        return true;
+    }
+    return false;
+}
+
+void VirtIONetworkAdapter::reclaim_transmit_slots()
+{
+    auto& queue = get_queue(TRANSMITQ);
+    VERIFY(queue.lock().is_locked());
+    size_t used;
+    for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+        m_tx_slots[m_tx_slot_for_descriptor[chain.start_index().value()]].is_in_flight = false;
+        chain.release_buffer_slots_to_queue();
+    }
+}
+
+void VirtIONetworkAdapter::transmit(ReadonlyBytes frame, const TCPOffload* offload)
+{
+    VERIFY(frame.size() <= m_tx_buffer_size);
+    auto& queue = get_queue(TRANSMITQ);
+
+    Optional<size_t> slot_index;
+    for (;;) {
+        {
+            ScopedSpinLock lock(queue.lock());
+            reclaim_transmit_slots();
+            for (size_t index = 0; index < m_tx_slots.size(); index++) {
+                if (!m_tx_slots[index].is_in_flight) {
+                    m_tx_slots[index].is_in_flight = true;
+                    slot_index = index;
+                    break;
+                }
+            }
+        }
+        if (slot_index.has_value())
+            break;
+        m_tx_wait_queue.wait_forever("VirtIONetworkAdapter");
+    }
+
+    auto& slot = m_tx_slots[slot_index.value()];
+    u8* buffer = slot.buffer->vaddr().as_ptr();
+    memcpy(buffer, frame.data(), frame.size());
+
+    auto& net_header = header(tx_header_index(slot_index.value()));
+    memset(&net_header, 0, sizeof(net_header));
+    if (offload) {
+        net_header.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+        net_header.checksum_start = offload->tcp_header_offset;
+        net_header.checksum_offset = tcp_checksum_offset;
+        if (offload->segment_size) {
+            net_header.gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+            net_header.gso_size = offload->segment_size;
+            net_header.header_length = offload->tcp_header_offset + offload->tcp_header_size;
+            // NOTE: The network stack leaves the length out of the pseudo-header sum of a packet that's going to be segmented,
+            //       but the device works like Linux does, and wants the length of the whole TCP packet in there.
+            //       This only changes our copy, the packet may still get retransmitted as it is.
+            auto& checksum = *(NetworkOrdered<u16>*)(buffer + offload->tcp_header_offset + tcp_checksum_offset);
+            u32 sum = (u16)checksum + (u32)(frame.size() - offload->tcp_header_offset);
+            sum = (sum >> 16) + (sum & 0xffff);
+            checksum = (u16)((sum >> 16) + (sum & 0xffff));
+        }
+    }
+
+    dbgln_if(VIRTIO_DEBUG, "{}: Sending {} bytes from slot {}", m_class_name, frame.size(), slot_index.value());
+
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    // NOTE: There are never more packets in flight than the queue has room for, so this can't run out of descriptors.
+    bool added = chain.add_buffer_to_chain(header_address(tx_header_index(slot_index.value())), m_header_size, BufferType::DeviceReadable)
+        && chain.add_buffer_to_chain(slot.buffer->physical_page(0)->paddr(), frame.size(), BufferType::DeviceReadable);
+    VERIFY(added);
+    m_tx_slot_for_descriptor[chain.start_index().value()] = slot_index.value();
+    supply_chain_and_notify(TRANSMITQ, chain);
+}
+
+void VirtIONetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    transmit(payload, nullptr);
+}
+
+void VirtIONetworkAdapter::send_raw_with_tcp_offload(PacketWithTimestamp& packet, const TCPOffload& offload)
+{
+    VERIFY(m_has_checksum_offload);
+    VERIFY(!offload.segment_size || m_has_segmentation_offload);
+    transmit({ packet.buffer.data(), packet.buffer.size() }, &offload);
+}
+
+}
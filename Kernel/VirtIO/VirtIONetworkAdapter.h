@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Tasklet.h>
+#include <Kernel/VirtIO/VirtIO.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// A virtio-net device.
+//
+// The device receives right into our packet buffers, and packets that it spreads over several of them
+// (with VIRTIO_NET_F_MRG_RXBUF) get put back together. Sending copies the packet into a buffer of ours,
+// so it doesn't have to wait for the device to get to it. If the device can, it fills in TCP checksums
+// and segments TCP packets by itself.
+class VirtIONetworkAdapter final : public NetworkAdapter
+    , public VirtIODevice {
+public:
+    static RefPtr<VirtIONetworkAdapter> try_to_initialize(PCI::Address);
+    virtual ~VirtIONetworkAdapter() override;
+
+    virtual const char* class_name() const override { return m_class_name.characters(); }
+    virtual const char* purpose() const override { return class_name(); }
+
+    virtual bool link_up() override;
+    virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_tcp_offload(PacketWithTimestamp&, const TCPOffload&) override;
+    virtual bool has_tcp_checksum_offload() const override { return m_has_checksum_offload; }
+    virtual size_t tcp_segmentation_max_payload_size() const override { return m_has_segmentation_offload ? tso_max_payload_size : 0; }
+
+private:
+    static constexpr u16 RECEIVEQ = 0;
+    static constexpr u16 TRANSMITQ = 1;
+
+    // NOTE: These have to fit a whole Ethernet frame, since we don't ask for packets bigger than that.
+    static constexpr size_t rx_buffer_size = 2048;
+    static constexpr size_t max_rx_slots = 64;
+    static constexpr size_t max_tx_slots = 16;
+    static constexpr size_t tso_max_payload_size = 32 * KiB;
+    static constexpr size_t rx_poll_budget = 64;
+    // Each slot's virtio_net_hdr lives at this stride in m_headers_region.
+    static constexpr size_t header_stride = 16;
+
+    struct [[gnu::packed]] VirtIONetworkHeader {
+        u8 flags;
+        u8 gso_type;
+        u16 header_length;
+        u16 gso_size;
+        u16 checksum_start;
+        u16 checksum_offset;
+        // NOTE: This is only there if the device is a modern one, or if it merges receive buffers.
+        u16 buffer_count;
+    };
+
+    explicit VirtIONetworkAdapter(PCI::Address);
+    bool initialize();
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    VirtIONetworkHeader& header(size_t header_index) const;
+    PhysicalAddress header_address(size_t header_index) const;
+    size_t rx_header_index(size_t slot_index) const { return slot_index; }
+    size_t tx_header_index(size_t slot_index) const { return m_rx_slots.size() + slot_index; }
+
+    bool supply_receive_buffer(size_t slot_index);
+    // The device sees a slot's header and packet buffer as one buffer, and continuation buffers of a merged packet don't have a header.
+    void copy_from_receive_slot(size_t slot_index, size_t offset, size_t length, u8* destination) const;
+    void receive_packet(size_t slot_index, size_t used_length);
+    // Hands up to budget received packets to the network stack, and returns how many there were.
+    size_t receive(size_t budget);
+    // Called from m_rx_tasklet, returns true if there's more to receive.
+    bool poll_receive(size_t budget);
+
+    void reclaim_transmit_slots();
+    void transmit(ReadonlyBytes frame, const TCPOffload*);
+
+    struct TransmitSlot {
+        OwnPtr<Region> buffer;
+        bool is_in_flight { false };
+    };
+
+    u8 m_header_size { 0 };
+    bool m_has_mergeable_receive_buffers { false };
+    bool m_has_checksum_offload { false };
+    bool m_has_segmentation_offload { false };
+    bool m_has_link_status { false };
+    size_t m_tx_buffer_size { 0 };
+
+    OwnPtr<Region> m_headers_region;
+    // The device receives right into these packets, which then go up the stack as they are.
+    Vector<RefPtr<PacketWithTimestamp>> m_rx_slots;
+    Vector<TransmitSlot> m_tx_slots;
+    // Which slot the chain starting at each descriptor belongs to, for each queue.
+    Vector<u16> m_rx_slot_for_descriptor;
+    Vector<u16> m_tx_slot_for_descriptor;
+
+    // Set while receiving is left to poll_receive() with the receive queue's interrupts off.
+    Atomic<bool> m_rx_poll_queued { false };
+    Tasklet m_rx_tasklet { [this](size_t budget) { return poll_receive(budget); } };
+    // Woken up whenever the device is done with some of our transmit slots.
+    WaitQueue m_tx_wait_queue;
+};
+
+}
@@ -162,6 +162,27 @@ bool VirtIOQueueChain::add_buffer_to_chain(PhysicalAddress buffer_start, size_t
     return true;
 }
 
+bool VirtIOQueueChain::add_indirect_table_to_chain(PhysicalAddress table_start, size_t descriptor_count)
+{
+    VERIFY(m_queue.lock().is_locked());
+    // NOTE: The spec doesn't allow an indirect descriptor to be followed by any other, so it's the whole chain.
+    VERIFY(is_empty());
+    VERIFY(descriptor_count > 0);
+
+    auto descriptor_index = m_queue.take_free_slot();
+    if (!descriptor_index.has_value())
+        return false;
+
+    m_start_of_chain_index = m_end_of_chain_index = descriptor_index.value();
+    m_chain_length = 1;
+
+    auto& descriptor = m_queue.m_descriptors[descriptor_index.value()];
+    descriptor.address = static_cast<u64>(table_start.get());
+    descriptor.flags = VIRTQ_DESC_F_INDIRECT;
+    descriptor.length = static_cast<u32>(descriptor_count * sizeof(VirtIOQueue::VirtIOQueueDescriptor));
+    return true;
+}
+
 void VirtIOQueueChain::submit_to_queue()
 {
     VERIFY(m_queue.lock().is_locked());
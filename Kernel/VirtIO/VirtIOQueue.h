@@ -13,6 +13,7 @@
 namespace Kernel {
 
 #define VIRTQ_DESC_F_NEXT 1
+#define VIRTQ_DESC_F_WRITE 2
 #define VIRTQ_DESC_F_INDIRECT 4
 
 #define VIRTQ_AVAIL_F_NO_INTERRUPT 1
@@ -28,10 +29,19 @@ class VirtIOQueueChain;
 
 class VirtIOQueue {
 public:
+    // NOTE: Drivers use this to build the tables behind indirect descriptors, see VirtIOQueueChain::add_indirect_table_to_chain().
+    struct [[gnu::packed]] VirtIOQueueDescriptor {
+        u64 address;
+        u32 length;
+        u16 flags;
+        u16 next;
+    };
+
     VirtIOQueue(u16 queue_size, u16 notify_offset);
     ~VirtIOQueue();
 
     bool is_null() const { return !m_queue_region; }
+    u16 size() const { return m_queue_size; }
     u16 notify_offset() const { return m_notify_offset; }
 
     void enable_interrupts();
@@ -59,12 +69,6 @@ private:
         auto offset = FlatPtr(ptr) - m_queue_region->vaddr().get();
         return m_queue_region->physical_page(0)->paddr().offset(offset);
     }
-    struct [[gnu::packed]] VirtIOQueueDescriptor {
-        u64 address;
-        u32 length;
-        u16 flags;
-        u16 next;
-    };
 
     struct [[gnu::packed]] VirtIOQueueDriver {
         u16 flags;
@@ -150,7 +154,12 @@ public:
     [[nodiscard]] VirtIOQueue& queue() const { return m_queue; }
     [[nodiscard]] bool is_empty() const { return m_chain_length == 0; }
     [[nodiscard]] size_t length() const { return m_chain_length; }
+    [[nodiscard]] Optional<u16> start_index() const { return m_start_of_chain_index; }
     bool add_buffer_to_chain(PhysicalAddress buffer_start, size_t buffer_length, BufferType buffer_type);
+    // Makes the chain a single descriptor pointing at a table of descriptors, so a request of any number of buffers
+    // only takes up one slot in the queue. The table has to stay untouched until the chain comes back used.
+    // NOTE: This is only allowed if VIRTIO_F_INDIRECT_DESC was negotiated.
+    bool add_indirect_table_to_chain(PhysicalAddress table_start, size_t descriptor_count);
     void submit_to_queue();
     void release_buffer_slots_to_queue();
 
@@ -9,6 +9,7 @@
 #include <Kernel/ACPI/Initialize.h>
 #include <Kernel/ACPI/MultiProcessorParser.h>
 #include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/BootTaskGraph.h>
 #include <Kernel/CMOS.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/DMI.h>
@@ -47,6 +48,9 @@
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/Tasks/FinalizerTask.h>
+#include <Kernel/Tasks/PageMergingTask.h>
+#include <Kernel/Tasks/PageReclaimTask.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/VM/MemoryManager.h>
@@ -230,17 +234,13 @@ void init_stage2(void*)
     }
 
     SyncTask::spawn();
+    PageZeroingTask::spawn();
+    PageReclaimTask::spawn();
+    PageMergingTask::spawn();
     FinalizerTask::spawn();
 
     auto boot_profiling = kernel_command_line().is_boot_profiling_enabled();
 
-    USB::UHCIController::detect();
-
-    DMIExpose::initialize();
-
-    VirtIO::detect();
-
-    NetworkingManagement::the().initialize();
     Syscall::initialize();
 
     new MemoryDevice;
@@ -248,16 +248,27 @@ void init_stage2(void*)
     new FullDevice;
     new RandomDevice;
     PTYMultiplexer::initialize();
-    SB16::detect();
-
-    StorageManagement::initialize(kernel_command_line().root_device(), kernel_command_line().is_force_pio());
-    if (!VFS::the().mount_root(StorageManagement::the().root_filesystem())) {
-        PANIC("VFS::mount_root failed");
-    }
-
-    Process::current()->set_root_directory(VFS::the().root_custody());
 
-    load_kernel_symbol_table();
+    // NOTE: Drivers that don't need each other get initialized at the same time, so that waiting
+    //       for one device doesn't hold up all the others.
+    BootTaskGraph boot_tasks(kernel_command_line().is_parallel_boot_enabled());
+    boot_tasks.add("USB", [] { USB::UHCIController::detect(); });
+    boot_tasks.add("DMI", [] { DMIExpose::initialize(); });
+    boot_tasks.add("VirtIO", [] { VirtIO::detect(); });
+    boot_tasks.add("Networking", [] { NetworkingManagement::the().initialize(); });
+    boot_tasks.add("Sound", [] { SB16::detect(); });
+    auto storage = boot_tasks.add("Storage", [] {
+        StorageManagement::initialize(kernel_command_line().root_device(), kernel_command_line().is_force_pio());
+    });
+    auto root_filesystem = boot_tasks.add("Root filesystem", [] {
+        if (!VFS::the().mount_root(StorageManagement::the().root_filesystem())) {
+            PANIC("VFS::mount_root failed");
+        }
+        Process::current()->set_root_directory(VFS::the().root_custody());
+    },
+        { storage });
+    boot_tasks.add("Kernel symbols", [] { load_kernel_symbol_table(); }, { root_filesystem });
+    boot_tasks.run();
 
     // NOTE: Everything marked READONLY_AFTER_INIT becomes non-writable after this point.
     MM.protect_readonly_after_init_memory();
@@ -276,6 +287,7 @@ void init_stage2(void*)
     RefPtr<Thread> thread;
     auto userspace_init = kernel_command_line().userspace_init();
     auto init_args = kernel_command_line().userspace_init_args();
+    dmesgln("Boot: Starting {} at {} ms", userspace_init, TimeManagement::the().uptime_ms());
     Process::create_user_process(thread, userspace_init, (uid_t)0, (gid_t)0, ProcessID(0), error, move(init_args), {}, tty0);
     if (error != 0) {
         PANIC("init_stage2: Error spawning SystemServer: {}", error);
@@ -6,6 +6,7 @@ set(ARP_DEBUG ON)
 set(AUTOCOMPLETE_DEBUG ON)
 set(AWAVLOADER_DEBUG ON)
 set(BBFS_DEBUG ON)
+set(BLOCK_REQUEST_QUEUE_DEBUG ON)
 set(BMP_DEBUG ON)
 set(BXVGA_DEBUG ON)
 set(CACHE_DEBUG ON)
@@ -39,6 +40,7 @@ set(E1000E_DEBUG ON)
 set(EDITOR_DEBUG ON)
 set(ELF_IMAGE_DEBUG ON)
 set(EMOJI_DEBUG ON)
+set(EPOLL_DEBUG ON)
 set(ESCAPE_SEQUENCE_DEBUG ON)
 set(ETHERNET_DEBUG ON)
 set(ETHERNET_VERY_DEBUG ON)
@@ -54,6 +56,7 @@ set(FILE_WATCHER_DEBUG ON)
 set(FILL_PATH_DEBUG ON)
 set(FORK_DEBUG ON)
 set(FRAMEBUFFER_DEVICE_DEBUG ON)
+set(FRAME_TIMING_DEBUG ON)
 set(FUTEX_DEBUG ON)
 set(FUTEXQUEUE_DEBUG ON)
 set(GEMINI_DEBUG ON)
@@ -99,6 +102,7 @@ set(LINE_EDITOR_DEBUG ON)
 set(LOCAL_SOCKET_DEBUG ON)
 set(LOCK_DEBUG ON)
 set(LOCK_RESTORE_DEBUG ON)
+set(LOCK_STATISTICS ON)
 set(LOCK_TRACE_DEBUG ON)
 set(LOOKUPSERVER_DEBUG ON)
 set(MALLOC_DEBUG ON)
@@ -117,6 +121,7 @@ set(MULTIPROCESSOR_DEBUG ON)
 set(NE2000_DEBUG ON)
 set(NETWORK_TASK_DEBUG ON)
 set(NT_DEBUG ON)
+set(NVME_DEBUG ON)
 set(OBJECT_DEBUG ON)
 set(OCCLUSIONS_DEBUG ON)
 set(OFFD_DEBUG ON)
@@ -131,12 +136,14 @@ set(POLL_SELECT_DEBUG ON)
 set(PORTABLE_IMAGE_LOADER_DEBUG ON)
 set(PROCESS_DEBUG ON)
 set(PROCFS_DEBUG ON)
+set(PROFILING_DEBUG ON)
 set(PROMISE_DEBUG ON)
 set(PS2MOUSE_DEBUG ON)
 set(PTHREAD_DEBUG ON)
 set(PTMX_DEBUG ON)
 set(REACHABLE_DEBUG ON)
 set(REGEX_DEBUG ON)
+set(REQUESTSERVER_DEBUG ON)
 set(RESIZE_DEBUG ON)
 set(RESOURCE_DEBUG ON)
 set(ROUTING_DEBUG ON)
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Arena.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+TEST_CASE(allocations_are_aligned)
+{
+    Arena arena(64);
+    for (size_t i = 0; i < 100; ++i) {
+        (void)arena.allocate(1, 1);
+        auto* u64_pointer = arena.allocate(sizeof(u64), alignof(u64));
+        EXPECT_EQ(reinterpret_cast<FlatPtr>(u64_pointer) % alignof(u64), 0u);
+        auto* page = arena.allocate(16, 64);
+        EXPECT_EQ(reinterpret_cast<FlatPtr>(page) % 64, 0u);
+    }
+}
+
+TEST_CASE(large_allocations)
+{
+    Arena arena(64);
+    auto span = arena.allocate_array<u8>(1000);
+    EXPECT_EQ(span.size(), 1000u);
+    span.fill(0xaa);
+    auto& value = arena.make<int>(42);
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(span[999], 0xaa);
+}
+
+struct Node {
+    Node(Vector<int>& destroyed, int value, Node* next = nullptr)
+        : destroyed(destroyed)
+        , value(value)
+        , next(next)
+    {
+    }
+    ~Node() { destroyed.append(value); }
+
+    Vector<int>& destroyed;
+    int value { 0 };
+    Node* next { nullptr };
+    String name { "node" };
+};
+
+TEST_CASE(objects_are_destroyed_in_reverse_order)
+{
+    Vector<int> destroyed;
+    {
+        Arena arena;
+        Node* list = nullptr;
+        for (int i = 0; i < 1000; ++i)
+            list = &arena.make<Node>(destroyed, i, list);
+        EXPECT_EQ(list->value, 999);
+        EXPECT_EQ(list->next->value, 998);
+        EXPECT_EQ(list->name, "node");
+        EXPECT(destroyed.is_empty());
+    }
+    EXPECT_EQ(destroyed.size(), 1000u);
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(destroyed[i], 999 - i);
+}
+
+TEST_CASE(clear_allows_reuse)
+{
+    Vector<int> destroyed;
+    Arena arena;
+    (void)arena.make<Node>(destroyed, 1);
+    EXPECT(arena.bytes_allocated() >= sizeof(Node));
+    arena.clear();
+    EXPECT_EQ(destroyed.size(), 1u);
+    EXPECT_EQ(arena.bytes_allocated(), 0u);
+    auto& node = arena.make<Node>(destroyed, 2);
+    EXPECT_EQ(node.value, 2);
+}
@@ -61,3 +61,29 @@ TEST_CASE(overwritting_is_well_defined)
 
     EXPECT(stream.eof());
 }
+
+TEST_CASE(write_from_seekback)
+{
+    constexpr size_t capacity = 32;
+
+    CircularDuplexStream<capacity> stream;
+
+    // Get the write position close to the end of the buffer, so that the copies below wrap around.
+    for (size_t idx = 0; idx < 20; ++idx)
+        stream << static_cast<u8>(idx);
+    stream.discard_or_error(20);
+
+    // A copy that overlaps itself repeats the last bytes.
+    stream << static_cast<u8>('a') << static_cast<u8>('b');
+    EXPECT(stream.write_from_seekback(2, 7));
+
+    // A copy from further back than it is long.
+    EXPECT(stream.write_from_seekback(9, 9));
+
+    Array<u8, 18> buffer;
+    stream >> buffer;
+    EXPECT_EQ(StringView(buffer.data(), buffer.size()), "ababababaababababa");
+
+    EXPECT(!stream.write_from_seekback(capacity + 1, 1));
+    EXPECT(stream.handle_any_error());
+}
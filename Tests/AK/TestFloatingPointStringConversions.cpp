@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/BitCast.h>
+#include <AK/FloatingPointStringConversions.h>
+
+static void expect_bits(double value, u64 bits)
+{
+    EXPECT_EQ(bit_cast<u64>(value), bits);
+}
+
+TEST_CASE(decimal_to_double_simple)
+{
+    EXPECT_EQ(decimal_to_double(0, 0), 0.0);
+    EXPECT_EQ(decimal_to_double(1, 0), 1.0);
+    EXPECT_EQ(decimal_to_double(15, -1), 1.5);
+    EXPECT_EQ(decimal_to_double(1, 2), 100.0);
+    EXPECT_EQ(decimal_to_double(1, 0, true), -1.0);
+    expect_bits(decimal_to_double(0, 0, true), 0x8000000000000000ull);
+}
+
+TEST_CASE(decimal_to_double_rounding)
+{
+    // 0.1 and 0.3 aren't representable, and the naive approach of dividing by 10 gets the wrong double.
+    expect_bits(decimal_to_double(1, -1), 0x3fb999999999999aull);
+    expect_bits(decimal_to_double(3, -1), 0x3fd3333333333333ull);
+    // 2^53 + 1 is exactly halfway between two doubles, and has to round to the even one.
+    expect_bits(decimal_to_double(9007199254740993ull, 0), 0x4340000000000000ull);
+    // 2^53 + 3 is too, but rounds up.
+    expect_bits(decimal_to_double(9007199254740995ull, 0), 0x4340000000000002ull);
+    expect_bits(decimal_to_double(17976931348623157ull, 292), 0x7fefffffffffffffull);
+    expect_bits(decimal_to_double(22250738585072014ull, -324), 0x0010000000000000ull);
+}
+
+TEST_CASE(decimal_to_double_extremes)
+{
+    // The smallest subnormal, and the numbers around half of it.
+    expect_bits(decimal_to_double(5, -324), 0x0000000000000001ull);
+    expect_bits(decimal_to_double(3, -324), 0x0000000000000001ull);
+    expect_bits(decimal_to_double(2, -324), 0x0000000000000000ull);
+    expect_bits(decimal_to_double(1, -400), 0x0000000000000000ull);
+    expect_bits(decimal_to_double(18, 307), 0x7ff0000000000000ull);
+    expect_bits(decimal_to_double(1, 400), 0x7ff0000000000000ull);
+    expect_bits(decimal_to_double(1, 400, true), 0xfff0000000000000ull);
+}
+
+static void expect_shortest(double value, u64 significand, i32 exponent)
+{
+    auto decimal = shortest_decimal_representation(value);
+    EXPECT_EQ(decimal.significand, significand);
+    EXPECT_EQ(decimal.exponent, exponent);
+}
+
+TEST_CASE(shortest_decimal_representation)
+{
+    expect_shortest(1.0, 1, 0);
+    expect_shortest(100.0, 1, 2);
+    expect_shortest(0.1, 1, -1);
+    expect_shortest(0.3, 3, -1);
+    expect_shortest(0.1 + 0.2, 30000000000000004ull, -17);
+    expect_shortest(1.0 / 3.0, 3333333333333333ull, -16);
+    expect_shortest(123456.789, 123456789, -3);
+    expect_shortest(9007199254740992.0, 9007199254740992ull, 0);
+    expect_shortest(1e23, 1, 23);
+    expect_shortest(bit_cast<double>(0x0000000000000001ull), 5, -324);
+    expect_shortest(bit_cast<double>(0x7fefffffffffffffull), 17976931348623157ull, 292);
+    expect_shortest(bit_cast<double>(0x0010000000000000ull), 22250738585072014ull, -324);
+}
+
+TEST_CASE(shortest_decimal_representation_round_trips)
+{
+    u64 bits = 0x3ff0000000000000ull;
+    for (size_t i = 0; i < 100000; ++i) {
+        // Walk through lots of different exponents and mantissas.
+        bits = (bits * 6364136223846793005ull + 1442695040888963407ull) & 0x7fefffffffffffffull;
+        auto value = bit_cast<double>(bits);
+        if (value == 0.0)
+            continue;
+        auto decimal = shortest_decimal_representation(value);
+        EXPECT_EQ(bit_cast<u64>(decimal_to_double(decimal.significand, decimal.exponent)), bits);
+        EXPECT(decimal.significand % 10 != 0);
+    }
+}
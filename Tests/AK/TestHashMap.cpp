@@ -173,3 +173,44 @@ TEST_CASE(basic_contains)
     EXPECT_EQ(map.remove(1), true);
     EXPECT_EQ(map.contains(1), false);
 }
+
+BENCHMARK_CASE(benchmark_insert_and_lookup)
+{
+    HashMap<int, int> map;
+    for (int i = 0; i < 1'000'000; ++i)
+        map.set(i * 7, i);
+
+    size_t hits = 0;
+    for (int i = 0; i < 5'000'000; ++i)
+        hits += map.get(i).has_value();
+    EXPECT_EQ(hits, 714286u);
+}
+
+BENCHMARK_CASE(benchmark_string_keys)
+{
+    Vector<String> keys;
+    for (int i = 0; i < 100'000; ++i)
+        keys.append(String::number(i));
+
+    HashMap<String, int> map;
+    for (int i = 0; i < 10; ++i) {
+        for (size_t j = 0; j < keys.size(); ++j)
+            map.set(keys[j], j);
+    }
+
+    size_t hits = 0;
+    for (auto& key : keys)
+        hits += map.contains(key);
+    EXPECT_EQ(hits, keys.size());
+}
+
+BENCHMARK_CASE(benchmark_insert_and_remove)
+{
+    HashMap<int, int> map;
+    for (int i = 0; i < 2'000'000; ++i) {
+        map.set(i, i);
+        if (i >= 1000)
+            map.remove(i - 1000);
+    }
+    EXPECT_EQ(map.size(), 1000u);
+}
@@ -198,3 +198,97 @@ TEST_CASE(basic_contains)
     EXPECT_EQ(table.remove(1), true);
     EXPECT_EQ(table.contains(1), false);
 }
+
+TEST_CASE(many_removes_keep_capacity)
+{
+    HashTable<int> table;
+    for (int i = 0; i < 100; ++i)
+        table.set(i);
+
+    // Churning through lots of values at the same size shouldn't make the table keep growing.
+    size_t capacity = 0;
+    for (int i = 100; i < 100000; ++i) {
+        if (i == 1000)
+            capacity = table.capacity();
+        EXPECT_EQ(table.remove(i - 100), true);
+        EXPECT_EQ(table.set(i), AK::HashSetResult::InsertedNewEntry);
+    }
+
+    EXPECT_EQ(table.size(), 100u);
+    EXPECT_EQ(table.capacity(), capacity);
+    for (int i = 99900; i < 100000; ++i)
+        EXPECT(table.contains(i));
+}
+
+TEST_CASE(iterate_after_removes)
+{
+    HashTable<int> table;
+    for (int i = 0; i < 1000; ++i)
+        table.set(i);
+    for (int i = 0; i < 1000; i += 2)
+        table.remove(i);
+
+    size_t count = 0;
+    for (auto value : table) {
+        EXPECT_EQ(value % 2, 1);
+        ++count;
+    }
+    EXPECT_EQ(count, 500u);
+}
+
+TEST_CASE(ensure_capacity_avoids_rehashing)
+{
+    HashTable<int> table;
+    table.ensure_capacity(1000);
+    auto capacity = table.capacity();
+    for (int i = 0; i < 1000; ++i)
+        table.set(i);
+    EXPECT_EQ(table.capacity(), capacity);
+}
+
+BENCHMARK_CASE(benchmark_thrashing)
+{
+    HashTable<int> table;
+    // Ensure that there needs to be some copying when rehashing.
+    table.set(3);
+    table.set(7);
+    table.set(11);
+    table.set(13);
+    for (int i = 0; i < 10'000; ++i) {
+        table.set(-i);
+    }
+    for (int i = 0; i < 10'000'000; ++i) {
+        table.set(i);
+        table.remove(i);
+    }
+}
+
+BENCHMARK_CASE(benchmark_lookups)
+{
+    HashTable<int> table;
+    for (int i = 0; i < 1'000'000; ++i)
+        table.set(i * 7);
+
+    size_t hits = 0;
+    for (int i = 0; i < 5'000'000; ++i)
+        hits += table.contains(i);
+    EXPECT_EQ(hits, 714286u);
+}
+
+BENCHMARK_CASE(benchmark_string_keys)
+{
+    Vector<String> keys;
+    for (int i = 0; i < 100'000; ++i)
+        keys.append(String::formatted("key{}", i));
+
+    HashTable<String> table;
+    for (auto& key : keys)
+        table.set(key);
+
+    size_t hits = 0;
+    for (int i = 0; i < 10; ++i) {
+        for (auto& key : keys)
+            hits += table.contains(key);
+    }
+    EXPECT_EQ(hits, 1'000'000u);
+}
@@ -9,6 +9,7 @@
 #include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonTokenizer.h>
 #include <AK/JsonValue.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
@@ -98,3 +99,106 @@ TEST_CASE(json_duplicate_keys)
     json.set("test", "baz");
     EXPECT_EQ(json.to_string(), "{\"test\":\"baz\"}");
 }
+
+TEST_CASE(json_object_keys_are_shared)
+{
+    auto json = JsonValue::from_string("[{\"name\":1},{\"name\":2},{\"na\\u006de\":3}]").value();
+    auto& array = json.as_array();
+    Vector<const StringImpl*> key_impls;
+    for (auto& element : array.values()) {
+        element.as_object().for_each_member([&](auto& key, auto&) {
+            EXPECT_EQ(key, "name");
+            key_impls.append(key.impl());
+        });
+    }
+    EXPECT_EQ(key_impls.size(), 3u);
+    EXPECT_EQ(key_impls[0], key_impls[1]);
+    EXPECT_EQ(array.at(2).as_object().get("name").to_i32(), 3);
+}
+
+TEST_CASE(json_strings_with_and_without_escapes)
+{
+    EXPECT_EQ(JsonValue::from_string("\"plain\"").value().as_string(), "plain");
+    EXPECT_EQ(JsonValue::from_string("\"\"").value().as_string(), "");
+    EXPECT_EQ(JsonValue::from_string("\"a\\tb\\\"c\"").value().as_string(), "a\tb\"c");
+    EXPECT(!JsonValue::from_string("\"unterminated").has_value());
+}
+
+TEST_CASE(json_tokenizer)
+{
+    JsonTokenizer tokenizer(" {\"a\": [1, -2.5e3, \"x\\ny\"], \"b\" : {}, \"c\": [true, false, null]} ");
+    Vector<JsonToken::Type> types;
+    Vector<String> texts;
+    for (;;) {
+        auto token = tokenizer.next();
+        EXPECT(!token.is_error());
+        if (token.is_error() || token.type == JsonToken::Type::EndOfInput)
+            break;
+        types.append(token.type);
+        texts.append(token.to_string());
+    }
+    using Type = JsonToken::Type;
+    Vector<Type> expected_types { Type::ObjectStart, Type::Key, Type::ArrayStart, Type::Number, Type::Number, Type::String, Type::ArrayEnd,
+        Type::Key, Type::ObjectStart, Type::ObjectEnd, Type::Key, Type::ArrayStart, Type::True, Type::False, Type::Null, Type::ArrayEnd, Type::ObjectEnd };
+    EXPECT_EQ(types, expected_types);
+    EXPECT_EQ(texts[1], "a");
+    EXPECT_EQ(texts[3], "1");
+    EXPECT_EQ(texts[4], "-2.5e3");
+    EXPECT_EQ(texts[5], "x\ny");
+}
+
+TEST_CASE(json_tokenizer_skip_value)
+{
+    JsonTokenizer tokenizer("{\"skip\": {\"a\": [1, {\"b\": 2}]}, \"keep\": 42}");
+    EXPECT(tokenizer.next_is(JsonToken::Type::ObjectStart));
+    auto key = tokenizer.next();
+    EXPECT(key.string_equals("skip"sv));
+    EXPECT(tokenizer.skip_value(tokenizer.next()));
+    EXPECT(tokenizer.next().string_equals("keep"sv));
+    EXPECT_EQ(tokenizer.next().to_integer<u32>(), 42u);
+    EXPECT(tokenizer.next_is(JsonToken::Type::ObjectEnd));
+    EXPECT(tokenizer.next_is(JsonToken::Type::EndOfInput));
+}
+
+TEST_CASE(json_tokenizer_rejects_malformed_input)
+{
+    auto is_valid = [](StringView input) {
+        JsonTokenizer tokenizer(input);
+        for (;;) {
+            auto token = tokenizer.next();
+            if (token.is_error())
+                return false;
+            if (token.type == JsonToken::Type::EndOfInput)
+                return true;
+        }
+    };
+    EXPECT(is_valid("[]"sv));
+    EXPECT(is_valid("\"\""sv));
+    EXPECT(!is_valid(""sv));
+    EXPECT(!is_valid("[1,]"sv));
+    EXPECT(!is_valid("{\"a\" 1}"sv));
+    EXPECT(!is_valid("{\"a\": 1,}"sv));
+    EXPECT(!is_valid("[1}"sv));
+    EXPECT(!is_valid("[1] 2"sv));
+    EXPECT(!is_valid("[\"unterminated]"sv));
+    EXPECT(!is_valid("[nul]"sv));
+}
+
+BENCHMARK_CASE(benchmark_parse)
+{
+    StringBuilder builder;
+    builder.append('[');
+    for (int i = 0; i < 10'000; ++i) {
+        if (i)
+            builder.append(',');
+        builder.appendff("{{\"id\":{},\"name\":\"item {}\",\"ratio\":{}.5,\"tags\":[\"a\",\"b\",null,true]}}", i, i, i);
+    }
+    builder.append(']');
+    auto json = builder.to_string();
+
+    for (int run = 0; run < 10; ++run) {
+        auto value = JsonValue::from_string(json);
+        EXPECT(value.has_value());
+        EXPECT_EQ(value->as_array().size(), 10'000);
+    }
+}
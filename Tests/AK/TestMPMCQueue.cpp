@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MPMCQueue.h>
+#include <AK/String.h>
+
+TEST_CASE(construct)
+{
+    MPMCQueue<int, 8> queue;
+    EXPECT(queue.is_empty());
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.capacity(), 8u);
+    EXPECT(!queue.try_dequeue().has_value());
+}
+
+TEST_CASE(fill_and_drain)
+{
+    MPMCQueue<int, 8> queue;
+    for (int i = 0; i < 8; ++i)
+        EXPECT(queue.try_enqueue(i));
+    EXPECT_EQ(queue.size(), 8u);
+    EXPECT(!queue.try_enqueue(8));
+
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(queue.try_dequeue().value(), i);
+    EXPECT(queue.is_empty());
+    EXPECT(!queue.try_dequeue().has_value());
+}
+
+TEST_CASE(wrap_around)
+{
+    MPMCQueue<int, 4> queue;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT(queue.try_enqueue(i));
+        EXPECT(queue.try_enqueue(i + 1000));
+        EXPECT(queue.try_enqueue(i + 2000));
+        EXPECT_EQ(queue.try_dequeue().value(), i);
+        EXPECT_EQ(queue.try_dequeue().value(), i + 1000);
+        EXPECT_EQ(queue.try_dequeue().value(), i + 2000);
+    }
+    EXPECT(queue.is_empty());
+}
+
+TEST_CASE(failed_enqueue_keeps_value)
+{
+    MPMCQueue<String, 2> queue;
+    EXPECT(queue.try_enqueue(String("foo")));
+    EXPECT(queue.try_enqueue(String("bar")));
+
+    String baz = "baz";
+    EXPECT(!queue.try_enqueue(move(baz)));
+    EXPECT_EQ(baz, "baz");
+
+    EXPECT_EQ(queue.try_dequeue().value(), "foo");
+    EXPECT(queue.try_enqueue(move(baz)));
+    EXPECT_EQ(queue.try_dequeue().value(), "bar");
+    EXPECT_EQ(queue.try_dequeue().value(), "baz");
+}
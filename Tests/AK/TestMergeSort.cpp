@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MergeSort.h>
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+
+TEST_CASE(sorts)
+{
+    Vector<int> values;
+    for (int i = 0; i < 1000; ++i)
+        values.append((i * 7919) % 1000);
+
+    merge_sort(values);
+
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(values[i], i);
+}
+
+TEST_CASE(is_stable)
+{
+    struct Entry {
+        int key;
+        int original_index;
+    };
+
+    Vector<Entry> entries;
+    for (int i = 0; i < 500; ++i)
+        entries.append({ (i * 31) % 7, i });
+
+    merge_sort(entries, [](auto& a, auto& b) { return a.key < b.key; });
+
+    for (size_t i = 1; i < entries.size(); ++i) {
+        EXPECT(entries[i - 1].key <= entries[i].key);
+        if (entries[i - 1].key == entries[i].key)
+            EXPECT(entries[i - 1].original_index < entries[i].original_index);
+    }
+}
+
+TEST_CASE(passes_later_element_first)
+{
+    struct Entry {
+        int key;
+        int original_index;
+    };
+
+    Vector<Entry> entries;
+    for (int i = 0; i < 300; ++i)
+        entries.append({ (300 - i) % 13, i });
+
+    // Elements only move when they compare less than an earlier one, so the later element is the one that came from further right.
+    bool arguments_in_order = true;
+    Vector<Entry> buffer;
+    merge_sort(entries, buffer, [&](auto& later, auto& earlier) {
+        if (later.key == earlier.key && later.original_index < earlier.original_index)
+            arguments_in_order = false;
+        return later.key < earlier.key;
+    });
+    EXPECT(arguments_in_order);
+
+    for (size_t i = 1; i < entries.size(); ++i)
+        EXPECT(entries[i - 1].key <= entries[i].key);
+}
+
+TEST_CASE(sorts_without_copy)
+{
+    struct NoCopy {
+        AK_MAKE_NONCOPYABLE(NoCopy);
+
+    public:
+        NoCopy() = default;
+        NoCopy(NoCopy&&) = default;
+
+        NoCopy& operator=(NoCopy&&) = default;
+
+        int value { 0 };
+    };
+
+    Vector<NoCopy> values;
+    for (int i = 0; i < 100; ++i) {
+        NoCopy value;
+        value.value = (100 - i) % 32;
+        values.append(move(value));
+    }
+
+    merge_sort(values, [](auto& a, auto& b) { return a.value < b.value; });
+
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1].value <= values[i].value);
+}
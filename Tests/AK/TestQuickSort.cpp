@@ -10,6 +10,7 @@
 #include <AK/Noncopyable.h>
 #include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
 
 TEST_CASE(sorts_without_copy)
 {
@@ -98,3 +99,31 @@ TEST_CASE(maximum_stack_depth)
 
     delete[] data;
 }
+
+TEST_CASE(pattern_defeating_quick_sort)
+{
+    const size_t size = 10000;
+    Vector<int> data;
+
+    // Sorted, reversed, organ pipe, all equal and only a few distinct values are the usual ways to make a quick sort go quadratic.
+    auto check = [&](auto generator) {
+        data.clear();
+        for (size_t i = 0; i < size; ++i)
+            data.append(generator(i));
+        size_t comparisons = 0;
+        AK::pattern_defeating_quick_sort(data, 0, data.size(), [&](int a, int b) {
+            ++comparisons;
+            return a < b;
+        });
+        for (size_t i = 1; i < size; ++i)
+            EXPECT(data[i - 1] <= data[i]);
+        EXPECT(comparisons < size * 64);
+    };
+
+    check([](size_t i) { return static_cast<int>(i); });
+    check([](size_t i) { return static_cast<int>(size - i); });
+    check([](size_t i) { return static_cast<int>(i < size / 2 ? i : size - i); });
+    check([](size_t) { return 42; });
+    check([](size_t i) { return static_cast<int>(i % 3); });
+    check([](size_t i) { return static_cast<int>((i * 7919) % size); });
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/SPSCRing.h>
+#include <AK/String.h>
+
+TEST_CASE(construct)
+{
+    SPSCRing<int, 4> ring;
+    EXPECT(ring.is_empty());
+    EXPECT(!ring.is_full());
+    EXPECT_EQ(ring.size(), 0u);
+    EXPECT_EQ(ring.capacity(), 4u);
+    EXPECT(!ring.try_dequeue().has_value());
+}
+
+TEST_CASE(fill_and_drain)
+{
+    SPSCRing<int, 4> ring;
+    for (int i = 0; i < 4; ++i)
+        EXPECT(ring.try_enqueue(i));
+    EXPECT(ring.is_full());
+    EXPECT(!ring.try_enqueue(4));
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(ring.try_dequeue().value(), i);
+    EXPECT(ring.is_empty());
+    EXPECT(!ring.try_dequeue().has_value());
+}
+
+TEST_CASE(wrap_around)
+{
+    SPSCRing<int, 4> ring;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT(ring.try_enqueue(i));
+        EXPECT(ring.try_enqueue(i + 1000));
+        EXPECT_EQ(ring.try_dequeue().value(), i);
+        EXPECT_EQ(ring.try_dequeue().value(), i + 1000);
+    }
+    EXPECT(ring.is_empty());
+}
+
+TEST_CASE(non_trivial_values)
+{
+    SPSCRing<String, 2> ring;
+    EXPECT(ring.try_enqueue(String("foo")));
+    EXPECT(ring.try_enqueue(String("bar")));
+    EXPECT(!ring.try_enqueue(String("baz")));
+    EXPECT_EQ(ring.try_dequeue().value(), "foo");
+    EXPECT(ring.try_enqueue(String("baz")));
+    EXPECT_EQ(ring.try_dequeue().value(), "bar");
+    EXPECT_EQ(ring.try_dequeue().value(), "baz");
+}
@@ -271,3 +271,47 @@ TEST_CASE(find)
     EXPECT_EQ(a.find('b', 4), Optional<size_t> { 6 });
     EXPECT_EQ(a.find('b', 9), Optional<size_t> {});
 }
+
+TEST_CASE(single_characters_are_shared)
+{
+    String a = "x";
+    String b("xyz", 1);
+    EXPECT_EQ(a.impl(), b.impl());
+    EXPECT_EQ(a, "x");
+
+    FlyString fly_a = a;
+    FlyString fly_b = "x"sv;
+    EXPECT_EQ(fly_a, fly_b);
+    EXPECT_EQ(fly_a.impl(), a.impl());
+    EXPECT_EQ(fly_a, "x"sv);
+    EXPECT_NE(fly_a, "y"sv);
+    EXPECT_NE(fly_a, String("y"));
+}
+
+BENCHMARK_CASE(benchmark_string_builder)
+{
+    for (int run = 0; run < 100; ++run) {
+        StringBuilder builder;
+        for (int i = 0; i < 10'000; ++i)
+            builder.appendff("{} ", i);
+        EXPECT_EQ(builder.to_string().length(), 48890u);
+    }
+}
+
+BENCHMARK_CASE(benchmark_compare_and_hash)
+{
+    Vector<String> strings;
+    for (int i = 0; i < 10'000; ++i)
+        strings.append(String::formatted("some fairly long string number {}", i));
+
+    size_t equal_count = 0;
+    unsigned hash = 0;
+    for (int run = 0; run < 100; ++run) {
+        for (size_t i = 1; i < strings.size(); ++i) {
+            equal_count += strings[i] == strings[i - 1];
+            hash ^= String(strings[i].view()).hash();
+        }
+    }
+    EXPECT_EQ(equal_count, 0u);
+    (void)hash;
+}
@@ -182,3 +182,33 @@ TEST_CASE(decode_invalid_ut8)
         VERIFY(i == expected_size);
     }
 }
+
+TEST_CASE(bulk_decode)
+{
+    Utf8View view("Some weird characters ©♪ꝕ and a \U0001F600 too");
+    Vector<u32> code_points;
+    view.append_code_points_to(code_points);
+    Vector<u32> expected;
+    for (auto code_point : view)
+        expected.append(code_point);
+    EXPECT_EQ(code_points, expected);
+    EXPECT_EQ(code_points.size(), view.length());
+
+    Vector<u16> code_units;
+    view.append_utf16_code_units_to(code_units);
+    EXPECT_EQ(code_units.size(), expected.size() + 1);
+    EXPECT_EQ(code_units[22], 0x00A9);
+    EXPECT_EQ(code_units[32], 0xD83D);
+    EXPECT_EQ(code_units[33], 0xDE00);
+    EXPECT_EQ(code_units.last(), 'o');
+
+    char invalid_utf8[] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', (char)0xA0, 'j', 0 };
+    code_points.clear();
+    Utf8View { invalid_utf8 }.append_code_points_to(code_points);
+    EXPECT_EQ(code_points.size(), 11u);
+    EXPECT_EQ(code_points[9], 0xFFFDu);
+    EXPECT_EQ(Utf8View { invalid_utf8 }.length(), 11u);
+    size_t valid_bytes;
+    EXPECT(!Utf8View { invalid_utf8 }.validate(valid_bytes));
+    EXPECT_EQ(valid_bytes, 9u);
+}
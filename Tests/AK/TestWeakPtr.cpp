@@ -64,3 +64,27 @@ TEST_CASE(weakptr_move)
 
     EXPECT_EQ(weak2.is_null(), true);
 }
+
+class NonAtomicWeakable : public Weakable<NonAtomicWeakable>
+    , public RefCounted<NonAtomicWeakable, RefCountPolicy::NonAtomic> {
+};
+
+TEST_CASE(non_atomic_ref_count)
+{
+    WeakPtr<NonAtomicWeakable> weak;
+
+    {
+        auto object = adopt_ref(*new NonAtomicWeakable);
+        weak = object;
+        EXPECT_EQ(object->ref_count(), 1u);
+        {
+            auto strong = weak.strong_ref();
+            EXPECT_EQ(strong.ptr(), object.ptr());
+            EXPECT_EQ(object->ref_count(), 2u);
+        }
+        EXPECT_EQ(object->ref_count(), 1u);
+    }
+
+    EXPECT_EQ(weak.is_null(), true);
+    EXPECT_EQ(weak.strong_ref().ptr(), nullptr);
+}
@@ -16,3 +16,90 @@ TEST_CASE(strerror_r_basic)
     EXPECT_EQ(strerror_r(EFAULT, buf, sizeof(buf)), 0);
     EXPECT_EQ(strcmp(buf, "Bad address"), 0);
 }
+
+// The string functions handle the bytes before the first aligned word and after the last one separately,
+// so these check every combination of starting offset and length within a few words.
+static constexpr size_t max_test_string_length = 64;
+static constexpr size_t max_test_string_offset = 16;
+
+TEST_CASE(strlen_all_offsets_and_lengths)
+{
+    char buffer[max_test_string_offset + max_test_string_length + 1];
+    for (size_t offset = 0; offset < max_test_string_offset; ++offset) {
+        for (size_t length = 0; length < max_test_string_length; ++length) {
+            memset(buffer, 'a', sizeof(buffer));
+            buffer[offset + length] = '\0';
+            EXPECT_EQ(strlen(buffer + offset), length);
+        }
+    }
+}
+
+TEST_CASE(strchr_all_offsets_and_lengths)
+{
+    char buffer[max_test_string_offset + max_test_string_length + 1];
+    for (size_t offset = 0; offset < max_test_string_offset; ++offset) {
+        for (size_t length = 0; length < max_test_string_length; ++length) {
+            memset(buffer, 'a', sizeof(buffer));
+            buffer[offset + length] = '\0';
+            EXPECT_EQ(strchr(buffer + offset, 'b'), nullptr);
+            EXPECT_EQ(strchr(buffer + offset, '\0'), buffer + offset + length);
+            if (length == 0)
+                continue;
+            buffer[offset + length - 1] = 'b';
+            EXPECT_EQ(strchr(buffer + offset, 'b'), buffer + offset + length - 1);
+            buffer[offset] = 'b';
+            EXPECT_EQ(strchr(buffer + offset, 'b'), buffer + offset);
+        }
+    }
+
+    // The character being looked for is converted to char, like the string's bytes.
+    char high_bytes[] = { 'a', (char)0xe9, 'b', '\0' };
+    EXPECT_EQ(strchr(high_bytes, 0xe9), high_bytes + 1);
+}
+
+TEST_CASE(memchr_all_offsets_and_lengths)
+{
+    char buffer[max_test_string_offset + max_test_string_length + 1];
+    for (size_t offset = 0; offset < max_test_string_offset; ++offset) {
+        for (size_t length = 0; length < max_test_string_length; ++length) {
+            memset(buffer, 'a', sizeof(buffer));
+            // Right after the end, so that looking at it would be a bug.
+            buffer[offset + length] = 'b';
+            EXPECT_EQ(memchr(buffer + offset, 'b', length), nullptr);
+            if (length == 0)
+                continue;
+            buffer[offset + length - 1] = 'b';
+            EXPECT_EQ(memchr(buffer + offset, 'b', length), buffer + offset + length - 1);
+            buffer[offset] = '\0';
+            EXPECT_EQ(memchr(buffer + offset, '\0', length), buffer + offset);
+        }
+    }
+}
+
+TEST_CASE(memcmp_all_offsets_and_lengths)
+{
+    u8 buffer1[max_test_string_offset + max_test_string_length];
+    u8 buffer2[max_test_string_offset + max_test_string_length];
+    for (size_t offset = 0; offset < max_test_string_offset; ++offset) {
+        for (size_t length = 0; length < max_test_string_length; ++length) {
+            for (size_t i = 0; i < sizeof(buffer1); ++i)
+                buffer1[i] = buffer2[i] = i;
+            // The second buffer is out of step with the first one, so that both can't be aligned at the same time.
+            auto* s1 = buffer1 + offset;
+            auto* s2 = buffer2 + (max_test_string_offset - 1 - offset);
+            memcpy(s2, s1, length);
+            EXPECT_EQ(memcmp(s1, s2, length), 0);
+            for (size_t difference = 0; difference < length; ++difference) {
+                s2[difference] = s1[difference] + 1;
+                EXPECT(memcmp(s1, s2, length) < 0);
+                EXPECT(memcmp(s2, s1, length) > 0);
+                s2[difference] = s1[difference];
+            }
+        }
+    }
+
+    // Bytes are compared as unsigned.
+    u8 low[] = { 0x01 };
+    u8 high[] = { 0x80 };
+    EXPECT(memcmp(low, high, 1) < 0);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/Random.h>
+#include <AK/Time.h>
+#include <LibCrypto/Checksum/Adler32.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <time.h>
+
+// The textbook versions, one bit (or byte) at a time, to check the fast paths against.
+static u32 reference_crc32(ReadonlyBytes data)
+{
+    u32 state = ~0u;
+    for (auto byte : data) {
+        state ^= byte;
+        for (size_t i = 0; i < 8; ++i)
+            state = (state & 1) ? 0xEDB88320 ^ (state >> 1) : state >> 1;
+    }
+    return ~state;
+}
+
+static u32 reference_adler32(ReadonlyBytes data)
+{
+    u32 a = 1;
+    u32 b = 0;
+    for (auto byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+TEST_CASE(checksums_match_reference)
+{
+    auto buffer = ByteBuffer::create_uninitialized(20000);
+    fill_with_random(buffer.data(), buffer.size());
+
+    // Lengths around every block size the fast paths use, at every alignment within a 16-byte vector.
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t length : { 0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 79, 80, 127, 128, 1000, 5551, 5552, 5553, 11104, 19000 }) {
+            auto data = buffer.bytes().slice(offset, length);
+            EXPECT_EQ(Crypto::Checksum::CRC32(data).digest(), reference_crc32(data));
+            EXPECT_EQ(Crypto::Checksum::Adler32(data).digest(), reference_adler32(data));
+
+            Crypto::Checksum::CRC32 crc32;
+            crc32.update(data.slice(0, length / 3));
+            crc32.update(data.slice(length / 3));
+            EXPECT_EQ(crc32.digest(), reference_crc32(data));
+        }
+    }
+}
+
+TEST_CASE(adler32_does_not_overflow)
+{
+    // All 0xff is the worst case for the sums that are only reduced every few thousand bytes.
+    auto buffer = ByteBuffer::create_uninitialized(100000);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = 0xff;
+    EXPECT_EQ(Crypto::Checksum::Adler32(buffer).digest(), reference_adler32(buffer));
+}
+
+template<typename Checksum>
+static void benchmark_checksum(StringView name)
+{
+    auto buffer = ByteBuffer::create_uninitialized(256 * MiB);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = i * 7;
+
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    auto digest = Checksum(buffer).digest();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    auto elapsed = Time::from_timespec(end) - Time::from_timespec(start);
+    auto microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    warnln("{}: {} bytes in {} ms, {} MB/s (digest {:08x})", name, buffer.size(), elapsed.to_milliseconds(), buffer.size() / microseconds, digest);
+}
+
+BENCHMARK_CASE(crc32)
+{
+    benchmark_checksum<Crypto::Checksum::CRC32>("CRC32");
+}
+
+BENCHMARK_CASE(adler32)
+{
+    benchmark_checksum<Crypto::Checksum::Adler32>("Adler32");
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/Time.h>
+#include <LibCompress/Deflate.h>
+#include <time.h>
+
+// Something that compresses about as well as text does: words from a small vocabulary, picked by a fixed LCG,
+// so that every run compresses exactly the same data.
+static ByteBuffer generate_text(size_t size)
+{
+    static constexpr const char* words[] = {
+        "the", "of", "and", "to", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on", "not",
+        "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had", "they", "you", "were",
+        "compression", "window", "block", "huffman", "symbol", "literal", "distance", "length", "stream", "buffer",
+    };
+    static constexpr size_t word_count = sizeof(words) / sizeof(words[0]);
+
+    auto text = ByteBuffer::create_uninitialized(size);
+    u32 state = 1;
+    size_t offset = 0;
+    while (offset < size) {
+        state = state * 1103515245 + 12345;
+        StringView word { words[(state >> 16) % word_count] };
+        for (size_t i = 0; i < word.length() && offset < size; i++)
+            text[offset++] = word[i];
+        if (offset < size)
+            text[offset++] = ((state >> 8) % 16) == 0 ? '\n' : ' ';
+    }
+    return text;
+}
+
+static void benchmark_level(StringView name, Compress::DeflateCompressor::CompressionLevel level)
+{
+    auto text = generate_text(4 * MiB);
+
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    auto compressed = Compress::DeflateCompressor::compress_all(text, level);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    EXPECT(compressed.has_value());
+
+    auto elapsed = Time::from_timespec(end) - Time::from_timespec(start);
+    auto microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    auto ratio = (double)compressed.value().size() / text.size();
+    warnln("{}: {} -> {} bytes ({}%) in {} ms, {} MB/s", name, text.size(), compressed.value().size(), (int)(ratio * 100), elapsed.to_milliseconds(), text.size() / microseconds);
+
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == text);
+}
+
+BENCHMARK_CASE(deflate_level_1)
+{
+    benchmark_level("level 1", Compress::DeflateCompressor::CompressionLevel::FAST);
+}
+
+BENCHMARK_CASE(deflate_level_3)
+{
+    benchmark_level("level 3", static_cast<Compress::DeflateCompressor::CompressionLevel>(3));
+}
+
+BENCHMARK_CASE(deflate_level_4)
+{
+    benchmark_level("level 4", static_cast<Compress::DeflateCompressor::CompressionLevel>(4));
+}
+
+BENCHMARK_CASE(deflate_level_6)
+{
+    benchmark_level("level 6", Compress::DeflateCompressor::CompressionLevel::GOOD);
+}
+
+BENCHMARK_CASE(deflate_level_9)
+{
+    benchmark_level("level 9", Compress::DeflateCompressor::CompressionLevel::GREAT);
+}
+
+BENCHMARK_CASE(inflate)
+{
+    auto text = generate_text(4 * MiB);
+    auto compressed = Compress::DeflateCompressor::compress_all(text, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(compressed.has_value());
+
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == text);
+
+    auto elapsed = Time::from_timespec(end) - Time::from_timespec(start);
+    auto microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    warnln("inflate: {} -> {} bytes in {} ms, {} MB/s", compressed.value().size(), text.size(), elapsed.to_milliseconds(), text.size() / microseconds);
+}
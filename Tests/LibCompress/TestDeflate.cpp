@@ -154,3 +154,59 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(compressed.has_value());
 }
+
+TEST_CASE(deflate_round_trip_all_levels)
+{
+    // Half random and half repeats of what came before, spread across more than one block
+    auto size = Compress::DeflateCompressor::block_size * 3;
+    auto original = ByteBuffer::create_uninitialized(size);
+    fill_with_random(original.data(), 1024);
+    for (size_t i = 1024; i < size; i += 1024) {
+        auto length = min<size_t>(1024, size - i);
+        if ((i / 1024) % 2)
+            fill_with_random(original.data() + i, length);
+        else
+            memcpy(original.data() + i, original.data() + get_random_uniform(i - 1024), length);
+    }
+
+    for (int level = 0; level <= 10; ++level) {
+        auto compressed = Compress::DeflateCompressor::compress_all(original, static_cast<Compress::DeflateCompressor::CompressionLevel>(level));
+        EXPECT(compressed.has_value());
+        auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+        EXPECT(uncompressed.has_value());
+        EXPECT(uncompressed.value() == original);
+    }
+}
+
+TEST_CASE(deflate_compress_across_blocks)
+{
+    // The second block is a copy of the first one, so it should turn into back references into the first one
+    auto size = Compress::DeflateCompressor::block_size;
+    auto original = ByteBuffer::create_uninitialized(size * 2);
+    fill_with_random(original.data(), size);
+    memcpy(original.data() + size, original.data(), size);
+
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+    EXPECT(compressed.value().size() < size + size / 8);
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(deflate_round_trip_dictionary)
+{
+    auto dictionary = ByteBuffer::create_uninitialized(4096);
+    fill_with_random(dictionary.data(), dictionary.size());
+    auto original = ByteBuffer::create_uninitialized(1024);
+    memcpy(original.data(), dictionary.data() + 1000, 1024);
+
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::CompressionLevel::GOOD }) {
+        auto compressed = Compress::DeflateCompressor::compress_all(original, level, dictionary);
+        EXPECT(compressed.has_value());
+        EXPECT(compressed.value().size() < 64);
+        auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value(), dictionary);
+        EXPECT(uncompressed.has_value());
+        EXPECT(uncompressed.value() == original);
+    }
+}
@@ -7,8 +7,10 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/Array.h>
+#include <AK/MemoryStream.h>
 #include <AK/Random.h>
 #include <LibCompress/Gzip.h>
+#include <cstring>
 
 TEST_CASE(gzip_decompress_simple)
 {
@@ -95,3 +97,34 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.has_value());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_chunks)
+{
+    // The way gzip -j puts a member together from chunks that were compressed separately
+    auto original = ByteBuffer::create_uninitialized(3 * 1024);
+    fill_with_random(original.data(), 1024);
+    memcpy(original.data() + 1024, original.data(), 1024);
+    fill_with_random(original.data() + 2048, 1024);
+    auto first = original.bytes().slice(0, 1500);
+    auto second = original.bytes().slice(1500);
+
+    DuplexMemoryStream output_stream;
+    Compress::GzipCompressor::write_header(output_stream);
+    {
+        Compress::DeflateCompressor compressor { output_stream };
+        compressor.write_or_error(first);
+        compressor.final_sync_flush();
+    }
+    {
+        Compress::DeflateCompressor compressor { output_stream };
+        compressor.set_dictionary(first);
+        compressor.write_or_error(second);
+        compressor.final_flush();
+    }
+    auto crc32 = Crypto::Checksum::CRC32::combine(Crypto::Checksum::CRC32 { first }.digest(), Crypto::Checksum::CRC32 { second }.digest(), second.size());
+    Compress::GzipCompressor::write_trailer(output_stream, crc32, original.size());
+
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(output_stream.copy_into_contiguous_buffer());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
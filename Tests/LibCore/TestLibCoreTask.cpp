@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/AsyncIO.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Task.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+static Core::Task<int> add_after_sleeping(int a, int b)
+{
+    co_await Core::sleep_for(10);
+    co_return a + b;
+}
+
+TEST_CASE(task_returns_value)
+{
+    auto event_loop = Core::EventLoop();
+    int result = 0;
+    // NOTE: The lambda has to outlive the coroutine, since that's where its captures live.
+    auto body = [&]() -> Core::Task<void> {
+        result = co_await add_after_sleeping(1, 2);
+        event_loop.quit(0);
+    };
+    auto task = body();
+    EXPECT(!task.is_done());
+    event_loop.exec();
+    EXPECT(task.is_done());
+    EXPECT_EQ(result, 3);
+}
+
+TEST_CASE(dropped_task_keeps_running)
+{
+    auto event_loop = Core::EventLoop();
+    bool finished = false;
+    auto body = [&]() -> Core::Task<void> {
+        co_await Core::sleep_for(0);
+        finished = true;
+        event_loop.quit(0);
+    };
+    body();
+    event_loop.exec();
+    EXPECT(finished);
+}
+
+TEST_CASE(wait_for_fd_with_timeout)
+{
+    auto event_loop = Core::EventLoop();
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+
+    Vector<bool> results;
+    auto body = [&]() -> Core::Task<void> {
+        results.append(co_await Core::readable(fds[0], 10));
+        EXPECT_EQ(write(fds[1], "x", 1), 1);
+        results.append(co_await Core::readable(fds[0], 1000));
+        event_loop.quit(0);
+    };
+    body();
+    event_loop.exec();
+
+    EXPECT_EQ(results.size(), 2u);
+    EXPECT(!results[0]);
+    EXPECT(results[1]);
+    close(fds[0]);
+    close(fds[1]);
+}
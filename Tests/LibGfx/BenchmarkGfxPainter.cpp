@@ -51,3 +51,33 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(blit)
+{
+    const int run_count = 1000;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    source->fill(Color::Blue);
+    Gfx::Painter painter(*bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    source->fill(Color(0, 0, 255, 128));
+    Gfx::Painter painter(*bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect(), 0.5f);
+    }
+}
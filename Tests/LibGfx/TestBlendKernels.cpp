@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibGfx/BlendKernels.h>
+#include <stdlib.h>
+
+static constexpr size_t row_length = 37;
+
+static u8 random_alpha()
+{
+    // Make sure the special cases in Color::blend() get plenty of coverage.
+    switch (rand() % 4) {
+    case 0:
+        return 0;
+    case 1:
+        return 255;
+    default:
+        return rand();
+    }
+}
+
+static RGBA32 random_pixel()
+{
+    return (random_alpha() << 24) | (rand() & 0xffffff);
+}
+
+TEST_CASE(blend_row_matches_color_blend)
+{
+    srand(0);
+    u8 alpha_map[256];
+    for (auto& alpha : alpha_map)
+        alpha = rand();
+
+    for (int run = 0; run < 1000; ++run) {
+        bool destination_is_opaque = run % 2;
+        const u8* source_alpha_map = (run / 2) % 2 ? alpha_map : nullptr;
+
+        RGBA32 dst[row_length];
+        RGBA32 src[row_length];
+        RGBA32 expected[row_length];
+        for (size_t i = 0; i < row_length; ++i) {
+            dst[i] = random_pixel();
+            src[i] = random_pixel();
+            auto source_color = Color::from_rgba(src[i]);
+            if (source_alpha_map)
+                source_color.set_alpha(source_alpha_map[source_color.alpha()]);
+            auto destination_color = destination_is_opaque ? Color::from_rgb(dst[i]) : Color::from_rgba(dst[i]);
+            expected[i] = destination_color.blend(source_color).value();
+        }
+
+        Gfx::blend_row(dst, src, row_length, source_alpha_map, destination_is_opaque);
+        for (size_t i = 0; i < row_length; ++i)
+            EXPECT_EQ(dst[i], expected[i]);
+    }
+}
+
+TEST_CASE(blend_color_onto_row_matches_color_blend)
+{
+    srand(0);
+    for (int run = 0; run < 1000; ++run) {
+        auto color = Color::from_rgba(random_pixel());
+        RGBA32 dst[row_length];
+        RGBA32 expected[row_length];
+        for (size_t i = 0; i < row_length; ++i) {
+            dst[i] = random_pixel();
+            expected[i] = Color::from_rgba(dst[i]).blend(color).value();
+        }
+
+        Gfx::blend_color_onto_row(dst, row_length, color);
+        for (size_t i = 0; i < row_length; ++i)
+            EXPECT_EQ(dst[i], expected[i]);
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/StringView.h>
+#include <LibHTTP/HPACK.h>
+
+using HTTP::HPACK::Header;
+
+static ByteBuffer from_hex(const StringView& hex)
+{
+    auto digit = [](char ch) -> u8 {
+        return ch <= '9' ? ch - '0' : ch - 'a' + 10;
+    };
+    VERIFY(hex.length() % 2 == 0);
+    auto buffer = ByteBuffer::create_uninitialized(hex.length() / 2);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = (digit(hex[2 * i]) << 4) | digit(hex[2 * i + 1]);
+    return buffer;
+}
+
+static void expect_headers(const Optional<Vector<Header>>& headers, const Vector<Header>& expected)
+{
+    EXPECT(headers.has_value());
+    if (!headers.has_value())
+        return;
+    EXPECT_EQ(headers.value().size(), expected.size());
+    for (size_t i = 0; i < min(headers.value().size(), expected.size()); ++i) {
+        EXPECT_EQ(headers.value()[i].name, expected[i].name);
+        EXPECT_EQ(headers.value()[i].value, expected[i].value);
+    }
+}
+
+TEST_CASE(huffman)
+{
+    ByteBuffer encoded;
+    HTTP::HPACK::huffman_encode("www.example.com", encoded);
+    EXPECT(encoded.bytes() == from_hex("f1e3c2e5f23a6ba0ab90f4ff").bytes());
+    EXPECT_EQ(HTTP::HPACK::huffman_encoded_length("www.example.com"), 12u);
+    EXPECT_EQ(HTTP::HPACK::huffman_decode(encoded).value(), "www.example.com");
+
+    String all_bytes;
+    {
+        auto buffer = ByteBuffer::create_uninitialized(256);
+        for (size_t i = 0; i < 256; ++i)
+            buffer[i] = i;
+        all_bytes = String::copy(buffer);
+    }
+    encoded.clear();
+    HTTP::HPACK::huffman_encode(all_bytes, encoded);
+    EXPECT_EQ(HTTP::HPACK::huffman_decode(encoded).value(), all_bytes);
+}
+
+TEST_CASE(huffman_invalid)
+{
+    // Padding that isn't the start of EOS
+    EXPECT(!HTTP::HPACK::huffman_decode(from_hex("00")).has_value());
+    // More than 7 bits of padding
+    EXPECT(!HTTP::HPACK::huffman_decode(from_hex("1fff")).has_value());
+    // EOS itself
+    EXPECT(!HTTP::HPACK::huffman_decode(from_hex("ffffffff")).has_value());
+}
+
+// RFC 7541 appendix C.4
+TEST_CASE(decode_requests)
+{
+    HTTP::HPACK::Decoder decoder;
+    expect_headers(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } });
+    EXPECT_EQ(decoder.table().size(), 57u);
+
+    expect_headers(decoder.decode(from_hex("828684be5886a8eb10649cbf")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } });
+    EXPECT_EQ(decoder.table().size(), 110u);
+
+    expect_headers(decoder.decode(from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf")),
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } });
+    EXPECT_EQ(decoder.table().size(), 164u);
+    EXPECT_EQ(decoder.table().entry_count(), 3u);
+    EXPECT_EQ(decoder.table().entry(0).name, "custom-key");
+}
+
+// RFC 7541 appendix C.6, where the table is so small that entries get evicted.
+TEST_CASE(decode_responses)
+{
+    HTTP::HPACK::Decoder decoder(256);
+    expect_headers(decoder.decode(from_hex("488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3")),
+        { { ":status", "302" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.table().size(), 222u);
+
+    expect_headers(decoder.decode(from_hex("4883640effc1c0bf")),
+        { { ":status", "307" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.table().size(), 222u);
+
+    expect_headers(decoder.decode(from_hex("88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b1063d5007")),
+        { { ":status", "200" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:22 GMT" }, { "location", "https://www.example.com" }, { "content-encoding", "gzip" }, { "set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1" } });
+    EXPECT_EQ(decoder.table().size(), 215u);
+    EXPECT_EQ(decoder.table().entry_count(), 3u);
+}
+
+TEST_CASE(decode_invalid)
+{
+    // Index 0, and an index past the end of the (empty) dynamic table
+    EXPECT(!HTTP::HPACK::Decoder().decode(from_hex("80")).has_value());
+    EXPECT(!HTTP::HPACK::Decoder().decode(from_hex("be")).has_value());
+    // An integer that doesn't fit into 32 bits
+    EXPECT(!HTTP::HPACK::Decoder().decode(from_hex("ffffffffff7f")).has_value());
+    // A string that is longer than the rest of the block
+    EXPECT(!HTTP::HPACK::Decoder().decode(from_hex("400a6b6579")).has_value());
+    // A table size update beyond what we allow, and one after the first header
+    EXPECT(!HTTP::HPACK::Decoder(256).decode(from_hex("3fe11f")).has_value());
+    EXPECT(!HTTP::HPACK::Decoder().decode(from_hex("8220")).has_value());
+    EXPECT(HTTP::HPACK::Decoder().decode(from_hex("2082")).has_value());
+}
+
+TEST_CASE(encode_round_trip)
+{
+    HTTP::HPACK::Encoder encoder;
+    HTTP::HPACK::Decoder decoder;
+
+    Vector<Header> headers {
+        { ":method", "GET" },
+        { ":scheme", "https" },
+        { ":authority", "www.example.com" },
+        { ":path", "/some/where?with=query" },
+        { "user-agent", "Mozilla/4.0 (SerenityOS; x86_64) LibWeb+LibJS (Not KHTML, nor Gecko) LibWeb" },
+        { "accept", "*/*" },
+        { "authorization", "Basic c2VyZW5pdHk6b3M=" },
+    };
+
+    ByteBuffer first_block;
+    encoder.encode(headers, first_block);
+    expect_headers(decoder.decode(first_block), headers);
+
+    // Everything but the path and the credentials comes out of the tables the second time around.
+    headers[3].value = "/some/where/else";
+    ByteBuffer second_block;
+    encoder.encode(headers, second_block);
+    expect_headers(decoder.decode(second_block), headers);
+    EXPECT(second_block.size() < first_block.size() / 2);
+    EXPECT_EQ(encoder.table().size(), decoder.table().size());
+
+    // The decoder has to learn that the table shrank before the encoder relies on it.
+    encoder.set_max_table_size(64);
+    ByteBuffer third_block;
+    encoder.encode(headers, third_block);
+    EXPECT_EQ(third_block[0] & 0xe0, 0x20);
+    expect_headers(decoder.decode(third_block), headers);
+    EXPECT_EQ(encoder.table().size(), decoder.table().size());
+    EXPECT(decoder.table().size() <= 64u);
+}
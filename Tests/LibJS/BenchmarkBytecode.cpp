@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PassManager.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+static void run_bytecode(StringView source, bool optimize)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+
+    auto unit = JS::Bytecode::Generator::generate(*program);
+    if (optimize)
+        JS::Bytecode::Interpreter::optimization_pipeline().perform(unit);
+
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.set_optimizations_enabled(optimize);
+    bytecode_interpreter.run(unit);
+    EXPECT(!vm->exception());
+}
+
+static constexpr char const* arithmetic_loop = R"(
+    let sum = 0;
+    for (let i = 0; i < 1000000; ++i)
+        sum = (sum + i * 3) % 1000003;
+)";
+
+static constexpr char const* function_calls = R"(
+    function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+    fib(22);
+)";
+
+static constexpr char const* property_access = R"(
+    let object = { a: 1, b: 2, c: 3 };
+    let array = [];
+    for (let i = 0; i < 100000; ++i) {
+        object.a = object.b + object.c;
+        array.push(object.a + i);
+    }
+)";
+
+BENCHMARK_CASE(arithmetic_loop)
+{
+    run_bytecode(arithmetic_loop, false);
+}
+
+BENCHMARK_CASE(arithmetic_loop_optimized)
+{
+    run_bytecode(arithmetic_loop, true);
+}
+
+BENCHMARK_CASE(function_calls)
+{
+    run_bytecode(function_calls, false);
+}
+
+BENCHMARK_CASE(function_calls_optimized)
+{
+    run_bytecode(function_calls, true);
+}
+
+BENCHMARK_CASE(property_access)
+{
+    run_bytecode(property_access, false);
+}
+
+BENCHMARK_CASE(property_access_optimized)
+{
+    run_bytecode(property_access, true);
+}
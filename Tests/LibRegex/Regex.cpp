@@ -563,6 +563,87 @@ TEST_CASE(ECMA262_match)
     }
 }
 
+TEST_CASE(ECMA262_search_starting_characters)
+{
+    struct _test {
+        const char* pattern;
+        const char* subject;
+        bool has_starting_characters;
+        Optional<size_t> column;
+    };
+    // clang-format off
+    const _test tests[] {
+        { "needle", "haystack with a needle", true, 16 },
+        { "n(ee)dle", "haystack with a needle", true, 16 },
+        { "[0-9]+", "abc 12 def 345", true, 4 },
+        { "\\d", "abcdef", true, {} },
+        { "(?:foo|bar)baz", "foobar barbaz", true, 7 },
+        { "x*y", "aaay", true, 3 },
+        { "\\bword", "a word", true, 2 },
+        { "x*", "aaa", false, 0 },
+        { "[^a]", "aab", false, 2 },
+        { ".b", "aab", false, 1 },
+        { "(?=b)b", "aab", false, 2 },
+    };
+    // clang-format on
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern, ECMAScriptFlags::Global);
+        EXPECT_EQ(re.parser_result.error, Error::NoError);
+        EXPECT_EQ(re.parser_result.starting_characters.has_value(), test.has_starting_characters);
+        auto result = re.match(test.subject);
+        EXPECT_EQ(result.success, test.column.has_value());
+        if (result.success)
+            EXPECT_EQ(result.matches.first().column, test.column.value());
+    }
+
+    // A global regex picks up where the previous match left off.
+    Regex<ECMA262> re("needle", ECMAScriptFlags::Global);
+    EXPECT_EQ(re.match("a needle, another needle").matches.first().column, 2u);
+    EXPECT_EQ(re.match("a needle, another needle").matches.first().column, 18u);
+    EXPECT_EQ(re.match("a needle, another needle").success, false);
+}
+
+TEST_CASE(ECMA262_simulation)
+{
+    EXPECT_EQ(Regex<ECMA262>("(a|b)+c").parser_result.needs_backtracking, false);
+    EXPECT_EQ(Regex<ECMA262>("(a|b)+\\1").parser_result.needs_backtracking, true);
+    EXPECT_EQ(Regex<ECMA262>("a(?=b)").parser_result.needs_backtracking, true);
+
+    // These take exponential time to fail when backtracking.
+    auto as = String::repeated('a', 40);
+    EXPECT_EQ(Regex<ECMA262>("(a|a)*b").match(as).success, false);
+    EXPECT_EQ(Regex<ECMA262>("^(a|aa)+$").match(String::formatted("{}b", as)).success, false);
+    EXPECT_EQ(Regex<ECMA262>("(a|a)*b", ECMAScriptFlags::Global).match(String::formatted("{}b", as)).success, true);
+
+    // The capture groups are the ones of the path that matched, not of the ones that were given up on.
+    Regex<ECMA262> re("(?:([^a]){1,2}|[a-c][ab]{1,2})b", ECMAScriptFlags::Global);
+    auto result = re.match("cbc");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.first().view, "cb");
+    EXPECT_EQ(result.capture_group_matches.first().first().view, "c");
+}
+
+TEST_CASE(ECMA262_optimizer)
+{
+    // A single-character alternation is just one compare with all the alternatives in it.
+    Regex<ECMA262> alternation("a|[x-z]|\\d");
+    EXPECT_EQ(alternation.parser_result.bytecode[0], (regex::ByteCodeValueType)regex::OpCodeId::Compare);
+    EXPECT_EQ(alternation.parser_result.bytecode[1], 3u);
+    EXPECT(alternation.match("y").success);
+    EXPECT(alternation.match("7").success);
+    EXPECT(!alternation.match("b").success);
+
+    // Runs of characters become strings, which have to keep matching the same as the characters did.
+    Regex<ECMA262> literal("foo|bar", ECMAScriptFlags::Global | ECMAScriptFlags::Insensitive);
+    auto result = literal.match("xxBARxFoO");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.first().view, "BAR");
+    result = literal.match("xxBARxFoO");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.first().view, "FoO");
+}
+
 TEST_CASE(replace)
 {
     struct _test {
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/String.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// A fresh, empty file in /tmp for a test to put a heap in. It's removed again, along with its write-ahead log, once the test is done.
+class ScratchFile {
+public:
+    ScratchFile()
+    {
+        auto fd = mkstemp(m_path);
+        VERIFY(fd >= 0);
+        close(fd);
+    }
+
+    ~ScratchFile()
+    {
+        unlink(m_path);
+        unlink(String::formatted("{}-wal", m_path).characters());
+    }
+
+    String path() const { return m_path; }
+
+private:
+    char m_path[32] = "/tmp/sql-test.XXXXXX";
+};
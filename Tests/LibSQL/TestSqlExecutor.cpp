@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "ScratchFile.h"
+#include <LibTest/TestCase.h>
+
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <LibSQL/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Executor.h>
+#include <LibSQL/Lexer.h>
+#include <LibSQL/Parser.h>
+
+namespace {
+
+class ScratchDatabase {
+public:
+    ScratchDatabase()
+        : m_database(SQL::Database::open(m_file.path()).release_value())
+    {
+    }
+
+    SQL::Database& database() { return *m_database; }
+
+private:
+    // NOTE: The database has to be closed before its file goes away, so it's declared after it.
+    ScratchFile m_file;
+    RefPtr<SQL::Database> m_database;
+};
+
+using ExecuteResult = AK::Result<SQL::ResultSet, String>;
+
+ExecuteResult execute(SQL::Database& database, StringView sql)
+{
+    auto parser = SQL::Parser(SQL::Lexer(sql));
+    auto statement = parser.next_statement();
+    if (parser.has_errors())
+        return parser.errors()[0].to_string();
+
+    SQL::Executor executor(database);
+    return executor.execute(*statement);
+}
+
+// The rows of a result, as "a, b" lines separated by "; ".
+String rows_of(SQL::Database& database, StringView sql)
+{
+    auto result = execute(database, sql);
+    if (result.is_error())
+        return String::formatted("error: {}", result.error());
+
+    StringBuilder builder;
+    for (size_t i = 0; i < result.value().rows.size(); ++i) {
+        if (i > 0)
+            builder.append("; ");
+        auto& row = result.value().rows[i];
+        for (size_t j = 0; j < row.size(); ++j) {
+            if (j > 0)
+                builder.append(", ");
+            builder.appendff("{}", row[j]);
+        }
+    }
+    return builder.to_string();
+}
+
+void create_employees(SQL::Database& database)
+{
+    EXPECT(!execute(database, "CREATE TABLE departments (id INTEGER, name TEXT);").is_error());
+    EXPECT(!execute(database, "INSERT INTO departments VALUES (1, 'Kernel'), (2, 'Userland'), (3, 'Ports');").is_error());
+
+    EXPECT(!execute(database, "CREATE TABLE employees (name TEXT, department INTEGER, salary REAL);").is_error());
+    EXPECT(!execute(database, "INSERT INTO employees VALUES ('ali', 1, 100), ('bo', 2, 80), ('cy', 2, 90), ('di', 1, 120), ('ed', NULL, 50);").is_error());
+}
+
+}
+
+TEST_CASE(create_insert_select)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+
+    EXPECT(!execute(database, "CREATE TABLE things (a INTEGER, b TEXT);").is_error());
+    EXPECT(execute(database, "CREATE TABLE things (a INTEGER);").is_error());
+    EXPECT(!execute(database, "CREATE TABLE IF NOT EXISTS things (a INTEGER);").is_error());
+
+    auto insert = execute(database, "INSERT INTO things VALUES (1, 'one'), (2, 'two');");
+    EXPECT(!insert.is_error());
+    EXPECT_EQ(insert.value().changed_row_count, 2u);
+    EXPECT(!execute(database, "INSERT INTO things (b) VALUES ('none');").is_error());
+    EXPECT(execute(database, "INSERT INTO things VALUES (1);").is_error());
+
+    auto select = execute(database, "SELECT * FROM things;");
+    EXPECT(!select.is_error());
+    EXPECT_EQ(select.value().column_names.size(), 2u);
+    EXPECT_EQ(select.value().column_names[0], "a");
+    EXPECT_EQ(rows_of(database, "SELECT * FROM things;"), "1, one; 2, two; NULL, none");
+
+    // Values are converted to the types of the columns.
+    EXPECT(!execute(database, "INSERT INTO things VALUES ('3', 4);").is_error());
+    EXPECT_EQ(rows_of(database, "SELECT a + 1, b || '!' FROM things WHERE rowid = 4;"), "4, 4!");
+
+    EXPECT(!execute(database, "DROP TABLE things;").is_error());
+    EXPECT(execute(database, "SELECT * FROM things;").is_error());
+    EXPECT(execute(database, "DROP TABLE things;").is_error());
+    EXPECT(!execute(database, "DROP TABLE IF EXISTS things;").is_error());
+}
+
+TEST_CASE(select_without_tables)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+
+    EXPECT_EQ(rows_of(database, "SELECT 1 + 2 * 3, (1 + 2) * 3, 7 / 2, 7.5 / 2, 7 % 3;"), "7, 9, 3, 3.75, 1");
+    EXPECT_EQ(rows_of(database, "SELECT 1 / 0, NULL + 1, 'a' || 'b';"), "NULL, NULL, ab");
+    EXPECT_EQ(rows_of(database, "SELECT 1 < 2 AND 2 < 3, NULL OR 1, NULL AND 0, NOT 1 = 2;"), "1, 1, 0, 1");
+}
+
+TEST_CASE(where_order_by_limit)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+    create_employees(database);
+
+    EXPECT_EQ(rows_of(database, "SELECT name FROM employees WHERE salary > 60 AND department = 1 OR name = 'ed';"), "ali; di; ed");
+    EXPECT_EQ(rows_of(database, "SELECT name FROM employees ORDER BY salary DESC;"), "di; ali; cy; bo; ed");
+    EXPECT_EQ(rows_of(database, "SELECT name, salary AS pay FROM employees ORDER BY pay LIMIT 2;"), "ed, 50; bo, 80");
+    EXPECT_EQ(rows_of(database, "SELECT name FROM employees ORDER BY 1 DESC LIMIT 2 OFFSET 1;"), "di; cy");
+    EXPECT_EQ(rows_of(database, "SELECT name FROM employees ORDER BY department NULLS LAST, name DESC;"), "di; ali; cy; bo; ed");
+    EXPECT_EQ(rows_of(database, "SELECT name FROM employees WHERE department IS NULL;").starts_with("error"), true);
+}
+
+TEST_CASE(group_by_and_aggregates)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+    create_employees(database);
+
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*), COUNT(department), SUM(salary), MIN(name), MAX(salary) FROM employees;"), "5, 4, 440, ali, 120");
+    EXPECT_EQ(rows_of(database, "SELECT department, COUNT(*), AVG(salary) FROM employees GROUP BY department ORDER BY department;"), "NULL, 1, 50; 1, 2, 110; 2, 2, 85");
+    EXPECT_EQ(rows_of(database, "SELECT department FROM employees GROUP BY department HAVING SUM(salary) > 100 ORDER BY SUM(salary);"), "2; 1");
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*) FROM employees WHERE salary > 1000;"), "0");
+
+    EXPECT(execute(database, "SELECT name, COUNT(*) FROM employees GROUP BY department;").is_error());
+    EXPECT(execute(database, "SELECT SUM(COUNT(*)) FROM employees;").is_error());
+    EXPECT(execute(database, "SELECT name FROM employees WHERE COUNT(*) > 1;").is_error());
+}
+
+TEST_CASE(joins)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+    create_employees(database);
+
+    EXPECT_EQ(rows_of(database, "SELECT e.name, d.name FROM employees e, departments d WHERE e.department = d.id ORDER BY e.name;"), "ali, Kernel; bo, Userland; cy, Userland; di, Kernel");
+    EXPECT_EQ(rows_of(database, "SELECT d.name, SUM(salary) FROM departments d, employees WHERE id = department GROUP BY d.name ORDER BY 2;"), "Userland, 170; Kernel, 220");
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*) FROM employees, departments;"), "15");
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*) FROM employees, departments WHERE department < id;"), "6");
+
+    EXPECT(execute(database, "SELECT name FROM employees, departments;").is_error());
+    EXPECT(execute(database, "SELECT missing FROM employees;").is_error());
+}
+
+TEST_CASE(distinct)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+    create_employees(database);
+
+    EXPECT_EQ(rows_of(database, "SELECT DISTINCT department FROM employees ORDER BY department;"), "NULL; 1; 2");
+    EXPECT_EQ(rows_of(database, "SELECT DISTINCT department FROM employees ORDER BY 1 DESC LIMIT 1;"), "2");
+    EXPECT(execute(database, "SELECT DISTINCT department FROM employees ORDER BY salary;").is_error());
+}
+
+TEST_CASE(many_rows)
+{
+    ScratchDatabase scratch;
+    auto& database = scratch.database();
+
+    // Enough rows to need several batches.
+    EXPECT(!execute(database, "CREATE TABLE numbers (n INTEGER);").is_error());
+    for (int i = 0; i < 50; ++i) {
+        StringBuilder builder;
+        builder.append("INSERT INTO numbers VALUES ");
+        for (int j = 0; j < 100; ++j) {
+            if (j > 0)
+                builder.append(", ");
+            builder.appendff("({})", i * 100 + j);
+        }
+        builder.append(';');
+        EXPECT(!execute(database, builder.string_view()).is_error());
+    }
+
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*), SUM(n), MAX(n) FROM numbers WHERE n % 2 = 0;"), "2500, 6247500, 4998");
+    EXPECT_EQ(rows_of(database, "SELECT n % 3, COUNT(*) FROM numbers GROUP BY n % 3 ORDER BY 1;"), "0, 1667; 1, 1667; 2, 1666");
+    EXPECT_EQ(rows_of(database, "SELECT n FROM numbers ORDER BY n DESC LIMIT 3 OFFSET 2000;"), "2999; 2998; 2997");
+    EXPECT_EQ(rows_of(database, "SELECT COUNT(*) FROM numbers a, numbers b WHERE a.n = b.n + 1;"), "4999");
+}
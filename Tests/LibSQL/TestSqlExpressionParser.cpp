@@ -236,6 +236,64 @@ TEST_CASE(binary_operator)
     }
 }
 
+TEST_CASE(operator_precedence)
+{
+    // Returns the operator at the root of the tree, and the one at the root of its left or right side.
+    auto validate = [](StringView sql, SQL::BinaryOperator expected_root, bool nested_on_left, SQL::BinaryOperator expected_nested) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::BinaryOperatorExpression>(*expression));
+
+        const auto& binary = static_cast<const SQL::BinaryOperatorExpression&>(*expression);
+        EXPECT_EQ(binary.type(), expected_root);
+
+        const auto& nested = nested_on_left ? binary.lhs() : binary.rhs();
+        EXPECT(is<SQL::BinaryOperatorExpression>(*nested));
+        EXPECT_EQ(static_cast<const SQL::BinaryOperatorExpression&>(*nested).type(), expected_nested);
+    };
+
+    validate("1 + 2 * 3", SQL::BinaryOperator::Plus, false, SQL::BinaryOperator::Multiplication);
+    validate("1 * 2 + 3", SQL::BinaryOperator::Plus, true, SQL::BinaryOperator::Multiplication);
+    validate("1 - 2 - 3", SQL::BinaryOperator::Minus, true, SQL::BinaryOperator::Minus);
+    validate("a = 1 AND b = 2", SQL::BinaryOperator::And, true, SQL::BinaryOperator::Equals);
+    validate("a OR b AND c", SQL::BinaryOperator::Or, false, SQL::BinaryOperator::And);
+    validate("a AND b OR c", SQL::BinaryOperator::Or, true, SQL::BinaryOperator::And);
+    validate("1 + 2 < 3 * 4", SQL::BinaryOperator::LessThan, true, SQL::BinaryOperator::Plus);
+
+    auto result = parse("NOT a = 1 AND b");
+    EXPECT(!result.is_error());
+    auto expression = result.release_value();
+    EXPECT(is<SQL::BinaryOperatorExpression>(*expression));
+    const auto& binary = static_cast<const SQL::BinaryOperatorExpression&>(*expression);
+    EXPECT_EQ(binary.type(), SQL::BinaryOperator::And);
+    EXPECT(is<SQL::UnaryOperatorExpression>(*binary.lhs()));
+}
+
+TEST_CASE(function_call_expression)
+{
+    EXPECT(parse("count(").is_error());
+    EXPECT(parse("count(,)").is_error());
+    EXPECT(parse("count(1,)").is_error());
+
+    auto validate = [](StringView sql, StringView expected_name, size_t expected_argument_count) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::FunctionCallExpression>(*expression));
+
+        const auto& call = static_cast<const SQL::FunctionCallExpression&>(*expression);
+        EXPECT_EQ(call.name(), expected_name);
+        EXPECT_EQ(call.arguments().size(), expected_argument_count);
+    };
+
+    validate("count(*)", "count", 0);
+    validate("sum(a)", "sum", 1);
+    validate("max(a + 1, b)", "max", 2);
+}
+
 TEST_CASE(chained_expression)
 {
     EXPECT(parse("()").is_error());
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "ScratchFile.h"
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/Endian.h>
+#include <AK/String.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/BufferPool.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/WriteAheadLog.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+ByteBuffer key_for(u64 row_id)
+{
+    BigEndian<u64> key = row_id;
+    return ByteBuffer::copy(&key, sizeof(key));
+}
+
+u64 row_id_of(ReadonlyBytes key)
+{
+    BigEndian<u64> row_id;
+    VERIFY(key.size() == sizeof(row_id));
+    memcpy(&row_id, key.data(), sizeof(row_id));
+    return row_id;
+}
+
+String value_for(u64 row_id)
+{
+    // Values of different sizes, so that nodes split at different places.
+    return String::formatted("row {} {}", row_id, String::repeated('x', row_id % 200));
+}
+
+String find(SQL::BTree& tree, u64 row_id)
+{
+    auto value = tree.find(key_for(row_id));
+    if (!value.has_value())
+        return {};
+    return String::copy(*value);
+}
+
+void copy_file(const String& from, const String& to, size_t bytes_to_drop = 0)
+{
+    auto from_fd = open(from.characters(), O_RDONLY);
+    VERIFY(from_fd >= 0);
+    auto size = lseek(from_fd, 0, SEEK_END);
+    VERIFY(size >= (off_t)bytes_to_drop);
+    auto data = ByteBuffer::create_uninitialized(size - bytes_to_drop);
+    VERIFY(pread(from_fd, data.data(), data.size(), 0) == (ssize_t)data.size());
+    close(from_fd);
+
+    auto to_fd = open(to.characters(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    VERIFY(to_fd >= 0);
+    VERIFY(write(to_fd, data.data(), data.size()) == (ssize_t)data.size());
+    close(to_fd);
+}
+
+// Copies the database file and its log as they are right now, as if the program had crashed.
+void copy_after_crash(const String& from, const String& to, size_t log_bytes_to_drop = 0)
+{
+    copy_file(from, to);
+    copy_file(String::formatted("{}-wal", from), String::formatted("{}-wal", to), log_bytes_to_drop);
+}
+
+size_t count_rows(SQL::BTree& tree)
+{
+    size_t count = 0;
+    for (auto it = tree.begin(); !it.is_end(); ++it)
+        ++count;
+    return count;
+}
+
+// Inserts the row IDs from 1 to count, in an order that is neither ascending nor descending.
+void fill(SQL::BTree& tree, u64 count)
+{
+    for (u64 i = 0; i < count; ++i) {
+        auto row_id = (i * 7919) % count + 1;
+        EXPECT(tree.insert(key_for(row_id), value_for(row_id).bytes()));
+    }
+}
+
+}
+
+TEST_CASE(insert_and_find)
+{
+    ScratchFile file;
+    auto heap = SQL::Heap::open(file.path()).release_value();
+    SQL::BufferPool pool(heap);
+    SQL::BTree tree(pool, SQL::BTree::create(pool));
+
+    fill(tree, 5000);
+    EXPECT(!tree.insert(key_for(42), value_for(42).bytes()));
+
+    for (u64 row_id = 1; row_id <= 5000; ++row_id) {
+        EXPECT_EQ(find(tree, row_id), value_for(row_id));
+    }
+    EXPECT(!tree.find(key_for(0)).has_value());
+    EXPECT(!tree.find(key_for(5001)).has_value());
+    EXPECT_EQ(row_id_of(tree.last_key().value()), 5000u);
+}
+
+TEST_CASE(iterate_in_key_order)
+{
+    ScratchFile file;
+    auto heap = SQL::Heap::open(file.path()).release_value();
+    SQL::BufferPool pool(heap);
+    SQL::BTree tree(pool, SQL::BTree::create(pool));
+
+    EXPECT(tree.begin().is_end());
+    fill(tree, 3000);
+
+    u64 expected = 1;
+    for (auto it = tree.begin(); !it.is_end(); ++it)
+        EXPECT_EQ(row_id_of(it.key()), expected++);
+    EXPECT_EQ(expected, 3001u);
+
+    auto it = tree.lower_bound(key_for(1234));
+    EXPECT_EQ(row_id_of(it.key()), 1234u);
+}
+
+TEST_CASE(remove_and_update)
+{
+    ScratchFile file;
+    auto heap = SQL::Heap::open(file.path()).release_value();
+    SQL::BufferPool pool(heap);
+    SQL::BTree tree(pool, SQL::BTree::create(pool));
+
+    fill(tree, 3000);
+    for (u64 row_id = 1; row_id <= 3000; row_id += 2)
+        EXPECT(tree.remove(key_for(row_id)));
+    EXPECT(!tree.remove(key_for(1)));
+
+    EXPECT(tree.update(key_for(2), "changed"sv.bytes()));
+    EXPECT(!tree.update(key_for(3), "changed"sv.bytes()));
+    EXPECT_EQ(find(tree, 2), "changed");
+
+    size_t count = 0;
+    for (auto it = tree.begin(); !it.is_end(); ++it) {
+        EXPECT_EQ(row_id_of(it.key()) % 2, 0u);
+        ++count;
+    }
+    EXPECT_EQ(count, 1500u);
+
+    // The pages of a destroyed tree are reused.
+    auto page_count = heap->page_count();
+    tree.destroy();
+    SQL::BTree other(pool, SQL::BTree::create(pool));
+    fill(other, 3000);
+    EXPECT_EQ(heap->page_count(), page_count);
+}
+
+TEST_CASE(small_buffer_pool)
+{
+    ScratchFile file;
+    auto heap = SQL::Heap::open(file.path()).release_value();
+    SQL::BufferPool pool(heap, 4);
+    SQL::BTree tree(pool, SQL::BTree::create(pool));
+
+    fill(tree, 5000);
+    EXPECT(pool.write_count() > 0);
+    for (u64 row_id = 1; row_id <= 5000; ++row_id)
+        EXPECT_EQ(find(tree, row_id), value_for(row_id));
+    EXPECT(pool.miss_count() > 0);
+    EXPECT(!pool.has_io_error());
+}
+
+TEST_CASE(reopen_database)
+{
+    ScratchFile file;
+    {
+        auto database = SQL::Database::open(file.path()).release_value();
+        auto table = database->create_table("FIRST").release_value();
+        fill(table, 2000);
+        EXPECT(!database->create_table("SECOND").is_error());
+        EXPECT(database->create_table("FIRST").is_error());
+        EXPECT(database->commit());
+    }
+
+    auto database = SQL::Database::open(file.path()).release_value();
+    auto names = database->table_names();
+    EXPECT_EQ(names.size(), 2u);
+    EXPECT_EQ(names[0], "FIRST");
+    EXPECT_EQ(names[1], "SECOND");
+
+    auto table = database->table("FIRST");
+    EXPECT(table.has_value());
+    for (u64 row_id = 1; row_id <= 2000; ++row_id)
+        EXPECT_EQ(find(*table, row_id), value_for(row_id));
+
+    EXPECT(database->drop_table("SECOND"));
+    EXPECT(!database->drop_table("SECOND"));
+    EXPECT(!database->table("SECOND").has_value());
+}
+
+TEST_CASE(recover_committed_changes_after_crash)
+{
+    ScratchFile file;
+    ScratchFile crashed;
+    auto database = SQL::Database::open(file.path(), 8).release_value();
+    auto table = database->create_table("FIRST").release_value();
+    fill(table, 2000);
+    EXPECT(database->commit());
+
+    // These don't fit in the pool, so some of them are already in the log, but they aren't committed.
+    auto write_count = database->pool().write_count();
+    for (u64 row_id = 2001; row_id <= 3000; ++row_id)
+        EXPECT(table.insert(key_for(row_id), value_for(row_id).bytes()));
+    EXPECT(database->create_table("SECOND").release_value().insert(key_for(1), "x"sv.bytes()));
+    EXPECT(database->pool().write_count() > write_count);
+    copy_after_crash(file.path(), crashed.path());
+
+    auto recovered = SQL::Database::open(crashed.path()).release_value();
+    EXPECT_EQ(recovered->table_names().size(), 1u);
+    auto recovered_table = recovered->table("FIRST");
+    EXPECT(recovered_table.has_value());
+    EXPECT_EQ(count_rows(*recovered_table), 2000u);
+    for (u64 row_id = 1; row_id <= 2000; ++row_id)
+        EXPECT_EQ(find(*recovered_table, row_id), value_for(row_id));
+}
+
+TEST_CASE(ignore_torn_commit_after_crash)
+{
+    ScratchFile file;
+    ScratchFile crashed;
+    auto database = SQL::Database::open(file.path()).release_value();
+    auto table = database->create_table("TABLE").release_value();
+    fill(table, 100);
+    EXPECT(database->commit());
+    for (u64 row_id = 101; row_id <= 200; ++row_id)
+        EXPECT(table.insert(key_for(row_id), value_for(row_id).bytes()));
+    EXPECT(database->commit());
+
+    // The last commit only made it to the disk in part.
+    copy_after_crash(file.path(), crashed.path(), 100);
+
+    auto recovered = SQL::Database::open(crashed.path()).release_value();
+    auto recovered_table = recovered->table("TABLE");
+    EXPECT(recovered_table.has_value());
+    EXPECT_EQ(count_rows(*recovered_table), 100u);
+    EXPECT_EQ(row_id_of(recovered_table->last_key().value()), 100u);
+}
+
+TEST_CASE(checkpoint_into_database_file)
+{
+    ScratchFile file;
+    ScratchFile copy;
+    auto database = SQL::Database::open(file.path()).release_value();
+    auto table = database->create_table("TABLE").release_value();
+    fill(table, 2000);
+    EXPECT(database->commit());
+
+    auto& heap = database->pool().heap();
+    EXPECT(heap.log().frame_count() > 0);
+    EXPECT(heap.checkpoint());
+    EXPECT_EQ(heap.log().frame_count(), 0u);
+
+    // Everything is in the database file now, so it doesn't need the log.
+    copy_file(file.path(), copy.path());
+    auto copied = SQL::Database::open(copy.path()).release_value();
+    auto copied_table = copied->table("TABLE");
+    EXPECT(copied_table.has_value());
+    for (u64 row_id = 1; row_id <= 2000; ++row_id)
+        EXPECT_EQ(find(*copied_table, row_id), value_for(row_id));
+}
+
+TEST_CASE(readers_see_a_snapshot)
+{
+    ScratchFile file;
+    auto database = SQL::Database::open(file.path()).release_value();
+    auto table = database->create_table("TABLE").release_value();
+    fill(table, 100);
+    EXPECT(database->commit());
+
+    auto reader = database->begin_read().release_value();
+    EXPECT(reader->is_read_only());
+    EXPECT(reader->create_table("OTHER").is_error());
+
+    for (u64 row_id = 101; row_id <= 3000; ++row_id)
+        EXPECT(table.insert(key_for(row_id), value_for(row_id).bytes()));
+    EXPECT(!database->create_table("OTHER").is_error());
+    EXPECT(database->commit());
+    // The pages that the reader still reads from the database file are left alone.
+    EXPECT(database->pool().heap().checkpoint());
+
+    auto old_table = reader->table("TABLE");
+    EXPECT(old_table.has_value());
+    EXPECT_EQ(count_rows(*old_table), 100u);
+    EXPECT_EQ(find(*old_table, 100), value_for(100));
+    EXPECT(!old_table->find(key_for(101)).has_value());
+    EXPECT(!reader->table("OTHER").has_value());
+
+    auto new_reader = database->begin_read().release_value();
+    auto new_table = new_reader->table("TABLE");
+    EXPECT(new_table.has_value());
+    EXPECT_EQ(count_rows(*new_table), 3000u);
+    EXPECT(new_reader->table("OTHER").has_value());
+}
+
+TEST_CASE(group_commit)
+{
+    static constexpr size_t thread_count = 8;
+    static constexpr size_t commits_per_thread = 25;
+
+    ScratchFile file;
+    auto database = SQL::Database::open(file.path()).release_value();
+    EXPECT(!database->create_table("TABLE", { { "N", SQL::ValueType::Integer } }).is_error());
+    EXPECT(database->commit());
+    auto& log = database->pool().heap().log();
+    auto sync_count = log.sync_count();
+
+    auto writer = [](void* argument) -> void* {
+        auto& database = *static_cast<SQL::Database*>(argument);
+        for (size_t i = 0; i < commits_per_thread; ++i) {
+            database.begin_write();
+            auto table = database.table_definition("TABLE").value();
+            auto row_id = database.insert_row(table, { SQL::Value((i64)i) });
+            VERIFY(!row_id.is_error());
+            VERIFY(database.commit());
+        }
+        return nullptr;
+    };
+
+    pthread_t threads[thread_count];
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_create(&thread, nullptr, writer, database.ptr()), 0);
+    for (auto& thread : threads)
+        pthread_join(thread, nullptr);
+
+    auto table = database->table("TABLE");
+    EXPECT_EQ(count_rows(*table), thread_count * commits_per_thread);
+    EXPECT(log.sync_count() - sync_count <= thread_count * commits_per_thread);
+}
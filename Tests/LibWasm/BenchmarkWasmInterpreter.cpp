@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/Opcode.h>
+#include <time.h>
+
+namespace {
+
+using namespace Wasm::Instructions;
+
+static constexpr u8 empty_block_type = 0x40;
+static constexpr u8 i32_type = 0x7f;
+// NOTE: The parser turns these into the structured_else and structured_end pseudo-instructions, which have opcodes of their own.
+static constexpr u8 else_byte = 0x05;
+static constexpr u8 end_byte = 0x0b;
+
+static void append_unsigned(Vector<u8>& bytes, u32 value)
+{
+    do {
+        u8 byte = value & 0x7f;
+        value >>= 7;
+        bytes.append(value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+static void append_signed(Vector<u8>& bytes, i32 value)
+{
+    for (;;) {
+        u8 byte = value & 0x7f;
+        value >>= 7;
+        if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40))) {
+            bytes.append(byte);
+            return;
+        }
+        bytes.append(byte | 0x80);
+    }
+}
+
+// Just enough of an assembler to write the kernels below with.
+class Code {
+public:
+    Code& op(Wasm::OpCode opcode)
+    {
+        m_bytes.append(opcode.value());
+        return *this;
+    }
+    Code& op(Wasm::OpCode opcode, u32 index)
+    {
+        op(opcode);
+        append_unsigned(m_bytes, index);
+        return *this;
+    }
+    Code& constant(i32 value)
+    {
+        op(i32_const);
+        append_signed(m_bytes, value);
+        return *this;
+    }
+    Code& memory(Wasm::OpCode opcode, u32 offset = 0)
+    {
+        op(opcode);
+        // Alignment hint, then the offset.
+        m_bytes.append(0);
+        append_unsigned(m_bytes, offset);
+        return *this;
+    }
+    Code& block(Wasm::OpCode opcode, u8 type = empty_block_type)
+    {
+        op(opcode);
+        m_bytes.append(type);
+        return *this;
+    }
+    Code& else_()
+    {
+        m_bytes.append(else_byte);
+        return *this;
+    }
+    Code& end()
+    {
+        m_bytes.append(end_byte);
+        return *this;
+    }
+
+    // for (counter = 0; counter < limit; ++counter) body
+    template<typename Body>
+    Code& repeat(u32 counter, u32 limit, Body body)
+    {
+        constant(0).op(local_set, counter);
+        block(Wasm::Instructions::block).block(loop);
+        op(local_get, counter).op(local_get, limit).op(i32_ges).op(br_if, 1);
+        body(*this);
+        op(local_get, counter).constant(1).op(i32_add).op(local_set, counter);
+        op(br, 0).end().end();
+        return *this;
+    }
+
+    Vector<u8> const& bytes() const { return m_bytes; }
+
+private:
+    Vector<u8> m_bytes;
+};
+
+// Builds a module around a single exported function that takes and returns an i32, with some i32 locals and a page of memory.
+static ByteBuffer build_module(Code const& code, u32 local_count)
+{
+    Vector<u8> module { 0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00 };
+    auto append_section = [&](u8 id, Vector<u8> const& contents) {
+        module.append(id);
+        append_unsigned(module, contents.size());
+        module.append(contents.data(), contents.size());
+    };
+
+    // (i32) -> i32
+    append_section(1, { 1, 0x60, 1, i32_type, 1, i32_type });
+    // One function, of the only type.
+    append_section(3, { 1, 0 });
+    // One memory, with one page and no maximum.
+    append_section(5, { 1, 0, 1 });
+    // export "run" (function 0)
+    append_section(7, { 1, 3, 'r', 'u', 'n', 0, 0 });
+
+    Vector<u8> body { 1 };
+    append_unsigned(body, local_count);
+    body.append(i32_type);
+    body.append(code.bytes().data(), code.bytes().size());
+    body.append(end_byte);
+
+    Vector<u8> code_section { 1 };
+    append_unsigned(code_section, body.size());
+    code_section.append(move(body));
+    append_section(10, code_section);
+
+    return ByteBuffer::copy(module.data(), module.size());
+}
+
+static i32 run(StringView name, ByteBuffer const& binary, i32 argument)
+{
+    InputMemoryStream stream { binary };
+    auto module = Wasm::Module::parse(stream);
+    VERIFY(!module.is_error());
+
+    Wasm::AbstractMachine machine;
+    auto instance = machine.instantiate(module.value(), {});
+    VERIFY(!instance.is_error());
+    auto address = instance.value()->exports().first().value().get<Wasm::FunctionAddress>();
+
+    Wasm::ProfilingBytecodeInterpreter interpreter;
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    auto result = machine.invoke(interpreter, address, { Wasm::Value { argument } });
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    VERIFY(!result.is_trap());
+
+    auto elapsed = Time::from_timespec(end) - Time::from_timespec(start);
+    auto instructions = interpreter.executed_instructions();
+    auto microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    warnln("{}: {} instructions in {} ms, {} million instructions per second", name, instructions, elapsed.to_milliseconds(), instructions / microseconds);
+
+    return result.values().first().to<i32>().value();
+}
+
+}
+
+BENCHMARK_CASE(fibonacci)
+{
+    // fib(n) = n < 2 ? n : fib(n - 1) + fib(n - 2)
+    Code code;
+    code.op(local_get, 0).constant(2).op(i32_lts).block(if_, i32_type);
+    code.op(local_get, 0);
+    code.else_();
+    code.op(local_get, 0).constant(1).op(i32_sub).op(call, 0);
+    code.op(local_get, 0).constant(2).op(i32_sub).op(call, 0);
+    code.op(i32_add);
+    code.end();
+
+    EXPECT_EQ(run("fibonacci", build_module(code, 0), 25), 75025);
+}
+
+BENCHMARK_CASE(matrix_multiplication)
+{
+    // Multiplies two n*n matrices of i32s, A[i] = i and B[i] = n*n - i, and returns the trace of the product.
+    static constexpr u32 n = 0, i = 1, j = 2, k = 3, sum = 4, trace = 5, size = 6;
+    static constexpr u32 b_offset = 16 * KiB, c_offset = 32 * KiB;
+    Code code;
+    code.op(local_get, n).op(local_get, n).op(i32_mul).op(local_set, size);
+    code.repeat(i, size, [](Code& code) {
+        code.op(local_get, i).constant(4).op(i32_mul).op(local_get, i).memory(i32_store);
+        code.op(local_get, i).constant(4).op(i32_mul).op(local_get, size).op(local_get, i).op(i32_sub).memory(i32_store, b_offset);
+    });
+    code.repeat(i, n, [](Code& code) {
+        code.repeat(j, n, [](Code& code) {
+            code.constant(0).op(local_set, sum);
+            code.repeat(k, n, [](Code& code) {
+                // sum += A[i * n + k] * B[k * n + j]
+                code.op(local_get, sum);
+                code.op(local_get, i).op(local_get, n).op(i32_mul).op(local_get, k).op(i32_add).constant(4).op(i32_mul).memory(i32_load);
+                code.op(local_get, k).op(local_get, n).op(i32_mul).op(local_get, j).op(i32_add).constant(4).op(i32_mul).memory(i32_load, b_offset);
+                code.op(i32_mul).op(i32_add).op(local_set, sum);
+            });
+            code.op(local_get, i).op(local_get, n).op(i32_mul).op(local_get, j).op(i32_add).constant(4).op(i32_mul).op(local_get, sum).memory(i32_store, c_offset);
+            code.op(local_get, i).op(local_get, j).op(i32_eq).block(if_);
+            code.op(local_get, trace).op(local_get, sum).op(i32_add).op(local_set, trace);
+            code.end();
+        });
+    });
+    code.op(local_get, trace);
+
+    EXPECT_EQ(run("matrix_multiplication", build_module(code, 6), 48), -1279769152);
+}
+
+BENCHMARK_CASE(hashing)
+{
+    // Fills the first length bytes of memory with (i * 31) & 0xff, and then returns their FNV-1a hash.
+    static constexpr u32 length = 0, i = 1, hash = 2;
+    Code code;
+    code.repeat(i, length, [](Code& code) {
+        code.op(local_get, i).op(local_get, i).constant(31).op(i32_mul).memory(i32_store8);
+    });
+    code.constant(static_cast<i32>(0x811c9dc5)).op(local_set, hash);
+    code.repeat(i, length, [](Code& code) {
+        code.op(local_get, hash).op(local_get, i).memory(i32_load8_u).op(i32_xor).constant(16777619).op(i32_mul).op(local_set, hash);
+    });
+    code.op(local_get, hash);
+
+    EXPECT_EQ(run("hashing", build_module(code, 2), 64 * KiB), 1688182213);
+}
@@ -40,7 +40,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (pledge("stdio recvfd sendfd unix cpath rpath wpath", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd unix cpath rpath wpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -37,18 +37,21 @@
 #include <LibGUI/Splitter.h>
 #include <LibGUI/Statusbar.h>
 #include <LibGUI/TextEditor.h>
+#include <LibGUI/ThumbnailCache.h>
 #include <LibGUI/Toolbar.h>
 #include <LibGUI/ToolbarContainer.h>
 #include <LibGUI/TreeView.h>
 #include <LibGUI/Widget.h>
 #include <LibGUI/Window.h>
 #include <LibGfx/Palette.h>
+#include <errno.h>
 #include <pthread.h>
 #include <serenity.h>
 #include <signal.h>
 #include <spawn.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -98,6 +101,14 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // Thumbnails are decoded by the ImageDecoder service, and kept around in the user's cache directory.
+    auto thumbnail_cache_directory = String::formatted("{}/.cache/thumbnails", Core::StandardPaths::home_directory());
+    if (Core::File::ensure_parent_directories(thumbnail_cache_directory) && (mkdir(thumbnail_cache_directory.characters(), 0700) == 0 || errno == EEXIST))
+        GUI::ThumbnailCache::the().set_disk_cache_directory(thumbnail_cache_directory);
+    else
+        warnln("Unable to create thumbnail cache directory {}, only caching in memory", thumbnail_cache_directory);
+    GUI::ThumbnailCache::the().set_decodes_in_image_decoder_service(true);
+
     if (is_desktop_mode)
         return run_in_desktop_mode(move(config));
 
@@ -14,7 +14,7 @@
 
 int main(int argc, char** argv)
 {
-    if (pledge("stdio inet unix recvfd sendfd cpath rpath wpath", nullptr) < 0) {
+    if (pledge("stdio inet unix recvfd sendfd cpath rpath wpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -22,6 +22,8 @@ PDFViewer::PDFViewer()
 
 void PDFViewer::set_document(RefPtr<PDF::Document> document)
 {
+    wait_for_pending_renders();
+
     m_document = document;
     m_current_page_index = document->get_first_page_index();
     m_zoom_level = initial_zoom_level;
@@ -34,6 +36,13 @@ void PDFViewer::set_document(RefPtr<PDF::Document> document)
     update();
 }
 
+void PDFViewer::wait_for_pending_renders()
+{
+    for (auto& pending_render : m_pending_renders)
+        (void)pending_render->await();
+    m_pending_renders.clear();
+}
+
 RefPtr<Gfx::Bitmap> PDFViewer::get_rendered_page(u32 index)
 {
     auto& rendered_page_map = m_rendered_page_list[index];
@@ -41,9 +50,35 @@ RefPtr<Gfx::Bitmap> PDFViewer::get_rendered_page(u32 index)
     if (existing_rendered_page.has_value())
         return existing_rendered_page.value();
 
-    auto rendered_page = render_page(m_document->get_page(index));
-    rendered_page_map.set(m_zoom_level, rendered_page);
-    return rendered_page;
+    auto page = m_document->get_page(index);
+    auto zoom_scale_factor = static_cast<float>(zoom_levels[m_zoom_level]) / 100.0f;
+
+    auto page_width = page.media_box.upper_right_x - page.media_box.lower_left_x;
+    auto page_height = page.media_box.upper_right_y - page.media_box.lower_left_y;
+    auto page_scale_factor = page_height / page_width;
+
+    auto height = static_cast<float>(this->height() - 2 * frame_thickness() - PAGE_PADDING * 2) * zoom_scale_factor;
+    auto width = height / page_scale_factor;
+    Gfx::IntSize size { width, height };
+
+    rendered_page_map.set(m_zoom_level, nullptr);
+    auto pending_render = Threading::ThreadPool::the().async<RefPtr<Gfx::Bitmap>>([document = NonnullRefPtr(*m_document), page, size]() mutable {
+        return render_page(*document, page, size);
+    });
+    m_pending_renders.append(pending_render);
+
+    pending_render->on_ready([this, weak_this = make_weak_ptr<PDFViewer>(), pending_render = pending_render.ptr(), document = m_document, index, zoom_level = m_zoom_level](auto rendered_page) {
+        if (!weak_this)
+            return;
+        m_pending_renders.remove_first_matching([&](auto& entry) { return entry.ptr() == pending_render; });
+        if (m_document != document)
+            return;
+        m_rendered_page_list[index].set(zoom_level, rendered_page);
+        if (index == m_current_page_index && zoom_level == m_zoom_level)
+            update();
+    });
+
+    return nullptr;
 }
 
 void PDFViewer::paint_event(GUI::PaintEvent& event)
@@ -58,7 +93,16 @@ void PDFViewer::paint_event(GUI::PaintEvent& event)
     if (!m_document)
         return;
 
+    // The pages next to this one are rendered ahead of time, so that they're there by the time they're scrolled to.
     auto page = get_rendered_page(m_current_page_index);
+    if (m_current_page_index > 0)
+        (void)get_rendered_page(m_current_page_index - 1);
+    if (m_current_page_index + 1 < m_document->get_page_count())
+        (void)get_rendered_page(m_current_page_index + 1);
+
+    if (!page)
+        return;
+
     set_content_size(page->size());
 
     painter.translate(frame_thickness(), frame_thickness());
@@ -112,9 +156,9 @@ void PDFViewer::mousewheel_event(GUI::MouseEvent& event)
 
 void PDFViewer::timer_event(Core::TimerEvent&)
 {
-    // Clear the bitmap vector of all pages except the current page
+    // Clear the bitmap vector of all pages except the current page and the ones next to it
     for (size_t i = 0; i < m_rendered_page_list.size(); i++) {
-        if (i != m_current_page_index)
+        if (i + 1 < m_current_page_index || i > m_current_page_index + 1)
             m_rendered_page_list[i].clear();
     }
 }
@@ -131,19 +175,11 @@ void PDFViewer::zoom_out()
         m_zoom_level--;
 }
 
-RefPtr<Gfx::Bitmap> PDFViewer::render_page(const PDF::Page& page)
+RefPtr<Gfx::Bitmap> PDFViewer::render_page(PDF::Document& document, const PDF::Page& page, Gfx::IntSize size)
 {
-    auto zoom_scale_factor = static_cast<float>(zoom_levels[m_zoom_level]) / 100.0f;
-
-    auto page_width = page.media_box.upper_right_x - page.media_box.lower_left_x;
-    auto page_height = page.media_box.upper_right_y - page.media_box.lower_left_y;
-    auto page_scale_factor = page_height / page_width;
-
-    auto height = static_cast<float>(this->height() - 2 * frame_thickness() - PAGE_PADDING * 2) * zoom_scale_factor;
-    auto width = height / page_scale_factor;
-    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { width, height });
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size);
 
-    PDF::Renderer::render(*m_document, page, bitmap);
+    PDF::Renderer::render(document, page, bitmap);
 
     if (page.rotate != 0) {
         int rotation_count = (page.rotate / 90) % 4;
@@ -10,6 +10,7 @@
 #include <LibGUI/AbstractScrollableWidget.h>
 #include <LibGfx/Bitmap.h>
 #include <LibPDF/Document.h>
+#include <LibThreading/ThreadPool.h>
 
 static constexpr u16 zoom_levels[] = {
     17,
@@ -47,6 +48,9 @@ public:
     ALWAYS_INLINE const RefPtr<PDF::Document>& document() const { return m_document; }
     void set_document(RefPtr<PDF::Document>);
 
+    // Pages are rendered in the background, from the document's bytes, so those have to stay around until this returns.
+    void wait_for_pending_renders();
+
 protected:
     PDFViewer();
 
@@ -55,15 +59,20 @@ protected:
     virtual void timer_event(Core::TimerEvent&) override;
 
 private:
+    using PendingRender = NonnullRefPtr<Threading::Future<RefPtr<Gfx::Bitmap>>>;
+
+    // Returns null while the page is still being rendered.
     RefPtr<Gfx::Bitmap> get_rendered_page(u32 index);
-    RefPtr<Gfx::Bitmap> render_page(const PDF::Page&);
+    static RefPtr<Gfx::Bitmap> render_page(PDF::Document&, const PDF::Page&, Gfx::IntSize);
 
     void zoom_in();
     void zoom_out();
 
     RefPtr<PDF::Document> m_document;
     u32 m_current_page_index { 0 };
+    // A null bitmap means that the page is being rendered at that zoom level.
     Vector<HashMap<u32, RefPtr<Gfx::Bitmap>>> m_rendered_page_list;
+    Vector<PendingRender> m_pending_renders;
 
     u8 m_zoom_level { initial_zoom_level };
 };
@@ -104,6 +104,7 @@ void PDFViewerWidget::open_file(const String& path)
     window()->set_title(String::formatted("{} - PDF Viewer", path));
     auto file_result = Core::File::open(path, Core::OpenMode::ReadOnly);
     VERIFY(!file_result.is_error());
+    m_viewer->wait_for_pending_renders();
     m_buffer = file_result.value()->read_all();
     auto document = adopt_ref(*new PDF::Document(m_buffer));
     m_viewer->set_document(document);
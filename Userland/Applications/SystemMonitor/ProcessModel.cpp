@@ -92,6 +92,8 @@ String ProcessModel::column_name(int column) const
         return "CPU";
     case Column::Processor:
         return "Processor";
+    case Column::Affinity:
+        return "Affinity";
     case Column::Name:
         return "Name";
     case Column::Syscalls:
@@ -155,6 +157,7 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
         case Column::PurgeableNonvolatile:
         case Column::CPU:
         case Column::Processor:
+        case Column::Affinity:
         case Column::Syscalls:
         case Column::InodeFaults:
         case Column::ZeroFaults:
@@ -210,6 +213,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return thread.current_state.cpu_percent;
         case Column::Processor:
             return thread.current_state.cpu;
+        case Column::Affinity:
+            return thread.current_state.cpu_affinity;
         case Column::Name:
             return thread.current_state.name;
         case Column::Syscalls:
@@ -279,6 +284,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return String::formatted("{:.2}", thread.current_state.cpu_percent);
         case Column::Processor:
             return thread.current_state.cpu;
+        case Column::Affinity:
+            return String::formatted("{:#x}", thread.current_state.cpu_affinity);
         case Column::Name:
             if (thread.current_state.kernel)
                 return String::formatted("{} (*)", thread.current_state.name);
@@ -363,6 +370,7 @@ void ProcessModel::update()
                 state.ticks_user = thread.ticks_user;
                 state.ticks_kernel = thread.ticks_kernel;
                 state.cpu = thread.cpu;
+                state.cpu_affinity = thread.cpu_affinity;
                 state.cpu_percent = 0;
                 state.priority = thread.priority;
                 state.state = thread.state;
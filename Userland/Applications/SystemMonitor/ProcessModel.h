@@ -33,6 +33,7 @@ public:
         PurgeableNonvolatile,
         Veil,
         Processor,
+        Affinity,
         Priority,
         TID,
         PPID,
@@ -98,6 +99,7 @@ private:
         String pledge;
         String veil;
         u32 cpu;
+        u32 cpu_affinity;
         u32 priority;
         size_t amount_virtual;
         size_t amount_resident;
@@ -5,6 +5,7 @@
  */
 
 #include "MainWidget.h"
+#include <AK/MappedFile.h>
 #include <AK/Optional.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
@@ -653,7 +654,12 @@ bool MainWidget::open_file(const String& path)
         return false;
     }
 
-    m_editor->set_text(file->read_all());
+    // Big files open a lot faster when the document can read them straight from the page cache.
+    // Empty and missing files can't be mapped, but then there's nothing to read anyway.
+    if (auto mapped_file = MappedFile::map(path); !mapped_file.is_error())
+        m_editor->set_text_from_mapped_file(mapped_file.release_value());
+    else
+        m_editor->set_text(file->read_all());
 
     set_path(LexicalPath(path));
 
@@ -48,8 +48,8 @@ template<>
 inline bool encode(Encoder& encoder, const GUI::AutocompleteProvider::ProjectLocation& location)
 {
     encoder << location.file;
-    encoder << (u64)location.line;
-    encoder << (u64)location.column;
+    encoder.encode_leb128(location.line);
+    encoder.encode_leb128(location.column);
     return true;
 }
 
@@ -60,9 +60,9 @@ inline bool decode(Decoder& decoder, GUI::AutocompleteProvider::ProjectLocation&
     u64 column = 0;
     if (!decoder.decode(location.file))
         return false;
-    if (!decoder.decode(line))
+    if (!decoder.decode_leb128(line))
         return false;
-    if (!decoder.decode(column))
+    if (!decoder.decode_leb128(column))
         return false;
 
     location.line = line;
@@ -15,6 +15,7 @@
 #include <LibCpp/Parser.h>
 #include <LibCpp/Preprocessor.h>
 #include <LibRegex/Regex.h>
+#include <sys/stat.h>
 #include <Userland/DevTools/HackStudio/LanguageServers/ClientConnection.h>
 
 namespace LanguageServers::Cpp {
@@ -27,6 +28,10 @@ CppComprehensionEngine::CppComprehensionEngine(const FileDB& filedb)
 const CppComprehensionEngine::DocumentData* CppComprehensionEngine::get_or_create_document_data(const String& file)
 {
     auto absolute_path = filedb().to_absolute_path(file);
+    if (auto* document = get_document_data(absolute_path); document && has_changed_on_disk(*document)) {
+        m_documents.remove(absolute_path);
+        invalidate_documents_including(absolute_path);
+    }
     if (!m_documents.contains(absolute_path)) {
         set_document_data(absolute_path, create_document_data_for(absolute_path));
     }
@@ -44,10 +49,40 @@ const CppComprehensionEngine::DocumentData* CppComprehensionEngine::get_document
 
 OwnPtr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::create_document_data_for(const String& file)
 {
+    Optional<time_t> modification_time;
+    if (struct stat st; !filedb().is_open(file) && stat(filedb().to_absolute_path(file).characters(), &st) == 0)
+        modification_time = st.st_mtime;
+
     auto document = filedb().get_or_create_from_filesystem(file);
     if (!document)
         return {};
-    return create_document_data(document->text(), file);
+    auto document_data = create_document_data(document->text(), file);
+    document_data->m_modification_time = modification_time;
+    return document_data;
+}
+
+bool CppComprehensionEngine::has_changed_on_disk(const DocumentData& document) const
+{
+    if (!document.m_modification_time.has_value())
+        return false;
+    struct stat st;
+    if (stat(filedb().to_absolute_path(document.filename()).characters(), &st) < 0)
+        return true;
+    return st.st_mtime != document.m_modification_time.value();
+}
+
+void CppComprehensionEngine::invalidate_documents_including(const String& file)
+{
+    auto including = m_documents_including.get(file);
+    if (!including.has_value())
+        return;
+    auto documents = move(including.value());
+    m_documents_including.remove(file);
+
+    for (auto& document : documents) {
+        if (m_documents.remove(document))
+            invalidate_documents_including(document);
+    }
 }
 
 void CppComprehensionEngine::set_document_data(const String& file, OwnPtr<DocumentData>&& data)
@@ -362,7 +397,9 @@ String CppComprehensionEngine::document_path_from_include_path(const StringView&
 
 void CppComprehensionEngine::on_edit(const String& file)
 {
+    // Only the edited document is parsed again right away, along with any headers of its that changed.
     set_document_data(file, create_document_data_for(file));
+    invalidate_documents_including(filedb().to_absolute_path(file));
 }
 
 void CppComprehensionEngine::file_opened([[maybe_unused]] const String& file)
@@ -558,6 +595,7 @@ OwnPtr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::create_docu
             continue;
 
         document_data->m_available_headers.set(include_fullpath);
+        m_documents_including.ensure(filedb().to_absolute_path(include_fullpath)).set(filedb().to_absolute_path(filename));
 
         for (auto& header : included_document->m_available_headers)
             document_data->m_available_headers.set(header);
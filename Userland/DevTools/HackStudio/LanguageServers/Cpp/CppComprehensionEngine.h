@@ -90,6 +90,10 @@ private:
 
         HashMap<SymbolName, Symbol> m_symbols;
         HashTable<String> m_available_headers;
+
+        // Only set for documents that were read from the file system, rather than being open in the editor,
+        // so that changes on disk can be noticed.
+        Optional<time_t> m_modification_time;
     };
 
     Vector<GUI::AutocompleteProvider::Entry> autocomplete_property(const DocumentData&, const MemberExpression&, const String partial_text) const;
@@ -119,6 +123,8 @@ private:
     void set_document_data(const String& file, OwnPtr<DocumentData>&& data);
 
     OwnPtr<DocumentData> create_document_data_for(const String& file);
+    bool has_changed_on_disk(const DocumentData&) const;
+    void invalidate_documents_including(const String& file);
     String document_path_from_include_path(const StringView& include_path) const;
     void update_declared_symbols(DocumentData&);
     GUI::AutocompleteProvider::DeclarationType type_of_declaration(const Declaration&);
@@ -140,6 +146,10 @@ private:
     void for_each_included_document_recursive(const DocumentData&, Func) const;
 
     HashMap<String, OwnPtr<DocumentData>> m_documents;
+
+    // For every document, the documents that include it directly. Those were parsed with the macros it defined,
+    // so they're thrown away when it changes (and parsed again the next time they're needed).
+    HashMap<String, HashTable<String>> m_documents_including;
 };
 
 template<typename Func>
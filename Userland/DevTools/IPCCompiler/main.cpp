@@ -421,6 +421,16 @@ public:
         VERIFY(valid());
 
         IPC::MessageBuffer buffer;
+        buffer.data.ensure_capacity(sizeof(u32) + sizeof(i32))~~~");
+
+            for (auto& parameter : parameters) {
+                auto parameter_generator = message_generator.fork();
+
+                parameter_generator.set("parameter.name", parameter.name);
+                parameter_generator.append(R"~~~( + IPC::encoded_size_hint(m_@parameter.name@))~~~");
+            }
+
+            message_generator.append(R"~~~();
         IPC::Encoder stream(buffer);
         stream << endpoint_magic();
         stream << (int)MessageID::@message.pascal_name@;
@@ -627,6 +637,35 @@ public:
     using Stub = @endpoint.name@Stub;
 
     static u32 static_magic() { return @endpoint.magic@; }
+    static StringView static_name() { return "@endpoint.name@"; }
+
+    static StringView message_name(i32 message_id)
+    {
+        switch (message_id) {
+)~~~");
+
+        for (auto& message : endpoint.messages) {
+            auto do_name_message = [&](const String& name) {
+                auto message_generator = endpoint_generator.fork();
+
+                message_generator.set("message.pascal_name", pascal_case(name));
+
+                message_generator.append(R"~~~(
+        case (int)Messages::@endpoint.name@::MessageID::@message.pascal_name@:
+            return "@message.pascal_name@";
+)~~~");
+            };
+
+            do_name_message(message.name);
+            if (message.is_synchronous)
+                do_name_message(message.response_name());
+        }
+
+        endpoint_generator.append(R"~~~(
+        default:
+            return "Unknown";
+        }
+    }
 
     static OwnPtr<IPC::Message> decode_message(ReadonlyBytes buffer, int sockfd)
     {
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "ComparisonModel.h"
+#include "Profile.h"
+
+namespace Profiler {
+
+ComparisonModel::ComparisonModel(Profile const& baseline, Profile const& profile)
+{
+    auto baseline_functions = baseline.samples_per_function();
+    auto functions = profile.samples_per_function();
+    auto baseline_sample_count = baseline.sample_count();
+    auto sample_count = profile.sample_count();
+
+    auto percentage = [](u32 count, size_t sample_count) {
+        return sample_count ? count * 100.0f / sample_count : 0.0f;
+    };
+
+    for (auto& it : functions) {
+        auto& function = it.value;
+        Row row { function.symbol, function.object_name };
+        row.self_after = percentage(function.self_count, sample_count);
+        row.total_after = percentage(function.total_count, sample_count);
+        if (auto baseline_function = baseline_functions.get(it.key); baseline_function.has_value()) {
+            row.self_before = percentage(baseline_function->self_count, baseline_sample_count);
+            row.total_before = percentage(baseline_function->total_count, baseline_sample_count);
+        }
+        m_rows.append(move(row));
+    }
+    // Functions that don't show up anymore went from something to nothing.
+    for (auto& it : baseline_functions) {
+        if (functions.contains(it.key))
+            continue;
+        auto& function = it.value;
+        Row row { function.symbol, function.object_name };
+        row.self_before = percentage(function.self_count, baseline_sample_count);
+        row.total_before = percentage(function.total_count, baseline_sample_count);
+        m_rows.append(move(row));
+    }
+}
+
+ComparisonModel::~ComparisonModel()
+{
+}
+
+int ComparisonModel::row_count(const GUI::ModelIndex&) const
+{
+    return m_rows.size();
+}
+
+int ComparisonModel::column_count(const GUI::ModelIndex&) const
+{
+    return Column::__Count;
+}
+
+String ComparisonModel::column_name(int column) const
+{
+    switch (column) {
+    case Column::Function:
+        return "Function";
+    case Column::ObjectName:
+        return "Object";
+    case Column::SelfBefore:
+        return "Self before";
+    case Column::SelfAfter:
+        return "Self after";
+    case Column::SelfDifference:
+        return "Self change";
+    case Column::TotalBefore:
+        return "Total before";
+    case Column::TotalAfter:
+        return "Total after";
+    case Column::TotalDifference:
+        return "Total change";
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+GUI::Variant ComparisonModel::data(const GUI::ModelIndex& index, GUI::ModelRole role) const
+{
+    auto& row = m_rows[index.row()];
+
+    auto value = [&]() -> float {
+        switch (index.column()) {
+        case Column::SelfBefore:
+            return row.self_before;
+        case Column::SelfAfter:
+            return row.self_after;
+        case Column::SelfDifference:
+            return row.self_after - row.self_before;
+        case Column::TotalBefore:
+            return row.total_before;
+        case Column::TotalAfter:
+            return row.total_after;
+        case Column::TotalDifference:
+            return row.total_after - row.total_before;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    };
+
+    if (role == GUI::ModelRole::TextAlignment) {
+        if (index.column() == Column::Function || index.column() == Column::ObjectName)
+            return Gfx::TextAlignment::CenterLeft;
+        return Gfx::TextAlignment::CenterRight;
+    }
+
+    if (role == GUI::ModelRole::ForegroundColor) {
+        // What got slower stands out in red, what got faster in green.
+        if (index.column() == Column::SelfDifference || index.column() == Column::TotalDifference) {
+            auto difference = value();
+            if (difference >= 0.01f)
+                return Color(Color::Red);
+            if (difference <= -0.01f)
+                return Color(Color::Green);
+        }
+        return {};
+    }
+
+    if (role == GUI::ModelRole::Sort) {
+        if (index.column() == Column::Function)
+            return row.symbol;
+        if (index.column() == Column::ObjectName)
+            return row.object_name;
+        return value();
+    }
+
+    if (role == GUI::ModelRole::Display) {
+        if (index.column() == Column::Function)
+            return row.symbol;
+        if (index.column() == Column::ObjectName)
+            return row.object_name;
+        if (index.column() == Column::SelfDifference || index.column() == Column::TotalDifference)
+            return String::formatted("{:+.2}%", value());
+        return String::formatted("{:.2}%", value());
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/Vector.h>
+#include <LibGUI/Model.h>
+
+namespace Profiler {
+
+class Profile;
+
+// Compares how much time every function took in a profile with how much it took in an earlier one (the baseline),
+// as the share of all samples in either profile, so that profiles of different length can be compared.
+class ComparisonModel final : public GUI::Model {
+public:
+    static NonnullRefPtr<ComparisonModel> create(Profile const& baseline, Profile const& profile)
+    {
+        return adopt_ref(*new ComparisonModel(baseline, profile));
+    }
+
+    enum Column {
+        Function,
+        ObjectName,
+        SelfBefore,
+        SelfAfter,
+        SelfDifference,
+        TotalBefore,
+        TotalAfter,
+        TotalDifference,
+        __Count
+    };
+
+    virtual ~ComparisonModel() override;
+
+    virtual int row_count(const GUI::ModelIndex& = GUI::ModelIndex()) const override;
+    virtual int column_count(const GUI::ModelIndex& = GUI::ModelIndex()) const override;
+    virtual String column_name(int) const override;
+    virtual GUI::Variant data(const GUI::ModelIndex&, GUI::ModelRole) const override;
+    virtual void update() override { }
+
+private:
+    ComparisonModel(Profile const& baseline, Profile const& profile);
+
+    struct Row {
+        String symbol;
+        FlyString object_name;
+        // Percentages of all samples in the baseline and in the profile.
+        float self_before { 0 };
+        float self_after { 0 };
+        float total_before { 0 };
+        float total_after { 0 };
+    };
+
+    Vector<Row> m_rows;
+};
+
+}
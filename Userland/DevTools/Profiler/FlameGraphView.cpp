@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "FlameGraphView.h"
+#include "Profile.h"
+#include <LibGUI/Painter.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/Palette.h>
+
+namespace Profiler {
+
+FlameGraphView::FlameGraphView(Profile& profile)
+    : m_profile(profile)
+{
+    set_fill_with_background_color(true);
+    set_background_role(Gfx::ColorRole::Base);
+    set_frame_thickness(1);
+    m_profile.model().register_client(*this);
+}
+
+FlameGraphView::~FlameGraphView()
+{
+    m_profile.model().unregister_client(*this);
+}
+
+void FlameGraphView::model_did_update(unsigned)
+{
+    // The tree has been rebuilt (or pruned), so the nodes we point to may be gone.
+    m_zoomed_node = nullptr;
+    m_hovered_node = nullptr;
+    set_tooltip({});
+    layout_bars();
+    update();
+}
+
+u32 FlameGraphView::total_event_count() const
+{
+    u32 count = 0;
+    for (auto& root : m_profile.roots())
+        count += root->event_count();
+    return count;
+}
+
+Gfx::IntRect FlameGraphView::rect_for_bar(int x, int width, int depth) const
+{
+    auto inner_rect = frame_inner_rect();
+    return { x, inner_rect.bottom() + 1 - (depth + 1) * bar_height, width, bar_height };
+}
+
+void FlameGraphView::layout_bars()
+{
+    m_bars.clear();
+    auto inner_rect = frame_inner_rect();
+
+    if (!m_zoomed_node) {
+        auto total = total_event_count();
+        if (!total)
+            return;
+        int x = inner_rect.x();
+        u64 events_so_far = 0;
+        for (auto& root : m_profile.roots()) {
+            // The bars are placed by their running total, so that rounding doesn't add up across siblings.
+            events_so_far += root->event_count();
+            int end = inner_rect.x() + events_so_far * inner_rect.width() / total;
+            if (end > x) {
+                m_bars.append({ rect_for_bar(x, end - x, 0), root.ptr() });
+                add_bars_for_children(*root, x, end - x, 1);
+            }
+            x = end;
+        }
+        return;
+    }
+
+    // The callers of the node that we have zoomed in on take up the whole width as well.
+    Vector<ProfileNode const*> path;
+    for (auto* node = m_zoomed_node; node; node = node->parent())
+        path.prepend(node);
+    for (size_t depth = 0; depth < path.size(); ++depth)
+        m_bars.append({ rect_for_bar(inner_rect.x(), inner_rect.width(), depth), path[depth], depth + 1 < path.size() });
+    add_bars_for_children(*m_zoomed_node, inner_rect.x(), inner_rect.width(), path.size());
+}
+
+void FlameGraphView::add_bars_for_children(ProfileNode const& node, int x, int width, int depth)
+{
+    if (!node.event_count() || rect_for_bar(x, width, depth).bottom() < frame_inner_rect().top())
+        return;
+    // Samples that ended in the node itself leave a gap to the right of its children.
+    u64 events_so_far = 0;
+    for (auto& child : node.children()) {
+        int child_x = x + events_so_far * width / node.event_count();
+        events_so_far += child->event_count();
+        int child_end = x + events_so_far * width / node.event_count();
+        if (child_end <= child_x)
+            continue;
+        m_bars.append({ rect_for_bar(child_x, child_end - child_x, depth), child.ptr() });
+        add_bars_for_children(*child, child_x, child_end - child_x, depth + 1);
+    }
+}
+
+FlameGraphView::Bar const* FlameGraphView::bar_at(Gfx::IntPoint const& position) const
+{
+    for (auto& bar : m_bars) {
+        if (bar.rect.contains(position))
+            return &bar;
+    }
+    return nullptr;
+}
+
+String FlameGraphView::text_for_node(ProfileNode const& node) const
+{
+    if (node.is_root())
+        return String::formatted("{} ({})", node.process().basename, node.process().pid);
+    return node.symbol();
+}
+
+// Warm colors that stay the same for the same function, in the style of flamegraph.pl.
+static Color color_for_node(ProfileNode const& node)
+{
+    auto hash = node.symbol().hash();
+    return Color(205 + (hash & 0x1f) * 50 / 0x1f, ((hash >> 5) & 0xff) * 230 / 0xff, ((hash >> 13) & 0x3f) * 55 / 0x3f);
+}
+
+void FlameGraphView::paint_event(GUI::PaintEvent& event)
+{
+    GUI::Frame::paint_event(event);
+
+    GUI::Painter painter(*this);
+    painter.add_clip_rect(event.rect());
+    painter.add_clip_rect(frame_inner_rect());
+
+    for (auto& bar : m_bars) {
+        if (!bar.rect.intersects(event.rect()))
+            continue;
+        auto color = color_for_node(*bar.node);
+        if (bar.is_caller)
+            color = color.darkened(0.7f);
+        if (bar.node == m_hovered_node)
+            color = color.lightened(1.2f);
+        painter.fill_rect(bar.rect, color);
+        painter.draw_rect(bar.rect, palette().base());
+        if (bar.rect.width() > 16)
+            painter.draw_text(bar.rect.shrunken(6, 0), text_for_node(*bar.node), Gfx::TextAlignment::CenterLeft, Color::Black, Gfx::TextElision::Right);
+    }
+}
+
+void FlameGraphView::resize_event(GUI::ResizeEvent& event)
+{
+    GUI::Frame::resize_event(event);
+    layout_bars();
+}
+
+void FlameGraphView::mousemove_event(GUI::MouseEvent& event)
+{
+    auto* bar = bar_at(event.position());
+    auto* node = bar ? bar->node : nullptr;
+    if (node == m_hovered_node)
+        return;
+    m_hovered_node = node;
+    if (node) {
+        auto total = total_event_count();
+        set_tooltip(String::formatted("{}\n{} samples ({:.2}%), {} in itself", text_for_node(*node), node->event_count(), total ? node->event_count() * 100.0f / total : 0.0f, node->self_count()));
+    } else {
+        set_tooltip({});
+    }
+    update();
+}
+
+void FlameGraphView::mousedown_event(GUI::MouseEvent& event)
+{
+    if (event.button() != GUI::MouseButton::Left)
+        return;
+    auto* bar = bar_at(event.position());
+    m_zoomed_node = bar ? bar->node : nullptr;
+    layout_bars();
+    update();
+}
+
+void FlameGraphView::leave_event(Core::Event&)
+{
+    if (!m_hovered_node)
+        return;
+    m_hovered_node = nullptr;
+    update();
+}
+
+}
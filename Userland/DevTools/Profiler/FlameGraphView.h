@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibGUI/Frame.h>
+#include <LibGUI/Model.h>
+
+namespace Profiler {
+
+class Profile;
+class ProfileNode;
+
+// Draws the call tree as a flame graph: every node is a bar as wide as its share of the samples,
+// on top of the bar of its caller. Clicking a bar zooms in on it, clicking outside the bars zooms out.
+class FlameGraphView final
+    : public GUI::Frame
+    , public GUI::ModelClient {
+    C_OBJECT(FlameGraphView);
+
+public:
+    virtual ~FlameGraphView() override;
+
+private:
+    explicit FlameGraphView(Profile&);
+
+    virtual void model_did_update(unsigned flags) override;
+
+    virtual void paint_event(GUI::PaintEvent&) override;
+    virtual void resize_event(GUI::ResizeEvent&) override;
+    virtual void mousemove_event(GUI::MouseEvent&) override;
+    virtual void mousedown_event(GUI::MouseEvent&) override;
+    virtual void leave_event(Core::Event&) override;
+
+    struct Bar {
+        Gfx::IntRect rect;
+        ProfileNode const* node { nullptr };
+        // Callers of the node that we have zoomed in on are stretched to the whole width, and drawn darker.
+        bool is_caller { false };
+    };
+
+    static constexpr int bar_height = 18;
+
+    void layout_bars();
+    void add_bars_for_children(ProfileNode const&, int x, int width, int depth);
+    Gfx::IntRect rect_for_bar(int x, int width, int depth) const;
+    Bar const* bar_at(Gfx::IntPoint const&) const;
+    u32 total_event_count() const;
+    String text_for_node(ProfileNode const&) const;
+
+    Profile& m_profile;
+    Vector<Bar> m_bars;
+    // The node that is drawn across the whole width, or none to show every process.
+    ProfileNode const* m_zoomed_node { nullptr };
+    ProfileNode const* m_hovered_node { nullptr };
+};
+
+}
@@ -97,6 +97,7 @@ void LibraryMetadata::handle_mmap(FlatPtr base, size_t size, const String& name)
         return IterationDecision::Continue;
     });
 
+    m_last_library_containing = nullptr;
     m_libraries.set(name, adopt_own(*new Library { base, size, name, text_base, mapped_object }));
 }
 
@@ -105,15 +106,35 @@ String LibraryMetadata::Library::symbolicate(FlatPtr ptr, u32* offset) const
     if (!object)
         return String::formatted("?? <{:p}>", ptr);
 
-    return object->elf.symbolicate(ptr - base + text_base, offset);
+    return object->symbolicate(ptr - base + text_base, offset);
+}
+
+String MappedObject::symbolicate(FlatPtr address, u32* offset)
+{
+    if (auto it = symbol_cache.find(address); it != symbol_cache.end()) {
+        if (offset)
+            *offset = it->value.offset;
+        return it->value.name;
+    }
+    u32 symbol_offset = 0;
+    auto name = elf.symbolicate(address, &symbol_offset);
+    symbol_cache.set(address, { name, symbol_offset });
+    if (offset)
+        *offset = symbol_offset;
+    return name;
 }
 
 const LibraryMetadata::Library* LibraryMetadata::library_containing(FlatPtr ptr) const
 {
+    auto contains = [ptr](auto& library) { return ptr >= library.base && ptr < (library.base + library.size); };
+    if (m_last_library_containing && contains(*m_last_library_containing))
+        return m_last_library_containing;
     for (auto& it : m_libraries) {
         auto& library = *it.value;
-        if (ptr >= library.base && ptr < (library.base + library.size))
+        if (contains(library)) {
+            m_last_library_containing = &library;
             return &library;
+        }
     }
     return nullptr;
 }
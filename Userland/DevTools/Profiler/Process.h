@@ -18,6 +18,16 @@ namespace Profiler {
 struct MappedObject {
     NonnullRefPtr<MappedFile> file;
     ELF::Image elf;
+
+    struct Symbol {
+        String name;
+        u32 offset { 0 };
+    };
+    // Samples hit the same addresses over and over again, in every process that maps the object, so each address
+    // (relative to the object) only gets symbolicated once.
+    HashMap<FlatPtr, Symbol> symbol_cache {};
+
+    String symbolicate(FlatPtr address, u32* offset);
 };
 
 extern HashMap<String, OwnPtr<MappedObject>> g_mapped_object_cache;
@@ -39,6 +49,8 @@ public:
 
 private:
     mutable HashMap<String, NonnullOwnPtr<Library>> m_libraries;
+    // Consecutive frames tend to be in the same library.
+    mutable const Library* m_last_library_containing { nullptr };
 };
 
 struct Thread {
@@ -8,12 +8,15 @@
 #include "DisassemblyModel.h"
 #include "ProfileModel.h"
 #include "SamplesModel.h"
+#include <AK/FlyString.h>
 #include <AK/HashTable.h>
+#include <AK/JsonTokenizer.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
+#include <Kernel/API/Syscall.h>
 #include <LibCore/File.h>
 #include <LibELF/Image.h>
 #include <sys/stat.h>
@@ -30,17 +33,38 @@ static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
         child->sort_children();
 }
 
-Profile::Profile(Vector<Process> processes, Vector<Event> events)
+Profile::Profile(Vector<Process> processes, Vector<Event> events, Vector<SchedulingInterval> scheduling_intervals, Vector<TraceEvent> trace_events)
     : m_processes(move(processes))
     , m_events(move(events))
+    , m_scheduling_intervals(move(scheduling_intervals))
+    , m_trace_events(move(trace_events))
 {
-    m_first_timestamp = m_events.first().timestamp;
-    m_last_timestamp = m_events.last().timestamp;
+    // NOTE: A profile can be nothing but trace events, if no samples were asked for.
+    if (!m_events.is_empty()) {
+        m_first_timestamp = m_events.first().timestamp;
+        m_last_timestamp = m_events.last().timestamp;
+    } else {
+        m_first_timestamp = NumericLimits<u64>::max();
+    }
+    for (auto& trace_event : m_trace_events) {
+        m_first_timestamp = min(m_first_timestamp, trace_event.start_timestamp);
+        m_last_timestamp = max(m_last_timestamp, trace_event.end_timestamp);
+    }
+
+    for (size_t i = 0; i < m_events.size(); ++i) {
+        auto& event = m_events[i];
+        if (i > 0 && event.timestamp < m_events[i - 1].timestamp)
+            m_events_are_in_order = false;
+        if (event.type == "malloc"sv || event.type == "free"sv)
+            m_has_allocation_events = true;
+    }
 
     m_model = ProfileModel::create(*this);
     m_samples_model = SamplesModel::create(*this);
+    m_trace_model = TraceModel::create(*this);
 
     rebuild_tree();
+    update_filtered_trace_events();
 }
 
 GUI::Model& Profile::model()
@@ -53,24 +77,137 @@ GUI::Model& Profile::samples_model()
     return *m_samples_model;
 }
 
-void Profile::rebuild_tree()
+GUI::Model& Profile::trace_model()
 {
-    Vector<NonnullRefPtr<ProfileNode>> roots;
+    return *m_trace_model;
+}
 
-    auto find_or_create_process_node = [this, &roots](pid_t pid, EventSerialNumber serial) -> ProfileNode& {
-        auto* process = find_process(pid, serial);
-        if (!process) {
-            dbgln("Profile contains event for unknown process with pid={}, serial={}", pid, serial.to_number());
-            VERIFY_NOT_REACHED();
-        }
-        for (auto root : roots) {
-            if (&root->process() == process)
-                return root;
+Profile::EventRange Profile::events_in_filter_range() const
+{
+    if (!has_timestamp_filter_range() || !m_events_are_in_order)
+        return { 0, m_events.size() };
+
+    // The first event at or after the timestamp, found by binary search.
+    auto first_event_at_or_after = [this](u64 timestamp) {
+        size_t low = 0;
+        size_t high = m_events.size();
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            if (m_events[middle].timestamp < timestamp)
+                low = middle + 1;
+            else
+                high = middle;
         }
-        auto new_root = ProfileNode::create_process_node(*process);
-        roots.append(new_root);
-        return new_root;
+        return low;
     };
+    auto start = first_event_at_or_after(m_timestamp_filter_range_start);
+    auto end = first_event_at_or_after(m_timestamp_filter_range_end + 1);
+    return { start, max(start, end) };
+}
+
+bool Profile::is_in_filter_range(Event const& event) const
+{
+    if (!has_timestamp_filter_range())
+        return true;
+    return event.timestamp >= m_timestamp_filter_range_start && event.timestamp <= m_timestamp_filter_range_end;
+}
+
+ProfileNode& Profile::find_or_create_process_node(Vector<NonnullRefPtr<ProfileNode>>& roots, pid_t pid, EventSerialNumber serial)
+{
+    auto* process = find_process(pid, serial);
+    if (!process) {
+        dbgln("Profile contains event for unknown process with pid={}, serial={}", pid, serial.to_number());
+        VERIFY_NOT_REACHED();
+    }
+    for (auto root : roots) {
+        if (&root->process() == process)
+            return root;
+    }
+    auto new_root = ProfileNode::create_process_node(*process);
+    roots.append(new_root);
+    return new_root;
+}
+
+template<typename Callback>
+void Profile::for_each_frame(Event const& event, Callback callback) const
+{
+    if (!m_inverted) {
+        for (size_t i = 0; i < event.frames.size(); ++i) {
+            if (callback(event.frames.at(i), i == event.frames.size() - 1) == IterationDecision::Break)
+                break;
+        }
+    } else {
+        for (ssize_t i = event.frames.size() - 1; i >= 0; --i) {
+            if (callback(event.frames.at(i), static_cast<size_t>(i) == event.frames.size() - 1) == IterationDecision::Break)
+                break;
+        }
+    }
+}
+
+void Profile::add_event_to_tree(Vector<NonnullRefPtr<ProfileNode>>& roots, Event const& event)
+{
+    ProfileNode* node = nullptr;
+    auto& process_node = find_or_create_process_node(roots, event.pid, event.serial);
+    process_node.increment_event_count();
+    for_each_frame(event, [&](const Frame& frame, bool is_innermost_frame) {
+        auto& object_name = frame.object_name;
+        auto& symbol = frame.symbol;
+        auto& address = frame.address;
+        auto& offset = frame.offset;
+
+        if (symbol.is_empty())
+            return IterationDecision::Break;
+
+        // FIXME: More cheating with intentional mixing of TID/PID here:
+        if (!node)
+            node = &process_node;
+        node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
+
+        node->increment_event_count();
+        if (is_innermost_frame) {
+            node->add_event_address(address);
+            node->increment_self_count();
+        }
+        return IterationDecision::Continue;
+    });
+}
+
+void Profile::remove_event_from_tree(Event const& event)
+{
+    // This retraces the steps of add_event_to_tree(), so every node on the way exists.
+    auto& process_node = find_or_create_process_node(m_roots, event.pid, event.serial);
+    process_node.decrement_event_count();
+    Vector<ProfileNode*, 64> path;
+    path.append(&process_node);
+    for_each_frame(event, [&](const Frame& frame, bool is_innermost_frame) {
+        if (frame.symbol.is_empty())
+            return IterationDecision::Break;
+
+        auto* node = path.last()->find_child(frame.symbol);
+        VERIFY(node);
+        node->decrement_event_count();
+        if (is_innermost_frame) {
+            node->remove_event_address(frame.address);
+            node->decrement_self_count();
+        }
+        path.append(node);
+        return IterationDecision::Continue;
+    });
+
+    // Nodes that no event goes through anymore go away, just like they wouldn't be there after a rebuild.
+    for (size_t i = path.size() - 1; i > 0; --i) {
+        if (path[i]->event_count() == 0)
+            path[i - 1]->remove_child(*path[i]);
+    }
+    if (process_node.event_count() == 0)
+        m_roots.remove_first_matching([&](auto& root) { return root.ptr() == &process_node; });
+}
+
+void Profile::rebuild_tree()
+{
+    Vector<NonnullRefPtr<ProfileNode>> roots;
+
+    auto range = events_in_filter_range();
 
     HashTable<FlatPtr> live_allocations;
 
@@ -83,14 +220,11 @@ void Profile::rebuild_tree()
 
     m_filtered_event_indices.clear();
 
-    for (size_t event_index = 0; event_index < m_events.size(); ++event_index) {
+    for (size_t event_index = range.start; event_index < range.end; ++event_index) {
         auto& event = m_events.at(event_index);
 
-        if (has_timestamp_filter_range()) {
-            auto timestamp = event.timestamp;
-            if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                continue;
-        }
+        if (!is_in_filter_range(event))
+            continue;
 
         if (!process_filter_contains(event.pid, event.serial))
             continue;
@@ -103,47 +237,10 @@ void Profile::rebuild_tree()
         if (event.type == "free"sv)
             continue;
 
-        auto for_each_frame = [&]<typename Callback>(Callback callback) {
-            if (!m_inverted) {
-                for (size_t i = 0; i < event.frames.size(); ++i) {
-                    if (callback(event.frames.at(i), i == event.frames.size() - 1) == IterationDecision::Break)
-                        break;
-                }
-            } else {
-                for (ssize_t i = event.frames.size() - 1; i >= 0; --i) {
-                    if (callback(event.frames.at(i), static_cast<size_t>(i) == event.frames.size() - 1) == IterationDecision::Break)
-                        break;
-                }
-            }
-        };
-
         if (!m_show_top_functions) {
-            ProfileNode* node = nullptr;
-            auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
-            for_each_frame([&](const Frame& frame, bool is_innermost_frame) {
-                auto& object_name = frame.object_name;
-                auto& symbol = frame.symbol;
-                auto& address = frame.address;
-                auto& offset = frame.offset;
-
-                if (symbol.is_empty())
-                    return IterationDecision::Break;
-
-                // FIXME: More cheating with intentional mixing of TID/PID here:
-                if (!node)
-                    node = &process_node;
-                node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
-
-                node->increment_event_count();
-                if (is_innermost_frame) {
-                    node->add_event_address(address);
-                    node->increment_self_count();
-                }
-                return IterationDecision::Continue;
-            });
+            add_event_to_tree(roots, event);
         } else {
-            auto& process_node = find_or_create_process_node(event.pid, event.serial);
+            auto& process_node = find_or_create_process_node(roots, event.pid, event.serial);
             process_node.increment_event_count();
             for (size_t i = 0; i < event.frames.size(); ++i) {
                 ProfileNode* node = nullptr;
@@ -159,7 +256,7 @@ void Profile::rebuild_tree()
 
                     // FIXME: More PID/TID mixing cheats here:
                     if (!node) {
-                        node = &find_or_create_process_node(event.pid, event.serial);
+                        node = &find_or_create_process_node(roots, event.pid, event.serial);
                         node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
                         root = node;
                         root->will_track_seen_events(m_events.size());
@@ -186,71 +283,243 @@ void Profile::rebuild_tree()
     sort_profile_nodes(roots);
 
     m_roots = move(roots);
+    m_tree_event_range = range;
     m_model->update();
 }
 
-Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
+void Profile::update_tree_for_filter_range()
 {
-    auto file = Core::File::construct(path);
-    if (!file->open(Core::OpenMode::ReadOnly))
-        return String::formatted("Unable to open {}, error: {}", path, file->error_string());
+    // Dragging across the timeline changes the range a little at a time, so it's a lot cheaper to only add and remove
+    // the events at its ends than to rebuild the tree from all the events in it. That doesn't work if the tree isn't
+    // just the sum of the events in the range, which it isn't with allocations (whose frees may fall out of the
+    // range), or with top functions (which count every event once per function).
+    auto old_range = m_tree_event_range;
+    auto new_range = events_in_filter_range();
+    bool ranges_overlap = new_range.start < old_range.end && old_range.start < new_range.end;
+    if (!m_events_are_in_order || m_has_allocation_events || m_show_top_functions || !ranges_overlap) {
+        rebuild_tree();
+        return;
+    }
+    auto changed_event_count = (max(old_range.start, new_range.start) - min(old_range.start, new_range.start))
+        + (max(old_range.end, new_range.end) - min(old_range.end, new_range.end));
+    if (changed_event_count >= new_range.end - new_range.start) {
+        rebuild_tree();
+        return;
+    }
 
-    auto json = JsonValue::from_string(file->read_all());
-    if (!json.has_value() || !json.value().is_object())
-        return String { "Invalid perfcore format (not a JSON object)" };
+    auto update_events = [&](size_t start, size_t end, bool add) {
+        for (size_t event_index = start; event_index < end; ++event_index) {
+            auto& event = m_events.at(event_index);
+            if (!process_filter_contains(event.pid, event.serial))
+                continue;
+            if (add)
+                add_event_to_tree(m_roots, event);
+            else
+                remove_event_from_tree(event);
+        }
+    };
+    update_events(new_range.start, min(old_range.start, new_range.end), true);
+    update_events(max(old_range.end, new_range.start), new_range.end, true);
+    update_events(old_range.start, min(new_range.start, old_range.end), false);
+    update_events(max(new_range.end, old_range.start), old_range.end, false);
 
-    auto& object = json.value().as_object();
+    m_filtered_event_indices.clear_with_capacity();
+    for (size_t event_index = new_range.start; event_index < new_range.end; ++event_index) {
+        auto& event = m_events.at(event_index);
+        if (process_filter_contains(event.pid, event.serial))
+            m_filtered_event_indices.append(event_index);
+    }
 
-    auto file_or_error = MappedFile::map("/boot/Kernel");
-    OwnPtr<ELF::Image> kernel_elf;
-    if (!file_or_error.is_error())
-        kernel_elf = make<ELF::Image>(file_or_error.value()->bytes());
+    sort_profile_nodes(m_roots);
+    m_tree_event_range = new_range;
+    m_model->update();
+}
+
+namespace {
+
+// One event from a perfcore file, pointing straight into the file instead of copying anything out of it.
+struct PerfEvent {
+    struct Member {
+        JsonToken key;
+        JsonToken value;
+    };
+
+    const JsonToken* get(const StringView& key) const
+    {
+        for (auto& member : members) {
+            if (member.key.string_equals(key))
+                return &member.value;
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    T get_number(const StringView& key) const
+    {
+        auto* value = get(key);
+        return value ? value->to_integer<T>().value_or(0) : 0;
+    }
+
+    i32 get_i32(const StringView& key) const { return get_number<i32>(key); }
+
+    String get_string(const StringView& key) const
+    {
+        auto* value = get(key);
+        if (!value || value->type != JsonToken::Type::String)
+            return {};
+        // These are mostly the same few event types, executables and library names over and over again.
+        if (!value->has_escapes)
+            return FlyString(value->text);
+        return value->to_string();
+    }
 
-    auto events_value = object.get_ptr("events");
-    if (!events_value || !events_value->is_array())
-        return String { "Malformed profile (events is not an array)" };
+    Vector<Member, 16> members;
+    Vector<u32, 64> stack;
+    bool has_stack { false };
+};
 
-    auto& perf_events = events_value->as_array();
+}
+
+static bool read_perf_event(JsonTokenizer& tokenizer, PerfEvent& event)
+{
+    event.members.clear_with_capacity();
+    event.stack.clear_with_capacity();
+    event.has_stack = false;
+
+    for (;;) {
+        auto key = tokenizer.next();
+        if (key.type == JsonToken::Type::ObjectEnd)
+            return true;
+        if (key.type != JsonToken::Type::Key)
+            return false;
+        auto value = tokenizer.next();
+        if (value.type == JsonToken::Type::ArrayStart && key.string_equals("stack"sv)) {
+            event.has_stack = true;
+            for (;;) {
+                auto frame = tokenizer.next();
+                if (frame.type == JsonToken::Type::ArrayEnd)
+                    break;
+                if (frame.type != JsonToken::Type::Number)
+                    return false;
+                event.stack.append(frame.to_integer<u32>().value_or(0));
+            }
+            continue;
+        }
+        if (value.type == JsonToken::Type::ObjectStart || value.type == JsonToken::Type::ArrayStart) {
+            if (!tokenizer.skip_value(value))
+                return false;
+            continue;
+        }
+        if (!value.is_value())
+            return false;
+        event.members.append({ key, value });
+    }
+}
+
+Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
+{
+    // NOTE: Profiles can get big, so the file is read through a mapping, one event at a time.
+    auto perfcore_file_or_error = MappedFile::map(path);
+    if (perfcore_file_or_error.is_error())
+        return String::formatted("Unable to open {}, error: {}", path, perfcore_file_or_error.error());
+    auto& perfcore_file = perfcore_file_or_error.value();
+
+    JsonTokenizer tokenizer(StringView { static_cast<const char*>(perfcore_file->data()), perfcore_file->size() });
+    if (!tokenizer.next_is(JsonToken::Type::ObjectStart))
+        return String { "Invalid perfcore format (not a JSON object)" };
+
+    // Everything but the events is skipped.
+    for (;;) {
+        auto key = tokenizer.next();
+        if (key.type != JsonToken::Type::Key)
+            return String { "Malformed profile (events is not an array)" };
+        auto value = tokenizer.next();
+        if (key.string_equals("events"sv)) {
+            if (value.type != JsonToken::Type::ArrayStart)
+                return String { "Malformed profile (events is not an array)" };
+            break;
+        }
+        if (!tokenizer.skip_value(value))
+            return String { "Invalid perfcore format (not a JSON object)" };
+    }
+
+    auto file_or_error = MappedFile::map("/boot/Kernel");
+    OwnPtr<MappedObject> kernel_object;
+    if (!file_or_error.is_error()) {
+        auto elf = ELF::Image(file_or_error.value()->bytes());
+        kernel_object = adopt_own(*new MappedObject {
+            .file = file_or_error.release_value(),
+            .elf = elf,
+        });
+    }
 
     NonnullOwnPtrVector<Process> all_processes;
     HashMap<pid_t, Process*> current_processes;
     Vector<Event> events;
     EventSerialNumber next_serial;
 
-    for (auto& perf_event_value : perf_events.values()) {
-        auto& perf_event = perf_event_value.as_object();
+    struct BlockedThread {
+        u64 timestamp { 0 };
+        String blocker;
+    };
+    Vector<SchedulingInterval> scheduling_intervals;
+    HashMap<pid_t, BlockedThread> blocked_threads;
+    HashMap<pid_t, u64> runnable_threads;
+
+    struct PendingSyscall {
+        u64 timestamp { 0 };
+        u32 function { 0 };
+    };
+    Vector<TraceEvent> trace_events;
+    HashMap<pid_t, PendingSyscall> pending_syscalls;
+    // The sends that no receive has been matched up with yet, keyed by endpoint magic and message id, oldest first.
+    HashMap<u64, Vector<size_t>> unmatched_ipc_sends;
+    auto ipc_message_key = [](PerfEvent const& perf_event) {
+        return (static_cast<u64>(perf_event.get_number<u32>("endpoint_magic"sv)) << 32) | perf_event.get_number<u32>("message_id"sv);
+    };
+    auto ipc_message_description = [](PerfEvent const& perf_event) {
+        return String::formatted("Endpoint {:08x}, message {}", perf_event.get_number<u32>("endpoint_magic"sv), perf_event.get_i32("message_id"sv));
+    };
+
+    PerfEvent perf_event;
+    for (;;) {
+        auto token = tokenizer.next();
+        if (token.type == JsonToken::Type::ArrayEnd)
+            break;
+        if (token.type != JsonToken::Type::ObjectStart || !read_perf_event(tokenizer, perf_event))
+            return String { "Malformed profile (events must be objects)" };
 
         Event event;
 
         event.serial = next_serial;
         next_serial.increment();
-        event.timestamp = perf_event.get("timestamp").to_number<u64>();
-        event.lost_samples = perf_event.get("lost_samples").to_number<u32>();
-        event.type = perf_event.get("type").to_string();
-        event.pid = perf_event.get("pid").to_i32();
-        event.tid = perf_event.get("tid").to_i32();
+        event.timestamp = perf_event.get_number<u64>("timestamp"sv);
+        event.lost_samples = perf_event.get_number<u32>("lost_samples"sv);
+        event.type = perf_event.get_string("type"sv);
+        event.pid = perf_event.get_i32("pid"sv);
+        event.tid = perf_event.get_i32("tid"sv);
 
         if (event.type == "malloc"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
+            event.ptr = perf_event.get_number<FlatPtr>("ptr"sv);
+            event.size = perf_event.get_number<size_t>("size"sv);
         } else if (event.type == "free"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
+            event.ptr = perf_event.get_number<FlatPtr>("ptr"sv);
         } else if (event.type == "mmap"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
-            event.name = perf_event.get("name").to_string();
+            event.ptr = perf_event.get_number<FlatPtr>("ptr"sv);
+            event.size = perf_event.get_number<size_t>("size"sv);
+            event.name = perf_event.get_string("name"sv);
 
             auto it = current_processes.find(event.pid);
             if (it != current_processes.end())
                 it->value->library_metadata.handle_mmap(event.ptr, event.size, event.name);
             continue;
         } else if (event.type == "munmap"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
+            event.ptr = perf_event.get_number<FlatPtr>("ptr"sv);
+            event.size = perf_event.get_number<size_t>("size"sv);
             continue;
         } else if (event.type == "process_create"sv) {
-            event.parent_pid = perf_event.get("parent_pid").to_number<FlatPtr>();
-            event.executable = perf_event.get("executable").to_string();
+            event.parent_pid = perf_event.get_number<FlatPtr>("parent_pid"sv);
+            event.executable = perf_event.get_string("executable"sv);
 
             auto sampled_process = adopt_own(*new Process {
                 .pid = event.pid,
@@ -264,7 +533,7 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
             all_processes.append(move(sampled_process));
             continue;
         } else if (event.type == "process_exec"sv) {
-            event.executable = perf_event.get("executable").to_string();
+            event.executable = perf_event.get_string("executable"sv);
 
             auto old_process = current_processes.get(event.pid).value();
             old_process->end_valid = event.serial;
@@ -289,7 +558,7 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
             current_processes.remove(event.pid);
             continue;
         } else if (event.type == "thread_create"sv) {
-            event.parent_tid = perf_event.get("parent_tid").to_i32();
+            event.parent_tid = perf_event.get_i32("parent_tid"sv);
             auto it = current_processes.find(event.pid);
             if (it != current_processes.end())
                 it->value->handle_thread_create(event.tid, event.serial);
@@ -299,21 +568,82 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
             if (it != current_processes.end())
                 it->value->handle_thread_exit(event.tid, event.serial);
             continue;
+        } else if (event.type == "thread_block"sv) {
+            // A thread that blocks is running, whatever we thought.
+            runnable_threads.remove(event.tid);
+            blocked_threads.set(event.tid, { event.timestamp, perf_event.get_string("blocker"sv) });
+            continue;
+        } else if (event.type == "thread_wakeup"sv) {
+            if (auto it = blocked_threads.find(event.tid); it != blocked_threads.end()) {
+                scheduling_intervals.append({ SchedulingInterval::Kind::Blocked, event.pid, event.tid, it->value.timestamp, event.timestamp, move(it->value.blocker) });
+                blocked_threads.remove(it);
+            }
+            runnable_threads.set(event.tid, event.timestamp);
+            continue;
+        } else if (event.type == "context_switch"sv) {
+            auto next_tid = perf_event.get_i32("next_tid"sv);
+            if (auto it = runnable_threads.find(next_tid); it != runnable_threads.end()) {
+                scheduling_intervals.append({ SchedulingInterval::Kind::Runnable, perf_event.get_i32("next_pid"sv), next_tid, it->value, event.timestamp, {} });
+                runnable_threads.remove(it);
+            }
+        } else if (event.type == "syscall_enter"sv) {
+            pending_syscalls.set(event.tid, { event.timestamp, perf_event.get_number<u32>("function"sv) });
+            continue;
+        } else if (event.type == "syscall_exit"sv) {
+            auto function = perf_event.get_number<u32>("function"sv);
+            // A syscall that was already going on when the profile started only has an exit.
+            u64 start_timestamp = event.timestamp;
+            if (auto it = pending_syscalls.find(event.tid); it != pending_syscalls.end()) {
+                if (it->value.function == function)
+                    start_timestamp = it->value.timestamp;
+                pending_syscalls.remove(it);
+            }
+            auto description = String::formatted("{}() = {}", Syscall::to_string(static_cast<Syscall::Function>(function)), perf_event.get_i32("result"sv));
+            trace_events.append({ TraceEvent::Kind::Syscall, event.serial, event.pid, event.tid, start_timestamp, event.timestamp, move(description), {} });
+            continue;
+        } else if (event.type == "irq"sv) {
+            trace_events.append({ TraceEvent::Kind::IRQ, event.serial, event.pid, event.tid, event.timestamp, event.timestamp, String::formatted("IRQ {}", perf_event.get_i32("irq"sv)), {} });
+            continue;
+        } else if (event.type == "ipc_send"sv) {
+            unmatched_ipc_sends.ensure(ipc_message_key(perf_event)).append(trace_events.size());
+            trace_events.append({ TraceEvent::Kind::IPCSend, event.serial, event.pid, event.tid, event.timestamp, event.timestamp, ipc_message_description(perf_event), {} });
+            continue;
+        } else if (event.type == "ipc_receive"sv) {
+            // NOTE: There's nothing in the events that says which connection a message went over, so this goes with
+            //       the oldest send of the same message by some other process. That's right unless several processes
+            //       send the same message at the same time.
+            Optional<size_t> peer_index;
+            if (auto it = unmatched_ipc_sends.find(ipc_message_key(perf_event)); it != unmatched_ipc_sends.end()) {
+                auto& sends = it->value;
+                for (size_t i = 0; i < sends.size(); ++i) {
+                    if (trace_events[sends[i]].pid == event.pid)
+                        continue;
+                    peer_index = sends.take(i);
+                    trace_events[peer_index.value()].peer_index = trace_events.size();
+                    break;
+                }
+            }
+            trace_events.append({ TraceEvent::Kind::IPCReceive, event.serial, event.pid, event.tid, event.timestamp, event.timestamp, ipc_message_description(perf_event), peer_index });
+            continue;
+        } else if (event.type == "event_loop_dispatch"sv) {
+            // This is recorded once the event has been dispatched.
+            u64 duration_ms = perf_event.get_number<u32>("duration_us"sv) / 1000;
+            u64 start_timestamp = event.timestamp > duration_ms ? event.timestamp - duration_ms : 0;
+            auto description = String::formatted("Event type {}", perf_event.get_number<u32>("event_type"sv));
+            trace_events.append({ TraceEvent::Kind::EventLoopDispatch, event.serial, event.pid, event.tid, start_timestamp, event.timestamp, move(description), {} });
+            continue;
         }
 
-        auto* stack = perf_event.get_ptr("stack");
-        VERIFY(stack);
-        auto& stack_array = stack->as_array();
-        for (ssize_t i = stack_array.values().size() - 1; i >= 0; --i) {
-            auto& frame = stack_array.at(i);
-            auto ptr = frame.to_number<u32>();
+        VERIFY(perf_event.has_stack);
+        for (ssize_t i = perf_event.stack.size() - 1; i >= 0; --i) {
+            auto ptr = perf_event.stack[i];
             u32 offset = 0;
             FlyString object_name;
             String symbol;
 
             if (ptr >= 0xc0000000) {
-                if (kernel_elf) {
-                    symbol = kernel_elf->symbolicate(ptr, &offset);
+                if (kernel_object) {
+                    symbol = kernel_object->symbolicate(ptr, &offset);
                 } else {
                     symbol = String::formatted("?? <{:p}>", ptr);
                 }
@@ -343,7 +673,7 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
         events.append(move(event));
     }
 
-    if (events.is_empty())
+    if (events.is_empty() && trace_events.is_empty())
         return String { "No events captured (targeted process was never on CPU)" };
 
     quick_sort(all_processes, [](auto& a, auto& b) {
@@ -357,7 +687,88 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
     for (auto& it : all_processes)
         processes.append(move(it));
 
-    return adopt_own(*new Profile(move(processes), move(events)));
+    return adopt_own(*new Profile(move(processes), move(events), move(scheduling_intervals), move(trace_events)));
+}
+
+HashMap<String, Profile::FunctionSamples> Profile::samples_per_function() const
+{
+    HashMap<String, FunctionSamples> functions;
+    // The sample that each function has last been counted for, so recursion doesn't count it more than once.
+    HashMap<String, size_t> last_counted_event;
+    for (size_t event_index = 0; event_index < m_events.size(); ++event_index) {
+        auto& event = m_events[event_index];
+        if (event.type != "sample"sv)
+            continue;
+        for (size_t i = 0; i < event.frames.size(); ++i) {
+            auto& frame = event.frames[i];
+            if (frame.symbol.is_empty())
+                break;
+            auto& function = functions.ensure(frame.symbol);
+            if (function.symbol.is_null()) {
+                function.object_name = frame.object_name;
+                function.symbol = frame.symbol;
+            }
+            if (i == event.frames.size() - 1)
+                ++function.self_count;
+            auto last_counted = last_counted_event.get(frame.symbol);
+            if (last_counted.has_value() && last_counted.value() == event_index)
+                continue;
+            last_counted_event.set(frame.symbol, event_index);
+            ++function.total_count;
+        }
+    }
+    return functions;
+}
+
+size_t Profile::sample_count() const
+{
+    size_t count = 0;
+    for (auto& event : m_events) {
+        if (event.type == "sample"sv)
+            ++count;
+    }
+    return count;
+}
+
+String Profile::to_folded_stacks() const
+{
+    // The stacks are keyed by their folded form, and listed in the order they first showed up.
+    HashMap<String, size_t> stack_indices;
+    Vector<String> stacks;
+    Vector<size_t> counts;
+    StringBuilder builder;
+    for (auto event_index : m_filtered_event_indices) {
+        auto& event = m_events[event_index];
+        if (event.type != "sample"sv)
+            continue;
+        builder.clear();
+        if (auto* process = find_process(event.pid, event.serial))
+            builder.append(process->basename);
+        else
+            builder.appendff("{}", event.pid);
+        for (auto& frame : event.frames) {
+            if (frame.symbol.is_empty())
+                break;
+            // Semicolons separate the frames, so they can't show up in the symbols themselves.
+            auto symbol = frame.symbol;
+            symbol.replace(";", ":", true);
+            builder.append(';');
+            builder.append(symbol);
+        }
+        auto stack = builder.to_string();
+        if (auto it = stack_indices.find(stack); it != stack_indices.end()) {
+            ++counts[it->value];
+            continue;
+        }
+        stack_indices.set(stack, stacks.size());
+        stacks.append(move(stack));
+        counts.append(1);
+    }
+
+    builder.clear();
+    for (size_t i = 0; i < stacks.size(); ++i)
+        builder.appendff("{} {}\n", stacks[i], counts[i]);
+    return builder.to_string();
 }
 
 void ProfileNode::sort_children()
@@ -374,8 +785,9 @@ void Profile::set_timestamp_filter_range(u64 start, u64 end)
     m_timestamp_filter_range_start = min(start, end);
     m_timestamp_filter_range_end = max(start, end);
 
-    rebuild_tree();
+    update_tree_for_filter_range();
     m_samples_model->update();
+    update_filtered_trace_events();
 }
 
 void Profile::clear_timestamp_filter_range()
@@ -383,8 +795,9 @@ void Profile::clear_timestamp_filter_range()
     if (!m_has_timestamp_filter_range)
         return;
     m_has_timestamp_filter_range = false;
-    rebuild_tree();
+    update_tree_for_filter_range();
     m_samples_model->update();
+    update_filtered_trace_events();
 }
 
 void Profile::add_process_filter(pid_t pid, EventSerialNumber start_valid, EventSerialNumber end_valid)
@@ -398,6 +811,7 @@ void Profile::add_process_filter(pid_t pid, EventSerialNumber start_valid, Event
     if (m_disassembly_model)
         m_disassembly_model->update();
     m_samples_model->update();
+    update_filtered_trace_events();
 }
 
 void Profile::remove_process_filter(pid_t pid, EventSerialNumber start_valid, EventSerialNumber end_valid)
@@ -413,6 +827,7 @@ void Profile::remove_process_filter(pid_t pid, EventSerialNumber start_valid, Ev
     if (m_disassembly_model)
         m_disassembly_model->update();
     m_samples_model->update();
+    update_filtered_trace_events();
 }
 
 void Profile::clear_process_filter()
@@ -424,6 +839,21 @@ void Profile::clear_process_filter()
     if (m_disassembly_model)
         m_disassembly_model->update();
     m_samples_model->update();
+    update_filtered_trace_events();
+}
+
+void Profile::update_filtered_trace_events()
+{
+    m_filtered_trace_event_indices.clear_with_capacity();
+    for (size_t i = 0; i < m_trace_events.size(); ++i) {
+        auto& trace_event = m_trace_events[i];
+        if (has_timestamp_filter_range() && (trace_event.end_timestamp < m_timestamp_filter_range_start || trace_event.start_timestamp > m_timestamp_filter_range_end))
+            continue;
+        if (!process_filter_contains(trace_event.pid, trace_event.serial))
+            continue;
+        m_filtered_trace_event_indices.append(i);
+    }
+    m_trace_model->update();
 }
 
 bool Profile::process_filter_contains(pid_t pid, EventSerialNumber serial)
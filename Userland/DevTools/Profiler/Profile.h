@@ -11,6 +11,7 @@
 #include "Profile.h"
 #include "ProfileModel.h"
 #include "SamplesModel.h"
+#include "TraceModel.h"
 #include <AK/Bitmap.h>
 #include <AK/FlyString.h>
 #include <AK/JsonArray.h>
@@ -68,24 +69,38 @@ public:
         m_children.append(child);
     }
 
-    ProfileNode& find_or_create_child(FlyString object_name, String symbol, u32 address, u32 offset, u64 timestamp, pid_t pid)
+    ProfileNode* find_child(const String& symbol)
     {
-        for (size_t i = 0; i < m_children.size(); ++i) {
-            auto& child = m_children[i];
-            if (child->symbol() == symbol) {
-                return child;
-            }
+        for (auto& child : m_children) {
+            if (child->symbol() == symbol)
+                return child.ptr();
         }
+        return nullptr;
+    }
+
+    ProfileNode& find_or_create_child(FlyString object_name, String symbol, u32 address, u32 offset, u64 timestamp, pid_t pid)
+    {
+        if (auto* child = find_child(symbol))
+            return *child;
         auto new_child = ProfileNode::create(m_process, move(object_name), move(symbol), address, offset, timestamp, pid);
         add_child(new_child);
         return new_child;
     };
 
+    void remove_child(ProfileNode& child)
+    {
+        VERIFY(child.m_parent == this);
+        child.m_parent = nullptr;
+        m_children.remove_first_matching([&](auto& entry) { return entry.ptr() == &child; });
+    }
+
     ProfileNode* parent() { return m_parent; }
     const ProfileNode* parent() const { return m_parent; }
 
     void increment_event_count() { ++m_event_count; }
+    void decrement_event_count() { --m_event_count; }
     void increment_self_count() { ++m_self_count; }
+    void decrement_self_count() { --m_self_count; }
 
     void sort_children();
 
@@ -98,6 +113,13 @@ public:
         else
             m_events_per_address.set(address, it->value + 1);
     }
+    void remove_event_address(FlatPtr address)
+    {
+        auto it = m_events_per_address.find(address);
+        VERIFY(it != m_events_per_address.end());
+        if (--it->value == 0)
+            m_events_per_address.remove(it);
+    }
 
     pid_t pid() const { return m_pid; }
 
@@ -180,6 +202,50 @@ public:
     };
 
     const Vector<Event>& events() const { return m_events; }
+
+    // A stretch of time in which a thread wasn't running, either because it was blocked, or because
+    // it had been woken up, but was still waiting for a processor.
+    struct SchedulingInterval {
+        enum class Kind {
+            Blocked,
+            Runnable,
+        };
+        Kind kind { Kind::Blocked };
+        pid_t pid { 0 };
+        pid_t tid { 0 };
+        u64 start_timestamp { 0 };
+        u64 end_timestamp { 0 };
+        String blocker;
+    };
+
+    const Vector<SchedulingInterval>& scheduling_intervals() const { return m_scheduling_intervals; }
+
+    // What the tracepoints recorded (see `profile -t`). Syscalls and event loop dispatches take a while,
+    // the rest happen at one point in time and have the same start and end.
+    struct TraceEvent {
+        enum class Kind {
+            Syscall,
+            IRQ,
+            IPCSend,
+            IPCReceive,
+            EventLoopDispatch,
+        };
+        Kind kind { Kind::Syscall };
+        EventSerialNumber serial;
+        pid_t pid { 0 };
+        pid_t tid { 0 };
+        u64 start_timestamp { 0 };
+        u64 end_timestamp { 0 };
+        String description;
+        // For IPC messages, the index of the event on the other end of the connection (the receive for a send,
+        // and the other way around), if it could be matched up.
+        Optional<size_t> peer_index;
+    };
+
+    const Vector<TraceEvent>& trace_events() const { return m_trace_events; }
+    // The trace events that overlap the timestamp filter range, and belong to the processes in the filter.
+    const Vector<size_t>& filtered_trace_event_indices() const { return m_filtered_trace_event_indices; }
+    GUI::Model& trace_model();
     const Vector<size_t>& filtered_event_indices() const { return m_filtered_event_indices; }
 
     u64 length_in_ms() const { return m_last_timestamp - m_first_timestamp; }
@@ -206,37 +272,76 @@ public:
 
     const Vector<Process>& processes() const { return m_processes; }
 
+    // How often a function was sampled, by itself (as the innermost frame) and in total (anywhere on the stack).
+    struct FunctionSamples {
+        FlyString object_name;
+        String symbol;
+        u32 self_count { 0 };
+        u32 total_count { 0 };
+    };
+    // Counts the samples of every function over the whole profile, keyed by symbol.
+    HashMap<String, FunctionSamples> samples_per_function() const;
+    size_t sample_count() const;
+
+    // The stacks of the samples in the filter range, in the folded format that flame graph tools take: one line per
+    // distinct stack, with the frames from the outermost one in, separated by semicolons, followed by a count.
+    String to_folded_stacks() const;
+
     template<typename Callback>
     void for_each_event_in_filter_range(Callback callback)
     {
-        for (auto& event : m_events) {
-            if (has_timestamp_filter_range()) {
-                auto timestamp = event.timestamp;
-                if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                    continue;
-            }
-            callback(event);
+        auto range = events_in_filter_range();
+        for (size_t i = range.start; i < range.end; ++i) {
+            auto& event = m_events[i];
+            if (is_in_filter_range(event))
+                callback(event);
         }
     }
 
 private:
-    Profile(Vector<Process>, Vector<Event>);
+    Profile(Vector<Process>, Vector<Event>, Vector<SchedulingInterval>, Vector<TraceEvent>);
+
+    // A range of indices into m_events.
+    struct EventRange {
+        size_t start { 0 };
+        size_t end { 0 };
+    };
+    // The events that may be in the timestamp filter range. If the events are in order (which they normally are),
+    // that's exactly the ones that are, otherwise it's all of them.
+    EventRange events_in_filter_range() const;
+    bool is_in_filter_range(Event const&) const;
+
+    ProfileNode& find_or_create_process_node(Vector<NonnullRefPtr<ProfileNode>>& roots, pid_t, EventSerialNumber);
+    template<typename Callback>
+    void for_each_frame(Event const&, Callback) const;
+    void add_event_to_tree(Vector<NonnullRefPtr<ProfileNode>>& roots, Event const&);
+    void remove_event_from_tree(Event const&);
 
     void rebuild_tree();
+    void update_filtered_trace_events();
+    void update_tree_for_filter_range();
 
     RefPtr<ProfileModel> m_model;
     RefPtr<SamplesModel> m_samples_model;
+    RefPtr<TraceModel> m_trace_model;
     RefPtr<DisassemblyModel> m_disassembly_model;
 
     GUI::ModelIndex m_disassembly_index;
 
     Vector<NonnullRefPtr<ProfileNode>> m_roots;
     Vector<size_t> m_filtered_event_indices;
+    // The events that the tree was last built from.
+    EventRange m_tree_event_range;
+    bool m_events_are_in_order { true };
+    bool m_has_allocation_events { false };
     u64 m_first_timestamp { 0 };
     u64 m_last_timestamp { 0 };
 
     Vector<Process> m_processes;
     Vector<Event> m_events;
+    Vector<SchedulingInterval> m_scheduling_intervals;
+    Vector<TraceEvent> m_trace_events;
+    Vector<size_t> m_filtered_trace_event_indices;
 
     bool m_has_timestamp_filter_range { false };
     u64 m_timestamp_filter_range_start { 0 };
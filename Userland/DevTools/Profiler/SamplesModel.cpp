@@ -45,6 +45,8 @@ String SamplesModel::column_name(int column) const
         return "TID";
     case Column::ExecutableName:
         return "Executable";
+    case Column::EventType:
+        return "Event";
     case Column::LostSamples:
         return "Lost Samples";
     case Column::InnermostStackFrame:
@@ -83,6 +85,9 @@ GUI::Variant SamplesModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return (u32)event.timestamp;
         }
 
+        if (index.column() == Column::EventType)
+            return event.type;
+
         if (index.column() == Column::LostSamples) {
             return event.lost_samples;
         }
@@ -25,6 +25,7 @@ public:
         ProcessID,
         ThreadID,
         ExecutableName,
+        EventType,
         LostSamples,
         InnermostStackFrame,
         __Count
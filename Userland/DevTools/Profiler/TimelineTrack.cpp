@@ -8,6 +8,7 @@
 #include "Histogram.h"
 #include "Profile.h"
 #include "TimelineView.h"
+#include <AK/QuickSort.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Palette.h>
@@ -21,7 +22,19 @@ TimelineTrack::TimelineTrack(TimelineView const& view, Profile const& profile, P
 {
     set_fill_with_background_color(true);
     set_background_role(Gfx::ColorRole::Base);
-    set_fixed_height(40);
+    for (auto& interval : profile.scheduling_intervals()) {
+        if (interval.pid == process.pid && !m_thread_ids.contains_slow(interval.tid))
+            m_thread_ids.append(interval.tid);
+    }
+    for (auto& trace_event : profile.trace_events()) {
+        if (trace_event.pid != process.pid)
+            continue;
+        m_has_trace_events = true;
+        if (!m_thread_ids.contains_slow(trace_event.tid))
+            m_thread_ids.append(trace_event.tid);
+    }
+    quick_sort(m_thread_ids);
+    set_fixed_height(40 + m_thread_ids.size() * lane_height());
     set_scale(view.scale());
     set_frame_thickness(1);
 }
@@ -87,7 +100,8 @@ void TimelineTrack::paint_event(GUI::PaintEvent& event)
             max_value = value;
     }
 
-    float frame_height = (float)frame_inner_rect().height() / (float)max_value;
+    int histogram_height = frame_inner_rect().height() - m_thread_ids.size() * lane_height();
+    float frame_height = (float)histogram_height / (float)max_value;
 
     for (size_t bucket = 0; bucket < bucket_count; bucket++) {
         auto kernel_value = kernel_histogram.at(bucket);
@@ -100,13 +114,69 @@ void TimelineTrack::paint_event(GUI::PaintEvent& event)
         int x = (int)((float)t * column_width);
         int cw = max(1, (int)column_width);
 
-        int kernel_column_height = frame_inner_rect().height() - (int)((float)kernel_value * frame_height);
-        int usermode_column_height = frame_inner_rect().height() - (int)((float)(kernel_value + usermode_value) * frame_height);
+        int kernel_column_height = histogram_height - (int)((float)kernel_value * frame_height);
+        int usermode_column_height = histogram_height - (int)((float)(kernel_value + usermode_value) * frame_height);
 
         constexpr auto kernel_color = Color::from_rgb(0xc25e5a);
         constexpr auto usermode_color = Color::from_rgb(0x5a65c2);
-        painter.fill_rect({ x, frame_thickness() + usermode_column_height, cw, height() - frame_thickness() * 2 }, usermode_color);
-        painter.fill_rect({ x, frame_thickness() + kernel_column_height, cw, height() - frame_thickness() * 2 }, kernel_color);
+        painter.fill_rect({ x, frame_thickness() + usermode_column_height, cw, histogram_height - usermode_column_height }, usermode_color);
+        painter.fill_rect({ x, frame_thickness() + kernel_column_height, cw, histogram_height - kernel_column_height }, kernel_color);
+    }
+
+    // Every thread gets a lane under the samples, showing when it was blocked (off-CPU),
+    // and when it had been woken up but was waiting for a processor (run queue latency).
+    // If anything was traced, what the thread was doing is shown right under that.
+    for (size_t lane = 0; lane < m_thread_ids.size(); ++lane) {
+        int y = frame_thickness() + histogram_height + lane * lane_height();
+        for (auto& interval : m_profile.scheduling_intervals()) {
+            if (interval.pid != m_process.pid || interval.tid != m_thread_ids[lane])
+                continue;
+            int start_x = (int)((float)(clamp_timestamp(interval.start_timestamp) - start_of_trace) * column_width);
+            int end_x = (int)((float)(clamp_timestamp(interval.end_timestamp) - start_of_trace) * column_width);
+
+            constexpr auto blocked_color = Color::from_rgb(0x9e9e9e);
+            constexpr auto runnable_color = Color::from_rgb(0xe0a040);
+            auto color = interval.kind == Profile::SchedulingInterval::Kind::Blocked ? blocked_color : runnable_color;
+            painter.fill_rect({ start_x, y, max(1, end_x - start_x), thread_lane_height - 1 }, color);
+        }
+
+        if (!m_has_trace_events)
+            continue;
+        int trace_y = y + thread_lane_height;
+        // The things that take a while go first, so that the ones at a single point in time can be seen on top of them.
+        for (int pass = 0; pass < 2; ++pass) {
+            for (auto& trace_event : m_profile.trace_events()) {
+                if (trace_event.pid != m_process.pid || trace_event.tid != m_thread_ids[lane])
+                    continue;
+                bool is_span = trace_event.kind == Profile::TraceEvent::Kind::Syscall || trace_event.kind == Profile::TraceEvent::Kind::EventLoopDispatch;
+                if (is_span != (pass == 0))
+                    continue;
+                int start_x = (int)((float)(clamp_timestamp(trace_event.start_timestamp) - start_of_trace) * column_width);
+                int end_x = (int)((float)(clamp_timestamp(trace_event.end_timestamp) - start_of_trace) * column_width);
+
+                constexpr auto syscall_color = Color::from_rgb(0x5aa25e);
+                constexpr auto event_loop_color = Color::from_rgb(0x9c5ac2);
+                constexpr auto irq_color = Color::from_rgb(0xc25e5a);
+                constexpr auto ipc_color = Color::from_rgb(0x3a8fd0);
+                Color color;
+                switch (trace_event.kind) {
+                case Profile::TraceEvent::Kind::Syscall:
+                    color = syscall_color;
+                    break;
+                case Profile::TraceEvent::Kind::EventLoopDispatch:
+                    color = event_loop_color;
+                    break;
+                case Profile::TraceEvent::Kind::IRQ:
+                    color = irq_color;
+                    break;
+                case Profile::TraceEvent::Kind::IPCSend:
+                case Profile::TraceEvent::Kind::IPCReceive:
+                    color = ipc_color;
+                    break;
+                }
+                painter.fill_rect({ start_x, trace_y, max(1, end_x - start_x), trace_lane_height - 1 }, color);
+            }
+        }
     }
 
     u64 normalized_start_time = clamp_timestamp(min(m_view.select_start_time(), m_view.select_end_time()));
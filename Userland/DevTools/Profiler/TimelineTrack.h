@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Vector.h>
 #include <LibGUI/Frame.h>
 
 namespace Profiler {
@@ -28,9 +29,17 @@ private:
 
     explicit TimelineTrack(TimelineView const&, Profile const&, Process const&);
 
+    static constexpr int thread_lane_height = 4;
+    static constexpr int trace_lane_height = 6;
+
+    int lane_height() const { return thread_lane_height + (m_has_trace_events ? trace_lane_height : 0); }
+
     TimelineView const& m_view;
     Profile const& m_profile;
     Process const& m_process;
+    // The threads that have a lane for the time they weren't running, and for what was traced.
+    Vector<pid_t> m_thread_ids;
+    bool m_has_trace_events { false };
 };
 
 }
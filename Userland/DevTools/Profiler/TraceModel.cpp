@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "TraceModel.h"
+#include "Profile.h"
+
+namespace Profiler {
+
+TraceModel::TraceModel(Profile& profile)
+    : m_profile(profile)
+{
+}
+
+TraceModel::~TraceModel()
+{
+}
+
+int TraceModel::row_count(const GUI::ModelIndex&) const
+{
+    return m_profile.filtered_trace_event_indices().size();
+}
+
+int TraceModel::column_count(const GUI::ModelIndex&) const
+{
+    return Column::__Count;
+}
+
+String TraceModel::column_name(int column) const
+{
+    switch (column) {
+    case Column::Timestamp:
+        return "Timestamp";
+    case Column::ProcessID:
+        return "PID";
+    case Column::ThreadID:
+        return "TID";
+    case Column::ExecutableName:
+        return "Executable";
+    case Column::EventType:
+        return "Event";
+    case Column::Duration:
+        return "Duration (ms)";
+    case Column::Description:
+        return "Description";
+    case Column::Peer:
+        return "Peer";
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+String TraceModel::executable_name(pid_t pid, EventSerialNumber serial) const
+{
+    if (auto* process = m_profile.find_process(pid, serial))
+        return process->executable;
+    return "";
+}
+
+static StringView kind_name(Profile::TraceEvent::Kind kind)
+{
+    switch (kind) {
+    case Profile::TraceEvent::Kind::Syscall:
+        return "Syscall";
+    case Profile::TraceEvent::Kind::IRQ:
+        return "IRQ";
+    case Profile::TraceEvent::Kind::IPCSend:
+        return "IPC send";
+    case Profile::TraceEvent::Kind::IPCReceive:
+        return "IPC receive";
+    case Profile::TraceEvent::Kind::EventLoopDispatch:
+        return "Event loop";
+    }
+    VERIFY_NOT_REACHED();
+}
+
+GUI::Variant TraceModel::data(const GUI::ModelIndex& index, GUI::ModelRole role) const
+{
+    size_t trace_event_index = m_profile.filtered_trace_event_indices()[index.row()];
+    auto& trace_event = m_profile.trace_events().at(trace_event_index);
+
+    if (role == GUI::ModelRole::Custom)
+        return trace_event_index;
+
+    if (role == GUI::ModelRole::Display) {
+        switch (index.column()) {
+        case Column::Timestamp:
+            return (u32)trace_event.start_timestamp;
+        case Column::ProcessID:
+            return trace_event.pid;
+        case Column::ThreadID:
+            return trace_event.tid;
+        case Column::ExecutableName:
+            return executable_name(trace_event.pid, trace_event.serial);
+        case Column::EventType:
+            return kind_name(trace_event.kind);
+        case Column::Duration:
+            return (u32)(trace_event.end_timestamp - trace_event.start_timestamp);
+        case Column::Description:
+            return trace_event.description;
+        case Column::Peer: {
+            if (!trace_event.peer_index.has_value())
+                return "";
+            auto& peer = m_profile.trace_events().at(trace_event.peer_index.value());
+            if (trace_event.kind == Profile::TraceEvent::Kind::IPCSend)
+                return String::formatted("{} ({}), received {} ms later", executable_name(peer.pid, peer.serial), peer.pid, peer.start_timestamp - trace_event.start_timestamp);
+            return String::formatted("{} ({}), sent {} ms earlier", executable_name(peer.pid, peer.serial), peer.pid, trace_event.start_timestamp - peer.start_timestamp);
+        }
+        default:
+            return {};
+        }
+    }
+    return {};
+}
+
+void TraceModel::update()
+{
+    did_update(Model::InvalidateAllIndices);
+}
+
+}
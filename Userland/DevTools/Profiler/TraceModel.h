@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "EventSerialNumber.h"
+#include <LibGUI/Model.h>
+
+namespace Profiler {
+
+class Profile;
+
+// The syscalls, interrupts, IPC messages and event loop dispatches of all processes, in the order they were
+// recorded (which is when they ended, for the ones that take a while).
+class TraceModel final : public GUI::Model {
+public:
+    static NonnullRefPtr<TraceModel> create(Profile& profile)
+    {
+        return adopt_ref(*new TraceModel(profile));
+    }
+
+    enum Column {
+        Timestamp,
+        ProcessID,
+        ThreadID,
+        ExecutableName,
+        EventType,
+        Duration,
+        Description,
+        Peer,
+        __Count
+    };
+
+    virtual ~TraceModel() override;
+
+    virtual int row_count(const GUI::ModelIndex& = GUI::ModelIndex()) const override;
+    virtual int column_count(const GUI::ModelIndex& = GUI::ModelIndex()) const override;
+    virtual String column_name(int) const override;
+    virtual GUI::Variant data(const GUI::ModelIndex&, GUI::ModelRole) const override;
+    virtual void update() override;
+    virtual bool is_column_sortable(int) const override { return false; }
+
+private:
+    explicit TraceModel(Profile&);
+
+    String executable_name(pid_t, EventSerialNumber) const;
+
+    Profile& m_profile;
+};
+
+}
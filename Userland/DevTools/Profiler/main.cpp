@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "ComparisonModel.h"
+#include "FlameGraphView.h"
 #include "IndividualSampleModel.h"
 #include "Profile.h"
 #include "TimelineContainer.h"
@@ -13,6 +15,7 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/EventLoop.h>
+#include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <LibCore/Timer.h>
 #include <LibDesktop/Launcher.h>
@@ -20,12 +23,14 @@
 #include <LibGUI/Application.h>
 #include <LibGUI/BoxLayout.h>
 #include <LibGUI/Button.h>
+#include <LibGUI/FilePicker.h>
 #include <LibGUI/Label.h>
 #include <LibGUI/Menu.h>
 #include <LibGUI/Menubar.h>
 #include <LibGUI/MessageBox.h>
 #include <LibGUI/Model.h>
 #include <LibGUI/ProcessChooser.h>
+#include <LibGUI/SortingProxyModel.h>
 #include <LibGUI/Splitter.h>
 #include <LibGUI/Statusbar.h>
 #include <LibGUI/TabWidget.h>
@@ -38,13 +43,18 @@
 using namespace Profiler;
 
 static bool generate_profile(pid_t& pid);
+static bool save_folded_stacks(Profile const&, String const& path, String& error);
 
 int main(int argc, char** argv)
 {
     int pid = 0;
     const char* perfcore_file_arg = nullptr;
+    const char* baseline_file_arg = nullptr;
+    const char* folded_stacks_path = nullptr;
     Core::ArgsParser args_parser;
     args_parser.add_option(pid, "PID to profile", "pid", 'p', "PID");
+    args_parser.add_option(baseline_file_arg, "Compare with an earlier profile", "compare-to", 'c', "perfcore-file");
+    args_parser.add_option(folded_stacks_path, "Save the stacks in the folded format of flame graph tools, and exit", "export-folded", 0, "path");
     args_parser.add_positional_argument(perfcore_file_arg, "Path of perfcore file", "perfcore-file", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -53,6 +63,24 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (folded_stacks_path) {
+        if (!perfcore_file_arg) {
+            warnln("--export-folded needs a perfcore-file argument!");
+            return 1;
+        }
+        auto profile_or_error = Profile::load_from_perfcore_file(perfcore_file_arg);
+        if (profile_or_error.is_error()) {
+            warnln("{}", profile_or_error.error());
+            return 1;
+        }
+        String error;
+        if (!save_folded_stacks(*profile_or_error.value(), folded_stacks_path, error)) {
+            warnln("{}", error);
+            return 1;
+        }
+        return 0;
+    }
+
     auto app = GUI::Application::construct(argc, argv);
     auto app_icon = GUI::Icon::default_icon("app-profiler");
 
@@ -73,6 +101,16 @@ int main(int argc, char** argv)
 
     auto& profile = profile_or_error.value();
 
+    OwnPtr<Profile> baseline;
+    if (baseline_file_arg) {
+        auto baseline_or_error = Profile::load_from_perfcore_file(baseline_file_arg);
+        if (baseline_or_error.is_error()) {
+            GUI::MessageBox::show(nullptr, baseline_or_error.error(), "Profiler", GUI::MessageBox::Type::Error);
+            return 0;
+        }
+        baseline = baseline_or_error.release_value();
+    }
+
     auto window = GUI::Window::construct();
 
     if (!Desktop::Launcher::add_allowed_handler_with_only_specific_urls(
@@ -105,6 +143,14 @@ int main(int argc, char** argv)
                 break;
             }
         }
+        for (auto& trace_event : profile->trace_events()) {
+            if (matching_event_found)
+                break;
+            if (trace_event.pid == process.pid && process.valid_at(trace_event.serial)) {
+                matching_event_found = true;
+                break;
+            }
+        }
         if (!matching_event_found)
             continue;
         auto& timeline_header = timeline_header_container->add<TimelineHeader>(*profile, process);
@@ -168,6 +214,46 @@ int main(int argc, char** argv)
         individual_sample_view.set_model(move(model));
     };
 
+    if (!profile->trace_events().is_empty()) {
+        auto& trace_tab = tab_widget.add_tab<GUI::Widget>("Trace");
+        trace_tab.set_layout<GUI::VerticalBoxLayout>();
+        trace_tab.layout()->set_margins({ 4, 4, 4, 4 });
+
+        auto& trace_table_view = trace_tab.add<GUI::TableView>();
+        trace_table_view.set_model(profile->trace_model());
+        // Selecting something shows when it happened on every timeline, along with the other end of an IPC message.
+        trace_table_view.on_selection_change = [&] {
+            const auto& index = trace_table_view.selection().first();
+            if (!index.is_valid())
+                return;
+            auto& trace_event = profile->trace_events().at(index.data(GUI::ModelRole::Custom).to_integer<size_t>());
+            u64 start = trace_event.start_timestamp;
+            u64 end = trace_event.end_timestamp;
+            if (trace_event.peer_index.has_value()) {
+                auto& peer = profile->trace_events().at(trace_event.peer_index.value());
+                start = min(start, peer.start_timestamp);
+                end = max(end, peer.end_timestamp);
+            }
+            timeline_view->set_select_start_time(start);
+            timeline_view->set_select_end_time(end);
+            timeline_view->set_hover_time(trace_event.start_timestamp);
+        };
+    }
+
+    auto& flame_graph_tab = tab_widget.add_tab<GUI::Widget>("Flame Graph");
+    flame_graph_tab.set_layout<GUI::VerticalBoxLayout>();
+    flame_graph_tab.layout()->set_margins({ 4, 4, 4, 4 });
+    flame_graph_tab.add<FlameGraphView>(*profile);
+
+    if (baseline) {
+        auto& comparison_tab = tab_widget.add_tab<GUI::Widget>("Comparison");
+        comparison_tab.set_layout<GUI::VerticalBoxLayout>();
+        comparison_tab.layout()->set_margins({ 4, 4, 4, 4 });
+        auto& comparison_view = comparison_tab.add<GUI::TableView>();
+        comparison_view.set_model(GUI::SortingProxyModel::create(ComparisonModel::create(*baseline, *profile)));
+        comparison_view.set_key_column_and_sort_order(ComparisonModel::Column::SelfDifference, GUI::SortOrder::Descending);
+    }
+
     const u64 start_of_trace = profile->first_timestamp();
     const u64 end_of_trace = start_of_trace + profile->length_in_ms();
     const auto clamp_timestamp = [start_of_trace, end_of_trace](u64 timestamp) -> u64 {
@@ -193,6 +279,15 @@ int main(int argc, char** argv)
 
     auto menubar = GUI::Menubar::construct();
     auto& file_menu = menubar->add_menu("&File");
+    file_menu.add_action(GUI::Action::create("&Export Folded Stacks...", [&](auto&) {
+        auto path = GUI::FilePicker::get_save_filepath(window, "Untitled", "folded");
+        if (!path.has_value())
+            return;
+        String error;
+        if (!save_folded_stacks(*profile, path.value(), error))
+            GUI::MessageBox::show(window, error, "Profiler", GUI::MessageBox::Type::Error);
+    }));
+    file_menu.add_separator();
     file_menu.add_action(GUI::CommonActions::make_quit_action([&](auto&) { app->quit(); }));
 
     auto& view_menu = menubar->add_menu("&View");
@@ -230,6 +325,20 @@ int main(int argc, char** argv)
     return app->exec();
 }
 
+bool save_folded_stacks(Profile const& profile, String const& path, String& error)
+{
+    auto file_or_error = Core::File::open(path, Core::OpenMode::WriteOnly);
+    if (file_or_error.is_error()) {
+        error = String::formatted("Unable to open {}: {}", path, file_or_error.error());
+        return false;
+    }
+    if (!file_or_error.value()->write(profile.to_folded_stacks())) {
+        error = String::formatted("Unable to write {}: {}", path, file_or_error.value()->error_string());
+        return false;
+    }
+    return true;
+}
+
 static bool prompt_to_stop_profiling(pid_t pid, const String& process_name)
 {
     auto window = GUI::Window::construct();
@@ -207,16 +207,41 @@ bool Emulator::load_elf()
 }
 
 int Emulator::exec()
+{
+    InstructionCache::Block* previous_block = nullptr;
+    while (!m_shutdown) {
+        auto& block = m_instruction_cache.block_at(m_cpu.eip(), previous_block);
+        previous_block = run_block(block) ? &block : nullptr;
+    }
+
+    if (auto* tracer = malloc_tracer())
+        tracer->dump_leak_report();
+
+    return m_exit_status;
+}
+
+// Runs the block until execution leaves it, decoding more instructions whenever it runs past its end.
+// Returns false if the instruction cache has been invalidated meanwhile, and the block is gone.
+bool Emulator::run_block(InstructionCache::Block& block)
 {
     // X86::ELFSymbolProvider symbol_provider(*m_elf);
     X86::ELFSymbolProvider* symbol_provider = nullptr;
 
     constexpr bool trace = false;
 
-    while (!m_shutdown) {
+    auto generation = m_instruction_cache.generation();
+    for (size_t i = 0;; ++i) {
         m_cpu.save_base_eip();
 
-        auto insn = X86::Instruction::from_stream(m_cpu, true, true);
+        const InstructionCache::CachedInstruction* cached;
+        if (i < block.instructions.size()) {
+            cached = &block.instructions[i];
+            m_cpu.set_eip(cached->next_address);
+        } else {
+            cached = &m_instruction_cache.decode_into(block, m_cpu);
+        }
+        auto& insn = cached->instruction;
+        auto next_address = cached->next_address;
 
         if constexpr (trace) {
             outln("{:p}  \033[33;1m{}\033[0m", m_cpu.base_eip(), insn.to_string(m_cpu.base_eip(), symbol_provider));
@@ -228,15 +253,17 @@ int Emulator::exec()
             m_cpu.dump();
         }
 
+        if (m_instruction_cache.generation() != generation) [[unlikely]]
+            return false;
+
         if (m_pending_signals) [[unlikely]] {
             dispatch_one_pending_signal();
+            return true;
         }
-    }
 
-    if (auto* tracer = malloc_tracer())
-        tracer->dump_leak_report();
-
-    return m_exit_status;
+        if (m_shutdown || m_cpu.eip() != next_address)
+            return true;
+    }
 }
 
 Vector<FlatPtr> Emulator::raw_backtrace()
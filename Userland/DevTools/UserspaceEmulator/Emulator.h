@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "InstructionCache.h"
 #include "MallocTracer.h"
 #include "RangeAllocator.h"
 #include "Report.h"
@@ -40,6 +41,7 @@ public:
     u32 virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3);
 
     SoftMMU& mmu() { return m_mmu; }
+    InstructionCache& instruction_cache() { return m_instruction_cache; }
 
     MallocTracer* malloc_tracer() { return m_malloc_tracer; }
 
@@ -59,9 +61,12 @@ private:
 
     SoftMMU m_mmu;
     SoftCPU m_cpu;
+    InstructionCache m_instruction_cache { SoftMMU::page_count };
 
     OwnPtr<MallocTracer> m_malloc_tracer;
 
+    bool run_block(InstructionCache::Block&);
+
     void setup_stack(Vector<ELF::AuxiliaryValue>);
     Vector<ELF::AuxiliaryValue> generate_auxiliary_vector(FlatPtr load_base, FlatPtr entry_eip, String executable_path, int executable_fd) const;
     void register_signal_handlers();
@@ -157,6 +162,8 @@ private:
     int virt$getsid(pid_t);
     int virt$sched_setparam(int, FlatPtr);
     int virt$sched_getparam(pid_t, FlatPtr);
+    int virt$sched_setaffinity(pid_t, size_t, FlatPtr);
+    int virt$sched_getaffinity(pid_t, size_t, FlatPtr);
     int virt$set_thread_name(pid_t, FlatPtr, size_t);
     pid_t virt$setsid();
     int virt$create_inode_watcher(unsigned);
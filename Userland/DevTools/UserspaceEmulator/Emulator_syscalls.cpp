@@ -218,6 +218,10 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$sched_getparam(arg1, arg2);
     case SC_sched_setparam:
         return virt$sched_setparam(arg1, arg2);
+    case SC_sched_getaffinity:
+        return virt$sched_getaffinity(arg1, arg2, arg3);
+    case SC_sched_setaffinity:
+        return virt$sched_setaffinity(arg1, arg2, arg3);
     case SC_set_thread_name:
         return virt$set_thread_name(arg1, arg2, arg3);
     case SC_setsid:
@@ -1392,6 +1396,26 @@ int Emulator::virt$sched_setparam(int pid, FlatPtr user_addr)
     return syscall(SC_sched_setparam, pid, &user_param);
 }
 
+int Emulator::virt$sched_getaffinity(pid_t pid, size_t cpusetsize, FlatPtr user_addr)
+{
+    cpu_set_t user_mask;
+    if (cpusetsize < sizeof(user_mask))
+        return -EINVAL;
+    auto rc = syscall(SC_sched_getaffinity, pid, sizeof(user_mask), &user_mask);
+    if (rc >= 0)
+        mmu().copy_to_vm(user_addr, &user_mask, sizeof(user_mask));
+    return rc;
+}
+
+int Emulator::virt$sched_setaffinity(pid_t pid, size_t cpusetsize, FlatPtr user_addr)
+{
+    cpu_set_t user_mask;
+    if (cpusetsize < sizeof(user_mask))
+        return -EINVAL;
+    mmu().copy_from_vm(&user_mask, user_addr, sizeof(user_mask));
+    return syscall(SC_sched_setaffinity, pid, sizeof(user_mask), &user_mask);
+}
+
 int Emulator::virt$set_thread_name(pid_t pid, FlatPtr name_addr, size_t name_length)
 {
     auto user_name = mmu().copy_buffer_from_vm(name_addr, name_length);
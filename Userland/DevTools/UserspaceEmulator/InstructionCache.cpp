@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "InstructionCache.h"
+#include "SoftCPU.h"
+
+namespace UserspaceEmulator {
+
+InstructionCache::InstructionCache(size_t page_count)
+    : m_pages_with_code(page_count, false)
+{
+}
+
+InstructionCache::Block& InstructionCache::block_at(u32 address, Block* previous)
+{
+    if (previous && previous->successor && previous->successor->address == address)
+        return *previous->successor;
+
+    Block* block;
+    if (auto it = m_blocks.find(address); it != m_blocks.end()) {
+        block = it->value.ptr();
+    } else {
+        auto new_block = make<Block>(address);
+        block = new_block.ptr();
+        m_blocks.set(address, move(new_block));
+    }
+    if (previous)
+        previous->successor = block;
+    return *block;
+}
+
+const InstructionCache::CachedInstruction& InstructionCache::decode_into(Block& block, SoftCPU& cpu)
+{
+    u32 address = cpu.eip();
+    auto instruction = X86::Instruction::from_stream(cpu, true, true);
+    u32 next_address = cpu.eip();
+    m_pages_with_code.set(address / PAGE_SIZE, true);
+    m_pages_with_code.set((next_address - 1) / PAGE_SIZE, true);
+    block.instructions.append({ instruction, next_address });
+    return block.instructions.last();
+}
+
+void InstructionCache::did_unmap(u32 address, size_t size)
+{
+    for (size_t page = address / PAGE_SIZE; page <= (address + size - 1) / PAGE_SIZE; ++page) {
+        if (m_pages_with_code.get(page)) {
+            invalidate();
+            return;
+        }
+    }
+}
+
+void InstructionCache::invalidate()
+{
+    m_blocks.clear();
+    m_pages_with_code.fill(false);
+    ++m_generation;
+}
+
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibX86/Instruction.h>
+
+namespace UserspaceEmulator {
+
+class SoftCPU;
+
+// Instructions that have been decoded before, so that code which runs over and over only has to be decoded once.
+// They are kept in blocks of straight-line code, which grow as execution runs past their end. Any write to a page
+// that instructions were decoded from throws the whole cache away, since the code may have changed.
+class InstructionCache {
+public:
+    explicit InstructionCache(size_t page_count);
+
+    struct CachedInstruction {
+        X86::Instruction instruction;
+        u32 next_address { 0 };
+    };
+
+    struct Block {
+        explicit Block(u32 address)
+            : address(address)
+        {
+        }
+
+        u32 address { 0 };
+        Vector<CachedInstruction> instructions;
+        // Where execution went the last time it left this block, so that hot paths go from one block to the
+        // next without having to look it up.
+        Block* successor { nullptr };
+    };
+
+    // Returns the block for the address, where the previous block (if it's still around) was left for it.
+    Block& block_at(u32 address, Block* previous);
+
+    // Decodes the instruction at the CPU's eip, which it leaves at the next instruction, and adds it to the end of the block.
+    const CachedInstruction& decode_into(Block&, SoftCPU&);
+
+    ALWAYS_INLINE void did_write(u32 address, size_t size)
+    {
+        if (m_pages_with_code.get(address / PAGE_SIZE) || m_pages_with_code.get((address + size - 1) / PAGE_SIZE)) [[unlikely]]
+            invalidate();
+    }
+    void did_unmap(u32 address, size_t size);
+
+    // Changes whenever the cache is thrown away, and with it every block that was handed out.
+    u32 generation() const { return m_generation; }
+
+private:
+    void invalidate();
+
+    HashMap<u32, NonnullOwnPtr<Block>> m_blocks;
+    Bitmap m_pages_with_code;
+    u32 m_generation { 0 };
+};
+
+}
@@ -303,6 +303,12 @@ void MallocTracer::audit_write(const Region& region, FlatPtr address, size_t siz
     }
 }
 
+bool MallocTracer::is_in_live_mallocation(const Region& region, FlatPtr address, size_t size)
+{
+    auto* mallocation = find_mallocation(region, address);
+    return mallocation && !mallocation->freed && mallocation->contains(address + size - 1);
+}
+
 void MallocTracer::populate_memory_graph()
 {
     // Create Node for each live Mallocation
@@ -322,9 +328,17 @@ void MallocTracer::populate_memory_graph()
 
         auto& edges_from_mallocation = m_memory_graph.find(mallocation.address)->value;
 
+        // A mallocation is in a single region, so its memory can be read straight from there.
+        auto* region = m_emulator.mmu().find_region({ 0x23, mallocation.address });
+        VERIFY(region);
+        auto offset_in_region = mallocation.address - region->base();
+
         for (size_t i = 0; i < pointers_in_mallocation; ++i) {
-            auto value = m_emulator.mmu().read32({ 0x23, mallocation.address + i * sizeof(u32) });
-            auto other_address = value.value();
+            u32 other_address;
+            u32 shadow;
+            memcpy(&other_address, region->data() + offset_in_region + i * sizeof(u32), sizeof(u32));
+            memcpy(&shadow, region->shadow_data() + offset_in_region + i * sizeof(u32), sizeof(u32));
+            ValueWithShadow<u32> value { other_address, shadow };
             if (!value.is_uninitialized() && m_memory_graph.contains(value.value())) {
                 if constexpr (REACHABLE_DEBUG)
                     reportln("region/mallocation {:p} is reachable from other mallocation {:p}", other_address, mallocation.address);
@@ -353,30 +367,27 @@ void MallocTracer::populate_memory_graph()
         for (size_t i = 0; i < pointers_in_region; ++i) {
             auto value = region.read32(i * sizeof(u32));
             auto other_address = value.value();
-            if (!value.is_uninitialized() && m_memory_graph.contains(value.value())) {
-                if constexpr (REACHABLE_DEBUG)
-                    reportln("region/mallocation {:p} is reachable from region {:p}-{:p}", other_address, region.base(), region.end() - 1);
-                m_memory_graph.find(other_address)->value.is_reachable = true;
-                reachable_mallocations.append(other_address);
-            }
+            if (value.is_uninitialized())
+                continue;
+            auto it = m_memory_graph.find(other_address);
+            if (it == m_memory_graph.end() || it->value.is_reachable)
+                continue;
+            if constexpr (REACHABLE_DEBUG)
+                reportln("region/mallocation {:p} is reachable from region {:p}-{:p}", other_address, region.base(), region.end() - 1);
+            it->value.is_reachable = true;
+            reachable_mallocations.append(other_address);
         }
         return IterationDecision::Continue;
     });
 
-    // Propagate reachability
-    // There are probably better ways to do that
-    Vector<FlatPtr> visited = {};
+    // Propagate reachability, where every mallocation is only visited the first time it is found to be reachable.
     for (size_t i = 0; i < reachable_mallocations.size(); ++i) {
-        auto reachable = reachable_mallocations.at(i);
-        if (visited.contains_slow(reachable))
-            continue;
-        visited.append(reachable);
-        auto& mallocation_node = m_memory_graph.find(reachable)->value;
-
-        if (!mallocation_node.is_reachable)
-            mallocation_node.is_reachable = true;
-
+        auto& mallocation_node = m_memory_graph.find(reachable_mallocations[i])->value;
         for (auto& edge : mallocation_node.edges_from_node) {
+            auto& other_node = m_memory_graph.find(edge)->value;
+            if (other_node.is_reachable)
+                continue;
+            other_node.is_reachable = true;
             reachable_mallocations.append(edge);
         }
     }
@@ -66,6 +66,9 @@ public:
     void audit_read(const Region&, FlatPtr address, size_t);
     void audit_write(const Region&, FlatPtr address, size_t);
 
+    // Whether the whole range is in a mallocation that is in use, so that accessing it is fine.
+    bool is_in_live_mallocation(const Region&, FlatPtr address, size_t);
+
     void dump_leak_report();
 
 private:
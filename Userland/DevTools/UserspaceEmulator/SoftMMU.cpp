@@ -35,6 +35,10 @@ void SoftMMU::add_region(NonnullOwnPtr<Region> region)
 
 void SoftMMU::remove_region(Region& region)
 {
+    m_emulator.instruction_cache().did_unmap(region.base(), region.size());
+    if (m_last_region == &region)
+        m_last_region = nullptr;
+
     size_t first_page_in_region = region.base() / PAGE_SIZE;
     for (size_t i = 0; i < ceil_div(region.size(), PAGE_SIZE); ++i) {
         m_page_to_region_map[first_page_in_region + i] = nullptr;
@@ -214,6 +218,7 @@ void SoftMMU::write8(X86::LogicalAddress address, ValueWithShadow<u8> value)
         TODO();
     }
     region->write8(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u8));
 }
 
 void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
@@ -232,6 +237,7 @@ void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
     }
 
     region->write16(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u16));
 }
 
 void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
@@ -250,6 +256,7 @@ void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
     }
 
     region->write32(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u32));
 }
 
 void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
@@ -268,6 +275,7 @@ void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
     }
 
     region->write64(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u64));
 }
 
 void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
@@ -286,6 +294,7 @@ void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
     }
 
     region->write128(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u128));
 }
 
 void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
@@ -304,20 +313,77 @@ void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
     }
 
     region->write256(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_write(address.offset(), sizeof(u256));
+}
+
+// Whether an access to the range can skip the checks that go with every single read and write, since none of them could fail:
+// Either the range isn't in a malloc block, or it is in a mallocation that is in use.
+bool SoftMMU::can_access_directly(Region& region, FlatPtr address, size_t size)
+{
+    if (!is<MmapRegion>(region) || !static_cast<const MmapRegion&>(region).is_malloc_block())
+        return true;
+    auto* tracer = m_emulator.malloc_tracer();
+    return !tracer || tracer->is_in_live_mallocation(region, address, size);
 }
 
 void SoftMMU::copy_to_vm(FlatPtr destination, const void* source, size_t size)
 {
     // FIXME: We should have a way to preserve the shadow data here as well.
-    for (size_t i = 0; i < size; ++i)
-        write8({ 0x23, destination + i }, shadow_wrap_as_initialized(((const u8*)source)[i]));
+    auto* source_bytes = (const u8*)source;
+    while (size) {
+        auto* region = find_region({ 0x23, destination });
+        // Leave complaining about the access to write8().
+        if (!region || !region->is_writable()) {
+            write8({ 0x23, destination }, shadow_wrap_as_initialized(*source_bytes));
+            ++destination;
+            ++source_bytes;
+            --size;
+            continue;
+        }
+
+        size_t chunk_size = min(size, region->end() - destination);
+        if (can_access_directly(*region, destination, chunk_size)) {
+            size_t offset_in_region = destination - region->base();
+            memcpy(region->data() + offset_in_region, source_bytes, chunk_size);
+            memset(region->shadow_data() + offset_in_region, 0x01, chunk_size);
+            m_emulator.instruction_cache().did_write(destination, chunk_size);
+        } else {
+            for (size_t i = 0; i < chunk_size; ++i)
+                write8({ 0x23, destination + i }, shadow_wrap_as_initialized(source_bytes[i]));
+        }
+        destination += chunk_size;
+        source_bytes += chunk_size;
+        size -= chunk_size;
+    }
 }
 
 void SoftMMU::copy_from_vm(void* destination, const FlatPtr source, size_t size)
 {
     // FIXME: We should have a way to preserve the shadow data here as well.
-    for (size_t i = 0; i < size; ++i)
-        ((u8*)destination)[i] = read8({ 0x23, source + i }).value();
+    auto* destination_bytes = (u8*)destination;
+    FlatPtr address = source;
+    while (size) {
+        auto* region = find_region({ 0x23, address });
+        // Leave complaining about the access to read8().
+        if (!region || !region->is_readable()) {
+            *destination_bytes = read8({ 0x23, address }).value();
+            ++address;
+            ++destination_bytes;
+            --size;
+            continue;
+        }
+
+        size_t chunk_size = min(size, region->end() - address);
+        if (can_access_directly(*region, address, chunk_size)) {
+            memcpy(destination_bytes, region->data() + (address - region->base()), chunk_size);
+        } else {
+            for (size_t i = 0; i < chunk_size; ++i)
+                destination_bytes[i] = read8({ 0x23, address + i }).value();
+        }
+        address += chunk_size;
+        destination_bytes += chunk_size;
+        size -= chunk_size;
+    }
 }
 
 ByteBuffer SoftMMU::copy_buffer_from_vm(const FlatPtr source, size_t size)
@@ -349,6 +415,7 @@ bool SoftMMU::fast_fill_memory8(X86::LogicalAddress address, size_t size, ValueW
     size_t offset_in_region = address.offset() - region->base();
     memset(region->data() + offset_in_region, value.value(), size);
     memset(region->shadow_data() + offset_in_region, value.shadow(), size);
+    m_emulator.instruction_cache().did_write(address.offset(), size);
     return true;
 }
 
@@ -374,6 +441,7 @@ bool SoftMMU::fast_fill_memory32(X86::LogicalAddress address, size_t count, Valu
     size_t offset_in_region = address.offset() - region->base();
     fast_u32_fill((u32*)(region->data() + offset_in_region), value.value(), count);
     fast_u32_fill((u32*)(region->shadow_data() + offset_in_region), value.shadow(), count);
+    m_emulator.instruction_cache().did_write(address.offset(), count * sizeof(u32));
     return true;
 }
 
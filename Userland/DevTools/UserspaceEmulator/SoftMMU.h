@@ -20,6 +20,9 @@ class Emulator;
 
 class SoftMMU {
 public:
+    // The pages of the address space that regions can be mapped in.
+    static constexpr size_t page_count = 786432;
+
     explicit SoftMMU(Emulator&);
 
     ValueWithShadow<u8> read8(X86::LogicalAddress);
@@ -41,8 +44,15 @@ public:
         if (address.selector() == 0x2b)
             return m_tls_region.ptr();
 
+        // Accesses tend to go to the region that the one before went to, which is quicker to check than the page table.
+        if (m_last_region && m_last_region->contains(address.offset()))
+            return m_last_region;
+
         size_t page_index = address.offset() / PAGE_SIZE;
-        return m_page_to_region_map[page_index];
+        auto* region = m_page_to_region_map[page_index];
+        if (region)
+            m_last_region = region;
+        return region;
     }
 
     void add_region(NonnullOwnPtr<Region>);
@@ -94,9 +104,12 @@ public:
     }
 
 private:
+    bool can_access_directly(Region&, FlatPtr address, size_t size);
+
     Emulator& m_emulator;
 
-    Region* m_page_to_region_map[786432] = { nullptr };
+    Region* m_page_to_region_map[page_count] = { nullptr };
+    Region* m_last_region { nullptr };
 
     OwnPtr<Region> m_tls_region;
     NonnullOwnPtrVector<Region> m_regions;
@@ -22,6 +22,9 @@ int __pthread_mutex_lock(pthread_mutex_t*);
 int __pthread_mutex_trylock(pthread_mutex_t*);
 int __pthread_mutex_unlock(pthread_mutex_t*);
 int __pthread_mutex_init(pthread_mutex_t*, const pthread_mutexattr_t*);
+// Locks the mutex as if others were waiting for it, so unlocking it wakes them up.
+// This is for threads that may have been moved over to the mutex from a condition variable.
+int __pthread_mutex_lock_pessimistic_np(pthread_mutex_t*);
 
 typedef void (*KeyDestructor)(void*);
 
@@ -32,10 +35,16 @@ int __pthread_setspecific(pthread_key_t, const void*);
 
 int __pthread_self();
 
+// Set once the process starts its first thread, and never cleared after that.
+// Until then, stdio doesn't have to lock anything.
+extern bool __pthread_is_multithreaded;
+
 void __pthread_key_destroy_for_current_thread();
 
 #define __PTHREAD_MUTEX_NORMAL 0
 #define __PTHREAD_MUTEX_RECURSIVE 1
+#define __PTHREAD_PRIO_NONE 0
+#define __PTHREAD_PRIO_INHERIT 1
 #define __PTHREAD_MUTEX_INITIALIZER     \
     {                                   \
         0, 0, 0, __PTHREAD_MUTEX_NORMAL \
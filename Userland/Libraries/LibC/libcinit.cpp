@@ -24,5 +24,6 @@ void __libc_init()
 {
     __malloc_init();
     __stdio_init();
+    __time_init();
 }
 }
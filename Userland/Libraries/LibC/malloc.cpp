@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Debug.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/Vector.h>
@@ -66,35 +67,56 @@ ALWAYS_INLINE static void ue_notify_chunk_size_changed(const void* block, size_t
         syscall(SC_emuctl, 4, chunk_size, (FlatPtr)block);
 }
 
+// NOTE: These are bumped under different arena locks, and some of them under none at all,
+//       so they're atomic. Nothing is ordered by them, so relaxed is enough.
+using MallocStat = Atomic<size_t, AK::MemoryOrder::memory_order_relaxed>;
+
 struct MallocStats {
-    size_t number_of_malloc_calls;
+    MallocStat number_of_malloc_calls;
+
+    MallocStat number_of_big_allocator_hits;
+    MallocStat number_of_big_allocator_purge_hits;
+    MallocStat number_of_big_allocs;
 
-    size_t number_of_big_allocator_hits;
-    size_t number_of_big_allocator_purge_hits;
-    size_t number_of_big_allocs;
+    MallocStat number_of_hot_empty_block_hits;
+    MallocStat number_of_cold_empty_block_hits;
+    MallocStat number_of_cold_empty_block_purge_hits;
+    MallocStat number_of_block_allocs;
+    MallocStat number_of_blocks_full;
 
-    size_t number_of_hot_empty_block_hits;
-    size_t number_of_cold_empty_block_hits;
-    size_t number_of_cold_empty_block_purge_hits;
-    size_t number_of_block_allocs;
-    size_t number_of_blocks_full;
+    MallocStat number_of_free_calls;
 
-    size_t number_of_free_calls;
+    MallocStat number_of_big_allocator_keeps;
+    MallocStat number_of_big_allocator_frees;
 
-    size_t number_of_big_allocator_keeps;
-    size_t number_of_big_allocator_frees;
+    MallocStat number_of_freed_full_blocks;
+    MallocStat number_of_hot_keeps;
+    MallocStat number_of_cold_keeps;
+    MallocStat number_of_frees;
 
-    size_t number_of_freed_full_blocks;
-    size_t number_of_hot_keeps;
-    size_t number_of_cold_keeps;
-    size_t number_of_frees;
+    MallocStat number_of_thread_cache_refills;
+    MallocStat number_of_thread_cache_flushes;
+
+    MallocStat number_of_remote_frees;
 };
 static MallocStats g_malloc_stats = {};
 
-static size_t s_hot_empty_block_count { 0 };
-static ChunkedBlock* s_hot_empty_blocks[number_of_hot_chunked_blocks_to_keep_around] { nullptr };
-static size_t s_cold_empty_block_count { 0 };
-static ChunkedBlock* s_cold_empty_blocks[number_of_cold_chunked_blocks_to_keep_around] { nullptr };
+#ifndef NO_TLS
+// Every thread keeps some free chunks of the smallest size classes to itself, so most calls to malloc()
+// and free() for those don't have to take their arena's lock at all. The cache is refilled from and flushed
+// back to the allocators half of it at a time.
+constexpr size_t number_of_thread_cached_size_classes = 7; // Up to 504 bytes.
+constexpr size_t number_of_thread_cached_chunks_per_size_class = 32;
+constexpr size_t thread_cache_batch_size = number_of_thread_cached_chunks_per_size_class / 2;
+static_assert(number_of_thread_cached_size_classes <= num_size_classes);
+
+struct ThreadCache {
+    FreelistEntry* chunks[number_of_thread_cached_size_classes];
+    size_t chunk_count[number_of_thread_cached_size_classes];
+};
+static __thread ThreadCache t_thread_cache;
+static bool s_thread_cache_enabled = false;
+#endif
 
 struct Allocator {
     size_t size { 0 };
@@ -107,18 +129,42 @@ struct BigAllocator {
     Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
 };
 
+// Chunked blocks are spread over a few arenas, each with a lock of its own, and every thread allocates
+// from one of them. A chunk that's freed by a thread of a different arena is queued up for the arena
+// it came from without taking any locks, and put back into its block by whoever takes that arena's lock next.
+// NOTE: Big allocations don't belong to an arena, they're protected by the global malloc lock.
+struct Arena {
+    Threading::Lock lock;
+    Allocator allocators[num_size_classes];
+
+    size_t hot_empty_block_count { 0 };
+    ChunkedBlock* hot_empty_blocks[number_of_hot_chunked_blocks_to_keep_around] { nullptr };
+    size_t cold_empty_block_count { 0 };
+    ChunkedBlock* cold_empty_blocks[number_of_cold_chunked_blocks_to_keep_around] { nullptr };
+
+    Atomic<FreelistEntry*> remote_frees;
+};
+
+#ifdef NO_TLS
+constexpr size_t number_of_arenas = 1;
+#else
+constexpr size_t number_of_arenas = 4;
+static __thread Arena* t_arena;
+static Atomic<size_t> s_next_arena_index;
+#endif
+
 // Allocators will be initialized in __malloc_init.
 // We can not rely on global constructors to initialize them,
 // because they must be initialized before other global constructors
 // are run. Similarly, we can not allow global destructors to destruct
 // them. We could have used AK::NeverDestoyed to prevent the latter,
 // but it would have not helped with the former.
-static u8 g_allocators_storage[sizeof(Allocator) * num_size_classes];
+alignas(Arena) static u8 g_arenas_storage[sizeof(Arena) * number_of_arenas];
 static u8 g_big_allocators_storage[sizeof(BigAllocator)];
 
-static inline Allocator (&allocators())[num_size_classes]
+static inline Arena (&arenas())[number_of_arenas]
 {
-    return reinterpret_cast<Allocator(&)[num_size_classes]>(g_allocators_storage);
+    return reinterpret_cast<Arena(&)[number_of_arenas]>(g_arenas_storage);
 }
 
 static inline BigAllocator (&big_allocators())[1]
@@ -126,16 +172,28 @@ static inline BigAllocator (&big_allocators())[1]
     return reinterpret_cast<BigAllocator(&)[1]>(g_big_allocators_storage);
 }
 
-static Allocator* allocator_for_size(size_t size, size_t& good_size)
+static Arena& current_arena()
+{
+#ifdef NO_TLS
+    return arenas()[0];
+#else
+    if (!t_arena)
+        t_arena = &arenas()[s_next_arena_index.fetch_add(1, AK::memory_order_relaxed) % number_of_arenas];
+    return *t_arena;
+#endif
+}
+
+// Returns num_size_classes if the size is too big for a chunked block.
+static size_t size_class_index_for_size(size_t size, size_t& good_size)
 {
     for (size_t i = 0; size_classes[i]; ++i) {
         if (size <= size_classes[i]) {
             good_size = size_classes[i];
-            return &allocators()[i];
+            return i;
         }
     }
     good_size = PAGE_ROUND_UP(size);
-    return nullptr;
+    return num_size_classes;
 }
 
 #ifdef RECYCLE_BIG_ALLOCATIONS
@@ -167,82 +225,33 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+// NOTE: The caller has to hold the arena's lock.
+static void* allocate_chunk(Arena& arena, Allocator& allocator, size_t good_size)
 {
-    Threading::Locker locker(malloc_lock());
-
-    if (s_log_malloc)
-        dbgln("LibC: malloc({})", size);
-
-    if (!size) {
-        // Legally we could just return a null pointer here, but this is more
-        // compatible with existing software.
-        size = 1;
-    }
-
-    g_malloc_stats.number_of_malloc_calls++;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
-
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
-
-                ue_notify_malloc(&block->m_slot[0], size);
-                return &block->m_slot[0];
-            }
-        }
-#endif
-        g_malloc_stats.number_of_big_allocs++;
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        ue_notify_malloc(&block->m_slot[0], size);
-        return &block->m_slot[0];
-    }
-
     ChunkedBlock* block = nullptr;
-    for (auto& current : allocator->usable_blocks) {
+    for (auto& current : allocator.usable_blocks) {
         if (current.free_chunks()) {
             block = &current;
             break;
         }
     }
 
-    if (!block && s_hot_empty_block_count) {
+    if (!block && arena.hot_empty_block_count) {
         g_malloc_stats.number_of_hot_empty_block_hits++;
-        block = s_hot_empty_blocks[--s_hot_empty_block_count];
+        block = arena.hot_empty_blocks[--arena.hot_empty_block_count];
         if (block->m_size != good_size) {
-            new (block) ChunkedBlock(good_size);
+            new (block) ChunkedBlock(&arena, good_size);
             ue_notify_chunk_size_changed(block, good_size);
             char buffer[64];
             snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
             set_mmap_name(block, ChunkedBlock::block_size, buffer);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
-    if (!block && s_cold_empty_block_count) {
+    if (!block && arena.cold_empty_block_count) {
         g_malloc_stats.number_of_cold_empty_block_hits++;
-        block = s_cold_empty_blocks[--s_cold_empty_block_count];
+        block = arena.cold_empty_blocks[--arena.cold_empty_block_count];
         int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
         bool this_block_was_purged = rc == 1;
         if (rc < 0) {
@@ -257,10 +266,10 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         if (this_block_was_purged || block->m_size != good_size) {
             if (this_block_was_purged)
                 g_malloc_stats.number_of_cold_empty_block_purge_hits++;
-            new (block) ChunkedBlock(good_size);
+            new (block) ChunkedBlock(&arena, good_size);
             ue_notify_chunk_size_changed(block, good_size);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
     if (!block) {
@@ -268,9 +277,9 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         char buffer[64];
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
-        new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(*block);
-        ++allocator->block_count;
+        new (block) ChunkedBlock(&arena, good_size);
+        allocator.usable_blocks.append(*block);
+        ++allocator.block_count;
     }
 
     --block->m_free_chunks;
@@ -285,18 +294,215 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
     if (block->is_full()) {
         g_malloc_stats.number_of_blocks_full++;
         dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(*block);
-        allocator->full_blocks.append(*block);
+        allocator.usable_blocks.remove(*block);
+        allocator.full_blocks.append(*block);
     }
     dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    return ptr;
+}
+
+#ifndef NO_TLS
+// The first chunk is for the caller, the rest of the batch goes into the thread's cache.
+// NOTE: The caller has to hold the arena's lock.
+static void* refill_thread_cache(Arena& arena, size_t size_class_index)
+{
+    g_malloc_stats.number_of_thread_cache_refills++;
+
+    auto& allocator = arena.allocators[size_class_index];
+    auto& cache = t_thread_cache;
+    void* ptr = allocate_chunk(arena, allocator, allocator.size);
+    while (cache.chunk_count[size_class_index] < thread_cache_batch_size) {
+        auto* entry = (FreelistEntry*)allocate_chunk(arena, allocator, allocator.size);
+        entry->next = cache.chunks[size_class_index];
+        cache.chunks[size_class_index] = entry;
+        ++cache.chunk_count[size_class_index];
+    }
+    return ptr;
+}
+#endif
+
+static void free_remotely_freed_chunks(Arena&);
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    if (s_log_malloc)
+        dbgln("LibC: malloc({})", size);
+
+    if (!size) {
+        // Legally we could just return a null pointer here, but this is more
+        // compatible with existing software.
+        size = 1;
+    }
+
+    g_malloc_stats.number_of_malloc_calls++;
+
+    size_t good_size;
+    size_t size_class_index = size_class_index_for_size(size, good_size);
+
+#ifndef NO_TLS
+    if (s_thread_cache_enabled && size_class_index < number_of_thread_cached_size_classes) {
+        auto& cache = t_thread_cache;
+        if (auto* entry = cache.chunks[size_class_index]) {
+            cache.chunks[size_class_index] = entry->next;
+            --cache.chunk_count[size_class_index];
+            if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+                memset(entry, MALLOC_SCRUB_BYTE, good_size);
+            ue_notify_malloc(entry, size);
+            return entry;
+        }
+    }
+#endif
+
+    if (size_class_index == num_size_classes) {
+        Threading::Locker locker(malloc_lock());
+        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
+#ifdef RECYCLE_BIG_ALLOCATIONS
+        if (auto* allocator = big_allocator_for_size(real_size)) {
+            if (!allocator->blocks.is_empty()) {
+                g_malloc_stats.number_of_big_allocator_hits++;
+                auto* block = allocator->blocks.take_last();
+                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+                bool this_block_was_purged = rc == 1;
+                if (rc < 0) {
+                    perror("madvise");
+                    VERIFY_NOT_REACHED();
+                }
+                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                    perror("mprotect");
+                    VERIFY_NOT_REACHED();
+                }
+                if (this_block_was_purged) {
+                    g_malloc_stats.number_of_big_allocator_purge_hits++;
+                    new (block) BigAllocationBlock(real_size);
+                }
+
+                ue_notify_malloc(&block->m_slot[0], size);
+                return &block->m_slot[0];
+            }
+        }
+#endif
+        g_malloc_stats.number_of_big_allocs++;
+        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+        new (block) BigAllocationBlock(real_size);
+        ue_notify_malloc(&block->m_slot[0], size);
+        return &block->m_slot[0];
+    }
+
+    auto& arena = current_arena();
+    Threading::Locker locker(arena.lock);
+    free_remotely_freed_chunks(arena);
+
+    void* ptr = nullptr;
+#ifndef NO_TLS
+    if (s_thread_cache_enabled && size_class_index < number_of_thread_cached_size_classes)
+        ptr = refill_thread_cache(arena, size_class_index);
+    else
+#endif
+        ptr = allocate_chunk(arena, arena.allocators[size_class_index], good_size);
 
     if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
 
     ue_notify_malloc(ptr, size);
     return ptr;
 }
 
+// NOTE: The caller has to hold the lock of the block's arena.
+static void free_chunk(ChunkedBlock& chunked_block, void* ptr)
+{
+    auto* block = &chunked_block;
+    auto& arena = *block->m_arena;
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
+
+    size_t good_size;
+    auto& allocator = arena.allocators[size_class_index_for_size(block->m_size, good_size)];
+
+    if (block->is_full()) {
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator.full_blocks.remove(*block);
+        allocator.usable_blocks.prepend(*block);
+    }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        if (arena.hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
+            g_malloc_stats.number_of_hot_keeps++;
+            allocator.usable_blocks.remove(*block);
+            arena.hot_empty_blocks[arena.hot_empty_block_count++] = block;
+            return;
+        }
+        if (arena.cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
+            g_malloc_stats.number_of_cold_keeps++;
+            allocator.usable_blocks.remove(*block);
+            arena.cold_empty_blocks[arena.cold_empty_block_count++] = block;
+            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+            return;
+        }
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
+        g_malloc_stats.number_of_frees++;
+        allocator.usable_blocks.remove(*block);
+        --allocator.block_count;
+        os_free(block, ChunkedBlock::block_size);
+    }
+}
+
+static void queue_remote_free(Arena& arena, void* ptr)
+{
+    g_malloc_stats.number_of_remote_frees++;
+    auto* entry = (FreelistEntry*)ptr;
+    auto* head = arena.remote_frees.load(AK::memory_order_relaxed);
+    do {
+        entry->next = head;
+    } while (!arena.remote_frees.compare_exchange_strong(head, entry, AK::memory_order_release));
+}
+
+// NOTE: The caller has to hold the arena's lock.
+static void free_remotely_freed_chunks(Arena& arena)
+{
+    if (!arena.remote_frees.load(AK::memory_order_relaxed))
+        return;
+    auto* entry = arena.remote_frees.exchange(nullptr, AK::memory_order_acquire);
+    while (entry) {
+        auto* next = entry->next;
+        free_chunk(*(ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+        entry = next;
+    }
+}
+
+// Puts the chunk back into its block right away if it's from the given arena, and queues it up for its own arena otherwise.
+// NOTE: The caller has to hold the given arena's lock.
+static void free_chunk_from_arena(Arena& arena, ChunkedBlock& block, void* ptr)
+{
+    if (block.m_arena == &arena)
+        free_chunk(block, ptr);
+    else
+        queue_remote_free(*block.m_arena, ptr);
+}
+
+#ifndef NO_TLS
+// Gives all but keep_count of the thread's cached chunks of this size class back to their blocks.
+// NOTE: The caller has to hold the arena's lock.
+static void flush_thread_cache(Arena& arena, size_t size_class_index, size_t keep_count)
+{
+    g_malloc_stats.number_of_thread_cache_flushes++;
+
+    auto& cache = t_thread_cache;
+    while (cache.chunk_count[size_class_index] > keep_count) {
+        auto* entry = cache.chunks[size_class_index];
+        cache.chunks[size_class_index] = entry->next;
+        --cache.chunk_count[size_class_index];
+        free_chunk_from_arena(arena, *(ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+    }
+}
+#endif
+
 static void free_impl(void* ptr)
 {
     ScopedValueRollback rollback(errno);
@@ -306,12 +512,36 @@ static void free_impl(void* ptr)
 
     g_malloc_stats.number_of_free_calls++;
 
-    Threading::Locker locker(malloc_lock());
-
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
+#ifndef NO_TLS
+    // NOTE: The block header can't change under us, since the block can't be reused while the chunk is in use.
+    if (s_thread_cache_enabled && magic == MAGIC_PAGE_HEADER) {
+        auto* block = (ChunkedBlock*)block_base;
+        size_t good_size;
+        size_t size_class_index = size_class_index_for_size(block->m_size, good_size);
+        if (size_class_index < number_of_thread_cached_size_classes) {
+            if (s_scrub_free)
+                memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+            auto& cache = t_thread_cache;
+            if (cache.chunk_count[size_class_index] >= number_of_thread_cached_chunks_per_size_class) {
+                auto& arena = current_arena();
+                Threading::Locker locker(arena.lock);
+                free_remotely_freed_chunks(arena);
+                flush_thread_cache(arena, size_class_index, number_of_thread_cached_chunks_per_size_class - thread_cache_batch_size);
+            }
+            auto* entry = (FreelistEntry*)ptr;
+            entry->next = cache.chunks[size_class_index];
+            cache.chunks[size_class_index] = entry;
+            ++cache.chunk_count[size_class_index];
+            return;
+        }
+    }
+#endif
+
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        Threading::Locker locker(malloc_lock());
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
@@ -344,46 +574,14 @@ static void free_impl(void* ptr)
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
-
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(*block);
-        allocator->usable_blocks.prepend(*block);
-    }
-
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
-            g_malloc_stats.number_of_hot_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
-            return;
-        }
-        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
-            g_malloc_stats.number_of_cold_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(*block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
+    auto& arena = current_arena();
+    if (block->m_arena != &arena) {
+        queue_remote_free(*block->m_arena, ptr);
+        return;
     }
+    Threading::Locker locker(arena.lock);
+    free_remotely_freed_chunks(arena);
+    free_chunk(*block, ptr);
 }
 
 [[gnu::flatten]] void* malloc(size_t size)
@@ -429,7 +627,7 @@ size_t malloc_size(void* ptr)
 size_t malloc_good_size(size_t size)
 {
     size_t good_size;
-    allocator_for_size(size, good_size);
+    size_class_index_for_size(size, good_size);
     return good_size;
 }
 
@@ -449,6 +647,19 @@ void* realloc(void* ptr, size_t size)
         ue_notify_realloc(ptr, size);
         return ptr;
     }
+
+    // Big allocations can usually grow in place by mapping more memory right after them, which saves us from copying.
+    auto* header = (CommonHeader*)((FlatPtr)ptr & ChunkedBlock::block_mask);
+    if (header->m_magic == MAGIC_BIGALLOC_HEADER) {
+        auto* block = (BigAllocationBlock*)header;
+        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
+        if (mremap(block, block->m_size, real_size, MAP_ANONYMOUS | MAP_PRIVATE) != MAP_FAILED) {
+            block->m_size = real_size;
+            ue_notify_realloc(ptr, size);
+            return ptr;
+        }
+    }
+
     auto* new_ptr = malloc(size);
     if (new_ptr) {
         memcpy(new_ptr, ptr, min(existing_allocation_size, size));
@@ -457,6 +668,19 @@ void* realloc(void* ptr, size_t size)
     return new_ptr;
 }
 
+void __malloc_thread_exit()
+{
+#ifndef NO_TLS
+    if (!s_thread_cache_enabled)
+        return;
+    auto& arena = current_arena();
+    Threading::Locker locker(arena.lock);
+    for (size_t i = 0; i < number_of_thread_cached_size_classes; ++i)
+        flush_thread_cache(arena, i, 0);
+    free_remotely_freed_chunks(arena);
+#endif
+}
+
 void __malloc_init()
 {
     new (&malloc_lock()) Threading::Lock();
@@ -478,36 +702,47 @@ void __malloc_init()
     if (secure_getenv("LIBC_PROFILE_MALLOC"))
         s_profiling = true;
 
-    for (size_t i = 0; i < num_size_classes; ++i) {
-        new (&allocators()[i]) Allocator();
-        allocators()[i].size = size_classes[i];
+    for (auto& arena : arenas()) {
+        new (&arena) Arena();
+        for (size_t i = 0; i < num_size_classes; ++i)
+            arena.allocators[i].size = size_classes[i];
     }
 
     new (&big_allocators()[0])(BigAllocator);
+
+#ifndef NO_TLS
+    // NOTE: The userspace emulator keeps track of every chunk, so don't hide any from it.
+    s_thread_cache_enabled = !s_in_userspace_emulator && !secure_getenv("LIBC_NO_MALLOC_THREAD_CACHE");
+#endif
 }
 
 void serenity_dump_malloc_stats()
 {
-    dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
+    dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls.load());
+    dbgln();
+    dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits.load());
+    dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits.load());
+    dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs.load());
+    dbgln();
+    dbgln("empty hot block hits: {}", g_malloc_stats.number_of_hot_empty_block_hits.load());
+    dbgln("empty cold block hits: {}", g_malloc_stats.number_of_cold_empty_block_hits.load());
+    dbgln("empty cold block hits that were purged: {}", g_malloc_stats.number_of_cold_empty_block_purge_hits.load());
+    dbgln("block allocs: {}", g_malloc_stats.number_of_block_allocs.load());
+    dbgln("filled blocks: {}", g_malloc_stats.number_of_blocks_full.load());
     dbgln();
-    dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
-    dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits);
-    dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs);
+    dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls.load());
     dbgln();
-    dbgln("empty hot block hits: {}", g_malloc_stats.number_of_hot_empty_block_hits);
-    dbgln("empty cold block hits: {}", g_malloc_stats.number_of_cold_empty_block_hits);
-    dbgln("empty cold block hits that were purged: {}", g_malloc_stats.number_of_cold_empty_block_purge_hits);
-    dbgln("block allocs: {}", g_malloc_stats.number_of_block_allocs);
-    dbgln("filled blocks: {}", g_malloc_stats.number_of_blocks_full);
+    dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps.load());
+    dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees.load());
     dbgln();
-    dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls);
+    dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks.load());
+    dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps.load());
+    dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps.load());
+    dbgln("number of frees: {}", g_malloc_stats.number_of_frees.load());
     dbgln();
-    dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps);
-    dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees);
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills.load());
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes.load());
     dbgln();
-    dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks);
-    dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps);
-    dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps);
-    dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln("remote frees: {}", g_malloc_stats.number_of_remote_frees.load());
 }
 }
@@ -45,18 +45,23 @@ struct FreelistEntry {
     FreelistEntry* next;
 };
 
+struct Arena;
+
 struct ChunkedBlock : public CommonHeader {
 
     static constexpr size_t block_size = 64 * KiB;
     static constexpr size_t block_mask = ~(block_size - 1);
 
-    ChunkedBlock(size_t bytes_per_chunk)
+    ChunkedBlock(Arena* arena, size_t bytes_per_chunk)
+        : m_arena(arena)
     {
         m_magic = MAGIC_PAGE_HEADER;
         m_size = bytes_per_chunk;
         m_free_chunks = chunk_capacity();
     }
 
+    // The arena that this block's chunks have to be freed into.
+    Arena* m_arena { nullptr };
     IntrusiveListNode<ChunkedBlock> m_list_node;
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
@@ -6,15 +6,19 @@
 
 #include <AK/Assertions.h>
 #include <AK/ByteBuffer.h>
+#include <AK/MemoryStream.h>
 #include <AK/ScopeGuard.h>
 #include <AK/String.h>
 #include <Kernel/Net/IPv4.h>
 #include <arpa/inet.h>
+#include <bits/pthread_integration.h>
 #include <errno.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 extern "C" {
@@ -643,26 +647,8 @@ static bool fill_getproto_buffers(const char* line, ssize_t read)
     return true;
 }
 
-int getaddrinfo(const char* __restrict node, const char* __restrict service, const struct addrinfo* __restrict hints, struct addrinfo** __restrict res)
+static int make_addrinfo_list(const char* canonical_name, const Vector<in_addr_t>& addresses, const char* service, const struct addrinfo* hints, struct addrinfo** res)
 {
-    dbgln("getaddrinfo: node={}, service={}, hints->ai_family={}", (const char*)node, (const char*)service, hints ? hints->ai_family : 0);
-
-    *res = nullptr;
-
-    if (hints && hints->ai_family != AF_INET && hints->ai_family != AF_UNSPEC)
-        return EAI_FAMILY;
-
-    if (!node) {
-        if (hints && hints->ai_flags & AI_PASSIVE)
-            node = "0.0.0.0";
-        else
-            node = "127.0.0.1";
-    }
-
-    auto host_ent = gethostbyname(node);
-    if (!host_ent)
-        return EAI_FAIL;
-
     const char* proto = nullptr;
     if (hints && hints->ai_socktype) {
         switch (hints->ai_socktype) {
@@ -705,11 +691,11 @@ int getaddrinfo(const char* __restrict node, const char* __restrict service, con
     addrinfo* first_info = nullptr;
     addrinfo* prev_info = nullptr;
 
-    for (int host_index = 0; host_ent->h_addr_list[host_index]; host_index++) {
+    for (auto address : addresses) {
         sockaddr_in* sin = new sockaddr_in;
         sin->sin_family = AF_INET;
         sin->sin_port = port;
-        memcpy(&sin->sin_addr.s_addr, host_ent->h_addr_list[host_index], host_ent->h_length);
+        sin->sin_addr.s_addr = address;
 
         addrinfo* info = new addrinfo;
         info->ai_flags = 0;
@@ -720,7 +706,7 @@ int getaddrinfo(const char* __restrict node, const char* __restrict service, con
         info->ai_addr = reinterpret_cast<sockaddr*>(sin);
 
         if (hints && hints->ai_flags & AI_CANONNAME)
-            info->ai_canonname = strdup(host_ent->h_name);
+            info->ai_canonname = strdup(canonical_name);
         else
             info->ai_canonname = nullptr;
 
@@ -742,6 +728,290 @@ int getaddrinfo(const char* __restrict node, const char* __restrict service, con
         return EAI_NONAME;
 }
 
+int getaddrinfo(const char* __restrict node, const char* __restrict service, const struct addrinfo* __restrict hints, struct addrinfo** __restrict res)
+{
+    *res = nullptr;
+
+    if (hints && hints->ai_family != AF_INET && hints->ai_family != AF_UNSPEC)
+        return EAI_FAMILY;
+
+    if (!node) {
+        if (hints && hints->ai_flags & AI_PASSIVE)
+            node = "0.0.0.0";
+        else
+            node = "127.0.0.1";
+    }
+
+    auto host_ent = gethostbyname(node);
+    if (!host_ent)
+        return EAI_FAIL;
+
+    Vector<in_addr_t> addresses;
+    for (int host_index = 0; host_ent->h_addr_list[host_index]; host_index++) {
+        in_addr_t address;
+        memcpy(&address, host_ent->h_addr_list[host_index], sizeof(address));
+        addresses.append(address);
+    }
+
+    return make_addrinfo_list(host_ent->h_name, addresses, service, hints, res);
+}
+
+// A getaddrinfo_a() call whose names LookupServer is still busy with. All of them go out in a single
+// lookup_names message, so LookupServer can send all the DNS queries before waiting for any answers.
+struct PendingAddressLookup {
+    int fd { -1 };
+    // In the order their names are in the message.
+    Vector<gaicb*> requests;
+};
+
+static pthread_mutex_t s_pending_address_lookup_lock = __PTHREAD_MUTEX_INITIALIZER;
+
+static bool write_fully(int fd, const u8* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t nwritten = write(fd, data, size);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += nwritten;
+        size -= nwritten;
+    }
+    return true;
+}
+
+static bool read_fully(int fd, u8* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t nread = read(fd, data, size);
+        if (nread < 0 && errno == EINTR)
+            continue;
+        if (nread <= 0)
+            return false;
+        data += nread;
+        size -= nread;
+    }
+    return true;
+}
+
+static bool send_lookup_names_request(int fd, const Vector<gaicb*>& requests)
+{
+    Vector<u8> message;
+    auto append = [&](auto value) {
+        message.append(reinterpret_cast<const u8*>(&value), sizeof(value));
+    };
+
+    append((u32)0);
+    append(lookup_server_endpoint_magic);
+    append((i32)5);
+    append((u64)requests.size());
+    for (auto* request : requests) {
+        size_t name_length = strlen(request->ar_name);
+        append((i32)name_length);
+        message.append(reinterpret_cast<const u8*>(request->ar_name), name_length);
+    }
+
+    u32 message_size = message.size() - sizeof(u32);
+    memcpy(message.data(), &message_size, sizeof(message_size));
+    return write_fully(fd, message.data(), message.size());
+}
+
+// Reads LookupServer's answer for the whole batch, and finishes all its requests.
+// NOTE: This has to be called with s_pending_address_lookup_lock held.
+static void finish_pending_address_lookup(PendingAddressLookup* lookup)
+{
+    auto fail_remaining_requests = [&](size_t start) {
+        for (size_t i = start; i < lookup->requests.size(); ++i)
+            lookup->requests[i]->__return = EAI_FAIL;
+    };
+
+    ScopeGuard clean_up = [&] {
+        for (auto* request : lookup->requests)
+            request->__batch = nullptr;
+        close(lookup->fd);
+        delete lookup;
+    };
+
+    u32 message_size;
+    if (!read_fully(lookup->fd, reinterpret_cast<u8*>(&message_size), sizeof(message_size))) {
+        fail_remaining_requests(0);
+        return;
+    }
+    auto message = ByteBuffer::create_uninitialized(message_size);
+    if (!read_fully(lookup->fd, message.data(), message.size())) {
+        fail_remaining_requests(0);
+        return;
+    }
+
+    InputMemoryStream stream { message };
+    i32 endpoint_magic = 0;
+    i32 message_id = 0;
+    u64 codes_count = 0;
+    stream >> endpoint_magic >> message_id >> codes_count;
+    if (stream.handle_any_error() || endpoint_magic != lookup_server_endpoint_magic || message_id != 6 || codes_count != lookup->requests.size()) {
+        dbgln("Received an unexpected message");
+        fail_remaining_requests(0);
+        return;
+    }
+
+    Vector<i32> codes;
+    for (size_t i = 0; i < codes_count; ++i) {
+        i32 code = 1;
+        stream >> code;
+        codes.append(code);
+    }
+
+    u64 address_lists_count = 0;
+    stream >> address_lists_count;
+    if (stream.handle_any_error() || address_lists_count != lookup->requests.size()) {
+        fail_remaining_requests(0);
+        return;
+    }
+
+    for (size_t i = 0; i < lookup->requests.size(); ++i) {
+        auto* request = lookup->requests[i];
+        u64 addresses_count = 0;
+        stream >> addresses_count;
+        Vector<in_addr_t> addresses;
+        for (size_t j = 0; j < addresses_count && !stream.has_any_error(); ++j) {
+            i32 length = 0;
+            in_addr_t address = 0;
+            stream >> length;
+            if (length != sizeof(address)) {
+                stream.set_fatal_error();
+                break;
+            }
+            stream >> Bytes { &address, sizeof(address) };
+            addresses.append(address);
+        }
+        if (stream.handle_any_error()) {
+            fail_remaining_requests(i);
+            return;
+        }
+
+        if (codes[i] != 0 || addresses.is_empty()) {
+            request->__return = EAI_FAIL;
+            continue;
+        }
+        request->__return = make_addrinfo_list(request->ar_name, addresses, request->ar_service, request->ar_request, &request->ar_result);
+    }
+}
+
+int getaddrinfo_a(int mode, struct gaicb* list[], int nitems, struct sigevent* sevp)
+{
+    if (mode != GAI_WAIT && mode != GAI_NOWAIT) {
+        errno = EINVAL;
+        return EAI_SYSTEM;
+    }
+    if (sevp) {
+        // FIXME: Support notifying the caller with a signal or a thread once the lookups are done.
+        errno = ENOTSUP;
+        return EAI_SYSTEM;
+    }
+
+    auto* lookup = new PendingAddressLookup;
+    for (int i = 0; i < nitems; ++i) {
+        auto* request = list[i];
+        if (!request)
+            continue;
+        request->ar_result = nullptr;
+        request->__batch = nullptr;
+
+        auto* hints = request->ar_request;
+        bool needs_lookup_server = request->ar_name
+            && (!hints || hints->ai_family == AF_INET || hints->ai_family == AF_UNSPEC)
+            && !IPv4Address::from_string(request->ar_name).has_value();
+        if (!needs_lookup_server) {
+            request->__return = getaddrinfo(request->ar_name, request->ar_service, hints, &request->ar_result);
+            continue;
+        }
+        request->__return = EAI_INPROGRESS;
+        lookup->requests.append(request);
+    }
+
+    if (lookup->requests.is_empty()) {
+        delete lookup;
+        return 0;
+    }
+
+    lookup->fd = connect_to_lookup_server();
+    if (lookup->fd < 0 || !send_lookup_names_request(lookup->fd, lookup->requests)) {
+        int saved_errno = errno;
+        for (auto* request : lookup->requests)
+            request->__return = EAI_SYSTEM;
+        if (lookup->fd >= 0)
+            close(lookup->fd);
+        delete lookup;
+        errno = saved_errno;
+        return EAI_SYSTEM;
+    }
+
+    __pthread_mutex_lock(&s_pending_address_lookup_lock);
+    for (auto* request : lookup->requests)
+        request->__batch = lookup;
+    if (mode == GAI_WAIT)
+        finish_pending_address_lookup(lookup);
+    __pthread_mutex_unlock(&s_pending_address_lookup_lock);
+    return 0;
+}
+
+int gai_error(struct gaicb* request)
+{
+    __pthread_mutex_lock(&s_pending_address_lookup_lock);
+    if (auto* lookup = reinterpret_cast<PendingAddressLookup*>(request->__batch)) {
+        pollfd poll_fd { lookup->fd, POLLIN, 0 };
+        if (poll(&poll_fd, 1, 0) > 0)
+            finish_pending_address_lookup(lookup);
+    }
+    int result = request->__return;
+    __pthread_mutex_unlock(&s_pending_address_lookup_lock);
+    return result;
+}
+
+int gai_suspend(const struct gaicb* const list[], int nitems, const struct timespec* timeout)
+{
+    __pthread_mutex_lock(&s_pending_address_lookup_lock);
+    ScopeGuard unlock = [] { __pthread_mutex_unlock(&s_pending_address_lookup_lock); };
+
+    Vector<pollfd> poll_fds;
+    Vector<PendingAddressLookup*> lookups;
+    for (int i = 0; i < nitems; ++i) {
+        if (!list[i])
+            continue;
+        auto* lookup = reinterpret_cast<PendingAddressLookup*>(list[i]->__batch);
+        if (!lookup)
+            return 0;
+        if (!lookups.contains_slow(lookup)) {
+            lookups.append(lookup);
+            poll_fds.append({ lookup->fd, POLLIN, 0 });
+        }
+    }
+    if (lookups.is_empty())
+        return EAI_ALLDONE;
+
+    int timeout_ms = timeout ? timeout->tv_sec * 1000 + timeout->tv_nsec / 1000000 : -1;
+    int rc = poll(poll_fds.data(), poll_fds.size(), timeout_ms);
+    if (rc < 0)
+        return errno == EINTR ? EAI_INTR : EAI_SYSTEM;
+    if (rc == 0)
+        return EAI_AGAIN;
+
+    for (size_t i = 0; i < poll_fds.size(); ++i) {
+        if (poll_fds[i].revents)
+            finish_pending_address_lookup(lookups[i]);
+    }
+    return 0;
+}
+
+int gai_cancel(struct gaicb* request)
+{
+    // NOTE: Once LookupServer has the names, there's no taking them back.
+    if (gai_error(request) != EAI_INPROGRESS)
+        return EAI_ALLDONE;
+    return EAI_NOTCANCELED;
+}
+
 void freeaddrinfo(struct addrinfo* res)
 {
     if (res) {
@@ -779,6 +1049,16 @@ const char* gai_strerror(int errcode)
         return "system error";
     case EAI_OVERFLOW:
         return "buffer too small";
+    case EAI_INPROGRESS:
+        return "request is still in progress";
+    case EAI_CANCELED:
+        return "request was canceled";
+    case EAI_NOTCANCELED:
+        return "request could not be canceled";
+    case EAI_ALLDONE:
+        return "all requests are done";
+    case EAI_INTR:
+        return "interrupted by a signal";
     default:
         return "invalid error code";
     }
@@ -78,6 +78,11 @@ struct addrinfo {
 #define EAI_SOCKTYPE 10
 #define EAI_SYSTEM 11
 #define EAI_OVERFLOW 12
+#define EAI_INPROGRESS 13
+#define EAI_CANCELED 14
+#define EAI_NOTCANCELED 15
+#define EAI_ALLDONE 16
+#define EAI_INTR 17
 
 #define AI_PASSIVE 0x0001
 #define AI_CANONNAME 0x0002
@@ -99,4 +104,27 @@ void freeaddrinfo(struct addrinfo* res);
 const char* gai_strerror(int errcode);
 int getnameinfo(const struct sockaddr* __restrict addr, socklen_t addrlen, char* __restrict host, socklen_t hostlen, char* __restrict serv, socklen_t servlen, int flags);
 
+struct gaicb {
+    const char* ar_name;
+    const char* ar_service;
+    const struct addrinfo* ar_request;
+    struct addrinfo* ar_result;
+    // Private, don't touch.
+    int __return;
+    void* __batch;
+};
+
+#define GAI_WAIT 0
+#define GAI_NOWAIT 1
+
+struct sigevent;
+struct timespec;
+
+// Looks up all the names in one go, which is a lot faster than calling getaddrinfo() for each of them.
+// NOTE: Notifying the caller through a sigevent isn't supported, sevp has to be null.
+int getaddrinfo_a(int mode, struct gaicb* list[], int nitems, struct sigevent* sevp);
+int gai_error(struct gaicb*);
+int gai_suspend(const struct gaicb* const list[], int nitems, const struct timespec* timeout);
+int gai_cancel(struct gaicb*);
+
 __END_DECLS
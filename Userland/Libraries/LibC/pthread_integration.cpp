@@ -9,7 +9,7 @@
 #include <AK/Vector.h>
 #include <bits/pthread_integration.h>
 #include <errno.h>
-#include <sched.h>
+#include <serenity.h>
 #include <unistd.h>
 
 namespace {
@@ -24,6 +24,9 @@ static NeverDestroyed<Vector<void (*)(void), 4>> g_atfork_parent_list;
 }
 
 extern "C" {
+
+bool __pthread_is_multithreaded;
+
 void __pthread_fork_prepare(void)
 {
     if (!g_did_touch_atfork.load())
@@ -91,23 +94,85 @@ int __pthread_self()
 
 int pthread_self() __attribute__((weak, alias("__pthread_self")));
 
-int __pthread_mutex_lock(pthread_mutex_t* mutex)
+// A priority inheriting mutex holds the TID of its owner, so the kernel knows who to lend our priority to while we wait.
+static int lock_priority_inheriting_mutex(pthread_mutex_t* mutex, pthread_t this_thread)
 {
-    pthread_t this_thread = __pthread_self();
     for (;;) {
         u32 expected = 0;
-        if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire)) {
-            if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
-                mutex->level++;
-                return 0;
-            }
-            sched_yield();
-            continue;
+        if (AK::atomic_compare_exchange_strong(&mutex->lock, expected, (u32)this_thread, AK::memory_order_acquire))
+            break;
+        if ((expected & FUTEX_TID_MASK) == (u32)this_thread) {
+            if (mutex->type != __PTHREAD_MUTEX_RECURSIVE)
+                return EDEADLK;
+            mutex->level++;
+            return 0;
+        }
+        if (futex(&mutex->lock, FUTEX_LOCK_PI, 0, nullptr, nullptr, 0) == 0)
+            break;
+        if (errno != EINTR && errno != EAGAIN)
+            return errno;
+    }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
+}
+
+static int unlock_priority_inheriting_mutex(pthread_mutex_t* mutex, pthread_t this_thread)
+{
+    mutex->owner = 0;
+    // If FUTEX_WAITERS is set, someone's waiting, and the kernel has to hand it over.
+    u32 expected = this_thread;
+    if (AK::atomic_compare_exchange_strong(&mutex->lock, expected, 0u, AK::memory_order_release))
+        return 0;
+    if (futex(&mutex->lock, FUTEX_UNLOCK_PI, 0, nullptr, nullptr, 0) < 0)
+        return errno;
+    return 0;
+}
+
+// The lock of a normal mutex is 0 when it's unlocked, 1 when it's locked, and 2 when it's locked and someone may be
+// waiting for it, in which case unlocking it wakes one of them up.
+static constexpr u32 MUTEX_UNLOCKED = 0;
+static constexpr u32 MUTEX_LOCKED = 1;
+static constexpr u32 MUTEX_LOCKED_WITH_WAITERS = 2;
+
+static void lock_mutex_with_waiters(pthread_mutex_t* mutex)
+{
+    // NOTE: We can't tell whether anyone else is waiting once we get it, so we have to assume they are.
+    while (AK::atomic_exchange(&mutex->lock, MUTEX_LOCKED_WITH_WAITERS, AK::memory_order_acquire) != MUTEX_UNLOCKED)
+        futex(&mutex->lock, FUTEX_WAIT, MUTEX_LOCKED_WITH_WAITERS, nullptr, nullptr, 0);
+}
+
+int __pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    pthread_t this_thread = __pthread_self();
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT)
+        return lock_priority_inheriting_mutex(mutex, this_thread);
+    u32 expected = MUTEX_UNLOCKED;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, MUTEX_LOCKED, AK::memory_order_acquire)) {
+        if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+            mutex->level++;
+            return 0;
         }
-        mutex->owner = this_thread;
-        mutex->level = 0;
+        lock_mutex_with_waiters(mutex);
+    }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
+}
+
+int __pthread_mutex_lock_pessimistic_np(pthread_mutex_t* mutex)
+{
+    pthread_t this_thread = __pthread_self();
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT)
+        return lock_priority_inheriting_mutex(mutex, this_thread);
+    if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+        mutex->level++;
         return 0;
     }
+    lock_mutex_with_waiters(mutex);
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
 }
 
 int pthread_mutex_lock(pthread_mutex_t*) __attribute__((weak, alias("__pthread_mutex_lock")));
@@ -118,8 +183,11 @@ int __pthread_mutex_unlock(pthread_mutex_t* mutex)
         mutex->level--;
         return 0;
     }
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT)
+        return unlock_priority_inheriting_mutex(mutex, __pthread_self());
     mutex->owner = 0;
-    AK::atomic_store(&mutex->lock, 0u, AK::memory_order_release);
+    if (AK::atomic_exchange(&mutex->lock, MUTEX_UNLOCKED, AK::memory_order_release) == MUTEX_LOCKED_WITH_WAITERS)
+        futex(&mutex->lock, FUTEX_WAKE, 1, nullptr, nullptr, 0);
     return 0;
 }
 
@@ -127,8 +195,9 @@ int pthread_mutex_unlock(pthread_mutex_t*) __attribute__((weak, alias("__pthread
 
 int __pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
-    u32 expected = 0;
-    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire)) {
+    u32 expected = MUTEX_UNLOCKED;
+    u32 value = mutex->protocol == __PTHREAD_PRIO_INHERIT ? (u32)pthread_self() : MUTEX_LOCKED;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, value, AK::memory_order_acquire)) {
         if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == pthread_self()) {
             mutex->level++;
             return 0;
@@ -148,6 +217,7 @@ int __pthread_mutex_init(pthread_mutex_t* mutex, const pthread_mutexattr_t* attr
     mutex->owner = 0;
     mutex->level = 0;
     mutex->type = attributes ? attributes->type : __PTHREAD_MUTEX_NORMAL;
+    mutex->protocol = attributes ? attributes->protocol : __PTHREAD_PRIO_NONE;
     return 0;
 }
 
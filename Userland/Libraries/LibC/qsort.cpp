@@ -31,11 +31,21 @@ template<>
 inline void swap(const SizedObject& a, const SizedObject& b)
 {
     VERIFY(a.size() == b.size());
-    const size_t size = a.size();
-    const auto a_data = reinterpret_cast<char*>(a.data());
-    const auto b_data = reinterpret_cast<char*>(b.data());
-    for (auto i = 0u; i < size; ++i) {
-        swap(a_data[i], b_data[i]);
+    size_t size = a.size();
+    auto a_data = reinterpret_cast<u8*>(a.data());
+    auto b_data = reinterpret_cast<u8*>(b.data());
+    if (a_data == b_data)
+        return;
+    // Swap in chunks rather than byte by byte, since this is where qsort() spends most of its time.
+    u8 temporary[64];
+    while (size > 0) {
+        size_t chunk_size = min(size, sizeof(temporary));
+        __builtin_memcpy(temporary, a_data, chunk_size);
+        __builtin_memcpy(a_data, b_data, chunk_size);
+        __builtin_memcpy(b_data, temporary, chunk_size);
+        a_data += chunk_size;
+        b_data += chunk_size;
+        size -= chunk_size;
     }
 }
 
@@ -67,7 +77,7 @@ void qsort(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, cons
 
     SizedObjectSlice slice { bot, size };
 
-    AK::dual_pivot_quick_sort(slice, 0, nmemb - 1, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data()) < 0; });
+    AK::pattern_defeating_quick_sort(slice, 0, nmemb, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data()) < 0; });
 }
 
 void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, const void*, void*), void* arg)
@@ -78,5 +88,5 @@ void qsort_r(void* bot, size_t nmemb, size_t size, int (*compar)(const void*, co
 
     SizedObjectSlice slice { bot, size };
 
-    AK::dual_pivot_quick_sort(slice, 0, nmemb - 1, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data(), arg) < 0; });
+    AK::pattern_defeating_quick_sort(slice, 0, nmemb, [=](const SizedObject& a, const SizedObject& b) { return compar(a.data(), b.data(), arg) < 0; });
 }
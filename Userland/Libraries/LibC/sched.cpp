@@ -16,14 +16,26 @@ int sched_yield()
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
-int sched_get_priority_min([[maybe_unused]] int policy)
+int sched_get_priority_min(int policy)
 {
-    return 0; // Idle
+    switch (policy) {
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return 1;
+    default:
+        return 0; // Idle
+    }
 }
 
-int sched_get_priority_max([[maybe_unused]] int policy)
+int sched_get_priority_max(int policy)
 {
-    return 3; // High
+    switch (policy) {
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return 99;
+    default:
+        return 3; // High
+    }
 }
 
 int sched_setparam(pid_t pid, const struct sched_param* param)
@@ -37,4 +49,28 @@ int sched_getparam(pid_t pid, struct sched_param* param)
     int rc = syscall(SC_sched_getparam, pid, param);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
+
+int sched_setscheduler(pid_t pid, int policy, const struct sched_param* param)
+{
+    int rc = syscall(SC_sched_setscheduler, pid, policy, param);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int sched_getscheduler(pid_t pid)
+{
+    int rc = syscall(SC_sched_getscheduler, pid);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int sched_setaffinity(pid_t pid, size_t cpusetsize, const cpu_set_t* mask)
+{
+    int rc = syscall(SC_sched_setaffinity, pid, cpusetsize, mask);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask)
+{
+    int rc = syscall(SC_sched_getaffinity, pid, cpusetsize, mask);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
 }
@@ -4,9 +4,13 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
+#include <Kernel/API/TimePage.h>
+#include <LibELF/AuxiliaryVector.h>
 #include <arpa/inet.h>
 #include <errno.h>
 #include <serenity.h>
+#include <stdlib.h>
 #include <string.h>
 #include <syscall.h>
 
@@ -52,8 +56,8 @@ int futex(uint32_t* userspace_address, int futex_op, uint32_t value, const struc
 {
     int rc;
     switch (futex_op & FUTEX_CMD_MASK) {
-    //case FUTEX_CMP_REQUEUE:
-    // FUTEX_CMP_REQUEUE_PI:
+    case FUTEX_REQUEUE:
+    case FUTEX_CMP_REQUEUE:
     case FUTEX_WAKE_OP: {
         // These interpret timeout as a u32 value for val2
         Syscall::SC_futex_params params {
@@ -95,6 +99,17 @@ int perf_event(int type, uintptr_t arg1, FlatPtr arg2)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int perf_event_is_enabled(int type)
+{
+    // NOTE: Looking the page up more than once (from several threads) does no harm, it's always the same one.
+    static const TimePage* s_time_page;
+    if (!s_time_page)
+        s_time_page = reinterpret_cast<const TimePage*>(getauxval(AT_TIME_PAGE));
+    if (!s_time_page)
+        return 0;
+    return (AK::atomic_load(&s_time_page->tracepoint_event_mask, AK::MemoryOrder::memory_order_relaxed) & type) != 0;
+}
+
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size)
 {
     int rc = syscall(SC_get_stack_bounds, user_stack_base, user_stack_size);
@@ -107,6 +122,18 @@ int anon_create(size_t size, int options)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int io_ring_create(unsigned entries, int options)
+{
+    int rc = syscall(SC_io_ring_create, entries, options);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int io_ring_enter(int fd, unsigned to_submit, unsigned min_complete)
+{
+    int rc = syscall(SC_io_ring_enter, fd, to_submit, min_complete);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int serenity_readlink(const char* path, size_t path_length, char* buffer, size_t buffer_size)
 {
     Syscall::SC_readlink_params small_params {
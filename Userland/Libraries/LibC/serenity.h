@@ -59,6 +59,8 @@ int profiling_free_buffer(pid_t);
 #define FUTEX_REQUEUE 3
 #define FUTEX_CMP_REQUEUE 4
 #define FUTEX_WAKE_OP 5
+#define FUTEX_LOCK_PI 6
+#define FUTEX_UNLOCK_PI 7
 #define FUTEX_WAIT_BITSET 9
 #define FUTEX_WAKE_BITSET 10
 
@@ -68,6 +70,10 @@ int profiling_free_buffer(pid_t);
 
 #define FUTEX_BITSET_MATCH_ANY 0xffffffff
 
+// The value of a priority inheriting futex is the TID of the thread holding it (or 0), and whether anyone's waiting for it.
+#define FUTEX_WAITERS 0x80000000
+#define FUTEX_TID_MASK 0x3fffffff
+
 int futex(uint32_t* userspace_address, int futex_op, uint32_t value, const struct timespec* timeout, uint32_t* userspace_address2, uint32_t value3);
 
 #define PURGE_ALL_VOLATILE 0x1
@@ -90,16 +96,39 @@ enum {
     PERF_EVENT_KMALLOC = 2048,
     PERF_EVENT_KFREE = 4096,
     PERF_EVENT_PAGE_FAULT = 8192,
+    PERF_EVENT_CYCLES = 16384,
+    PERF_EVENT_INSTRUCTIONS = 32768,
+    PERF_EVENT_CACHE_MISS = 65536,
+    PERF_EVENT_BRANCH_MISS = 131072,
+    PERF_EVENT_THREAD_BLOCK = 262144,
+    PERF_EVENT_THREAD_WAKEUP = 524288,
+    PERF_EVENT_SYSCALL_ENTER = 1048576,
+    PERF_EVENT_SYSCALL_EXIT = 2097152,
+    PERF_EVENT_IRQ = 4194304,
+    PERF_EVENT_IPC_SEND = 8388608,
+    PERF_EVENT_IPC_RECEIVE = 16777216,
+    PERF_EVENT_EVENT_LOOP_DISPATCH = 33554432,
 };
 
 #define PERF_EVENT_MASK_ALL (~0ull)
 
+// The events that userspace records itself (with perf_event()) when all processes are being profiled.
+#define PERF_EVENT_USERSPACE_TRACEPOINTS (PERF_EVENT_IPC_SEND | PERF_EVENT_IPC_RECEIVE | PERF_EVENT_EVENT_LOOP_DISPATCH)
+
 int perf_event(int type, uintptr_t arg1, uintptr_t arg2);
 
+// Whether an event of this type would be recorded right now. This doesn't need a syscall, so it's cheap enough
+// to check before every tracepoint.
+int perf_event_is_enabled(int type);
+
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size);
 
 int anon_create(size_t size, int options);
 
+// See Kernel/API/IORing.h for the layout of the shared rings.
+int io_ring_create(unsigned entries, int options);
+int io_ring_enter(int fd, unsigned to_submit, unsigned min_complete);
+
 int serenity_readlink(const char* path, size_t path_length, char* buffer, size_t buffer_size);
 
 int getkeymap(char* name_buffer, size_t name_buffer_size, uint32_t* map, uint32_t* shift_map, uint32_t* alt_map, uint32_t* altgr_map, uint32_t* shift_altgr_map);
@@ -13,154 +13,129 @@
 
 #include <spawn.h>
 
-#include <AK/Function.h>
+#include <AK/String.h>
 #include <AK/Vector.h>
+#include <Kernel/API/Syscall.h>
+#include <alloca.h>
 #include <errno.h>
-#include <fcntl.h>
-#include <stdio.h>
 #include <stdlib.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <unistd.h>
+#include <string.h>
+#include <syscall.h>
 
 struct posix_spawn_file_actions_state {
-    Vector<Function<int()>, 4> actions;
+    struct Action {
+        Syscall::PosixSpawnFileActionType type;
+        int fd { -1 };
+        int new_fd { -1 };
+        int flags { 0 };
+        mode_t mode { 0 };
+        String path;
+    };
+    Vector<Action, 4> actions;
 };
 
 extern "C" {
 
-[[noreturn]] static void posix_spawn_child(const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[], int (*exec)(const char*, char* const[], char* const[]))
+// NOTE: The kernel builds the new process straight from the executable, and applies the file actions and
+//       attributes to it itself, so spawning doesn't have to fork() (and copy) our whole address space first.
+static int spawn(pid_t* out_pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
 {
-    if (attr) {
-        short flags = attr->flags;
-        if (flags & POSIX_SPAWN_RESETIDS) {
-            if (seteuid(getuid()) < 0) {
-                perror("posix_spawn seteuid");
-                _exit(127);
-            }
-            if (setegid(getgid()) < 0) {
-                perror("posix_spawn setegid");
-                _exit(127);
-            }
-        }
-        if (flags & POSIX_SPAWN_SETPGROUP) {
-            if (setpgid(0, attr->pgroup) < 0) {
-                perror("posix_spawn setpgid");
-                _exit(127);
-            }
-        }
-        if (flags & POSIX_SPAWN_SETSCHEDPARAM) {
-            if (sched_setparam(0, &attr->schedparam) < 0) {
-                perror("posix_spawn sched_setparam");
-                _exit(127);
-            }
-        }
-        if (flags & POSIX_SPAWN_SETSIGDEF) {
-            struct sigaction default_action;
-            default_action.sa_flags = 0;
-            sigemptyset(&default_action.sa_mask);
-            default_action.sa_handler = SIG_DFL;
-
-            sigset_t sigdefault = attr->sigdefault;
-            for (int i = 0; i < NSIG; ++i) {
-                if (sigismember(&sigdefault, i) && sigaction(i, &default_action, nullptr) < 0) {
-                    perror("posix_spawn sigaction");
-                    _exit(127);
-                }
-            }
-        }
-        if (flags & POSIX_SPAWN_SETSIGMASK) {
-            if (sigprocmask(SIG_SETMASK, &attr->sigmask, nullptr) < 0) {
-                perror("posix_spawn sigprocmask");
-                _exit(127);
-            }
-        }
-        if (flags & POSIX_SPAWN_SETSID) {
-            if (setsid() < 0) {
-                perror("posix_spawn setsid");
-                _exit(127);
-            }
+    size_t arg_count = 0;
+    for (size_t i = 0; argv[i]; ++i)
+        ++arg_count;
+
+    size_t env_count = 0;
+    for (size_t i = 0; envp[i]; ++i)
+        ++env_count;
+
+    auto copy_strings = [&](auto& vec, size_t count, auto& output) {
+        output.length = count;
+        for (size_t i = 0; vec[i]; ++i) {
+            output.strings[i].characters = vec[i];
+            output.strings[i].length = strlen(vec[i]);
         }
+    };
 
-        // FIXME: POSIX_SPAWN_SETSCHEDULER
-    }
+    Syscall::SC_posix_spawn_params params {};
+    params.arguments.strings = (Syscall::StringArgument*)alloca(arg_count * sizeof(Syscall::StringArgument));
+    params.environment.strings = (Syscall::StringArgument*)alloca(env_count * sizeof(Syscall::StringArgument));
+
+    params.path = { path, strlen(path) };
+    copy_strings(argv, arg_count, params.arguments);
+    copy_strings(envp, env_count, params.environment);
 
+    Vector<Syscall::SC_posix_spawn_file_action, 4> syscall_file_actions;
     if (file_actions) {
-        for (const auto& action : file_actions->state->actions) {
-            if (action() < 0) {
-                perror("posix_spawn file action");
-                _exit(127);
-            }
-        }
+        for (auto& action : file_actions->state->actions)
+            syscall_file_actions.append({ action.type, action.fd, action.new_fd, action.flags, (u16)action.mode, { action.path.characters(), action.path.length() } });
     }
+    params.file_actions = syscall_file_actions.data();
+    params.file_action_count = syscall_file_actions.size();
 
-    exec(path, argv, envp);
-    perror("posix_spawn exec");
-    _exit(127);
+    if (attr) {
+        // FIXME: POSIX_SPAWN_SETSCHEDULER
+        params.attribute_flags = attr->flags;
+        params.pgroup = attr->pgroup;
+        params.priority = attr->schedparam.sched_priority;
+    }
+
+    int rc = syscall(SC_posix_spawn, &params);
+    if (rc < 0)
+        return -rc;
+    if (out_pid)
+        *out_pid = rc;
+    return 0;
 }
 
 int posix_spawn(pid_t* out_pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
 {
-    pid_t child_pid = fork();
-    if (child_pid < 0)
-        return errno;
-
-    if (child_pid != 0) {
-        *out_pid = child_pid;
-        return 0;
-    }
-
-    posix_spawn_child(path, file_actions, attr, argv, envp, execve);
+    return spawn(out_pid, path, file_actions, attr, argv, envp);
 }
 
 int posix_spawnp(pid_t* out_pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
 {
-    pid_t child_pid = fork();
-    if (child_pid < 0)
-        return errno;
+    if (strchr(path, '/'))
+        return spawn(out_pid, path, file_actions, attr, argv, envp);
 
-    if (child_pid != 0) {
-        *out_pid = child_pid;
-        return 0;
+    String search_path = getenv("PATH");
+    if (search_path.is_empty())
+        search_path = "/bin:/usr/bin";
+    for (auto& part : search_path.split(':')) {
+        auto candidate = String::formatted("{}/{}", part, path);
+        int rc = spawn(out_pid, candidate.characters(), file_actions, attr, argv, envp);
+        if (rc != ENOENT)
+            return rc;
     }
-
-    posix_spawn_child(path, file_actions, attr, argv, envp, execvpe);
+    return ENOENT;
 }
 
 int posix_spawn_file_actions_addchdir(posix_spawn_file_actions_t* actions, const char* path)
 {
-    actions->state->actions.append([path]() { return chdir(path); });
+    actions->state->actions.append({ .type = Syscall::PosixSpawnFileActionType::Chdir, .path = path });
     return 0;
 }
 
 int posix_spawn_file_actions_addfchdir(posix_spawn_file_actions_t* actions, int fd)
 {
-    actions->state->actions.append([fd]() { return fchdir(fd); });
+    actions->state->actions.append({ .type = Syscall::PosixSpawnFileActionType::Fchdir, .fd = fd });
     return 0;
 }
 
 int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t* actions, int fd)
 {
-    actions->state->actions.append([fd]() { return close(fd); });
+    actions->state->actions.append({ .type = Syscall::PosixSpawnFileActionType::Close, .fd = fd });
     return 0;
 }
 
 int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* actions, int old_fd, int new_fd)
 {
-    actions->state->actions.append([old_fd, new_fd]() { return dup2(old_fd, new_fd); });
+    actions->state->actions.append({ .type = Syscall::PosixSpawnFileActionType::Dup2, .fd = old_fd, .new_fd = new_fd });
     return 0;
 }
 
 int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* actions, int want_fd, const char* path, int flags, mode_t mode)
 {
-    actions->state->actions.append([want_fd, path, flags, mode]() {
-        int opened_fd = open(path, flags, mode);
-        if (opened_fd < 0 || opened_fd == want_fd)
-            return opened_fd;
-        if (int rc = dup2(opened_fd, want_fd); rc < 0)
-            return rc;
-        return close(opened_fd);
-    });
+    actions->state->actions.append({ .type = Syscall::PosixSpawnFileActionType::Open, .fd = want_fd, .flags = flags, .mode = mode, .path = path });
     return 0;
 }
 
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/internals.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <syscall.h>
@@ -31,7 +32,9 @@ public:
         : m_fd(fd)
         , m_mode(mode)
     {
-        __pthread_mutex_init(&m_mutex, nullptr);
+        // Recursive, so that functions taking the lock still work between flockfile() and funlockfile().
+        pthread_mutexattr_t attributes { __PTHREAD_MUTEX_RECURSIVE, __PTHREAD_PRIO_NONE };
+        __pthread_mutex_init(&m_mutex, &attributes);
     }
     ~FILE();
 
@@ -65,6 +68,10 @@ public:
 
     void reopen(int fd, int mode);
 
+    void lock();
+    void unlock();
+    bool try_lock();
+
     enum Flags : u8 {
         None = 0,
         LastRead = 1,
@@ -108,6 +115,8 @@ private:
         u8 m_unget_buffer { 0 };
         bool m_ungotten : 1 { false };
         bool m_data_is_malloced : 1 { false };
+        // Whether someone asked for a particular size with setvbuf(), otherwise we pick one that suits the file.
+        bool m_capacity_is_fixed : 1 { false };
         // When m_begin == m_end, we want to distinguish whether
         // the buffer is full or empty.
         bool m_empty : 1 { true };
@@ -122,9 +131,6 @@ private:
     // Flush *some* data from the buffer.
     bool write_from_buffer();
 
-    void lock();
-    void unlock();
-
     int m_fd { -1 };
     int m_mode { 0 };
     u8 m_flags { Flags::None };
@@ -453,12 +459,31 @@ FILE::Buffer::~Buffer()
         free(m_data);
 }
 
+// Regular files and pipes are usually read and written in bulk, so a bigger buffer saves a lot of syscalls.
+// Terminals and everything else get the usual BUFSIZ.
+static constexpr size_t large_buffer_size = 16 * KiB;
+static constexpr size_t max_buffer_size = 64 * KiB;
+
+static size_t preferred_buffer_size(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+        return BUFSIZ;
+    if (S_ISREG(st.st_mode))
+        return clamp<size_t>(st.st_blksize, large_buffer_size, max_buffer_size);
+    if (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode))
+        return large_buffer_size;
+    return BUFSIZ;
+}
+
 void FILE::Buffer::realize(int fd)
 {
     if (m_mode == -1)
         m_mode = isatty(fd) ? _IOLBF : _IOFBF;
 
     if (m_mode != _IONBF && m_data == nullptr) {
+        if (!m_capacity_is_fixed)
+            m_capacity = preferred_buffer_size(fd);
         m_data = reinterpret_cast<u8*>(malloc(m_capacity));
         m_data_is_malloced = true;
     }
@@ -471,6 +496,9 @@ void FILE::Buffer::setbuf(u8* data, int mode, size_t size)
     if (data != nullptr) {
         m_data = data;
         m_capacity = size;
+    } else if (size != 0) {
+        m_capacity = size;
+        m_capacity_is_fixed = true;
     }
 }
 
@@ -595,21 +623,32 @@ void FILE::unlock()
     __pthread_mutex_unlock(&m_mutex);
 }
 
+bool FILE::try_lock()
+{
+    return __pthread_mutex_trylock(&m_mutex) == 0;
+}
+
+// NOTE: While there's only one thread, nobody else could be using the file, so we don't bother with the lock.
+//       Once there's another one, this has to lock, even if it's just the two of us.
 class ScopedFileLock {
 public:
     ScopedFileLock(FILE* file)
         : m_file(file)
+        , m_is_locked(__pthread_is_multithreaded)
     {
-        m_file->lock();
+        if (m_is_locked)
+            m_file->lock();
     }
 
     ~ScopedFileLock()
     {
-        m_file->unlock();
+        if (m_is_locked)
+            m_file->unlock();
     }
 
 private:
     FILE* m_file;
+    bool m_is_locked { false };
 };
 
 extern "C" {
@@ -650,53 +689,75 @@ void setlinebuf(FILE* stream)
     setvbuf(stream, nullptr, _IOLBF, 0);
 }
 
+int fileno_unlocked(FILE* stream)
+{
+    VERIFY(stream);
+    return stream->fileno();
+}
+
 int fileno(FILE* stream)
 {
     VERIFY(stream);
     ScopedFileLock lock(stream);
-    return stream->fileno();
+    return fileno_unlocked(stream);
+}
+
+int feof_unlocked(FILE* stream)
+{
+    VERIFY(stream);
+    return stream->eof();
 }
 
 int feof(FILE* stream)
 {
     VERIFY(stream);
     ScopedFileLock lock(stream);
-    return stream->eof();
+    return feof_unlocked(stream);
 }
 
-int fflush(FILE* stream)
+int fflush_unlocked(FILE* stream)
 {
     if (!stream) {
         dbgln("FIXME: fflush(nullptr) should flush all open streams");
         return 0;
     }
-    ScopedFileLock lock(stream);
     return stream->flush() ? 0 : EOF;
 }
 
-char* fgets(char* buffer, int size, FILE* stream)
+int fflush(FILE* stream)
 {
-    VERIFY(stream);
+    if (!stream)
+        return fflush_unlocked(stream);
     ScopedFileLock lock(stream);
+    return fflush_unlocked(stream);
+}
+
+char* fgets_unlocked(char* buffer, int size, FILE* stream)
+{
+    VERIFY(stream);
     bool ok = stream->gets(reinterpret_cast<u8*>(buffer), size);
     return ok ? buffer : nullptr;
 }
 
+char* fgets(char* buffer, int size, FILE* stream)
+{
+    VERIFY(stream);
+    ScopedFileLock lock(stream);
+    return fgets_unlocked(buffer, size, stream);
+}
+
 int fgetc(FILE* stream)
 {
     VERIFY(stream);
-    char ch;
-    size_t nread = fread(&ch, sizeof(char), 1, stream);
-    if (nread == 1)
-        return ch;
-    return EOF;
+    ScopedFileLock lock(stream);
+    return fgetc_unlocked(stream);
 }
 
 int fgetc_unlocked(FILE* stream)
 {
     VERIFY(stream);
-    char ch;
-    size_t nread = fread_unlocked(&ch, sizeof(char), 1, stream);
+    u8 ch;
+    size_t nread = stream->read(&ch, 1);
     if (nread == 1)
         return ch;
     return EOF;
@@ -717,6 +778,11 @@ int getchar()
     return getc(stdin);
 }
 
+int getchar_unlocked()
+{
+    return getc_unlocked(stdin);
+}
+
 ssize_t getdelim(char** lineptr, size_t* n, int delim, FILE* stream)
 {
     if (!lineptr || !n) {
@@ -731,12 +797,13 @@ ssize_t getdelim(char** lineptr, size_t* n, int delim, FILE* stream)
         }
     }
 
+    ScopedFileLock lock(stream);
     char* ptr;
     char* eptr;
     for (ptr = *lineptr, eptr = *lineptr + *n;;) {
-        int c = fgetc(stream);
+        int c = fgetc_unlocked(stream);
         if (c == -1) {
-            if (feof(stream)) {
+            if (feof_unlocked(stream)) {
                 *ptr = '\0';
                 return ptr == *lineptr ? -1 : ptr - *lineptr;
             } else {
@@ -776,11 +843,10 @@ int ungetc(int c, FILE* stream)
     return ok ? c : EOF;
 }
 
-int fputc(int ch, FILE* stream)
+int fputc_unlocked(int ch, FILE* stream)
 {
     VERIFY(stream);
     u8 byte = ch;
-    ScopedFileLock lock(stream);
     size_t nwritten = stream->write(&byte, 1);
     if (nwritten == 0)
         return EOF;
@@ -788,27 +854,50 @@ int fputc(int ch, FILE* stream)
     return byte;
 }
 
+int fputc(int ch, FILE* stream)
+{
+    VERIFY(stream);
+    ScopedFileLock lock(stream);
+    return fputc_unlocked(ch, stream);
+}
+
 int putc(int ch, FILE* stream)
 {
     return fputc(ch, stream);
 }
 
+int putc_unlocked(int ch, FILE* stream)
+{
+    return fputc_unlocked(ch, stream);
+}
+
 int putchar(int ch)
 {
     return putc(ch, stdout);
 }
 
-int fputs(const char* s, FILE* stream)
+int putchar_unlocked(int ch)
+{
+    return putc_unlocked(ch, stdout);
+}
+
+int fputs_unlocked(const char* s, FILE* stream)
 {
     VERIFY(stream);
     size_t len = strlen(s);
-    ScopedFileLock lock(stream);
     size_t nwritten = stream->write(reinterpret_cast<const u8*>(s), len);
     if (nwritten < len)
         return EOF;
     return 1;
 }
 
+int fputs(const char* s, FILE* stream)
+{
+    VERIFY(stream);
+    ScopedFileLock lock(stream);
+    return fputs_unlocked(s, stream);
+}
+
 int puts(const char* s)
 {
     int rc = fputs(s, stdout);
@@ -817,18 +906,30 @@ int puts(const char* s)
     return fputc('\n', stdout);
 }
 
+void clearerr_unlocked(FILE* stream)
+{
+    VERIFY(stream);
+    stream->clear_err();
+}
+
 void clearerr(FILE* stream)
 {
     VERIFY(stream);
     ScopedFileLock lock(stream);
-    stream->clear_err();
+    clearerr_unlocked(stream);
+}
+
+int ferror_unlocked(FILE* stream)
+{
+    VERIFY(stream);
+    return stream->error();
 }
 
 int ferror(FILE* stream)
 {
     VERIFY(stream);
     ScopedFileLock lock(stream);
-    return stream->error();
+    return ferror_unlocked(stream);
 }
 
 size_t fread_unlocked(void* ptr, size_t size, size_t nmemb, FILE* stream)
@@ -849,18 +950,24 @@ size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
     return fread_unlocked(ptr, size, nmemb, stream);
 }
 
-size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
+size_t fwrite_unlocked(const void* ptr, size_t size, size_t nmemb, FILE* stream)
 {
     VERIFY(stream);
     VERIFY(!Checked<size_t>::multiplication_would_overflow(size, nmemb));
 
-    ScopedFileLock lock(stream);
     size_t nwritten = stream->write(reinterpret_cast<const u8*>(ptr), size * nmemb);
     if (!nwritten)
         return 0;
     return nwritten / size;
 }
 
+size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
+{
+    VERIFY(stream);
+    ScopedFileLock lock(stream);
+    return fwrite_unlocked(ptr, size, nmemb, stream);
+}
+
 int fseek(FILE* stream, long offset, int whence)
 {
     VERIFY(stream);
@@ -1287,14 +1394,22 @@ int vscanf(const char* fmt, va_list ap)
     return vfscanf(stdin, fmt, ap);
 }
 
-void flockfile([[maybe_unused]] FILE* filehandle)
+void flockfile(FILE* filehandle)
+{
+    VERIFY(filehandle);
+    filehandle->lock();
+}
+
+void funlockfile(FILE* filehandle)
 {
-    dbgln("FIXME: Implement flockfile()");
+    VERIFY(filehandle);
+    filehandle->unlock();
 }
 
-void funlockfile([[maybe_unused]] FILE* filehandle)
+int ftrylockfile(FILE* filehandle)
 {
-    dbgln("FIXME: Implement funlockfile()");
+    VERIFY(filehandle);
+    return filehandle->try_lock() ? 0 : -1;
 }
 
 FILE* tmpfile()
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/FloatingPointStringConversions.h>
 #include <AK/HashMap.h>
 #include <AK/Noncopyable.h>
 #include <AK/Random.h>
@@ -644,7 +645,21 @@ double strtod(const char* str, char** endptr)
         }
     }
 
-    // TODO: If `exponent` is large, this could be made faster.
+    if (base == 10) {
+        // `digits` is negative if the sign is, but the magnitude (even of i64's minimum) always fits into a u64.
+        u64 significand = sign == Sign::Negative ? 0 - static_cast<u64>(digits.number()) : static_cast<u64>(digits.number());
+        double value = decimal_to_double(significand, exponent, sign == Sign::Negative);
+        // If we had to drop digits, the exact value is somewhere between `digits` and the next number up.
+        // That only matters if those two are on different sides of the middle between two doubles.
+        if (!digits_overflow || value == decimal_to_double(significand + 1, exponent, sign == Sign::Negative)) {
+            if (value == 0.0 || value == __builtin_huge_val() || value == -__builtin_huge_val())
+                errno = ERANGE;
+            return value;
+        }
+    }
+
+    // FIXME: This is slow and not correctly rounded. We only get here for hexadecimal numbers,
+    //        and for decimal ones with more than 19 digits that are too close to call.
     double value = digits.number();
     if (exponent < 0) {
         exponent = -exponent;
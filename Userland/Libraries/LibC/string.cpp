@@ -17,6 +17,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+// The functions below look at a whole word at a time where they can.
+// NOTE: Words are only ever read from aligned addresses, so they can't reach into the next page,
+//       even if they go past the end of the string.
+using AliasingWord = size_t __attribute__((may_alias));
+
+static constexpr size_t word_with_every_byte_set_to(u8 byte)
+{
+    return static_cast<size_t>(-1) / 0xff * byte;
+}
+
+static constexpr bool word_has_zero_byte(size_t word)
+{
+    return (word - word_with_every_byte_set_to(0x01)) & ~word & word_with_every_byte_set_to(0x80);
+}
+
+static constexpr bool is_word_aligned(const void* ptr)
+{
+    return (reinterpret_cast<FlatPtr>(ptr) % sizeof(size_t)) == 0;
+}
+
 extern "C" {
 
 size_t strspn(const char* s, const char* accept)
@@ -47,10 +67,17 @@ size_t strcspn(const char* s, const char* reject)
 
 size_t strlen(const char* str)
 {
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
+    auto* ptr = str;
+    for (; !is_word_aligned(ptr); ++ptr) {
+        if (!*ptr)
+            return ptr - str;
+    }
+    auto* word = reinterpret_cast<const AliasingWord*>(ptr);
+    while (!word_has_zero_byte(*word))
+        ++word;
+    for (ptr = reinterpret_cast<const char*>(word); *ptr; ++ptr)
+        ;
+    return ptr - str;
 }
 
 size_t strnlen(const char* str, size_t maxlen)
@@ -104,6 +131,15 @@ int memcmp(const void* v1, const void* v2, size_t n)
 {
     auto* s1 = (const uint8_t*)v1;
     auto* s2 = (const uint8_t*)v2;
+    // Skip over the identical words first, then find the byte that differs.
+    for (; n >= sizeof(size_t); n -= sizeof(size_t), s1 += sizeof(size_t), s2 += sizeof(size_t)) {
+        size_t word1;
+        size_t word2;
+        __builtin_memcpy(&word1, s1, sizeof(size_t));
+        __builtin_memcpy(&word2, s2, sizeof(size_t));
+        if (word1 != word2)
+            break;
+    }
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
@@ -214,7 +250,17 @@ size_t strlcpy(char* dest, const char* src, size_t n)
 char* strchr(const char* str, int c)
 {
     char ch = c;
-    for (;; ++str) {
+    for (; !is_word_aligned(str); ++str) {
+        if (*str == ch)
+            return const_cast<char*>(str);
+        if (!*str)
+            return nullptr;
+    }
+    auto pattern = word_with_every_byte_set_to((u8)ch);
+    auto* word = reinterpret_cast<const AliasingWord*>(str);
+    while (!word_has_zero_byte(*word) && !word_has_zero_byte(*word ^ pattern))
+        ++word;
+    for (str = reinterpret_cast<const char*>(word);; ++str) {
         if (*str == ch)
             return const_cast<char*>(str);
         if (!*str)
@@ -235,6 +281,15 @@ void* memchr(const void* ptr, int c, size_t size)
 {
     char ch = c;
     auto* cptr = (const char*)ptr;
+    for (; size && !is_word_aligned(cptr); --size, ++cptr) {
+        if (*cptr == ch)
+            return const_cast<char*>(cptr);
+    }
+    auto pattern = word_with_every_byte_set_to((u8)ch);
+    auto* word = reinterpret_cast<const AliasingWord*>(cptr);
+    for (; size >= sizeof(size_t) && !word_has_zero_byte(*word ^ pattern); size -= sizeof(size_t))
+        ++word;
+    cptr = reinterpret_cast<const char*>(word);
     for (size_t i = 0; i < size; ++i) {
         if (cptr[i] == ch)
             return const_cast<char*>(cptr + i);
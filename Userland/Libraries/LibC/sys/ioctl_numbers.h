@@ -23,6 +23,18 @@ struct FBResolution {
     unsigned height;
 };
 
+struct FBRect {
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+};
+
+struct FBRects {
+    unsigned count;
+    const struct FBRect* rects;
+};
+
 __END_DECLS
 
 enum IOCtlNumber {
@@ -43,6 +55,7 @@ enum IOCtlNumber {
     FB_IOCTL_SET_RESOLUTION,
     FB_IOCTL_GET_BUFFER,
     FB_IOCTL_SET_BUFFER,
+    FB_IOCTL_FLUSH_RECTS,
     SIOCSIFADDR,
     SIOCGIFADDR,
     SIOCGIFHWADDR,
@@ -56,6 +69,8 @@ enum IOCtlNumber {
     SIOCDELRT,
     FIBMAP,
     FIONBIO,
+    SOUNDCARD_IOCTL_GET_PERIOD_SIZE,
+    SOUNDCARD_IOCTL_SET_PERIOD_SIZE,
 };
 
 #define TIOCGPGRP TIOCGPGRP
@@ -75,6 +90,7 @@ enum IOCtlNumber {
 #define FB_IOCTL_SET_RESOLUTION FB_IOCTL_SET_RESOLUTION
 #define FB_IOCTL_GET_BUFFER FB_IOCTL_GET_BUFFER
 #define FB_IOCTL_SET_BUFFER FB_IOCTL_SET_BUFFER
+#define FB_IOCTL_FLUSH_RECTS FB_IOCTL_FLUSH_RECTS
 #define SIOCSIFADDR SIOCSIFADDR
 #define SIOCGIFADDR SIOCGIFADDR
 #define SIOCGIFHWADDR SIOCGIFHWADDR
@@ -88,3 +104,5 @@ enum IOCtlNumber {
 #define SIOCDELRT SIOCDELRT
 #define FIBMAP FIBMAP
 #define FIONBIO FIONBIO
+#define SOUNDCARD_IOCTL_GET_PERIOD_SIZE SOUNDCARD_IOCTL_GET_PERIOD_SIZE
+#define SOUNDCARD_IOCTL_SET_PERIOD_SIZE SOUNDCARD_IOCTL_SET_PERIOD_SIZE
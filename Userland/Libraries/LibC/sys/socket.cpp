@@ -80,6 +80,20 @@ ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int sendmmsg(int sockfd, struct mmsghdr* messages, unsigned int vlen, int flags)
+{
+    Syscall::SC_sendmmsg_params params { sockfd, messages, vlen, flags };
+    int rc = syscall(SC_sendmmsg, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int recvmmsg(int sockfd, struct mmsghdr* messages, unsigned int vlen, int flags, struct timespec* timeout)
+{
+    Syscall::SC_recvmmsg_params params { sockfd, messages, vlen, flags, timeout };
+    int rc = syscall(SC_recvmmsg, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 ssize_t recvfrom(int sockfd, void* buffer, size_t buffer_length, int flags, struct sockaddr* addr, socklen_t* addr_length)
 {
     if (!addr_length && addr) {
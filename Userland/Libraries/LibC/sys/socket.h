@@ -49,6 +49,7 @@ __BEGIN_DECLS
 #define MSG_PEEK 0x4
 #define MSG_OOB 0x8
 #define MSG_DONTWAIT 0x40
+#define MSG_WAITFORONE 0x10000
 
 typedef uint16_t sa_family_t;
 
@@ -68,6 +69,13 @@ struct msghdr {
     int msg_flags;
 };
 
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
+struct timespec;
+
 struct sockaddr {
     sa_family_t sa_family;
     char sa_data[14];
@@ -95,6 +103,7 @@ enum {
     SO_KEEPALIVE,
     SO_TIMESTAMP,
     SO_BROADCAST,
+    SO_REUSEPORT,
 };
 #define SO_RCVTIMEO SO_RCVTIMEO
 #define SO_SNDTIMEO SO_SNDTIMEO
@@ -106,6 +115,7 @@ enum {
 #define SO_KEEPALIVE SO_KEEPALIVE
 #define SO_TIMESTAMP SO_TIMESTAMP
 #define SO_BROADCAST SO_BROADCAST
+#define SO_REUSEPORT SO_REUSEPORT
 #define SO_SNDBUF SO_SNDBUF
 #define SO_RCVBUF SO_RCVBUF
 
@@ -137,6 +147,8 @@ ssize_t sendto(int sockfd, const void*, size_t, int flags, const struct sockaddr
 ssize_t recv(int sockfd, void*, size_t, int flags);
 ssize_t recvmsg(int sockfd, struct msghdr*, int flags);
 ssize_t recvfrom(int sockfd, void*, size_t, int flags, struct sockaddr*, socklen_t*);
+int sendmmsg(int sockfd, struct mmsghdr*, unsigned int vlen, int flags);
+int recvmmsg(int sockfd, struct mmsghdr*, unsigned int vlen, int flags, struct timespec* timeout);
 int getsockopt(int sockfd, int level, int option, void*, socklen_t*);
 int setsockopt(int sockfd, int level, int option, const void*, socklen_t);
 int getsockname(int sockfd, struct sockaddr*, socklen_t*);
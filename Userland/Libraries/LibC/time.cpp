@@ -7,18 +7,68 @@
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <AK/Time.h>
+#include <Kernel/API/TimePage.h>
+#include <LibELF/AuxiliaryVector.h>
 #include <assert.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <sys/internals.h>
 #include <sys/times.h>
 #include <syscall.h>
 #include <time.h>
 #include <utime.h>
 
+static const TimePage* s_time_page;
+
+// Reads the clock from the kernel's time page, if it's there and has the clock we want.
+static bool read_clock_from_time_page(clockid_t clock_id, timespec& ts)
+{
+    auto* page = s_time_page;
+    if (!page)
+        return false;
+
+    const volatile TimePageClock* clock = nullptr;
+    switch (clock_id) {
+    case CLOCK_MONOTONIC:
+    case CLOCK_MONOTONIC_RAW:
+        if (page->monotonic_is_more_precise_than_coarse)
+            return false;
+        [[fallthrough]];
+    case CLOCK_MONOTONIC_COARSE:
+        clock = &page->monotonic_coarse;
+        break;
+    // NOTE: The kernel doesn't know the time of day any more precisely than this either.
+    case CLOCK_REALTIME:
+    case CLOCK_REALTIME_COARSE:
+        clock = &page->realtime_coarse;
+        break;
+    default:
+        return false;
+    }
+
+    for (;;) {
+        u32 update_iteration = AK::atomic_load(&page->update2, AK::MemoryOrder::memory_order_acquire);
+        i64 seconds = clock->seconds;
+        u32 nanoseconds = clock->nanoseconds;
+        AK::atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
+        if (AK::atomic_load(&page->update1, AK::MemoryOrder::memory_order_relaxed) == update_iteration) {
+            ts.tv_sec = seconds;
+            ts.tv_nsec = nanoseconds;
+            return true;
+        }
+    }
+}
+
 extern "C" {
 
+void __time_init()
+{
+    s_time_page = reinterpret_cast<const TimePage*>(getauxval(AT_TIME_PAGE));
+}
+
 time_t time(time_t* tloc)
 {
     struct timeval tv;
@@ -38,6 +88,11 @@ int adjtime(const struct timeval* delta, struct timeval* old_delta)
 
 int gettimeofday(struct timeval* __restrict__ tv, void* __restrict__)
 {
+    timespec ts;
+    if (read_clock_from_time_page(CLOCK_REALTIME, ts)) {
+        TIMESPEC_TO_TIMEVAL(tv, &ts);
+        return 0;
+    }
     int rc = syscall(SC_gettimeofday, tv);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -355,6 +410,8 @@ clock_t clock()
 
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
+    if (ts && read_clock_from_time_page(clock_id, *ts))
+        return 0;
     int rc = syscall(SC_clock_gettime, clock_id, ts);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -8,7 +8,6 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
 #include <AK/MemoryStream.h>
 #include <string.h>
 
@@ -59,10 +58,11 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
         code.m_symbol_values.append(last_non_zero);
+        code.m_code_length_counts[1] = 1;
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.fill_fast_lookup(last_non_zero);
         return code;
     }
 
@@ -78,10 +78,11 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
             code.m_symbol_values.append(symbol);
+            code.m_code_length_counts[code_length]++;
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
+            code.fill_fast_lookup(symbol);
 
             next_code++;
         }
@@ -94,21 +95,47 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
     return code;
 }
 
+void CanonicalCode::fill_fast_lookup(u16 symbol)
+{
+    size_t code_length = m_bit_code_lengths[symbol];
+    if (code_length > fast_lookup_bits)
+        return;
+
+    // The code is followed by the start of the next one, so every index that starts with the code maps to this symbol
+    for (size_t index = m_bit_codes[symbol]; index < m_fast_lookup.size(); index += 1 << code_length)
+        m_fast_lookup[index] = symbol << 4 | code_length;
+}
+
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
-    u32 code_bits = 1;
-
-    for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+    auto bits = stream.peek_bits(max_code_length);
+
+    // Most symbols have short codes, which we can look up all at once
+    if (auto entry = m_fast_lookup[bits & (m_fast_lookup.size() - 1)]; entry != 0) {
+        if (!stream.discard_bits(entry & 0xf))
+            return UINT32_MAX;
+        return entry >> 4;
     }
+
+    // Canonical codes of the same length are consecutive numbers, so after every bit we only have to check whether
+    // the code read so far falls into the range of codes of that length (see puff.c in zlib).
+    u32 code = 0;
+    u32 first_code = 0;
+    u32 first_index = 0;
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
+        code |= (bits >> (code_length - 1)) & 1;
+        u32 count = m_code_length_counts[code_length];
+        if (code - first_code < count) {
+            if (!stream.discard_bits(code_length))
+                return UINT32_MAX;
+            return m_symbol_values[first_index + (code - first_code)];
+        }
+        first_index += count;
+        first_code = (first_code + count) << 1;
+        code <<= 1;
+    }
+
+    return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
 }
 
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
@@ -155,14 +182,10 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        if (!m_decompressor.m_output_stream.write_from_seekback(distance, length)) {
+            m_decompressor.m_output_stream.handle_any_error();
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
         }
 
         return true;
@@ -355,12 +378,26 @@ bool DeflateDecompressor::handle_any_error()
     return Stream::handle_any_error() || handled_errors;
 }
 
-Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
+void DeflateDecompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_state == State::Idle && !m_read_final_bock);
+
+    // The dictionary only has to be reachable by back references, so we put it into the window without anyone reading it.
+    if (dictionary.size() > 32 * KiB)
+        dictionary = dictionary.slice(dictionary.size() - 32 * KiB);
+    m_output_stream.write_or_error(dictionary);
+    m_output_stream.discard_or_error(dictionary.size());
+}
+
+Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes, ReadonlyBytes dictionary)
 {
     InputMemoryStream memory_stream { bytes };
     DeflateDecompressor deflate_stream { memory_stream };
     DuplexMemoryStream output_stream;
 
+    if (!dictionary.is_empty())
+        deflate_stream.set_dictionary(dictionary);
+
     u8 buffer[4096];
     while (!deflate_stream.has_any_error() && !deflate_stream.unreliable_eof()) {
         const auto nread = deflate_stream.read({ buffer, sizeof(buffer) });
@@ -510,6 +547,8 @@ DeflateCompressor::DeflateCompressor(OutputStream& stream, CompressionLevel comp
 {
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
+    for (auto& slot : m_hash_head)
+        slot = empty_slot;
 }
 
 DeflateCompressor::~DeflateCompressor()
@@ -517,6 +556,17 @@ DeflateCompressor::~DeflateCompressor()
     VERIFY(m_finished);
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(!m_finished && m_pending_block_size == 0 && m_unhashed_history_size == 0);
+
+    // The dictionary goes where the previous block would usually be, and gets hashed along with the first block.
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_unhashed_history_size = dictionary.size();
+}
+
 size_t DeflateCompressor::write(ReadonlyBytes bytes)
 {
     VERIFY(!m_finished);
@@ -590,7 +640,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -688,40 +738,90 @@ void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, const
     }
 }
 
+void DeflateCompressor::insert_hash(size_t position, u16 hash)
+{
+    auto window_position = position % window_size;
+    m_hash_prev[window_position] = m_hash_head[hash];
+    m_hash_head[hash] = window_position;
+}
+
+void DeflateCompressor::emit_literal(u8 literal)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = 0;
+    m_symbol_buffer[index].literal = literal;
+    m_symbol_frequencies[literal]++;
+}
+
+void DeflateCompressor::emit_back_reference(u16 distance, u16 length)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = distance;
+    m_symbol_buffer[index].length = length;
+    m_symbol_frequencies[length_to_symbol[length]]++;
+    m_distance_frequencies[distance_to_base(distance)]++;
+}
+
 void DeflateCompressor::lz77_compress_block()
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
-        slot = empty_slot;
+    VERIFY(m_compression_constants.great_match_length <= max_match_length);
+
+    // Hash what's left of the window before this block, which is either the last few bytes of the previous block
+    // (which couldn't be hashed without the start of this one) or the whole dictionary
+    auto block_end = block_size + m_pending_block_size;
+    for (size_t position = block_size - m_unhashed_history_size; position < block_size; position++) {
+        if (position + min_match_length <= block_end)
+            insert_hash(position, hash_sequence(&m_rolling_window[position]));
     }
+    m_unhashed_history_size = 0;
 
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
+    if (m_compression_constants.lazy_matching)
+        lz77_compress_block_lazy();
+    else
+        lz77_compress_block_greedy();
+}
 
-    auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
-    };
+void DeflateCompressor::lz77_compress_block_greedy()
+{
+    // our block starts at block_size and is m_pending_block_size in length
+    auto block_end = block_size + m_pending_block_size;
+    size_t current_position;
+    for (current_position = block_size; current_position < block_end - min_match_length + 1; current_position++) {
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        size_t match_position;
+        auto match_length = find_back_match(current_position, hash, 0,
+            min(m_compression_constants.great_match_length, block_end - current_position), match_position);
 
-    auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
-    };
+        insert_hash(current_position, hash);
+
+        if (match_length == 0) {
+            emit_literal(m_rolling_window[current_position]);
+            continue;
+        }
+
+        emit_back_reference(current_position - match_position, match_length);
+
+        // only spend time on hashing the bytes inside of the match if it's a short one
+        if (match_length <= m_compression_constants.max_lazy_length) {
+            for (size_t j = current_position + 1; j < min(current_position + match_length, block_end - min_match_length + 1); j++)
+                insert_hash(j, hash_sequence(&m_rolling_window[j]));
+        }
+        current_position += match_length - 1;
+    }
 
+    // output remaining literals
+    while (current_position < block_end) {
+        emit_literal(m_rolling_window[current_position++]);
+    }
+}
+
+void DeflateCompressor::lz77_compress_block_lazy()
+{
     size_t previous_match_length = 0;
     size_t previous_match_position = 0;
 
-    VERIFY(m_compression_constants.great_match_length <= max_match_length);
-
     // our block starts at block_size and is m_pending_block_size in length
     auto block_end = block_size + m_pending_block_size;
     size_t current_position;
@@ -773,6 +873,24 @@ void DeflateCompressor::lz77_compress_block()
     }
 }
 
+void DeflateCompressor::slide_window()
+{
+    // Move the block we just wrote into the first half of the window, where the next block can still reach it,
+    // and move the hash chains along with it, forgetting about everything that's now outside of the window.
+    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+    m_unhashed_history_size = min_match_length - 1;
+
+    auto slide = [](u16 position) -> u16 {
+        if (position == empty_slot || position < block_size)
+            return empty_slot;
+        return position - block_size;
+    };
+    for (auto& slot : m_hash_head)
+        slot = slide(slot);
+    for (size_t i = 0; i < block_size; i++)
+        m_hash_prev[i] = slide(m_hash_prev[i + block_size]);
+}
+
 size_t DeflateCompressor::huffman_block_length(const Array<u8, max_huffman_literals>& literal_bit_lengths, const Array<u8, max_huffman_distances>& distance_bit_lengths)
 {
     size_t length = 0;
@@ -954,7 +1072,7 @@ void DeflateCompressor::flush()
         return;
     }
 
-    m_output_stream.write_bit(m_finished);
+    m_output_stream.write_bit(m_finished && m_ends_stream);
 
     // if this is just an empty block to signify the end of the deflate stream use the smallest block possible (10 bits total)
     if (m_pending_block_size == 0) {
@@ -1033,7 +1151,7 @@ void DeflateCompressor::flush()
         auto distance_code = CanonicalCode::from_bytes(dynamic_distance_bit_lengths);
         write_dynamic_huffman(literal_code.value(), literal_code_count, distance_code, distance_code_count, code_lengths_bit_lengths, code_lengths_count, encoded_lengths, encoded_lengths_count);
     }
-    if (m_finished)
+    if (m_finished && m_ends_stream)
         m_output_stream.align_to_byte_boundary();
 
     // reset all block specific members
@@ -1041,8 +1159,9 @@ void DeflateCompressor::flush()
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
-    // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+    // The final block might not be a full one, but there's no block after it that could use the window
+    if (!m_finished)
+        slide_window();
 }
 
 void DeflateCompressor::final_flush()
@@ -1052,11 +1171,36 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
-Optional<ByteBuffer> DeflateCompressor::compress_all(const ReadonlyBytes& bytes, CompressionLevel compression_level)
+void DeflateCompressor::final_sync_flush()
+{
+    VERIFY(!m_finished);
+    m_finished = true;
+    m_ends_stream = false;
+    if (m_pending_block_size != 0)
+        flush();
+
+    if (m_output_stream.handle_any_error()) {
+        set_fatal_error();
+        return;
+    }
+
+    // an empty stored block, which ends right after its length fields, and those start on a byte boundary
+    m_output_stream.write_bit(false);
+    m_output_stream.write_bits(0b00, 2);
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    LittleEndian<u16> nlen = 0xffff;
+    m_output_stream << len << nlen;
+}
+
+Optional<ByteBuffer> DeflateCompressor::compress_all(const ReadonlyBytes& bytes, CompressionLevel compression_level, ReadonlyBytes dictionary)
 {
     DuplexMemoryStream output_stream;
     DeflateCompressor deflate_stream { output_stream, compression_level };
 
+    if (!dictionary.is_empty())
+        deflate_stream.set_dictionary(dictionary);
+
     deflate_stream.write_or_error(bytes);
 
     deflate_stream.final_flush();
@@ -28,9 +28,17 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
+    void fill_fast_lookup(u16 symbol);
+
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t fast_lookup_bits = 10;
+
+    // Decompression - the symbols in the order of their codes, and how many codes there are of every length
     Vector<u16> m_symbol_values;
+    Array<u16, 16> m_code_length_counts {};
+    // ...and the symbol and code length (as symbol << 4 | length) of every code that fits into fast_lookup_bits,
+    // indexed by the next fast_lookup_bits bits of the stream, or 0 if the code is longer than that
+    Array<u16, 1 << fast_lookup_bits> m_fast_lookup {};
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -77,6 +85,10 @@ public:
     DeflateDecompressor(InputStream&);
     ~DeflateDecompressor();
 
+    // The decompressor reads a few bytes ahead of the deflate data, so once it has reached the end, anything that
+    // comes after the deflate data in the underlying stream has to be read from here.
+    InputStream& input_stream() { return m_input_stream; }
+
     size_t read(Bytes) override;
     bool read_or_error(Bytes) override;
     bool discard_or_error(size_t) override;
@@ -84,7 +96,11 @@ public:
     bool unreliable_eof() const override;
     bool handle_any_error() override;
 
-    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    // The data the stream was compressed with a preset dictionary of (see DeflateCompressor::set_dictionary()),
+    // which has to be set before anything is read.
+    void set_dictionary(ReadonlyBytes);
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes, ReadonlyBytes dictionary = {});
 
 private:
     u32 decode_length(u32);
@@ -118,40 +134,59 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_distance = 32 * KiB; // back references can't reach further back than this
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
         size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time
         size_t max_lazy_length;    // If the match is at least this long we dont defer matching to the next byte (which takes time) as its good enough
+                                   // Without lazy matching, we only add the bytes inside of matches up to this long to the hash chains
         size_t great_match_length; // Once we find a match of at least this length (a great match) we can just stop searching for longer ones
         size_t max_chain;          // We only check the actual length of the max_chain closest matches
+        bool lazy_matching;        // Whether we check if a match starting at the next byte would be longer before taking one
     };
 
-    // These constants were shamelessly "borrowed" from zlib
+    // These constants were shamelessly "borrowed" from zlib, and are indexed by the compression level
     static constexpr CompressionConstants compression_constants[] = {
-        { 0, 0, 0, 0 },
-        { 4, 4, 8, 4 },
-        { 8, 16, 128, 128 },
-        { 32, 258, 258, 4096 },
-        { max_match_length, max_match_length, max_match_length, 1 << hash_bits } // disable all limits
+        { 0, 0, 0, 0, false },
+        { 4, 4, 8, 1, false }, // zlib checks 4 candidates here, but we want one level that only ever looks at one
+        { 4, 5, 16, 8, false },
+        { 4, 6, 32, 32, false },
+        { 4, 4, 16, 16, true },
+        { 8, 16, 32, 32, true },
+        { 8, 16, 128, 128, true },
+        { 8, 32, 128, 256, true },
+        { 32, 128, 258, 1024, true },
+        { 32, 258, 258, 4096, true },
+        { max_match_length, max_match_length, max_match_length, 1 << hash_bits, true } // disable all limits
     };
 
+    // The levels from 1 to 9 correspond to zlib's levels, so any of the levels in between the named ones can be used as well.
     enum class CompressionLevel : int {
         STORE = 0,
-        FAST,
-        GOOD,
-        GREAT,
-        BEST // WARNING: this one can take an unreasonable amount of time!
+        FAST = 1,
+        GOOD = 6,
+        GREAT = 9,
+        BEST = 10 // WARNING: this one can take an unreasonable amount of time!
     };
 
     DeflateCompressor(OutputStream&, CompressionLevel = CompressionLevel::GOOD);
     ~DeflateCompressor();
 
+    // Lets back references reach into the given data as if it came right before the stream, which helps a lot
+    // for small inputs that share a lot with some known data. This has to be called before anything is written,
+    // and the decompressor has to be given the same dictionary. Only the last 32 KiB of the dictionary are used.
+    void set_dictionary(ReadonlyBytes);
+
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
+    // Like final_flush(), but without marking the last block as the final one, and with an empty stored block after it
+    // that pads the output to a whole byte. Another stream can then be appended to make up a single valid deflate stream,
+    // which is how chunks that were compressed independently (with the previous chunk as the dictionary) get stitched together.
+    void final_sync_flush();
 
-    static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, CompressionLevel = CompressionLevel::GOOD);
+    static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, CompressionLevel = CompressionLevel::GOOD, ReadonlyBytes dictionary = {});
 
 private:
     Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
@@ -160,7 +195,13 @@ private:
     static u16 hash_sequence(const u8* bytes);
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
+    void insert_hash(size_t position, u16 hash);
     void lz77_compress_block();
+    void lz77_compress_block_greedy();
+    void lz77_compress_block_lazy();
+    void emit_literal(u8);
+    void emit_back_reference(u16 distance, u16 length);
+    void slide_window();
 
     // Huffman Coding
     struct code_length_symbol {
@@ -182,12 +223,15 @@ private:
     void flush();
 
     bool m_finished { false };
+    bool m_ends_stream { true };
     CompressionLevel m_compression_level;
     CompressionConstants m_compression_constants;
     OutputBitStream m_output_stream;
 
+    // The pending block is in the second half, and the first half holds the previous block (or the dictionary), which back references can reach into.
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_unhashed_history_size { 0 };
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -200,7 +244,7 @@ private:
     Array<u16, max_huffman_literals> m_symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
     Array<u16, max_huffman_distances> m_distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
 
-    // LZ77 Chained hash table
+    // LZ77 Chained hash table, with positions in the rolling window that are kept across blocks
     u16 m_hash_head[1 << hash_bits];
     u16 m_hash_prev[window_size];
 };
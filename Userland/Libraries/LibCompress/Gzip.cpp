@@ -70,7 +70,7 @@ size_t GzipDecompressor::read(Bytes bytes)
 
             if (nread < slice.size()) {
                 LittleEndian<u32> crc32, input_size;
-                m_input_stream >> crc32 >> input_size;
+                current_member().m_stream.input_stream() >> crc32 >> input_size;
 
                 if (crc32 != current_member().m_checksum.digest()) {
                     // FIXME: Somehow the checksum is incorrect?
@@ -229,7 +229,7 @@ GzipCompressor::~GzipCompressor()
 {
 }
 
-size_t GzipCompressor::write(ReadonlyBytes bytes)
+void GzipCompressor::write_header(OutputStream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -239,15 +239,25 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    m_output_stream << Bytes { &header, sizeof(header) };
+    stream << Bytes { &header, sizeof(header) };
+}
+
+void GzipCompressor::write_trailer(OutputStream& stream, u32 crc32, size_t uncompressed_size)
+{
+    LittleEndian<u32> digest = crc32;
+    LittleEndian<u32> size = uncompressed_size; // this is the size modulo 2^32
+    stream << digest << size;
+}
+
+size_t GzipCompressor::write(ReadonlyBytes bytes)
+{
+    write_header(m_output_stream);
     DeflateCompressor compressed_stream { m_output_stream };
     VERIFY(compressed_stream.write_or_error(bytes));
     compressed_stream.final_flush();
     Crypto::Checksum::CRC32 crc32;
     crc32.update(bytes);
-    LittleEndian<u32> digest = crc32.digest();
-    LittleEndian<u32> size = bytes.size();
-    m_output_stream << digest << size;
+    write_trailer(m_output_stream, crc32.digest(), bytes.size());
     return bytes.size();
 }
 
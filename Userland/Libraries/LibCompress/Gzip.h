@@ -89,6 +89,11 @@ public:
 
     static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes);
 
+    // What comes before and after the deflate stream of a member, for putting one together from chunks that were
+    // compressed separately (see DeflateCompressor::final_sync_flush()).
+    static void write_header(OutputStream&);
+    static void write_trailer(OutputStream&, u32 crc32, size_t uncompressed_size);
+
 private:
     OutputStream& m_output_stream;
 };
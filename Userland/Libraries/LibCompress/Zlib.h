@@ -18,6 +18,9 @@ public:
     Optional<ByteBuffer> decompress();
     u32 checksum();
 
+    // The deflate stream inside the zlib wrapper, for decompressing it piece by piece with a DeflateDecompressor.
+    ReadonlyBytes deflate_data() const { return m_data_bytes; }
+
     static Optional<Zlib> try_create(ReadonlyBytes data);
     static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
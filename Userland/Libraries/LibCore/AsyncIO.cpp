@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/AsyncIO.h>
+
+namespace Core {
+
+void FDAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    m_handle = handle;
+    m_notifier = Notifier::construct(m_fd, m_event);
+    if (m_event == Notifier::Read)
+        m_notifier->on_ready_to_read = [this] { finish(false); };
+    else
+        m_notifier->on_ready_to_write = [this] { finish(false); };
+
+    if (m_timeout_ms >= 0) {
+        m_timer = Timer::create_single_shot(m_timeout_ms, [this] { finish(true); });
+        m_timer->start();
+    }
+}
+
+void FDAwaiter::finish(bool timed_out)
+{
+    // Both may have fired in the same event loop iteration, so make sure we only resume once.
+    if (!m_handle)
+        return;
+    m_notifier->set_enabled(false);
+    if (m_timer)
+        m_timer->stop();
+    m_timed_out = timed_out;
+    // NOTE: Resuming is the last thing we do, since the coroutine is going to destroy us as it moves on.
+    exchange(m_handle, nullptr).resume();
+}
+
+void SleepAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    m_timer = Timer::create_single_shot(m_milliseconds, [handle] { handle.resume(); });
+    m_timer->start();
+}
+
+}
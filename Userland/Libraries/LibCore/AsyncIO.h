@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/RefPtr.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Task.h>
+#include <LibCore/Timer.h>
+
+namespace Core {
+
+// Things a Task can co_await on, all of which resume it from the event loop.
+
+// Waits until the fd becomes readable (or writable), or until timeout_ms have passed.
+// co_await'ing it returns false if it timed out. A negative timeout waits for as long as it takes.
+class FDAwaiter {
+    AK_MAKE_NONCOPYABLE(FDAwaiter);
+    AK_MAKE_NONMOVABLE(FDAwaiter);
+
+public:
+    FDAwaiter(int fd, Notifier::Event event, int timeout_ms)
+        : m_fd(fd)
+        , m_event(event)
+        , m_timeout_ms(timeout_ms)
+    {
+    }
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<>);
+    bool await_resume() const { return !m_timed_out; }
+
+private:
+    void finish(bool timed_out);
+
+    int m_fd { -1 };
+    Notifier::Event m_event { Notifier::None };
+    int m_timeout_ms { -1 };
+    bool m_timed_out { false };
+    std::coroutine_handle<> m_handle;
+    RefPtr<Notifier> m_notifier;
+    RefPtr<Timer> m_timer;
+};
+
+inline FDAwaiter readable(int fd, int timeout_ms = -1) { return { fd, Notifier::Read, timeout_ms }; }
+inline FDAwaiter writable(int fd, int timeout_ms = -1) { return { fd, Notifier::Write, timeout_ms }; }
+
+class SleepAwaiter {
+    AK_MAKE_NONCOPYABLE(SleepAwaiter);
+    AK_MAKE_NONMOVABLE(SleepAwaiter);
+
+public:
+    explicit SleepAwaiter(int milliseconds)
+        : m_milliseconds(milliseconds)
+    {
+    }
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<>);
+    void await_resume() const { }
+
+private:
+    int m_milliseconds { 0 };
+    RefPtr<Timer> m_timer;
+};
+
+// NOTE: sleep_for(0) still lets everything else that's pending on the event loop run first.
+inline SleepAwaiter sleep_for(int milliseconds) { return SleepAwaiter { milliseconds }; }
+
+}
@@ -44,6 +44,7 @@ bool DirIterator::advance_next()
         }
 
         m_next = de->d_name;
+        m_next_type = de->d_type;
         if (m_next.is_null())
             return false;
 
@@ -80,6 +81,16 @@ String DirIterator::next_full_path()
     return String::formatted("{}/{}", m_path, next_path());
 }
 
+DirIterator::Entry DirIterator::next_entry()
+{
+    if (m_next.is_null())
+        advance_next();
+
+    Entry entry { m_next, m_next_type };
+    m_next = String();
+    return entry;
+}
+
 String find_executable_in_path(String filename)
 {
     if (filename.starts_with('/')) {
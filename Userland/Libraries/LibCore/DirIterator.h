@@ -23,18 +23,27 @@ public:
     explicit DirIterator(String path, Flags = Flags::NoFlags);
     ~DirIterator();
 
+    struct Entry {
+        String name;
+        // One of the DT_* constants, straight from the directory, which saves a stat() when all that's needed
+        // is whether it's a directory. NOTE: This is DT_UNKNOWN if the file system doesn't keep track of it.
+        unsigned char type { DT_UNKNOWN };
+    };
+
     bool has_error() const { return m_error != 0; }
     int error() const { return m_error; }
     const char* error_string() const { return strerror(m_error); }
     bool has_next();
     String next_path();
     String next_full_path();
+    Entry next_entry();
     int fd() const;
 
 private:
     DIR* m_dir = nullptr;
     int m_error = 0;
     String m_next;
+    unsigned char m_next_type { DT_UNKNOWN };
     String m_path;
     int m_flags;
 
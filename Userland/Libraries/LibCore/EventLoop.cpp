@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
@@ -29,12 +30,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/epoll.h>
+#    define CORE_EVENTLOOP_USE_EPOLL
+#endif
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __serenity__
+#    include <serenity.h>
+#endif
+
 namespace Core {
 
 class InspectorServerConnection;
@@ -49,8 +58,116 @@ struct EventLoopTimer {
     TimerShouldFireWhenNotVisible fire_when_not_visible { TimerShouldFireWhenNotVisible::No };
     WeakPtr<Object> owner;
 
+    // Where this timer is in the TimerQueue, whether it's waiting to expire or to become visible.
+    bool is_waiting_for_visibility { false };
+    size_t queue_index { 0 };
+
     void reload(const timeval& now);
     bool has_expired(const timeval& now) const;
+    bool fires_before(const EventLoopTimer& other) const
+    {
+        return fire_time.tv_sec < other.fire_time.tv_sec || (fire_time.tv_sec == other.fire_time.tv_sec && fire_time.tv_usec < other.fire_time.tv_usec);
+    }
+};
+
+// Keeps the timers in a binary min-heap by expiry, so finding the next one to fire is O(1) and everything else is O(log n),
+// no matter how many timers there are.
+// Timers that expire while their owner isn't visible are put aside until it is, so they don't keep waking us up.
+class TimerQueue {
+public:
+    bool is_empty() const { return m_heap.is_empty(); }
+    EventLoopTimer& soonest() { return *m_heap.first(); }
+
+    void insert(EventLoopTimer& timer)
+    {
+        timer.is_waiting_for_visibility = false;
+        timer.queue_index = m_heap.size();
+        m_heap.append(&timer);
+        sift_up(timer.queue_index);
+    }
+
+    EventLoopTimer& take_soonest()
+    {
+        auto& timer = soonest();
+        remove(timer);
+        return timer;
+    }
+
+    void wait_for_visibility(EventLoopTimer& timer)
+    {
+        timer.is_waiting_for_visibility = true;
+        timer.queue_index = m_waiting_for_visibility.size();
+        m_waiting_for_visibility.append(&timer);
+    }
+
+    Vector<EventLoopTimer*>& timers_waiting_for_visibility() { return m_waiting_for_visibility; }
+
+    void remove(EventLoopTimer& timer)
+    {
+        size_t index = timer.queue_index;
+        if (timer.is_waiting_for_visibility) {
+            VERIFY(m_waiting_for_visibility[index] == &timer);
+            auto* last = m_waiting_for_visibility.take_last();
+            if (index == m_waiting_for_visibility.size())
+                return;
+            m_waiting_for_visibility[index] = last;
+            last->queue_index = index;
+            return;
+        }
+        VERIFY(m_heap[index] == &timer);
+        auto* last = m_heap.take_last();
+        if (index == m_heap.size())
+            return;
+        m_heap[index] = last;
+        last->queue_index = index;
+        sift_down(index);
+        sift_up(index);
+    }
+
+    void clear()
+    {
+        m_heap.clear();
+        m_waiting_for_visibility.clear();
+    }
+
+private:
+    void swap_entries(size_t a, size_t b)
+    {
+        swap(m_heap[a], m_heap[b]);
+        m_heap[a]->queue_index = a;
+        m_heap[b]->queue_index = b;
+    }
+
+    void sift_up(size_t index)
+    {
+        while (index > 0) {
+            size_t parent = (index - 1) / 2;
+            if (!m_heap[index]->fires_before(*m_heap[parent]))
+                return;
+            swap_entries(index, parent);
+            index = parent;
+        }
+    }
+
+    void sift_down(size_t index)
+    {
+        for (;;) {
+            size_t soonest = index;
+            size_t left = index * 2 + 1;
+            size_t right = left + 1;
+            if (left < m_heap.size() && m_heap[left]->fires_before(*m_heap[soonest]))
+                soonest = left;
+            if (right < m_heap.size() && m_heap[right]->fires_before(*m_heap[soonest]))
+                soonest = right;
+            if (soonest == index)
+                return;
+            swap_entries(index, soonest);
+            index = soonest;
+        }
+    }
+
+    Vector<EventLoopTimer*> m_heap;
+    Vector<EventLoopTimer*> m_waiting_for_visibility;
 };
 
 struct EventLoop::Private {
@@ -61,7 +178,33 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop&>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static HashTable<Notifier*>* s_notifiers;
+static TimerQueue* s_timer_queue;
+
+// All the notifiers that are interested in one fd, and the events we're currently waiting on for it.
+struct NotifierFD {
+    Vector<Notifier*, 1> notifiers;
+    unsigned event_mask { Notifier::None };
+};
+static HashMap<int, NotifierFD>* s_notifiers;
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+// The notifier fds stay registered with the kernel, so waiting doesn't get more expensive with every fd we watch.
+static int s_epoll_fd = -1;
+// Regular files can't be watched with epoll on Linux, but they're always ready anyway.
+static HashTable<int>* s_always_ready_fds;
+
+static int epoll_fd()
+{
+    if (s_epoll_fd < 0) {
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (s_epoll_fd < 0) {
+            perror("epoll_create1");
+            VERIFY_NOT_REACHED();
+        }
+    }
+    return s_epoll_fd;
+}
+#endif
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
 
@@ -259,7 +402,11 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_timer_queue = new TimerQueue;
+        s_notifiers = new HashMap<int, NotifierFD>;
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        s_always_ready_fds = new HashTable<int>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -275,6 +422,13 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 #endif
         VERIFY(rc == 0);
         s_event_loop_stack->append(*this);
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(epoll_fd(), EPOLL_CTL_ADD, s_wake_pipe_fds[0], &event);
+        VERIFY(rc == 0);
+#endif
 
 #ifdef __serenity__
         if (getuid() != 0
@@ -381,6 +535,14 @@ void EventLoop::pump(WaitMode mode)
         if (receiver)
             dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: {} event {}", *receiver, event.type());
 
+#ifdef __serenity__
+        // Timing the dispatch is only worth it when somebody is recording it.
+        bool tracing_dispatch = perf_event_is_enabled(PERF_EVENT_EVENT_LOOP_DISPATCH);
+        timespec dispatch_start {};
+        if (tracing_dispatch)
+            clock_gettime(CLOCK_MONOTONIC, &dispatch_start);
+#endif
+
         if (!receiver) {
             switch (event.type()) {
             case Event::Quit:
@@ -398,6 +560,15 @@ void EventLoop::pump(WaitMode mode)
             receiver->dispatch_event(event);
         }
 
+#ifdef __serenity__
+        if (tracing_dispatch) {
+            timespec dispatch_end;
+            clock_gettime(CLOCK_MONOTONIC, &dispatch_end);
+            auto duration = Time::from_timespec(dispatch_end) - Time::from_timespec(dispatch_start);
+            perf_event(PERF_EVENT_EVENT_LOOP_DISPATCH, event.type(), duration.to_microseconds());
+        }
+#endif
+
         if (m_exit_requested) {
             Threading::Locker locker(m_private->lock);
             dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Exit requested. Rejigging {} events.", events.size() - i);
@@ -554,7 +725,16 @@ void EventLoop::notify_forked(ForkEvent event)
         s_main_event_loop = nullptr;
         s_event_loop_stack->clear();
         s_timers->clear();
+        s_timer_queue->clear();
         s_notifiers->clear();
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        // The interest set is shared with the parent, so we need one of our own.
+        if (s_epoll_fd >= 0) {
+            close(s_epoll_fd);
+            s_epoll_fd = -1;
+        }
+        s_always_ready_fds->clear();
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -569,11 +749,41 @@ void EventLoop::notify_forked(ForkEvent event)
     VERIFY_NOT_REACHED();
 }
 
-void EventLoop::wait_for_event(WaitMode mode)
+struct ReadyFD {
+    int fd { -1 };
+    bool is_readable { false };
+    bool is_writable { false };
+};
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+static int wait_for_ready_fds(int, const timeval* timeout, Vector<ReadyFD, 32>& ready_fds)
+{
+    int timeout_ms = -1;
+    if (!s_always_ready_fds->is_empty())
+        timeout_ms = 0;
+    else if (timeout)
+        timeout_ms = timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000;
+
+    epoll_event events[32];
+    int event_count = epoll_wait(epoll_fd(), events, array_size(events), timeout_ms);
+    if (event_count < 0)
+        return event_count;
+
+    ready_fds.clear();
+    for (int i = 0; i < event_count; ++i) {
+        // Errors and hangups are reported the same way select() reports them, as both readable and writable.
+        bool has_error = events[i].events & (EPOLLERR | EPOLLHUP);
+        ready_fds.append({ events[i].data.fd, has_error || (events[i].events & EPOLLIN), has_error || (events[i].events & EPOLLOUT) });
+    }
+    for (auto fd : *s_always_ready_fds)
+        ready_fds.append({ fd, true, true });
+    return ready_fds.size();
+}
+#else
+static int wait_for_ready_fds(int wake_pipe_fd, const timeval* timeout, Vector<ReadyFD, 32>& ready_fds)
 {
     fd_set rfds;
     fd_set wfds;
-retry:
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
 
@@ -584,18 +794,41 @@ retry:
             max_fd = fd;
     };
 
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
+    add_fd_to_set(wake_pipe_fd, rfds);
+    for (auto& it : *s_notifiers) {
+        if (it.value.event_mask & Notifier::Read)
+            add_fd_to_set(it.key, rfds);
+        if (it.value.event_mask & Notifier::Write)
+            add_fd_to_set(it.key, wfds);
+        if (it.value.event_mask & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
 
+    // NOTE: select() may modify the timeout, so it gets a copy.
+    timeval timeout_copy;
+    if (timeout)
+        timeout_copy = *timeout;
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, timeout ? &timeout_copy : nullptr);
+    if (marked_fd_count < 0)
+        return marked_fd_count;
+
+    ready_fds.clear();
+    if (FD_ISSET(wake_pipe_fd, &rfds))
+        ready_fds.append({ wake_pipe_fd, true, false });
+    for (auto& it : *s_notifiers) {
+        bool is_readable = FD_ISSET(it.key, &rfds);
+        bool is_writable = FD_ISSET(it.key, &wfds);
+        if (is_readable || is_writable)
+            ready_fds.append({ it.key, is_readable, is_writable });
+    }
+    return ready_fds.size();
+}
+#endif
+
+void EventLoop::wait_for_event(WaitMode mode)
+{
+    Vector<ReadyFD, 32> ready_fds;
+retry:
     bool queued_events_is_empty;
     {
         Threading::Locker locker(m_private->lock);
@@ -623,7 +856,7 @@ retry:
     }
 
 try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count = wait_for_ready_fds(s_wake_pipe_fds[0], should_wait_forever ? nullptr : &timeout, ready_fds);
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -634,7 +867,11 @@ try_select_again:
         dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+    bool wake_pipe_is_readable = any_of(ready_fds.begin(), ready_fds.end(), [](auto& ready_fd) {
+        return ready_fd.fd == s_wake_pipe_fds[0] && ready_fd.is_readable;
+    });
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -662,38 +899,56 @@ try_select_again:
         now.tv_usec = now_spec.tv_nsec / 1000;
     }
 
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
-        if (!timer.has_expired(now))
+    auto fire_timer = [&](EventLoopTimer& timer, auto& owner) {
+        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
+        if (owner)
+            post_event(*owner, make<TimerEvent>(timer.timer_id));
+        // FIXME: Support removing expired timers that don't want to reload.
+        VERIFY(timer.should_reload);
+        timer.reload(now);
+    };
+
+    Vector<EventLoopTimer*, 32> fired_timers;
+    auto& waiting_for_visibility = s_timer_queue->timers_waiting_for_visibility();
+    for (size_t i = 0; i < waiting_for_visibility.size();) {
+        auto& timer = *waiting_for_visibility[i];
+        auto owner = timer.owner.strong_ref();
+        if (owner && !owner->is_visible_for_timer_purposes()) {
+            ++i;
             continue;
+        }
+        s_timer_queue->remove(timer);
+        fire_timer(timer, owner);
+        fired_timers.append(&timer);
+    }
+
+    while (!s_timer_queue->is_empty() && s_timer_queue->soonest().has_expired(now)) {
+        auto& timer = s_timer_queue->take_soonest();
         auto owner = timer.owner.strong_ref();
         if (timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No
             && owner && !owner->is_visible_for_timer_purposes()) {
+            s_timer_queue->wait_for_visibility(timer);
             continue;
         }
-
-        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
-
-        if (owner)
-            post_event(*owner, make<TimerEvent>(timer.timer_id));
-        if (timer.should_reload) {
-            timer.reload(now);
-        } else {
-            // FIXME: Support removing expired timers that don't want to reload.
-            VERIFY_NOT_REACHED();
-        }
+        fire_timer(timer, owner);
+        fired_timers.append(&timer);
     }
 
+    // NOTE: These only go back in now, since a timer with a zero interval would have expired again right away.
+    for (auto* timer : fired_timers)
+        s_timer_queue->insert(*timer);
+
     if (!marked_fd_count)
         return;
 
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->event_mask() & Notifier::Event::Read)
+    for (auto& ready_fd : ready_fds) {
+        auto it = s_notifiers->find(ready_fd.fd);
+        if (it == s_notifiers->end())
+            continue;
+        for (auto* notifier : it->value.notifiers) {
+            if (ready_fd.is_readable && (notifier->event_mask() & Notifier::Event::Read))
                 post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->event_mask() & Notifier::Event::Write)
+            if (ready_fd.is_writable && (notifier->event_mask() & Notifier::Event::Write))
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
@@ -706,25 +961,16 @@ bool EventLoopTimer::has_expired(const timeval& now) const
 
 void EventLoopTimer::reload(const timeval& now)
 {
-    fire_time = now;
-    fire_time.tv_sec += interval / 1000;
-    fire_time.tv_usec += (interval % 1000) * 1000;
+    timeval interval_timeval { interval / 1000, (interval % 1000) * 1000 };
+    timeval_add(now, interval_timeval, fire_time);
 }
 
 Optional<struct timeval> EventLoop::get_next_timer_expiration()
 {
-    Optional<struct timeval> soonest {};
-    for (auto& it : *s_timers) {
-        auto& fire_time = it.value->fire_time;
-        auto owner = it.value->owner.strong_ref();
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-        if (!soonest.has_value() || fire_time.tv_sec < soonest.value().tv_sec || (fire_time.tv_sec == soonest.value().tv_sec && fire_time.tv_usec < soonest.value().tv_usec))
-            soonest = fire_time;
-    }
-    return soonest;
+    // NOTE: If the soonest timer's owner isn't visible, we'll wake up for nothing once, and then put it aside until it is.
+    if (s_timer_queue->is_empty())
+        return {};
+    return s_timer_queue->soonest().fire_time;
 }
 
 int EventLoop::register_timer(Object& object, int milliseconds, bool should_reload, TimerShouldFireWhenNotVisible fire_when_not_visible)
@@ -743,6 +989,7 @@ int EventLoop::register_timer(Object& object, int milliseconds, bool should_relo
     timer->fire_when_not_visible = fire_when_not_visible;
     int timer_id = s_id_allocator->allocate();
     timer->timer_id = timer_id;
+    s_timer_queue->insert(*timer);
     s_timers->set(timer_id, move(timer));
     return timer_id;
 }
@@ -753,18 +1000,74 @@ bool EventLoop::unregister_timer(int timer_id)
     auto it = s_timers->find(timer_id);
     if (it == s_timers->end())
         return false;
+    s_timer_queue->remove(*it->value);
     s_timers->remove(it);
     return true;
 }
 
+static void update_notifier_fd(int fd, NotifierFD& notifier_fd)
+{
+    unsigned event_mask = Notifier::None;
+    for (auto* notifier : notifier_fd.notifiers)
+        event_mask |= notifier->event_mask();
+    if (event_mask == notifier_fd.event_mask)
+        return;
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+    if (event_mask & Notifier::Exceptional)
+        VERIFY_NOT_REACHED();
+
+    if (event_mask == Notifier::None) {
+        // NOTE: This fails if the fd has been closed already, which is fine, since the kernel forgets about it then.
+        (void)epoll_ctl(epoll_fd(), EPOLL_CTL_DEL, fd, nullptr);
+        s_always_ready_fds->remove(fd);
+    } else {
+        epoll_event event {};
+        if (event_mask & Notifier::Read)
+            event.events |= EPOLLIN;
+        if (event_mask & Notifier::Write)
+            event.events |= EPOLLOUT;
+        event.data.fd = fd;
+        // NOTE: We always try adding first, since an old registration for this fd number may be for a file that was closed since.
+        int rc = epoll_ctl(epoll_fd(), EPOLL_CTL_ADD, fd, &event);
+        if (rc < 0 && errno == EEXIST)
+            rc = epoll_ctl(epoll_fd(), EPOLL_CTL_MOD, fd, &event);
+        if (rc < 0 && errno == EPERM) {
+            s_always_ready_fds->set(fd);
+            rc = 0;
+        }
+        if (rc < 0)
+            dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+    }
+#endif
+    notifier_fd.event_mask = event_mask;
+}
+
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    auto& notifier_fd = s_notifiers->ensure(notifier.fd());
+    if (!notifier_fd.notifiers.contains_slow(&notifier))
+        notifier_fd.notifiers.append(&notifier);
+    update_notifier_fd(notifier.fd(), notifier_fd);
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end())
+        return;
+    it->value.notifiers.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    update_notifier_fd(it->key, it->value);
+    if (it->value.notifiers.is_empty())
+        s_notifiers->remove(it);
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, Notifier& notifier)
+{
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end() || !it->value.notifiers.contains_slow(&notifier))
+        return;
+    update_notifier_fd(it->key, it->value);
 }
 
 void EventLoop::wake()
@@ -5,9 +5,8 @@
  */
 
 #include <AK/ByteBuffer.h>
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <AK/MemoryStream.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
@@ -20,80 +19,103 @@ Optional<Vector<Core::ProcessStatistics>> ProcessStatisticsReader::get_all(RefPt
 {
     if (proc_all_file) {
         if (!proc_all_file->seek(0, Core::SeekMode::SetPosition)) {
-            warnln("ProcessStatisticsReader: Failed to refresh /proc/all: {}", proc_all_file->error_string());
+            warnln("ProcessStatisticsReader: Failed to refresh /proc/all_binary: {}", proc_all_file->error_string());
             return {};
         }
     } else {
-        proc_all_file = Core::File::construct("/proc/all");
+        proc_all_file = Core::File::construct("/proc/all_binary");
         if (!proc_all_file->open(Core::OpenMode::ReadOnly)) {
-            warnln("ProcessStatisticsReader: Failed to open /proc/all: {}", proc_all_file->error_string());
+            warnln("ProcessStatisticsReader: Failed to open /proc/all_binary: {}", proc_all_file->error_string());
             return {};
         }
     }
 
-    Vector<Core::ProcessStatistics> processes;
-
     auto file_contents = proc_all_file->read_all();
-    auto json = JsonValue::from_string(file_contents);
-    if (!json.has_value())
+    InputMemoryStream stream { file_contents };
+
+    // NOTE: We check the length ourselves, so the stream never ends up in an error state.
+    auto read_entry = [&](auto& entry) {
+        if (stream.remaining() < sizeof(entry))
+            return false;
+        return stream.read_or_error({ &entry, sizeof(entry) });
+    };
+    auto read_string = [&](String& string, u32 length) {
+        if (stream.remaining() < length)
+            return false;
+        string = String(ReadonlyBytes { file_contents.data() + stream.offset(), length });
+        return stream.discard_or_error(length);
+    };
+
+    ProcessStatisticsHeader header;
+    if (!read_entry(header) || header.magic != PROCESS_STATISTICS_MAGIC || header.version != PROCESS_STATISTICS_VERSION) {
+        warnln("ProcessStatisticsReader: /proc/all_binary is not in the expected format");
         return {};
-    json.value().as_array().for_each([&](auto& value) {
-        const JsonObject& process_object = value.as_object();
+    }
+
+    Vector<Core::ProcessStatistics> processes;
+    processes.ensure_capacity(header.process_count);
+    for (u32 i = 0; i < header.process_count; ++i) {
+        ProcessStatisticsEntry entry;
+        if (!read_entry(entry))
+            return {};
         Core::ProcessStatistics process;
 
         // kernel data first
-        process.pid = process_object.get("pid").to_u32();
-        process.pgid = process_object.get("pgid").to_u32();
-        process.pgp = process_object.get("pgp").to_u32();
-        process.sid = process_object.get("sid").to_u32();
-        process.uid = process_object.get("uid").to_u32();
-        process.gid = process_object.get("gid").to_u32();
-        process.ppid = process_object.get("ppid").to_u32();
-        process.nfds = process_object.get("nfds").to_u32();
-        process.kernel = process_object.get("kernel").to_bool();
-        process.name = process_object.get("name").to_string();
-        process.executable = process_object.get("executable").to_string();
-        process.tty = process_object.get("tty").to_string();
-        process.pledge = process_object.get("pledge").to_string();
-        process.veil = process_object.get("veil").to_string();
-        process.amount_virtual = process_object.get("amount_virtual").to_u32();
-        process.amount_resident = process_object.get("amount_resident").to_u32();
-        process.amount_shared = process_object.get("amount_shared").to_u32();
-        process.amount_dirty_private = process_object.get("amount_dirty_private").to_u32();
-        process.amount_clean_inode = process_object.get("amount_clean_inode").to_u32();
-        process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
-        process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile").to_u32();
+        process.pid = entry.pid;
+        process.pgid = entry.pgid;
+        process.pgp = entry.pgp;
+        process.sid = entry.sid;
+        process.uid = entry.uid;
+        process.gid = entry.gid;
+        process.ppid = entry.ppid;
+        process.nfds = entry.nfds;
+        process.kernel = entry.kernel;
+        process.amount_virtual = entry.amount_virtual;
+        process.amount_resident = entry.amount_resident;
+        process.amount_shared = entry.amount_shared;
+        process.amount_dirty_private = entry.amount_dirty_private;
+        process.amount_clean_inode = entry.amount_clean_inode;
+        process.amount_purgeable_volatile = entry.amount_purgeable_volatile;
+        process.amount_purgeable_nonvolatile = entry.amount_purgeable_nonvolatile;
+        if (!read_string(process.name, entry.name_length)
+            || !read_string(process.executable, entry.executable_length)
+            || !read_string(process.tty, entry.tty_length)
+            || !read_string(process.pledge, entry.pledge_length)
+            || !read_string(process.veil, entry.veil_length))
+            return {};
 
-        auto& thread_array = process_object.get_ptr("threads")->as_array();
-        process.threads.ensure_capacity(thread_array.size());
-        thread_array.for_each([&](auto& value) {
-            auto& thread_object = value.as_object();
+        process.threads.ensure_capacity(entry.thread_count);
+        for (u32 j = 0; j < entry.thread_count; ++j) {
+            ThreadStatisticsEntry thread_entry;
+            if (!read_entry(thread_entry))
+                return {};
             Core::ThreadStatistics thread;
-            thread.tid = thread_object.get("tid").to_u32();
-            thread.times_scheduled = thread_object.get("times_scheduled").to_u32();
-            thread.name = thread_object.get("name").to_string();
-            thread.state = thread_object.get("state").to_string();
-            thread.ticks_user = thread_object.get("ticks_user").to_u32();
-            thread.ticks_kernel = thread_object.get("ticks_kernel").to_u32();
-            thread.cpu = thread_object.get("cpu").to_u32();
-            thread.priority = thread_object.get("priority").to_u32();
-            thread.syscall_count = thread_object.get("syscall_count").to_u32();
-            thread.inode_faults = thread_object.get("inode_faults").to_u32();
-            thread.zero_faults = thread_object.get("zero_faults").to_u32();
-            thread.cow_faults = thread_object.get("cow_faults").to_u32();
-            thread.unix_socket_read_bytes = thread_object.get("unix_socket_read_bytes").to_u32();
-            thread.unix_socket_write_bytes = thread_object.get("unix_socket_write_bytes").to_u32();
-            thread.ipv4_socket_read_bytes = thread_object.get("ipv4_socket_read_bytes").to_u32();
-            thread.ipv4_socket_write_bytes = thread_object.get("ipv4_socket_write_bytes").to_u32();
-            thread.file_read_bytes = thread_object.get("file_read_bytes").to_u32();
-            thread.file_write_bytes = thread_object.get("file_write_bytes").to_u32();
-            process.threads.append(move(thread));
-        });
+            thread.tid = thread_entry.tid;
+            thread.times_scheduled = thread_entry.times_scheduled;
+            thread.ticks_user = thread_entry.ticks_user;
+            thread.ticks_kernel = thread_entry.ticks_kernel;
+            thread.cpu = thread_entry.cpu;
+            thread.priority = thread_entry.priority;
+            thread.cpu_affinity = thread_entry.cpu_affinity;
+            thread.syscall_count = thread_entry.syscall_count;
+            thread.inode_faults = thread_entry.inode_faults;
+            thread.zero_faults = thread_entry.zero_faults;
+            thread.cow_faults = thread_entry.cow_faults;
+            thread.unix_socket_read_bytes = thread_entry.unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_entry.unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_entry.ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_entry.ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_entry.file_read_bytes;
+            thread.file_write_bytes = thread_entry.file_write_bytes;
+            if (!read_string(thread.state, thread_entry.state_length) || !read_string(thread.name, thread_entry.name_length))
+                return {};
+            process.threads.unchecked_append(move(thread));
+        }
 
         // and synthetic data last
         process.username = username_from_uid(process.uid);
-        processes.append(move(process));
-    });
+        processes.unchecked_append(move(process));
+    }
 
     return processes;
 }
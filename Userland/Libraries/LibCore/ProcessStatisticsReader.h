@@ -29,12 +29,13 @@ struct ThreadStatistics {
     unsigned file_write_bytes;
     String state;
     u32 cpu;
+    u32 cpu_affinity;
     u32 priority;
     String name;
 };
 
 struct ProcessStatistics {
-    // Keep this in sync with /proc/all.
+    // Keep this in sync with /proc/all_binary.
     // From the kernel side:
     pid_t pid;
     pid_t pgid;
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <coroutine>
+
+namespace Core {
+
+template<typename T>
+class Task;
+
+namespace Detail {
+
+class TaskPromiseBase {
+public:
+    // Tasks start running right away, up to the first thing they have to wait for.
+    std::suspend_never initial_suspend() { return {}; }
+
+    auto final_suspend() noexcept
+    {
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                auto& promise = *m_promise;
+                if (promise.m_continuation)
+                    return promise.m_continuation;
+                // Nobody is around to look at the result anymore, so we're the last ones to need the frame.
+                if (promise.m_detached)
+                    handle.destroy();
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept { }
+
+            TaskPromiseBase* m_promise;
+        };
+        return FinalAwaiter { this };
+    }
+
+    void unhandled_exception() { VERIFY_NOT_REACHED(); }
+
+    std::coroutine_handle<> m_continuation;
+    bool m_detached { false };
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U&& value) { m_result = forward<U>(value); }
+
+    T take_result() { return m_result.release_value(); }
+
+private:
+    Optional<T> m_result;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object();
+
+    void return_void() { }
+    void take_result() { }
+};
+
+}
+
+// The result of a coroutine that runs on the event loop.
+// A Task can be co_await'ed from another coroutine to get its result, or simply dropped, in which case the
+// coroutine carries on by itself and cleans up after itself once it's done. Either way, the coroutine
+// frame is the only allocation, no matter how many times it has to wait for something.
+template<typename T>
+class Task {
+    AK_MAKE_NONCOPYABLE(Task);
+
+public:
+    using promise_type = Detail::TaskPromise<T>;
+
+    Task(Task&& other)
+        : m_handle(exchange(other.m_handle, nullptr))
+    {
+    }
+
+    ~Task()
+    {
+        if (!m_handle)
+            return;
+        if (m_handle.done())
+            m_handle.destroy();
+        else
+            m_handle.promise().m_detached = true;
+    }
+
+    bool is_done() const { return !m_handle || m_handle.done(); }
+
+    bool await_ready() const { return m_handle.done(); }
+    void await_suspend(std::coroutine_handle<> continuation) { m_handle.promise().m_continuation = continuation; }
+    T await_resume() { return m_handle.promise().take_result(); }
+
+private:
+    friend promise_type;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template<typename T>
+Task<T> Detail::TaskPromise<T>::get_return_object()
+{
+    return Task<T> { std::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+}
+
+inline Task<void> Detail::TaskPromise<void>::get_return_object()
+{
+    return Task<void> { std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+}
+
+}
@@ -11,6 +11,9 @@
 #include <LibCore/UDPSocket.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifndef SOCK_NONBLOCK
@@ -76,6 +79,95 @@ ByteBuffer UDPServer::receive(size_t size, sockaddr_in& in)
     return buf;
 }
 
+#if defined(__serenity__) || defined(__linux__)
+Vector<UDPServer::Datagram> UDPServer::receive_many(size_t max_count, size_t max_size)
+{
+    Vector<Datagram> datagrams;
+    datagrams.resize(max_count);
+    Vector<iovec> iovs;
+    iovs.resize(max_count);
+    Vector<mmsghdr> messages;
+    messages.resize(max_count);
+    for (size_t i = 0; i < max_count; ++i) {
+        datagrams[i].data = ByteBuffer::create_uninitialized(max_size);
+        iovs[i] = { datagrams[i].data.data(), max_size };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = &datagrams[i].address;
+        messages[i].msg_hdr.msg_namelen = sizeof(datagrams[i].address);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int count = ::recvmmsg(m_fd, messages.data(), max_count, MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+        if (errno != EAGAIN)
+            dbgln("recvmmsg: {}", strerror(errno));
+        return {};
+    }
+
+    datagrams.shrink(count);
+    for (int i = 0; i < count; ++i)
+        datagrams[i].data.resize(min((size_t)messages[i].msg_len, max_size));
+    return datagrams;
+}
+
+size_t UDPServer::send_many(const Vector<Datagram>& datagrams)
+{
+    Vector<iovec> iovs;
+    iovs.resize(datagrams.size());
+    Vector<mmsghdr> messages;
+    messages.resize(datagrams.size());
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        iovs[i] = { const_cast<u8*>(datagrams[i].data.data()), datagrams[i].data.size() };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&datagrams[i].address);
+        messages[i].msg_hdr.msg_namelen = sizeof(datagrams[i].address);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent_count = 0;
+    while (sent_count < datagrams.size()) {
+        int count = ::sendmmsg(m_fd, messages.data() + sent_count, datagrams.size() - sent_count, 0);
+        if (count <= 0) {
+            dbgln("sendmmsg: {}", strerror(errno));
+            break;
+        }
+        sent_count += count;
+    }
+    return sent_count;
+}
+#else
+Vector<UDPServer::Datagram> UDPServer::receive_many(size_t max_count, size_t max_size)
+{
+    Vector<Datagram> datagrams;
+    while (datagrams.size() < max_count) {
+        Datagram datagram;
+        datagram.data = ByteBuffer::create_uninitialized(max_size);
+        socklen_t address_length = sizeof(datagram.address);
+        ssize_t length = ::recvfrom(m_fd, datagram.data.data(), max_size, MSG_DONTWAIT, (sockaddr*)&datagram.address, &address_length);
+        if (length < 0)
+            break;
+        datagram.data.resize(min((size_t)length, max_size));
+        datagrams.append(move(datagram));
+    }
+    return datagrams;
+}
+
+size_t UDPServer::send_many(const Vector<Datagram>& datagrams)
+{
+    size_t sent_count = 0;
+    for (auto& datagram : datagrams) {
+        if (::sendto(m_fd, datagram.data.data(), datagram.data.size(), 0, (const sockaddr*)&datagram.address, sizeof(datagram.address)) < 0) {
+            dbgln("sendto: {}", strerror(errno));
+            break;
+        }
+        ++sent_count;
+    }
+    return sent_count;
+}
+#endif
+
 Optional<IPv4Address> UDPServer::local_address() const
 {
     if (m_fd == -1)
@@ -9,6 +9,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Forward.h>
 #include <AK/Function.h>
+#include <AK/Vector.h>
 #include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/SocketAddress.h>
@@ -30,6 +31,15 @@ public:
         return receive(size, saddr);
     };
 
+    struct Datagram {
+        ByteBuffer data;
+        sockaddr_in address;
+    };
+    // Receives up to max_count datagrams that have arrived already, with one syscall if the system has recvmmsg().
+    Vector<Datagram> receive_many(size_t max_count, size_t max_size);
+    // Sends every datagram to its address, with one syscall if the system has sendmmsg(). Returns how many were sent.
+    size_t send_many(const Vector<Datagram>&);
+
     Optional<IPv4Address> local_address() const;
     Optional<u16> local_port() const;
 
@@ -37,6 +37,11 @@ public:
     {
         for (size_t i = 0; i < 16; i += 4)
             m_key[i / 4] = AK::convert_between_host_and_big_endian(*(const u32*)(key.offset(i)));
+
+        // H^2, H^3 and H^4, for hashing four blocks at once
+        __builtin_memcpy(m_key_powers[0], m_key, sizeof(m_key));
+        for (size_t i = 1; i < 4; ++i)
+            galois_multiply(m_key_powers[i], m_key_powers[i - 1], m_key);
     }
 
     constexpr static size_t digest_size() { return TagType::Size; }
@@ -49,6 +54,7 @@ private:
     inline void transform(ReadonlyBytes, ReadonlyBytes);
 
     u32 m_key[4];
+    u32 m_key_powers[4][4];
 };
 
 }
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+
+namespace Crypto {
+namespace Authentication {
+
+static constexpr u32 limb_mask = 0x3ffffff;
+
+ALWAYS_INLINE static u32 load_little_endian(const u8* address)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(address));
+}
+
+Poly1305::Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+
+    // r is "clamped" as the RFC asks, and split into 26-bit limbs.
+    m_r[0] = load_little_endian(key.offset(0)) & 0x3ffffff;
+    m_r[1] = (load_little_endian(key.offset(3)) >> 2) & 0x3ffff03;
+    m_r[2] = (load_little_endian(key.offset(6)) >> 4) & 0x3ffc0ff;
+    m_r[3] = (load_little_endian(key.offset(9)) >> 6) & 0x3f03fff;
+    m_r[4] = (load_little_endian(key.offset(12)) >> 8) & 0x00fffff;
+
+    for (size_t i = 0; i < 4; ++i)
+        m_s[i] = load_little_endian(key.offset(16 + i * 4));
+}
+
+// Computes accumulator = (accumulator + block) * r mod 2^130 - 5 for every 16-byte block.
+// high_bit is the 2^128 bit that's added to every full block.
+void Poly1305::process_blocks(ReadonlyBytes blocks, u32 high_bit)
+{
+    auto r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+    // Limb products that go past 2^130 wrap around multiplied by 5.
+    auto s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    auto h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    for (size_t offset = 0; offset + 16 <= blocks.size(); offset += 16) {
+        auto* block = blocks.offset(offset);
+        h0 += load_little_endian(block) & limb_mask;
+        h1 += (load_little_endian(block + 3) >> 2) & limb_mask;
+        h2 += (load_little_endian(block + 6) >> 4) & limb_mask;
+        h3 += (load_little_endian(block + 9) >> 6) & limb_mask;
+        h4 += (load_little_endian(block + 12) >> 8) | high_bit;
+
+        u64 d0 = (u64)h0 * r0 + (u64)h1 * s4 + (u64)h2 * s3 + (u64)h3 * s2 + (u64)h4 * s1;
+        u64 d1 = (u64)h0 * r1 + (u64)h1 * r0 + (u64)h2 * s4 + (u64)h3 * s3 + (u64)h4 * s2;
+        u64 d2 = (u64)h0 * r2 + (u64)h1 * r1 + (u64)h2 * r0 + (u64)h3 * s4 + (u64)h4 * s3;
+        u64 d3 = (u64)h0 * r3 + (u64)h1 * r2 + (u64)h2 * r1 + (u64)h3 * r0 + (u64)h4 * s4;
+        u64 d4 = (u64)h0 * r4 + (u64)h1 * r3 + (u64)h2 * r2 + (u64)h3 * r1 + (u64)h4 * r0;
+
+        // Partially reduce, leaving every limb at most slightly above 26 bits.
+        d1 += d0 >> 26;
+        h0 = d0 & limb_mask;
+        d2 += d1 >> 26;
+        h1 = d1 & limb_mask;
+        d3 += d2 >> 26;
+        h2 = d2 & limb_mask;
+        d4 += d3 >> 26;
+        h3 = d3 & limb_mask;
+        h0 += (u32)(d4 >> 26) * 5;
+        h4 = d4 & limb_mask;
+        h1 += h0 >> 26;
+        h0 &= limb_mask;
+    }
+
+    m_accumulator[0] = h0;
+    m_accumulator[1] = h1;
+    m_accumulator[2] = h2;
+    m_accumulator[3] = h3;
+    m_accumulator[4] = h4;
+}
+
+void Poly1305::update(ReadonlyBytes message)
+{
+    if (m_partial_block_size) {
+        auto size = min(message.size(), sizeof(m_partial_block) - m_partial_block_size);
+        __builtin_memcpy(m_partial_block + m_partial_block_size, message.data(), size);
+        m_partial_block_size += size;
+        message = message.slice(size);
+        if (m_partial_block_size < sizeof(m_partial_block))
+            return;
+        process_blocks({ m_partial_block, sizeof(m_partial_block) }, 1 << 24);
+        m_partial_block_size = 0;
+    }
+
+    auto whole_blocks_size = message.size() & ~15;
+    process_blocks(message.slice(0, whole_blocks_size), 1 << 24);
+
+    m_partial_block_size = message.size() - whole_blocks_size;
+    __builtin_memcpy(m_partial_block, message.data() + whole_blocks_size, m_partial_block_size);
+}
+
+Poly1305::TagType Poly1305::digest()
+{
+    // The last partial block gets a 1 byte after it instead of the 2^128 bit.
+    if (m_partial_block_size) {
+        m_partial_block[m_partial_block_size] = 1;
+        __builtin_memset(m_partial_block + m_partial_block_size + 1, 0, sizeof(m_partial_block) - m_partial_block_size - 1);
+        process_blocks({ m_partial_block, sizeof(m_partial_block) }, 0);
+        m_partial_block_size = 0;
+    }
+
+    auto h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    // Fully carry the accumulator.
+    h2 += h1 >> 26;
+    h1 &= limb_mask;
+    h3 += h2 >> 26;
+    h2 &= limb_mask;
+    h4 += h3 >> 26;
+    h3 &= limb_mask;
+    h0 += (h4 >> 26) * 5;
+    h4 &= limb_mask;
+    h1 += h0 >> 26;
+    h0 &= limb_mask;
+
+    // g = h + 5 - 2^130, which is h mod 2^130 - 5 if it doesn't go below zero.
+    u32 g0 = h0 + 5;
+    u32 g1 = h1 + (g0 >> 26);
+    g0 &= limb_mask;
+    u32 g2 = h2 + (g1 >> 26);
+    g1 &= limb_mask;
+    u32 g3 = h3 + (g2 >> 26);
+    g2 &= limb_mask;
+    u32 g4 = h4 + (g3 >> 26) - (1 << 26);
+    g3 &= limb_mask;
+
+    // Pick h or g without branching on them: use_g is all ones if g4 didn't go below zero.
+    u32 use_g = (g4 >> 31) - 1;
+    h0 = (h0 & ~use_g) | (g0 & use_g);
+    h1 = (h1 & ~use_g) | (g1 & use_g);
+    h2 = (h2 & ~use_g) | (g2 & use_g);
+    h3 = (h3 & ~use_g) | (g3 & use_g);
+    h4 = (h4 & ~use_g) | (g4 & use_g);
+
+    // Back to 32-bit words, and add s (mod 2^128).
+    u32 words[4] = {
+        h0 | (h1 << 26),
+        (h1 >> 6) | (h2 << 20),
+        (h2 >> 12) | (h3 << 14),
+        (h3 >> 18) | (h4 << 8),
+    };
+
+    TagType tag;
+    u64 carry = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        carry += (u64)words[i] + m_s[i];
+        ByteReader::store(tag.data + i * 4, AK::convert_between_host_and_little_endian((u32)carry));
+        carry >>= 32;
+    }
+
+    __builtin_memset(m_accumulator, 0, sizeof(m_accumulator));
+    return tag;
+}
+
+}
+}
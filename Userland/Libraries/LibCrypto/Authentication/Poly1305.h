@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Authentication {
+
+struct Poly1305Tag {
+    constexpr static size_t Size = 16;
+    u8 data[Size];
+
+    const u8* immutable_data() const { return data; }
+    size_t data_length() { return Size; }
+};
+
+// The Poly1305 one-time authenticator, as specified in RFC 8439 section 2.5.
+// The key must never be used for more than one message.
+class Poly1305 final {
+public:
+    using TagType = Poly1305Tag;
+
+    static constexpr size_t KeySize = 32;
+
+    explicit Poly1305(ReadonlyBytes key);
+
+    constexpr static size_t digest_size() { return TagType::Size; }
+
+    String class_name() const { return "Poly1305"; }
+
+    void update(ReadonlyBytes);
+    TagType digest();
+
+private:
+    void process_blocks(ReadonlyBytes, u32 high_bit);
+
+    // The accumulator and r, in five 26-bit limbs each, so that limb products fit in 64 bits.
+    u32 m_accumulator[5] { 0 };
+    u32 m_r[5];
+    u32 m_s[4];
+
+    u8 m_partial_block[16];
+    size_t m_partial_block_size { 0 };
+};
+
+}
+}
@@ -70,46 +70,6 @@ ALWAYS_INLINE static u32 inverse_wrapped(u32 value)
     return static_cast<u32>(-k0);
 }
 
-/**
- * Computes z = x * y + c. z_carry contains the top bits, z contains the bottom bits.
- */
-ALWAYS_INLINE static void linear_multiplication_with_carry(u32 x, u32 y, u32 c, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(x) * static_cast<u64>(y) + static_cast<u64>(c);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
-/**
- * Computes z = a + b. z_carry contains the top bit (1 or 0), z contains the bottom bits.
- */
-ALWAYS_INLINE static void addition_with_carry(u32 a, u32 b, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(a) + static_cast<u64>(b);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
-/**
- * Computes a montgomery "fragment" for y_i. This computes "z[i] += x[i] * y_i" for all words while rippling the carry, and returns the carry.
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
- */
-UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(UnsignedBigInteger& z, size_t offset_in_z, UnsignedBigInteger const& x, UnsignedBigInteger::Word y_digit, size_t num_words)
-{
-    UnsignedBigInteger::Word carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word a_carry;
-        UnsignedBigInteger::Word a;
-        linear_multiplication_with_carry(x.m_words[i], y_digit, z.m_words[offset_in_z + i], a_carry, a);
-        UnsignedBigInteger::Word b_carry;
-        UnsignedBigInteger::Word b;
-        addition_with_carry(a, carry, b_carry, b);
-        z.m_words[offset_in_z + i] = b;
-        carry = a_carry + b_carry;
-    }
-    return carry;
-}
-
 /**
  * Computes the "almost montgomery" product : x * y * 2 ^ (-num_words * BITS_IN_WORD) % modulo
  * [Note : that means that the result z satisfies z * 2^(num_words * BITS_IN_WORD) % modulo = x * y % modulo]
@@ -136,20 +96,27 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
 
     UnsignedBigInteger::Word previous_double_carry { 0 };
     for (size_t i = 0; i < num_words; ++i) {
-        // z[i->num_words+i] += x * y_i
-        UnsignedBigInteger::Word carry_1 = montgomery_fragment(z, i, x, y.m_words[i], num_words);
-        // z[i->num_words+i] += modulo * (z_i * k)
-        UnsignedBigInteger::Word t = z.m_words[i] * k;
-        UnsignedBigInteger::Word carry_2 = montgomery_fragment(z, i, modulo, t, num_words);
+        // z[i->num_words+i] += x * y_i + modulo * t, with t = (z_i + x_0 * y_i) * k chosen so that z_i becomes 0.
+        // Both products are added in the same pass, with a separate carry for each of them.
+        UnsignedBigInteger::Word y_digit = y.m_words[i];
+        UnsignedBigInteger::Word t = (z.m_words[i] + x.m_words[0] * y_digit) * k;
+        u64 carry_1 = 0;
+        u64 carry_2 = 0;
+        for (size_t j = 0; j < num_words; ++j) {
+            u64 product = static_cast<u64>(x.m_words[j]) * y_digit + z.m_words[i + j] + carry_1;
+            carry_1 = product >> UnsignedBigInteger::BITS_IN_WORD;
+            u64 reduction = static_cast<u64>(modulo.m_words[j]) * t + static_cast<UnsignedBigInteger::Word>(product) + carry_2;
+            carry_2 = reduction >> UnsignedBigInteger::BITS_IN_WORD;
+            z.m_words[i + j] = static_cast<UnsignedBigInteger::Word>(reduction);
+        }
 
         // Compute the carry by combining all of the carrys of the previous computations
         // Put it "right after" the range that we computed above
-        UnsignedBigInteger::Word temp_carry = previous_double_carry + carry_1;
-        UnsignedBigInteger::Word overall_carry = temp_carry + carry_2;
-        z.m_words[num_words + i] = overall_carry;
+        u64 overall_carry = previous_double_carry + carry_1 + carry_2;
+        z.m_words[num_words + i] = static_cast<UnsignedBigInteger::Word>(overall_carry);
 
-        // Detect if there was a "double carry" for this word by checking if our carry results are smaller than their components
-        previous_double_carry = (temp_carry < carry_1 || overall_carry < carry_2) ? 1 : 0;
+        // There's a "double carry" for this word if the carries didn't fit in one word
+        previous_double_carry = static_cast<UnsignedBigInteger::Word>(overall_carry >> UnsignedBigInteger::BITS_IN_WORD);
     }
 
     if (previous_double_carry == 0) {
@@ -178,8 +145,30 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     result.resize_with_leading_zeros(num_words);
 }
 
+static constexpr size_t max_sliding_window_size = 6;
+
+/**
+ * Picks the window size that needs the fewest multiplications for an exponent of this many bits,
+ * counting the 2^(window_size - 1) multiplications that go into the precomputed powers.
+ * These are the thresholds OpenSSL uses in BN_window_bits_for_exponent_size().
+ */
+static size_t sliding_window_size(size_t exponent_bits)
+{
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
+}
+
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
+ * Exponentiation method: left-to-right sliding windows, so only the odd powers up to 2^window_size are precomputed
+ * and there's one multiplication per window rather than one per window_size bits of the exponent.
  * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
  */
 void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
@@ -197,9 +186,16 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
 {
     VERIFY(modulo.is_odd());
 
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
+    // The exponent is read from its top bit down, in windows of up to window_size bits that start and end with a 1 bit.
+    // Each window costs one squaring per bit and a single multiplication by a precomputed odd power of x.
+    size_t exponent_bits = exponent.trimmed_length() * UnsignedBigInteger::BITS_IN_WORD;
+    if (exponent_bits)
+        exponent_bits -= __builtin_clz(exponent.m_words[exponent.trimmed_length() - 1]);
+    size_t window_size = sliding_window_size(exponent_bits);
+
+    auto exponent_bit = [&](size_t bit) -> UnsignedBigInteger::Word {
+        return (exponent.m_words[bit / UnsignedBigInteger::BITS_IN_WORD] >> (bit % UnsignedBigInteger::BITS_IN_WORD)) & 1;
+    };
 
     size_t num_words = modulo.trimmed_length();
     UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
@@ -220,39 +216,49 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
     one.set_to(1);
     one.resize_with_leading_zeros(num_words);
 
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
-
-    z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
-    zz.set_to(0);
-    zz.resize_with_leading_zeros(num_words);
-
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
+    // Compute the odd montgomery powers up to 2^window_size. odd_powers[i] = x^(2 * i + 1)
+    UnsignedBigInteger odd_powers[1 << (max_sliding_window_size - 1)];
+    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, odd_powers[0]);
+    almost_montgomery_multiplication_without_allocation(odd_powers[0], odd_powers[0], modulo, temp_z, k, num_words, zz);
+    for (size_t i = 1; i < (1u << (window_size - 1)); ++i)
+        almost_montgomery_multiplication_without_allocation(odd_powers[i - 1], zz, modulo, temp_z, k, num_words, odd_powers[i]);
+
+    // z = 1, in montgomery form
+    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, z);
+    bool z_is_one = true;
+
+    ssize_t bit = static_cast<ssize_t>(exponent_bits) - 1;
+    while (bit >= 0) {
+        if (!exponent_bit(bit)) {
+            if (!z_is_one) {
                 almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
+                swap(z, zz);
+            }
+            --bit;
+            continue;
+        }
+
+        ssize_t window_end = max<ssize_t>(bit - static_cast<ssize_t>(window_size) + 1, 0);
+        while (!exponent_bit(window_end))
+            ++window_end;
+        size_t window_value = 0;
+        for (ssize_t i = bit; i >= window_end; --i)
+            window_value = (window_value << 1) | exponent_bit(i);
+        auto& power = odd_powers[window_value >> 1];
+
+        if (z_is_one) {
+            z.set_to(power);
+            z.resize_with_leading_zeros(num_words);
+            z_is_one = false;
+        } else {
+            for (ssize_t i = bit; i >= window_end; --i) {
                 almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
+                swap(z, zz);
             }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
             almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
-
             swap(z, zz);
-
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
         }
+        bit = window_end - 1;
     }
 
     almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
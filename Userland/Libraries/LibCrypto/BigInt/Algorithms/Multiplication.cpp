@@ -9,38 +9,171 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+
+// Below this many words, the schoolbook method beats Karatsuba's extra additions.
+static constexpr size_t karatsuba_threshold = 32;
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Computes out[0, a_length + b_length) = a * b, one word of b at a time.
+ */
+static void schoolbook_multiply(Word* out, Word const* a, size_t a_length, Word const* b, size_t b_length)
+{
+    __builtin_memset(out, 0, (a_length + b_length) * sizeof(Word));
+    for (size_t i = 0; i < b_length; ++i) {
+        u64 carry = 0;
+        for (size_t j = 0; j < a_length; ++j) {
+            // This can't overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+            u64 product = static_cast<u64>(a[j]) * b[i] + out[i + j] + carry;
+            out[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        out[i + a_length] = static_cast<Word>(carry);
+    }
+}
+
+/**
+ * Computes out[0, out_length) += value[0, value_length), and returns the carry out of the top word.
+ */
+static Word add_words(Word* out, size_t out_length, Word const* value, size_t value_length)
+{
+    u64 carry = 0;
+    size_t i = 0;
+    for (; i < value_length; ++i) {
+        u64 sum = static_cast<u64>(out[i]) + value[i] + carry;
+        out[i] = static_cast<Word>(sum);
+        carry = sum >> UnsignedBigInteger::BITS_IN_WORD;
+    }
+    for (; carry && i < out_length; ++i) {
+        u64 sum = static_cast<u64>(out[i]) + carry;
+        out[i] = static_cast<Word>(sum);
+        carry = sum >> UnsignedBigInteger::BITS_IN_WORD;
+    }
+    return static_cast<Word>(carry);
+}
+
+/**
+ * Computes out[0, out_length) -= value[0, value_length), which must not go below zero.
+ */
+static void subtract_words(Word* out, size_t out_length, Word const* value, size_t value_length)
+{
+    Word borrow = 0;
+    size_t i = 0;
+    for (; i < value_length; ++i) {
+        u64 difference = static_cast<u64>(out[i]) - value[i] - borrow;
+        out[i] = static_cast<Word>(difference);
+        borrow = (difference >> UnsignedBigInteger::BITS_IN_WORD) ? 1 : 0;
+    }
+    for (; borrow && i < out_length; ++i)
+        borrow = out[i]-- == 0 ? 1 : 0;
+    VERIFY(borrow == 0);
+}
+
+static size_t karatsuba_scratch_length(size_t length)
+{
+    if (length < karatsuba_threshold)
+        return 0;
+    auto high_length = length - length / 2;
+    return 4 * (high_length + 1) + karatsuba_scratch_length(high_length + 1);
+}
+
+/**
+ * Computes out[0, 2 * length) = a * b for two numbers of `length` words each.
+ * Karatsuba method:
+ * With a = a1 * W + a0 and b = b1 * W + b0 (W being 2^(32 * half the length)),
+ * a * b = a1 * b1 * W^2 + ((a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1) * W + a0 * b0,
+ * which takes three half-sized multiplications instead of four.
+ */
+static void karatsuba_multiply(Word* out, Word const* a, Word const* b, size_t length, Word* scratch)
+{
+    if (length < karatsuba_threshold) {
+        schoolbook_multiply(out, a, length, b, length);
+        return;
+    }
+
+    auto low_length = length / 2;
+    auto high_length = length - low_length;
+    auto sum_length = high_length + 1;
+
+    auto* a_sum = scratch;
+    auto* b_sum = a_sum + sum_length;
+    auto* middle = b_sum + sum_length;
+    auto* next_scratch = middle + 2 * sum_length;
+
+    // a_sum = a0 + a1, b_sum = b0 + b1
+    __builtin_memcpy(a_sum, a + low_length, high_length * sizeof(Word));
+    a_sum[high_length] = 0;
+    add_words(a_sum, sum_length, a, low_length);
+    __builtin_memcpy(b_sum, b + low_length, high_length * sizeof(Word));
+    b_sum[high_length] = 0;
+    add_words(b_sum, sum_length, b, low_length);
+
+    // The low and high products go straight into their places in the output.
+    karatsuba_multiply(out, a, b, low_length, next_scratch);
+    karatsuba_multiply(out + 2 * low_length, a + low_length, b + low_length, high_length, next_scratch);
+
+    // middle = a_sum * b_sum - a0 * b0 - a1 * b1 = a0 * b1 + a1 * b0
+    karatsuba_multiply(middle, a_sum, b_sum, sum_length, next_scratch);
+    subtract_words(middle, 2 * sum_length, out, 2 * low_length);
+    subtract_words(middle, 2 * sum_length, out + 2 * low_length, 2 * high_length);
+
+    auto carry = add_words(out + low_length, 2 * length - low_length, middle, 2 * sum_length);
+    VERIFY(carry == 0);
+}
+
+/**
+ * Complexity: O(N^2) where N is the number of words in the larger number, or O(N^1.58) once both
+ * numbers are at least karatsuba_threshold words long.
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Short numbers are multiplied word by word, like we would multiply decimal numbers by hand.
+ * Long numbers are split in halves and multiplied with Karatsuba's method (see karatsuba_multiply()).
+ * If one number is much longer than the other, it is cut into chunks that are as long as the
+ * other number, and the chunk products are added up.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp_scratch,
+    UnsignedBigInteger& temp_chunk_product,
+    UnsignedBigInteger&,
     UnsignedBigInteger& output)
 {
+    auto const* longer = &left;
+    auto const* shorter = &right;
+    if (longer->trimmed_length() < shorter->trimmed_length())
+        swap(longer, shorter);
+
+    auto longer_length = longer->trimmed_length();
+    auto shorter_length = shorter->trimmed_length();
+
     output.set_to_0();
+    if (shorter_length == 0)
+        return;
+    output.m_words.resize_and_keep_capacity(longer_length + shorter_length);
+    auto* out = output.m_words.data();
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    if (shorter_length < karatsuba_threshold) {
+        schoolbook_multiply(out, longer->m_words.data(), longer_length, shorter->m_words.data(), shorter_length);
+        output.clamp_to_trimmed_length();
+        return;
+    }
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    temp_scratch.set_to_0();
+    temp_chunk_product.set_to_0();
+    temp_scratch.m_words.resize_and_keep_capacity(karatsuba_scratch_length(shorter_length));
+    temp_chunk_product.m_words.resize_and_keep_capacity(2 * shorter_length);
+    auto* chunk_product = temp_chunk_product.m_words.data();
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
+    __builtin_memset(out, 0, (longer_length + shorter_length) * sizeof(Word));
+    for (size_t offset = 0; offset < longer_length; offset += shorter_length) {
+        auto chunk_length = min(shorter_length, longer_length - offset);
+        if (chunk_length == shorter_length)
+            karatsuba_multiply(chunk_product, longer->m_words.data() + offset, shorter->m_words.data(), shorter_length, temp_scratch.m_words.data());
+        else
+            schoolbook_multiply(chunk_product, shorter->m_words.data(), shorter_length, longer->m_words.data() + offset, chunk_length);
+        add_words(out + offset, longer_length + shorter_length - offset, chunk_product, chunk_length + shorter_length);
     }
+    output.clamp_to_trimmed_length();
 }
 
 }
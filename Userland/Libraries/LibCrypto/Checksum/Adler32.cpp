@@ -4,17 +4,67 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/SIMD.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
+#include <string.h>
 
 namespace Crypto::Checksum {
 
+using AK::SIMD::u32x4;
+using AK::SIMD::u8x4;
+
+static constexpr u32 modulus = 65521;
+// The most bytes that can be summed up before b overflows 32 bits and has to be reduced (zlib's NMAX).
+static constexpr size_t max_bytes_between_reductions = 5552;
+
+// Sums up 16 byte columns: a_columns[j] gets the sum of the j-th byte of every 16-byte block, and b_columns[j] the sum
+// of the a_columns[j] seen before every block. That gives a and b without a single multiplication in the loop, since
+//   a = a0 + sum of all bytes
+//   b = b0 + size * a0 + 16 * sum(b_columns) + sum((16 - j) * a_columns[j])
+static void update_blocks(u32& a, u32& b, const u8* data, size_t block_count)
+{
+    u32x4 a_columns[4] {};
+    u32x4 b_columns[4] {};
+    for (size_t block = 0; block < block_count; ++block, data += 16) {
+        for (size_t i = 0; i < 4; ++i) {
+            u8x4 bytes;
+            memcpy(&bytes, data + i * 4, sizeof(bytes));
+            b_columns[i] += a_columns[i];
+            a_columns[i] += __builtin_convertvector(bytes, u32x4);
+        }
+    }
+
+    u64 a_sum = 0;
+    u64 b_sum = 0;
+    u64 weighted_a_sum = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            a_sum += a_columns[i][j];
+            b_sum += b_columns[i][j];
+            weighted_a_sum += (16 - (i * 4 + j)) * (u64)a_columns[i][j];
+        }
+    }
+
+    b = (b + block_count * 16 * (u64)a + 16 * b_sum + weighted_a_sum) % modulus;
+    a = (a + a_sum) % modulus;
+}
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    auto* bytes = data.data();
+    auto size = data.size();
+    while (size >= 16) {
+        auto chunk_size = min(size, max_bytes_between_reductions) & ~(size_t)15;
+        update_blocks(m_state_a, m_state_b, bytes, chunk_size / 16);
+        bytes += chunk_size;
+        size -= chunk_size;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        m_state_a = (m_state_a + bytes[i]) % modulus;
+        m_state_b = (m_state_b + m_state_a) % modulus;
     }
 };
 
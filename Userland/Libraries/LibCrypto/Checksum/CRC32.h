@@ -12,35 +12,6 @@
 
 namespace Crypto::Checksum {
 
-struct Table {
-    u32 data[256];
-
-    constexpr Table()
-        : data()
-    {
-        for (auto i = 0; i < 256; i++) {
-            u32 value = i;
-
-            for (auto j = 0; j < 8; j++) {
-                if (value & 1) {
-                    value = 0xEDB88320 ^ (value >> 1);
-                } else {
-                    value = value >> 1;
-                }
-            }
-
-            data[i] = value;
-        }
-    }
-
-    constexpr u32 operator[](int index) const
-    {
-        return data[index];
-    }
-};
-
-constexpr static auto table = Table();
-
 class CRC32 : public ChecksumFunction<u32> {
 public:
     CRC32() { }
@@ -58,6 +29,10 @@ public:
     void update(ReadonlyBytes data);
     u32 digest();
 
+    // The digest of two pieces of data put together, given the digests of both pieces and the length of the second one.
+    // This takes O(log(second_length)) steps, so the pieces can be checksummed separately (and in parallel).
+    static u32 combine(u32 first_digest, u32 second_digest, size_t second_length);
+
 private:
     u32 m_state { ~0u };
 };
@@ -4,9 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
+#include <AK/SIMD.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 
+// NOTE: The kernel can't use SSE registers, so it always goes through the tables.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    include <cpuid.h>
+#    define HAVE_AESNI_KERNELS
+#    define AESNI_TARGET __attribute__((target("sse2,aes")))
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -23,6 +32,95 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#ifdef HAVE_AESNI_KERNELS
+
+using AK::SIMD::u32x4;
+using AESVector = long long __attribute__((vector_size(16)));
+
+static bool cpu_has_aesni()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ecx & bit_AES) && (edx & bit_SSE2);
+}
+
+static bool has_aesni()
+{
+    static bool s_has_aesni = cpu_has_aesni();
+    return s_has_aesni;
+}
+
+// The round keys are kept as big endian words for the tables, and AES-NI wants them as bytes in memory order.
+// The decryption keys are already in the form AESDEC wants, reversed and with InvMixColumns applied to the middle ones.
+ALWAYS_INLINE static void load_round_keys(AESVector (&round_keys)[15], const u32* words, size_t rounds)
+{
+    for (size_t i = 0; i <= rounds; ++i) {
+        u32x4 key { __builtin_bswap32(words[i * 4]), __builtin_bswap32(words[i * 4 + 1]), __builtin_bswap32(words[i * 4 + 2]), __builtin_bswap32(words[i * 4 + 3]) };
+        round_keys[i] = (AESVector)key;
+    }
+}
+
+ALWAYS_INLINE static AESVector load_block(const u8* data)
+{
+    AESVector block;
+    __builtin_memcpy(&block, data, sizeof(block));
+    return block;
+}
+
+ALWAYS_INLINE static void store_block(u8* data, AESVector block)
+{
+    __builtin_memcpy(data, &block, sizeof(block));
+}
+
+// AESENC takes a few cycles to produce its result, but can start on another block every cycle,
+// so independent blocks go through the rounds four at a time.
+template<bool Encrypt>
+AESNI_TARGET static void crypt_blocks_aesni(const u32* round_key_words, size_t rounds, const u8* in, u8* out, size_t count)
+{
+    AESVector round_keys[15];
+    load_round_keys(round_keys, round_key_words, rounds);
+
+    auto round = [](AESVector block, AESVector key) {
+        if constexpr (Encrypt)
+            return __builtin_ia32_aesenc128(block, key);
+        else
+            return __builtin_ia32_aesdec128(block, key);
+    };
+    auto last_round = [](AESVector block, AESVector key) {
+        if constexpr (Encrypt)
+            return __builtin_ia32_aesenclast128(block, key);
+        else
+            return __builtin_ia32_aesdeclast128(block, key);
+    };
+
+    for (; count >= 4; count -= 4, in += 64, out += 64) {
+        auto b0 = load_block(in) ^ round_keys[0];
+        auto b1 = load_block(in + 16) ^ round_keys[0];
+        auto b2 = load_block(in + 32) ^ round_keys[0];
+        auto b3 = load_block(in + 48) ^ round_keys[0];
+        for (size_t i = 1; i < rounds; ++i) {
+            b0 = round(b0, round_keys[i]);
+            b1 = round(b1, round_keys[i]);
+            b2 = round(b2, round_keys[i]);
+            b3 = round(b3, round_keys[i]);
+        }
+        store_block(out, last_round(b0, round_keys[rounds]));
+        store_block(out + 16, last_round(b1, round_keys[rounds]));
+        store_block(out + 32, last_round(b2, round_keys[rounds]));
+        store_block(out + 48, last_round(b3, round_keys[rounds]));
+    }
+
+    for (; count > 0; --count, in += 16, out += 16) {
+        auto block = load_block(in) ^ round_keys[0];
+        for (size_t i = 1; i < rounds; ++i)
+            block = round(block, round_keys[i]);
+        store_block(out, last_round(block, round_keys[rounds]));
+    }
+}
+
+#endif
+
 String AESCipherBlock::to_string() const
 {
     StringBuilder builder;
@@ -194,8 +292,37 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+void AESCipher::encrypt_blocks(ReadonlyBytes in, Bytes out)
+{
+    VERIFY(in.size() % block_size() == 0);
+    VERIFY(out.size() >= in.size());
+
+#ifdef HAVE_AESNI_KERNELS
+    if (has_aesni()) {
+        const auto& enc_key = key();
+        crypt_blocks_aesni<true>(enc_key.round_keys(), enc_key.rounds(), in.data(), out.data(), in.size() / block_size());
+        return;
+    }
+#endif
+
+    BlockType block;
+    for (size_t offset = 0; offset < in.size(); offset += block_size()) {
+        block.overwrite(in.slice(offset, block_size()));
+        encrypt_block(block, block);
+        block.bytes().copy_to(out.slice(offset));
+    }
+}
+
 void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef HAVE_AESNI_KERNELS
+    if (has_aesni()) {
+        const auto& enc_key = key();
+        crypt_blocks_aesni<true>(enc_key.round_keys(), enc_key.rounds(), in.bytes().data(), out.bytes().data(), 1);
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +415,14 @@ void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef HAVE_AESNI_KERNELS
+    if (has_aesni()) {
+        const auto& dec_key = key();
+        crypt_blocks_aesni<false>(dec_key.round_keys(), dec_key.rounds(), in.bytes().data(), out.bytes().data(), 1);
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
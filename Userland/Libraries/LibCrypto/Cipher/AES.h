@@ -109,6 +109,10 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) override;
     virtual void decrypt_block(const BlockType& in, BlockType& out) override;
 
+    // Encrypts a whole number of blocks at once, which lets AES-NI (when the CPU has it) work on several of them
+    // at the same time. in and out may be the same.
+    void encrypt_blocks(ReadonlyBytes in, Bytes out);
+
     virtual String class_name() const override { return "AES"; }
 
 protected:
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
+#include <AK/SIMD.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    define HAVE_SSE2_KERNELS
+#    define SSE2_TARGET __attribute__((target("sse2")))
+#endif
+
+namespace Crypto {
+namespace Cipher {
+
+ALWAYS_INLINE static u32 load_little_endian(const u8* address)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(address));
+}
+
+ALWAYS_INLINE static void store_little_endian(u8* address, u32 value)
+{
+    ByteReader::store(address, AK::convert_between_host_and_little_endian(value));
+}
+
+template<typename T>
+ALWAYS_INLINE static T rotate_left(T value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+#define QUARTER_ROUND(a, b, c, d) \
+    a += b;                       \
+    d ^= a;                       \
+    d = rotate_left(d, 16);       \
+    c += d;                       \
+    b ^= c;                       \
+    b = rotate_left(b, 12);       \
+    a += b;                       \
+    d ^= a;                       \
+    d = rotate_left(d, 8);        \
+    c += d;                       \
+    b ^= c;                       \
+    b = rotate_left(b, 7);
+
+// Runs the 20 rounds on x, which works the same on plain words and on vectors of words.
+template<typename T>
+ALWAYS_INLINE static void chacha20_rounds(T (&x)[16])
+{
+    for (size_t i = 0; i < 10; ++i) {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+}
+
+#undef QUARTER_ROUND
+
+// Writes `block_count` blocks of key stream and advances the block counter in state[12] past them.
+static void generate_blocks_scalar(u32 (&state)[16], u8* out, size_t block_count)
+{
+    for (size_t block = 0; block < block_count; ++block) {
+        u32 x[16];
+        __builtin_memcpy(x, state, sizeof(x));
+        chacha20_rounds(x);
+        for (size_t i = 0; i < 16; ++i)
+            store_little_endian(out + block * ChaCha20::BlockSize + i * 4, x[i] + state[i]);
+        ++state[12];
+    }
+}
+
+#ifdef HAVE_SSE2_KERNELS
+
+using AK::SIMD::u32x4;
+
+ALWAYS_INLINE SSE2_TARGET static void chacha20_rounds_sse2(u32x4 (&x)[16])
+{
+    chacha20_rounds(x);
+}
+
+// Computes four blocks at once: every vector holds the same word of four consecutive blocks.
+SSE2_TARGET static void generate_blocks_sse2(u32 (&state)[16], u8* out, size_t block_count)
+{
+    size_t block = 0;
+    for (; block + 4 <= block_count; block += 4) {
+        u32x4 initial[16];
+        for (size_t i = 0; i < 16; ++i)
+            initial[i] = u32x4 { state[i], state[i], state[i], state[i] };
+        initial[12] += u32x4 { 0, 1, 2, 3 };
+
+        u32x4 x[16];
+        for (size_t i = 0; i < 16; ++i)
+            x[i] = initial[i];
+        chacha20_rounds_sse2(x);
+
+        for (size_t i = 0; i < 16; ++i) {
+            auto word = x[i] + initial[i];
+            for (size_t lane = 0; lane < 4; ++lane)
+                store_little_endian(out + (block + lane) * ChaCha20::BlockSize + i * 4, word[lane]);
+        }
+        state[12] += 4;
+    }
+    generate_blocks_scalar(state, out + block * ChaCha20::BlockSize, block_count - block);
+}
+
+static bool cpu_has_sse2()
+{
+#    if ARCH(X86_64)
+    return true;
+#    else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return edx & bit_SSE2;
+#    endif
+}
+
+#endif
+
+using GenerateBlocksFunction = void (*)(u32 (&)[16], u8*, size_t);
+
+static GenerateBlocksFunction generate_blocks_function()
+{
+    static GenerateBlocksFunction s_function;
+    if (!s_function) {
+        s_function = generate_blocks_scalar;
+#ifdef HAVE_SSE2_KERNELS
+        if (cpu_has_sse2())
+            s_function = generate_blocks_sse2;
+#endif
+    }
+    return s_function;
+}
+
+ChaCha20::ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter)
+{
+    VERIFY(key.size() == KeySize);
+    VERIFY(nonce.size() == NonceSize);
+
+    // "expand 32-byte k"
+    m_state[0] = 0x61707865;
+    m_state[1] = 0x3320646e;
+    m_state[2] = 0x79622d32;
+    m_state[3] = 0x6b206574;
+    for (size_t i = 0; i < 8; ++i)
+        m_state[4 + i] = load_little_endian(key.offset(i * 4));
+    m_state[12] = initial_counter;
+    for (size_t i = 0; i < 3; ++i)
+        m_state[13 + i] = load_little_endian(nonce.offset(i * 4));
+}
+
+void ChaCha20::run(ReadonlyBytes in, Bytes out)
+{
+    VERIFY(out.size() >= in.size());
+
+    size_t offset = 0;
+
+    // Use up what's left of the last block first.
+    for (; offset < in.size() && m_key_stream_offset < BlockSize; ++offset)
+        out[offset] = in[offset] ^ m_key_stream[m_key_stream_offset++];
+
+    auto generate_blocks = generate_blocks_function();
+
+    // Then go through whole blocks, a few at a time.
+    constexpr size_t blocks_per_batch = 8;
+    u8 key_stream[blocks_per_batch * BlockSize];
+    while (in.size() - offset >= BlockSize) {
+        auto block_count = min(blocks_per_batch, (in.size() - offset) / BlockSize);
+        generate_blocks(m_state, key_stream, block_count);
+        for (size_t i = 0; i < block_count * BlockSize; ++i)
+            out[offset + i] = in[offset + i] ^ key_stream[i];
+        offset += block_count * BlockSize;
+    }
+
+    // And keep the rest of the last block for next time.
+    if (offset < in.size()) {
+        generate_blocks(m_state, m_key_stream, 1);
+        m_key_stream_offset = 0;
+        for (; offset < in.size(); ++offset)
+            out[offset] = in[offset] ^ m_key_stream[m_key_stream_offset++];
+    }
+}
+
+}
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Cipher {
+
+// The ChaCha20 stream cipher, as specified in RFC 8439 section 2.4.
+class ChaCha20 {
+public:
+    static constexpr size_t KeySize = 32;
+    static constexpr size_t NonceSize = 12;
+    static constexpr size_t BlockSize = 64;
+
+    ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter = 0);
+
+    // XORs `in` with the next in.size() bytes of the key stream into `out`.
+    // Encryption and decryption are the same operation, and `in` and `out` may be the same buffer.
+    void run(ReadonlyBytes in, Bytes out);
+
+    String class_name() const { return "ChaCha20"; }
+
+private:
+    u32 m_state[16];
+    u8 m_key_stream[BlockSize];
+    size_t m_key_stream_offset { BlockSize };
+};
+
+}
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+
+namespace Crypto {
+namespace Cipher {
+
+ChaCha20Poly1305::ChaCha20Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+    key.copy_to({ m_key, KeySize });
+}
+
+void ChaCha20Poly1305::compute_tag(ReadonlyBytes poly1305_key, ReadonlyBytes aad, ReadonlyBytes ciphertext, Bytes tag)
+{
+    static constexpr u8 zeros[16] {};
+
+    Authentication::Poly1305 poly1305(poly1305_key);
+    poly1305.update(aad);
+    poly1305.update({ zeros, (16 - aad.size() % 16) % 16 });
+    poly1305.update(ciphertext);
+    poly1305.update({ zeros, (16 - ciphertext.size() % 16) % 16 });
+
+    u8 lengths[16];
+    ByteReader::store(lengths, AK::convert_between_host_and_little_endian((u32)aad.size()));
+    ByteReader::store(lengths + 4, AK::convert_between_host_and_little_endian((u32)((u64)aad.size() >> 32)));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_little_endian((u32)ciphertext.size()));
+    ByteReader::store(lengths + 12, AK::convert_between_host_and_little_endian((u32)((u64)ciphertext.size() >> 32)));
+    poly1305.update({ lengths, sizeof(lengths) });
+
+    auto digest = poly1305.digest();
+    ReadonlyBytes { digest.data, TagSize }.copy_to(tag);
+}
+
+void ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag)
+{
+    VERIFY(tag.size() >= TagSize);
+
+    // The Poly1305 key is the first half of block 0, and the message is encrypted from block 1 on.
+    ChaCha20 chacha20 { { m_key, KeySize }, nonce };
+    u8 poly1305_key[ChaCha20::BlockSize] {};
+    chacha20.run({ poly1305_key, sizeof(poly1305_key) }, { poly1305_key, sizeof(poly1305_key) });
+    chacha20.run(in, out);
+
+    compute_tag({ poly1305_key, Authentication::Poly1305::KeySize }, aad, out.slice(0, in.size()), tag);
+}
+
+VerificationConsistency ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag)
+{
+    ChaCha20 chacha20 { { m_key, KeySize }, nonce };
+    u8 poly1305_key[ChaCha20::BlockSize] {};
+    chacha20.run({ poly1305_key, sizeof(poly1305_key) }, { poly1305_key, sizeof(poly1305_key) });
+
+    u8 expected_tag[TagSize];
+    compute_tag({ poly1305_key, Authentication::Poly1305::KeySize }, aad, in, { expected_tag, TagSize });
+
+    if (tag.size() != TagSize)
+        return VerificationConsistency::Inconsistent;
+
+    // Compare in constant time, so the time this takes doesn't tell how much of the tag was right.
+    u8 difference = 0;
+    for (size_t i = 0; i < TagSize; ++i)
+        difference |= expected_tag[i] ^ tag[i];
+    if (difference != 0)
+        return VerificationConsistency::Inconsistent;
+
+    chacha20.run(in, out);
+    return VerificationConsistency::Consistent;
+}
+
+}
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Verification.h>
+
+namespace Crypto {
+namespace Cipher {
+
+// The ChaCha20 and Poly1305 AEAD construction, as specified in RFC 8439 section 2.8.
+// Its encrypt() and decrypt() take the same arguments as GCM's.
+class ChaCha20Poly1305 {
+public:
+    static constexpr size_t KeySize = ChaCha20::KeySize;
+    static constexpr size_t NonceSize = ChaCha20::NonceSize;
+    static constexpr size_t TagSize = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key);
+
+    String class_name() const { return "ChaCha20-Poly1305"; }
+
+    void encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag);
+    VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag);
+
+private:
+    void compute_tag(ReadonlyBytes poly1305_key, ReadonlyBytes aad, ReadonlyBytes ciphertext, Bytes tag);
+
+    u8 m_key[KeySize];
+};
+
+}
+}
@@ -97,15 +97,20 @@ public:
         m_cipher_block.set_padding_mode(cipher.padding_mode());
         size_t offset { 0 };
 
+        // Each ciphertext block is the IV of the next one, so keep a copy: `out` may be `in`.
+        u8 previous_block[T::block_size()];
+        u8 current_block[T::block_size()];
+
         while (length > 0) {
-            auto slice = in.slice(offset);
-            m_cipher_block.overwrite(slice.data(), block_size);
+            __builtin_memcpy(current_block, in.offset(offset), block_size);
+            m_cipher_block.overwrite(current_block, block_size);
             cipher.decrypt_block(m_cipher_block, m_cipher_block);
             m_cipher_block.apply_initialization_vector(iv);
             auto decrypted = m_cipher_block.bytes();
             VERIFY(offset + decrypted.size() <= out.size());
             __builtin_memcpy(out.offset(offset), decrypted.data(), decrypted.size());
-            iv = slice;
+            __builtin_memcpy(previous_block, current_block, block_size);
+            iv = { previous_block, block_size };
             length -= block_size;
             offset += block_size;
         }
@@ -163,6 +163,37 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        if constexpr (requires { cipher.encrypt_blocks(ReadonlyBytes {}, Bytes {}); }) {
+            // Encrypting a batch of counter blocks at once lets the cipher pipeline them.
+            constexpr size_t blocks_per_batch = 8;
+            u8 key_stream[blocks_per_batch * T::block_size()];
+
+            while (length > 0) {
+                auto batch_size = min(length, sizeof(key_stream));
+                auto block_count = (batch_size + block_size - 1) / block_size;
+                for (size_t i = 0; i < block_count; ++i) {
+                    __builtin_memcpy(key_stream + i * block_size, iv.data(), block_size);
+                    increment(iv);
+                }
+                cipher.encrypt_blocks({ key_stream, block_count * block_size }, { key_stream, block_count * block_size });
+
+                VERIFY(offset + batch_size <= out.size());
+                if (in) {
+                    for (size_t i = 0; i < batch_size; ++i)
+                        out[offset + i] = key_stream[i] ^ (*in)[offset + i];
+                } else {
+                    __builtin_memcpy(out.offset(offset), key_stream, batch_size);
+                }
+
+                length -= batch_size;
+                offset += batch_size;
+            }
+
+            if (ivec_out)
+                __builtin_memcpy(ivec_out->data(), iv.data(), min(ivec_out->size(), IV_length()));
+            return;
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
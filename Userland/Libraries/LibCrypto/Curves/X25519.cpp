@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Random.h>
+#include <LibCrypto/Curves/X25519.h>
+
+namespace Crypto {
+namespace Curves {
+
+// Elements of the field of integers modulo p = 2^255 - 19, in ten limbs that alternate between 26 and 25 bits
+// (so limb i is worth 2^ceil(25.5 * i)). Limbs are signed and may go a little past their size between carries;
+// all the products of two of them still fit in 64 bits, which keeps this fast on 32-bit CPUs too.
+struct FieldElement {
+    i32 limbs[10];
+};
+
+static constexpr int limb_bits(size_t i)
+{
+    return i % 2 == 0 ? 26 : 25;
+}
+
+// Brings every limb back to (about) its size, rounding so they end up between -2^(bits-1) and 2^(bits-1).
+static void carry(i64 (&h)[10], FieldElement& out)
+{
+    for (size_t i = 0; i < 9; ++i) {
+        auto bits = limb_bits(i);
+        i64 carry = (h[i] + ((i64)1 << (bits - 1))) >> bits;
+        h[i + 1] += carry;
+        h[i] -= carry * ((i64)1 << bits);
+    }
+
+    // 2^255 is 19 modulo p.
+    i64 carry = (h[9] + ((i64)1 << 24)) >> 25;
+    h[0] += carry * 19;
+    h[9] -= carry * ((i64)1 << 25);
+    carry = (h[0] + ((i64)1 << 25)) >> 26;
+    h[1] += carry;
+    h[0] -= carry * ((i64)1 << 26);
+
+    for (size_t i = 0; i < 10; ++i)
+        out.limbs[i] = (i32)h[i];
+}
+
+static void add(FieldElement& out, const FieldElement& f, const FieldElement& g)
+{
+    for (size_t i = 0; i < 10; ++i)
+        out.limbs[i] = f.limbs[i] + g.limbs[i];
+}
+
+static void subtract(FieldElement& out, const FieldElement& f, const FieldElement& g)
+{
+    for (size_t i = 0; i < 10; ++i)
+        out.limbs[i] = f.limbs[i] - g.limbs[i];
+}
+
+static void multiply(FieldElement& out, const FieldElement& f, const FieldElement& g)
+{
+    i64 h[19] {};
+    for (size_t i = 0; i < 10; ++i) {
+        for (size_t j = 0; j < 10; ++j) {
+            i64 product = (i64)f.limbs[i] * g.limbs[j];
+            // Two odd limbs are worth half a bit more than limb i + j.
+            if (i & j & 1)
+                product *= 2;
+            h[i + j] += product;
+        }
+    }
+
+    i64 reduced[10];
+    for (size_t i = 0; i < 10; ++i)
+        reduced[i] = h[i] + (i + 10 < 19 ? 19 * h[i + 10] : 0);
+    carry(reduced, out);
+}
+
+static void square(FieldElement& out, const FieldElement& f)
+{
+    multiply(out, f, f);
+}
+
+static void multiply_small(FieldElement& out, const FieldElement& f, i32 g)
+{
+    i64 h[10];
+    for (size_t i = 0; i < 10; ++i)
+        h[i] = (i64)f.limbs[i] * g;
+    carry(h, out);
+}
+
+// Swaps f and g if swap is 1, in constant time.
+static void conditional_swap(FieldElement& f, FieldElement& g, u32 swap)
+{
+    i32 mask = -(i32)swap;
+    for (size_t i = 0; i < 10; ++i) {
+        i32 difference = mask & (f.limbs[i] ^ g.limbs[i]);
+        f.limbs[i] ^= difference;
+        g.limbs[i] ^= difference;
+    }
+}
+
+// Computes 1/f as f^(p - 2), with the usual chain of 254 squarings and 11 multiplications.
+static void invert(FieldElement& out, const FieldElement& f)
+{
+    auto square_times = [](FieldElement& x, size_t times) {
+        for (size_t i = 0; i < times; ++i)
+            square(x, x);
+    };
+
+    FieldElement f2, f9, f11, f_5_0, f_10_0, f_20_0, f_50_0, f_100_0, t;
+    square(f2, f);
+    square(t, f2);
+    square(t, t);
+    multiply(f9, t, f);
+    multiply(f11, f9, f2);
+    square(t, f11);
+    multiply(f_5_0, t, f9); // 2^5 - 1
+    t = f_5_0;
+    square_times(t, 5);
+    multiply(f_10_0, t, f_5_0); // 2^10 - 1
+    t = f_10_0;
+    square_times(t, 10);
+    multiply(f_20_0, t, f_10_0); // 2^20 - 1
+    t = f_20_0;
+    square_times(t, 20);
+    multiply(t, t, f_20_0); // 2^40 - 1
+    square_times(t, 10);
+    multiply(f_50_0, t, f_10_0); // 2^50 - 1
+    t = f_50_0;
+    square_times(t, 50);
+    multiply(f_100_0, t, f_50_0); // 2^100 - 1
+    t = f_100_0;
+    square_times(t, 100);
+    multiply(t, t, f_100_0); // 2^200 - 1
+    square_times(t, 50);
+    multiply(t, t, f_50_0); // 2^250 - 1
+    square_times(t, 5);
+    multiply(out, t, f11); // 2^255 - 21
+}
+
+static void from_bytes(FieldElement& out, ReadonlyBytes bytes)
+{
+    // The top bit is ignored, as RFC 7748 asks.
+    i64 h[10];
+    size_t offset = 0;
+    for (size_t i = 0; i < 10; ++i) {
+        u64 window = 0;
+        for (size_t byte = 0; byte < 8 && offset / 8 + byte < X25519::KeySize; ++byte)
+            window |= (u64)bytes[offset / 8 + byte] << (byte * 8);
+        h[i] = (window >> (offset % 8)) & ((1u << limb_bits(i)) - 1);
+        offset += limb_bits(i);
+    }
+    carry(h, out);
+}
+
+static void to_bytes(Bytes out, const FieldElement& f)
+{
+    auto h = f;
+
+    // q is 1 if h is at least p (then h + 19 reaches 2^255), and 0 otherwise.
+    i32 q = (19 * h.limbs[9] + (1 << 24)) >> 25;
+    for (size_t i = 0; i < 10; ++i)
+        q = (h.limbs[i] + q) >> limb_bits(i);
+
+    // Subtract q * p, by adding 19 * q and dropping the 2^255 bit.
+    h.limbs[0] += 19 * q;
+    for (size_t i = 0; i < 9; ++i) {
+        i32 carry = h.limbs[i] >> limb_bits(i);
+        h.limbs[i + 1] += carry;
+        h.limbs[i] -= carry * (1 << limb_bits(i));
+    }
+    h.limbs[9] &= (1 << 25) - 1;
+
+    u64 bits = 0;
+    size_t bit_count = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < 10; ++i) {
+        bits |= (u64)h.limbs[i] << bit_count;
+        bit_count += limb_bits(i);
+        while (bit_count >= 8) {
+            out[position++] = bits & 0xff;
+            bits >>= 8;
+            bit_count -= 8;
+        }
+    }
+    out[position] = bits;
+}
+
+bool X25519::compute_coordinate(ReadonlyBytes scalar, ReadonlyBytes u_coordinate, Bytes out)
+{
+    VERIFY(scalar.size() == KeySize);
+    VERIFY(u_coordinate.size() == KeySize);
+    VERIFY(out.size() >= KeySize);
+
+    u8 k[KeySize];
+    __builtin_memcpy(k, scalar.data(), KeySize);
+    k[0] &= 248;
+    k[31] &= 127;
+    k[31] |= 64;
+
+    // The Montgomery ladder from RFC 7748 section 5, with (a + 2) / 4 = 121666 folded into "a24 = 121665".
+    FieldElement x1, x2 {}, z2 {}, x3, z3 {};
+    from_bytes(x1, u_coordinate);
+    x2.limbs[0] = 1;
+    x3 = x1;
+    z3.limbs[0] = 1;
+
+    u32 swap = 0;
+    for (int t = 254; t >= 0; --t) {
+        u32 k_t = (k[t / 8] >> (t % 8)) & 1;
+        swap ^= k_t;
+        conditional_swap(x2, x3, swap);
+        conditional_swap(z2, z3, swap);
+        swap = k_t;
+
+        FieldElement a, aa, b, bb, e, c, d, da, cb;
+        add(a, x2, z2);
+        square(aa, a);
+        subtract(b, x2, z2);
+        square(bb, b);
+        subtract(e, aa, bb);
+        add(c, x3, z3);
+        subtract(d, x3, z3);
+        multiply(da, d, a);
+        multiply(cb, c, b);
+
+        add(x3, da, cb);
+        square(x3, x3);
+        subtract(z3, da, cb);
+        square(z3, z3);
+        multiply(z3, z3, x1);
+        multiply(x2, aa, bb);
+        multiply_small(z2, e, 121665);
+        add(z2, z2, aa);
+        multiply(z2, z2, e);
+    }
+    conditional_swap(x2, x3, swap);
+    conditional_swap(z2, z3, swap);
+
+    FieldElement z2_inverse, result;
+    invert(z2_inverse, z2);
+    multiply(result, x2, z2_inverse);
+    to_bytes(out, result);
+
+    u8 all_bits = 0;
+    for (size_t i = 0; i < KeySize; ++i)
+        all_bits |= out[i];
+    return all_bits != 0;
+}
+
+void X25519::generate_private_key(Bytes private_key)
+{
+    VERIFY(private_key.size() >= KeySize);
+    fill_with_random(private_key.data(), KeySize);
+}
+
+void X25519::generate_public_key(ReadonlyBytes private_key, Bytes public_key)
+{
+    static constexpr u8 base_point[KeySize] { 9 };
+    compute_coordinate(private_key, { base_point, KeySize }, public_key);
+}
+
+}
+}
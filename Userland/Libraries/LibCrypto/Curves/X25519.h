@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Curves {
+
+// The X25519 Diffie-Hellman function on Curve25519, as specified in RFC 7748 section 5.
+class X25519 {
+public:
+    static constexpr size_t KeySize = 32;
+
+    // A new random private key.
+    static void generate_private_key(Bytes private_key);
+
+    // The public key for a private key, which is the private key multiplied by the base point.
+    static void generate_public_key(ReadonlyBytes private_key, Bytes public_key);
+
+    // The u-coordinate of the point `u_coordinate` multiplied by `scalar`. Called with our private key
+    // and the peer's public key, this is the shared secret.
+    // Returns false if the result is zero, which means that the peer's public key is a point of small order.
+    static bool compute_coordinate(ReadonlyBytes scalar, ReadonlyBytes u_coordinate, Bytes out);
+};
+
+}
+}
@@ -50,6 +50,7 @@ static __pthread_mutex_t s_loader_lock = __PTHREAD_MUTEX_INITIALIZER;
 
 static bool s_allowed_to_check_environment_variables { false };
 static bool s_do_breakpoint_trap_before_entry { false };
+static bool s_bind_now { false };
 
 static Result<void, DlErrorMessage> __dlclose(void* handle);
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags);
@@ -364,9 +365,11 @@ static Optional<DlErrorMessage> verify_tls_for_dlopen(const DynamicLoader& loade
 
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags)
 {
-    // FIXME: RTLD_NOW and RTLD_LOCAL are not supported
-    flags &= ~RTLD_NOW;
-    flags |= RTLD_LAZY;
+    if ((flags & RTLD_NOW) || s_bind_now)
+        flags &= ~RTLD_LAZY;
+    else
+        flags |= RTLD_LAZY;
+    // FIXME: RTLD_LOCAL is not supported
     flags &= ~RTLD_LOCAL;
     flags |= RTLD_GLOBAL;
 
@@ -483,6 +486,9 @@ static void read_environment_variables()
         if (StringView { *env } == "_LOADER_BREAKPOINT=1") {
             s_do_breakpoint_trap_before_entry = true;
         }
+        if (StringView { *env } == "LD_BIND_NOW=1") {
+            s_bind_now = true;
+        }
     }
 }
 
@@ -524,7 +530,7 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
 
     auto entry_point_function = [&main_program_name] {
         auto library_name = get_library_name(main_program_name);
-        auto result = load_main_library(library_name, RTLD_GLOBAL | RTLD_LAZY);
+        auto result = load_main_library(library_name, RTLD_GLOBAL | (s_bind_now ? RTLD_NOW : RTLD_LAZY));
         if (result.is_error()) {
             warnln("{}", result.error().text);
             _exit(1);
@@ -157,6 +157,8 @@ bool DynamicLoader::load_stage_2(unsigned flags)
 {
     VERIFY(flags & RTLD_GLOBAL);
 
+    m_should_bind_now = !(flags & RTLD_LAZY) || m_dynamic_object->must_bind_now();
+
     if (m_dynamic_object->has_text_relocations()) {
         for (auto& text_segment : m_text_segments) {
             VERIFY(text_segment.address().get() != 0);
@@ -200,7 +202,8 @@ void DynamicLoader::do_main_relocations()
 Result<NonnullRefPtr<DynamicObject>, DlErrorMessage> DynamicLoader::load_stage_3(unsigned flags)
 {
     do_lazy_relocations();
-    if (flags & RTLD_LAZY) {
+    if (!m_should_bind_now) {
+        VERIFY(flags & RTLD_LAZY);
         if (m_dynamic_object->has_plt())
             setup_plt_trampoline();
     }
@@ -486,8 +489,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #else
     case R_X86_64_JUMP_SLOT: {
 #endif
-        // FIXME: Or BIND_NOW flag passed in?
-        if (m_dynamic_object->must_bind_now()) {
+        if (m_should_bind_now) {
             // Eagerly BIND_NOW the PLT entries, doing all the symbol looking goodness
             // The patch method returns the address for the LAZY fixup path, but we don't need it here
             m_dynamic_object->patch_plt_entry(relocation.offset_in_section());
@@ -156,6 +156,9 @@ private:
 
     Vector<DynamicObject::Relocation> m_unresolved_relocations;
 
+    // If not set, PLT entries are left pointing at the trampoline and bound on their first call.
+    bool m_should_bind_now { true };
+
     mutable RefPtr<DynamicObject> m_cached_dynamic_object;
 };
 
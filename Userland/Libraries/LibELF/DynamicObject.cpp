@@ -181,8 +181,35 @@ void DynamicObject::parse()
 
     auto hash_section_address = hash_section().address().as_ptr();
     // TODO: consider base address - it might not be zero
-    auto num_hash_chains = ((u32*)hash_section_address)[1];
-    m_symbol_count = num_hash_chains;
+    if (m_hash_type == HashType::SYSV) {
+        auto num_hash_chains = ((u32*)hash_section_address)[1];
+        m_symbol_count = num_hash_chains;
+    } else {
+        m_symbol_count = gnu_hash_symbol_count((const u32*)hash_section_address);
+    }
+}
+
+unsigned DynamicObject::gnu_hash_symbol_count(const u32* hash_table_begin)
+{
+    // A GNU hash table doesn't store the number of symbols, but since the symbols in each bucket come after
+    // the ones in the buckets before, the last symbol is at the end of the chain of the last used bucket.
+    const size_t num_buckets = hash_table_begin[0];
+    const size_t num_omitted_symbols = hash_table_begin[1];
+    const u32 num_maskwords = hash_table_begin[2];
+
+    const u32* const buckets = (const u32*)&((const GnuHashBloomWord*)&hash_table_begin[4])[num_maskwords];
+    const u32* const chains = &buckets[num_buckets];
+
+    size_t last_symbol = 0;
+    for (size_t i = 0; i < num_buckets; ++i)
+        last_symbol = max(last_symbol, (size_t)buckets[i]);
+    // Empty buckets are 0, so this means there are no symbols in the table at all.
+    if (last_symbol == 0)
+        return num_omitted_symbols;
+
+    while (!(chains[last_symbol - num_omitted_symbols] & 1))
+        ++last_symbol;
+    return last_symbol + 1;
 }
 
 DynamicObject::Relocation DynamicObject::RelocationSection::relocation(unsigned index) const
@@ -276,8 +303,7 @@ auto DynamicObject::HashSection::lookup_sysv_symbol(const StringView& name, u32
 auto DynamicObject::HashSection::lookup_gnu_symbol(const StringView& name, u32 hash_value) const -> Optional<Symbol>
 {
     // Algorithm reference: https://ent-voy.blogspot.com/2011/02/
-    // TODO: Handle 64bit bloomwords for ELF_CLASS64
-    using BloomWord = u32;
+    using BloomWord = GnuHashBloomWord;
     constexpr size_t bloom_word_size = sizeof(BloomWord) * 8;
 
     const u32* hash_table_begin = (u32*)address().as_ptr();
@@ -289,13 +315,13 @@ auto DynamicObject::HashSection::lookup_gnu_symbol(const StringView& name, u32 h
     const u32 num_maskwords_bitmask = num_maskwords - 1;
     const u32 shift2 = hash_table_begin[3];
 
-    const BloomWord* bloom_words = &hash_table_begin[4];
-    const u32* const buckets = &bloom_words[num_maskwords];
+    const BloomWord* bloom_words = (const BloomWord*)&hash_table_begin[4];
+    const u32* const buckets = (const u32*)&bloom_words[num_maskwords];
     const u32* const chains = &buckets[num_buckets];
 
-    BloomWord hash1 = hash_value;
-    BloomWord hash2 = hash1 >> shift2;
-    const BloomWord bitmask = (1 << (hash1 % bloom_word_size)) | (1 << (hash2 % bloom_word_size));
+    u32 hash1 = hash_value;
+    u32 hash2 = hash1 >> shift2;
+    const BloomWord bitmask = ((BloomWord)1 << (hash1 % bloom_word_size)) | ((BloomWord)1 << (hash2 % bloom_word_size));
 
     if ((bloom_words[(hash1 / bloom_word_size) & num_maskwords_bitmask] & bitmask) != bitmask)
         return {};
@@ -167,6 +167,9 @@ public:
         GNU
     };
 
+    // The Bloom filter words of a DT_GNU_HASH table are as wide as an address in the object's ELF class.
+    using GnuHashBloomWord = ElfW(Addr);
+
     class HashSymbol {
     public:
         HashSymbol(const StringView& name)
@@ -293,6 +296,7 @@ private:
     StringView symbol_string_table_string(ElfW(Word)) const;
     const char* raw_symbol_string_table_string(ElfW(Word)) const;
     void parse();
+    static unsigned gnu_hash_symbol_count(const u32* hash_table_begin);
 
     String m_filename;
 
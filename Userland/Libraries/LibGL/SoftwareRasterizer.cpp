@@ -6,16 +6,26 @@
 
 #include "SoftwareRasterizer.h"
 #include <AK/Function.h>
+#include <AK/SIMD.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
+#include <LibThreading/Parallel.h>
+#include <string.h>
 
 namespace GL {
 
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
+
 using IntVector2 = Gfx::Vector2<int>;
 using IntVector3 = Gfx::Vector3<int>;
 
 static constexpr int RASTERIZER_BLOCK_SIZE = 16;
+static constexpr int RASTERIZER_TILE_SIZE = 4 * RASTERIZER_BLOCK_SIZE;
+static constexpr size_t MAX_QUEUED_TRIANGLES = 16384;
+
+static_assert(RASTERIZER_BLOCK_SIZE % 4 == 0, "RASTERIZER_BLOCK_SIZE must be a multiple of the span width of 4 pixels");
 
 constexpr static int edge_function(const IntVector2& a, const IntVector2& b, const IntVector2& c)
 {
@@ -28,6 +38,30 @@ constexpr static T interpolate(const T& v0, const T& v1, const T& v2, const Floa
     return v0 * barycentric_coords.x() + v1 * barycentric_coords.y() + v2 * barycentric_coords.z();
 }
 
+ALWAYS_INLINE static i32x4 splat(int value)
+{
+    return i32x4 { value, value, value, value };
+}
+
+ALWAYS_INLINE static f32x4 splat(float value)
+{
+    return f32x4 { value, value, value, value };
+}
+
+// The edge values of a span of 4 horizontally neighbouring pixels, the first of which has the given edge values.
+ALWAYS_INLINE static void edge_values_of_span(const IntVector3& first, const IntVector3& step, i32x4& e0, i32x4& e1, i32x4& e2)
+{
+    e0 = i32x4 { first.x(), first.x() + step.x(), first.x() + 2 * step.x(), first.x() + 3 * step.x() };
+    e1 = i32x4 { first.y(), first.y() + step.y(), first.y() + 2 * step.y(), first.y() + 3 * step.y() };
+    e2 = i32x4 { first.z(), first.z() + step.z(), first.z() + 2 * step.z(), first.z() + 3 * step.z() };
+}
+
+// Turns the result of a comparison of two vectors (where every lane is either all 1s or all 0s) into a 4 bit mask.
+ALWAYS_INLINE static int to_mask(i32x4 lanes)
+{
+    return (lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8);
+}
+
 static Gfx::RGBA32 to_rgba32(const FloatVector4& v)
 {
     auto clamped = v.clamped(0, 1);
@@ -99,7 +133,7 @@ static constexpr void setup_blend_factors(GLenum mode, FloatVector4& constant, f
 }
 
 template<typename PS>
-static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, PS pixel_shader)
+static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const Gfx::IntRect& tile_rect, const GLTriangle& triangle, PS pixel_shader)
 {
     // Since the algorithm is based on blocks of uniform size, we need
     // to ensure that our render_target size is actually a multiple of the block size
@@ -176,12 +210,12 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             && edges.z() >= zero.z();
     };
 
-    // Calculate block-based bounds
+    // Calculate block-based bounds, limited to the tile we're drawing
     // clang-format off
-    const int bx0 = max(0,                      min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int bx1 = min(render_target.width(),  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
-    const int by0 = max(0,                      min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int by1 = min(render_target.height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int bx0 = max(tile_rect.left(),       min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int bx1 = min(tile_rect.right() + 1,  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int by0 = max(tile_rect.top(),        min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int by1 = min(tile_rect.bottom() + 1, max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
     // clang-format on
 
     static_assert(RASTERIZER_BLOCK_SIZE < sizeof(int) * 8, "RASTERIZER_BLOCK_SIZE must be smaller than the pixel_mask's width in bits");
@@ -216,8 +250,10 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             // edge value derivatives
             auto dbdx = (b1 - b0) / RASTERIZER_BLOCK_SIZE;
             auto dbdy = (b2 - b0) / RASTERIZER_BLOCK_SIZE;
-            // step edge value after each horizontal span: 1 down, BLOCK_SIZE left
-            auto step_y = dbdy - dbdx * RASTERIZER_BLOCK_SIZE;
+            // step edge values of a 4 pixel span to the next one
+            auto span_step_x = splat(dbdx.x() * 4);
+            auto span_step_y = splat(dbdx.y() * 4);
+            auto span_step_z = splat(dbdx.z() * 4);
 
             int x0 = bx * RASTERIZER_BLOCK_SIZE;
             int y0 = by * RASTERIZER_BLOCK_SIZE;
@@ -230,15 +266,18 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
                 }
             } else {
                 // The block overlaps at least one triangle edge.
-                // We need to test coverage of every pixel within the block.
+                // We need to test coverage of every pixel within the block, which we do 4 pixels at a time.
+                auto zero_x = splat(zero.x());
+                auto zero_y = splat(zero.y());
+                auto zero_z = splat(zero.z());
                 auto coords = b0;
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
                     pixel_mask[y] = 0;
 
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx) {
-                        if (test_point(coords))
-                            pixel_mask[y] |= 1 << x;
-                    }
+                    i32x4 e0, e1, e2;
+                    edge_values_of_span(coords, dbdx, e0, e1, e2);
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 4, e0 += span_step_x, e1 += span_step_y, e2 += span_step_z)
+                        pixel_mask[y] |= to_mask((e0 >= zero_x) & (e1 >= zero_y) & (e2 >= zero_z)) << x;
                 }
             }
 
@@ -247,26 +286,37 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
                 int z_pass_count = 0;
                 auto coords = b0;
 
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                    if (pixel_mask[y] == 0) {
-                        coords += dbdx * RASTERIZER_BLOCK_SIZE;
+                auto z0 = splat(triangle.vertices[0].z);
+                auto z1 = splat(triangle.vertices[1].z);
+                auto z2 = splat(triangle.vertices[2].z);
+                auto one_over_area_4 = splat(one_over_area);
+
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
+                    if (pixel_mask[y] == 0)
                         continue;
-                    }
 
+                    i32x4 e0, e1, e2;
+                    edge_values_of_span(coords, dbdx, e0, e1, e2);
                     auto* depth = &depth_buffer.scanline(y0 + y)[x0];
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, depth++) {
-                        if (~pixel_mask[y] & (1 << x))
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 4, e0 += span_step_x, e1 += span_step_y, e2 += span_step_z) {
+                        int span_mask = (pixel_mask[y] >> x) & 0xf;
+                        if (span_mask == 0)
                             continue;
 
-                        auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                        float z = interpolate(triangle.vertices[0].z, triangle.vertices[1].z, triangle.vertices[2].z, barycentric);
-                        if (z >= *depth) {
-                            pixel_mask[y] ^= 1 << x;
-                            continue;
-                        }
+                        auto z = z0 * (__builtin_convertvector(e0, f32x4) * one_over_area_4)
+                            + z1 * (__builtin_convertvector(e1, f32x4) * one_over_area_4)
+                            + z2 * (__builtin_convertvector(e2, f32x4) * one_over_area_4);
 
-                        *depth = z;
-                        z_pass_count++;
+                        f32x4 stored_z;
+                        memcpy(&stored_z, depth + x, sizeof(stored_z));
+                        int passed_mask = to_mask(~(z >= stored_z)) & span_mask;
+                        pixel_mask[y] &= ~((span_mask & ~passed_mask) << x);
+
+                        for (int i = 0; i < 4; i++) {
+                            if (passed_mask & (1 << i))
+                                depth[x + i] = z[i];
+                        }
+                        z_pass_count += __builtin_popcount(passed_mask);
                     }
                 }
 
@@ -277,42 +327,57 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
 
             // Draw the pixels according to the previously generated mask
             auto coords = b0;
-            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                if (pixel_mask[y] == 0) {
-                    coords += dbdx * RASTERIZER_BLOCK_SIZE;
+            auto w0 = splat(triangle.vertices[0].w);
+            auto w1 = splat(triangle.vertices[1].w);
+            auto w2 = splat(triangle.vertices[2].w);
+            auto one_over_area_4 = splat(one_over_area);
+            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
+                if (pixel_mask[y] == 0)
                     continue;
-                }
 
-                auto* pixel = pixel_buffer[y];
-                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, pixel++) {
-                    if (~pixel_mask[y] & (1 << x))
+                i32x4 e0, e1, e2;
+                edge_values_of_span(coords, dbdx, e0, e1, e2);
+                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 4, e0 += span_step_x, e1 += span_step_y, e2 += span_step_z) {
+                    int span_mask = (pixel_mask[y] >> x) & 0xf;
+                    if (span_mask == 0)
                         continue;
 
-                    // Perspective correct barycentric coordinates
-                    auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                    float interpolated_reciprocal_w = interpolate(triangle.vertices[0].w, triangle.vertices[1].w, triangle.vertices[2].w, barycentric);
-                    float interpolated_w = 1 / interpolated_reciprocal_w;
-                    barycentric = barycentric * FloatVector3(triangle.vertices[0].w, triangle.vertices[1].w, triangle.vertices[2].w) * interpolated_w;
-
-                    // FIXME: make this more generic. We want to interpolate more than just color and uv
-                    FloatVector4 vertex_color;
-                    if (options.shade_smooth) {
-                        vertex_color = interpolate(
-                            FloatVector4(triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a),
-                            FloatVector4(triangle.vertices[1].r, triangle.vertices[1].g, triangle.vertices[1].b, triangle.vertices[1].a),
-                            FloatVector4(triangle.vertices[2].r, triangle.vertices[2].g, triangle.vertices[2].b, triangle.vertices[2].a),
-                            barycentric);
-                    } else {
-                        vertex_color = { triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a };
-                    }
+                    // Perspective correct barycentric coordinates of the whole span
+                    auto barycentric_x = __builtin_convertvector(e0, f32x4) * one_over_area_4;
+                    auto barycentric_y = __builtin_convertvector(e1, f32x4) * one_over_area_4;
+                    auto barycentric_z = __builtin_convertvector(e2, f32x4) * one_over_area_4;
+                    auto interpolated_reciprocal_w = w0 * barycentric_x + w1 * barycentric_y + w2 * barycentric_z;
+                    auto interpolated_w = 1 / interpolated_reciprocal_w;
+                    barycentric_x = barycentric_x * w0 * interpolated_w;
+                    barycentric_y = barycentric_y * w1 * interpolated_w;
+                    barycentric_z = barycentric_z * w2 * interpolated_w;
+
+                    for (int i = 0; i < 4; i++) {
+                        if (~span_mask & (1 << i))
+                            continue;
 
-                    auto uv = interpolate(
-                        FloatVector2(triangle.vertices[0].u, triangle.vertices[0].v),
-                        FloatVector2(triangle.vertices[1].u, triangle.vertices[1].v),
-                        FloatVector2(triangle.vertices[2].u, triangle.vertices[2].v),
-                        barycentric);
+                        FloatVector3 barycentric { barycentric_x[i], barycentric_y[i], barycentric_z[i] };
+
+                        // FIXME: make this more generic. We want to interpolate more than just color and uv
+                        FloatVector4 vertex_color;
+                        if (options.shade_smooth) {
+                            vertex_color = interpolate(
+                                FloatVector4(triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a),
+                                FloatVector4(triangle.vertices[1].r, triangle.vertices[1].g, triangle.vertices[1].b, triangle.vertices[1].a),
+                                FloatVector4(triangle.vertices[2].r, triangle.vertices[2].g, triangle.vertices[2].b, triangle.vertices[2].a),
+                                barycentric);
+                        } else {
+                            vertex_color = { triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a };
+                        }
+
+                        auto uv = interpolate(
+                            FloatVector2(triangle.vertices[0].u, triangle.vertices[0].v),
+                            FloatVector2(triangle.vertices[1].u, triangle.vertices[1].v),
+                            FloatVector2(triangle.vertices[2].u, triangle.vertices[2].v),
+                            barycentric);
 
-                    *pixel = pixel_shader(uv, vertex_color);
+                        pixel_buffer[y][x + i] = pixel_shader(uv, vertex_color);
+                    }
                 }
             }
 
@@ -412,34 +477,107 @@ SoftwareRasterizer::SoftwareRasterizer(const Gfx::IntSize& min_size)
     : m_render_target { Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE)) }
     , m_depth_buffer { adopt_own(*new DepthBuffer(closest_multiple(min_size, RASTERIZER_BLOCK_SIZE))) }
 {
+    set_up_tiles();
+}
+
+void SoftwareRasterizer::set_up_tiles()
+{
+    m_tiles.clear();
+    m_tiles_per_row = (m_render_target->width() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+    for (int y = 0; y < m_render_target->height(); y += RASTERIZER_TILE_SIZE) {
+        for (int x = 0; x < m_render_target->width(); x += RASTERIZER_TILE_SIZE) {
+            Gfx::IntRect rect { x, y, RASTERIZER_TILE_SIZE, RASTERIZER_TILE_SIZE };
+            m_tiles.append({ rect.intersected(m_render_target->rect()), {} });
+        }
+    }
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [](const FloatVector2&, const FloatVector4& color) -> FloatVector4 {
-        return color;
-    });
+    if (!m_queued_triangles.is_empty() && m_queued_triangles_are_textured)
+        wait_for_all_threads();
+
+    m_queued_triangles_are_textured = false;
+    queue_triangle(triangle);
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [&texture_units](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
-        // TODO: We'd do some kind of multitexturing/blending here
-        // Construct a vector for the texel we want to sample
-        FloatVector4 texel = color;
+    // The queued triangles get drawn with the textures that were bound when they were submitted.
+    auto has_same_textures_as_queue = [&] {
+        if (!m_queued_triangles_are_textured)
+            return false;
+        for (size_t i = 0; i < texture_units.size(); ++i) {
+            if (texture_units[i].bound_texture() != m_queued_texture_units[i].bound_texture())
+                return false;
+        }
+        return true;
+    };
 
-        for (const auto& texture_unit : texture_units) {
+    if (m_queued_triangles.is_empty() || !has_same_textures_as_queue()) {
+        wait_for_all_threads();
+        m_queued_triangles_are_textured = true;
+        m_queued_texture_units = texture_units;
+    }
+    queue_triangle(triangle);
+}
 
-            // No texture is bound to this texture unit
-            if (!texture_unit.is_bound())
-                continue;
+void SoftwareRasterizer::queue_triangle(const GLTriangle& triangle)
+{
+    // Sort the triangle into every tile that its bounding box touches. The same bounds are used by rasterize_triangle().
+    IntVector2 v0 { (int)triangle.vertices[0].x, (int)triangle.vertices[0].y };
+    IntVector2 v1 { (int)triangle.vertices[1].x, (int)triangle.vertices[1].y };
+    IntVector2 v2 { (int)triangle.vertices[2].x, (int)triangle.vertices[2].y };
+
+    int x0 = max(0, min(min(v0.x(), v1.x()), v2.x())) / RASTERIZER_BLOCK_SIZE * RASTERIZER_BLOCK_SIZE;
+    int x1 = min(m_render_target->width(), max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE * RASTERIZER_BLOCK_SIZE;
+    int y0 = max(0, min(min(v0.y(), v1.y()), v2.y())) / RASTERIZER_BLOCK_SIZE * RASTERIZER_BLOCK_SIZE;
+    int y1 = min(m_render_target->height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE * RASTERIZER_BLOCK_SIZE;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    u32 triangle_index = m_queued_triangles.size();
+    m_queued_triangles.append(triangle);
+
+    for (int tile_y = y0 / RASTERIZER_TILE_SIZE; tile_y <= (y1 - 1) / RASTERIZER_TILE_SIZE; ++tile_y) {
+        for (int tile_x = x0 / RASTERIZER_TILE_SIZE; tile_x <= (x1 - 1) / RASTERIZER_TILE_SIZE; ++tile_x)
+            m_tiles[tile_y * m_tiles_per_row + tile_x].triangle_indices.append(triangle_index);
+    }
+
+    if (m_queued_triangles.size() >= MAX_QUEUED_TRIANGLES)
+        wait_for_all_threads();
+}
 
-            // FIXME: Don't assume Texture2D, _and_ work out how we blend/do multitexturing properly.....
-            texel = texel * static_ptr_cast<Texture2D>(texture_unit.bound_texture())->sample_texel(uv);
+void SoftwareRasterizer::draw_tile(Tile& tile)
+{
+    for (auto triangle_index : tile.triangle_indices) {
+        auto& triangle = m_queued_triangles[triangle_index];
+        if (!m_queued_triangles_are_textured) {
+            rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, tile.rect, triangle, [](const FloatVector2&, const FloatVector4& color) -> FloatVector4 {
+                return color;
+            });
+            continue;
         }
 
-        return texel;
-    });
+        rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, tile.rect, triangle, [this](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
+            // TODO: We'd do some kind of multitexturing/blending here
+            // Construct a vector for the texel we want to sample
+            FloatVector4 texel = color;
+
+            for (const auto& texture_unit : m_queued_texture_units) {
+
+                // No texture is bound to this texture unit
+                if (!texture_unit.is_bound())
+                    continue;
+
+                // FIXME: Don't assume Texture2D, _and_ work out how we blend/do multitexturing properly.....
+                texel = texel * static_ptr_cast<Texture2D>(texture_unit.bound_texture())->sample_texel(uv);
+            }
+
+            return texel;
+        });
+    }
+    tile.triangle_indices.clear_with_capacity();
 }
 
 void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
@@ -448,6 +586,7 @@ void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
 
     m_render_target = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE));
     m_depth_buffer = adopt_own(*new DepthBuffer(m_render_target->size()));
+    set_up_tiles();
 }
 
 void SoftwareRasterizer::clear_color(const FloatVector4& color)
@@ -477,9 +616,19 @@ void SoftwareRasterizer::blit_to(Gfx::Bitmap& target)
     painter.blit({ 0, 0 }, *m_render_target, m_render_target->rect(), 1.0f, false);
 }
 
-void SoftwareRasterizer::wait_for_all_threads() const
+void SoftwareRasterizer::wait_for_all_threads()
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    if (m_queued_triangles.is_empty())
+        return;
+
+    // Every tile only ever gets touched by one thread, which draws its triangles in the order they were submitted.
+    Threading::parallel_for(m_tiles.span(), [this](Tile& tile) {
+        if (!tile.triangle_indices.is_empty())
+            draw_tile(tile);
+    },
+        1);
+
+    m_queued_triangles.clear_with_capacity();
 }
 
 void SoftwareRasterizer::set_options(const RasterizerOptions& options)
@@ -487,12 +636,12 @@ void SoftwareRasterizer::set_options(const RasterizerOptions& options)
     wait_for_all_threads();
 
     m_options = options;
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
 }
 
 Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 0;
@@ -502,6 +651,8 @@ Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 
 float SoftwareRasterizer::get_depthbuffer_value(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 1.0f;
@@ -13,6 +13,7 @@
 #include "Tex/TextureUnit.h"
 #include <AK/Array.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Vector4.h>
 
@@ -39,16 +40,35 @@ public:
     void clear_color(const FloatVector4&);
     void clear_depth(float);
     void blit_to(Gfx::Bitmap&);
-    void wait_for_all_threads() const;
+
+    // Submitted triangles are only queued up. They get drawn here, split up into screen tiles that are drawn in parallel,
+    // which happens on its own whenever something needs the render target or the depth buffer.
+    void wait_for_all_threads();
+
     void set_options(const RasterizerOptions&);
     RasterizerOptions options() const { return m_options; }
     Gfx::RGBA32 get_backbuffer_pixel(int x, int y);
     float get_depthbuffer_value(int x, int y);
 
 private:
+    struct Tile {
+        Gfx::IntRect rect;
+        Vector<u32> triangle_indices;
+    };
+
+    void set_up_tiles();
+    void queue_triangle(const GLTriangle&);
+    void draw_tile(Tile&);
+
     RefPtr<Gfx::Bitmap> m_render_target;
     OwnPtr<DepthBuffer> m_depth_buffer;
     RasterizerOptions m_options;
+
+    Vector<Tile> m_tiles;
+    int m_tiles_per_row { 0 };
+    Vector<GLTriangle> m_queued_triangles;
+    bool m_queued_triangles_are_textured { false };
+    Array<TextureUnit, 32> m_queued_texture_units;
 };
 
 }
@@ -14,9 +14,8 @@
 #include <LibCore/StandardPaths.h>
 #include <LibGUI/FileIconProvider.h>
 #include <LibGUI/FileSystemModel.h>
-#include <LibGUI/Painter.h>
+#include <LibGUI/ThumbnailCache.h>
 #include <LibGfx/Bitmap.h>
-#include <LibThreading/BackgroundAction.h>
 #include <grp.h>
 #include <pwd.h>
 #include <stdio.h>
@@ -527,69 +526,39 @@ Icon FileSystemModel::icon_for(const Node& node) const
     return FileIconProvider::icon_for_path(node.full_path(), node.mode);
 }
 
-static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
-
-static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
-{
-    auto png_bitmap = Gfx::Bitmap::load_from_file(path);
-    if (!png_bitmap)
-        return nullptr;
-
-    double scale = min(32 / (double)png_bitmap->width(), 32 / (double)png_bitmap->height());
-
-    auto thumbnail = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { 32, 32 });
-    Gfx::IntRect destination = Gfx::IntRect(0, 0, (int)(png_bitmap->width() * scale), (int)(png_bitmap->height() * scale));
-    destination.center_within(thumbnail->rect());
-
-    Painter painter(*thumbnail);
-    painter.draw_scaled_bitmap(destination, *png_bitmap, png_bitmap->rect());
-    return thumbnail;
-}
-
 bool FileSystemModel::fetch_thumbnail_for(const Node& node)
 {
     // See if we already have the thumbnail
     // we're looking for in the cache.
     auto path = node.full_path();
-    auto it = s_thumbnail_cache.find(path);
-    if (it != s_thumbnail_cache.end()) {
-        if (!(*it).value)
-            return false;
-        node.thumbnail = (*it).value;
-        return true;
+    if (auto thumbnail = ThumbnailCache::the().cached_thumbnail(path, node.mtime); thumbnail.has_value()) {
+        node.thumbnail = thumbnail.value();
+        return !node.thumbnail.is_null();
     }
 
     // Otherwise, arrange to render the thumbnail
     // in background and make it available later.
 
-    s_thumbnail_cache.set(path, nullptr);
-    m_thumbnail_progress_total++;
-
     auto weak_this = make_weak_ptr();
 
-    Threading::BackgroundAction<RefPtr<Gfx::Bitmap>>::create(
-        [path] {
-            return render_thumbnail(path);
-        },
-
-        [this, path, weak_this](auto thumbnail) {
-            s_thumbnail_cache.set(path, move(thumbnail));
-
-            // The model was destroyed, no need to update
-            // progress or call any event handlers.
-            if (weak_this.is_null())
-                return;
-
-            m_thumbnail_progress++;
-            if (on_thumbnail_progress)
-                on_thumbnail_progress(m_thumbnail_progress, m_thumbnail_progress_total);
-            if (m_thumbnail_progress == m_thumbnail_progress_total) {
-                m_thumbnail_progress = 0;
-                m_thumbnail_progress_total = 0;
-            }
+    bool started = ThumbnailCache::the().generate_thumbnail(path, node.mtime, [this, weak_this] {
+        // The model was destroyed, no need to update
+        // progress or call any event handlers.
+        if (weak_this.is_null())
+            return;
+
+        m_thumbnail_progress++;
+        if (on_thumbnail_progress)
+            on_thumbnail_progress(m_thumbnail_progress, m_thumbnail_progress_total);
+        if (m_thumbnail_progress == m_thumbnail_progress_total) {
+            m_thumbnail_progress = 0;
+            m_thumbnail_progress_total = 0;
+        }
 
-            did_update(UpdateFlag::DontInvalidateIndices);
-        });
+        did_update(UpdateFlag::DontInvalidateIndices);
+    });
+    if (started)
+        m_thumbnail_progress_total++;
 
     return false;
 }
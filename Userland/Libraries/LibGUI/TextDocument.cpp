@@ -41,53 +41,62 @@ TextDocument::~TextDocument()
 }
 
 bool TextDocument::set_text(const StringView& text)
+{
+    return set_text_from_buffer(TextDocumentBuffer::create(ByteBuffer::copy(text.characters_without_null_termination(), text.length())));
+}
+
+bool TextDocument::set_text_from_mapped_file(NonnullRefPtr<MappedFile> file)
+{
+    return set_text_from_buffer(TextDocumentBuffer::create(move(file)));
+}
+
+bool TextDocument::set_text_from_buffer(NonnullRefPtr<TextDocumentBuffer> buffer)
 {
     m_client_notifications_enabled = false;
     m_undo_stack.clear();
     m_spans.clear();
     remove_all_lines();
+    m_buffer = nullptr;
 
     ArmedScopeGuard clear_text_guard([this]() {
-        set_text({});
+        set_text(StringView {});
     });
 
+    auto text = buffer->view(0, buffer->bytes().size());
+    if (!Utf8View(text).validate())
+        return false;
+
     size_t start_of_current_line = 0;
+    size_t code_points_in_current_line = 0;
 
-    auto add_line = [&](size_t current_position) -> bool {
+    auto add_line = [&](size_t current_position) {
         size_t line_length = current_position - start_of_current_line;
-        auto line = make<TextDocumentLine>(*this);
-
-        bool success = true;
         if (line_length)
-            success = line->set_text(*this, text.substring_view(start_of_current_line, current_position - start_of_current_line));
-
-        if (!success)
-            return false;
-
-        append_line(move(line));
+            append_line(make<TextDocumentLine>(buffer, start_of_current_line, line_length, code_points_in_current_line));
+        else
+            append_line(make<TextDocumentLine>(*this));
         start_of_current_line = current_position + 1;
-
-        return true;
+        code_points_in_current_line = 0;
     };
 
     size_t i = 0;
     for (i = 0; i < text.length(); ++i) {
-        if (text[i] != '\n')
+        if (text[i] == '\n') {
+            add_line(i);
             continue;
-
-        auto success = add_line(i);
-        if (!success)
-            return false;
+        }
+        // Every code point has exactly one byte that isn't a continuation byte.
+        if ((static_cast<u8>(text[i]) & 0xc0) != 0x80)
+            ++code_points_in_current_line;
     }
 
-    auto success = add_line(i);
-    if (!success)
-        return false;
+    add_line(i);
 
     // Don't show the file's trailing newline as an actual new line.
     if (line_count() > 1 && line(line_count() - 1).is_empty())
         m_lines.take_last();
 
+    m_buffer = move(buffer);
     m_client_notifications_enabled = true;
 
     for (auto* client : m_clients)
@@ -100,6 +109,20 @@ bool TextDocument::set_text(const StringView& text)
     return true;
 }
 
+void TextDocument::unmap_file()
+{
+    if (m_buffer)
+        m_buffer->copy_out_of_mapped_file();
+}
+
+void TextDocumentBuffer::copy_out_of_mapped_file()
+{
+    if (!m_file)
+        return;
+    m_data = ByteBuffer::copy(m_file->bytes());
+    m_file = nullptr;
+}
+
 size_t TextDocumentLine::first_non_whitespace_column() const
 {
     for (size_t i = 0; i < length(); ++i) {
@@ -142,8 +165,8 @@ bool TextDocumentLine::can_select() const
 size_t TextDocumentLine::leading_spaces() const
 {
     size_t count = 0;
-    for (; count < m_text.size(); ++count) {
-        if (m_text[count] != ' ') {
+    for (; count < length(); ++count) {
+        if (code_points()[count] != ' ') {
             break;
         }
     }
@@ -152,6 +175,8 @@ size_t TextDocumentLine::leading_spaces() const
 
 String TextDocumentLine::to_utf8() const
 {
+    if (auto text = undecoded_text(); text.has_value())
+        return *text;
     StringBuilder builder;
     builder.append(view());
     return builder.to_string();
@@ -167,14 +192,38 @@ TextDocumentLine::TextDocumentLine(TextDocument& document, const StringView& tex
     set_text(document, text);
 }
 
+TextDocumentLine::TextDocumentLine(NonnullRefPtr<TextDocumentBuffer> buffer, size_t offset, size_t byte_length, size_t length)
+    : m_buffer(move(buffer))
+    , m_offset(offset)
+    , m_byte_length(byte_length)
+    , m_length(length)
+{
+}
+
+Optional<StringView> TextDocumentLine::undecoded_text() const
+{
+    if (!m_buffer)
+        return {};
+    return m_buffer->view(m_offset, m_byte_length);
+}
+
+void TextDocumentLine::decode() const
+{
+    m_text.ensure_capacity(m_length);
+    Utf8View(m_buffer->view(m_offset, m_byte_length)).append_code_points_to(m_text);
+    m_buffer = nullptr;
+}
+
 void TextDocumentLine::clear(TextDocument& document)
 {
+    m_buffer = nullptr;
     m_text.clear();
     document.update_views({});
 }
 
 void TextDocumentLine::set_text(TextDocument& document, const Vector<u32> text)
 {
+    m_buffer = nullptr;
     m_text = move(text);
     document.update_views({});
 }
@@ -185,13 +234,13 @@ bool TextDocumentLine::set_text(TextDocument& document, const StringView& text)
         clear(document);
         return true;
     }
+    m_buffer = nullptr;
     m_text.clear();
     Utf8View utf8_view(text);
     if (!utf8_view.validate()) {
         return false;
     }
-    for (auto code_point : utf8_view)
-        m_text.append(code_point);
+    utf8_view.append_code_points_to(m_text);
     document.update_views({});
     return true;
 }
@@ -200,6 +249,7 @@ void TextDocumentLine::append(TextDocument& document, const u32* code_points, si
 {
     if (length == 0)
         return;
+    ensure_decoded();
     m_text.append(code_points, length);
     document.update_views({});
 }
@@ -216,6 +266,7 @@ void TextDocumentLine::prepend(TextDocument& document, u32 code_point)
 
 void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_point)
 {
+    ensure_decoded();
     if (index == length()) {
         m_text.append(code_point);
     } else {
@@ -226,6 +277,7 @@ void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_poi
 
 void TextDocumentLine::remove(TextDocument& document, size_t index)
 {
+    ensure_decoded();
     if (index == length()) {
         m_text.take_last();
     } else {
@@ -236,6 +288,7 @@ void TextDocumentLine::remove(TextDocument& document, size_t index)
 
 void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t length)
 {
+    ensure_decoded();
     VERIFY(length <= m_text.size());
 
     Vector<u32> new_data;
@@ -250,6 +303,7 @@ void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t
 
 void TextDocumentLine::truncate(TextDocument& document, size_t length)
 {
+    ensure_decoded();
     m_text.resize(length);
     document.update_views({});
 }
@@ -332,7 +386,10 @@ String TextDocument::text() const
     StringBuilder builder;
     for (size_t i = 0; i < line_count(); ++i) {
         auto& line = this->line(i);
-        builder.append(line.view());
+        if (auto text = line.undecoded_text(); text.has_value())
+            builder.append(*text);
+        else
+            builder.append(line.view());
         if (i != line_count() - 1)
             builder.append('\n');
     }
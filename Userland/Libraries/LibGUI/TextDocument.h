@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/HashTable.h>
+#include <AK/MappedFile.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
@@ -30,6 +32,30 @@ struct TextDocumentSpan {
     bool is_skippable { false };
 };
 
+// The text a document was loaded with. Lines keep pointing into it until they're needed as code points,
+// so that loading a big file only costs what it takes to find the line breaks.
+class TextDocumentBuffer : public RefCounted<TextDocumentBuffer> {
+public:
+    static NonnullRefPtr<TextDocumentBuffer> create(ByteBuffer data) { return adopt_ref(*new TextDocumentBuffer(move(data), nullptr)); }
+    static NonnullRefPtr<TextDocumentBuffer> create(NonnullRefPtr<MappedFile> file) { return adopt_ref(*new TextDocumentBuffer({}, move(file))); }
+
+    ReadonlyBytes bytes() const { return m_file ? m_file->bytes() : m_data.bytes(); }
+    StringView view(size_t offset, size_t length) const { return { bytes().offset_pointer(offset), length }; }
+
+    bool is_mapped() const { return m_file; }
+    void copy_out_of_mapped_file();
+
+private:
+    TextDocumentBuffer(ByteBuffer data, RefPtr<MappedFile> file)
+        : m_data(move(data))
+        , m_file(move(file))
+    {
+    }
+
+    ByteBuffer m_data;
+    RefPtr<MappedFile> m_file;
+};
+
 class TextDocument : public RefCounted<TextDocument> {
 public:
     enum class SearchShouldWrap {
@@ -63,6 +89,10 @@ public:
     void set_spans(Vector<TextDocumentSpan> spans) { m_spans = move(spans); }
 
     bool set_text(const StringView&);
+    // The file has to stay the way it is for as long as the document is reading from it, see unmap_file().
+    bool set_text_from_mapped_file(NonnullRefPtr<MappedFile>);
+    // Copies whatever is still read straight from a mapped file into memory, so that the file can be written to.
+    void unmap_file();
 
     const NonnullOwnPtrVector<TextDocumentLine>& lines() const { return m_lines; }
     NonnullOwnPtrVector<TextDocumentLine>& lines() { return m_lines; }
@@ -132,7 +162,10 @@ protected:
     explicit TextDocument(Client* client);
 
 private:
+    bool set_text_from_buffer(NonnullRefPtr<TextDocumentBuffer>);
+
     NonnullOwnPtrVector<TextDocumentLine> m_lines;
+    RefPtr<TextDocumentBuffer> m_buffer;
     Vector<TextDocumentSpan> m_spans;
 
     HashTable<Client*> m_clients;
@@ -152,12 +185,20 @@ class TextDocumentLine {
 public:
     explicit TextDocumentLine(TextDocument&);
     explicit TextDocumentLine(TextDocument&, const StringView&);
+    // A line that reads its (valid UTF-8) text from the buffer until it's needed as code points.
+    TextDocumentLine(NonnullRefPtr<TextDocumentBuffer>, size_t offset, size_t byte_length, size_t length);
 
     String to_utf8() const;
 
     Utf32View view() const { return { code_points(), length() }; }
-    const u32* code_points() const { return m_text.data(); }
-    size_t length() const { return m_text.size(); }
+    const u32* code_points() const
+    {
+        ensure_decoded();
+        return m_text.data();
+    }
+    size_t length() const { return m_buffer ? m_length : m_text.size(); }
+    // The line's text as UTF-8, if it hasn't been decoded yet.
+    Optional<StringView> undecoded_text() const;
     bool set_text(TextDocument&, const StringView&);
     void set_text(TextDocument&, Vector<u32>);
     void append(TextDocument&, u32);
@@ -177,8 +218,20 @@ public:
     size_t leading_spaces() const;
 
 private:
+    void ensure_decoded() const
+    {
+        if (m_buffer)
+            decode();
+    }
+    void decode() const;
+
     // NOTE: This vector is null terminated.
-    Vector<u32> m_text;
+    mutable Vector<u32> m_text;
+
+    mutable RefPtr<TextDocumentBuffer> m_buffer;
+    size_t m_offset { 0 };
+    size_t m_byte_length { 0 };
+    size_t m_length { 0 };
 };
 
 class TextDocumentUndoCommand : public Command {
@@ -9,6 +9,7 @@
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <AK/TemporaryChange.h>
+#include <AK/Utf8View.h>
 #include <LibCore/Timer.h>
 #include <LibGUI/Action.h>
 #include <LibGUI/AutocompleteProvider.h>
@@ -101,9 +102,19 @@ void TextEditor::create_actions()
 void TextEditor::set_text(const StringView& text)
 {
     m_selection.clear();
-
     document().set_text(text);
+    did_set_text();
+}
+
+void TextEditor::set_text_from_mapped_file(NonnullRefPtr<MappedFile> file)
+{
+    m_selection.clear();
+    document().set_text_from_mapped_file(move(file));
+    did_set_text();
+}
 
+void TextEditor::did_set_text()
+{
     update_content_size();
     recompute_all_visual_lines();
     if (is_single_line())
@@ -1146,6 +1157,9 @@ void TextEditor::timer_event(Core::TimerEvent&)
 
 bool TextEditor::write_to_file(const String& path)
 {
+    // We might be about to overwrite the file the document is reading from.
+    document().unmap_file();
+
     int fd = open(path.characters(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
     if (fd < 0) {
         perror("open");
@@ -1583,6 +1597,8 @@ void TextEditor::recompute_visual_lines(size_t line_index)
 
     if (is_wrapping_enabled())
         visual_data.visual_rect = { m_horizontal_content_padding, 0, available_width, static_cast<int>(visual_data.visual_line_breaks.size()) * line_height() };
+    else if (auto text = line.undecoded_text(); text.has_value())
+        visual_data.visual_rect = { m_horizontal_content_padding, 0, font().width(Utf8View(*text)), line_height() };
     else
         visual_data.visual_rect = { m_horizontal_content_padding, 0, font().width(line.view()), line_height() };
 }
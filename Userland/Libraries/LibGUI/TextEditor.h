@@ -99,6 +99,7 @@ public:
     Function<void()> on_focusout;
 
     void set_text(const StringView&);
+    void set_text_from_mapped_file(NonnullRefPtr<MappedFile>);
     void scroll_cursor_into_view();
     void scroll_position_into_view(const TextPosition&);
     size_t line_count() const { return document().line_count(); }
@@ -278,6 +279,7 @@ private:
     void flush_pending_change_notification_if_needed();
 
     size_t visual_line_containing(size_t line_index, size_t column) const;
+    void did_set_text();
     void recompute_visual_lines(size_t line_index);
 
     void automatic_selection_scroll_timer_fired();
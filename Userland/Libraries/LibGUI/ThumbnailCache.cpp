@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/GenericLexer.h>
+#include <AK/MappedFile.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/File.h>
+#include <LibGUI/ThumbnailCache.h>
+#include <LibGfx/ImageDecoder.h>
+#include <LibGfx/PNGLoader.h>
+#include <LibGfx/PNGWriter.h>
+#include <LibThreading/BackgroundAction.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace GUI {
+
+// A couple of jobs keep both the background thread and the ImageDecoder service busy, without reading
+// lots of files into memory ahead of time.
+static constexpr size_t max_running_job_count = 2;
+
+static constexpr const char* disk_cache_magic = "ThumbnailCache v1";
+
+ThumbnailCache& ThumbnailCache::the()
+{
+    static ThumbnailCache s_the;
+    return s_the;
+}
+
+Optional<RefPtr<Gfx::Bitmap>> ThumbnailCache::cached_thumbnail(const String& path, time_t mtime) const
+{
+    auto it = m_thumbnails.find(path);
+    if (it == m_thumbnails.end() || it->value.mtime != mtime)
+        return {};
+    return it->value.thumbnail;
+}
+
+bool ThumbnailCache::generate_thumbnail(const String& path, time_t mtime, Function<void()> on_complete)
+{
+    if (m_paths_being_generated.contains(path))
+        return false;
+    m_paths_being_generated.set(path);
+    m_queued_jobs.enqueue({ path, mtime, move(on_complete) });
+    start_jobs_if_possible();
+    return true;
+}
+
+void ThumbnailCache::start_jobs_if_possible()
+{
+    while (m_running_job_count < max_running_job_count && !m_queued_jobs.is_empty())
+        start_job(m_queued_jobs.dequeue());
+}
+
+void ThumbnailCache::start_job(Job job)
+{
+    ++m_running_job_count;
+
+    auto path = job.path;
+    auto mtime = job.mtime;
+    Threading::BackgroundAction<BackgroundResult>::create(
+        [path, mtime, disk_cache_directory = m_disk_cache_directory, decodes_in_image_decoder_service = m_decodes_in_image_decoder_service] {
+            return load_or_generate(path, mtime, disk_cache_directory, decodes_in_image_decoder_service);
+        },
+        [this, job = move(job)](auto result) mutable {
+            if (!result.encoded_data.is_valid()) {
+                did_finish_job(move(job), move(result.thumbnail));
+                return;
+            }
+            auto request_id = m_next_request_id++;
+            image_decoder_client().decode_thumbnail(request_id, move(result.encoded_data), { thumbnail_size, thumbnail_size });
+            m_jobs_in_image_decoder.set(request_id, move(job));
+        });
+}
+
+void ThumbnailCache::did_finish_job(Job job, RefPtr<Gfx::Bitmap> thumbnail)
+{
+    m_thumbnails.set(job.path, { job.mtime, move(thumbnail) });
+    m_paths_being_generated.remove(job.path);
+    --m_running_job_count;
+    if (job.on_complete)
+        job.on_complete();
+    start_jobs_if_possible();
+}
+
+static String disk_path_for(const String& disk_cache_directory, const String& path)
+{
+    return String::formatted("{}/{:08x}.thumbnail", disk_cache_directory, path.hash());
+}
+
+// The on-disk format is a small text header followed by the thumbnail as a PNG:
+//
+//     ThumbnailCache v1
+//     <path>
+//     <mtime>
+//     <PNG data>
+static RefPtr<Gfx::Bitmap> load_from_disk(const String& disk_cache_directory, const String& path, time_t mtime)
+{
+    auto file_or_error = Core::File::open(disk_path_for(disk_cache_directory, path), Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return nullptr;
+    auto data = file_or_error.value()->read_all();
+
+    GenericLexer lexer { StringView { data.data(), data.size() } };
+    auto read_line = [&] {
+        auto line = lexer.consume_until('\n');
+        lexer.consume_specific('\n');
+        return line;
+    };
+
+    // The path check protects against hash collisions.
+    if (read_line() != disk_cache_magic || read_line() != path)
+        return nullptr;
+    if (read_line().to_uint<u64>() != (u64)mtime)
+        return nullptr;
+
+    auto png_data = data.bytes().slice(lexer.tell());
+    return Gfx::load_png_from_memory(png_data.data(), png_data.size());
+}
+
+static bool store_on_disk(const String& disk_cache_directory, const String& path, time_t mtime, const Gfx::Bitmap& thumbnail)
+{
+    auto png_data = Gfx::PNGWriter::encode(thumbnail);
+
+    // Other processes may be reading this entry, so write a temporary file and move it into place.
+    auto disk_path = disk_path_for(disk_cache_directory, path);
+    auto temporary_path = String::formatted("{}.{}", disk_path, getpid());
+    auto file_or_error = Core::File::open(temporary_path, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate, 0600);
+    if (file_or_error.is_error()) {
+        dbgln("ThumbnailCache: Failed to open {}: {}", temporary_path, file_or_error.error());
+        return false;
+    }
+    auto& file = *file_or_error.value();
+    auto header = String::formatted("{}\n{}\n{}\n", disk_cache_magic, path, (u64)mtime);
+    if (!file.write(header) || !file.write(png_data.data(), png_data.size())) {
+        dbgln("ThumbnailCache: Failed to write {}: {}", temporary_path, file.error_string());
+        unlink(temporary_path.characters());
+        return false;
+    }
+    file.close();
+
+    if (rename(temporary_path.characters(), disk_path.characters()) < 0) {
+        perror("rename");
+        unlink(temporary_path.characters());
+        return false;
+    }
+    return true;
+}
+
+ThumbnailCache::BackgroundResult ThumbnailCache::load_or_generate(const String& path, time_t mtime, const String& disk_cache_directory, bool decodes_in_image_decoder_service)
+{
+    if (!disk_cache_directory.is_null()) {
+        if (auto thumbnail = load_from_disk(disk_cache_directory, path, mtime))
+            return { move(thumbnail), {} };
+    }
+
+    auto file_or_error = MappedFile::map(path);
+    if (file_or_error.is_error())
+        return {};
+    auto& file = *file_or_error.value();
+
+    if (decodes_in_image_decoder_service) {
+        auto encoded_data = Core::AnonymousBuffer::create_with_size(file.size());
+        if (!encoded_data.is_valid())
+            return {};
+        memcpy(encoded_data.data<void>(), file.data(), file.size());
+        return { nullptr, move(encoded_data) };
+    }
+
+    auto thumbnail = Gfx::ImageDecoder::create((const u8*)file.data(), file.size())->create_thumbnail({ thumbnail_size, thumbnail_size });
+    if (thumbnail && !disk_cache_directory.is_null())
+        store_on_disk(disk_cache_directory, path, mtime, *thumbnail);
+    return { move(thumbnail), {} };
+}
+
+ImageDecoderClient::Client& ThumbnailCache::image_decoder_client()
+{
+    if (m_image_decoder_client)
+        return *m_image_decoder_client;
+
+    m_image_decoder_client = ImageDecoderClient::Client::construct();
+    m_image_decoder_client->on_death = [this] {
+        m_image_decoder_client = nullptr;
+        // Whatever it was working on probably took it down, so give up on all of it.
+        auto jobs = move(m_jobs_in_image_decoder);
+        for (auto& it : jobs)
+            did_finish_job(move(it.value), nullptr);
+    };
+    m_image_decoder_client->on_thumbnail_decoded = [this](i32 request_id, RefPtr<Gfx::Bitmap> thumbnail) {
+        auto it = m_jobs_in_image_decoder.find(request_id);
+        if (it == m_jobs_in_image_decoder.end())
+            return;
+        auto job = move(it->value);
+        m_jobs_in_image_decoder.remove(it);
+
+        if (thumbnail && !m_disk_cache_directory.is_null()) {
+            Threading::BackgroundAction<bool>::create(
+                [disk_cache_directory = m_disk_cache_directory, path = job.path, mtime = job.mtime, thumbnail = thumbnail.release_nonnull()] {
+                    return store_on_disk(disk_cache_directory, path, mtime, thumbnail);
+                });
+        }
+        did_finish_job(move(job), move(thumbnail));
+    };
+    return *m_image_decoder_client;
+}
+
+}
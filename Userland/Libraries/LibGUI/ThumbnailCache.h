@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/Queue.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibImageDecoderClient/Client.h>
+#include <time.h>
+
+namespace GUI {
+
+// Thumbnails of image files, kept in memory and (if the process allows it) on disk, keyed by path and mtime.
+// They're generated in the background, a couple at a time, so a directory full of big images doesn't get
+// decoded all at once.
+class ThumbnailCache {
+public:
+    static constexpr int thumbnail_size = 32;
+
+    static ThumbnailCache& the();
+
+    // NOTE: Both of these are off unless the process asks for them, since they need pledges and unveils
+    //       that not every program showing files has. The disk cache needs "rpath wpath cpath" for the
+    //       directory, and the ImageDecoder service needs "unix sendfd recvfd" and /tmp/portal/image.
+    void set_disk_cache_directory(const String& path) { m_disk_cache_directory = path; }
+    void set_decodes_in_image_decoder_service(bool decodes_in_image_decoder_service) { m_decodes_in_image_decoder_service = decodes_in_image_decoder_service; }
+
+    // The thumbnail for the file as it was at mtime, which is nullptr if it couldn't be decoded.
+    // This is empty if the thumbnail hasn't been generated (yet).
+    Optional<RefPtr<Gfx::Bitmap>> cached_thumbnail(const String& path, time_t mtime) const;
+
+    // Generates the thumbnail in the background and calls on_complete once it's in the cache.
+    // Returns false without doing anything if the thumbnail is already being generated.
+    bool generate_thumbnail(const String& path, time_t mtime, Function<void()> on_complete);
+
+private:
+    ThumbnailCache() = default;
+
+    struct CachedThumbnail {
+        time_t mtime { 0 };
+        RefPtr<Gfx::Bitmap> thumbnail;
+    };
+
+    struct Job {
+        String path;
+        time_t mtime { 0 };
+        Function<void()> on_complete;
+    };
+
+    // What the background thread comes up with: either the thumbnail, or the file's data for the ImageDecoder service.
+    struct BackgroundResult {
+        RefPtr<Gfx::Bitmap> thumbnail;
+        Core::AnonymousBuffer encoded_data;
+    };
+
+    void start_jobs_if_possible();
+    void start_job(Job);
+    void did_finish_job(Job, RefPtr<Gfx::Bitmap>);
+    ImageDecoderClient::Client& image_decoder_client();
+
+    // This runs on the background thread, so it gets everything it needs passed in.
+    static BackgroundResult load_or_generate(const String& path, time_t mtime, const String& disk_cache_directory, bool decodes_in_image_decoder_service);
+
+    HashMap<String, CachedThumbnail> m_thumbnails;
+    HashTable<String> m_paths_being_generated;
+    Queue<Job> m_queued_jobs;
+    size_t m_running_job_count { 0 };
+
+    String m_disk_cache_directory;
+
+    bool m_decodes_in_image_decoder_service { false };
+    RefPtr<ImageDecoderClient::Client> m_image_decoder_client;
+    HashMap<i32, Job> m_jobs_in_image_decoder;
+    i32 m_next_request_id { 0 };
+};
+
+}
@@ -169,6 +169,8 @@ void Window::server_did_destroy()
     m_pending_paint_event_rects.clear();
     m_back_store = nullptr;
     m_front_store = nullptr;
+    m_rects_missing_from_back_store.clear();
+    m_retired_backing_stores.clear();
     m_cursor = Gfx::StandardCursor::None;
 }
 
@@ -240,7 +242,8 @@ void Window::set_rect(const Gfx::IntRect& a_rect)
     }
     auto window_rect = WindowServerConnection::the().set_window_rect(m_window_id, a_rect);
     if (m_back_store && m_back_store->size() != window_rect.size())
-        m_back_store = nullptr;
+        retire_backing_store(m_back_store);
+    // NOTE: WindowServer is still showing the front store, so it can't be reused for painting.
     if (m_front_store && m_front_store->size() != window_rect.size())
         m_front_store = nullptr;
     if (m_main_widget)
@@ -382,7 +385,7 @@ void Window::handle_multi_paint_event(MultiPaintEvent& event)
         // Eagerly discard the backing store if we learn from this paint event that it needs to be bigger.
         // Otherwise we would have to wait for a resize event to tell us. This way we don't waste the
         // effort on painting into an undersized bitmap that will be thrown away anyway.
-        m_back_store = nullptr;
+        retire_backing_store(m_back_store);
     }
     bool created_new_backing_store = !m_back_store;
     if (!m_back_store) {
@@ -397,8 +400,16 @@ void Window::handle_multi_paint_event(MultiPaintEvent& event)
         }
     }
 
+    bool repaint_everything = created_new_backing_store;
+    if (m_double_buffering_enabled) {
+        if (created_new_backing_store)
+            m_rects_missing_from_back_store.clear();
+        else if (!copy_front_store_to_back_store())
+            repaint_everything = true;
+    }
+
     auto rect = rects.first();
-    if (rect.is_empty() || created_new_backing_store) {
+    if (rect.is_empty() || repaint_everything) {
         rects.clear();
         rects.append({ {}, event.window_size() });
     }
@@ -433,7 +444,7 @@ void Window::handle_resize_event(ResizeEvent& event)
 {
     auto new_size = event.size();
     if (m_back_store && m_back_store->size() != new_size)
-        m_back_store = nullptr;
+        retire_backing_store(m_back_store);
     if (!m_pending_paint_event_rects.is_empty()) {
         m_pending_paint_event_rects.clear_with_capacity();
         m_pending_paint_event_rects.append({ {}, new_size });
@@ -756,22 +767,40 @@ void Window::flip(const Vector<Gfx::IntRect, 32>& dirty_rects)
 
     set_current_backing_store(*m_front_store);
 
+    // Whatever was painted has to make it to the back store as well, but that only happens right before
+    // painting into it again. Until then, the back store may well be thrown away (e.g. while resizing),
+    // and then there's no need to copy anything.
     if (!m_back_store || m_back_store->size() != m_front_store->size()) {
+        if (m_back_store)
+            retire_backing_store(m_back_store);
         m_back_store = create_backing_store(m_front_store->size());
         VERIFY(m_back_store);
-        memcpy(m_back_store->bitmap().scanline(0), m_front_store->bitmap().scanline(0), m_front_store->bitmap().size_in_bytes());
-        m_back_store->bitmap().set_volatile();
-        return;
+        m_rects_missing_from_back_store = Gfx::IntRect { {}, m_front_store->size() };
+    } else {
+        for (auto& dirty_rect : dirty_rects)
+            m_rects_missing_from_back_store.add(dirty_rect);
     }
 
-    // Copy whatever was painted from the front to the back.
-    Painter painter(m_back_store->bitmap());
-    for (auto& dirty_rect : dirty_rects)
-        painter.blit(dirty_rect.location(), m_front_store->bitmap(), dirty_rect, 1.0f, false);
-
     m_back_store->bitmap().set_volatile();
 }
 
+bool Window::copy_front_store_to_back_store()
+{
+    if (m_rects_missing_from_back_store.is_empty())
+        return true;
+    auto rects = move(m_rects_missing_from_back_store);
+    m_rects_missing_from_back_store.clear();
+
+    // The front store may have been made volatile in the meantime, and then we can't rely on what's in it.
+    if (!m_front_store || m_front_store->size() != m_back_store->size() || m_front_store->bitmap().is_volatile())
+        return false;
+
+    Painter painter(m_back_store->bitmap());
+    for (auto& rect : rects.rects())
+        painter.blit(rect.location(), m_front_store->bitmap(), rect, 1.0f, false);
+    return true;
+}
+
 OwnPtr<WindowBackingStore> Window::create_backing_store(const Gfx::IntSize& size)
 {
     auto format = m_has_alpha_channel ? Gfx::BitmapFormat::BGRA8888 : Gfx::BitmapFormat::BGRx8888;
@@ -780,10 +809,31 @@ OwnPtr<WindowBackingStore> Window::create_backing_store(const Gfx::IntSize& size
     size_t pitch = Gfx::Bitmap::minimum_pitch(size.width(), format);
     size_t size_in_bytes = size.height() * pitch;
 
-    auto buffer = Core::AnonymousBuffer::create_with_size(round_up_to_power_of_two(size_in_bytes, PAGE_SIZE));
+    // Reuse the buffer of a backing store that was thrown away by a resize, if it's big enough (but not way too big).
+    Core::AnonymousBuffer buffer;
+    for (size_t i = 0; i < m_retired_backing_stores.size(); ++i) {
+        auto& retired_bitmap = m_retired_backing_stores[i]->bitmap();
+        auto capacity = retired_bitmap.anonymous_buffer().size();
+        if (capacity < size_in_bytes || capacity / 4 > size_in_bytes)
+            continue;
+        // What's in it doesn't matter, it just needs to be nonvolatile again.
+        [[maybe_unused]] bool still_has_pixels = retired_bitmap.set_nonvolatile();
+        buffer = retired_bitmap.anonymous_buffer();
+        m_retired_backing_stores.remove(i);
+        break;
+    }
+
     if (!buffer.is_valid()) {
-        perror("anon_create");
-        return {};
+        // If we're in the middle of a resize, leave some room for the window to grow into.
+        size_t capacity = size_in_bytes;
+        if (!m_retired_backing_stores.is_empty())
+            capacity = Gfx::Bitmap::minimum_pitch(size.width() + size.width() / 4, format) * (size.height() + size.height() / 4);
+
+        buffer = Core::AnonymousBuffer::create_with_size(round_up_to_power_of_two(capacity, PAGE_SIZE));
+        if (!buffer.is_valid()) {
+            perror("anon_create");
+            return {};
+        }
     }
 
     // FIXME: Plumb scale factor here eventually.
@@ -796,6 +846,17 @@ OwnPtr<WindowBackingStore> Window::create_backing_store(const Gfx::IntSize& size
     return make<WindowBackingStore>(bitmap.release_nonnull());
 }
 
+void Window::retire_backing_store(OwnPtr<WindowBackingStore>& backing_store)
+{
+    static constexpr size_t max_retired_backing_stores = 2;
+
+    VERIFY(backing_store);
+    backing_store->bitmap().set_volatile();
+    if (m_retired_backing_stores.size() == max_retired_backing_stores)
+        m_retired_backing_stores.take_first();
+    m_retired_backing_stores.append(backing_store.release_nonnull());
+}
+
 void Window::set_modal(bool modal)
 {
     VERIFY(!is_visible());
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <AK/WeakPtr.h>
@@ -15,6 +16,7 @@
 #include <LibGUI/Forward.h>
 #include <LibGUI/WindowType.h>
 #include <LibGfx/Color.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Forward.h>
 #include <LibGfx/Rect.h>
 #include <LibGfx/StandardCursor.h>
@@ -225,8 +227,10 @@ private:
     void server_did_destroy();
 
     OwnPtr<WindowBackingStore> create_backing_store(const Gfx::IntSize&);
+    void retire_backing_store(OwnPtr<WindowBackingStore>&);
     void set_current_backing_store(WindowBackingStore&, bool flush_immediately = false);
     void flip(const Vector<Gfx::IntRect, 32>& dirty_rects);
+    bool copy_front_store_to_back_store();
     void force_update();
 
     WeakPtr<Widget> m_previously_focused_widget;
@@ -234,6 +238,13 @@ private:
     OwnPtr<WindowBackingStore> m_front_store;
     OwnPtr<WindowBackingStore> m_back_store;
 
+    // What was painted into the front store, but hasn't been copied to the back store yet.
+    Gfx::DisjointRectSet m_rects_missing_from_back_store;
+
+    // Backing stores thrown away because the window was resized. They're kept around (volatile),
+    // so the next backing stores can reuse their buffers.
+    Vector<NonnullOwnPtr<WindowBackingStore>, 2> m_retired_backing_stores;
+
     RefPtr<Menubar> m_menubar;
 
     RefPtr<Gfx::Bitmap> m_icon;
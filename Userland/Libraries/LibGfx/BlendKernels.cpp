@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Platform.h>
+#include <AK/SIMD.h>
+#include <LibGfx/BlendKernels.h>
+#include <string.h>
+
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    define HAVE_SSE2_KERNELS
+#    define SSE2_TARGET __attribute__((target("sse2")))
+#endif
+
+namespace Gfx {
+
+ALWAYS_INLINE static RGBA32 apply_source_alpha_map(RGBA32 pixel, const u8* source_alpha_map)
+{
+    if (!source_alpha_map)
+        return pixel;
+    return (pixel & 0x00ffffff) | (source_alpha_map[pixel >> 24] << 24);
+}
+
+ALWAYS_INLINE static RGBA32 blend_pixel(RGBA32 dst, RGBA32 src, bool destination_is_opaque)
+{
+    auto dst_color = destination_is_opaque ? Color::from_rgb(dst) : Color::from_rgba(dst);
+    return dst_color.blend(Color::from_rgba(src)).value();
+}
+
+static void blend_row_scalar(RGBA32* dst, const RGBA32* src, size_t count, const u8* source_alpha_map, bool destination_is_opaque)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], apply_source_alpha_map(src[i], source_alpha_map), destination_is_opaque);
+}
+
+#ifdef HAVE_SSE2_KERNELS
+
+using AK::SIMD::u16x8;
+using AK::SIMD::u8x8;
+
+// Blends two pixels onto two opaque ones. With an opaque destination, Color::blend() boils down to
+// (dst * (255 - alpha) + src * alpha) / 255 for every channel, and the result is opaque as well.
+ALWAYS_INLINE SSE2_TARGET static void blend_two_pixels_onto_opaque(RGBA32* dst, const RGBA32* src)
+{
+    u8x8 dst_bytes;
+    u8x8 src_bytes;
+    memcpy(&dst_bytes, dst, sizeof(dst_bytes));
+    memcpy(&src_bytes, src, sizeof(src_bytes));
+    auto d = __builtin_convertvector(dst_bytes, u16x8);
+    auto s = __builtin_convertvector(src_bytes, u16x8);
+
+    u16x8 alpha = { s[3], s[3], s[3], s[3], s[7], s[7], s[7], s[7] };
+    u16x8 x = d * (255 - alpha) + s * alpha;
+    // This is x / 255 (rounding down) for all x up to 255 * 255.
+    x = (x + 1 + (x >> 8)) >> 8;
+
+    auto result = __builtin_convertvector(x, u8x8);
+    result[3] = 255;
+    result[7] = 255;
+    memcpy(dst, &result, sizeof(result));
+}
+
+SSE2_TARGET static void blend_row_sse2(RGBA32* dst, const RGBA32* src, size_t count, const u8* source_alpha_map, bool destination_is_opaque)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        RGBA32 source_pixels[4];
+        for (size_t j = 0; j < 4; ++j)
+            source_pixels[j] = apply_source_alpha_map(src[i + j], source_alpha_map);
+
+        if (!destination_is_opaque && (dst[i] & dst[i + 1] & dst[i + 2] & dst[i + 3]) < 0xff000000) {
+            for (size_t j = 0; j < 4; ++j)
+                dst[i + j] = blend_pixel(dst[i + j], source_pixels[j], false);
+            continue;
+        }
+
+        auto all_alpha = source_pixels[0] & source_pixels[1] & source_pixels[2] & source_pixels[3];
+        auto any_alpha = source_pixels[0] | source_pixels[1] | source_pixels[2] | source_pixels[3];
+        if (all_alpha >= 0xff000000) {
+            memcpy(dst + i, source_pixels, sizeof(source_pixels));
+        } else if (any_alpha < 0x01000000) {
+            for (size_t j = 0; j < 4; ++j)
+                dst[i + j] |= 0xff000000;
+        } else {
+            blend_two_pixels_onto_opaque(dst + i, source_pixels);
+            blend_two_pixels_onto_opaque(dst + i + 2, source_pixels + 2);
+        }
+    }
+    blend_row_scalar(dst + i, src + i, count - i, source_alpha_map, destination_is_opaque);
+}
+
+static bool cpu_has_sse2()
+{
+#    if ARCH(X86_64)
+    return true;
+#    else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return edx & bit_SSE2;
+#    endif
+}
+
+#endif
+
+using BlendRowFunction = void (*)(RGBA32*, const RGBA32*, size_t, const u8*, bool);
+
+static BlendRowFunction blend_row_function()
+{
+    static BlendRowFunction s_function;
+    if (!s_function) {
+        s_function = blend_row_scalar;
+#ifdef HAVE_SSE2_KERNELS
+        if (cpu_has_sse2())
+            s_function = blend_row_sse2;
+#endif
+    }
+    return s_function;
+}
+
+void blend_row(RGBA32* dst, const RGBA32* src, size_t count, const u8* source_alpha_map, bool destination_is_opaque)
+{
+    blend_row_function()(dst, src, count, source_alpha_map, destination_is_opaque);
+}
+
+void blend_color_onto_row(RGBA32* dst, size_t count, Color color)
+{
+    static constexpr size_t chunk_size = 64;
+    RGBA32 source[chunk_size];
+    for (size_t i = 0; i < min(count, chunk_size); ++i)
+        source[i] = color.value();
+
+    auto function = blend_row_function();
+    for (size_t i = 0; i < count; i += chunk_size)
+        function(dst + i, source, min(chunk_size, count - i), nullptr, false);
+}
+
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <LibGfx/Color.h>
+
+namespace Gfx {
+
+// Row kernels for the blending loops in Painter. The results are exactly what calling Color::blend() for every pixel
+// would give. Blocks of pixels on top of an opaque destination go through SSE2 when the CPU has it (picked at runtime,
+// since i686 userland isn't built for SSE2), and everything else goes through Color::blend() as before.
+
+// dst[i] = dst[i].blend(color)
+void blend_color_onto_row(RGBA32* dst, size_t count, Color color);
+
+// dst[i] = dst[i].blend(src[i]), where the alpha of every source pixel is first looked up in source_alpha_map
+// (if there is one), and the destination alpha is taken to be 255 if destination_is_opaque is set.
+void blend_row(RGBA32* dst, const RGBA32* src, size_t count, const u8* source_alpha_map, bool destination_is_opaque);
+
+}
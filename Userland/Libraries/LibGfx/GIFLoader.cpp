@@ -75,6 +75,7 @@ struct GIFLoadingContext {
     ErrorState error_state { NoError };
     const u8* data { nullptr };
     size_t data_size { 0 };
+    bool data_is_partial { false };
     LogicalScreen logical_screen {};
     u8 background_color_index { 0 };
     NonnullOwnPtrVector<GIFImageDescriptor> images {};
@@ -401,7 +402,7 @@ static bool decode_frame(GIFLoadingContext& context, size_t frame_index)
     return true;
 }
 
-static bool load_gif_frame_descriptors(GIFLoadingContext& context)
+static bool load_gif_frame_descriptors_impl(GIFLoadingContext& context, size_t& complete_image_count)
 {
     if (context.data_size < 32)
         return false;
@@ -600,6 +601,7 @@ static bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 }
             }
 
+            complete_image_count = context.images.size();
             current_image = make<GIFImageDescriptor>();
             continue;
         }
@@ -611,6 +613,19 @@ static bool load_gif_frame_descriptors(GIFLoadingContext& context)
         return false;
     }
 
+    return true;
+}
+
+static bool load_gif_frame_descriptors(GIFLoadingContext& context)
+{
+    size_t complete_image_count = 0;
+    if (!load_gif_frame_descriptors_impl(context, complete_image_count)) {
+        // Partial data runs out somewhere, so make do with the frames that arrived in full.
+        if (!context.data_is_partial || complete_image_count == 0)
+            return false;
+        context.images.shrink(complete_image_count);
+    }
+
     context.state = GIFLoadingContext::State::FrameDescriptorsLoaded;
     return true;
 }
@@ -663,6 +678,12 @@ bool GIFImageDecoderPlugin::set_nonvolatile()
     return m_context->frame_buffer->set_nonvolatile();
 }
 
+bool GIFImageDecoderPlugin::set_data_is_partial()
+{
+    m_context->data_is_partial = true;
+    return true;
+}
+
 bool GIFImageDecoderPlugin::sniff()
 {
     InputMemoryStream stream { { m_context->data, m_context->data_size } };
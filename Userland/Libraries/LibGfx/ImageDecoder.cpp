@@ -13,10 +13,23 @@
 #include <LibGfx/PBMLoader.h>
 #include <LibGfx/PGMLoader.h>
 #include <LibGfx/PNGLoader.h>
+#include <LibGfx/Painter.h>
 #include <LibGfx/PPMLoader.h>
 
 namespace Gfx {
 
+static bool s_may_decode_in_parallel = false;
+
+void ImageDecoder::set_may_decode_in_parallel(bool may_decode_in_parallel)
+{
+    s_may_decode_in_parallel = may_decode_in_parallel;
+}
+
+bool ImageDecoder::may_decode_in_parallel()
+{
+    return s_may_decode_in_parallel;
+}
+
 ImageDecoder::ImageDecoder(const u8* data, size_t size)
 {
     m_plugin = make<PNGImageDecoderPlugin>(data, size);
@@ -58,15 +71,44 @@ ImageDecoder::ImageDecoder(const u8* data, size_t size)
     m_plugin = nullptr;
 }
 
+NonnullRefPtr<ImageDecoder> ImageDecoder::create_for_partial_data(const u8* data, size_t size)
+{
+    auto decoder = adopt_ref(*new ImageDecoder(data, size));
+    decoder->m_data_is_partial = true;
+    if (decoder->m_plugin)
+        decoder->m_plugin_supports_partial_data = decoder->m_plugin->set_data_is_partial();
+    return decoder;
+}
+
 ImageDecoder::~ImageDecoder()
 {
 }
 
 RefPtr<Gfx::Bitmap> ImageDecoder::bitmap() const
 {
-    if (!m_plugin)
+    if (!can_decode())
         return nullptr;
     return m_plugin->bitmap();
 }
 
+RefPtr<Gfx::Bitmap> ImageDecoder::create_thumbnail(IntSize thumbnail_size)
+{
+    set_ideal_size(thumbnail_size);
+    auto bitmap = this->bitmap();
+    if (!bitmap)
+        return nullptr;
+
+    auto thumbnail = Bitmap::create(BitmapFormat::BGRA8888, thumbnail_size);
+    if (!thumbnail)
+        return nullptr;
+
+    double scale = min(thumbnail_size.width() / (double)bitmap->width(), thumbnail_size.height() / (double)bitmap->height());
+    IntRect destination { 0, 0, (int)(bitmap->width() * scale), (int)(bitmap->height() * scale) };
+    destination.center_within(thumbnail->rect());
+
+    Painter painter(*thumbnail);
+    painter.draw_scaled_bitmap(destination, *bitmap, bitmap->rect());
+    return thumbnail;
+}
+
 }
@@ -37,6 +37,17 @@ public:
 
     virtual bool sniff() = 0;
 
+    // Called before anything is decoded, when the data is only the beginning of the file because the rest hasn't
+    // arrived yet. Plugins that return true make the best of it: bitmap() and frame() give whatever part of the
+    // image could be decoded, with the rest left transparent (or missing, for frames). Others aren't asked to
+    // decode anything until all the data is there.
+    virtual bool set_data_is_partial() { return false; }
+
+    // Called before anything is decoded, when the image will never be shown larger than this. Plugins that can
+    // skip work for smaller images may then decode to a bitmap smaller than size(), but never smaller than this
+    // (or size(), if that is smaller) in either dimension.
+    virtual void set_ideal_size(IntSize) { }
+
     virtual bool is_animated() = 0;
     virtual size_t loop_count() = 0;
     virtual size_t frame_count() = 0;
@@ -50,14 +61,33 @@ class ImageDecoder : public RefCounted<ImageDecoder> {
 public:
     static NonnullRefPtr<ImageDecoder> create(const u8* data, size_t size) { return adopt_ref(*new ImageDecoder(data, size)); }
     static NonnullRefPtr<ImageDecoder> create(const ByteBuffer& data) { return adopt_ref(*new ImageDecoder(data.data(), data.size())); }
+    // For data that stops short of the end of the file. See ImageDecoderPlugin::set_data_is_partial().
+    static NonnullRefPtr<ImageDecoder> create_for_partial_data(const u8* data, size_t size);
     ~ImageDecoder();
 
+    // Lets decoders spread their work across Threading::ThreadPool::the().
+    // NOTE: This is off unless the process asks for it, since it needs the "thread" pledge.
+    static void set_may_decode_in_parallel(bool);
+    static bool may_decode_in_parallel();
+
     bool is_valid() const { return m_plugin; }
 
+    // This is false for partial data when the plugin can only decode complete files.
+    bool can_decode() const { return m_plugin && (!m_data_is_partial || m_plugin_supports_partial_data); }
+
+    // NOTE: Once this is set, bitmap() and frame() may be smaller than size(). See ImageDecoderPlugin::set_ideal_size().
+    void set_ideal_size(IntSize ideal_size)
+    {
+        if (m_plugin)
+            m_plugin->set_ideal_size(ideal_size);
+    }
+
     IntSize size() const { return m_plugin ? m_plugin->size() : IntSize(); }
     int width() const { return size().width(); }
     int height() const { return size().height(); }
     RefPtr<Gfx::Bitmap> bitmap() const;
+    // The image scaled to fit in a transparent bitmap of the given size, and centered in it.
+    RefPtr<Gfx::Bitmap> create_thumbnail(IntSize);
     void set_volatile()
     {
         if (m_plugin)
@@ -68,12 +98,14 @@ public:
     bool is_animated() const { return m_plugin ? m_plugin->is_animated() : false; }
     size_t loop_count() const { return m_plugin ? m_plugin->loop_count() : 0; }
     size_t frame_count() const { return m_plugin ? m_plugin->frame_count() : 0; }
-    ImageFrameDescriptor frame(size_t i) const { return m_plugin ? m_plugin->frame(i) : ImageFrameDescriptor(); }
+    ImageFrameDescriptor frame(size_t i) const { return can_decode() ? m_plugin->frame(i) : ImageFrameDescriptor(); }
 
 private:
     ImageDecoder(const u8*, size_t);
 
     mutable OwnPtr<ImageDecoderPlugin> m_plugin;
+    bool m_data_is_partial { false };
+    bool m_plugin_supports_partial_data { false };
 };
 
 }
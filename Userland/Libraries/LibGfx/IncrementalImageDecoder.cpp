@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/IncrementalImageDecoder.h>
+
+namespace Gfx {
+
+void IncrementalImageDecoder::append(ReadonlyBytes bytes)
+{
+    VERIFY(!m_is_finished);
+    if (bytes.is_empty())
+        return;
+    m_data.append(bytes.data(), bytes.size());
+    m_decoder = nullptr;
+}
+
+void IncrementalImageDecoder::finish()
+{
+    m_is_finished = true;
+    m_decoder = nullptr;
+}
+
+void IncrementalImageDecoder::set_ideal_size(IntSize ideal_size)
+{
+    m_ideal_size = ideal_size;
+    m_decoder = nullptr;
+}
+
+ImageDecoder* IncrementalImageDecoder::decoder()
+{
+    if (!m_decoder) {
+        if (m_is_finished)
+            m_decoder = ImageDecoder::create(m_data);
+        else
+            m_decoder = ImageDecoder::create_for_partial_data(m_data.data(), m_data.size());
+        if (!m_ideal_size.is_empty())
+            m_decoder->set_ideal_size(m_ideal_size);
+    }
+    if (!m_decoder->is_valid())
+        return nullptr;
+    return m_decoder;
+}
+
+bool IncrementalImageDecoder::has_new_bitmap() const
+{
+    if (m_is_finished)
+        return !m_did_decode_finished_data;
+    // Growing by a quarter each time keeps the total work within a few times that of a single decode.
+    return m_data.size() >= m_data_size_at_last_decode + max(m_data_size_at_last_decode / 4, 4 * KiB);
+}
+
+RefPtr<Bitmap> IncrementalImageDecoder::bitmap()
+{
+    if (!has_new_bitmap())
+        return m_bitmap;
+
+    auto* decoder = this->decoder();
+    if (!decoder || !decoder->can_decode())
+        return m_bitmap;
+
+    m_data_size_at_last_decode = m_data.size();
+    m_did_decode_finished_data = m_is_finished;
+    auto bitmap = decoder->bitmap();
+    // A failed decode of partial data usually just means there isn't enough of it yet.
+    if (bitmap || m_is_finished)
+        m_bitmap = move(bitmap);
+    return m_bitmap;
+}
+
+}
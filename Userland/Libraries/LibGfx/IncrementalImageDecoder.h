@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <LibGfx/ImageDecoder.h>
+
+namespace Gfx {
+
+// Decodes an image whose data arrives a piece at a time. Until finish() is called, bitmap() is whatever part of
+// the image the format allows decoding early: the top rows of a PNG or a baseline JPEG, a coarse version of an
+// interlaced PNG, or the frames of a GIF that have arrived in full.
+class IncrementalImageDecoder : public RefCounted<IncrementalImageDecoder> {
+public:
+    static NonnullRefPtr<IncrementalImageDecoder> create() { return adopt_ref(*new IncrementalImageDecoder); }
+
+    void append(ReadonlyBytes);
+    void finish();
+    bool is_finished() const { return m_is_finished; }
+
+    void set_ideal_size(IntSize);
+
+    // The decoder for the data that has arrived so far, or nullptr if it's not a format we know (yet).
+    // NOTE: Decoders point into the data, so this one is only good until the next append().
+    ImageDecoder* decoder();
+
+    // Decoding everything again for every little piece of data would make this quadratic, so before finish(),
+    // this only decodes again once the data has grown by a good amount. has_new_bitmap() says whether it would.
+    bool has_new_bitmap() const;
+    RefPtr<Bitmap> bitmap();
+
+private:
+    IncrementalImageDecoder() = default;
+
+    ByteBuffer m_data;
+    bool m_is_finished { false };
+    IntSize m_ideal_size;
+    RefPtr<ImageDecoder> m_decoder;
+    RefPtr<Bitmap> m_bitmap;
+    size_t m_data_size_at_last_decode { 0 };
+    bool m_did_decode_finished_data { false };
+};
+
+}
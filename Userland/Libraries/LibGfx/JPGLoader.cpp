@@ -11,11 +11,14 @@
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/JPGLoader.h>
+#include <LibThreading/Parallel.h>
 #include <math.h>
+#include <string.h>
 
 #define JPG_INVALID 0X0000
 
@@ -155,18 +158,32 @@ struct StartOfFrame {
     u16 width { 0 };
 };
 
+// Codes up to this many bits long are decoded with a single lookup into HuffmanTableSpec::lookup.
+static constexpr u8 huffman_lookup_bits = 9;
+
 struct HuffmanTableSpec {
     u8 type { 0 };
     u8 destination_id { 0 };
     u8 code_counts[16] = { 0 };
     Vector<u8> symbols;
     Vector<u16> codes;
+    // Indexed by the next huffman_lookup_bits bits of the stream. The low byte of an entry is the symbol, and the
+    // high byte is the length of its code, or 0 if the code is longer than huffman_lookup_bits.
+    u16 lookup[1 << huffman_lookup_bits] = { 0 };
 };
 
+// Where we are in the entropy-coded data of one restart interval.
 struct HuffmanStreamState {
-    Vector<u8> stream;
+    ReadonlyBytes stream;
     u8 bit_offset { 0 };
     size_t byte_offset { 0 };
+    i32 previous_dc_values[3] = { 0 };
+};
+
+struct RestartInterval {
+    u32 first_mcu { 0 };
+    u32 mcu_count { 0 };
+    size_t stream_offset { 0 };
 };
 
 struct JPGLoadingContext {
@@ -180,6 +197,12 @@ struct JPGLoadingContext {
     State state { State::NotDecoded };
     const u8* data { nullptr };
     size_t data_size { 0 };
+    bool data_is_partial { false };
+    IntSize ideal_size;
+    // Either 1 or 8. At 8, every block becomes a single pixel, and only the DC coefficients are needed for that.
+    u8 scale_denominator { 1 };
+    // With partial data, the MCUs after these are missing.
+    u32 decoded_mcu_count { 0 };
     u32 luma_table[64] = { 0 };
     u32 chroma_table[64] = { 0 };
     StartOfFrame frame;
@@ -191,47 +214,89 @@ struct JPGLoadingContext {
     u16 dc_reset_interval { 0 };
     HashMap<u8, HuffmanTableSpec> dc_tables;
     HashMap<u8, HuffmanTableSpec> ac_tables;
-    HuffmanStreamState huffman_stream;
-    i32 previous_dc_values[3] = { 0 };
+    // The entropy-coded data with the byte stuffing and the restart markers taken out.
+    Vector<u8> huffman_stream;
+    // Where every restart interval but the first one starts in huffman_stream.
+    Vector<size_t> restart_interval_offsets;
     MacroblockMeta mblock_meta;
 };
 
 static void generate_huffman_codes(HuffmanTableSpec& table)
 {
     unsigned code = 0;
-    for (auto number_of_codes : table.code_counts) {
-        for (int i = 0; i < number_of_codes; i++)
-            table.codes.append(code++);
+    size_t code_cursor = 0;
+    for (u8 code_length = 1; code_length <= 16; code_length++) {
+        for (int i = 0; i < table.code_counts[code_length - 1]; i++) {
+            table.codes.append(code);
+
+            // Whatever bits come after a short code, they still decode to its symbol.
+            if (code_length <= huffman_lookup_bits && code_cursor < table.symbols.size()) {
+                u32 unused_bits = huffman_lookup_bits - code_length;
+                u32 first_index = code << unused_bits;
+                u32 last_index = min((code + 1) << unused_bits, (u32)array_size(table.lookup));
+                for (u32 index = first_index; index < last_index; index++)
+                    table.lookup[index] = (code_length << 8) | table.symbols[code_cursor];
+            }
+
+            code++;
+            code_cursor++;
+        }
         code <<= 1;
     }
 }
 
+static size_t huffman_bits_left(const HuffmanStreamState& hstream)
+{
+    if (hstream.byte_offset >= hstream.stream.size())
+        return 0;
+    return (hstream.stream.size() - hstream.byte_offset) * 8 - hstream.bit_offset;
+}
+
+// Returns the next count (at most 16) bits of the stream, MSB first, as if the stream was followed by zeroes.
+static u32 peek_huffman_bits(const HuffmanStreamState& hstream, size_t count)
+{
+    u32 window = 0;
+    for (size_t i = 0; i < 3; i++) {
+        size_t offset = hstream.byte_offset + i;
+        window = (window << 8) | (offset < hstream.stream.size() ? hstream.stream[offset] : 0);
+    }
+    return (window >> (24 - hstream.bit_offset - count)) & ((1u << count) - 1);
+}
+
+static void skip_huffman_bits(HuffmanStreamState& hstream, size_t count)
+{
+    size_t bit_offset = hstream.bit_offset + count;
+    hstream.byte_offset += bit_offset / 8;
+    hstream.bit_offset = bit_offset % 8;
+}
+
 static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t count = 1)
 {
-    if (count > (8 * sizeof(size_t))) {
+    if (count > 16) {
         dbgln_if(JPG_DEBUG, "Can't read {} bits at once!", count);
         return {};
     }
-    size_t value = 0;
-    while (count--) {
-        if (hstream.byte_offset >= hstream.stream.size()) {
-            dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
-            return {};
-        }
-        u8 current_byte = hstream.stream[hstream.byte_offset];
-        u8 current_bit = 1u & (u32)(current_byte >> (7 - hstream.bit_offset)); // MSB first.
-        hstream.bit_offset++;
-        value = (value << 1) | (size_t)current_bit;
-        if (hstream.bit_offset == 8) {
-            hstream.byte_offset++;
-            hstream.bit_offset = 0;
-        }
+    if (count == 0)
+        return 0;
+    if (huffman_bits_left(hstream) < count) {
+        dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
+        return {};
     }
+    auto value = peek_huffman_bits(hstream, count);
+    skip_huffman_bits(hstream, count);
     return value;
 }
 
 static Optional<u8> get_next_symbol(HuffmanStreamState& hstream, const HuffmanTableSpec& table)
 {
+    auto entry = table.lookup[peek_huffman_bits(hstream, huffman_lookup_bits)];
+    size_t code_length = entry >> 8;
+    if (code_length != 0 && code_length <= huffman_bits_left(hstream)) {
+        skip_huffman_bits(hstream, code_length);
+        return entry & 0xFF;
+    }
+
+    // The code is too long for the lookup table, so go through the codes one bit at a time.
     unsigned code = 0;
     size_t code_cursor = 0;
     for (int i = 0; i < 16; i++) { // Codes can't be longer than 16 bits.
@@ -277,7 +342,7 @@ static inline i32* get_component(Macroblock& block, unsigned component)
  * macroblocks that share the chrominance data. Next two iterations (assuming that
  * we are dealing with three components) will fill up the blocks with chroma data.
  */
-static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+static bool build_macroblocks(const JPGLoadingContext& context, HuffmanStreamState& hstream, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
 {
     for (unsigned component_i = 0; component_i < context.component_count; component_i++) {
         auto& component = context.components[component_i];
@@ -295,7 +360,7 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                 auto& dc_table = context.dc_tables.find(component.dc_destination_id)->value;
                 auto& ac_table = context.ac_tables.find(component.ac_destination_id)->value;
 
-                auto symbol_or_error = get_next_symbol(context.huffman_stream, dc_table);
+                auto symbol_or_error = get_next_symbol(hstream, dc_table);
                 if (!symbol_or_error.has_value())
                     return false;
 
@@ -306,7 +371,7 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                     return false;
                 }
 
-                auto coeff_or_error = read_huffman_bits(context.huffman_stream, dc_length);
+                auto coeff_or_error = read_huffman_bits(hstream, dc_length);
                 if (!coeff_or_error.has_value())
                     return false;
 
@@ -318,12 +383,12 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                     dc_diff -= (1 << dc_length) - 1;
 
                 auto select_component = get_component(block, component_i);
-                auto& previous_dc = context.previous_dc_values[component_i];
+                auto& previous_dc = hstream.previous_dc_values[component_i];
                 select_component[0] = previous_dc += dc_diff;
 
                 // Compute the AC coefficients.
                 for (int j = 1; j < 64;) {
-                    symbol_or_error = get_next_symbol(context.huffman_stream, ac_table);
+                    symbol_or_error = get_next_symbol(hstream, ac_table);
                     if (!symbol_or_error.has_value())
                         return false;
 
@@ -350,7 +415,7 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                     }
 
                     if (coeff_length != 0) {
-                        coeff_or_error = read_huffman_bits(context.huffman_stream, coeff_length);
+                        coeff_or_error = read_huffman_bits(hstream, coeff_length);
                         if (!coeff_or_error.has_value())
                             return false;
                         i32 ac_coefficient = coeff_or_error.release_value();
@@ -367,63 +432,6 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
     return true;
 }
 
-static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
-{
-    Vector<Macroblock> macroblocks;
-    macroblocks.resize(context.mblock_meta.padded_total);
-
-    if constexpr (JPG_DEBUG) {
-        dbgln("Image width: {}", context.frame.width);
-        dbgln("Image height: {}", context.frame.height);
-        dbgln("Macroblocks in a row: {}", context.mblock_meta.hpadded_count);
-        dbgln("Macroblocks in a column: {}", context.mblock_meta.vpadded_count);
-        dbgln("Macroblock meta padded total: {}", context.mblock_meta.padded_total);
-    }
-
-    // Compute huffman codes for DC and AC tables.
-    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it)
-        generate_huffman_codes(it->value);
-
-    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
-        generate_huffman_codes(it->value);
-
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
-                    context.previous_dc_values[0] = 0;
-                    context.previous_dc_values[1] = 0;
-                    context.previous_dc_values[2] = 0;
-
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
-                        if (context.huffman_stream.bit_offset > 0) {
-                            context.huffman_stream.bit_offset = 0;
-                            context.huffman_stream.byte_offset++;
-                        }
-
-                        // Skip the restart marker (RSTn).
-                        context.huffman_stream.byte_offset++;
-                    }
-                }
-            }
-
-            if (!build_macroblocks(context, macroblocks, hcursor, vcursor)) {
-                if constexpr (JPG_DEBUG) {
-                    dbgln("Failed to build Macroblock {}", i);
-                    dbgln("Huffman stream byte offset {}", context.huffman_stream.byte_offset);
-                    dbgln("Huffman stream bit offset {}", context.huffman_stream.bit_offset);
-                }
-                return {};
-            }
-        }
-    }
-
-    return macroblocks;
-}
-
 static inline bool bounds_okay(const size_t cursor, const size_t delta, const size_t bound)
 {
     return (delta + cursor) < bound;
@@ -841,243 +849,354 @@ static bool skip_marker_with_length(InputMemoryStream& stream)
     return !stream.handle_any_error();
 }
 
-static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static void dequantize(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 i = 0; i < context.component_count; i++) {
-                auto& component = context.components[i];
-                const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
-                for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        int* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
+    for (u32 i = 0; i < context.component_count; i++) {
+        auto& component = context.components[i];
+        const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
+        for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                Macroblock& block = macroblocks[mb_index];
+                int* block_component = get_component(block, i);
+                for (u32 k = 0; k < 64; k++)
+                    block_component[k] *= table[k];
             }
         }
     }
 }
 
-static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+using AK::SIMD::i32x4;
+
+ALWAYS_INLINE static i32x4 load_i32x4(const i32* data)
 {
-    static const float m0 = 2.0 * cos(1.0 / 16.0 * 2.0 * M_PI);
-    static const float m1 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m3 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
-    static const float m5 = 2.0 * cos(3.0 / 16.0 * 2.0 * M_PI);
-    static const float m2 = m0 - m5;
-    static const float m4 = m0 + m5;
-    static const float s0 = cos(0.0 / 16.0 * M_PI) / sqrt(8);
-    static const float s1 = cos(1.0 / 16.0 * M_PI) / 2.0;
-    static const float s2 = cos(2.0 / 16.0 * M_PI) / 2.0;
-    static const float s3 = cos(3.0 / 16.0 * M_PI) / 2.0;
-    static const float s4 = cos(4.0 / 16.0 * M_PI) / 2.0;
-    static const float s5 = cos(5.0 / 16.0 * M_PI) / 2.0;
-    static const float s6 = cos(6.0 / 16.0 * M_PI) / 2.0;
-    static const float s7 = cos(7.0 / 16.0 * M_PI) / 2.0;
-
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 component_i = 0; component_i < context.component_count; component_i++) {
-                auto& component = context.components[component_i];
-                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        i32* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
-                    }
-                }
+    i32x4 vector;
+    memcpy(&vector, data, sizeof(vector));
+    return vector;
+}
+
+ALWAYS_INLINE static void store_i32x4(i32* data, i32x4 vector)
+{
+    memcpy(data, &vector, sizeof(vector));
+}
+
+static constexpr int idct_constant_bits = 13;
+static constexpr int idct_pass1_bits = 2;
+
+// One pass of the integer IDCT from the IJG's jidctint.c, which is within one level of the exact result.
+// Every lane of the vectors is a column (or row) of its own, so four of them are transformed at once.
+ALWAYS_INLINE static void inverse_dct_8(i32x4 (&data)[8], int descale_bits)
+{
+    // Even part.
+    auto z2 = data[2];
+    auto z3 = data[6];
+    auto z1 = (z2 + z3) * 4433;
+    auto tmp2 = z1 + z3 * -15137;
+    auto tmp3 = z1 + z2 * 6270;
+
+    auto tmp0 = (data[0] + data[4]) * (1 << idct_constant_bits);
+    auto tmp1 = (data[0] - data[4]) * (1 << idct_constant_bits);
+
+    auto tmp10 = tmp0 + tmp3;
+    auto tmp13 = tmp0 - tmp3;
+    auto tmp11 = tmp1 + tmp2;
+    auto tmp12 = tmp1 - tmp2;
+
+    // Odd part.
+    tmp0 = data[7];
+    tmp1 = data[5];
+    tmp2 = data[3];
+    tmp3 = data[1];
+
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    auto z4 = tmp1 + tmp3;
+    auto z5 = (z3 + z4) * 9633;
+
+    tmp0 = tmp0 * 2446;
+    tmp1 = tmp1 * 16819;
+    tmp2 = tmp2 * 25172;
+    tmp3 = tmp3 * 12299;
+    z1 = z1 * -7373;
+    z2 = z2 * -20995;
+    z3 = z3 * -16069 + z5;
+    z4 = z4 * -3196 + z5;
+
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    i32 rounding = 1 << (descale_bits - 1);
+    data[0] = (tmp10 + tmp3 + rounding) >> descale_bits;
+    data[7] = (tmp10 - tmp3 + rounding) >> descale_bits;
+    data[1] = (tmp11 + tmp2 + rounding) >> descale_bits;
+    data[6] = (tmp11 - tmp2 + rounding) >> descale_bits;
+    data[2] = (tmp12 + tmp1 + rounding) >> descale_bits;
+    data[5] = (tmp12 - tmp1 + rounding) >> descale_bits;
+    data[3] = (tmp13 + tmp0 + rounding) >> descale_bits;
+    data[4] = (tmp13 - tmp0 + rounding) >> descale_bits;
+}
+
+static void inverse_dct_block(i32* block)
+{
+    // The columns go first. Their results are stored transposed, so the rows can be loaded the same way afterwards.
+    i32 workspace[64];
+    for (u32 column = 0; column < 8; column += 4) {
+        i32x4 data[8];
+        for (u32 row = 0; row < 8; row++)
+            data[row] = load_i32x4(&block[row * 8 + column]);
+        inverse_dct_8(data, idct_constant_bits - idct_pass1_bits);
+        for (u32 row = 0; row < 8; row++) {
+            for (u32 i = 0; i < 4; i++)
+                workspace[(column + i) * 8 + row] = data[row][i];
+        }
+    }
+
+    // The extra 3 bits are the 1/8 that the 2-D IDCT is scaled by.
+    for (u32 row = 0; row < 8; row += 4) {
+        i32x4 data[8];
+        for (u32 column = 0; column < 8; column++)
+            data[column] = load_i32x4(&workspace[column * 8 + row]);
+        inverse_dct_8(data, idct_constant_bits + idct_pass1_bits + 3);
+        for (u32 column = 0; column < 8; column++) {
+            for (u32 i = 0; i < 4; i++)
+                block[(row + i) * 8 + column] = data[column][i];
+        }
+    }
+}
+
+static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+{
+    for (u32 component_i = 0; component_i < context.component_count; component_i++) {
+        auto& component = context.components[component_i];
+        for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                Macroblock& block = macroblocks[mb_index];
+                inverse_dct_block(get_component(block, component_i));
             }
         }
     }
 }
 
-static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+ALWAYS_INLINE static i32x4 clamp_to_u8(i32x4 value)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            const Macroblock& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
-                        }
-                    }
+    // Comparisons give all ones in the lanes where they hold, and zeroes elsewhere.
+    const i32x4 zero = { 0, 0, 0, 0 };
+    const i32x4 max = { 255, 255, 255, 255 };
+    value &= ~(value < zero);
+    auto too_large = value > max;
+    return (value & ~too_large) | (max & too_large);
+}
+
+static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+{
+    // Fixed-point versions of the JFIF conversion factors, with 16 fractional bits.
+    static constexpr i32 cr_to_r = 91881;
+    static constexpr i32 cb_to_g = -22554;
+    static constexpr i32 cr_to_g = -46802;
+    static constexpr i32 cb_to_b = 116130;
+    static constexpr i32 rounding = 1 << 15;
+
+    const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
+    const Macroblock& chroma = macroblocks[chroma_block_index];
+    // Overflows are intentional. The chroma block is converted last, and every row of it before the
+    // rows that it holds the chroma of, so that its chroma data is only overwritten once it's no longer needed.
+    for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
+        for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
+            u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
+            i32* y = macroblocks[mb_index].y;
+            i32* cb = macroblocks[mb_index].cb;
+            i32* cr = macroblocks[mb_index].cr;
+            u32 chroma_pxcols[8];
+            for (u8 j = 0; j < 8; j++)
+                chroma_pxcols[j] = (j / context.hsample_factor) + 4 * hfactor_i;
+            for (u8 i = 7; i < 8; --i) {
+                const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
+                i32 row_cb[8];
+                i32 row_cr[8];
+                for (u8 j = 0; j < 8; j++) {
+                    const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcols[j];
+                    row_cb[j] = chroma.cb[chroma_pixel];
+                    row_cr[j] = chroma.cr[chroma_pixel];
                 }
+                for (u8 j = 0; j < 8; j += 4) {
+                    const u8 pixel = i * 8 + j;
+                    auto luma = load_i32x4(&y[pixel]) + 128;
+                    auto blue_difference = load_i32x4(&row_cb[j]);
+                    auto red_difference = load_i32x4(&row_cr[j]);
+                    auto r = luma + ((red_difference * cr_to_r + rounding) >> 16);
+                    auto g = luma + ((blue_difference * cb_to_g + red_difference * cr_to_g + rounding) >> 16);
+                    auto b = luma + ((blue_difference * cb_to_b + rounding) >> 16);
+                    store_i32x4(&y[pixel], clamp_to_u8(r));
+                    store_i32x4(&cb[pixel], clamp_to_u8(g));
+                    store_i32x4(&cr[pixel], clamp_to_u8(b));
+                }
+            }
+        }
+    }
+}
+
+// At a scale of 1/8, each block is just its average, which is what the DC coefficient is.
+static void dequantize_dc_only(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+{
+    for (u32 i = 0; i < context.component_count; i++) {
+        auto& component = context.components[i];
+        const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
+        for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                int* block_component = get_component(macroblocks[mb_index], i);
+                // The 2-D IDCT is scaled by 1/8.
+                i32 average = (block_component[0] * (i32)table[0] + 4) >> 3;
+                for (u32 k = 0; k < 64; k++)
+                    block_component[k] = average;
             }
         }
     }
 }
 
+// Returns how many MCUs of the interval were decoded, which is all of them unless something went wrong.
+static u32 decode_restart_interval(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks, const RestartInterval& interval)
+{
+    HuffmanStreamState hstream;
+    hstream.stream = context.huffman_stream.span().slice(interval.stream_offset);
+
+    const u32 mcus_per_row = context.mblock_meta.hpadded_count / context.hsample_factor;
+    for (u32 mcu = interval.first_mcu; mcu < interval.first_mcu + interval.mcu_count; mcu++) {
+        const u32 hcursor = (mcu % mcus_per_row) * context.hsample_factor;
+        const u32 vcursor = (mcu / mcus_per_row) * context.vsample_factor;
+        if (!build_macroblocks(context, hstream, macroblocks, hcursor, vcursor)) {
+            if constexpr (JPG_DEBUG) {
+                dbgln("Failed to build Macroblock {}", vcursor * context.mblock_meta.hpadded_count + hcursor);
+                dbgln("Huffman stream byte offset {}", interval.stream_offset + hstream.byte_offset);
+                dbgln("Huffman stream bit offset {}", hstream.bit_offset);
+            }
+            return mcu - interval.first_mcu;
+        }
+
+        // Finish the MCU while it's still in the cache.
+        if (context.scale_denominator == 8) {
+            dequantize_dc_only(context, macroblocks, hcursor, vcursor);
+        } else {
+            dequantize(context, macroblocks, hcursor, vcursor);
+            inverse_dct(context, macroblocks, hcursor, vcursor);
+        }
+        ycbcr_to_rgb(context, macroblocks, hcursor, vcursor);
+    }
+    return interval.mcu_count;
+}
+
+static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
+{
+    Vector<Macroblock> macroblocks;
+    macroblocks.resize(context.mblock_meta.padded_total);
+
+    if constexpr (JPG_DEBUG) {
+        dbgln("Image width: {}", context.frame.width);
+        dbgln("Image height: {}", context.frame.height);
+        dbgln("Macroblocks in a row: {}", context.mblock_meta.hpadded_count);
+        dbgln("Macroblocks in a column: {}", context.mblock_meta.vpadded_count);
+        dbgln("Macroblock meta padded total: {}", context.mblock_meta.padded_total);
+    }
+
+    // Compute huffman codes for DC and AC tables.
+    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it)
+        generate_huffman_codes(it->value);
+
+    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
+        generate_huffman_codes(it->value);
+
+    // The DC predictions are reset and the stream is realigned to a byte boundary at every restart marker,
+    // so each restart interval can be decoded on its own.
+    const u32 mcu_count = (context.mblock_meta.hpadded_count / context.hsample_factor) * (context.mblock_meta.vpadded_count / context.vsample_factor);
+    const u32 mcus_per_interval = context.dc_reset_interval > 0 ? context.dc_reset_interval : mcu_count;
+    Vector<RestartInterval> intervals;
+    for (u32 first_mcu = 0; first_mcu < mcu_count; first_mcu += mcus_per_interval) {
+        size_t interval_index = intervals.size();
+        if (interval_index > context.restart_interval_offsets.size()) {
+            // The rest of partial data hasn't arrived yet.
+            if (context.data_is_partial)
+                break;
+            dbgln_if(JPG_DEBUG, "Restart marker before interval {} is missing!", interval_index);
+            return {};
+        }
+        size_t stream_offset = interval_index == 0 ? 0 : context.restart_interval_offsets[interval_index - 1];
+        intervals.append({ first_mcu, min(mcus_per_interval, mcu_count - first_mcu), stream_offset });
+    }
+
+    // Partial data is decoded in order, so we know where it stopped.
+    if (intervals.size() > 1 && ImageDecoder::may_decode_in_parallel() && !context.data_is_partial) {
+        // Hand out a few hundred MCUs at a time, so images with tiny restart intervals don't drown in jobs.
+        static constexpr u32 minimum_mcus_per_job = 256;
+        Atomic<bool> did_fail { false };
+        Threading::parallel_for(
+            intervals.span(), [&](auto& interval) {
+                if (did_fail.load(AK::MemoryOrder::memory_order_relaxed))
+                    return;
+                if (decode_restart_interval(context, macroblocks, interval) != interval.mcu_count)
+                    did_fail.store(true, AK::MemoryOrder::memory_order_relaxed);
+            },
+            max(1u, minimum_mcus_per_job / mcus_per_interval));
+        if (did_fail.load())
+            return {};
+        context.decoded_mcu_count = mcu_count;
+        return macroblocks;
+    }
+
+    for (auto& interval : intervals) {
+        auto decoded_mcu_count = decode_restart_interval(context, macroblocks, interval);
+        context.decoded_mcu_count = interval.first_mcu + decoded_mcu_count;
+        if (decoded_mcu_count != interval.mcu_count) {
+            // Partial data is expected to run out somewhere.
+            if (context.data_is_partial)
+                break;
+            return {};
+        }
+    }
+    return macroblocks;
+}
+
 static bool compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
 {
-    context.bitmap = Bitmap::create_purgeable(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height });
+    // Only whole rows of MCUs are drawn, and with partial data, the rows that are missing are left transparent.
+    const u32 mcus_per_row = context.mblock_meta.hpadded_count / context.hsample_factor;
+    const u32 decoded_block_rows = (context.decoded_mcu_count / mcus_per_row) * context.vsample_factor;
+    auto format = context.data_is_partial ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888;
+
+    if (context.scale_denominator == 8) {
+        context.bitmap = Bitmap::create_purgeable(format, { (int)context.mblock_meta.hcount, (int)context.mblock_meta.vcount });
+        if (!context.bitmap)
+            return false;
+        for (u32 block_row = 0; block_row < min(context.mblock_meta.vcount, decoded_block_rows); block_row++) {
+            auto* scanline = context.bitmap->scanline(block_row);
+            for (u32 block_column = 0; block_column < context.mblock_meta.hcount; block_column++) {
+                auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
+                scanline[block_column] = Color((u8)block.y[0], (u8)block.cb[0], (u8)block.cr[0]).value();
+            }
+        }
+        return true;
+    }
+
+    context.bitmap = Bitmap::create_purgeable(format, { context.frame.width, context.frame.height });
     if (!context.bitmap)
         return false;
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
+    for (u32 y = 0; y < min((u32)context.frame.height, decoded_block_rows * 8); y++) {
         const u32 block_row = y / 8;
         const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
+        auto* scanline = context.bitmap->scanline(y);
+        for (u32 block_column = 0; block_column < context.mblock_meta.hcount; block_column++) {
             auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+            const u32 first_x = block_column * 8;
+            const u32 pixel_count = min(8u, context.frame.width - first_x);
+            for (u32 pixel_column = 0; pixel_column < pixel_count; pixel_column++) {
+                const u32 pixel_index = pixel_row * 8 + pixel_column;
+                const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
+                scanline[first_x + pixel_column] = color.value();
+            }
         }
     }
 
@@ -1163,6 +1282,9 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
         last_byte = current_byte;
         stream >> current_byte;
         if (stream.handle_any_error()) {
+            // The rest of partial data hasn't arrived yet, so decode what's there.
+            if (context.data_is_partial)
+                return true;
             dbgln_if(JPG_DEBUG, "{}: EOI not found!", stream.offset());
             return false;
         }
@@ -1174,14 +1296,14 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
                 stream >> current_byte;
                 if (stream.handle_any_error())
                     return false;
-                context.huffman_stream.stream.append(last_byte);
+                context.huffman_stream.append(last_byte);
                 continue;
             }
             Marker marker = 0xFF00 | current_byte;
             if (marker == JPG_EOI)
                 return true;
             if (marker >= JPG_RST0 && marker <= JPG_RST7) {
-                context.huffman_stream.stream.append(marker);
+                context.restart_interval_offsets.append(context.huffman_stream.size());
                 stream >> current_byte;
                 if (stream.handle_any_error())
                     return false;
@@ -1190,7 +1312,7 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
             dbgln_if(JPG_DEBUG, "{}: Invalid marker: {:x}!", stream.offset(), marker);
             return false;
         } else {
-            context.huffman_stream.stream.append(last_byte);
+            context.huffman_stream.append(last_byte);
         }
     }
 
@@ -1206,6 +1328,11 @@ static bool decode_jpg(JPGLoadingContext& context)
     if (!scan_huffman_stream(stream, context))
         return false;
 
+    if (!context.ideal_size.is_empty()
+        && (int)context.mblock_meta.hcount >= context.ideal_size.width()
+        && (int)context.mblock_meta.vcount >= context.ideal_size.height())
+        context.scale_denominator = 8;
+
     auto result = decode_huffman_stream(context);
     if (!result.has_value()) {
         dbgln_if(JPG_DEBUG, "{}: Failed to decode Macroblocks!", stream.offset());
@@ -1213,9 +1340,6 @@ static bool decode_jpg(JPGLoadingContext& context)
     }
 
     auto macroblocks = result.release_value();
-    dequantize(context, macroblocks);
-    inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
     if (!compose_bitmap(context, macroblocks))
         return false;
     return true;
@@ -1257,7 +1381,7 @@ JPGImageDecoderPlugin::JPGImageDecoderPlugin(const u8* data, size_t size)
     m_context = make<JPGLoadingContext>();
     m_context->data = data;
     m_context->data_size = size;
-    m_context->huffman_stream.stream.ensure_capacity(50 * KiB);
+    m_context->huffman_stream.ensure_capacity(50 * KiB);
 }
 
 JPGImageDecoderPlugin::~JPGImageDecoderPlugin()
@@ -1302,6 +1426,17 @@ bool JPGImageDecoderPlugin::set_nonvolatile()
     return m_context->bitmap->set_nonvolatile();
 }
 
+bool JPGImageDecoderPlugin::set_data_is_partial()
+{
+    m_context->data_is_partial = true;
+    return true;
+}
+
+void JPGImageDecoderPlugin::set_ideal_size(IntSize ideal_size)
+{
+    m_context->ideal_size = ideal_size;
+}
+
 bool JPGImageDecoderPlugin::sniff()
 {
     return m_context->data_size > 3
@@ -1327,9 +1462,8 @@ size_t JPGImageDecoderPlugin::frame_count()
 
 ImageFrameDescriptor JPGImageDecoderPlugin::frame(size_t i)
 {
-    if (i > 0) {
-        return { bitmap(), 0 };
-    }
-    return {};
+    if (i > 0)
+        return {};
+    return { bitmap(), 0 };
 }
 }
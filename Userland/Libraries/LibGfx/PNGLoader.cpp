@@ -8,6 +8,9 @@
 #include <AK/Endian.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
+#include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
+#include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
@@ -19,7 +22,6 @@
 #include <unistd.h>
 
 #ifdef __serenity__
-#    include <LibCompress/Deflate.h>
 #    include <serenity.h>
 #endif
 
@@ -39,11 +41,6 @@ struct PNG_IHDR {
 
 static_assert(sizeof(PNG_IHDR) == 13);
 
-struct Scanline {
-    u8 filter { 0 };
-    ReadonlyBytes data {};
-};
-
 struct [[gnu::packed]] PaletteEntry {
     u8 r;
     u8 g;
@@ -51,27 +48,6 @@ struct [[gnu::packed]] PaletteEntry {
     //u8 a;
 };
 
-template<typename T>
-struct [[gnu::packed]] Tuple {
-    T gray;
-    T a;
-};
-
-template<typename T>
-struct [[gnu::packed]] Triplet {
-    T r;
-    T g;
-    T b;
-};
-
-template<typename T>
-struct [[gnu::packed]] Quad {
-    T r;
-    T g;
-    T b;
-    T a;
-};
-
 enum PngInterlaceMethod {
     Null = 0,
     Adam7 = 1
@@ -98,10 +74,9 @@ struct PNGLoadingContext {
     u8 interlace_method { 0 };
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
+    bool data_is_partial { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
-    ByteBuffer* decompression_buffer { nullptr };
     Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
@@ -160,6 +135,11 @@ public:
         return true;
     }
 
+    bool wrap_remaining_bytes(ReadonlyBytes& buffer)
+    {
+        return wrap_bytes(buffer, m_size_remaining);
+    }
+
     bool at_end() const { return !m_size_remaining; }
 
 private:
@@ -202,302 +182,178 @@ ALWAYS_INLINE static u8 paeth_predictor(int a, int b, int c)
     return c;
 }
 
-union [[gnu::packed]] Pixel {
-    RGBA32 rgba { 0 };
-    u8 v[4];
-    struct {
-        u8 r;
-        u8 g;
-        u8 b;
-        u8 a;
-    };
-};
-static_assert(sizeof(Pixel) == 4);
+using AK::SIMD::i16x4;
+using AK::SIMD::u8x4;
 
-template<bool has_alpha, u8 filter_type>
-ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
+ALWAYS_INLINE static i16x4 load_pixel(const u8* data)
 {
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
+    u8x4 bytes;
+    memcpy(&bytes, data, sizeof(bytes));
+    return __builtin_convertvector(bytes, i16x4);
+}
 
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
-        }
-        return;
-    }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
-        }
-    }
+ALWAYS_INLINE static void store_pixel(u8* data, i16x4 pixel, size_t bytes_per_pixel)
+{
+    auto bytes = __builtin_convertvector(pixel, u8x4);
+    memcpy(data, &bytes, bytes_per_pixel);
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static i16x4 absolute_value(i16x4 value)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* gray_values = reinterpret_cast<const T*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = gray_values[i];
-            pixel.g = gray_values[i];
-            pixel.b = gray_values[i];
-            pixel.a = 0xff;
-        }
+    auto sign = value >> 15;
+    return (value ^ sign) - sign;
+}
+
+// The same as the scalar paeth_predictor(), for every channel of a pixel at once.
+// Comparisons give all ones in the lanes where they hold, and zeroes elsewhere.
+ALWAYS_INLINE static i16x4 paeth_predictor(i16x4 a, i16x4 b, i16x4 c)
+{
+    auto pa = absolute_value(b - c);
+    auto pb = absolute_value(a - c);
+    auto pc = absolute_value(a + b - c - c);
+    auto use_a = (pa <= pb) & (pa <= pc);
+    auto use_b = ~use_a & (pb <= pc);
+    return (a & use_a) | (b & use_b) | (c & ~(use_a | use_b));
+}
+
+// The Sub, Average and Paeth filters depend on the pixel to the left, so they can't be undone for many bytes at
+// once. With three or four bytes per pixel, all the bytes of a pixel are handled together instead.
+// NOTE: This reads (but doesn't write) one byte past the end of the scanline for three byte pixels.
+template<u8 filter_type, size_t bytes_per_pixel>
+static void unfilter_scanline_by_pixel(u8* scanline, const u8* previous_scanline, size_t size)
+{
+    static_assert(bytes_per_pixel == 3 || bytes_per_pixel == 4);
+    i16x4 a = { 0, 0, 0, 0 };
+    i16x4 c = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < size; i += bytes_per_pixel) {
+        auto x = load_pixel(scanline + i);
+        auto b = load_pixel(previous_scanline + i);
+        if constexpr (filter_type == 1)
+            x += a;
+        if constexpr (filter_type == 3)
+            x += (a + b) >> 1;
+        if constexpr (filter_type == 4)
+            x += paeth_predictor(a, b, c);
+        x &= 0xff;
+        store_pixel(scanline + i, x, bytes_per_pixel);
+        a = x;
+        c = b;
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+template<size_t bytes_per_pixel>
+static void unfilter_scanline_by_pixel(u8 filter, u8* scanline, const u8* previous_scanline, size_t size)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* tuples = reinterpret_cast<const Tuple<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = tuples[i].gray;
-            pixel.g = tuples[i].gray;
-            pixel.b = tuples[i].gray;
-            pixel.a = tuples[i].a;
-        }
+    switch (filter) {
+    case 1:
+        unfilter_scanline_by_pixel<1, bytes_per_pixel>(scanline, previous_scanline, size);
+        break;
+    case 3:
+        unfilter_scanline_by_pixel<3, bytes_per_pixel>(scanline, previous_scanline, size);
+        break;
+    case 4:
+        unfilter_scanline_by_pixel<4, bytes_per_pixel>(scanline, previous_scanline, size);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+// Undoes the filter of a scanline in place. Filters work on bytes, whatever the pixel format is,
+// and "the pixel to the left" is the byte bytes_per_pixel bytes back.
+static void unfilter_scanline(u8 filter, u8* scanline, const u8* previous_scanline, size_t size, size_t bytes_per_pixel)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<const Triplet<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            pixel.a = 0xff;
-        }
+    if (filter == 0)
+        return;
+
+    if (filter == 2) {
+        for (size_t i = 0; i < size; ++i)
+            scanline[i] += previous_scanline[i];
+        return;
+    }
+
+    if (bytes_per_pixel == 3) {
+        unfilter_scanline_by_pixel<3>(filter, scanline, previous_scanline, size);
+        return;
+    }
+    if (bytes_per_pixel == 4) {
+        unfilter_scanline_by_pixel<4>(filter, scanline, previous_scanline, size);
+        return;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        u8 a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
+        u8 b = previous_scanline[i];
+        u8 c = i >= bytes_per_pixel ? previous_scanline[i - bytes_per_pixel] : 0;
+        if (filter == 1)
+            scanline[i] += a;
+        else if (filter == 3)
+            scanline[i] += (a + b) / 2;
+        else if (filter == 4)
+            scanline[i] += paeth_predictor(a, b, c);
     }
 }
 
-NEVER_INLINE FLATTEN static bool unfilter(PNGLoadingContext& context)
+// Samples of less than 8 bits are packed into bytes from the most significant bit down.
+ALWAYS_INLINE static u8 packed_sample(const u8* scanline, int index, u8 bit_depth)
 {
-    // First unpack the scanlines to RGBA:
+    auto samples_per_byte = 8 / bit_depth;
+    auto bit_offset = (8 - bit_depth) - (bit_depth * (index % samples_per_byte));
+    return (scanline[index / samples_per_byte] >> bit_offset) & ((1 << bit_depth) - 1);
+}
+
+// Turns an unfiltered scanline into pixels. Only the most significant byte of 16-bit samples is used.
+static bool unpack_scanline(const PNGLoadingContext& context, const u8* scanline, int width, RGBA32* pixels)
+{
+    size_t bytes_per_sample = context.bit_depth == 16 ? 2 : 1;
     switch (context.color_type) {
     case 0:
-        if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
-        } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
-        } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto bit_depth_squared = context.bit_depth * context.bit_depth;
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* gray_values = context.scanlines[y].data.data();
-                for (int x = 0; x < context.width; ++x) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
-                    auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[x];
-                    pixel.r = value * (0xff / bit_depth_squared);
-                    pixel.g = value * (0xff / bit_depth_squared);
-                    pixel.b = value * (0xff / bit_depth_squared);
-                    pixel.a = 0xff;
-                }
+        if (context.bit_depth < 8) {
+            auto scale = 0xff / ((1 << context.bit_depth) - 1);
+            for (int i = 0; i < width; ++i) {
+                u8 gray = packed_sample(scanline, i, context.bit_depth) * scale;
+                pixels[i] = Color(gray, gray, gray).value();
             }
-        } else {
-            VERIFY_NOT_REACHED();
+            break;
+        }
+        for (int i = 0; i < width; ++i) {
+            u8 gray = scanline[i * bytes_per_sample];
+            pixels[i] = Color(gray, gray, gray).value();
         }
         break;
     case 4:
-        if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
-        } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
-        } else {
-            VERIFY_NOT_REACHED();
+        for (int i = 0; i < width; ++i) {
+            auto* sample = &scanline[i * 2 * bytes_per_sample];
+            pixels[i] = Color(sample[0], sample[0], sample[0], sample[bytes_per_sample]).value();
         }
         break;
     case 2:
-        if (context.bit_depth == 8) {
-            unpack_triplets_without_alpha<u8>(context);
-        } else if (context.bit_depth == 16) {
-            unpack_triplets_without_alpha<u16>(context);
-        } else {
-            VERIFY_NOT_REACHED();
+        for (int i = 0; i < width; ++i) {
+            auto* sample = &scanline[i * 3 * bytes_per_sample];
+            pixels[i] = Color(sample[0], sample[bytes_per_sample], sample[2 * bytes_per_sample]).value();
         }
         break;
     case 6:
-        if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
-        } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = reinterpret_cast<const Quad<u16>*>(context.scanlines[y].data.data());
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = triplets[i].a & 0xFF;
-                }
-            }
-        } else {
-            VERIFY_NOT_REACHED();
+        for (int i = 0; i < width; ++i) {
+            auto* sample = &scanline[i * 4 * bytes_per_sample];
+            pixels[i] = Color(sample[0], sample[bytes_per_sample], sample[2 * bytes_per_sample], sample[3 * bytes_per_sample]).value();
         }
         break;
     case 3:
-        if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_index = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if (palette_index[i] >= context.palette_data.size())
-                        return false;
-                    auto& color = context.palette_data.at((int)palette_index[i]);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                        ? context.palette_transparency_data.data()[palette_index[i]]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
-        } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_indices = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
-                    auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if ((size_t)palette_index >= context.palette_data.size())
-                        return false;
-                    auto& color = context.palette_data.at(palette_index);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
-                        ? context.palette_transparency_data.data()[palette_index]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
-        } else {
-            VERIFY_NOT_REACHED();
+        for (int i = 0; i < width; ++i) {
+            size_t palette_index = context.bit_depth == 8 ? scanline[i] : packed_sample(scanline, i, context.bit_depth);
+            if (palette_index >= context.palette_data.size())
+                return false;
+            auto& color = context.palette_data[palette_index];
+            auto transparency = palette_index < context.palette_transparency_data.size()
+                ? context.palette_transparency_data[palette_index]
+                : 0xff;
+            pixels[i] = Color(color.r, color.g, color.b, transparency).value();
         }
         break;
     default:
         VERIFY_NOT_REACHED();
-        break;
     }
-
-    u8 dummy_scanline[context.width * sizeof(RGBA32)];
-    memset(dummy_scanline, 0, sizeof(dummy_scanline));
-
-    for (int y = 0; y < context.height; ++y) {
-        auto filter = context.scanlines[y].filter;
-        if (filter == 0) {
-            if (context.has_alpha())
-                unfilter_impl<true, 0>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 0>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 1) {
-            if (context.has_alpha())
-                unfilter_impl<true, 1>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 1>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 2) {
-            if (context.has_alpha())
-                unfilter_impl<true, 2>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 2>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 3) {
-            if (context.has_alpha())
-                unfilter_impl<true, 3>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 3>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 4) {
-            if (context.has_alpha())
-                unfilter_impl<true, 4>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 4>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-    }
-
     return true;
 }
 
@@ -578,45 +434,6 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     return true;
 }
 
-static bool decode_png_bitmap_simple(PNGLoadingContext& context)
-{
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-
-    for (int y = 0; y < context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-
-        if (filter > 4) {
-            dbgln_if(PNG_DEBUG, "Invalid PNG filter: {}", filter);
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = context.compute_row_size_for_width(context.width);
-        if (row_size.has_overflow())
-            return false;
-
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-    }
-
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
-
-    if (!context.bitmap) {
-        context.state = PNGLoadingContext::State::Error;
-        return false;
-    }
-
-    return unfilter(context);
-}
-
 static int adam7_height(PNGLoadingContext& context, int pass)
 {
     switch (pass) {
@@ -666,74 +483,74 @@ static int adam7_starty[8] = { 0, 0, 0, 4, 0, 2, 0, 1 };
 static int adam7_startx[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
 static int adam7_stepy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
 static int adam7_stepx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
+// Each pixel of a pass also stands in for the pixels to the right of and below it that only later passes fill in.
+static int adam7_block_height[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
+static int adam7_block_width[8] = { 1, 8, 4, 4, 2, 2, 1, 1 };
 
-static bool decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, int pass)
+// Decodes the scanlines of the whole image (pass 0), or of one of the Adam7 passes, as they come out of the decompressor.
+// Only the current and the previous scanline are kept around.
+static bool decode_png_pass(PNGLoadingContext& context, InputStream& decompressed_data, int pass)
 {
-    PNGLoadingContext subimage_context;
-    subimage_context.width = adam7_width(context, pass);
-    subimage_context.height = adam7_height(context, pass);
-    subimage_context.channels = context.channels;
-    subimage_context.color_type = context.color_type;
-    subimage_context.palette_data = context.palette_data;
-    subimage_context.palette_transparency_data = context.palette_transparency_data;
-    subimage_context.bit_depth = context.bit_depth;
-    subimage_context.filter_method = context.filter_method;
+    int width = pass == 0 ? context.width : adam7_width(context, pass);
+    int height = pass == 0 ? context.height : adam7_height(context, pass);
 
     // For small images, some passes might be empty
-    if (!subimage_context.width || !subimage_context.height)
+    if (!width || !height)
         return true;
 
-    subimage_context.scanlines.clear_with_capacity();
-    for (int y = 0; y < subimage_context.height; ++y) {
+    auto row_size = context.compute_row_size_for_width(width);
+    if (row_size.has_overflow())
+        return false;
+
+    size_t bytes_per_pixel = max(1, context.channels * context.bit_depth / 8);
+
+    // The extra bytes are for unfilter_scanline(), which may read a little past the end.
+    Vector<u8> scanline;
+    Vector<u8> previous_scanline;
+    scanline.resize(row_size.value() + sizeof(u8x4));
+    previous_scanline.resize(row_size.value() + sizeof(u8x4));
+
+    Vector<RGBA32> pass_pixels;
+    if (pass != 0)
+        pass_pixels.resize(width);
+
+    for (int y = 0; y < height; ++y) {
         u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
+        if (!decompressed_data.read_or_error({ &filter, sizeof(filter) }))
             return false;
-        }
 
         if (filter > 4) {
             dbgln_if(PNG_DEBUG, "Invalid PNG filter: {}", filter);
-            context.state = PNGLoadingContext::State::Error;
             return false;
         }
 
-        subimage_context.scanlines.append({ filter });
-        auto& scanline_buffer = subimage_context.scanlines.last().data;
-
-        auto row_size = context.compute_row_size_for_width(subimage_context.width);
-        if (row_size.has_overflow())
-            return false;
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
+        if (!decompressed_data.read_or_error({ scanline.data(), (size_t)row_size.value() }))
             return false;
-        }
-    }
 
-    subimage_context.bitmap = Bitmap::create(context.bitmap->format(), { subimage_context.width, subimage_context.height });
-    if (!unfilter(subimage_context)) {
-        subimage_context.bitmap = nullptr;
-        return false;
-    }
+        unfilter_scanline(filter, scanline.data(), previous_scanline.data(), row_size.value(), bytes_per_pixel);
 
-    // Copy the subimage data into the main image according to the pass pattern
-    for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
-        for (int x = 0, dx = adam7_startx[pass]; x < subimage_context.width && dy < context.width; ++x, dx += adam7_stepx[pass]) {
-            context.bitmap->set_pixel(dx, dy, subimage_context.bitmap->get_pixel(x, y));
+        if (pass == 0) {
+            if (!unpack_scanline(context, scanline.data(), width, context.bitmap->scanline(y)))
+                return false;
+        } else {
+            if (!unpack_scanline(context, scanline.data(), width, pass_pixels.data()))
+                return false;
+
+            // Copy the pixels into the main image according to the pass pattern. The rest of partial data may never
+            // show up, so then every pixel is also copied into the spots that later passes would fill in.
+            int dy = adam7_starty[pass] + y * adam7_stepy[pass];
+            int block_height = context.data_is_partial ? adam7_block_height[pass] : 1;
+            int block_width = context.data_is_partial ? adam7_block_width[pass] : 1;
+            for (int block_y = dy; block_y < min(dy + block_height, context.height); ++block_y) {
+                auto* pixels = context.bitmap->scanline(block_y);
+                for (int x = 0, dx = adam7_startx[pass]; x < width && dx < context.width; ++x, dx += adam7_stepx[pass]) {
+                    for (int block_x = dx; block_x < min(dx + block_width, context.width); ++block_x)
+                        pixels[block_x] = pass_pixels[x];
+                }
+            }
         }
-    }
-    return true;
-}
-
-static bool decode_png_adam7(PNGLoadingContext& context)
-{
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
-    if (!context.bitmap)
-        return false;
 
-    for (int pass = 1; pass <= 7; ++pass) {
-        if (!decode_adam7_pass(context, streamer, pass))
-            return false;
+        swap(scanline, previous_scanline);
     }
     return true;
 }
@@ -754,31 +571,46 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
     if (context.color_type == 3 && context.palette_data.is_empty())
         return false; // Didn't see a PLTE chunk for a palettized image, or it was empty.
 
-    auto result = Compress::Zlib::decompress_all(context.compressed_data.span());
-    if (!result.has_value()) {
+    if (context.interlace_method != PngInterlaceMethod::Null && context.interlace_method != PngInterlaceMethod::Adam7) {
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
-    context.decompression_buffer = &result.value();
-    context.compressed_data.clear();
 
-    context.scanlines.ensure_capacity(context.height);
-    switch (context.interlace_method) {
-    case PngInterlaceMethod::Null:
-        if (!decode_png_bitmap_simple(context))
-            return false;
-        break;
-    case PngInterlaceMethod::Adam7:
-        if (!decode_png_adam7(context))
-            return false;
-        break;
-    default:
+    auto zlib = Compress::Zlib::try_create(context.compressed_data.span());
+    if (!zlib.has_value()) {
+        context.state = PNGLoadingContext::State::Error;
+        return false;
+    }
+
+    // With partial data, the rows that are still missing are left transparent.
+    bool needs_alpha = context.has_alpha() || context.data_is_partial;
+    context.bitmap = Bitmap::create_purgeable(needs_alpha ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
+    if (!context.bitmap) {
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
 
-    context.decompression_buffer = nullptr;
+    // The image data is decompressed straight into scanlines, instead of into one big buffer first.
+    InputMemoryStream compressed_data { zlib->deflate_data() };
+    Compress::DeflateDecompressor decompressed_data { compressed_data };
+    bool success = true;
+    if (context.interlace_method == PngInterlaceMethod::Null) {
+        success = decode_png_pass(context, decompressed_data, 0);
+    } else {
+        for (int pass = 1; pass <= 7 && success; ++pass)
+            success = decode_png_pass(context, decompressed_data, pass);
+    }
+    decompressed_data.handle_any_error();
+    compressed_data.handle_any_error();
 
+    // With partial data, running out of it is expected. Whatever got decoded before that is still good.
+    if (!success && !context.data_is_partial) {
+        context.bitmap = nullptr;
+        context.state = PNGLoadingContext::State::Error;
+        return false;
+    }
+
+    context.compressed_data.clear();
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return true;
 }
@@ -918,6 +750,9 @@ static bool process_chunk(Streamer& streamer, PNGLoadingContext& context)
     ReadonlyBytes chunk_data;
     if (!streamer.wrap_bytes(chunk_data, chunk_size)) {
         dbgln_if(PNG_DEBUG, "Bail at chunk_data");
+        // The image data is decoded as far as it goes, so the part of it that did arrive is still useful.
+        if (context.data_is_partial && !strcmp((const char*)chunk_type, "IDAT") && streamer.wrap_remaining_bytes(chunk_data))
+            process_IDAT(chunk_data, context);
         return false;
     }
     u32 chunk_crc;
@@ -992,6 +827,12 @@ bool PNGImageDecoderPlugin::set_nonvolatile()
     return m_context->bitmap->set_nonvolatile();
 }
 
+bool PNGImageDecoderPlugin::set_data_is_partial()
+{
+    m_context->data_is_partial = true;
+    return true;
+}
+
 bool PNGImageDecoderPlugin::sniff()
 {
     return decode_png_header(*m_context);
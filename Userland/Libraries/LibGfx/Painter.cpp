@@ -21,6 +21,7 @@
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
 #include <AK/Utf8View.h>
+#include <LibGfx/BlendKernels.h>
 #include <LibGfx/CharacterBitmap.h>
 #include <LibGfx/Palette.h>
 #include <LibGfx/Path.h>
@@ -113,8 +114,7 @@ void Painter::fill_physical_rect(const IntRect& physical_rect, Color color)
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+        blend_color_onto_row(dst, physical_rect.width(), color);
         dst += dst_skip;
     }
 }
@@ -718,20 +718,20 @@ struct BlitState {
 template<BlitState::AlphaState has_alpha>
 static void do_blit_with_opacity(BlitState& state)
 {
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_rgba(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_rgba(state.src[x]);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
+    // The opacity only depends on the source alpha, so work it out once for every possible value.
+    u8 source_alpha_map[256];
+    for (int alpha = 0; alpha < 256; ++alpha) {
+        if constexpr (has_alpha & BlitState::SrcAlpha) {
+            float pixel_opacity = alpha / 255.0;
+            source_alpha_map[alpha] = 255 * (state.opacity * pixel_opacity);
+        } else {
+            source_alpha_map[alpha] = state.opacity * 255;
         }
+    }
+
+    constexpr bool destination_is_opaque = !(has_alpha & BlitState::DstAlpha);
+    for (int row = 0; row < state.row_count; ++row) {
+        blend_row(state.dst, state.src, state.column_count, source_alpha_map, destination_is_opaque);
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -1045,6 +1045,11 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
     int src_left = src_rect.left() * (1 << 16);
     int src_top = src_rect.top() * (1 << 16);
 
+    // With alpha, a row of scaled source pixels is gathered first and then blended in one go.
+    Vector<RGBA32> scaled_row;
+    if constexpr (has_alpha_channel)
+        scaled_row.resize(clipped_rect.width());
+
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
         auto* scanline = (Color*)target.scanline(y);
         for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
@@ -1053,11 +1058,13 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
             auto src_pixel = get_pixel(source, scaled_x, scaled_y);
             if (has_opacity)
                 src_pixel.set_alpha(src_pixel.alpha() * opacity);
-            if constexpr (has_alpha_channel) {
-                scanline[x] = scanline[x].blend(src_pixel);
-            } else
+            if constexpr (has_alpha_channel)
+                scaled_row[x - clipped_rect.left()] = src_pixel.value();
+            else
                 scanline[x] = src_pixel;
         }
+        if constexpr (has_alpha_channel)
+            blend_row(target.scanline(y) + clipped_rect.left(), scaled_row.data(), scaled_row.size(), nullptr, false);
     }
 }
 
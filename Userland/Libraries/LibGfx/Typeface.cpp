@@ -45,8 +45,14 @@ RefPtr<Font> Typeface::get_font(unsigned size)
             return font;
     }
 
-    if (m_ttf_font)
-        return adopt_ref(*new TTF::ScaledFont(*m_ttf_font, size, size));
+    if (m_ttf_font) {
+        // Hand out the same font for the same size, so everything in the process shares its caches.
+        if (auto it = m_scaled_ttf_fonts.find(size); it != m_scaled_ttf_fonts.end())
+            return it->value;
+        auto font = adopt_ref(*new TTF::ScaledFont(*m_ttf_font, size, size));
+        m_scaled_ttf_fonts.set(size, font);
+        return font;
+    }
 
     return {};
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
@@ -43,6 +44,7 @@ private:
 
     Vector<RefPtr<BitmapFont>> m_bitmap_fonts;
     RefPtr<TTF::Font> m_ttf_font;
+    HashMap<unsigned, NonnullRefPtr<Font>> m_scaled_ttf_fonts;
 };
 
 }
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibHTTP/HPACK.h>
+
+namespace HTTP::HPACK {
+
+struct StaticHeader {
+    const char* name;
+    const char* value;
+};
+
+// RFC 7541 appendix A. Index 1 is the first entry.
+static constexpr StaticHeader static_table[] = {
+    { ":authority", "" },
+    { ":method", "GET" },
+    { ":method", "POST" },
+    { ":path", "/" },
+    { ":path", "/index.html" },
+    { ":scheme", "http" },
+    { ":scheme", "https" },
+    { ":status", "200" },
+    { ":status", "204" },
+    { ":status", "206" },
+    { ":status", "304" },
+    { ":status", "400" },
+    { ":status", "404" },
+    { ":status", "500" },
+    { "accept-charset", "" },
+    { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" },
+    { "accept-ranges", "" },
+    { "accept", "" },
+    { "access-control-allow-origin", "" },
+    { "age", "" },
+    { "allow", "" },
+    { "authorization", "" },
+    { "cache-control", "" },
+    { "content-disposition", "" },
+    { "content-encoding", "" },
+    { "content-language", "" },
+    { "content-length", "" },
+    { "content-location", "" },
+    { "content-range", "" },
+    { "content-type", "" },
+    { "cookie", "" },
+    { "date", "" },
+    { "etag", "" },
+    { "expect", "" },
+    { "expires", "" },
+    { "from", "" },
+    { "host", "" },
+    { "if-match", "" },
+    { "if-modified-since", "" },
+    { "if-none-match", "" },
+    { "if-range", "" },
+    { "if-unmodified-since", "" },
+    { "last-modified", "" },
+    { "link", "" },
+    { "location", "" },
+    { "max-forwards", "" },
+    { "proxy-authenticate", "" },
+    { "proxy-authorization", "" },
+    { "range", "" },
+    { "referer", "" },
+    { "refresh", "" },
+    { "retry-after", "" },
+    { "server", "" },
+    { "set-cookie", "" },
+    { "strict-transport-security", "" },
+    { "transfer-encoding", "" },
+    { "user-agent", "" },
+    { "vary", "" },
+    { "via", "" },
+    { "www-authenticate", "" },
+};
+static constexpr size_t static_table_size = sizeof(static_table) / sizeof(static_table[0]);
+
+struct HuffmanCode {
+    u32 bits;
+    u8 length;
+};
+
+// RFC 7541 appendix B, indexed by symbol. Symbol 256 is EOS, which must never show up in an encoded string.
+static constexpr HuffmanCode huffman_codes[257] = {
+    { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 },
+    { 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+    { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+    { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+    { 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 },
+    { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+    { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 },
+    { 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+    { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+    { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+    { 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 },
+    { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+    { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 },
+    { 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+    { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+    { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+    { 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 },
+    { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+    { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 },
+    { 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+    { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+    { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+    { 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 },
+    { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+    { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 },
+    { 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+    { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+    { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+    { 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 },
+    { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+    { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 },
+    { 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+    { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+    { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+    { 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 },
+    { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+    { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 },
+    { 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+    { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+    { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+    { 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 },
+    { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+    { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 },
+    { 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+    { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+    { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+    { 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 },
+    { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+    { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 },
+    { 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+    { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+    { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+    { 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 },
+    { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+    { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 },
+    { 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+    { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+    { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+    { 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 },
+    { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+    { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 },
+    { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+    { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+    { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+    { 0x3fffffff, 30 },
+};
+static constexpr u16 huffman_eos = 256;
+static constexpr u8 huffman_max_code_length = 30;
+
+// The code is canonical: the codes of any one length are consecutive, in the order of their symbols, and
+// smaller than the prefixes of the longer codes. That allows decoding by looking at one length after the other.
+struct HuffmanDecodeTable {
+    u32 first_code[huffman_max_code_length + 1] {};
+    u16 code_count[huffman_max_code_length + 1] {};
+    u16 first_index[huffman_max_code_length + 1] {};
+    u16 symbols[257] {};
+};
+
+static constexpr HuffmanDecodeTable build_huffman_decode_table()
+{
+    HuffmanDecodeTable table;
+    for (auto& code : huffman_codes)
+        ++table.code_count[code.length];
+    u16 index = 0;
+    for (size_t length = 1; length <= huffman_max_code_length; ++length) {
+        table.first_index[length] = index;
+        for (u16 symbol = 0; symbol <= huffman_eos; ++symbol) {
+            if (huffman_codes[symbol].length != length)
+                continue;
+            if (index == table.first_index[length])
+                table.first_code[length] = huffman_codes[symbol].bits;
+            table.symbols[index++] = symbol;
+        }
+    }
+    return table;
+}
+
+static constexpr HuffmanDecodeTable huffman_decode_table = build_huffman_decode_table();
+
+size_t huffman_encoded_length(const StringView& string)
+{
+    size_t bit_count = 0;
+    for (auto ch : string)
+        bit_count += huffman_codes[(u8)ch].length;
+    return (bit_count + 7) / 8;
+}
+
+void huffman_encode(const StringView& string, ByteBuffer& output)
+{
+    auto offset = output.size();
+    output.resize(offset + huffman_encoded_length(string));
+    auto* data = output.data() + offset;
+
+    u64 pending_bits = 0;
+    size_t pending_bit_count = 0;
+    for (auto ch : string) {
+        auto& code = huffman_codes[(u8)ch];
+        pending_bits = (pending_bits << code.length) | code.bits;
+        pending_bit_count += code.length;
+        while (pending_bit_count >= 8) {
+            pending_bit_count -= 8;
+            *data++ = (u8)(pending_bits >> pending_bit_count);
+        }
+    }
+    // The last byte is padded with the most significant bits of EOS, which are all ones.
+    if (pending_bit_count > 0)
+        *data = (u8)((pending_bits << (8 - pending_bit_count)) | (0xff >> pending_bit_count));
+}
+
+Optional<String> huffman_decode(ReadonlyBytes encoded)
+{
+    StringBuilder builder(encoded.size() * 8 / 5);
+    u32 code = 0;
+    size_t length = 0;
+    for (auto byte : encoded) {
+        for (int bit = 7; bit >= 0; --bit) {
+            code = (code << 1) | ((byte >> bit) & 1);
+            ++length;
+            auto offset = code - huffman_decode_table.first_code[length];
+            if (offset >= huffman_decode_table.code_count[length])
+                continue;
+            auto symbol = huffman_decode_table.symbols[huffman_decode_table.first_index[length] + offset];
+            if (symbol == huffman_eos)
+                return {};
+            builder.append((char)symbol);
+            code = 0;
+            length = 0;
+        }
+    }
+    // Only the beginning of EOS may be left over, as padding to a whole byte (RFC 7541 section 5.2).
+    if (length > 7 || code != (1u << length) - 1)
+        return {};
+    return builder.to_string();
+}
+
+static void append_byte(ByteBuffer& output, u8 byte)
+{
+    output.append(&byte, 1);
+}
+
+// RFC 7541 section 5.1: the value goes into the low prefix_bits of the first byte if it fits, and continues
+// in 7-bit groups otherwise. The bits above the prefix are the flags that say what the value is for.
+static void encode_integer(ByteBuffer& output, u8 flags, u8 prefix_bits, u32 value)
+{
+    u8 max_prefix = (1 << prefix_bits) - 1;
+    if (value < max_prefix) {
+        append_byte(output, flags | value);
+        return;
+    }
+    append_byte(output, flags | max_prefix);
+    value -= max_prefix;
+    while (value >= 128) {
+        append_byte(output, 0x80 | (value & 0x7f));
+        value >>= 7;
+    }
+    append_byte(output, value);
+}
+
+static void encode_string(ByteBuffer& output, const StringView& string)
+{
+    auto huffman_length = huffman_encoded_length(string);
+    if (huffman_length < string.length()) {
+        encode_integer(output, 0x80, 7, huffman_length);
+        huffman_encode(string, output);
+    } else {
+        encode_integer(output, 0, 7, string.length());
+        output.append(string.characters_without_null_termination(), string.length());
+    }
+}
+
+class Reader {
+public:
+    explicit Reader(ReadonlyBytes data)
+        : m_data(data)
+    {
+    }
+
+    bool is_eof() const { return m_offset >= m_data.size(); }
+    u8 peek() const { return m_data[m_offset]; }
+
+    Optional<u32> read_integer(u8 prefix_bits)
+    {
+        if (is_eof())
+            return {};
+        u8 max_prefix = (1 << prefix_bits) - 1;
+        u64 value = m_data[m_offset++] & max_prefix;
+        if (value < max_prefix)
+            return value;
+        for (size_t shift = 0;; shift += 7) {
+            // Anything that doesn't fit into 32 bits is way past any limit that we'd accept anyway.
+            if (is_eof() || shift > 28)
+                return {};
+            auto byte = m_data[m_offset++];
+            value += (u64)(byte & 0x7f) << shift;
+            if (value > NumericLimits<u32>::max())
+                return {};
+            if (!(byte & 0x80))
+                return value;
+        }
+    }
+
+    Optional<String> read_string()
+    {
+        if (is_eof())
+            return {};
+        bool is_huffman_encoded = peek() & 0x80;
+        auto length = read_integer(7);
+        if (!length.has_value() || length.value() > m_data.size() - m_offset)
+            return {};
+        auto bytes = m_data.slice(m_offset, length.value());
+        m_offset += length.value();
+        if (is_huffman_encoded)
+            return huffman_decode(bytes);
+        return String { bytes };
+    }
+
+private:
+    ReadonlyBytes m_data;
+    size_t m_offset { 0 };
+};
+
+void DynamicTable::set_max_size(size_t max_size)
+{
+    m_max_size = max_size;
+    evict_until_size_is_at_most(max_size);
+}
+
+void DynamicTable::add(Header header)
+{
+    // An entry that is too large for the table empties it, and is not added (RFC 7541 section 4.4).
+    auto size = entry_size(header);
+    if (size > m_max_size) {
+        evict_until_size_is_at_most(0);
+        return;
+    }
+    evict_until_size_is_at_most(m_max_size - size);
+    m_entries.prepend(move(header));
+    m_size += size;
+}
+
+void DynamicTable::evict_until_size_is_at_most(size_t size)
+{
+    while (m_size > size) {
+        m_size -= entry_size(m_entries.last());
+        m_entries.take_last();
+    }
+}
+
+Decoder::Decoder(size_t max_table_size, size_t max_header_list_size)
+    : m_max_table_size(max_table_size)
+    , m_max_header_list_size(max_header_list_size)
+{
+    m_table.set_max_size(max_table_size);
+}
+
+Optional<Header> Decoder::header_at_index(size_t index) const
+{
+    if (index == 0)
+        return {};
+    if (index <= static_table_size) {
+        auto& header = static_table[index - 1];
+        return Header { header.name, header.value };
+    }
+    index -= static_table_size + 1;
+    if (index >= m_table.entry_count())
+        return {};
+    return m_table.entry(index);
+}
+
+Optional<Vector<Header>> Decoder::decode(ReadonlyBytes block)
+{
+    Vector<Header> headers;
+    size_t header_list_size = 0;
+    Reader reader(block);
+    while (!reader.is_eof()) {
+        auto first_byte = reader.peek();
+
+        if ((first_byte & 0xe0) == 0x20) {
+            // Dynamic table size update, which has to come before the first header.
+            auto max_size = reader.read_integer(5);
+            if (!headers.is_empty() || !max_size.has_value() || max_size.value() > m_max_table_size)
+                return {};
+            m_table.set_max_size(max_size.value());
+            continue;
+        }
+
+        Optional<Header> header;
+        bool add_to_table = false;
+        if (first_byte & 0x80) {
+            // Indexed header field
+            auto index = reader.read_integer(7);
+            if (!index.has_value())
+                return {};
+            header = header_at_index(index.value());
+        } else {
+            // Literal header field with incremental indexing (6-bit prefix), without indexing, or never
+            // indexed (4-bit prefixes). A name index of 0 means that the name follows as a literal as well.
+            add_to_table = first_byte & 0x40;
+            auto name_index = reader.read_integer(add_to_table ? 6 : 4);
+            if (!name_index.has_value())
+                return {};
+            Optional<String> name;
+            if (name_index.value() == 0) {
+                name = reader.read_string();
+            } else if (auto indexed_header = header_at_index(name_index.value()); indexed_header.has_value()) {
+                name = indexed_header.value().name;
+            }
+            if (!name.has_value())
+                return {};
+            auto value = reader.read_string();
+            if (!value.has_value())
+                return {};
+            header = Header { name.release_value(), value.release_value() };
+        }
+        if (!header.has_value())
+            return {};
+
+        header_list_size += DynamicTable::entry_size(header.value());
+        if (header_list_size > m_max_header_list_size)
+            return {};
+        if (add_to_table)
+            m_table.add(header.value());
+        headers.append(header.release_value());
+    }
+    return headers;
+}
+
+void Encoder::set_max_table_size(size_t max_size)
+{
+    // We don't need more than the default to get the common headers across, however much the decoder would take.
+    max_size = min(max_size, default_table_size);
+    if (max_size == m_table.max_size())
+        return;
+    m_smallest_pending_size = m_has_pending_size_update ? min(m_smallest_pending_size, max_size) : min(m_table.max_size(), max_size);
+    m_has_pending_size_update = true;
+    m_table.set_max_size(max_size);
+}
+
+// Values that are different for almost every request only push more useful entries out of the table.
+static bool should_index(const Header& header)
+{
+    return header.name != ":path" && header.name != "content-length" && header.name != "if-none-match" && header.name != "if-modified-since";
+}
+
+// Credentials are never indexed, so they can't be probed for through the table (RFC 7541 section 7.1.3).
+static bool is_sensitive(const Header& header)
+{
+    if (header.name == "authorization" || header.name == "proxy-authorization")
+        return true;
+    return header.name == "cookie" && header.value.length() < 20;
+}
+
+void Encoder::encode(const Vector<Header>& headers, ByteBuffer& output)
+{
+    if (m_has_pending_size_update) {
+        if (m_smallest_pending_size < m_table.max_size())
+            encode_integer(output, 0x20, 5, m_smallest_pending_size);
+        encode_integer(output, 0x20, 5, m_table.max_size());
+        m_has_pending_size_update = false;
+    }
+
+    for (auto& header : headers) {
+        size_t name_index = 0;
+        size_t index = 0;
+        for (size_t i = 0; i < static_table_size && index == 0; ++i) {
+            if (header.name != static_table[i].name)
+                continue;
+            if (name_index == 0)
+                name_index = i + 1;
+            if (header.value == static_table[i].value)
+                index = i + 1;
+        }
+        for (size_t i = 0; i < m_table.entry_count() && index == 0; ++i) {
+            auto& entry = m_table.entry(i);
+            if (entry.name != header.name)
+                continue;
+            if (name_index == 0)
+                name_index = static_table_size + i + 1;
+            if (entry.value == header.value)
+                index = static_table_size + i + 1;
+        }
+
+        if (index != 0) {
+            encode_integer(output, 0x80, 7, index);
+            continue;
+        }
+
+        bool add_to_table = false;
+        if (is_sensitive(header)) {
+            encode_integer(output, 0x10, 4, name_index);
+        } else if (should_index(header) && DynamicTable::entry_size(header) <= m_table.max_size() / 2) {
+            add_to_table = true;
+            encode_integer(output, 0x40, 6, name_index);
+        } else {
+            encode_integer(output, 0, 4, name_index);
+        }
+        if (name_index == 0)
+            encode_string(output, header.name);
+        encode_string(output, header.value);
+        if (add_to_table)
+            m_table.add(header);
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+// Header compression for HTTP/2 (RFC 7541).
+namespace HTTP::HPACK {
+
+static constexpr size_t default_table_size = 4096;
+
+struct Header {
+    String name;
+    String value;
+};
+
+// The headers that both ends remember from earlier header blocks, newest first.
+// Since every header block may change the table, the blocks have to be decoded in the order they were encoded.
+class DynamicTable {
+public:
+    // What an entry counts against the maximum size of the table (RFC 7541 section 4.1).
+    static size_t entry_size(const Header& header) { return header.name.length() + header.value.length() + 32; }
+
+    size_t size() const { return m_size; }
+    size_t max_size() const { return m_max_size; }
+    size_t entry_count() const { return m_entries.size(); }
+    const Header& entry(size_t index) const { return m_entries[index]; }
+
+    void set_max_size(size_t);
+    void add(Header);
+
+private:
+    void evict_until_size_is_at_most(size_t);
+
+    Vector<Header> m_entries;
+    size_t m_size { 0 };
+    size_t m_max_size { default_table_size };
+};
+
+class Decoder {
+public:
+    // The encoder on the other end may use a table of up to max_table_size, which is what we sent as our
+    // SETTINGS_HEADER_TABLE_SIZE. A header block that decodes to more than max_header_list_size is refused.
+    explicit Decoder(size_t max_table_size = default_table_size, size_t max_header_list_size = 256 * KiB);
+
+    // Decodes a complete header block. Returns nothing if it is malformed, after which the table is out of
+    // sync with the encoder's, and the connection has to go (a COMPRESSION_ERROR).
+    Optional<Vector<Header>> decode(ReadonlyBytes);
+
+    const DynamicTable& table() const { return m_table; }
+
+private:
+    Optional<Header> header_at_index(size_t index) const;
+
+    DynamicTable m_table;
+    size_t m_max_table_size { default_table_size };
+    size_t m_max_header_list_size { 0 };
+};
+
+class Encoder {
+public:
+    // Called with the SETTINGS_HEADER_TABLE_SIZE of the other end, which is the most that our table may use.
+    void set_max_table_size(size_t);
+
+    // Appends the header block for the headers, whose names have to be lowercase, to the output.
+    void encode(const Vector<Header>&, ByteBuffer& output);
+
+    const DynamicTable& table() const { return m_table; }
+
+private:
+    DynamicTable m_table;
+    // The smallest size that the table had since the last header block, and whether it changed at all.
+    // The decoder has to learn about both, since it evicts whatever the smaller size doesn't fit.
+    size_t m_smallest_pending_size { 0 };
+    bool m_has_pending_size_update { false };
+};
+
+// The string encoding of RFC 7541 appendix B. Decoding returns nothing if the input is not a valid encoding.
+size_t huffman_encoded_length(const StringView&);
+void huffman_encode(const StringView&, ByteBuffer& output);
+Optional<String> huffman_decode(ReadonlyBytes);
+
+}
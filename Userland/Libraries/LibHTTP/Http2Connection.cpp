@@ -0,0 +1,680 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/StringBuilder.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibHTTP/Job.h>
+
+namespace HTTP {
+
+static const char connection_preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+static constexpr size_t frame_header_size = 9;
+// Frames of this size are what every endpoint has to take (SETTINGS_MAX_FRAME_SIZE, RFC 7540 section 6.5.2).
+// We neither send nor accept larger ones, since a TLS record doesn't carry more anyway.
+static constexpr u32 max_frame_size = 16384;
+static constexpr u32 max_window_size = 0x7fffffff;
+static constexpr u32 max_stream_id = 0x7fffffff;
+
+// Our receive windows are large enough to not hold back a fast download. Like the HTTP/1.1 jobs, we take in
+// whatever arrives and leave it to the jobs to buffer what their clients haven't read yet.
+static constexpr u32 default_window_size = 65535;
+static constexpr u32 stream_receive_window = 4 * MiB;
+static constexpr u32 connection_receive_window = 16 * MiB;
+static constexpr u32 max_header_list_size = 256 * KiB;
+
+static constexpr u8 flag_end_stream = 0x1;
+static constexpr u8 flag_ack = 0x1;
+static constexpr u8 flag_end_headers = 0x4;
+static constexpr u8 flag_padded = 0x8;
+static constexpr u8 flag_priority = 0x20;
+
+enum class Setting : u16 {
+    HeaderTableSize = 0x1,
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+    MaxFrameSize = 0x5,
+    MaxHeaderListSize = 0x6,
+};
+
+static u32 load_u32(const u8* data)
+{
+    return ((u32)data[0] << 24) | ((u32)data[1] << 16) | ((u32)data[2] << 8) | data[3];
+}
+
+static void store_u32(u8* data, u32 value)
+{
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+// Headers that only mean something for a single HTTP/1.1 connection must not be sent (RFC 7540 section 8.1.2.2).
+// The ones that the pseudo-headers and the frames take care of are left out as well.
+static bool is_connection_specific_header(const String& name)
+{
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection" || name == "transfer-encoding"
+        || name == "upgrade" || name == "te" || name == "host" || name == "content-length";
+}
+
+// Takes the padding off a frame whose PADDED flag is set (RFC 7540 section 6.1).
+static Optional<ReadonlyBytes> remove_padding(u8 flags, ReadonlyBytes payload)
+{
+    if (!(flags & flag_padded))
+        return payload;
+    if (payload.is_empty() || payload[0] >= payload.size())
+        return {};
+    return payload.slice(1, payload.size() - 1 - payload[0]);
+}
+
+Http2Connection::Http2Connection(NonnullRefPtr<TLS::TLSv12> socket, Core::Object* parent)
+    : Core::Object(parent)
+    , m_socket(move(socket))
+    , m_decoder(HPACK::default_table_size, max_header_list_size)
+{
+    add_child(*m_socket);
+    m_socket->on_tls_ready_to_read = [this](auto&) {
+        did_receive_data();
+    };
+    m_socket->on_tls_ready_to_write = nullptr;
+    m_socket->on_tls_connected = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    m_socket->on_tls_finished = [this] {
+        dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: The server closed the connection");
+        NonnullRefPtr<Http2Connection> protector(*this);
+        fail_streams_after(0, Core::NetworkJob::Error::TransmissionFailed);
+        did_close();
+    };
+    m_socket->on_tls_error = [this](auto) {
+        NonnullRefPtr<Http2Connection> protector(*this);
+        fail_streams_after(0, Core::NetworkJob::Error::TransmissionFailed);
+        did_close();
+    };
+
+    m_output.append(connection_preface, sizeof(connection_preface) - 1);
+    send_settings();
+    send_window_update(0, connection_receive_window - default_window_size);
+    m_idle_time.start();
+
+    // The server may have sent its SETTINGS right behind the end of the handshake.
+    if (m_socket->can_read()) {
+        deferred_invoke([this](auto&) {
+            did_receive_data();
+        });
+    }
+}
+
+Http2Connection::~Http2Connection()
+{
+}
+
+bool Http2Connection::is_usable() const
+{
+    return !m_is_closing && !m_go_away_received && !m_is_closed && m_next_stream_id <= max_stream_id;
+}
+
+void Http2Connection::send_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    VERIFY(payload.size() <= max_frame_size);
+    u8 header[frame_header_size];
+    header[0] = payload.size() >> 16;
+    header[1] = payload.size() >> 8;
+    header[2] = payload.size();
+    header[3] = (u8)type;
+    header[4] = flags;
+    store_u32(header + 5, stream_id);
+    m_output.append(header, frame_header_size);
+    m_output.append(payload.data(), payload.size());
+
+    // Everything that comes up until we're back in the event loop goes out in as few TLS records as possible.
+    if (!m_has_scheduled_flush) {
+        m_has_scheduled_flush = true;
+        deferred_invoke([this](auto&) {
+            flush_output();
+        });
+    }
+}
+
+void Http2Connection::flush_output()
+{
+    m_has_scheduled_flush = false;
+    if (m_output.is_empty())
+        return;
+    if (!m_socket->write(m_output))
+        dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: Could not send {} bytes", m_output.size());
+    m_output.clear_with_capacity();
+}
+
+void Http2Connection::send_settings()
+{
+    auto append_setting = [](ByteBuffer& payload, Setting setting, u32 value) {
+        u8 entry[6];
+        entry[0] = (u16)setting >> 8;
+        entry[1] = (u16)setting;
+        store_u32(entry + 2, value);
+        payload.append(entry, sizeof(entry));
+    };
+    ByteBuffer payload;
+    append_setting(payload, Setting::EnablePush, 0);
+    append_setting(payload, Setting::InitialWindowSize, stream_receive_window);
+    append_setting(payload, Setting::MaxHeaderListSize, max_header_list_size);
+    send_frame(FrameType::Settings, 0, 0, payload);
+}
+
+void Http2Connection::send_window_update(u32 stream_id, u32 increment)
+{
+    u8 payload[4];
+    store_u32(payload, increment);
+    send_frame(FrameType::WindowUpdate, 0, stream_id, { payload, sizeof(payload) });
+}
+
+void Http2Connection::send_reset_stream(u32 stream_id, ErrorCode error_code)
+{
+    u8 payload[4];
+    store_u32(payload, (u32)error_code);
+    send_frame(FrameType::ResetStream, 0, stream_id, { payload, sizeof(payload) });
+}
+
+void Http2Connection::send_go_away(ErrorCode error_code)
+{
+    if (m_is_closed)
+        return;
+    // The server can't open streams (we don't take pushes), so there is never one that we processed.
+    u8 payload[8];
+    store_u32(payload, 0);
+    store_u32(payload + 4, (u32)error_code);
+    send_frame(FrameType::GoAway, 0, 0, { payload, sizeof(payload) });
+}
+
+void Http2Connection::start_stream(Job& job)
+{
+    VERIFY(is_usable());
+    if (m_streams.size() >= m_max_concurrent_streams) {
+        dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: {} streams are open already, queueing the request", m_streams.size());
+        m_queued_jobs.append(&job);
+        return;
+    }
+    open_stream(job);
+}
+
+void Http2Connection::open_stream(Job& job)
+{
+    auto& request = job.request();
+    auto& url = request.url();
+
+    StringBuilder authority;
+    authority.append(url.host());
+    if (url.port() != URL::default_port_for_scheme(url.scheme()))
+        authority.appendff(":{}", url.port());
+
+    StringBuilder path;
+    path.append(URL::percent_encode(url.path(), URL::PercentEncodeSet::EncodeURI));
+    if (!url.query().is_empty()) {
+        path.append('?');
+        path.append(URL::percent_encode(url.query(), URL::PercentEncodeSet::EncodeURI));
+    }
+
+    Vector<HPACK::Header> headers;
+    headers.append({ ":method", request.method_name() });
+    headers.append({ ":scheme", url.scheme() });
+    headers.append({ ":authority", authority.to_string() });
+    headers.append({ ":path", path.to_string() });
+    for (auto& header : request.headers()) {
+        auto name = header.name.to_lowercase();
+        if (!is_connection_specific_header(name))
+            headers.append({ move(name), header.value });
+    }
+    bool has_body = !request.body().is_empty();
+    if (has_body)
+        headers.append({ "content-length", String::number(request.body().size()) });
+
+    ByteBuffer header_block;
+    m_encoder.encode(headers, header_block);
+
+    auto stream_id = m_next_stream_id;
+    m_next_stream_id += 2;
+    dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: Stream {} is for {}", stream_id, url);
+
+    // A header block that doesn't fit into one frame continues in CONTINUATION frames, with nothing in between.
+    size_t offset = 0;
+    auto type = FrameType::Headers;
+    do {
+        auto size = min(header_block.size() - offset, (size_t)max_frame_size);
+        u8 flags = 0;
+        if (offset + size == header_block.size())
+            flags |= flag_end_headers;
+        if (type == FrameType::Headers && !has_body)
+            flags |= flag_end_stream;
+        send_frame(type, flags, stream_id, header_block.bytes().slice(offset, size));
+        offset += size;
+        type = FrameType::Continuation;
+    } while (offset < header_block.size());
+
+    m_streams.set(stream_id, { &job, m_initial_send_window, has_body ? request.body() : ByteBuffer {}, 0, 0 });
+    if (has_body)
+        send_request_body(stream_id, m_streams.find(stream_id)->value);
+
+    if (m_next_stream_id > max_stream_id)
+        did_become_unusable();
+}
+
+// Sends as much of the request body as the flow control windows allow, the rest goes out on WINDOW_UPDATE.
+void Http2Connection::send_request_body(u32 stream_id, Stream& stream)
+{
+    while (stream.body_offset < stream.body.size()) {
+        auto window = min(stream.send_window, m_connection_send_window);
+        if (window <= 0)
+            return;
+        auto size = min(min(stream.body.size() - stream.body_offset, (size_t)max_frame_size), (size_t)window);
+        bool is_last = stream.body_offset + size == stream.body.size();
+        send_frame(FrameType::Data, is_last ? flag_end_stream : 0, stream_id, stream.body.bytes().slice(stream.body_offset, size));
+        stream.body_offset += size;
+        stream.send_window -= size;
+        m_connection_send_window -= size;
+    }
+    stream.body.clear();
+    stream.body_offset = 0;
+}
+
+void Http2Connection::send_request_bodies()
+{
+    for (auto& it : m_streams) {
+        if (!it.value.body.is_empty())
+            send_request_body(it.key, it.value);
+    }
+}
+
+void Http2Connection::finish_stream(u32 stream_id)
+{
+    m_streams.remove(stream_id);
+    start_queued_streams();
+    if (has_streams())
+        return;
+
+    m_idle_time.start();
+    if (!is_usable() && !m_is_closed) {
+        send_go_away(ErrorCode::NoError);
+        did_close();
+    }
+}
+
+void Http2Connection::start_queued_streams()
+{
+    while (!m_queued_jobs.is_empty() && m_streams.size() < m_max_concurrent_streams && !m_go_away_received && !m_is_closed) {
+        auto* job = m_queued_jobs.take_first();
+        if (m_next_stream_id > max_stream_id) {
+            job->did_fail_http2_stream(Core::NetworkJob::Error::ConnectionFailed);
+            continue;
+        }
+        open_stream(*job);
+    }
+}
+
+void Http2Connection::cancel_stream(Job& job)
+{
+    if (m_queued_jobs.remove_first_matching([&](auto* queued_job) { return queued_job == &job; }))
+        return;
+
+    for (auto& it : m_streams) {
+        if (it.value.job != &job)
+            continue;
+        auto stream_id = it.key;
+        dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: Cancelling stream {}", stream_id);
+        if (!m_is_closed)
+            send_reset_stream(stream_id, ErrorCode::Cancel);
+        finish_stream(stream_id);
+        return;
+    }
+}
+
+void Http2Connection::close()
+{
+    if (m_is_closing || m_is_closed)
+        return;
+    m_is_closing = true;
+    did_become_unusable();
+    if (!has_streams()) {
+        send_go_away(ErrorCode::NoError);
+        did_close();
+    }
+}
+
+void Http2Connection::did_receive_data()
+{
+    NonnullRefPtr<Http2Connection> protector(*this);
+    if (m_is_closed)
+        return;
+
+    if (auto data = m_socket->read(); data.has_value())
+        m_input.append(data.value().data(), data.value().size());
+
+    size_t offset = 0;
+    while (m_input.size() - offset >= frame_header_size) {
+        auto* header = m_input.data() + offset;
+        u32 length = (header[0] << 16) | (header[1] << 8) | header[2];
+        if (length > max_frame_size) {
+            fail(ErrorCode::FrameSizeError);
+            return;
+        }
+        if (m_input.size() - offset < frame_header_size + length)
+            break;
+
+        auto type = (FrameType)header[3];
+        auto flags = header[4];
+        auto stream_id = load_u32(header + 5) & max_stream_id;
+        auto payload = m_input.bytes().slice(offset + frame_header_size, length);
+        offset += frame_header_size + length;
+        if (!handle_frame(type, flags, stream_id, payload) || m_is_closed)
+            return;
+    }
+
+    if (offset == m_input.size())
+        m_input.clear_with_capacity();
+    else if (offset > 0)
+        m_input = m_input.slice(offset, m_input.size() - offset);
+
+    if (m_connection_unacknowledged_size >= connection_receive_window / 2) {
+        send_window_update(0, m_connection_unacknowledged_size);
+        m_connection_unacknowledged_size = 0;
+    }
+}
+
+bool Http2Connection::handle_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    // Nothing may come between the frames of a header block (RFC 7540 section 6.10).
+    if (m_header_block_stream_id != 0 && type != FrameType::Continuation)
+        return fail(ErrorCode::ProtocolError);
+
+    switch (type) {
+    case FrameType::Data:
+        return handle_data(flags, stream_id, payload);
+    case FrameType::Headers:
+    case FrameType::Continuation:
+        return handle_headers(type, flags, stream_id, payload);
+    case FrameType::Priority:
+        // We leave it to the server to decide what goes first.
+        return true;
+    case FrameType::ResetStream:
+        return handle_reset_stream(stream_id, payload);
+    case FrameType::Settings:
+        return handle_settings(flags, stream_id, payload);
+    case FrameType::PushPromise:
+        // We told the server that we don't take pushes.
+        return fail(ErrorCode::ProtocolError);
+    case FrameType::Ping:
+        return handle_ping(flags, stream_id, payload);
+    case FrameType::GoAway:
+        return handle_go_away(stream_id, payload);
+    case FrameType::WindowUpdate:
+        return handle_window_update(stream_id, payload);
+    }
+    // Frames of types that we don't know are to be ignored.
+    return true;
+}
+
+bool Http2Connection::handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return fail(ErrorCode::ProtocolError);
+
+    // The padding counts against the flow control windows as well.
+    m_connection_unacknowledged_size += payload.size();
+    auto data = remove_padding(flags, payload);
+    if (!data.has_value())
+        return fail(ErrorCode::ProtocolError);
+
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end()) {
+        // Whatever was still on its way when we cancelled a stream doesn't matter anymore.
+        return is_known_stream(stream_id) ? true : fail(ErrorCode::ProtocolError);
+    }
+
+    auto& stream = it->value;
+    auto* job = stream.job;
+    bool end_stream = flags & flag_end_stream;
+    if (end_stream) {
+        finish_stream(stream_id);
+    } else {
+        stream.unacknowledged_size += payload.size();
+        if (stream.unacknowledged_size >= stream_receive_window / 2) {
+            send_window_update(stream_id, stream.unacknowledged_size);
+            stream.unacknowledged_size = 0;
+        }
+    }
+    job->did_receive_http2_data(data.value(), end_stream);
+    return true;
+}
+
+bool Http2Connection::handle_headers(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return fail(ErrorCode::ProtocolError);
+
+    if (type == FrameType::Headers) {
+        auto fragment = remove_padding(flags, payload);
+        if (!fragment.has_value())
+            return fail(ErrorCode::ProtocolError);
+        if (flags & flag_priority) {
+            if (fragment.value().size() < 5)
+                return fail(ErrorCode::FrameSizeError);
+            fragment = fragment.value().slice(5);
+        }
+        m_header_block.clear_with_capacity();
+        m_header_block.append(fragment.value().data(), fragment.value().size());
+        m_header_block_stream_id = stream_id;
+        m_header_block_ends_stream = flags & flag_end_stream;
+    } else {
+        if (stream_id != m_header_block_stream_id)
+            return fail(ErrorCode::ProtocolError);
+        m_header_block.append(payload.data(), payload.size());
+    }
+
+    if (m_header_block.size() > max_header_list_size)
+        return fail(ErrorCode::EnhanceYourCalm);
+    if (!(flags & flag_end_headers))
+        return true;
+
+    m_header_block_stream_id = 0;
+    return handle_header_block(stream_id, m_header_block_ends_stream);
+}
+
+bool Http2Connection::handle_header_block(u32 stream_id, bool end_stream)
+{
+    // Every header block has to be decoded, even for streams that we gave up on, to keep the table in sync.
+    auto headers = m_decoder.decode(m_header_block);
+    if (!headers.has_value())
+        return fail(ErrorCode::CompressionError);
+
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return is_known_stream(stream_id) ? true : fail(ErrorCode::ProtocolError);
+
+    auto* job = it->value.job;
+    if (end_stream)
+        finish_stream(stream_id);
+    job->did_receive_http2_headers(headers.value(), end_stream);
+    return true;
+}
+
+bool Http2Connection::handle_reset_stream(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return fail(ErrorCode::FrameSizeError);
+    if (stream_id == 0)
+        return fail(ErrorCode::ProtocolError);
+
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return true;
+    auto error_code = (ErrorCode)load_u32(payload.data());
+    dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: The server reset stream {} with error {}", stream_id, (u32)error_code);
+    auto* job = it->value.job;
+    finish_stream(stream_id);
+    job->did_fail_http2_stream(error_code == ErrorCode::RefusedStream ? Core::NetworkJob::Error::ConnectionFailed : Core::NetworkJob::Error::TransmissionFailed);
+    return true;
+}
+
+bool Http2Connection::handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail(ErrorCode::ProtocolError);
+    if (flags & flag_ack)
+        return payload.is_empty() ? true : fail(ErrorCode::FrameSizeError);
+    if (payload.size() % 6 != 0)
+        return fail(ErrorCode::FrameSizeError);
+
+    for (size_t offset = 0; offset < payload.size(); offset += 6) {
+        auto setting = (Setting)((payload[offset] << 8) | payload[offset + 1]);
+        auto value = load_u32(payload.offset(offset + 2));
+        switch (setting) {
+        case Setting::HeaderTableSize:
+            m_encoder.set_max_table_size(value);
+            break;
+        case Setting::EnablePush:
+            if (value > 1)
+                return fail(ErrorCode::ProtocolError);
+            break;
+        case Setting::MaxConcurrentStreams:
+            m_max_concurrent_streams = value;
+            break;
+        case Setting::InitialWindowSize: {
+            if (value > max_window_size)
+                return fail(ErrorCode::FlowControlError);
+            // The windows of the streams that are open already change by as much as the initial size did.
+            i64 delta = (i64)value - m_initial_send_window;
+            for (auto& it : m_streams)
+                it.value.send_window += delta;
+            m_initial_send_window = value;
+            break;
+        }
+        case Setting::MaxFrameSize:
+            if (value < 16384 || value > 16777215)
+                return fail(ErrorCode::ProtocolError);
+            break;
+        case Setting::MaxHeaderListSize:
+            break;
+        }
+    }
+    send_frame(FrameType::Settings, flag_ack, 0, {});
+
+    start_queued_streams();
+    send_request_bodies();
+    return true;
+}
+
+bool Http2Connection::handle_ping(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 8)
+        return fail(ErrorCode::FrameSizeError);
+    if (stream_id != 0)
+        return fail(ErrorCode::ProtocolError);
+    if (!(flags & flag_ack))
+        send_frame(FrameType::Ping, flag_ack, 0, payload);
+    return true;
+}
+
+bool Http2Connection::handle_go_away(u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail(ErrorCode::ProtocolError);
+    if (payload.size() < 8)
+        return fail(ErrorCode::FrameSizeError);
+
+    // The streams up to the last one that the server processed still get their responses, the others never will.
+    auto last_stream_id = load_u32(payload.data()) & max_stream_id;
+    dbgln_if(HTTPSJOB_DEBUG, "Http2Connection: The server is going away after stream {} with error {}", last_stream_id, load_u32(payload.offset(4)));
+    m_go_away_received = true;
+    did_become_unusable();
+    fail_streams_after(last_stream_id, Core::NetworkJob::Error::ConnectionFailed);
+    if (!has_streams()) {
+        send_go_away(ErrorCode::NoError);
+        did_close();
+    }
+    return true;
+}
+
+bool Http2Connection::handle_window_update(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return fail(ErrorCode::FrameSizeError);
+    auto increment = load_u32(payload.data()) & max_window_size;
+    if (increment == 0)
+        return fail(ErrorCode::ProtocolError);
+
+    if (stream_id == 0) {
+        m_connection_send_window += increment;
+        if (m_connection_send_window > max_window_size)
+            return fail(ErrorCode::FlowControlError);
+    } else {
+        auto it = m_streams.find(stream_id);
+        if (it == m_streams.end())
+            return true;
+        it->value.send_window += increment;
+        if (it->value.send_window > max_window_size)
+            return fail(ErrorCode::FlowControlError);
+    }
+    send_request_bodies();
+    return true;
+}
+
+bool Http2Connection::fail(ErrorCode error_code, Core::NetworkJob::Error error)
+{
+    dbgln("Http2Connection: Closing the connection with error {}", (u32)error_code);
+    send_go_away(error_code);
+    fail_streams_after(0, error);
+    did_close();
+    return false;
+}
+
+void Http2Connection::fail_streams_after(u32 last_stream_id, Core::NetworkJob::Error error)
+{
+    Vector<u32> stream_ids;
+    for (auto& it : m_streams) {
+        if (it.key > last_stream_id)
+            stream_ids.append(it.key);
+    }
+    for (auto stream_id : stream_ids) {
+        auto* job = m_streams.get(stream_id).value().job;
+        m_streams.remove(stream_id);
+        job->did_fail_http2_stream(error);
+    }
+
+    auto queued_jobs = move(m_queued_jobs);
+    for (auto* job : queued_jobs)
+        job->did_fail_http2_stream(error);
+
+    if (!has_streams())
+        m_idle_time.start();
+}
+
+void Http2Connection::did_become_unusable()
+{
+    if (m_did_become_unusable)
+        return;
+    m_did_become_unusable = true;
+    NonnullRefPtr<Http2Connection> protector(*this);
+    if (on_close)
+        on_close();
+}
+
+void Http2Connection::did_close()
+{
+    if (m_is_closed)
+        return;
+    flush_output();
+    m_is_closed = true;
+    m_header_block_stream_id = 0;
+    // The socket sends what we just gave it once we're back in the event loop, so it can only close after that.
+    deferred_invoke([](auto& object) {
+        static_cast<Http2Connection&>(object).m_socket->close();
+    });
+    did_become_unusable();
+}
+
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/NetworkJob.h>
+#include <LibCore/Object.h>
+#include <LibHTTP/Forward.h>
+#include <LibHTTP/HPACK.h>
+#include <LibTLS/TLSv12.h>
+
+namespace HTTP {
+
+// An HTTP/2 connection (RFC 7540) over TLS, which carries any number of requests to the same origin at the
+// same time, each of them on a stream of its own. The connection has to be negotiated through ALPN ("h2").
+// The jobs whose requests it carries get the responses through the same interface as with HTTP/1.1.
+class Http2Connection final : public Core::Object {
+    C_OBJECT(Http2Connection);
+
+public:
+    virtual ~Http2Connection() override;
+
+    // Whether new requests can still go on this connection, which they can't once either end started to close it.
+    bool is_usable() const;
+
+    // Whether any request is in flight (or waiting for the server to allow another stream).
+    bool has_streams() const { return !m_streams.is_empty() || !m_queued_jobs.is_empty(); }
+    // How long the connection has been without requests.
+    const Core::ElapsedTimer& idle_time() const { return m_idle_time; }
+
+    // Sends the job's request on a new stream. The job is told about the response as it comes in.
+    void start_stream(Job&);
+    // Stops telling the job about its response, and asks the server to stop sending it.
+    void cancel_stream(Job&);
+
+    // Lets the server know that we're done, once the requests that are in flight are.
+    void close();
+
+    // Called once the connection can't take new requests anymore.
+    Function<void()> on_close;
+
+private:
+    explicit Http2Connection(NonnullRefPtr<TLS::TLSv12>, Core::Object* parent = nullptr);
+
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        ResetStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    enum class ErrorCode : u32 {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        SettingsTimeout = 0x4,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        RefusedStream = 0x7,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+        ConnectError = 0xa,
+        EnhanceYourCalm = 0xb,
+        InadequateSecurity = 0xc,
+        Http11Required = 0xd,
+    };
+
+    struct Stream {
+        Job* job { nullptr };
+        // How much more request body the server is willing to take on this stream.
+        i64 send_window { 0 };
+        ByteBuffer body;
+        size_t body_offset { 0 };
+        // Received bytes that we haven't given back to the stream's flow control window yet.
+        u32 unacknowledged_size { 0 };
+    };
+
+    void send_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void send_settings();
+    void send_window_update(u32 stream_id, u32 increment);
+    void send_reset_stream(u32 stream_id, ErrorCode);
+    void send_go_away(ErrorCode);
+    void flush_output();
+
+    void open_stream(Job&);
+    void send_request_body(u32 stream_id, Stream&);
+    void send_request_bodies();
+    void finish_stream(u32 stream_id);
+    void start_queued_streams();
+
+    void did_receive_data();
+    bool handle_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    bool handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    bool handle_headers(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    bool handle_header_block(u32 stream_id, bool end_stream);
+    bool handle_reset_stream(u32 stream_id, ReadonlyBytes payload);
+    bool handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    bool handle_ping(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    bool handle_go_away(u32 stream_id, ReadonlyBytes payload);
+    bool handle_window_update(u32 stream_id, ReadonlyBytes payload);
+
+    // Whether the stream is one that we opened, which may have been closed since.
+    bool is_known_stream(u32 stream_id) const { return stream_id % 2 == 1 && stream_id < m_next_stream_id; }
+
+    // Fails every request in flight, and closes the connection. Returns false to make it easy to bail out with.
+    bool fail(ErrorCode, Core::NetworkJob::Error = Core::NetworkJob::Error::ProtocolFailed);
+    void fail_streams_after(u32 last_stream_id, Core::NetworkJob::Error);
+    void did_become_unusable();
+    void did_close();
+
+    NonnullRefPtr<TLS::TLSv12> m_socket;
+    HPACK::Encoder m_encoder;
+    HPACK::Decoder m_decoder;
+
+    HashMap<u32, Stream> m_streams;
+    // Jobs that wait for the server to allow more concurrent streams.
+    Vector<Job*> m_queued_jobs;
+    u32 m_next_stream_id { 1 };
+    Core::ElapsedTimer m_idle_time;
+
+    ByteBuffer m_input;
+    ByteBuffer m_output;
+    bool m_has_scheduled_flush { false };
+
+    // A header block that continues in CONTINUATION frames, for the stream that it belongs to.
+    ByteBuffer m_header_block;
+    u32 m_header_block_stream_id { 0 };
+    bool m_header_block_ends_stream { false };
+
+    // What the server told us in its SETTINGS.
+    u32 m_max_concurrent_streams { 100 };
+    u32 m_initial_send_window { 65535 };
+
+    i64 m_connection_send_window { 65535 };
+    u32 m_connection_unacknowledged_size { 0 };
+
+    bool m_is_closing { false };
+    bool m_go_away_received { false };
+    bool m_is_closed { false };
+    bool m_did_become_unusable { false };
+};
+
+}
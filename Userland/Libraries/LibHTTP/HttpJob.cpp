@@ -28,6 +28,14 @@ void HttpJob::start()
     }
 }
 
+void HttpJob::start(NonnullRefPtr<Core::Socket> socket)
+{
+    VERIFY(!m_socket);
+    m_socket = move(socket);
+    add_child(*m_socket);
+    on_socket_connected();
+}
+
 void HttpJob::shutdown()
 {
     if (!m_socket)
@@ -38,9 +46,31 @@ void HttpJob::shutdown()
     m_socket = nullptr;
 }
 
+RefPtr<Core::Socket> HttpJob::take_reusable_socket()
+{
+    if (!m_socket || !can_reuse_connection() || !m_socket->is_connected() || m_socket->can_read())
+        return nullptr;
+
+    m_socket->on_ready_to_read = nullptr;
+    m_socket->on_connected = nullptr;
+    remove_child(*m_socket);
+    return move(m_socket);
+}
+
 void HttpJob::register_on_ready_to_read(Function<void()> callback)
 {
-    m_socket->on_ready_to_read = move(callback);
+    m_socket->on_ready_to_read = [this, callback = move(callback)] {
+        callback();
+
+        // What is already buffered won't make the socket readable again, and unlike one that is being
+        // closed, a persistent connection won't wake us up with an EOF either.
+        if (m_state != State::Finished && m_socket && m_socket->can_read_only_from_buffer()) {
+            deferred_invoke([this](auto&) {
+                if (m_socket && m_socket->on_ready_to_read)
+                    m_socket->on_ready_to_read();
+            });
+        }
+    };
 }
 
 void HttpJob::register_on_ready_to_write(Function<void()> callback)
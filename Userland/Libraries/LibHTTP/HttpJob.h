@@ -28,7 +28,9 @@ public:
     }
 
     virtual void start() override;
+    virtual void start(NonnullRefPtr<Core::Socket>) override;
     virtual void shutdown() override;
+    virtual RefPtr<Core::Socket> take_reusable_socket() override;
 
 protected:
     virtual bool should_fail_on_empty_payload() const override { return false; }
@@ -54,7 +54,7 @@ ByteBuffer HttpRequest::to_raw_request() const
         builder.append(header.value);
         builder.append("\r\n");
     }
-    builder.append("Connection: close\r\n");
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
     if (!m_body.is_empty()) {
         builder.appendff("Content-Length: {}\r\n\r\n", m_body.size());
         builder.append((const char*)m_body.data(), m_body.size());
@@ -166,6 +166,17 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
     request.m_resource = URL::percent_decode(resource);
     request.m_headers = move(headers);
 
+    // HTTP/1.1 connections stay open unless the client says otherwise, HTTP/1.0 ones only if it asks.
+    request.m_keep_alive = protocol == "HTTP/1.1";
+    for (auto& header : request.m_headers) {
+        if (!header.name.equals_ignoring_case("Connection"))
+            continue;
+        if (header.value.view().contains("close", CaseSensitivity::CaseInsensitive))
+            request.m_keep_alive = false;
+        else if (header.value.view().contains("keep-alive", CaseSensitivity::CaseInsensitive))
+            request.m_keep_alive = true;
+    }
+
     return request;
 }
 
@@ -45,6 +45,10 @@ public:
     void set_body(ReadonlyBytes body) { m_body = ByteBuffer::copy(body); }
     void set_body(ByteBuffer&& body) { m_body = move(body); }
 
+    // Asks the server to leave the connection open after the response, so another request can use it.
+    bool keep_alive() const { return m_keep_alive; }
+    void set_keep_alive(bool keep_alive) { m_keep_alive = keep_alive; }
+
     String method_name() const;
     ByteBuffer to_raw_request() const;
 
@@ -58,6 +62,7 @@ private:
     Method m_method { GET };
     Vector<Header> m_headers;
     ByteBuffer m_body;
+    bool m_keep_alive { false };
 };
 
 }
@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <LibCore/EventLoop.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/HttpsJob.h>
 #include <LibTLS/TLSv12.h>
@@ -19,10 +20,58 @@ void HttpsJob::start()
     VERIFY(!m_socket);
     m_socket = TLS::TLSv12::construct(this);
     m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
+    m_socket->add_alpn("h2");
+    m_socket->add_alpn("http/1.1");
     m_socket->on_tls_connected = [this] {
         dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: on_connected callback");
-        on_socket_connected();
     };
+    // We may write once the handshake is done, which is also when we know what protocol the server picked.
+    m_socket->on_tls_ready_to_write = [this](auto&) {
+        m_socket->on_tls_ready_to_write = nullptr;
+        deferred_invoke([this](auto&) {
+            did_connect();
+        });
+    };
+    register_socket_callbacks();
+    bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port());
+    if (!success) {
+        deferred_invoke([this](auto&) {
+            return did_fail(Core::NetworkJob::Error::ConnectionFailed);
+        });
+    }
+}
+
+void HttpsJob::start(NonnullRefPtr<Core::Socket> socket)
+{
+    VERIFY(!m_socket);
+    VERIFY(is<TLS::TLSv12>(*socket));
+    m_socket = static_ptr_cast<TLS::TLSv12>(socket);
+    add_child(*m_socket);
+    register_socket_callbacks();
+    on_socket_connected();
+}
+
+void HttpsJob::did_connect()
+{
+    if (m_socket->alpn() != "h2") {
+        if (on_protocol_negotiated)
+            on_protocol_negotiated(nullptr);
+        on_socket_connected();
+        return;
+    }
+
+    dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: Speaking HTTP/2 with {}", m_request.url().host());
+    // The connection takes over the socket, and outlives this job if other requests go on it as well.
+    NonnullRefPtr<TLS::TLSv12> socket = *m_socket;
+    shutdown();
+    auto connection = Http2Connection::construct(move(socket));
+    if (on_protocol_negotiated)
+        on_protocol_negotiated(connection);
+    start_on_http2_connection(move(connection));
+}
+
+void HttpsJob::register_socket_callbacks()
+{
     m_socket->on_tls_error = [&](TLS::AlertDescription error) {
         if (error == TLS::AlertDescription::HandshakeFailure) {
             deferred_invoke([this](auto&) {
@@ -45,16 +94,11 @@ void HttpsJob::start()
         if (on_certificate_requested)
             on_certificate_requested(*this);
     };
-    bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port());
-    if (!success) {
-        deferred_invoke([this](auto&) {
-            return did_fail(Core::NetworkJob::Error::ConnectionFailed);
-        });
-    }
 }
 
 void HttpsJob::shutdown()
 {
+    detach_from_http2_connection();
     if (!m_socket)
         return;
     m_socket->on_tls_ready_to_read = nullptr;
@@ -63,6 +107,22 @@ void HttpsJob::shutdown()
     m_socket = nullptr;
 }
 
+RefPtr<Core::Socket> HttpsJob::take_reusable_socket()
+{
+    if (!m_socket || !can_reuse_connection() || !m_socket->is_established() || m_socket->can_read())
+        return nullptr;
+
+    m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_ready_to_write = nullptr;
+    m_socket->on_tls_error = nullptr;
+    m_socket->on_tls_connected = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    remove_child(*m_socket);
+    RefPtr<Core::Socket> socket = move(m_socket);
+    return socket;
+}
+
 void HttpsJob::set_certificate(String certificate, String private_key)
 {
     if (!m_socket->add_client_key(certificate.bytes(), private_key.bytes())) {
@@ -92,6 +152,14 @@ void HttpsJob::register_on_ready_to_write(Function<void()> callback)
     m_socket->on_tls_ready_to_write = [callback = move(callback)](auto&) {
         callback();
     };
+
+    // A connection that an earlier job left open is already established, so it won't tell us again.
+    if (m_socket->is_established()) {
+        deferred_invoke([this](auto&) {
+            if (m_socket && m_socket->on_tls_ready_to_write)
+                m_socket->on_tls_ready_to_write(*m_socket);
+        });
+    }
 }
 
 bool HttpsJob::can_read_line() const
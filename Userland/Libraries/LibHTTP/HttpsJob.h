@@ -29,10 +29,15 @@ public:
     }
 
     virtual void start() override;
+    virtual void start(NonnullRefPtr<Core::Socket>) override;
     virtual void shutdown() override;
+    virtual RefPtr<Core::Socket> take_reusable_socket() override;
     void set_certificate(String certificate, String key);
 
     Function<void(HttpsJob&)> on_certificate_requested;
+    // Called once the server picked the protocol: with the connection if it is HTTP/2, which can carry the
+    // requests of other jobs to the same origin as well, or with null if it is HTTP/1.1.
+    Function<void(RefPtr<Http2Connection>)> on_protocol_negotiated;
 
 protected:
     virtual void register_on_ready_to_read(Function<void()>) override;
@@ -48,6 +53,9 @@ protected:
     virtual void read_while_data_available(Function<IterationDecision()>) override;
 
 private:
+    void register_socket_callbacks();
+    void did_connect();
+
     RefPtr<TLS::TLSv12> m_socket;
     const Vector<Certificate>* m_override_ca_certificates { nullptr };
 };
@@ -9,6 +9,7 @@
 #include <LibCompress/Zlib.h>
 #include <LibCore/Event.h>
 #include <LibCore/TCPSocket.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
 #include <stdio.h>
@@ -79,6 +80,7 @@ Job::Job(const HttpRequest& request, OutputStream& output_stream)
 
 Job::~Job()
 {
+    detach_from_http2_connection();
 }
 
 void Job::flush_received_buffers()
@@ -150,6 +152,8 @@ void Job::on_socket_connected()
                 return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
             m_code = code.value();
+            // HTTP/1.1 connections stay open unless the server says otherwise (RFC 7230 section 6.3).
+            m_server_keeps_connection_alive = parts[0] == "HTTP/1.1";
             m_state = State::InHeaders;
             return;
         }
@@ -169,11 +173,16 @@ void Job::on_socket_connected()
             }
             if (line.is_empty()) {
                 if (m_state == State::Trailers) {
+                    m_response_is_delimited = true;
                     return finish_up();
                 } else {
                     if (on_headers_received)
                         on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
                     m_state = State::InBody;
+                    if (!response_has_body()) {
+                        m_response_is_delimited = true;
+                        return finish_up();
+                    }
                 }
                 return;
             }
@@ -201,6 +210,12 @@ void Job::on_socket_connected()
             }
             auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
             m_headers.set(name, value);
+            if (name.equals_ignoring_case("Connection")) {
+                if (value.contains("close", CaseSensitivity::CaseInsensitive))
+                    m_server_keeps_connection_alive = false;
+                else if (value.contains("keep-alive", CaseSensitivity::CaseInsensitive))
+                    m_server_keeps_connection_alive = true;
+            }
             if (name.equals_ignoring_case("Content-Encoding")) {
                 // Assume that any content-encoding means that we can't decode it as a stream :(
                 dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
@@ -335,6 +350,8 @@ void Job::on_socket_connected()
             if (content_length.has_value()) {
                 auto length = content_length.value();
                 if (m_received_size >= length) {
+                    // Anything past the end of the body would be garbage at the start of the next response.
+                    m_response_is_delimited = m_received_size == length;
                     m_received_size = length;
                     finish_up();
                     return IterationDecision::Break;
@@ -350,6 +367,107 @@ void Job::on_socket_connected()
     });
 }
 
+void Job::start_on_http2_connection(NonnullRefPtr<Http2Connection> connection)
+{
+    VERIFY(!m_http2_connection);
+    m_http2_connection = move(connection);
+    m_http2_connection->start_stream(*this);
+}
+
+void Job::detach_from_http2_connection()
+{
+    if (!m_http2_connection)
+        return;
+    m_http2_connection->cancel_stream(*this);
+    m_http2_connection = nullptr;
+}
+
+void Job::did_receive_http2_headers(const Vector<HPACK::Header>& headers, bool end_stream)
+{
+    if (m_state == State::InStatus) {
+        u32 code = 0;
+        bool found_code = false;
+        for (auto& header : headers) {
+            if (header.name != ":status")
+                continue;
+            auto status = header.value.to_uint();
+            found_code = status.has_value();
+            if (found_code)
+                code = *status;
+        }
+        if (!found_code) {
+            warnln("Job: Expected HTTP status");
+            return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
+        }
+        // An informational response comes before the real one.
+        if (code < 200 && !end_stream)
+            return;
+        m_code = code;
+        m_state = State::InHeaders;
+    }
+
+    // The same goes for headers that come after the body (trailers).
+    for (auto& header : headers) {
+        if (header.name.starts_with(':'))
+            continue;
+        m_headers.set(header.name, header.value);
+        if (header.name == "content-encoding") {
+            dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", header.value);
+            m_can_stream_response = false;
+        }
+    }
+
+    if (m_state == State::InHeaders) {
+        if (on_headers_received)
+            on_headers_received(m_headers, m_code);
+        m_state = State::InBody;
+    }
+    if (end_stream)
+        finish_up();
+}
+
+void Job::did_receive_http2_data(ReadonlyBytes data, bool end_stream)
+{
+    if (m_state != State::InBody) {
+        warnln("Job: Expected HTTP headers before the body");
+        return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
+    }
+
+    if (!data.is_empty()) {
+        m_received_buffers.append(ByteBuffer::copy(data));
+        m_buffered_size += data.size();
+        m_received_size += data.size();
+        flush_received_buffers();
+
+        Optional<u32> content_length;
+        if (auto content_length_header = m_headers.get("Content-Length"); content_length_header.has_value())
+            content_length = content_length_header.value().to_uint();
+        deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
+    }
+
+    if (end_stream)
+        finish_up();
+}
+
+void Job::did_fail_http2_stream(Core::NetworkJob::Error error)
+{
+    deferred_invoke([this, error](auto&) { did_fail(error); });
+}
+
+bool Job::response_has_body() const
+{
+    // These responses end with their headers (RFC 7230 section 3.3.3).
+    if (m_request.method() == HttpRequest::Method::HEAD || m_code == 204 || m_code == 304)
+        return false;
+
+    if (!m_headers.contains("Transfer-Encoding")) {
+        auto content_length = m_headers.get("Content-Length");
+        if (content_length.has_value() && content_length.value().to_uint().value_or(1) == 0)
+            return false;
+    }
+    return true;
+}
+
 void Job::timer_event(Core::TimerEvent& event)
 {
     event.accept();
@@ -11,12 +11,16 @@
 #include <AK/Optional.h>
 #include <LibCore/NetworkJob.h>
 #include <LibCore/TCPSocket.h>
+#include <LibHTTP/Forward.h>
+#include <LibHTTP/HPACK.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 
 namespace HTTP {
 
 class Job : public Core::NetworkJob {
+    friend class Http2Connection;
+
 public:
     explicit Job(const HttpRequest&, OutputStream&);
     virtual ~Job() override;
@@ -24,12 +28,27 @@ public:
     virtual void start() override = 0;
     virtual void shutdown() override = 0;
 
+    // Runs the request on a connection that an earlier job left open.
+    virtual void start(NonnullRefPtr<Core::Socket>) = 0;
+
+    // Once the job is done, hands over its connection if the server will take another request on it.
+    virtual RefPtr<Core::Socket> take_reusable_socket() = 0;
+
+    // Runs the request as one of the streams of an HTTP/2 connection, which other jobs may be using as well.
+    void start_on_http2_connection(NonnullRefPtr<Http2Connection>);
+
+    const HttpRequest& request() const { return m_request; }
+
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
     const HttpResponse* response() const { return static_cast<const HttpResponse*>(Core::NetworkJob::response()); }
 
 protected:
+    bool can_reuse_connection() const { return m_request.keep_alive() && m_server_keeps_connection_alive && m_response_is_delimited; }
+    bool response_has_body() const;
+
     void finish_up();
     void on_socket_connected();
+    void detach_from_http2_connection();
     void flush_received_buffers();
     virtual void register_on_ready_to_read(Function<void()>) = 0;
     virtual void register_on_ready_to_write(Function<void()>) = 0;
@@ -44,6 +63,11 @@ protected:
     virtual void read_while_data_available(Function<IterationDecision()> read) { read(); };
     virtual void timer_event(Core::TimerEvent&) override;
 
+    // The HTTP/2 connection that carries the request tells us about the response through these.
+    void did_receive_http2_headers(const Vector<HPACK::Header>&, bool end_stream);
+    void did_receive_http2_data(ReadonlyBytes, bool end_stream);
+    void did_fail_http2_stream(Core::NetworkJob::Error);
+
     enum class State {
         InStatus,
         InHeaders,
@@ -64,6 +88,10 @@ protected:
     Optional<size_t> m_current_chunk_total_size;
     bool m_can_stream_response { true };
     bool m_should_read_chunk_ending_line { false };
+    bool m_server_keeps_connection_alive { false };
+    // Whether we know where the response ended without the server closing the connection.
+    bool m_response_is_delimited { false };
+    RefPtr<Http2Connection> m_http2_connection;
 };
 
 }
@@ -7,14 +7,19 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalSocket.h>
 #include <LibCore/Notifier.h>
+#include <LibCore/Task.h>
 #include <LibCore/Timer.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/MessageRing.h>
+#include <LibIPC/Statistics.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,8 +28,19 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifdef __serenity__
+#    include <serenity.h>
+#endif
+
 namespace IPC {
 
+// A request that has been sent, but whose response nobody has looked for yet.
+// Responses to the same kind of request come back in the order the requests went out, so the ticket tells us which one is ours.
+template<typename ResponseType>
+struct PendingResponse {
+    u32 ticket { 0 };
+};
+
 template<typename LocalEndpoint, typename PeerEndpoint>
 class Connection : public Core::Object {
 public:
@@ -41,6 +57,12 @@ public:
             drain_messages_from_peer();
             handle_messages();
         };
+
+        m_statistics = Statistics::create_if_enabled(
+            { LocalEndpoint::static_name(), LocalEndpoint::static_magic(), LocalEndpoint::message_name },
+            { PeerEndpoint::static_name(), PeerEndpoint::static_magic(), PeerEndpoint::message_name });
+        if (m_statistics)
+            register_property("ipc_statistics", [this] { return m_statistics->to_json(); });
     }
 
     template<typename MessageType>
@@ -51,9 +73,22 @@ public:
 
     void post_message(const Message& message)
     {
-        post_message(message.encode());
+#ifdef __serenity__
+        if (perf_event_is_enabled(PERF_EVENT_IPC_SEND))
+            perf_event(PERF_EVENT_IPC_SEND, message.endpoint_magic(), message.message_id());
+#endif
+        if (!m_statistics) {
+            post_message(message.encode());
+            return;
+        }
+        auto encode_start = Statistics::now();
+        auto buffer = message.encode();
+        m_statistics->did_send(message.endpoint_magic(), message.message_id(), buffer.data.size(), Statistics::now() - encode_start);
+        post_message(move(buffer));
     }
 
+    Statistics const* statistics() const { return m_statistics.ptr(); }
+
     // FIXME: unnecessary copy
     void post_message(MessageBuffer buffer)
     {
@@ -62,10 +97,6 @@ public:
         if (!m_socket->is_open())
             return;
 
-        // Prepend the message size.
-        uint32_t message_size = buffer.data.size();
-        buffer.data.prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
-
 #ifdef __serenity__
         for (auto& fd : buffer.fds) {
             auto rc = sendfd(m_socket->fd(), fd->value());
@@ -79,36 +110,55 @@ public:
             warnln("fd passing is not supported on this platform, sorry :(");
 #endif
 
-        size_t total_nwritten = 0;
-        while (total_nwritten < buffer.data.size()) {
-            auto nwritten = write(m_socket->fd(), buffer.data.data() + total_nwritten, buffer.data.size() - total_nwritten);
-            if (nwritten < 0) {
-                switch (errno) {
-                case EPIPE:
-                    dbgln("{}::post_message: Disconnected from peer", *this);
-                    shutdown();
-                    return;
-                case EAGAIN:
-                    dbgln("{}::post_message: Peer buffer overflowed", *this);
-                    shutdown();
-                    return;
-                default:
-                    perror("Connection::post_message write");
-                    shutdown();
-                    return;
+        if (m_send_ring) {
+            if (m_send_ring->fits(buffer.data.size()) && m_send_ring->try_write(buffer.data)) {
+                if (m_send_ring->needs_doorbell()) {
+                    u32 doorbell[2] { m_send_ring->write_position(), 0 };
+                    write_to_socket({ doorbell, sizeof(doorbell) });
                 }
+                m_responsiveness_timer->start();
+                return;
             }
-            total_nwritten += nwritten;
+            // The peer has to read everything that went into the ring before this one first.
+            u32 frame_header[2] { m_send_ring->write_position(), static_cast<u32>(buffer.data.size()) };
+            buffer.data.prepend(reinterpret_cast<const u8*>(frame_header), sizeof(frame_header));
+        } else {
+            // Prepend the message size.
+            uint32_t message_size = buffer.data.size();
+            buffer.data.prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
         }
 
+        write_to_socket(buffer.data);
         m_responsiveness_timer->start();
     }
 
+    // From now on, send messages to the peer through a ring in shared memory, and only use the socket
+    // to wake it up when it isn't already busy reading from the ring.
+    // Fds and messages that don't fit still go over the socket, but they stay in order with the rest.
+    bool enable_message_ring([[maybe_unused]] size_t capacity = MessageRing::default_capacity)
+    {
+#ifdef __serenity__
+        VERIFY(!m_send_ring);
+        auto ring = MessageRing::create(capacity);
+        if (!ring)
+            return false;
+        if (sendfd(m_socket->fd(), ring->fd()) < 0) {
+            perror("sendfd");
+            return false;
+        }
+        u32 setup_frame[2] { ring_setup_marker, ring->capacity() };
+        write_to_socket({ setup_frame, sizeof(setup_frame) });
+        m_send_ring = move(ring);
+        return true;
+#else
+        return false;
+#endif
+    }
+
     template<typename RequestType, typename... Args>
     NonnullOwnPtr<typename RequestType::ResponseType> send_sync(Args&&... args)
     {
-        post_message(RequestType(forward<Args>(args)...));
-        auto response = wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        auto response = send_sync_but_allow_failure<RequestType>(forward<Args>(args)...);
         VERIFY(response);
         return response.release_nonnull();
     }
@@ -116,8 +166,49 @@ public:
     template<typename RequestType, typename... Args>
     OwnPtr<typename RequestType::ResponseType> send_sync_but_allow_failure(Args&&... args)
     {
+        using ResponseType = typename RequestType::ResponseType;
+        auto request_start = m_statistics ? Statistics::now() : 0;
+        auto response = wait_for_response(send_pipelined<RequestType>(forward<Args>(args)...));
+        if (m_statistics && response)
+            m_statistics->did_receive_response(PeerEndpoint::static_magic(), ResponseType::static_message_id(), Statistics::now() - request_start);
+        return response;
+    }
+
+    // Sends a request without waiting for its response, so that several of them can be in flight at once:
+    //
+    //     auto first = send_pipelined<Messages::Foo>(...);
+    //     auto second = send_pipelined<Messages::Bar>(...);
+    //     auto first_response = wait_for_response(first);
+    //     auto second_response = wait_for_response(second);
+    //
+    // NOTE: Every pending response has to be waited for, or it sticks around until the connection goes away.
+    template<typename RequestType, typename... Args>
+    PendingResponse<typename RequestType::ResponseType> send_pipelined(Args&&... args)
+    {
+        auto& queue = m_response_queues.ensure(RequestType::ResponseType::static_message_id());
+        PendingResponse<typename RequestType::ResponseType> pending { queue.next_ticket++ };
         post_message(RequestType(forward<Args>(args)...));
-        return wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        return pending;
+    }
+
+    // Blocks until the response is there, or returns null if the peer went away first.
+    template<typename ResponseType>
+    OwnPtr<ResponseType> wait_for_response(PendingResponse<ResponseType> pending)
+    {
+        for (;;) {
+            if (auto response = take_response(ResponseType::static_message_id(), pending.ticket))
+                return adopt_own(static_cast<ResponseType&>(*response.leak_ptr()));
+            if (!m_socket->is_open() || !wait_until_readable() || !drain_messages_from_peer())
+                return {};
+        }
+    }
+
+    // Like send_sync_but_allow_failure(), but lets the event loop carry on while we wait for the response.
+    // NOTE: The request is sent right away, even if nobody ever co_awaits the task.
+    template<typename RequestType, typename... Args>
+    Core::Task<OwnPtr<typename RequestType::ResponseType>> send_async(Args&&... args)
+    {
+        return wait_for_response_asynchronously(send_pipelined<RequestType>(forward<Args>(args)...));
     }
 
     virtual void may_have_become_unresponsive() { }
@@ -127,6 +218,10 @@ public:
     {
         m_notifier->close();
         m_socket->close();
+        // Nothing is going to answer anyone who is still waiting for a response now.
+        auto awaiters = move(m_response_awaiters);
+        for (auto* awaiter : awaiters)
+            exchange(awaiter->handle, nullptr).resume();
         die();
     }
 
@@ -135,6 +230,116 @@ public:
 protected:
     Core::LocalSocket& socket() { return *m_socket; }
 
+    // What the peer sends instead of a message size to tell us it's going to use a MessageRing.
+    static constexpr u32 ring_setup_marker = 0xffffffff;
+
+    void write_to_socket(ReadonlyBytes bytes)
+    {
+        size_t total_nwritten = 0;
+        while (total_nwritten < bytes.size()) {
+            auto nwritten = write(m_socket->fd(), bytes.data() + total_nwritten, bytes.size() - total_nwritten);
+            if (nwritten < 0) {
+                switch (errno) {
+                case EPIPE:
+                    dbgln("{}::post_message: Disconnected from peer", *this);
+                    shutdown();
+                    return;
+                case EAGAIN:
+                    dbgln("{}::post_message: Peer buffer overflowed", *this);
+                    shutdown();
+                    return;
+                default:
+                    perror("Connection::post_message write");
+                    shutdown();
+                    return;
+                }
+            }
+            total_nwritten += nwritten;
+        }
+    }
+
+    bool decode_message_from_peer(ReadonlyBytes bytes)
+    {
+        auto decode_start = m_statistics ? Statistics::now() : 0;
+        OwnPtr<Message> message = LocalEndpoint::decode_message(bytes, m_socket->fd());
+        if (!message)
+            message = PeerEndpoint::decode_message(bytes, m_socket->fd());
+        if (!message) {
+            dbgln("Failed to parse a message");
+            return false;
+        }
+        if (m_statistics)
+            m_statistics->did_receive(message->endpoint_magic(), message->message_id(), bytes.size(), Statistics::now() - decode_start);
+#ifdef __serenity__
+        if (perf_event_is_enabled(PERF_EVENT_IPC_RECEIVE))
+            perf_event(PERF_EVENT_IPC_RECEIVE, message->endpoint_magic(), message->message_id());
+#endif
+
+        if (message->endpoint_magic() == LocalEndpoint::static_magic())
+            m_unprocessed_messages.append(message.release_nonnull());
+        else
+            did_receive_from_peer(message.release_nonnull());
+        return true;
+    }
+
+    bool drain_receive_ring(u32 write_position)
+    {
+        if (m_receive_ring->read_until(write_position, [this](ReadonlyBytes message) { return decode_message_from_peer(message); }))
+            return true;
+        dbgln("{}::drain_receive_ring: Peer's message ring is broken", *this);
+        shutdown();
+        return false;
+    }
+
+    struct ResponseAwaiter {
+        bool await_ready()
+        {
+            if (!connection.m_socket->is_open())
+                return true;
+            response = connection.take_response(message_id, ticket);
+            return response;
+        }
+        void await_suspend(std::coroutine_handle<> suspended_handle)
+        {
+            handle = suspended_handle;
+            connection.m_response_awaiters.append(this);
+        }
+        OwnPtr<Message> await_resume() { return move(response); }
+
+        Connection& connection;
+        int message_id { 0 };
+        u32 ticket { 0 };
+        OwnPtr<Message> response;
+        std::coroutine_handle<> handle;
+    };
+
+    template<typename ResponseType>
+    Core::Task<OwnPtr<ResponseType>> wait_for_response_asynchronously(PendingResponse<ResponseType> pending)
+    {
+        NonnullRefPtr protect = *this;
+        auto response = co_await ResponseAwaiter { *this, ResponseType::static_message_id(), pending.ticket, nullptr, nullptr };
+        co_return adopt_own_if_nonnull(static_cast<ResponseType*>(response.leak_ptr()));
+    }
+
+    bool wait_until_readable()
+    {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(m_socket->fd(), &rfds);
+        for (;;) {
+            if (auto rc = select(m_socket->fd() + 1, &rfds, nullptr, nullptr, nullptr); rc < 0) {
+                if (errno == EINTR)
+                    continue;
+                perror("wait_until_readable: select");
+                VERIFY_NOT_REACHED();
+            } else {
+                VERIFY(rc > 0);
+                VERIFY(FD_ISSET(m_socket->fd(), &rfds));
+                return true;
+            }
+        }
+    }
+
     template<typename MessageType, typename Endpoint>
     OwnPtr<MessageType> wait_for_specific_endpoint_message()
     {
@@ -149,34 +354,56 @@ protected:
                     return m_unprocessed_messages.take(i).template release_nonnull<MessageType>();
             }
 
-            if (!m_socket->is_open())
-                break;
-            fd_set rfds;
-            FD_ZERO(&rfds);
-            FD_SET(m_socket->fd(), &rfds);
-            for (;;) {
-                if (auto rc = select(m_socket->fd() + 1, &rfds, nullptr, nullptr, nullptr); rc < 0) {
-                    if (errno == EINTR)
-                        continue;
-                    perror("wait_for_specific_endpoint_message: select");
-                    VERIFY_NOT_REACHED();
-                } else {
-                    VERIFY(rc > 0);
-                    VERIFY(FD_ISSET(m_socket->fd(), &rfds));
-                    break;
-                }
-            }
-
-            if (!drain_messages_from_peer())
+            if (!m_socket->is_open() || !wait_until_readable() || !drain_messages_from_peer())
                 break;
         }
         return {};
     }
 
+    // The responses we're expecting for one kind of request, by ticket.
+    struct ResponseQueue {
+        u32 next_ticket { 0 };
+        u32 next_arrival { 0 };
+        HashMap<u32, NonnullOwnPtr<Message>> arrived;
+    };
+
+    OwnPtr<Message> take_response(int message_id, u32 ticket)
+    {
+        auto queue = m_response_queues.find(message_id);
+        if (queue == m_response_queues.end())
+            return {};
+        auto response = queue->value.arrived.find(ticket);
+        if (response == queue->value.arrived.end())
+            return {};
+        OwnPtr<Message> message = move(response->value);
+        queue->value.arrived.remove(response);
+        return message;
+    }
+
+    void did_receive_from_peer(NonnullOwnPtr<Message> message)
+    {
+        auto queue = m_response_queues.find(message->message_id());
+        if (queue == m_response_queues.end() || queue->value.next_arrival == queue->value.next_ticket) {
+            // Nobody asked for this one.
+            m_unprocessed_messages.append(move(message));
+            return;
+        }
+        queue->value.arrived.set(queue->value.next_arrival++, move(message));
+        m_has_new_responses = true;
+    }
+
     bool drain_messages_from_peer()
     {
         Vector<u8> bytes;
 
+        // NOTE: We look at the ring before reading from the socket. Anything the peer wrote to the socket before
+        //       these messages went into the ring is then guaranteed to be there for us to read as well.
+        Optional<u32> ring_write_position;
+        if (m_receive_ring) {
+            m_receive_ring->acknowledge_doorbell();
+            ring_write_position = m_receive_ring->load_write_position();
+        }
+
         if (!m_unprocessed_bytes.is_empty()) {
             bytes.append(m_unprocessed_bytes.data(), m_unprocessed_bytes.size());
             m_unprocessed_bytes.clear();
@@ -208,20 +435,47 @@ protected:
 
         size_t index = 0;
         u32 message_size = 0;
-        for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
+        while (index + sizeof(message_size) < bytes.size()) {
+            if (m_receive_ring) {
+                // Every frame tells us how far into the ring the peer was when it sent it, and a frame without a message
+                // is there to wake us up.
+                u32 frame_header[2];
+                if (bytes.size() - index < sizeof(frame_header))
+                    break;
+                memcpy(frame_header, bytes.data() + index, sizeof(frame_header));
+                message_size = frame_header[1];
+                if (bytes.size() - index - sizeof(frame_header) < message_size)
+                    break;
+                index += sizeof(frame_header);
+                if (!drain_receive_ring(frame_header[0]))
+                    return false;
+                if (message_size != 0 && !decode_message_from_peer({ bytes.data() + index, message_size })) {
+                    shutdown();
+                    return false;
+                }
+                index += message_size;
+                continue;
+            }
+
             memcpy(&message_size, bytes.data() + index, sizeof(message_size));
+            if (message_size == ring_setup_marker) {
+                u32 setup_frame[2];
+                if (bytes.size() - index < sizeof(setup_frame))
+                    break;
+                memcpy(setup_frame, bytes.data() + index, sizeof(setup_frame));
+                index += sizeof(setup_frame);
+                if (!receive_message_ring(setup_frame[1]))
+                    return false;
+                // We don't know how much of the ring we can safely read yet, so wait for the peer to ring the doorbell.
+                ring_write_position = {};
+                continue;
+            }
             if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
                 break;
             index += sizeof(message_size);
-            auto remaining_bytes = ReadonlyBytes { bytes.data() + index, bytes.size() - index };
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else {
-                dbgln("Failed to parse a message");
+            if (!decode_message_from_peer({ bytes.data() + index, message_size }))
                 break;
-            }
+            index += message_size;
         }
 
         if (index < bytes.size()) {
@@ -235,9 +489,13 @@ protected:
                 return false;
             }
             m_unprocessed_bytes = remaining_bytes;
+        } else if (ring_write_position.has_value()) {
+            // NOTE: If we have part of a frame, it may have been sent before some of what's in the ring, so that has to wait.
+            if (!drain_receive_ring(ring_write_position.value()))
+                return false;
         }
 
-        if (!m_unprocessed_messages.is_empty()) {
+        if (!m_unprocessed_messages.is_empty() || (m_has_new_responses && !m_response_awaiters.is_empty())) {
             deferred_invoke([this](auto&) {
                 handle_messages();
             });
@@ -245,6 +503,22 @@ protected:
         return true;
     }
 
+    bool receive_message_ring([[maybe_unused]] u32 capacity)
+    {
+#ifdef __serenity__
+        int fd = recvfd(m_socket->fd(), O_CLOEXEC);
+        if (fd >= 0 && !m_receive_ring) {
+            if (auto ring = MessageRing::create_from_fd(fd, capacity)) {
+                m_receive_ring = move(ring);
+                return true;
+            }
+        }
+#endif
+        dbgln("{}::drain_messages_from_peer: Peer sent a bad message ring", *this);
+        shutdown();
+        return false;
+    }
+
     void handle_messages()
     {
         auto messages = move(m_unprocessed_messages);
@@ -253,6 +527,21 @@ protected:
                 if (auto response = m_local_stub.handle(message))
                     post_message(*response);
         }
+
+        if (!exchange(m_has_new_responses, false))
+            return;
+        Vector<ResponseAwaiter*> responded_awaiters;
+        for (size_t i = 0; i < m_response_awaiters.size();) {
+            auto* awaiter = m_response_awaiters[i];
+            awaiter->response = take_response(awaiter->message_id, awaiter->ticket);
+            if (!awaiter->response) {
+                ++i;
+                continue;
+            }
+            responded_awaiters.append(m_response_awaiters.take(i));
+        }
+        for (auto* awaiter : responded_awaiters)
+            exchange(awaiter->handle, nullptr).resume();
     }
 
 protected:
@@ -263,6 +552,13 @@ protected:
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
     ByteBuffer m_unprocessed_bytes;
+    OwnPtr<MessageRing> m_send_ring;
+    OwnPtr<MessageRing> m_receive_ring;
+    OwnPtr<Statistics> m_statistics;
+    HashMap<int, ResponseQueue> m_response_queues;
+    bool m_has_new_responses { false };
+    // Coroutines waiting for a response from the peer.
+    Vector<ResponseAwaiter*> m_response_awaiters;
 };
 
 }
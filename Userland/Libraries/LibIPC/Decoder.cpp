@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/LEB128.h>
 #include <AK/MemoryStream.h>
 #include <AK/URL.h>
 #include <LibCore/AnonymousBuffer.h>
@@ -78,41 +79,55 @@ bool Decoder::decode(float& value)
     return !m_stream.handle_any_error();
 }
 
-bool Decoder::decode(String& value)
+bool Decoder::decode_leb128(u64& value)
 {
-    i32 length = 0;
-    m_stream >> length;
-    if (m_stream.handle_any_error())
+    // NOTE: LEB128 wants to seek back to where it started when it runs out of bytes, which it can't do from the very end.
+    if (m_stream.eof())
+        return false;
+    if (!LEB128::read_unsigned(m_stream, value)) {
+        m_stream.handle_any_error();
         return false;
-    if (length < 0) {
-        value = {};
-        return true;
-    }
-    if (length == 0) {
-        value = String::empty();
-        return true;
     }
-    char* text_buffer = nullptr;
-    auto text_impl = StringImpl::create_uninitialized(static_cast<size_t>(length), text_buffer);
-    m_stream >> Bytes { text_buffer, static_cast<size_t>(length) };
-    value = *text_impl;
-    return !m_stream.handle_any_error();
+    return true;
 }
 
-bool Decoder::decode(ByteBuffer& value)
+bool Decoder::decode_length(size_t& length)
+{
+    u64 value = 0;
+    if (!decode_leb128(value) || value > m_stream.remaining())
+        return false;
+    length = value;
+    return true;
+}
+
+bool Decoder::decode(StringView& value)
 {
-    i32 length = 0;
-    m_stream >> length;
-    if (m_stream.handle_any_error())
+    u64 length_plus_one = 0;
+    if (!decode_leb128(length_plus_one) || length_plus_one > m_stream.remaining() + 1)
         return false;
-    if (length < 0) {
+    if (length_plus_one == 0) {
         value = {};
         return true;
     }
-    if (length == 0) {
-        value = ByteBuffer::create_uninitialized(0);
-        return true;
-    }
+    size_t length = length_plus_one - 1;
+    value = StringView { reinterpret_cast<const char*>(m_stream.bytes().offset_pointer(m_stream.offset())), length };
+    return m_stream.discard_or_error(length);
+}
+
+bool Decoder::decode(String& value)
+{
+    StringView view;
+    if (!decode(view))
+        return false;
+    value = view;
+    return true;
+}
+
+bool Decoder::decode(ByteBuffer& value)
+{
+    size_t length = 0;
+    if (!decode_length(length))
+        return false;
     value = ByteBuffer::create_uninitialized(length);
     m_stream >> value.bytes();
     return !m_stream.handle_any_error();
@@ -120,7 +135,7 @@ bool Decoder::decode(ByteBuffer& value)
 
 bool Decoder::decode(URL& value)
 {
-    String string;
+    StringView string;
     if (!decode(string))
         return false;
     value = URL(string);
@@ -129,13 +144,9 @@ bool Decoder::decode(URL& value)
 
 bool Decoder::decode(Dictionary& dictionary)
 {
-    u64 size = 0;
-    m_stream >> size;
-    if (m_stream.handle_any_error())
+    size_t size = 0;
+    if (!decode_length(size))
         return false;
-    if (size >= (size_t)NumericLimits<i32>::max()) {
-        VERIFY_NOT_REACHED();
-    }
 
     for (size_t i = 0; i < size; ++i) {
         String key;
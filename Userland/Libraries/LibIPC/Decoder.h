@@ -41,15 +41,22 @@ public:
     bool decode(i64&);
     bool decode(float&);
     bool decode(String&);
+    // NOTE: The view points into the message that's being decoded, so it's only good until decoding is done.
+    bool decode(StringView&);
     bool decode(ByteBuffer&);
     bool decode(URL&);
     bool decode(Dictionary&);
     bool decode(File&);
+
+    bool decode_leb128(u64&);
+    // Every element takes at least a byte, so a length that's longer than what's left of the message can't be right.
+    bool decode_length(size_t&);
+
     template<typename K, typename V>
     bool decode(HashMap<K, V>& hashmap)
     {
-        u32 size;
-        if (!decode(size) || size > NumericLimits<i32>::max())
+        size_t size;
+        if (!decode_length(size))
             return false;
 
         for (size_t i = 0; i < size; ++i) {
@@ -75,9 +82,10 @@ public:
     template<typename T>
     bool decode(Vector<T>& vector)
     {
-        u64 size;
-        if (!decode(size) || size > NumericLimits<i32>::max())
+        size_t size;
+        if (!decode_length(size))
             return false;
+        vector.ensure_capacity(vector.size() + size);
         for (size_t i = 0; i < size; ++i) {
             T value;
             if (!decode(value))
@@ -119,15 +119,18 @@ Encoder& Encoder::operator<<(const StringView& value)
 
 Encoder& Encoder::operator<<(const String& value)
 {
-    if (value.is_null())
-        return *this << (i32)-1;
-    *this << static_cast<i32>(value.length());
+    // A null string is told apart from an empty one by being one shorter.
+    if (value.is_null()) {
+        encode_leb128(0);
+        return *this;
+    }
+    encode_leb128(value.length() + 1);
     return *this << value.view();
 }
 
 Encoder& Encoder::operator<<(const ByteBuffer& value)
 {
-    *this << static_cast<i32>(value.size());
+    encode_leb128(value.size());
     m_buffer.data.append(value.data(), value.size());
     return *this;
 }
@@ -139,7 +142,7 @@ Encoder& Encoder::operator<<(const URL& value)
 
 Encoder& Encoder::operator<<(const Dictionary& dictionary)
 {
-    *this << (u64)dictionary.size();
+    encode_leb128(dictionary.size());
     dictionary.for_each_entry([this](auto& key, auto& value) {
         *this << key << value;
     });
@@ -161,6 +164,18 @@ Encoder& Encoder::operator<<(const File& file)
     return *this;
 }
 
+void Encoder::encode_leb128(u64 value)
+{
+    m_buffer.data.ensure_capacity(m_buffer.data.size() + max_leb128_size);
+    do {
+        u8 byte = value & 0x7f;
+        value >>= 7;
+        if (value != 0)
+            byte |= 0x80;
+        m_buffer.data.unchecked_append(byte);
+    } while (value != 0);
+}
+
 bool encode(Encoder& encoder, const Core::AnonymousBuffer& buffer)
 {
     encoder << buffer.is_valid();
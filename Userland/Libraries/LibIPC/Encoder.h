@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
 
@@ -18,6 +21,30 @@ bool encode(Encoder&, T&)
     VERIFY_NOT_REACHED();
 }
 
+// The most bytes a LEB128-encoded u64 can take.
+static constexpr size_t max_leb128_size = 10;
+
+// How many bytes encoding a value is going to take at most, which is used to size message buffers up front.
+// NOTE: Types that don't have a better answer here say 0, and the buffer grows as they are encoded.
+template<typename T>
+size_t encoded_size_hint(const T& value)
+{
+    if constexpr (IsIntegral<T> || IsFloatingPoint<T> || IsEnum<T>) {
+        return sizeof(T);
+    } else if constexpr (IsSame<T, String> || IsSame<T, StringView>) {
+        return max_leb128_size + value.length();
+    } else if constexpr (IsSame<T, ByteBuffer>) {
+        return max_leb128_size + value.size();
+    } else if constexpr (requires { value.size(); value.first(); typename T::ValueType; }) {
+        if constexpr (IsIntegral<typename T::ValueType> || IsFloatingPoint<typename T::ValueType>)
+            return max_leb128_size + value.size() * sizeof(typename T::ValueType);
+        else
+            return max_leb128_size;
+    } else {
+        return 0;
+    }
+}
+
 class Encoder {
 public:
     explicit Encoder(MessageBuffer& buffer)
@@ -42,10 +69,14 @@ public:
     Encoder& operator<<(const URL&);
     Encoder& operator<<(const Dictionary&);
     Encoder& operator<<(const File&);
+
+    // Small values take fewer bytes, which is what lengths and counts usually are.
+    void encode_leb128(u64);
+
     template<typename K, typename V>
     Encoder& operator<<(const HashMap<K, V>& hashmap)
     {
-        *this << (u32)hashmap.size();
+        encode_leb128(hashmap.size());
         for (auto it : hashmap) {
             *this << it.key;
             *this << it.value;
@@ -56,7 +87,7 @@ public:
     template<typename T>
     Encoder& operator<<(const Vector<T>& vector)
     {
-        *this << (u64)vector.size();
+        encode_leb128(vector.size());
         for (auto& value : vector)
             *this << value;
         return *this;
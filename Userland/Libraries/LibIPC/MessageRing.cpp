@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <LibIPC/MessageRing.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace IPC {
+
+static bool is_valid_capacity(size_t capacity)
+{
+    return capacity >= 4 * KiB && capacity <= 16 * MiB && !(capacity & (capacity - 1));
+}
+
+OwnPtr<MessageRing> MessageRing::create(size_t capacity)
+{
+    VERIFY(is_valid_capacity(capacity));
+    auto buffer = Core::AnonymousBuffer::create_with_size(sizeof(Header) + capacity);
+    if (!buffer.is_valid())
+        return {};
+    return adopt_own_if_nonnull(new MessageRing(move(buffer), capacity));
+}
+
+OwnPtr<MessageRing> MessageRing::create_from_fd(int fd, size_t capacity)
+{
+    if (!is_valid_capacity(capacity)) {
+        dbgln("MessageRing: Peer sent a ring with bogus capacity {}", capacity);
+        close(fd);
+        return {};
+    }
+    auto buffer = Core::AnonymousBuffer::create_from_anon_fd(fd, sizeof(Header) + capacity);
+    if (!buffer.is_valid())
+        return {};
+    auto ring = adopt_own_if_nonnull(new MessageRing(move(buffer), capacity));
+    if (ring)
+        ring->m_read_position = ring->header().read_position.load(AK::MemoryOrder::memory_order_acquire);
+    return ring;
+}
+
+MessageRing::MessageRing(Core::AnonymousBuffer buffer, u32 capacity)
+    : m_buffer(move(buffer))
+    , m_capacity(capacity)
+{
+}
+
+void MessageRing::copy_in(u32 position, ReadonlyBytes bytes)
+{
+    size_t offset = position & (m_capacity - 1);
+    size_t first_part = min(bytes.size(), m_capacity - offset);
+    memcpy(data() + offset, bytes.data(), first_part);
+    memcpy(data(), bytes.data() + first_part, bytes.size() - first_part);
+}
+
+void MessageRing::copy_out(u32 position, Bytes bytes)
+{
+    size_t offset = position & (m_capacity - 1);
+    size_t first_part = min(bytes.size(), m_capacity - offset);
+    memcpy(bytes.data(), data() + offset, first_part);
+    memcpy(bytes.data() + first_part, data(), bytes.size() - first_part);
+}
+
+bool MessageRing::try_write(ReadonlyBytes message)
+{
+    VERIFY(fits(message.size()));
+    u32 read_position = header().read_position.load(AK::MemoryOrder::memory_order_acquire);
+    u32 used = m_write_position - read_position;
+    if (used > m_capacity)
+        return false;
+    u32 message_size = message.size();
+    if (m_capacity - used < sizeof(message_size) + message_size)
+        return false;
+
+    copy_in(m_write_position, { &message_size, sizeof(message_size) });
+    copy_in(m_write_position + sizeof(message_size), message);
+    m_write_position += sizeof(message_size) + message_size;
+    header().write_position.store(m_write_position, AK::MemoryOrder::memory_order_release);
+    return true;
+}
+
+bool MessageRing::needs_doorbell()
+{
+    return header().doorbell_pending.exchange(1, AK::MemoryOrder::memory_order_acq_rel) == 0;
+}
+
+void MessageRing::acknowledge_doorbell()
+{
+    header().doorbell_pending.store(0, AK::MemoryOrder::memory_order_seq_cst);
+}
+
+u32 MessageRing::load_write_position() const
+{
+    return header().write_position.load(AK::MemoryOrder::memory_order_acquire);
+}
+
+Optional<ReadonlyBytes> MessageRing::read_one(u32 write_position)
+{
+    u32 available = write_position - m_read_position;
+    u32 message_size = 0;
+    if (available > m_capacity || available < sizeof(message_size)) {
+        dbgln("MessageRing: Peer's write position {} doesn't make sense, we're at {}", write_position, m_read_position);
+        return {};
+    }
+    copy_out(m_read_position, { &message_size, sizeof(message_size) });
+    if (message_size > available - sizeof(message_size)) {
+        dbgln("MessageRing: Peer wrote a message of {} bytes, but only {} are there", message_size, available - sizeof(message_size));
+        return {};
+    }
+
+    // NOTE: We never decode straight out of shared memory, since the peer could change the message while we're looking at it.
+    m_message.resize(message_size);
+    copy_out(m_read_position + sizeof(message_size), m_message.span());
+    m_read_position += sizeof(message_size) + message_size;
+    return m_message.span();
+}
+
+}
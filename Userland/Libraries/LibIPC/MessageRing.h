@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// A single-producer/single-consumer byte ring in memory shared by two processes, for passing encoded messages
+// from one end of a Connection to the other without going through the socket.
+// Every message is stored as its size, followed by its data, and may wrap around the end of the ring.
+// NOTE: The other process can scribble all over the shared memory at any time, so everything
+//       that's read from it is checked before it's used.
+class MessageRing {
+    AK_MAKE_NONCOPYABLE(MessageRing);
+    AK_MAKE_NONMOVABLE(MessageRing);
+
+public:
+    static constexpr size_t default_capacity = 64 * KiB;
+
+    // For the sending side, which owns the ring.
+    static OwnPtr<MessageRing> create(size_t capacity = default_capacity);
+    // For the receiving side, which gets the ring's fd from the sender.
+    static OwnPtr<MessageRing> create_from_fd(int fd, size_t capacity);
+
+    int fd() const { return m_buffer.fd(); }
+    u32 capacity() const { return m_capacity; }
+
+    // Messages that wouldn't leave much room for anything else go through the socket instead.
+    bool fits(size_t message_size) const { return message_size + sizeof(u32) <= m_capacity / 4; }
+
+    // Producer side.
+    // Returns false if there's no room for the message right now (or the consumer looks confused).
+    bool try_write(ReadonlyBytes);
+    u32 write_position() const { return m_write_position; }
+    // Returns true if the consumer hasn't been told about new messages since it last looked, which makes it our job.
+    bool needs_doorbell();
+
+    // Consumer side.
+    // NOTE: Call this before looking for new messages, so that anything written after that rings the doorbell again.
+    void acknowledge_doorbell();
+    u32 load_write_position() const;
+    // Calls on_message with every message up to the given write position. The data is only valid during the call.
+    // Returns false if the ring's contents don't make sense, or on_message returns false.
+    template<typename Callback>
+    bool read_until(u32 write_position, Callback on_message)
+    {
+        while (m_read_position != write_position) {
+            auto message = read_one(write_position);
+            if (!message.has_value())
+                return false;
+            if (!on_message(message.value()))
+                return false;
+            // The producer may reuse the space as soon as we move on.
+            header().read_position.store(m_read_position, AK::MemoryOrder::memory_order_release);
+        }
+        return true;
+    }
+
+private:
+    // The positions keep on counting up, and wrap around at 2^32. The capacity is a power of two, so that's fine.
+    struct Header {
+        Atomic<u32> read_position;
+        u8 padding_after_read_position[60];
+        Atomic<u32> write_position;
+        Atomic<u32> doorbell_pending;
+        u8 padding_after_write_position[56];
+    };
+
+    MessageRing(Core::AnonymousBuffer, u32 capacity);
+
+    Header& header() { return *reinterpret_cast<Header*>(m_buffer.data<void>()); }
+    const Header& header() const { return *reinterpret_cast<const Header*>(m_buffer.data<void>()); }
+    u8* data() { return m_buffer.data<u8>() + sizeof(Header); }
+
+    void copy_in(u32 position, ReadonlyBytes);
+    void copy_out(u32 position, Bytes);
+    Optional<ReadonlyBytes> read_one(u32 write_position);
+
+    Core::AnonymousBuffer m_buffer;
+    u32 m_capacity { 0 };
+    // Our own copies of the positions, since the ones in shared memory can't be trusted.
+    u32 m_read_position { 0 };
+    u32 m_write_position { 0 };
+    // The message that is currently being read.
+    Vector<u8> m_message;
+};
+
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibIPC/Statistics.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace IPC {
+
+void LatencyHistogram::record(u64 microseconds)
+{
+    size_t bucket = 0;
+    while (bucket < bucket_count - 1 && microseconds >= (1ull << bucket))
+        ++bucket;
+    ++m_buckets[bucket];
+}
+
+JsonObject LatencyHistogram::to_json() const
+{
+    JsonObject object;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        if (m_buckets[i] == 0)
+            continue;
+        if (i == bucket_count - 1)
+            object.set(String::formatted(">={}us", 1ull << (i - 1)), m_buckets[i]);
+        else
+            object.set(String::formatted("<{}us", 1ull << i), m_buckets[i]);
+    }
+    return object;
+}
+
+static bool is_enabled_for(StringView endpoint_name)
+{
+    static Optional<Vector<String>> s_enabled_endpoints;
+    if (!s_enabled_endpoints.has_value()) {
+        s_enabled_endpoints = Vector<String> {};
+        if (auto* enabled = getenv("IPC_STATISTICS"))
+            s_enabled_endpoints = String(enabled).split(',');
+    }
+    for (auto& name : *s_enabled_endpoints) {
+        if (name == "all" || name == endpoint_name)
+            return true;
+    }
+    return false;
+}
+
+OwnPtr<Statistics> Statistics::create_if_enabled(EndpointDescription local_endpoint, EndpointDescription peer_endpoint)
+{
+    if (!is_enabled_for(local_endpoint.name) && !is_enabled_for(peer_endpoint.name))
+        return {};
+    return make<Statistics>(local_endpoint, peer_endpoint);
+}
+
+Statistics::Statistics(EndpointDescription local_endpoint, EndpointDescription peer_endpoint)
+    : m_local_endpoint { local_endpoint, {} }
+    , m_peer_endpoint { peer_endpoint, {} }
+{
+}
+
+Statistics::~Statistics()
+{
+    dump();
+}
+
+u64 Statistics::now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<u64>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+MessageStatistics& Statistics::statistics_for(u32 endpoint_magic, i32 message_id)
+{
+    if (endpoint_magic == m_local_endpoint.description.magic)
+        return m_local_endpoint.messages.ensure(message_id);
+    if (endpoint_magic == m_peer_endpoint.description.magic)
+        return m_peer_endpoint.messages.ensure(message_id);
+    return m_unknown_messages;
+}
+
+void Statistics::did_send(u32 endpoint_magic, i32 message_id, size_t size, u64 encode_time_ns)
+{
+    auto& statistics = statistics_for(endpoint_magic, message_id);
+    ++statistics.sent_count;
+    statistics.sent_bytes += size;
+    statistics.encode_time_ns += encode_time_ns;
+}
+
+void Statistics::did_receive(u32 endpoint_magic, i32 message_id, size_t size, u64 decode_time_ns)
+{
+    auto& statistics = statistics_for(endpoint_magic, message_id);
+    ++statistics.received_count;
+    statistics.received_bytes += size;
+    statistics.decode_time_ns += decode_time_ns;
+}
+
+void Statistics::did_receive_response(u32 endpoint_magic, i32 message_id, u64 round_trip_time_ns)
+{
+    statistics_for(endpoint_magic, message_id).round_trip_latency.record(round_trip_time_ns / 1000);
+}
+
+static JsonObject to_json(MessageStatistics const& statistics)
+{
+    JsonObject object;
+    object.set("sent_count", statistics.sent_count);
+    object.set("sent_bytes", statistics.sent_bytes);
+    object.set("encode_time_ns", statistics.encode_time_ns);
+    object.set("received_count", statistics.received_count);
+    object.set("received_bytes", statistics.received_bytes);
+    object.set("decode_time_ns", statistics.decode_time_ns);
+    object.set("round_trip_latency", statistics.round_trip_latency.to_json());
+    return object;
+}
+
+JsonObject Statistics::to_json() const
+{
+    JsonObject object;
+    for (auto* endpoint : { &m_local_endpoint, &m_peer_endpoint }) {
+        JsonObject messages;
+        for (auto& it : endpoint->messages)
+            messages.set(endpoint->description.message_name(it.key), IPC::to_json(it.value));
+        object.set(endpoint->description.name, move(messages));
+    }
+    if (m_unknown_messages.sent_count || m_unknown_messages.received_count)
+        object.set("unknown", IPC::to_json(m_unknown_messages));
+    return object;
+}
+
+void Statistics::dump() const
+{
+    dbgln("IPC statistics for {} <-> {}:", m_local_endpoint.description.name, m_peer_endpoint.description.name);
+    for (auto* endpoint : { &m_local_endpoint, &m_peer_endpoint }) {
+        // Whatever moved the most data goes first, since that's what's most interesting.
+        struct Row {
+            i32 message_id;
+            MessageStatistics const* statistics;
+        };
+        Vector<Row> rows;
+        for (auto& it : endpoint->messages)
+            rows.append({ it.key, &it.value });
+        quick_sort(rows, [](auto& a, auto& b) {
+            return a.statistics->sent_bytes + a.statistics->received_bytes > b.statistics->sent_bytes + b.statistics->received_bytes;
+        });
+
+        for (auto& row : rows) {
+            auto& statistics = *row.statistics;
+            dbgln("    {}::{}: sent {} ({} bytes, {}us encoding), received {} ({} bytes, {}us decoding)",
+                endpoint->description.name,
+                endpoint->description.message_name(row.message_id),
+                statistics.sent_count,
+                statistics.sent_bytes,
+                statistics.encode_time_ns / 1000,
+                statistics.received_count,
+                statistics.received_bytes,
+                statistics.decode_time_ns / 1000);
+            auto round_trip_latency = statistics.round_trip_latency.to_json();
+            if (!round_trip_latency.is_empty())
+                dbgln("        round trips: {}", round_trip_latency.to_string());
+        }
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/JsonObject.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+
+namespace IPC {
+
+// Counts samples by order of magnitude: bucket i holds the samples below 2^i microseconds,
+// and the last bucket everything that's even slower than that.
+class LatencyHistogram {
+public:
+    static constexpr size_t bucket_count = 24;
+
+    void record(u64 microseconds);
+    JsonObject to_json() const;
+
+private:
+    Array<u32, bucket_count> m_buckets {};
+};
+
+struct MessageStatistics {
+    u64 sent_count { 0 };
+    u64 sent_bytes { 0 };
+    u64 encode_time_ns { 0 };
+    u64 received_count { 0 };
+    u64 received_bytes { 0 };
+    u64 decode_time_ns { 0 };
+    LatencyHistogram round_trip_latency;
+};
+
+// What went over one Connection, message by message.
+// This is opt-in, and only collected for processes started with IPC_STATISTICS in their environment,
+// which is either "all" or a comma-separated list of endpoint names (e.g. IPC_STATISTICS=WindowServer,WebContentClient).
+// The numbers can be looked at in the Inspector, and are dumped to the debug log when the connection goes away.
+class Statistics {
+    AK_MAKE_NONCOPYABLE(Statistics);
+    AK_MAKE_NONMOVABLE(Statistics);
+
+public:
+    using MessageNameLookup = StringView (*)(i32 message_id);
+
+    struct EndpointDescription {
+        StringView name;
+        u32 magic { 0 };
+        MessageNameLookup message_name { nullptr };
+    };
+
+    // Returns null unless statistics were asked for either of the two endpoints.
+    static OwnPtr<Statistics> create_if_enabled(EndpointDescription local_endpoint, EndpointDescription peer_endpoint);
+
+    Statistics(EndpointDescription local_endpoint, EndpointDescription peer_endpoint);
+    ~Statistics();
+
+    // Monotonic time to measure with, in nanoseconds.
+    static u64 now();
+
+    void did_send(u32 endpoint_magic, i32 message_id, size_t size, u64 encode_time_ns);
+    void did_receive(u32 endpoint_magic, i32 message_id, size_t size, u64 decode_time_ns);
+    void did_receive_response(u32 endpoint_magic, i32 message_id, u64 round_trip_time_ns);
+
+    JsonObject to_json() const;
+    void dump() const;
+
+private:
+    struct Endpoint {
+        EndpointDescription description;
+        HashMap<i32, MessageStatistics> messages;
+    };
+
+    MessageStatistics& statistics_for(u32 endpoint_magic, i32 message_id);
+
+    Endpoint m_local_endpoint;
+    Endpoint m_peer_endpoint;
+    // Anything that doesn't belong to either endpoint, which shouldn't really happen.
+    MessageStatistics m_unknown_messages;
+};
+
+}
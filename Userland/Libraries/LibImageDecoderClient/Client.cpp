@@ -20,11 +20,18 @@ void Client::die()
         on_death();
 }
 
-void Client::dummy()
+void Client::decode_thumbnail(i32 request_id, Core::AnonymousBuffer encoded_data, Gfx::IntSize size)
 {
+    async_decode_thumbnail(request_id, move(encoded_data), size);
 }
 
-Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
+void Client::did_decode_thumbnail(i32 request_id, Gfx::ShareableBitmap const& thumbnail)
+{
+    if (on_thumbnail_decoded)
+        on_thumbnail_decoded(request_id, thumbnail.bitmap());
+}
+
+Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data, Gfx::IntSize ideal_size)
 {
     if (encoded_data.is_empty())
         return {};
@@ -36,7 +43,7 @@ Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
     }
 
     memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
-    auto response_or_error = try_decode_image(move(encoded_buffer));
+    auto response_or_error = try_decode_image(move(encoded_buffer), ideal_size);
 
     if (response_or_error.is_error()) {
         dbgln("ImageDecoder died heroically");
@@ -51,6 +58,7 @@ Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
     DecodedImage image;
     image.is_animated = response.is_animated();
     image.loop_count = response.loop_count();
+    image.size = response.size();
     image.frames.resize(response.bitmaps().size());
     for (size_t i = 0; i < image.frames.size(); ++i) {
         auto& frame = image.frames[i];
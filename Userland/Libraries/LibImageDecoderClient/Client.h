@@ -20,6 +20,8 @@ struct Frame {
 
 struct DecodedImage {
     bool is_animated { false };
+    // The size of the image itself, which the frames are smaller than if it was decoded at a smaller ideal size.
+    Gfx::IntSize size;
     u32 loop_count { 0 };
     Vector<Frame> frames;
 };
@@ -30,16 +32,21 @@ class Client final
     C_OBJECT(Client);
 
 public:
-    Optional<DecodedImage> decode_image(const ByteBuffer&);
+    // Decoders that can decode at a reduced size for less work do that if the image is far larger than ideal_size.
+    Optional<DecodedImage> decode_image(const ByteBuffer&, Gfx::IntSize ideal_size = {});
+
+    // Thumbnails are decoded asynchronously, and handed to on_thumbnail_decoded (as nullptr if that failed).
+    void decode_thumbnail(i32 request_id, Core::AnonymousBuffer encoded_data, Gfx::IntSize);
 
     Function<void()> on_death;
+    Function<void(i32 request_id, RefPtr<Gfx::Bitmap>)> on_thumbnail_decoded;
 
 private:
     Client();
 
     virtual void die() override;
 
-    virtual void dummy() override;
+    virtual void did_decode_thumbnail(i32, Gfx::ShareableBitmap const&) override;
 };
 
 }
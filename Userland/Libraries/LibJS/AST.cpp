@@ -14,6 +14,7 @@
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Parser.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/BigInt.h>
@@ -85,6 +86,26 @@ Value ScopeNode::execute(Interpreter& interpreter, GlobalObject& global_object)
     return interpreter.execute_statement(global_object, *this);
 }
 
+BlockStatement const& LazyFunctionBody::parsed_body() const
+{
+    if (m_parsed_body)
+        return *m_parsed_body;
+
+    auto& start = source_range().start;
+    // NOTE: The lexer counts the first character it reads as one column past the one it starts at.
+    Parser parser(Lexer(m_source, source_range().filename, start.line, start.column - 1));
+    m_parsed_body = parser.parse_lazy_function_body(m_context);
+    // This exact source text was parsed in this exact context before, without any errors.
+    VERIFY(!parser.has_errors());
+    m_source = {};
+    return *m_parsed_body;
+}
+
+Value LazyFunctionBody::execute(Interpreter& interpreter, GlobalObject& global_object) const
+{
+    return parsed_body().execute(interpreter, global_object);
+}
+
 Value Program::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -881,6 +902,11 @@ void ScopeNode::dump(int indent) const
     }
 }
 
+void LazyFunctionBody::dump(int indent) const
+{
+    parsed_body().dump(indent);
+}
+
 void BinaryExpression::dump(int indent) const
 {
     const char* op_string = nullptr;
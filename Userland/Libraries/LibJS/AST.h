@@ -166,6 +166,45 @@ public:
     }
 };
 
+// A function body that has so far only been checked for syntax errors. Its AST is built from a copy
+// of its source text the first time anything asks for it.
+class LazyFunctionBody final : public Statement {
+public:
+    // The parser state the body was first parsed in, which it has to be parsed in again.
+    struct Context {
+        bool strict_mode { false };
+        bool allow_super_property_lookup { false };
+        bool allow_super_constructor_call { false };
+        bool in_generator_function_context { false };
+        bool in_arrow_function_context { false };
+        bool in_break_context { false };
+        bool in_continue_context { false };
+    };
+
+    LazyFunctionBody(SourceRange source_range, String source, Context context)
+        : Statement(move(source_range))
+        , m_source(move(source))
+        , m_context(context)
+    {
+    }
+
+    BlockStatement const& parsed_body() const;
+    bool has_been_parsed() const { return m_parsed_body; }
+
+    // NOTE: The source is only kept around until the body has been parsed.
+    String const& source() const { return m_source; }
+    Context const& context() const { return m_context; }
+
+    virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void dump(int indent) const override;
+    virtual void generate_bytecode(Bytecode::Generator&) const override;
+
+private:
+    mutable String m_source;
+    Context m_context;
+    mutable RefPtr<BlockStatement> m_parsed_body;
+};
+
 class Expression : public ASTNode {
 public:
     Expression(SourceRange source_range)
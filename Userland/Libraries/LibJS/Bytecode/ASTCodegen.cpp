@@ -22,6 +22,11 @@ void ASTNode::generate_bytecode(Bytecode::Generator&) const
     TODO();
 }
 
+void LazyFunctionBody::generate_bytecode(Bytecode::Generator& generator) const
+{
+    parsed_body().generate_bytecode(generator);
+}
+
 void ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
 {
     for (auto& function : functions()) {
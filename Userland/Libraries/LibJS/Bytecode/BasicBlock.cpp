@@ -7,6 +7,7 @@
 #include <AK/String.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Op.h>
+#include <string.h>
 #include <sys/mman.h>
 
 namespace JS::Bytecode {
@@ -64,6 +65,53 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+Instruction const* BasicBlock::terminator() const
+{
+    if (!m_is_terminated)
+        return nullptr;
+    Instruction const* last = nullptr;
+    for (InstructionStreamIterator it(instruction_stream()); !it.at_end(); ++it)
+        last = &*it;
+    return last;
+}
+
+void BasicBlock::append_copy_of(Instruction const& instruction)
+{
+    auto length = instruction.length();
+    VERIFY(can_grow(length));
+    auto* slot = next_slot();
+    size_t fixed_size = 0;
+    bool is_terminator = false;
+
+#define __BYTECODE_OP(op)                                           \
+    case Instruction::Type::op:                                     \
+        new (slot) Op::op(static_cast<Op::op const&>(instruction)); \
+        fixed_size = sizeof(Op::op);                                \
+        is_terminator = Op::op::IsTerminator;                       \
+        break;
+
+    switch (instruction.type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+#undef __BYTECODE_OP
+
+    // Variable-width instructions keep the rest of their operands past the end of the class.
+    memcpy((u8*)slot + fixed_size, (u8 const*)&instruction + fixed_size, length - fixed_size);
+    grow(length);
+    if (is_terminator)
+        m_is_terminated = true;
+}
+
+void BasicBlock::swap_instructions_with(BasicBlock& other)
+{
+    swap(m_buffer, other.m_buffer);
+    swap(m_buffer_capacity, other.m_buffer_capacity);
+    swap(m_buffer_size, other.m_buffer_size);
+    swap(m_is_terminated, other.m_is_terminated);
+}
+
 void InstructionStreamIterator::operator++()
 {
     m_offset += dereference().length();
@@ -9,6 +9,7 @@
 #include <AK/Badge.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/String.h>
+#include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
 
 namespace JS::Bytecode {
@@ -61,6 +62,32 @@ public:
 
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
+    Instruction const* terminator() const;
+
+    // These are for the optimization passes, which build a block's new instruction stream in a scratch block
+    // and then swap it in, so that labels pointing at the block stay valid.
+    template<typename OpType, typename... Args>
+    void append(Args&&... args)
+    {
+        VERIFY(can_grow(sizeof(OpType)));
+        new (next_slot()) OpType(forward<Args>(args)...);
+        grow(sizeof(OpType));
+        if constexpr (OpType::IsTerminator)
+            m_is_terminated = true;
+    }
+    template<typename OpType, typename... Args>
+    void append_with_extra_register_slots(size_t extra_register_slots, Args&&... args)
+    {
+        size_t size_to_allocate = round_up_to_power_of_two(sizeof(OpType) + extra_register_slots * sizeof(Register), alignof(void*));
+        VERIFY(can_grow(size_to_allocate));
+        new (next_slot()) OpType(forward<Args>(args)...);
+        grow(size_to_allocate);
+        if constexpr (OpType::IsTerminator)
+            m_is_terminated = true;
+    }
+
+    void append_copy_of(Instruction const&);
+    void swap_instructions_with(BasicBlock&);
 
     String const& name() const { return m_name; }
 
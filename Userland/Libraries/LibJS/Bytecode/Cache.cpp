@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Hex.h>
+#include <LibCore/File.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibJS/Bytecode/Cache.h>
+#include <LibJS/Bytecode/Serialization.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace JS::Bytecode {
+
+String Cache::path_for(StringView source) const
+{
+    auto digest = Crypto::Hash::SHA256::hash(source);
+    return String::formatted("{}/{}.jsbc", m_directory, encode_hex({ digest.immutable_data(), digest.data_length() }));
+}
+
+Optional<Executable> Cache::load(StringView source, StringView filename) const
+{
+    auto path = path_for(source);
+    auto file_or_error = Core::File::open(path, Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return {};
+    auto bytes = file_or_error.value()->read_all();
+    auto executable = deserialize(bytes, filename);
+    dbgln_if(JS_BYTECODE_DEBUG, "Bytecode cache {} for {}", executable.has_value() ? "hit" : "entry unusable", path);
+    return executable;
+}
+
+void Cache::store(StringView source, Executable const& executable) const
+{
+    auto bytes = serialize(executable);
+    if (!bytes.has_value()) {
+        dbgln_if(JS_BYTECODE_DEBUG, "Bytecode cache: Executable can't be serialized");
+        return;
+    }
+
+    // Write to a temporary file first, so that nobody ever loads a half-written entry.
+    auto path = path_for(source);
+    auto temporary_path = String::formatted("{}.{}", path, getpid());
+    if (mkdir(m_directory.characters(), 0755) < 0 && errno != EEXIST)
+        return;
+    auto file_or_error = Core::File::open(temporary_path, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate);
+    if (file_or_error.is_error())
+        return;
+    bool wrote_everything = file_or_error.value()->write(bytes->data(), bytes->size());
+    file_or_error.value()->close();
+    if (!wrote_everything || rename(temporary_path.characters(), path.characters()) < 0)
+        unlink(temporary_path.characters());
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <LibJS/Bytecode/Generator.h>
+
+namespace JS::Bytecode {
+
+// Keeps serialized executables on disk, keyed by a hash of the source they were generated from.
+class Cache {
+public:
+    explicit Cache(String directory)
+        : m_directory(move(directory))
+    {
+    }
+
+    Optional<Executable> load(StringView source, StringView filename) const;
+    void store(StringView source, Executable const&) const;
+
+private:
+    String path_for(StringView source) const;
+
+    String m_directory;
+};
+
+}
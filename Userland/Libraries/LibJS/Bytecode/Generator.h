@@ -9,12 +9,14 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/SinglyLinkedList.h>
+#include <LibJS/AST.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Op.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Forward.h>
+#include <LibJS/JIT/NativeExecutable.h>
 
 namespace JS::Bytecode {
 
@@ -23,6 +25,13 @@ struct Executable {
     NonnullOwnPtr<StringTable> string_table;
     size_t number_of_registers { 0 };
 
+    // NOTE: The native code refers to the blocks and instructions above, so they can't change once it's been generated.
+    OwnPtr<JIT::NativeExecutable> native_executable;
+
+    // NOTE: NewFunction refers to the function's AST node. Usually that's part of an AST that outlives the executable,
+    //       but an executable that was loaded from a cache holds on to the nodes itself.
+    NonnullRefPtrVector<FunctionDeclaration> function_declarations;
+
     String const& get_string(StringTableIndex index) const { return string_table->get(index); }
 };
 
@@ -65,11 +74,14 @@ public:
     {
         VERIFY(!is_current_block_terminated());
         // If the block doesn't have enough space, switch to another block
+        // NOTE: The size is rounded up so that the next instruction stays pointer-aligned. Instructions hold RefPtrs and
+        //       WeakPtrs, and atomics on those would be split across cache lines otherwise, which is very slow.
+        size_t size_to_allocate = round_up_to_power_of_two(sizeof(OpType) + extra_register_slots * sizeof(Register), alignof(void*));
         if constexpr (!OpType::IsTerminator)
-            ensure_enough_space(sizeof(OpType) + extra_register_slots * sizeof(Register));
+            ensure_enough_space(size_to_allocate);
 
         void* slot = next_slot();
-        grow(sizeof(OpType) + extra_register_slots * sizeof(Register));
+        grow(size_to_allocate);
         new (slot) OpType(forward<Args>(args)...);
         if constexpr (OpType::IsTerminator)
             m_current_basic_block->terminate({});
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/InlineCache.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/ProxyObject.h>
+
+namespace JS::Bytecode {
+
+// Proxies don't keep their properties in their shape, and integer-like names are looked up as indexed properties instead.
+static bool can_cache(Object const& object, StringOrSymbol const& property_name)
+{
+    if (object.shape().is_unique() || is<ProxyObject>(object))
+        return false;
+    return !property_name.is_string() || !property_name.as_string().to_int().has_value();
+}
+
+void PropertyInlineCache::add_for_get(Object& object, StringOrSymbol const& property_name)
+{
+    if (!can_cache(object, property_name))
+        return;
+    auto& shape = object.shape();
+    if (auto metadata = shape.lookup(property_name); metadata.has_value()) {
+        add({ shape.make_weak_ptr(), metadata->offset, false, {} });
+        return;
+    }
+
+    // Methods usually live one step up the prototype chain.
+    auto* prototype = shape.prototype();
+    if (!prototype || !can_cache(*prototype, property_name))
+        return;
+    if (auto metadata = prototype->shape().lookup(property_name); metadata.has_value())
+        add({ shape.make_weak_ptr(), metadata->offset, true, prototype->shape().make_weak_ptr() });
+}
+
+void PropertyInlineCache::add_for_put(Object& object, StringOrSymbol const& property_name)
+{
+    if (!can_cache(object, property_name))
+        return;
+    // NOTE: Only writable properties the object already has itself can be stored to directly. Anything else might
+    //       have to go to a setter further up the prototype chain, or add a property to the object.
+    auto& shape = object.shape();
+    auto metadata = shape.lookup(property_name);
+    if (!metadata.has_value() || !metadata->attributes.is_writable())
+        return;
+    add({ shape.make_weak_ptr(), metadata->offset, false, {} });
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+// Remembers where a GetById or PutById found its property for the last few shapes it has seen, so that looking
+// the property up on another object with one of those shapes is a pointer compare and a load.
+// NOTE: Only shapes that don't change behind our back are cached, which rules out unique shapes.
+//       Shapes are held weakly, so that a new shape that's allocated where a dead one used to be can't be mistaken for it.
+class PropertyInlineCache {
+public:
+    static constexpr size_t entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        size_t offset { 0 };
+        // For properties that were found on the prototype instead, the shape the prototype had back then.
+        bool is_on_prototype { false };
+        WeakPtr<Shape> prototype_shape;
+    };
+
+    // Returns the object that holds the property and where it keeps it, if we know.
+    Object* find_holder(Object& object, size_t& offset) const
+    {
+        auto& shape = object.shape();
+        for (auto& entry : m_entries) {
+            if (entry.shape.ptr() != &shape)
+                continue;
+            offset = entry.offset;
+            if (!entry.is_on_prototype)
+                return &object;
+            auto* prototype = shape.prototype();
+            if (!prototype || &prototype->shape() != entry.prototype_shape.ptr())
+                return nullptr;
+            return prototype;
+        }
+        return nullptr;
+    }
+
+    void add_for_get(Object&, StringOrSymbol const&);
+    void add_for_put(Object&, StringOrSymbol const&);
+
+private:
+    void add(Entry entry)
+    {
+        m_entries[m_next_entry] = move(entry);
+        m_next_entry = (m_next_entry + 1) % entry_count;
+    }
+
+    AK::Array<Entry, entry_count> m_entries;
+    size_t m_next_entry { 0 };
+};
+
+}
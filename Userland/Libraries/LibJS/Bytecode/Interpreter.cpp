@@ -10,6 +10,7 @@
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
 #include <LibJS/Runtime/GlobalObject.h>
 
 namespace JS::Bytecode {
@@ -21,6 +22,22 @@ Interpreter* Interpreter::current()
     return s_current;
 }
 
+PassManager& Interpreter::optimization_pipeline()
+{
+    static OwnPtr<PassManager> s_optimization_pipeline;
+    if (!s_optimization_pipeline) {
+        s_optimization_pipeline = make<PassManager>();
+        s_optimization_pipeline->add<Passes::FoldConstants>();
+        s_optimization_pipeline->add<Passes::ElideLoadsAndStores>();
+        s_optimization_pipeline->add<Passes::ThreadJumps>();
+        s_optimization_pipeline->add<Passes::EliminateDeadBlocks>();
+        s_optimization_pipeline->add<Passes::MergeBlocks>();
+        // Merging blocks puts stores at the end of one block right next to the loads at the start of the next.
+        s_optimization_pipeline->add<Passes::ElideLoadsAndStores>();
+    }
+    return *s_optimization_pipeline;
+}
+
 Interpreter::Interpreter(GlobalObject& global_object)
     : m_vm(global_object.vm())
     , m_global_object(global_object)
@@ -60,8 +77,7 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     if (m_manually_entered_frames) {
         VERIFY(registers().size() >= executable.number_of_registers);
     } else {
-        m_register_windows.append(make<RegisterWindow>());
-        registers().resize(executable.number_of_registers);
+        push_register_window(executable.number_of_registers);
         registers()[Register::global_object_index] = Value(&global_object());
     }
 
@@ -69,9 +85,21 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
         Bytecode::InstructionStreamIterator pc(block->instruction_stream());
         bool will_jump = false;
         bool will_return = false;
+        bool has_executed_instruction = false;
+        if (executable.native_executable) {
+            auto bailout = executable.native_executable->run(*this, registers().data(), *block);
+            if (!bailout.has_value())
+                break;
+            // The native code has already run the instruction it stopped at, so all that's left is to deal with the aftermath.
+            block = bailout->block;
+            pc = Bytecode::InstructionStreamIterator(block->instruction_stream());
+            pc.jump(bailout->offset);
+            has_executed_instruction = true;
+        }
         while (!pc.at_end()) {
             auto& instruction = *pc;
-            instruction.execute(*this);
+            if (!exchange(has_executed_instruction, false))
+                instruction.execute(*this);
             if (vm().exception()) {
                 m_saved_exception = {};
                 if (m_unwind_contexts.is_empty())
@@ -129,14 +157,14 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     vm().set_last_value(Badge<Interpreter> {}, accumulator());
 
     if (!m_manually_entered_frames)
-        m_register_windows.take_last();
+        pop_register_window();
 
     auto return_value = m_return_value.value_or(js_undefined());
     m_return_value = {};
 
     // NOTE: The return value from a called function is put into $0 in the caller context.
     if (!m_register_windows.is_empty())
-        m_register_windows.last()[0] = return_value;
+        registers()[0] = return_value;
 
     if (vm().call_stack().size() == 1)
         vm().pop_call_frame();
@@ -144,6 +172,46 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     return return_value;
 }
 
+// Big enough for a few hundred nested calls of a typical function before another chunk is needed.
+static constexpr size_t register_chunk_size = 16 * KiB;
+
+void Interpreter::push_register_window(size_t size)
+{
+    size_t chunk_index = 0;
+    size_t offset = 0;
+    if (!m_register_windows.is_empty()) {
+        auto& current = m_register_windows.last();
+        chunk_index = current.chunk_index;
+        offset = current.offset + current.registers.size();
+    }
+
+    // Move on to the next chunk when this one is full, making a new one if we haven't been this deep before.
+    while (chunk_index < m_register_chunks.size() && offset + size > m_register_chunks[chunk_index].size()) {
+        ++chunk_index;
+        offset = 0;
+    }
+    if (chunk_index == m_register_chunks.size()) {
+        auto chunk = make<Vector<Value>>();
+        chunk->resize(max(register_chunk_size, size));
+        m_register_chunks.append(move(chunk));
+    }
+
+    auto registers = m_register_chunks[chunk_index].span().slice(offset, size);
+    for (auto& value : registers)
+        value = {};
+    m_register_windows.append({ chunk_index, offset, registers });
+}
+
+void Interpreter::gather_roots(HashTable<Cell*>& roots)
+{
+    for (auto& window : m_register_windows) {
+        for (auto& value : window.registers) {
+            if (value.is_cell())
+                roots.set(&value.as_cell());
+        }
+    }
+}
+
 void Interpreter::enter_unwind_context(Optional<Label> handler_target, Optional<Label> finalizer_target)
 {
     m_unwind_contexts.empend(handler_target.has_value() ? &handler_target->block() : nullptr, finalizer_target.has_value() ? &finalizer_target->block() : nullptr);
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "Generator.h"
+#include <AK/HashTable.h>
+#include <AK/Span.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
@@ -34,18 +36,25 @@ public:
 
     ALWAYS_INLINE Value& accumulator() { return reg(Register::accumulator()); }
     Value& reg(Register const& r) { return registers()[r.index()]; }
-    [[nodiscard]] RegisterWindow snapshot_frame() const { return m_register_windows.last(); }
+    [[nodiscard]] RegisterWindow snapshot_frame() const
+    {
+        RegisterWindow frame;
+        frame.append(registers().data(), registers().size());
+        return frame;
+    }
 
     void enter_frame(RegisterWindow const& frame)
     {
         ++m_manually_entered_frames;
-        m_register_windows.append(make<RegisterWindow>(frame));
+        push_register_window(frame.size());
+        for (size_t i = 0; i < frame.size(); ++i)
+            registers()[i] = frame[i];
     }
     void leave_frame()
     {
         VERIFY(m_manually_entered_frames);
         --m_manually_entered_frames;
-        m_register_windows.take_last();
+        pop_register_window();
     }
 
     void jump(Label const& label)
@@ -54,24 +63,55 @@ public:
     }
     void do_return(Value return_value) { m_return_value = return_value; }
 
+    bool has_pending_jump() const { return m_pending_jump.has_value(); }
+    bool has_return_value() const { return !m_return_value.is_empty(); }
+
     void enter_unwind_context(Optional<Label> handler_target, Optional<Label> finalizer_target);
     void leave_unwind_context();
     void continue_pending_unwind(Label const& resume_label);
 
     Executable const& current_executable() { return *m_current_executable; }
 
+    // Functions compiled while this is enabled go through the optimization pipeline before they first run.
+    bool optimizations_enabled() const { return m_optimizations_enabled; }
+    void set_optimizations_enabled(bool enabled) { m_optimizations_enabled = enabled; }
+
+    static PassManager& optimization_pipeline();
+
+    // Functions compiled while this is enabled also get turned into native code, where that's possible.
+    bool jit_enabled() const { return m_jit_enabled; }
+    void set_jit_enabled(bool enabled) { m_jit_enabled = enabled; }
+
+    void gather_roots(HashTable<Cell*>&);
+
 private:
-    RegisterWindow& registers() { return m_register_windows.last(); }
+    Span<Value> registers() { return m_register_windows.last().registers; }
+    Span<Value const> registers() const { return m_register_windows.last().registers; }
+
+    void push_register_window(size_t size);
+    void pop_register_window() { m_register_windows.take_last(); }
+
+    // NOTE: Register windows are carved out of a few big chunks of registers, one after the other, like a stack.
+    //       The chunks are kept around and never resized, so calls don't allocate once things have warmed up,
+    //       and pointers into a window (like the one native code holds) stay valid while it's active.
+    struct RegisterWindowInChunk {
+        size_t chunk_index { 0 };
+        size_t offset { 0 };
+        Span<Value> registers;
+    };
 
     VM& m_vm;
     GlobalObject& m_global_object;
-    NonnullOwnPtrVector<RegisterWindow> m_register_windows;
+    NonnullOwnPtrVector<Vector<Value>> m_register_chunks;
+    Vector<RegisterWindowInChunk> m_register_windows;
     Optional<BasicBlock const*> m_pending_jump;
     Value m_return_value;
     size_t m_manually_entered_frames { 0 };
     Executable const* m_current_executable { nullptr };
     Vector<UnwindInfo> m_unwind_contexts;
     Handle<Exception> m_saved_exception;
+    bool m_optimizations_enabled { false };
+    bool m_jit_enabled { false };
 };
 
 }
@@ -150,14 +150,45 @@ void SetVariable::execute(Bytecode::Interpreter& interpreter) const
 
 void GetById::execute(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.accumulator().to_object(interpreter.global_object()))
-        interpreter.accumulator() = object->get(interpreter.current_executable().get_string(m_property));
+    auto* object = interpreter.accumulator().to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    size_t offset = 0;
+    if (auto* holder = m_cache.find_holder(*object, offset)) {
+        auto value = holder->get_direct(offset);
+        // Getters still have to be called, so those take the long way around.
+        if (!value.is_accessor() && !value.is_native_property()) {
+            interpreter.accumulator() = value.value_or(js_undefined());
+            return;
+        }
+    }
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    interpreter.accumulator() = object->get(property_name);
+    if (!interpreter.vm().exception())
+        m_cache.add_for_get(*object, property_name);
 }
 
 void PutById::execute(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.reg(m_base).to_object(interpreter.global_object()))
-        object->put(interpreter.current_executable().get_string(m_property), interpreter.accumulator());
+    auto* object = interpreter.reg(m_base).to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    size_t offset = 0;
+    if (m_cache.find_holder(*object, offset) == object) {
+        auto value = object->get_direct(offset);
+        if (!value.is_accessor() && !value.is_native_property()) {
+            object->put_direct(offset, interpreter.accumulator());
+            return;
+        }
+    }
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    object->put(property_name, interpreter.accumulator());
+    if (!interpreter.vm().exception())
+        m_cache.add_for_put(*object, property_name);
 }
 
 void Jump::execute(Bytecode::Interpreter& interpreter) const
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/Bytecode/InlineCache.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
@@ -30,6 +31,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register src() const { return m_src; }
+
 private:
     Register m_src;
 };
@@ -45,6 +48,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Value const& value() const { return m_value; }
+
 private:
     Value m_value;
 };
@@ -60,6 +65,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register dst() const { return m_dst; }
+
 private:
     Register m_dst;
 };
@@ -100,6 +107,8 @@ private:
         void execute(Bytecode::Interpreter&) const;             \
         String to_string(Bytecode::Executable const&) const;    \
                                                                 \
+        Register lhs() const { return m_lhs_reg; }              \
+                                                                \
     private:                                                    \
         Register m_lhs_reg;                                     \
     };
@@ -140,6 +149,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    StringTableIndex string() const { return m_string; }
+
 private:
     StringTableIndex m_string;
 };
@@ -166,6 +177,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Crypto::SignedBigInteger const& bigint() const { return m_bigint; }
+
 private:
     Crypto::SignedBigInteger m_bigint;
 };
@@ -184,6 +197,10 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    size_t length() const { return round_up_to_power_of_two(sizeof(*this) + sizeof(Register) * m_element_count, alignof(void*)); }
+
+    Span<Register const> elements() const { return { m_elements, m_element_count }; }
+
 private:
     size_t m_element_count { 0 };
     Register m_elements[];
@@ -200,6 +217,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register lhs() const { return m_lhs; }
+
 private:
     Register m_lhs;
 };
@@ -215,6 +234,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    StringTableIndex identifier() const { return m_identifier; }
+
 private:
     StringTableIndex m_identifier;
 };
@@ -230,6 +251,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    StringTableIndex identifier() const { return m_identifier; }
+
 private:
     StringTableIndex m_identifier;
 };
@@ -245,8 +268,11 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    StringTableIndex property() const { return m_property; }
+
 private:
     StringTableIndex m_property;
+    mutable PropertyInlineCache m_cache;
 };
 
 class PutById final : public Instruction {
@@ -261,9 +287,13 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+    StringTableIndex property() const { return m_property; }
+
 private:
     Register m_base;
     StringTableIndex m_property;
+    mutable PropertyInlineCache m_cache;
 };
 
 class GetByValue final : public Instruction {
@@ -277,6 +307,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
 };
@@ -293,6 +325,9 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+    Register property() const { return m_property; }
+
 private:
     Register m_base;
     Register m_property;
@@ -322,6 +357,9 @@ public:
         m_false_target = move(false_target);
     }
 
+    auto& true_target() const { return m_true_target; }
+    auto& false_target() const { return m_false_target; }
+
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
@@ -374,7 +412,12 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
-    size_t length() const { return sizeof(*this) + sizeof(Register) * m_argument_count; }
+    size_t length() const { return round_up_to_power_of_two(sizeof(*this) + sizeof(Register) * m_argument_count, alignof(void*)); }
+
+    CallType call_type() const { return m_type; }
+    Register callee() const { return m_callee; }
+    Register this_value() const { return m_this_value; }
+    Span<Register const> arguments() const { return { m_arguments, m_argument_count }; }
 
 private:
     Register m_callee;
@@ -395,6 +438,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    FunctionNode const& function_node() const { return m_function_node; }
+
 private:
     FunctionNode const& m_function_node;
 };
@@ -459,6 +504,9 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    auto& handler_target() const { return m_handler_target; }
+    auto& finalizer_target() const { return m_finalizer_target; }
+
 private:
     Optional<Label> m_handler_target;
     Optional<Label> m_finalizer_target;
@@ -488,6 +536,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    auto& resume_target() const { return m_resume_target; }
+
 private:
     Label m_resume_target;
 };
@@ -510,6 +560,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    auto& continuation() const { return m_continuation_label; }
+
 private:
     Optional<Label> m_continuation_label;
 };
@@ -524,6 +576,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    HashMap<u32, Variable> const& variables() const { return m_variables; }
+
 private:
     HashMap<u32, Variable> m_variables;
 };
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Instructions that do nothing but put something into the accumulator.
+static bool only_writes_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions that replace the accumulator without looking at it first, and can't throw.
+// NOTE: The ones that can throw are left out, as exception handlers and finalizers get to see the accumulator.
+static bool overwrites_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::NewString:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewBigInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ElideLoadsAndStores::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<Instruction const*> kept_instructions;
+        // The registers that are known to hold the same value as the accumulator.
+        Vector<u32, 4> mirrored_registers;
+        bool changed = false;
+
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            auto& instruction = *it;
+
+            if (instruction.type() == Instruction::Type::Load && mirrored_registers.contains_slow(static_cast<Op::Load const&>(instruction).src().index())) {
+                changed = true;
+                continue;
+            }
+            if (instruction.type() == Instruction::Type::Store && mirrored_registers.contains_slow(static_cast<Op::Store const&>(instruction).dst().index())) {
+                changed = true;
+                continue;
+            }
+
+            if (overwrites_accumulator(instruction) && !kept_instructions.is_empty() && only_writes_accumulator(*kept_instructions.last())) {
+                kept_instructions.take_last();
+                changed = true;
+            }
+            kept_instructions.append(&instruction);
+
+            switch (instruction.type()) {
+            case Instruction::Type::Load:
+                mirrored_registers.clear_with_capacity();
+                mirrored_registers.append(static_cast<Op::Load const&>(instruction).src().index());
+                break;
+            case Instruction::Type::Store:
+                mirrored_registers.append(static_cast<Op::Store const&>(instruction).dst().index());
+                break;
+            default:
+                // NOTE: This also covers ConcatString, the only other instruction that writes to a register.
+                mirrored_registers.clear_with_capacity();
+                break;
+            }
+        }
+
+        if (!changed)
+            continue;
+
+        auto rewritten_block = BasicBlock::create(block.name());
+        for (auto* instruction : kept_instructions)
+            rewritten_block->append_copy_of(*instruction);
+        block.swap_instructions_with(*rewritten_block);
+    }
+
+    finished();
+}
+
+}
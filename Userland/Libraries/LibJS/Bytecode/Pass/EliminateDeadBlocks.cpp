@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void EliminateDeadBlocks::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    if (!executable.cfg.has_value()) {
+        GenerateCFG generate_cfg;
+        generate_cfg.perform(executable);
+    }
+
+    // NOTE: The CFG also has edges to exception handlers and generator continuations, so anything that can be
+    //       entered at all is reachable from the entry block.
+    BlockSet reachable_blocks;
+    Vector<BasicBlock const*> blocks_to_visit;
+    blocks_to_visit.append(&executable.executable.basic_blocks.first());
+    while (!blocks_to_visit.is_empty()) {
+        auto* block = blocks_to_visit.take_last();
+        if (reachable_blocks.set(block) != AK::HashSetResult::InsertedNewEntry)
+            continue;
+        for (auto* successor : executable.cfg->find(block)->value)
+            blocks_to_visit.append(successor);
+    }
+
+    if (reachable_blocks.size() != executable.executable.basic_blocks.size()) {
+        executable.executable.basic_blocks.remove_all_matching([&](auto& block) { return !reachable_blocks.contains(block.ptr()); });
+        executable.invalidate_cfg();
+    }
+
+    finished();
+}
+
+}
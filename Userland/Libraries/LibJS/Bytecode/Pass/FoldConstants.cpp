@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// NOTE: Only numbers are folded, as that's all these operations can do without calling into anything
+//       that might throw or touch the heap. The results have to match Value.cpp's exactly.
+static Optional<Value> fold_binary_operation(Instruction::Type type, Value lhs, Value rhs)
+{
+    if (!lhs.is_number() || !rhs.is_number())
+        return {};
+    auto a = lhs.as_double();
+    auto b = rhs.as_double();
+    switch (type) {
+    case Instruction::Type::Add:
+        return Value(a + b);
+    case Instruction::Type::Sub:
+        return Value(a - b);
+    case Instruction::Type::Mul:
+        return Value(a * b);
+    case Instruction::Type::Div:
+        return Value(a / b);
+    case Instruction::Type::LessThan:
+        return Value(a < b);
+    case Instruction::Type::LessThanEquals:
+        return Value(a <= b);
+    case Instruction::Type::GreaterThan:
+        return Value(a > b);
+    case Instruction::Type::GreaterThanEquals:
+        return Value(a >= b);
+    case Instruction::Type::TypedEquals:
+    case Instruction::Type::AbstractEquals:
+        return Value(a == b);
+    case Instruction::Type::TypedInequals:
+    case Instruction::Type::AbstractInequals:
+        return Value(a != b);
+    default:
+        return {};
+    }
+}
+
+static Optional<Register> binary_operation_lhs(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+#define __BYTECODE_BINARY_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:          \
+        return static_cast<Op::OpTitleCase const&>(instruction).lhs();
+        JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_BINARY_OP)
+#undef __BYTECODE_BINARY_OP
+    default:
+        return {};
+    }
+}
+
+void FoldConstants::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    bool changed_any_jumps = false;
+    for (auto& block : executable.executable.basic_blocks) {
+        // What we know about the accumulator and the registers at each point in the block.
+        // NOTE: Nothing but Store and ConcatString writes to any register other than the accumulator.
+        Optional<Value> accumulator;
+        HashMap<u32, Value> registers;
+
+        HashMap<Instruction const*, Value> folded_values;
+        Optional<Label> folded_jump_target;
+        size_t new_size = 0;
+
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            auto& instruction = *it;
+            new_size += instruction.length();
+
+            switch (instruction.type()) {
+            case Instruction::Type::LoadImmediate:
+                accumulator = static_cast<Op::LoadImmediate const&>(instruction).value();
+                continue;
+            case Instruction::Type::Load:
+                accumulator = registers.get(static_cast<Op::Load const&>(instruction).src().index());
+                continue;
+            case Instruction::Type::Store: {
+                auto destination = static_cast<Op::Store const&>(instruction).dst().index();
+                if (accumulator.has_value())
+                    registers.set(destination, *accumulator);
+                else
+                    registers.remove(destination);
+                continue;
+            }
+            case Instruction::Type::ConcatString:
+                registers.remove(static_cast<Op::ConcatString const&>(instruction).lhs().index());
+                continue;
+            case Instruction::Type::Not:
+                if (accumulator.has_value()) {
+                    accumulator = Value(!accumulator->to_boolean());
+                    folded_values.set(&instruction, *accumulator);
+                    new_size += sizeof(Op::LoadImmediate) - instruction.length();
+                }
+                continue;
+            case Instruction::Type::UnaryMinus:
+                if (accumulator.has_value() && accumulator->is_number()) {
+                    accumulator = Value(-accumulator->as_double());
+                    folded_values.set(&instruction, *accumulator);
+                    new_size += sizeof(Op::LoadImmediate) - instruction.length();
+                    continue;
+                }
+                accumulator.clear();
+                continue;
+            case Instruction::Type::JumpConditional:
+            case Instruction::Type::JumpNullish: {
+                if (!accumulator.has_value())
+                    continue;
+                auto& jump = static_cast<Op::Jump const&>(instruction);
+                bool condition = instruction.type() == Instruction::Type::JumpConditional ? accumulator->to_boolean() : accumulator->is_nullish();
+                folded_jump_target = condition ? jump.true_target() : jump.false_target();
+                continue;
+            }
+            default:
+                break;
+            }
+
+            if (auto lhs = binary_operation_lhs(instruction); lhs.has_value()) {
+                auto lhs_value = registers.get(lhs->index());
+                Optional<Value> result;
+                if (lhs_value.has_value() && accumulator.has_value())
+                    result = fold_binary_operation(instruction.type(), *lhs_value, *accumulator);
+                if (result.has_value()) {
+                    folded_values.set(&instruction, *result);
+                    new_size += sizeof(Op::LoadImmediate) - instruction.length();
+                }
+                accumulator = result;
+                continue;
+            }
+
+            // Anything else might leave just about anything in the accumulator.
+            accumulator.clear();
+        }
+
+        if (folded_values.is_empty() && !folded_jump_target.has_value())
+            continue;
+
+        auto rewritten_block = BasicBlock::create(block.name());
+        if (!rewritten_block->can_grow(new_size))
+            continue;
+
+        auto* terminator = block.terminator();
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            auto& instruction = *it;
+            if (auto value = folded_values.get(&instruction); value.has_value())
+                rewritten_block->append<Op::LoadImmediate>(*value);
+            else if (&instruction == terminator && folded_jump_target.has_value())
+                rewritten_block->append<Op::Jump>(folded_jump_target);
+            else
+                rewritten_block->append_copy_of(instruction);
+        }
+        block.swap_instructions_with(*rewritten_block);
+
+        if (folded_jump_target.has_value())
+            changed_any_jumps = true;
+    }
+
+    if (changed_any_jumps)
+        executable.invalidate_cfg();
+
+    finished();
+}
+
+}
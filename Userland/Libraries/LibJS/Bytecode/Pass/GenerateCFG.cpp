@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void GenerateCFG::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    executable.cfg = HashMap<BasicBlock const*, BlockSet> {};
+    executable.inverted_cfg = HashMap<BasicBlock const*, BlockSet> {};
+    executable.exported_blocks = BlockSet {};
+
+    auto& cfg = *executable.cfg;
+    auto& inverted_cfg = *executable.inverted_cfg;
+    auto& exported_blocks = *executable.exported_blocks;
+
+    exported_blocks.set(&executable.executable.basic_blocks.first());
+
+    for (auto& block : executable.executable.basic_blocks) {
+        auto& successors = cfg.ensure(&block);
+        inverted_cfg.ensure(&block);
+
+        auto enter_label = [&](Optional<Label> const& label, bool exported) {
+            if (!label.has_value())
+                return;
+            auto* target = &label->block();
+            successors.set(target);
+            inverted_cfg.ensure(target).set(&block);
+            if (exported)
+                exported_blocks.set(target);
+        };
+
+        InstructionStreamIterator it(block.instruction_stream());
+        for (; !it.at_end(); ++it) {
+            auto& instruction = *it;
+            switch (instruction.type()) {
+            case Instruction::Type::Jump:
+            case Instruction::Type::JumpConditional:
+            case Instruction::Type::JumpNullish: {
+                auto& jump = static_cast<Op::Jump const&>(instruction);
+                enter_label(jump.true_target(), false);
+                enter_label(jump.false_target(), false);
+                break;
+            }
+            case Instruction::Type::EnterUnwindContext: {
+                // These are entered when something throws, from wherever that happens to be.
+                auto& enter = static_cast<Op::EnterUnwindContext const&>(instruction);
+                enter_label(enter.handler_target(), true);
+                enter_label(enter.finalizer_target(), true);
+                break;
+            }
+            case Instruction::Type::ContinuePendingUnwind:
+                enter_label(static_cast<Op::ContinuePendingUnwind const&>(instruction).resume_target(), false);
+                break;
+            case Instruction::Type::Yield:
+                // The generator object comes back in here the next time it's resumed.
+                enter_label(static_cast<Op::Yield const&>(instruction).continuation(), true);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    finished();
+}
+
+}
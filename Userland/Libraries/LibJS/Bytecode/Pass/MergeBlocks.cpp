@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void MergeBlocks::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    if (!executable.cfg.has_value()) {
+        GenerateCFG generate_cfg;
+        generate_cfg.perform(executable);
+    }
+
+    auto& cfg = *executable.cfg;
+    auto& inverted_cfg = *executable.inverted_cfg;
+    auto& exported_blocks = *executable.exported_blocks;
+
+    BlockSet merged_blocks;
+    for (auto& block : executable.executable.basic_blocks) {
+        if (merged_blocks.contains(&block))
+            continue;
+
+        // Keep going for as long as there's something to glue on, so that whole chains end up in one block.
+        for (;;) {
+            auto* terminator = block.terminator();
+            if (!terminator || terminator->type() != Instruction::Type::Jump)
+                break;
+            auto& target = static_cast<Op::Jump const*>(terminator)->true_target();
+            if (!target.has_value())
+                break;
+
+            auto* successor = &target->block();
+            if (successor == &block || exported_blocks.contains(successor))
+                break;
+            auto& predecessors = inverted_cfg.find(successor)->value;
+            if (predecessors.size() != 1)
+                break;
+
+            auto merged_block = BasicBlock::create(block.name());
+            if (!merged_block->can_grow(block.instruction_stream().size() - sizeof(Op::Jump) + successor->instruction_stream().size()))
+                break;
+            for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+                if (&*it != terminator)
+                    merged_block->append_copy_of(*it);
+            }
+            for (InstructionStreamIterator it(successor->instruction_stream()); !it.at_end(); ++it)
+                merged_block->append_copy_of(*it);
+            block.swap_instructions_with(*merged_block);
+
+            // Everything that used to come after the successor now comes after this block instead.
+            auto& successors = cfg.find(&block)->value;
+            successors.remove(successor);
+            for (auto* next : cfg.find(successor)->value) {
+                auto& next_predecessors = inverted_cfg.find(next)->value;
+                next_predecessors.remove(successor);
+                next_predecessors.set(&block);
+                successors.set(next);
+            }
+            cfg.find(successor)->value.clear();
+            predecessors.clear();
+            merged_blocks.set(successor);
+        }
+    }
+
+    if (!merged_blocks.is_empty()) {
+        executable.executable.basic_blocks.remove_all_matching([&](auto& block) { return merged_blocks.contains(block.ptr()); });
+        executable.invalidate_cfg();
+    }
+
+    finished();
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Follows the label through any number of blocks that do nothing but jump, and returns where it ends up.
+static Label resolve_final_target(Label label)
+{
+    BlockSet visited_blocks;
+    for (;;) {
+        auto& block = label.block();
+        if (block.instruction_stream().size() != sizeof(Op::Jump))
+            return label;
+        auto* terminator = block.terminator();
+        if (!terminator || terminator->type() != Instruction::Type::Jump)
+            return label;
+        auto& next_target = static_cast<Op::Jump const*>(terminator)->true_target();
+        // NOTE: `for (;;) {}` is a block that jumps to itself, and there's no going anywhere from there.
+        if (!next_target.has_value() || visited_blocks.set(&block) != AK::HashSetResult::InsertedNewEntry)
+            return label;
+        label = *next_target;
+    }
+}
+
+void ThreadJumps::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    bool changed = false;
+    for (auto& block : executable.executable.basic_blocks) {
+        auto* terminator = block.terminator();
+        if (!terminator)
+            continue;
+        if (terminator->type() != Instruction::Type::Jump && terminator->type() != Instruction::Type::JumpConditional && terminator->type() != Instruction::Type::JumpNullish)
+            continue;
+
+        auto& jump = const_cast<Op::Jump&>(static_cast<Op::Jump const&>(*terminator));
+        Optional<Label> true_target;
+        Optional<Label> false_target;
+        if (jump.true_target().has_value())
+            true_target = resolve_final_target(*jump.true_target());
+        if (jump.false_target().has_value())
+            false_target = resolve_final_target(*jump.false_target());
+
+        auto is_same_target = [](auto& a, auto& b) {
+            return a.has_value() == b.has_value() && (!a.has_value() || &a->block() == &b->block());
+        };
+        if (is_same_target(true_target, jump.true_target()) && is_same_target(false_target, jump.false_target()))
+            continue;
+        jump.set_targets(move(true_target), move(false_target));
+        changed = true;
+    }
+
+    if (changed)
+        executable.invalidate_cfg();
+
+    finished();
+}
+
+}
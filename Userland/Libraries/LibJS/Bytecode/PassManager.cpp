@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode {
+
+void PassManager::perform(PassPipelineExecutable& executable)
+{
+    started();
+    for (auto& pass : m_passes) {
+        pass.perform(executable);
+        dbgln_if(JS_BYTECODE_DEBUG, "Bytecode pass {} took {}us, {} blocks left", pass.name(), pass.elapsed(), executable.executable.basic_blocks.size());
+    }
+    finished();
+}
+
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Time.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <sys/time.h>
+
+namespace JS::Bytecode {
+
+using BlockSet = HashTable<BasicBlock const*>;
+
+struct PassPipelineExecutable {
+    Executable& executable;
+
+    // Filled in by Passes::GenerateCFG, and thrown away by every pass that changes which block goes where.
+    // NOTE: Blocks that are entered from outside the normal flow of control (exception handlers, finalizers,
+    //       generator continuations and the entry block) are "exported", and must be kept as they are.
+    Optional<HashMap<BasicBlock const*, BlockSet>> cfg {};
+    Optional<HashMap<BasicBlock const*, BlockSet>> inverted_cfg {};
+    Optional<BlockSet> exported_blocks {};
+
+    void invalidate_cfg()
+    {
+        cfg.clear();
+        inverted_cfg.clear();
+        exported_blocks.clear();
+    }
+};
+
+class Pass {
+public:
+    Pass() = default;
+    virtual ~Pass() = default;
+
+    virtual StringView name() const = 0;
+    virtual void perform(PassPipelineExecutable&) = 0;
+
+    void started()
+    {
+        gettimeofday(&m_started_time, nullptr);
+    }
+    void finished()
+    {
+        struct timeval finished_time;
+        gettimeofday(&finished_time, nullptr);
+        timeval_sub(finished_time, m_started_time, m_time_difference);
+    }
+
+    u64 elapsed() const
+    {
+        return static_cast<u64>(m_time_difference.tv_sec) * 1000000 + static_cast<u64>(m_time_difference.tv_usec);
+    }
+
+protected:
+    struct timeval m_started_time;
+    struct timeval m_time_difference {};
+};
+
+class PassManager : public Pass {
+public:
+    PassManager() = default;
+    ~PassManager() override = default;
+
+    template<typename PassT, typename... Args>
+    void add(Args&&... args)
+    {
+        m_passes.append(make<PassT>(forward<Args>(args)...));
+    }
+
+    virtual StringView name() const override { return "PassManager"; }
+
+    void perform(Executable& executable)
+    {
+        PassPipelineExecutable pipeline_executable { executable };
+        perform(pipeline_executable);
+    }
+
+    virtual void perform(PassPipelineExecutable&) override;
+
+    NonnullOwnPtrVector<Pass> const& passes() const { return m_passes; }
+
+private:
+    NonnullOwnPtrVector<Pass> m_passes;
+};
+
+namespace Passes {
+
+#define JS_DECLARE_BYTECODE_PASS(PassName)                                  \
+    class PassName final : public Pass {                                    \
+    public:                                                                 \
+        PassName() = default;                                               \
+        ~PassName() override = default;                                     \
+                                                                            \
+        virtual StringView name() const override { return #PassName; }       \
+        virtual void perform(PassPipelineExecutable&) override;             \
+    };
+
+// Works out which blocks can go to which, for the passes that need to know.
+JS_DECLARE_BYTECODE_PASS(GenerateCFG)
+
+// Replaces conditions on values that are known while generating code (like `while (true)`) with plain jumps,
+// and evaluates arithmetic and comparisons on numeric constants right away.
+JS_DECLARE_BYTECODE_PASS(FoldConstants)
+
+// Drops loads of values that are already in the accumulator, stores of values that are already in their
+// register, and loads into the accumulator that are overwritten before anyone gets to see them.
+JS_DECLARE_BYTECODE_PASS(ElideLoadsAndStores)
+
+// Makes jumps into blocks that do nothing but jump somewhere else go straight to where they'd end up.
+JS_DECLARE_BYTECODE_PASS(ThreadJumps)
+
+// Appends blocks that are only ever jumped to from the end of one other block to that block.
+JS_DECLARE_BYTECODE_PASS(MergeBlocks)
+
+// Throws away blocks that can't be reached from the entry block.
+JS_DECLARE_BYTECODE_PASS(EliminateDeadBlocks)
+
+#undef JS_DECLARE_BYTECODE_PASS
+
+}
+
+}
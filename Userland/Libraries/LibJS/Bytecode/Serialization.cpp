@@ -0,0 +1,675 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/MemoryStream.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Serialization.h>
+
+namespace JS::Bytecode {
+
+static constexpr u32 serialization_magic = 0x4342534a; // "JSBC"
+// NOTE: Bump this whenever the encoding or any of the instructions change.
+static constexpr u32 serialization_version = 1;
+
+static constexpr u32 no_label = NumericLimits<u32>::max();
+
+class Encoder {
+public:
+    explicit Encoder(Executable const& executable)
+        : m_executable(executable)
+    {
+    }
+
+    Optional<ByteBuffer> encode()
+    {
+        m_stream << serialization_magic << serialization_version;
+        m_stream << static_cast<u32>(m_executable.number_of_registers);
+
+        auto& string_table = *m_executable.string_table;
+        m_stream << static_cast<u32>(string_table.size());
+        for (size_t i = 0; i < string_table.size(); ++i)
+            encode_string(string_table.get(i));
+
+        m_stream << static_cast<u32>(m_executable.basic_blocks.size());
+        for (size_t i = 0; i < m_executable.basic_blocks.size(); ++i) {
+            auto& block = m_executable.basic_blocks[i];
+            m_block_indices.set(&block, i);
+            encode_string(block.name());
+        }
+
+        for (auto& block : m_executable.basic_blocks) {
+            u32 instruction_count = 0;
+            for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it)
+                ++instruction_count;
+            m_stream << instruction_count;
+            for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+                if (!encode_instruction(*it))
+                    return {};
+            }
+        }
+
+        return m_stream.copy_into_contiguous_buffer();
+    }
+
+private:
+    void encode_string(StringView string)
+    {
+        m_stream << static_cast<u32>(string.length());
+        m_stream << string.bytes();
+    }
+
+    void encode_register(Register reg) { m_stream << reg.index(); }
+    void encode_string_index(StringTableIndex index) { m_stream << static_cast<u32>(index.value()); }
+
+    void encode_registers(Span<Register const> registers)
+    {
+        m_stream << static_cast<u32>(registers.size());
+        for (auto reg : registers)
+            encode_register(reg);
+    }
+
+    void encode_label(Optional<Label> const& label)
+    {
+        m_stream << (label.has_value() ? m_block_indices.get(&label->block()).value() : no_label);
+    }
+
+    void encode_position(Position const& position)
+    {
+        m_stream << static_cast<u64>(position.line) << static_cast<u64>(position.column);
+    }
+
+    // NOTE: Only values the generator can put into an instruction by itself can be encoded, nothing that lives on the heap.
+    bool encode_value(Value value)
+    {
+        m_stream << static_cast<u8>(value.type());
+        switch (value.type()) {
+        case Value::Type::Empty:
+        case Value::Type::Undefined:
+        case Value::Type::Null:
+            return true;
+        case Value::Type::Int32:
+            m_stream << value.as_i32();
+            return true;
+        case Value::Type::Double:
+            m_stream << value.as_double();
+            return true;
+        case Value::Type::Boolean:
+            m_stream << static_cast<u8>(value.as_bool());
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Functions are encoded as their parameters and the source text of their bodies, which gets parsed again once they're called.
+    bool encode_function(FunctionNode const& function)
+    {
+        if (!is<LazyFunctionBody>(function.body()))
+            return false;
+        auto& body = static_cast<LazyFunctionBody const&>(function.body());
+        if (body.has_been_parsed())
+            return false;
+
+        encode_string(function.name());
+        m_stream << static_cast<i32>(function.function_length());
+        m_stream << static_cast<u8>(function.is_generator()) << static_cast<u8>(function.is_strict_mode());
+
+        m_stream << static_cast<u32>(function.parameters().size());
+        for (auto& parameter : function.parameters()) {
+            auto* name = parameter.binding.get_pointer<FlyString>();
+            if (!name || parameter.default_value)
+                return false;
+            encode_string(*name);
+            m_stream << static_cast<u8>(parameter.is_rest);
+        }
+
+        encode_position(body.source_range().start);
+        encode_position(body.source_range().end);
+        encode_string(body.source());
+        auto& context = body.context();
+        m_stream << static_cast<u8>(context.strict_mode)
+                 << static_cast<u8>(context.allow_super_property_lookup)
+                 << static_cast<u8>(context.allow_super_constructor_call)
+                 << static_cast<u8>(context.in_generator_function_context)
+                 << static_cast<u8>(context.in_arrow_function_context)
+                 << static_cast<u8>(context.in_break_context)
+                 << static_cast<u8>(context.in_continue_context);
+        return true;
+    }
+
+    bool encode_instruction(Instruction const& instruction)
+    {
+        m_stream << static_cast<u8>(instruction.type());
+
+        switch (instruction.type()) {
+        case Instruction::Type::Load:
+            encode_register(static_cast<Op::Load const&>(instruction).src());
+            return true;
+        case Instruction::Type::LoadImmediate:
+            return encode_value(static_cast<Op::LoadImmediate const&>(instruction).value());
+        case Instruction::Type::Store:
+            encode_register(static_cast<Op::Store const&>(instruction).dst());
+            return true;
+        case Instruction::Type::ConcatString:
+            encode_register(static_cast<Op::ConcatString const&>(instruction).lhs());
+            return true;
+#define __BYTECODE_BINARY_OP(OpTitleCase, op_snake_case)                      \
+    case Instruction::Type::OpTitleCase:                                      \
+        encode_register(static_cast<Op::OpTitleCase const&>(instruction).lhs()); \
+        return true;
+            JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_BINARY_OP)
+#undef __BYTECODE_BINARY_OP
+#define __BYTECODE_UNARY_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:
+            JS_ENUMERATE_COMMON_UNARY_OPS(__BYTECODE_UNARY_OP)
+#undef __BYTECODE_UNARY_OP
+        case Instruction::Type::NewObject:
+        case Instruction::Type::Return:
+        case Instruction::Type::Increment:
+        case Instruction::Type::Decrement:
+        case Instruction::Type::Throw:
+        case Instruction::Type::LeaveUnwindContext:
+            return true;
+        case Instruction::Type::NewBigInt:
+            encode_string(static_cast<Op::NewBigInt const&>(instruction).bigint().to_base10());
+            return true;
+        case Instruction::Type::NewArray:
+            encode_registers(static_cast<Op::NewArray const&>(instruction).elements());
+            return true;
+        case Instruction::Type::NewString:
+            encode_string_index(static_cast<Op::NewString const&>(instruction).string());
+            return true;
+        case Instruction::Type::GetVariable:
+            encode_string_index(static_cast<Op::GetVariable const&>(instruction).identifier());
+            return true;
+        case Instruction::Type::SetVariable:
+            encode_string_index(static_cast<Op::SetVariable const&>(instruction).identifier());
+            return true;
+        case Instruction::Type::GetById:
+            encode_string_index(static_cast<Op::GetById const&>(instruction).property());
+            return true;
+        case Instruction::Type::PutById: {
+            auto& put = static_cast<Op::PutById const&>(instruction);
+            encode_register(put.base());
+            encode_string_index(put.property());
+            return true;
+        }
+        case Instruction::Type::GetByValue:
+            encode_register(static_cast<Op::GetByValue const&>(instruction).base());
+            return true;
+        case Instruction::Type::PutByValue: {
+            auto& put = static_cast<Op::PutByValue const&>(instruction);
+            encode_register(put.base());
+            encode_register(put.property());
+            return true;
+        }
+        case Instruction::Type::Jump:
+        case Instruction::Type::JumpConditional:
+        case Instruction::Type::JumpNullish: {
+            auto& jump = static_cast<Op::Jump const&>(instruction);
+            encode_label(jump.true_target());
+            encode_label(jump.false_target());
+            return true;
+        }
+        case Instruction::Type::Call: {
+            auto& call = static_cast<Op::Call const&>(instruction);
+            m_stream << static_cast<u8>(call.call_type());
+            encode_register(call.callee());
+            encode_register(call.this_value());
+            encode_registers(call.arguments());
+            return true;
+        }
+        case Instruction::Type::NewFunction:
+            return encode_function(static_cast<Op::NewFunction const&>(instruction).function_node());
+        case Instruction::Type::PushLexicalEnvironment: {
+            auto& variables = static_cast<Op::PushLexicalEnvironment const&>(instruction).variables();
+            m_stream << static_cast<u32>(variables.size());
+            for (auto& entry : variables) {
+                m_stream << entry.key << static_cast<u8>(entry.value.declaration_kind);
+                if (!encode_value(entry.value.value))
+                    return false;
+            }
+            return true;
+        }
+        case Instruction::Type::EnterUnwindContext: {
+            auto& enter = static_cast<Op::EnterUnwindContext const&>(instruction);
+            encode_label(enter.handler_target());
+            encode_label(enter.finalizer_target());
+            return true;
+        }
+        case Instruction::Type::ContinuePendingUnwind:
+            encode_label(static_cast<Op::ContinuePendingUnwind const&>(instruction).resume_target());
+            return true;
+        case Instruction::Type::Yield:
+            encode_label(static_cast<Op::Yield const&>(instruction).continuation());
+            return true;
+        }
+        VERIFY_NOT_REACHED();
+    }
+
+    Executable const& m_executable;
+    DuplexMemoryStream m_stream;
+    HashMap<BasicBlock const*, u32> m_block_indices;
+};
+
+class Decoder {
+public:
+    Decoder(ReadonlyBytes bytes, StringView filename)
+        : m_stream(bytes)
+        , m_filename(filename)
+    {
+    }
+
+    ~Decoder()
+    {
+        m_stream.handle_any_error();
+    }
+
+    Optional<Executable> decode()
+    {
+        u32 magic = 0;
+        u32 version = 0;
+        u32 number_of_registers = 0;
+        if (!read(magic) || !read(version) || magic != serialization_magic || version != serialization_version)
+            return {};
+        // The accumulator and the global object are always there.
+        if (!read(number_of_registers) || number_of_registers < 2)
+            return {};
+        m_number_of_registers = number_of_registers;
+
+        auto string_table = make<StringTable>();
+        u32 string_count = 0;
+        if (!read(string_count))
+            return {};
+        for (u32 i = 0; i < string_count; ++i) {
+            auto string = decode_string();
+            // NOTE: The table was built without duplicates, so inserting its strings one by one gives them the same indices.
+            if (!string.has_value() || string_table->insert(*string).value() != i)
+                return {};
+        }
+        m_string_count = string_count;
+
+        u32 block_count = 0;
+        if (!read(block_count) || block_count == 0)
+            return {};
+        NonnullOwnPtrVector<BasicBlock> blocks;
+        for (u32 i = 0; i < block_count; ++i) {
+            auto name = decode_string();
+            if (!name.has_value())
+                return {};
+            blocks.append(BasicBlock::create(name.release_value()));
+        }
+        m_blocks = &blocks;
+
+        for (auto& block : blocks) {
+            u32 instruction_count = 0;
+            if (!read(instruction_count))
+                return {};
+            for (u32 i = 0; i < instruction_count; ++i) {
+                if (!decode_instruction(block))
+                    return {};
+            }
+        }
+        if (!m_stream.eof())
+            return {};
+
+        return Executable { move(blocks), move(string_table), m_number_of_registers, {}, move(m_function_declarations) };
+    }
+
+private:
+    template<typename T>
+    bool read(T& value)
+    {
+        m_stream >> value;
+        return !m_stream.has_any_error();
+    }
+
+    bool read_bool(bool& value)
+    {
+        u8 byte = 0;
+        if (!read(byte) || byte > 1)
+            return false;
+        value = byte;
+        return true;
+    }
+
+    Optional<String> decode_string()
+    {
+        u32 length = 0;
+        if (!read(length) || length > m_stream.remaining())
+            return {};
+        auto bytes = m_stream.bytes().slice(m_stream.offset(), length);
+        m_stream.discard_or_error(length);
+        return String { bytes };
+    }
+
+    Optional<Register> decode_register()
+    {
+        u32 index = 0;
+        if (!read(index) || index >= m_number_of_registers)
+            return {};
+        return Register { index };
+    }
+
+    Optional<Vector<Register>> decode_registers()
+    {
+        u32 count = 0;
+        if (!read(count) || count > m_stream.remaining() / sizeof(u32))
+            return {};
+        Vector<Register> registers;
+        registers.ensure_capacity(count);
+        for (u32 i = 0; i < count; ++i) {
+            auto reg = decode_register();
+            if (!reg.has_value())
+                return {};
+            registers.unchecked_append(*reg);
+        }
+        return registers;
+    }
+
+    Optional<StringTableIndex> decode_string_index()
+    {
+        u32 index = 0;
+        if (!read(index) || index >= m_string_count)
+            return {};
+        return StringTableIndex { index };
+    }
+
+    // The outer Optional is empty when decoding failed, the inner one when there's no label.
+    Optional<Optional<Label>> decode_label()
+    {
+        u32 index = 0;
+        if (!read(index))
+            return {};
+        if (index == no_label)
+            return Optional<Label> {};
+        if (index >= m_blocks->size())
+            return {};
+        return Optional<Label> { Label { m_blocks->at(index) } };
+    }
+
+    Optional<Position> decode_position()
+    {
+        u64 line = 0;
+        u64 column = 0;
+        if (!read(line) || !read(column))
+            return {};
+        return Position { static_cast<size_t>(line), static_cast<size_t>(column) };
+    }
+
+    Optional<Value> decode_value()
+    {
+        u8 type = 0;
+        if (!read(type))
+            return {};
+        switch (static_cast<Value::Type>(type)) {
+        case Value::Type::Empty:
+        case Value::Type::Undefined:
+        case Value::Type::Null:
+            return Value(static_cast<Value::Type>(type));
+        case Value::Type::Int32: {
+            i32 value = 0;
+            if (!read(value))
+                return {};
+            return Value(value);
+        }
+        case Value::Type::Double: {
+            double value = 0;
+            if (!read(value))
+                return {};
+            return Value(value);
+        }
+        case Value::Type::Boolean: {
+            bool value = false;
+            if (!read_bool(value))
+                return {};
+            return Value(value);
+        }
+        default:
+            return {};
+        }
+    }
+
+    FunctionNode const* decode_function()
+    {
+        auto name = decode_string();
+        i32 function_length = 0;
+        bool is_generator = false;
+        bool is_strict = false;
+        u32 parameter_count = 0;
+        if (!name.has_value() || !read(function_length) || !read_bool(is_generator) || !read_bool(is_strict) || !read(parameter_count))
+            return nullptr;
+
+        Vector<FunctionNode::Parameter> parameters;
+        for (u32 i = 0; i < parameter_count; ++i) {
+            auto parameter_name = decode_string();
+            bool is_rest = false;
+            if (!parameter_name.has_value() || !read_bool(is_rest))
+                return nullptr;
+            parameters.append({ FlyString { *parameter_name }, {}, is_rest });
+        }
+
+        auto start = decode_position();
+        auto end = decode_position();
+        auto source = decode_string();
+        LazyFunctionBody::Context context;
+        if (!start.has_value() || !end.has_value() || !source.has_value()
+            || !read_bool(context.strict_mode)
+            || !read_bool(context.allow_super_property_lookup)
+            || !read_bool(context.allow_super_constructor_call)
+            || !read_bool(context.in_generator_function_context)
+            || !read_bool(context.in_arrow_function_context)
+            || !read_bool(context.in_break_context)
+            || !read_bool(context.in_continue_context))
+            return nullptr;
+
+        SourceRange source_range { m_filename, *start, *end };
+        auto body = create_ast_node<LazyFunctionBody>(source_range, source.release_value(), context);
+        auto function = create_ast_node<FunctionDeclaration>(source_range, *name, move(body), move(parameters), function_length, NonnullRefPtrVector<VariableDeclaration>(), is_generator, is_strict);
+        m_function_declarations.append(function);
+        return &m_function_declarations.last();
+    }
+
+    template<typename OpType, typename... Args>
+    bool append(BasicBlock& block, Args&&... args)
+    {
+        if (!block.can_grow(sizeof(OpType)))
+            return false;
+        block.append<OpType>(forward<Args>(args)...);
+        return true;
+    }
+
+    template<typename OpType, typename... Args>
+    bool append_with_extra_register_slots(BasicBlock& block, size_t extra_register_slots, Args&&... args)
+    {
+        if (!block.can_grow(round_up_to_power_of_two(sizeof(OpType) + extra_register_slots * sizeof(Register), alignof(void*))))
+            return false;
+        block.append_with_extra_register_slots<OpType>(extra_register_slots, forward<Args>(args)...);
+        return true;
+    }
+
+    bool decode_instruction(BasicBlock& block)
+    {
+        if (block.is_terminated())
+            return false;
+
+        u8 type = 0;
+        if (!read(type))
+            return false;
+
+        switch (static_cast<Instruction::Type>(type)) {
+        case Instruction::Type::Load: {
+            auto src = decode_register();
+            return src.has_value() && append<Op::Load>(block, *src);
+        }
+        case Instruction::Type::LoadImmediate: {
+            auto value = decode_value();
+            return value.has_value() && append<Op::LoadImmediate>(block, *value);
+        }
+        case Instruction::Type::Store: {
+            auto dst = decode_register();
+            return dst.has_value() && append<Op::Store>(block, *dst);
+        }
+        case Instruction::Type::ConcatString: {
+            auto lhs = decode_register();
+            return lhs.has_value() && append<Op::ConcatString>(block, *lhs);
+        }
+#define __BYTECODE_BINARY_OP(OpTitleCase, op_snake_case)                \
+    case Instruction::Type::OpTitleCase: {                              \
+        auto lhs = decode_register();                                   \
+        return lhs.has_value() && append<Op::OpTitleCase>(block, *lhs); \
+    }
+            JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_BINARY_OP)
+#undef __BYTECODE_BINARY_OP
+#define __BYTECODE_UNARY_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:                \
+        return append<Op::OpTitleCase>(block);
+            JS_ENUMERATE_COMMON_UNARY_OPS(__BYTECODE_UNARY_OP)
+#undef __BYTECODE_UNARY_OP
+        case Instruction::Type::NewObject:
+            return append<Op::NewObject>(block);
+        case Instruction::Type::Return:
+            return append<Op::Return>(block);
+        case Instruction::Type::Increment:
+            return append<Op::Increment>(block);
+        case Instruction::Type::Decrement:
+            return append<Op::Decrement>(block);
+        case Instruction::Type::Throw:
+            return append<Op::Throw>(block);
+        case Instruction::Type::LeaveUnwindContext:
+            return append<Op::LeaveUnwindContext>(block);
+        case Instruction::Type::NewBigInt: {
+            auto digits = decode_string();
+            return digits.has_value() && append<Op::NewBigInt>(block, Crypto::SignedBigInteger::from_base10(*digits));
+        }
+        case Instruction::Type::NewArray: {
+            auto elements = decode_registers();
+            return elements.has_value() && append_with_extra_register_slots<Op::NewArray>(block, elements->size(), *elements);
+        }
+        case Instruction::Type::NewString: {
+            auto string = decode_string_index();
+            return string.has_value() && append<Op::NewString>(block, *string);
+        }
+        case Instruction::Type::GetVariable: {
+            auto identifier = decode_string_index();
+            return identifier.has_value() && append<Op::GetVariable>(block, *identifier);
+        }
+        case Instruction::Type::SetVariable: {
+            auto identifier = decode_string_index();
+            return identifier.has_value() && append<Op::SetVariable>(block, *identifier);
+        }
+        case Instruction::Type::GetById: {
+            auto property = decode_string_index();
+            return property.has_value() && append<Op::GetById>(block, *property);
+        }
+        case Instruction::Type::PutById: {
+            auto base = decode_register();
+            auto property = decode_string_index();
+            return base.has_value() && property.has_value() && append<Op::PutById>(block, *base, *property);
+        }
+        case Instruction::Type::GetByValue: {
+            auto base = decode_register();
+            return base.has_value() && append<Op::GetByValue>(block, *base);
+        }
+        case Instruction::Type::PutByValue: {
+            auto base = decode_register();
+            auto property = decode_register();
+            return base.has_value() && property.has_value() && append<Op::PutByValue>(block, *base, *property);
+        }
+        case Instruction::Type::Jump:
+        case Instruction::Type::JumpConditional:
+        case Instruction::Type::JumpNullish: {
+            auto true_target = decode_label();
+            auto false_target = decode_label();
+            if (!true_target.has_value() || !false_target.has_value())
+                return false;
+            if (type == static_cast<u8>(Instruction::Type::Jump))
+                return append<Op::Jump>(block, *true_target, *false_target);
+            // NOTE: The conditional jumps assume that both of their targets are there.
+            if (!true_target->has_value() || !false_target->has_value())
+                return false;
+            if (type == static_cast<u8>(Instruction::Type::JumpConditional))
+                return append<Op::JumpConditional>(block, *true_target, *false_target);
+            return append<Op::JumpNullish>(block, *true_target, *false_target);
+        }
+        case Instruction::Type::Call: {
+            u8 call_type = 0;
+            if (!read(call_type) || call_type > static_cast<u8>(Op::Call::CallType::Construct))
+                return false;
+            auto callee = decode_register();
+            auto this_value = decode_register();
+            auto arguments = decode_registers();
+            if (!callee.has_value() || !this_value.has_value() || !arguments.has_value())
+                return false;
+            return append_with_extra_register_slots<Op::Call>(block, arguments->size(), static_cast<Op::Call::CallType>(call_type), *callee, *this_value, *arguments);
+        }
+        case Instruction::Type::NewFunction: {
+            auto* function = decode_function();
+            return function && append<Op::NewFunction>(block, *function);
+        }
+        case Instruction::Type::PushLexicalEnvironment: {
+            u32 count = 0;
+            if (!read(count))
+                return false;
+            HashMap<u32, Variable> variables;
+            for (u32 i = 0; i < count; ++i) {
+                u32 identifier = 0;
+                u8 declaration_kind = 0;
+                if (!read(identifier) || identifier >= m_string_count || !read(declaration_kind) || declaration_kind > static_cast<u8>(DeclarationKind::Const))
+                    return false;
+                auto value = decode_value();
+                if (!value.has_value())
+                    return false;
+                variables.set(identifier, { *value, static_cast<DeclarationKind>(declaration_kind) });
+            }
+            return append<Op::PushLexicalEnvironment>(block, move(variables));
+        }
+        case Instruction::Type::EnterUnwindContext: {
+            auto handler_target = decode_label();
+            auto finalizer_target = decode_label();
+            return handler_target.has_value() && finalizer_target.has_value() && append<Op::EnterUnwindContext>(block, *handler_target, *finalizer_target);
+        }
+        case Instruction::Type::ContinuePendingUnwind: {
+            auto resume_target = decode_label();
+            return resume_target.has_value() && resume_target->has_value() && append<Op::ContinuePendingUnwind>(block, **resume_target);
+        }
+        case Instruction::Type::Yield: {
+            auto continuation = decode_label();
+            if (!continuation.has_value())
+                return false;
+            if (continuation->has_value())
+                return append<Op::Yield>(block, **continuation);
+            return append<Op::Yield>(block, nullptr);
+        }
+        }
+        return false;
+    }
+
+    InputMemoryStream m_stream;
+    StringView m_filename;
+    size_t m_number_of_registers { 0 };
+    size_t m_string_count { 0 };
+    NonnullOwnPtrVector<BasicBlock> const* m_blocks { nullptr };
+    NonnullRefPtrVector<FunctionDeclaration> m_function_declarations;
+};
+
+Optional<ByteBuffer> serialize(Executable const& executable)
+{
+    Encoder encoder(executable);
+    return encoder.encode();
+}
+
+Optional<Executable> deserialize(ReadonlyBytes bytes, StringView filename)
+{
+    Decoder decoder(bytes, filename);
+    return decoder.decode();
+}
+
+}
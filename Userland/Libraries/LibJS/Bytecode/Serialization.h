@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <LibJS/Bytecode/Generator.h>
+
+namespace JS::Bytecode {
+
+// The encoding is only meant to be read back by the same build on the same machine, so it's in native byte order.
+// Executables that refer to parts of the AST that can't be encoded (yet) come back empty.
+Optional<ByteBuffer> serialize(Executable const&);
+
+// NOTE: The filename ends up in the source ranges of the functions, so it has to outlive the executable,
+//       just like the one handed to the parser.
+Optional<Executable> deserialize(ReadonlyBytes, StringView filename);
+
+}
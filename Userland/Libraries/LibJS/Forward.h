@@ -131,6 +131,7 @@ class PromiseReactionJob;
 class PromiseResolveThenableJob;
 class PropertyName;
 class Reference;
+class RegExpCache;
 class ScopeNode;
 class ScopeObject;
 class Shape;
@@ -173,7 +174,12 @@ struct Executable;
 class Generator;
 class Instruction;
 class Interpreter;
+class PassManager;
 class Register;
 }
 
+namespace JIT {
+class NativeExecutable;
+}
+
 }
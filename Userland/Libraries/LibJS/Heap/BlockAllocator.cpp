@@ -37,8 +37,14 @@ BlockAllocator::~BlockAllocator()
     }
 }
 
+size_t BlockAllocator::bytes_in_use() const
+{
+    return m_blocks_in_use * HeapBlock::block_size;
+}
+
 void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 {
+    ++m_blocks_in_use;
     if (!m_blocks.is_empty()) {
         auto* block = m_blocks.take_last();
         ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
@@ -64,6 +70,8 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 void BlockAllocator::deallocate_block(void* block)
 {
     VERIFY(block);
+    VERIFY(m_blocks_in_use > 0);
+    --m_blocks_in_use;
     if (m_blocks.size() >= max_cached_blocks) {
 #ifdef __serenity__
         if (munmap(block, HeapBlock::block_size) < 0) {
@@ -19,10 +19,14 @@ public:
     void* allocate_block(char const* name);
     void deallocate_block(void*);
 
+    // The memory taken up by blocks that have been handed out, not counting the cached ones.
+    size_t bytes_in_use() const;
+
 private:
     static constexpr size_t max_cached_blocks = 64;
 
     Vector<void*, max_cached_blocks> m_blocks;
+    size_t m_blocks_in_use { 0 };
 };
 
 }
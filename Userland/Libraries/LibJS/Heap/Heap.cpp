@@ -9,7 +9,6 @@
 #include <AK/HashTable.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
-#include <LibCore/ElapsedTimer.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
@@ -18,6 +17,7 @@
 #include <LibJS/Runtime/Object.h>
 #include <LibJS/Runtime/WeakSet.h>
 #include <setjmp.h>
+#include <time.h>
 
 namespace JS {
 
@@ -52,38 +52,94 @@ ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size)
     VERIFY_NOT_REACHED();
 }
 
+ALWAYS_INLINE bool Heap::should_collect_before_allocating(size_t cell_size) const
+{
+    if (m_bytes_allocated_since_last_gc + cell_size > m_max_bytes_between_gc)
+        return true;
+    // NOTE: Only a fresh block can push the block memory over its limit, so this is rarely the deciding factor.
+    return m_block_allocator.bytes_in_use() > m_max_block_bytes;
+}
+
 Cell* Heap::allocate_cell(size_t size)
 {
-    if (should_collect_on_every_allocation()) {
-        collect_garbage();
-    } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
-        m_allocations_since_last_gc = 0;
+    auto& allocator = allocator_for_size(size);
+
+    if (should_collect_on_every_allocation() || should_collect_before_allocating(allocator.cell_size()))
         collect_garbage();
-    } else {
-        ++m_allocations_since_last_gc;
-    }
 
-    auto& allocator = allocator_for_size(size);
+    m_bytes_allocated_since_last_gc += allocator.cell_size();
     return allocator.allocate_cell(*this);
 }
 
+void Heap::set_gc_growth_factor(double growth_factor)
+{
+    VERIFY(growth_factor >= 1.0);
+    m_gc_growth_factor = growth_factor;
+    update_gc_thresholds();
+}
+
+void Heap::set_min_bytes_between_gc(size_t bytes)
+{
+    m_min_bytes_between_gc = bytes;
+    update_gc_thresholds();
+}
+
+void Heap::update_gc_thresholds()
+{
+    auto growth = [&](size_t bytes) {
+        return static_cast<size_t>(static_cast<double>(bytes) * (m_gc_growth_factor - 1.0));
+    };
+    m_max_bytes_between_gc = max(m_min_bytes_between_gc, growth(m_statistics.live_cell_bytes));
+    auto block_bytes = m_block_allocator.bytes_in_use();
+    m_max_block_bytes = block_bytes + max(m_min_bytes_between_gc, growth(block_bytes));
+}
+
+static Time now_monotonic()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Time::from_timespec(now);
+}
+
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 {
     VERIFY(!m_collecting_garbage);
     TemporaryChange change(m_collecting_garbage, true);
 
-    Core::ElapsedTimer collection_measurement_timer;
-    collection_measurement_timer.start();
+    if (collection_type == CollectionType::CollectGarbage && m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    auto collection_start_time = now_monotonic();
+    m_statistics.last_marking_time = Time::zero();
     if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
         HashTable<Cell*> roots;
         gather_roots(roots);
         mark_live_cells(roots);
+        m_statistics.last_marking_time = now_monotonic() - collection_start_time;
+    }
+    sweep_dead_cells(print_report);
+
+    auto pause = now_monotonic() - collection_start_time;
+    m_statistics.last_sweeping_time = pause - m_statistics.last_marking_time;
+    m_statistics.last_pause = pause;
+    m_statistics.total_pause += pause;
+    if (pause > m_statistics.longest_pause)
+        m_statistics.longest_pause = pause;
+    ++m_statistics.collections;
+    m_bytes_allocated_since_last_gc = 0;
+    update_gc_thresholds();
+
+    dbgln_if(HEAP_DEBUG, "GC #{} paused for {}us (marking {}us, sweeping {}us), next one after {} bytes ({} bytes of blocks)",
+        m_statistics.collections, pause.to_microseconds(), m_statistics.last_marking_time.to_microseconds(),
+        m_statistics.last_sweeping_time.to_microseconds(), m_max_bytes_between_gc, m_max_block_bytes);
+
+    if (print_report) {
+        dbgln("     Pause time: {} us (marking {} us, sweeping {} us)", pause.to_microseconds(), m_statistics.last_marking_time.to_microseconds(), m_statistics.last_sweeping_time.to_microseconds());
+        dbgln("    Collections: {} (longest pause {} us, total {} us)", m_statistics.collections, m_statistics.longest_pause.to_microseconds(), m_statistics.total_pause.to_microseconds());
+        dbgln("=============================================");
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -156,18 +212,30 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     }
 }
 
+// NOTE: Cells are marked as soon as they're discovered, but their edges are only visited once they come off
+//       the work list. This keeps long chains of objects (linked lists, deep scope chains) from recursing
+//       through visit_edges() as deep as the chain is long.
 class MarkingVisitor final : public Cell::Visitor {
 public:
     MarkingVisitor() { }
 
-    virtual void visit_impl(Cell& cell)
+    virtual void visit_impl(Cell& cell) override
     {
         if (cell.is_marked())
             return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_work_list.append(&cell);
+    }
+
+    void visit_edges_of_all_marked_cells()
+    {
+        while (!m_work_list.is_empty())
+            m_work_list.take_last()->visit_edges(*this);
     }
+
+private:
+    Vector<Cell*> m_work_list;
 };
 
 void Heap::mark_live_cells(const HashTable<Cell*>& roots)
@@ -176,9 +244,10 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+    visitor.visit_edges_of_all_marked_cells();
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::sweep_dead_cells(bool print_report)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
     Vector<HeapBlock*, 32> empty_blocks;
@@ -236,7 +305,8 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         });
     }
 
-    int time_spent = measurement_timer.elapsed();
+    m_statistics.live_cells = live_cells;
+    m_statistics.live_cell_bytes = live_cell_bytes;
 
     if (print_report) {
         size_t live_block_count = 0;
@@ -247,12 +317,10 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
 
         dbgln("Garbage collection report");
         dbgln("=============================================");
-        dbgln("     Time spent: {} ms", time_spent);
         dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
         dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
-        dbgln("=============================================");
     }
 }
 
@@ -9,6 +9,7 @@
 #include <AK/HashTable.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -59,6 +60,28 @@ public:
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    struct Statistics {
+        size_t collections { 0 };
+        Time last_pause;
+        Time last_marking_time;
+        Time last_sweeping_time;
+        Time longest_pause;
+        Time total_pause;
+        size_t live_cells { 0 };
+        size_t live_cell_bytes { 0 };
+    };
+
+    Statistics const& statistics() const { return m_statistics; }
+
+    // How far the heap may grow past what survived the previous collection before the next one kicks in,
+    // e.g. 2.0 lets a heap with 10 MiB of live cells allocate another 10 MiB first.
+    double gc_growth_factor() const { return m_gc_growth_factor; }
+    void set_gc_growth_factor(double);
+
+    // The least amount of allocation between two collections, so that small heaps don't collect constantly.
+    size_t min_bytes_between_gc() const { return m_min_bytes_between_gc; }
+    void set_min_bytes_between_gc(size_t);
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -84,7 +107,7 @@ private:
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
     void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void sweep_dead_cells(bool print_report);
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -97,8 +120,20 @@ private:
         }
     }
 
-    size_t m_max_allocations_between_gc { 10000 };
-    size_t m_allocations_since_last_gc { 0 };
+    bool should_collect_before_allocating(size_t cell_size) const;
+    void update_gc_thresholds();
+
+    // NOTE: The allocation budget grows along with the live heap, so that a big heap isn't rescanned in its
+    //       entirety every few thousand allocations. This keeps the time spent in GC proportional to the amount
+    //       of garbage produced rather than to the size of the heap.
+    double m_gc_growth_factor { 2.0 };
+    size_t m_min_bytes_between_gc { 4 * MiB };
+    size_t m_max_bytes_between_gc { 4 * MiB };
+    size_t m_bytes_allocated_since_last_gc { 0 };
+
+    // NOTE: Cells that keep landing in otherwise empty blocks make the heap's footprint grow faster than its
+    //       cell bytes do, so the block memory is held to the same growth factor separately.
+    size_t m_max_block_bytes { 4 * MiB };
 
     bool m_should_collect_on_every_allocation { false };
 
@@ -117,6 +152,8 @@ private:
     bool m_should_gc_when_deferral_ends { false };
 
     bool m_collecting_garbage { false };
+
+    Statistics m_statistics;
 };
 
 }
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace JS::JIT {
+
+// Just enough of an x86_64 assembler to stitch calls into the runtime together.
+class Assembler {
+public:
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    enum class Reg {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R8 = 8,
+        R9 = 9,
+        R10 = 10,
+        R11 = 11,
+        R12 = 12,
+        R13 = 13,
+        R14 = 14,
+        R15 = 15,
+    };
+
+    class Label {
+    public:
+        bool is_bound() const { return m_offset.has_value(); }
+        size_t offset() const { return m_offset.value(); }
+
+    private:
+        friend class Assembler;
+
+        Optional<size_t> m_offset;
+        // The places that jump here, as offsets of the rel32 operands that still need to be filled in.
+        Vector<size_t, 2> m_jump_sites;
+    };
+
+    size_t size() const { return m_output.size(); }
+
+    void bind(Label& label)
+    {
+        VERIFY(!label.is_bound());
+        label.m_offset = m_output.size();
+        for (auto jump_site : label.m_jump_sites)
+            patch_rel32(jump_site, *label.m_offset);
+        label.m_jump_sites.clear();
+    }
+
+    void push(Reg reg)
+    {
+        if (index_of(reg) >= 8)
+            emit8(0x41);
+        emit8(0x50 | encode(reg));
+    }
+
+    void pop(Reg reg)
+    {
+        if (index_of(reg) >= 8)
+            emit8(0x41);
+        emit8(0x58 | encode(reg));
+    }
+
+    // mov dst, src
+    void mov(Reg dst, Reg src)
+    {
+        emit_rex_w(src, dst);
+        emit8(0x89);
+        emit8(0xc0 | (encode(src) << 3) | encode(dst));
+    }
+
+    // mov dst, imm64
+    void mov(Reg dst, u64 immediate)
+    {
+        emit8(0x48 | (index_of(dst) >= 8 ? 0x01 : 0));
+        emit8(0xb8 | encode(dst));
+        emit64(immediate);
+    }
+
+    // mov eax, imm32 (zero extended into rax)
+    void mov_eax(u32 immediate)
+    {
+        emit8(0xb8);
+        emit32(immediate);
+    }
+
+    // mov [base + displacement], src
+    void store(Reg base, i32 displacement, Reg src)
+    {
+        VERIFY(base != Reg::RSP && base != Reg::R12);
+        emit_rex_w(src, base);
+        emit8(0x89);
+        emit8(0x80 | (encode(src) << 3) | encode(base));
+        emit32(displacement);
+    }
+
+    // movups xmm0, [base + displacement]
+    void load_xmm0(Reg base, i32 displacement)
+    {
+        emit_sse_memory_operand(0x10, base, displacement);
+    }
+
+    // movups [base + displacement], xmm0
+    void store_xmm0(Reg base, i32 displacement)
+    {
+        emit_sse_memory_operand(0x11, base, displacement);
+    }
+
+    void call(Reg reg)
+    {
+        if (index_of(reg) >= 8)
+            emit8(0x41);
+        emit8(0xff);
+        emit8(0xd0 | encode(reg));
+    }
+
+    void jump(Reg reg)
+    {
+        if (index_of(reg) >= 8)
+            emit8(0x41);
+        emit8(0xff);
+        emit8(0xe0 | encode(reg));
+    }
+
+    void jump(Label& label)
+    {
+        emit8(0xe9);
+        emit_rel32_to(label);
+    }
+
+    void jump_if_zero(Label& label)
+    {
+        emit8(0x0f);
+        emit8(0x84);
+        emit_rel32_to(label);
+    }
+
+    void jump_if_not_zero(Label& label)
+    {
+        emit8(0x0f);
+        emit8(0x85);
+        emit_rel32_to(label);
+    }
+
+    // test al, al
+    void test_al()
+    {
+        emit8(0x84);
+        emit8(0xc0);
+    }
+
+    void ret()
+    {
+        emit8(0xc3);
+    }
+
+private:
+    static u8 index_of(Reg reg) { return static_cast<u8>(reg); }
+    static u8 encode(Reg reg) { return index_of(reg) & 7; }
+
+    void emit8(u8 value) { m_output.append(value); }
+
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    void emit_rex_w(Reg reg, Reg rm)
+    {
+        emit8(0x48 | (index_of(reg) >= 8 ? 0x04 : 0) | (index_of(rm) >= 8 ? 0x01 : 0));
+    }
+
+    void emit_sse_memory_operand(u8 opcode, Reg base, i32 displacement)
+    {
+        if (index_of(base) >= 8)
+            emit8(0x41);
+        emit8(0x0f);
+        emit8(opcode);
+        // NOTE: RSP and R12 can only be used as a base through a SIB byte.
+        if (encode(base) == encode(Reg::RSP)) {
+            emit8(0x84);
+            emit8(0x24);
+        } else {
+            emit8(0x80 | encode(base));
+        }
+        emit32(displacement);
+    }
+
+    void emit_rel32_to(Label& label)
+    {
+        auto jump_site = m_output.size();
+        emit32(0);
+        if (label.is_bound())
+            patch_rel32(jump_site, *label.m_offset);
+        else
+            label.m_jump_sites.append(jump_site);
+    }
+
+    void patch_rel32(size_t jump_site, size_t target)
+    {
+        auto relative_offset = static_cast<i32>(static_cast<i64>(target) - static_cast<i64>(jump_site + 4));
+        for (size_t i = 0; i < 4; ++i)
+            m_output[jump_site + i] = (static_cast<u32>(relative_offset) >> (i * 8)) & 0xff;
+    }
+
+    Vector<u8>& m_output;
+};
+
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Platform.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Assembler.h>
+#include <LibJS/JIT/Compiler.h>
+#include <LibJS/Runtime/VM.h>
+
+namespace JS::JIT {
+
+#if ARCH(X86_64)
+
+using Reg = Assembler::Reg;
+
+// Registers that hold the same thing for as long as we're in native code. They're all callee-saved.
+static constexpr auto INTERPRETER = Reg::RBX;
+static constexpr auto REGISTERS = Reg::R12;
+static constexpr auto BAILOUT = Reg::R13;
+
+static_assert(sizeof(Value) == 16);
+static_assert(sizeof(NativeExecutable::Bailout) == 2 * sizeof(FlatPtr));
+
+// Runs an instruction, and returns whether the interpreter needs to take over from here.
+template<typename OpType>
+static bool execute_instruction(Bytecode::Interpreter& interpreter, Bytecode::Instruction const& instruction)
+{
+    static_cast<OpType const&>(instruction).execute(interpreter);
+    return interpreter.vm().exception() || interpreter.has_pending_jump() || interpreter.has_return_value();
+}
+
+static bool accumulator_is_truthy(Bytecode::Interpreter& interpreter)
+{
+    return interpreter.accumulator().to_boolean();
+}
+
+static bool accumulator_is_nullish(Bytecode::Interpreter& interpreter)
+{
+    return interpreter.accumulator().is_nullish();
+}
+
+static i32 register_offset(Bytecode::Register const& reg)
+{
+    return static_cast<i32>(reg.index() * sizeof(Value));
+}
+
+class BlockCompiler {
+public:
+    BlockCompiler(Assembler& assembler, HashMap<Bytecode::BasicBlock const*, Assembler::Label>& block_labels)
+        : m_assembler(assembler)
+        , m_block_labels(block_labels)
+    {
+    }
+
+    void compile(Bytecode::BasicBlock const& block)
+    {
+        m_assembler.bind(label_for(block));
+
+        bool has_terminated = false;
+        for (Bytecode::InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            auto& instruction = *it;
+            switch (instruction.type()) {
+            case Bytecode::Instruction::Type::Load:
+                m_assembler.load_xmm0(REGISTERS, register_offset(static_cast<Bytecode::Op::Load const&>(instruction).src()));
+                m_assembler.store_xmm0(REGISTERS, register_offset(Bytecode::Register::accumulator()));
+                break;
+            case Bytecode::Instruction::Type::Store:
+                m_assembler.load_xmm0(REGISTERS, register_offset(Bytecode::Register::accumulator()));
+                m_assembler.store_xmm0(REGISTERS, register_offset(static_cast<Bytecode::Op::Store const&>(instruction).dst()));
+                break;
+            case Bytecode::Instruction::Type::LoadImmediate:
+                m_assembler.mov(Reg::RAX, bit_cast<FlatPtr>(&static_cast<Bytecode::Op::LoadImmediate const&>(instruction).value()));
+                m_assembler.load_xmm0(Reg::RAX, 0);
+                m_assembler.store_xmm0(REGISTERS, register_offset(Bytecode::Register::accumulator()));
+                break;
+            case Bytecode::Instruction::Type::Jump:
+                compile_jump(static_cast<Bytecode::Op::Jump const&>(instruction));
+                has_terminated = true;
+                break;
+            case Bytecode::Instruction::Type::JumpConditional:
+                compile_conditional_jump(static_cast<Bytecode::Op::Jump const&>(instruction), accumulator_is_truthy);
+                has_terminated = true;
+                break;
+            case Bytecode::Instruction::Type::JumpNullish:
+                compile_conditional_jump(static_cast<Bytecode::Op::Jump const&>(instruction), accumulator_is_nullish);
+                has_terminated = true;
+                break;
+            default:
+                compile_call_to_handler(block, it.offset(), instruction);
+                break;
+            }
+            // NOTE: Like in the interpreter, nothing after a jump ever runs.
+            if (has_terminated)
+                return;
+        }
+
+        // Running off the end of a block without jumping anywhere ends the executable.
+        m_assembler.mov_eax(0);
+        m_assembler.jump(m_exit);
+    }
+
+    void compile_bailouts_and_exit()
+    {
+        for (auto& bailout : m_bailouts) {
+            m_assembler.bind(*bailout.label);
+            m_assembler.mov(Reg::RAX, bit_cast<FlatPtr>(bailout.block));
+            m_assembler.store(BAILOUT, 0, Reg::RAX);
+            m_assembler.mov(Reg::RAX, static_cast<u64>(bailout.offset));
+            m_assembler.store(BAILOUT, sizeof(FlatPtr), Reg::RAX);
+            m_assembler.mov_eax(1);
+            m_assembler.jump(m_exit);
+        }
+
+        m_assembler.bind(m_exit);
+        m_assembler.pop(BAILOUT);
+        m_assembler.pop(REGISTERS);
+        m_assembler.pop(INTERPRETER);
+        m_assembler.ret();
+    }
+
+private:
+    Assembler::Label& label_for(Bytecode::BasicBlock const& block)
+    {
+        auto it = m_block_labels.find(&block);
+        VERIFY(it != m_block_labels.end());
+        return it->value;
+    }
+
+    void compile_jump(Bytecode::Op::Jump const& jump)
+    {
+        VERIFY(jump.true_target().has_value());
+        m_assembler.jump(label_for(jump.true_target()->block()));
+    }
+
+    void compile_conditional_jump(Bytecode::Op::Jump const& jump, bool (*condition)(Bytecode::Interpreter&))
+    {
+        VERIFY(jump.true_target().has_value());
+        VERIFY(jump.false_target().has_value());
+        m_assembler.mov(Reg::RDI, INTERPRETER);
+        m_assembler.mov(Reg::RAX, bit_cast<FlatPtr>(condition));
+        m_assembler.call(Reg::RAX);
+        m_assembler.test_al();
+        m_assembler.jump_if_not_zero(label_for(jump.true_target()->block()));
+        m_assembler.jump(label_for(jump.false_target()->block()));
+    }
+
+    void compile_call_to_handler(Bytecode::BasicBlock const& block, size_t offset, Bytecode::Instruction const& instruction)
+    {
+        bool (*handler)(Bytecode::Interpreter&, Bytecode::Instruction const&) = nullptr;
+        switch (instruction.type()) {
+#define __BYTECODE_OP(op)                                 \
+    case Bytecode::Instruction::Type::op:                 \
+        handler = execute_instruction<Bytecode::Op::op>; \
+        break;
+            ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+        }
+
+        m_assembler.mov(Reg::RDI, INTERPRETER);
+        m_assembler.mov(Reg::RSI, bit_cast<FlatPtr>(&instruction));
+        m_assembler.mov(Reg::RAX, bit_cast<FlatPtr>(handler));
+        m_assembler.call(Reg::RAX);
+        m_assembler.test_al();
+        m_bailouts.append({ make<Assembler::Label>(), &block, offset });
+        m_assembler.jump_if_not_zero(*m_bailouts.last().label);
+    }
+
+    struct PendingBailout {
+        NonnullOwnPtr<Assembler::Label> label;
+        Bytecode::BasicBlock const* block;
+        size_t offset;
+    };
+
+    Assembler& m_assembler;
+    HashMap<Bytecode::BasicBlock const*, Assembler::Label>& m_block_labels;
+    Vector<PendingBailout> m_bailouts;
+    Assembler::Label m_exit;
+};
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const& executable)
+{
+    Vector<u8> code;
+    Assembler assembler(code);
+
+    // The entry trampoline, called as (Interpreter*, Value* registers, u8 const* block_code, Bailout*).
+    // NOTE: Pushing three registers on top of the return address keeps the stack 16-byte aligned for the calls we make.
+    assembler.push(INTERPRETER);
+    assembler.push(REGISTERS);
+    assembler.push(BAILOUT);
+    assembler.mov(INTERPRETER, Reg::RDI);
+    assembler.mov(REGISTERS, Reg::RSI);
+    assembler.mov(BAILOUT, Reg::RCX);
+    assembler.jump(Reg::RDX);
+
+    // NOTE: Labels are kept in the HashMap the whole time, so none of them move once a jump refers to them.
+    HashMap<Bytecode::BasicBlock const*, Assembler::Label> block_labels;
+    for (auto& block : executable.basic_blocks)
+        block_labels.set(&block, {});
+
+    BlockCompiler block_compiler(assembler, block_labels);
+    for (auto& block : executable.basic_blocks)
+        block_compiler.compile(block);
+    block_compiler.compile_bailouts_and_exit();
+
+    HashMap<Bytecode::BasicBlock const*, size_t> block_offsets;
+    for (auto& block : executable.basic_blocks)
+        block_offsets.set(&block, block_labels.find(&block)->value.offset());
+
+    dbgln_if(JS_BYTECODE_DEBUG, "JIT: Compiled {} basic blocks into {} bytes of native code", executable.basic_blocks.size(), code.size());
+    return NativeExecutable::create(code.span(), move(block_offsets));
+}
+
+#else
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const&)
+{
+    return {};
+}
+
+#endif
+
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/JIT/NativeExecutable.h>
+
+namespace JS::JIT {
+
+// A baseline compiler that turns each basic block into a straight run of calls to the handler
+// for each of its instructions. This gets rid of the interpreter's dispatch loop: jumps between
+// blocks become native jumps, and loads and stores between registers are done inline.
+// Anything that throws, jumps somewhere dynamic or returns bails out to the interpreter.
+class Compiler {
+public:
+    // Returns nullptr if there's no native code generator for this architecture, or if the
+    // code can't be made executable, in which case the interpreter runs the bytecode as usual.
+    static OwnPtr<NativeExecutable> compile(Bytecode::Executable const&);
+};
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJS/JIT/NativeExecutable.h>
+#include <string.h>
+#include <sys/mman.h>
+
+namespace JS::JIT {
+
+// The code always starts out with the trampoline the Compiler puts in front of everything else.
+using EntryTrampoline = bool (*)(Bytecode::Interpreter*, Value* registers, u8 const* block_code, NativeExecutable::Bailout*);
+
+OwnPtr<NativeExecutable> NativeExecutable::create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+{
+    auto size = code.size();
+    auto* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        dbgln_if(JS_BYTECODE_DEBUG, "JIT: Couldn't allocate {} bytes for native code", size);
+        return {};
+    }
+    memcpy(memory, code.data(), size);
+    // NOTE: From here on the code can be run, but never written to again.
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) < 0) {
+        dbgln_if(JS_BYTECODE_DEBUG, "JIT: Couldn't make native code executable");
+        munmap(memory, size);
+        return {};
+    }
+    return adopt_own(*new NativeExecutable(static_cast<u8*>(memory), size, move(block_offsets)));
+}
+
+NativeExecutable::NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+    : m_code(code)
+    , m_size(size)
+    , m_block_offsets(move(block_offsets))
+{
+}
+
+NativeExecutable::~NativeExecutable()
+{
+    munmap(m_code, m_size);
+}
+
+Optional<NativeExecutable::Bailout> NativeExecutable::run(Bytecode::Interpreter& interpreter, Value* registers, Bytecode::BasicBlock const& block) const
+{
+    auto it = m_block_offsets.find(&block);
+    VERIFY(it != m_block_offsets.end());
+    Bailout bailout;
+    auto entry = reinterpret_cast<EntryTrampoline>(m_code);
+    if (!entry(&interpreter, registers, m_code + it->value, &bailout))
+        return {};
+    return bailout;
+}
+
+}
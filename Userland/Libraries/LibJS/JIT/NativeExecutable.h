@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <LibJS/Forward.h>
+
+namespace JS::JIT {
+
+// Machine code generated for a Bytecode::Executable, with an entry point for each of its basic blocks.
+class NativeExecutable {
+    AK_MAKE_NONCOPYABLE(NativeExecutable);
+    AK_MAKE_NONMOVABLE(NativeExecutable);
+
+public:
+    // Copies the code into memory of its own, which is never writable and executable at the same time.
+    // Returns nullptr if the system won't let us execute it, in which case the interpreter has to do.
+    static OwnPtr<NativeExecutable> create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+    ~NativeExecutable();
+
+    // Where native execution stopped, because an instruction threw, jumped somewhere dynamic or returned.
+    // The instruction at `offset` in `block` has already run; the interpreter picks up from there.
+    struct Bailout {
+        Bytecode::BasicBlock const* block { nullptr };
+        size_t offset { 0 };
+    };
+
+    // Runs from the start of `block` until either running off the end of a block without a jump, or a bailout.
+    Optional<Bailout> run(Bytecode::Interpreter&, Value* registers, Bytecode::BasicBlock const& block) const;
+
+    size_t size() const { return m_size; }
+
+private:
+    NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+
+    u8* m_code { nullptr };
+    size_t m_size { 0 };
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_offsets;
+};
+
+}
@@ -616,6 +616,8 @@ NonnullRefPtr<Expression> Parser::parse_primary_expression()
 
             set_try_parse_arrow_function_expression_failed_at_position(paren_position, true);
         }
+        // A parenthesized function is very likely to be called right away, so don't make it parse its body twice.
+        m_parser_state.m_next_function_is_parenthesized = match(TokenType::Function);
         auto expression = parse_expression(0);
         consume(TokenType::ParenClose);
         if (is<FunctionExpression>(*expression)) {
@@ -1377,11 +1379,64 @@ NonnullRefPtr<FunctionNodeType> Parser::parse_function_node(u8 parse_options)
         m_parser_state.m_labels_in_scope = move(old_labels_in_scope);
     });
 
+    // NOTE: Syntax errors have to be reported up front, so the body is always parsed. Unless the function
+    //       is likely to be called right away, its AST is thrown away again and only rebuilt once it's needed.
+    //       Functions nested in a body that's going to be thrown away aren't worth the bother.
+    bool is_parenthesized = exchange(m_parser_state.m_next_function_is_parenthesized, false);
+    bool parse_lazily = !is_parenthesized && !m_parser_state.m_in_lazy_function_body;
+    auto body_start = m_parser_state.m_current_token;
+    LazyFunctionBody::Context context {
+        m_parser_state.m_strict_mode,
+        m_parser_state.m_allow_super_property_lookup,
+        m_parser_state.m_allow_super_constructor_call,
+        m_parser_state.m_in_generator_function_context,
+        m_parser_state.m_in_arrow_function_context,
+        m_parser_state.m_in_break_context,
+        m_parser_state.m_in_continue_context,
+    };
+
     bool is_strict = false;
+    NonnullRefPtr<Statement> body = [&] {
+        TemporaryChange lazy_change(m_parser_state.m_in_lazy_function_body, m_parser_state.m_in_lazy_function_body || parse_lazily);
+        return parse_function_body(is_strict);
+    }();
+    if (parse_lazily && !has_errors())
+        body = create_lazy_function_body(body_start, context);
+    return create_ast_node<FunctionNodeType>({ m_parser_state.m_current_token.filename(), rule_start.position(), position() }, name, move(body), move(parameters), function_length, NonnullRefPtrVector<VariableDeclaration>(), is_generator, is_strict);
+}
+
+NonnullRefPtr<BlockStatement> Parser::parse_function_body(bool& is_strict)
+{
     auto body = parse_block_statement(is_strict);
     body->add_variables(m_parser_state.m_var_scopes.last());
     body->add_functions(m_parser_state.m_function_scopes.last());
-    return create_ast_node<FunctionNodeType>({ m_parser_state.m_current_token.filename(), rule_start.position(), position() }, name, move(body), move(parameters), function_length, NonnullRefPtrVector<VariableDeclaration>(), is_generator, is_strict);
+    return body;
+}
+
+NonnullRefPtr<LazyFunctionBody> Parser::create_lazy_function_body(Token const& body_start, LazyFunctionBody::Context const& context)
+{
+    // The body spans from its opening curly brace up to the trivia in front of whatever comes after it.
+    auto source = m_parser_state.m_lexer.source();
+    auto start_offset = body_start.value().characters_without_null_termination() - source.characters_without_null_termination();
+    auto end_offset = m_parser_state.m_current_token.trivia().characters_without_null_termination() - source.characters_without_null_termination();
+    Position start { body_start.line_number(), body_start.line_column() };
+    return create_ast_node<LazyFunctionBody>({ m_parser_state.m_current_token.filename(), start, position() }, source.substring_view(start_offset, end_offset - start_offset), context);
+}
+
+NonnullRefPtr<BlockStatement> Parser::parse_lazy_function_body(LazyFunctionBody::Context const& context)
+{
+    ScopePusher scope(*this, ScopePusher::Var | ScopePusher::Function);
+    m_parser_state.m_strict_mode = context.strict_mode;
+    m_parser_state.m_allow_super_property_lookup = context.allow_super_property_lookup;
+    m_parser_state.m_allow_super_constructor_call = context.allow_super_constructor_call;
+    m_parser_state.m_in_function_context = true;
+    m_parser_state.m_in_generator_function_context = context.in_generator_function_context;
+    m_parser_state.m_in_arrow_function_context = context.in_arrow_function_context;
+    m_parser_state.m_in_break_context = context.in_break_context;
+    m_parser_state.m_in_continue_context = context.in_continue_context;
+
+    bool is_strict = false;
+    return parse_function_body(is_strict);
 }
 
 Vector<FunctionNode::Parameter> Parser::parse_formal_parameters(int& function_length, u8 parse_options)
@@ -40,6 +40,7 @@ public:
 
     template<typename FunctionNodeType>
     NonnullRefPtr<FunctionNodeType> parse_function_node(u8 parse_options = FunctionNodeParseOptions::CheckForFunctionAndName);
+    NonnullRefPtr<BlockStatement> parse_lazy_function_body(LazyFunctionBody::Context const&);
     Vector<FunctionNode::Parameter> parse_formal_parameters(int& function_length, u8 parse_options = 0);
     RefPtr<BindingPattern> parse_binding_pattern();
 
@@ -153,6 +154,8 @@ private:
     Token consume(TokenType type);
     Token consume_and_validate_numeric_literal();
     void consume_or_insert_semicolon();
+    NonnullRefPtr<BlockStatement> parse_function_body(bool& is_strict);
+    NonnullRefPtr<LazyFunctionBody> create_lazy_function_body(Token const& body_start, LazyFunctionBody::Context const&);
     void save_state();
     void load_state();
     void discard_saved_state();
@@ -206,6 +209,8 @@ private:
         bool m_in_break_context { false };
         bool m_in_continue_context { false };
         bool m_string_legacy_octal_escape_sequence_in_scope { false };
+        bool m_in_lazy_function_body { false };
+        bool m_next_function_is_parenthesized { false };
 
         explicit ParserState(Lexer);
     };
@@ -8,6 +8,7 @@
 
 #include <AK/Function.h>
 #include <AK/HashTable.h>
+#include <AK/MergeSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/Runtime/Array.h>
@@ -88,6 +89,18 @@ static Function* callback_from_args(GlobalObject& global_object, const String& n
     return &callback.as_function();
 }
 
+// Reads an element straight out of a packed array's storage. This skips the generic property lookup, which is fine
+// as long as the element is there: it's then an own data property that can't be a hole or an accessor.
+static Optional<Value> packed_array_element(Object const& object, size_t index)
+{
+    if (!object.is_array())
+        return {};
+    auto* storage = object.indexed_properties().packed_storage();
+    if (!storage || index >= storage->array_like_size())
+        return {};
+    return storage->elements()[index];
+}
+
 static void for_each_item(VM& vm, GlobalObject& global_object, const String& name, AK::Function<IterationDecision(size_t index, Value value, Value callback_result)> callback, bool skip_empty = true)
 {
     auto* this_object = vm.this_value(global_object).to_object(global_object);
@@ -105,9 +118,15 @@ static void for_each_item(VM& vm, GlobalObject& global_object, const String& nam
     auto this_value = vm.argument(1);
 
     for (size_t i = 0; i < initial_length; ++i) {
-        auto value = this_object->get(i);
-        if (vm.exception())
-            return;
+        // NOTE: The callback may do anything to the array, so whether it's still packed is checked again every time.
+        Value value;
+        if (auto element = packed_array_element(*this_object, i); element.has_value()) {
+            value = *element;
+        } else {
+            value = this_object->get(i);
+            if (vm.exception())
+                return;
+        }
         if (value.is_empty()) {
             if (skip_empty)
                 continue;
@@ -150,15 +169,24 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::map)
     auto initial_length = length_of_array_like(global_object, *this_object);
     if (vm.exception())
         return {};
-    auto* new_array = Array::create(global_object, initial_length);
-    if (vm.exception())
+    if (initial_length > NumericLimits<u32>::max()) {
+        vm.throw_exception<RangeError>(global_object, ErrorType::InvalidLength, "array");
         return {};
+    }
+    // NOTE: The new array starts out empty and only gets its full length at the end, so that it gets filled in
+    //       front to back and stays packed, rather than starting out as `initial_length` holes.
+    //       Nothing else can see it in the meantime, so the elements can go right into its storage.
+    auto* new_array = Array::create(global_object);
     for_each_item(vm, global_object, "map", [&](auto index, auto, auto callback_result) {
         if (vm.exception())
             return IterationDecision::Break;
-        new_array->define_property(index, callback_result);
+        new_array->indexed_properties().put(new_array, index, callback_result);
         return IterationDecision::Continue;
     });
+    if (vm.exception())
+        return {};
+    if (new_array->indexed_properties().array_like_size() < initial_length)
+        new_array->indexed_properties().set_array_like_size(initial_length);
     return Value(new_array);
 }
 
@@ -437,6 +465,29 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
             from_index = max(length + from_index, 0);
     }
     auto search_element = vm.argument(0);
+
+    // NOTE: Nothing below can run any code, so a packed array stays exactly as it is for the whole search.
+    auto* packed_storage = this_object->is_array() ? this_object->indexed_properties().packed_storage() : nullptr;
+    if (packed_storage && packed_storage->array_like_size() >= static_cast<size_t>(length)) {
+        auto& elements = packed_storage->elements();
+        auto element_kind = packed_storage->element_kind();
+        if (element_kind == SimpleIndexedPropertyStorage::ElementKind::PackedInt32 || element_kind == SimpleIndexedPropertyStorage::ElementKind::PackedDouble) {
+            if (!search_element.is_number())
+                return Value(-1);
+            auto search_number = search_element.as_double();
+            for (i32 i = from_index; i < length; ++i) {
+                if (elements[i].as_double() == search_number)
+                    return Value(i);
+            }
+            return Value(-1);
+        }
+        for (i32 i = from_index; i < length; ++i) {
+            if (strict_eq(elements[i], search_element))
+                return Value(i);
+        }
+        return Value(-1);
+    }
+
     for (i32 i = from_index; i < length; ++i) {
         auto element = this_object->get(i);
         if (vm.exception())
@@ -577,111 +628,51 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::reverse)
     return array;
 }
 
-static void array_merge_sort(VM& vm, GlobalObject& global_object, Function* compare_func, MarkedValueList& arr_to_sort)
+// Returns a negative number if x should come before y, a positive one if y should come before x, and 0 if they're equal.
+static double sort_compare(VM& vm, GlobalObject& global_object, Function* compare_func, Value x, Value y)
 {
-    // FIXME: it would probably be better to switch to insertion sort for small arrays for
-    // better performance
-    if (arr_to_sort.size() <= 1)
-        return;
-
-    MarkedValueList left(vm.heap());
-    MarkedValueList right(vm.heap());
-
-    left.ensure_capacity(arr_to_sort.size() / 2);
-    right.ensure_capacity(arr_to_sort.size() / 2 + (arr_to_sort.size() & 1));
-
-    for (size_t i = 0; i < arr_to_sort.size(); ++i) {
-        if (i < arr_to_sort.size() / 2) {
-            left.append(arr_to_sort[i]);
-        } else {
-            right.append(arr_to_sort[i]);
-        }
+    if (x.is_undefined() && y.is_undefined())
+        return 0;
+    if (x.is_undefined())
+        return 1;
+    if (y.is_undefined())
+        return -1;
+
+    if (compare_func) {
+        auto call_result = vm.call(*compare_func, js_undefined(), x, y);
+        if (vm.exception())
+            return 0;
+        if (call_result.is_nan())
+            return 0;
+        return call_result.to_double(global_object);
     }
 
-    array_merge_sort(vm, global_object, compare_func, left);
+    // FIXME: It would probably be much better to be smarter about this and implement
+    // the Abstract Relational Comparison in line once iterating over code points, rather
+    // than calling it twice after creating two primitive strings.
+
+    auto x_string = x.to_primitive_string(global_object);
     if (vm.exception())
-        return;
-    array_merge_sort(vm, global_object, compare_func, right);
+        return 0;
+    auto y_string = y.to_primitive_string(global_object);
     if (vm.exception())
-        return;
-
-    arr_to_sort.clear();
-
-    size_t left_index = 0, right_index = 0;
-
-    while (left_index < left.size() && right_index < right.size()) {
-        auto x = left[left_index];
-        auto y = right[right_index];
-
-        double comparison_result;
-
-        if (x.is_undefined() && y.is_undefined()) {
-            comparison_result = 0;
-        } else if (x.is_undefined()) {
-            comparison_result = 1;
-        } else if (y.is_undefined()) {
-            comparison_result = -1;
-        } else if (compare_func) {
-            auto call_result = vm.call(*compare_func, js_undefined(), left[left_index], right[right_index]);
-            if (vm.exception())
-                return;
-
-            if (call_result.is_nan()) {
-                comparison_result = 0;
-            } else {
-                comparison_result = call_result.to_double(global_object);
-                if (vm.exception())
-                    return;
-            }
-        } else {
-            // FIXME: It would probably be much better to be smarter about this and implement
-            // the Abstract Relational Comparison in line once iterating over code points, rather
-            // than calling it twice after creating two primitive strings.
-
-            auto x_string = x.to_primitive_string(global_object);
-            if (vm.exception())
-                return;
-            auto y_string = y.to_primitive_string(global_object);
-            if (vm.exception())
-                return;
-
-            auto x_string_value = Value(x_string);
-            auto y_string_value = Value(y_string);
-
-            // Because they are called with primitive strings, these abstract_relation calls
-            // should never result in a VM exception.
-            auto x_lt_y_relation = abstract_relation(global_object, true, x_string_value, y_string_value);
-            VERIFY(x_lt_y_relation != TriState::Unknown);
-            auto y_lt_x_relation = abstract_relation(global_object, true, y_string_value, x_string_value);
-            VERIFY(y_lt_x_relation != TriState::Unknown);
-
-            if (x_lt_y_relation == TriState::True) {
-                comparison_result = -1;
-            } else if (y_lt_x_relation == TriState::True) {
-                comparison_result = 1;
-            } else {
-                comparison_result = 0;
-            }
-        }
-
-        if (comparison_result <= 0) {
-            arr_to_sort.append(left[left_index]);
-            left_index++;
-        } else {
-            arr_to_sort.append(right[right_index]);
-            right_index++;
-        }
-    }
-
-    while (left_index < left.size()) {
-        arr_to_sort.append(left[left_index]);
-        left_index++;
-    }
-
-    while (right_index < right.size()) {
-        arr_to_sort.append(right[right_index]);
-        right_index++;
-    }
+        return 0;
+
+    auto x_string_value = Value(x_string);
+    auto y_string_value = Value(y_string);
+
+    // Because they are called with primitive strings, these abstract_relation calls
+    // should never result in a VM exception.
+    auto x_lt_y_relation = abstract_relation(global_object, true, x_string_value, y_string_value);
+    VERIFY(x_lt_y_relation != TriState::Unknown);
+    auto y_lt_x_relation = abstract_relation(global_object, true, y_string_value, x_string_value);
+    VERIFY(y_lt_x_relation != TriState::Unknown);
+
+    if (x_lt_y_relation == TriState::True)
+        return -1;
+    if (y_lt_x_relation == TriState::True)
+        return 1;
+    return 0;
 }
 
 JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
@@ -702,23 +693,59 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
 
     MarkedValueList values_to_sort(vm.heap());
 
-    for (size_t i = 0; i < original_length; ++i) {
-        auto element_val = array->get(i);
-        if (vm.exception())
-            return {};
+    // NOTE: Reading from a packed array can't run any code, so its elements can be copied out all at once.
+    auto* packed_storage = array->is_array() ? array->indexed_properties().packed_storage() : nullptr;
+    bool has_only_numbers = false;
+    if (packed_storage && packed_storage->array_like_size() >= original_length) {
+        auto element_kind = packed_storage->element_kind();
+        has_only_numbers = element_kind == SimpleIndexedPropertyStorage::ElementKind::PackedInt32 || element_kind == SimpleIndexedPropertyStorage::ElementKind::PackedDouble;
+        values_to_sort.ensure_capacity(original_length);
+        for (size_t i = 0; i < original_length; ++i)
+            values_to_sort.unchecked_append(packed_storage->elements()[i]);
+    } else {
+        for (size_t i = 0; i < original_length; ++i) {
+            auto element_val = array->get(i);
+            if (vm.exception())
+                return {};
 
-        if (!element_val.is_empty())
-            values_to_sort.append(element_val);
+            if (!element_val.is_empty())
+                values_to_sort.append(element_val);
+        }
     }
 
-    // Perform sorting by merge sort. This isn't as efficient compared to quick sort, but
-    // quicksort can't be used in all cases because the spec requires Array.prototype.sort()
-    // to be stable. FIXME: when initially scanning through the array, maintain a flag
-    // for if an unstable sort would be indistinguishable from a stable sort (such as just
-    // just strings or numbers), and in that case use quick sort instead for better performance.
-    array_merge_sort(vm, global_object, callback.is_undefined() ? nullptr : &callback.as_function(), values_to_sort);
-    if (vm.exception())
-        return {};
+    // The spec requires Array.prototype.sort() to be stable, so this has to be a merge sort.
+    // The scratch space is a MarkedValueList too, so the values in it survive a GC during the compare function.
+    // merge_sort() passes the later element first, so the compare function gets its arguments in array order.
+    // Once the compare function has thrown, we just let the sort run to the end without calling it again.
+    auto* compare_func = callback.is_undefined() ? nullptr : &callback.as_function();
+    if (!compare_func && has_only_numbers) {
+        // NOTE: The default order compares the elements as strings, and turning a number into a string has no side
+        //       effects. So each number only needs to be turned into a string once, rather than on every comparison.
+        //       Numbers aren't cells, so none of this needs to be marked.
+        struct NumberAndString {
+            Value number;
+            String string;
+        };
+        Vector<NumberAndString> numbers_to_sort;
+        numbers_to_sort.ensure_capacity(values_to_sort.size());
+        for (auto& value : values_to_sort)
+            numbers_to_sort.unchecked_append({ value, value.to_string_without_side_effects() });
+        Vector<NumberAndString> scratch_space;
+        merge_sort(numbers_to_sort, scratch_space, [](auto& a, auto& b) {
+            return a.string < b.string;
+        });
+        for (size_t i = 0; i < numbers_to_sort.size(); ++i)
+            values_to_sort[i] = numbers_to_sort[i].number;
+    } else {
+        MarkedValueList scratch_space(vm.heap());
+        merge_sort(values_to_sort, scratch_space, [&](auto& later, auto& earlier) {
+            if (vm.exception())
+                return false;
+            return sort_compare(vm, global_object, compare_func, earlier, later) > 0;
+        });
+        if (vm.exception())
+            return {};
+    }
 
     for (size_t i = 0; i < values_to_sort.size(); ++i) {
         array->put(i, values_to_sort[i]);
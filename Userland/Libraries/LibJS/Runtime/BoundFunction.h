@@ -23,6 +23,7 @@ public:
     virtual Value construct(Function& new_target) override;
 
     virtual LexicalEnvironment* create_environment() override;
+    virtual ScopeObject* outer_scope() override { return m_target_function->outer_scope(); }
 
     virtual void visit_edges(Visitor&) override;
 
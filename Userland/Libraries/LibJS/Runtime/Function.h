@@ -28,6 +28,9 @@ public:
     virtual const FlyString& name() const = 0;
     virtual LexicalEnvironment* create_environment() = 0;
 
+    // The scope a call runs in when create_environment() decides the function doesn't need an environment of its own.
+    virtual ScopeObject* outer_scope() { return nullptr; }
+
     BoundFunction* bind(Value bound_this_value, Vector<Value> arguments);
 
     Value bound_this() const { return m_bound_this; }
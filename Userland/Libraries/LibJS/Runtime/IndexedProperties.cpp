@@ -13,10 +13,29 @@ namespace JS {
 constexpr const size_t SPARSE_ARRAY_HOLE_THRESHOLD = 200;
 constexpr const size_t LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD = 4 * MiB;
 
+static SimpleIndexedPropertyStorage::ElementKind element_kind_for(Value value)
+{
+    using ElementKind = SimpleIndexedPropertyStorage::ElementKind;
+    if (value.type() == Value::Type::Int32)
+        return ElementKind::PackedInt32;
+    if (value.is_number())
+        return ElementKind::PackedDouble;
+    if (value.is_empty() || value.is_accessor() || value.is_native_property())
+        return ElementKind::Holey;
+    return ElementKind::Packed;
+}
+
 SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initial_values)
     : m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
 {
+    for (auto& value : m_packed_elements)
+        did_store(value);
+}
+
+void SimpleIndexedPropertyStorage::did_store(Value value)
+{
+    m_element_kind = max(m_element_kind, element_kind_for(value));
 }
 
 bool SimpleIndexedPropertyStorage::has_index(u32 index) const
@@ -44,16 +63,21 @@ void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttribute
     VERIFY(attributes == default_attributes);
 
     if (index >= m_array_size) {
+        if (index > m_array_size)
+            m_element_kind = ElementKind::Holey;
         m_array_size = index + 1;
         grow_storage_if_needed();
     }
     m_packed_elements[index] = value;
+    did_store(value);
 }
 
 void SimpleIndexedPropertyStorage::remove(u32 index)
 {
-    if (index < m_array_size)
+    if (index < m_array_size) {
         m_packed_elements[index] = {};
+        m_element_kind = ElementKind::Holey;
+    }
 }
 
 void SimpleIndexedPropertyStorage::insert(u32 index, Value value, PropertyAttributes attributes)
@@ -61,6 +85,7 @@ void SimpleIndexedPropertyStorage::insert(u32 index, Value value, PropertyAttrib
     VERIFY(attributes == default_attributes);
     m_array_size++;
     m_packed_elements.insert(index, value);
+    did_store(value);
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_first()
@@ -79,6 +104,8 @@ ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 
 void SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
+    if (new_size > m_array_size)
+        m_element_kind = ElementKind::Holey;
     m_array_size = new_size;
     m_packed_elements.resize(new_size);
 }
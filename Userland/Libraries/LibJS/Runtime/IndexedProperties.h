@@ -43,6 +43,19 @@ public:
 
 class SimpleIndexedPropertyStorage final : public IndexedPropertyStorage {
 public:
+    // What's known about every element below array_like_size(). Kinds only ever move towards Holey, as finding out
+    // that an array has gone back to being packed would take a scan over all of its elements.
+    enum class ElementKind : u8 {
+        // No holes, and every element is an Int32.
+        PackedInt32,
+        // No holes, and every element is a number.
+        PackedDouble,
+        // No holes, and no accessors.
+        Packed,
+        // Anything goes.
+        Holey,
+    };
+
     SimpleIndexedPropertyStorage() = default;
     explicit SimpleIndexedPropertyStorage(Vector<Value>&& initial_values);
 
@@ -62,13 +75,18 @@ public:
     virtual bool is_simple_storage() const override { return true; }
     const Vector<Value>& elements() const { return m_packed_elements; }
 
+    ElementKind element_kind() const { return m_element_kind; }
+    bool is_packed() const { return m_element_kind != ElementKind::Holey; }
+
 private:
     friend GenericIndexedPropertyStorage;
 
     void grow_storage_if_needed();
+    void did_store(Value);
 
     size_t m_array_size { 0 };
     Vector<Value> m_packed_elements;
+    ElementKind m_element_kind { ElementKind::PackedInt32 };
 };
 
 class GenericIndexedPropertyStorage final : public IndexedPropertyStorage {
@@ -144,6 +162,16 @@ public:
 
     Vector<u32> indices() const;
 
+    // Returns the storage if every element below array_like_size() is a plain value, i.e. if reading one of them
+    // can't run any code or end up looking at the prototype chain.
+    const SimpleIndexedPropertyStorage* packed_storage() const
+    {
+        if (!m_storage->is_simple_storage())
+            return nullptr;
+        auto& storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
+        return storage.is_packed() ? &storage : nullptr;
+    }
+
     template<typename Callback>
     void for_each_value(Callback callback)
     {
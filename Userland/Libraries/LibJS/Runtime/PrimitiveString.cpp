@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/StringBuilder.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/VM.h>
 
@@ -14,10 +15,50 @@ PrimitiveString::PrimitiveString(String string)
 {
 }
 
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_lhs(&lhs)
+    , m_rhs(&rhs)
+    , m_length(lhs.length() + rhs.length())
+    , m_is_rope(true)
+{
+}
+
 PrimitiveString::~PrimitiveString()
 {
 }
 
+void PrimitiveString::visit_edges(Cell::Visitor& visitor)
+{
+    Cell::visit_edges(visitor);
+    if (m_is_rope) {
+        visitor.visit(m_lhs);
+        visitor.visit(m_rhs);
+    }
+}
+
+void PrimitiveString::resolve_rope() const
+{
+    // NOTE: Strings built up with `s += x` are very deep ropes, so this walks them with a stack of its own instead of recursing.
+    StringBuilder builder(m_length);
+    Vector<PrimitiveString const*> pieces;
+    pieces.append(m_rhs);
+    pieces.append(m_lhs);
+    while (!pieces.is_empty()) {
+        auto* piece = pieces.take_last();
+        if (piece->m_is_rope) {
+            pieces.append(piece->m_rhs);
+            pieces.append(piece->m_lhs);
+            continue;
+        }
+        builder.append(piece->m_string);
+    }
+
+    m_string = builder.to_string();
+    m_is_rope = false;
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+}
+
 PrimitiveString* js_string(Heap& heap, String string)
 {
     if (string.is_empty())
@@ -34,4 +75,24 @@ PrimitiveString* js_string(VM& vm, String string)
     return js_string(vm.heap(), move(string));
 }
 
+// Below this length, copying both halves right away is cheaper than keeping a rope around.
+static constexpr size_t minimum_rope_length = 32;
+
+PrimitiveString* js_rope_string(VM& vm, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    if (lhs.length() == 0)
+        return &rhs;
+    if (rhs.length() == 0)
+        return &lhs;
+
+    if (lhs.length() + rhs.length() < minimum_rope_length) {
+        StringBuilder builder(lhs.length() + rhs.length());
+        builder.append(lhs.string());
+        builder.append(rhs.string());
+        return js_string(vm, builder.to_string());
+    }
+
+    return vm.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
@@ -483,4 +483,10 @@ LexicalEnvironment* ProxyObject::create_environment()
     return static_cast<Function&>(m_target).create_environment();
 }
 
+ScopeObject* ProxyObject::outer_scope()
+{
+    VERIFY(is_function());
+    return static_cast<Function&>(m_target).outer_scope();
+}
+
 }
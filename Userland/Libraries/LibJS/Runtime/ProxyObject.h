@@ -23,6 +23,7 @@ public:
     virtual Value construct(Function& new_target) override;
     virtual const FlyString& name() const override;
     virtual LexicalEnvironment* create_environment() override;
+    virtual ScopeObject* outer_scope() override;
 
     const Object& target() const { return m_target; }
     const Object& handler() const { return m_handler; }
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Runtime/RegExpCache.h>
+
+namespace JS {
+
+NonnullRefPtr<CompiledRegExp> RegExpCache::get(const String& pattern, regex::ECMAScriptOptions options)
+{
+    RegExpCacheKey key { pattern, options };
+    ++m_uses;
+
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        it->value.last_used = m_uses;
+        return it->value.compiled_regexp;
+    }
+
+    if (m_entries.size() >= max_entries) {
+        // Evicting only happens when compiling anyway, which is much slower than looking through the entries.
+        auto least_recently_used = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value.last_used < least_recently_used->value.last_used)
+                least_recently_used = it;
+        }
+        m_entries.remove(least_recently_used);
+    }
+
+    auto compiled_regexp = adopt_ref(*new CompiledRegExp(pattern, options));
+    m_entries.set(move(key), { compiled_regexp, m_uses });
+    return compiled_regexp;
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/String.h>
+#include <LibRegex/Regex.h>
+
+namespace JS {
+
+struct RegExpCacheKey {
+    String pattern;
+    regex::ECMAScriptOptions options;
+
+    bool operator==(const RegExpCacheKey& other) const
+    {
+        return pattern == other.pattern && options.value() == other.options.value();
+    }
+};
+
+}
+
+namespace AK {
+template<>
+struct Traits<JS::RegExpCacheKey> : public GenericTraits<JS::RegExpCacheKey> {
+    static unsigned hash(const JS::RegExpCacheKey& key) { return pair_int_hash(key.pattern.hash(), (u32)key.options.value()); }
+};
+}
+
+namespace JS {
+
+// A compiled pattern, shared by all RegExp objects with the same pattern and flags.
+// NOTE: Matching never changes it, the objects keep their own lastIndex and pass it to match().
+class CompiledRegExp : public RefCounted<CompiledRegExp> {
+public:
+    CompiledRegExp(const String& pattern, regex::ECMAScriptOptions options)
+        : m_regex(pattern, options)
+    {
+    }
+
+    const Regex<ECMA262>& regex() const { return m_regex; }
+
+private:
+    Regex<ECMA262> m_regex;
+};
+
+// Keeps the most recently used patterns compiled, so that evaluating the same RegExp literal
+// (or calling the RegExp constructor with the same arguments) over and over only parses it once.
+class RegExpCache {
+public:
+    NonnullRefPtr<CompiledRegExp> get(const String& pattern, regex::ECMAScriptOptions);
+
+private:
+    static constexpr size_t max_entries = 64;
+
+    struct Entry {
+        NonnullRefPtr<CompiledRegExp> compiled_regexp;
+        u64 last_used { 0 };
+    };
+
+    HashMap<RegExpCacheKey, Entry> m_entries;
+    u64 m_uses { 0 };
+};
+
+}
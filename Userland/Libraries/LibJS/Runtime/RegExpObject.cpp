@@ -93,10 +93,10 @@ RegExpObject::RegExpObject(String pattern, String flags, Object& prototype)
     , m_pattern(pattern)
     , m_flags(flags)
     , m_active_flags(options_from(global_object(), m_flags))
-    , m_regex(pattern, m_active_flags.effective_flags)
+    , m_compiled_regexp(vm().regexp_cache().get(pattern, m_active_flags.effective_flags))
 {
-    if (m_regex.parser_result.error != regex::Error::NoError) {
-        vm().throw_exception<SyntaxError>(global_object(), ErrorType::RegExpCompileError, m_regex.error_string());
+    if (regex().parser_result.error != regex::Error::NoError) {
+        vm().throw_exception<SyntaxError>(global_object(), ErrorType::RegExpCompileError, regex().error_string());
     }
 }
 
@@ -130,7 +130,7 @@ JS_DEFINE_NATIVE_GETTER(RegExpObject::last_index)
     if (!regexp_object)
         return {};
 
-    return Value((unsigned)regexp_object->regex().start_offset);
+    return Value((unsigned)regexp_object->start_offset());
 }
 
 JS_DEFINE_NATIVE_SETTER(RegExpObject::set_last_index)
@@ -146,7 +146,7 @@ JS_DEFINE_NATIVE_SETTER(RegExpObject::set_last_index)
     if (index < 0)
         index = 0;
 
-    regexp_object->regex().start_offset = index;
+    regexp_object->set_start_offset(index);
 }
 
 RegExpObject* regexp_create(GlobalObject& global_object, Value pattern, Value flags)
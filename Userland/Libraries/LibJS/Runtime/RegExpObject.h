@@ -8,6 +8,7 @@
 
 #include <LibJS/AST.h>
 #include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/RegExpCache.h>
 #include <LibRegex/Regex.h>
 
 struct Flags {
@@ -32,8 +33,13 @@ public:
     const String& pattern() const { return m_pattern; }
     const String& flags() const { return m_flags; }
     const regex::RegexOptions<ECMAScriptFlags>& declared_options() { return m_active_flags.declared_flags; }
-    const Regex<ECMA262>& regex() { return m_regex; }
-    const Regex<ECMA262>& regex() const { return m_regex; }
+    const Regex<ECMA262>& regex() const { return m_compiled_regexp->regex(); }
+
+    // The compiled pattern is shared with other RegExp objects, so this is where the matching continues from.
+    size_t start_offset() const { return m_start_offset; }
+    void set_start_offset(size_t start_offset) { m_start_offset = start_offset; }
+
+    RegexResult match(const StringView& subject) { return regex().match(subject, m_start_offset); }
 
 private:
     JS_DECLARE_NATIVE_GETTER(last_index);
@@ -42,7 +48,8 @@ private:
     String m_pattern;
     String m_flags;
     Flags m_active_flags;
-    Regex<ECMA262> m_regex;
+    NonnullRefPtr<CompiledRegExp> m_compiled_regexp;
+    size_t m_start_offset { 0 };
 };
 
 }
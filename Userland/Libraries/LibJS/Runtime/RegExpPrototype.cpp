@@ -131,12 +131,12 @@ JS_DEFINE_NATIVE_GETTER(RegExpPrototype::source)
     return js_string(vm, escape_regexp_pattern(*regexp_object));
 }
 
-RegexResult RegExpPrototype::do_match(const Regex<ECMA262>& re, const StringView& subject)
+RegexResult RegExpPrototype::do_match(RegExpObject& regexp_object, const StringView& subject)
 {
-    auto result = re.match(subject);
+    auto result = regexp_object.match(subject);
     // The 'lastIndex' property is reset on failing tests (if 'global')
-    if (!result.success && re.options().has_flag_set(ECMAScriptFlags::Global))
-        re.start_offset = 0;
+    if (!result.success && regexp_object.regex().options().has_flag_set(ECMAScriptFlags::Global))
+        regexp_object.set_start_offset(0);
 
     return result;
 }
@@ -157,9 +157,9 @@ JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::exec)
 
     // RegExps without "global" and "sticky" always start at offset 0.
     if (!regexp_object->regex().options().has_flag_set((ECMAScriptFlags)regex::AllFlags::Internal_Stateful))
-        regexp_object->regex().start_offset = 0;
+        regexp_object->set_start_offset(0);
 
-    auto result = do_match(regexp_object->regex(), str_to_match);
+    auto result = do_match(*regexp_object, str_to_match);
     if (!result.success)
         return js_null();
 
@@ -208,9 +208,9 @@ JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::test)
 
     // RegExps without "global" and "sticky" always start at offset 0.
     if (!regexp_object->regex().options().has_flag_set((ECMAScriptFlags)regex::AllFlags::Internal_Stateful))
-        regexp_object->regex().start_offset = 0;
+        regexp_object->set_start_offset(0);
 
-    auto result = do_match(regexp_object->regex(), str);
+    auto result = do_match(*regexp_object, str);
     return Value(result.success);
 }
 
@@ -281,7 +281,7 @@ JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::symbol_replace)
 
     bool global = global_value.to_boolean();
     if (global)
-        rx->regex().start_offset = 0;
+        rx->set_start_offset(0);
 
     // FIXME: Implement and use RegExpExec - https://tc39.es/ecma262/#sec-regexpexec
     auto* exec = get_method(global_object, rx, vm.names.exec);
@@ -315,7 +315,7 @@ JS_DEFINE_NATIVE_FUNCTION(RegExpPrototype::symbol_replace)
         if (match_str.is_empty()) {
             // FIXME: Implement AdvanceStringIndex to take Unicode code points into account - https://tc39.es/ecma262/#sec-advancestringindex
             //        Once implemented, step (8a) of the @@replace algorithm must also be implemented.
-            rx->regex().start_offset += 1;
+            rx->set_start_offset(rx->start_offset() + 1);
         }
     }
 
@@ -19,7 +19,7 @@ public:
     virtual ~RegExpPrototype() override;
 
 private:
-    static RegexResult do_match(const Regex<ECMA262>&, const StringView&);
+    static RegexResult do_match(RegExpObject&, const StringView&);
 
     JS_DECLARE_NATIVE_GETTER(flags);
     JS_DECLARE_NATIVE_GETTER(source);
@@ -10,7 +10,9 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PassManager.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GeneratorObject.h>
@@ -74,8 +76,38 @@ void ScriptFunction::visit_edges(Visitor& visitor)
     visitor.visit(m_parent_scope);
 }
 
+const Statement& ScriptFunction::body() const
+{
+    if (is<LazyFunctionBody>(*m_body))
+        return static_cast<const LazyFunctionBody&>(*m_body).parsed_body();
+    return m_body;
+}
+
+bool ScriptFunction::needs_own_environment() const
+{
+    if (m_needs_own_environment.has_value())
+        return m_needs_own_environment.value();
+
+    // An arrow function gets |this|, new.target and friends from its surroundings anyway, so unless it binds
+    // names of its own, it can just run in the scope it was created in.
+    // FIXME: Non-arrow functions that don't use |this| could do the same, if the parser told us about that.
+    auto binds_names = [&] {
+        if (!m_parameters.is_empty())
+            return true;
+        if (!is<ScopeNode>(body()))
+            return false;
+        auto& scope_node = static_cast<const ScopeNode&>(body());
+        return !scope_node.variables().is_empty() || !scope_node.functions().is_empty();
+    };
+    m_needs_own_environment = !m_is_arrow_function || binds_names();
+    return m_needs_own_environment.value();
+}
+
 LexicalEnvironment* ScriptFunction::create_environment()
 {
+    if (!needs_own_environment())
+        return nullptr;
+
     HashMap<FlyString, Variable> variables;
     for (auto& parameter : m_parameters) {
         parameter.binding.visit(
@@ -155,7 +187,11 @@ Value ScriptFunction::execute_function_body()
     if (bytecode_interpreter) {
         prepare_arguments();
         if (!m_bytecode_executable.has_value()) {
-            m_bytecode_executable = Bytecode::Generator::generate(m_body, m_is_generator);
+            m_bytecode_executable = Bytecode::Generator::generate(body(), m_is_generator);
+            if (bytecode_interpreter->optimizations_enabled())
+                Bytecode::Interpreter::optimization_pipeline().perform(*m_bytecode_executable);
+            if (bytecode_interpreter->jit_enabled())
+                m_bytecode_executable->native_executable = JIT::Compiler::compile(*m_bytecode_executable);
             if constexpr (JS_BYTECODE_DEBUG) {
                 dbgln("Compiled Bytecode::Block for function '{}':", m_name);
                 for (auto& block : m_bytecode_executable->basic_blocks)
@@ -183,7 +219,7 @@ Value ScriptFunction::execute_function_body()
         if (vm.exception())
             return {};
 
-        return ast_interpreter->execute_statement(global_object(), m_body, ScopeType::Function);
+        return ast_interpreter->execute_statement(global_object(), body(), ScopeType::Function);
     }
 }
 
@@ -22,7 +22,7 @@ public:
     virtual void initialize(GlobalObject&) override;
     virtual ~ScriptFunction();
 
-    const Statement& body() const { return m_body; }
+    const Statement& body() const;
     const Vector<FunctionNode::Parameter>& parameters() const { return m_parameters; };
 
     virtual Value call() override;
@@ -40,8 +40,11 @@ protected:
 
 private:
     virtual LexicalEnvironment* create_environment() override;
+    virtual ScopeObject* outer_scope() override { return m_parent_scope; }
     virtual void visit_edges(Visitor&) override;
 
+    bool needs_own_environment() const;
+
     Value execute_function_body();
 
     JS_DECLARE_NATIVE_GETTER(length_getter);
@@ -57,6 +60,7 @@ private:
     bool m_is_strict { false };
     bool m_is_arrow_function { false };
     bool m_is_class_constructor { false };
+    mutable Optional<bool> m_needs_own_environment;
 };
 
 }
@@ -17,9 +17,9 @@ Shape* Shape::create_unique_clone() const
     new_shape->m_unique = true;
     new_shape->m_prototype = m_prototype;
     ensure_property_table();
-    new_shape->ensure_property_table();
-    (*new_shape->m_property_table) = *m_property_table;
-    new_shape->m_property_count = new_shape->m_property_table->size();
+    // NOTE: The clone shares our table until one of the two wants to change it.
+    new_shape->m_property_table = m_property_table;
+    new_shape->m_property_count = m_property_count;
     return new_shape;
 }
 
@@ -101,26 +101,25 @@ void Shape::visit_edges(Cell::Visitor& visitor)
     visitor.visit(m_prototype);
     visitor.visit(m_previous);
     m_property_name.visit_edges(visitor);
-    if (m_property_table) {
-        for (auto& it : *m_property_table)
-            it.key.visit_edges(visitor);
-    }
+    if (m_property_table)
+        m_property_table->visit_edges(visitor);
 }
 
 Optional<PropertyMetadata> Shape::lookup(const StringOrSymbol& property_name) const
 {
     if (m_property_count == 0)
         return {};
-    auto property = property_table().get(property_name);
-    if (!property.has_value())
+    ensure_property_table();
+    auto index = m_property_table->find(property_name, m_property_count);
+    if (!index.has_value())
         return {};
-    return property;
+    return (*m_property_table)[index.value()].value;
 }
 
-FLATTEN HashMap<StringOrSymbol, PropertyMetadata> const& Shape::property_table() const
+FLATTEN Span<Shape::Property const> Shape::property_table() const
 {
     ensure_property_table();
-    return *m_property_table;
+    return m_property_table->prefix(m_property_count);
 }
 
 size_t Shape::property_count() const
@@ -130,13 +129,10 @@ size_t Shape::property_count() const
 
 Vector<Shape::Property> Shape::property_table_ordered() const
 {
-    auto vec = Vector<Shape::Property>();
-    vec.resize(property_count());
-
-    for (auto& it : property_table()) {
-        vec[it.value.offset] = { it.key, it.value };
-    }
-
+    auto table = property_table();
+    Vector<Shape::Property> vec;
+    vec.ensure_capacity(table.size());
+    vec.append(table.data(), table.size());
     return vec;
 }
 
@@ -144,21 +140,24 @@ void Shape::ensure_property_table() const
 {
     if (m_property_table)
         return;
-    m_property_table = make<HashMap<StringOrSymbol, PropertyMetadata>>();
 
-    u32 next_offset = 0;
+    RefPtr<PropertyTable> table;
+    size_t count = 0;
 
     Vector<const Shape*, 64> transition_chain;
     for (auto* shape = m_previous; shape; shape = shape->m_previous) {
         if (shape->m_property_table) {
-            *m_property_table = *shape->m_property_table;
-            next_offset = shape->m_property_count;
+            table = shape->m_property_table;
+            count = shape->m_property_count;
             break;
         }
         transition_chain.append(shape);
     }
     transition_chain.append(this);
 
+    if (!table)
+        table = adopt_ref(*new PropertyTable);
+
     for (ssize_t i = transition_chain.size() - 1; i >= 0; --i) {
         auto* shape = transition_chain[i];
         if (!shape->m_property_name.is_valid()) {
@@ -166,21 +165,44 @@ void Shape::ensure_property_table() const
             continue;
         }
         if (shape->m_transition_type == TransitionType::Put) {
-            m_property_table->set(shape->m_property_name, { next_offset++, shape->m_attributes });
+            if (count < table->size() && (*table)[count].key == shape->m_property_name && (*table)[count].value.attributes == shape->m_attributes) {
+                // Some other shape has already gone down this path, so the entry we need is right there.
+                ++count;
+                continue;
+            }
+            // Entries past our count belong to a sibling shape, so we have to fork the table before adding ours.
+            if (count != table->size())
+                table = table->copy_prefix(count);
+            table->append(shape->m_property_name, shape->m_attributes);
+            ++count;
         } else if (shape->m_transition_type == TransitionType::Configure) {
-            auto it = m_property_table->find(shape->m_property_name);
-            VERIFY(it != m_property_table->end());
-            it->value.attributes = shape->m_attributes;
+            auto index = table->find(shape->m_property_name, count);
+            VERIFY(index.has_value());
+            if (table->ref_count() > 1)
+                table = table->copy_prefix(count);
+            table->set_attributes(index.value(), shape->m_attributes);
         }
     }
+
+    VERIFY(count == m_property_count);
+    m_property_table = move(table);
+}
+
+Shape::PropertyTable& Shape::ensure_writable_property_table()
+{
+    ensure_property_table();
+    if (m_property_table->ref_count() > 1 || m_property_table->size() != m_property_count)
+        m_property_table = m_property_table->copy_prefix(m_property_count);
+    return *m_property_table;
 }
 
 void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    VERIFY(!m_property_table->contains(property_name));
-    m_property_table->set(property_name, { m_property_table->size(), attributes });
+    auto& table = ensure_writable_property_table();
+    VERIFY(!table.find(property_name, m_property_count).has_value());
+    table.append(property_name, attributes);
     ++m_property_count;
 }
 
@@ -188,30 +210,100 @@ void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    auto it = m_property_table->find(property_name);
-    VERIFY(it != m_property_table->end());
-    it->value.attributes = attributes;
-    m_property_table->set(property_name, it->value);
+    auto& table = ensure_writable_property_table();
+    auto index = table.find(property_name, m_property_count);
+    VERIFY(index.has_value());
+    table.set_attributes(index.value(), attributes);
 }
 
 void Shape::remove_property_from_unique_shape(const StringOrSymbol& property_name, size_t offset)
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    if (m_property_table->remove(property_name))
-        --m_property_count;
-    for (auto& it : *m_property_table) {
-        VERIFY(it.value.offset != offset);
-        if (it.value.offset > offset)
-            --it.value.offset;
-    }
+    auto& table = ensure_writable_property_table();
+    auto index = table.find(property_name, m_property_count);
+    if (!index.has_value())
+        return;
+    VERIFY(index.value() == offset);
+    table.remove(index.value());
+    --m_property_count;
 }
 
 void Shape::add_property_without_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
-    ensure_property_table();
-    if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
-        ++m_property_count;
+    auto& table = ensure_writable_property_table();
+    if (auto index = table.find(property_name, m_property_count); index.has_value()) {
+        table.set_attributes(index.value(), attributes);
+        return;
+    }
+    table.append(property_name, attributes);
+    ++m_property_count;
+}
+
+// Up to this many properties, comparing keys one by one beats hashing them. Most keys are interned strings,
+// so those comparisons tend to stop at the pointer.
+static constexpr size_t property_table_linear_search_limit = 16;
+
+Optional<size_t> Shape::PropertyTable::find(const StringOrSymbol& key, size_t count) const
+{
+    if (m_index) {
+        auto index = m_index->get(key);
+        if (!index.has_value() || index.value() >= count)
+            return {};
+        return index;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (m_properties[i].key == key)
+            return i;
+    }
+    return {};
+}
+
+void Shape::PropertyTable::append(const StringOrSymbol& key, PropertyAttributes attributes)
+{
+    m_properties.append({ key, { m_properties.size(), attributes } });
+    if (m_index)
+        m_index->set(key, m_properties.size() - 1);
+    else if (m_properties.size() > property_table_linear_search_limit)
+        build_index();
+}
+
+void Shape::PropertyTable::set_attributes(size_t index, PropertyAttributes attributes)
+{
+    m_properties[index].value.attributes = attributes;
+}
+
+void Shape::PropertyTable::remove(size_t index)
+{
+    m_properties.remove(index);
+    for (size_t i = index; i < m_properties.size(); ++i)
+        m_properties[i].value.offset = i;
+    m_index = nullptr;
+    if (m_properties.size() > property_table_linear_search_limit)
+        build_index();
+}
+
+NonnullRefPtr<Shape::PropertyTable> Shape::PropertyTable::copy_prefix(size_t count) const
+{
+    auto table = adopt_ref(*new PropertyTable);
+    table->m_properties.append(m_properties.data(), count);
+    if (count > property_table_linear_search_limit)
+        table->build_index();
+    return table;
+}
+
+void Shape::PropertyTable::build_index()
+{
+    m_index = make<HashMap<StringOrSymbol, size_t>>();
+    m_index->ensure_capacity(m_properties.size());
+    for (size_t i = 0; i < m_properties.size(); ++i)
+        m_index->set(m_properties[i].key, i);
+}
+
+void Shape::PropertyTable::visit_edges(Cell::Visitor& visitor)
+{
+    for (auto& property : m_properties)
+        property.key.visit_edges(visitor);
 }
 
 }
@@ -8,6 +8,8 @@
 
 #include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
 #include <LibJS/Forward.h>
@@ -67,15 +69,18 @@ public:
     Object* prototype() { return m_prototype; }
     const Object* prototype() const { return m_prototype; }
 
-    Optional<PropertyMetadata> lookup(const StringOrSymbol&) const;
-    const HashMap<StringOrSymbol, PropertyMetadata>& property_table() const;
-    size_t property_count() const;
-
     struct Property {
         StringOrSymbol key;
         PropertyMetadata value;
     };
 
+    Optional<PropertyMetadata> lookup(const StringOrSymbol&) const;
+
+    // The properties in offset order, so property_table()[i].value.offset == i.
+    Span<Property const> property_table() const;
+    size_t property_count() const;
+
+    // NOTE: This is a copy, so it's safe to iterate over while adding and removing properties.
     Vector<Property> property_table_ordered() const;
 
     void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
@@ -88,8 +93,35 @@ private:
     virtual const char* class_name() const override { return "Shape"; }
     virtual void visit_edges(Visitor&) override;
 
+    // Properties are kept in an array ordered by offset, and small ones are searched linearly.
+    // Shapes along a chain of put transitions all share the same table, each one only looking at the first
+    // property_count() entries, so a new shape only adds one entry instead of copying everything before it.
+    class PropertyTable : public RefCounted<PropertyTable> {
+    public:
+        size_t size() const { return m_properties.size(); }
+        Property const& operator[](size_t index) const { return m_properties[index]; }
+        Span<Property const> prefix(size_t count) const { return m_properties.span().slice(0, count); }
+
+        Optional<size_t> find(const StringOrSymbol&, size_t count) const;
+
+        void append(const StringOrSymbol&, PropertyAttributes);
+        void set_attributes(size_t index, PropertyAttributes);
+        void remove(size_t index);
+
+        NonnullRefPtr<PropertyTable> copy_prefix(size_t count) const;
+
+        void visit_edges(Cell::Visitor&);
+
+    private:
+        void build_index();
+
+        Vector<Property> m_properties;
+        OwnPtr<HashMap<StringOrSymbol, size_t>> m_index;
+    };
+
     Shape* get_or_prune_cached_forward_transition(TransitionKey const&);
     void ensure_property_table() const;
+    PropertyTable& ensure_writable_property_table();
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
@@ -97,7 +129,7 @@ private:
 
     Object* m_global_object { nullptr };
 
-    mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
+    mutable RefPtr<PropertyTable> m_property_table;
 
     HashMap<TransitionKey, WeakPtr<Shape>> m_forward_transitions;
     Shape* m_previous { nullptr };
@@ -8,6 +8,7 @@
 #include <AK/Debug.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Error.h>
@@ -16,6 +17,7 @@
 #include <LibJS/Runtime/NativeFunction.h>
 #include <LibJS/Runtime/PromiseReaction.h>
 #include <LibJS/Runtime/Reference.h>
+#include <LibJS/Runtime/RegExpCache.h>
 #include <LibJS/Runtime/ScriptFunction.h>
 #include <LibJS/Runtime/Symbol.h>
 #include <LibJS/Runtime/TemporaryClearException.h>
@@ -30,6 +32,7 @@ NonnullRefPtr<VM> VM::create()
 
 VM::VM()
     : m_heap(*this)
+    , m_regexp_cache(make<RegExpCache>())
 {
     m_empty_string = m_heap.allocate_without_global_object<PrimitiveString>(String::empty());
     for (size_t i = 0; i < 128; ++i) {
@@ -107,6 +110,9 @@ void VM::gather_roots(HashTable<Cell*>& roots)
         roots.set(call_frame->scope);
     }
 
+    if (auto* bytecode_interpreter = Bytecode::Interpreter::current(); bytecode_interpreter && &bytecode_interpreter->vm() == this)
+        bytecode_interpreter->gather_roots(roots);
+
 #define __JS_ENUMERATE(SymbolName, snake_name) \
     roots.set(well_known_symbol_##snake_name());
     JS_ENUMERATE_WELL_KNOWN_SYMBOLS
@@ -399,7 +405,7 @@ Value VM::construct(Function& function, Function& new_target, Optional<MarkedVal
     if (arguments.has_value())
         call_frame.arguments.append(arguments.value().values());
     auto* environment = function.create_environment();
-    call_frame.scope = environment;
+    call_frame.scope = environment ?: function.outer_scope();
     if (environment)
         environment->set_new_target(&new_target);
 
@@ -511,7 +517,7 @@ Value VM::call_internal(Function& function, Value this_value, Optional<MarkedVal
     if (arguments.has_value())
         call_frame.arguments.append(arguments.value().values());
     auto* environment = function.create_environment();
-    call_frame.scope = environment;
+    call_frame.scope = environment ?: function.outer_scope();
 
     if (environment) {
         VERIFY(environment->this_binding_status() == LexicalEnvironment::ThisBindingStatus::Uninitialized);
@@ -10,6 +10,7 @@
 #include <AK/FlyString.h>
 #include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/StackInfo.h>
 #include <AK/Variant.h>
@@ -92,6 +93,8 @@ public:
     Symbol* get_global_symbol(const String& description);
 
     PrimitiveString& empty_string() { return *m_empty_string; }
+
+    RegExpCache& regexp_cache() { return *m_regexp_cache; }
     PrimitiveString& single_ascii_character_string(u8 character)
     {
         VERIFY(character < 0x80);
@@ -266,6 +269,8 @@ private:
 
     HashMap<String, Symbol*> m_global_symbol_map;
 
+    NonnullOwnPtr<RegExpCache> m_regexp_cache;
+
     Vector<NativeFunction*> m_promise_jobs;
 
     PrimitiveString* m_empty_string { nullptr };
@@ -0,0 +1,49 @@
+test("forEach sees the prototype once a packed array shrinks underneath it", () => {
+    const array = [1, 2, 3, 4];
+    Array.prototype[3] = "from prototype";
+    try {
+        const seen = [];
+        array.forEach((value, index) => {
+            seen.push(value);
+            if (index === 0) array.length = 2;
+        });
+        expect(seen).toEqual([1, 2, "from prototype"]);
+    } finally {
+        delete Array.prototype[3];
+    }
+});
+
+test("map keeps holes and the full length", () => {
+    const array = [1, 2, 3, 4, 5];
+    const result = array.map((value, index) => {
+        if (index === 0) array.length = 3;
+        return value * 2;
+    });
+    expect(result).toHaveLength(5);
+    expect(result[0]).toBe(2);
+    expect(result[2]).toBe(6);
+    expect(3 in result).toBeFalse();
+    expect(4 in result).toBeFalse();
+
+    const holey = [1, , 3];
+    const mapped = holey.map(value => value + 1);
+    expect(mapped).toHaveLength(3);
+    expect(1 in mapped).toBeFalse();
+    expect(mapped[2]).toBe(4);
+});
+
+test("indexOf on arrays of numbers", () => {
+    const array = [1, 2.5, -0, NaN, 7];
+    expect(array.indexOf(2.5)).toBe(1);
+    expect(array.indexOf(0)).toBe(2);
+    expect(array.indexOf(NaN)).toBe(-1);
+    expect(array.indexOf("7")).toBe(-1);
+    expect(array.indexOf(7, -1)).toBe(4);
+    expect(array.indexOf(1, 1)).toBe(-1);
+});
+
+test("default sort of numbers compares them as strings", () => {
+    expect([10, 9, 1, 100, -1, 2.5].sort()).toEqual([-1, 1, 10, 100, 2.5, 9]);
+    expect([3, NaN, Infinity, 20].sort()).toEqual([20, 3, Infinity, NaN]);
+    expect([3, 1, 2].sort((a, b) => a - b)).toEqual([1, 2, 3]);
+});
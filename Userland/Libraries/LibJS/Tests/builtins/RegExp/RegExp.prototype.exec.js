@@ -205,3 +205,16 @@ test("multiline stateful match", () => {
     );
     expect(res.index).toBe(231);
 });
+
+test("RegExp objects with the same pattern keep their own lastIndex", () => {
+    let first = /a/g;
+    let second = new RegExp("a", "g");
+
+    expect(first.exec("aaa").index).toBe(0);
+    expect(first.exec("aaa").index).toBe(1);
+    expect(first.lastIndex).toBe(2);
+
+    expect(second.lastIndex).toBe(0);
+    expect(second.exec("aaa").index).toBe(0);
+    expect(first.exec("aaa").index).toBe(2);
+});
@@ -0,0 +1,59 @@
+test("syntax errors in function bodies are reported before anything is called", () => {
+    expect("function f() { return 1 +; }").not.toEval();
+    expect("function f() { function g() { return 1 +; } }").not.toEval();
+    expect("(function () { break; })").not.toEval();
+});
+
+test("function bodies see the context they were declared in", () => {
+    "use strict";
+    function f() {
+        return this;
+    }
+    function g() {
+        "use strict";
+        return typeof this;
+    }
+    expect(f()).toBeUndefined();
+    expect(g()).toBe("undefined");
+
+    class A {
+        value() {
+            return 1;
+        }
+    }
+    class B extends A {
+        constructor() {
+            super();
+            this.x = 2;
+        }
+        value() {
+            return super.value() + this.x;
+        }
+    }
+    expect(new B().value()).toBe(3);
+});
+
+test("function bodies keep their variables and nested functions", () => {
+    function outer(a) {
+        var doubled = a * 2;
+        function inner(b) {
+            return doubled + b;
+        }
+        return inner(1) + hoisted();
+        function hoisted() {
+            return 10;
+        }
+    }
+    expect(outer(3)).toBe(17);
+    expect(outer(4)).toBe(19);
+});
+
+test("every closure of the same function works", () => {
+    function makeAdder(i) {
+        return function (x) {
+            return x + i;
+        };
+    }
+    const adders = [makeAdder(0), makeAdder(1), makeAdder(2)];
+    expect(adders.map(adder => adder(10))).toEqual([10, 11, 12]);
+});
@@ -0,0 +1,26 @@
+test("long strings built up piece by piece", () => {
+    let s = "";
+    for (let i = 0; i < 10000; ++i) s += "ab";
+    expect(s.length).toBe(20000);
+    expect(s[0]).toBe("a");
+    expect(s[19999]).toBe("b");
+    expect(s.indexOf("ba")).toBe(1);
+    expect(s.slice(0, 6)).toBe("ababab");
+});
+
+test("concatenated strings compare by their contents", () => {
+    const a = "the quick brown fox " + "jumps over the lazy dog";
+    const b = "the quick brown fox jumps " + "over the lazy dog";
+    expect(a === b).toBeTrue();
+    expect(a < b + "!").toBeTrue();
+    const o = {};
+    o[a] = 1;
+    expect(o[b]).toBe(1);
+});
+
+test("concatenating with non-strings", () => {
+    const long = "a string that is long enough to not be copied: ";
+    expect(long + 1 + null + undefined + true).toBe(long + "1nullundefinedtrue");
+    expect(1 + 2 + long).toBe("3" + long);
+    expect(("" + long + "").length).toBe(long.length);
+});
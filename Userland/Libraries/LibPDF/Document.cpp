@@ -6,6 +6,7 @@
 
 #include <LibPDF/CommonNames.h>
 #include <LibPDF/Document.h>
+#include <LibPDF/Filter.h>
 #include <LibPDF/Parser.h>
 
 namespace PDF {
@@ -46,12 +47,15 @@ Document::Document(const ReadonlyBytes& bytes)
     m_trailer = trailer;
 
     m_catalog = m_trailer->get_dict(this, CommonNames::Root);
-    build_page_tree();
+    m_page_tree = m_catalog->get_dict(this, CommonNames::Pages);
+    m_page_count = m_page_tree->get_value(CommonNames::Count).as_int();
     build_outline();
 }
 
 Value Document::get_or_load_value(u32 index)
 {
+    Threading::Locker locker(m_lock);
+
     auto value = get_value(index);
     if (value)
         return value;
@@ -74,18 +78,20 @@ u32 Document::get_first_page_index() const
 
 u32 Document::get_page_count() const
 {
-    return m_page_object_indices.size();
+    return m_page_count;
 }
 
 Page Document::get_page(u32 index)
 {
-    VERIFY(index < m_page_object_indices.size());
+    VERIFY(index < m_page_count);
+
+    Threading::Locker locker(m_lock);
 
     auto cached_page = m_pages.get(index);
     if (cached_page.has_value())
         return cached_page.value();
 
-    auto page_object_index = m_page_object_indices[index];
+    auto page_object_index = find_page_object_index(index);
     auto raw_page_object = resolve_to<DictObject>(get_or_load_value(page_object_index));
 
     auto resources = raw_page_object->get_dict(this, CommonNames::Resources);
@@ -145,38 +151,96 @@ Value Document::resolve(const Value& value)
     return obj;
 }
 
-void Document::build_page_tree()
+u32 Document::find_page_object_index(u32 page_index)
 {
-    auto page_tree = m_catalog->get_dict(this, CommonNames::Pages);
-    add_page_tree_node_to_page_tree(page_tree);
-}
+    NonnullRefPtr<DictObject> node = *m_page_tree;
+    u32 first_page_in_node = 0;
 
-void Document::add_page_tree_node_to_page_tree(NonnullRefPtr<DictObject> page_tree)
-{
-    auto kids_array = page_tree->get_array(this, CommonNames::Kids);
-    auto page_count = page_tree->get(CommonNames::Count).value().as_int();
+    while (true) {
+        auto kids_array = node->get_array(this, CommonNames::Kids);
+        auto page_count = node->get_value(CommonNames::Count).as_int();
 
-    if (static_cast<size_t>(page_count) != kids_array->elements().size()) {
-        // This page tree contains child page trees, so we recursively add
-        // these pages to the overall page tree
+        // We know all of the kids are leaf nodes
+        if (static_cast<size_t>(page_count) == kids_array->elements().size())
+            return kids_array->at(page_index - first_page_in_node).as_ref_index();
 
+        RefPtr<DictObject> next_node;
         for (auto& value : *kids_array) {
             auto reference_index = value.as_ref_index();
-            auto byte_offset = m_xref_table.byte_offset_for_object(reference_index);
-            auto maybe_page_tree_node = m_parser.conditionally_parse_page_tree_node_at_offset(byte_offset);
-            if (maybe_page_tree_node) {
-                add_page_tree_node_to_page_tree(maybe_page_tree_node.release_nonnull());
-            } else {
-                m_page_object_indices.append(reference_index);
+            auto kid_node = get_page_tree_node(reference_index);
+            if (!kid_node) {
+                if (first_page_in_node == page_index)
+                    return reference_index;
+                first_page_in_node++;
+                continue;
+            }
+
+            auto kid_page_count = static_cast<u32>(kid_node->get_value(CommonNames::Count).as_int());
+            if (page_index < first_page_in_node + kid_page_count) {
+                next_node = kid_node;
+                break;
             }
+            first_page_in_node += kid_page_count;
         }
 
+        VERIFY(next_node);
+        node = next_node.release_nonnull();
+    }
+}
+
+RefPtr<DictObject> Document::get_page_tree_node(u32 object_index)
+{
+    if (auto it = m_page_tree_nodes.find(object_index); it != m_page_tree_nodes.end())
+        return it->value;
+
+    auto byte_offset = m_xref_table.byte_offset_for_object(object_index);
+    auto page_tree_node = m_parser.conditionally_parse_page_tree_node_at_offset(byte_offset);
+    m_page_tree_nodes.set(object_index, page_tree_node);
+    return page_tree_node;
+}
+
+ByteBuffer Document::decode_stream(NonnullRefPtr<StreamObject> stream)
+{
+    if (!stream->is_encoded())
+        return ByteBuffer::copy(stream->bytes());
+
+    {
+        Threading::Locker locker(m_lock);
+        if (auto it = m_decoded_streams.find(stream.ptr()); it != m_decoded_streams.end()) {
+            it->value.last_use = ++m_decoded_stream_clock;
+            return it->value.data;
+        }
+    }
+
+    // Decoding is where the time goes, so it happens without holding the lock. If two pages happen to
+    // decode the same stream at once, the second one to finish just doesn't get cached.
+    auto& encoded_stream = static_cast<EncodedStreamObject&>(*stream);
+    auto maybe_bytes = Filter::decode(encoded_stream.bytes(), encoded_stream.filter());
+    // FIXME: Handle error condition
+    VERIFY(maybe_bytes.has_value());
+
+    Threading::Locker locker(m_lock);
+    cache_decoded_stream(stream, maybe_bytes.value());
+    return maybe_bytes.release_value();
+}
+
+void Document::cache_decoded_stream(NonnullRefPtr<StreamObject> stream, const ByteBuffer& data)
+{
+    if (data.size() > decoded_stream_cache_budget || m_decoded_streams.contains(stream.ptr()))
         return;
+
+    while (m_decoded_streams_size + data.size() > decoded_stream_cache_budget) {
+        auto least_recently_used = m_decoded_streams.begin();
+        for (auto it = m_decoded_streams.begin(); it != m_decoded_streams.end(); ++it) {
+            if (it->value.last_use < least_recently_used->value.last_use)
+                least_recently_used = it;
+        }
+        m_decoded_streams_size -= least_recently_used->value.data.size();
+        m_decoded_streams.remove(least_recently_used);
     }
 
-    // We know all of the kids are leaf nodes
-    for (auto& value : *kids_array)
-        m_page_object_indices.append(value.as_ref_index());
+    m_decoded_streams_size += data.size();
+    m_decoded_streams.set(stream.ptr(), { stream, data, ++m_decoded_stream_clock });
 }
 
 void Document::build_outline()
@@ -13,6 +13,7 @@
 #include <LibPDF/Object.h>
 #include <LibPDF/Parser.h>
 #include <LibPDF/XRefTable.h>
+#include <LibThreading/Lock.h>
 
 namespace PDF {
 
@@ -87,13 +88,18 @@ public:
 
     [[nodiscard]] Page get_page(u32 index);
 
-    ALWAYS_INLINE Value get_value(u32 index) const
+    // Returns the decoded contents of the stream. Decoded streams are kept around (up to a point) for the next time.
+    [[nodiscard]] ByteBuffer decode_stream(NonnullRefPtr<StreamObject>);
+
+    ALWAYS_INLINE Value get_value(u32 index)
     {
+        Threading::Locker locker(m_lock);
         return m_values.get(index).value_or({});
     }
 
     ALWAYS_INLINE void set_value(u32 index, const Value& value)
     {
+        Threading::Locker locker(m_lock);
         m_values.ensure_capacity(index);
         m_values.set(index, value);
     }
@@ -123,14 +129,12 @@ public:
     }
 
 private:
-    // FIXME: Currently, to improve performance, we don't load any pages at Document
-    // construction, rather we just load the page structure and populate
-    // m_page_object_indices. However, we can be even lazier and defer page tree node
-    // parsing, as good PDF writers will layout the page tree in a balanced tree to
-    // improve lookup time. This would reduce the initial overhead by not loading
-    // every page tree node of, say, a 1000+ page PDF file.
-    void build_page_tree();
-    void add_page_tree_node_to_page_tree(NonnullRefPtr<DictObject> page_tree);
+    // The page tree is only walked as far as it takes to find the pages that are asked for. Good PDF writers
+    // lay it out as a balanced tree, so that this only has to look at a few nodes, even in a 1000+ page PDF.
+    u32 find_page_object_index(u32 page_index);
+    RefPtr<DictObject> get_page_tree_node(u32 object_index);
+
+    void cache_decoded_stream(NonnullRefPtr<StreamObject>, const ByteBuffer&);
 
     void build_outline();
     NonnullRefPtr<OutlineItem> build_outline_item(NonnullRefPtr<DictObject> outline_item_dict);
@@ -140,10 +144,27 @@ private:
     XRefTable m_xref_table;
     RefPtr<DictObject> m_trailer;
     RefPtr<DictObject> m_catalog;
-    Vector<u32> m_page_object_indices;
+    RefPtr<DictObject> m_page_tree;
+    u32 m_page_count { 0 };
+    // Null for the kids that turned out to be pages rather than page tree nodes.
+    HashMap<u32, RefPtr<DictObject>> m_page_tree_nodes;
     HashMap<u32, Page> m_pages;
     HashMap<u32, Value> m_values;
     RefPtr<OutlineDict> m_outline;
+
+    static constexpr size_t decoded_stream_cache_budget = 32 * MiB;
+
+    struct DecodedStream {
+        NonnullRefPtr<StreamObject> stream;
+        ByteBuffer data;
+        u64 last_use { 0 };
+    };
+    HashMap<const StreamObject*, DecodedStream> m_decoded_streams;
+    size_t m_decoded_streams_size { 0 };
+    u64 m_decoded_stream_clock { 0 };
+
+    // Pages can be rendered on several threads at once, and loading objects moves the one parser around.
+    Threading::Lock m_lock;
 };
 
 }
@@ -12,7 +12,8 @@ class Document;
 class Object;
 
 // Note: This macro doesn't care about PlainTextStreamObject and EncodedStreamObject because
-//       we never need to work directly with either of them.
+//       we never need to work directly with either of them, telling them apart with
+//       StreamObject::is_encoded() is enough.
 
 #define ENUMERATE_OBJECT_TYPES(V) \
     V(StringObject, string)       \
@@ -158,7 +158,9 @@ public:
     virtual ~StreamObject() override = default;
 
     [[nodiscard]] ALWAYS_INLINE NonnullRefPtr<DictObject> dict() const { return m_dict; }
+    // The bytes as they are in the file. Use Document::decode_stream() to get at the contents of an encoded stream.
     [[nodiscard]] virtual ReadonlyBytes bytes() const = 0;
+    [[nodiscard]] virtual bool is_encoded() const { return false; }
 
     ALWAYS_INLINE bool is_stream() const override { return true; }
     ALWAYS_INLINE const char* type_name() const override { return "stream"; }
@@ -186,18 +188,22 @@ private:
 
 class EncodedStreamObject final : public StreamObject {
 public:
-    EncodedStreamObject(const NonnullRefPtr<DictObject>& dict, ByteBuffer&& buffer)
+    EncodedStreamObject(const NonnullRefPtr<DictObject>& dict, const ReadonlyBytes& bytes, const FlyString& filter)
         : StreamObject(dict)
-        , m_buffer(buffer)
+        , m_bytes(bytes)
+        , m_filter(filter)
     {
     }
 
     virtual ~EncodedStreamObject() override = default;
 
-    [[nodiscard]] ALWAYS_INLINE virtual ReadonlyBytes bytes() const override { return m_buffer.bytes(); }
+    [[nodiscard]] ALWAYS_INLINE virtual ReadonlyBytes bytes() const override { return m_bytes; }
+    [[nodiscard]] ALWAYS_INLINE virtual bool is_encoded() const override { return true; }
+    [[nodiscard]] ALWAYS_INLINE const FlyString& filter() const { return m_filter; }
 
 private:
-    ByteBuffer m_buffer;
+    ReadonlyBytes m_bytes;
+    FlyString m_filter;
 };
 
 class IndirectValue final : public Object {
@@ -8,7 +8,6 @@
 #include <AK/TypeCasts.h>
 #include <LibPDF/CommonNames.h>
 #include <LibPDF/Document.h>
-#include <LibPDF/Filter.h>
 #include <LibPDF/Parser.h>
 #include <LibTextCodec/Decoder.h>
 #include <ctype.h>
@@ -679,11 +678,9 @@ NonnullRefPtr<StreamObject> Parser::parse_stream(NonnullRefPtr<DictObject> dict)
     consume_whitespace();
 
     if (dict->contains(CommonNames::Filter)) {
+        // The stream is only decoded once something looks at its contents, see Document::decode_stream().
         auto filter_type = dict->get_name(m_document, CommonNames::Filter)->name();
-        auto maybe_bytes = Filter::decode(bytes, filter_type);
-        // FIXME: Handle error condition
-        VERIFY(maybe_bytes.has_value());
-        return make_object<EncodedStreamObject>(dict, move(maybe_bytes.value()));
+        return make_object<EncodedStreamObject>(dict, bytes, filter_type);
     }
 
     return make_object<PlainTextStreamObject>(dict, bytes);
@@ -112,13 +112,12 @@ void Renderer::render()
     if (m_page.contents->is_array()) {
         auto contents = object_cast<ArrayObject>(m_page.contents);
         for (auto& ref : *contents) {
-            auto bytes = m_document->resolve_to<StreamObject>(ref)->bytes();
+            auto bytes = m_document->decode_stream(m_document->resolve_to<StreamObject>(ref));
             byte_buffer.append(bytes.data(), bytes.size());
         }
     } else {
         VERIFY(m_page.contents->is_stream());
-        auto bytes = object_cast<StreamObject>(m_page.contents)->bytes();
-        byte_buffer.append(bytes.data(), bytes.size());
+        byte_buffer = m_document->decode_stream(object_cast<StreamObject>(m_page.contents));
     }
 
     auto commands = Parser::parse_graphics_commands(byte_buffer);
@@ -19,6 +19,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/internals.h>
 #include <sys/mman.h>
 #include <syscall.h>
 #include <time.h>
@@ -75,6 +76,9 @@ static int create_thread(pthread_t* thread, void* (*entry)(void*), void* argumen
     // Push a fake return address
     push_on_stack(nullptr);
 
+    // This has to be set before the new thread could run, so nobody skips locking from then on.
+    __pthread_is_multithreaded = true;
+
     int rc = syscall(SC_create_thread, pthread_create_helper, thread_params);
     if (rc >= 0)
         *thread = rc;
@@ -84,6 +88,7 @@ static int create_thread(pthread_t* thread, void* (*entry)(void*), void* argumen
 [[noreturn]] static void exit_thread(void* code, void* stack_location, size_t stack_size)
 {
     __pthread_key_destroy_for_current_thread();
+    __malloc_thread_exit();
     syscall(SC_exit_thread, code, stack_location, stack_size);
     VERIFY_NOT_REACHED();
 }
@@ -186,6 +191,7 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex)
 int pthread_mutexattr_init(pthread_mutexattr_t* attr)
 {
     attr->type = PTHREAD_MUTEX_NORMAL;
+    attr->protocol = PTHREAD_PRIO_NONE;
     return 0;
 }
 
@@ -210,6 +216,24 @@ int pthread_mutexattr_gettype(pthread_mutexattr_t* attr, int* type)
     return 0;
 }
 
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* attr, int protocol)
+{
+    if (!attr)
+        return EINVAL;
+    if (protocol == PTHREAD_PRIO_PROTECT)
+        return ENOTSUP;
+    if (protocol != PTHREAD_PRIO_NONE && protocol != PTHREAD_PRIO_INHERIT)
+        return EINVAL;
+    attr->protocol = protocol;
+    return 0;
+}
+
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t* attr, int* protocol)
+{
+    *protocol = attr->protocol;
+    return 0;
+}
+
 int pthread_attr_init(pthread_attr_t* attributes)
 {
     auto* impl = new PthreadAttrImpl {};
@@ -444,6 +468,7 @@ int pthread_cond_init(pthread_cond_t* cond, const pthread_condattr_t* attr)
     cond->value = 0;
     cond->previous = 0;
     cond->clockid = attr ? attr->clockid : CLOCK_MONOTONIC_COARSE;
+    cond->mutex = nullptr;
     return 0;
 }
 
@@ -469,9 +494,12 @@ static int cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct
 {
     u32 value = cond->value;
     cond->previous = value;
+    // NOTE: Everyone waiting on a condition variable at the same time has to use the same mutex.
+    cond->mutex = mutex;
     pthread_mutex_unlock(mutex);
     int rc = futex_wait(cond->value, value, abstime);
-    pthread_mutex_lock(mutex);
+    // pthread_cond_broadcast() may have moved us over to the mutex, and whoever's behind us is waiting for us to unlock it.
+    __pthread_mutex_lock_pessimistic_np(mutex);
     return rc;
 }
 
@@ -517,8 +545,18 @@ int pthread_cond_broadcast(pthread_cond_t* cond)
 {
     u32 value = cond->previous + 1;
     cond->value = value;
-    int rc = futex(&cond->value, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
-    VERIFY(rc >= 0);
+    auto* mutex = cond->mutex;
+    // NOTE: Priority inheriting mutexes are handed over by the kernel, so we can't queue anyone up on them.
+    if (!mutex || mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        int rc = futex(&cond->value, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+        VERIFY(rc >= 0);
+        return 0;
+    }
+    // Only the first waiter gets woken up. The others are moved over to the mutex, and wake up one at a time
+    // as it gets unlocked, instead of all of them fighting over it at once.
+    // If anyone changed the value in the meantime, they've woken everyone up already.
+    int rc = futex(&cond->value, FUTEX_CMP_REQUEUE, 1, reinterpret_cast<const struct timespec*>(INT32_MAX), &mutex->lock, value);
+    VERIFY(rc >= 0 || errno == EAGAIN);
     return 0;
 }
 
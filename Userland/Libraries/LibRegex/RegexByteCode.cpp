@@ -167,6 +167,245 @@ OpCode* ByteCode::get_opcode(MatchState& state) const
     return op_code;
 }
 
+void StartingCharacters::add(u32 from, u32 to)
+{
+    for (; from <= to && from < 256; ++from)
+        m_latin1_bits[from / 64] |= 1ull << (from % 64);
+    if (from <= to)
+        m_other_ranges.empend(from, to);
+}
+
+static bool matches_character_class(CharClass character_class, u32 ch)
+{
+    switch (character_class) {
+    case CharClass::Alnum:
+        return is_ascii_alphanumeric(ch);
+    case CharClass::Alpha:
+        return is_ascii_alpha(ch);
+    case CharClass::Blank:
+        return is_ascii_blank(ch);
+    case CharClass::Cntrl:
+        return is_ascii_control(ch);
+    case CharClass::Digit:
+        return is_ascii_digit(ch);
+    case CharClass::Graph:
+        return is_ascii_graphical(ch);
+    case CharClass::Lower:
+        return is_ascii_lower_alpha(ch);
+    case CharClass::Print:
+        return is_ascii_printable(ch);
+    case CharClass::Punct:
+        return is_ascii_punctuation(ch);
+    case CharClass::Space:
+        return is_ascii_space(ch);
+    case CharClass::Upper:
+        return is_ascii_upper_alpha(ch);
+    case CharClass::Word:
+        return is_ascii_alphanumeric(ch) || ch == '_';
+    case CharClass::Xdigit:
+        return is_ascii_hex_digit(ch);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Adds everything the Compare at `ip` can consume as its first character, or returns false if that could be anything.
+static bool add_compare_starting_characters(const ByteCode& bytecode, size_t ip, StartingCharacters& characters)
+{
+    size_t offset = ip + 3;
+    for (size_t i = 0; i < bytecode[ip + 1]; ++i) {
+        switch ((CharacterCompareType)bytecode[offset++]) {
+        case CharacterCompareType::Char: {
+            u32 ch = bytecode[offset++];
+            characters.add(ch, ch);
+            break;
+        }
+        case CharacterCompareType::String: {
+            auto length = bytecode[offset];
+            if (length == 0)
+                return false;
+            // Strings are compared byte by byte, so this is the byte the input has to start with.
+            u8 ch = bytecode[offset + 1];
+            characters.add(ch, ch);
+            offset += length + 1;
+            break;
+        }
+        case CharacterCompareType::CharRange: {
+            CharRange range = bytecode[offset++];
+            characters.add(range.from, range.to);
+            break;
+        }
+        case CharacterCompareType::CharClass: {
+            auto character_class = (CharClass)bytecode[offset++];
+            // All the character classes are ASCII-only.
+            for (u32 ch = 0; ch < 128; ++ch) {
+                if (matches_character_class(character_class, ch))
+                    characters.add(ch, ch);
+            }
+            break;
+        }
+        default:
+            // Inversions, AnyChar and references could match (almost) anything.
+            return false;
+        }
+    }
+    return true;
+}
+
+// The literal that every match has to start with, i.e. the single-character compares at the start of the bytecode.
+static Vector<u8> literal_prefix(const ByteCode& bytecode)
+{
+    Vector<u8> prefix;
+    size_t ip = 0;
+    while (ip < bytecode.size()) {
+        switch ((OpCodeId)bytecode[ip]) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+            ip += 2;
+            continue;
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+            ip += 3;
+            continue;
+        case OpCodeId::Compare: {
+            if (bytecode[ip + 1] != 1)
+                return prefix;
+            auto type = (CharacterCompareType)bytecode[ip + 3];
+            if (type == CharacterCompareType::Char) {
+                auto ch = bytecode[ip + 4];
+                if (ch >= 256)
+                    return prefix;
+                prefix.append(static_cast<u8>(ch));
+            } else if (type == CharacterCompareType::String) {
+                auto length = bytecode[ip + 4];
+                for (size_t i = 0; i < length; ++i)
+                    prefix.append(static_cast<u8>(bytecode[ip + 5 + i]));
+            } else {
+                return prefix;
+            }
+            ip += bytecode[ip + 2] + 3;
+            continue;
+        }
+        default:
+            return prefix;
+        }
+    }
+    return prefix;
+}
+
+Optional<StartingCharacters> ByteCode::starting_characters() const
+{
+    StartingCharacters characters;
+
+    // Follow every path from the start up to its first Compare, giving up on anything that could match
+    // without consuming a character (or move backwards in the input).
+    Vector<bool> visited;
+    visited.resize(size());
+    Vector<size_t> pending;
+    pending.append(0);
+    while (!pending.is_empty()) {
+        auto ip = pending.take_last();
+        for (;;) {
+            if (ip >= size())
+                return {};
+            if (visited[ip])
+                break;
+            visited[ip] = true;
+
+            auto id = (OpCodeId)at(ip);
+            if (id == OpCodeId::Compare) {
+                if (!add_compare_starting_characters(*this, ip, characters))
+                    return {};
+                break;
+            }
+
+            switch (id) {
+            case OpCodeId::Jump:
+                ip += 2 + (ssize_t)at(ip + 1);
+                continue;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkStay:
+                pending.append(ip + 2 + (ssize_t)at(ip + 1));
+                ip += 2;
+                continue;
+            case OpCodeId::CheckBegin:
+            case OpCodeId::CheckEnd:
+                ip += 1;
+                continue;
+            case OpCodeId::FailForks:
+            case OpCodeId::CheckBoundary:
+            case OpCodeId::SaveLeftCaptureGroup:
+            case OpCodeId::SaveRightCaptureGroup:
+                ip += 2;
+                continue;
+            case OpCodeId::SaveLeftNamedCaptureGroup:
+            case OpCodeId::SaveRightNamedCaptureGroup:
+                ip += 3;
+                continue;
+            default:
+                // Exit, and the lookaround machinery (Save, Restore and GoBack).
+                return {};
+            }
+        }
+    }
+
+    characters.set_literal_prefix(literal_prefix(*this));
+    return characters;
+}
+
+bool ByteCode::needs_backtracking() const
+{
+    size_t ip = 0;
+    while (ip < size()) {
+        switch ((OpCodeId)at(ip)) {
+        case OpCodeId::Compare: {
+            size_t offset = ip + 3;
+            for (size_t i = 0; i < at(ip + 1); ++i) {
+                switch ((CharacterCompareType)at(offset++)) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                    ++offset;
+                    break;
+                case CharacterCompareType::String:
+                    // The simulation can't deal with compares that don't consume anything.
+                    if (at(offset) == 0)
+                        return true;
+                    offset += at(offset) + 1;
+                    break;
+                default:
+                    return true;
+                }
+            }
+            ip += at(ip + 2) + 3;
+            break;
+        }
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+            ip += 1;
+            break;
+        case OpCodeId::Jump:
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::CheckBoundary:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+            ip += 2;
+            break;
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+            ip += 3;
+            break;
+        default:
+            return true;
+        }
+    }
+    return false;
+}
+
 ALWAYS_INLINE ExecutionResult OpCode_Exit::execute(const MatchInput& input, MatchState& state, MatchOutput&) const
 {
     if (state.string_position > input.view.length() || state.instruction_position >= m_bytecode->size())
@@ -425,16 +664,26 @@ ALWAYS_INLINE ExecutionResult OpCode_Compare::execute(const MatchInput& input, M
             VERIFY(!current_inversion_state());
 
             const auto& length = m_bytecode->at(offset++);
-            StringBuilder str_builder;
-            for (size_t i = 0; i < length; ++i)
-                str_builder.append(m_bytecode->at(offset++));
 
             // We want to compare a string that is definitely longer than the available string
             if (input.view.length() - state.string_position < length)
                 return ExecutionResult::Failed_ExecuteLowPrioForks;
 
-            if (!compare_string(input, state, str_builder.string_view().characters_without_null_termination(), length, had_zero_length_match))
-                return ExecutionResult::Failed_ExecuteLowPrioForks;
+            // NOTE: The optimizer merges runs of characters into strings, so compare them in place instead of building a String first.
+            for (size_t i = 0; i < length; ++i) {
+                u32 ch1 = static_cast<u8>(m_bytecode->at(offset + i));
+                u32 ch2 = input.view[state.string_position + i];
+                if (input.regex_options & AllFlags::Insensitive) {
+                    ch1 = to_ascii_lowercase(ch1);
+                    ch2 = to_ascii_lowercase(ch2);
+                }
+                if (ch1 != ch2)
+                    return ExecutionResult::Failed_ExecuteLowPrioForks;
+            }
+            offset += length;
+            state.string_position += length;
+            if (length == 0)
+                had_zero_length_match = true;
 
         } else if (compare_type == CharacterCompareType::CharClass) {
 
@@ -510,7 +759,7 @@ ALWAYS_INLINE void OpCode_Compare::compare_char(const MatchInput& input, MatchSt
 
     if (input.regex_options & AllFlags::Insensitive) {
         ch1 = to_ascii_lowercase(ch1);
-        ch2 = to_ascii_uppercase(ch2);
+        ch2 = to_ascii_lowercase(ch2);
     }
 
     if (ch1 == ch2) {
@@ -541,9 +790,24 @@ ALWAYS_INLINE bool OpCode_Compare::compare_string(const MatchInput& input, Match
                 had_zero_length_match = true;
             return true;
         }
+        return false;
     }
 
-    return false;
+    for (size_t i = 0; i < length; ++i) {
+        u32 ch1 = static_cast<u8>(str[i]);
+        u32 ch2 = input.view[state.string_position + i];
+        if (input.regex_options & AllFlags::Insensitive) {
+            ch1 = to_ascii_lowercase(ch1);
+            ch2 = to_ascii_lowercase(ch2);
+        }
+        if (ch1 != ch2)
+            return false;
+    }
+
+    state.string_position += length;
+    if (length == 0)
+        had_zero_length_match = true;
+    return true;
 }
 
 ALWAYS_INLINE void OpCode_Compare::compare_character_class(const MatchInput& input, MatchState& state, CharClass character_class, u32 ch, bool inverse, bool& inverse_matched)
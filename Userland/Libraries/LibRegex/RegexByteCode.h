@@ -125,6 +125,32 @@ struct CompareTypeAndValuePair {
     ByteCodeValueType value;
 };
 
+// What every match of a pattern has to start with: a set of characters, and a literal prefix if there is one.
+// The matcher uses this to skip over input positions that can't possibly start a match.
+class StartingCharacters {
+public:
+    void add(u32 from, u32 to);
+    void set_literal_prefix(Vector<u8>&& prefix) { m_literal_prefix = move(prefix); }
+
+    ALWAYS_INLINE bool contains(u32 ch) const
+    {
+        if (ch < 256)
+            return m_latin1_bits[ch / 64] & (1ull << (ch % 64));
+        for (auto& range : m_other_ranges) {
+            if (ch >= range.from && ch <= range.to)
+                return true;
+        }
+        return false;
+    }
+
+    const Vector<u8>& literal_prefix() const { return m_literal_prefix; }
+
+private:
+    u64 m_latin1_bits[4] {};
+    Vector<CharRange> m_other_ranges;
+    Vector<u8> m_literal_prefix;
+};
+
 class OpCode;
 
 class ByteCode : public Vector<ByteCodeValueType> {
@@ -135,6 +161,15 @@ public:
 
     ByteCode& operator=(ByteCode&&) = default;
 
+    // Returns nothing if the bytecode could match without consuming a character first, or if we can't tell.
+    Optional<StartingCharacters> starting_characters() const;
+
+    // Backreferences and lookarounds can only be matched by backtracking, everything else can be simulated as an NFA.
+    bool needs_backtracking() const;
+
+    // Rewrites the bytecode into an equivalent one that does less work, e.g. by merging runs of literal characters.
+    void optimize();
+
     void insert_bytecode_compare_values(Vector<CompareTypeAndValuePair>&& pairs)
     {
         ByteCode bytecode;
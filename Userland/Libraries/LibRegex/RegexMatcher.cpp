@@ -8,9 +8,11 @@
 #include "RegexDebug.h"
 #include "RegexParser.h"
 #include <AK/Debug.h>
+#include <AK/MemMem.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
+#include <string.h>
 
 namespace regex {
 
@@ -53,25 +55,62 @@ String Regex<Parser>::error_string(Optional<String> message) const
     return eb.build();
 }
 
+// Returns the first position at or after `start` where a match could begin.
+static Optional<size_t> find_possible_match_start(const RegexStringView& view, size_t start, const StartingCharacters& characters)
+{
+    auto& prefix = characters.literal_prefix();
+    if (view.is_u8_view() && !prefix.is_empty()) {
+        auto haystack = view.u8view().substring_view(start);
+        Optional<size_t> offset;
+        if (prefix.size() == 1) {
+            if (auto* match = memchr(haystack.characters_without_null_termination(), prefix.first(), haystack.length()))
+                offset = static_cast<const char*>(match) - haystack.characters_without_null_termination();
+        } else {
+            offset = AK::memmem_optional(haystack.characters_without_null_termination(), haystack.length(), prefix.data(), prefix.size());
+        }
+        if (!offset.has_value())
+            return {};
+        return start + offset.value();
+    }
+
+    for (size_t i = start; i < view.length(); ++i) {
+        if (characters.contains(view[i]))
+            return i;
+    }
+    return {};
+}
+
 template<typename Parser>
 RegexResult Matcher<Parser>::match(const RegexStringView& view, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
+{
+    return match(view, m_pattern.start_offset, regex_options);
+}
+
+template<typename Parser>
+RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
+{
+    return match(views, m_pattern.start_offset, regex_options);
+}
+
+template<typename Parser>
+RegexResult Matcher<Parser>::match(const RegexStringView& view, size_t& start_offset, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
     AllOptions options = m_regex_options | regex_options.value_or({}).value();
 
     if (options.has_flag_set(AllFlags::Multiline))
-        return match(view.lines(), regex_options); // FIXME: how do we know, which line ending a line has (1char or 2char)? This is needed to get the correct match offsets from start of string...
+        return match(view.lines(), start_offset, regex_options); // FIXME: how do we know, which line ending a line has (1char or 2char)? This is needed to get the correct match offsets from start of string...
 
     Vector<RegexStringView> views;
     views.append(view);
-    return match(views, regex_options);
+    return match(views, start_offset, regex_options);
 }
 
 template<typename Parser>
-RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
+RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, size_t& start_offset, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
     // If the pattern *itself* isn't stateful, reset any changes to start_offset.
     if (!((AllFlags)m_regex_options.value() & AllFlags::Internal_Stateful))
-        m_pattern.start_offset = 0;
+        start_offset = 0;
 
     size_t match_count { 0 };
 
@@ -80,7 +119,7 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
     MatchOutput output;
 
     input.regex_options = m_regex_options | regex_options.value_or({}).value();
-    input.start_offset = m_pattern.start_offset;
+    input.start_offset = start_offset;
     output.operations = 0;
     size_t lines_to_skip = 0;
 
@@ -138,6 +177,12 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
     if (input.regex_options.has_flag_set(AllFlags::Internal_Stateful))
         continue_search = false;
 
+    // If we're going to look for a match at every position anyway, skip the positions that can't start one.
+    // FIXME: Case-insensitive matching could use this too, if the starting characters were case-folded.
+    const StartingCharacters* starting_characters = nullptr;
+    if ((continue_search || input.regex_options.has_flag_set(AllFlags::Internal_Stateful)) && !input.regex_options.has_flag_set(AllFlags::Insensitive) && m_pattern.parser_result.starting_characters.has_value())
+        starting_characters = &m_pattern.parser_result.starting_characters.value();
+
     for (auto& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -148,7 +193,7 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
         dbgln_if(REGEX_DEBUG, "[match] Starting match with view ({}): _{}_", view.length(), view);
 
         auto view_length = view.length();
-        size_t view_index = m_pattern.start_offset;
+        size_t view_index = start_offset;
         state.string_position = view_index;
         bool succeeded = false;
 
@@ -179,6 +224,13 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
         }
 
         for (; view_index < view_length; ++view_index) {
+            if (starting_characters) {
+                auto start = find_possible_match_start(view, view_index, *starting_characters);
+                if (!start.has_value())
+                    break;
+                view_index = start.value();
+            }
+
             auto& match_length_minimum = m_pattern.parser_result.match_length_minimum;
             // FIXME: More performant would be to know the remaining minimum string
             //        length needed to match from the current position onwards within
@@ -195,7 +247,18 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
             state.string_position = view_index;
             state.instruction_position = 0;
 
-            auto success = execute(input, state, output, 0);
+            Optional<bool> success;
+            if (m_pattern.parser_result.needs_backtracking) {
+                success = execute(input, state, output, 0);
+            } else {
+                // The simulation checks every later starting position in the same pass, so if it fails there's nothing left to find.
+                bool search = continue_search || input.regex_options.has_flag_set(AllFlags::Internal_Stateful);
+                size_t match_start = view_index;
+                success = simulate(input, state, output, search, starting_characters, match_start);
+                if (success == false && search)
+                    break;
+                view_index = match_start;
+            }
             if (!success.has_value())
                 return { false, 0, {}, {}, {}, output.operations };
 
@@ -245,7 +308,7 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
         input.global_offset += view.length() + 1; // +1 includes the line break character
 
         if (input.regex_options.has_flag_set(AllFlags::Internal_Stateful))
-            m_pattern.start_offset = state.string_position;
+            start_offset = state.string_position;
 
         if (succeeded && !continue_search)
             break;
@@ -378,6 +441,181 @@ ALWAYS_INLINE Optional<bool> Matcher<Parser>::execute_low_prio_forks(const Match
     return false;
 }
 
+// A capture group instruction a thread went through, and where. Threads share their history of these as a tree.
+struct CaptureEvent {
+    size_t instruction_position;
+    size_t string_position;
+    ssize_t previous;
+};
+
+struct SimulationThread {
+    size_t instruction_position;
+    size_t start_position;
+    ssize_t last_capture { -1 };
+    // How many more characters the Compare this thread just went through consumed.
+    size_t characters_to_skip { 0 };
+};
+
+// Runs the bytecode as an NFA (Pike's construction): all the threads step through the input in lockstep,
+// ordered by the priority the backtracking matcher would have visited them in. That finds the same match
+// in time linear in the length of the input, and the capture groups of the winning thread are replayed
+// onto the output at the end.
+// If `search` is set, this looks for the leftmost match at or after the starting position, and returns
+// where it started in `match_start`.
+template<class Parser>
+Optional<bool> Matcher<Parser>::simulate(const MatchInput& input, MatchState& state, MatchOutput& output, bool search, const StartingCharacters* starting_characters, size_t& match_start) const
+{
+    auto& bytecode = m_pattern.parser_result.bytecode;
+    auto view_length = input.view.length();
+
+    Vector<CaptureEvent, 64> captures;
+    Vector<SimulationThread, 32> current;
+    Vector<SimulationThread, 32> next;
+    Vector<SimulationThread, 32> pending;
+    // The position (plus one) at which each instruction was last reached, so that only the first thread to get there continues.
+    Vector<size_t, 128> visited;
+    visited.resize(bytecode.size());
+
+    // Looking the opcodes up again every time we need one is surprisingly expensive.
+    OpCode* opcodes[(size_t)OpCodeId::Last + 1] {};
+    auto opcode_for = [&](MatchState& opcode_state) {
+        auto& opcode = opcodes[bytecode[opcode_state.instruction_position]];
+        if (!opcode)
+            opcode = bytecode.get_opcode(opcode_state);
+        else
+            opcode->set_state(opcode_state);
+        return opcode;
+    };
+
+    Optional<SimulationThread> match;
+    size_t match_end = 0;
+
+    // Follows the thread through everything that doesn't consume input, and adds the threads that end up
+    // waiting on a Compare to `list`. Returns true if one of them matched, in which case nothing after it matters.
+    auto add_thread = [&](auto& list, SimulationThread thread, size_t position) {
+        pending.clear();
+        pending.append(thread);
+        while (!pending.is_empty()) {
+            auto current_thread = pending.take_last();
+            for (;;) {
+                auto ip = current_thread.instruction_position;
+                if (ip >= bytecode.size()) {
+                    match = current_thread;
+                    match_end = position;
+                    return true;
+                }
+                if (visited[ip] == position + 1)
+                    break;
+                visited[ip] = position + 1;
+                ++output.operations;
+
+                auto id = (OpCodeId)bytecode[ip];
+                if (id == OpCodeId::Compare) {
+                    list.append(current_thread);
+                    break;
+                }
+
+                if (id == OpCodeId::Jump || id == OpCodeId::ForkJump || id == OpCodeId::ForkStay) {
+                    auto target = ip + 2 + (ssize_t)bytecode[ip + 1];
+                    auto fallthrough = ip + 2;
+                    if (id == OpCodeId::ForkJump) {
+                        // The jump is tried first, so the thread staying behind is the one that has to wait.
+                        pending.append(current_thread);
+                        pending.last().instruction_position = fallthrough;
+                    } else if (id == OpCodeId::ForkStay) {
+                        pending.append(current_thread);
+                        pending.last().instruction_position = target;
+                        target = fallthrough;
+                    }
+                    current_thread.instruction_position = target;
+                    continue;
+                }
+
+                MatchState opcode_state { position, ip, 0 };
+                auto* opcode = opcode_for(opcode_state);
+                if (id == OpCodeId::CheckBegin || id == OpCodeId::CheckEnd || id == OpCodeId::CheckBoundary) {
+                    if (opcode->execute(input, opcode_state, output) != ExecutionResult::Continue)
+                        break;
+                } else {
+                    captures.append({ ip, position, current_thread.last_capture });
+                    current_thread.last_capture = captures.size() - 1;
+                }
+                current_thread.instruction_position += opcode->size();
+            }
+        }
+        return false;
+    };
+
+    size_t position = state.string_position;
+    add_thread(current, { 0, position }, position);
+
+    while (position < view_length) {
+        if (current.is_empty() && (!search || match.has_value()))
+            break;
+
+        next.clear();
+        for (auto& thread : current) {
+            if (thread.characters_to_skip) {
+                if (--thread.characters_to_skip) {
+                    next.append(thread);
+                    continue;
+                }
+                if (add_thread(next, thread, position + 1))
+                    break;
+                continue;
+            }
+
+            ++output.operations;
+            MatchState compare_state { position, thread.instruction_position, 0 };
+            auto* opcode = opcode_for(compare_state);
+            if (opcode->execute(input, compare_state, output) != ExecutionResult::Continue)
+                continue;
+
+            thread.instruction_position += opcode->size();
+            auto consumed = compare_state.string_position - position;
+            if (consumed > 1) {
+                thread.characters_to_skip = consumed - 1;
+                next.append(thread);
+                continue;
+            }
+            // The threads after this one have a lower priority, so they can't win anymore if this one matched.
+            if (add_thread(next, thread, position + 1))
+                break;
+        }
+
+        swap(current, next);
+        ++position;
+
+        if (search && !match.has_value() && position < view_length) {
+            // Start another thread here, with the lowest priority, since a match that starts earlier wins.
+            if (current.is_empty() && starting_characters) {
+                auto next_start = find_possible_match_start(input.view, position, *starting_characters);
+                if (!next_start.has_value())
+                    break;
+                position = next_start.value();
+            }
+            if (!starting_characters || starting_characters->contains(input.view[position]))
+                add_thread(current, { 0, position }, position);
+        }
+    }
+
+    if (!match.has_value())
+        return false;
+
+    Vector<size_t> events;
+    for (auto index = match->last_capture; index >= 0; index = captures[index].previous)
+        events.append(index);
+    for (size_t i = events.size(); i > 0; --i) {
+        auto& event = captures[events[i - 1]];
+        MatchState event_state { event.string_position, event.instruction_position, 0 };
+        opcode_for(event_state)->execute(input, event_state, output);
+    }
+
+    match_start = match->start_position;
+    state.string_position = match_end;
+    return true;
+}
+
 template class Matcher<PosixExtendedParser>;
 template class Regex<PosixExtendedParser>;
 
@@ -54,6 +54,10 @@ public:
     RegexResult match(const RegexStringView&, Optional<typename ParserTraits<Parser>::OptionsType> = {}) const;
     RegexResult match(const Vector<RegexStringView>, Optional<typename ParserTraits<Parser>::OptionsType> = {}) const;
 
+    // Like the above, but starting at (and for stateful patterns, continuing from) the caller's offset instead of the pattern's own.
+    RegexResult match(const RegexStringView&, size_t& start_offset, Optional<typename ParserTraits<Parser>::OptionsType> = {}) const;
+    RegexResult match(const Vector<RegexStringView>, size_t& start_offset, Optional<typename ParserTraits<Parser>::OptionsType> = {}) const;
+
     typename ParserTraits<Parser>::OptionsType options() const
     {
         return m_regex_options;
@@ -62,11 +66,14 @@ public:
 private:
     Optional<bool> execute(const MatchInput& input, MatchState& state, MatchOutput& output, size_t recursion_level) const;
     ALWAYS_INLINE Optional<bool> execute_low_prio_forks(const MatchInput& input, MatchState& original_state, MatchOutput& output, Vector<MatchState> states, size_t recursion_level) const;
+    Optional<bool> simulate(const MatchInput& input, MatchState& state, MatchOutput& output, bool search, const StartingCharacters* starting_characters, size_t& match_start) const;
 
     const Regex<Parser>& m_pattern;
     const typename ParserTraits<Parser>::OptionsType m_regex_options;
 };
 
+// NOTE: Apart from start_offset, a Regex doesn't change once it's compiled, so one can be shared between several users
+//       as long as they keep track of their own start offsets, see match(view, start_offset).
 template<class Parser>
 class Regex final {
 public:
@@ -96,6 +103,13 @@ public:
         return matcher->match(views, regex_options);
     }
 
+    RegexResult match(const RegexStringView view, size_t& start_offset, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {}) const
+    {
+        if (!matcher || parser_result.error != Error::NoError)
+            return {};
+        return matcher->match(view, start_offset, regex_options);
+    }
+
     String replace(const RegexStringView view, const StringView& replacement_pattern, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {}) const
     {
         if (!matcher || parser_result.error != Error::NoError)
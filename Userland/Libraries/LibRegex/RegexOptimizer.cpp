@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexByteCode.h"
+#include <AK/Debug.h>
+
+namespace regex {
+
+namespace {
+
+struct Instruction {
+    size_t old_position { 0 };
+    // Empty once the instruction has been optimized away, jumps to it then end up at the next one.
+    Vector<ByteCodeValueType> code;
+    // For Jump, ForkJump and ForkStay: the old position of the instruction they jump to.
+    Optional<size_t> target;
+    size_t incoming_jumps { 0 };
+
+    bool is_removed() const { return code.is_empty(); }
+    OpCodeId opcode_id() const { return (OpCodeId)code[0]; }
+};
+
+class Optimizer {
+public:
+    explicit Optimizer(const ByteCode& bytecode)
+        : m_old_size(bytecode.size())
+    {
+        MatchState state;
+        while (state.instruction_position < bytecode.size()) {
+            auto ip = state.instruction_position;
+            auto size = bytecode.get_opcode(state)->size();
+
+            Instruction instruction;
+            instruction.old_position = ip;
+            instruction.code.append(bytecode.data() + ip, size);
+            auto id = instruction.opcode_id();
+            if (id == OpCodeId::Jump || id == OpCodeId::ForkJump || id == OpCodeId::ForkStay)
+                instruction.target = ip + size + (ssize_t)bytecode[ip + 1];
+            m_instructions.append(move(instruction));
+
+            state.instruction_position += size;
+        }
+    }
+
+    void run()
+    {
+        for (;;) {
+            count_incoming_jumps();
+            // Collapsing an alternation can make its parent collapsible too, so keep going until nothing changes.
+            if (collapse_single_character_alternations())
+                continue;
+            if (merge_literal_runs())
+                continue;
+            if (remove_empty_jumps())
+                continue;
+            break;
+        }
+    }
+
+    ByteCode assemble() const
+    {
+        // Removed instructions take up no space, so they end up at the position of whatever follows them.
+        HashMap<size_t, size_t> new_positions;
+        size_t new_size = 0;
+        for (auto& instruction : m_instructions) {
+            new_positions.set(instruction.old_position, new_size);
+            new_size += instruction.code.size();
+        }
+        new_positions.set(m_old_size, new_size);
+
+        ByteCode bytecode;
+        bytecode.ensure_capacity(new_size);
+        for (auto& instruction : m_instructions) {
+            if (instruction.is_removed())
+                continue;
+            auto position = bytecode.size();
+            bytecode.append(instruction.code.data(), instruction.code.size());
+            if (instruction.target.has_value())
+                bytecode[position + 1] = static_cast<ByteCodeValueType>((ssize_t)new_positions.get(*instruction.target).value() - (ssize_t)(position + instruction.code.size()));
+        }
+        return bytecode;
+    }
+
+private:
+    void count_incoming_jumps()
+    {
+        HashMap<size_t, size_t> index_of_position;
+        for (size_t i = 0; i < m_instructions.size(); ++i) {
+            m_instructions[i].incoming_jumps = 0;
+            index_of_position.set(m_instructions[i].old_position, i);
+        }
+        for (auto& instruction : m_instructions) {
+            if (!instruction.target.has_value())
+                continue;
+            if (auto index = index_of_position.get(*instruction.target); index.has_value())
+                ++m_instructions[*index].incoming_jumps;
+        }
+    }
+
+    // The indices of the next `count` instructions that are still there, starting at `index`.
+    Optional<Vector<size_t, 4>> live_instructions(size_t index, size_t count) const
+    {
+        Vector<size_t, 4> indices;
+        for (; index < m_instructions.size() && indices.size() < count; ++index) {
+            if (!m_instructions[index].is_removed())
+                indices.append(index);
+        }
+        if (indices.size() < count)
+            return {};
+        return indices;
+    }
+
+    // Where the first instruction at or after `index` that's still there started out.
+    size_t next_live_position(size_t index) const
+    {
+        auto next = live_instructions(index, 1);
+        return next.has_value() ? m_instructions[(*next)[0]].old_position : m_old_size;
+    }
+
+    // A Compare that consumes exactly one character if any of its arguments match it.
+    static bool is_single_character_compare(const Instruction& instruction)
+    {
+        if (instruction.opcode_id() != OpCodeId::Compare)
+            return false;
+        auto& code = instruction.code;
+        size_t offset = 3;
+        for (size_t i = 0; i < code[1]; ++i) {
+            auto type = (CharacterCompareType)code[offset++];
+            if (type != CharacterCompareType::Char && type != CharacterCompareType::CharClass && type != CharacterCompareType::CharRange)
+                return false;
+            ++offset;
+        }
+        return code[1] > 0;
+    }
+
+    // FORKJUMP _ALT; COMPARE b; JUMP _END; _ALT: COMPARE a; _END:
+    // Both alternatives consume one character and then carry on in the same place, so which one is tried first
+    // doesn't matter; this becomes COMPARE a, b.
+    bool collapse_single_character_alternations()
+    {
+        bool changed = false;
+        for (size_t i = 0; i < m_instructions.size(); ++i) {
+            auto& fork = m_instructions[i];
+            if (fork.is_removed() || fork.opcode_id() != OpCodeId::ForkJump)
+                continue;
+            auto indices = live_instructions(i + 1, 3);
+            if (!indices.has_value())
+                continue;
+            auto& right = m_instructions[(*indices)[0]];
+            auto& jump = m_instructions[(*indices)[1]];
+            auto& left = m_instructions[(*indices)[2]];
+            if (!is_single_character_compare(right) || !is_single_character_compare(left))
+                continue;
+            if (jump.opcode_id() != OpCodeId::Jump || *jump.target != next_live_position((*indices)[2] + 1) || *fork.target != left.old_position)
+                continue;
+            if (right.incoming_jumps != 0 || jump.incoming_jumps != 0 || left.incoming_jumps != 1)
+                continue;
+
+            Vector<ByteCodeValueType> code;
+            code.append((ByteCodeValueType)OpCodeId::Compare);
+            code.append(left.code[1] + right.code[1]);
+            code.append(left.code[2] + right.code[2]);
+            code.append(left.code.data() + 3, left.code.size() - 3);
+            code.append(right.code.data() + 3, right.code.size() - 3);
+
+            fork.code = move(code);
+            fork.target.clear();
+            right.code.clear();
+            jump.code.clear();
+            jump.target.clear();
+            left.code.clear();
+            changed = true;
+        }
+        return changed;
+    }
+
+    // The characters a Compare matches literally, if that's all it does.
+    static Optional<Vector<ByteCodeValueType>> literal_characters(const Instruction& instruction)
+    {
+        auto& code = instruction.code;
+        if (instruction.opcode_id() != OpCodeId::Compare || code[1] != 1)
+            return {};
+        auto type = (CharacterCompareType)code[3];
+        if (type == CharacterCompareType::Char) {
+            // Strings are compared byte by byte, which is only the same thing for ASCII.
+            if (code[4] >= 128)
+                return {};
+            return Vector<ByteCodeValueType> { code[4] };
+        }
+        if (type == CharacterCompareType::String && code[4] > 0) {
+            Vector<ByteCodeValueType> characters;
+            characters.append(code.data() + 5, code[4]);
+            return characters;
+        }
+        return {};
+    }
+
+    // COMPARE 'f'; COMPARE 'o'; COMPARE 'o' becomes COMPARE "foo".
+    bool merge_literal_runs()
+    {
+        bool changed = false;
+        for (size_t i = 0; i < m_instructions.size(); ++i) {
+            if (m_instructions[i].is_removed())
+                continue;
+            auto characters = literal_characters(m_instructions[i]);
+            if (!characters.has_value())
+                continue;
+
+            Vector<size_t> merged;
+            for (size_t j = i + 1; j < m_instructions.size(); ++j) {
+                auto& next = m_instructions[j];
+                if (next.is_removed())
+                    continue;
+                if (next.incoming_jumps != 0)
+                    break;
+                auto next_characters = literal_characters(next);
+                if (!next_characters.has_value())
+                    break;
+                characters->append(next_characters->data(), next_characters->size());
+                merged.append(j);
+            }
+            if (merged.is_empty())
+                continue;
+
+            Vector<ByteCodeValueType> code;
+            code.append((ByteCodeValueType)OpCodeId::Compare);
+            code.append(1);
+            code.append(characters->size() + 2);
+            code.append((ByteCodeValueType)CharacterCompareType::String);
+            code.append(characters->size());
+            code.append(characters->data(), characters->size());
+            m_instructions[i].code = move(code);
+            for (auto index : merged)
+                m_instructions[index].code.clear();
+            changed = true;
+        }
+        return changed;
+    }
+
+    // Jumps to the next instruction, which an empty alternative leaves behind.
+    bool remove_empty_jumps()
+    {
+        bool changed = false;
+        for (size_t i = 0; i < m_instructions.size(); ++i) {
+            auto& jump = m_instructions[i];
+            if (jump.is_removed() || jump.opcode_id() != OpCodeId::Jump)
+                continue;
+            if (*jump.target != next_live_position(i + 1))
+                continue;
+            jump.code.clear();
+            jump.target.clear();
+            changed = true;
+        }
+        return changed;
+    }
+
+    size_t m_old_size { 0 };
+    Vector<Instruction> m_instructions;
+};
+
+}
+
+void ByteCode::optimize()
+{
+    Optimizer optimizer(*this);
+    optimizer.run();
+    auto optimized = optimizer.assemble();
+    dbgln_if(REGEX_DEBUG, "[OPTIMIZER] Went from {} to {} entries", size(), optimized.size());
+    *this = move(optimized);
+}
+
+}
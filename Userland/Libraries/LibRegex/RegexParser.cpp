@@ -149,13 +149,24 @@ Parser::Result Parser::parse(Optional<AllOptions> regex_options)
         set_error(Error::InvalidPattern);
 
     dbgln_if(REGEX_DEBUG, "[PARSER] Produced bytecode with {} entries (opcodes + arguments)", m_parser_state.bytecode.size());
+
+    Optional<StartingCharacters> starting_characters;
+    bool needs_backtracking = true;
+    if (m_parser_state.error == Error::NoError) {
+        m_parser_state.bytecode.optimize();
+        starting_characters = m_parser_state.bytecode.starting_characters();
+        needs_backtracking = m_parser_state.bytecode.needs_backtracking();
+    }
+
     return {
         move(m_parser_state.bytecode),
         move(m_parser_state.capture_groups_count),
         move(m_parser_state.named_capture_groups_count),
         move(m_parser_state.match_length_minimum),
         move(m_parser_state.error),
-        move(m_parser_state.error_token)
+        move(m_parser_state.error_token),
+        move(starting_characters),
+        needs_backtracking
     };
 }
 
@@ -47,6 +47,8 @@ public:
         size_t match_length_minimum;
         Error error;
         Token error_token;
+        Optional<StartingCharacters> starting_characters;
+        bool needs_backtracking { true };
     };
 
     explicit Parser(Lexer& lexer)
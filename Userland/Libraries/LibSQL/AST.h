@@ -488,6 +488,23 @@ private:
     BinaryOperator m_type;
 };
 
+class FunctionCallExpression : public Expression {
+public:
+    // An argument of * (as in "COUNT(*)") is no arguments.
+    FunctionCallExpression(String name, NonnullRefPtrVector<Expression> arguments)
+        : m_name(move(name))
+        , m_arguments(move(arguments))
+    {
+    }
+
+    const String& name() const { return m_name; }
+    const NonnullRefPtrVector<Expression>& arguments() const { return m_arguments; }
+
+private:
+    String m_name;
+    NonnullRefPtrVector<Expression> m_arguments;
+};
+
 class ChainedExpression : public Expression {
 public:
     explicit ChainedExpression(NonnullRefPtrVector<Expression> expressions)
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Function.h>
+#include <LibSQL/BTree.h>
+#include <string.h>
+
+namespace SQL {
+
+// A node is a slotted page: a header, then an array of the offsets of the cells, in key order,
+// and the cells themselves at the end of the page, growing towards the offsets.
+//
+// Header (all integers are little-endian):
+//  0: kind (u8)
+//  2: number of cells (u16)
+//  4: offset of the lowest cell (u16)
+//  8: link (u32): the next leaf in a leaf, the rightmost child in an interior node
+//
+// A leaf cell is the key size (u16), the value size (u16), the key and the value.
+// An interior cell is the child (u32), the key size (u16) and the key: all keys in that child
+// are less than the cell's key, and not less than the key of the cell before it.
+static constexpr size_t node_header_size = 12;
+
+enum class NodeKind : u8 {
+    Leaf = 1,
+    Interior = 2,
+};
+
+static u16 load_u16(const u8* data) { return AK::convert_between_host_and_little_endian(ByteReader::load16(data)); }
+static u32 load_u32(const u8* data) { return AK::convert_between_host_and_little_endian(ByteReader::load32(data)); }
+static void store_u16(u8* data, u16 value) { ByteReader::store(data, AK::convert_between_host_and_little_endian(value)); }
+static void store_u32(u8* data, u32 value) { ByteReader::store(data, AK::convert_between_host_and_little_endian(value)); }
+
+static int compare_keys(ReadonlyBytes a, ReadonlyBytes b)
+{
+    if (auto result = memcmp(a.data(), b.data(), min(a.size(), b.size())); result != 0)
+        return result;
+    if (a.size() == b.size())
+        return 0;
+    return a.size() < b.size() ? -1 : 1;
+}
+
+static ByteBuffer make_leaf_cell(ReadonlyBytes key, ReadonlyBytes value)
+{
+    auto cell = ByteBuffer::create_uninitialized(4 + key.size() + value.size());
+    store_u16(cell.data(), key.size());
+    store_u16(cell.data() + 2, value.size());
+    memcpy(cell.data() + 4, key.data(), key.size());
+    memcpy(cell.data() + 4 + key.size(), value.data(), value.size());
+    return cell;
+}
+
+static ByteBuffer make_interior_cell(u32 child, ReadonlyBytes key)
+{
+    auto cell = ByteBuffer::create_uninitialized(6 + key.size());
+    store_u32(cell.data(), child);
+    store_u16(cell.data() + 4, key.size());
+    memcpy(cell.data() + 6, key.data(), key.size());
+    return cell;
+}
+
+static ReadonlyBytes leaf_cell_key(ReadonlyBytes cell) { return cell.slice(4, load_u16(cell.data())); }
+static ReadonlyBytes interior_cell_key(ReadonlyBytes cell) { return cell.slice(6, load_u16(cell.data() + 4)); }
+static u32 interior_cell_child(ReadonlyBytes cell) { return load_u32(cell.data()); }
+
+class Node {
+public:
+    explicit Node(Page& page)
+        : m_page(page)
+        , m_data(page.data().data())
+    {
+    }
+
+    // Only for reading: nothing that changes the node may be called on one made like this.
+    explicit Node(const Page& page)
+        : Node(const_cast<Page&>(page))
+    {
+    }
+
+    // A page that was never written to is an empty leaf.
+    bool is_leaf() const { return m_data[0] != (u8)NodeKind::Interior; }
+
+    size_t cell_count() const { return load_u16(m_data + 2); }
+
+    u32 link() const { return load_u32(m_data + 8); }
+    void set_link(u32 link)
+    {
+        store_u32(m_data + 8, link);
+        m_page.set_dirty();
+    }
+
+    void initialize(NodeKind kind)
+    {
+        memset(m_data, 0, node_header_size);
+        m_data[0] = (u8)kind;
+        set_content_start(Heap::page_size);
+        m_page.set_dirty();
+    }
+
+    ReadonlyBytes cell(size_t index) const
+    {
+        auto offset = slot(index);
+        return { m_data + offset, cell_size_at(offset) };
+    }
+
+    ReadonlyBytes key(size_t index) const { return is_leaf() ? leaf_cell_key(cell(index)) : interior_cell_key(cell(index)); }
+
+    ReadonlyBytes value(size_t index) const
+    {
+        VERIFY(is_leaf());
+        auto cell = this->cell(index);
+        auto key_size = load_u16(cell.data());
+        return cell.slice(4 + key_size, load_u16(cell.data() + 2));
+    }
+
+    u32 child(size_t index) const
+    {
+        VERIFY(!is_leaf());
+        if (index == cell_count())
+            return link();
+        return interior_cell_child(cell(index));
+    }
+
+    void set_child(size_t index, u32 child)
+    {
+        VERIFY(!is_leaf());
+        if (index == cell_count())
+            return set_link(child);
+        store_u32(m_data + slot(index), child);
+        m_page.set_dirty();
+    }
+
+    // The first cell whose key is not less than (or for upper_bound(), greater than) the given one.
+    size_t lower_bound(ReadonlyBytes key) const
+    {
+        return bound(key, [](int comparison) { return comparison < 0; });
+    }
+
+    size_t upper_bound(ReadonlyBytes key) const
+    {
+        return bound(key, [](int comparison) { return comparison <= 0; });
+    }
+
+    bool insert(size_t index, ReadonlyBytes cell)
+    {
+        auto count = cell_count();
+        VERIFY(index <= count);
+        auto needed = cell.size() + 2;
+        if (needed > contiguous_free_space()) {
+            if (needed > total_free_space())
+                return false;
+            defragment();
+        }
+
+        auto offset = content_start() - cell.size();
+        memcpy(m_data + offset, cell.data(), cell.size());
+        set_content_start(offset);
+
+        auto* slots = m_data + node_header_size;
+        memmove(slots + (index + 1) * 2, slots + index * 2, (count - index) * 2);
+        store_u16(slots + index * 2, offset);
+        store_u16(m_data + 2, count + 1);
+        m_page.set_dirty();
+        return true;
+    }
+
+    // The space of the cell is reclaimed by the next defragment().
+    void remove(size_t index)
+    {
+        auto count = cell_count();
+        VERIFY(index < count);
+        auto* slots = m_data + node_header_size;
+        memmove(slots + index * 2, slots + (index + 1) * 2, (count - index - 1) * 2);
+        store_u16(m_data + 2, count - 1);
+        m_page.set_dirty();
+    }
+
+    // Replaces the contents of the node with the cells [begin, end). They have to fit.
+    void rebuild(NodeKind kind, const Vector<ByteBuffer>& cells, size_t begin, size_t end)
+    {
+        auto link = this->link();
+        initialize(kind);
+        store_u32(m_data + 8, link);
+        for (size_t i = begin; i < end; ++i) {
+            auto inserted = insert(i - begin, cells[i]);
+            VERIFY(inserted);
+        }
+    }
+
+    static size_t capacity() { return Heap::page_size - node_header_size; }
+
+private:
+    template<typename Callback>
+    size_t bound(ReadonlyBytes key, Callback is_before) const
+    {
+        size_t low = 0;
+        size_t high = cell_count();
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            if (is_before(compare_keys(this->key(middle), key)))
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    u16 slot(size_t index) const
+    {
+        VERIFY(index < cell_count());
+        return load_u16(m_data + node_header_size + index * 2);
+    }
+
+    size_t cell_size_at(size_t offset) const
+    {
+        if (is_leaf())
+            return 4 + load_u16(m_data + offset) + load_u16(m_data + offset + 2);
+        return 6 + load_u16(m_data + offset + 4);
+    }
+
+    size_t content_start() const { return load_u16(m_data + 4) == 0 ? Heap::page_size : load_u16(m_data + 4); }
+    void set_content_start(size_t offset) { store_u16(m_data + 4, offset == Heap::page_size ? 0 : offset); }
+
+    size_t contiguous_free_space() const { return content_start() - node_header_size - cell_count() * 2; }
+
+    size_t total_free_space() const
+    {
+        size_t used = 0;
+        for (size_t i = 0; i < cell_count(); ++i)
+            used += cell(i).size() + 2;
+        return capacity() - used;
+    }
+
+    void defragment()
+    {
+        u8 cells[Heap::page_size];
+        auto offset = Heap::page_size;
+        for (size_t i = 0; i < cell_count(); ++i) {
+            auto cell = this->cell(i);
+            offset -= cell.size();
+            memcpy(cells + offset, cell.data(), cell.size());
+            store_u16(m_data + node_header_size + i * 2, offset);
+        }
+        memcpy(m_data + offset, cells + offset, Heap::page_size - offset);
+        set_content_start(offset);
+        m_page.set_dirty();
+    }
+
+    Page& m_page;
+    u8* m_data { nullptr };
+};
+
+// Where to split cells into two nodes so that both get about as many bytes.
+static size_t split_point(const Vector<ByteBuffer>& cells, size_t min_index, size_t max_index)
+{
+    size_t total = 0;
+    for (auto& cell : cells)
+        total += cell.size() + 2;
+
+    size_t left = 0;
+    size_t index = 0;
+    while (index < cells.size() && left + cells[index].size() + 2 <= total / 2) {
+        left += cells[index].size() + 2;
+        ++index;
+    }
+    return clamp(index, min_index, max_index);
+}
+
+u32 BTree::create(BufferPool& pool)
+{
+    auto root = pool.allocate_page();
+    Node(*root).initialize(NodeKind::Leaf);
+    return root->index();
+}
+
+BTree::BTree(BufferPool& pool, u32 root_page)
+    : m_pool(pool)
+    , m_root_page(root_page)
+{
+}
+
+Vector<BTree::PathEntry> BTree::find_leaf(ReadonlyBytes key)
+{
+    Vector<PathEntry> path;
+    auto page = m_pool.get_page(m_root_page);
+    for (;;) {
+        Node node(*page);
+        if (node.is_leaf()) {
+            path.append({ move(page), 0 });
+            return path;
+        }
+        auto index = node.upper_bound(key);
+        auto child = node.child(index);
+        path.append({ move(page), index });
+        page = m_pool.get_page(child);
+    }
+}
+
+Optional<ByteBuffer> BTree::find(ReadonlyBytes key)
+{
+    auto path = find_leaf(key);
+    Node leaf(*path.last().page);
+    auto index = leaf.lower_bound(key);
+    if (index == leaf.cell_count() || compare_keys(leaf.key(index), key) != 0)
+        return {};
+    return ByteBuffer::copy(leaf.value(index));
+}
+
+bool BTree::insert(ReadonlyBytes key, ReadonlyBytes value)
+{
+    VERIFY(key.size() + value.size() <= max_entry_size);
+
+    auto path = find_leaf(key);
+    Node leaf(*path.last().page);
+    auto index = leaf.lower_bound(key);
+    if (index < leaf.cell_count() && compare_keys(leaf.key(index), key) == 0)
+        return false;
+
+    insert_cell(path, path.size() - 1, index, make_leaf_cell(key, value));
+    return true;
+}
+
+bool BTree::update(ReadonlyBytes key, ReadonlyBytes value)
+{
+    if (!remove(key))
+        return false;
+    auto inserted = insert(key, value);
+    VERIFY(inserted);
+    return true;
+}
+
+bool BTree::remove(ReadonlyBytes key)
+{
+    auto path = find_leaf(key);
+    Node leaf(*path.last().page);
+    auto index = leaf.lower_bound(key);
+    if (index == leaf.cell_count() || compare_keys(leaf.key(index), key) != 0)
+        return false;
+    leaf.remove(index);
+    return true;
+}
+
+void BTree::insert_cell(Vector<PathEntry>& path, size_t depth, size_t index, ReadonlyBytes cell)
+{
+    if (Node(*path[depth].page).insert(index, cell))
+        return;
+
+    if (depth == 0) {
+        // The root keeps its page: move what it has to a new child, and split that instead.
+        auto child = m_pool.allocate_page();
+        child->data().overwrite(0, path[0].page->data().data(), Heap::page_size);
+        Node root(*path[0].page);
+        root.initialize(NodeKind::Interior);
+        root.set_link(child->index());
+        path[0].child_index = 0;
+        path.insert(1, { move(child), index });
+        depth = 1;
+    }
+
+    auto& page = *path[depth].page;
+    Node node(page);
+    auto is_leaf = node.is_leaf();
+    auto kind = is_leaf ? NodeKind::Leaf : NodeKind::Interior;
+
+    Vector<ByteBuffer> cells;
+    cells.ensure_capacity(node.cell_count() + 1);
+    for (size_t i = 0; i < node.cell_count(); ++i)
+        cells.append(ByteBuffer::copy(node.cell(i)));
+    cells.insert(index, ByteBuffer::copy(cell));
+
+    auto right_page = m_pool.allocate_page();
+    Node right(*right_page);
+    auto old_link = node.link();
+    ByteBuffer separator;
+
+    if (is_leaf) {
+        // The first key of the right leaf is copied up; leaves are linked in key order.
+        auto middle = split_point(cells, 1, cells.size() - 1);
+        node.rebuild(kind, cells, 0, middle);
+        node.set_link(right_page->index());
+        right.rebuild(kind, cells, middle, cells.size());
+        right.set_link(old_link);
+        separator = ByteBuffer::copy(leaf_cell_key(cells[middle]));
+    } else {
+        // The middle key moves up, and its child becomes the rightmost child of the left node.
+        auto middle = split_point(cells, 1, cells.size() - 2);
+        node.rebuild(kind, cells, 0, middle);
+        node.set_link(interior_cell_child(cells[middle]));
+        right.rebuild(kind, cells, middle + 1, cells.size());
+        right.set_link(old_link);
+        separator = ByteBuffer::copy(interior_cell_key(cells[middle]));
+    }
+
+    // The parent pointed to this node for all its keys; now it points to the right node for the ones after the separator.
+    auto parent_index = path[depth - 1].child_index;
+    Node(*path[depth - 1].page).set_child(parent_index, right_page->index());
+    insert_cell(path, depth - 1, parent_index, make_interior_cell(page.index(), separator));
+}
+
+BTree::Iterator BTree::begin()
+{
+    auto page = m_pool.get_page(m_root_page);
+    while (!Node(*page).is_leaf())
+        page = m_pool.get_page(Node(*page).child(0));
+    return Iterator(m_pool, move(page), 0);
+}
+
+BTree::Iterator BTree::lower_bound(ReadonlyBytes key)
+{
+    auto path = find_leaf(key);
+    auto index = Node(*path.last().page).lower_bound(key);
+    return Iterator(m_pool, path.last().page, index);
+}
+
+Optional<ByteBuffer> BTree::last_key()
+{
+    // Leaves can be empty after removals, so this may have to look further left than the rightmost one.
+    Function<Optional<ByteBuffer>(u32)> last_key_in = [&](u32 page_index) -> Optional<ByteBuffer> {
+        auto page = m_pool.get_page(page_index);
+        Node node(*page);
+        if (node.is_leaf()) {
+            if (node.cell_count() == 0)
+                return {};
+            return ByteBuffer::copy(node.key(node.cell_count() - 1));
+        }
+        for (ssize_t i = node.cell_count(); i >= 0; --i) {
+            if (auto key = last_key_in(node.child(i)); key.has_value())
+                return key;
+        }
+        return {};
+    };
+    return last_key_in(m_root_page);
+}
+
+void BTree::destroy()
+{
+    destroy_subtree(m_root_page);
+    m_root_page = 0;
+}
+
+void BTree::destroy_subtree(u32 page_index)
+{
+    Vector<u32> children;
+    {
+        auto page = m_pool.get_page(page_index);
+        Node node(*page);
+        if (!node.is_leaf()) {
+            for (size_t i = 0; i <= node.cell_count(); ++i)
+                children.append(node.child(i));
+        }
+    }
+    for (auto child : children)
+        destroy_subtree(child);
+    m_pool.free_page(page_index);
+}
+
+BTree::Iterator::Iterator(BufferPool& pool, RefPtr<Page> page, size_t index)
+    : m_pool(&pool)
+    , m_page(move(page))
+    , m_index(index)
+{
+    skip_empty_leaves();
+}
+
+ReadonlyBytes BTree::Iterator::key() const
+{
+    return Node(*m_page).key(m_index);
+}
+
+ReadonlyBytes BTree::Iterator::value() const
+{
+    return Node(*m_page).value(m_index);
+}
+
+BTree::Iterator& BTree::Iterator::operator++()
+{
+    ++m_index;
+    skip_empty_leaves();
+    return *this;
+}
+
+void BTree::Iterator::skip_empty_leaves()
+{
+    while (m_page && m_index >= Node(*m_page).cell_count()) {
+        auto next = Node(*m_page).link();
+        if (next)
+            m_page = m_pool->get_page(next);
+        else
+            m_page = nullptr;
+        m_index = 0;
+    }
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibSQL/BufferPool.h>
+
+namespace SQL {
+
+// A B+tree of byte string keys (ordered like memcmp() orders them) and values, in the pages of a
+// buffer pool. Tables are trees keyed by row ID, and indexes are trees keyed by the indexed values,
+// so these have to be encoded in a way that sorts correctly (e.g. big-endian integers).
+//
+// All entries are in the leaves, which are linked together for scans. The root stays on the same
+// page as the tree grows, so that page identifies the tree. Removing entries doesn't merge nodes:
+// a page that becomes empty stays in the tree until the tree is destroyed.
+class BTree {
+public:
+    // An entry has to fit in a quarter of a page.
+    static constexpr size_t max_entry_size = 1000;
+
+    class Iterator {
+    public:
+        bool is_end() const { return m_page.is_null(); }
+        ReadonlyBytes key() const;
+        ReadonlyBytes value() const;
+        Iterator& operator++();
+
+    private:
+        friend class BTree;
+        Iterator(BufferPool&, RefPtr<Page>, size_t index);
+        void skip_empty_leaves();
+
+        BufferPool* m_pool { nullptr };
+        RefPtr<Page> m_page;
+        size_t m_index { 0 };
+    };
+
+    // Makes an empty tree, and returns its root page.
+    static u32 create(BufferPool&);
+
+    BTree(BufferPool&, u32 root_page);
+
+    u32 root_page() const { return m_root_page; }
+
+    Optional<ByteBuffer> find(ReadonlyBytes key);
+
+    // These return false if the key is already (or isn't) in the tree.
+    bool insert(ReadonlyBytes key, ReadonlyBytes value);
+    bool update(ReadonlyBytes key, ReadonlyBytes value);
+    bool remove(ReadonlyBytes key);
+
+    Iterator begin();
+    // The first entry whose key is not less than the given one.
+    Iterator lower_bound(ReadonlyBytes key);
+    Optional<ByteBuffer> last_key();
+
+    // Frees all the pages of the tree, including the root.
+    void destroy();
+
+private:
+    struct PathEntry {
+        NonnullRefPtr<Page> page;
+        size_t child_index { 0 };
+    };
+
+    Vector<PathEntry> find_leaf(ReadonlyBytes key);
+    void insert_cell(Vector<PathEntry>& path, size_t depth, size_t index, ReadonlyBytes cell);
+    void destroy_subtree(u32 page_index);
+
+    BufferPool& m_pool;
+    u32 m_root_page { 0 };
+};
+
+}
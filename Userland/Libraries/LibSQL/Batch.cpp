@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/Batch.h>
+#include <string.h>
+
+namespace SQL {
+
+Value ColumnVector::value(size_t row) const
+{
+    if (m_nulls[row])
+        return {};
+    switch (m_type) {
+    case ValueType::Null:
+        return {};
+    case ValueType::Integer:
+        return Value(m_integers[row]);
+    case ValueType::Real:
+        return Value(m_reals[row]);
+    case ValueType::Text:
+        return Value(m_texts[row]);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+double ColumnVector::real_at(size_t row) const
+{
+    switch (m_type) {
+    case ValueType::Integer:
+        return (double)m_integers[row];
+    case ValueType::Real:
+        return m_reals[row];
+    default:
+        return value(row).to_real();
+    }
+}
+
+i64 ColumnVector::integer_at(size_t row) const
+{
+    switch (m_type) {
+    case ValueType::Integer:
+        return m_integers[row];
+    case ValueType::Real:
+        return (i64)m_reals[row];
+    default:
+        return value(row).to_integer();
+    }
+}
+
+void ColumnVector::ensure_capacity(size_t capacity)
+{
+    m_nulls.ensure_capacity(capacity);
+    switch (m_type) {
+    case ValueType::Null:
+        break;
+    case ValueType::Integer:
+        m_integers.ensure_capacity(capacity);
+        break;
+    case ValueType::Real:
+        m_reals.ensure_capacity(capacity);
+        break;
+    case ValueType::Text:
+        m_texts.ensure_capacity(capacity);
+        break;
+    }
+}
+
+void ColumnVector::append_null()
+{
+    m_nulls.append(true);
+    switch (m_type) {
+    case ValueType::Null:
+        break;
+    case ValueType::Integer:
+        m_integers.append(0);
+        break;
+    case ValueType::Real:
+        m_reals.append(0);
+        break;
+    case ValueType::Text:
+        m_texts.append(String());
+        break;
+    }
+}
+
+void ColumnVector::append_integer(i64 integer)
+{
+    VERIFY(m_type == ValueType::Integer);
+    m_nulls.append(false);
+    m_integers.append(integer);
+}
+
+void ColumnVector::append_real(double real)
+{
+    VERIFY(m_type == ValueType::Real);
+    m_nulls.append(false);
+    m_reals.append(real);
+}
+
+void ColumnVector::append_text(String text)
+{
+    VERIFY(m_type == ValueType::Text);
+    m_nulls.append(false);
+    m_texts.append(move(text));
+}
+
+void ColumnVector::append(const Value& value)
+{
+    switch (value.type()) {
+    case ValueType::Null:
+        return append_null();
+    case ValueType::Integer:
+        return append_integer(value.integer());
+    case ValueType::Real:
+        return append_real(value.real());
+    case ValueType::Text:
+        return append_text(value.text());
+    }
+}
+
+void ColumnVector::append_from(const ColumnVector& other, size_t row)
+{
+    VERIFY(m_type == other.m_type);
+    m_nulls.append(other.m_nulls[row]);
+    switch (m_type) {
+    case ValueType::Null:
+        break;
+    case ValueType::Integer:
+        m_integers.append(other.m_integers[row]);
+        break;
+    case ValueType::Real:
+        m_reals.append(other.m_reals[row]);
+        break;
+    case ValueType::Text:
+        m_texts.append(other.m_texts[row]);
+        break;
+    }
+}
+
+void ColumnVector::extend(const ColumnVector& other)
+{
+    VERIFY(m_type == other.m_type);
+    m_nulls.append(other.m_nulls);
+    m_integers.append(other.m_integers);
+    m_reals.append(other.m_reals);
+    m_texts.append(other.m_texts);
+}
+
+ColumnVector ColumnVector::gather(const Vector<u32>& rows) const
+{
+    ColumnVector result(m_type);
+    result.m_nulls.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        result.m_nulls[i] = m_nulls[rows[i]];
+
+    switch (m_type) {
+    case ValueType::Null:
+        break;
+    case ValueType::Integer:
+        result.m_integers.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i)
+            result.m_integers[i] = m_integers[rows[i]];
+        break;
+    case ValueType::Real:
+        result.m_reals.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i)
+            result.m_reals[i] = m_reals[rows[i]];
+        break;
+    case ValueType::Text:
+        result.m_texts.ensure_capacity(rows.size());
+        for (auto row : rows)
+            result.m_texts.unchecked_append(m_texts[row]);
+        break;
+    }
+    return result;
+}
+
+int ColumnVector::compare_rows(size_t a, const ColumnVector& other, size_t b) const
+{
+    bool a_is_null = m_nulls[a];
+    bool b_is_null = other.m_nulls[b];
+    if (a_is_null || b_is_null)
+        return (int)b_is_null - (int)a_is_null;
+
+    if (m_type == other.m_type) {
+        switch (m_type) {
+        case ValueType::Null:
+            return 0;
+        case ValueType::Integer:
+            return m_integers[a] < other.m_integers[b] ? -1 : (m_integers[a] > other.m_integers[b] ? 1 : 0);
+        case ValueType::Real:
+            return m_reals[a] < other.m_reals[b] ? -1 : (m_reals[a] > other.m_reals[b] ? 1 : 0);
+        case ValueType::Text:
+            return strcmp(m_texts[a].characters(), other.m_texts[b].characters());
+        }
+    }
+    return value(a).compare(other.value(b));
+}
+
+Batch Batch::gather(const Vector<u32>& rows) const
+{
+    Batch result;
+    result.row_count = rows.size();
+    result.columns.ensure_capacity(columns.size());
+    for (auto& column : columns)
+        result.columns.unchecked_append(column.gather(rows));
+    return result;
+}
+
+void Batch::extend(const Batch& other)
+{
+    if (columns.is_empty() && row_count == 0) {
+        *this = other;
+        return;
+    }
+    VERIFY(columns.size() == other.columns.size());
+    for (size_t i = 0; i < columns.size(); ++i)
+        columns[i].extend(other.columns[i]);
+    row_count += other.row_count;
+}
+
+}
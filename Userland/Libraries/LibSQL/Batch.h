@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+// The values of one column for a batch of rows. All the values that aren't NULL have the type of
+// the column, and are stored in the array for that type; a NULL has a placeholder there, so that
+// the values of row i are always at index i.
+class ColumnVector {
+public:
+    explicit ColumnVector(ValueType type = ValueType::Null)
+        : m_type(type)
+    {
+    }
+
+    ValueType type() const { return m_type; }
+    size_t size() const { return m_nulls.size(); }
+
+    bool is_null(size_t row) const { return m_nulls[row]; }
+    i64 integer(size_t row) const { return m_integers[row]; }
+    double real(size_t row) const { return m_reals[row]; }
+    const String& text(size_t row) const { return m_texts[row]; }
+    Value value(size_t row) const;
+
+    // Numbers converted like SQL operators convert them.
+    double real_at(size_t row) const;
+    i64 integer_at(size_t row) const;
+
+    const Vector<u8>& nulls() const { return m_nulls; }
+    const Vector<i64>& integers() const { return m_integers; }
+    const Vector<double>& reals() const { return m_reals; }
+
+    void ensure_capacity(size_t);
+    void append_null();
+    void append_integer(i64);
+    void append_real(double);
+    void append_text(String);
+    // The value has to be NULL, or have the type of the column.
+    void append(const Value&);
+    void append_from(const ColumnVector&, size_t row);
+    void extend(const ColumnVector&);
+
+    ColumnVector gather(const Vector<u32>& rows) const;
+
+    // Compares two rows like Value::compare() would.
+    int compare_rows(size_t a, const ColumnVector& other, size_t b) const;
+
+private:
+    ValueType m_type { ValueType::Null };
+    Vector<u8> m_nulls;
+    Vector<i64> m_integers;
+    Vector<double> m_reals;
+    Vector<String> m_texts;
+};
+
+// A set of rows, column by column. Operators pass rows to each other in batches of about
+// batch_size rows, so that evaluating an expression is a loop over arrays of values.
+struct Batch {
+    static constexpr size_t batch_size = 1024;
+
+    Vector<ColumnVector> columns;
+    size_t row_count { 0 };
+
+    Batch gather(const Vector<u32>& rows) const;
+    void extend(const Batch&);
+};
+
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/BoundExpression.h>
+
+namespace SQL {
+
+NonnullOwnPtr<BoundExpression> BoundExpression::create_column(size_t index, ValueType type)
+{
+    auto expression = adopt_own(*new BoundExpression(Kind::Column, type));
+    expression->m_column_index = index;
+    return expression;
+}
+
+NonnullOwnPtr<BoundExpression> BoundExpression::create_literal(Value value)
+{
+    auto expression = adopt_own(*new BoundExpression(Kind::Literal, value.type()));
+    expression->m_literal = move(value);
+    return expression;
+}
+
+NonnullOwnPtr<BoundExpression> BoundExpression::create_unary(UnaryOperator op, NonnullOwnPtr<BoundExpression> operand)
+{
+    auto type = operand->type();
+    if (type != ValueType::Null) {
+        switch (op) {
+        case UnaryOperator::Minus:
+            if (type == ValueType::Text)
+                type = ValueType::Real;
+            break;
+        case UnaryOperator::Plus:
+            break;
+        case UnaryOperator::BitwiseNot:
+        case UnaryOperator::Not:
+            type = ValueType::Integer;
+            break;
+        }
+    }
+
+    auto expression = adopt_own(*new BoundExpression(Kind::Unary, type));
+    expression->m_unary_operator = op;
+    expression->m_lhs = move(operand);
+    return expression;
+}
+
+NonnullOwnPtr<BoundExpression> BoundExpression::create_binary(BinaryOperator op, NonnullOwnPtr<BoundExpression> lhs, NonnullOwnPtr<BoundExpression> rhs)
+{
+    auto either_is_null = lhs->type() == ValueType::Null || rhs->type() == ValueType::Null;
+    ValueType type;
+    switch (op) {
+    case BinaryOperator::Multiplication:
+    case BinaryOperator::Division:
+    case BinaryOperator::Modulo:
+    case BinaryOperator::Plus:
+    case BinaryOperator::Minus:
+        if (either_is_null)
+            type = ValueType::Null;
+        else if (lhs->type() == ValueType::Integer && rhs->type() == ValueType::Integer)
+            type = ValueType::Integer;
+        else
+            type = op == BinaryOperator::Modulo ? ValueType::Integer : ValueType::Real;
+        break;
+    case BinaryOperator::Concatenate:
+        type = either_is_null ? ValueType::Null : ValueType::Text;
+        break;
+    case BinaryOperator::And:
+    case BinaryOperator::Or:
+        // NULL AND 0 is 0, and NULL OR 1 is 1.
+        type = ValueType::Integer;
+        break;
+    default:
+        type = either_is_null ? ValueType::Null : ValueType::Integer;
+        break;
+    }
+
+    auto expression = adopt_own(*new BoundExpression(Kind::Binary, type));
+    expression->m_binary_operator = op;
+    expression->m_lhs = move(lhs);
+    expression->m_rhs = move(rhs);
+    return expression;
+}
+
+Optional<bool> truth_value(const ColumnVector& values, size_t row)
+{
+    if (values.is_null(row))
+        return {};
+    switch (values.type()) {
+    case ValueType::Integer:
+        return values.integer(row) != 0;
+    default:
+        return values.real_at(row) != 0;
+    }
+}
+
+ColumnVector BoundExpression::evaluate(const Batch& batch) const
+{
+    switch (m_kind) {
+    case Kind::Column:
+        return batch.columns[m_column_index];
+    case Kind::Literal: {
+        ColumnVector result(m_type);
+        result.ensure_capacity(batch.row_count);
+        for (size_t i = 0; i < batch.row_count; ++i)
+            result.append(m_literal);
+        return result;
+    }
+    case Kind::Unary:
+        return evaluate_unary(batch);
+    case Kind::Binary:
+        return evaluate_binary(batch);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ColumnVector BoundExpression::evaluate_unary(const Batch& batch) const
+{
+    ColumnVector result(m_type);
+    if (m_type == ValueType::Null) {
+        for (size_t i = 0; i < batch.row_count; ++i)
+            result.append_null();
+        return result;
+    }
+
+    result.ensure_capacity(batch.row_count);
+    m_lhs->with_values(batch, [&](const ColumnVector& operand) {
+        for (size_t i = 0; i < batch.row_count; ++i) {
+            if (operand.is_null(i)) {
+                result.append_null();
+                continue;
+            }
+            switch (m_unary_operator) {
+            case UnaryOperator::Minus:
+                if (m_type == ValueType::Integer)
+                    result.append_integer(-operand.integer(i));
+                else
+                    result.append_real(-operand.real_at(i));
+                break;
+            case UnaryOperator::Plus:
+                result.append_from(operand, i);
+                break;
+            case UnaryOperator::BitwiseNot:
+                result.append_integer(~operand.integer_at(i));
+                break;
+            case UnaryOperator::Not:
+                result.append_integer(truth_value(operand, i).value() ? 0 : 1);
+                break;
+            }
+        }
+    });
+    return result;
+}
+
+// The loops below are instantiated for each operator, so that the operation is inlined into them.
+
+template<typename Operation>
+static void integer_operation(const ColumnVector& lhs, const ColumnVector& rhs, size_t count, ColumnVector& result, Operation operation)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (lhs.is_null(i) || rhs.is_null(i)) {
+            result.append_null();
+            continue;
+        }
+        if (auto value = operation(lhs.integer_at(i), rhs.integer_at(i)); value.has_value())
+            result.append_integer(value.value());
+        else
+            result.append_null();
+    }
+}
+
+template<typename Operation>
+static void real_operation(const ColumnVector& lhs, const ColumnVector& rhs, size_t count, ColumnVector& result, Operation operation)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (lhs.is_null(i) || rhs.is_null(i)) {
+            result.append_null();
+            continue;
+        }
+        if (auto value = operation(lhs.real_at(i), rhs.real_at(i)); value.has_value())
+            result.append_real(value.value());
+        else
+            result.append_null();
+    }
+}
+
+template<typename Compare, typename Predicate>
+static void compare_loop(const ColumnVector& lhs, const ColumnVector& rhs, size_t count, ColumnVector& result, Compare compare, Predicate predicate)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (lhs.is_null(i) || rhs.is_null(i))
+            result.append_null();
+        else
+            result.append_integer(predicate(compare(i)) ? 1 : 0);
+    }
+}
+
+template<typename Predicate>
+static void comparison(const ColumnVector& lhs, const ColumnVector& rhs, size_t count, ColumnVector& result, Predicate predicate)
+{
+    if (lhs.type() == ValueType::Integer && rhs.type() == ValueType::Integer) {
+        auto& a = lhs.integers();
+        auto& b = rhs.integers();
+        compare_loop(lhs, rhs, count, result, [&](size_t i) { return a[i] < b[i] ? -1 : (a[i] > b[i] ? 1 : 0); }, predicate);
+    } else if (lhs.type() != ValueType::Text && rhs.type() != ValueType::Text) {
+        compare_loop(
+            lhs, rhs, count, result, [&](size_t i) {
+                auto a = lhs.real_at(i);
+                auto b = rhs.real_at(i);
+                return a < b ? -1 : (a > b ? 1 : 0);
+            },
+            predicate);
+    } else {
+        compare_loop(lhs, rhs, count, result, [&](size_t i) { return lhs.compare_rows(i, rhs, i); }, predicate);
+    }
+}
+
+ColumnVector BoundExpression::evaluate_binary(const Batch& batch) const
+{
+    auto count = batch.row_count;
+    ColumnVector result(m_type);
+    if (m_type == ValueType::Null) {
+        for (size_t i = 0; i < count; ++i)
+            result.append_null();
+        return result;
+    }
+
+    result.ensure_capacity(count);
+    m_lhs->with_values(batch, [&](const ColumnVector& lhs) {
+        m_rhs->with_values(batch, [&](const ColumnVector& rhs) {
+            auto is_integer = m_type == ValueType::Integer;
+            switch (m_binary_operator) {
+            case BinaryOperator::Concatenate:
+                for (size_t i = 0; i < count; ++i) {
+                    if (lhs.is_null(i) || rhs.is_null(i))
+                        result.append_null();
+                    else
+                        result.append_text(String::formatted("{}{}", lhs.value(i).to_string(), rhs.value(i).to_string()));
+                }
+                break;
+            case BinaryOperator::Multiplication:
+                if (is_integer)
+                    integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> { return (i64)((u64)a * (u64)b); });
+                else
+                    real_operation(lhs, rhs, count, result, [](double a, double b) -> Optional<double> { return a * b; });
+                break;
+            case BinaryOperator::Division:
+                // Dividing by zero gives NULL.
+                if (is_integer) {
+                    integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> {
+                        if (b == 0 || (b == -1 && a == NumericLimits<i64>::min()))
+                            return {};
+                        return a / b;
+                    });
+                } else {
+                    real_operation(lhs, rhs, count, result, [](double a, double b) -> Optional<double> {
+                        if (b == 0)
+                            return {};
+                        return a / b;
+                    });
+                }
+                break;
+            case BinaryOperator::Modulo:
+                integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> {
+                    if (b == 0 || b == -1)
+                        return b == 0 ? Optional<i64> {} : 0;
+                    return a % b;
+                });
+                break;
+            case BinaryOperator::Plus:
+                if (is_integer)
+                    integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> { return (i64)((u64)a + (u64)b); });
+                else
+                    real_operation(lhs, rhs, count, result, [](double a, double b) -> Optional<double> { return a + b; });
+                break;
+            case BinaryOperator::Minus:
+                if (is_integer)
+                    integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> { return (i64)((u64)a - (u64)b); });
+                else
+                    real_operation(lhs, rhs, count, result, [](double a, double b) -> Optional<double> { return a - b; });
+                break;
+            case BinaryOperator::ShiftLeft:
+                integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> {
+                    if (b < 0)
+                        return b <= -64 ? (a < 0 ? -1 : 0) : a >> -b;
+                    return b >= 64 ? 0 : (i64)((u64)a << b);
+                });
+                break;
+            case BinaryOperator::ShiftRight:
+                integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> {
+                    if (b < 0)
+                        return b <= -64 ? 0 : (i64)((u64)a << -b);
+                    return b >= 64 ? (a < 0 ? -1 : 0) : a >> b;
+                });
+                break;
+            case BinaryOperator::BitwiseAnd:
+                integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> { return a & b; });
+                break;
+            case BinaryOperator::BitwiseOr:
+                integer_operation(lhs, rhs, count, result, [](i64 a, i64 b) -> Optional<i64> { return a | b; });
+                break;
+            case BinaryOperator::LessThan:
+                comparison(lhs, rhs, count, result, [](int c) { return c < 0; });
+                break;
+            case BinaryOperator::LessThanEquals:
+                comparison(lhs, rhs, count, result, [](int c) { return c <= 0; });
+                break;
+            case BinaryOperator::GreaterThan:
+                comparison(lhs, rhs, count, result, [](int c) { return c > 0; });
+                break;
+            case BinaryOperator::GreaterThanEquals:
+                comparison(lhs, rhs, count, result, [](int c) { return c >= 0; });
+                break;
+            case BinaryOperator::Equals:
+                comparison(lhs, rhs, count, result, [](int c) { return c == 0; });
+                break;
+            case BinaryOperator::NotEquals:
+                comparison(lhs, rhs, count, result, [](int c) { return c != 0; });
+                break;
+            case BinaryOperator::And:
+            case BinaryOperator::Or: {
+                // Three-valued logic: the result is only NULL if the non-NULL operand doesn't decide it.
+                auto deciding_value = m_binary_operator == BinaryOperator::Or;
+                for (size_t i = 0; i < count; ++i) {
+                    auto a = truth_value(lhs, i);
+                    auto b = truth_value(rhs, i);
+                    if ((a.has_value() && a.value() == deciding_value) || (b.has_value() && b.value() == deciding_value))
+                        result.append_integer(deciding_value);
+                    else if (!a.has_value() || !b.has_value())
+                        result.append_null();
+                    else
+                        result.append_integer(!deciding_value);
+                }
+                break;
+            }
+            }
+        });
+    });
+    return result;
+}
+
+}
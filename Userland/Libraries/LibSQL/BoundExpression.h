@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <LibSQL/AST.h>
+#include <LibSQL/Batch.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+// An expression whose column names have been resolved to the indices of the columns of the
+// batches it is evaluated on, and whose result type is known. Evaluating it on a batch gives the
+// values for all its rows at once.
+class BoundExpression {
+public:
+    static NonnullOwnPtr<BoundExpression> create_column(size_t index, ValueType);
+    static NonnullOwnPtr<BoundExpression> create_literal(Value);
+    static NonnullOwnPtr<BoundExpression> create_unary(UnaryOperator, NonnullOwnPtr<BoundExpression>);
+    static NonnullOwnPtr<BoundExpression> create_binary(BinaryOperator, NonnullOwnPtr<BoundExpression>, NonnullOwnPtr<BoundExpression>);
+
+    ValueType type() const { return m_type; }
+
+    ColumnVector evaluate(const Batch&) const;
+
+    // Calls the callback with the values of the expression, which are not copied if it is just a column.
+    template<typename Callback>
+    void with_values(const Batch& batch, Callback callback) const
+    {
+        if (m_kind == Kind::Column) {
+            callback(batch.columns[m_column_index]);
+            return;
+        }
+        auto values = evaluate(batch);
+        callback(values);
+    }
+
+private:
+    enum class Kind {
+        Column,
+        Literal,
+        Unary,
+        Binary,
+    };
+
+    BoundExpression(Kind kind, ValueType type)
+        : m_kind(kind)
+        , m_type(type)
+    {
+    }
+
+    ColumnVector evaluate_unary(const Batch&) const;
+    ColumnVector evaluate_binary(const Batch&) const;
+
+    Kind m_kind;
+    ValueType m_type;
+    size_t m_column_index { 0 };
+    Value m_literal;
+    UnaryOperator m_unary_operator { UnaryOperator::Plus };
+    BinaryOperator m_binary_operator { BinaryOperator::Plus };
+    OwnPtr<BoundExpression> m_lhs;
+    OwnPtr<BoundExpression> m_rhs;
+};
+
+// Whether a value counts as true in a WHERE clause, or nothing if it is NULL.
+Optional<bool> truth_value(const ColumnVector&, size_t row);
+
+}
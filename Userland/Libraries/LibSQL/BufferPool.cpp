@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibSQL/BufferPool.h>
+
+namespace SQL {
+
+BufferPool::BufferPool(NonnullRefPtr<Heap> heap, size_t capacity, Optional<Heap::Snapshot> snapshot)
+    : m_heap(move(heap))
+    , m_snapshot(move(snapshot))
+    , m_capacity(capacity)
+{
+    VERIFY(m_capacity > 0);
+}
+
+BufferPool::~BufferPool()
+{
+    if (is_read_only())
+        m_heap->end_snapshot(m_snapshot.value());
+    else
+        flush();
+    m_lru_list.clear();
+}
+
+NonnullRefPtr<Page> BufferPool::get_page(u32 index)
+{
+    VERIFY(index > 0 && index < page_count());
+
+    if (auto it = m_pages.find(index); it != m_pages.end()) {
+        ++m_hit_count;
+        touch(*it->value);
+        return it->value;
+    }
+
+    ++m_miss_count;
+    auto page = add_page(index);
+    Optional<u32> frame_limit;
+    if (m_snapshot.has_value())
+        frame_limit = m_snapshot->frame_limit;
+    if (!m_heap->read_page(index, page->data(), frame_limit))
+        m_has_io_error = true;
+    return page;
+}
+
+NonnullRefPtr<Page> BufferPool::allocate_page()
+{
+    VERIFY(!is_read_only());
+    if (auto index = m_heap->free_list_head(); index != 0) {
+        auto page = get_page(index);
+        m_heap->set_free_list_head(AK::convert_between_host_and_little_endian(ByteReader::load32(page->data().data())));
+        page->data().fill(0);
+        page->set_dirty();
+        return page;
+    }
+
+    // A new page at the end of the file doesn't have to be read: it's all zeroes.
+    auto index = m_heap->page_count();
+    m_heap->set_page_count(index + 1);
+    auto page = add_page(index);
+    page->data().fill(0);
+    page->set_dirty();
+    return page;
+}
+
+void BufferPool::free_page(u32 index)
+{
+    VERIFY(!is_read_only());
+    auto page = get_page(index);
+    page->data().fill(0);
+    ByteReader::store(page->data().data(), AK::convert_between_host_and_little_endian(m_heap->free_list_head()));
+    page->set_dirty();
+    m_heap->set_free_list_head(index);
+}
+
+bool BufferPool::write_back_changes()
+{
+    for (auto& it : m_pages) {
+        if (it.value->is_dirty())
+            write_back(*it.value);
+    }
+    return !m_has_io_error;
+}
+
+bool BufferPool::flush()
+{
+    if (is_read_only())
+        return !m_has_io_error;
+    // Committing after a page couldn't be written would lose that page.
+    if (!write_back_changes() || !m_heap->sync())
+        m_has_io_error = true;
+    return !m_has_io_error;
+}
+
+NonnullRefPtr<Page> BufferPool::add_page(u32 index)
+{
+    evict_if_needed();
+    auto page = adopt_ref(*new Page(index));
+    m_pages.set(index, page);
+    m_lru_list.append(*page);
+    return page;
+}
+
+void BufferPool::touch(Page& page)
+{
+    m_lru_list.remove(page);
+    m_lru_list.append(page);
+}
+
+void BufferPool::write_back(Page& page)
+{
+    VERIFY(!is_read_only());
+    ++m_write_count;
+    if (!m_heap->write_page(page.index(), page.data()))
+        m_has_io_error = true;
+    page.m_is_dirty = false;
+}
+
+void BufferPool::evict_if_needed()
+{
+    if (m_pages.size() < m_capacity)
+        return;
+
+    // Go from the least recently used page, skipping the ones that are in use, until there is room for one more.
+    for (auto it = m_lru_list.begin(); it != m_lru_list.end() && m_pages.size() >= m_capacity;) {
+        auto& page = *it;
+        ++it;
+        if (page.ref_count() > 1)
+            continue;
+        if (page.is_dirty())
+            write_back(page);
+        m_lru_list.remove(page);
+        m_pages.remove(page.index());
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <LibSQL/Heap.h>
+
+namespace SQL {
+
+class Page : public RefCounted<Page> {
+    friend class BufferPool;
+
+public:
+    u32 index() const { return m_index; }
+
+    Bytes data() { return { m_data, Heap::page_size }; }
+    ReadonlyBytes data() const { return { m_data, Heap::page_size }; }
+
+    // Has to be called after changing the data, so that it gets written back.
+    void set_dirty() { m_is_dirty = true; }
+    bool is_dirty() const { return m_is_dirty; }
+
+private:
+    explicit Page(u32 index)
+        : m_index(index)
+    {
+    }
+
+    u32 m_index { 0 };
+    bool m_is_dirty { false };
+    IntrusiveListNode<Page> m_lru_list_node;
+    u8 m_data[Heap::page_size];
+};
+
+// Keeps the most recently used pages of a heap in memory. Changed pages are only written back
+// when they are evicted, or when the pool is flushed; a page that someone still holds a reference
+// to is never evicted, so the pool can grow past its capacity while many pages are in use.
+//
+// A pool that is given a snapshot reads the pages as of that snapshot, and can't change them.
+class BufferPool {
+public:
+    static constexpr size_t default_capacity = 256;
+
+    explicit BufferPool(NonnullRefPtr<Heap>, size_t capacity = default_capacity, Optional<Heap::Snapshot> = {});
+    ~BufferPool();
+
+    Heap& heap() { return *m_heap; }
+
+    bool is_read_only() const { return m_snapshot.has_value(); }
+    u32 page_count() const { return m_snapshot.has_value() ? m_snapshot->page_count : m_heap->page_count(); }
+
+    NonnullRefPtr<Page> get_page(u32 index);
+
+    // Returns a zeroed page, reusing a freed one if there is any.
+    NonnullRefPtr<Page> allocate_page();
+    void free_page(u32 index);
+
+    // Writes all changed pages back, without committing them.
+    bool write_back_changes();
+    // Writes all changed pages back and commits them, and makes sure that they reach the disk.
+    bool flush();
+
+    // Set once reading or writing a page failed; what was read is then zeroes.
+    bool has_io_error() const { return m_has_io_error; }
+
+    size_t capacity() const { return m_capacity; }
+    size_t hit_count() const { return m_hit_count; }
+    size_t miss_count() const { return m_miss_count; }
+    size_t write_count() const { return m_write_count; }
+
+private:
+    NonnullRefPtr<Page> add_page(u32 index);
+    void touch(Page&);
+    void write_back(Page&);
+    void evict_if_needed();
+
+    NonnullRefPtr<Heap> m_heap;
+    Optional<Heap::Snapshot> m_snapshot;
+    size_t m_capacity { 0 };
+    HashMap<u32, NonnullRefPtr<Page>> m_pages;
+    // Least recently used first.
+    IntrusiveList<Page, RawPtr<Page>, &Page::m_lru_list_node> m_lru_list;
+
+    bool m_has_io_error { false };
+    size_t m_hit_count { 0 };
+    size_t m_miss_count { 0 };
+    size_t m_write_count { 0 };
+};
+
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <LibSQL/Database.h>
+#include <string.h>
+
+namespace SQL {
+
+// A catalog entry is keyed by the table name. Its value is the root page of the table, the number
+// of columns, and for each column its type and its name (as a 2-byte size and the name).
+static ReadonlyBytes catalog_key(const String& name)
+{
+    return name.bytes();
+}
+
+static ByteBuffer encode_table_definition(u32 root_page, const Vector<TableColumn>& columns)
+{
+    DuplexMemoryStream stream;
+    stream << (LittleEndian<u32>)root_page;
+    stream << (LittleEndian<u16>)columns.size();
+    for (auto& column : columns) {
+        stream << (u8)column.type;
+        stream << (LittleEndian<u16>)column.name.length();
+        stream << column.name.bytes();
+    }
+    return stream.copy_into_contiguous_buffer();
+}
+
+static Optional<TableDefinition> decode_table_definition(const String& name, ReadonlyBytes bytes)
+{
+    TableDefinition definition { name, 0, {} };
+    InputMemoryStream stream { bytes };
+    LittleEndian<u32> root_page;
+    LittleEndian<u16> column_count;
+    stream >> root_page >> column_count;
+    definition.root_page = root_page;
+
+    for (size_t i = 0; i < column_count && !stream.has_any_error(); ++i) {
+        u8 type = 0;
+        LittleEndian<u16> name_length;
+        stream >> type >> name_length;
+        if (stream.remaining() < name_length)
+            return {};
+        definition.columns.append({ String(bytes.slice(stream.offset(), name_length)), (ValueType)type });
+        stream.discard_or_error(name_length);
+    }
+    if (stream.handle_any_error())
+        return {};
+    return definition;
+}
+
+Optional<size_t> TableDefinition::column_index(StringView name) const
+{
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name.equals_ignoring_case(name))
+            return i;
+    }
+    return {};
+}
+
+Result<NonnullRefPtr<Database>, String> Database::open(const String& path, size_t pool_capacity)
+{
+    auto heap_or_error = Heap::open(path);
+    if (heap_or_error.is_error())
+        return heap_or_error.release_error();
+
+    auto heap = heap_or_error.release_value();
+    if (heap->catalog_root() == 0) {
+        BufferPool pool(heap, 1);
+        heap->set_catalog_root(BTree::create(pool));
+    }
+    return adopt_ref(*new Database(move(heap), pool_capacity));
+}
+
+Database::Database(NonnullRefPtr<Heap> heap, size_t pool_capacity, Optional<Heap::Snapshot> snapshot)
+    : m_pool(heap, pool_capacity, snapshot)
+    , m_catalog(m_pool, snapshot.has_value() ? snapshot->catalog_root : heap->catalog_root())
+{
+    pthread_mutex_init(&m_write_mutex, nullptr);
+}
+
+Database::~Database()
+{
+    pthread_mutex_destroy(&m_write_mutex);
+}
+
+Result<NonnullRefPtr<Database>, String> Database::begin_read(size_t pool_capacity)
+{
+    auto snapshot = m_pool.heap().begin_snapshot();
+    if (!snapshot.has_value())
+        return String("Could not read the database header");
+    return adopt_ref(*new Database(m_pool.heap(), pool_capacity, snapshot.release_value()));
+}
+
+void Database::begin_write()
+{
+    VERIFY(!is_read_only());
+    pthread_mutex_lock(&m_write_mutex);
+    m_is_writing = true;
+}
+
+Optional<BTree> Database::table(const String& name)
+{
+    auto definition = table_definition(name);
+    if (!definition.has_value())
+        return {};
+    return BTree(m_pool, definition->root_page);
+}
+
+Optional<TableDefinition> Database::table_definition(const String& name)
+{
+    auto value = m_catalog.find(catalog_key(name));
+    if (!value.has_value())
+        return {};
+    return decode_table_definition(name, *value);
+}
+
+Result<BTree, String> Database::create_table(const String& name, Vector<TableColumn> columns)
+{
+    if (is_read_only())
+        return String("The database is read-only");
+    if (m_catalog.find(catalog_key(name)).has_value())
+        return String::formatted("Table already exists: {}", name);
+
+    auto definition = encode_table_definition(0, columns);
+    if (name.length() + definition.size() > BTree::max_entry_size)
+        return String::formatted("Table definition is too large: {}", name);
+
+    auto root_page = BTree::create(m_pool);
+    ByteReader::store(definition.data(), AK::convert_between_host_and_little_endian(root_page));
+    auto inserted = m_catalog.insert(catalog_key(name), definition);
+    VERIFY(inserted);
+    return BTree(m_pool, root_page);
+}
+
+bool Database::drop_table(const String& name)
+{
+    VERIFY(!is_read_only());
+    auto table = this->table(name);
+    if (!table.has_value())
+        return false;
+    table->destroy();
+    m_catalog.remove(catalog_key(name));
+    return true;
+}
+
+Vector<String> Database::table_names()
+{
+    Vector<String> names;
+    for (auto it = m_catalog.begin(); !it.is_end(); ++it)
+        names.append(String(it.key()));
+    return names;
+}
+
+Result<u64, String> Database::insert_row(const TableDefinition& table, Vector<Value> values)
+{
+    if (is_read_only())
+        return String("The database is read-only");
+    if (values.size() != table.columns.size())
+        return String::formatted("Table {} has {} columns but {} values were supplied", table.name, table.columns.size(), values.size());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto value = values[i].converted_to(table.columns[i].type);
+        if (!value.has_value())
+            return String::formatted("Cannot store {} in column {} of type {}", values[i], table.columns[i].name, value_type_name(table.columns[i].type));
+        values[i] = value.release_value();
+    }
+
+    auto row = encode_row(values);
+    if (row.size() + sizeof(u64) > BTree::max_entry_size)
+        return String::formatted("Row is too large for table {}", table.name);
+
+    BTree tree(m_pool, table.root_page);
+    u64 row_id = 1;
+    if (auto last_key = tree.last_key(); last_key.has_value())
+        row_id = row_id_for_key(*last_key) + 1;
+
+    auto inserted = tree.insert(key_for_row_id(row_id), row);
+    VERIFY(inserted);
+    return row_id;
+}
+
+ByteBuffer Database::key_for_row_id(u64 row_id)
+{
+    BigEndian<u64> key = row_id;
+    return ByteBuffer::copy(&key, sizeof(key));
+}
+
+u64 Database::row_id_for_key(ReadonlyBytes key)
+{
+    VERIFY(key.size() == sizeof(u64));
+    BigEndian<u64> row_id;
+    memcpy(&row_id, key.data(), sizeof(row_id));
+    return row_id;
+}
+
+bool Database::commit()
+{
+    if (is_read_only())
+        return true;
+
+    auto& heap = m_pool.heap();
+    Optional<u32> frame;
+    if (m_pool.write_back_changes())
+        frame = heap.commit();
+
+    if (m_is_writing) {
+        m_is_writing = false;
+        pthread_mutex_unlock(&m_write_mutex);
+    }
+
+    if (!frame.has_value() || !heap.wait_until_durable(frame.value()))
+        return false;
+    heap.checkpoint_if_needed();
+    return true;
+}
+
+}
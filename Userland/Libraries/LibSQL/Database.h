@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/Result.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/BufferPool.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/Value.h>
+#include <pthread.h>
+
+namespace SQL {
+
+struct TableColumn {
+    String name;
+    ValueType type { ValueType::Text };
+};
+
+struct TableDefinition {
+    String name;
+    u32 root_page { 0 };
+    Vector<TableColumn> columns;
+
+    Optional<size_t> column_index(StringView name) const;
+};
+
+// The storage of a database file: its buffer pool, and a catalog that maps the name of each
+// table to its definition and the root page of the B-tree holding it. Rows are keyed by their
+// row ID, as a big-endian integer. Changes only become part of the database with commit(), and
+// are safely on disk when it returns (see WriteAheadLog).
+//
+// Threads that share a database for writing take turns with begin_write() and commit(). Readers
+// use a read-only database from begin_read() instead, which sees the database as of the last
+// commit and doesn't wait for writers, nor make them wait.
+class Database : public RefCounted<Database> {
+public:
+    static Result<NonnullRefPtr<Database>, String> open(const String& path, size_t pool_capacity = BufferPool::default_capacity);
+    ~Database();
+
+    BufferPool& pool() { return m_pool; }
+    bool is_read_only() const { return m_pool.is_read_only(); }
+
+    Result<NonnullRefPtr<Database>, String> begin_read(size_t pool_capacity = BufferPool::default_capacity);
+    // Waits until the writer before this one has committed.
+    void begin_write();
+
+    Optional<BTree> table(const String& name);
+    Optional<TableDefinition> table_definition(const String& name);
+    Result<BTree, String> create_table(const String& name, Vector<TableColumn> columns = {});
+    bool drop_table(const String& name);
+    Vector<String> table_names();
+
+    // Converts the values to the types of the columns, and returns the row ID of the new row.
+    Result<u64, String> insert_row(const TableDefinition&, Vector<Value>);
+
+    static ByteBuffer key_for_row_id(u64);
+    static u64 row_id_for_key(ReadonlyBytes);
+
+    // Lets the next writer go ahead once the changes are in the log, and then waits for them to reach
+    // the disk, so that writers that commit at about the same time share an fsync().
+    bool commit();
+
+private:
+    Database(NonnullRefPtr<Heap>, size_t pool_capacity, Optional<Heap::Snapshot> = {});
+
+    BufferPool m_pool;
+    BTree m_catalog;
+    pthread_mutex_t m_write_mutex;
+    bool m_is_writing { false };
+};
+
+}
@@ -0,0 +1,866 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST.h>
+#include <LibSQL/BoundExpression.h>
+#include <LibSQL/Executor.h>
+#include <LibSQL/Operators.h>
+#include <math.h>
+
+namespace SQL {
+
+namespace {
+
+using BindResult = Result<NonnullOwnPtr<BoundExpression>, String>;
+
+// The columns of the rows that an operator produces, as far as expressions can refer to them.
+struct ScopeColumn {
+    String table;
+    String name;
+    ValueType type { ValueType::Null };
+    // Not included in "SELECT *", like the row ID.
+    bool is_hidden { false };
+};
+
+using Scope = Vector<ScopeColumn>;
+
+// Once rows are grouped, expressions can only refer to the grouping expressions and to the
+// aggregates, which are the columns of the rows produced by the HashAggregateOperator.
+struct AggregateContext {
+    Vector<String> group_names;
+    // The input column of each grouping expression that is just a column.
+    Vector<Optional<size_t>> group_columns;
+    Vector<String> aggregate_names;
+    Vector<ValueType> output_types;
+};
+
+struct AggregateCall {
+    AggregateFunction function;
+    const Expression* argument { nullptr };
+    String name;
+};
+
+Optional<AggregateFunction> aggregate_function_for_name(StringView name)
+{
+    if (name.equals_ignoring_case("COUNT"))
+        return AggregateFunction::Count;
+    if (name.equals_ignoring_case("SUM"))
+        return AggregateFunction::Sum;
+    if (name.equals_ignoring_case("AVG"))
+        return AggregateFunction::Average;
+    if (name.equals_ignoring_case("MIN"))
+        return AggregateFunction::Minimum;
+    if (name.equals_ignoring_case("MAX"))
+        return AggregateFunction::Maximum;
+    return {};
+}
+
+StringView binary_operator_name(BinaryOperator type)
+{
+    switch (type) {
+    case BinaryOperator::Concatenate:
+        return "||";
+    case BinaryOperator::Multiplication:
+        return "*";
+    case BinaryOperator::Division:
+        return "/";
+    case BinaryOperator::Modulo:
+        return "%";
+    case BinaryOperator::Plus:
+        return "+";
+    case BinaryOperator::Minus:
+        return "-";
+    case BinaryOperator::ShiftLeft:
+        return "<<";
+    case BinaryOperator::ShiftRight:
+        return ">>";
+    case BinaryOperator::BitwiseAnd:
+        return "&";
+    case BinaryOperator::BitwiseOr:
+        return "|";
+    case BinaryOperator::LessThan:
+        return "<";
+    case BinaryOperator::LessThanEquals:
+        return "<=";
+    case BinaryOperator::GreaterThan:
+        return ">";
+    case BinaryOperator::GreaterThanEquals:
+        return ">=";
+    case BinaryOperator::Equals:
+        return "=";
+    case BinaryOperator::NotEquals:
+        return "!=";
+    case BinaryOperator::And:
+        return "AND";
+    case BinaryOperator::Or:
+        return "OR";
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Value numeric_literal_value(const NumericLiteral& literal)
+{
+    auto value = literal.value();
+    if (value == trunc(value) && fabs(value) < 9.2e18)
+        return Value((i64)value);
+    return Value(value);
+}
+
+// The parser keeps the quotes around string literals.
+String string_literal_value(const StringLiteral& literal)
+{
+    auto& value = literal.value();
+    if (value.length() < 2)
+        return value;
+    auto unquoted = value.substring(1, value.length() - 2);
+    unquoted.replace("''", "'", true);
+    return unquoted;
+}
+
+// The name of a result column that has no alias, which is also used to find expressions that are
+// the same as a grouping expression, or as an aggregate that was already computed.
+String expression_to_string(const Expression& expression)
+{
+    if (is<NumericLiteral>(expression))
+        return numeric_literal_value(static_cast<const NumericLiteral&>(expression)).to_string();
+    if (is<StringLiteral>(expression))
+        return static_cast<const StringLiteral&>(expression).value();
+    if (is<NullLiteral>(expression))
+        return "NULL";
+
+    if (is<ColumnNameExpression>(expression)) {
+        auto& column = static_cast<const ColumnNameExpression&>(expression);
+        if (column.table_name().is_empty())
+            return column.column_name();
+        return String::formatted("{}.{}", column.table_name(), column.column_name());
+    }
+
+    if (is<UnaryOperatorExpression>(expression)) {
+        auto& unary = static_cast<const UnaryOperatorExpression&>(expression);
+        auto operand = expression_to_string(*unary.expression());
+        switch (unary.type()) {
+        case UnaryOperator::Minus:
+            return String::formatted("-{}", operand);
+        case UnaryOperator::Plus:
+            return String::formatted("+{}", operand);
+        case UnaryOperator::BitwiseNot:
+            return String::formatted("~{}", operand);
+        case UnaryOperator::Not:
+            return String::formatted("NOT {}", operand);
+        }
+    }
+
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary = static_cast<const BinaryOperatorExpression&>(expression);
+        return String::formatted("{} {} {}", expression_to_string(*binary.lhs()), binary_operator_name(binary.type()), expression_to_string(*binary.rhs()));
+    }
+
+    if (is<ChainedExpression>(expression)) {
+        StringBuilder builder;
+        builder.append('(');
+        bool first = true;
+        for (auto& element : static_cast<const ChainedExpression&>(expression).expressions()) {
+            if (!first)
+                builder.append(", ");
+            builder.append(expression_to_string(element));
+            first = false;
+        }
+        builder.append(')');
+        return builder.to_string();
+    }
+
+    if (is<FunctionCallExpression>(expression)) {
+        auto& call = static_cast<const FunctionCallExpression&>(expression);
+        StringBuilder builder;
+        builder.append(call.name().to_uppercase());
+        builder.append('(');
+        if (call.arguments().is_empty())
+            builder.append('*');
+        bool first = true;
+        for (auto& argument : call.arguments()) {
+            if (!first)
+                builder.append(", ");
+            builder.append(expression_to_string(argument));
+            first = false;
+        }
+        builder.append(')');
+        return builder.to_string();
+    }
+
+    return "?";
+}
+
+Result<size_t, String> resolve_column(const Scope& scope, const ColumnNameExpression& column)
+{
+    Optional<size_t> found;
+    for (size_t i = 0; i < scope.size(); ++i) {
+        if (!column.table_name().is_empty() && !scope[i].table.equals_ignoring_case(column.table_name()))
+            continue;
+        if (!scope[i].name.equals_ignoring_case(column.column_name()))
+            continue;
+        if (found.has_value())
+            return String::formatted("Ambiguous column name: {}", expression_to_string(column));
+        found = i;
+    }
+    if (!found.has_value())
+        return String::formatted("No such column: {}", expression_to_string(column));
+    return found.value();
+}
+
+BindResult bind(const Expression& expression, const Scope& scope, const AggregateContext* context = nullptr)
+{
+    if (context) {
+        auto name = expression_to_string(expression);
+        for (size_t i = 0; i < context->group_names.size(); ++i) {
+            if (context->group_names[i] == name)
+                return BoundExpression::create_column(i, context->output_types[i]);
+        }
+        if (is<FunctionCallExpression>(expression)) {
+            for (size_t i = 0; i < context->aggregate_names.size(); ++i) {
+                if (context->aggregate_names[i] == name) {
+                    auto index = context->group_names.size() + i;
+                    return BoundExpression::create_column(index, context->output_types[index]);
+                }
+            }
+        }
+        if (is<ColumnNameExpression>(expression)) {
+            auto index_or_error = resolve_column(scope, static_cast<const ColumnNameExpression&>(expression));
+            if (index_or_error.is_error())
+                return index_or_error.release_error();
+            for (size_t i = 0; i < context->group_columns.size(); ++i) {
+                if (context->group_columns[i] == index_or_error.value())
+                    return BoundExpression::create_column(i, context->output_types[i]);
+            }
+            return String::formatted("Column {} must be in the GROUP BY clause or used in an aggregate function", name);
+        }
+    }
+
+    if (is<NumericLiteral>(expression))
+        return BoundExpression::create_literal(numeric_literal_value(static_cast<const NumericLiteral&>(expression)));
+    if (is<StringLiteral>(expression))
+        return BoundExpression::create_literal(Value(string_literal_value(static_cast<const StringLiteral&>(expression))));
+    if (is<NullLiteral>(expression))
+        return BoundExpression::create_literal(Value());
+
+    if (is<ColumnNameExpression>(expression)) {
+        auto index_or_error = resolve_column(scope, static_cast<const ColumnNameExpression&>(expression));
+        if (index_or_error.is_error())
+            return index_or_error.release_error();
+        auto index = index_or_error.value();
+        return BoundExpression::create_column(index, scope[index].type);
+    }
+
+    if (is<UnaryOperatorExpression>(expression)) {
+        auto& unary = static_cast<const UnaryOperatorExpression&>(expression);
+        auto operand = bind(*unary.expression(), scope, context);
+        if (operand.is_error())
+            return operand.release_error();
+        return BoundExpression::create_unary(unary.type(), operand.release_value());
+    }
+
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary = static_cast<const BinaryOperatorExpression&>(expression);
+        auto lhs = bind(*binary.lhs(), scope, context);
+        if (lhs.is_error())
+            return lhs.release_error();
+        auto rhs = bind(*binary.rhs(), scope, context);
+        if (rhs.is_error())
+            return rhs.release_error();
+        return BoundExpression::create_binary(binary.type(), lhs.release_value(), rhs.release_value());
+    }
+
+    if (is<ChainedExpression>(expression)) {
+        auto& elements = static_cast<const ChainedExpression&>(expression).expressions();
+        if (elements.size() == 1)
+            return bind(elements.first(), scope, context);
+        return String("Row values are not supported");
+    }
+
+    if (is<FunctionCallExpression>(expression)) {
+        auto& call = static_cast<const FunctionCallExpression&>(expression);
+        if (aggregate_function_for_name(call.name()).has_value())
+            return String::formatted("Aggregate function {} can't be used here", call.name().to_uppercase());
+        return String::formatted("No such function: {}", call.name());
+    }
+
+    return String::formatted("Unsupported expression: {}", expression_to_string(expression));
+}
+
+Result<Value, String> evaluate_constant(const Expression& expression)
+{
+    auto bound = bind(expression, {});
+    if (bound.is_error())
+        return bound.release_error();
+    Batch batch;
+    batch.row_count = 1;
+    return bound.value()->evaluate(batch).value(0);
+}
+
+Optional<String> collect_aggregates(const Expression& expression, Vector<AggregateCall>& calls, bool is_in_aggregate = false)
+{
+    if (is<FunctionCallExpression>(expression)) {
+        auto& call = static_cast<const FunctionCallExpression&>(expression);
+        auto function = aggregate_function_for_name(call.name());
+        if (!function.has_value())
+            return {};
+        if (is_in_aggregate)
+            return String("Aggregate functions can't be nested");
+
+        auto expected_arguments = function.value() == AggregateFunction::Count ? call.arguments().size() : 1;
+        if (call.arguments().size() != expected_arguments || expected_arguments > 1)
+            return String::formatted("Wrong number of arguments to {}", call.name().to_uppercase());
+        for (auto& argument : call.arguments()) {
+            if (auto error = collect_aggregates(argument, calls, true); error.has_value())
+                return error;
+        }
+
+        auto name = expression_to_string(expression);
+        if (!calls.find_if([&](auto& other) { return other.name == name; }).is_end())
+            return {};
+        calls.append({ function.value(), call.arguments().is_empty() ? nullptr : &call.arguments().first(), move(name) });
+        return {};
+    }
+
+    if (is<UnaryOperatorExpression>(expression))
+        return collect_aggregates(*static_cast<const UnaryOperatorExpression&>(expression).expression(), calls, is_in_aggregate);
+
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary = static_cast<const BinaryOperatorExpression&>(expression);
+        if (auto error = collect_aggregates(*binary.lhs(), calls, is_in_aggregate); error.has_value())
+            return error;
+        return collect_aggregates(*binary.rhs(), calls, is_in_aggregate);
+    }
+
+    if (is<ChainedExpression>(expression)) {
+        for (auto& element : static_cast<const ChainedExpression&>(expression).expressions()) {
+            if (auto error = collect_aggregates(element, calls, is_in_aggregate); error.has_value())
+                return error;
+        }
+    }
+    return {};
+}
+
+void split_conjuncts(const Expression& expression, Vector<const Expression*>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary = static_cast<const BinaryOperatorExpression&>(expression);
+        if (binary.type() == BinaryOperator::And) {
+            split_conjuncts(*binary.lhs(), conjuncts);
+            split_conjuncts(*binary.rhs(), conjuncts);
+            return;
+        }
+    }
+    if (is<ChainedExpression>(expression)) {
+        auto& elements = static_cast<const ChainedExpression&>(expression).expressions();
+        if (elements.size() == 1)
+            return split_conjuncts(elements.first(), conjuncts);
+    }
+    conjuncts.append(&expression);
+}
+
+// The tables (as bits of a mask) that an expression refers to, or nothing if that isn't clear.
+Optional<u64> referenced_tables(const Expression& expression, const Scope& scope, const Vector<size_t>& table_of_column)
+{
+    if (is<ColumnNameExpression>(expression)) {
+        auto index = resolve_column(scope, static_cast<const ColumnNameExpression&>(expression));
+        if (index.is_error())
+            return {};
+        return (u64)1 << table_of_column[index.value()];
+    }
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<NullLiteral>(expression))
+        return 0;
+    if (is<UnaryOperatorExpression>(expression))
+        return referenced_tables(*static_cast<const UnaryOperatorExpression&>(expression).expression(), scope, table_of_column);
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary = static_cast<const BinaryOperatorExpression&>(expression);
+        auto lhs = referenced_tables(*binary.lhs(), scope, table_of_column);
+        auto rhs = referenced_tables(*binary.rhs(), scope, table_of_column);
+        if (!lhs.has_value() || !rhs.has_value())
+            return {};
+        return lhs.value() | rhs.value();
+    }
+    if (is<ChainedExpression>(expression)) {
+        u64 tables = 0;
+        for (auto& element : static_cast<const ChainedExpression&>(expression).expressions()) {
+            auto element_tables = referenced_tables(element, scope, table_of_column);
+            if (!element_tables.has_value())
+                return {};
+            tables |= element_tables.value();
+        }
+        return tables;
+    }
+    return {};
+}
+
+struct Source {
+    NonnullOwnPtr<Operator> input;
+    Scope scope;
+};
+
+NonnullOwnPtr<Operator> add_filter(NonnullOwnPtr<Operator> input, NonnullOwnPtr<BoundExpression> predicate)
+{
+    return make<FilterOperator>(move(input), move(predicate));
+}
+
+}
+
+Result<ResultSet, String> Executor::execute(const Statement& statement)
+{
+    if (m_database.is_read_only() && !is<Select>(statement))
+        return String("The database is read-only");
+    if (is<CreateTable>(statement))
+        return execute_create_table(static_cast<const CreateTable&>(statement));
+    if (is<DropTable>(statement))
+        return execute_drop_table(static_cast<const DropTable&>(statement));
+    if (is<Insert>(statement))
+        return execute_insert(static_cast<const Insert&>(statement));
+    if (is<Select>(statement))
+        return execute_select(static_cast<const Select&>(statement));
+    return String("This kind of statement is not supported yet");
+}
+
+Result<ResultSet, String> Executor::execute_create_table(const CreateTable& statement)
+{
+    if (statement.has_selection())
+        return String("CREATE TABLE ... AS SELECT is not supported yet");
+
+    auto name = statement.table_name().to_uppercase();
+    if (m_database.table_definition(name).has_value()) {
+        if (!statement.is_error_if_table_exists())
+            return ResultSet {};
+        return String::formatted("Table {} already exists", statement.table_name());
+    }
+
+    Vector<TableColumn> columns;
+    for (auto& column : statement.columns()) {
+        if (!columns.find_if([&](auto& other) { return other.name.equals_ignoring_case(column.name()); }).is_end())
+            return String::formatted("Duplicate column name: {}", column.name());
+        columns.append({ column.name(), value_type_for_type_name(column.type_name()->name()) });
+    }
+
+    auto table = m_database.create_table(name, move(columns));
+    if (table.is_error())
+        return table.release_error();
+    return ResultSet {};
+}
+
+Result<ResultSet, String> Executor::execute_drop_table(const DropTable& statement)
+{
+    if (!m_database.drop_table(statement.table_name().to_uppercase()) && statement.is_error_if_table_does_not_exist())
+        return String::formatted("No such table: {}", statement.table_name());
+    return ResultSet {};
+}
+
+Result<ResultSet, String> Executor::execute_insert(const Insert& statement)
+{
+    if (statement.has_selection())
+        return String("INSERT ... SELECT is not supported yet");
+
+    auto table = m_database.table_definition(statement.table_name().to_uppercase());
+    if (!table.has_value())
+        return String::formatted("No such table: {}", statement.table_name());
+
+    Vector<size_t> targets;
+    if (statement.column_names().is_empty()) {
+        for (size_t i = 0; i < table->columns.size(); ++i)
+            targets.append(i);
+    } else {
+        for (auto& name : statement.column_names()) {
+            auto index = table->column_index(name);
+            if (!index.has_value())
+                return String::formatted("Table {} has no column named {}", statement.table_name(), name);
+            targets.append(index.value());
+        }
+    }
+
+    ResultSet result;
+    auto insert_row = [&](const NonnullRefPtrVector<Expression>& expressions) -> Optional<String> {
+        Vector<Value> row;
+        row.resize(table->columns.size());
+        if (expressions.size() != targets.size())
+            return String::formatted("{} values for {} columns", expressions.size(), targets.size());
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            auto value = evaluate_constant(expressions[i]);
+            if (value.is_error())
+                return value.release_error();
+            row[targets[i]] = value.release_value();
+        }
+        auto row_id = m_database.insert_row(*table, move(row));
+        if (row_id.is_error())
+            return row_id.release_error();
+        ++result.changed_row_count;
+        return {};
+    };
+
+    if (statement.default_values()) {
+        NonnullRefPtrVector<Expression> nulls;
+        for (size_t i = 0; i < targets.size(); ++i)
+            nulls.append(create_ast_node<NullLiteral>());
+        if (auto error = insert_row(nulls); error.has_value())
+            return error.release_value();
+    }
+    for (auto& values : statement.chained_expressions()) {
+        if (auto error = insert_row(values.expressions()); error.has_value())
+            return error.release_value();
+    }
+    return result;
+}
+
+Result<ResultSet, String> Executor::execute_select(const Select& statement)
+{
+    if (statement.common_table_expression_list())
+        return String("WITH clauses are not supported yet");
+
+    // The tables, each with the filters that only refer to it.
+    Vector<Source> sources;
+    Scope full_scope;
+    Vector<size_t> table_of_column;
+    if (statement.table_or_subquery_list().size() > 64)
+        return String("Too many tables");
+    for (auto& table_or_subquery : statement.table_or_subquery_list()) {
+        if (!table_or_subquery.is_table())
+            return String("Subqueries are not supported yet");
+        auto table = m_database.table_definition(table_or_subquery.table_name().to_uppercase());
+        if (!table.has_value())
+            return String::formatted("No such table: {}", table_or_subquery.table_name());
+
+        auto& name = table_or_subquery.table_alias().is_empty() ? table_or_subquery.table_name() : table_or_subquery.table_alias();
+        Scope scope;
+        for (auto& column : table->columns)
+            scope.append({ name, column.name, column.type, false });
+        scope.append({ name, "rowid", ValueType::Integer, true });
+
+        for (size_t i = 0; i < scope.size(); ++i)
+            table_of_column.append(sources.size());
+        full_scope.append(scope);
+        sources.append({ make<TableScanOperator>(m_database, table.value()), move(scope) });
+    }
+
+    Vector<const Expression*> conjuncts;
+    if (statement.where_clause())
+        split_conjuncts(*statement.where_clause(), conjuncts);
+    Vector<bool> is_applied;
+    Vector<u64> conjunct_tables;
+    for (auto* conjunct : conjuncts) {
+        is_applied.append(false);
+        auto tables = referenced_tables(*conjunct, full_scope, table_of_column);
+        // Something that can't be resolved is left until the end, where binding it will report why.
+        conjunct_tables.append(tables.value_or(~(u64)0));
+    }
+
+    for (size_t i = 0; i < conjuncts.size(); ++i) {
+        auto tables = conjunct_tables[i];
+        if (tables == 0 || (tables & (tables - 1)) != 0 || tables == ~(u64)0)
+            continue;
+        auto& source = sources[__builtin_ctzll(tables)];
+        auto predicate = bind(*conjuncts[i], source.scope);
+        if (predicate.is_error())
+            return predicate.release_error();
+        source.input = add_filter(move(source.input), predicate.release_value());
+        is_applied[i] = true;
+    }
+
+    // Join the tables in the order they were listed, each new one being the build side of a hash join
+    // if there is a condition that equates it with the tables joined so far.
+    NonnullOwnPtr<Operator> plan = sources.is_empty() ? NonnullOwnPtr<Operator>(make<SingleRowOperator>()) : move(sources.first().input);
+    Scope scope = sources.is_empty() ? Scope {} : sources.first().scope;
+    u64 joined_tables = 1;
+    for (size_t table = 1; table < sources.size(); ++table) {
+        auto& source = sources[table];
+        u64 table_bit = (u64)1 << table;
+
+        OwnPtr<BoundExpression> probe_key;
+        OwnPtr<BoundExpression> build_key;
+        for (size_t i = 0; i < conjuncts.size() && !probe_key; ++i) {
+            if (is_applied[i] || !is<BinaryOperatorExpression>(*conjuncts[i]))
+                continue;
+            auto& equality = static_cast<const BinaryOperatorExpression&>(*conjuncts[i]);
+            if (equality.type() != BinaryOperator::Equals)
+                continue;
+
+            auto lhs_tables = referenced_tables(*equality.lhs(), full_scope, table_of_column);
+            auto rhs_tables = referenced_tables(*equality.rhs(), full_scope, table_of_column);
+            if (!lhs_tables.has_value() || !rhs_tables.has_value())
+                continue;
+
+            const Expression* probe_side = nullptr;
+            const Expression* build_side = nullptr;
+            auto is_joined = [&](u64 tables) { return tables != 0 && (tables & ~joined_tables) == 0; };
+            if (is_joined(lhs_tables.value()) && rhs_tables.value() == table_bit) {
+                probe_side = equality.lhs();
+                build_side = equality.rhs();
+            } else if (is_joined(rhs_tables.value()) && lhs_tables.value() == table_bit) {
+                probe_side = equality.rhs();
+                build_side = equality.lhs();
+            } else {
+                continue;
+            }
+
+            auto bound_probe_key = bind(*probe_side, scope);
+            if (bound_probe_key.is_error())
+                return bound_probe_key.release_error();
+            auto bound_build_key = bind(*build_side, source.scope);
+            if (bound_build_key.is_error())
+                return bound_build_key.release_error();
+            probe_key = bound_probe_key.release_value();
+            build_key = bound_build_key.release_value();
+            is_applied[i] = true;
+        }
+
+        if (probe_key)
+            plan = make<HashJoinOperator>(move(plan), move(source.input), probe_key.release_nonnull(), build_key.release_nonnull());
+        else
+            plan = make<CrossJoinOperator>(move(plan), move(source.input));
+        scope.append(source.scope);
+        joined_tables |= table_bit;
+
+        for (size_t i = 0; i < conjuncts.size(); ++i) {
+            if (is_applied[i] || conjunct_tables[i] == 0 || (conjunct_tables[i] & ~joined_tables) != 0)
+                continue;
+            auto predicate = bind(*conjuncts[i], scope);
+            if (predicate.is_error())
+                return predicate.release_error();
+            plan = add_filter(move(plan), predicate.release_value());
+            is_applied[i] = true;
+        }
+    }
+
+    for (size_t i = 0; i < conjuncts.size(); ++i) {
+        if (is_applied[i])
+            continue;
+        auto predicate = bind(*conjuncts[i], scope);
+        if (predicate.is_error())
+            return predicate.release_error();
+        plan = add_filter(move(plan), predicate.release_value());
+    }
+
+    // The result columns, with "*" expanded.
+    struct OutputColumn {
+        String name;
+        const Expression* expression { nullptr };
+        size_t scope_index { 0 };
+    };
+    Vector<OutputColumn> outputs;
+    for (auto& result_column : statement.result_column_list()) {
+        switch (result_column.type()) {
+        case ResultType::All:
+        case ResultType::Table: {
+            if (scope.is_empty())
+                return String("No tables specified");
+            auto size_before = outputs.size();
+            for (size_t i = 0; i < scope.size(); ++i) {
+                if (scope[i].is_hidden)
+                    continue;
+                if (result_column.type() == ResultType::Table && !scope[i].table.equals_ignoring_case(result_column.table_name()))
+                    continue;
+                outputs.append({ scope[i].name, nullptr, i });
+            }
+            if (outputs.size() == size_before)
+                return String::formatted("No such table: {}", result_column.table_name());
+            break;
+        }
+        case ResultType::Expression: {
+            auto& expression = *result_column.expression();
+            String name = result_column.column_alias();
+            if (name.is_empty() && is<ColumnNameExpression>(expression))
+                name = static_cast<const ColumnNameExpression&>(expression).column_name();
+            if (name.is_empty())
+                name = expression_to_string(expression);
+            outputs.append({ move(name), &expression, 0 });
+            break;
+        }
+        }
+    }
+
+    // ORDER BY terms can also be the position or the alias of a result column.
+    struct OrderTarget {
+        Optional<size_t> output_index;
+        const Expression* expression { nullptr };
+        bool descending { false };
+        bool nulls_first { true };
+    };
+    Vector<OrderTarget> order_targets;
+    for (auto& term : statement.ordering_term_list()) {
+        OrderTarget target { {}, term.expression().ptr(), term.order() == Order::Descending, term.nulls() == Nulls::First };
+        if (is<NumericLiteral>(*term.expression())) {
+            auto position = numeric_literal_value(static_cast<const NumericLiteral&>(*term.expression()));
+            if (position.type() != ValueType::Integer || position.integer() < 1 || position.integer() > (i64)outputs.size())
+                return String::formatted("ORDER BY term out of range: {}", position);
+            target.output_index = position.integer() - 1;
+        } else if (is<ColumnNameExpression>(*term.expression())) {
+            auto& column = static_cast<const ColumnNameExpression&>(*term.expression());
+            for (size_t i = 0; i < statement.result_column_list().size() && column.table_name().is_empty(); ++i) {
+                auto& result_column = statement.result_column_list()[i];
+                if (result_column.type() == ResultType::Expression && result_column.column_alias().equals_ignoring_case(column.column_name())) {
+                    target.expression = result_column.expression().ptr();
+                    break;
+                }
+            }
+        }
+        order_targets.append(target);
+    }
+
+    // Grouping and aggregates.
+    Vector<AggregateCall> aggregate_calls;
+    for (auto& output : outputs) {
+        if (!output.expression)
+            continue;
+        if (auto error = collect_aggregates(*output.expression, aggregate_calls); error.has_value())
+            return error.release_value();
+    }
+    RefPtr<Expression> having;
+    if (statement.group_by_clause())
+        having = statement.group_by_clause()->having_clause();
+    if (having) {
+        if (auto error = collect_aggregates(*having, aggregate_calls); error.has_value())
+            return error.release_value();
+    }
+    for (auto& target : order_targets) {
+        if (auto error = collect_aggregates(*target.expression, aggregate_calls); error.has_value())
+            return error.release_value();
+    }
+
+    Optional<AggregateContext> aggregate_context;
+    if (statement.group_by_clause() || !aggregate_calls.is_empty()) {
+        AggregateContext context;
+        NonnullOwnPtrVector<BoundExpression> groups;
+        if (statement.group_by_clause()) {
+            for (auto& group : statement.group_by_clause()->group_by_list()) {
+                auto bound = bind(group, scope);
+                if (bound.is_error())
+                    return bound.release_error();
+                context.group_names.append(expression_to_string(group));
+                context.output_types.append(bound.value()->type());
+                Optional<size_t> column;
+                if (is<ColumnNameExpression>(group))
+                    column = resolve_column(scope, static_cast<const ColumnNameExpression&>(group)).value();
+                context.group_columns.append(column);
+                groups.append(bound.release_value());
+            }
+        }
+
+        Vector<Aggregate> aggregates;
+        for (auto& call : aggregate_calls) {
+            Aggregate aggregate { call.function, nullptr };
+            if (call.argument) {
+                auto argument = bind(*call.argument, scope);
+                if (argument.is_error())
+                    return argument.release_error();
+                aggregate.argument = argument.release_value();
+            }
+            context.aggregate_names.append(call.name);
+            context.output_types.append(aggregate.type());
+            aggregates.append(move(aggregate));
+        }
+
+        plan = make<HashAggregateOperator>(move(plan), move(groups), move(aggregates));
+        aggregate_context = move(context);
+
+        if (having) {
+            auto predicate = bind(*having, scope, &aggregate_context.value());
+            if (predicate.is_error())
+                return predicate.release_error();
+            plan = add_filter(move(plan), predicate.release_value());
+        }
+    }
+    auto* context = aggregate_context.has_value() ? &aggregate_context.value() : nullptr;
+
+    auto bind_output = [&](const OutputColumn& output) -> BindResult {
+        if (output.expression)
+            return bind(*output.expression, scope, context);
+        if (!context)
+            return BoundExpression::create_column(output.scope_index, scope[output.scope_index].type);
+        for (size_t i = 0; i < context->group_columns.size(); ++i) {
+            if (context->group_columns[i] == output.scope_index)
+                return BoundExpression::create_column(i, context->output_types[i]);
+        }
+        return String::formatted("Column {} must be in the GROUP BY clause or used in an aggregate function", output.name);
+    };
+
+    NonnullOwnPtrVector<BoundExpression> projections;
+    for (auto& output : outputs) {
+        auto bound = bind_output(output);
+        if (bound.is_error())
+            return bound.release_error();
+        projections.append(bound.release_value());
+    }
+
+    Vector<SortKey> sort_keys;
+    if (statement.select_all()) {
+        // Sort before projecting, so that rows can be sorted by what isn't in the result.
+        for (auto& target : order_targets) {
+            auto key = target.output_index.has_value() ? bind_output(outputs[target.output_index.value()]) : bind(*target.expression, scope, context);
+            if (key.is_error())
+                return key.release_error();
+            sort_keys.append({ key.release_value(), target.descending, target.nulls_first });
+        }
+        if (!sort_keys.is_empty())
+            plan = make<SortOperator>(move(plan), move(sort_keys));
+        plan = make<ProjectOperator>(move(plan), move(projections));
+    } else {
+        // With DISTINCT, duplicate rows are removed by grouping by all the result columns, and only
+        // those can be sorted by.
+        Vector<ValueType> types;
+        NonnullOwnPtrVector<BoundExpression> groups;
+        for (size_t i = 0; i < projections.size(); ++i) {
+            types.append(projections[i].type());
+            groups.append(BoundExpression::create_column(i, types[i]));
+        }
+        plan = make<ProjectOperator>(move(plan), move(projections));
+        plan = make<HashAggregateOperator>(move(plan), move(groups), Vector<Aggregate> {});
+
+        for (auto& target : order_targets) {
+            auto index = target.output_index;
+            for (size_t i = 0; i < outputs.size() && !index.has_value(); ++i) {
+                if (outputs[i].expression && expression_to_string(*outputs[i].expression) == expression_to_string(*target.expression))
+                    index = i;
+                else if (!outputs[i].expression && is<ColumnNameExpression>(*target.expression) && static_cast<const ColumnNameExpression&>(*target.expression).column_name().equals_ignoring_case(outputs[i].name))
+                    index = i;
+            }
+            if (!index.has_value())
+                return String::formatted("ORDER BY term {} must be in the result of SELECT DISTINCT", expression_to_string(*target.expression));
+            sort_keys.append({ BoundExpression::create_column(index.value(), types[index.value()]), target.descending, target.nulls_first });
+        }
+        if (!sort_keys.is_empty())
+            plan = make<SortOperator>(move(plan), move(sort_keys));
+    }
+
+    if (auto& limit_clause = statement.limit_clause()) {
+        auto limit = evaluate_constant(*limit_clause->limit_expression());
+        if (limit.is_error())
+            return limit.release_error();
+        size_t offset = 0;
+        if (limit_clause->offset_expression()) {
+            auto offset_value = evaluate_constant(*limit_clause->offset_expression());
+            if (offset_value.is_error())
+                return offset_value.release_error();
+            offset = max(offset_value.value().to_integer(), (i64)0);
+        }
+        // A negative limit means that there is none.
+        Optional<size_t> row_limit;
+        if (limit.value().to_integer() >= 0)
+            row_limit = limit.value().to_integer();
+        plan = make<LimitOperator>(move(plan), row_limit, offset);
+    }
+
+    ResultSet result;
+    for (auto& output : outputs)
+        result.column_names.append(output.name);
+    for (auto batch = plan->next(); batch.has_value(); batch = plan->next()) {
+        for (size_t row = 0; row < batch->row_count; ++row) {
+            Vector<Value> values;
+            values.ensure_capacity(batch->columns.size());
+            for (auto& column : batch->columns)
+                values.unchecked_append(column.value(row));
+            result.rows.append(move(values));
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Result.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+struct ResultSet {
+    Vector<String> column_names;
+    Vector<Vector<Value>> rows;
+    size_t changed_row_count { 0 };
+};
+
+// Runs statements against a database. A SELECT is planned into a tree of operators (see
+// Operators.h) that process rows in batches, column by column: filters are applied to each
+// table before it is joined, tables are joined with hash joins where the WHERE clause equates
+// their columns, and grouping uses a hash table.
+class Executor {
+public:
+    explicit Executor(Database& database)
+        : m_database(database)
+    {
+    }
+
+    Result<ResultSet, String> execute(const Statement&);
+
+private:
+    Result<ResultSet, String> execute_create_table(const CreateTable&);
+    Result<ResultSet, String> execute_drop_table(const DropTable&);
+    Result<ResultSet, String> execute_insert(const Insert&);
+    Result<ResultSet, String> execute_select(const Select&);
+
+    Database& m_database;
+};
+
+}
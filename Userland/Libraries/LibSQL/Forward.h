@@ -10,26 +10,35 @@ namespace SQL {
 class AddColumn;
 class AlterTable;
 class ASTNode;
+class Batch;
 class BetweenExpression;
 class BinaryOperatorExpression;
 class BlobLiteral;
+class BoundExpression;
+class BTree;
+class BufferPool;
 class CaseExpression;
 class CastExpression;
 class ChainedExpression;
 class CollateExpression;
 class ColumnDefinition;
 class ColumnNameExpression;
+class ColumnVector;
 class CommonTableExpression;
 class CommonTableExpressionList;
 class CreateTable;
+class Database;
 class Delete;
 class DropColumn;
 class DropTable;
 class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
+class Executor;
 class Expression;
+class FunctionCallExpression;
 class GroupByClause;
+class Heap;
 class InChainedExpression;
 class InSelectionExpression;
 class Insert;
@@ -45,7 +54,9 @@ class NestedExpression;
 class NullExpression;
 class NullLiteral;
 class NumericLiteral;
+class Operator;
 class OrderingTerm;
+class Page;
 class Parser;
 class QualifiedTableName;
 class RenameColumn;
@@ -61,4 +72,6 @@ class Token;
 class TypeName;
 class UnaryOperatorExpression;
 class Update;
+class Value;
+class WriteAheadLog;
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/WriteAheadLog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SQL {
+
+static constexpr char heap_magic[] = "SerenitySQL";
+static constexpr u32 heap_version = 1;
+
+static u32 load_u32(const u8* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+static void store_u32(u8* data, u32 value)
+{
+    ByteReader::store(data, AK::convert_between_host_and_little_endian(value));
+}
+
+// Header layout (all integers are little-endian):
+//  0: magic (12 bytes)
+// 12: version
+// 16: page size
+// 20: page count
+// 24: first free page
+// 28: catalog root page
+static bool decode_header(const u8* header, Heap::Snapshot& snapshot)
+{
+    if (memcmp(header, heap_magic, sizeof(heap_magic)) != 0)
+        return false;
+    if (load_u32(header + 12) != heap_version || load_u32(header + 16) != Heap::page_size)
+        return false;
+
+    snapshot.page_count = load_u32(header + 20);
+    snapshot.free_list_head = load_u32(header + 24);
+    snapshot.catalog_root = load_u32(header + 28);
+    return snapshot.page_count > 0 && snapshot.free_list_head < snapshot.page_count && snapshot.catalog_root < snapshot.page_count;
+}
+
+Result<NonnullRefPtr<Heap>, String> Heap::open(const String& path)
+{
+    int fd = ::open(path.characters(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return String::formatted("Could not open {}: {}", path, strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        auto error = String::formatted("Could not stat {}: {}", path, strerror(errno));
+        ::close(fd);
+        return error;
+    }
+
+    // A log that is left over from an earlier database with the same name doesn't belong to a new one.
+    auto log_path = String::formatted("{}-wal", path);
+    if (st.st_size == 0)
+        unlink(log_path.characters());
+
+    auto log_or_error = WriteAheadLog::open(log_path);
+    if (log_or_error.is_error()) {
+        ::close(fd);
+        return log_or_error.release_error();
+    }
+
+    auto heap = adopt_ref(*new Heap(path, fd, log_or_error.release_value()));
+    if (st.st_size == 0) {
+        if (!heap->initialize())
+            return String::formatted("Could not initialize {}", path);
+    } else if (!heap->load_header()) {
+        return String::formatted("{} is not a database", path);
+    }
+    return heap;
+}
+
+Heap::Heap(String path, int fd, NonnullOwnPtr<WriteAheadLog> log)
+    : m_path(move(path))
+    , m_fd(fd)
+    , m_log(move(log))
+{
+}
+
+Heap::~Heap()
+{
+    // Once everything is in the database file, the log isn't needed anymore.
+    if (checkpoint() && m_log->frame_count() == 0)
+        unlink(m_log->path().characters());
+    ::close(m_fd);
+}
+
+bool Heap::read_page(u32 index, Bytes buffer, Optional<u32> frame_limit)
+{
+    VERIFY(buffer.size() == page_size);
+    if (auto frame = m_log->find_frame(index, frame_limit); frame.has_value())
+        return m_log->read_frame(frame.value(), buffer);
+
+    auto nread = pread(m_fd, buffer.data(), page_size, (off_t)index * page_size);
+    if (nread < 0) {
+        perror("pread");
+        return false;
+    }
+    // The file ends before pages that haven't been checkpointed yet; what isn't in the log is all zeroes.
+    memset(buffer.data() + nread, 0, page_size - nread);
+    return true;
+}
+
+bool Heap::write_page(u32 index, ReadonlyBytes buffer)
+{
+    VERIFY(buffer.size() == page_size);
+    VERIFY(index > 0 && index < m_page_count);
+    return m_log->append_frame(index, buffer).has_value();
+}
+
+Optional<u32> Heap::commit()
+{
+    u8 header[page_size] {};
+    encode_header(header);
+    if (!m_log->has_uncommitted_frames() && memcmp(header, m_committed_header, header_size) == 0)
+        return m_log->last_commit_frame();
+
+    auto frame = m_log->append_frame(0, { header, page_size });
+    if (frame.has_value())
+        memcpy(m_committed_header, header, header_size);
+    return frame;
+}
+
+bool Heap::wait_until_durable(u32 frame)
+{
+    return m_log->wait_until_durable(frame);
+}
+
+bool Heap::sync()
+{
+    auto frame = commit();
+    if (!frame.has_value() || !wait_until_durable(frame.value()))
+        return false;
+    checkpoint_if_needed();
+    return true;
+}
+
+bool Heap::checkpoint()
+{
+    u32 frame_limit = 0;
+    auto pages = m_log->begin_checkpoint(frame_limit);
+    if (!pages.has_value())
+        return false;
+
+    bool success = true;
+    u8 buffer[page_size];
+    for (auto& page : pages.value()) {
+        if (!m_log->read_frame(page.frame, { buffer, page_size })) {
+            success = false;
+            break;
+        }
+        if (pwrite(m_fd, buffer, page_size, (off_t)page.page_index * page_size) != (ssize_t)page_size) {
+            perror("pwrite");
+            success = false;
+            break;
+        }
+    }
+    // The log can only start over once the pages are safely in the database file.
+    if (success && !pages->is_empty() && fsync(m_fd) < 0) {
+        perror("fsync");
+        success = false;
+    }
+    m_log->end_checkpoint(frame_limit, success);
+    return success;
+}
+
+void Heap::checkpoint_if_needed()
+{
+    if (m_log->frames_since_checkpoint() >= checkpoint_frame_count)
+        checkpoint();
+}
+
+Optional<Heap::Snapshot> Heap::begin_snapshot()
+{
+    Snapshot snapshot;
+    snapshot.frame_limit = m_log->begin_snapshot();
+
+    u8 header[page_size];
+    if (!read_page(0, { header, page_size }, snapshot.frame_limit) || !decode_header(header, snapshot)) {
+        m_log->end_snapshot(snapshot.frame_limit);
+        return {};
+    }
+    return snapshot;
+}
+
+void Heap::end_snapshot(const Snapshot& snapshot)
+{
+    m_log->end_snapshot(snapshot.frame_limit);
+}
+
+// A new database file starts out with just the header, which is written directly.
+bool Heap::initialize()
+{
+    u8 header[page_size] {};
+    encode_header(header);
+    if (pwrite(m_fd, header, page_size, 0) != (ssize_t)page_size) {
+        perror("pwrite");
+        return false;
+    }
+    if (fsync(m_fd) < 0) {
+        perror("fsync");
+        return false;
+    }
+    memcpy(m_committed_header, header, header_size);
+    return true;
+}
+
+bool Heap::load_header()
+{
+    u8 header[page_size];
+    Snapshot snapshot;
+    if (!read_page(0, { header, page_size }) || !decode_header(header, snapshot))
+        return false;
+
+    m_page_count = snapshot.page_count;
+    m_free_list_head = snapshot.free_list_head;
+    m_catalog_root = snapshot.catalog_root;
+    memcpy(m_committed_header, header, header_size);
+    return true;
+}
+
+void Heap::encode_header(u8* header) const
+{
+    memcpy(header, heap_magic, sizeof(heap_magic));
+    store_u32(header + 12, heap_version);
+    store_u32(header + 16, page_size);
+    store_u32(header + 20, m_page_count);
+    store_u32(header + 24, m_free_list_head);
+    store_u32(header + 28, m_catalog_root);
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/Result.h>
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <LibSQL/Forward.h>
+
+namespace SQL {
+
+// A database file: a sequence of fixed-size pages. The first one holds the header below, and
+// every other page belongs to a B-tree or is on the free list. Pages are read and written
+// through a BufferPool, which caches them; the heap only does the file I/O.
+//
+// Pages are never written over in the database file directly: they go to its WriteAheadLog, and
+// a commit appends the header page after them. Checkpoints copy them into the database file once
+// the log has grown long enough, and when the heap is closed.
+class Heap : public RefCounted<Heap> {
+public:
+    static constexpr size_t page_size = 4096;
+    static constexpr u32 checkpoint_frame_count = 1000;
+
+    // The database as of a commit, for a reader that shouldn't see later ones.
+    struct Snapshot {
+        u32 frame_limit { 0 };
+        u32 page_count { 1 };
+        u32 free_list_head { 0 };
+        u32 catalog_root { 0 };
+    };
+
+    static Result<NonnullRefPtr<Heap>, String> open(const String& path);
+    ~Heap();
+
+    const String& path() const { return m_path; }
+    WriteAheadLog& log() { return *m_log; }
+
+    // Reads the page as of a snapshot's frame limit, or as the writer last wrote it.
+    bool read_page(u32 index, Bytes, Optional<u32> frame_limit = {});
+    bool write_page(u32 index, ReadonlyBytes);
+
+    // Appends the header to the log, which commits the pages written since the last commit, and
+    // returns the frame to wait for. Nothing is appended if nothing changed.
+    Optional<u32> commit();
+    bool wait_until_durable(u32 frame);
+    // Commits, and waits for the commit to reach the disk.
+    bool sync();
+
+    bool checkpoint();
+    void checkpoint_if_needed();
+
+    Optional<Snapshot> begin_snapshot();
+    void end_snapshot(const Snapshot&);
+
+    u32 page_count() const { return m_page_count; }
+    void set_page_count(u32 page_count) { m_page_count = page_count; }
+
+    // The first page of the list of pages that were freed, each of which points at the next one.
+    u32 free_list_head() const { return m_free_list_head; }
+    void set_free_list_head(u32 index) { m_free_list_head = index; }
+
+    // The root page of the B-tree that holds the definitions of all the tables.
+    u32 catalog_root() const { return m_catalog_root; }
+    void set_catalog_root(u32 index) { m_catalog_root = index; }
+
+private:
+    static constexpr size_t header_size = 32;
+
+    Heap(String path, int fd, NonnullOwnPtr<WriteAheadLog>);
+
+    bool initialize();
+    bool load_header();
+    void encode_header(u8* header) const;
+
+    String m_path;
+    int m_fd { -1 };
+    NonnullOwnPtr<WriteAheadLog> m_log;
+    // The header as of the last commit, to tell whether there's anything to commit.
+    u8 m_committed_header[header_size] {};
+    u32 m_page_count { 1 };
+    u32 m_free_list_head { 0 };
+    u32 m_catalog_root { 0 };
+};
+
+}
@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MergeSort.h>
+#include <LibSQL/Operators.h>
+
+namespace SQL {
+
+static Vector<u32> row_range(size_t begin, size_t end)
+{
+    Vector<u32> rows;
+    rows.resize(end - begin);
+    for (size_t i = begin; i < end; ++i)
+        rows[i - begin] = i;
+    return rows;
+}
+
+TableScanOperator::TableScanOperator(Database& database, const TableDefinition& table)
+    : m_table(table)
+    , m_tree(database.pool(), table.root_page)
+{
+}
+
+Optional<Batch> TableScanOperator::next()
+{
+    if (!m_iterator.has_value())
+        m_iterator = m_tree.begin();
+    auto& it = m_iterator.value();
+    if (it.is_end())
+        return {};
+
+    Batch batch;
+    for (auto& column : m_table.columns)
+        batch.columns.append(ColumnVector(column.type));
+    batch.columns.append(ColumnVector(ValueType::Integer));
+    for (auto& column : batch.columns)
+        column.ensure_capacity(Batch::batch_size);
+
+    auto column_count = m_table.columns.size();
+    for (; !it.is_end() && batch.row_count < Batch::batch_size; ++it) {
+        auto values = decode_row(it.value());
+        for (size_t i = 0; i < column_count; ++i) {
+            // Values were converted to the type of their column when they were inserted.
+            if (values.has_value() && i < values->size() && values->at(i).type() == m_table.columns[i].type)
+                batch.columns[i].append(values->at(i));
+            else
+                batch.columns[i].append_null();
+        }
+        batch.columns[column_count].append_integer(Database::row_id_for_key(it.key()));
+        ++batch.row_count;
+    }
+    return batch;
+}
+
+Optional<Batch> SingleRowOperator::next()
+{
+    if (m_done)
+        return {};
+    m_done = true;
+    Batch batch;
+    batch.row_count = 1;
+    return batch;
+}
+
+FilterOperator::FilterOperator(NonnullOwnPtr<Operator> input, NonnullOwnPtr<BoundExpression> predicate)
+    : m_input(move(input))
+    , m_predicate(move(predicate))
+{
+}
+
+Optional<Batch> FilterOperator::next()
+{
+    for (;;) {
+        auto batch = m_input->next();
+        if (!batch.has_value())
+            return {};
+
+        Vector<u32> selected;
+        selected.ensure_capacity(batch->row_count);
+        m_predicate->with_values(*batch, [&](const ColumnVector& values) {
+            for (size_t i = 0; i < batch->row_count; ++i) {
+                if (truth_value(values, i).value_or(false))
+                    selected.unchecked_append(i);
+            }
+        });
+
+        if (selected.size() == batch->row_count)
+            return batch;
+        if (!selected.is_empty())
+            return batch->gather(selected);
+    }
+}
+
+ProjectOperator::ProjectOperator(NonnullOwnPtr<Operator> input, NonnullOwnPtrVector<BoundExpression> expressions)
+    : m_input(move(input))
+    , m_expressions(move(expressions))
+{
+}
+
+Optional<Batch> ProjectOperator::next()
+{
+    auto batch = m_input->next();
+    if (!batch.has_value())
+        return {};
+
+    Batch result;
+    result.row_count = batch->row_count;
+    result.columns.ensure_capacity(m_expressions.size());
+    for (auto& expression : m_expressions)
+        result.columns.unchecked_append(expression.evaluate(*batch));
+    return result;
+}
+
+HashJoinOperator::HashJoinOperator(NonnullOwnPtr<Operator> probe, NonnullOwnPtr<Operator> build, NonnullOwnPtr<BoundExpression> probe_key, NonnullOwnPtr<BoundExpression> build_key)
+    : m_probe(move(probe))
+    , m_build(move(build))
+    , m_probe_key(move(probe_key))
+    , m_build_key(move(build_key))
+{
+}
+
+void HashJoinOperator::build()
+{
+    m_is_built = true;
+    for (auto batch = m_build->next(); batch.has_value(); batch = m_build->next())
+        m_build_rows.extend(*batch);
+    if (m_build_rows.row_count == 0)
+        return;
+
+    // NULL is not equal to anything, so rows with a NULL key never match.
+    m_build_key->with_values(m_build_rows, [&](const ColumnVector& keys) {
+        for (size_t i = 0; i < m_build_rows.row_count; ++i) {
+            if (!keys.is_null(i))
+                m_build_table.ensure(keys.value(i)).append(i);
+        }
+    });
+}
+
+Optional<Batch> HashJoinOperator::next()
+{
+    if (!m_is_built)
+        build();
+
+    for (;;) {
+        auto batch = m_probe->next();
+        if (!batch.has_value())
+            return {};
+        if (m_build_table.is_empty())
+            continue;
+
+        Vector<u32> probe_rows;
+        Vector<u32> build_rows;
+        m_probe_key->with_values(*batch, [&](const ColumnVector& keys) {
+            for (size_t i = 0; i < batch->row_count; ++i) {
+                if (keys.is_null(i))
+                    continue;
+                auto it = m_build_table.find(keys.value(i));
+                if (it == m_build_table.end())
+                    continue;
+                for (auto build_row : it->value) {
+                    probe_rows.append(i);
+                    build_rows.append(build_row);
+                }
+            }
+        });
+        if (probe_rows.is_empty())
+            continue;
+
+        auto result = batch->gather(probe_rows);
+        auto build_columns = m_build_rows.gather(build_rows);
+        result.columns.append(move(build_columns.columns));
+        return result;
+    }
+}
+
+CrossJoinOperator::CrossJoinOperator(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right)
+    : m_left(move(left))
+    , m_right(move(right))
+{
+}
+
+Optional<Batch> CrossJoinOperator::next()
+{
+    if (!m_right_rows.has_value()) {
+        m_right_rows = Batch {};
+        for (auto batch = m_right->next(); batch.has_value(); batch = m_right->next())
+            m_right_rows->extend(*batch);
+    }
+
+    for (;;) {
+        auto batch = m_left->next();
+        if (!batch.has_value())
+            return {};
+
+        auto right_count = m_right_rows->row_count;
+        if (right_count == 0)
+            continue;
+
+        Vector<u32> left_rows;
+        Vector<u32> right_rows;
+        left_rows.ensure_capacity(batch->row_count * right_count);
+        right_rows.ensure_capacity(batch->row_count * right_count);
+        for (size_t i = 0; i < batch->row_count; ++i) {
+            for (size_t j = 0; j < right_count; ++j) {
+                left_rows.unchecked_append(i);
+                right_rows.unchecked_append(j);
+            }
+        }
+
+        auto result = batch->gather(left_rows);
+        auto right_columns = m_right_rows->gather(right_rows);
+        result.columns.append(move(right_columns.columns));
+        return result;
+    }
+}
+
+ValueType Aggregate::type() const
+{
+    if (function == AggregateFunction::Count)
+        return ValueType::Integer;
+
+    auto argument_type = argument->type();
+    switch (function) {
+    case AggregateFunction::Sum:
+        if (argument_type == ValueType::Null || argument_type == ValueType::Integer)
+            return argument_type;
+        return ValueType::Real;
+    case AggregateFunction::Average:
+        return argument_type == ValueType::Null ? ValueType::Null : ValueType::Real;
+    default:
+        return argument_type;
+    }
+}
+
+HashAggregateOperator::HashAggregateOperator(NonnullOwnPtr<Operator> input, NonnullOwnPtrVector<BoundExpression> groups, Vector<Aggregate> aggregates)
+    : m_input(move(input))
+    , m_groups(move(groups))
+    , m_aggregates(move(aggregates))
+{
+}
+
+struct GroupKeyTraits : public GenericTraits<Vector<Value>> {
+    static unsigned hash(const Vector<Value>& values)
+    {
+        unsigned hash = 0;
+        for (auto& value : values)
+            hash = pair_int_hash(hash, value.hash());
+        return hash;
+    }
+};
+
+void HashAggregateOperator::aggregate()
+{
+    m_is_aggregated = true;
+
+    HashMap<Vector<Value>, u32, GroupKeyTraits> group_indices_by_key;
+    Vector<Vector<Value>> group_keys;
+    Vector<Vector<State>> states;
+    states.resize(m_aggregates.size());
+
+    auto add_group = [&](Vector<Value> key) -> u32 {
+        u32 index = group_keys.size();
+        group_indices_by_key.set(key, index);
+        group_keys.append(move(key));
+        for (auto& aggregate_states : states)
+            aggregate_states.append(State {});
+        return index;
+    };
+
+    if (m_groups.is_empty())
+        add_group({});
+
+    Vector<u32> group_indices;
+    for (auto batch = m_input->next(); batch.has_value(); batch = m_input->next()) {
+        group_indices.clear_with_capacity();
+        group_indices.resize(batch->row_count);
+        if (!m_groups.is_empty()) {
+            Vector<ColumnVector> keys;
+            for (auto& group : m_groups)
+                keys.append(group.evaluate(*batch));
+            for (size_t i = 0; i < batch->row_count; ++i) {
+                Vector<Value> key;
+                key.ensure_capacity(keys.size());
+                for (auto& column : keys)
+                    key.unchecked_append(column.value(i));
+                if (auto it = group_indices_by_key.find(key); it != group_indices_by_key.end())
+                    group_indices[i] = it->value;
+                else
+                    group_indices[i] = add_group(move(key));
+            }
+        }
+
+        for (size_t i = 0; i < m_aggregates.size(); ++i)
+            update(m_aggregates[i], states[i], group_indices, *batch);
+    }
+
+    for (auto& group : m_groups)
+        m_output.columns.append(ColumnVector(group.type()));
+    for (auto& aggregate : m_aggregates)
+        m_output.columns.append(ColumnVector(aggregate.type()));
+    m_output.row_count = group_keys.size();
+
+    for (size_t group = 0; group < group_keys.size(); ++group) {
+        for (size_t i = 0; i < m_groups.size(); ++i)
+            m_output.columns[i].append(group_keys[group][i]);
+
+        for (size_t i = 0; i < m_aggregates.size(); ++i) {
+            auto& aggregate = m_aggregates[i];
+            auto& state = states[i][group];
+            auto& column = m_output.columns[m_groups.size() + i];
+            if (aggregate.type() == ValueType::Null || (aggregate.function != AggregateFunction::Count && state.count == 0)) {
+                column.append_null();
+                continue;
+            }
+            switch (aggregate.function) {
+            case AggregateFunction::Count:
+                column.append_integer(state.count);
+                break;
+            case AggregateFunction::Sum:
+                if (column.type() == ValueType::Integer)
+                    column.append_integer(state.integer_sum);
+                else
+                    column.append_real(state.real_sum + (double)state.integer_sum);
+                break;
+            case AggregateFunction::Average:
+                column.append_real((state.real_sum + (double)state.integer_sum) / (double)state.count);
+                break;
+            case AggregateFunction::Minimum:
+            case AggregateFunction::Maximum:
+                column.append(state.extreme);
+                break;
+            }
+        }
+    }
+}
+
+void HashAggregateOperator::update(const Aggregate& aggregate, Vector<State>& states, const Vector<u32>& group_indices, const Batch& batch)
+{
+    auto count = batch.row_count;
+    if (!aggregate.argument) {
+        for (size_t i = 0; i < count; ++i)
+            ++states[group_indices[i]].count;
+        return;
+    }
+
+    aggregate.argument->with_values(batch, [&](const ColumnVector& values) {
+        switch (aggregate.function) {
+        case AggregateFunction::Count:
+            for (size_t i = 0; i < count; ++i) {
+                if (!values.is_null(i))
+                    ++states[group_indices[i]].count;
+            }
+            break;
+        case AggregateFunction::Sum:
+        case AggregateFunction::Average:
+            if (values.type() == ValueType::Integer) {
+                auto& integers = values.integers();
+                for (size_t i = 0; i < count; ++i) {
+                    if (values.is_null(i))
+                        continue;
+                    auto& state = states[group_indices[i]];
+                    state.integer_sum += integers[i];
+                    ++state.count;
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    if (values.is_null(i))
+                        continue;
+                    auto& state = states[group_indices[i]];
+                    state.real_sum += values.real_at(i);
+                    ++state.count;
+                }
+            }
+            break;
+        case AggregateFunction::Minimum:
+        case AggregateFunction::Maximum: {
+            auto wanted_sign = aggregate.function == AggregateFunction::Minimum ? -1 : 1;
+            for (size_t i = 0; i < count; ++i) {
+                if (values.is_null(i))
+                    continue;
+                auto& state = states[group_indices[i]];
+                auto value = values.value(i);
+                if (state.count++ == 0 || value.compare(state.extreme) * wanted_sign > 0)
+                    state.extreme = move(value);
+            }
+            break;
+        }
+        }
+    });
+}
+
+Optional<Batch> HashAggregateOperator::next()
+{
+    if (!m_is_aggregated)
+        aggregate();
+    if (m_output_offset >= m_output.row_count)
+        return {};
+
+    auto end = min(m_output_offset + Batch::batch_size, m_output.row_count);
+    auto batch = m_output.gather(row_range(m_output_offset, end));
+    m_output_offset = end;
+    return batch;
+}
+
+SortOperator::SortOperator(NonnullOwnPtr<Operator> input, Vector<SortKey> keys)
+    : m_input(move(input))
+    , m_keys(move(keys))
+{
+}
+
+void SortOperator::sort()
+{
+    m_is_sorted = true;
+    for (auto batch = m_input->next(); batch.has_value(); batch = m_input->next())
+        m_rows.extend(*batch);
+
+    Vector<ColumnVector> key_values;
+    for (auto& key : m_keys)
+        key_values.append(key.expression->evaluate(m_rows));
+
+    m_order = row_range(0, m_rows.row_count);
+    merge_sort(m_order, [&](u32 a, u32 b) {
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            auto& values = key_values[i];
+            auto a_is_null = values.is_null(a);
+            auto b_is_null = values.is_null(b);
+            if (a_is_null != b_is_null)
+                return m_keys[i].nulls_first ? a_is_null : b_is_null;
+            if (a_is_null)
+                continue;
+            auto result = values.compare_rows(a, values, b);
+            if (result != 0)
+                return m_keys[i].descending ? result > 0 : result < 0;
+        }
+        return false;
+    });
+}
+
+Optional<Batch> SortOperator::next()
+{
+    if (!m_is_sorted)
+        sort();
+    if (m_output_offset >= m_order.size())
+        return {};
+
+    auto end = min(m_output_offset + Batch::batch_size, m_order.size());
+    Vector<u32> rows;
+    rows.append(m_order.data() + m_output_offset, end - m_output_offset);
+    m_output_offset = end;
+    return m_rows.gather(rows);
+}
+
+LimitOperator::LimitOperator(NonnullOwnPtr<Operator> input, Optional<size_t> limit, size_t offset)
+    : m_input(move(input))
+    , m_remaining(limit)
+    , m_to_skip(offset)
+{
+}
+
+Optional<Batch> LimitOperator::next()
+{
+    for (;;) {
+        // Once the limit is reached, the input isn't asked for any more rows.
+        if (m_remaining.has_value() && m_remaining.value() == 0)
+            return {};
+
+        auto batch = m_input->next();
+        if (!batch.has_value())
+            return {};
+
+        auto begin = min(m_to_skip, batch->row_count);
+        m_to_skip -= begin;
+        auto end = batch->row_count;
+        if (m_remaining.has_value()) {
+            end = min(end, begin + m_remaining.value());
+            m_remaining = m_remaining.value() - (end - begin);
+        }
+
+        if (begin == 0 && end == batch->row_count)
+            return batch;
+        if (begin < end)
+            return batch->gather(row_range(begin, end));
+    }
+}
+
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Optional.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/Batch.h>
+#include <LibSQL/BoundExpression.h>
+#include <LibSQL/Database.h>
+
+namespace SQL {
+
+// A query is run by a tree of operators, each of which pulls batches of rows from its inputs
+// and produces batches for its parent. Operators that need all of their input (like sorting and
+// aggregation) only consume it when they are first asked for a batch.
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns the next batch of rows, or nothing once all of them have been returned.
+    virtual Optional<Batch> next() = 0;
+};
+
+// The columns of a table, followed by the row ID.
+class TableScanOperator final : public Operator {
+public:
+    TableScanOperator(Database&, const TableDefinition&);
+    virtual Optional<Batch> next() override;
+
+private:
+    TableDefinition m_table;
+    BTree m_tree;
+    Optional<BTree::Iterator> m_iterator;
+};
+
+// A single row without any columns, for queries without a FROM clause.
+class SingleRowOperator final : public Operator {
+public:
+    virtual Optional<Batch> next() override;
+
+private:
+    bool m_done { false };
+};
+
+class FilterOperator final : public Operator {
+public:
+    FilterOperator(NonnullOwnPtr<Operator>, NonnullOwnPtr<BoundExpression> predicate);
+    virtual Optional<Batch> next() override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullOwnPtr<BoundExpression> m_predicate;
+};
+
+class ProjectOperator final : public Operator {
+public:
+    ProjectOperator(NonnullOwnPtr<Operator>, NonnullOwnPtrVector<BoundExpression>);
+    virtual Optional<Batch> next() override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullOwnPtrVector<BoundExpression> m_expressions;
+};
+
+// An inner join of the rows whose keys are equal, which puts the rows of the build input into a
+// hash table and then looks up the rows of the probe input in it. The output has the columns of
+// the probe input followed by the columns of the build input.
+class HashJoinOperator final : public Operator {
+public:
+    HashJoinOperator(NonnullOwnPtr<Operator> probe, NonnullOwnPtr<Operator> build, NonnullOwnPtr<BoundExpression> probe_key, NonnullOwnPtr<BoundExpression> build_key);
+    virtual Optional<Batch> next() override;
+
+private:
+    void build();
+
+    NonnullOwnPtr<Operator> m_probe;
+    NonnullOwnPtr<Operator> m_build;
+    NonnullOwnPtr<BoundExpression> m_probe_key;
+    NonnullOwnPtr<BoundExpression> m_build_key;
+
+    bool m_is_built { false };
+    Batch m_build_rows;
+    HashMap<Value, Vector<u32>> m_build_table;
+};
+
+// Every row of the left input with every row of the right one.
+class CrossJoinOperator final : public Operator {
+public:
+    CrossJoinOperator(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right);
+    virtual Optional<Batch> next() override;
+
+private:
+    NonnullOwnPtr<Operator> m_left;
+    NonnullOwnPtr<Operator> m_right;
+    Optional<Batch> m_right_rows;
+};
+
+enum class AggregateFunction {
+    Count,
+    Sum,
+    Average,
+    Minimum,
+    Maximum,
+};
+
+struct Aggregate {
+    AggregateFunction function;
+    // Null for COUNT(*).
+    OwnPtr<BoundExpression> argument;
+
+    ValueType type() const;
+};
+
+// Groups the rows by the values of the grouping expressions. The output has a row for each group,
+// with the values of the grouping expressions followed by the values of the aggregates. Without
+// grouping expressions, there is a single group, even if there are no rows.
+class HashAggregateOperator final : public Operator {
+public:
+    HashAggregateOperator(NonnullOwnPtr<Operator>, NonnullOwnPtrVector<BoundExpression> groups, Vector<Aggregate>);
+    virtual Optional<Batch> next() override;
+
+private:
+    struct State {
+        i64 count { 0 };
+        i64 integer_sum { 0 };
+        double real_sum { 0 };
+        Value extreme;
+    };
+
+    void aggregate();
+    void update(const Aggregate&, Vector<State>&, const Vector<u32>& group_indices, const Batch&);
+
+    NonnullOwnPtr<Operator> m_input;
+    NonnullOwnPtrVector<BoundExpression> m_groups;
+    Vector<Aggregate> m_aggregates;
+
+    bool m_is_aggregated { false };
+    Batch m_output;
+    size_t m_output_offset { 0 };
+};
+
+struct SortKey {
+    NonnullOwnPtr<BoundExpression> expression;
+    bool descending { false };
+    bool nulls_first { true };
+};
+
+class SortOperator final : public Operator {
+public:
+    SortOperator(NonnullOwnPtr<Operator>, Vector<SortKey>);
+    virtual Optional<Batch> next() override;
+
+private:
+    void sort();
+
+    NonnullOwnPtr<Operator> m_input;
+    Vector<SortKey> m_keys;
+
+    bool m_is_sorted { false };
+    Batch m_rows;
+    Vector<u32> m_order;
+    size_t m_output_offset { 0 };
+};
+
+class LimitOperator final : public Operator {
+public:
+    LimitOperator(NonnullOwnPtr<Operator>, Optional<size_t> limit, size_t offset);
+    virtual Optional<Batch> next() override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Optional<size_t> m_remaining;
+    size_t m_to_skip { 0 };
+};
+
+}
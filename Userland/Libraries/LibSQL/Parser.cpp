@@ -365,7 +365,6 @@ NonnullRefPtr<Expression> Parser::parse_expression()
         expression = parse_secondary_expression(move(expression));
 
     // FIXME: Parse 'bind-parameter'.
-    // FIXME: Parse 'function-name'.
     // FIXME: Parse 'raise-function'.
 
     --m_parser_state.m_current_expression_depth;
@@ -519,27 +518,107 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_column_name_expression(String
         }
     } else {
         column_name = move(first_identifier);
+
+        if (match(TokenType::ParenOpen))
+            return parse_function_call_expression(move(column_name));
     }
 
     return create_ast_node<ColumnNameExpression>(move(schema_name), move(table_name), move(column_name));
 }
 
+NonnullRefPtr<Expression> Parser::parse_function_call_expression(String name)
+{
+    // https://sqlite.org/lang_expr.html (function-name)
+    consume(TokenType::ParenOpen);
+
+    NonnullRefPtrVector<Expression> arguments;
+    if (!consume_if(TokenType::Asterisk) && !match(TokenType::ParenClose))
+        parse_comma_separated_list(false, [&]() { arguments.append(parse_expression()); });
+
+    consume(TokenType::ParenClose);
+    return create_ast_node<FunctionCallExpression>(move(name), move(arguments));
+}
+
+// https://sqlite.org/lang_expr.html#operators
+// Higher numbers bind more tightly.
+static int operator_precedence(BinaryOperator type)
+{
+    switch (type) {
+    case BinaryOperator::Concatenate:
+        return 9;
+    case BinaryOperator::Multiplication:
+    case BinaryOperator::Division:
+    case BinaryOperator::Modulo:
+        return 8;
+    case BinaryOperator::Plus:
+    case BinaryOperator::Minus:
+        return 7;
+    case BinaryOperator::ShiftLeft:
+    case BinaryOperator::ShiftRight:
+    case BinaryOperator::BitwiseAnd:
+    case BinaryOperator::BitwiseOr:
+        return 6;
+    case BinaryOperator::LessThan:
+    case BinaryOperator::LessThanEquals:
+    case BinaryOperator::GreaterThan:
+    case BinaryOperator::GreaterThanEquals:
+        return 5;
+    case BinaryOperator::Equals:
+    case BinaryOperator::NotEquals:
+        return 4;
+    case BinaryOperator::And:
+        return 2;
+    case BinaryOperator::Or:
+        return 1;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static int operator_precedence(UnaryOperator type)
+{
+    return type == UnaryOperator::Not ? 3 : 10;
+}
+
+// The operand of an operator is parsed as the whole rest of the expression, so in "1 * 2 + 3" the
+// operand of * is "2 + 3". These move the operator down into the leftmost operand of such an operand
+// until that operand's operator binds less tightly, which gives "(1 * 2) + 3". As binary operators
+// are left-associative, they are also moved below operators that bind as tightly as they do.
+static NonnullRefPtr<Expression> create_binary_operator_expression(BinaryOperator type, NonnullRefPtr<Expression> lhs, NonnullRefPtr<Expression> rhs)
+{
+    if (is<BinaryOperatorExpression>(*rhs)) {
+        const auto& binary = static_cast<const BinaryOperatorExpression&>(*rhs);
+        if (operator_precedence(binary.type()) <= operator_precedence(type))
+            return create_ast_node<BinaryOperatorExpression>(binary.type(), create_binary_operator_expression(type, move(lhs), binary.lhs()), binary.rhs());
+    }
+    return create_ast_node<BinaryOperatorExpression>(type, move(lhs), move(rhs));
+}
+
+static NonnullRefPtr<Expression> create_unary_operator_expression(UnaryOperator type, NonnullRefPtr<Expression> expression)
+{
+    if (is<BinaryOperatorExpression>(*expression)) {
+        const auto& binary = static_cast<const BinaryOperatorExpression&>(*expression);
+        if (operator_precedence(binary.type()) < operator_precedence(type))
+            return create_ast_node<BinaryOperatorExpression>(binary.type(), create_unary_operator_expression(type, binary.lhs()), binary.rhs());
+    }
+    return create_ast_node<UnaryOperatorExpression>(type, move(expression));
+}
+
 Optional<NonnullRefPtr<Expression>> Parser::parse_unary_operator_expression()
 {
     if (consume_if(TokenType::Minus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Minus, parse_expression());
+        return create_unary_operator_expression(UnaryOperator::Minus, parse_expression());
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Plus, parse_expression());
+        return create_unary_operator_expression(UnaryOperator::Plus, parse_expression());
 
     if (consume_if(TokenType::Tilde))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::BitwiseNot, parse_expression());
+        return create_unary_operator_expression(UnaryOperator::BitwiseNot, parse_expression());
 
     if (consume_if(TokenType::Not)) {
         if (match(TokenType::Exists))
             return parse_exists_expression(true);
         else
-            return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Not, parse_expression());
+            return create_unary_operator_expression(UnaryOperator::Not, parse_expression());
     }
 
     return {};
@@ -548,58 +627,58 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_unary_operator_expression()
 Optional<NonnullRefPtr<Expression>> Parser::parse_binary_operator_expression(NonnullRefPtr<Expression> lhs)
 {
     if (consume_if(TokenType::DoublePipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Concatenate, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Concatenate, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Asterisk))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Multiplication, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Multiplication, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Divide))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Division, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Division, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Modulus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Modulo, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Modulo, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Plus, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Plus, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Minus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Minus, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Minus, move(lhs), parse_expression());
 
     if (consume_if(TokenType::ShiftLeft))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftLeft, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::ShiftLeft, move(lhs), parse_expression());
 
     if (consume_if(TokenType::ShiftRight))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftRight, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::ShiftRight, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Ampersand))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseAnd, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::BitwiseAnd, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Pipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseOr, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::BitwiseOr, move(lhs), parse_expression());
 
     if (consume_if(TokenType::LessThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThan, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::LessThan, move(lhs), parse_expression());
 
     if (consume_if(TokenType::LessThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThanEquals, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::LessThanEquals, move(lhs), parse_expression());
 
     if (consume_if(TokenType::GreaterThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThan, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::GreaterThan, move(lhs), parse_expression());
 
     if (consume_if(TokenType::GreaterThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Equals) || consume_if(TokenType::EqualsEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Equals, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Equals, move(lhs), parse_expression());
 
     if (consume_if(TokenType::NotEquals1) || consume_if(TokenType::NotEquals2))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::NotEquals, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::NotEquals, move(lhs), parse_expression());
 
     if (consume_if(TokenType::And))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::And, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::And, move(lhs), parse_expression());
 
     if (consume_if(TokenType::Or))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Or, move(lhs), parse_expression());
+        return create_binary_operator_expression(BinaryOperator::Or, move(lhs), parse_expression());
 
     return {};
 }
@@ -934,10 +1013,15 @@ NonnullRefPtr<ResultColumn> Parser::parse_result_column()
             return create_ast_node<ResultColumn>(move(table_name));
     }
 
-    auto expression = table_name.is_null()
+    bool parsed_identifier = !table_name.is_null();
+    auto expression = !parsed_identifier
         ? parse_expression()
         : static_cast<NonnullRefPtr<Expression>>(*parse_column_name_expression(move(table_name), parsed_period));
 
+    // The identifier may only have been the start of a longer expression, like "column + 1".
+    if (parsed_identifier && match_secondary_expression())
+        expression = parse_secondary_expression(move(expression));
+
     String column_alias;
     if (consume_if(TokenType::As) || match(TokenType::Identifier))
         column_alias = consume(TokenType::Identifier).value();
@@ -74,6 +74,7 @@ private:
     bool match_secondary_expression() const;
     Optional<NonnullRefPtr<Expression>> parse_literal_value_expression();
     Optional<NonnullRefPtr<Expression>> parse_column_name_expression(String with_parsed_identifier = {}, bool with_parsed_period = false);
+    NonnullRefPtr<Expression> parse_function_call_expression(String name);
     Optional<NonnullRefPtr<Expression>> parse_unary_operator_expression();
     Optional<NonnullRefPtr<Expression>> parse_binary_operator_expression(NonnullRefPtr<Expression> lhs);
     Optional<NonnullRefPtr<Expression>> parse_chained_expression();
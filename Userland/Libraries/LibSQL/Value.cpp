@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <AK/StringHash.h>
+#include <LibSQL/Value.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace SQL {
+
+ValueType value_type_for_type_name(StringView type_name)
+{
+    auto name = type_name.to_string().to_uppercase();
+    if (name.contains("INT"))
+        return ValueType::Integer;
+    if (name.contains("CHAR") || name.contains("CLOB") || name.contains("TEXT"))
+        return ValueType::Text;
+    if (name.contains("REAL") || name.contains("FLOA") || name.contains("DOUB") || name.contains("NUM") || name.contains("DEC"))
+        return ValueType::Real;
+    return ValueType::Text;
+}
+
+StringView value_type_name(ValueType type)
+{
+    switch (type) {
+    case ValueType::Null:
+        return {};
+    case ValueType::Integer:
+        return "INTEGER";
+    case ValueType::Real:
+        return "REAL";
+    case ValueType::Text:
+        return "TEXT";
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Parses all of the text as a number, as an integer if it is one.
+static Optional<Value> parse_number(const String& text)
+{
+    if (auto integer = text.to_int<i64>(); integer.has_value())
+        return Value(integer.value());
+
+    if (text.is_empty())
+        return {};
+    char* end = nullptr;
+    auto real = strtod(text.characters(), &end);
+    if (end != text.characters() + text.length())
+        return {};
+    return Value(real);
+}
+
+i64 Value::to_integer() const
+{
+    switch (m_type) {
+    case ValueType::Null:
+        return 0;
+    case ValueType::Integer:
+        return m_integer;
+    case ValueType::Real:
+        return (i64)m_real;
+    case ValueType::Text:
+        return strtoll(m_text.characters(), nullptr, 10);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+double Value::to_real() const
+{
+    switch (m_type) {
+    case ValueType::Null:
+        return 0;
+    case ValueType::Integer:
+        return (double)m_integer;
+    case ValueType::Real:
+        return m_real;
+    case ValueType::Text:
+        return strtod(m_text.characters(), nullptr);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+String Value::to_string() const
+{
+    switch (m_type) {
+    case ValueType::Null:
+        return "NULL";
+    case ValueType::Integer:
+        return String::number(m_integer);
+    case ValueType::Real:
+        return String::formatted("{}", m_real);
+    case ValueType::Text:
+        return m_text;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Optional<Value> Value::converted_to(ValueType type) const
+{
+    if (m_type == type || m_type == ValueType::Null)
+        return *this;
+
+    switch (type) {
+    case ValueType::Null:
+        return {};
+    case ValueType::Integer:
+        if (m_type == ValueType::Real) {
+            if (m_real != trunc(m_real) || fabs(m_real) >= 9.2e18)
+                return {};
+            return Value((i64)m_real);
+        }
+        if (auto number = parse_number(m_text); number.has_value())
+            return number->converted_to(ValueType::Integer);
+        return {};
+    case ValueType::Real:
+        if (m_type == ValueType::Integer)
+            return Value((double)m_integer);
+        if (auto number = parse_number(m_text); number.has_value())
+            return Value(number->to_real());
+        return {};
+    case ValueType::Text:
+        return Value(to_string());
+    }
+    VERIFY_NOT_REACHED();
+}
+
+int Value::compare(const Value& other) const
+{
+    auto rank = [](ValueType type) {
+        switch (type) {
+        case ValueType::Null:
+            return 0;
+        case ValueType::Integer:
+        case ValueType::Real:
+            return 1;
+        case ValueType::Text:
+            return 2;
+        }
+        VERIFY_NOT_REACHED();
+    };
+
+    if (auto difference = rank(m_type) - rank(other.m_type); difference != 0)
+        return difference;
+
+    switch (m_type) {
+    case ValueType::Null:
+        return 0;
+    case ValueType::Text:
+        return strcmp(m_text.characters(), other.m_text.characters());
+    default:
+        break;
+    }
+
+    if (m_type == ValueType::Integer && other.m_type == ValueType::Integer)
+        return m_integer < other.m_integer ? -1 : (m_integer > other.m_integer ? 1 : 0);
+    auto a = to_real();
+    auto b = other.to_real();
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+unsigned Value::hash() const
+{
+    switch (m_type) {
+    case ValueType::Null:
+        return 0;
+    case ValueType::Integer:
+        return u64_hash(m_integer);
+    case ValueType::Real:
+        // Has to hash like the integer that it is equal to, if there is one.
+        if (m_real == trunc(m_real) && fabs(m_real) < 9.2e18)
+            return u64_hash((i64)m_real);
+        u64 bits;
+        memcpy(&bits, &m_real, sizeof(bits));
+        return u64_hash(bits);
+    case ValueType::Text:
+        return m_text.hash();
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ByteBuffer encode_row(const Vector<Value>& values)
+{
+    DuplexMemoryStream stream;
+    for (auto& value : values) {
+        stream << (u8)value.type();
+        switch (value.type()) {
+        case ValueType::Null:
+            break;
+        case ValueType::Integer:
+            stream << (LittleEndian<u64>)value.integer();
+            break;
+        case ValueType::Real: {
+            u64 bits;
+            auto real = value.real();
+            memcpy(&bits, &real, sizeof(bits));
+            stream << (LittleEndian<u64>)bits;
+            break;
+        }
+        case ValueType::Text:
+            stream << (LittleEndian<u16>)min(value.text().length(), (size_t)NumericLimits<u16>::max());
+            stream << value.text().bytes().trim(NumericLimits<u16>::max());
+            break;
+        }
+    }
+    return stream.copy_into_contiguous_buffer();
+}
+
+Optional<Vector<Value>> decode_row(ReadonlyBytes bytes)
+{
+    Vector<Value> values;
+    InputMemoryStream stream { bytes };
+    while (!stream.eof()) {
+        u8 type;
+        stream >> type;
+        switch ((ValueType)type) {
+        case ValueType::Null:
+            values.append(Value());
+            break;
+        case ValueType::Integer: {
+            LittleEndian<u64> integer;
+            stream >> integer;
+            values.append(Value((i64)(u64)integer));
+            break;
+        }
+        case ValueType::Real: {
+            LittleEndian<u64> bits;
+            stream >> bits;
+            u64 host_bits = bits;
+            double real;
+            memcpy(&real, &host_bits, sizeof(real));
+            values.append(Value(real));
+            break;
+        }
+        case ValueType::Text: {
+            LittleEndian<u16> length;
+            stream >> length;
+            if (stream.remaining() < length)
+                return {};
+            values.append(Value(String(bytes.slice(stream.offset(), length))));
+            stream.discard_or_error(length);
+            break;
+        }
+        default:
+            return {};
+        }
+        if (stream.handle_any_error())
+            return {};
+    }
+    return values;
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Traits.h>
+#include <AK/Vector.h>
+
+namespace SQL {
+
+enum class ValueType : u8 {
+    Null,
+    Integer,
+    Real,
+    Text,
+};
+
+// The type that the values of a column declared with the given type name are stored as,
+// following SQLite's rules for column affinity.
+ValueType value_type_for_type_name(StringView);
+StringView value_type_name(ValueType);
+
+class Value {
+public:
+    Value() = default;
+
+    explicit Value(i64 integer)
+        : m_type(ValueType::Integer)
+        , m_integer(integer)
+    {
+    }
+
+    explicit Value(double real)
+        : m_type(ValueType::Real)
+        , m_real(real)
+    {
+    }
+
+    explicit Value(String text)
+        : m_type(ValueType::Text)
+        , m_text(move(text))
+    {
+    }
+
+    ValueType type() const { return m_type; }
+    bool is_null() const { return m_type == ValueType::Null; }
+    bool is_numeric() const { return m_type == ValueType::Integer || m_type == ValueType::Real; }
+
+    i64 integer() const
+    {
+        VERIFY(m_type == ValueType::Integer);
+        return m_integer;
+    }
+
+    double real() const
+    {
+        VERIFY(m_type == ValueType::Real);
+        return m_real;
+    }
+
+    const String& text() const
+    {
+        VERIFY(m_type == ValueType::Text);
+        return m_text;
+    }
+
+    // Conversions as done by SQL operators: text that isn't a number is 0, and so is NULL.
+    i64 to_integer() const;
+    double to_real() const;
+    String to_string() const;
+
+    // Returns the value as stored in a column of the given type, or nothing if it can't be stored
+    // there without losing information. NULL goes into any column.
+    Optional<Value> converted_to(ValueType) const;
+
+    // NULLs come first, then numbers (in numerical order, whether they are integers or reals),
+    // then text. Unlike SQL's = operator, this treats two NULLs as equal.
+    int compare(const Value&) const;
+    bool operator==(const Value& other) const { return compare(other) == 0; }
+    bool operator!=(const Value& other) const { return compare(other) != 0; }
+
+    unsigned hash() const;
+
+private:
+    ValueType m_type { ValueType::Null };
+    i64 m_integer { 0 };
+    double m_real { 0 };
+    String m_text;
+};
+
+// Rows are stored in table B-trees as the sequence of their values, each one a type byte
+// followed by the value: 8 little-endian bytes for numbers, or a 2-byte size and the UTF-8 text.
+ByteBuffer encode_row(const Vector<Value>&);
+Optional<Vector<Value>> decode_row(ReadonlyBytes);
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<SQL::Value> : public GenericTraits<SQL::Value> {
+    static unsigned hash(const SQL::Value& value) { return value.hash(); }
+};
+
+template<>
+struct Formatter<SQL::Value> : Formatter<StringView> {
+    void format(FormatBuilder& builder, const SQL::Value& value)
+    {
+        Formatter<StringView>::format(builder, value.is_null() ? "NULL" : value.to_string());
+    }
+};
+
+}
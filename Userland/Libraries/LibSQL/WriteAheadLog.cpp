@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Random.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/WriteAheadLog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SQL {
+
+static constexpr char log_magic[] = "SQL-WAL";
+static constexpr u32 log_version = 1;
+
+// Log header layout (all integers are little-endian):
+//  0: magic (8 bytes)
+//  8: version
+// 12: page size
+// 16: sequence number, counting how often the log was started over
+// 20: salt (2 * 4 bytes), which every frame repeats
+//
+// Frame header layout, followed by the page:
+//  0: page index
+//  4: reserved
+//  8: salt (2 * 4 bytes)
+// 16: checksum (2 * 4 bytes) of the log header, all frames before this one, the first 8 bytes
+//     of this frame header, and the page
+static constexpr size_t log_header_size = 32;
+static constexpr size_t frame_header_size = 24;
+static constexpr size_t frame_size = frame_header_size + Heap::page_size;
+
+static u32 load_u32(const u8* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+static void store_u32(u8* data, u32 value)
+{
+    ByteReader::store(data, AK::convert_between_host_and_little_endian(value));
+}
+
+// A Fletcher-like checksum over 32-bit words, which depends on their order and is cheap enough to
+// compute for every frame.
+static void update_checksum(u32 checksum[2], ReadonlyBytes data)
+{
+    VERIFY(data.size() % 8 == 0);
+    for (size_t i = 0; i < data.size(); i += 8) {
+        checksum[0] += load_u32(data.offset(i)) + checksum[1];
+        checksum[1] += load_u32(data.offset(i + 4)) + checksum[0];
+    }
+}
+
+class MutexLocker {
+public:
+    explicit MutexLocker(pthread_mutex_t& mutex)
+        : m_mutex(mutex)
+    {
+        pthread_mutex_lock(&m_mutex);
+    }
+    ~MutexLocker() { pthread_mutex_unlock(&m_mutex); }
+
+private:
+    pthread_mutex_t& m_mutex;
+};
+
+Result<NonnullOwnPtr<WriteAheadLog>, String> WriteAheadLog::open(const String& path)
+{
+    int fd = ::open(path.characters(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return String::formatted("Could not open {}: {}", path, strerror(errno));
+
+    auto log = adopt_own(*new WriteAheadLog(path, fd));
+    if (!log->recover())
+        return String::formatted("Could not recover {}", path);
+    return log;
+}
+
+WriteAheadLog::WriteAheadLog(String path, int fd)
+    : m_path(move(path))
+    , m_fd(fd)
+{
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_sync_finished, nullptr);
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    ::close(m_fd);
+    pthread_cond_destroy(&m_sync_finished);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+off_t WriteAheadLog::frame_offset(u32 frame) const
+{
+    VERIFY(frame > 0);
+    return (off_t)log_header_size + (off_t)(frame - 1) * frame_size;
+}
+
+// Replays the log after it was opened: every frame up to the last commit whose checksum is right
+// (and everything before it) is taken over, and the rest is left to be overwritten.
+bool WriteAheadLog::recover()
+{
+    u8 header[log_header_size];
+    if (pread(m_fd, header, log_header_size, 0) != (ssize_t)log_header_size
+        || memcmp(header, log_magic, sizeof(log_magic)) != 0
+        || load_u32(header + 8) != log_version
+        || load_u32(header + 12) != Heap::page_size) {
+        return reset();
+    }
+
+    m_sequence = load_u32(header + 16);
+    m_salt[0] = load_u32(header + 20);
+    m_salt[1] = load_u32(header + 24);
+    m_checksum[0] = m_checksum[1] = 0;
+    update_checksum(m_checksum, { header, log_header_size });
+
+    u32 checksum[2] = { m_checksum[0], m_checksum[1] };
+    Vector<u32> uncommitted_page_indices;
+    u8 data[frame_size];
+    for (u32 number = 1;; ++number) {
+        if (pread(m_fd, data, frame_size, frame_offset(number)) != (ssize_t)frame_size)
+            break;
+        if (load_u32(data + 8) != m_salt[0] || load_u32(data + 12) != m_salt[1])
+            break;
+        update_checksum(checksum, { data, 8 });
+        update_checksum(checksum, { data + frame_header_size, Heap::page_size });
+        if (load_u32(data + 16) != checksum[0] || load_u32(data + 20) != checksum[1])
+            break;
+
+        auto page_index = load_u32(data);
+        uncommitted_page_indices.append(page_index);
+        if (page_index != 0)
+            continue;
+
+        for (size_t i = 0; i < uncommitted_page_indices.size(); ++i) {
+            auto frame_number = number - uncommitted_page_indices.size() + 1 + i;
+            m_frames_of_page.ensure(uncommitted_page_indices[i]).append(frame_number);
+        }
+        uncommitted_page_indices.clear_with_capacity();
+        m_last_commit_frame = number;
+        m_checksum[0] = checksum[0];
+        m_checksum[1] = checksum[1];
+    }
+
+    m_frame_count = m_last_commit_frame;
+    m_synced_frame_count = m_last_commit_frame;
+    m_durable_frame_count = m_last_commit_frame;
+    return true;
+}
+
+// Starts the log over with a new salt, so that the frames that are still in the file don't count.
+bool WriteAheadLog::reset()
+{
+    ++m_sequence;
+    m_salt[0] += 1;
+    m_salt[1] = get_random<u32>();
+
+    u8 header[log_header_size] {};
+    memcpy(header, log_magic, sizeof(log_magic));
+    store_u32(header + 8, log_version);
+    store_u32(header + 12, Heap::page_size);
+    store_u32(header + 16, m_sequence);
+    store_u32(header + 20, m_salt[0]);
+    store_u32(header + 24, m_salt[1]);
+    if (pwrite(m_fd, header, log_header_size, 0) != (ssize_t)log_header_size) {
+        perror("pwrite");
+        return false;
+    }
+    if (ftruncate(m_fd, log_header_size) < 0)
+        perror("ftruncate");
+
+    m_checksum[0] = m_checksum[1] = 0;
+    update_checksum(m_checksum, { header, log_header_size });
+
+    m_frames_of_page.clear();
+    m_frame_count = 0;
+    m_last_commit_frame = 0;
+    m_synced_frame_count = 0;
+    m_durable_frame_count = 0;
+    m_checkpointed_frame_count = 0;
+    return true;
+}
+
+Optional<u32> WriteAheadLog::find_frame(u32 page_index, Optional<u32> frame_limit)
+{
+    MutexLocker locker(m_mutex);
+    auto it = m_frames_of_page.find(page_index);
+    if (it == m_frames_of_page.end())
+        return {};
+
+    auto limit = frame_limit.value_or(m_frame_count);
+    auto& frames = it->value;
+    for (size_t i = frames.size(); i > 0; --i) {
+        if (frames[i - 1] <= limit)
+            return frames[i - 1];
+    }
+    return {};
+}
+
+bool WriteAheadLog::read_frame(u32 frame, Bytes buffer)
+{
+    VERIFY(buffer.size() == Heap::page_size);
+    if (pread(m_fd, buffer.data(), Heap::page_size, frame_offset(frame) + frame_header_size) != (ssize_t)Heap::page_size) {
+        perror("pread");
+        return false;
+    }
+    return true;
+}
+
+Optional<u32> WriteAheadLog::append_frame(u32 page_index, ReadonlyBytes page)
+{
+    VERIFY(page.size() == Heap::page_size);
+
+    u8 data[frame_size] {};
+    store_u32(data, page_index);
+    memcpy(data + frame_header_size, page.data(), Heap::page_size);
+
+    MutexLocker locker(m_mutex);
+    store_u32(data + 8, m_salt[0]);
+    store_u32(data + 12, m_salt[1]);
+    u32 checksum[2] = { m_checksum[0], m_checksum[1] };
+    update_checksum(checksum, { data, 8 });
+    update_checksum(checksum, page);
+    store_u32(data + 16, checksum[0]);
+    store_u32(data + 20, checksum[1]);
+
+    auto number = m_frame_count + 1;
+    if (pwrite(m_fd, data, frame_size, frame_offset(number)) != (ssize_t)frame_size) {
+        perror("pwrite");
+        return {};
+    }
+
+    m_frame_count = number;
+    m_checksum[0] = checksum[0];
+    m_checksum[1] = checksum[1];
+    m_frames_of_page.ensure(page_index).append(number);
+    if (page_index == 0)
+        m_last_commit_frame = number;
+    return number;
+}
+
+u32 WriteAheadLog::frame_count()
+{
+    MutexLocker locker(m_mutex);
+    return m_frame_count;
+}
+
+u32 WriteAheadLog::last_commit_frame()
+{
+    MutexLocker locker(m_mutex);
+    return m_last_commit_frame;
+}
+
+bool WriteAheadLog::has_uncommitted_frames()
+{
+    MutexLocker locker(m_mutex);
+    return m_frame_count > m_last_commit_frame;
+}
+
+bool WriteAheadLog::wait_until_durable(u32 frame)
+{
+    MutexLocker locker(m_mutex);
+    // A frame past the end belongs to a log that was started over, which only happens once all of
+    // it has reached the disk.
+    while (m_synced_frame_count < frame && frame <= m_frame_count) {
+        if (m_is_syncing) {
+            pthread_cond_wait(&m_sync_finished, &m_mutex);
+            continue;
+        }
+
+        // Everything that was appended so far goes to the disk with this fsync(), including the
+        // commits of other threads that came in while the previous one was under way.
+        m_is_syncing = true;
+        auto frame_count = m_frame_count;
+        auto last_commit_frame = m_last_commit_frame;
+        pthread_mutex_unlock(&m_mutex);
+        auto success = fsync(m_fd) == 0;
+        if (!success)
+            perror("fsync");
+        pthread_mutex_lock(&m_mutex);
+
+        m_is_syncing = false;
+        ++m_sync_count;
+        if (success) {
+            m_synced_frame_count = frame_count;
+            m_durable_frame_count = last_commit_frame;
+        }
+        pthread_cond_broadcast(&m_sync_finished);
+        if (!success)
+            return false;
+    }
+    return true;
+}
+
+u32 WriteAheadLog::begin_snapshot()
+{
+    MutexLocker locker(m_mutex);
+    m_snapshots.append(m_durable_frame_count);
+    return m_durable_frame_count;
+}
+
+void WriteAheadLog::end_snapshot(u32 frame_limit)
+{
+    MutexLocker locker(m_mutex);
+    auto index = m_snapshots.find_first_index(frame_limit);
+    VERIFY(index.has_value());
+    m_snapshots.remove(index.value());
+}
+
+Optional<Vector<WriteAheadLog::CheckpointPage>> WriteAheadLog::begin_checkpoint(u32& frame_limit)
+{
+    MutexLocker locker(m_mutex);
+    if (m_is_checkpointing)
+        return {};
+    m_is_checkpointing = true;
+
+    // Pages that a reader may still read from the database file have to stay as they are.
+    frame_limit = m_durable_frame_count;
+    for (auto snapshot : m_snapshots)
+        frame_limit = min(frame_limit, snapshot);
+
+    Vector<CheckpointPage> pages;
+    if (frame_limit <= m_checkpointed_frame_count)
+        return pages;
+    for (auto& it : m_frames_of_page) {
+        for (size_t i = it.value.size(); i > 0; --i) {
+            auto frame = it.value[i - 1];
+            if (frame > frame_limit)
+                continue;
+            if (frame > m_checkpointed_frame_count)
+                pages.append({ it.key, frame });
+            break;
+        }
+    }
+    return pages;
+}
+
+void WriteAheadLog::end_checkpoint(u32 frame_limit, bool success)
+{
+    MutexLocker locker(m_mutex);
+    VERIFY(m_is_checkpointing);
+    m_is_checkpointing = false;
+    if (!success)
+        return;
+
+    m_checkpointed_frame_count = max(m_checkpointed_frame_count, frame_limit);
+    // Once all of the log is in the database file and nobody reads from it, it can start over.
+    if (m_frame_count > 0 && m_checkpointed_frame_count == m_frame_count && m_snapshots.is_empty() && !m_is_syncing)
+        reset();
+}
+
+size_t WriteAheadLog::sync_count()
+{
+    MutexLocker locker(m_mutex);
+    return m_sync_count;
+}
+
+u32 WriteAheadLog::frames_since_checkpoint()
+{
+    MutexLocker locker(m_mutex);
+    return m_frame_count - m_checkpointed_frame_count;
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Result.h>
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <pthread.h>
+
+namespace SQL {
+
+// The log next to a database file ("<path>-wal") that changed pages are appended to, instead of
+// being written over their old contents. Frames are numbered from 1, and each holds a page and a
+// checksum that also covers all the frames before it. A frame holding page 0 (the header page)
+// commits the transaction that the frames before it belong to; after a crash, frames that come
+// after the last valid commit are ignored.
+//
+// Pages are looked up in the log before the database file, up to a frame limit: readers use the
+// last commit that had reached the disk when they started, so they see a consistent snapshot while
+// the writer keeps appending. Checkpoints copy the newest version of each page back into the
+// database file, and start the log over once nobody can need the old frames anymore.
+//
+// The log can be used from several threads. The writer appends while holding no lock but the
+// log's own, so it can go on with the next transaction while an earlier one waits for fsync();
+// transactions that commit while an fsync() is under way all share the next one.
+class WriteAheadLog {
+    AK_MAKE_NONCOPYABLE(WriteAheadLog);
+    AK_MAKE_NONMOVABLE(WriteAheadLog);
+
+public:
+    static Result<NonnullOwnPtr<WriteAheadLog>, String> open(const String& path);
+    ~WriteAheadLog();
+
+    const String& path() const { return m_path; }
+
+    // The newest frame holding the page, among the frames up to the limit (or all of them).
+    Optional<u32> find_frame(u32 page_index, Optional<u32> frame_limit = {});
+    bool read_frame(u32 frame, Bytes);
+
+    // Returns the number of the new frame, which is a commit if the page is the header page.
+    Optional<u32> append_frame(u32 page_index, ReadonlyBytes);
+
+    u32 frame_count();
+    u32 last_commit_frame();
+    bool has_uncommitted_frames();
+
+    // Returns once the frame has reached the disk.
+    bool wait_until_durable(u32 frame);
+
+    // Readers register the frame limit that they read up to, so that checkpoints leave the database
+    // file pages that they may still read alone.
+    u32 begin_snapshot();
+    void end_snapshot(u32 frame_limit);
+
+    struct CheckpointPage {
+        u32 page_index { 0 };
+        u32 frame { 0 };
+    };
+
+    // A checkpoint copies the returned frames into the database file, syncs it, and then ends.
+    // Returns nothing if another checkpoint is under way.
+    Optional<Vector<CheckpointPage>> begin_checkpoint(u32& frame_limit);
+    void end_checkpoint(u32 frame_limit, bool success);
+
+    // How many frames haven't been copied into the database file yet.
+    u32 frames_since_checkpoint();
+
+    size_t sync_count();
+
+private:
+    WriteAheadLog(String path, int fd);
+
+    bool recover();
+    bool reset();
+    off_t frame_offset(u32 frame) const;
+
+    String m_path;
+    int m_fd { -1 };
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_sync_finished;
+
+    u32 m_salt[2] { 0, 0 };
+    u32 m_sequence { 0 };
+    // The checksum of everything up to the last frame, which the next one continues.
+    u32 m_checksum[2] { 0, 0 };
+
+    HashMap<u32, Vector<u32>> m_frames_of_page;
+    u32 m_frame_count { 0 };
+    u32 m_last_commit_frame { 0 };
+    u32 m_synced_frame_count { 0 };
+    // The last commit that has reached the disk, which new readers start from.
+    u32 m_durable_frame_count { 0 };
+    u32 m_checkpointed_frame_count { 0 };
+    bool m_is_syncing { false };
+    bool m_is_checkpointing { false };
+    Vector<u32> m_snapshots;
+    size_t m_sync_count { 0 };
+};
+
+}
@@ -30,6 +30,8 @@ enum class CipherSuite {
     // RFC 5289 - ECDHE for AES-GCM
     ECDHE_ECDSA_WITH_AES_128_GCM_SHA256 = 0xC02B,
     ECDHE_ECDSA_WITH_AES_256_GCM_SHA384 = 0xC02C,
+    ECDHE_RSA_WITH_AES_128_GCM_SHA256 = 0xC02F,
+    ECDHE_RSA_WITH_AES_256_GCM_SHA384 = 0xC030,
 
     // RFC 5487 - Pre-shared keys
     DHE_PSK_WITH_AES_128_GCM_SHA256 = 0x00AA,
@@ -62,6 +64,7 @@ enum class CipherSuite {
     ECDHE_ECDSA_WITH_AES_256_CCM_8 = 0xC0AF,
 
     // RFC 7905 - ChaCha20-Poly1305 Cipher Suites
+    ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256 = 0xCCA8,
     ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256 = 0xCCA9,
     ECDHE_PSK_WITH_CHACHA20_POLY1305_SHA256 = 0xCCAC,
     DHE_PSK_WITH_CHACHA20_POLY1305 = 0xCCAD,
@@ -148,6 +151,21 @@ constexpr SignatureAlgorithm signature_for_key_exchange_algorithm(KeyExchangeAlg
     }
 }
 
+// Defined in RFC 8422 section 5.1.1
+enum class NamedCurve : u16 {
+    x25519 = 0x001D,
+};
+
+// Defined in RFC 8422 section 5.1.2
+enum class ECPointFormat : u8 {
+    Uncompressed = 0,
+};
+
+// Defined in RFC 8422 section 5.4
+enum class ECCurveType : u8 {
+    NamedCurve = 3,
+};
+
 enum class CipherAlgorithm {
     Invalid,
     AES_128_CBC,
@@ -156,6 +174,7 @@ enum class CipherAlgorithm {
     AES_128_CCM_8,
     AES_256_CBC,
     AES_256_GCM,
+    CHACHA20_POLY1305,
 };
 
 constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
@@ -168,6 +187,7 @@ constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
         return 128;
     case CipherAlgorithm::AES_256_CBC:
     case CipherAlgorithm::AES_256_GCM:
+    case CipherAlgorithm::CHACHA20_POLY1305:
         return 256;
     case CipherAlgorithm::Invalid:
     default:
@@ -39,22 +39,12 @@ ByteBuffer TLSv12::build_hello()
         builder.append(m_context.session_id, m_context.session_id_size);
 
     size_t extension_length = 0;
+    // ALPN: the protocols we can speak on top of TLS, in order of preference
     size_t alpn_length = 0;
-    size_t alpn_negotiated_length = 0;
-
-    // ALPN
-    if (!m_context.negotiated_alpn.is_null()) {
-        alpn_negotiated_length = m_context.negotiated_alpn.length();
-        alpn_length = alpn_negotiated_length + 1;
+    for (auto& alpn : m_context.alpn)
+        alpn_length += alpn.length() + 1;
+    if (alpn_length)
         extension_length += alpn_length + 6;
-    } else if (m_context.alpn.size()) {
-        for (auto& alpn : m_context.alpn) {
-            size_t length = alpn.length();
-            alpn_length += length + 1;
-        }
-        if (alpn_length)
-            extension_length += alpn_length + 6;
-    }
 
     // Ciphers
     builder.append((u16)(m_context.options.usable_cipher_suites.size() * sizeof(u16)));
@@ -74,6 +64,12 @@ ByteBuffer TLSv12::build_hello()
     // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
     extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
 
+    // supported_groups: 2b extension ID, 2b extension length, 2b vector length, 2xN named curves
+    // ec_point_formats: 2b extension ID, 2b extension length, 1b vector length, 1 point format
+    auto elliptic_curves_count = m_context.options.elliptic_curves.size();
+    if (elliptic_curves_count)
+        extension_length += 2 + 2 + 2 + 2 * elliptic_curves_count + 2 + 2 + 1 + 1;
+
     if (sni_length)
         extension_length += sni_length + 9;
 
@@ -105,9 +101,30 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u8)entry.signature);
     }
 
+    if (elliptic_curves_count) {
+        // supported_groups extension
+        builder.append((u16)HandshakeExtension::SupportedGroups);
+        builder.append((u16)(2 + 2 * elliptic_curves_count));
+        builder.append((u16)(2 * elliptic_curves_count));
+        for (auto curve : m_context.options.elliptic_curves)
+            builder.append((u16)curve);
+
+        // ec_point_formats extension
+        builder.append((u16)HandshakeExtension::ECPointFormats);
+        builder.append((u16)2);
+        builder.append((u8)1);
+        builder.append((u8)ECPointFormat::Uncompressed);
+    }
+
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // application_layer_protocol_negotiation extension
+        builder.append((u16)HandshakeExtension::ApplicationLayerProtocolNegotiation);
+        builder.append((u16)(alpn_length + 2));
+        builder.append((u16)alpn_length);
+        for (auto& alpn : m_context.alpn) {
+            builder.append((u8)alpn.length());
+            builder.append((const u8*)alpn.characters(), alpn.length());
+        }
     }
 
     // set the "length" field of the packet
@@ -193,6 +210,29 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+
+    if (m_context.is_resumed_session) {
+        // In an abbreviated handshake the server finishes first, and we answer with our own Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    if (m_context.options.use_session_cache && m_context.session_id_size && !m_context.extensions.SNI.is_empty()) {
+        SessionCache::Session session;
+        memcpy(session.id, m_context.session_id, m_context.session_id_size);
+        session.id_size = m_context.session_id_size;
+        session.cipher = m_context.cipher;
+        session.master_key = m_context.master_key;
+        SessionCache::the().store(m_context.extensions.SNI, move(session));
+    }
+
+    did_establish_connection();
+
+    return index + size;
+}
+
+void TLSv12::did_establish_connection()
+{
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -204,8 +244,6 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     if (on_tls_ready_to_write)
         on_tls_ready_to_write(*this);
-
-    return index + size;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
@@ -463,6 +501,11 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 write_packet(packet);
                 break;
             }
+            case Error::IntegrityCheckFailed: {
+                auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                write_packet(packet);
+                break;
+            }
             case Error::NeedMoreData:
                 // Ignore this, as it's not an "error"
                 dbgln_if(TLS_DEBUG, "More data needed");
@@ -517,12 +560,13 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_change_cipher_spec();
                 write_packet(packet);
             }
+            m_context.local_sequence_number = 0;
             {
                 dbgln_if(TLS_DEBUG, "> client finished");
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            did_establish_connection();
             break;
         }
         payload_size++;
@@ -7,6 +7,7 @@
 #include <AK/Debug.h>
 #include <AK/Random.h>
 #include <LibCrypto/ASN1/DER.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
@@ -38,7 +39,8 @@ bool TLSv12::expand_key()
 
     size_t offset = 0;
     if (is_aead) {
-        iv_size = 4; // Explicit IV size.
+        // Fixed IV size: GCM takes 4 bytes of it, and ChaCha20-Poly1305 its whole nonce.
+        iv_size = get_cipher_algorithm(m_context.cipher) == CipherAlgorithm::CHACHA20_POLY1305 ? 12 : 4;
     } else {
         memcpy(m_context.crypto.local_mac, key + offset, mac_size);
         offset += mac_size;
@@ -93,6 +95,15 @@ bool TLSv12::expand_key()
         m_cipher_remote = Crypto::Cipher::AESCipher::GCMMode(ReadonlyBytes { server_key, key_size }, key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
         break;
     }
+    case CipherAlgorithm::CHACHA20_POLY1305: {
+        VERIFY(is_aead);
+        memcpy(m_context.crypto.local_aead_iv, client_iv, iv_size);
+        memcpy(m_context.crypto.remote_aead_iv, server_iv, iv_size);
+
+        m_cipher_local = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { client_key, key_size });
+        m_cipher_remote = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { server_key, key_size });
+        break;
+    }
     case CipherAlgorithm::AES_128_CCM:
         dbgln("Requested unimplemented AES CCM cipher");
         TODO();
@@ -224,6 +235,48 @@ void TLSv12::build_rsa_pre_master_secret(PacketBuilder& builder)
     builder.append(outbuf);
 }
 
+void TLSv12::build_ecdhe_rsa_pre_master_secret(PacketBuilder& builder)
+{
+    // The server's key was checked against its certificate in handle_server_key_exchange().
+    if (m_context.server_ephemeral_public_key.size() != Crypto::Curves::X25519::KeySize) {
+        dbgln("no server key to agree upon a secret with");
+        alert(AlertLevel::Critical, AlertDescription::HandshakeFailure);
+        return;
+    }
+
+    u8 private_key[Crypto::Curves::X25519::KeySize];
+    u8 public_key[Crypto::Curves::X25519::KeySize];
+    u8 shared_secret[Crypto::Curves::X25519::KeySize];
+    Crypto::Curves::X25519::generate_private_key({ private_key, sizeof(private_key) });
+    Crypto::Curves::X25519::generate_public_key({ private_key, sizeof(private_key) }, { public_key, sizeof(public_key) });
+
+    // RFC 8422 section 5.11: an all-zero shared secret means the server sent a point of small order, and must be rejected.
+    if (!Crypto::Curves::X25519::compute_coordinate({ private_key, sizeof(private_key) }, m_context.server_ephemeral_public_key, { shared_secret, sizeof(shared_secret) })) {
+        dbgln("server sent an X25519 key of small order");
+        alert(AlertLevel::Critical, AlertDescription::IllegalParameter);
+        return;
+    }
+
+    m_context.premaster_key = ByteBuffer::copy(shared_secret, sizeof(shared_secret));
+    m_context.server_ephemeral_public_key.clear();
+    explicit_bzero(private_key, sizeof(private_key));
+    explicit_bzero(shared_secret, sizeof(shared_secret));
+
+    if constexpr (TLS_DEBUG) {
+        dbgln("PreMaster secret");
+        print_buffer(m_context.premaster_key);
+    }
+
+    if (!compute_master_secret_from_pre_master_secret(48)) {
+        dbgln("oh noes we could not derive a master key :(");
+        return;
+    }
+
+    builder.append_u24(sizeof(public_key) + 1);
+    builder.append((u8)sizeof(public_key));
+    builder.append(public_key, sizeof(public_key));
+}
+
 ByteBuffer TLSv12::build_certificate()
 {
     PacketBuilder builder { MessageType::Handshake, m_context.options.version };
@@ -304,6 +357,8 @@ ByteBuffer TLSv12::build_client_key_exchange()
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        build_ecdhe_rsa_pre_master_secret(builder);
+        break;
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
@@ -10,6 +10,8 @@
 
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/NumberTheory/ModularFunctions.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
@@ -144,27 +146,18 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
         } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    const u8* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        String alpn_str { (const char*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
-            }
+            // RFC 7301 section 3.1: The server picks exactly one of the protocols that we offered.
+            if (extension_length < 3)
+                return (i8)Error::BrokenPacket;
+            auto list_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            u8 alpn_size = buffer[res + 2];
+            if (list_length != extension_length - 2 || alpn_size == 0 || alpn_size + 1u != list_length)
+                return (i8)Error::BrokenPacket;
+            String alpn { (const char*)buffer.offset_pointer(res + 3), alpn_size };
+            if (!m_context.alpn.contains_slow(alpn))
+                return (i8)Error::NotUnderstood;
+            m_context.negotiated_alpn = alpn;
+            dbgln_if(TLS_DEBUG, "Negotiated ALPN: {}", alpn);
             res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
@@ -177,6 +170,24 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     }
 
+    if (m_context.offered_session.has_value()) {
+        auto session = m_context.offered_session.release_value();
+        if (session.id_size == m_context.session_id_size && memcmp(session.id, m_context.session_id, session.id_size) == 0) {
+            // The server is resuming our session: there is no key exchange, the keys come from the old master secret.
+            dbgln_if(TLS_DEBUG, "Resuming session");
+            if (session.cipher != m_context.cipher) {
+                dbgln("Server resumed a session with a different cipher");
+                SessionCache::the().remove(m_context.extensions.SNI);
+                return (i8)Error::BrokenPacket;
+            }
+            m_context.master_key = move(session.master_key);
+            if (!expand_key())
+                return (i8)Error::NotUnderstood;
+            m_context.is_resumed_session = true;
+            m_context.connection_status = ConnectionStatus::KeyExchange;
+        }
+    }
+
     return res;
 }
 
@@ -199,7 +210,143 @@ ByteBuffer TLSv12::build_server_key_exchange()
     return {};
 }
 
-ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes)
+// The DER encoded DigestInfo that goes before the hash in a PKCS#1 v1.5 signature, as listed in RFC 8017 section 9.2.
+static Optional<ReadonlyBytes> digest_info_prefix(HashAlgorithm hash)
+{
+    static constexpr u8 sha1_prefix[] { 0x30, 0x21, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14 };
+    static constexpr u8 sha256_prefix[] { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+    static constexpr u8 sha384_prefix[] { 0x30, 0x41, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x02, 0x05, 0x00, 0x04, 0x30 };
+    static constexpr u8 sha512_prefix[] { 0x30, 0x51, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x03, 0x05, 0x00, 0x04, 0x40 };
+
+    switch (hash) {
+    case HashAlgorithm::SHA1:
+        return ReadonlyBytes { sha1_prefix, sizeof(sha1_prefix) };
+    case HashAlgorithm::SHA256:
+        return ReadonlyBytes { sha256_prefix, sizeof(sha256_prefix) };
+    case HashAlgorithm::SHA384:
+        return ReadonlyBytes { sha384_prefix, sizeof(sha384_prefix) };
+    case HashAlgorithm::SHA512:
+        return ReadonlyBytes { sha512_prefix, sizeof(sha512_prefix) };
+    default:
+        return {};
+    }
+}
+
+static Crypto::Hash::HashKind hash_kind(HashAlgorithm hash)
+{
+    switch (hash) {
+    case HashAlgorithm::SHA1:
+        return Crypto::Hash::HashKind::SHA1;
+    case HashAlgorithm::SHA256:
+        return Crypto::Hash::HashKind::SHA256;
+    case HashAlgorithm::SHA384:
+        return Crypto::Hash::HashKind::SHA384;
+    case HashAlgorithm::SHA512:
+        return Crypto::Hash::HashKind::SHA512;
+    default:
+        return Crypto::Hash::HashKind::None;
+    }
+}
+
+// Checks an RSASSA-PKCS1-v1_5 signature (RFC 8017 section 8.2.2) of `message`, by rebuilding the padded hash
+// that the signature should decrypt to.
+static bool verify_rsa_pkcs1_signature(const Certificate& certificate, HashAlgorithm hash, ReadonlyBytes message, ReadonlyBytes signature)
+{
+    auto prefix = digest_info_prefix(hash);
+    if (!prefix.has_value())
+        return false;
+
+    auto& modulus = certificate.public_key.modulus();
+    Vector<u8, 512> modulus_bytes;
+    modulus_bytes.resize(modulus.trimmed_length() * sizeof(u32));
+    auto modulus_length = modulus.export_data(modulus_bytes, true);
+    if (signature.size() != modulus_length)
+        return false;
+
+    Crypto::Hash::Manager hasher(hash_kind(hash));
+    hasher.update(message);
+    auto digest = hasher.digest();
+    auto digest_size = hasher.digest_size();
+
+    // EM = 0x00 || 0x01 || 0xff... || 0x00 || DigestInfo || hash
+    if (modulus_length < prefix->size() + digest_size + 11)
+        return false;
+    Vector<u8, 512> expected;
+    expected.resize(modulus_length);
+    auto padding_end = modulus_length - prefix->size() - digest_size - 1;
+    expected[0] = 0x00;
+    expected[1] = 0x01;
+    for (size_t i = 2; i < padding_end; ++i)
+        expected[i] = 0xff;
+    expected[padding_end] = 0x00;
+    prefix->copy_to(expected.span().slice(padding_end + 1));
+    ReadonlyBytes { digest.immutable_data(), digest_size }.copy_to(expected.span().slice(padding_end + 1 + prefix->size()));
+
+    auto signature_integer = Crypto::UnsignedBigInteger::import_data(signature.data(), signature.size());
+    if (!(signature_integer < modulus))
+        return false;
+    auto decrypted = Crypto::NumberTheory::ModularPower(signature_integer, certificate.public_key.public_exponent(), modulus);
+    return decrypted == Crypto::UnsignedBigInteger::import_data(expected.data(), expected.size());
+}
+
+ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    auto message = buffer.slice(3, size);
+
+    // ServerECDHParams (RFC 8422 section 5.4): curve type, named curve, and the length-prefixed public point.
+    if (message.size() < 4)
+        return (i8)Error::BrokenPacket;
+    auto curve_type = (ECCurveType)message[0];
+    auto curve = (NamedCurve)AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(1)));
+    size_t point_length = message[3];
+    if (curve_type != ECCurveType::NamedCurve || curve != NamedCurve::x25519 || point_length != Crypto::Curves::X25519::KeySize) {
+        dbgln("server picked an elliptic curve that we did not offer");
+        return (i8)Error::NotUnderstood;
+    }
+    size_t params_length = 4 + point_length;
+
+    // The signature over the parameters: the hash and signature algorithms, and the length-prefixed signature.
+    if (message.size() < params_length + 4)
+        return (i8)Error::BrokenPacket;
+    auto hash = (HashAlgorithm)message[params_length];
+    auto signature_algorithm = (SignatureAlgorithm)message[params_length + 1];
+    size_t signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(params_length + 2)));
+    if (message.size() - params_length - 4 < signature_length)
+        return (i8)Error::BrokenPacket;
+    auto signature = message.slice(params_length + 4, signature_length);
+
+    if (signature_algorithm != SignatureAlgorithm::RSA) {
+        dbgln("server signed its key exchange with something other than RSA");
+        return (i8)Error::NotUnderstood;
+    }
+
+    auto certificate_option = verify_chain_and_get_matching_certificate(m_context.extensions.SNI);
+    if (!certificate_option.has_value()) {
+        dbgln("certificate verification failed :(");
+        return (i8)Error::BadCertificate;
+    }
+
+    // The signed data is client_random + server_random + ServerECDHParams.
+    auto signed_data = ByteBuffer::create_uninitialized(sizeof(m_context.local_random) + sizeof(m_context.remote_random) + params_length);
+    signed_data.overwrite(0, m_context.local_random, sizeof(m_context.local_random));
+    signed_data.overwrite(sizeof(m_context.local_random), m_context.remote_random, sizeof(m_context.remote_random));
+    signed_data.overwrite(sizeof(m_context.local_random) + sizeof(m_context.remote_random), message.data(), params_length);
+
+    if (!verify_rsa_pkcs1_signature(m_context.certificates[certificate_option.value()], hash, signed_data, signature)) {
+        dbgln("server key exchange signature does not match its certificate");
+        return (i8)Error::IntegrityCheckFailed;
+    }
+
+    m_context.server_ephemeral_public_key = ByteBuffer::copy(message.offset_pointer(4), point_length);
+    return size + 3;
+}
+
+ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes buffer)
 {
     switch (get_key_exchange_algorithm(m_context.cipher)) {
     case KeyExchangeAlgorithm::RSA:
@@ -222,6 +369,7 @@ ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes)
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        return handle_ecdhe_rsa_server_key_exchange(buffer);
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
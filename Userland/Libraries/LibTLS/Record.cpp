@@ -38,6 +38,11 @@ void TLSv12::alert(AlertLevel level, AlertDescription code)
 void TLSv12::write_packet(ByteBuffer& packet)
 {
     m_context.tls_buffer.append(packet.data(), packet.size());
+    schedule_write();
+}
+
+void TLSv12::schedule_write()
+{
     if (m_context.connection_status > ConnectionStatus::Disconnected) {
         if (!m_has_scheduled_write_flush) {
             dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
@@ -65,143 +70,106 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 update_hash(packet.bytes(), header_size);
             }
         }
-        if (m_context.cipher_spec_set && m_context.crypto.created) {
-            size_t length = packet.size() - header_size;
-            size_t block_size = 0;
-            size_t padding = 0;
-            size_t mac_size = 0;
-
-            m_cipher_local.visit(
-                [&](Empty&) { VERIFY_NOT_REACHED(); },
-                [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
-                    VERIFY(is_aead());
-                    block_size = gcm.cipher().block_size();
-                    padding = 0;
-                    mac_size = 0; // AEAD provides its own authentication scheme.
-                },
-                [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
-                    VERIFY(!is_aead());
-                    block_size = cbc.cipher().block_size();
-                    // If the length is already a multiple a block_size,
-                    // an entire block of padding is added.
-                    // In short, we _never_ have no padding.
-                    mac_size = mac_length();
-                    length += mac_size;
-                    padding = block_size - length % block_size;
-                    length += padding;
-                });
-
-            if (m_context.crypto.created == 1) {
-                // `buffer' will continue to be encrypted
-                auto buffer = ByteBuffer::create_uninitialized(length);
-                size_t buffer_position = 0;
-                auto iv_size = iv_length();
-
-                // copy the packet, sans the header
-                buffer.overwrite(buffer_position, packet.offset_pointer(header_size), packet.size() - header_size);
-                buffer_position += packet.size() - header_size;
-
-                ByteBuffer ct;
-
-                m_cipher_local.visit(
-                    [&](Empty&) { VERIFY_NOT_REACHED(); },
-                    [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
-                        VERIFY(is_aead());
-                        // We need enough space for a header, the data, a tag, and the IV
-                        ct = ByteBuffer::create_uninitialized(length + header_size + iv_size + 16);
-
-                        // copy the header over
-                        ct.overwrite(0, packet.data(), header_size - 2);
-
-                        // AEAD AAD (13)
-                        // Seq. no (8)
-                        // content type (1)
-                        // version (2)
-                        // length (2)
-                        u8 aad[13];
-                        Bytes aad_bytes { aad, 13 };
-                        OutputMemoryStream aad_stream { aad_bytes };
-
-                        u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
-                        u16 len = AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size));
-
-                        aad_stream.write({ &seq_no, sizeof(seq_no) });
-                        aad_stream.write(packet.bytes().slice(0, 3)); // content-type + version
-                        aad_stream.write({ &len, sizeof(len) });      // length
-                        VERIFY(aad_stream.is_end());
-
-                        // AEAD IV (12)
-                        // IV (4)
-                        // (Nonce) (8)
-                        // -- Our GCM impl takes 16 bytes
-                        // zero (4)
-                        u8 iv[16];
-                        Bytes iv_bytes { iv, 16 };
-                        Bytes { m_context.crypto.local_aead_iv, 4 }.copy_to(iv_bytes);
-                        fill_with_random(iv_bytes.offset(4), 8);
-                        memset(iv_bytes.offset(12), 0, 4);
-
-                        // write the random part of the iv out
-                        iv_bytes.slice(4, 8).copy_to(ct.bytes().slice(header_size));
-
-                        // Write the encrypted data and the tag
-                        gcm.encrypt(
-                            packet.bytes().slice(header_size, length),
-                            ct.bytes().slice(header_size + 8, length),
-                            iv_bytes,
-                            aad_bytes,
-                            ct.bytes().slice(header_size + 8 + length, 16));
-
-                        VERIFY(header_size + 8 + length + 16 == ct.size());
-                    },
-                    [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
-                        VERIFY(!is_aead());
-                        // We need enough space for a header, iv_length bytes of IV and whatever the packet contains
-                        ct = ByteBuffer::create_uninitialized(length + header_size + iv_size);
-
-                        // copy the header over
-                        ct.overwrite(0, packet.data(), header_size - 2);
-
-                        // get the appropricate HMAC value for the entire packet
-                        auto mac = hmac_message(packet, {}, mac_size, true);
-
-                        // write the MAC
-                        buffer.overwrite(buffer_position, mac.data(), mac.size());
-                        buffer_position += mac.size();
-
-                        // Apply the padding (a packet MUST always be padded)
-                        memset(buffer.offset_pointer(buffer_position), padding - 1, padding);
-                        buffer_position += padding;
-
-                        VERIFY(buffer_position == buffer.size());
-
-                        auto iv = ByteBuffer::create_uninitialized(iv_size);
-                        fill_with_random(iv.data(), iv.size());
-
-                        // write it into the ciphertext portion of the message
-                        ct.overwrite(header_size, iv.data(), iv.size());
-
-                        VERIFY(header_size + iv_size + length == ct.size());
-                        VERIFY(length % block_size == 0);
-
-                        // get a block to encrypt into
-                        auto view = ct.bytes().slice(header_size + iv_size, length);
-                        cbc.encrypt(buffer, view, iv);
-                    });
-
-                // store the correct ciphertext length into the packet
-                u16 ct_length = (u16)ct.size() - header_size;
-
-                ByteReader::store(ct.offset_pointer(header_size - 2), AK::convert_between_host_and_network_endian(ct_length));
-
-                // replace the packet with the ciphertext
-                packet = ct;
-            }
+        if (m_context.cipher_spec_set && m_context.crypto.created == 1) {
+            // Make room for the explicit IV in front of the payload and for the MAC or tag behind it, then encrypt in place.
+            auto payload_size = packet.size() - header_size;
+            auto iv_size = iv_length();
+            packet.resize(packet.size() + iv_size + record_trailer_size());
+            memmove(packet.offset_pointer(header_size + iv_size), packet.offset_pointer(header_size), payload_size);
+            packet.resize(encrypt_record(packet.bytes(), payload_size));
         }
     }
     ++m_context.local_sequence_number;
 }
 
+size_t TLSv12::encrypt_record(Bytes record, size_t payload_size)
+{
+    constexpr size_t header_size = 5;
+    auto iv_size = iv_length();
+    auto payload = record.slice(header_size + iv_size, payload_size);
+    size_t encrypted_size = 0;
+
+    // AEAD AAD (13)
+    // Seq. no (8)
+    // content type (1)
+    // version (2)
+    // length (2)
+    // The last five bytes are also what the MAC of a CBC record covers, after the sequence number.
+    u8 aad[13];
+    Bytes aad_bytes { aad, 13 };
+    OutputMemoryStream aad_stream { aad_bytes };
+
+    u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
+    u16 len = AK::convert_between_host_and_network_endian((u16)payload_size);
+
+    aad_stream.write({ &seq_no, sizeof(seq_no) });
+    aad_stream.write(record.slice(0, 3));    // content-type + version
+    aad_stream.write({ &len, sizeof(len) }); // length
+    VERIFY(aad_stream.is_end());
+
+    m_cipher_local.visit(
+        [&](Empty&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            VERIFY(is_aead());
+            // AEAD IV (12)
+            // IV (4)
+            // (Nonce) (8)
+            // -- Our GCM impl takes 16 bytes
+            // zero (4)
+            u8 iv[16];
+            Bytes iv_bytes { iv, 16 };
+            Bytes { m_context.crypto.local_aead_iv, 4 }.copy_to(iv_bytes);
+            fill_with_random(iv_bytes.offset(4), 8);
+            memset(iv_bytes.offset(12), 0, 4);
+
+            // write the random part of the iv out
+            iv_bytes.slice(4, 8).copy_to(record.slice(header_size));
+
+            // Encrypt the data where it is, and write the tag after it
+            gcm.encrypt(payload, payload, iv_bytes, aad_bytes, record.slice(header_size + iv_size + payload_size, 16));
+            encrypted_size = iv_size + payload_size + 16;
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            VERIFY(is_aead());
+            // Nonce (12): the fixed IV, with the sequence number XORed into its last 8 bytes
+            u8 nonce[12];
+            memcpy(nonce, m_context.crypto.local_aead_iv, 12);
+            for (size_t i = 0; i < sizeof(seq_no); ++i)
+                nonce[4 + i] ^= ((u8*)&seq_no)[i];
+
+            // Encrypt the data where it is, and write the tag after it; there is no explicit nonce.
+            chacha.encrypt(payload, payload, { nonce, 12 }, aad_bytes, record.slice(header_size + payload_size, 16));
+            encrypted_size = payload_size + 16;
+        },
+        [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
+            VERIFY(!is_aead());
+            auto block_size = cbc.cipher().block_size();
+            auto mac_size = mac_length();
+
+            // get the appropriate HMAC value for the entire packet, and write it after the data
+            auto mac = hmac_message(aad_bytes.slice(8), payload, mac_size, true);
+            mac.bytes().copy_to(record.slice(header_size + iv_size + payload_size));
+
+            // Apply the padding (a packet MUST always be padded)
+            // If the length is already a multiple a block_size, an entire block of padding is added.
+            auto length = payload_size + mac_size;
+            auto padding = block_size - length % block_size;
+            memset(record.offset(header_size + iv_size + length), padding - 1, padding);
+            length += padding;
+
+            auto iv = record.slice(header_size, iv_size);
+            fill_with_random(iv.data(), iv.size());
+
+            Bytes plaintext = record.slice(header_size + iv_size, length);
+            cbc.encrypt(plaintext, plaintext, iv);
+            encrypted_size = iv_size + length;
+        });
+
+    // store the correct ciphertext length into the record
+    ByteReader::store(record.offset(3), AK::convert_between_host_and_network_endian((u16)encrypted_size));
+    return header_size + encrypted_size;
+}
+
 void TLSv12::update_hash(ReadonlyBytes message, size_t header_size)
 {
     dbgln_if(TLS_DEBUG, "Update hash with message of size {}", message.size());
@@ -272,7 +240,7 @@ ByteBuffer TLSv12::hmac_message(const ReadonlyBytes& buf, const Optional<Readonl
     return mac;
 }
 
-ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
+ssize_t TLSv12::handle_message(Bytes buffer)
 {
     auto res { 5ll };
     size_t header_size = res;
@@ -307,9 +275,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
     }
 
     dbgln_if(TLS_DEBUG, "message type: {}, length: {}", (u8)type, length);
-    auto plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
-
-    ByteBuffer decrypted;
+    ReadonlyBytes plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
     if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
         if constexpr (TLS_DEBUG) {
@@ -331,8 +297,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                 }
 
                 auto packet_length = length - iv_length() - 16;
-                auto payload = plain;
-                decrypted = ByteBuffer::create_uninitialized(packet_length);
+                auto payload = buffer.slice(header_size, length);
 
                 // AEAD AAD (13)
                 // Seq. no (8)
@@ -365,12 +330,13 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                 nonce.copy_to(iv_bytes.slice(4));
                 memset(iv_bytes.offset(12), 0, 4);
 
+                // The record is decrypted where it is.
                 auto ciphertext = payload.slice(0, payload.size() - 16);
                 auto tag = payload.slice(ciphertext.size());
 
                 auto consistency = gcm.decrypt(
                     ciphertext,
-                    decrypted,
+                    ciphertext,
                     iv_bytes,
                     aad_bytes,
                     tag);
@@ -384,23 +350,83 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return;
                 }
 
-                plain = decrypted;
+                plain = ciphertext;
+            },
+            [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                VERIFY(is_aead());
+                if (length < 16) {
+                    dbgln("Invalid packet length");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
+
+                auto packet_length = length - 16;
+
+                // AEAD AAD (13), same as GCM's
+                u8 aad[13];
+                Bytes aad_bytes { aad, 13 };
+                OutputMemoryStream aad_stream { aad_bytes };
+
+                u64 seq_no = AK::convert_between_host_and_network_endian(m_context.remote_sequence_number);
+                u16 len = AK::convert_between_host_and_network_endian((u16)packet_length);
+
+                aad_stream.write({ &seq_no, sizeof(seq_no) });      // Sequence number
+                aad_stream.write(buffer.slice(0, header_size - 2)); // content-type + version
+                aad_stream.write({ &len, sizeof(u16) });
+                VERIFY(aad_stream.is_end());
+
+                // Nonce (12): the fixed IV, with the sequence number XORed into its last 8 bytes
+                u8 nonce[12];
+                memcpy(nonce, m_context.crypto.remote_aead_iv, 12);
+                for (size_t i = 0; i < sizeof(seq_no); ++i)
+                    nonce[4 + i] ^= ((u8*)&seq_no)[i];
+
+                // The record is decrypted where it is.
+                auto ciphertext = buffer.slice(header_size, packet_length);
+                auto tag = buffer.slice(header_size + packet_length, 16);
+
+                auto consistency = chacha.decrypt(
+                    ciphertext,
+                    ciphertext,
+                    { nonce, 12 },
+                    aad_bytes,
+                    tag);
+
+                if (consistency != Crypto::VerificationConsistency::Consistent) {
+                    dbgln("integrity check failed (tag length {})", tag.size());
+                    auto packet = build_alert(true, (u8)AlertDescription::BadRecordMAC);
+                    write_packet(packet);
+
+                    return_value = Error::IntegrityCheckFailed;
+                    return;
+                }
+
+                plain = ciphertext;
             },
             [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                 VERIFY(!is_aead());
                 auto iv_size = iv_length();
+                if (length < iv_size || (length - iv_size) % cbc.cipher().block_size() != 0) {
+                    dbgln("broken packet");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
 
-                decrypted = cbc.create_aligned_buffer(length - iv_size);
                 auto iv = buffer.slice(header_size, iv_size);
 
-                Bytes decrypted_span = decrypted;
-                cbc.decrypt(buffer.slice(header_size + iv_size, length - iv_size), decrypted_span, iv);
+                // The record is decrypted where it is.
+                Bytes decrypted_span = buffer.slice(header_size + iv_size, length - iv_size);
+                cbc.decrypt(decrypted_span, decrypted_span, iv);
 
                 length = decrypted_span.size();
 
                 if constexpr (TLS_DEBUG) {
                     dbgln("Decrypted: ");
-                    print_buffer(decrypted);
+                    print_buffer(decrypted_span);
                 }
 
                 auto mac_size = mac_length();
@@ -432,7 +458,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return_value = Error::IntegrityCheckFailed;
                     return;
                 }
-                plain = decrypted.bytes().slice(0, length);
+                plain = decrypted_span.slice(0, length);
             });
 
         if (return_value != Error::NoError) {
@@ -489,7 +515,8 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CloseNotify) {
                 res += 2;
-                alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+                // This has to be a warning: servers forget the session when they get a fatal alert, and we want to resume it later.
+                alert(AlertLevel::Warning, AlertDescription::CloseNotify);
                 m_context.connection_finished = true;
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
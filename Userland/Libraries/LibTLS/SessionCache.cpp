@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+SessionCache& SessionCache::the()
+{
+    static SessionCache s_the;
+    return s_the;
+}
+
+Optional<SessionCache::Session> SessionCache::lookup(const String& host)
+{
+    auto it = m_sessions.find(host);
+    if (it == m_sessions.end())
+        return {};
+
+    if (time(nullptr) - it->value.creation_time > max_session_age_in_seconds) {
+        m_sessions.remove(it);
+        return {};
+    }
+    return it->value;
+}
+
+void SessionCache::store(const String& host, Session session)
+{
+    if (!m_sessions.contains(host) && m_sessions.size() >= max_session_count) {
+        auto oldest = m_sessions.begin();
+        for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            if (it->value.creation_time < oldest->value.creation_time)
+                oldest = it;
+        }
+        m_sessions.remove(oldest);
+    }
+
+    session.creation_time = time(nullptr);
+    m_sessions.set(host, move(session));
+}
+
+void SessionCache::remove(const String& host)
+{
+    m_sessions.remove(host);
+}
+
+}
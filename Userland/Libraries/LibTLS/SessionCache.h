@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <LibTLS/CipherSuite.h>
+#include <time.h>
+
+namespace TLS {
+
+// The sessions servers gave us, so that the next connection to the same host can resume one
+// with an abbreviated handshake (RFC 5246 section 7.3) instead of doing a full key exchange again.
+class SessionCache {
+public:
+    static constexpr size_t max_session_count = 64;
+
+    // Servers tend to forget sessions much sooner than this, in which case they just do a full handshake.
+    static constexpr time_t max_session_age_in_seconds = 3600;
+
+    struct Session {
+        u8 id[32];
+        u8 id_size { 0 };
+        CipherSuite cipher { CipherSuite::Invalid };
+        ByteBuffer master_key;
+        time_t creation_time { 0 };
+    };
+
+    static SessionCache& the();
+
+    Optional<Session> lookup(const String& host);
+    void store(const String& host, Session);
+    void remove(const String& host);
+
+private:
+    SessionCache() = default;
+
+    HashMap<String, Session> m_sessions;
+};
+
+}
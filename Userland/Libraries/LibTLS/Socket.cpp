@@ -61,19 +61,44 @@ bool TLSv12::write(ReadonlyBytes buffer)
         return false;
     }
 
-    PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, buffer.size() };
-    builder.append(buffer);
-    auto packet = builder.build();
+    // Each record is put together right where it will be sent from, and encrypted there.
+    constexpr size_t header_size = 5;
+    auto iv_size = iv_length();
+    auto trailer_size = record_trailer_size();
+    auto& out = write_buffer();
 
-    update_packet(packet);
-    write_packet(packet);
+    do {
+        auto payload_size = min(buffer.size(), max_record_payload_size);
+        auto record_offset = out.size();
+        out.resize(record_offset + header_size + iv_size + payload_size + trailer_size);
 
+        auto record = out.bytes().slice(record_offset);
+        record[0] = (u8)MessageType::ApplicationData;
+        ByteReader::store(record.offset(1), AK::convert_between_host_and_network_endian((u16)m_context.options.version));
+        buffer.slice(0, payload_size).copy_to(record.slice(header_size + iv_size));
+
+        out.resize(record_offset + encrypt_record(record, payload_size));
+        ++m_context.local_sequence_number;
+
+        buffer = buffer.slice(payload_size);
+    } while (!buffer.is_empty());
+
+    schedule_write();
     return true;
 }
 
 bool TLSv12::connect(const String& hostname, int port)
 {
     set_sni(hostname);
+
+    if (m_context.options.use_session_cache) {
+        if (auto session = SessionCache::the().lookup(hostname); session.has_value()) {
+            memcpy(m_context.session_id, session->id, session->id_size);
+            m_context.session_id_size = session->id_size;
+            m_context.offered_session = session.release_value();
+        }
+    }
+
     return Core::Socket::connect(hostname, port);
 }
 
@@ -229,7 +254,7 @@ bool TLSv12::flush()
         print_buffer(out_buffer, out_buffer_length);
     }
     if (Core::Socket::write(&out_buffer[out_buffer_index], out_buffer_length)) {
-        write_buffer().clear();
+        write_buffer().clear_with_capacity();
         return true;
     }
     if (m_context.send_retries++ == 10) {
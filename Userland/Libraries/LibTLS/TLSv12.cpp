@@ -88,7 +88,13 @@ void TLSv12::consume(ReadonlyBytes record)
     }
 
     if (index) {
-        m_context.message_buffer = m_context.message_buffer.slice(index, m_context.message_buffer.size() - index);
+        // Move what is left of the next record to the front, and keep the buffer for the records after it.
+        auto remaining = m_context.message_buffer.size() - index;
+        memmove(m_context.message_buffer.data(), m_context.message_buffer.offset_pointer(index), remaining);
+        if (remaining)
+            m_context.message_buffer.resize(remaining);
+        else
+            m_context.message_buffer.clear_with_capacity();
     }
 }
 
@@ -183,6 +189,19 @@ void TLSv12::set_root_certificates(Vector<Certificate> certificates)
     m_context.root_ceritificates = move(certificates);
 }
 
+void TLSv12::add_alpn(const StringView& alpn)
+{
+    // Protocol names are length-prefixed with a single byte on the wire.
+    VERIFY(!alpn.is_empty() && alpn.length() <= 255);
+    if (!has_alpn(alpn))
+        m_context.alpn.append(alpn);
+}
+
+bool TLSv12::has_alpn(const StringView& alpn) const
+{
+    return m_context.alpn.contains_slow(alpn);
+}
+
 bool Context::verify_chain() const
 {
     if (!options.validate_certificates)
@@ -15,9 +15,11 @@
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -136,6 +138,8 @@ enum HandshakeType {
 enum class HandshakeExtension : u16 {
     ServerName = 0x00,
     ApplicationLayerProtocolNegotiation = 0x10,
+    SupportedGroups = 0x0a,
+    ECPointFormats = 0x0b,
     SignatureAlgorithms = 0x0d,
 };
 
@@ -167,12 +171,18 @@ enum ClientVerificationStaus {
 // 4 bytes of fixed IV, 8 random (nonce) bytes, 4 bytes for counter
 // GCM specifically asks us to transmit only the nonce, the counter is zero
 // and the fixed IV is derived from the premaster key.
-#define ENUMERATE_CIPHERS(C)                                                                                                                    \
-    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)      \
-    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)      \
-    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false) \
-    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false) \
-    C(true, CipherSuite::RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)   \
+// ChaCha20-Poly1305 transmits no nonce at all: all 12 bytes of its IV are derived
+// from the premaster key, and XORed with the sequence number (RFC 7905 section 2).
+// The ECDHE suites come first, so that servers that follow our preference pick forward secrecy.
+#define ENUMERATE_CIPHERS(C)                                                                                                                                          \
+    C(true, CipherSuite::ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true) \
+    C(true, CipherSuite::ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)             \
+    C(true, CipherSuite::ECDHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)             \
+    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)                         \
     C(true, CipherSuite::RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)
 
 constexpr KeyExchangeAlgorithm get_key_exchange_algorithm(CipherSuite suite)
@@ -225,9 +235,12 @@ struct Options {
         { HashAlgorithm::SHA256, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA1, SignatureAlgorithm::RSA });
 
+    OPTION_WITH_DEFAULTS(Vector<NamedCurve>, elliptic_curves, NamedCurve::x25519)
+
     OPTION_WITH_DEFAULTS(bool, use_sni, true)
     OPTION_WITH_DEFAULTS(bool, use_compression, false)
     OPTION_WITH_DEFAULTS(bool, validate_certificates, true)
+    OPTION_WITH_DEFAULTS(bool, use_session_cache, true)
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -245,6 +258,9 @@ struct Context {
     u8 local_random[32];
     u8 session_id[32];
     u8 session_id_size { 0 };
+    // The cached session we asked the server to resume, and whether it did.
+    Optional<SessionCache::Session> offered_session;
+    bool is_resumed_session { false };
     CipherSuite cipher;
     bool is_server { false };
     Vector<Certificate> certificates;
@@ -252,6 +268,8 @@ struct Context {
     Vector<Certificate> client_certificates;
     ByteBuffer master_key;
     ByteBuffer premaster_key;
+    // The server's X25519 public key, from its ServerKeyExchange message.
+    ByteBuffer server_ephemeral_public_key;
     u8 cipher_spec_set { 0 };
     struct {
         int created { 0 };
@@ -259,8 +277,8 @@ struct Context {
         u8 local_mac[32];
         u8 local_iv[16];
         u8 remote_iv[16];
-        u8 local_aead_iv[4];
-        u8 remote_aead_iv[4];
+        u8 local_aead_iv[12];
+        u8 remote_aead_iv[12];
     } crypto;
 
     Crypto::Hash::Manager handshake_hash;
@@ -298,7 +316,7 @@ struct Context {
     Vector<Certificate> root_ceritificates;
 
     Vector<String> alpn;
-    StringView negotiated_alpn;
+    String negotiated_alpn;
 
     size_t send_retries { 0 };
 
@@ -335,7 +353,8 @@ public:
 
     ByteBuffer finish_build();
 
-    const StringView& alpn() const { return m_context.negotiated_alpn; }
+    // The protocol that the server picked among the ones we offered, or null if it didn't pick any.
+    const String& alpn() const { return m_context.negotiated_alpn; }
     void add_alpn(const StringView& alpn);
     bool has_alpn(const StringView& alpn) const;
 
@@ -375,6 +394,9 @@ public:
     Function<void(TLSv12&)> on_tls_certificate_request;
 
 private:
+    // A record carries at most 2^14 bytes of plaintext (RFC 5246 section 6.2.1).
+    static constexpr size_t max_record_payload_size = 16384;
+
     explicit TLSv12(Core::Object* parent, Options = {});
 
     virtual bool common_connect(const struct sockaddr*, socklen_t) override;
@@ -385,9 +407,11 @@ private:
     void ensure_hmac(size_t digest_size, bool local);
 
     void update_packet(ByteBuffer& packet);
+    size_t encrypt_record(Bytes record, size_t payload_size);
     void update_hash(ReadonlyBytes in, size_t header_size);
 
     void write_packet(ByteBuffer& packet);
+    void schedule_write();
 
     ByteBuffer build_client_key_exchange();
     ByteBuffer build_server_key_exchange();
@@ -400,6 +424,7 @@ private:
     ByteBuffer build_change_cipher_spec();
     ByteBuffer build_verify_request();
     void build_rsa_pre_master_secret(PacketBuilder&);
+    void build_ecdhe_rsa_pre_master_secret(PacketBuilder&);
 
     bool flush();
     void write_into_socket();
@@ -411,10 +436,11 @@ private:
     ssize_t handle_handshake_finished(ReadonlyBytes, WritePacketStage&);
     ssize_t handle_certificate(ReadonlyBytes);
     ssize_t handle_server_key_exchange(ReadonlyBytes);
+    ssize_t handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes);
     ssize_t handle_server_hello_done(ReadonlyBytes);
     ssize_t handle_certificate_verify(ReadonlyBytes);
     ssize_t handle_handshake_payload(ReadonlyBytes);
-    ssize_t handle_message(ReadonlyBytes);
+    ssize_t handle_message(Bytes);
     ssize_t handle_random(ReadonlyBytes);
 
     size_t asn1_length(ReadonlyBytes, size_t* octets);
@@ -474,6 +500,12 @@ private:
         }
     }
 
+    // What encrypting a record adds after its payload: AEAD ciphers add a tag, CBC adds a MAC and at most a block of padding.
+    size_t record_trailer_size() const
+    {
+        return is_aead() ? 16 : mac_length() + iv_length();
+    }
+
     bool is_aead() const
     {
         switch (m_context.cipher) {
@@ -488,6 +520,7 @@ private:
     }
 
     bool expand_key();
+    void did_establish_connection();
 
     bool compute_master_secret_from_pre_master_secret(size_t length);
 
@@ -503,7 +536,8 @@ private:
     using CipherVariant = Variant<
         Empty,
         Crypto::Cipher::AESCipher::CBCMode,
-        Crypto::Cipher::AESCipher::GCMMode>;
+        Crypto::Cipher::AESCipher::GCMMode,
+        Crypto::Cipher::ChaCha20Poly1305>;
     CipherVariant m_cipher_local { Empty {} };
     CipherVariant m_cipher_remote { Empty {} };
 
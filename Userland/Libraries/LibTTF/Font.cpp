@@ -12,6 +12,7 @@
 #include <LibTTF/Cmap.h>
 #include <LibTTF/Font.h>
 #include <LibTTF/Glyf.h>
+#include <LibTTF/GlyphCache.h>
 #include <LibTTF/Tables.h>
 #include <LibTextCodec/Decoder.h>
 #include <math.h>
@@ -221,6 +222,11 @@ RefPtr<Font> Font::load_from_file(String path, unsigned index)
     return load_from_memory(buffer, index);
 }
 
+Font::~Font()
+{
+    GlyphCache::the().forget_font(*this);
+}
+
 RefPtr<Font> Font::load_from_memory(ByteBuffer& buffer, unsigned index)
 {
     if (buffer.size() < 4) {
@@ -532,15 +538,14 @@ int ScaledFont::width(const Utf32View& utf32) const
     return width;
 }
 
-RefPtr<Gfx::Bitmap> ScaledFont::raster_glyph(u32 glyph_id) const
+ScaledGlyphMetrics ScaledFont::glyph_metrics(u32 glyph_id) const
 {
-    auto glyph_iterator = m_cached_glyph_bitmaps.find(glyph_id);
-    if (glyph_iterator != m_cached_glyph_bitmaps.end())
-        return glyph_iterator->value;
+    return GlyphCache::the().glyph_metrics(*m_font, m_x_scale, m_y_scale, glyph_id);
+}
 
-    auto glyph_bitmap = m_font->raster_glyph(glyph_id, m_x_scale, m_y_scale);
-    m_cached_glyph_bitmaps.set(glyph_id, glyph_bitmap);
-    return glyph_bitmap;
+RefPtr<Gfx::Bitmap> ScaledFont::raster_glyph(u32 glyph_id) const
+{
+    return GlyphCache::the().raster_glyph(*m_font, m_x_scale, m_y_scale, glyph_id);
 }
 
 Gfx::Glyph ScaledFont::glyph(u32 code_point) const
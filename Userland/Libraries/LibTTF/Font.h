@@ -48,6 +48,7 @@ class Font : public RefCounted<Font> {
 public:
     static RefPtr<Font> load_from_file(String path, unsigned index = 0);
     static RefPtr<Font> load_from_memory(ByteBuffer&, unsigned index = 0);
+    ~Font();
 
     ScaledFontMetrics metrics(float x_scale, float y_scale) const;
     ScaledGlyphMetrics glyph_metrics(u32 glyph_id, float x_scale, float y_scale) const;
@@ -112,7 +113,7 @@ public:
     }
     u32 glyph_id_for_code_point(u32 code_point) const { return m_font->glyph_id_for_code_point(code_point); }
     ScaledFontMetrics metrics() const { return m_font->metrics(m_x_scale, m_y_scale); }
-    ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const { return m_font->glyph_metrics(glyph_id, m_x_scale, m_y_scale); }
+    ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const;
     RefPtr<Gfx::Bitmap> raster_glyph(u32 glyph_id) const;
 
     // Gfx::Font implementation
@@ -148,7 +149,6 @@ private:
     float m_y_scale { 0.0f };
     float m_point_width { 0.0f };
     float m_point_height { 0.0f };
-    mutable HashMap<u32, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
 };
 
 }
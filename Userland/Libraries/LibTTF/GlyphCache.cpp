@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTTF/GlyphCache.h>
+
+namespace TTF {
+
+// That's a few thousand glyphs at typical UI sizes.
+static constexpr size_t glyph_cache_budget = 4 * MiB;
+
+GlyphCache& GlyphCache::the()
+{
+    static GlyphCache s_the;
+    return s_the;
+}
+
+size_t GlyphCache::Entry::size_in_bytes() const
+{
+    return sizeof(Entry) + (bitmap ? bitmap->size_in_bytes() : 0);
+}
+
+GlyphCache::Entry& GlyphCache::ensure_entry(const Font& font, float x_scale, float y_scale, u32 glyph_id)
+{
+    GlyphCacheKey key { &font, x_scale, y_scale, glyph_id };
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        auto& entry = *it->value;
+        m_lru_list.remove(entry);
+        m_lru_list.append(entry);
+        return entry;
+    }
+
+    auto entry = make<Entry>();
+    entry->key = key;
+    entry->metrics = font.glyph_metrics(glyph_id, x_scale, y_scale);
+    auto& entry_ref = *entry;
+    m_lru_list.append(entry_ref);
+    m_total_size_in_bytes += entry_ref.size_in_bytes();
+    m_entries.set(key, move(entry));
+    return entry_ref;
+}
+
+ScaledGlyphMetrics GlyphCache::glyph_metrics(const Font& font, float x_scale, float y_scale, u32 glyph_id)
+{
+    auto metrics = ensure_entry(font, x_scale, y_scale, glyph_id).metrics;
+    evict_if_needed();
+    return metrics;
+}
+
+RefPtr<Gfx::Bitmap> GlyphCache::raster_glyph(const Font& font, float x_scale, float y_scale, u32 glyph_id)
+{
+    auto& entry = ensure_entry(font, x_scale, y_scale, glyph_id);
+    if (!entry.is_rasterized) {
+        entry.bitmap = font.raster_glyph(glyph_id, x_scale, y_scale);
+        entry.is_rasterized = true;
+        if (entry.bitmap)
+            m_total_size_in_bytes += entry.bitmap->size_in_bytes();
+    }
+    auto bitmap = entry.bitmap;
+    evict_if_needed();
+    return bitmap;
+}
+
+void GlyphCache::remove_entry(Entry& entry)
+{
+    auto key = entry.key;
+    m_total_size_in_bytes -= entry.size_in_bytes();
+    m_lru_list.remove(entry);
+    // NOTE: This destroys the entry.
+    m_entries.remove(key);
+}
+
+void GlyphCache::evict_if_needed()
+{
+    // The entry that was just used is at the end of the list, so it's never evicted here.
+    while (m_total_size_in_bytes > glyph_cache_budget && m_lru_list.first() != m_lru_list.last())
+        remove_entry(*m_lru_list.first());
+}
+
+void GlyphCache::forget_font(const Font& font)
+{
+    Vector<Entry*> entries_to_remove;
+    for (auto& it : m_entries) {
+        if (it.key.font == &font)
+            entries_to_remove.append(it.value.ptr());
+    }
+    for (auto* entry : entries_to_remove)
+        remove_entry(*entry);
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BitCast.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <LibGfx/Bitmap.h>
+#include <LibTTF/Font.h>
+
+namespace TTF {
+
+struct GlyphCacheKey {
+    const Font* font { nullptr };
+    float x_scale { 0 };
+    float y_scale { 0 };
+    u32 glyph_id { 0 };
+
+    bool operator==(const GlyphCacheKey& other) const
+    {
+        return font == other.font && x_scale == other.x_scale && y_scale == other.y_scale && glyph_id == other.glyph_id;
+    }
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<TTF::GlyphCacheKey> : public GenericTraits<TTF::GlyphCacheKey> {
+    static unsigned hash(const TTF::GlyphCacheKey& key)
+    {
+        auto hash = pair_int_hash(ptr_hash(key.font), key.glyph_id);
+        return pair_int_hash(hash, pair_int_hash(bit_cast<u32>(key.x_scale), bit_cast<u32>(key.y_scale)));
+    }
+};
+
+}
+
+namespace TTF {
+
+// The metrics and rasterized bitmaps of glyphs of all TrueType fonts in the process, at every size they're
+// used at. Getting either of them from the font means decoding the glyph's outline (and running it through
+// the rasterizer), which would make drawing text much slower than with bitmap fonts. Once the bitmaps take
+// up more memory than the budget, the least recently used glyphs are evicted.
+class GlyphCache {
+public:
+    static GlyphCache& the();
+
+    ScaledGlyphMetrics glyph_metrics(const Font&, float x_scale, float y_scale, u32 glyph_id);
+    RefPtr<Gfx::Bitmap> raster_glyph(const Font&, float x_scale, float y_scale, u32 glyph_id);
+
+    void forget_font(const Font&);
+
+private:
+    GlyphCache() = default;
+
+    struct Entry {
+        GlyphCacheKey key;
+        ScaledGlyphMetrics metrics;
+        bool is_rasterized { false };
+        RefPtr<Gfx::Bitmap> bitmap;
+        IntrusiveListNode<Entry> lru_list_node;
+
+        size_t size_in_bytes() const;
+    };
+
+    Entry& ensure_entry(const Font&, float x_scale, float y_scale, u32 glyph_id);
+    void remove_entry(Entry&);
+    void evict_if_needed();
+
+    HashMap<GlyphCacheKey, NonnullOwnPtr<Entry>> m_entries;
+    // Least recently used first.
+    IntrusiveList<Entry, RawPtr<Entry>, &Entry::lru_list_node> m_lru_list;
+    size_t m_total_size_in_bytes { 0 };
+};
+
+}
@@ -7,10 +7,14 @@
 
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
+#include <AK/JsonObjectSerializer.h>
+#include <AK/QuickSort.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
 #include <LibTest/TestSuite.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 
 namespace Test {
 
@@ -37,6 +41,32 @@ private:
     struct timeval m_started = {};
 };
 
+static u64 monotonic_nanoseconds()
+{
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<u64>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+// Nearest-rank percentile of samples that are already sorted.
+static u64 percentile(const Vector<u64>& samples, unsigned percent)
+{
+    VERIFY(!samples.is_empty());
+    size_t rank = (percent * samples.size() + 99) / 100;
+    return samples[max(rank, (size_t)1) - 1];
+}
+
+static String format_duration(u64 nanoseconds)
+{
+    if (nanoseconds >= 1'000'000'000)
+        return String::formatted("{:.3}s", nanoseconds / 1'000'000'000.0);
+    if (nanoseconds >= 1'000'000)
+        return String::formatted("{:.3}ms", nanoseconds / 1'000'000.0);
+    if (nanoseconds >= 1'000)
+        return String::formatted("{:.3}us", nanoseconds / 1'000.0);
+    return String::formatted("{}ns", nanoseconds);
+}
+
 // Declared in Macros.h
 void current_test_case_did_fail()
 {
@@ -58,14 +88,40 @@ int TestSuite::main(const String& suite_name, int argc, char** argv)
     bool do_tests_only = getenv("TESTS_ONLY") != nullptr;
     bool do_benchmarks_only = false;
     bool do_list_cases = false;
+    const char* benchmark_json_path = nullptr;
+    const char* benchmark_baseline_path = nullptr;
     const char* search_string = "*";
 
     args_parser.add_option(do_tests_only, "Only run tests.", "tests", 0);
     args_parser.add_option(do_benchmarks_only, "Only run benchmarks.", "bench", 0);
     args_parser.add_option(do_list_cases, "List available test cases.", "list", 0);
+    args_parser.add_option(m_benchmark_warmups, "Run each benchmark this many times before timing it.", "bench-warmups", 0, "count");
+    args_parser.add_option(m_benchmark_repetitions, "Time this many runs of each benchmark.", "bench-repetitions", 0, "count");
+    args_parser.add_option(benchmark_json_path, "Write the benchmark timings to a JSON file.", "bench-json", 0, "path");
+    args_parser.add_option(benchmark_baseline_path, "Compare the benchmark timings to a JSON file from an earlier run.", "bench-baseline", 0, "path");
+    args_parser.add_option(m_benchmark_tolerance_percent, "How much slower than the baseline a benchmark may get (default: 10).", "bench-tolerance", 0, "percent");
     args_parser.add_positional_argument(search_string, "Only run matching cases.", "pattern", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
+    if (m_benchmark_warmups < 0 || m_benchmark_repetitions < 1) {
+        warnln("Benchmarks need at least one repetition, and no fewer than zero warmups.");
+        return 1;
+    }
+
+    if (benchmark_baseline_path) {
+        auto file = Core::File::open(benchmark_baseline_path, Core::OpenMode::ReadOnly);
+        if (file.is_error()) {
+            warnln("Failed to open {}: {}", benchmark_baseline_path, file.error());
+            return 1;
+        }
+        auto baseline = JsonValue::from_string(file.value()->read_all());
+        if (!baseline.has_value() || !baseline->is_object() || !baseline->as_object().get("benchmarks").is_object()) {
+            warnln("{} doesn't have any benchmark timings in it", benchmark_baseline_path);
+            return 1;
+        }
+        m_benchmark_baseline = baseline->as_object().get("benchmarks").as_object();
+    }
+
     const auto& matching_tests = find_cases(search_string, !do_benchmarks_only, !do_tests_only);
 
     if (do_list_cases) {
@@ -78,7 +134,11 @@ int TestSuite::main(const String& suite_name, int argc, char** argv)
 
     outln("Running {} cases out of {}.", matching_tests.size(), m_cases.size());
 
-    return run(matching_tests);
+    auto failed_count = run(matching_tests);
+
+    if (benchmark_json_path && !write_benchmark_results(benchmark_json_path))
+        return max(failed_count, 1);
+    return failed_count;
 }
 
 NonnullRefPtrVector<TestCase> TestSuite::find_cases(const String& search, bool find_tests, bool find_benchmarks)
@@ -106,6 +166,7 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
     size_t test_count = 0;
     size_t test_failed_count = 0;
     size_t benchmark_count = 0;
+    size_t benchmark_failed_count = 0;
     TestElapsedTimer global_timer;
 
     for (const auto& t : tests) {
@@ -114,9 +175,20 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         warnln("Running {} '{}'.", test_type, t.name());
         m_current_test_case_passed = true;
 
-        TestElapsedTimer timer;
-        t.func()();
-        const auto time = timer.elapsed_milliseconds();
+        u64 time;
+        if (t.is_benchmark()) {
+            auto result = run_benchmark(t);
+            time = 0;
+            for (auto sample : result.samples)
+                time += sample;
+            time /= 1'000'000;
+            report_benchmark(result);
+            m_benchmark_results.append(move(result));
+        } else {
+            TestElapsedTimer timer;
+            t.func()();
+            time = timer.elapsed_milliseconds();
+        }
 
         dbgln("{} {} '{}' in {}ms", m_current_test_case_passed ? "Completed" : "Failed", test_type, t.name(), time);
 
@@ -129,7 +201,10 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         }
 
         if (!m_current_test_case_passed) {
-            test_failed_count++;
+            if (t.is_benchmark())
+                benchmark_failed_count++;
+            else
+                test_failed_count++;
         }
     }
 
@@ -141,8 +216,97 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         m_benchtime,
         global_timer.elapsed_milliseconds() - (m_testtime + m_benchtime));
     dbgln("Out of {} tests, {} passed and {} failed.", test_count, test_count - test_failed_count, test_failed_count);
+    if (benchmark_count)
+        dbgln("Out of {} benchmarks, {} passed and {} failed.", benchmark_count, benchmark_count - benchmark_failed_count, benchmark_failed_count);
 
-    return (int)test_failed_count;
+    return (int)(test_failed_count + benchmark_failed_count);
+}
+
+TestSuite::BenchmarkResult TestSuite::run_benchmark(const TestCase& benchmark)
+{
+    for (int i = 0; i < m_benchmark_warmups; ++i)
+        benchmark.func()();
+
+    BenchmarkResult result { benchmark.name(), {} };
+    result.samples.ensure_capacity(m_benchmark_repetitions);
+    for (int i = 0; i < m_benchmark_repetitions; ++i) {
+        auto started = monotonic_nanoseconds();
+        benchmark.func()();
+        result.samples.unchecked_append(monotonic_nanoseconds() - started);
+    }
+    quick_sort(result.samples);
+    return result;
+}
+
+void TestSuite::report_benchmark(const BenchmarkResult& result)
+{
+    auto median = percentile(result.samples, 50);
+    if (result.samples.size() == 1) {
+        outln("{}: {}", result.name, format_duration(median));
+    } else {
+        outln("{}: median {}, p90 {}, p99 {}, min {}, max {} over {} runs",
+            result.name,
+            format_duration(median),
+            format_duration(percentile(result.samples, 90)),
+            format_duration(percentile(result.samples, 99)),
+            format_duration(result.samples.first()),
+            format_duration(result.samples.last()),
+            result.samples.size());
+    }
+
+    if (!m_benchmark_baseline.has_value())
+        return;
+
+    auto baseline = m_benchmark_baseline->get(result.name);
+    if (!baseline.is_object())
+        return;
+    auto baseline_median = baseline.as_object().get("median_ns").to_u64();
+    if (baseline_median == 0)
+        return;
+
+    auto change_percent = (static_cast<double>(median) / baseline_median - 1.0) * 100.0;
+    if (change_percent > m_benchmark_tolerance_percent) {
+        warnln("Benchmark '{}' regressed by {:.1}%: median {}, was {}", result.name, change_percent, format_duration(median), format_duration(baseline_median));
+        m_current_test_case_passed = false;
+    } else {
+        outln("    {:+.1}% compared to the baseline", change_percent);
+    }
+}
+
+bool TestSuite::write_benchmark_results(const String& path) const
+{
+    StringBuilder builder;
+    {
+        JsonObjectSerializer suite(builder);
+        suite.add("suite", m_suite_name);
+        suite.add("warmups", m_benchmark_warmups);
+        suite.add("repetitions", m_benchmark_repetitions);
+        auto benchmarks = suite.add_object("benchmarks");
+        for (auto& result : m_benchmark_results) {
+            u64 total = 0;
+            for (auto sample : result.samples)
+                total += sample;
+
+            auto benchmark = benchmarks.add_object(result.name);
+            benchmark.add("min_ns", result.samples.first());
+            benchmark.add("median_ns", percentile(result.samples, 50));
+            benchmark.add("p90_ns", percentile(result.samples, 90));
+            benchmark.add("p99_ns", percentile(result.samples, 99));
+            benchmark.add("max_ns", result.samples.last());
+            benchmark.add("mean_ns", total / result.samples.size());
+        }
+    }
+
+    auto file = Core::File::open(path, Core::OpenMode::WriteOnly);
+    if (file.is_error()) {
+        warnln("Failed to open {}: {}", path, file.error());
+        return false;
+    }
+    if (!file.value()->write(builder.string_view())) {
+        warnln("Failed to write {}: {}", path, file.value()->error_string());
+        return false;
+    }
+    return true;
 }
 
 }
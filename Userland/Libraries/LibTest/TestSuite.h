@@ -11,8 +11,10 @@
 
 #include <AK/Format.h>
 #include <AK/Function.h>
+#include <AK/JsonObject.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibTest/TestCase.h>
 
 namespace Test {
@@ -44,12 +46,29 @@ public:
     void current_test_case_did_fail() { m_current_test_case_passed = false; }
 
 private:
+    struct BenchmarkResult {
+        String name;
+        // The time every timed run took, in nanoseconds, sorted from fastest to slowest.
+        Vector<u64> samples;
+    };
+
+    BenchmarkResult run_benchmark(const TestCase&);
+    void report_benchmark(const BenchmarkResult&);
+    bool write_benchmark_results(const String& path) const;
+
     static TestSuite* s_global;
     NonnullRefPtrVector<TestCase> m_cases;
     u64 m_testtime = 0;
     u64 m_benchtime = 0;
     String m_suite_name;
     bool m_current_test_case_passed = true;
+
+    int m_benchmark_warmups = 0;
+    int m_benchmark_repetitions = 1;
+    // Benchmarks whose median got slower than in the baseline by more than the tolerance fail.
+    Optional<JsonObject> m_benchmark_baseline;
+    int m_benchmark_tolerance_percent = 10;
+    Vector<BenchmarkResult> m_benchmark_results;
 };
 
 }
@@ -4,28 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/Queue.h>
 #include <LibThreading/BackgroundAction.h>
-#include <LibThreading/Lock.h>
 #include <LibThreading/Thread.h>
 
-static Threading::Lockable<Queue<Function<void()>>>* s_all_actions;
+static Threading::BackgroundActionBase::WorkQueue* s_all_actions;
 static Threading::Thread* s_background_thread;
 
 static intptr_t background_thread_func()
 {
     while (true) {
-        Function<void()> work_item;
-        {
-            Threading::Locker locker(s_all_actions->lock());
-
-            if (!s_all_actions->resource().is_empty())
-                work_item = s_all_actions->resource().dequeue();
-        }
-        if (work_item)
-            work_item();
-        else
-            sleep(1);
+        auto work_item = s_all_actions->dequeue();
+        work_item();
     }
 
     VERIFY_NOT_REACHED();
@@ -33,13 +22,13 @@ static intptr_t background_thread_func()
 
 static void init()
 {
-    s_all_actions = new Threading::Lockable<Queue<Function<void()>>>();
+    s_all_actions = new Threading::BackgroundActionBase::WorkQueue();
     s_background_thread = &Threading::Thread::construct(background_thread_func).leak_ref();
     s_background_thread->set_name("Background thread");
     s_background_thread->start();
 }
 
-Threading::Lockable<Queue<Function<void()>>>& Threading::BackgroundActionBase::all_actions()
+Threading::BackgroundActionBase::WorkQueue& Threading::BackgroundActionBase::all_actions()
 {
     if (s_all_actions == nullptr)
         init();
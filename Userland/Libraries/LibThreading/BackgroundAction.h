@@ -9,11 +9,10 @@
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
-#include <AK/Queue.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
-#include <LibThreading/Lock.h>
+#include <LibThreading/BlockingQueue.h>
 #include <LibThreading/Thread.h>
 
 namespace Threading {
@@ -25,10 +24,13 @@ class BackgroundActionBase {
     template<typename Result>
     friend class BackgroundAction;
 
+public:
+    using WorkQueue = BlockingQueue<Function<void()>, 1024>;
+
 private:
     BackgroundActionBase() { }
 
-    static Lockable<Queue<Function<void()>>>& all_actions();
+    static WorkQueue& all_actions();
     static Thread& background_thread();
 };
 
@@ -53,9 +55,7 @@ private:
         , m_action(move(action))
         , m_on_complete(move(on_complete))
     {
-        Locker locker(all_actions().lock());
-
-        all_actions().resource().enqueue([this] {
+        all_actions().enqueue([this] {
             m_result = m_action();
             if (m_on_complete) {
                 Core::EventLoop::current().post_event(*this, make<Core::DeferredInvocationEvent>([this](auto&) {
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/MPMCQueue.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <LibThreading/Event.h>
+
+namespace Threading {
+
+// An MPMCQueue that threads can also go to sleep on, until there's something to dequeue or room to enqueue.
+// Neither side makes a syscall unless somebody is actually waiting.
+template<typename T, size_t Capacity>
+class BlockingQueue {
+    AK_MAKE_NONCOPYABLE(BlockingQueue);
+    AK_MAKE_NONMOVABLE(BlockingQueue);
+
+public:
+    BlockingQueue() = default;
+
+    [[nodiscard]] bool try_enqueue(T&& value)
+    {
+        if (!m_queue.try_enqueue(move(value)))
+            return false;
+        m_items_available.notify();
+        return true;
+    }
+
+    void enqueue(T&& value)
+    {
+        for (;;) {
+            auto generation = m_space_available.generation();
+            if (try_enqueue(move(value)))
+                return;
+            m_space_available.wait(generation);
+        }
+    }
+
+    [[nodiscard]] Optional<T> try_dequeue()
+    {
+        auto value = m_queue.try_dequeue();
+        if (value.has_value())
+            m_space_available.notify();
+        return value;
+    }
+
+    T dequeue()
+    {
+        for (;;) {
+            auto generation = m_items_available.generation();
+            if (auto value = try_dequeue(); value.has_value())
+                return value.release_value();
+            m_items_available.wait(generation);
+        }
+    }
+
+    size_t size() const { return m_queue.size(); }
+    bool is_empty() const { return m_queue.is_empty(); }
+
+private:
+    MPMCQueue<T, Capacity> m_queue;
+    Event m_items_available;
+    Event m_space_available;
+};
+
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/DirIterator.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <errno.h>
+
+namespace Threading {
+
+static unsigned char type_from_mode(mode_t mode)
+{
+    if (S_ISDIR(mode))
+        return DT_DIR;
+    if (S_ISLNK(mode))
+        return DT_LNK;
+    if (S_ISCHR(mode))
+        return DT_CHR;
+    if (S_ISBLK(mode))
+        return DT_BLK;
+    if (S_ISFIFO(mode))
+        return DT_FIFO;
+    if (S_ISSOCK(mode))
+        return DT_SOCK;
+    return DT_REG;
+}
+
+static bool wants_stat(DirectoryWalker::Options const& options, unsigned char type)
+{
+    switch (options.stat_entries) {
+    case DirectoryWalker::StatEntries::No:
+        return false;
+    case DirectoryWalker::StatEntries::DirectoriesOnly:
+        return type == DT_DIR;
+    case DirectoryWalker::StatEntries::Yes:
+        return true;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Stats the entry (following a symbolic link if asked to, and if it doesn't dangle), and fills in its type and stat.
+static void stat_entry(DirectoryWalker::Entry& entry, bool follow_symlink, DirectoryWalker::Options const& options)
+{
+    struct stat st;
+    int rc = follow_symlink ? stat(entry.path.characters(), &st) : -1;
+    if (rc < 0)
+        rc = lstat(entry.path.characters(), &st);
+    if (rc < 0)
+        return;
+    entry.type = type_from_mode(st.st_mode);
+    if (wants_stat(options, entry.type))
+        entry.stat = st;
+}
+
+DirectoryWalker::Listing DirectoryWalker::read_directory(String const& path, size_t depth, Options const& options)
+{
+    Listing listing;
+    Core::DirIterator iterator(path, Core::DirIterator::SkipParentAndBaseDir);
+    while (iterator.has_next()) {
+        auto directory_entry = iterator.next_entry();
+        Entry entry { String::formatted("{}/{}", path, directory_entry.name), depth, directory_entry.type, {} };
+        bool follow_symlink = options.follow_symlinks && entry.type == DT_LNK;
+        if (entry.type == DT_UNKNOWN || follow_symlink || wants_stat(options, entry.type))
+            stat_entry(entry, follow_symlink, options);
+        listing.entries.append(move(entry));
+    }
+    listing.error = iterator.error();
+    return listing;
+}
+
+void DirectoryWalker::walk(String const& root)
+{
+    struct stat st;
+    int rc = (m_options.follow_symlinks || m_options.follow_root_symlink) ? stat(root.characters(), &st) : -1;
+    if (rc < 0)
+        rc = lstat(root.characters(), &st);
+    if (rc < 0) {
+        if (on_error)
+            on_error(root, errno);
+        return;
+    }
+    visit({ root, 0, type_from_mode(st.st_mode), st }, nullptr);
+}
+
+bool DirectoryWalker::should_read(Entry const& entry) const
+{
+    return entry.is_directory() && entry.depth < m_options.max_depth;
+}
+
+DirectoryWalker::PendingListing DirectoryWalker::start_reading(Entry const& entry)
+{
+    ++m_listings_in_flight;
+    return m_pool.async<Listing>([path = entry.path, depth = entry.depth + 1, options = m_options] {
+        return read_directory(path, depth, options);
+    });
+}
+
+void DirectoryWalker::visit(Entry const& entry, PendingListing pending)
+{
+    auto decision = on_enter ? on_enter(entry) : Decision::Continue;
+
+    if (decision == Decision::Continue && should_read(entry)) {
+        if (!pending)
+            pending = start_reading(entry);
+        auto& listing = pending->await();
+        --m_listings_in_flight;
+
+        // Start reading the subdirectories right away, so they're (hopefully) there by the time they're visited.
+        // There's a limit to how far ahead this goes, since a wide tree would otherwise be read all at once.
+        Vector<PendingListing> pending_children;
+        pending_children.resize(listing.entries.size());
+        for (size_t i = 0; i < listing.entries.size() && m_listings_in_flight < m_pool.thread_count() * 4; ++i) {
+            if (should_read(listing.entries[i]))
+                pending_children[i] = start_reading(listing.entries[i]);
+        }
+
+        for (size_t i = 0; i < listing.entries.size(); ++i)
+            visit(listing.entries[i], move(pending_children[i]));
+
+        if (listing.error && on_error)
+            on_error(entry.path, listing.error);
+    } else if (pending) {
+        // Nobody is going to look at what was read ahead, but it doesn't count towards the limit anymore.
+        --m_listings_in_flight;
+    }
+
+    if (on_leave)
+        on_leave(entry);
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/String.h>
+#include <LibThreading/ThreadPool.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace Threading {
+
+// Walks a directory tree depth first, and calls back on the calling thread in the same order that a plain recursive
+// walk would. Meanwhile, the directories that come up next are read (and their entries stat'ed, where that's needed)
+// ahead of time on the thread pool, so that slow storage gets several requests at once instead of one after another.
+class DirectoryWalker {
+public:
+    struct Entry {
+        String path;
+        // The root is at depth 0, and its entries at depth 1.
+        size_t depth { 0 };
+        // One of the DT_* constants. This comes from the directory where possible, and is only DT_UNKNOWN
+        // if the entry went away before it could be stat'ed.
+        unsigned char type { DT_UNKNOWN };
+        // Only there when the options ask for it, except for the root, which is always stat'ed.
+        Optional<struct stat> stat;
+
+        bool is_directory() const { return type == DT_DIR; }
+    };
+
+    enum class StatEntries {
+        No,
+        DirectoriesOnly,
+        Yes,
+    };
+
+    struct Options {
+        // Symbolic links to directories are walked into like the directories themselves, and stat'ed as their target.
+        bool follow_symlinks { false };
+        // Whether the root is walked into if it's a symbolic link to a directory, even if other links aren't followed.
+        bool follow_root_symlink { false };
+        StatEntries stat_entries { StatEntries::No };
+        // Directories deeper than this aren't read.
+        size_t max_depth { NumericLimits<size_t>::max() };
+    };
+
+    enum class Decision {
+        Continue,
+        SkipChildren,
+    };
+
+    explicit DirectoryWalker(Options options, ThreadPool& pool = ThreadPool::the())
+        : m_options(options)
+        , m_pool(pool)
+    {
+    }
+
+    // Called for every entry before the ones below it.
+    Function<Decision(Entry const&)> on_enter;
+    // Called for every entry after the ones below it.
+    Function<void(Entry const&)> on_leave;
+    // Called with the errno when the root can't be stat'ed, or a directory can't be read.
+    Function<void(String const& path, int error)> on_error;
+
+    void walk(String const& root);
+
+private:
+    struct Listing {
+        int error { 0 };
+        Vector<Entry> entries;
+    };
+    using PendingListing = RefPtr<Future<Listing>>;
+
+    static Listing read_directory(String const& path, size_t depth, Options const&);
+    bool should_read(Entry const&) const;
+    PendingListing start_reading(Entry const&);
+    void visit(Entry const&, PendingListing);
+
+    Options m_options;
+    ThreadPool& m_pool;
+    size_t m_listings_in_flight { 0 };
+};
+
+}
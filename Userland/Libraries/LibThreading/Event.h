@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/NumericLimits.h>
+#include <AK/Types.h>
+
+#ifdef __serenity__
+#    include <serenity.h>
+#else
+#    include <sched.h>
+#endif
+
+namespace Threading {
+
+// Something for threads to go to sleep on until another thread says that whatever they're waiting for may have happened.
+// Waiters remember the generation they saw before checking their condition, so a notify() that happens between
+// their check and their wait() makes the wait return right away instead of getting lost.
+// Notifying doesn't make a syscall unless somebody is actually waiting.
+class Event {
+    AK_MAKE_NONCOPYABLE(Event);
+    AK_MAKE_NONMOVABLE(Event);
+
+public:
+    Event() = default;
+
+    u32 generation() const { return m_generation.load(); }
+
+    void notify() { notify(1); }
+    void notify_all() { notify(NumericLimits<i32>::max()); }
+
+    void wait(u32 seen_generation)
+    {
+        m_waiters.fetch_add(1);
+#ifdef __serenity__
+        futex(const_cast<u32*>(m_generation.ptr()), FUTEX_WAIT, seen_generation, nullptr, nullptr, 0);
+#else
+        if (m_generation.load() == seen_generation)
+            sched_yield();
+#endif
+        m_waiters.fetch_sub(1);
+    }
+
+private:
+    void notify([[maybe_unused]] i32 count)
+    {
+        m_generation.fetch_add(1);
+        if (m_waiters.load() == 0)
+            return;
+#ifdef __serenity__
+        futex(const_cast<u32*>(m_generation.ptr()), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#endif
+    }
+
+    Atomic<u32> m_generation { 0 };
+    Atomic<u32> m_waiters { 0 };
+};
+
+}
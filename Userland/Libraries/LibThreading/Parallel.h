@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/MergeSort.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibThreading/Event.h>
+#include <LibThreading/ThreadPool.h>
+
+namespace Threading {
+
+namespace Detail {
+
+// Calls callback(chunk_index, begin, end) for count items split into chunks of at least minimum_chunk_size,
+// with the first chunk running on the calling thread, and returns once all of them are done.
+template<typename Callback>
+void for_each_chunk(ThreadPool& pool, size_t count, size_t minimum_chunk_size, Callback callback)
+{
+    VERIFY(minimum_chunk_size > 0);
+    if (count == 0)
+        return;
+
+    // A few chunks per thread, so that one slow chunk doesn't hold everyone else up.
+    size_t chunk_count = min(pool.thread_count() * 4, (count + minimum_chunk_size - 1) / minimum_chunk_size);
+    if (chunk_count <= 1) {
+        callback(0, 0, count);
+        return;
+    }
+
+    size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+    chunk_count = (count + chunk_size - 1) / chunk_size;
+
+    Atomic<size_t> remaining_chunks { chunk_count - 1 };
+    Event chunk_done;
+    for (size_t chunk = 1; chunk < chunk_count; ++chunk) {
+        pool.submit([&, chunk] {
+            callback(chunk, chunk * chunk_size, min(count, (chunk + 1) * chunk_size));
+            if (remaining_chunks.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel) == 1)
+                chunk_done.notify_all();
+        });
+    }
+    callback(0, 0, min(count, chunk_size));
+    pool.help_until(chunk_done, [&] { return remaining_chunks.load(AK::MemoryOrder::memory_order_acquire) == 0; });
+}
+
+}
+
+// Calls callback for every element of the span, spread across the pool.
+// NOTE: There's no telling in which order (or on which thread) the elements are visited.
+template<typename T, typename Callback>
+void parallel_for(Span<T> span, Callback callback, size_t minimum_chunk_size = 64, ThreadPool& pool = ThreadPool::the())
+{
+    Detail::for_each_chunk(pool, span.size(), minimum_chunk_size, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            callback(span[i]);
+    });
+}
+
+// Combines all elements of the span with reduce(accumulator, element), starting from identity.
+// Every chunk is reduced on its own first, and the chunks' results are then combined in order,
+// so reduce has to be associative, but doesn't have to be commutative.
+template<typename T, typename Accumulator, typename Reduce>
+Accumulator parallel_reduce(Span<T> span, Accumulator identity, Reduce reduce, size_t minimum_chunk_size = 64, ThreadPool& pool = ThreadPool::the())
+{
+    Vector<Optional<Accumulator>> partial_results;
+    partial_results.resize(pool.thread_count() * 4);
+    size_t used_chunks = 0;
+    Detail::for_each_chunk(pool, span.size(), minimum_chunk_size, [&](size_t chunk, size_t begin, size_t end) {
+        Accumulator accumulator = identity;
+        for (size_t i = begin; i < end; ++i)
+            accumulator = reduce(move(accumulator), span[i]);
+        partial_results[chunk] = move(accumulator);
+        if (end == span.size())
+            used_chunks = chunk + 1;
+    });
+
+    Accumulator result = move(identity);
+    for (size_t i = 0; i < used_chunks; ++i)
+        result = reduce(move(result), partial_results[i].release_value());
+    return result;
+}
+
+// A stable sort: every chunk is merge sorted on its own, and neighbouring runs are then merged in parallel until only one is left.
+template<typename T, typename LessThan>
+void parallel_sort(Span<T> span, LessThan less_than, size_t minimum_chunk_size = 1024, ThreadPool& pool = ThreadPool::the())
+{
+    Vector<size_t> run_starts;
+    run_starts.resize(pool.thread_count() * 4 + 1);
+    Atomic<size_t> run_count { 0 };
+    Detail::for_each_chunk(pool, span.size(), minimum_chunk_size, [&](size_t chunk, size_t begin, size_t end) {
+        auto run = span.slice(begin, end - begin);
+        merge_sort(run, less_than);
+        run_starts[chunk] = begin;
+        run_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    });
+    size_t runs = run_count.load();
+    run_starts.resize(runs);
+    run_starts.append(span.size());
+
+    while (runs > 1) {
+        size_t merges = runs / 2;
+        Detail::for_each_chunk(pool, merges, 1, [&](size_t, size_t first_merge, size_t last_merge) {
+            Vector<T> buffer;
+            for (size_t merge = first_merge; merge < last_merge; ++merge) {
+                size_t begin = run_starts[merge * 2];
+                size_t middle = run_starts[merge * 2 + 1];
+                size_t end = run_starts[merge * 2 + 2];
+
+                buffer.clear_with_capacity();
+                buffer.ensure_capacity(middle - begin);
+                for (size_t i = begin; i < middle; ++i)
+                    buffer.unchecked_append(move(span[i]));
+
+                size_t left = 0;
+                size_t right = middle;
+                size_t out = begin;
+                while (left < buffer.size() && right < end) {
+                    if (less_than(span[right], buffer[left]))
+                        span[out++] = move(span[right++]);
+                    else
+                        span[out++] = move(buffer[left++]);
+                }
+                while (left < buffer.size())
+                    span[out++] = move(buffer[left++]);
+            }
+        });
+
+        // Every merge turned two runs into one, and an odd one out at the end stays as it is.
+        Vector<size_t> merged_run_starts;
+        for (size_t i = 0; i < runs; i += 2)
+            merged_run_starts.append(run_starts[i]);
+        merged_run_starts.append(span.size());
+        run_starts = move(merged_run_starts);
+        runs = run_starts.size() - 1;
+    }
+}
+
+template<typename T>
+void parallel_sort(Span<T> span)
+{
+    parallel_sort(span, [](auto& a, auto& b) { return a < b; });
+}
+
+}
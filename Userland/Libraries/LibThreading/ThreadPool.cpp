@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+// The queue of the worker running on this thread, if any.
+static __thread size_t s_current_worker_index;
+static __thread ThreadPool* s_current_pool;
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the;
+    if (!s_the) {
+        auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        s_the = new ThreadPool(processor_count > 0 ? processor_count : 1);
+    }
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    VERIFY(thread_count > 0);
+    for (size_t i = 0; i < thread_count; ++i)
+        m_workers.append(make<Worker>());
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto thread = Thread::construct([this, i] { return worker_main(i); }, String::formatted("Worker {}", i));
+        thread->start();
+        m_threads.append(move(thread));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_exiting.store(true);
+    m_jobs_available.notify_all();
+    for (auto& thread : m_threads)
+        [[maybe_unused]] auto result = thread.join();
+}
+
+void ThreadPool::submit(Job job)
+{
+    size_t first_worker = s_current_pool == this ? s_current_worker_index : m_next_worker.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto& worker = m_workers[(first_worker + i) % m_workers.size()];
+        if (worker.jobs.try_enqueue(move(job))) {
+            m_jobs_available.notify();
+            return;
+        }
+    }
+    job();
+}
+
+bool ThreadPool::run_one_job()
+{
+    // Start with our own queue, and then go around stealing from everyone else.
+    size_t first_worker = s_current_pool == this ? s_current_worker_index : 0;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto& worker = m_workers[(first_worker + i) % m_workers.size()];
+        if (auto job = worker.jobs.try_dequeue(); job.has_value()) {
+            job.value()();
+            return true;
+        }
+    }
+    return false;
+}
+
+intptr_t ThreadPool::worker_main(size_t worker_index)
+{
+    s_current_pool = this;
+    s_current_worker_index = worker_index;
+    for (;;) {
+        auto generation = m_jobs_available.generation();
+        if (run_one_job())
+            continue;
+        if (m_exiting.load())
+            return 0;
+        m_jobs_available.wait(generation);
+    }
+}
+
+}
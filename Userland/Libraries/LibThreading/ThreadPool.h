@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/MPMCQueue.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <LibCore/Event.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Object.h>
+#include <LibThreading/Event.h>
+#include <LibThreading/Lock.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+template<typename Result>
+class Future;
+
+// A fixed set of worker threads that run jobs as they come in.
+// Every worker has a queue of its own, which is where jobs submitted from that worker go, so related work tends to
+// stay on one CPU. A worker that runs out of jobs steals them from the other workers' queues before going to sleep.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    using Job = Function<void()>;
+
+    // A pool with one worker for every CPU, which is started the first time it's needed and never goes away.
+    static ThreadPool& the();
+
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+    // NOTE: If every queue is full, the job runs right away on the calling thread instead.
+    void submit(Job);
+
+    // Runs a job on the result's behalf and returns right away. The result can either be waited for with
+    // Future::await(), or handed to a callback on the event loop with Future::on_ready().
+    template<typename Result>
+    NonnullRefPtr<Future<Result>> async(Function<Result()> work);
+
+    // Runs queued jobs on the calling thread until condition() holds, so that waiting on other jobs
+    // (even from inside a job) keeps the pool busy instead of tying up a thread.
+    template<typename Condition>
+    void help_until(Event& event, Condition condition)
+    {
+        for (;;) {
+            auto generation = event.generation();
+            if (condition())
+                return;
+            if (run_one_job())
+                continue;
+            event.wait(generation);
+        }
+    }
+
+private:
+    static constexpr size_t queue_capacity = 256;
+
+    struct Worker {
+        MPMCQueue<Job, queue_capacity> jobs;
+    };
+
+    bool run_one_job();
+    intptr_t worker_main(size_t worker_index);
+
+    NonnullOwnPtrVector<Worker> m_workers;
+    NonnullRefPtrVector<Thread> m_threads;
+    Atomic<size_t> m_next_worker { 0 };
+    Event m_jobs_available;
+    Atomic<bool> m_exiting { false };
+};
+
+template<typename Result>
+class Future : public RefCounted<Future<Result>> {
+    friend class ThreadPool;
+
+public:
+    bool is_ready() const { return m_ready.load(AK::MemoryOrder::memory_order_acquire); }
+
+    // Blocks until the result is there, running other jobs in the meantime.
+    Result& await()
+    {
+        m_pool.help_until(m_ready_event, [this] { return is_ready(); });
+        return m_result.value();
+    }
+
+    // Calls on_ready with the result on the calling thread's event loop, once the result is there.
+    // NOTE: There's only one result, so only one callback may be installed, and it gets to take the result.
+    void on_ready(Function<void(Result)> on_ready)
+    {
+        auto receiver = Receiver::construct();
+        auto& event_loop = Core::EventLoop::current();
+        Locker locker(m_lock);
+        VERIFY(!m_on_ready);
+        m_on_ready = [this, protector = NonnullRefPtr(*this), receiver = move(receiver), &event_loop, on_ready = move(on_ready)]() mutable {
+            event_loop.post_event(*receiver, make<Core::DeferredInvocationEvent>([this, protector = move(protector), receiver, on_ready = move(on_ready)](auto&) {
+                on_ready(m_result.release_value());
+            }));
+            Core::EventLoop::wake();
+        };
+        if (is_ready())
+            m_on_ready();
+    }
+
+private:
+    class Receiver final : public Core::Object {
+        C_OBJECT(Receiver);
+    };
+
+    explicit Future(ThreadPool& pool)
+        : m_pool(pool)
+    {
+    }
+
+    void resolve(Result&& result)
+    {
+        Locker locker(m_lock);
+        m_result = move(result);
+        m_ready.store(true, AK::MemoryOrder::memory_order_release);
+        m_ready_event.notify_all();
+        if (m_on_ready)
+            m_on_ready();
+    }
+
+    ThreadPool& m_pool;
+    Lock m_lock;
+    Optional<Result> m_result;
+    Atomic<bool> m_ready { false };
+    Event m_ready_event;
+    Function<void()> m_on_ready;
+};
+
+template<typename Result>
+NonnullRefPtr<Future<Result>> ThreadPool::async(Function<Result()> work)
+{
+    auto future = adopt_ref(*new Future<Result>(*this));
+    submit([future, work = move(work)]() mutable {
+        future->resolve(work());
+    });
+    return future;
+}
+
+}
@@ -9,6 +9,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
+#include <AK/MappedFile.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/String.h>
@@ -122,8 +123,9 @@ public:
     bool discardable() const { return m_discardable; }
     void set_discardable(bool discardable) { m_discardable = discardable; }
     u64 frame_count() const { return m_frames.size(); }
-    const ByteBuffer& frame(size_t index) const { return m_frames.at(index); }
-    void add_frame(const ByteBuffer& frame) { m_frames.append(move(frame)); }
+    // Frames point into the data the block was read from, so they're only good for as long as that's around.
+    ReadonlyBytes frame(size_t index) const { return m_frames.at(index); }
+    void add_frame(ReadonlyBytes frame) { m_frames.append(frame); }
 
 private:
     u64 m_track_number { 0 };
@@ -132,7 +134,7 @@ private:
     bool m_invisible { false };
     Lacing m_lacing { None };
     bool m_discardable { true };
-    Vector<ByteBuffer> m_frames;
+    Vector<ReadonlyBytes> m_frames;
 };
 
 class Cluster {
@@ -147,6 +149,14 @@ private:
     NonnullOwnPtrVector<Block> m_blocks;
 };
 
+struct CuePoint {
+    // In the same units as cluster timestamps, i.e. the segment's timestamp scale.
+    u64 timestamp { 0 };
+    u64 track_number { 0 };
+    // Relative to the start of the segment's data.
+    u64 cluster_position { 0 };
+};
+
 class MatroskaDocument {
 public:
     explicit MatroskaDocument(EBMLHeader m_header)
@@ -184,12 +194,19 @@ public:
         m_tracks.set(track_number, move(track));
     }
     NonnullOwnPtrVector<Cluster>& clusters() { return m_clusters; }
+    Vector<CuePoint>& cue_points() { return m_cue_points; }
+    const Vector<CuePoint>& cue_points() const { return m_cue_points; }
+
+    // The blocks' frames point into the file, so it's kept mapped for as long as the document is around.
+    void set_mapped_file(NonnullRefPtr<MappedFile> mapped_file) { m_mapped_file = move(mapped_file); }
 
 private:
+    RefPtr<MappedFile> m_mapped_file;
     EBMLHeader m_header;
     OwnPtr<SegmentInformation> m_segment_information;
     HashMap<u64, NonnullOwnPtr<TrackEntry>> m_tracks;
     NonnullOwnPtrVector<Cluster> m_clusters;
+    Vector<CuePoint> m_cue_points;
 };
 
 }
@@ -40,6 +40,16 @@ constexpr u32 CHANNELS_ID = 0x9F;
 constexpr u32 BIT_DEPTH_ID = 0x6264;
 constexpr u32 SIMPLE_BLOCK_ID = 0xA3;
 constexpr u32 TIMESTAMP_ID = 0xE7;
+constexpr u32 SEEK_HEAD_ID = 0x114D9B74;
+constexpr u32 SEEK_ID = 0x4DBB;
+constexpr u32 SEEK_ID_ID = 0x53AB;
+constexpr u32 SEEK_POSITION_ID = 0x53AC;
+constexpr u32 CUES_ID = 0x1C53BB6B;
+constexpr u32 CUE_POINT_ID = 0xBB;
+constexpr u32 CUE_TIME_ID = 0xB3;
+constexpr u32 CUE_TRACK_POSITIONS_ID = 0xB7;
+constexpr u32 CUE_TRACK_ID = 0xF7;
+constexpr u32 CUE_CLUSTER_POSITION_ID = 0xF1;
 
 OwnPtr<MatroskaDocument> MatroskaReader::parse_matroska_from_file(const StringView& path)
 {
@@ -48,7 +58,11 @@ OwnPtr<MatroskaDocument> MatroskaReader::parse_matroska_from_file(const StringVi
         return {};
 
     auto mapped_file = mapped_file_result.release_value();
-    return parse_matroska_from_data((u8*)mapped_file->data(), mapped_file->size());
+    auto matroska_document = parse_matroska_from_data((u8*)mapped_file->data(), mapped_file->size());
+    if (!matroska_document)
+        return {};
+    matroska_document->set_mapped_file(move(mapped_file));
+    return matroska_document;
 }
 
 OwnPtr<MatroskaDocument> MatroskaReader::parse_matroska_from_data(const u8* data, size_t size)
@@ -57,7 +71,45 @@ OwnPtr<MatroskaDocument> MatroskaReader::parse_matroska_from_data(const u8* data
     return reader.parse();
 }
 
+OwnPtr<MatroskaReader> MatroskaReader::stream_matroska_from_file(const StringView& path)
+{
+    auto mapped_file_result = MappedFile::map(path);
+    if (mapped_file_result.is_error())
+        return {};
+
+    auto mapped_file = mapped_file_result.release_value();
+    auto reader = stream_matroska_from_data((u8*)mapped_file->data(), mapped_file->size());
+    if (!reader)
+        return {};
+    reader->m_mapped_file = move(mapped_file);
+    return reader;
+}
+
+OwnPtr<MatroskaReader> MatroskaReader::stream_matroska_from_data(const u8* data, size_t size)
+{
+    auto reader = make<MatroskaReader>(data, size);
+    reader->m_document = reader->parse_up_to_segment();
+    if (!reader->m_document)
+        return {};
+    if (!reader->parse_segment_headers())
+        return {};
+    return reader;
+}
+
 OwnPtr<MatroskaDocument> MatroskaReader::parse()
+{
+    auto matroska_document = parse_up_to_segment();
+    if (!matroska_document)
+        return {};
+
+    auto segment_parse_success = parse_segment_elements(*matroska_document);
+    if (!segment_parse_success)
+        return {};
+
+    return matroska_document;
+}
+
+OwnPtr<MatroskaDocument> MatroskaReader::parse_up_to_segment()
 {
     auto first_element_id = m_streamer.read_variable_size_integer(false);
     dbgln_if(MATROSKA_TRACE_DEBUG, "First element ID is {:#010x}\n", first_element_id.value());
@@ -74,13 +126,7 @@ OwnPtr<MatroskaDocument> MatroskaReader::parse()
     if (!root_element_id.has_value() || root_element_id.value() != SEGMENT_ELEMENT_ID)
         return {};
 
-    auto matroska_document = make<MatroskaDocument>(header.value());
-
-    auto segment_parse_success = parse_segment_elements(*matroska_document);
-    if (!segment_parse_success)
-        return {};
-
-    return matroska_document;
+    return make<MatroskaDocument>(header.value());
 }
 
 bool MatroskaReader::parse_master_element([[maybe_unused]] const StringView& element_name, Function<bool(u64)> element_consumer)
@@ -152,6 +198,8 @@ bool MatroskaReader::parse_segment_elements(MatroskaDocument& matroska_document)
             if (!cluster)
                 return false;
             matroska_document.clusters().append(cluster.release_nonnull());
+        } else if (element_id == CUES_ID) {
+            return parse_cues(matroska_document);
         } else {
             return read_unknown_element();
         }
@@ -163,6 +211,107 @@ bool MatroskaReader::parse_segment_elements(MatroskaDocument& matroska_document)
     return success;
 }
 
+bool MatroskaReader::parse_segment_headers()
+{
+    dbgln_if(MATROSKA_DEBUG, "Parsing segment headers");
+    auto segment_data_size = m_streamer.read_variable_size_integer();
+    CHECK_HAS_VALUE(segment_data_size);
+    m_segment_data_position = m_streamer.position();
+    // The size may be "unknown", which is all ones, so it doesn't necessarily fit into the file.
+    m_segment_end = m_segment_data_position + min(segment_data_size.value(), m_streamer.remaining());
+    m_next_cluster_position = m_segment_end;
+
+    Optional<u64> cues_position;
+    bool has_parsed_cues = false;
+    while (m_streamer.position() < m_segment_end) {
+        auto element_position = m_streamer.position();
+        auto element_id = m_streamer.read_variable_size_integer(false);
+        CHECK_HAS_VALUE(element_id);
+
+        // Everything that's needed before playback comes before the first cluster, except for the cues,
+        // which usually come at the very end. Those are found through the seek head instead.
+        if (element_id.value() == CLUSTER_ELEMENT_ID) {
+            m_next_cluster_position = element_position;
+            break;
+        }
+
+        bool success;
+        if (element_id.value() == SEGMENT_INFORMATION_ELEMENT_ID) {
+            auto segment_information = parse_information();
+            success = segment_information;
+            m_document->set_segment_information(move(segment_information));
+        } else if (element_id.value() == TRACK_ELEMENT_ID) {
+            success = parse_tracks(*m_document);
+        } else if (element_id.value() == SEEK_HEAD_ID) {
+            success = parse_seek_head(cues_position);
+        } else if (element_id.value() == CUES_ID) {
+            success = parse_cues(*m_document);
+            has_parsed_cues = true;
+        } else {
+            success = read_unknown_element();
+        }
+        if (!success)
+            return false;
+    }
+
+    if (!has_parsed_cues && cues_position.has_value() && m_streamer.seek(m_segment_data_position + cues_position.value())) {
+        // Without cues, seeking doesn't work, but the clusters can still be read. So this isn't treated as an error.
+        auto element_id = m_streamer.read_variable_size_integer(false);
+        if (!element_id.has_value() || element_id.value() != CUES_ID || !parse_cues(*m_document)) {
+            dbgln_if(MATROSKA_DEBUG, "Failed to parse the cues the seek head points to");
+            m_document->cue_points().clear();
+        }
+    }
+
+    return true;
+}
+
+OwnPtr<Cluster> MatroskaReader::read_next_cluster()
+{
+    VERIFY(m_document);
+
+    while (m_next_cluster_position < m_segment_end) {
+        if (!m_streamer.seek(m_next_cluster_position))
+            return {};
+        auto element_id = m_streamer.read_variable_size_integer(false);
+        if (!element_id.has_value())
+            return {};
+
+        // Cues, tags and the like can come between or after the clusters.
+        if (element_id.value() != CLUSTER_ELEMENT_ID) {
+            if (!read_unknown_element())
+                return {};
+            m_next_cluster_position = m_streamer.position();
+            continue;
+        }
+
+        auto cluster = parse_cluster();
+        if (!cluster)
+            return {};
+        m_next_cluster_position = m_streamer.position();
+        return cluster;
+    }
+
+    return {};
+}
+
+bool MatroskaReader::seek_to_timestamp(u64 timestamp)
+{
+    VERIFY(m_document);
+
+    Optional<u64> cluster_position;
+    for (auto& cue_point : m_document->cue_points()) {
+        if (cue_point.timestamp > timestamp)
+            break;
+        cluster_position = cue_point.cluster_position;
+    }
+    if (!cluster_position.has_value())
+        return false;
+
+    m_next_cluster_position = m_segment_data_position + cluster_position.value();
+    return true;
+}
+
 OwnPtr<SegmentInformation> MatroskaReader::parse_information()
 {
     auto segment_information = make<SegmentInformation>();
@@ -318,6 +467,98 @@ Optional<TrackEntry::AudioTrack> MatroskaReader::parse_audio_track_information()
     return audio_track;
 }
 
+bool MatroskaReader::parse_seek_head(Optional<u64>& cues_position)
+{
+    return parse_master_element("SeekHead", [&](u64 element_id) {
+        if (element_id != SEEK_ID)
+            return read_unknown_element();
+
+        Optional<u64> seek_id;
+        Optional<u64> seek_position;
+        auto success = parse_master_element("Seek", [&](u64 element_id) {
+            if (element_id == SEEK_ID_ID) {
+                seek_id = read_u64_element();
+                CHECK_HAS_VALUE(seek_id);
+            } else if (element_id == SEEK_POSITION_ID) {
+                seek_position = read_u64_element();
+                CHECK_HAS_VALUE(seek_position);
+            } else {
+                return read_unknown_element();
+            }
+
+            return true;
+        });
+        if (!success)
+            return false;
+
+        if (seek_id == CUES_ID && seek_position.has_value()) {
+            dbgln_if(MATROSKA_DEBUG, "Cues are at offset {} into the segment", seek_position.value());
+            cues_position = seek_position;
+        }
+        return true;
+    });
+}
+
+bool MatroskaReader::parse_cues(MatroskaDocument& matroska_document)
+{
+    return parse_master_element("Cues", [&](u64 element_id) {
+        if (element_id == CUE_POINT_ID) {
+            auto cue_point = parse_cue_point();
+            CHECK_HAS_VALUE(cue_point);
+            matroska_document.cue_points().append(cue_point.value());
+        } else {
+            return read_unknown_element();
+        }
+
+        return true;
+    });
+}
+
+Optional<CuePoint> MatroskaReader::parse_cue_point()
+{
+    CuePoint cue_point;
+
+    auto success = parse_master_element("CuePoint", [&](u64 element_id) {
+        if (element_id == CUE_TIME_ID) {
+            auto timestamp = read_u64_element();
+            CHECK_HAS_VALUE(timestamp);
+            cue_point.timestamp = timestamp.value();
+            dbgln_if(MATROSKA_TRACE_DEBUG, "Read CuePoint's CueTime attribute: {}", timestamp.value());
+        } else if (element_id == CUE_TRACK_POSITIONS_ID) {
+            return parse_cue_track_positions(cue_point);
+        } else {
+            return read_unknown_element();
+        }
+
+        return true;
+    });
+
+    if (!success)
+        return {};
+    return cue_point;
+}
+
+bool MatroskaReader::parse_cue_track_positions(CuePoint& cue_point)
+{
+    return parse_master_element("CueTrackPositions", [&](u64 element_id) {
+        if (element_id == CUE_TRACK_ID) {
+            auto track_number = read_u64_element();
+            CHECK_HAS_VALUE(track_number);
+            cue_point.track_number = track_number.value();
+            dbgln_if(MATROSKA_TRACE_DEBUG, "Read CueTrackPositions' CueTrack attribute: {}", track_number.value());
+        } else if (element_id == CUE_CLUSTER_POSITION_ID) {
+            auto cluster_position = read_u64_element();
+            CHECK_HAS_VALUE(cluster_position);
+            cue_point.cluster_position = cluster_position.value();
+            dbgln_if(MATROSKA_TRACE_DEBUG, "Read CueTrackPositions' CueClusterPosition attribute: {}", cluster_position.value());
+        } else {
+            return read_unknown_element();
+        }
+
+        return true;
+    });
+}
+
 OwnPtr<Cluster> MatroskaReader::parse_cluster()
 {
     auto cluster = make<Cluster>();
@@ -404,18 +645,24 @@ OwnPtr<Block> MatroskaReader::parse_simple_block()
 
         for (int i = 0; i < frame_count; i++) {
             auto current_frame_size = frame_sizes.at(i);
-            block->add_frame(ByteBuffer::copy(m_streamer.data(), current_frame_size));
+            if (m_streamer.remaining() < current_frame_size)
+                return {};
+            block->add_frame({ m_streamer.data(), current_frame_size });
             m_streamer.drop_octets(current_frame_size);
         }
     } else if (block->lacing() == Block::Lacing::FixedSize) {
         auto frame_count = m_streamer.read_octet() + 1;
         auto individual_frame_size = total_frame_content_size / frame_count;
+        if (m_streamer.remaining() < individual_frame_size * frame_count)
+            return {};
         for (int i = 0; i < frame_count; i++) {
-            block->add_frame(ByteBuffer::copy(m_streamer.data(), individual_frame_size));
+            block->add_frame({ m_streamer.data(), individual_frame_size });
             m_streamer.drop_octets(individual_frame_size);
         }
     } else {
-        block->add_frame(ByteBuffer::copy(m_streamer.data(), total_frame_content_size));
+        if (m_streamer.remaining() < total_frame_content_size)
+            return {};
+        block->add_frame({ m_streamer.data(), total_frame_content_size });
         m_streamer.drop_octets(total_frame_content_size);
     }
     return block;
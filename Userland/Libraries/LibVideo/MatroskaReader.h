@@ -25,13 +25,30 @@ public:
     static OwnPtr<MatroskaDocument> parse_matroska_from_file(const StringView& path);
     static OwnPtr<MatroskaDocument> parse_matroska_from_data(const u8*, size_t);
 
+    // Only parses the headers, tracks and cues up front, so that clusters can be read one at a time with
+    // read_next_cluster(). The file stays mapped rather than read, which keeps even huge files cheap to open.
+    static OwnPtr<MatroskaReader> stream_matroska_from_file(const StringView& path);
+    static OwnPtr<MatroskaReader> stream_matroska_from_data(const u8*, size_t);
+
     OwnPtr<MatroskaDocument> parse();
 
+    // The document that streaming fills in. It has everything but the clusters.
+    const MatroskaDocument& document() const { return *m_document; }
+
+    // Returns null once there are no clusters left, or if the next one can't be parsed.
+    OwnPtr<Cluster> read_next_cluster();
+
+    // Makes read_next_cluster() continue from the last cue point at or before the timestamp. Returns false if there's
+    // nothing to go by, in which case the reader stays where it is.
+    bool seek_to_timestamp(u64 timestamp);
+
 private:
     class Streamer {
     public:
         Streamer(const u8* data, size_t size)
-            : m_data_ptr(data)
+            : m_data_start(data)
+            , m_data_ptr(data)
+            , m_size(size)
             , m_size_remaining(size)
         {
         }
@@ -140,18 +157,40 @@ private:
         size_t remaining() const { return m_size_remaining; }
         void set_remaining(size_t remaining) { m_size_remaining = remaining; }
 
+        size_t position() const { return m_data_ptr - m_data_start; }
+
+        bool seek(size_t position)
+        {
+            if (position > m_size)
+                return false;
+            m_data_ptr = m_data_start + position;
+            m_size_remaining = m_size - position;
+            m_octets_read.clear();
+            m_octets_read.append(0);
+            return true;
+        }
+
     private:
+        const u8* m_data_start { nullptr };
         const u8* m_data_ptr { nullptr };
+        size_t m_size { 0 };
         size_t m_size_remaining { 0 };
         Vector<size_t> m_octets_read { 0 };
     };
 
     bool parse_master_element(const StringView& element_name, Function<bool(u64 element_id)> element_consumer);
+    OwnPtr<MatroskaDocument> parse_up_to_segment();
     Optional<EBMLHeader> parse_ebml_header();
 
     bool parse_segment_elements(MatroskaDocument&);
+    bool parse_segment_headers();
     OwnPtr<SegmentInformation> parse_information();
 
+    bool parse_seek_head(Optional<u64>& cues_position);
+    bool parse_cues(MatroskaDocument&);
+    Optional<CuePoint> parse_cue_point();
+    bool parse_cue_track_positions(CuePoint&);
+
     bool parse_tracks(MatroskaDocument&);
     OwnPtr<TrackEntry> parse_track_entry();
     Optional<TrackEntry::VideoTrack> parse_video_track_information();
@@ -164,6 +203,13 @@ private:
     bool read_unknown_element();
 
     Streamer m_streamer;
+
+    // Only used when streaming.
+    RefPtr<MappedFile> m_mapped_file;
+    OwnPtr<MatroskaDocument> m_document;
+    size_t m_segment_data_position { 0 };
+    size_t m_segment_end { 0 };
+    size_t m_next_cluster_position { 0 };
 };
 
 }
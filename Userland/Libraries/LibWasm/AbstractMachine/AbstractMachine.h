@@ -277,6 +277,35 @@ private:
     Vector<ExportInstance> m_exports;
 };
 
+class Store;
+
+// Where a branch goes, worked out before the function first runs.
+struct ResolvedBranch {
+    InstructionPointer target { 0 };
+    // The values that the branch carries along from the top of the stack...
+    size_t arity { 0 };
+    // ...and how many of the frame's values below them are kept (i.e. the height of the stack when the block was entered).
+    size_t stack_height { 0 };
+};
+
+// A function body that has been checked for a consistent stack layout, with all the structured control flow in it
+// resolved to plain jumps. Blocks don't need labels on the stack at runtime, and a branch is a single jump that
+// moves its results down to a height that is already known.
+class CompiledFunction {
+public:
+    static OwnPtr<CompiledFunction> compile(Store&, ModuleInstance const&, FunctionType const&, Expression const&);
+
+    // The branches taken by the instruction at `ip`: one for br, br_if, if, else and return, and one per label
+    // (followed by the default) for br_table.
+    ResolvedBranch const& branch(InstructionPointer ip, size_t index = 0) const { return m_branches[m_first_branch[ip.value()] + index]; }
+
+private:
+    CompiledFunction() = default;
+
+    Vector<u32> m_first_branch;
+    Vector<ResolvedBranch> m_branches;
+};
+
 class WasmFunction {
 public:
     explicit WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code)
@@ -290,10 +319,15 @@ public:
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
 
+    // Compiled the first time the function is called. Returns null if the body isn't valid.
+    CompiledFunction const* compiled(Store&);
+
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    OwnPtr<CompiledFunction> m_compiled;
+    bool m_did_try_to_compile { false };
 };
 
 class HostFunction {
@@ -336,6 +370,9 @@ public:
     explicit MemoryInstance(MemoryType const& type)
         : m_type(type)
     {
+        // Allocate room for the memory to grow into right away, so it doesn't have to be moved around (and copied) later.
+        if (m_type.limits().max().has_value())
+            m_data.ensure_capacity(min(max_size(), static_cast<u64>(Constants::max_reserved_memory_size)));
         grow(m_type.limits().min() * Constants::page_size);
     }
 
@@ -348,10 +385,14 @@ public:
     {
         if (size_to_grow == 0)
             return true;
-        auto new_size = m_data.size() + size_to_grow;
-        if (m_type.limits().max().value_or(new_size) < new_size)
+        if (size_to_grow > max_size() - m_size)
             return false;
+        auto new_size = m_size + size_to_grow;
         auto previous_size = m_size;
+        if (new_size > m_data.capacity()) {
+            // Grow geometrically, so that modules growing their memory a page at a time don't have to copy all of it every time.
+            m_data.ensure_capacity(min(max_size(), static_cast<u64>(max(new_size, m_data.capacity() * 2))));
+        }
         m_data.resize(new_size);
         m_size = new_size;
         // The spec requires that we zero out everything on grow
@@ -360,6 +401,11 @@ public:
     }
 
 private:
+    u64 max_size() const
+    {
+        return static_cast<u64>(m_type.limits().max().value_or(Constants::max_page_count)) * Constants::page_size;
+    }
+
     MemoryType const& m_type;
     size_t m_size { 0 };
     ByteBuffer m_data;
@@ -427,29 +473,14 @@ private:
     Vector<ElementInstance> m_elements;
 };
 
-class Label {
-public:
-    explicit Label(size_t arity, InstructionPointer continuation)
-        : m_arity(arity)
-        , m_continuation(continuation)
-    {
-    }
-
-    auto continuation() const { return m_continuation; }
-    auto arity() const { return m_arity; }
-
-private:
-    size_t m_arity { 0 };
-    InstructionPointer m_continuation { 0 };
-};
-
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, CompiledFunction const* compiled = nullptr)
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_compiled(compiled)
     {
     }
 
@@ -459,20 +490,26 @@ public:
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
 
+    // NOTE: Constant expressions (global initializers and the like) are run without being compiled,
+    //       as they can't contain any control flow.
+    auto* compiled() const { return m_compiled; }
+
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    CompiledFunction const* m_compiled { nullptr };
 };
 
+// NOTE: This only holds the operands, the frames live on a stack of their own (see Configuration),
+//       and there's no need for labels since all branches are resolved when a function is compiled.
 class Stack {
 public:
-    using EntryType = Variant<Value, Label, Frame>;
     Stack() = default;
 
     [[nodiscard]] ALWAYS_INLINE bool is_empty() const { return m_data.is_empty(); }
-    ALWAYS_INLINE void push(EntryType entry) { m_data.append(move(entry)); }
+    ALWAYS_INLINE void push(Value value) { m_data.append(move(value)); }
     ALWAYS_INLINE auto pop() { return m_data.take_last(); }
     ALWAYS_INLINE auto& peek() const { return m_data.last(); }
     ALWAYS_INLINE auto& peek() { return m_data.last(); }
@@ -482,7 +519,7 @@ public:
     ALWAYS_INLINE auto& entries() { return m_data; }
 
 private:
-    Vector<EntryType, 1024> m_data;
+    Vector<Value, 1024> m_data;
 };
 
 using InstantiationResult = AK::Result<NonnullOwnPtr<ModuleInstance>, InstantiationError>;
@@ -12,6 +12,7 @@
 #include <LibWasm/Printer/Printer.h>
 #include <limits.h>
 #include <math.h>
+#include <time.h>
 
 namespace Wasm {
 
@@ -48,28 +49,42 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
     }
 }
 
-void BytecodeInterpreter::branch_to_label(Configuration& configuration, LabelIndex index)
+ResolvedBranch const* BytecodeInterpreter::branch_for(Configuration& configuration, InstructionPointer ip, size_t index)
 {
-    dbgln_if(WASM_TRACE_DEBUG, "Branch to label with index {}...", index.value());
-    auto label = configuration.nth_label(index.value());
-    TRAP_IF_NOT(label.has_value());
-    dbgln_if(WASM_TRACE_DEBUG, "...which is actually IP {}, and has {} result(s)", label->continuation().value(), label->arity());
-    auto results = pop_values(configuration, label->arity());
-
-    size_t drop_count = index.value() + 1;
-    for (; !configuration.stack().is_empty();) {
-        auto& entry = configuration.stack().peek();
-        if (entry.has<Label>()) {
-            if (--drop_count == 0)
-                break;
-        }
-        configuration.stack().pop();
+    auto* compiled = configuration.frame().compiled();
+    if (!compiled) {
+        // Only compiled functions can contain control flow.
+        m_do_trap = true;
+        return nullptr;
     }
+    return &compiled->branch(ip, index);
+}
 
-    for (auto& result : results)
-        configuration.stack().push(move(result));
+void BytecodeInterpreter::jump(Configuration& configuration, ResolvedBranch const* branch)
+{
+    if (!branch)
+        return;
+    dbgln_if(WASM_TRACE_DEBUG, "Jump to IP {}", branch->target.value());
+    configuration.ip() = branch->target;
+}
 
-    configuration.ip() = label->continuation();
+void BytecodeInterpreter::branch(Configuration& configuration, ResolvedBranch const* branch)
+{
+    if (!branch)
+        return;
+    dbgln_if(WASM_TRACE_DEBUG, "Branch to IP {}, keeping {} result(s) at height {}", branch->target.value(), branch->arity, branch->stack_height);
+
+    // Move the results down to where the target block started, and drop everything in between.
+    auto& entries = configuration.stack().entries();
+    auto base = configuration.frame_base() + branch->stack_height;
+    auto results_start = entries.size() - branch->arity;
+    if (results_start != base) {
+        for (size_t i = 0; i < branch->arity; ++i)
+            entries[base + i] = move(entries[results_start + i]);
+        entries.shrink(base + branch->arity, true);
+    }
+
+    jump(configuration, branch);
 }
 
 template<typename ReadType, typename PushType>
@@ -82,7 +97,7 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
         return;
     }
     auto& arg = instruction.arguments().get<Instruction::MemoryArgument>();
-    auto base = configuration.stack().peek().get<Value>().to<i32>();
+    auto base = configuration.stack().peek().to<i32>();
     if (!base.has_value()) {
         m_do_trap = true;
         return;
@@ -104,7 +119,7 @@ void BytecodeInterpreter::store_to_memory(Configuration& configuration, Instruct
     auto memory = configuration.store().get(address);
     TRAP_IF_NOT(memory);
     auto& arg = instruction.arguments().get<Instruction::MemoryArgument>();
-    auto base = configuration.stack().pop().get<Value>().to<i32>();
+    auto base = configuration.stack().pop().to<i32>();
     TRAP_IF_NOT(base.has_value());
     auto instance_address = base.value() + static_cast<i64>(arg.offset);
     if (instance_address < 0 || static_cast<u64>(instance_address + data.size()) > memory->size()) {
@@ -123,17 +138,14 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
     FunctionType const* type { nullptr };
     instance->visit([&](auto const& function) { type = &function.type(); });
     TRAP_IF_NOT(type);
-    TRAP_IF_NOT(configuration.stack().entries().size() > type->parameters().size());
+    TRAP_IF_NOT(configuration.stack().size() >= configuration.frame_base() + type->parameters().size());
     Vector<Value> args;
     args.ensure_capacity(type->parameters().size());
     auto span = configuration.stack().entries().span().slice_from_end(type->parameters().size());
-    for (auto& entry : span) {
-        auto* ptr = entry.get_pointer<Value>();
-        TRAP_IF_NOT(ptr != nullptr);
-        args.unchecked_append(*ptr);
-    }
+    for (auto& entry : span)
+        args.unchecked_append(move(entry));
 
-    configuration.stack().entries().remove(configuration.stack().size() - span.size(), span.size());
+    configuration.stack().entries().shrink(configuration.stack().size() - span.size(), true);
 
     Result result { Trap {} };
     {
@@ -153,8 +165,8 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
 #define BINARY_NUMERIC_OPERATION(type, operator, cast, ...)                                       \
     do {                                                                                          \
-        auto rhs = configuration.stack().pop().get<Value>().to<type>();                           \
-        auto lhs = configuration.stack().peek().get<Value>().to<type>();                          \
+        auto rhs = configuration.stack().pop().to<type>();                           \
+        auto lhs = configuration.stack().peek().to<type>();                          \
         TRAP_IF_NOT(lhs.has_value());                                                             \
         TRAP_IF_NOT(rhs.has_value());                                                             \
         __VA_ARGS__;                                                                              \
@@ -166,8 +178,8 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
 #define OVF_CHECKED_BINARY_NUMERIC_OPERATION(type, operator, cast, ...)                            \
     do {                                                                                           \
-        auto rhs = configuration.stack().pop().get<Value>().to<type>();                            \
-        auto ulhs = configuration.stack().peek().get<Value>().to<type>();                          \
+        auto rhs = configuration.stack().pop().to<type>();                            \
+        auto ulhs = configuration.stack().peek().to<type>();                          \
         TRAP_IF_NOT(ulhs.has_value());                                                             \
         TRAP_IF_NOT(rhs.has_value());                                                              \
         dbgln_if(WASM_TRACE_DEBUG, "{} {} {} = ??", ulhs.value(), #operator, rhs.value());         \
@@ -183,8 +195,8 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
 #define BINARY_PREFIX_NUMERIC_OPERATION(type, operation, cast, ...)                                 \
     do {                                                                                            \
-        auto rhs = configuration.stack().pop().get<Value>().to<type>();                             \
-        auto lhs = configuration.stack().peek().get<Value>().to<type>();                            \
+        auto rhs = configuration.stack().pop().to<type>();                             \
+        auto lhs = configuration.stack().peek().to<type>();                            \
         TRAP_IF_NOT(lhs.has_value());                                                               \
         TRAP_IF_NOT(rhs.has_value());                                                               \
         auto result = operation(lhs.value(), rhs.value());                                          \
@@ -195,7 +207,7 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
 #define UNARY_MAP(pop_type, operation, ...)                                               \
     do {                                                                                  \
-        auto value = configuration.stack().peek().get<Value>().to<pop_type>();            \
+        auto value = configuration.stack().peek().to<pop_type>();            \
         TRAP_IF_NOT(value.has_value());                                                   \
         auto result = operation(value.value());                                           \
         dbgln_if(WASM_TRACE_DEBUG, "map({}) {} = {}", #operation, value.value(), result); \
@@ -213,7 +225,7 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
 #define POP_AND_STORE(pop_type, store_type)                                                                 \
     do {                                                                                                    \
-        auto value = ConvertToRaw<store_type> {}(*configuration.stack().pop().get<Value>().to<pop_type>()); \
+        auto value = ConvertToRaw<store_type> {}(*configuration.stack().pop().to<pop_type>()); \
         dbgln_if(WASM_TRACE_DEBUG, "stack({}) -> temporary({}b)", value, sizeof(store_type));               \
         store_to_memory(configuration, instruction, { &value, sizeof(store_type) });                        \
         return;                                                                                             \
@@ -333,21 +345,6 @@ MakeUnsigned<T> BytecodeInterpreter::checked_unsigned_truncate(V value)
     return true;
 }
 
-Vector<Value> BytecodeInterpreter::pop_values(Configuration& configuration, size_t count)
-{
-    Vector<Value> results;
-    results.resize(count);
-
-    for (size_t i = 0; i < count; ++i) {
-        auto top_of_stack = configuration.stack().pop();
-        if (auto value = top_of_stack.get_pointer<Value>())
-            results[i] = move(*value);
-        else
-            TRAP_IF_NOT_NORETURN(value);
-    }
-    return results;
-}
-
 template<typename T, typename R>
 ALWAYS_INLINE static T rotl(T value, R shift)
 {
@@ -472,7 +469,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return;
     case Instructions::local_set.value(): {
         auto entry = configuration.stack().pop();
-        configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()] = move(entry.get<Value>());
+        configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()] = move(entry);
         return;
     }
     case Instructions::i32_const.value():
@@ -487,99 +484,35 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_const.value():
         configuration.stack().push(Value(ValueType { ValueType::F64 }, instruction.arguments().get<double>()));
         return;
-    case Instructions::block.value(): {
-        size_t arity = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        if (args.block_type.kind() != BlockType::Empty)
-            arity = 1;
-        configuration.stack().push(Label(arity, args.end_ip));
-        return;
-    }
-    case Instructions::loop.value(): {
-        size_t arity = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        if (args.block_type.kind() != BlockType::Empty)
-            arity = 1;
-        configuration.stack().push(Label(arity, ip.value() + 1));
+    case Instructions::block.value():
+    case Instructions::loop.value():
+    case Instructions::structured_end.value():
+        // All the structured control flow has been resolved to jumps ahead of time, so there's nothing to do here.
         return;
-    }
     case Instructions::if_.value(): {
-        size_t arity = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        if (args.block_type.kind() != BlockType::Empty)
-            arity = 1;
-
-        auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>().to<i32>();
+        auto value = configuration.stack().pop().to<i32>();
         TRAP_IF_NOT(value.has_value());
-        auto end_label = Label(arity, args.end_ip.value());
-        if (value.value() == 0) {
-            if (args.else_ip.has_value()) {
-                configuration.ip() = args.else_ip.value();
-                configuration.stack().push(move(end_label));
-            } else {
-                configuration.ip() = args.end_ip.value() + 1;
-            }
-        } else {
-            configuration.stack().push(move(end_label));
-        }
-        return;
-    }
-    case Instructions::structured_end.value():
-    case Instructions::structured_else.value(): {
-        auto label = configuration.nth_label(0);
-        TRAP_IF_NOT(label.has_value());
-        size_t end = configuration.stack().size() - label->arity() - 1;
-        size_t start = end;
-        while (start > 0 && start < configuration.stack().size() && !configuration.stack().entries()[start].has<Label>())
-            --start;
-
-        configuration.stack().entries().remove(start, end - start + 1);
-
-        if (instruction.opcode() == Instructions::structured_end)
-            return;
-
-        // Jump to the end label
-        configuration.ip() = label->continuation();
-        return;
-    }
-    case Instructions::return_.value(): {
-        auto& frame = configuration.frame();
-        size_t end = configuration.stack().size() - frame.arity();
-        size_t start = end;
-        for (; start + 1 > 0 && start < configuration.stack().size(); --start) {
-            auto& entry = configuration.stack().entries()[start];
-            if (entry.has<Frame>()) {
-                // Leave the frame, _and_ its label.
-                start += 2;
-                break;
-            }
-        }
-
-        configuration.stack().entries().remove(start, end - start);
-
-        // Jump past the call/indirect instruction
-        configuration.ip() = configuration.frame().expression().instructions().size();
+        if (value.value() == 0)
+            return jump(configuration, branch_for(configuration, ip));
         return;
     }
+    case Instructions::structured_else.value():
+        return jump(configuration, branch_for(configuration, ip));
+    case Instructions::return_.value():
     case Instructions::br.value():
-        return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
+        return branch(configuration, branch_for(configuration, ip));
     case Instructions::br_if.value(): {
-        if (configuration.stack().pop().get<Value>().to<i32>().value_or(0) == 0)
+        if (configuration.stack().pop().to<i32>().value_or(0) == 0)
             return;
-        return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
+        return branch(configuration, branch_for(configuration, ip));
     }
     case Instructions::br_table.value(): {
         auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
-        auto entry = configuration.stack().pop();
-        TRAP_IF_NOT(entry.has<Value>());
-        auto maybe_i = entry.get<Value>().to<i32>();
+        auto maybe_i = configuration.stack().pop().to<i32>();
         TRAP_IF_NOT(maybe_i.has_value());
         TRAP_IF_NOT(maybe_i.value() >= 0);
         size_t i = *maybe_i;
-        if (i < arguments.labels.size())
-            return branch_to_label(configuration, arguments.labels[i]);
-        return branch_to_label(configuration, arguments.default_);
+        return branch(configuration, branch_for(configuration, ip, min(i, arguments.labels.size())));
     }
     case Instructions::call.value(): {
         auto index = instruction.arguments().get<FunctionIndex>();
@@ -594,7 +527,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         TRAP_IF_NOT(args.table.value() < configuration.frame().module().tables().size());
         auto table_address = configuration.frame().module().tables()[args.table.value()];
         auto table_instance = configuration.store().get(table_address);
-        auto index = configuration.stack().pop().get<Value>().to<i32>();
+        auto index = configuration.stack().pop().to<i32>();
         TRAP_IF_NOT(index.has_value());
         TRAP_IF_NOT(index.value() >= 0);
         TRAP_IF_NOT(static_cast<size_t>(index.value()) < table_instance->elements().size());
@@ -653,7 +586,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::i64_store32.value():
         POP_AND_STORE(i64, i32);
     case Instructions::local_tee.value(): {
-        auto value = configuration.stack().peek().get<Value>();
+        auto value = configuration.stack().peek();
         auto local_index = instruction.arguments().get<LocalIndex>();
         TRAP_IF_NOT(configuration.frame().locals().size() > local_index.value());
         dbgln_if(WASM_TRACE_DEBUG, "stack:peek -> locals({})", local_index.value());
@@ -673,7 +606,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto global_index = instruction.arguments().get<GlobalIndex>();
         TRAP_IF_NOT(configuration.frame().module().globals().size() > global_index.value());
         auto address = configuration.frame().module().globals()[global_index.value()];
-        auto value = configuration.stack().pop().get<Value>();
+        auto value = configuration.stack().pop();
         dbgln_if(WASM_TRACE_DEBUG, "stack -> global({})", address.value());
         auto global = configuration.store().get(address);
         global->set_value(move(value));
@@ -693,10 +626,10 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto address = configuration.frame().module().memories()[0];
         auto instance = configuration.store().get(address);
         i32 old_pages = instance->size() / Constants::page_size;
-        auto new_pages = configuration.stack().peek().get<Value>().to<i32>();
+        auto new_pages = configuration.stack().peek().to<i32>();
         TRAP_IF_NOT(new_pages.has_value());
         dbgln_if(WASM_TRACE_DEBUG, "memory.grow({}), previously {} pages...", *new_pages, old_pages);
-        if (instance->grow(new_pages.value() * Constants::page_size))
+        if (static_cast<u32>(*new_pages) <= Constants::max_page_count && instance->grow(static_cast<u32>(*new_pages) * Constants::page_size))
             configuration.stack().peek() = Value((i32)old_pages);
         else
             configuration.stack().peek() = Value((i32)-1);
@@ -720,10 +653,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return;
     }
     case Instructions::ref_is_null.value(): {
-        auto top = configuration.stack().peek().get_pointer<Value>();
-        TRAP_IF_NOT(top);
-        TRAP_IF_NOT(top->type().is_reference());
-        auto is_null = top->to<Reference::Null>().has_value();
+        auto& top = configuration.stack().peek();
+        TRAP_IF_NOT(top.type().is_reference());
+        auto is_null = top.to<Reference::Null>().has_value();
         configuration.stack().peek() = Value(ValueType(ValueType::I32), static_cast<u64>(is_null ? 1 : 0));
         return;
     }
@@ -733,12 +665,12 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::select.value():
     case Instructions::select_typed.value(): {
         // Note: The type seems to only be used for validation.
-        auto value = configuration.stack().pop().get<Value>().to<i32>();
+        auto value = configuration.stack().pop().to<i32>();
         TRAP_IF_NOT(value.has_value());
         dbgln_if(WASM_TRACE_DEBUG, "select({})", value.value());
-        auto rhs = move(configuration.stack().pop().get<Value>());
-        auto lhs = move(configuration.stack().peek().get<Value>());
-        configuration.stack().peek() = value.value() != 0 ? move(lhs) : move(rhs);
+        auto rhs = configuration.stack().pop();
+        if (value.value() == 0)
+            configuration.stack().peek() = move(rhs);
         return;
     }
     case Instructions::i32_eqz.value():
@@ -1070,4 +1002,53 @@ void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, Instru
     BytecodeInterpreter::interpret(configuration, ip, instruction);
 }
 
+void ProfilingBytecodeInterpreter::interpret(Configuration& configuration)
+{
+    if (!profile_functions)
+        return BytecodeInterpreter::interpret(configuration);
+
+    m_function_stack.append(&configuration.frame().expression());
+    switch_to_function(m_function_stack.last());
+    ++m_current_function->call_count;
+
+    BytecodeInterpreter::interpret(configuration);
+
+    m_function_stack.take_last();
+    switch_to_function(m_function_stack.is_empty() ? nullptr : m_function_stack.last());
+}
+
+void ProfilingBytecodeInterpreter::switch_to_function(Expression const* function)
+{
+    timespec now_spec;
+    clock_gettime(CLOCK_MONOTONIC, &now_spec);
+    auto now = Time::from_timespec(now_spec);
+
+    // The time since the last call or return all went to whichever function was running in between.
+    if (m_current_function)
+        m_current_function->self_time += now - m_current_function_entered;
+
+    // NOTE: The profiles only get added to while (re-)entering a function, so the pointer stays good until the next switch.
+    m_current_function = function ? &m_function_profiles.ensure(function) : nullptr;
+    m_current_function_entered = now;
+}
+
+void ProfilingBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
+{
+    ++m_executed_instructions;
+    if (count_opcodes)
+        ++m_opcode_counts.ensure(instruction.opcode().value());
+    if (m_current_function)
+        ++m_current_function->executed_instructions;
+
+    BytecodeInterpreter::interpret(configuration, ip, instruction);
+}
+
+void ProfilingBytecodeInterpreter::reset()
+{
+    VERIFY(m_function_stack.is_empty());
+    m_executed_instructions = 0;
+    m_opcode_counts.clear();
+    m_function_profiles.clear();
+}
+
 }
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
+#include <AK/Time.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
 
@@ -32,7 +34,9 @@ struct BytecodeInterpreter : public Interpreter {
 
 protected:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
-    void branch_to_label(Configuration&, LabelIndex);
+    ResolvedBranch const* branch_for(Configuration&, InstructionPointer, size_t index = 0);
+    void jump(Configuration&, ResolvedBranch const*);
+    void branch(Configuration&, ResolvedBranch const*);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
     void store_to_memory(Configuration&, Instruction const&, ReadonlyBytes data);
@@ -47,7 +51,6 @@ protected:
     template<typename T>
     T read_value(ReadonlyBytes data);
 
-    Vector<Value> pop_values(Configuration& configuration, size_t count);
     bool trap_if_not(bool value)
     {
         if (!value)
@@ -67,4 +70,38 @@ private:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
 };
 
+struct ProfilingBytecodeInterpreter : public BytecodeInterpreter {
+    virtual ~ProfilingBytecodeInterpreter() override = default;
+    virtual void interpret(Configuration&) override;
+
+    struct FunctionProfile {
+        u64 call_count { 0 };
+        u64 executed_instructions { 0 };
+        // Time spent in the function itself, not counting the functions it called.
+        Time self_time;
+    };
+
+    bool count_opcodes { false };
+    bool profile_functions { false };
+
+    u64 executed_instructions() const { return m_executed_instructions; }
+    // Keyed by the opcode's value.
+    auto& opcode_counts() const { return m_opcode_counts; }
+    // NOTE: This is keyed by the function's body, as that's all a frame knows about the function it belongs to.
+    auto& function_profiles() const { return m_function_profiles; }
+
+    void reset();
+
+private:
+    virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
+    void switch_to_function(Expression const*);
+
+    u64 m_executed_instructions { 0 };
+    HashMap<u32, u64> m_opcode_counts;
+    HashMap<Expression const*, FunctionProfile> m_function_profiles;
+    Vector<Expression const*> m_function_stack;
+    FunctionProfile* m_current_function { nullptr };
+    Time m_current_function_entered;
+};
+
 }
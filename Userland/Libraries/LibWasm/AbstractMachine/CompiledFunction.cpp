@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+namespace {
+
+struct StackEffect {
+    size_t pops { 0 };
+    size_t pushes { 0 };
+};
+
+struct ControlFrame {
+    OpCode opcode;
+    InstructionPointer ip { 0 };
+    size_t base_height { 0 };
+    size_t parameter_count { 0 };
+    size_t result_count { 0 };
+    bool unreachable { false };
+    // Branches that go to the end of this block, and so can only be filled in once we get there.
+    Vector<size_t> forward_branches;
+    // The branch an `if` takes when its condition is false, which goes to the `else` if there is one.
+    Optional<size_t> false_branch;
+};
+
+class Compiler {
+public:
+    Compiler(Store& store, ModuleInstance const& module, FunctionType const& type, Expression const& expression)
+        : m_store(store)
+        , m_module(module)
+        , m_type(type)
+        , m_expression(expression)
+    {
+    }
+
+    bool compile(Vector<u32>& first_branch, Vector<ResolvedBranch>& branches);
+
+private:
+    bool pop(size_t count);
+    void push(size_t count) { m_height += count; }
+    void mark_remainder_unreachable()
+    {
+        m_control.last().unreachable = true;
+        m_height = m_control.last().base_height;
+    }
+
+    Optional<StackEffect> block_type_effect(BlockType const&) const;
+    Optional<StackEffect> function_type_effect(TypeIndex) const;
+    Optional<StackEffect> stack_effect(Instruction const&) const;
+
+    Optional<size_t> add_branch_to(LabelIndex);
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    FunctionType const& m_type;
+    Expression const& m_expression;
+
+    Vector<ControlFrame, 16> m_control;
+    Vector<ResolvedBranch>* m_branches { nullptr };
+    size_t m_height { 0 };
+};
+
+bool Compiler::pop(size_t count)
+{
+    auto& frame = m_control.last();
+    if (m_height >= frame.base_height + count) {
+        m_height -= count;
+        return true;
+    }
+    // The stack is polymorphic after an unconditional branch, so anything goes there.
+    if (frame.unreachable) {
+        m_height = frame.base_height;
+        return true;
+    }
+    return false;
+}
+
+Optional<StackEffect> Compiler::function_type_effect(TypeIndex index) const
+{
+    if (index.value() >= m_module.types().size())
+        return {};
+    auto& type = m_module.types()[index.value()];
+    return StackEffect { type.parameters().size(), type.results().size() };
+}
+
+Optional<StackEffect> Compiler::block_type_effect(BlockType const& type) const
+{
+    switch (type.kind()) {
+    case BlockType::Empty:
+        return StackEffect {};
+    case BlockType::Type:
+        return StackEffect { 0, 1 };
+    case BlockType::Index:
+        return function_type_effect(type.type_index());
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Optional<StackEffect> Compiler::stack_effect(Instruction const& instruction) const
+{
+    auto opcode = instruction.opcode().value();
+
+    switch (opcode) {
+    case Instructions::nop.value():
+        return StackEffect {};
+    case Instructions::drop.value():
+        return StackEffect { 1, 0 };
+    case Instructions::select.value():
+    case Instructions::select_typed.value():
+        return StackEffect { 3, 1 };
+    case Instructions::local_get.value():
+    case Instructions::global_get.value():
+    case Instructions::memory_size.value():
+    case Instructions::i32_const.value():
+    case Instructions::i64_const.value():
+    case Instructions::f32_const.value():
+    case Instructions::f64_const.value():
+    case Instructions::ref_null.value():
+    case Instructions::ref_func.value():
+        return StackEffect { 0, 1 };
+    case Instructions::local_set.value():
+    case Instructions::global_set.value():
+        return StackEffect { 1, 0 };
+    case Instructions::local_tee.value():
+    case Instructions::memory_grow.value():
+    case Instructions::ref_is_null.value():
+        return StackEffect { 1, 1 };
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>();
+        if (index.value() >= m_module.functions().size())
+            return {};
+        auto* function = m_store.get(m_module.functions()[index.value()]);
+        if (!function)
+            return {};
+        FunctionType const* type { nullptr };
+        function->visit([&](auto const& function) { type = &function.type(); });
+        return StackEffect { type->parameters().size(), type->results().size() };
+    }
+    case Instructions::call_indirect.value(): {
+        auto effect = function_type_effect(instruction.arguments().get<Instruction::IndirectCallArgs>().type);
+        if (!effect.has_value())
+            return {};
+        // The callee's index into the table comes on top of the arguments.
+        ++effect->pops;
+        return effect;
+    }
+    default:
+        break;
+    }
+
+    if (opcode >= Instructions::i32_load.value() && opcode <= Instructions::i64_load32_u.value())
+        return StackEffect { 1, 1 };
+    if (opcode >= Instructions::i32_store.value() && opcode <= Instructions::i64_store32.value())
+        return StackEffect { 2, 0 };
+
+    // The numeric instructions come in runs of unary and binary operations.
+    if (opcode == Instructions::i32_eqz.value() || opcode == Instructions::i64_eqz.value())
+        return StackEffect { 1, 1 };
+    if (opcode >= Instructions::i32_eq.value() && opcode <= Instructions::f64_ge.value())
+        return StackEffect { 2, 1 };
+    if ((opcode >= Instructions::i32_clz.value() && opcode <= Instructions::i32_popcnt.value())
+        || (opcode >= Instructions::i64_clz.value() && opcode <= Instructions::i64_popcnt.value())
+        || (opcode >= Instructions::f32_abs.value() && opcode <= Instructions::f32_sqrt.value())
+        || (opcode >= Instructions::f64_abs.value() && opcode <= Instructions::f64_sqrt.value())
+        || (opcode >= Instructions::i32_wrap_i64.value() && opcode <= Instructions::i64_extend32_s.value())
+        || (opcode >= Instructions::i32_trunc_sat_f32_s.value() && opcode <= Instructions::i64_trunc_sat_f64_u.value()))
+        return StackEffect { 1, 1 };
+    if ((opcode >= Instructions::i32_add.value() && opcode <= Instructions::i32_rotr.value())
+        || (opcode >= Instructions::i64_add.value() && opcode <= Instructions::i64_rotr.value())
+        || (opcode >= Instructions::f32_add.value() && opcode <= Instructions::f32_copysign.value())
+        || (opcode >= Instructions::f64_add.value() && opcode <= Instructions::f64_copysign.value()))
+        return StackEffect { 2, 1 };
+
+    return {};
+}
+
+Optional<size_t> Compiler::add_branch_to(LabelIndex label)
+{
+    if (label.value() >= m_control.size())
+        return {};
+
+    auto& target = m_control[m_control.size() - 1 - label.value()];
+    auto is_loop = target.opcode == Instructions::loop;
+    auto arity = is_loop ? target.parameter_count : target.result_count;
+    if (!m_control.last().unreachable && m_height < m_control.last().base_height + arity)
+        return {};
+
+    auto index = m_branches->size();
+    // NOTE: A branch to a loop goes back to the (now do-nothing) loop instruction rather than the one after it,
+    //       so that it's never a jump to the branch itself, which the interpreter would mistake for no jump at all.
+    m_branches->append({ target.ip, arity, target.base_height });
+    if (&target == &m_control.first())
+        m_branches->last().target = m_expression.instructions().size();
+    else if (!is_loop)
+        target.forward_branches.append(index);
+    return index;
+}
+
+bool Compiler::compile(Vector<u32>& first_branch, Vector<ResolvedBranch>& branches)
+{
+    m_branches = &branches;
+    auto& instructions = m_expression.instructions();
+    first_branch.resize(instructions.size());
+
+    // The function body itself acts like a block, branching to which returns from the function.
+    m_control.append({ Instructions::block, 0, 0, 0, m_type.results().size(), false, {}, {} });
+
+    auto fail = [&](size_t ip, StringView reason) {
+        dbgln_if(WASM_TRACE_DEBUG, "Compiling function failed at ip {} ({}): {}", ip, instruction_name(instructions[ip].opcode()), reason);
+        return false;
+    };
+
+    for (size_t ip = 0; ip < instructions.size(); ++ip) {
+        auto& instruction = instructions[ip];
+        first_branch[ip] = branches.size();
+
+        switch (instruction.opcode().value()) {
+        case Instructions::block.value():
+        case Instructions::loop.value():
+        case Instructions::if_.value(): {
+            auto effect = block_type_effect(instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+            if (!effect.has_value())
+                return fail(ip, "invalid block type");
+            if (instruction.opcode() == Instructions::if_ && !pop(1))
+                return fail(ip, "stack underflow");
+            if (!pop(effect->pops))
+                return fail(ip, "stack underflow");
+            ControlFrame frame { instruction.opcode(), ip, m_height, effect->pops, effect->pushes, m_control.last().unreachable, {}, {} };
+            push(effect->pops);
+            if (instruction.opcode() == Instructions::if_) {
+                frame.false_branch = branches.size();
+                branches.append({ 0, 0, m_height });
+            }
+            m_control.append(move(frame));
+            continue;
+        }
+        case Instructions::structured_else.value(): {
+            auto& frame = m_control.last();
+            if (frame.opcode != Instructions::if_ || !frame.false_branch.has_value())
+                return fail(ip, "else outside of if");
+            if (!frame.unreachable && m_height != frame.base_height + frame.result_count)
+                return fail(ip, "wrong number of results");
+            // Falling through into the else means the then-branch is done, so jump to the end.
+            frame.forward_branches.append(branches.size());
+            branches.append({ 0, frame.result_count, frame.base_height });
+            branches[frame.false_branch.release_value()].target = ip + 1;
+            m_height = frame.base_height + frame.parameter_count;
+            frame.unreachable = m_control.size() > 1 && m_control[m_control.size() - 2].unreachable;
+            continue;
+        }
+        case Instructions::structured_end.value(): {
+            if (m_control.size() == 1)
+                return fail(ip, "end without a block");
+            auto frame = m_control.take_last();
+            if (!frame.unreachable && m_height != frame.base_height + frame.result_count)
+                return fail(ip, "wrong number of results");
+            for (auto index : frame.forward_branches)
+                branches[index].target = ip + 1;
+            if (frame.false_branch.has_value())
+                branches[frame.false_branch.value()].target = ip + 1;
+            m_height = frame.base_height + frame.result_count;
+            continue;
+        }
+        case Instructions::br.value():
+            if (!add_branch_to(instruction.arguments().get<LabelIndex>()).has_value())
+                return fail(ip, "invalid branch");
+            mark_remainder_unreachable();
+            continue;
+        case Instructions::br_if.value():
+            if (!pop(1))
+                return fail(ip, "stack underflow");
+            if (!add_branch_to(instruction.arguments().get<LabelIndex>()).has_value())
+                return fail(ip, "invalid branch");
+            continue;
+        case Instructions::br_table.value(): {
+            if (!pop(1))
+                return fail(ip, "stack underflow");
+            auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
+            for (auto& label : arguments.labels) {
+                if (!add_branch_to(label).has_value())
+                    return fail(ip, "invalid branch");
+            }
+            if (!add_branch_to(arguments.default_).has_value())
+                return fail(ip, "invalid branch");
+            mark_remainder_unreachable();
+            continue;
+        }
+        case Instructions::return_.value():
+            if (!add_branch_to(LabelIndex(m_control.size() - 1)).has_value())
+                return fail(ip, "invalid return");
+            mark_remainder_unreachable();
+            continue;
+        case Instructions::unreachable.value():
+            mark_remainder_unreachable();
+            continue;
+        default:
+            break;
+        }
+
+        auto effect = stack_effect(instruction);
+        if (!effect.has_value()) {
+            // Whatever the interpreter doesn't know about traps, so nothing after it in this block runs.
+            mark_remainder_unreachable();
+            continue;
+        }
+        if (!pop(effect->pops))
+            return fail(ip, "stack underflow");
+        push(effect->pushes);
+    }
+
+    if (m_control.size() != 1)
+        return fail(instructions.size() - 1, "unterminated block");
+    if (!m_control.last().unreachable && m_height != m_type.results().size())
+        return false;
+    return true;
+}
+
+}
+
+OwnPtr<CompiledFunction> CompiledFunction::compile(Store& store, ModuleInstance const& module, FunctionType const& type, Expression const& expression)
+{
+    auto function = adopt_own(*new CompiledFunction);
+    Compiler compiler { store, module, type, expression };
+    if (!compiler.compile(function->m_first_branch, function->m_branches))
+        return {};
+    return function;
+}
+
+CompiledFunction const* WasmFunction::compiled(Store& store)
+{
+    if (!m_did_try_to_compile) {
+        m_did_try_to_compile = true;
+        m_compiled = CompiledFunction::compile(store, m_module, m_type, m_code.body());
+    }
+    return m_compiled.ptr();
+}
+
+}
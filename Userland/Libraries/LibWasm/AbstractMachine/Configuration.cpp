@@ -10,27 +10,16 @@
 
 namespace Wasm {
 
-Optional<Label> Configuration::nth_label(size_t i)
-{
-    for (size_t index = m_stack.size(); index > 0; --index) {
-        auto& entry = m_stack.entries()[index - 1];
-        if (auto ptr = entry.get_pointer<Label>()) {
-            if (i == 0)
-                return *ptr;
-            --i;
-        }
-    }
-    return {};
-}
-
 void Configuration::unwind(Badge<CallFrameHandle>, CallFrameHandle const& frame_handle)
 {
-    if (m_stack.size() == frame_handle.stack_size && frame_handle.frame_index == m_current_frame_index)
+    if (m_stack.size() == frame_handle.stack_size && m_frames.size() == frame_handle.frame_count)
         return;
 
-    VERIFY(m_stack.size() > frame_handle.stack_size);
-    m_stack.entries().remove(frame_handle.stack_size, m_stack.size() - frame_handle.stack_size);
-    m_current_frame_index = frame_handle.frame_index;
+    VERIFY(m_stack.size() >= frame_handle.stack_size);
+    VERIFY(m_frames.size() >= frame_handle.frame_count);
+    m_stack.entries().shrink(frame_handle.stack_size, true);
+    m_frames.shrink(frame_handle.frame_count, true);
+    m_frame_base = frame_handle.frame_base;
     m_depth--;
     m_ip = frame_handle.ip;
     VERIFY(m_stack.size() == frame_handle.stack_size);
@@ -42,6 +31,10 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
     if (!function)
         return Trap {};
     if (auto* wasm_function = function->get_pointer<WasmFunction>()) {
+        auto* compiled = wasm_function->compiled(m_store);
+        if (!compiled)
+            return Trap {};
+
         Vector<Value> locals;
         locals.ensure_capacity(arguments.size() + wasm_function->code().locals().size());
         for (auto& value : arguments)
@@ -54,6 +47,7 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
             move(locals),
             wasm_function->code().body(),
             wasm_function->type().results().size(),
+            compiled,
         });
         m_ip = 0;
         return execute(interpreter);
@@ -70,17 +64,13 @@ Result Configuration::execute(Interpreter& interpreter)
     if (interpreter.did_trap())
         return Trap {};
 
-    if (stack().size() <= frame().arity() + 1)
+    if (stack().size() < frame_base() + frame().arity())
         return Trap {};
 
     Vector<Value> results;
     results.ensure_capacity(frame().arity());
     for (size_t i = 0; i < frame().arity(); ++i)
-        results.append(move(stack().pop().get<Value>()));
-    auto label = stack().pop();
-    // ASSERT: label == current frame
-    if (!label.has<Label>())
-        return Trap {};
+        results.append(stack().pop());
     return Result { move(results) };
 }
 
@@ -92,21 +82,15 @@ void Configuration::dump_stack()
         Printer { memory_stream }.print(vs...);
         dbgln(format.view(), StringView(memory_stream.copy_into_contiguous_buffer()).trim_whitespace());
     };
-    for (auto const& entry : stack().entries()) {
-        entry.visit(
-            [&](Value const& v) {
-                print_value("    {}", v);
-            },
-            [&](Frame const& f) {
-                dbgln("    frame({})", f.arity());
-                for (auto& local : f.locals()) {
-                    print_value("        {}", local);
-                }
-            },
-            [](Label const& l) {
-                dbgln("    label({}) -> {}", l.arity(), l.continuation());
-            });
+    for (auto const& frame : m_frames) {
+        dbgln("    frame({})", frame.arity());
+        for (auto& local : frame.locals()) {
+            print_value("        {}", local);
+        }
     }
+    dbgln("    values:");
+    for (auto const& value : stack().entries())
+        print_value("        {}", value);
 }
 
 }
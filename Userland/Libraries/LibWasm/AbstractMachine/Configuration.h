@@ -17,16 +17,15 @@ public:
     {
     }
 
-    Optional<Label> nth_label(size_t);
     void set_frame(Frame&& frame)
     {
-        m_current_frame_index = m_stack.size();
-        Label label(frame.arity(), frame.expression().instructions().size());
-        m_stack.push(move(frame));
-        m_stack.push(label);
+        m_frame_base = m_stack.size();
+        m_frames.append(move(frame));
     }
-    ALWAYS_INLINE auto& frame() const { return m_stack.entries()[m_current_frame_index].get<Frame>(); }
-    ALWAYS_INLINE auto& frame() { return m_stack.entries()[m_current_frame_index].get<Frame>(); }
+    // The index of the first stack entry that belongs to the current frame's operands.
+    ALWAYS_INLINE size_t frame_base() const { return m_frame_base; }
+    ALWAYS_INLINE auto& frame() const { return m_frames.last(); }
+    ALWAYS_INLINE auto& frame() { return m_frames.last(); }
     ALWAYS_INLINE auto& ip() const { return m_ip; }
     ALWAYS_INLINE auto& ip() { return m_ip; }
     ALWAYS_INLINE auto& depth() const { return m_depth; }
@@ -38,7 +37,8 @@ public:
 
     struct CallFrameHandle {
         explicit CallFrameHandle(Configuration& configuration)
-            : frame_index(configuration.m_current_frame_index)
+            : frame_count(configuration.m_frames.size())
+            , frame_base(configuration.m_frame_base)
             , stack_size(configuration.m_stack.size())
             , ip(configuration.ip())
             , configuration(configuration)
@@ -51,7 +51,8 @@ public:
             configuration.unwind({}, *this);
         }
 
-        size_t frame_index { 0 };
+        size_t frame_count { 0 };
+        size_t frame_base { 0 };
         size_t stack_size { 0 };
         InstructionPointer ip { 0 };
         Configuration& configuration;
@@ -65,7 +66,8 @@ public:
 
 private:
     Store& m_store;
-    size_t m_current_frame_index { 0 };
+    Vector<Frame, 16> m_frames;
+    size_t m_frame_base { 0 };
     Stack m_stack;
     size_t m_depth { 0 };
     InstructionPointer m_ip;
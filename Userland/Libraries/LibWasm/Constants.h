@@ -35,5 +35,9 @@ static constexpr auto extern_memory_tag = 0x02;
 static constexpr auto extern_global_tag = 0x03;
 
 static constexpr auto page_size = 64 * KiB;
+// A 32-bit memory index can't address more than this.
+static constexpr auto max_page_count = 64 * KiB;
+// How much of a memory's stated maximum size we're willing to allocate before it's actually needed.
+static constexpr auto max_reserved_memory_size = 32 * MiB;
 
 }
@@ -5,8 +5,10 @@
  */
 
 #include <AK/LEB128.h>
+#include <AK/MemoryStream.h>
 #include <AK/ScopeGuard.h>
 #include <AK/ScopeLogger.h>
+#include <LibThreading/Parallel.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -1135,10 +1137,56 @@ ParseResult<CodeSection::Code> CodeSection::Code::parse(InputStream& stream)
 ParseResult<CodeSection> CodeSection::parse(InputStream& stream)
 {
     ScopeLogger<WASM_BINPARSER_DEBUG> logger("CodeSection");
-    auto result = parse_vector<Code>(stream);
-    if (result.is_error())
-        return result.error();
-    return CodeSection { result.release_value() };
+    size_t count;
+    if (!LEB128::read_unsigned(stream, count))
+        return with_eof_check(stream, ParseError::ExpectedSize);
+
+    // Function bodies don't depend on one another, so they're all read in first, and then parsed in parallel.
+    struct PendingCode {
+        ByteBuffer bytes;
+        Optional<ParseResult<Func>> func;
+    };
+    Vector<PendingCode> pending;
+    for (size_t i = 0; i < count; ++i) {
+        size_t size;
+        if (!LEB128::read_unsigned(stream, size))
+            return with_eof_check(stream, ParseError::InvalidSize);
+
+        // NOTE: The size comes straight from the module, so there's no allocating it all up front before we know the bytes actually exist.
+        ByteBuffer bytes;
+        while (bytes.size() < size) {
+            auto chunk_size = min(size - bytes.size(), 64 * KiB);
+            auto offset = bytes.size();
+            bytes.resize(offset + chunk_size);
+            if (!stream.read_or_error(bytes.bytes().slice(offset, chunk_size)))
+                return with_eof_check(stream, ParseError::UnexpectedEof);
+        }
+        pending.append({ move(bytes), {} });
+    }
+
+    auto parse_code = [](PendingCode& code) {
+        InputMemoryStream code_stream { code.bytes };
+        code.func = Func::parse(code_stream);
+        code_stream.handle_any_error();
+    };
+    // NOTE: Small modules aren't worth waking up (or even starting) the thread pool for.
+    static constexpr size_t minimum_functions_per_job = 16;
+    if (pending.size() > minimum_functions_per_job) {
+        Threading::parallel_for(pending.span(), parse_code, minimum_functions_per_job);
+    } else {
+        for (auto& code : pending)
+            parse_code(code);
+    }
+
+    Vector<Code> functions;
+    functions.ensure_capacity(pending.size());
+    for (auto& code : pending) {
+        // The first error in the module is the one that gets reported, no matter which thread ran into it first.
+        if (code.func->is_error())
+            return code.func->error();
+        functions.unchecked_append(Code { static_cast<u32>(code.bytes.size()), code.func->release_value() });
+    }
+    return CodeSection { move(functions) };
 }
 
 ParseResult<DataSection::Data> DataSection::Data::parse(InputStream& stream)
@@ -13,7 +13,7 @@
 
 namespace Web::CSS {
 
-class CSSRule : public RefCounted<CSSRule> {
+class CSSRule : public RefCounted<CSSRule, RefCountPolicy::NonAtomic> {
 public:
     virtual ~CSSRule();
 
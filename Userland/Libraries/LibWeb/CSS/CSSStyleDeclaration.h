@@ -21,7 +21,7 @@ struct StyleProperty {
 };
 
 class CSSStyleDeclaration
-    : public RefCounted<CSSStyleDeclaration>
+    : public RefCounted<CSSStyleDeclaration, RefCountPolicy::NonAtomic>
     , public Bindings::Wrappable {
 public:
     using WrapperType = Bindings::CSSStyleDeclarationWrapper;
@@ -47,13 +47,25 @@ ParsingContext::ParsingContext(const DOM::ParentNode& parent_node)
 {
 }
 
+ParsingContext ParsingContext::create_detached(const DOM::Document& document)
+{
+    ParsingContext context;
+    context.m_detached_document_url = document.url();
+    context.m_detached_in_quirks_mode = document.in_quirks_mode();
+    return context;
+}
+
 bool ParsingContext::in_quirks_mode() const
 {
+    if (m_detached_document_url.has_value())
+        return m_detached_in_quirks_mode;
     return m_document ? m_document->in_quirks_mode() : false;
 }
 
 URL ParsingContext::complete_url(const String& addr) const
 {
+    if (m_detached_document_url.has_value())
+        return m_detached_document_url->complete_url(addr);
     return m_document ? m_document->url().complete_url(addr) : URL::create_with_url_or_path(addr);
 }
 
@@ -7,7 +7,9 @@
 #pragma once
 
 #include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
 #include <AK/String.h>
+#include <AK/URL.h>
 #include <LibWeb/CSS/CSSStyleSheet.h>
 
 namespace Web::CSS {
@@ -17,12 +19,19 @@ public:
     explicit ParsingContext(const DOM::Document&);
     explicit ParsingContext(const DOM::ParentNode&);
 
+    // A context that copies what it needs from the document instead of referring to it,
+    // so that parsing can happen on another thread.
+    static ParsingContext create_detached(const DOM::Document&);
+
     bool in_quirks_mode() const;
 
     URL complete_url(const String&) const;
 
 private:
     const DOM::Document* m_document { nullptr };
+
+    Optional<URL> m_detached_document_url;
+    bool m_detached_in_quirks_mode { false };
 };
 }
 
@@ -11,45 +11,30 @@
 
 namespace Web::CSS {
 
-StyleInvalidator::StyleInvalidator(DOM::Document& document)
-    : m_document(document)
+StyleInvalidator::StyleInvalidator(DOM::Element& element, const FlyString& attribute_name)
+    : m_element(element)
+    , m_attribute_name(attribute_name)
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
-        return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        m_elements_and_matching_rules_before.set(&element, style_resolver.collect_matching_rules(element));
-        return IterationDecision::Continue;
-    });
 }
 
 StyleInvalidator::~StyleInvalidator()
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    auto& document = m_element.document();
+    if (!document.should_invalidate_styles_on_attribute_changes())
         return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        auto maybe_matching_rules_before = m_elements_and_matching_rules_before.get(&element);
-        if (!maybe_matching_rules_before.has_value()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
-        }
-        auto& matching_rules_before = maybe_matching_rules_before.value();
-        auto matching_rules_after = style_resolver.collect_matching_rules(element);
-        if (matching_rules_before.size() != matching_rules_after.size()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
-        }
-        style_resolver.sort_matching_rules(matching_rules_before);
-        style_resolver.sort_matching_rules(matching_rules_after);
-        for (size_t i = 0; i < matching_rules_before.size(); ++i) {
-            if (matching_rules_before[i].rule != matching_rules_after[i].rule) {
-                element.set_needs_style_update(true);
-                break;
-            }
-        }
-        return IterationDecision::Continue;
-    });
+
+    // NOTE: Presentational hints depend on attributes too, so the element itself is always restyled.
+    m_element.set_needs_style_update(true);
+
+    auto& rule_cache = document.style_resolver().rule_cache();
+    if (!rule_cache.has_not_pseudo_class && !rule_cache.attributes_in_other_compounds.contains(m_attribute_name))
+        return;
+
+    m_element.invalidate_style();
+    if (rule_cache.has_not_pseudo_class || rule_cache.has_sibling_combinators) {
+        for (auto* sibling = m_element.next_element_sibling(); sibling; sibling = sibling->next_element_sibling())
+            sibling->invalidate_style();
+    }
 }
 
 }
@@ -6,21 +6,20 @@
 
 #pragma once
 
-#include <AK/HashMap.h>
-#include <LibWeb/CSS/StyleResolver.h>
-#include <LibWeb/DOM/Document.h>
+#include <AK/FlyString.h>
 #include <LibWeb/DOM/Element.h>
 
 namespace Web::CSS {
 
+// Invalidates the style of the elements that a change of the given attribute can affect, once it's done.
 class StyleInvalidator {
 public:
-    explicit StyleInvalidator(DOM::Document&);
+    StyleInvalidator(DOM::Element&, const FlyString& attribute_name);
     ~StyleInvalidator();
 
 private:
-    DOM::Document& m_document;
-    HashMap<DOM::Element*, Vector<MatchingRule>> m_elements_and_matching_rules_before;
+    DOM::Element& m_element;
+    FlyString m_attribute_name;
 };
 
 }
@@ -16,7 +16,7 @@
 
 namespace Web::CSS {
 
-class StyleProperties : public RefCounted<StyleProperties> {
+class StyleProperties : public RefCounted<StyleProperties, RefCountPolicy::NonAtomic> {
 public:
     StyleProperties();
 
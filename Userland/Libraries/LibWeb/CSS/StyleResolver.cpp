@@ -6,6 +6,7 @@
  */
 
 #include <AK/QuickSort.h>
+#include <LibThreading/Parallel.h>
 #include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/Parser/DeprecatedCSSParser.h>
 #include <LibWeb/CSS/SelectorEngine.h>
@@ -14,11 +15,16 @@
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Dump.h>
+#include <LibWeb/HTML/AttributeNames.h>
 #include <ctype.h>
 #include <stdio.h>
 
 namespace Web::CSS {
 
+// Below this, handing the elements out to other threads costs more than it saves.
+static constexpr size_t minimum_element_count_for_prematching = 512;
+static constexpr size_t minimum_elements_per_job = 16;
+
 StyleResolver::StyleResolver(DOM::Document& document)
     : m_document(document)
 {
@@ -61,9 +67,176 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+static u32 ancestor_hash(Selector::SimpleSelector::Type type, u32 value_hash)
+{
+    return pair_int_hash((u32)type, value_hash);
+}
+
+// A Bloom filter of the ids, classes and tag names of an element's ancestors.
+// If a selector needs an ancestor with one the filter has never seen, it can't match the element.
+class AncestorFilter {
+public:
+    explicit AncestorFilter(const DOM::Element& element)
+    {
+        // NOTE: This walks the same ancestors as SelectorEngine does for descendant combinators.
+        for (auto* ancestor = element.parent(); ancestor; ancestor = ancestor->parent()) {
+            if (!is<DOM::Element>(*ancestor))
+                continue;
+            auto& ancestor_element = downcast<DOM::Element>(*ancestor);
+            add(ancestor_hash(Selector::SimpleSelector::Type::TagName, ancestor_element.local_name().hash()));
+            if (auto id = ancestor_element.attribute(HTML::AttributeNames::id); !id.is_null())
+                add(ancestor_hash(Selector::SimpleSelector::Type::Id, id.hash()));
+            for (auto& class_name : ancestor_element.class_names())
+                add(ancestor_hash(Selector::SimpleSelector::Type::Class, class_name.hash()));
+        }
+    }
+
+    bool may_match(const RuleToMatch& rule_to_match) const
+    {
+        for (auto hash : rule_to_match.ancestor_hashes) {
+            if (!may_contain(hash))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t bit_count = 2048;
+
+    void add(u32 hash)
+    {
+        set_bit(hash % bit_count);
+        set_bit((hash >> 16) % bit_count);
+    }
+
+    bool may_contain(u32 hash) const
+    {
+        return get_bit(hash % bit_count) && get_bit((hash >> 16) % bit_count);
+    }
+
+    void set_bit(size_t bit) { m_bits[bit / 64] |= 1ull << (bit % 64); }
+    bool get_bit(size_t bit) const { return m_bits[bit / 64] & (1ull << (bit % 64)); }
+
+    u64 m_bits[bit_count / 64] {};
+};
+
+static Vector<u32, 4> ancestor_hashes(const Selector& selector)
+{
+    Vector<u32, 4> hashes;
+    auto& complex_selectors = selector.complex_selectors();
+    // The compound selector before a descendant or child combinator has to match an ancestor. Sibling combinators
+    // don't change that for the ones further left, as siblings have the same ancestors.
+    for (size_t i = complex_selectors.size(); i-- > 1;) {
+        auto relation = complex_selectors[i].relation;
+        if (relation != Selector::ComplexSelector::Relation::Descendant && relation != Selector::ComplexSelector::Relation::ImmediateChild)
+            continue;
+        for (auto& simple_selector : complex_selectors[i - 1].compound_selector) {
+            auto type = simple_selector.type;
+            if (type != Selector::SimpleSelector::Type::Id && type != Selector::SimpleSelector::Type::Class && type != Selector::SimpleSelector::Type::TagName)
+                continue;
+            hashes.append(ancestor_hash(type, simple_selector.value.hash()));
+            // A few are enough to rule out most selectors.
+            if (hashes.size() == 4)
+                return hashes;
+        }
+    }
+    return hashes;
+}
+
+static void record_selector_features(RuleCache& rule_cache, const Selector& selector)
+{
+    auto& complex_selectors = selector.complex_selectors();
+    for (size_t i = 0; i < complex_selectors.size(); ++i) {
+        bool is_rightmost = i == complex_selectors.size() - 1;
+        auto& attributes = is_rightmost ? rule_cache.attributes_in_rightmost_compounds : rule_cache.attributes_in_other_compounds;
+
+        auto relation = complex_selectors[i].relation;
+        if (relation == Selector::ComplexSelector::Relation::AdjacentSibling || relation == Selector::ComplexSelector::Relation::GeneralSibling)
+            rule_cache.has_sibling_combinators = true;
+
+        for (auto& simple_selector : complex_selectors[i].compound_selector) {
+            if (simple_selector.type == Selector::SimpleSelector::Type::Id)
+                attributes.set(HTML::AttributeNames::id);
+            else if (simple_selector.type == Selector::SimpleSelector::Type::Class)
+                attributes.set(HTML::AttributeNames::class_);
+            if (simple_selector.attribute_match_type != Selector::SimpleSelector::AttributeMatchType::None)
+                attributes.set(simple_selector.attribute_name);
+
+            switch (simple_selector.pseudo_class) {
+            case Selector::SimpleSelector::PseudoClass::Link:
+                // NOTE: This matches the descendants of links too, see Node::is_link().
+                rule_cache.attributes_in_other_compounds.set(HTML::AttributeNames::href);
+                break;
+            case Selector::SimpleSelector::PseudoClass::Hover:
+                if (is_rightmost)
+                    rule_cache.has_hover_in_rightmost_compounds = true;
+                else
+                    rule_cache.has_hover_in_other_compounds = true;
+                break;
+            case Selector::SimpleSelector::PseudoClass::Disabled:
+            case Selector::SimpleSelector::PseudoClass::Enabled:
+                attributes.set(HTML::AttributeNames::disabled);
+                break;
+            case Selector::SimpleSelector::PseudoClass::Checked:
+                attributes.set(HTML::AttributeNames::checked);
+                break;
+            case Selector::SimpleSelector::PseudoClass::Not:
+                rule_cache.has_not_pseudo_class = true;
+                break;
+            case Selector::SimpleSelector::PseudoClass::FirstChild:
+            case Selector::SimpleSelector::PseudoClass::LastChild:
+            case Selector::SimpleSelector::PseudoClass::OnlyChild:
+            case Selector::SimpleSelector::PseudoClass::Empty:
+            case Selector::SimpleSelector::PseudoClass::FirstOfType:
+            case Selector::SimpleSelector::PseudoClass::LastOfType:
+            case Selector::SimpleSelector::PseudoClass::NthChild:
+            case Selector::SimpleSelector::PseudoClass::NthLastChild:
+                rule_cache.has_structural_pseudo_classes = true;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+static void add_to_rule_cache(RuleCache& rule_cache, RuleToMatch&& rule_to_match, const Selector& selector)
 {
-    Vector<MatchingRule> matching_rules;
+    record_selector_features(rule_cache, selector);
+
+    if (selector.complex_selectors().is_empty()) {
+        rule_cache.other_rules.append(move(rule_to_match));
+        return;
+    }
+
+    // Every simple selector of the rightmost compound selector has to match the element itself, so any one of them
+    // is a good key. Ids are the most selective, then classes, then tag names.
+    auto& compound_selector = selector.complex_selectors().last().compound_selector;
+    auto find = [&](Selector::SimpleSelector::Type type) -> const Selector::SimpleSelector* {
+        for (auto& simple_selector : compound_selector) {
+            if (simple_selector.type == type)
+                return &simple_selector;
+        }
+        return nullptr;
+    };
+
+    if (auto* id = find(Selector::SimpleSelector::Type::Id))
+        rule_cache.rules_by_id.ensure(id->value).append(move(rule_to_match));
+    else if (auto* class_name = find(Selector::SimpleSelector::Type::Class))
+        rule_cache.rules_by_class.ensure(class_name->value).append(move(rule_to_match));
+    else if (auto* tag_name = find(Selector::SimpleSelector::Type::TagName))
+        rule_cache.rules_by_tag_name.ensure(tag_name->value).append(move(rule_to_match));
+    else
+        rule_cache.other_rules.append(move(rule_to_match));
+}
+
+const RuleCache& StyleResolver::rule_cache() const
+{
+    if (m_rule_cache && m_rule_cache->built_in_quirks_mode == document().in_quirks_mode())
+        return *m_rule_cache;
+
+    auto rule_cache = make<RuleCache>();
+    rule_cache->built_in_quirks_mode = document().in_quirks_mode();
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -73,10 +246,8 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         static_cast<const CSSStyleSheet&>(sheet).for_each_effective_style_rule([&](auto& rule) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index, selector.specificity() });
-                    break;
-                }
+                RuleToMatch rule_to_match { { rule, style_sheet_index, rule_index, selector_index, selector.specificity() }, ancestor_hashes(selector) };
+                add_to_rule_cache(*rule_cache, move(rule_to_match), selector);
                 ++selector_index;
             }
             ++rule_index;
@@ -84,7 +255,115 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         ++style_sheet_index;
     });
 
-    return matching_rules;
+    m_rule_cache = move(rule_cache);
+    return *m_rule_cache;
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+    m_prematched_rules.clear();
+}
+
+Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+{
+    if (auto it = m_prematched_rules.find(&element); it != m_prematched_rules.end())
+        return it->value;
+    return to_matching_rules(collect_matching_rules(element, rule_cache()));
+}
+
+// NOTE: This may run on any thread (see prematch_rules_for_subtree()), so it must not touch anything but the rule cache and the DOM.
+//       That includes the reference counts of the rules, which is why we hand out pointers into the rule cache instead.
+Vector<const MatchingRule*> StyleResolver::collect_matching_rules(const DOM::Element& element, const RuleCache& rule_cache) const
+{
+    AncestorFilter ancestor_filter(element);
+
+    Vector<const MatchingRule*> matching_rules;
+    auto add_matching_rules = [&](const Vector<RuleToMatch>& rules) {
+        for (auto& rule_to_match : rules) {
+            if (!ancestor_filter.may_match(rule_to_match))
+                continue;
+            auto& matching_rule = rule_to_match.matching_rule;
+            if (SelectorEngine::matches(matching_rule.rule->selectors()[matching_rule.selector_index], element))
+                matching_rules.append(&matching_rule);
+        }
+    };
+    auto add_matching_rules_from = [&](const HashMap<FlyString, Vector<RuleToMatch>>& rules_by_key, const FlyString& key) {
+        if (auto it = rules_by_key.find(key); it != rules_by_key.end())
+            add_matching_rules(it->value);
+    };
+
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_null())
+        add_matching_rules_from(rule_cache.rules_by_id, id);
+    for (auto& class_name : element.class_names())
+        add_matching_rules_from(rule_cache.rules_by_class, class_name);
+    add_matching_rules_from(rule_cache.rules_by_tag_name, element.local_name());
+    add_matching_rules(rule_cache.other_rules);
+
+    // A rule applies once, with the first of its selectors that matches, no matter how many of them do
+    // (or which buckets they came from).
+    quick_sort(matching_rules, [](auto* a, auto* b) {
+        if (a->style_sheet_index != b->style_sheet_index)
+            return a->style_sheet_index < b->style_sheet_index;
+        if (a->rule_index != b->rule_index)
+            return a->rule_index < b->rule_index;
+        return a->selector_index < b->selector_index;
+    });
+    Vector<const MatchingRule*> unique_matching_rules;
+    unique_matching_rules.ensure_capacity(matching_rules.size());
+    for (auto* matching_rule : matching_rules) {
+        if (!unique_matching_rules.is_empty()) {
+            auto& previous = *unique_matching_rules.last();
+            if (previous.style_sheet_index == matching_rule->style_sheet_index && previous.rule_index == matching_rule->rule_index)
+                continue;
+        }
+        unique_matching_rules.unchecked_append(matching_rule);
+    }
+
+    return unique_matching_rules;
+}
+
+Vector<MatchingRule> StyleResolver::to_matching_rules(const Vector<const MatchingRule*>& matching_rules)
+{
+    Vector<MatchingRule> copied_matching_rules;
+    copied_matching_rules.ensure_capacity(matching_rules.size());
+    for (auto* matching_rule : matching_rules)
+        copied_matching_rules.unchecked_append(*matching_rule);
+    return copied_matching_rules;
+}
+
+void StyleResolver::prematch_rules_for_subtree(DOM::Node& root) const
+{
+    auto& rule_cache = this->rule_cache();
+    // The arguments of :not() get parsed while matching, which can't happen on other threads.
+    if (rule_cache.has_not_pseudo_class)
+        return;
+
+    struct ElementToMatch {
+        const DOM::Element* element { nullptr };
+        Vector<const MatchingRule*> matching_rules;
+    };
+    Vector<ElementToMatch> elements_to_match;
+    root.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
+        elements_to_match.append({ &element, {} });
+        return IterationDecision::Continue;
+    });
+    if (elements_to_match.size() < minimum_element_count_for_prematching)
+        return;
+
+    auto match = [&](ElementToMatch& element_to_match) {
+        element_to_match.matching_rules = collect_matching_rules(*element_to_match.element, rule_cache);
+    };
+    Threading::parallel_for(elements_to_match.span(), match, minimum_elements_per_job);
+
+    // The rules are reference counted non-atomically, so only now that we're back on our own thread do we take references to them.
+    for (auto& element_to_match : elements_to_match)
+        m_prematched_rules.set(element_to_match.element, to_matching_rules(element_to_match.matching_rules));
+}
+
+void StyleResolver::clear_prematched_rules() const
+{
+    m_prematched_rules.clear();
 }
 
 void StyleResolver::sort_matching_rules(Vector<MatchingRule>& matching_rules) const
@@ -861,8 +1140,52 @@ Optional<StyleProperty> StyleResolver::resolve_custom_property(DOM::Element& ele
     return resolved_with_specificity.style;
 }
 
+static bool have_same_attributes(const DOM::Element& a, const DOM::Element& b)
+{
+    if (a.attribute_list_size() != b.attribute_list_size())
+        return false;
+    bool same = true;
+    a.for_each_attribute([&](auto& name, auto& value) {
+        if (same && b.attribute(name) != value)
+            same = false;
+    });
+    return same;
+}
+
+// Siblings with the same tag name and attributes usually end up with the same style, in which case the style
+// resolved for the previous one can be reused as is. We only do that when nothing could tell them apart.
+RefPtr<StyleProperties> StyleResolver::find_shareable_style(const DOM::Element& element) const
+{
+    auto* sibling = element.previous_element_sibling();
+    if (!sibling || !sibling->specified_css_values() || sibling->needs_style_update())
+        return nullptr;
+
+    auto& rule_cache = this->rule_cache();
+    if (rule_cache.has_structural_pseudo_classes || rule_cache.has_sibling_combinators || rule_cache.has_not_pseudo_class)
+        return nullptr;
+
+    if (sibling->local_name() != element.local_name() || sibling->namespace_() != element.namespace_())
+        return nullptr;
+    // NOTE: The inline style can be changed through the CSSOM without touching the style attribute.
+    if (element.inline_style() || sibling->inline_style())
+        return nullptr;
+    if (!have_same_attributes(element, *sibling))
+        return nullptr;
+
+    if (auto* hovered_node = document().hovered_node()) {
+        auto is_hovered = [&](auto& node) { return node.is_inclusive_ancestor_of(*hovered_node); };
+        if (is_hovered(element) || is_hovered(*sibling))
+            return nullptr;
+    }
+
+    return const_cast<StyleProperties*>(sibling->specified_css_values());
+}
+
 NonnullRefPtr<StyleProperties> StyleResolver::resolve_style(DOM::Element& element) const
 {
+    if (auto shared_style = find_shareable_style(element))
+        return shared_style.release_nonnull();
+
     auto style = StyleProperties::create();
 
     if (auto* parent_style = element.parent_element() ? element.parent_element()->specified_css_values() : nullptr) {
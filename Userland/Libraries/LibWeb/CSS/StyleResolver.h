@@ -1,11 +1,15 @@
 /*
  * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * Copyright (c) 2021, the SerenityOS developers.
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
@@ -22,6 +26,36 @@ struct MatchingRule {
     u32 specificity { 0 };
 };
 
+// One selector of a rule, along with what we need to rule it out quickly.
+struct RuleToMatch {
+    MatchingRule matching_rule;
+    // The ids, classes and tag names that some ancestor of a matching element must have, see AncestorFilter.
+    Vector<u32, 4> ancestor_hashes;
+};
+
+// The rules of all style sheets, bucketed by what the rightmost compound selector of each of their selectors requires,
+// so that an element only has to be matched against the rules that could possibly apply to it.
+struct RuleCache {
+    HashMap<FlyString, Vector<RuleToMatch>> rules_by_id;
+    HashMap<FlyString, Vector<RuleToMatch>> rules_by_class;
+    HashMap<FlyString, Vector<RuleToMatch>> rules_by_tag_name;
+    Vector<RuleToMatch> other_rules;
+    bool built_in_quirks_mode { false };
+
+    // What the selectors depend on, so that a change only invalidates the elements it can affect.
+    // Something that only appears in rightmost compound selectors can only affect the style of the element itself,
+    // anywhere else it can affect descendants (and following siblings, with sibling combinators) as well.
+    HashTable<FlyString> attributes_in_rightmost_compounds;
+    HashTable<FlyString> attributes_in_other_compounds;
+    bool has_hover_in_rightmost_compounds { false };
+    bool has_hover_in_other_compounds { false };
+    bool has_sibling_combinators { false };
+    // The arguments of :not() aren't parsed until they're matched, so all bets are off.
+    bool has_not_pseudo_class { false };
+    // Structural pseudo-classes match siblings differently, which means they can't share their style.
+    bool has_structural_pseudo_classes { false };
+};
+
 class StyleResolver {
 public:
     explicit StyleResolver(DOM::Document&);
@@ -33,6 +67,13 @@ public:
     NonnullRefPtr<StyleProperties> resolve_style(DOM::Element&) const;
 
     Vector<MatchingRule> collect_matching_rules(const DOM::Element&) const;
+
+    // Selector matching only reads the DOM and the rule cache, so the elements of a subtree can be matched on the
+    // thread pool all at once. collect_matching_rules() then hands out the results until they're cleared again.
+    // NOTE: The DOM must not change in between, so this is meant for building a layout tree in one go.
+    void prematch_rules_for_subtree(DOM::Node&) const;
+    void clear_prematched_rules() const;
+
     void sort_matching_rules(Vector<MatchingRule>&) const;
     struct CustomPropertyResolutionTuple {
         Optional<StyleProperty> style {};
@@ -43,11 +84,21 @@ public:
 
     static bool is_inherited_property(CSS::PropertyID);
 
+    // Has to be called whenever the set of style sheets, or the rules in them, changes.
+    void invalidate_rule_cache();
+    const RuleCache& rule_cache() const;
+
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    RefPtr<StyleProperties> find_shareable_style(const DOM::Element&) const;
+    Vector<const MatchingRule*> collect_matching_rules(const DOM::Element&, const RuleCache&) const;
+    static Vector<MatchingRule> to_matching_rules(const Vector<const MatchingRule*>&);
+
     DOM::Document& m_document;
+    mutable OwnPtr<RuleCache> m_rule_cache;
+    mutable HashMap<const DOM::Element*, Vector<MatchingRule>> m_prematched_rules;
 };
 
 }
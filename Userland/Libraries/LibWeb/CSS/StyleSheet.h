@@ -14,7 +14,7 @@
 namespace Web::CSS {
 
 class StyleSheet
-    : public RefCounted<StyleSheet>
+    : public RefCounted<StyleSheet, RefCountPolicy::NonAtomic>
     , public Bindings::Wrappable {
 public:
     using WrapperType = Bindings::StyleSheetWrapper;
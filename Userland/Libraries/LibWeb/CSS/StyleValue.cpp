@@ -163,7 +163,7 @@ void ImageStyleValue::resource_did_load()
 {
     if (!m_document)
         return;
-    m_bitmap = resource()->bitmap();
+    // NOTE: The bitmap itself is decoded on demand when painting, see ImageResource.
     // FIXME: Do less than a full repaint if possible?
     if (m_document->browsing_context())
         m_document->browsing_context()->set_needs_display({});
@@ -192,7 +192,7 @@ enum class Repeat : u8 {
     Space,
 };
 
-class StyleValue : public RefCounted<StyleValue> {
+class StyleValue : public RefCounted<StyleValue, RefCountPolicy::NonAtomic> {
 public:
     virtual ~StyleValue();
 
@@ -436,7 +436,7 @@ public:
 
     String to_string() const override { return String::formatted("Image({})", m_url.to_string()); }
 
-    const Gfx::Bitmap* bitmap() const { return m_bitmap; }
+    const Gfx::Bitmap* bitmap() const { return resource() ? resource()->bitmap() : nullptr; }
 
 private:
     ImageStyleValue(const URL&, DOM::Document&);
@@ -446,7 +446,6 @@ private:
 
     URL m_url;
     WeakPtr<DOM::Document> m_document;
-    RefPtr<Gfx::Bitmap> m_bitmap;
 };
 
 inline CSS::ValueID StyleValue::to_identifier() const
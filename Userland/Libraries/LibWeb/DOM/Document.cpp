@@ -72,6 +72,10 @@ Document::Document(const URL& url)
     m_forced_layout_timer = Core::Timer::create_single_shot(0, [this] {
         force_layout();
     });
+
+    m_layout_update_timer = Core::Timer::create_single_shot(0, [this] {
+        update_layout();
+    });
 }
 
 Document::~Document()
@@ -157,6 +161,13 @@ void Document::schedule_forced_layout()
     m_forced_layout_timer->start();
 }
 
+void Document::schedule_layout_update()
+{
+    if (m_layout_update_timer->is_active())
+        return;
+    m_layout_update_timer->start();
+}
+
 bool Document::is_child_allowed(const Node& node) const
 {
     switch (node.type()) {
@@ -397,19 +408,38 @@ void Document::force_layout()
     update_layout();
 }
 
+static void clear_needs_layout_recursively(Layout::Node& node)
+{
+    node.for_each_child([&](auto& child) {
+        if (child.child_needs_layout())
+            clear_needs_layout_recursively(child);
+        child.set_needs_layout(false);
+        child.set_child_needs_layout(false);
+    });
+}
+
 void Document::update_layout()
 {
     if (!browsing_context())
         return;
 
+    m_layout_update_timer->stop();
+
     if (!m_layout_root) {
         Layout::TreeBuilder tree_builder;
         m_layout_root = static_ptr_cast<Layout::InitialContainingBlockBox>(tree_builder.build(*this));
     }
 
+    // The layout tree is kept between updates. Boxes that haven't been marked as needing layout
+    // (and whose containing block didn't change size) keep the geometry from the previous run.
     Layout::BlockFormattingContext root_formatting_context(*m_layout_root, nullptr);
     root_formatting_context.run(*m_layout_root, Layout::LayoutMode::Default);
 
+    clear_needs_layout_recursively(*m_layout_root);
+    m_layout_root->set_needs_layout(false);
+    m_layout_root->set_child_needs_layout(false);
+    m_layout_root->invalidate_display_lists();
+
     m_layout_root->set_needs_display();
 
     if (browsing_context()->is_top_level()) {
@@ -492,7 +522,24 @@ void Document::set_hovered_node(Node* node)
     RefPtr<Node> old_hovered_node = move(m_hovered_node);
     m_hovered_node = node;
 
-    invalidate_style();
+    auto& rule_cache = style_resolver().rule_cache();
+    if (!rule_cache.has_hover_in_rightmost_compounds && !rule_cache.has_hover_in_other_compounds)
+        return;
+
+    // :hover matches the hovered node and its ancestors, so only the ancestors that the old and new hovered nodes
+    // don't have in common started or stopped matching it.
+    auto invalidate_ancestors_up_to_common_one = [&](Node* hovered_node, Node* other_hovered_node) {
+        Node* topmost_changed = nullptr;
+        for (auto* ancestor = hovered_node; ancestor && !(other_hovered_node && ancestor->is_inclusive_ancestor_of(*other_hovered_node)); ancestor = ancestor->parent()) {
+            ancestor->set_needs_style_update(true);
+            topmost_changed = ancestor;
+        }
+        // Otherwise, selectors like "div:hover span" can change the style of their descendants too.
+        if (topmost_changed && rule_cache.has_hover_in_other_compounds)
+            topmost_changed->invalidate_style();
+    };
+    invalidate_ancestors_up_to_common_one(old_hovered_node, node);
+    invalidate_ancestors_up_to_common_one(node, old_hovered_node);
 }
 
 NonnullRefPtr<HTMLCollection> Document::get_elements_by_name(String const& name)
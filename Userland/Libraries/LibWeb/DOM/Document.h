@@ -151,6 +151,7 @@ public:
 
     void schedule_style_update();
     void schedule_forced_layout();
+    void schedule_layout_update();
 
     NonnullRefPtr<HTMLCollection> get_elements_by_name(String const&);
     NonnullRefPtr<HTMLCollection> get_elements_by_tag_name(FlyString const&);
@@ -310,6 +311,7 @@ private:
 
     RefPtr<Core::Timer> m_style_update_timer;
     RefPtr<Core::Timer> m_forced_layout_timer;
+    RefPtr<Core::Timer> m_layout_update_timer;
 
     String m_source;
 
@@ -72,7 +72,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     if (name.is_empty())
         return InvalidCharacterError::create("Attribute name must not be empty");
 
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     if (auto* attribute = find_attribute(name))
         attribute->set_value(value);
@@ -85,7 +85,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
 
 void Element::remove_attribute(const FlyString& name)
 {
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     m_attributes.remove_first_matching([&](auto& attribute) { return attribute.name() == name; });
 }
@@ -103,6 +103,8 @@ RefPtr<Layout::Node> Element::create_layout_node()
 {
     auto style = document().style_resolver().resolve_style(*this);
     const_cast<Element&>(*this).m_specified_css_values = style;
+    // The style is up to date now, which also lets the next sibling share it.
+    set_needs_style_update(false);
     auto display = style->display();
 
     if (display == CSS::Display::None)
@@ -200,6 +202,14 @@ void Element::recompute_style()
     auto old_specified_css_values = m_specified_css_values;
     auto new_specified_css_values = document().style_resolver().resolve_style(*this);
     m_specified_css_values = new_specified_css_values;
+
+    // Only the elements whose own style may have changed get invalidated, so pass changes on to the children inheriting from us.
+    if (!old_specified_css_values || !(*old_specified_css_values == *new_specified_css_values)) {
+        for_each_child_of_type<Element>([](auto& child) {
+            child.set_needs_style_update(true);
+        });
+    }
+
     if (!layout_node()) {
         if (new_specified_css_values->display() == CSS::Display::None)
             return;
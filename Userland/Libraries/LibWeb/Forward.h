@@ -162,6 +162,7 @@ class BlockFormattingContext;
 class Box;
 class ButtonBox;
 class CheckBox;
+class DisplayList;
 class FormattingContext;
 class InitialContainingBlockBox;
 class InlineFormattingContext;
@@ -173,6 +174,7 @@ class Node;
 class NodeWithStyle;
 class RadioButton;
 class ReplacedBox;
+class StackingContext;
 class TextNode;
 }
 
@@ -181,6 +183,7 @@ class EventHandler;
 class EditEventHandler;
 class BrowsingContext;
 class FrameLoader;
+class ImageResource;
 class InProcessWebView;
 class LoadRequest;
 class Origin;
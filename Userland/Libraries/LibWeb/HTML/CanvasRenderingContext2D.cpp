@@ -97,7 +97,7 @@ void CanvasRenderingContext2D::draw_image(const HTMLImageElement& image_element,
         return;
 
     auto src_rect = image_element.bitmap()->rect();
-    Gfx::FloatRect dst_rect = { x, y, (float)image_element.bitmap()->width(), (float)image_element.bitmap()->height() };
+    Gfx::FloatRect dst_rect = { x, y, (float)image_element.natural_width(), (float)image_element.natural_height() };
     auto rect = m_transform.map(dst_rect);
 
     painter->draw_scaled_bitmap(enclosing_int_rect(rect), *image_element.bitmap(), src_rect);
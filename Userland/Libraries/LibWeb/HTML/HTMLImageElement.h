@@ -28,6 +28,10 @@ public:
 
     const Gfx::Bitmap* bitmap() const;
 
+    // NOTE: The bitmap may have been decoded at a smaller size than this, see ImageResource.
+    unsigned natural_width() const { return m_image_loader.width(); }
+    unsigned natural_height() const { return m_image_loader.height(); }
+
 private:
     virtual void apply_presentational_hints(CSS::StyleProperties&) const override;
 
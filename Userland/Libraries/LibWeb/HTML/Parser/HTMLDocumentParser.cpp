@@ -102,6 +102,7 @@ RefPtr<DOM::Document> parse_html_document(const StringView& data, const URL& url
 
 HTMLDocumentParser::HTMLDocumentParser(DOM::Document& document, const StringView& input, const String& encoding)
     : m_tokenizer(input, encoding)
+    , m_preload_scanner(document)
     , m_document(document)
 {
     m_document->set_should_invalidate_styles_on_attribute_changes(false);
@@ -1890,6 +1891,15 @@ void HTMLDocumentParser::handle_text(HTMLToken& token)
         NonnullRefPtr<HTMLScriptElement> script = downcast<HTMLScriptElement>(current_node());
         m_stack_of_open_elements.pop();
         m_insertion_mode = m_original_insertion_mode;
+
+        // External scripts are currently loaded synchronously and block the parser. Before that happens,
+        // look ahead through the rest of the input and start fetching everything else it references.
+        // NOTE: The scan runs to the end of the input, so once is enough.
+        if (!m_did_run_preload_scanner && !m_parsing_fragment && script->has_attribute(HTML::AttributeNames::src)) {
+            m_did_run_preload_scanner = true;
+            m_preload_scanner.scan(m_tokenizer.unconsumed_source());
+        }
+
         // FIXME: Handle tokenizer insertion point stuff here.
         increment_script_nesting_level();
         script->prepare_script({});
@@ -8,6 +8,7 @@
 
 #include <AK/NonnullRefPtrVector.h>
 #include <LibWeb/DOM/Node.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
 #include <LibWeb/HTML/Parser/HTMLTokenizer.h>
 #include <LibWeb/HTML/Parser/ListOfActiveFormattingElements.h>
 #include <LibWeb/HTML/Parser/StackOfOpenElements.h>
@@ -150,6 +151,8 @@ private:
     ListOfActiveFormattingElements m_list_of_active_formatting_elements;
 
     HTMLTokenizer m_tokenizer;
+    HTMLPreloadScanner m_preload_scanner;
+    bool m_did_run_preload_scanner { false };
 
     bool m_foster_parenting { false };
     bool m_frameset_ok { true };
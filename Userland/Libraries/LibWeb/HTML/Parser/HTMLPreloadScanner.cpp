@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Loader/LoadRequest.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+namespace Web::HTML {
+
+HTMLPreloadScanner::HTMLPreloadScanner(DOM::Document& document)
+    : m_document(document)
+{
+}
+
+static bool is_stylesheet_link(const StringView& rel)
+{
+    bool is_stylesheet = false;
+    for (auto& part : rel.split_view(' ')) {
+        if (part == "stylesheet")
+            is_stylesheet = true;
+        else if (part == "alternate")
+            return false;
+    }
+    return is_stylesheet;
+}
+
+static bool is_classic_script_type(const StringView& type)
+{
+    // NOTE: This is deliberately loose; a wasted fetch is cheap compared to a missed one.
+    return type.is_empty() || type.contains("javascript"sv) || type.contains("ecmascript"sv);
+}
+
+void HTMLPreloadScanner::scan(const StringView& input)
+{
+    // The input has already been decoded by the parser's tokenizer.
+    HTMLTokenizer tokenizer { input, "utf-8" };
+
+    for (;;) {
+        auto optional_token = tokenizer.next_token();
+        if (!optional_token.has_value())
+            return;
+        auto& token = optional_token.value();
+        if (token.is_end_of_file())
+            return;
+        if (!token.is_start_tag())
+            continue;
+
+        auto tag_name = token.tag_name();
+
+        // URLs after a <base> resolve against a base URL we don't know yet, so leave the rest to the parser.
+        if (tag_name == HTML::TagNames::base)
+            return;
+
+        if (tag_name == HTML::TagNames::script) {
+            if (token.has_attribute(HTML::AttributeNames::src) && is_classic_script_type(token.attribute(HTML::AttributeNames::type)))
+                preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::src));
+        } else if (tag_name == HTML::TagNames::link) {
+            if (is_stylesheet_link(token.attribute(HTML::AttributeNames::rel)) && token.has_attribute(HTML::AttributeNames::href))
+                preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::href));
+        } else if (tag_name == HTML::TagNames::img) {
+            if (token.has_attribute(HTML::AttributeNames::src))
+                preload(Resource::Type::Image, token.attribute(HTML::AttributeNames::src));
+        }
+
+        // There's no tree builder here to switch the tokenizer into the right state for elements
+        // with raw text contents, so do it ourselves. Otherwise markup inside e.g. a script would be
+        // mistaken for real tags.
+        if (tag_name == HTML::TagNames::script)
+            tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        else if (tag_name.is_one_of(HTML::TagNames::style, HTML::TagNames::xmp, HTML::TagNames::iframe, HTML::TagNames::noembed, HTML::TagNames::noframes, HTML::TagNames::noscript))
+            tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+        else if (tag_name.is_one_of(HTML::TagNames::textarea, HTML::TagNames::title))
+            tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+        else if (tag_name == HTML::TagNames::plaintext)
+            return;
+    }
+}
+
+void HTMLPreloadScanner::preload(Resource::Type type, const StringView& value)
+{
+    auto url = m_document.complete_url(value);
+    if (!url.is_valid())
+        return;
+
+    // Only network loads are cached and slow enough to be worth starting early.
+    if (!url.protocol().is_one_of("http", "https", "gemini"))
+        return;
+
+    auto url_string = url.to_string();
+    if (m_requested_urls.contains(url_string))
+        return;
+    m_requested_urls.set(url_string);
+
+    dbgln_if(RESOURCE_DEBUG, "HTMLPreloadScanner: Preloading {}", url);
+    auto request = LoadRequest::create_for_url_on_page(url, m_document.page());
+    ResourceLoader::the().load_resource(type, request);
+}
+
+}
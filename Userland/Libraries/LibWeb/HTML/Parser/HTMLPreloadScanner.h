@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/String.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/Loader/Resource.h>
+
+namespace Web::HTML {
+
+// Speculatively tokenizes markup the tree builder hasn't reached yet and starts fetching the
+// subresources it references (scripts, stylesheets and images). The fetches go through the
+// ResourceLoader cache, so the real loads issued later by the DOM pick up the in-flight or
+// finished resource instead of starting over.
+class HTMLPreloadScanner {
+public:
+    explicit HTMLPreloadScanner(DOM::Document&);
+
+    void scan(const StringView& input);
+
+private:
+    void preload(Resource::Type, const StringView& url);
+
+    DOM::Document& m_document;
+    HashTable<String> m_requested_urls;
+};
+
+}
@@ -120,6 +120,9 @@ public:
 
     String source() const { return m_decoded_input; }
 
+    // The part of the (decoded) input that hasn't been consumed yet.
+    StringView unconsumed_source() const { return m_utf8_view.as_string().substring_view(m_utf8_view.byte_offset_of(m_utf8_iterator)); }
+
 private:
     void skip(size_t count);
     Optional<u32> next_code_point();
@@ -191,8 +191,10 @@ void InProcessWebView::page_did_unhover_link()
         on_link_hover({});
 }
 
-void InProcessWebView::page_did_invalidate(const Gfx::IntRect&)
+void InProcessWebView::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
+    if (!viewport_rect_in_content_coordinates().intersects(content_rect))
+        return;
     update();
 }
 
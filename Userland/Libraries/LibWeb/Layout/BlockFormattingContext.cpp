@@ -395,9 +395,21 @@ void BlockFormattingContext::layout_block_level_children(Box& box, LayoutMode la
             return IterationDecision::Continue;
         }
 
-        compute_width(child_box);
-        layout_inside(child_box, layout_mode);
-        compute_height(child_box);
+        float containing_block_width = child_box.containing_block()->width();
+        // A box that can keep its previous layout still has to be placed again, as that depends on its earlier siblings.
+        if (!can_reuse_previous_layout(child_box, containing_block_width, layout_mode)) {
+            auto out_of_flow_box_count_before = m_out_of_flow_box_count;
+
+            compute_width(child_box);
+            layout_inside(child_box, layout_mode);
+            compute_height(child_box);
+
+            // Passes in the other layout modes leave boxes with geometry that is only good for measuring.
+            if (layout_mode == LayoutMode::Default)
+                child_box.set_layout_cache(Box::LayoutCache { containing_block_width, m_out_of_flow_box_count != out_of_flow_box_count_before });
+            else
+                child_box.set_layout_cache({});
+        }
 
         if (child_box.computed_values().position() == CSS::Position::Relative)
             compute_position(child_box);
@@ -423,6 +435,28 @@ void BlockFormattingContext::layout_block_level_children(Box& box, LayoutMode la
     }
 }
 
+bool BlockFormattingContext::can_reuse_previous_layout(const Box& child_box, float containing_block_width, LayoutMode layout_mode) const
+{
+    if (layout_mode != LayoutMode::Default)
+        return false;
+    if (!is<BlockBox>(child_box) || is<ReplacedBox>(child_box))
+        return false;
+    if (child_box.needs_layout() || child_box.child_needs_layout())
+        return false;
+
+    auto& cache = child_box.layout_cache();
+    if (!cache.has_value() || cache->containing_block_width != containing_block_width)
+        return false;
+
+    // Floats (ours or the ones inside the box) and absolutely positioned descendants tie the box to the rest
+    // of the formatting context, so those boxes are always laid out again.
+    if (cache->has_out_of_flow_descendants)
+        return false;
+    if (!m_left_floating_boxes.is_empty() || !m_right_floating_boxes.is_empty())
+        return false;
+    return true;
+}
+
 void BlockFormattingContext::place_block_level_replaced_element_in_normal_flow(Box& child_box, Box& containing_block)
 {
     VERIFY(!containing_block.is_absolutely_positioned());
@@ -564,6 +598,8 @@ void BlockFormattingContext::layout_floating_child(Box& box, Box& containing_blo
 {
     VERIFY(box.is_floating());
 
+    ++m_out_of_flow_box_count;
+
     compute_width(box);
     layout_inside(box, LayoutMode::Default);
     compute_height(box);
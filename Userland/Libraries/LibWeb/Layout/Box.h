@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Layout/LineBox.h>
@@ -131,6 +132,24 @@ public:
 
     BorderRadiusData normalized_border_radius_data();
 
+    // Remembers how this box was last laid out in LayoutMode::Default, so that its formatting context
+    // can leave it alone as long as neither it nor its containing block have changed since.
+    struct LayoutCache {
+        float containing_block_width { 0 };
+        bool has_out_of_flow_descendants { false };
+    };
+
+    const Optional<LayoutCache>& layout_cache() const { return m_layout_cache; }
+    void set_layout_cache(Optional<LayoutCache> cache) { m_layout_cache = move(cache); }
+
+    struct IntrinsicWidths {
+        float preferred_width { 0 };
+        float preferred_minimum_width { 0 };
+    };
+
+    const Optional<IntrinsicWidths>& cached_intrinsic_widths() const { return m_cached_intrinsic_widths; }
+    void set_cached_intrinsic_widths(Optional<IntrinsicWidths> widths) { m_cached_intrinsic_widths = move(widths); }
+
 protected:
     Box(DOM::Document& document, DOM::Node* node, NonnullRefPtr<CSS::StyleProperties> style)
         : NodeWithStyleAndBoxModelMetrics(document, node, move(style))
@@ -158,6 +177,9 @@ private:
     WeakPtr<LineBoxFragment> m_containing_line_box_fragment;
 
     OwnPtr<StackingContext> m_stacking_context;
+
+    Optional<LayoutCache> m_layout_cache;
+    Optional<IntrinsicWidths> m_cached_intrinsic_widths;
 };
 
 template<>
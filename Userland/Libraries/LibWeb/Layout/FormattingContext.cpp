@@ -108,6 +108,9 @@ static float greatest_child_width(const Box& box)
 
 FormattingContext::ShrinkToFitResult FormattingContext::calculate_shrink_to_fit_widths(Box& box)
 {
+    if (auto& cached_widths = box.cached_intrinsic_widths(); cached_widths.has_value())
+        return { cached_widths->preferred_width, cached_widths->preferred_minimum_width };
+
     // Calculate the preferred width by formatting the content without breaking lines
     // other than where explicit line breaks occur.
     layout_inside(box, LayoutMode::OnlyRequiredLineBreaks);
@@ -119,6 +122,9 @@ FormattingContext::ShrinkToFitResult FormattingContext::calculate_shrink_to_fit_
     layout_inside(box, LayoutMode::AllPossibleLineBreaks);
     float preferred_minimum_width = greatest_child_width(box);
 
+    // These only depend on the contents of the box, so they can be reused until something inside it needs layout.
+    box.set_cached_intrinsic_widths(Box::IntrinsicWidths { preferred_width, preferred_minimum_width });
+
     return { preferred_width, preferred_minimum_width };
 }
 
@@ -553,6 +559,10 @@ void FormattingContext::compute_height_for_absolutely_positioned_non_replaced_el
 
 void FormattingContext::layout_absolutely_positioned_element(Box& box)
 {
+    // The containing block of an absolutely positioned box may lie outside of every context above us, so all of them have to know.
+    for (auto* context = this; context; context = context->m_parent)
+        ++context->m_out_of_flow_box_count;
+
     auto& containing_block = *box.containing_block();
     auto& box_model = box.box_model();
 
@@ -53,6 +53,10 @@ protected:
 
     FormattingContext* m_parent { nullptr };
     Box* m_context_box { nullptr };
+
+    // Number of floating and absolutely positioned boxes laid out on behalf of this context so far.
+    // Used to tell whether a box can be laid out again without the rest of its formatting context.
+    size_t m_out_of_flow_box_count { 0 };
 };
 
 }
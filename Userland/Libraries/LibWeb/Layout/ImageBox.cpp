@@ -95,8 +95,10 @@ void ImageBox::paint(PaintContext& context, PaintPhase phase)
             if (alt.is_empty())
                 alt = image_element.src();
             context.painter().draw_text(enclosing_int_rect(absolute_rect()), alt, Gfx::TextAlignment::Center, computed_values().color(), Gfx::TextElision::Right);
-        } else if (auto bitmap = m_image_loader.bitmap(m_image_loader.current_frame_index())) {
-            context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect());
+        } else {
+            m_image_loader.set_displayed_size(enclosing_int_rect(absolute_rect()).size());
+            if (auto bitmap = m_image_loader.bitmap(m_image_loader.current_frame_index()))
+                context.painter().draw_scaled_bitmap(enclosing_int_rect(absolute_rect()), *bitmap, bitmap->rect());
         }
     }
 }
@@ -110,7 +112,11 @@ bool ImageBox::renders_as_alt_text() const
 
 void ImageBox::frame_did_set_viewport_rect(const Gfx::IntRect& viewport_rect)
 {
-    m_image_loader.set_visible_in_viewport(viewport_rect.to_type<float>().intersects(absolute_rect()));
+    m_image_loader.set_displayed_size(enclosing_int_rect(absolute_rect()).size());
+
+    // Count images within half a viewport of the visible area as visible, so they get decoded before they scroll into view.
+    auto expanded_viewport_rect = viewport_rect.inflated(0, viewport_rect.height());
+    m_image_loader.set_visible_in_viewport(expanded_viewport_rect.to_type<float>().intersects(absolute_rect()));
 }
 
 }
@@ -42,6 +42,12 @@ void InitialContainingBlockBox::build_stacking_context_tree()
     });
 }
 
+void InitialContainingBlockBox::invalidate_display_lists()
+{
+    if (auto* context = stacking_context())
+        context->invalidate_display_list();
+}
+
 void InitialContainingBlockBox::paint_all_phases(PaintContext& context)
 {
     context.painter().translate(-context.viewport_rect().location());
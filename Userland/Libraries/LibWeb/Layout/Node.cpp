@@ -147,6 +147,25 @@ void Node::set_needs_display()
     }
 }
 
+void Node::set_needs_layout(bool value)
+{
+    if (m_needs_layout == value)
+        return;
+    m_needs_layout = value;
+
+    if (m_needs_layout) {
+        // Intrinsic widths depend on everything inside a box, so they go stale along with the whole ancestor chain.
+        if (is<Box>(*this))
+            downcast<Box>(*this).set_cached_intrinsic_widths({});
+        for (auto* ancestor = parent(); ancestor; ancestor = ancestor->parent()) {
+            ancestor->m_child_needs_layout = true;
+            if (is<Box>(*ancestor))
+                downcast<Box>(*ancestor).set_cached_intrinsic_widths({});
+        }
+        document().schedule_layout_update();
+    }
+}
+
 Gfx::FloatPoint Node::box_type_agnostic_position() const
 {
     if (is<Box>(*this))
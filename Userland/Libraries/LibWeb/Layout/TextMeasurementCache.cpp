@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <LibWeb/Layout/TextMeasurementCache.h>
+#include <LibWeb/Layout/TextNode.h>
+
+namespace Web::Layout {
+
+// Roughly a few megabytes worth of chunks per generation.
+static constexpr size_t max_chunks_per_generation = 128 * KiB;
+
+TextMeasurementCache& TextMeasurementCache::the()
+{
+    static TextMeasurementCache s_the;
+    return s_the;
+}
+
+NonnullRefPtr<TextMeasurementCache::MeasuredText> TextMeasurementCache::measure(const Gfx::Font& font, const String& text, LayoutMode layout_mode, bool wrap_lines, bool wrap_breaks)
+{
+    TextMeasurementKey key { &font, text, layout_mode, wrap_lines, wrap_breaks };
+
+    if (auto it = m_current_generation.find(key); it != m_current_generation.end())
+        return it->value.measured_text;
+
+    RefPtr<MeasuredText> measured_text;
+    if (auto it = m_previous_generation.find(key); it != m_previous_generation.end()) {
+        measured_text = it->value.measured_text;
+        m_previous_generation.remove(it);
+    } else {
+        measured_text = adopt_ref(*new MeasuredText);
+        TextNode::ChunkIterator iterator(text, layout_mode, wrap_lines, wrap_breaks);
+        for (;;) {
+            auto chunk = iterator.next();
+            if (!chunk.has_value())
+                break;
+            auto width = font.width(chunk->view);
+            auto width_without_leading_space = width;
+            if (chunk->length > 0 && is_ascii_space(text[chunk->start]))
+                width_without_leading_space = font.width(chunk->view.substring_view(1, chunk->view.byte_length() - 1));
+            measured_text->chunks.append({
+                .start = chunk->start,
+                .length = chunk->length,
+                .has_breaking_newline = chunk->has_breaking_newline,
+                .is_all_whitespace = chunk->is_all_whitespace,
+                .width = width,
+                .width_without_leading_space = width_without_leading_space,
+            });
+        }
+    }
+
+    m_current_generation_chunk_count += measured_text->chunks.size();
+    if (m_current_generation_chunk_count > max_chunks_per_generation) {
+        m_previous_generation = move(m_current_generation);
+        m_current_generation.clear();
+        m_current_generation_chunk_count = measured_text->chunks.size();
+    }
+    m_current_generation.set(move(key), Entry { const_cast<Gfx::Font&>(font), *measured_text });
+    return measured_text.release_nonnull();
+}
+
+}
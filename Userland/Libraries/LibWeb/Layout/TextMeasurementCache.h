@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibGfx/Font.h>
+#include <LibWeb/Layout/Node.h>
+
+namespace Web::Layout {
+
+struct TextMeasurementKey {
+    const Gfx::Font* font { nullptr };
+    String text;
+    LayoutMode layout_mode { LayoutMode::Default };
+    bool wrap_lines { false };
+    bool wrap_breaks { false };
+
+    bool operator==(const TextMeasurementKey& other) const
+    {
+        return font == other.font && layout_mode == other.layout_mode && wrap_lines == other.wrap_lines && wrap_breaks == other.wrap_breaks && text == other.text;
+    }
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Web::Layout::TextMeasurementKey> : public GenericTraits<Web::Layout::TextMeasurementKey> {
+    static unsigned hash(const Web::Layout::TextMeasurementKey& key)
+    {
+        auto hash = pair_int_hash(ptr_hash(key.font), key.text.hash());
+        return pair_int_hash(hash, ((unsigned)key.layout_mode << 2) | (key.wrap_lines << 1) | key.wrap_breaks);
+    }
+};
+
+}
+
+namespace Web::Layout {
+
+// Remembers how a run of text breaks into chunks (the places a line may be broken) and how wide
+// each chunk is in a given font. The layout tree is rebuilt whenever the document changes or the
+// viewport is resized, so this lives outside of it and is shared by all text nodes, keyed by the
+// text itself. Measuring the same text again at a new available width is then just a lookup.
+class TextMeasurementCache {
+public:
+    struct Chunk {
+        size_t start { 0 };
+        size_t length { 0 };
+        bool has_breaking_newline { false };
+        bool is_all_whitespace { false };
+        float width { 0 };
+        // Width of the chunk with its first code point removed, for when leading whitespace collapses away.
+        float width_without_leading_space { 0 };
+    };
+
+    class MeasuredText : public RefCounted<MeasuredText> {
+    public:
+        Vector<Chunk> chunks;
+    };
+
+    static TextMeasurementCache& the();
+
+    NonnullRefPtr<MeasuredText> measure(const Gfx::Font&, const String& text, LayoutMode, bool wrap_lines, bool wrap_breaks);
+
+private:
+    TextMeasurementCache() = default;
+
+    struct Entry {
+        NonnullRefPtr<Gfx::Font> font;
+        NonnullRefPtr<MeasuredText> measured_text;
+    };
+
+    // A two-generation cache: lookups promote entries from the old generation to the current one,
+    // and once the current generation is full it becomes the old one. Anything that wasn't used
+    // during a whole generation gets dropped, without having to keep track of an exact LRU order.
+    HashMap<TextMeasurementKey, Entry> m_current_generation;
+    HashMap<TextMeasurementKey, Entry> m_previous_generation;
+    size_t m_current_generation_chunk_count { 0 };
+};
+
+}
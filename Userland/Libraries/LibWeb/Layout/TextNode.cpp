@@ -12,6 +12,7 @@
 #include <LibWeb/Layout/BlockBox.h>
 #include <LibWeb/Layout/InlineFormattingContext.h>
 #include <LibWeb/Layout/Label.h>
+#include <LibWeb/Layout/TextMeasurementCache.h>
 #include <LibWeb/Layout/TextNode.h>
 #include <LibWeb/Page/BrowsingContext.h>
 
@@ -174,30 +175,25 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
     float available_width = context.available_width_at_line(line_boxes.size() - 1) - line_boxes.last().width();
 
     compute_text_for_rendering(do_collapse, line_boxes.last().is_empty_or_ends_in_whitespace());
-    ChunkIterator iterator(m_text_for_rendering, layout_mode, do_wrap_lines, do_wrap_breaks);
-
-    for (;;) {
-        auto chunk_opt = iterator.next();
-        if (!chunk_opt.has_value())
-            break;
-        auto& chunk = chunk_opt.value();
+    auto measured_text = TextMeasurementCache::the().measure(font, m_text_for_rendering, layout_mode, do_wrap_lines, do_wrap_breaks);
 
+    for (auto chunk : measured_text->chunks) {
         // Collapse entire fragment into non-existence if previous fragment on line ended in whitespace.
         if (do_collapse && line_boxes.last().is_empty_or_ends_in_whitespace() && chunk.is_all_whitespace)
             continue;
 
         float chunk_width;
         if (do_wrap_lines) {
-            if (do_collapse && is_ascii_space(*chunk.view.begin()) && line_boxes.last().is_empty_or_ends_in_whitespace()) {
+            if (do_collapse && chunk.length > 0 && is_ascii_space(m_text_for_rendering[chunk.start]) && line_boxes.last().is_empty_or_ends_in_whitespace()) {
                 // This is a non-empty chunk that starts with collapsible whitespace.
                 // We are at either at the start of a new line, or after something that ended in whitespace,
                 // so we don't need to contribute our own whitespace to the line. Skip over it instead!
                 ++chunk.start;
                 --chunk.length;
-                chunk.view = chunk.view.substring_view(1, chunk.view.byte_length() - 1);
+                chunk.width = chunk.width_without_leading_space;
             }
 
-            chunk_width = font.width(chunk.view) + font.glyph_spacing();
+            chunk_width = chunk.width + font.glyph_spacing();
 
             if (line_boxes.last().width() > 0 && chunk_width > available_width) {
                 containing_block.add_line_box();
@@ -207,7 +203,7 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
                     continue;
             }
         } else {
-            chunk_width = font.width(chunk.view);
+            chunk_width = chunk.width;
         }
 
         line_boxes.last().add_fragment(*this, chunk.start, chunk.length, chunk_width, font.glyph_height());
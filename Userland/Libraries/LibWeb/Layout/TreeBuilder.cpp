@@ -124,10 +124,21 @@ RefPtr<Node> TreeBuilder::build(DOM::Node& dom_node)
             m_parent_stack.prepend(downcast<NodeWithStyle>(ancestor));
     }
 
+    auto& style_resolver = dom_node.document().style_resolver();
+    style_resolver.prematch_rules_for_subtree(dom_node);
     create_layout_tree(dom_node);
+    style_resolver.clear_prematched_rules();
 
-    if (auto* root = dom_node.document().layout_node())
+    // A partial build inserts into a tree that has already been laid out, so make sure the new boxes get laid out too.
+    if (dom_node.parent()) {
+        if (auto* layout_node = dom_node.layout_node(); layout_node && layout_node->parent())
+            layout_node->parent()->set_needs_layout(true);
+    }
+
+    if (auto* root = dom_node.document().layout_node()) {
         fixup_tables(*root);
+        root->invalidate_display_lists();
+    }
 
     return move(m_layout_root);
 }
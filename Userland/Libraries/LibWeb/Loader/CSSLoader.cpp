@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <AK/URL.h>
+#include <LibThreading/ThreadPool.h>
 #include <LibWeb/CSS/CSSImportRule.h>
 #include <LibWeb/CSS/Parser/DeprecatedCSSParser.h>
 #include <LibWeb/CSS/StyleSheet.h>
@@ -16,6 +17,8 @@
 
 namespace Web {
 
+static constexpr size_t minimum_size_for_parsing_in_background = 16 * KiB;
+
 CSSLoader::CSSLoader(DOM::Element& owner_element)
     : m_owner_element(owner_element)
 {
@@ -51,7 +54,24 @@ void CSSLoader::resource_did_load()
         dbgln_if(CSS_LOADER_DEBUG, "CSSLoader: Resource did load, has encoded data. URL: {}", resource()->url());
     }
 
-    auto sheet = parse_css(CSS::ParsingContext(m_owner_element.document()), resource()->encoded_data());
+    if (resource()->encoded_data().size() < minimum_size_for_parsing_in_background) {
+        did_parse_style_sheet(parse_css(CSS::ParsingContext(m_owner_element.document()), resource()->encoded_data()));
+        return;
+    }
+
+    // Parsing a big style sheet takes a while, so it happens on the thread pool. That way the main thread can get on
+    // with other things in the meantime, and style sheets that arrive together get parsed at the same time.
+    auto context = CSS::ParsingContext::create_detached(m_owner_element.document());
+    auto future = Threading::ThreadPool::the().async<RefPtr<CSS::CSSStyleSheet>>([context = move(context), data = resource()->encoded_data()] {
+        return parse_css(context, data);
+    });
+    future->on_ready([this, protector = NonnullRefPtr(m_owner_element)](auto sheet) {
+        did_parse_style_sheet(move(sheet));
+    });
+}
+
+void CSSLoader::did_parse_style_sheet(RefPtr<CSS::CSSStyleSheet> sheet)
+{
     if (!sheet) {
         dbgln_if(CSS_LOADER_DEBUG, "CSSLoader: Failed to parse stylesheet: {}", resource()->url());
         return;
@@ -66,6 +86,8 @@ void CSSLoader::resource_did_load()
         m_style_sheet->rules() = sheet->rules();
     }
 
+    m_owner_element.document().style_resolver().invalidate_rule_cache();
+
     if (on_load)
         on_load();
 
@@ -31,6 +31,8 @@ private:
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
 
+    void did_parse_style_sheet(RefPtr<CSS::CSSStyleSheet>);
+
     DOM::Element& m_owner_element;
 
     RefPtr<CSS::CSSStyleSheet> m_style_sheet;
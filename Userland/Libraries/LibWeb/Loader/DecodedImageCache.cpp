@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWeb/Loader/DecodedImageCache.h>
+#include <LibWeb/Loader/ImageResource.h>
+
+namespace Web {
+
+static constexpr size_t decoded_image_budget = 64 * MiB;
+
+DecodedImageCache& DecodedImageCache::the()
+{
+    static DecodedImageCache s_the;
+    return s_the;
+}
+
+void DecodedImageCache::did_decode(ImageResource& resource)
+{
+    auto size_in_bytes = resource.decoded_size_in_bytes();
+    auto& entry = m_entries.ensure(&resource);
+    m_total_size_in_bytes -= entry.size_in_bytes;
+    entry.size_in_bytes = size_in_bytes;
+    entry.last_use = ++m_use_counter;
+    m_total_size_in_bytes += size_in_bytes;
+
+    evict_if_needed(resource);
+}
+
+void DecodedImageCache::did_use(ImageResource& resource)
+{
+    auto it = m_entries.find(&resource);
+    if (it != m_entries.end())
+        it->value.last_use = ++m_use_counter;
+}
+
+void DecodedImageCache::did_discard(ImageResource& resource)
+{
+    auto it = m_entries.find(&resource);
+    if (it == m_entries.end())
+        return;
+    m_total_size_in_bytes -= it->value.size_in_bytes;
+    m_entries.remove(it);
+}
+
+void DecodedImageCache::evict_if_needed(ImageResource& just_decoded)
+{
+    while (m_total_size_in_bytes > decoded_image_budget) {
+        ImageResource* victim = nullptr;
+        u64 victim_last_use = NumericLimits<u64>::max();
+        for (auto& it : m_entries) {
+            // Images on screen would only be decoded again on the next paint.
+            if (it.key == &just_decoded || it.key->is_visible_in_viewport())
+                continue;
+            if (it.value.last_use < victim_last_use) {
+                victim = it.key;
+                victim_last_use = it.value.last_use;
+            }
+        }
+        if (!victim)
+            return;
+        dbgln_if(IMAGE_LOADER_DEBUG, "DecodedImageCache: Evicting {} ({} bytes)", victim->url(), m_entries.get(victim)->size_in_bytes);
+        // NOTE: This calls back into did_discard().
+        victim->discard_decoded_frames();
+    }
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <LibWeb/Forward.h>
+
+namespace Web {
+
+// Keeps track of how much memory decoded image frames use across all ImageResources, and throws
+// away the least recently used ones that aren't on screen once that goes over budget.
+// The encoded data stays around, so evicted images are simply decoded again when needed.
+class DecodedImageCache {
+public:
+    static DecodedImageCache& the();
+
+    void did_decode(ImageResource&);
+    void did_use(ImageResource&);
+    void did_discard(ImageResource&);
+
+private:
+    DecodedImageCache() = default;
+
+    void evict_if_needed(ImageResource& just_decoded);
+
+    struct Entry {
+        size_t size_in_bytes { 0 };
+        u64 last_use { 0 };
+    };
+
+    HashMap<ImageResource*, Entry> m_entries;
+    size_t m_total_size_in_bytes { 0 };
+    u64 m_use_counter { 0 };
+};
+
+}
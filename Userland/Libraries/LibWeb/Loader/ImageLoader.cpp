@@ -41,6 +41,16 @@ void ImageLoader::set_visible_in_viewport(bool visible_in_viewport) const
         const_cast<ImageResource*>(resource())->update_volatility();
 }
 
+void ImageLoader::set_displayed_size(const Gfx::IntSize& displayed_size) const
+{
+    if (m_displayed_size == displayed_size)
+        return;
+    m_displayed_size = displayed_size;
+
+    if (resource())
+        const_cast<ImageResource*>(resource())->did_change_displayed_size();
+}
+
 void ImageLoader::resource_did_load()
 {
     VERIFY(resource());
@@ -62,14 +72,23 @@ void ImageLoader::resource_did_load()
         }
     }
 
+    // NOTE: Decoding is left until the image is actually needed, see ImageResource.
+
+    if (on_load)
+        on_load();
+}
+
+void ImageLoader::resource_did_decode()
+{
+    // We may be decoding again after the decoded frames were thrown away, don't restart the animation then.
+    if (m_timer->is_active() || m_loops_completed > 0)
+        return;
+
     if (resource()->is_animated() && resource()->frame_count() > 1) {
-        m_timer->set_interval(resource()->frame_duration(0));
+        m_timer->set_interval(resource()->frame_duration(m_current_frame_index));
         m_timer->on_timeout = [this] { animate(); };
         m_timer->start();
     }
-
-    if (on_load)
-        on_load();
 }
 
 void ImageLoader::animate()
@@ -107,21 +126,21 @@ bool ImageLoader::has_image() const
 {
     if (!resource())
         return false;
-    return bitmap(0);
+    return !resource()->natural_size().is_empty();
 }
 
 unsigned ImageLoader::width() const
 {
     if (!resource())
         return 0;
-    return bitmap(0) ? bitmap(0)->width() : 0;
+    return resource()->natural_size().width();
 }
 
 unsigned ImageLoader::height() const
 {
     if (!resource())
         return 0;
-    return bitmap(0) ? bitmap(0)->height() : 0;
+    return resource()->natural_size().height();
 }
 
 const Gfx::Bitmap* ImageLoader::bitmap(size_t frame_index) const
@@ -26,6 +26,7 @@ public:
     bool has_loaded_or_failed() const { return m_loading_state != LoadingState::Loading; }
 
     void set_visible_in_viewport(bool) const;
+    void set_displayed_size(const Gfx::IntSize&) const;
 
     unsigned width() const;
     unsigned height() const;
@@ -38,7 +39,9 @@ private:
     // ^ImageResourceClient
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
+    virtual void resource_did_decode() override;
     virtual bool is_visible_in_viewport() const override { return m_visible_in_viewport; }
+    virtual Optional<Gfx::IntSize> displayed_size() const override { return m_displayed_size; }
 
     void animate();
 
@@ -52,6 +55,7 @@ private:
     DOM::Element& m_owner_element;
 
     mutable bool m_visible_in_viewport { false };
+    mutable Optional<Gfx::IntSize> m_displayed_size;
 
     size_t m_current_frame_index { 0 };
     size_t m_loops_completed { 0 };
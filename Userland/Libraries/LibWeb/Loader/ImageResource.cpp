@@ -6,8 +6,12 @@
 
 #include <AK/Function.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
 #include <LibImageDecoderClient/Client.h>
+#include <LibWeb/Loader/DecodedImageCache.h>
 #include <LibWeb/Loader/ImageResource.h>
+#include <stdlib.h>
+#include <string.h>
 
 namespace Web {
 
@@ -18,6 +22,7 @@ ImageResource::ImageResource(const LoadRequest& request)
 
 ImageResource::~ImageResource()
 {
+    DecodedImageCache::the().did_discard(*this);
 }
 
 int ImageResource::frame_duration(size_t frame_index) const
@@ -40,6 +45,87 @@ static ImageDecoderClient::Client& image_decoder_client()
     return *image_decoder_client;
 }
 
+static u16 read_u16_be(ReadonlyBytes data, size_t offset) { return (data[offset] << 8) | data[offset + 1]; }
+static u16 read_u16_le(ReadonlyBytes data, size_t offset) { return data[offset] | (data[offset + 1] << 8); }
+static u32 read_u32_be(ReadonlyBytes data, size_t offset) { return ((u32)read_u16_be(data, offset) << 16) | read_u16_be(data, offset + 2); }
+static u32 read_u32_le(ReadonlyBytes data, size_t offset) { return read_u16_le(data, offset) | ((u32)read_u16_le(data, offset + 2) << 16); }
+
+// Finds the dimensions of an image by looking at its header, without decoding any pixels.
+// This lets layout size images that haven't been (and may never need to be) decoded.
+static Optional<Gfx::IntSize> sniff_image_size(ReadonlyBytes data)
+{
+    auto starts_with = [&](const StringView& magic) {
+        return data.size() >= magic.length() && !memcmp(data.data(), magic.characters_without_null_termination(), magic.length());
+    };
+
+    if (starts_with("\x89PNG\r\n\x1a\n"sv)) {
+        // The IHDR chunk always comes first.
+        if (data.size() < 24)
+            return {};
+        return Gfx::IntSize { (int)read_u32_be(data, 16), (int)read_u32_be(data, 20) };
+    }
+
+    if (starts_with("GIF87a"sv) || starts_with("GIF89a"sv)) {
+        if (data.size() < 10)
+            return {};
+        return Gfx::IntSize { (int)read_u16_le(data, 6), (int)read_u16_le(data, 8) };
+    }
+
+    if (starts_with("BM"sv)) {
+        if (data.size() < 26)
+            return {};
+        if (read_u32_le(data, 14) == 12)
+            return Gfx::IntSize { (int)read_u16_le(data, 18), (int)read_u16_le(data, 20) };
+        // A negative height means the rows are stored top-down.
+        return Gfx::IntSize { abs((i32)read_u32_le(data, 18)), abs((i32)read_u32_le(data, 22)) };
+    }
+
+    if (starts_with("\xff\xd8"sv)) {
+        // Walk the marker segments until we hit a start-of-frame.
+        size_t offset = 2;
+        while (offset + 4 <= data.size()) {
+            if (data[offset] != 0xff)
+                return {};
+            u8 marker = data[offset + 1];
+            if (marker == 0xff) {
+                ++offset;
+                continue;
+            }
+            // These markers stand alone and don't have a length.
+            if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9)) {
+                offset += 2;
+                continue;
+            }
+            bool is_start_of_frame = marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+            if (is_start_of_frame) {
+                if (offset + 9 > data.size())
+                    return {};
+                return Gfx::IntSize { (int)read_u16_be(data, offset + 7), (int)read_u16_be(data, offset + 5) };
+            }
+            offset += 2 + read_u16_be(data, offset + 2);
+        }
+        return {};
+    }
+
+    return {};
+}
+
+Gfx::IntSize ImageResource::natural_size() const
+{
+    // A failed decode trumps whatever the header claimed.
+    if (m_has_attempted_decode && m_decoded_frames.is_empty())
+        return {};
+
+    if (!m_natural_size.has_value() && has_encoded_data())
+        m_natural_size = sniff_image_size(encoded_data());
+
+    // Not a format we know how to sniff, so we have to decode it after all.
+    if (!m_natural_size.has_value())
+        decode_if_needed();
+
+    return m_natural_size.value_or({});
+}
+
 void ImageResource::decode_if_needed() const
 {
     if (!has_encoded_data())
@@ -51,10 +137,13 @@ void ImageResource::decode_if_needed() const
     if (!m_decoded_frames.is_empty())
         return;
 
+    // Formats that can decode huge images at a reduced size for less work do so if the image is shown much smaller.
     NonnullRefPtr decoder = image_decoder_client();
-    auto image = decoder->decode_image(encoded_data());
+    auto image = decoder->decode_image(encoded_data(), largest_displayed_size().value_or({}));
 
     if (image.has_value()) {
+        if (!image.value().size.is_empty())
+            m_natural_size = image.value().size;
         m_loop_count = image.value().loop_count;
         m_animated = image.value().is_animated;
         m_decoded_frames.resize(image.value().frames.size());
@@ -66,6 +155,76 @@ void ImageResource::decode_if_needed() const
     }
 
     m_has_attempted_decode = true;
+
+    if (m_decoded_frames.is_empty() || !m_decoded_frames[0].bitmap)
+        return;
+
+    if (!m_natural_size.has_value())
+        m_natural_size = m_decoded_frames[0].bitmap->size();
+    scale_decoded_frames_to_displayed_size();
+
+    auto& self = const_cast<ImageResource&>(*this);
+    DecodedImageCache::the().did_decode(self);
+    self.for_each_client([](auto& client) {
+        static_cast<ImageResourceClient&>(client).resource_did_decode();
+    });
+}
+
+Optional<Gfx::IntSize> ImageResource::largest_displayed_size() const
+{
+    Optional<Gfx::IntSize> largest_size;
+    bool all_clients_know_their_size = true;
+    const_cast<ImageResource&>(*this).for_each_client([&](auto& client) {
+        auto displayed_size = static_cast<const ImageResourceClient&>(client).displayed_size();
+        if (!displayed_size.has_value()) {
+            all_clients_know_their_size = false;
+            return;
+        }
+        if (!largest_size.has_value())
+            largest_size = displayed_size;
+        else
+            largest_size = Gfx::IntSize { max(largest_size->width(), displayed_size->width()), max(largest_size->height(), displayed_size->height()) };
+    });
+    if (!all_clients_know_their_size)
+        return {};
+    return largest_size;
+}
+
+void ImageResource::scale_decoded_frames_to_displayed_size() const
+{
+    auto displayed_size = largest_displayed_size();
+    if (!displayed_size.has_value() || displayed_size->is_empty())
+        return;
+
+    // Only bother when it saves a meaningful amount of memory.
+    auto natural_size = m_natural_size.value();
+    if ((u64)displayed_size->width() * displayed_size->height() * 2 > (u64)natural_size.width() * natural_size.height())
+        return;
+
+    for (auto& frame : m_decoded_frames) {
+        if (!frame.bitmap)
+            continue;
+        auto scaled_bitmap = Gfx::Bitmap::create_purgeable(Gfx::BitmapFormat::BGRA8888, displayed_size.value());
+        if (!scaled_bitmap)
+            continue;
+        Gfx::Painter painter(*scaled_bitmap);
+        painter.draw_scaled_bitmap(scaled_bitmap->rect(), *frame.bitmap, frame.bitmap->rect());
+        frame.bitmap = move(scaled_bitmap);
+    }
+}
+
+void ImageResource::did_change_displayed_size()
+{
+    if (m_decoded_frames.is_empty() || !m_decoded_frames[0].bitmap || !m_natural_size.has_value())
+        return;
+
+    // If we decoded at a reduced size and the image is now shown larger than that, start over.
+    auto decoded_size = m_decoded_frames[0].bitmap->size();
+    if (decoded_size == m_natural_size.value())
+        return;
+    auto displayed_size = largest_displayed_size();
+    if (!displayed_size.has_value() || displayed_size->width() > decoded_size.width() || displayed_size->height() > decoded_size.height())
+        discard_decoded_frames();
 }
 
 const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
@@ -73,18 +232,40 @@ const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
     decode_if_needed();
     if (frame_index >= m_decoded_frames.size())
         return nullptr;
+    DecodedImageCache::the().did_use(const_cast<ImageResource&>(*this));
     return m_decoded_frames[frame_index].bitmap;
 }
 
-void ImageResource::update_volatility()
+size_t ImageResource::decoded_size_in_bytes() const
+{
+    size_t size_in_bytes = 0;
+    for (auto& frame : m_decoded_frames) {
+        if (frame.bitmap)
+            size_in_bytes += frame.bitmap->size_in_bytes();
+    }
+    return size_in_bytes;
+}
+
+void ImageResource::discard_decoded_frames()
+{
+    m_decoded_frames.clear();
+    m_has_attempted_decode = false;
+    DecodedImageCache::the().did_discard(*this);
+}
+
+bool ImageResource::is_visible_in_viewport() const
 {
     bool visible_in_viewport = false;
-    for_each_client([&](auto& client) {
+    const_cast<ImageResource&>(*this).for_each_client([&](auto& client) {
         if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
             visible_in_viewport = true;
     });
+    return visible_in_viewport;
+}
 
-    if (!visible_in_viewport) {
+void ImageResource::update_volatility()
+{
+    if (!is_visible_in_viewport()) {
         for (auto& frame : m_decoded_frames) {
             if (frame.bitmap)
                 frame.bitmap->set_volatile();
@@ -102,11 +283,11 @@ void ImageResource::update_volatility()
                 still_has_decoded_image = false;
         }
     }
-    if (still_has_decoded_image)
-        return;
+    if (!still_has_decoded_image)
+        discard_decoded_frames();
 
-    m_decoded_frames.clear();
-    m_has_attempted_decode = false;
+    // The image is on screen or about to be, so have it ready for painting.
+    decode_if_needed();
 }
 
 ImageResourceClient::~ImageResourceClient()
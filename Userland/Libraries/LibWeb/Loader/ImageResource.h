@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <LibGfx/Size.h>
 #include <LibWeb/Loader/Resource.h>
 
 namespace Web {
@@ -21,6 +22,9 @@ public:
         size_t duration { 0 };
     };
 
+    // NOTE: This is read from the image header when possible, so asking for it doesn't force a decode.
+    Gfx::IntSize natural_size() const;
+
     const Gfx::Bitmap* bitmap(size_t frame_index = 0) const;
     int frame_duration(size_t frame_index) const;
     size_t frame_count() const
@@ -39,17 +43,25 @@ public:
         return m_loop_count;
     }
 
+    bool is_visible_in_viewport() const;
     void update_volatility();
+    void did_change_displayed_size();
+
+    size_t decoded_size_in_bytes() const;
+    void discard_decoded_frames();
 
 private:
     explicit ImageResource(const LoadRequest&);
 
     void decode_if_needed() const;
+    Optional<Gfx::IntSize> largest_displayed_size() const;
+    void scale_decoded_frames_to_displayed_size() const;
 
     mutable bool m_animated { false };
     mutable int m_loop_count { 0 };
     mutable Vector<Frame> m_decoded_frames;
     mutable bool m_has_attempted_decode { false };
+    mutable Optional<Gfx::IntSize> m_natural_size;
 };
 
 class ImageResourceClient : public ResourceClient {
@@ -58,6 +70,11 @@ public:
 
     virtual bool is_visible_in_viewport() const { return false; }
 
+    // The size the image is painted at, if known. Large images are decoded at this size to save memory.
+    virtual Optional<Gfx::IntSize> displayed_size() const { return {}; }
+
+    virtual void resource_did_decode() { }
+
 protected:
     ImageResource* resource() { return static_cast<ImageResource*>(ResourceClient::resource()); }
     const ImageResource* resource() const { return static_cast<const ImageResource*>(ResourceClient::resource()); }
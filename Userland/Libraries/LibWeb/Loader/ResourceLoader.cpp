@@ -32,10 +32,27 @@ ResourceLoader::ResourceLoader()
 {
 }
 
+static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
+
 void ResourceLoader::load_sync(const LoadRequest& request, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback)
 {
     Core::EventLoop loop;
 
+    // If someone (e.g. the HTML preload scanner) has already started loading this, wait for that load instead of starting another one.
+    if (auto it = s_resource_cache.find(request); it != s_resource_cache.end()) {
+        NonnullRefPtr<Resource> resource = it->value;
+        dbgln_if(CACHE_DEBUG, "Reusing cached resource for synchronous load: {}", request.url());
+        while (!resource->is_loaded() && !resource->is_failed())
+            loop.pump();
+        if (resource->is_failed()) {
+            if (error_callback)
+                error_callback(resource->error(), resource->status_code());
+            return;
+        }
+        success_callback(resource->encoded_data(), resource->response_headers(), resource->status_code());
+        return;
+    }
+
     load(
         request,
         [&](auto data, auto& response_headers, auto status_code) {
@@ -51,8 +68,6 @@ void ResourceLoader::load_sync(const LoadRequest& request, Function<void(Readonl
     loop.exec();
 }
 
-static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
-
 RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request)
 {
     if (!request.is_valid())
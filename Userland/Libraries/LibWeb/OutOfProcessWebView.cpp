@@ -197,15 +197,21 @@ void OutOfProcessWebView::screen_rect_change_event(GUI::ScreenRectChangeEvent& e
     client().async_update_screen_rect(event.rect());
 }
 
-void OutOfProcessWebView::notify_server_did_paint(Badge<WebContentClient>, i32 bitmap_id)
+void OutOfProcessWebView::notify_server_did_paint(Badge<WebContentClient>, i32 bitmap_id, const Gfx::IntRect& damage_rect)
 {
     if (m_client_state.back_bitmap_id == bitmap_id) {
+        bool had_usable_bitmap = m_client_state.has_usable_bitmap;
         m_client_state.has_usable_bitmap = true;
         swap(m_client_state.back_bitmap, m_client_state.front_bitmap);
         swap(m_client_state.back_bitmap_id, m_client_state.front_bitmap_id);
         // We don't need the backup bitmap anymore, so drop it.
         m_backup_bitmap = nullptr;
-        update();
+
+        // The new front bitmap only differs from the old one within the damage (which is in bitmap coordinates).
+        if (had_usable_bitmap)
+            update(damage_rect.translated(frame_thickness(), frame_thickness()));
+        else
+            update();
     }
 }
 
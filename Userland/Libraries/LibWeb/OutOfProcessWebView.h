@@ -35,7 +35,7 @@ public:
     void js_console_input(const String& js_source);
 
     void notify_server_did_layout(Badge<WebContentClient>, const Gfx::IntSize& content_size);
-    void notify_server_did_paint(Badge<WebContentClient>, i32 bitmap_id);
+    void notify_server_did_paint(Badge<WebContentClient>, i32 bitmap_id, const Gfx::IntRect& damage_rect);
     void notify_server_did_invalidate_content_rect(Badge<WebContentClient>, const Gfx::IntRect&);
     void notify_server_did_change_selection(Badge<WebContentClient>);
     void notify_server_did_request_cursor_change(Badge<WebContentClient>, Gfx::StandardCursor cursor);
@@ -142,15 +142,16 @@ void BrowsingContext::set_viewport_scroll_offset(const Gfx::IntPoint& offset)
 
 void BrowsingContext::set_needs_display(const Gfx::IntRect& rect)
 {
-    if (!viewport_rect().intersects(rect))
-        return;
-
+    // NOTE: The page client gets to hear about changes outside of the viewport too, as it may keep those parts of the page around.
     if (is_top_level()) {
         if (m_page)
             m_page->client().page_did_invalidate(to_top_level_rect(rect));
         return;
     }
 
+    if (!viewport_rect().intersects(rect))
+        return;
+
     if (host_element() && host_element()->layout_node())
         host_element()->layout_node()->set_needs_display();
 }
@@ -48,6 +48,9 @@ void EditEventHandler::handle_delete(DOM::Range& range)
         builder.append(end->data().substring_view(range.end_offset()));
 
         start->set_data(builder.to_string());
+
+        // Only the text changed, so the layout tree stays valid and just the affected boxes are laid out again.
+        m_frame.document()->update_layout();
     } else {
         // Remove all the nodes that are fully enclosed in the range.
         HashTable<DOM::Node*> queued_for_deletion;
@@ -87,12 +90,12 @@ void EditEventHandler::handle_delete(DOM::Range& range)
 
         start->set_data(builder.to_string());
         end->remove();
-    }
 
-    // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
-    //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
-    //        which really hurts performance.
-    m_frame.document()->force_layout();
+        // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
+        //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
+        //        which really hurts performance.
+        m_frame.document()->force_layout();
+    }
 
     m_frame.did_edit({});
 }
@@ -111,10 +114,7 @@ void EditEventHandler::handle_insert(DOM::Position position, u32 code_point)
         node.invalidate_style();
     }
 
-    // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
-    //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
-    //        which really hurts performance.
-    m_frame.document()->force_layout();
+    m_frame.document()->update_layout();
 
     m_frame.did_edit({});
 }
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Painter.h>
+#include <LibWeb/Layout/BlockBox.h>
+#include <LibWeb/Layout/SVGBox.h>
+#include <LibWeb/Painting/DisplayList.h>
+#include <LibWeb/Painting/PaintContext.h>
+#include <LibWeb/Painting/StackingContext.h>
+
+namespace Web::Layout {
+
+static Optional<Gfx::IntRect> visual_rect(const Node& node)
+{
+    // The root element's background covers the whole canvas, and fixed position boxes move along with the viewport.
+    if (node.is_root_element() || node.is_fixed_position())
+        return {};
+
+    // SVG graphics are drawn in the coordinate space of their <svg> element, not inside their own box.
+    if (is<SVGBox>(node))
+        return {};
+
+    // Inline content is painted as fragments of its containing block's line boxes.
+    if (!is<Box>(node)) {
+        auto* containing_block = node.containing_block();
+        if (!containing_block)
+            return {};
+        return visual_rect(*containing_block);
+    }
+
+    auto& box = downcast<Box>(node);
+    auto rect = box.bordered_rect();
+    for (auto& line_box : box.line_boxes()) {
+        for (auto& fragment : line_box.fragments())
+            rect = rect.united(fragment.absolute_rect());
+    }
+
+    // Leave some room for outlines and glyphs that stick out of their fragment.
+    return enclosing_int_rect(rect).inflated(4, 4);
+}
+
+void DisplayList::append_paint(Node& node, PaintPhase phase)
+{
+    m_items.append({ Item::Type::Paint, &node, nullptr, phase, visual_rect(node) });
+}
+
+void DisplayList::append_paint_if_focused(Node& node, PaintPhase phase)
+{
+    m_items.append({ Item::Type::PaintIfFocused, &node, nullptr, phase, visual_rect(node) });
+}
+
+void DisplayList::append_before_children_paint(Node& node, PaintPhase phase)
+{
+    m_items.append({ Item::Type::BeforeChildrenPaint, &node, nullptr, phase, {} });
+}
+
+void DisplayList::append_after_children_paint(Node& node, PaintPhase phase)
+{
+    m_items.append({ Item::Type::AfterChildrenPaint, &node, nullptr, phase, {} });
+}
+
+void DisplayList::append_stacking_context(StackingContext& stacking_context)
+{
+    m_items.append({ Item::Type::StackingContext, nullptr, &stacking_context, PaintPhase::Background, {} });
+}
+
+void DisplayList::replay(PaintContext& context) const
+{
+    auto& painter = context.painter();
+    auto damage_rect = painter.clip_rect().translated(-painter.translation());
+
+    for (auto& item : m_items) {
+        switch (item.type) {
+        case Item::Type::PaintIfFocused:
+            if (!context.has_focus())
+                break;
+            [[fallthrough]];
+        case Item::Type::Paint:
+            if (item.rect.has_value() && !item.rect->intersects(damage_rect))
+                break;
+            item.node->paint(context, item.phase);
+            break;
+        case Item::Type::BeforeChildrenPaint:
+            item.node->before_children_paint(context, item.phase);
+            break;
+        case Item::Type::AfterChildrenPaint:
+            item.node->after_children_paint(context, item.phase);
+            break;
+        case Item::Type::StackingContext:
+            item.stacking_context->paint(context);
+            break;
+        }
+    }
+}
+
+}
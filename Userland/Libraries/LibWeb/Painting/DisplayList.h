@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGfx/Rect.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/Layout/Node.h>
+
+namespace Web::Layout {
+
+// A recording of the paint calls for one stacking context, in painting order.
+// Replaying it skips every call whose output can't reach the painter's clip rect.
+class DisplayList {
+public:
+    void append_paint(Node&, PaintPhase);
+    void append_paint_if_focused(Node&, PaintPhase);
+    void append_before_children_paint(Node&, PaintPhase);
+    void append_after_children_paint(Node&, PaintPhase);
+    void append_stacking_context(StackingContext&);
+
+    void clear() { m_items.clear(); }
+
+    void replay(PaintContext&) const;
+
+private:
+    struct Item {
+        enum class Type {
+            Paint,
+            PaintIfFocused,
+            BeforeChildrenPaint,
+            AfterChildrenPaint,
+            StackingContext,
+        };
+
+        Type type;
+        Node* node { nullptr };
+        StackingContext* stacking_context { nullptr };
+        PaintPhase phase { PaintPhase::Background };
+
+        // The part of the page this item may paint into, or nothing if it always has to be replayed.
+        Optional<Gfx::IntRect> rect;
+    };
+
+    Vector<Item> m_items;
+};
+
+}
@@ -29,74 +29,93 @@ StackingContext::StackingContext(Box& box, StackingContext* parent)
     }
 }
 
-void StackingContext::paint_descendants(PaintContext& context, Node& box, StackingContextPaintPhase phase)
+void StackingContext::record_descendants(Node& box, StackingContextPaintPhase phase)
 {
     box.for_each_child([&](auto& child) {
         switch (phase) {
         case StackingContextPaintPhase::BackgroundAndBorders:
             if (!child.is_floating() && !child.is_positioned()) {
-                child.paint(context, PaintPhase::Background);
-                child.paint(context, PaintPhase::Border);
-                paint_descendants(context, child, phase);
+                m_display_list.append_paint(child, PaintPhase::Background);
+                m_display_list.append_paint(child, PaintPhase::Border);
+                record_descendants(child, phase);
             }
             break;
         case StackingContextPaintPhase::Floats:
             if (!child.is_positioned()) {
                 if (child.is_floating()) {
-                    child.paint(context, PaintPhase::Background);
-                    child.paint(context, PaintPhase::Border);
-                    paint_descendants(context, child, StackingContextPaintPhase::BackgroundAndBorders);
+                    m_display_list.append_paint(child, PaintPhase::Background);
+                    m_display_list.append_paint(child, PaintPhase::Border);
+                    record_descendants(child, StackingContextPaintPhase::BackgroundAndBorders);
                 }
-                paint_descendants(context, child, phase);
+                record_descendants(child, phase);
             }
             break;
         case StackingContextPaintPhase::Foreground:
             if (!child.is_positioned()) {
-                child.paint(context, PaintPhase::Foreground);
-                child.before_children_paint(context, PaintPhase::Foreground);
-                paint_descendants(context, child, phase);
-                child.after_children_paint(context, PaintPhase::Foreground);
+                m_display_list.append_paint(child, PaintPhase::Foreground);
+                m_display_list.append_before_children_paint(child, PaintPhase::Foreground);
+                record_descendants(child, phase);
+                m_display_list.append_after_children_paint(child, PaintPhase::Foreground);
             }
             break;
         case StackingContextPaintPhase::FocusAndOverlay:
-            if (context.has_focus()) {
-                child.paint(context, PaintPhase::FocusOutline);
-            }
-            child.paint(context, PaintPhase::Overlay);
-            paint_descendants(context, child, phase);
+            m_display_list.append_paint_if_focused(child, PaintPhase::FocusOutline);
+            m_display_list.append_paint(child, PaintPhase::Overlay);
+            record_descendants(child, phase);
             break;
         }
     });
 }
 
-void StackingContext::paint(PaintContext& context)
+void StackingContext::record_display_list()
 {
+    m_display_list.clear();
+
     // For a more elaborate description of the algorithm, see CSS 2.1 Appendix E
     // Draw the background and borders for the context root (steps 1, 2)
-    m_box.paint(context, PaintPhase::Background);
-    m_box.paint(context, PaintPhase::Border);
+    m_display_list.append_paint(m_box, PaintPhase::Background);
+    m_display_list.append_paint(m_box, PaintPhase::Border);
     // Draw positioned descendants with negative z-indices (step 3)
     for (auto* child : m_children) {
         if (child->m_box.computed_values().z_index().has_value() && child->m_box.computed_values().z_index().value() < 0)
-            child->paint(context);
+            m_display_list.append_stacking_context(*child);
     }
     // Draw the background and borders for block-level children (step 4)
-    paint_descendants(context, m_box, StackingContextPaintPhase::BackgroundAndBorders);
+    record_descendants(m_box, StackingContextPaintPhase::BackgroundAndBorders);
     // Draw the non-positioned floats (step 5)
-    paint_descendants(context, m_box, StackingContextPaintPhase::Floats);
+    record_descendants(m_box, StackingContextPaintPhase::Floats);
     // Draw inline content, replaced content, etc. (steps 6, 7)
-    m_box.paint(context, PaintPhase::Foreground);
-    paint_descendants(context, m_box, StackingContextPaintPhase::Foreground);
+    m_display_list.append_paint(m_box, PaintPhase::Foreground);
+    record_descendants(m_box, StackingContextPaintPhase::Foreground);
     // Draw other positioned descendants (steps 8, 9)
     for (auto* child : m_children) {
         if (child->m_box.computed_values().z_index().has_value() && child->m_box.computed_values().z_index().value() < 0)
             continue;
-        child->paint(context);
+        m_display_list.append_stacking_context(*child);
     }
 
-    m_box.paint(context, PaintPhase::FocusOutline);
-    m_box.paint(context, PaintPhase::Overlay);
-    paint_descendants(context, m_box, StackingContextPaintPhase::FocusAndOverlay);
+    m_display_list.append_paint(m_box, PaintPhase::FocusOutline);
+    m_display_list.append_paint(m_box, PaintPhase::Overlay);
+    record_descendants(m_box, StackingContextPaintPhase::FocusAndOverlay);
+
+    m_display_list_is_valid = true;
+}
+
+void StackingContext::paint(PaintContext& context)
+{
+    // The display list only depends on the layout tree, so it is recorded once and replayed for
+    // every repaint, skipping whatever lies outside of the area being painted.
+    if (!m_display_list_is_valid)
+        record_display_list();
+    m_display_list.replay(context);
+}
+
+void StackingContext::invalidate_display_list()
+{
+    m_display_list_is_valid = false;
+    m_display_list.clear();
+    for (auto* child : m_children)
+        child->invalidate_display_list();
 }
 
 HitTestResult StackingContext::hit_test(const Gfx::IntPoint& position, HitTestType type) const
@@ -124,6 +143,18 @@ HitTestResult StackingContext::hit_test(const Gfx::IntPoint& position, HitTestTy
     return result;
 }
 
+bool StackingContext::contains_fixed_position_box() const
+{
+    // Fixed position boxes always establish a stacking context, so there's no need to look at the layout tree.
+    if (m_box.is_fixed_position())
+        return true;
+    for (auto* child : m_children) {
+        if (child->contains_fixed_position_box())
+            return true;
+    }
+    return false;
+}
+
 void StackingContext::dump(int indent) const
 {
     StringBuilder builder;
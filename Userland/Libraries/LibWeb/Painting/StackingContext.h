@@ -8,6 +8,7 @@
 
 #include <AK/Vector.h>
 #include <LibWeb/Layout/Node.h>
+#include <LibWeb/Painting/DisplayList.h>
 
 namespace Web::Layout {
 
@@ -25,16 +26,26 @@ public:
         FocusAndOverlay,
     };
 
-    void paint_descendants(PaintContext&, Node&, StackingContextPaintPhase);
     void paint(PaintContext&);
+
+    // Must be called whenever the layout tree or its geometry changes, as the recorded display lists point into it.
+    void invalidate_display_list();
     HitTestResult hit_test(const Gfx::IntPoint&, HitTestType) const;
 
+    bool contains_fixed_position_box() const;
+
     void dump(int indent = 0) const;
 
 private:
+    void record_display_list();
+    void record_descendants(Node&, StackingContextPaintPhase);
+
     Box& m_box;
     StackingContext* const m_parent { nullptr };
     Vector<StackingContext*> m_children;
+
+    DisplayList m_display_list;
+    bool m_display_list_is_valid { false };
 };
 
 }
@@ -23,9 +23,9 @@ void WebContentClient::die()
     on_web_content_process_crash();
 }
 
-void WebContentClient::did_paint(const Gfx::IntRect&, i32 bitmap_id)
+void WebContentClient::did_paint(const Gfx::IntRect& content_rect, const Gfx::IntRect& damage_rect, i32 bitmap_id)
 {
-    m_view.notify_server_did_paint({}, bitmap_id);
+    m_view.notify_server_did_paint({}, bitmap_id, damage_rect.translated(-content_rect.location()));
 }
 
 void WebContentClient::did_finish_loading(URL const& url)
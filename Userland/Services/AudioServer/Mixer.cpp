@@ -4,13 +4,13 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/Array.h>
-#include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
 #include <AudioServer/ClientConnection.h>
 #include <AudioServer/Mixer.h>
 #include <pthread.h>
-#include <strings.h>
+#include <string.h>
+#include <sys/ioctl.h>
 
 namespace AudioServer {
 
@@ -28,11 +28,13 @@ Mixer::Mixer()
         return;
     }
 
+    // Every frame is a 16-bit sample for each of the two channels.
+    if (ioctl(m_device->fd(), SOUNDCARD_IOCTL_SET_PERIOD_SIZE, period_frame_count * 2 * sizeof(i16)) < 0)
+        dbgln("Can't set the period size of the audio device: {}", strerror(errno));
+
     pthread_mutex_init(&m_pending_mutex, nullptr);
     pthread_cond_init(&m_pending_cond, nullptr);
 
-    m_zero_filled_buffer = (u8*)malloc(4096);
-    bzero(m_zero_filled_buffer, 4096);
     m_sound_thread->start();
 }
 
@@ -51,6 +53,39 @@ NonnullRefPtr<BufferQueue> Mixer::create_queue(ClientConnection& client)
     return queue;
 }
 
+using AK::SIMD::f32x4;
+using AK::SIMD::i16x4;
+using AK::SIMD::i32x4;
+
+ALWAYS_INLINE static f32x4 clamp(f32x4 value, f32x4 low, f32x4 high)
+{
+    // The comparisons give all ones for the lanes where they're true, which picks the bound instead of the value.
+    auto below = value < low;
+    auto above = value > high;
+    auto bits = (i32x4)value;
+    bits = (bits & ~below) | ((i32x4)low & below);
+    bits = (bits & ~above) | ((i32x4)high & above);
+    return (f32x4)bits;
+}
+
+// Scales the mixed samples by the volume, clips them, and turns them into the 16-bit samples that the device takes.
+static void convert_to_pcm(const float* mix, i16* pcm, size_t sample_count, float volume)
+{
+    static_assert(Mixer::period_frame_count * 2 % 4 == 0);
+    float scale = volume * NumericLimits<i16>::max();
+    float limit = NumericLimits<i16>::max();
+    f32x4 scale4 = { scale, scale, scale, scale };
+    f32x4 low = { -limit, -limit, -limit, -limit };
+    f32x4 high = { limit, limit, limit, limit };
+    for (size_t i = 0; i < sample_count; i += 4) {
+        f32x4 samples;
+        memcpy(&samples, mix + i, sizeof(samples));
+        samples = clamp(samples * scale4, low, high);
+        auto result = __builtin_convertvector(__builtin_convertvector(samples, i32x4), i16x4);
+        memcpy(pcm + i, &result, sizeof(result));
+    }
+}
+
 void Mixer::mix()
 {
     decltype(m_pending_mixing) active_mix_queues;
@@ -66,8 +101,8 @@ void Mixer::mix()
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->client(); });
 
-        Audio::Frame mixed_buffer[1024];
-        auto mixed_buffer_length = (int)(sizeof(mixed_buffer) / sizeof(Audio::Frame));
+        constexpr size_t sample_count = period_frame_count * 2;
+        float mixed_buffer[sample_count] {};
 
         // Mix the buffers together into the output
         for (auto& queue : active_mix_queues) {
@@ -75,40 +110,15 @@ void Mixer::mix()
                 queue->clear();
                 continue;
             }
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-                Audio::Frame sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                mixed_sample += sample;
-            }
+            queue->mix_into(mixed_buffer, period_frame_count);
         }
 
-        if (m_muted) {
-            m_device->write(m_zero_filled_buffer, 4096);
-        } else {
-            Array<u8, 4096> buffer;
-            OutputMemoryStream stream { buffer };
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-
-                mixed_sample.scale(m_main_volume);
-                mixed_sample.clip();
-
-                LittleEndian<i16> out_sample;
-                out_sample = mixed_sample.left * NumericLimits<i16>::max();
-                stream << out_sample;
-
-                out_sample = mixed_sample.right * NumericLimits<i16>::max();
-                stream << out_sample;
-            }
+        // NOTE: The queues keep playing while muted, they just aren't heard.
+        i16 pcm_buffer[sample_count];
+        convert_to_pcm(mixed_buffer, pcm_buffer, sample_count, m_muted ? 0 : m_main_volume / 100.0f);
 
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), stream.size());
-        }
+        // This blocks until the device is done with the period before last, which is when the next one is due.
+        m_device->write((const u8*)pcm_buffer, sizeof(pcm_buffer));
     }
 }
 
@@ -140,9 +150,64 @@ BufferQueue::BufferQueue(ClientConnection& client)
 {
 }
 
+size_t BufferQueue::mix_into(float* mix, size_t frame_count)
+{
+    if (m_paused)
+        return 0;
+
+    auto discard_before = m_discard_before.load(AK::MemoryOrder::memory_order_acquire);
+    if (m_current && m_current_index < discard_before) {
+        m_current = nullptr;
+        m_position = 0;
+    }
+
+    size_t mixed_frame_count = 0;
+    while (mixed_frame_count < frame_count) {
+        while (!m_current) {
+            auto buffer = m_queue.try_dequeue();
+            if (!buffer.has_value())
+                break;
+            auto index = m_dequeued_buffers++;
+            if (index < discard_before)
+                continue;
+            m_current = buffer.release_value();
+            m_current_index = index;
+            m_playing_buffer_id = m_current->id();
+        }
+
+        if (!m_current)
+            break;
+
+        auto count = min(frame_count - mixed_frame_count, (size_t)(m_current->sample_count() - m_position));
+        auto* frames = m_current->samples() + m_position;
+        auto* out = mix + mixed_frame_count * 2;
+        for (size_t i = 0; i < count; ++i) {
+            out[i * 2] += (float)frames[i].left;
+            out[i * 2 + 1] += (float)frames[i].right;
+        }
+        m_position += count;
+        mixed_frame_count += count;
+
+        if (m_position >= m_current->sample_count()) {
+            m_client->did_finish_playing_buffer({}, m_current->id());
+            m_current = nullptr;
+            m_position = 0;
+            m_playing_buffer_id = -1;
+        }
+    }
+
+    // The client asks for these a lot less often than we mix, so they're only updated once per period.
+    m_remaining_samples -= mixed_frame_count;
+    m_played_samples += mixed_frame_count;
+    return mixed_frame_count;
+}
+
 void BufferQueue::enqueue(NonnullRefPtr<Audio::Buffer>&& buffer)
 {
     m_remaining_samples += buffer->sample_count();
-    m_queue.enqueue(move(buffer));
+    // NOTE: The client checks is_full() first, and the ring has room for one more than that.
+    auto enqueued = m_queue.try_enqueue(move(buffer));
+    VERIFY(enqueued);
+    ++m_enqueued_buffers;
 }
 }
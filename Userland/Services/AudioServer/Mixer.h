@@ -11,8 +11,8 @@
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullRefPtrVector.h>
-#include <AK/Queue.h>
 #include <AK/RefCounted.h>
+#include <AK/SPSCRing.h>
 #include <AK/WeakPtr.h>
 #include <LibAudio/Buffer.h>
 #include <LibCore/File.h>
@@ -23,6 +23,10 @@ namespace AudioServer {
 
 class ClientConnection;
 
+// The client's connection thread enqueues buffers, and the mixer thread plays them back.
+// NOTE: Since there is exactly one of each, the buffers are handed over through an SPSCRing, and the mixer thread
+//       never has to wait for the client. Only the mixer thread ever dequeues, so clear() just tells it which
+//       buffers to throw away instead of touching the ring itself.
 class BufferQueue : public RefCounted<BufferQueue> {
 public:
     explicit BufferQueue(ClientConnection&);
@@ -31,38 +35,18 @@ public:
     bool is_full() const { return m_queue.size() >= 3; }
     void enqueue(NonnullRefPtr<Audio::Buffer>&&);
 
-    bool get_next_sample(Audio::Frame& sample)
-    {
-        if (m_paused)
-            return false;
-
-        while (!m_current && !m_queue.is_empty())
-            m_current = m_queue.dequeue();
-
-        if (!m_current)
-            return false;
-
-        sample = m_current->samples()[m_position++];
-        --m_remaining_samples;
-        ++m_played_samples;
-
-        if (m_position >= m_current->sample_count()) {
-            m_client->did_finish_playing_buffer({}, m_current->id());
-            m_current = nullptr;
-            m_position = 0;
-        }
-        return true;
-    }
+    // Called on the mixer thread. Adds up to frame_count frames to the mix, which holds interleaved left and right
+    // samples, and returns how many frames there were.
+    size_t mix_into(float* mix, size_t frame_count);
 
     ClientConnection* client() { return m_client.ptr(); }
 
     void clear(bool paused = false)
     {
-        m_queue.clear();
-        m_position = 0;
+        m_discard_before.store(m_enqueued_buffers, AK::MemoryOrder::memory_order_release);
         m_remaining_samples = 0;
         m_played_samples = 0;
-        m_current = nullptr;
+        m_playing_buffer_id = -1;
         m_paused = paused;
     }
 
@@ -71,28 +55,40 @@ public:
         m_paused = paused;
     }
 
-    int get_remaining_samples() const { return m_remaining_samples; }
+    // NOTE: The mixer thread may still be finishing a buffer that was just cleared, so don't go below zero.
+    int get_remaining_samples() const { return max(0, m_remaining_samples.load()); }
     int get_played_samples() const { return m_played_samples; }
-    int get_playing_buffer() const
-    {
-        if (m_current)
-            return m_current->id();
-        return -1;
-    }
+    int get_playing_buffer() const { return m_playing_buffer_id; }
 
 private:
+    SPSCRing<NonnullRefPtr<Audio::Buffer>, 4> m_queue;
+
+    // Only touched by the client's thread.
+    u64 m_enqueued_buffers { 0 };
+
+    // Only touched by the mixer thread.
     RefPtr<Audio::Buffer> m_current;
-    Queue<NonnullRefPtr<Audio::Buffer>> m_queue;
+    u64 m_current_index { 0 };
+    u64 m_dequeued_buffers { 0 };
     int m_position { 0 };
-    int m_remaining_samples { 0 };
-    int m_played_samples { 0 };
-    bool m_paused { false };
+
+    // Buffers enqueued before this one have been cleared.
+    Atomic<u64> m_discard_before { 0 };
+    Atomic<int> m_remaining_samples { 0 };
+    Atomic<int> m_played_samples { 0 };
+    Atomic<int> m_playing_buffer_id { -1 };
+    Atomic<bool> m_paused { false };
     WeakPtr<ClientConnection> m_client;
 };
 
 class Mixer : public Core::Object {
     C_OBJECT(Mixer)
 public:
+    // How many frames the mixer hands to the device at a time. The device holds two of these, and the mixer thread
+    // blocks until it has room for another, so this is what the latency of the output comes down to:
+    // 256 frames at 44.1 kHz are 5.8 ms.
+    static constexpr size_t period_frame_count = 256;
+
     Mixer();
     virtual ~Mixer() override;
 
@@ -117,8 +113,6 @@ private:
     bool m_muted { false };
     int m_main_volume { 100 };
 
-    u8* m_zero_filled_buffer { nullptr };
-
     void mix();
 };
 }
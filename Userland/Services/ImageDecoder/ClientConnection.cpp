@@ -30,7 +30,7 @@ void ClientConnection::die()
     exit(0);
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer, Gfx::IntSize const& ideal_size)
 {
     if (!encoded_buffer.is_valid()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
@@ -38,10 +38,12 @@ Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image
     }
 
     auto decoder = Gfx::ImageDecoder::create(encoded_buffer.data<u8>(), encoded_buffer.size());
+    if (!ideal_size.is_empty())
+        decoder->set_ideal_size(ideal_size);
 
     if (!decoder->frame_count()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
-        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+        return { false, 0, Gfx::IntSize {}, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
     }
 
     Vector<Gfx::ShareableBitmap> bitmaps;
@@ -62,7 +64,20 @@ Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image
         durations.append(frame.duration);
     }
 
-    return { decoder->is_animated(), static_cast<u32>(decoder->loop_count()), bitmaps, durations };
+    // NOTE: The bitmaps may be smaller than this if an ideal size was given.
+    return { decoder->is_animated(), static_cast<u32>(decoder->loop_count()), decoder->size(), bitmaps, durations };
+}
+
+void ClientConnection::decode_thumbnail(i32 request_id, Core::AnonymousBuffer const& encoded_buffer, Gfx::IntSize const& size)
+{
+    RefPtr<Gfx::Bitmap> thumbnail;
+    if (encoded_buffer.is_valid() && !size.is_empty()) {
+        auto decoder = Gfx::ImageDecoder::create(encoded_buffer.data<u8>(), encoded_buffer.size());
+        thumbnail = decoder->create_thumbnail(size);
+    }
+    if (!thumbnail)
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode thumbnail from encoded data");
+    async_did_decode_thumbnail(request_id, thumbnail ? thumbnail->to_shareable_bitmap() : Gfx::ShareableBitmap {});
 }
 
 }
@@ -26,7 +26,8 @@ public:
     virtual void die() override;
 
 private:
-    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&) override;
+    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Gfx::IntSize const&) override;
+    virtual void decode_thumbnail(i32, Core::AnonymousBuffer const&, Gfx::IntSize const&) override;
 };
 
 }
@@ -7,12 +7,13 @@
 #include <ImageDecoder/ClientConnection.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibGfx/ImageDecoder.h>
 #include <LibIPC/ClientConnection.h>
 
 int main(int, char**)
 {
     Core::EventLoop event_loop;
-    if (pledge("stdio recvfd sendfd unix", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd unix thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -21,9 +22,11 @@ int main(int, char**)
         return 1;
     }
 
+    Gfx::ImageDecoder::set_may_decode_in_parallel(true);
+
     auto socket = Core::LocalSocket::take_over_accepted_socket_from_system_server();
     IPC::new_client_connection<ImageDecoder::ClientConnection>(socket.release_nonnull(), 1);
-    if (pledge("stdio recvfd sendfd", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -55,4 +55,27 @@ Messages::LookupServer::LookupAddressResponse ClientConnection::lookup_address(S
         return { 1, String() };
     return { 0, answers[0].record_data() };
 }
+
+Messages::LookupServer::LookupNamesResponse ClientConnection::lookup_names(Vector<String> const& names)
+{
+    Vector<DNSName> dns_names;
+    dns_names.ensure_capacity(names.size());
+    for (auto& name : names)
+        dns_names.unchecked_append(DNSName(name));
+
+    auto results = LookupServer::the().lookup(dns_names, DNSRecordType::A);
+
+    Vector<i32> codes;
+    Vector<Vector<String>> addresses;
+    codes.ensure_capacity(results.size());
+    addresses.ensure_capacity(results.size());
+    for (auto& answers : results) {
+        codes.unchecked_append(answers.is_empty() ? 1 : 0);
+        Vector<String> addresses_for_name;
+        for (auto& answer : answers)
+            addresses_for_name.append(answer.record_data());
+        addresses.unchecked_append(move(addresses_for_name));
+    }
+    return { move(codes), move(addresses) };
+}
 }
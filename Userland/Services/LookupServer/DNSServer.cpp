@@ -16,24 +16,37 @@ DNSServer::DNSServer(Object* parent)
 {
     bind(IPv4Address(), 53);
     on_ready_to_receive = [this]() {
-        handle_client();
+        handle_clients();
     };
 }
 
-void DNSServer::handle_client()
+void DNSServer::handle_clients()
+{
+    // Answer everything that's waiting at once, so a burst of queries doesn't cost two syscalls per query.
+    constexpr size_t max_requests_at_once = 32;
+    auto requests = receive_many(max_requests_at_once, 1024);
+    Vector<Datagram> responses;
+    for (auto& request : requests) {
+        auto response = handle_request(request.data);
+        if (response.has_value())
+            responses.append({ response.release_value(), request.address });
+    }
+    if (!responses.is_empty())
+        send_many(responses);
+}
+
+Optional<ByteBuffer> DNSServer::handle_request(ReadonlyBytes buffer)
 {
-    sockaddr_in client_address;
-    auto buffer = receive(1024, client_address);
     auto optional_request = DNSPacket::from_raw_packet(buffer.data(), buffer.size());
     if (!optional_request.has_value()) {
         dbgln("Got an invalid DNS packet");
-        return;
+        return {};
     }
     auto& request = optional_request.value();
 
     if (!request.is_query()) {
         dbgln("It's not a request");
-        return;
+        return {};
     }
 
     LookupServer& lookup_server = LookupServer::the();
@@ -57,8 +70,7 @@ void DNSServer::handle_client()
     else
         response.set_code(DNSPacket::Code::NOERROR);
 
-    buffer = response.to_byte_buffer();
-    sendto(fd(), buffer.data(), buffer.size(), 0, (const sockaddr*)&client_address, sizeof(client_address));
+    return response.to_byte_buffer();
 }
 
 }
@@ -16,7 +16,8 @@ class DNSServer : public Core::UDPServer {
 private:
     explicit DNSServer(Object* parent = nullptr);
 
-    void handle_client();
+    void handle_clients();
+    Optional<ByteBuffer> handle_request(ReadonlyBytes);
 };
 
 }
@@ -27,6 +27,8 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+// NOTE: This is how long we remember that a name has no records of some type.
+static constexpr time_t s_negative_ttl = 60;
 
 LookupServer& LookupServer::the()
 {
@@ -149,28 +151,27 @@ static String get_hostname()
     return buffer;
 }
 
-Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record_type)
+static DNSAnswer with_name(const DNSName& name, const DNSAnswer& answer)
 {
-    dbgln_if(LOOKUPSERVER_DEBUG, "Got request for '{}'", name.as_string());
+    return {
+        name,
+        answer.type(),
+        answer.class_code(),
+        answer.ttl(),
+        answer.record_data(),
+        answer.mdns_cache_flush(),
+    };
+}
 
+Optional<Vector<DNSAnswer>> LookupServer::lookup_without_asking_nameservers(const DNSName& name, DNSRecordType record_type)
+{
     Vector<DNSAnswer> answers;
-    auto add_answer = [&](const DNSAnswer& answer) {
-        DNSAnswer answer_with_original_case {
-            name,
-            answer.type(),
-            answer.class_code(),
-            answer.ttl(),
-            answer.record_data(),
-            answer.mdns_cache_flush(),
-        };
-        answers.append(answer_with_original_case);
-    };
 
     // First, try /etc/hosts.
     if (auto local_answers = m_etc_hosts.get(name); local_answers.has_value()) {
         for (auto& answer : local_answers.value()) {
             if (answer.type() == record_type)
-                add_answer(answer);
+                answers.append(with_name(name, answer));
         }
         if (!answers.is_empty())
             return answers;
@@ -187,40 +188,67 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.get(name); cached_answers.has_value()) {
-        for (auto& answer : cached_answers.value()) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
+    if (auto it = m_lookup_cache.find(name); it != m_lookup_cache.end()) {
+        it->value.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+        for (auto& answer : it->value) {
+            if (answer.type() == record_type) {
                 dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
+                answers.append(with_name(name, answer));
             }
         }
+        if (it->value.is_empty())
+            m_lookup_cache.remove(it);
         if (!answers.is_empty())
             return answers;
     }
 
-    // Fourth, look up .local names using mDNS instead of DNS nameservers.
+    // Fourth, see if we were told recently that there's nothing to find.
+    if (auto it = m_negative_lookup_cache.find(name); it != m_negative_lookup_cache.end()) {
+        auto now = time(nullptr);
+        it->value.remove_all_matching([&](auto& negative_answer) { return negative_answer.expiry_time <= now; });
+        bool is_known_to_not_exist = it->value.first_matching([&](auto& negative_answer) { return negative_answer.record_type == record_type; }).has_value();
+        if (it->value.is_empty())
+            m_negative_lookup_cache.remove(it);
+        if (is_known_to_not_exist) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Negative cache hit: {}", name.as_string());
+            return answers;
+        }
+    }
+
+    return {};
+}
+
+Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record_type)
+{
+    dbgln_if(LOOKUPSERVER_DEBUG, "Got request for '{}'", name.as_string());
+
+    if (auto answers = lookup_without_asking_nameservers(name, record_type); answers.has_value())
+        return answers.release_value();
+
+    // Fifth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local")) {
-        answers = m_mdns->lookup(name, record_type);
+        auto answers = m_mdns->lookup(name, record_type);
         for (auto& answer : answers)
             put_in_cache(answer);
         return answers;
     }
 
-    // Fifth, ask the upstream nameservers.
+    // Sixth, ask the upstream nameservers.
+    Vector<DNSAnswer> answers;
+    bool did_get_negative_answer = false;
     for (auto& nameserver : m_nameservers) {
         dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
         bool did_get_response = false;
         int retries = 3;
         Vector<DNSAnswer> upstream_answers;
         do {
-            upstream_answers = lookup(name, nameserver, did_get_response, record_type);
+            upstream_answers = lookup(name, nameserver, did_get_response, did_get_negative_answer, record_type);
             if (did_get_response)
                 break;
         } while (--retries);
         if (!upstream_answers.is_empty()) {
             for (auto& answer : upstream_answers)
-                add_answer(answer);
+                answers.append(with_name(name, answer));
             break;
         } else {
             if (!did_get_response)
@@ -230,16 +258,120 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
         }
     }
 
-    // Sixth, fail.
+    // Seventh, fail.
     if (answers.is_empty()) {
         dbgln("Tried all nameservers but never got a response :(");
+        if (did_get_negative_answer)
+            put_in_negative_cache(name, record_type);
         return {};
     }
 
     return answers;
 }
 
-Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
+Vector<Vector<DNSAnswer>> LookupServer::lookup(const Vector<DNSName>& names, DNSRecordType record_type)
+{
+    dbgln_if(LOOKUPSERVER_DEBUG, "Got request for {} names", names.size());
+
+    Vector<Vector<DNSAnswer>> results;
+    results.resize(names.size());
+    Vector<bool> is_resolved;
+    is_resolved.resize(names.size());
+
+    Vector<size_t> indices_to_ask_about;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (auto answers = lookup_without_asking_nameservers(names[i], record_type); answers.has_value()) {
+            results[i] = answers.release_value();
+            is_resolved[i] = true;
+        } else if (!names[i].as_string().ends_with(".local")) {
+            indices_to_ask_about.append(i);
+        }
+    }
+
+    // Rather than waiting for every answer before sending the next query, send them all at once.
+    // Whatever doesn't come back gets another chance (with retries and the other nameservers) below.
+    if (indices_to_ask_about.size() > 1 && !m_nameservers.is_empty())
+        lookup_in_one_go(names, indices_to_ask_about, m_nameservers.first(), record_type, results, is_resolved);
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (!is_resolved[i])
+            results[i] = lookup(names[i], record_type);
+    }
+    return results;
+}
+
+void LookupServer::lookup_in_one_go(const Vector<DNSName>& names, const Vector<size_t>& indices, const String& nameserver, DNSRecordType record_type, Vector<Vector<DNSAnswer>>& results, Vector<bool>& is_resolved)
+{
+    auto udp_socket = Core::UDPSocket::construct();
+    udp_socket->set_blocking(true);
+
+    struct timeval timeout {
+        1, 0
+    };
+
+    int rc = setsockopt(udp_socket->fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (rc < 0) {
+        perror("setsockopt(SOL_SOCKET, SO_RCVTIMEO)");
+        return;
+    }
+
+    if (!udp_socket->connect(nameserver, 53))
+        return;
+
+    struct PendingQuery {
+        size_t index;
+        DNSPacket request;
+    };
+    HashMap<u16, PendingQuery> pending_queries;
+
+    for (auto index : indices) {
+        DNSPacket request;
+        request.set_is_query();
+        u16 id;
+        do {
+            id = get_random_uniform(UINT16_MAX);
+        } while (pending_queries.contains(id));
+        request.set_id(id);
+        DNSName name_in_question = names[index];
+        name_in_question.randomize_case();
+        request.add_question({ name_in_question, record_type, DNSRecordClass::IN, false });
+
+        if (!udp_socket->write(request.to_byte_buffer()))
+            break;
+        pending_queries.set(id, { index, move(request) });
+    }
+
+    while (!pending_queries.is_empty()) {
+        u8 response_buffer[4096];
+        int nrecv = udp_socket->read(response_buffer, sizeof(response_buffer));
+        if (nrecv <= 0)
+            break;
+
+        auto response = DNSPacket::from_raw_packet(response_buffer, nrecv);
+        if (!response.has_value())
+            continue;
+
+        auto it = pending_queries.find(response->id());
+        if (it == pending_queries.end()) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "LookupServer: Response with unknown ID {}", response->id());
+            continue;
+        }
+
+        auto index = it->value.index;
+        auto answers = answers_from_response(it->value.request, response.value(), record_type);
+        pending_queries.remove(it);
+        if (!answers.has_value())
+            continue;
+
+        if (answers->is_empty())
+            put_in_negative_cache(names[index], record_type);
+        for (auto& answer : answers.value())
+            results[index].append(with_name(names[index], answer));
+        is_resolved[index] = true;
+    }
+}
+
+Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& nameserver, bool& did_get_response, bool& did_get_negative_answer, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
 {
     DNSPacket request;
     request.set_is_query();
@@ -291,11 +423,30 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
     if (response.code() == DNSPacket::Code::REFUSED) {
         if (should_randomize_case == ShouldRandomizeCase::Yes) {
             // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
+            return lookup(name, nameserver, did_get_response, did_get_negative_answer, record_type, ShouldRandomizeCase::No);
         }
         return {};
     }
 
+    auto answers = answers_from_response(request, response, record_type);
+    if (!answers.has_value())
+        return {};
+    if (answers->is_empty())
+        did_get_negative_answer = true;
+    return answers.release_value();
+}
+
+// Returns the answers of the type we asked for, or an empty Vector if the nameserver told us there aren't any.
+// If the response doesn't tell us either way, returns an empty Optional.
+Optional<Vector<DNSAnswer>> LookupServer::answers_from_response(const DNSPacket& request, const DNSPacket& response, DNSRecordType record_type)
+{
+    if (response.code() == DNSPacket::Code::NXDOMAIN) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "LookupServer: No such name");
+        return Vector<DNSAnswer> {};
+    }
+    if (response.code() != DNSPacket::Code::NOERROR)
+        return {};
+
     if (response.question_count() != request.question_count()) {
         dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
         return {};
@@ -316,12 +467,10 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
         }
     }
 
-    if (response.answer_count() < 1) {
+    if (response.answer_count() < 1)
         dbgln("LookupServer: No answers :(");
-        return {};
-    }
 
-    Vector<DNSAnswer, 8> answers;
+    Vector<DNSAnswer> answers;
     for (auto& answer : response.answers()) {
         put_in_cache(answer);
         if (answer.type() != record_type)
@@ -332,6 +481,23 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
     return answers;
 }
 
+void LookupServer::put_in_negative_cache(const DNSName& name, DNSRecordType record_type)
+{
+    // Prevent the cache from growing too big.
+    if (m_negative_lookup_cache.size() >= 256)
+        m_negative_lookup_cache.remove(m_negative_lookup_cache.begin());
+
+    // FIXME: This should use the TTL from the SOA record in the authority section, but we don't parse that yet.
+    NegativeAnswer negative_answer { record_type, time(nullptr) + s_negative_ttl };
+    auto it = m_negative_lookup_cache.find(name);
+    if (it == m_negative_lookup_cache.end()) {
+        m_negative_lookup_cache.set(name, { negative_answer });
+        return;
+    }
+    it->value.remove_all_matching([&](auto& other) { return other.record_type == record_type; });
+    it->value.append(negative_answer);
+}
+
 void LookupServer::put_in_cache(const DNSAnswer& answer)
 {
     if (answer.has_expired())
@@ -342,6 +508,13 @@ void LookupServer::put_in_cache(const DNSAnswer& answer)
     if (m_lookup_cache.size() >= 256)
         m_lookup_cache.remove(m_lookup_cache.begin());
 
+    // Whatever we thought didn't exist, does now.
+    if (auto negative_it = m_negative_lookup_cache.find(answer.name()); negative_it != m_negative_lookup_cache.end()) {
+        negative_it->value.remove_all_matching([&](auto& negative_answer) { return negative_answer.record_type == answer.type(); });
+        if (negative_it->value.is_empty())
+            m_negative_lookup_cache.remove(negative_it);
+    }
+
     auto it = m_lookup_cache.find(answer.name());
     if (it == m_lookup_cache.end())
         m_lookup_cache.set(answer.name(), { answer });
@@ -23,14 +23,27 @@ class LookupServer final : public Core::Object {
 public:
     static LookupServer& the();
     Vector<DNSAnswer> lookup(const DNSName& name, DNSRecordType record_type);
+    // Looks up all the names at once, sending all the queries to the nameserver before waiting for any answers.
+    Vector<Vector<DNSAnswer>> lookup(const Vector<DNSName>& names, DNSRecordType record_type);
 
 private:
     LookupServer();
 
     void load_etc_hosts();
     void put_in_cache(const DNSAnswer&);
+    void put_in_negative_cache(const DNSName&, DNSRecordType);
 
-    Vector<DNSAnswer> lookup(const DNSName& hostname, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    // Returns an empty Optional if we have to ask a nameserver, and an empty Vector if we know there's no answer.
+    Optional<Vector<DNSAnswer>> lookup_without_asking_nameservers(const DNSName& name, DNSRecordType record_type);
+    Vector<DNSAnswer> lookup(const DNSName& hostname, const String& nameserver, bool& did_get_response, bool& did_get_negative_answer, DNSRecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    void lookup_in_one_go(const Vector<DNSName>& names, const Vector<size_t>& indices, const String& nameserver, DNSRecordType record_type, Vector<Vector<DNSAnswer>>& results, Vector<bool>& is_resolved);
+    Optional<Vector<DNSAnswer>> answers_from_response(const DNSPacket& request, const DNSPacket& response, DNSRecordType record_type);
+
+    // Remembers names that don't have any records of a type, so we don't ask for them over and over again.
+    struct NegativeAnswer {
+        DNSRecordType record_type;
+        time_t expiry_time;
+    };
 
     RefPtr<Core::LocalServer> m_local_server;
     RefPtr<DNSServer> m_dns_server;
@@ -39,6 +52,7 @@ private:
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_etc_hosts;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_lookup_cache;
+    HashMap<DNSName, Vector<NegativeAnswer>, DNSName::Traits> m_negative_lookup_cache;
 };
 
 }
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <RequestServer/CachedRequest.h>
+#include <RequestServer/Protocol.h>
+
+namespace RequestServer {
+
+CachedRequest::CachedRequest(ClientConnection& client, NonnullOwnPtr<OutputFileStream>&& output_stream)
+    : Request(client, move(output_stream))
+{
+}
+
+CachedRequest::~CachedRequest()
+{
+    if (m_is_waiting)
+        HttpCache::the().remove_waiter(url(), *this);
+}
+
+OwnPtr<CachedRequest> CachedRequest::create(ClientConnection& client, const URL& url)
+{
+    auto pipe_result = Protocol::get_pipe_for_request();
+    if (pipe_result.is_error())
+        return {};
+
+    auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
+    output_stream->make_unbuffered();
+    auto request = adopt_own(*new CachedRequest(client, move(output_stream)));
+    request->set_url(url);
+    request->set_request_fd(pipe_result.value().read_fd);
+    request->set_write_fd(pipe_result.value().write_fd);
+    return request;
+}
+
+void CachedRequest::serve(HttpCache::Entry& entry)
+{
+    dbgln_if(CACHE_DEBUG, "CachedRequest: Serving {} from the cache", url());
+    m_is_waiting = false;
+    send_cached_response(entry);
+}
+
+void CachedRequest::wait_for_fetch_in_flight()
+{
+    dbgln_if(CACHE_DEBUG, "CachedRequest: Waiting for in-flight fetch of {}", url());
+    m_is_waiting = true;
+    HttpCache::the().add_waiter(url(), *this);
+}
+
+void CachedRequest::fail()
+{
+    m_is_waiting = false;
+
+    // NOTE: This can happen while the request we were waiting for is being destroyed, so finish from the event loop.
+    m_failure_notifier = Core::Notifier::construct(write_fd(), Core::Notifier::Write);
+    m_failure_notifier->on_ready_to_write = [this] {
+        m_failure_notifier->set_enabled(false);
+        did_progress(0, 0);
+        did_finish(false);
+    };
+}
+
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <RequestServer/HttpCache.h>
+#include <RequestServer/Request.h>
+
+namespace RequestServer {
+
+// A request that is answered by the HttpCache rather than by a protocol, either right away or
+// once a fetch of the same URL that is already in flight has finished.
+class CachedRequest final : public Request {
+public:
+    virtual ~CachedRequest() override;
+    static OwnPtr<CachedRequest> create(ClientConnection&, const URL&);
+
+    void serve(HttpCache::Entry&);
+    void wait_for_fetch_in_flight();
+    void fail();
+
+private:
+    CachedRequest(ClientConnection&, NonnullOwnPtr<OutputFileStream>&&);
+
+    bool m_is_waiting { false };
+    RefPtr<Core::Notifier> m_failure_notifier;
+};
+
+}
@@ -5,7 +5,9 @@
  */
 
 #include <AK/Badge.h>
+#include <RequestServer/CachedRequest.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Protocol.h>
 #include <RequestServer/Request.h>
 #include <RequestServer/RequestClientEndpoint.h>
@@ -48,7 +50,9 @@ Messages::RequestServer::StartRequestResponse ClientConnection::start_request(St
         dbgln("StartRequest: No protocol handler for URL: '{}'", url);
         return { -1, Optional<IPC::File> {} };
     }
-    auto request = protocol->start_request(*this, method, url, request_headers.entries(), request_body);
+    auto request = start_cached_request(method, url, request_headers.entries());
+    if (!request)
+        request = protocol->start_request(*this, method, url, request_headers.entries(), request_body);
     if (!request) {
         dbgln("StartRequest: Protocol handler failed to start request: '{}'", url);
         return { -1, Optional<IPC::File> {} };
@@ -59,6 +63,27 @@ Messages::RequestServer::StartRequestResponse ClientConnection::start_request(St
     return { id, IPC::File(fd, IPC::File::CloseAfterSending) };
 }
 
+OwnPtr<Request> ClientConnection::start_cached_request(String const& method, URL const& url, HashMap<String, String> const& request_headers)
+{
+    if (!HttpCache::can_use_cache_for(method, url, request_headers))
+        return {};
+
+    auto& cache = HttpCache::the();
+    auto entry = cache.lookup(url);
+    bool can_serve_entry = entry && entry->is_fresh();
+    if (!can_serve_entry && !cache.has_fetch_in_flight(url))
+        return {};
+
+    auto request = CachedRequest::create(*this, url);
+    if (!request)
+        return {};
+    if (can_serve_entry)
+        request->serve(*entry);
+    else
+        request->wait_for_fetch_in_flight();
+    return request;
+}
+
 Messages::RequestServer::StopRequestResponse ClientConnection::stop_request(i32 request_id)
 {
     auto* request = const_cast<Request*>(m_requests.get(request_id).value_or(nullptr));
@@ -35,6 +35,8 @@ private:
     virtual Messages::RequestServer::StopRequestResponse stop_request(i32) override;
     virtual Messages::RequestServer::SetCertificateResponse set_certificate(i32, String const&, String const&) override;
 
+    OwnPtr<Request> start_cached_request(String const& method, URL const&, HashMap<String, String> const& request_headers);
+
     HashMap<i32, OwnPtr<Request>> m_requests;
 };
 
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/TypeCasts.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibTLS/TLSv12.h>
+#include <RequestServer/ConnectionCache.h>
+
+namespace RequestServer {
+
+ConnectionCache& ConnectionCache::the()
+{
+    static ConnectionCache s_the;
+    return s_the;
+}
+
+String ConnectionCache::origin_key(const URL& url)
+{
+    return String::formatted("{}://{}:{}", url.protocol(), url.host(), url.port());
+}
+
+static bool is_usable(Core::Socket& socket)
+{
+    if (!socket.is_open() || !socket.is_connected() || socket.eof())
+        return false;
+    if (is<TLS::TLSv12>(socket))
+        return static_cast<TLS::TLSv12&>(socket).is_established();
+    // Anything to read on an idle connection means that the server closed it, or sent something we can't use.
+    return !socket.can_read();
+}
+
+void ConnectionCache::start_job(const URL& url, Core::NetworkJob& job, StartFunction start)
+{
+    auto key = origin_key(url);
+    auto& origin = m_origins.ensure(key);
+
+    if (origin.http2_connection && origin.http2_connection->is_usable()) {
+        dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Starting a stream on the HTTP/2 connection to {}", key);
+        start(nullptr, origin.http2_connection);
+        return;
+    }
+
+    // The most recently used connection is the least likely to have been closed by the server.
+    while (!origin.idle_connections.is_empty()) {
+        auto connection = origin.idle_connections.take_last();
+        if (!is_usable(connection.socket))
+            continue;
+        dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Reusing a connection to {}", key);
+        origin.active_jobs.set(&job);
+        start(move(connection.socket), nullptr);
+        return;
+    }
+
+    // If the connection that is being made turns out to be HTTP/2, everything else can go on it as well.
+    bool is_negotiating = url.protocol() == "https" && origin.protocol == Protocol::Unknown && !origin.active_jobs.is_empty();
+    if (!is_negotiating && origin.active_jobs.size() < max_connections_per_origin) {
+        origin.active_jobs.set(&job);
+        start(nullptr, nullptr);
+        return;
+    }
+
+    dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: {} has {} connections in use, queueing the request", key, origin.active_jobs.size());
+    origin.pending_jobs.append({ &job, move(start) });
+}
+
+void ConnectionCache::did_negotiate_protocol(const URL& url, Core::NetworkJob& job, RefPtr<HTTP::Http2Connection> connection)
+{
+    auto key = origin_key(url);
+    auto it = m_origins.find(key);
+    if (it == m_origins.end())
+        return;
+    auto& origin = it->value;
+
+    if (!connection) {
+        origin.protocol = Protocol::Http1;
+        while (!origin.pending_jobs.is_empty() && origin.active_jobs.size() < max_connections_per_origin) {
+            auto next_job = origin.pending_jobs.take_first();
+            origin.active_jobs.set(next_job.job);
+            next_job.start(nullptr, nullptr);
+        }
+        return;
+    }
+
+    dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: {} speaks HTTP/2, {} requests go on the new connection", key, origin.pending_jobs.size());
+    origin.protocol = Protocol::Http2;
+    origin.active_jobs.remove(&job);
+    // Another connection that turned out to be HTTP/2 in the meantime keeps the requests that it carries.
+    if (!origin.http2_connection || !origin.http2_connection->is_usable())
+        set_http2_connection(key, *connection);
+
+    auto pending_jobs = move(origin.pending_jobs);
+    for (auto& pending_job : pending_jobs)
+        pending_job.start(nullptr, connection);
+}
+
+void ConnectionCache::did_finish_job(const URL& url, Core::NetworkJob& job, RefPtr<Core::Socket> socket)
+{
+    auto key = origin_key(url);
+    auto it = m_origins.find(key);
+    if (it == m_origins.end())
+        return;
+    auto& origin = it->value;
+
+    if (origin.pending_jobs.remove_first_matching([&](auto& pending_job) { return pending_job.job == &job; })) {
+        remove_origin_if_unused(key);
+        return;
+    }
+
+    if (!origin.active_jobs.remove(&job))
+        return;
+
+    if (!origin.pending_jobs.is_empty()) {
+        // Whoever has been waiting longest gets the connection, or the slot if there is no connection to give.
+        auto next_job = origin.pending_jobs.take_first();
+        origin.active_jobs.set(next_job.job);
+        next_job.start(move(socket), nullptr);
+        return;
+    }
+
+    if (socket)
+        add_idle_connection(key, socket.release_nonnull());
+    else
+        remove_origin_if_unused(key);
+}
+
+void ConnectionCache::add_idle_connection(const String& key, NonnullRefPtr<Core::Socket> socket)
+{
+    // Whatever an idle connection receives means that it is done for. Drop it once the socket is no longer busy telling us.
+    auto remove_later = [key, &socket = *socket] {
+        socket.deferred_invoke([key](auto& object) {
+            ConnectionCache::the().remove_idle_connection(key, static_cast<Core::Socket&>(object));
+        });
+    };
+    if (is<TLS::TLSv12>(*socket)) {
+        auto& tls_socket = static_cast<TLS::TLSv12&>(*socket);
+        tls_socket.on_tls_ready_to_read = [remove_later](auto&) { remove_later(); };
+        tls_socket.on_tls_finished = [remove_later] { remove_later(); };
+        tls_socket.on_tls_error = [remove_later](auto) { remove_later(); };
+    } else {
+        socket->on_ready_to_read = [remove_later] { remove_later(); };
+    }
+
+    Core::ElapsedTimer idle_time;
+    idle_time.start();
+    m_origins.ensure(key).idle_connections.append({ move(socket), idle_time });
+    start_expiry_timer();
+}
+
+void ConnectionCache::set_http2_connection(const String& key, NonnullRefPtr<HTTP::Http2Connection> connection)
+{
+    // Once the connection can't take more requests, the next one to the origin has to find out anew what the server speaks.
+    connection->on_close = [this, key, &connection = *connection] {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end() || it->value.http2_connection.ptr() != &connection)
+            return;
+        it->value.http2_connection = nullptr;
+        it->value.protocol = Protocol::Unknown;
+        remove_origin_if_unused(key);
+    };
+    m_origins.ensure(key).http2_connection = move(connection);
+    start_expiry_timer();
+}
+
+void ConnectionCache::start_expiry_timer()
+{
+    if (!m_expiry_timer)
+        m_expiry_timer = Core::Timer::create_repeating(1000, [this] { remove_expired_connections(); });
+    if (!m_expiry_timer->is_active())
+        m_expiry_timer->start();
+}
+
+void ConnectionCache::remove_idle_connection(const String& key, Core::Socket& socket)
+{
+    auto it = m_origins.find(key);
+    if (it == m_origins.end())
+        return;
+    it->value.idle_connections.remove_first_matching([&](auto& connection) { return connection.socket.ptr() == &socket; });
+    remove_origin_if_unused(key);
+}
+
+void ConnectionCache::remove_expired_connections()
+{
+    Vector<String> keys;
+    Vector<NonnullRefPtr<HTTP::Http2Connection>> expired_http2_connections;
+    bool has_idle_connections = false;
+    for (auto& it : m_origins) {
+        it.value.idle_connections.remove_all_matching([](auto& connection) { return connection.idle_time.elapsed() >= idle_timeout_in_milliseconds; });
+        has_idle_connections |= !it.value.idle_connections.is_empty();
+        if (auto& connection = it.value.http2_connection) {
+            if (!connection->has_streams() && connection->idle_time().elapsed() >= idle_timeout_in_milliseconds)
+                expired_http2_connections.append(*connection);
+            else
+                has_idle_connections = true;
+        }
+        keys.append(it.key);
+    }
+    // Closing a connection takes it out of its origin.
+    for (auto& connection : expired_http2_connections)
+        connection->close();
+    for (auto& key : keys)
+        remove_origin_if_unused(key);
+
+    if (!has_idle_connections)
+        m_expiry_timer->stop();
+}
+
+void ConnectionCache::remove_origin_if_unused(const String& key)
+{
+    auto it = m_origins.find(key);
+    if (it == m_origins.end())
+        return;
+    auto& origin = it->value;
+    if (origin.idle_connections.is_empty() && origin.active_jobs.is_empty() && origin.pending_jobs.is_empty() && !origin.http2_connection)
+        m_origins.remove(it);
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/Forward.h>
+#include <LibCore/NetworkJob.h>
+#include <LibCore/Socket.h>
+#include <LibCore/Timer.h>
+#include <LibHTTP/Forward.h>
+
+namespace RequestServer {
+
+// Persistent connections, per origin (scheme, host and port).
+// With HTTP/1.1, a job that finishes with its connection still usable leaves it here, and the next request to
+// the same origin takes it over instead of connecting (and, for HTTPS, doing a TLS handshake) again.
+// An origin has at most max_connections_per_origin connections in use at once; more jobs wait for one of them.
+// With HTTP/2, all requests to the origin go on a single connection at the same time, as streams of their own.
+// Until the first connection to an HTTPS origin tells us which of the two the server speaks, only that one is made.
+class ConnectionCache {
+public:
+    static constexpr size_t max_connections_per_origin = 6;
+    static constexpr int idle_timeout_in_milliseconds = 10000;
+
+    // Called with an idle connection to take over, with an HTTP/2 connection to run the request on, or with
+    // nulls when the job should make its own connection.
+    using StartFunction = Function<void(RefPtr<Core::Socket>, RefPtr<HTTP::Http2Connection>)>;
+
+    static ConnectionCache& the();
+
+    void start_job(const URL&, Core::NetworkJob&, StartFunction);
+
+    // Called when the connection of a job picked its protocol, with the connection if it is HTTP/2.
+    void did_negotiate_protocol(const URL&, Core::NetworkJob&, RefPtr<HTTP::Http2Connection>);
+
+    // Called when a job is done, with its connection if the next job can use it.
+    // Jobs that go away early (e.g. because the client stopped them) call this too, so they don't keep their slot.
+    void did_finish_job(const URL&, Core::NetworkJob&, RefPtr<Core::Socket>);
+
+private:
+    ConnectionCache() = default;
+
+    struct IdleConnection {
+        NonnullRefPtr<Core::Socket> socket;
+        Core::ElapsedTimer idle_time;
+    };
+
+    struct PendingJob {
+        Core::NetworkJob* job { nullptr };
+        StartFunction start;
+    };
+
+    enum class Protocol {
+        Unknown,
+        Http1,
+        Http2,
+    };
+
+    struct Origin {
+        Protocol protocol { Protocol::Unknown };
+        Vector<IdleConnection> idle_connections;
+        // Jobs that run on an HTTP/2 connection are not in here, since they don't take up a connection of their own.
+        HashTable<Core::NetworkJob*> active_jobs;
+        Vector<PendingJob> pending_jobs;
+        RefPtr<HTTP::Http2Connection> http2_connection;
+    };
+
+    static String origin_key(const URL&);
+
+    void add_idle_connection(const String& key, NonnullRefPtr<Core::Socket>);
+    void remove_idle_connection(const String& key, Core::Socket&);
+    void set_http2_connection(const String& key, NonnullRefPtr<HTTP::Http2Connection>);
+    void start_expiry_timer();
+    void remove_expired_connections();
+    void remove_origin_if_unused(const String& key);
+
+    HashMap<String, Origin> m_origins;
+    RefPtr<Core::Timer> m_expiry_timer;
+};
+
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/GenericLexer.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/File.h>
+#include <RequestServer/CachedRequest.h>
+#include <RequestServer/HttpCache.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace RequestServer {
+
+static constexpr size_t max_memory_cache_size = 16 * MiB;
+static constexpr auto disk_cache_magic = "RequestServer cache v1"sv;
+
+HttpCache& HttpCache::the()
+{
+    static HttpCache s_the;
+    return s_the;
+}
+
+// Parses an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+// FIXME: Also accept the obsolete RFC 850 and asctime() formats.
+static Optional<time_t> parse_http_date(const StringView& string)
+{
+    static constexpr StringView month_names[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    auto parts = string.split_view(' ');
+    if (parts.size() != 6 || parts[5] != "GMT")
+        return {};
+
+    auto day = parts[1].to_uint();
+    auto year = parts[3].to_uint();
+    auto time_parts = parts[4].split_view(':');
+    if (!day.has_value() || !year.has_value() || time_parts.size() != 3)
+        return {};
+
+    Optional<int> month;
+    for (int i = 0; i < 12; ++i) {
+        if (parts[2] == month_names[i])
+            month = i;
+    }
+    auto hour = time_parts[0].to_uint();
+    auto minute = time_parts[1].to_uint();
+    auto second = time_parts[2].to_uint();
+    if (!month.has_value() || !hour.has_value() || !minute.has_value() || !second.has_value())
+        return {};
+
+    struct tm tm {};
+    tm.tm_year = (int)year.value() - 1900;
+    tm.tm_mon = month.value();
+    tm.tm_mday = (int)day.value();
+    tm.tm_hour = (int)hour.value();
+    tm.tm_min = (int)minute.value();
+    tm.tm_sec = (int)second.value();
+    return timegm(&tm);
+}
+
+static Optional<time_t> date_header(const HttpCache::Headers& headers, const StringView& name)
+{
+    auto value = headers.get(name);
+    if (!value.has_value())
+        return {};
+    return parse_http_date(value.value());
+}
+
+bool HttpCache::Entry::has_cache_control_directive(const StringView& directive) const
+{
+    auto cache_control = m_response_headers.get("Cache-Control");
+    if (!cache_control.has_value())
+        return false;
+    for (auto& part : cache_control->split_view(',')) {
+        auto name = part.trim_whitespace();
+        if (auto equals = name.find_first_of('='); equals.has_value())
+            name = name.substring_view(0, equals.value());
+        if (name.equals_ignoring_case(directive))
+            return true;
+    }
+    return false;
+}
+
+time_t HttpCache::Entry::freshness_lifetime() const
+{
+    if (auto cache_control = m_response_headers.get("Cache-Control"); cache_control.has_value()) {
+        for (auto& part : cache_control->split_view(',')) {
+            auto directive = part.trim_whitespace();
+            if (directive.starts_with("max-age=", CaseSensitivity::CaseInsensitive))
+                return directive.substring_view(8).to_uint().value_or(0);
+        }
+    }
+
+    auto date = date_header(m_response_headers, "Date").value_or(m_response_time);
+
+    if (m_response_headers.contains("Expires")) {
+        // An invalid Expires value (e.g. "0") means "already expired".
+        auto expires = date_header(m_response_headers, "Expires");
+        if (!expires.has_value() || expires.value() <= date)
+            return 0;
+        return expires.value() - date;
+    }
+
+    // No explicit lifetime, so use the usual heuristic of 10% of the time since the last modification.
+    if (auto last_modified = date_header(m_response_headers, "Last-Modified"); last_modified.has_value() && last_modified.value() < date)
+        return (date - last_modified.value()) / 10;
+
+    return 0;
+}
+
+time_t HttpCache::Entry::current_age() const
+{
+    time_t age = m_response_headers.get("Age").value_or({}).to_uint().value_or(0);
+    return age + max((time_t)0, time(nullptr) - m_response_time);
+}
+
+bool HttpCache::Entry::is_storable() const
+{
+    switch (m_status_code) {
+    case 200:
+    case 203:
+    case 301:
+    case 404:
+    case 410:
+        break;
+    default:
+        return false;
+    }
+
+    if (m_body.size() > max_entry_size)
+        return false;
+    if (has_cache_control_directive("no-store"))
+        return false;
+
+    // We don't key entries on request headers, so only the one that never changes is acceptable here.
+    if (auto vary = m_response_headers.get("Vary"); vary.has_value() && !vary->trim_whitespace().equals_ignoring_case("Accept-Encoding"))
+        return false;
+
+    return freshness_lifetime() > 0 || has_validators();
+}
+
+bool HttpCache::Entry::is_fresh() const
+{
+    if (has_cache_control_directive("no-cache"))
+        return false;
+    return current_age() < freshness_lifetime();
+}
+
+bool HttpCache::Entry::has_validators() const
+{
+    return m_response_headers.contains("ETag") || m_response_headers.contains("Last-Modified");
+}
+
+void HttpCache::Entry::add_validators_to(HashMap<String, String>& request_headers) const
+{
+    if (auto etag = m_response_headers.get("ETag"); etag.has_value())
+        request_headers.set("If-None-Match", etag.value());
+    if (auto last_modified = m_response_headers.get("Last-Modified"); last_modified.has_value())
+        request_headers.set("If-Modified-Since", last_modified.value());
+}
+
+void HttpCache::Entry::update_from_not_modified_response(const Headers& headers)
+{
+    for (auto& it : headers) {
+        // These describe the (empty) 304 body, not the stored one.
+        if (it.key.equals_ignoring_case("Content-Length") || it.key.equals_ignoring_case("Content-Encoding") || it.key.equals_ignoring_case("Transfer-Encoding"))
+            continue;
+        m_response_headers.set(it.key, it.value);
+    }
+    m_response_time = time(nullptr);
+}
+
+bool HttpCache::can_use_cache_for(const String& method, const URL& url, const HashMap<String, String>& request_headers)
+{
+    if (!method.equals_ignoring_case("GET"))
+        return false;
+    if (url.protocol() != "http" && url.protocol() != "https")
+        return false;
+    for (auto& it : request_headers) {
+        if (it.key.equals_ignoring_case("Authorization") || it.key.equals_ignoring_case("Range"))
+            return false;
+        if (it.key.equals_ignoring_case("Cache-Control") && it.value.contains("no-store"))
+            return false;
+    }
+    return true;
+}
+
+RefPtr<HttpCache::Entry> HttpCache::lookup(const URL& url)
+{
+    auto key = url.to_string();
+    if (auto it = m_memory_entries.find(key); it != m_memory_entries.end()) {
+        it->value.last_use = ++m_use_counter;
+        return it->value.entry;
+    }
+
+    auto entry = load_from_disk(key);
+    if (entry)
+        store_in_memory(key, *entry);
+    return entry;
+}
+
+void HttpCache::store(const URL& url, Entry& entry)
+{
+    auto key = url.to_string();
+    if (!entry.is_storable()) {
+        // Whatever we had stored is outdated now.
+        if (auto it = m_memory_entries.find(key); it != m_memory_entries.end()) {
+            m_memory_size -= it->value.entry->body().size();
+            m_memory_entries.remove(it);
+        }
+        if (!m_disk_cache_directory.is_null())
+            unlink(disk_path_for(key).characters());
+        return;
+    }
+
+    dbgln_if(CACHE_DEBUG, "HttpCache: Storing {} ({} bytes)", key, entry.body().size());
+    store_in_memory(key, entry);
+    store_on_disk(key, entry);
+}
+
+void HttpCache::store_in_memory(const String& key, Entry& entry)
+{
+    if (auto it = m_memory_entries.find(key); it != m_memory_entries.end())
+        m_memory_size -= it->value.entry->body().size();
+    m_memory_entries.set(key, { entry, ++m_use_counter });
+    m_memory_size += entry.body().size();
+    evict_from_memory_if_needed();
+}
+
+void HttpCache::evict_from_memory_if_needed()
+{
+    while (m_memory_size > max_memory_cache_size) {
+        auto least_recently_used = m_memory_entries.begin();
+        for (auto it = m_memory_entries.begin(); it != m_memory_entries.end(); ++it) {
+            if (it->value.last_use < least_recently_used->value.last_use)
+                least_recently_used = it;
+        }
+        m_memory_size -= least_recently_used->value.entry->body().size();
+        m_memory_entries.remove(least_recently_used);
+    }
+}
+
+String HttpCache::disk_path_for(const String& key) const
+{
+    return String::formatted("{}/{:08x}", m_disk_cache_directory, key.hash());
+}
+
+// The on-disk format is a small text header followed by the raw body:
+//
+//     RequestServer cache v1
+//     <url>
+//     <status code>
+//     <response time>
+//     <header name>: <header value>
+//     ...
+//     <empty line>
+//     <body>
+RefPtr<HttpCache::Entry> HttpCache::load_from_disk(const String& key) const
+{
+    if (m_disk_cache_directory.is_null())
+        return nullptr;
+
+    auto file_or_error = Core::File::open(disk_path_for(key), Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return nullptr;
+    auto data = file_or_error.value()->read_all();
+
+    GenericLexer lexer { StringView { data.data(), data.size() } };
+    auto read_line = [&] {
+        auto line = lexer.consume_until('\n');
+        lexer.consume_specific('\n');
+        return line;
+    };
+
+    // The URL check protects against hash collisions.
+    if (read_line() != disk_cache_magic || read_line() != key)
+        return nullptr;
+    auto status_code = read_line().to_uint();
+    auto response_time = read_line().to_uint();
+    if (!status_code.has_value() || !response_time.has_value())
+        return nullptr;
+
+    Headers headers;
+    for (;;) {
+        if (lexer.is_eof())
+            return nullptr;
+        auto line = read_line();
+        if (line.is_empty())
+            break;
+        auto colon = line.find_first_of(':');
+        if (!colon.has_value())
+            return nullptr;
+        headers.set(line.substring_view(0, colon.value()), line.substring_view(colon.value() + 1).trim_whitespace());
+    }
+
+    auto body = ByteBuffer::copy(data.bytes().slice(lexer.tell()));
+    dbgln_if(CACHE_DEBUG, "HttpCache: Loaded {} from disk ({} bytes)", key, body.size());
+    return Entry::create(status_code.value(), move(headers), move(body), response_time.value());
+}
+
+void HttpCache::store_on_disk(const String& key, const Entry& entry) const
+{
+    if (m_disk_cache_directory.is_null())
+        return;
+
+    StringBuilder builder;
+    builder.appendff("{}\n{}\n{}\n{}\n", disk_cache_magic, key, entry.status_code(), entry.response_time());
+    for (auto& it : entry.response_headers())
+        builder.appendff("{}: {}\n", it.key, it.value);
+    builder.append('\n');
+
+    // Other RequestServer processes may be reading this entry, so write a temporary file and move it into place.
+    auto path = disk_path_for(key);
+    auto temporary_path = String::formatted("{}.{}", path, getpid());
+    auto file_or_error = Core::File::open(temporary_path, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate, 0600);
+    if (file_or_error.is_error()) {
+        dbgln("HttpCache: Failed to open {}: {}", temporary_path, file_or_error.error());
+        return;
+    }
+    auto& file = *file_or_error.value();
+    auto header = builder.to_string();
+    if (!file.write(header) || !file.write(entry.body().data(), entry.body().size())) {
+        dbgln("HttpCache: Failed to write {}: {}", temporary_path, file.error_string());
+        unlink(temporary_path.characters());
+        return;
+    }
+    file.close();
+
+    if (rename(temporary_path.characters(), path.characters()) < 0) {
+        perror("rename");
+        unlink(temporary_path.characters());
+    }
+
+    // FIXME: Evict entries once the disk cache gets too big.
+}
+
+bool HttpCache::has_fetch_in_flight(const URL& url) const
+{
+    return m_fetches_in_flight.contains(url.to_string());
+}
+
+void HttpCache::did_start_fetch(const URL& url)
+{
+    m_fetches_in_flight.set(url.to_string());
+}
+
+void HttpCache::did_finish_fetch(const URL& url, RefPtr<Entry> entry)
+{
+    auto key = url.to_string();
+    m_fetches_in_flight.remove(key);
+
+    auto it = m_waiters.find(key);
+    if (it == m_waiters.end())
+        return;
+    auto waiters = move(it->value);
+    m_waiters.remove(it);
+
+    dbgln_if(CACHE_DEBUG, "HttpCache: Fetch of {} finished, handing the response to {} waiting request(s)", key, waiters.size());
+    for (auto* waiter : waiters) {
+        if (entry)
+            waiter->serve(*entry);
+        else
+            waiter->fail();
+    }
+}
+
+void HttpCache::add_waiter(const URL& url, CachedRequest& request)
+{
+    m_waiters.ensure(url.to_string()).append(&request);
+}
+
+void HttpCache::remove_waiter(const URL& url, CachedRequest& request)
+{
+    auto it = m_waiters.find(url.to_string());
+    if (it == m_waiters.end())
+        return;
+    it->value.remove_first_matching([&](auto* waiter) { return waiter == &request; });
+}
+
+}
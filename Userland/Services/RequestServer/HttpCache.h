@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/FileStream.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/RefCounted.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <RequestServer/Forward.h>
+#include <time.h>
+
+namespace RequestServer {
+
+// A private HTTP cache (RFC 7234) for GET responses.
+// Entries live in memory and on disk. Every client connection gets its own RequestServer process,
+// so the disk tier is what lets different WebContent processes share responses.
+class HttpCache {
+public:
+    using Headers = HashMap<String, String, CaseInsensitiveStringTraits>;
+
+    static constexpr size_t max_entry_size = 4 * MiB;
+
+    class Entry : public RefCounted<Entry> {
+    public:
+        static NonnullRefPtr<Entry> create(u32 status_code, Headers response_headers, ByteBuffer body, time_t response_time)
+        {
+            return adopt_ref(*new Entry(status_code, move(response_headers), move(body), response_time));
+        }
+
+        u32 status_code() const { return m_status_code; }
+        const Headers& response_headers() const { return m_response_headers; }
+        const ByteBuffer& body() const { return m_body; }
+        time_t response_time() const { return m_response_time; }
+
+        bool is_storable() const;
+        bool is_fresh() const;
+        bool has_validators() const;
+        void add_validators_to(HashMap<String, String>& request_headers) const;
+
+        // Applies the headers of a "304 Not Modified" response, which makes the entry fresh again.
+        void update_from_not_modified_response(const Headers&);
+
+    private:
+        Entry(u32 status_code, Headers response_headers, ByteBuffer body, time_t response_time)
+            : m_status_code(status_code)
+            , m_response_headers(move(response_headers))
+            , m_body(move(body))
+            , m_response_time(response_time)
+        {
+        }
+
+        bool has_cache_control_directive(const StringView&) const;
+        time_t freshness_lifetime() const;
+        time_t current_age() const;
+
+        u32 m_status_code { 0 };
+        Headers m_response_headers;
+        ByteBuffer m_body;
+        time_t m_response_time { 0 };
+    };
+
+    static HttpCache& the();
+
+    static bool can_use_cache_for(const String& method, const URL&, const HashMap<String, String>& request_headers);
+
+    void set_disk_cache_directory(const String& path) { m_disk_cache_directory = path; }
+
+    RefPtr<Entry> lookup(const URL&);
+    void store(const URL&, Entry&);
+
+    // Requests for a URL that is already being fetched wait for that fetch instead of starting their own.
+    bool has_fetch_in_flight(const URL&) const;
+    void did_start_fetch(const URL&);
+    void did_finish_fetch(const URL&, RefPtr<Entry>);
+    void add_waiter(const URL&, CachedRequest&);
+    void remove_waiter(const URL&, CachedRequest&);
+
+private:
+    HttpCache() = default;
+
+    struct MemoryEntry {
+        NonnullRefPtr<Entry> entry;
+        u64 last_use { 0 };
+    };
+
+    void store_in_memory(const String& key, Entry&);
+    void evict_from_memory_if_needed();
+
+    String disk_path_for(const String& key) const;
+    RefPtr<Entry> load_from_disk(const String& key) const;
+    void store_on_disk(const String& key, const Entry&) const;
+
+    HashMap<String, MemoryEntry> m_memory_entries;
+    size_t m_memory_size { 0 };
+    u64 m_use_counter { 0 };
+
+    String m_disk_cache_directory;
+
+    HashTable<String> m_fetches_in_flight;
+    HashMap<String, Vector<CachedRequest*>> m_waiters;
+};
+
+// An OutputFileStream that keeps a copy of what it wrote, so a finished response can be put in the cache.
+class RecordingOutputFileStream final : public OutputFileStream {
+public:
+    explicit RecordingOutputFileStream(int fd)
+        : OutputFileStream(fd)
+    {
+    }
+
+    virtual size_t write(ReadonlyBytes bytes) override
+    {
+        auto nwritten = OutputFileStream::write(bytes);
+        if (m_did_overflow)
+            return nwritten;
+        if (m_recorded_data.size() + nwritten > HttpCache::max_entry_size) {
+            // Too big to cache anyway, so don't hold on to (say) a huge download.
+            m_did_overflow = true;
+            m_recorded_data.clear();
+            return nwritten;
+        }
+        m_recorded_data.append(bytes.data(), nwritten);
+        return nwritten;
+    }
+
+    bool did_overflow() const { return m_did_overflow; }
+    const ByteBuffer& recorded_data() const { return m_recorded_data; }
+
+private:
+    ByteBuffer m_recorded_data;
+    bool m_did_overflow { false };
+};
+
+// Per-request state for a network load that goes through the HttpCache.
+struct HttpCacheContext {
+    URL url;
+    const RecordingOutputFileStream& body_stream;
+    RefPtr<HttpCache::Entry> entry_being_revalidated;
+    RefPtr<HttpCache::Entry> revalidated_entry;
+    bool did_finish { false };
+};
+
+}
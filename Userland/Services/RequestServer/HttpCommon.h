@@ -13,8 +13,11 @@
 #include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/ConnectionCache.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer::Detail {
@@ -23,18 +26,47 @@ template<typename TSelf, typename TJob>
 void init(TSelf* self, TJob job)
 {
     job->on_headers_received = [self](auto& headers, auto response_code) {
+        if (auto* context = self->cache_context(); context && context->entry_being_revalidated && response_code.value_or(0) == 304) {
+            // Our copy is still good, so the client gets that instead of this (empty) response.
+            context->entry_being_revalidated->update_from_not_modified_response(headers);
+            context->revalidated_entry = move(context->entry_being_revalidated);
+            return;
+        }
         if (response_code.has_value())
             self->set_status_code(response_code.value());
         self->set_response_headers(headers);
     };
 
     job->on_finish = [self](bool success) {
+        // If the server keeps the connection open, the next request to it can use it.
+        ConnectionCache::the().did_finish_job(self->url(), self->job(), success ? self->job().take_reusable_socket() : nullptr);
+
+        auto* cache_context = self->cache_context();
+        if (cache_context && cache_context->revalidated_entry) {
+            auto& entry = *cache_context->revalidated_entry;
+            HttpCache::the().store(cache_context->url, entry);
+            cache_context->did_finish = true;
+            HttpCache::the().did_finish_fetch(cache_context->url, entry);
+            self->send_cached_response(entry);
+            return;
+        }
+
         if (auto* response = self->job().response()) {
             self->set_status_code(response->code());
             self->set_response_headers(response->headers());
             self->set_downloaded_size(self->output_stream().size());
         }
 
+        if (cache_context) {
+            RefPtr<HttpCache::Entry> entry;
+            if (success && self->status_code().has_value() && !cache_context->body_stream.did_overflow()) {
+                entry = HttpCache::Entry::create(self->status_code().value(), self->response_headers(), cache_context->body_stream.recorded_data(), time(nullptr));
+                HttpCache::the().store(cache_context->url, *entry);
+            }
+            cache_context->did_finish = true;
+            HttpCache::the().did_finish_fetch(cache_context->url, move(entry));
+        }
+
         // if we didn't know the total size, pretend that the request finished successfully
         // and set the total size to the downloaded size
         if (!self->total_size().has_value())
@@ -50,6 +82,11 @@ void init(TSelf* self, TJob job)
             self->did_request_certificates();
         };
     }
+    if constexpr (requires { job->on_protocol_negotiated; }) {
+        job->on_protocol_negotiated = [self](auto connection) {
+            ConnectionCache::the().did_negotiate_protocol(self->url(), self->job(), move(connection));
+        };
+    }
 }
 
 template<typename TBadgedProtocol, typename TPipeResult>
@@ -62,21 +99,56 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ClientConnection& clie
         return {};
     }
 
+    bool use_cache = HttpCache::can_use_cache_for(method, url, headers);
+    auto request_headers = headers;
+
+    // If we have a stale copy, ask the server whether it is still good instead of fetching it again.
+    RefPtr<HttpCache::Entry> entry_to_revalidate;
+    if (use_cache) {
+        entry_to_revalidate = HttpCache::the().lookup(url);
+        if (entry_to_revalidate && entry_to_revalidate->has_validators())
+            entry_to_revalidate->add_validators_to(request_headers);
+        else
+            entry_to_revalidate = nullptr;
+    }
+
     HTTP::HttpRequest request;
     if (method.equals_ignoring_case("post"))
         request.set_method(HTTP::HttpRequest::Method::POST);
     else
         request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
-    request.set_headers(headers);
+    request.set_headers(request_headers);
     request.set_body(body);
+    request.set_keep_alive(true);
 
-    auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
+    RecordingOutputFileStream* recording_stream = nullptr;
+    OwnPtr<OutputFileStream> output_stream;
+    if (use_cache) {
+        auto stream = make<RecordingOutputFileStream>(pipe_result.value().write_fd);
+        recording_stream = stream.ptr();
+        output_stream = move(stream);
+    } else {
+        output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
+    }
     output_stream->make_unbuffered();
     auto job = TJob::construct(request, *output_stream);
-    auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
+    auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, output_stream.release_nonnull());
+    protocol_request->set_url(url);
     protocol_request->set_request_fd(pipe_result.value().read_fd);
-    job->start();
+    protocol_request->set_write_fd(pipe_result.value().write_fd);
+    if (use_cache) {
+        protocol_request->set_cache_context(adopt_own(*new HttpCacheContext { url, *recording_stream, move(entry_to_revalidate), {}, false }));
+        HttpCache::the().did_start_fetch(url);
+    }
+    ConnectionCache::the().start_job(url, *job, [job](RefPtr<Core::Socket> socket, RefPtr<HTTP::Http2Connection> http2_connection) mutable {
+        if (http2_connection)
+            job->start_on_http2_connection(http2_connection.release_nonnull());
+        else if (socket)
+            job->start(socket.release_nonnull());
+        else
+            job->start();
+    });
     return protocol_request;
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include <LibHTTP/HttpJob.h>
+#include <RequestServer/ConnectionCache.h>
 #include <RequestServer/HttpCommon.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpRequest.h>
@@ -22,6 +23,7 @@ HttpRequest::~HttpRequest()
 {
     m_job->on_finish = nullptr;
     m_job->on_progress = nullptr;
+    ConnectionCache::the().did_finish_job(url(), *m_job, nullptr);
     m_job->shutdown();
 }
 
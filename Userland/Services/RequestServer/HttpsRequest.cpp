@@ -5,6 +5,7 @@
  */
 
 #include <LibHTTP/HttpsJob.h>
+#include <RequestServer/ConnectionCache.h>
 #include <RequestServer/HttpCommon.h>
 #include <RequestServer/HttpsProtocol.h>
 #include <RequestServer/HttpsRequest.h>
@@ -27,6 +28,7 @@ HttpsRequest::~HttpsRequest()
 {
     m_job->on_finish = nullptr;
     m_job->on_progress = nullptr;
+    ConnectionCache::the().did_finish_job(url(), *m_job, nullptr);
     m_job->shutdown();
 }
 
@@ -22,6 +22,9 @@ Request::Request(ClientConnection& client, NonnullOwnPtr<OutputFileStream>&& out
 
 Request::~Request()
 {
+    // Don't leave anyone waiting for a fetch that will never finish.
+    if (m_cache_context && !m_cache_context->did_finish)
+        HttpCache::the().did_finish_fetch(m_cache_context->url, nullptr);
 }
 
 void Request::stop()
@@ -51,6 +54,38 @@ void Request::did_progress(Optional<u32> total_size, u32 downloaded_size)
     m_client.did_progress_request({}, *this);
 }
 
+void Request::send_cached_response(HttpCache::Entry& entry)
+{
+    VERIFY(m_write_fd != -1);
+    VERIFY(!m_write_notifier);
+
+    m_cached_response = entry;
+    m_cached_response_offset = 0;
+
+    // NOTE: Everything happens from the notifier, since this may be called before the client has even
+    //       been told about this request. The pipe is non-blocking and the client drains it as it goes,
+    //       so we write as space becomes available.
+    m_write_notifier = Core::Notifier::construct(m_write_fd, Core::Notifier::Write);
+    m_write_notifier->on_ready_to_write = [this] {
+        auto& body = m_cached_response->body();
+        if (!m_did_send_cached_response_headers) {
+            m_did_send_cached_response_headers = true;
+            set_status_code(m_cached_response->status_code());
+            set_response_headers(m_cached_response->response_headers());
+        }
+
+        m_cached_response_offset += m_output_stream->write(body.bytes().slice(m_cached_response_offset));
+        m_output_stream->handle_any_error();
+        if (m_cached_response_offset < body.size())
+            return;
+
+        m_write_notifier->set_enabled(false);
+        set_downloaded_size(body.size());
+        did_progress(body.size(), body.size());
+        did_finish(true);
+    };
+}
+
 void Request::did_request_certificates()
 {
     m_client.did_request_certificates({}, *this);
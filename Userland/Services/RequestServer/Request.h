@@ -12,7 +12,9 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <LibCore/Notifier.h>
 #include <RequestServer/Forward.h>
+#include <RequestServer/HttpCache.h>
 
 namespace RequestServer {
 
@@ -22,6 +24,7 @@ public:
 
     i32 id() const { return m_id; }
     URL url() const { return m_url; }
+    void set_url(const URL& url) { m_url = url; }
 
     Optional<u32> status_code() const { return m_status_code; }
     Optional<u32> total_size() const { return m_total_size; }
@@ -34,6 +37,8 @@ public:
     // FIXME: Want Badge<Protocol>, but can't make one from HttpProtocol, etc.
     void set_request_fd(int fd) { m_request_fd = fd; }
     int request_fd() const { return m_request_fd; }
+    void set_write_fd(int fd) { m_write_fd = fd; }
+    int write_fd() const { return m_write_fd; }
 
     void did_finish(bool success);
     void did_progress(Optional<u32> total_size, u32 downloaded_size);
@@ -43,6 +48,12 @@ public:
     void set_downloaded_size(size_t size) { m_downloaded_size = size; }
     const OutputFileStream& output_stream() const { return *m_output_stream; }
 
+    // Sends a response from the HttpCache to the client instead of whatever the network gave us, then finishes the request.
+    void send_cached_response(HttpCache::Entry&);
+
+    HttpCacheContext* cache_context() { return m_cache_context.ptr(); }
+    void set_cache_context(OwnPtr<HttpCacheContext> context) { m_cache_context = move(context); }
+
 protected:
     explicit Request(ClientConnection&, NonnullOwnPtr<OutputFileStream>&&);
 
@@ -50,12 +61,18 @@ private:
     ClientConnection& m_client;
     i32 m_id { 0 };
     int m_request_fd { -1 }; // Passed to client.
+    int m_write_fd { -1 };   // Our end of the pipe, owned by m_output_stream.
     URL m_url;
     Optional<u32> m_status_code;
     Optional<u32> m_total_size {};
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<OutputFileStream> m_output_stream;
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    OwnPtr<HttpCacheContext> m_cache_context;
+    RefPtr<HttpCache::Entry> m_cached_response;
+    size_t m_cached_response_offset { 0 };
+    bool m_did_send_cached_response_headers { false };
+    RefPtr<Core::Notifier> m_write_notifier;
 };
 
 }
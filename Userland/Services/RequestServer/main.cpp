@@ -5,17 +5,22 @@
  */
 
 #include <LibCore/EventLoop.h>
+#include <LibCore/File.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/StandardPaths.h>
 #include <LibIPC/ClientConnection.h>
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 int main(int, char**)
 {
-    if (pledge("stdio inet accept unix rpath sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -23,9 +28,17 @@ int main(int, char**)
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
 
+    // The disk cache is shared by all RequestServer instances of this user.
+    auto cache_directory = String::formatted("{}/.cache/RequestServer", Core::StandardPaths::home_directory());
+    bool has_disk_cache = Core::File::ensure_parent_directories(cache_directory) && (mkdir(cache_directory.characters(), 0700) == 0 || errno == EEXIST);
+    if (has_disk_cache)
+        RequestServer::HttpCache::the().set_disk_cache_directory(cache_directory);
+    else
+        warnln("Unable to create cache directory {}, only caching in memory", cache_directory);
+
     Core::EventLoop event_loop;
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
-    if (pledge("stdio inet accept unix sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -33,6 +46,10 @@ int main(int, char**)
         perror("unveil");
         return 1;
     }
+    if (has_disk_cache && unveil(cache_directory.characters(), "rwc") < 0) {
+        perror("unveil");
+        return 1;
+    }
     if (unveil(nullptr, nullptr) < 0) {
         perror("unveil");
         return 1;
@@ -35,6 +35,8 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> socket, int
     , m_page_host(PageHost::create(*this))
 {
     s_connections.set(client_id, *this);
+    // We tell the client about every paint, cursor change and link hover, so skip the socket for those.
+    enable_message_ring();
     m_paint_flush_timer = Core::Timer::create_single_shot(0, [this] { flush_pending_paint_requests(); });
 }
 
@@ -64,6 +66,7 @@ void ClientConnection::update_system_theme(const Core::AnonymousBuffer& theme_bu
     Gfx::set_system_theme(theme_buffer);
     auto impl = Gfx::PaletteImpl::create_with_anonymous_buffer(theme_buffer);
     m_page_host->set_palette_impl(*impl);
+    damage_everything();
 }
 
 void ClientConnection::update_system_fonts(String const& default_font_query, String const& fixed_width_font_query)
@@ -102,6 +105,9 @@ void ClientConnection::set_viewport_rect(const Gfx::IntRect& rect)
 {
     dbgln_if(SPAM_DEBUG, "handle: WebContentServer::SetViewportRect: rect={}", rect);
     m_page_host->set_viewport_rect(rect);
+
+    // Changes outside of the viewport are never reported, so a backing store showing another part of the page can't be trusted.
+    damage_everything();
 }
 
 void ClientConnection::add_backing_store(i32 backing_store_id, const Gfx::ShareableBitmap& bitmap)
@@ -112,6 +118,20 @@ void ClientConnection::add_backing_store(i32 backing_store_id, const Gfx::Sharea
 void ClientConnection::remove_backing_store(i32 backing_store_id)
 {
     m_backing_stores.remove(backing_store_id);
+    m_backing_store_states.remove(backing_store_id);
+}
+
+void ClientConnection::add_damage(Gfx::IntRect const& content_rect)
+{
+    for (auto& it : m_backing_store_states) {
+        auto& damage_rect = it.value.damage_rect;
+        damage_rect = damage_rect.is_empty() ? content_rect : damage_rect.united(content_rect);
+    }
+}
+
+void ClientConnection::damage_everything()
+{
+    m_backing_store_states.clear();
 }
 
 void ClientConnection::paint(const Gfx::IntRect& content_rect, i32 backing_store_id)
@@ -137,8 +157,16 @@ void ClientConnection::paint(const Gfx::IntRect& content_rect, i32 backing_store
 void ClientConnection::flush_pending_paint_requests()
 {
     for (auto& pending_paint : m_pending_paint_requests) {
-        m_page_host->paint(pending_paint.content_rect, *pending_paint.bitmap);
-        async_did_paint(pending_paint.content_rect, pending_paint.bitmap_id);
+        // A backing store that already shows this part of the page only needs what changed since it was painted.
+        auto damage_rect = pending_paint.content_rect;
+        auto state = m_backing_store_states.get(pending_paint.bitmap_id);
+        if (state.has_value() && state->content_rect == pending_paint.content_rect)
+            damage_rect = state->damage_rect.intersected(pending_paint.content_rect);
+
+        if (!damage_rect.is_empty())
+            m_page_host->paint(pending_paint.content_rect, damage_rect, *pending_paint.bitmap);
+        m_backing_store_states.set(pending_paint.bitmap_id, { pending_paint.content_rect, {} });
+        async_did_paint(pending_paint.content_rect, damage_rect, pending_paint.bitmap_id);
     }
     m_pending_paint_requests.clear();
 }
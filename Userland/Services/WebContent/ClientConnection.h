@@ -28,6 +28,9 @@ public:
 
     virtual void die() override;
 
+    void add_damage(Gfx::IntRect const& content_rect);
+    void damage_everything();
+
 private:
     Web::Page& page();
     const Web::Page& page() const;
@@ -64,6 +67,14 @@ private:
 
     HashMap<i32, NonnullRefPtr<Gfx::Bitmap>> m_backing_stores;
 
+    // The content rect each backing store was last painted for, and the part of the page that changed since then.
+    // Backing stores without an entry have to be painted in full.
+    struct BackingStoreState {
+        Gfx::IntRect content_rect;
+        Gfx::IntRect damage_rect;
+    };
+    HashMap<i32, BackingStoreState> m_backing_store_states;
+
     WeakPtr<JS::Interpreter> m_interpreter;
     OwnPtr<WebContentConsoleClient> m_console_client;
 };
@@ -11,6 +11,7 @@
 #include <LibWeb/Cookie/ParsedCookie.h>
 #include <LibWeb/Layout/InitialContainingBlockBox.h>
 #include <LibWeb/Page/BrowsingContext.h>
+#include <LibWeb/Painting/StackingContext.h>
 #include <WebContent/WebContentClientEndpoint.h>
 
 namespace WebContent {
@@ -44,6 +45,7 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(const Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    m_tile_cache.clear();
 }
 
 Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
@@ -54,7 +56,7 @@ Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
     return document->layout_node();
 }
 
-void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
+void PageHost::paint(const Gfx::IntRect& content_rect, const Gfx::IntRect& damage_rect, Gfx::Bitmap& target)
 {
     Gfx::Painter painter(target);
     Gfx::IntRect bitmap_rect { {}, content_rect.size() };
@@ -65,10 +67,28 @@ void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
         return;
     }
 
+    // Everything outside of the damage still shows what it did the last time this bitmap was painted.
+    painter.add_clip_rect(damage_rect.translated(-content_rect.location()));
+
+    // FIXME: Boxes with position: fixed move along with the viewport, so they can't be cached in tiles.
+    //        Paint them on top of the tiles instead of bypassing the tile cache for the whole page.
+    auto* stacking_context = layout_root->stacking_context();
+    if (stacking_context && !stacking_context->contains_fixed_position_box()) {
+        m_tile_cache.paint(painter, content_rect, [&](auto& tile_painter, auto& tile_rect) {
+            paint_content(tile_painter, tile_rect);
+        });
+        return;
+    }
+
+    paint_content(painter, content_rect);
+}
+
+void PageHost::paint_content(Gfx::Painter& painter, const Gfx::IntRect& content_rect)
+{
     Web::PaintContext context(painter, palette(), content_rect.top_left());
     context.set_should_show_line_box_borders(m_should_show_line_box_borders);
     context.set_viewport_rect(content_rect);
-    layout_root->paint_all_phases(context);
+    layout_root()->paint_all_phases(context);
 }
 
 void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
@@ -78,11 +98,20 @@ void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
 
 void PageHost::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
+    // Tiles outside of the viewport are kept around, so they need to hear about every change.
+    m_tile_cache.invalidate(content_rect);
+
+    if (!page().top_level_browsing_context().viewport_rect().intersects(content_rect))
+        return;
+    m_client.add_damage(content_rect);
     m_client.async_did_invalidate_content_rect(content_rect);
 }
 
 void PageHost::page_did_change_selection()
 {
+    // FIXME: Only damage the parts of the page whose selection state changed.
+    m_tile_cache.clear();
+    m_client.damage_everything();
     m_client.async_did_change_selection();
 }
 
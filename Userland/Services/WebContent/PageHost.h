@@ -8,6 +8,7 @@
 
 #include <LibGfx/Rect.h>
 #include <LibWeb/Page/Page.h>
+#include <WebContent/TileCache.h>
 
 namespace WebContent {
 
@@ -24,13 +25,17 @@ public:
     Web::Page& page() { return *m_page; }
     const Web::Page& page() const { return *m_page; }
 
-    void paint(const Gfx::IntRect& content_rect, Gfx::Bitmap&);
+    void paint(const Gfx::IntRect& content_rect, const Gfx::IntRect& damage_rect, Gfx::Bitmap&);
 
     void set_palette_impl(const Gfx::PaletteImpl&);
     void set_viewport_rect(const Gfx::IntRect&);
     void set_screen_rect(const Gfx::IntRect& rect) { m_screen_rect = rect; };
 
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool b)
+    {
+        m_should_show_line_box_borders = b;
+        m_tile_cache.clear();
+    }
 
 private:
     // ^PageClient
@@ -66,12 +71,14 @@ private:
 
     Web::Layout::InitialContainingBlockBox* layout_root();
     void setup_palette();
+    void paint_content(Gfx::Painter&, const Gfx::IntRect& content_rect);
 
     ClientConnection& m_client;
     NonnullOwnPtr<Web::Page> m_page;
     RefPtr<Gfx::PaletteImpl> m_palette_impl;
     Gfx::IntRect m_screen_rect;
     bool m_should_show_line_box_borders { false };
+    TileCache m_tile_cache;
 };
 
 }
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "TileCache.h"
+#include <AK/Vector.h>
+#include <LibGfx/Painter.h>
+
+namespace WebContent {
+
+static Gfx::IntRect rect_for_tile(int x, int y)
+{
+    return { x * TileCache::tile_size, y * TileCache::tile_size, TileCache::tile_size, TileCache::tile_size };
+}
+
+static int tile_index_for(int coordinate)
+{
+    // Round towards negative infinity, so that tiles also line up left of and above the origin.
+    if (coordinate < 0)
+        return (coordinate - TileCache::tile_size + 1) / TileCache::tile_size;
+    return coordinate / TileCache::tile_size;
+}
+
+void TileCache::paint(Gfx::Painter& painter, const Gfx::IntRect& content_rect, const RasterizeCallback& rasterize)
+{
+    auto area = painter.clip_rect().translated(content_rect.location() - painter.translation()).intersected(content_rect);
+    if (area.is_empty())
+        return;
+
+    for (int y = tile_index_for(area.top()); y <= tile_index_for(area.bottom()); ++y) {
+        for (int x = tile_index_for(area.left()); x <= tile_index_for(area.right()); ++x) {
+            auto tile_rect = rect_for_tile(x, y);
+            auto key = key_for_tile(x, y);
+
+            auto it = m_tiles.find(key);
+            if (it == m_tiles.end()) {
+                auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, tile_rect.size());
+                if (!bitmap)
+                    return;
+                Gfx::Painter tile_painter(*bitmap);
+                rasterize(tile_painter, tile_rect);
+                m_tiles.set(key, bitmap.release_nonnull());
+                it = m_tiles.find(key);
+            }
+
+            painter.blit(tile_rect.location() - content_rect.location(), *it->value, it->value->rect());
+        }
+    }
+
+    evict_tiles_far_from(content_rect);
+}
+
+void TileCache::invalidate(const Gfx::IntRect& content_rect)
+{
+    if (content_rect.is_empty())
+        return;
+    for (int y = tile_index_for(content_rect.top()); y <= tile_index_for(content_rect.bottom()); ++y) {
+        for (int x = tile_index_for(content_rect.left()); x <= tile_index_for(content_rect.right()); ++x)
+            m_tiles.remove(key_for_tile(x, y));
+    }
+}
+
+void TileCache::evict_tiles_far_from(const Gfx::IntRect& content_rect)
+{
+    // Keep roughly one viewport's worth of tiles in every direction, which covers ordinary scrolling.
+    auto keep_rect = content_rect.inflated(content_rect.width() * 2, content_rect.height() * 2);
+
+    Vector<u64> tiles_to_evict;
+    for (auto& it : m_tiles) {
+        auto x = static_cast<i32>(it.key >> 32);
+        auto y = static_cast<i32>(it.key & 0xffffffff);
+        if (!rect_for_tile(x, y).intersects(keep_rect))
+            tiles_to_evict.append(it.key);
+    }
+    for (auto key : tiles_to_evict)
+        m_tiles.remove(key);
+}
+
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Forward.h>
+#include <LibGfx/Rect.h>
+
+namespace WebContent {
+
+// Rasterized pieces of the page in content coordinates. They are kept across paints, so that showing
+// a part of the page that hasn't changed (e.g. when scrolling back and forth) only needs blits.
+class TileCache {
+public:
+    static constexpr int tile_size = 256;
+
+    using RasterizeCallback = Function<void(Gfx::Painter&, const Gfx::IntRect& tile_rect)>;
+
+    // Paints the part of content_rect that is inside the painter's clip rect, rasterizing missing tiles first.
+    void paint(Gfx::Painter&, const Gfx::IntRect& content_rect, const RasterizeCallback&);
+
+    void invalidate(const Gfx::IntRect& content_rect);
+    void clear() { m_tiles.clear(); }
+
+private:
+    static u64 key_for_tile(int x, int y) { return (static_cast<u64>(static_cast<u32>(x)) << 32) | static_cast<u32>(y); }
+
+    void evict_tiles_far_from(const Gfx::IntRect& content_rect);
+
+    HashMap<u64, NonnullRefPtr<Gfx::Bitmap>> m_tiles;
+};
+
+}
@@ -4,15 +4,26 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibIPC/ClientConnection.h>
+#include <LibJS/Heap/Heap.h>
+#include <LibWeb/Bindings/MainThreadVM.h>
 #include <WebContent/ClientConnection.h>
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    double gc_growth_factor = 0;
+    int gc_min_kib_between_collections = 0;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(gc_growth_factor, "Let the JS heap grow by this factor between collections", "gc-growth-factor", 0, "factor");
+    args_parser.add_option(gc_min_kib_between_collections, "Allocate at least this many KiB between JS heap collections", "gc-min-kib", 0, "kib");
+    args_parser.parse(argc, argv);
+
     Core::EventLoop event_loop;
-    if (pledge("stdio recvfd sendfd accept unix rpath", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd accept unix rpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -37,6 +48,12 @@ int main(int, char**)
         return 1;
     }
 
+    auto& heap = Web::Bindings::main_thread_vm().heap();
+    if (gc_growth_factor >= 1)
+        heap.set_gc_growth_factor(gc_growth_factor);
+    if (gc_min_kib_between_collections > 0)
+        heap.set_min_bytes_between_gc(gc_min_kib_between_collections * KiB);
+
     auto socket = Core::LocalSocket::take_over_accepted_socket_from_system_server();
     VERIFY(socket);
     IPC::new_client_connection<WebContent::ClientConnection>(socket.release_nonnull(), 1);
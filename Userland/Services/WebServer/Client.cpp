@@ -5,63 +5,196 @@
  */
 
 #include "Client.h"
-#include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MappedFile.h>
-#include <AK/MemoryStream.h>
 #include <AK/StringBuilder.h>
-#include <AK/URL.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
-#include <LibCore/MimeData.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/HttpRequest.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 
 namespace WebServer {
 
-Client::Client(NonnullRefPtr<Core::TCPSocket> socket, const String& root, Core::Object* parent)
+// How long a connection may go without making any progress before we close it.
+static constexpr int idle_timeout_ms = 15000;
+// Requests whose headers don't fit are refused, so a client can't make us buffer without bound.
+static constexpr size_t max_request_size = 64 * KiB;
+static constexpr size_t read_chunk_size = 64 * KiB;
+static constexpr size_t file_chunk_size = 1 * MiB;
+static constexpr size_t inline_file_size = 16 * KiB;
+
+static Optional<String> header_value(const HTTP::HttpRequest& request, const StringView& name)
+{
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case(name))
+            return header.value;
+    }
+    return {};
+}
+
+static bool accepts_gzip(const HTTP::HttpRequest& request)
+{
+    auto accept_encoding = header_value(request, "Accept-Encoding");
+    if (!accept_encoding.has_value())
+        return false;
+    for (auto& coding : accept_encoding.value().split_view(',')) {
+        auto parts = coding.split_view(';');
+        if (parts.is_empty() || !parts[0].trim_whitespace().equals_ignoring_case("gzip"))
+            continue;
+        // "gzip;q=0" means the client doesn't want it after all.
+        return parts.size() < 2 || !parts[1].trim_whitespace().is_one_of("q=0", "q=0.0", "q=0.00", "q=0.000");
+    }
+    return false;
+}
+
+// Whether the client's cached copy is still current. Like other servers, we only take an
+// If-Modified-Since date that is exactly the Last-Modified date we sent.
+static bool is_not_modified(const HTTP::HttpRequest& request, const String& etag, const String& last_modified)
+{
+    if (auto if_none_match = header_value(request, "If-None-Match"); if_none_match.has_value()) {
+        for (auto& tag : if_none_match.value().split_view(',')) {
+            auto trimmed_tag = tag.trim_whitespace();
+            if (trimmed_tag.starts_with("W/"))
+                trimmed_tag = trimmed_tag.substring_view(2);
+            if (trimmed_tag == "*" || trimmed_tag == etag)
+                return true;
+        }
+        return false;
+    }
+    auto if_modified_since = header_value(request, "If-Modified-Since");
+    return if_modified_since.has_value() && if_modified_since.value() == last_modified;
+}
+
+Client::Client(int fd, FileCache& file_cache, Core::Object* parent)
     : Core::Object(parent)
-    , m_socket(socket)
-    , m_root_path(root)
+    , m_fd(fd)
+    , m_file_cache(file_cache)
+{
+}
+
+Client::~Client()
 {
+    if (m_notifier)
+        m_notifier->close();
+    ::close(m_fd);
 }
 
 void Client::die()
 {
-    remove_from_parent();
+    if (m_dying)
+        return;
+    m_dying = true;
+    m_notifier->set_enabled(false);
+    m_idle_timer->stop();
+    // We may be deep inside one of our own callbacks, so let the event loop drop the last reference.
+    deferred_invoke([this](auto&) { remove_from_parent(); });
 }
 
 void Client::start()
 {
-    m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
-        for (;;) {
-            auto line = m_socket->read_line();
-            if (line.is_empty())
-                break;
-            builder.append(line);
-            builder.append("\r\n");
+    m_notifier = Core::Notifier::construct(m_fd, Core::Notifier::Event::Read, this);
+    m_notifier->on_ready_to_read = [this] { did_become_readable(); };
+    m_notifier->on_ready_to_write = [this] { did_become_writable(); };
+
+    m_idle_timer = Core::Timer::create_single_shot(idle_timeout_ms, [this] { die(); }, this);
+    m_idle_timer->start();
+}
+
+void Client::update_notifier()
+{
+    if (m_dying)
+        return;
+    // While a response is on its way out, new requests stay in the socket, which pushes back on
+    // clients that send faster than they read.
+    if (m_is_responding)
+        m_notifier->set_event_mask(Core::Notifier::Event::Write);
+    else if (!m_peer_closed)
+        m_notifier->set_event_mask(Core::Notifier::Event::Read);
+    else
+        m_notifier->set_event_mask(Core::Notifier::Event::None);
+}
+
+void Client::did_become_readable()
+{
+    if (m_dying)
+        return;
+    m_idle_timer->restart();
+
+    u8 buffer[read_chunk_size];
+    auto nread = ::read(m_fd, buffer, sizeof(buffer));
+    if (nread < 0) {
+        if (errno == EAGAIN || errno == EINTR)
+            return;
+        die();
+        return;
+    }
+    if (nread == 0)
+        m_peer_closed = true;
+    else
+        m_input.append(buffer, nread);
+
+    handle_next_request();
+}
+
+void Client::did_become_writable()
+{
+    if (m_dying)
+        return;
+    m_idle_timer->restart();
+
+    continue_response();
+    handle_next_request();
+}
+
+void Client::handle_next_request()
+{
+    while (!m_dying && !m_is_responding) {
+        auto end_of_headers = StringView { m_input.bytes() }.find("\r\n\r\n");
+        if (!end_of_headers.has_value()) {
+            if (m_input.size() > max_request_size) {
+                m_is_responding = true;
+                m_keep_alive = false;
+                send_error_response(400, "Bad request!", {});
+                continue_response();
+            }
+            break;
         }
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
-        handle_request(request);
+        auto request_size = end_of_headers.value() + 4;
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", StringView { m_input.data(), request_size });
+        // The parser wants every header line to end in a line break, but not the empty line after them.
+        handle_request(m_input.bytes().slice(0, request_size - 2));
+        m_input = m_input.slice(request_size, m_input.size() - request_size);
+        continue_response();
+    }
+
+    if (m_dying)
+        return;
+    if (m_peer_closed && !m_is_responding) {
         die();
-    };
+        return;
+    }
+    update_notifier();
 }
 
 void Client::handle_request(ReadonlyBytes raw_request)
 {
+    m_is_responding = true;
+    m_keep_alive = false;
+
     auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
-    if (!request_or_error.has_value())
+    if (!request_or_error.has_value()) {
+        send_error_response(400, "Bad request!", {});
         return;
+    }
     auto& request = request_or_error.value();
 
     if constexpr (WEBSERVER_DEBUG) {
@@ -72,57 +205,78 @@ void Client::handle_request(ReadonlyBytes raw_request)
     }
 
     if (request.method() != HTTP::HttpRequest::Method::GET) {
+        // We don't read request bodies, so we couldn't tell where the next request starts.
         send_error_response(403, "Forbidden!", request);
         return;
     }
+    m_keep_alive = request.keep_alive();
 
     auto requested_path = LexicalPath::join("/", request.resource()).string();
     dbgln_if(WEBSERVER_DEBUG, "Canonical requested path: '{}'", requested_path);
 
-    StringBuilder path_builder;
-    path_builder.append(m_root_path);
-    path_builder.append('/');
-    path_builder.append(requested_path);
-    auto real_path = path_builder.to_string();
+    auto* entry = m_file_cache.find(requested_path);
+    if (!entry) {
+        send_error_response(404, "Not found!", request);
+        return;
+    }
 
-    if (Core::File::is_directory(real_path)) {
+    if (entry->is_directory && !request.resource().ends_with("/")) {
+        StringBuilder red;
 
-        if (!request.resource().ends_with("/")) {
-            StringBuilder red;
+        red.append(requested_path);
+        red.append("/");
 
-            red.append(requested_path);
-            red.append("/");
+        send_redirect(red.to_string(), request);
+        return;
+    }
 
-            send_redirect(red.to_string(), request);
-            return;
-        }
+    if (entry->directory_listing.has_value()) {
+        send_response(entry->directory_listing.value(), request, entry->content_type);
+        return;
+    }
 
-        StringBuilder index_html_path_builder;
-        index_html_path_builder.append(real_path);
-        index_html_path_builder.append("/index.html");
-        auto index_html_path = index_html_path_builder.to_string();
-        if (!Core::File::exists(index_html_path)) {
-            handle_directory_listing(requested_path, real_path, request);
-            return;
-        }
-        real_path = index_html_path;
+    auto& file = entry->gzip_file.has_value() && accepts_gzip(request) ? entry->gzip_file.value() : entry->file;
+
+    StringBuilder headers;
+    headers.appendff("ETag: {}\r\n", file.etag);
+    headers.appendff("Last-Modified: {}\r\n", entry->last_modified);
+    if (entry->gzip_file.has_value())
+        headers.append("Vary: Accept-Encoding\r\n");
+
+    if (is_not_modified(request, file.etag, entry->last_modified)) {
+        send_not_modified(headers.string_view(), request);
+        return;
     }
 
-    auto file = Core::File::construct(real_path);
-    if (!file->open(Core::OpenMode::ReadOnly)) {
+    if (&file != &entry->file)
+        headers.append("Content-Encoding: gzip\r\n");
+
+    auto content = Core::File::construct(file.path);
+    struct stat st;
+    if (!content->open(Core::OpenMode::ReadOnly) || fstat(content->fd(), &st) < 0 || !S_ISREG(st.st_mode)) {
         send_error_response(404, "Not found!", request);
         return;
     }
 
-    Core::InputFileStream stream { file };
+    send_file_response(move(content), st.st_size, request, entry->content_type, headers.string_view());
+}
 
-    send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path));
+void Client::send(ReadonlyBytes bytes)
+{
+    m_output.append(bytes.data(), bytes.size());
 }
 
-void Client::send_response(InputStream& response, const HTTP::HttpRequest& request, const String& content_type)
+void Client::send(const StringView& string)
+{
+    send(string.bytes());
+}
+
+void Client::send_response_headers(unsigned code, const StringView& message, const HTTP::HttpRequest& request, const String& content_type, size_t content_length, const StringView& extra_headers)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n");
+    builder.appendff("HTTP/1.1 {} ", code);
+    builder.append(message);
+    builder.append("\r\n");
     builder.append("Server: WebServer (SerenityOS)\r\n");
     builder.append("X-Frame-Options: SAMEORIGIN\r\n");
     builder.append("X-Content-Type-Options: nosniff\r\n");
@@ -130,133 +284,163 @@ void Client::send_response(InputStream& response, const HTTP::HttpRequest& reque
     builder.append("Content-Type: ");
     builder.append(content_type);
     builder.append("\r\n");
+    builder.appendff("Content-Length: {}\r\n", content_length);
+    builder.append(extra_headers);
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
     builder.append("\r\n");
 
-    m_socket->write(builder.to_string());
-    log_response(200, request);
+    send(builder.string_view());
+    log_response(code, request);
+}
 
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+void Client::send_response(const String& body, const HTTP::HttpRequest& request, const String& content_type)
+{
+    send_response_headers(200, "OK", request, content_type, body.length());
+    send(body);
+}
 
-        m_socket->write({ buffer, size });
-    } while (true);
+void Client::send_file_response(NonnullRefPtr<Core::File> file, size_t size, const HTTP::HttpRequest& request, const String& content_type, const StringView& extra_headers)
+{
+    send_response_headers(200, "OK", request, content_type, size, extra_headers);
+    m_file = move(file);
+    m_file_remaining = size;
+
+    // Small files go out together with the headers, in a single write.
+    if (size <= inline_file_size) {
+        u8 buffer[inline_file_size];
+        auto nread = ::read(m_file->fd(), buffer, size);
+        if (nread > 0) {
+            send(ReadonlyBytes { buffer, (size_t)nread });
+            m_file_remaining -= nread;
+        }
+    }
 }
 
-void Client::send_redirect(StringView redirect_path, const HTTP::HttpRequest& request)
+// Writes as much of the queued output as the socket takes. Returns whether all of it is out.
+bool Client::flush_output()
 {
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n");
-    builder.append("Location: ");
-    builder.append(redirect_path);
-    builder.append("\r\n");
-    builder.append("\r\n");
+    while (m_output_offset < m_output.size()) {
+        auto nwritten = ::write(m_fd, m_output.data() + m_output_offset, m_output.size() - m_output_offset);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN)
+                die();
+            return false;
+        }
+        m_output_offset += nwritten;
+    }
+    m_output.clear_with_capacity();
+    m_output_offset = 0;
+    return true;
+}
 
-    m_socket->write(builder.to_string());
+// Sends the rest of the file once the headers are out. Returns whether all of it is out.
+bool Client::send_file_contents()
+{
+    while (m_file_remaining > 0) {
+        // Let the kernel move the file contents into the socket directly instead of bouncing them through our buffers.
+        auto nsent = sendfile(m_fd, m_file->fd(), nullptr, min(m_file_remaining, file_chunk_size));
+        if (nsent > 0) {
+            m_file_remaining -= nsent;
+            continue;
+        }
+        if (nsent < 0 && errno == EINTR)
+            continue;
+        if (nsent < 0 && errno == EAGAIN)
+            return false;
+        if (nsent == 0 || (errno != EINVAL && errno != ENOSYS)) {
+            // The file got shorter or the client went away, and we can't keep the promised length either way.
+            if (nsent < 0 && errno != EPIPE && errno != ECONNRESET)
+                perror("sendfile");
+            die();
+            return false;
+        }
 
-    log_response(301, request);
+        // sendfile() doesn't support this kind of file, fall back to copying it through userspace.
+        u8 buffer[read_chunk_size];
+        auto nread = ::read(m_file->fd(), buffer, min(m_file_remaining, sizeof(buffer)));
+        if (nread <= 0) {
+            if (nread < 0)
+                perror("read");
+            die();
+            return false;
+        }
+        m_file_remaining -= nread;
+        send(ReadonlyBytes { buffer, (size_t)nread });
+        if (!flush_output())
+            return false;
+    }
+    m_file = nullptr;
+    return true;
 }
 
-static String folder_image_data()
+void Client::continue_response()
 {
-    static String cache;
-    if (cache.is_empty()) {
-        auto file_or_error = MappedFile::map("/res/icons/16x16/filetype-folder.png");
-        VERIFY(!file_or_error.is_error());
-        cache = encode_base64(file_or_error.value()->bytes());
-    }
-    return cache;
+    if (!m_is_responding || m_dying)
+        return;
+    if (!flush_output())
+        return;
+    if (m_file && !send_file_contents())
+        return;
+    finish_response();
 }
 
-static String file_image_data()
+void Client::finish_response()
 {
-    static String cache;
-    if (cache.is_empty()) {
-        auto file_or_error = MappedFile::map("/res/icons/16x16/filetype-unknown.png");
-        VERIFY(!file_or_error.is_error());
-        cache = encode_base64(file_or_error.value()->bytes());
-    }
-    return cache;
+    m_is_responding = false;
+    if (!m_keep_alive)
+        die();
 }
 
-void Client::handle_directory_listing(const String& requested_path, const String& real_path, const HTTP::HttpRequest& request)
+void Client::send_not_modified(const StringView& extra_headers, const HTTP::HttpRequest& request)
 {
     StringBuilder builder;
+    builder.append("HTTP/1.1 304 Not Modified\r\n");
+    builder.append("Server: WebServer (SerenityOS)\r\n");
+    builder.append(extra_headers);
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    builder.append("\r\n");
 
-    builder.append("<!DOCTYPE html>\n");
-    builder.append("<html>\n");
-    builder.append("<head><title>Index of ");
-    builder.append(escape_html_entities(requested_path));
-    builder.append("</title><style>\n");
-    builder.append(".folder { width: 16px; height: 16px; background-image: url('data:image/png;base64,");
-    builder.append(folder_image_data());
-    builder.append("'); }\n");
-    builder.append(".file { width: 16px; height: 16px; background-image: url('data:image/png;base64,");
-    builder.append(file_image_data());
-    builder.append("'); }\n");
-    builder.append("</style></head><body>\n");
-    builder.append("<h1>Index of ");
-    builder.append(escape_html_entities(requested_path));
-    builder.append("</h1>\n");
-    builder.append("<hr>\n");
-    builder.append("<code><table>\n");
-
-    Core::DirIterator dt(real_path);
-    while (dt.has_next()) {
-        auto name = dt.next_path();
-
-        StringBuilder path_builder;
-        path_builder.append(real_path);
-        path_builder.append('/');
-        path_builder.append(name);
-        struct stat st;
-        memset(&st, 0, sizeof(st));
-        int rc = stat(path_builder.to_string().characters(), &st);
-        if (rc < 0) {
-            perror("stat");
-        }
+    send(builder.string_view());
 
-        bool is_directory = S_ISDIR(st.st_mode) || name.is_one_of(".", "..");
-
-        builder.append("<tr>");
-        builder.appendff("<td><div class=\"{}\"></div></td>", is_directory ? "folder" : "file");
-        builder.append("<td><a href=\"");
-        builder.append(URL::percent_encode(name));
-        builder.append("\">");
-        builder.append(escape_html_entities(name));
-        builder.append("</a></td><td>&nbsp;</td>");
-
-        builder.appendff("<td>{:10}</td><td>&nbsp;</td>", st.st_size);
-        builder.append("<td>");
-        builder.append(Core::DateTime::from_timestamp(st.st_mtime).to_string());
-        builder.append("</td>");
-        builder.append("</tr>\n");
-    }
+    log_response(304, request);
+}
+
+void Client::send_redirect(StringView redirect_path, const HTTP::HttpRequest& request)
+{
+    StringBuilder builder;
+    builder.append("HTTP/1.1 301 Moved Permanently\r\n");
+    builder.append("Location: ");
+    builder.append(redirect_path);
+    builder.append("\r\n");
+    builder.append("Content-Length: 0\r\n");
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    builder.append("\r\n");
 
-    builder.append("</table></code>\n");
-    builder.append("<hr>\n");
-    builder.append("<i>Generated by WebServer (SerenityOS)</i>\n");
-    builder.append("</body>\n");
-    builder.append("</html>\n");
+    send(builder.string_view());
 
-    auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    send_response(stream, request, "text/html");
+    log_response(301, request);
 }
 
 void Client::send_error_response(unsigned code, const StringView& message, const HTTP::HttpRequest& request)
 {
+    StringBuilder body_builder;
+    body_builder.append("<!DOCTYPE html><html><body><h1>");
+    body_builder.appendff("{} ", code);
+    body_builder.append(message);
+    body_builder.append("</h1></body></html>");
+    auto body = body_builder.to_string();
+
     StringBuilder builder;
-    builder.appendff("HTTP/1.0 {} ", code);
+    builder.appendff("HTTP/1.1 {} ", code);
     builder.append(message);
-    builder.append("\r\n\r\n");
-    builder.append("<!DOCTYPE html><html><body><h1>");
-    builder.appendff("{} ", code);
-    builder.append(message);
-    builder.append("</h1></body></html>");
-    m_socket->write(builder.to_string());
+    builder.append("\r\n");
+    builder.appendff("Content-Length: {}\r\n", body.length());
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    builder.append("\r\n");
+    builder.append(body);
+    send(builder.string_view());
 
     log_response(code, request);
 }
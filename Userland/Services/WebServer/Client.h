@@ -6,31 +6,68 @@
 
 #pragma once
 
+#include "FileCache.h"
+#include <AK/ByteBuffer.h>
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
-#include <LibCore/TCPSocket.h>
 #include <LibHTTP/Forward.h>
 
 namespace WebServer {
 
+// A connection, which may carry any number of requests one after the other (HTTP/1.1 keep-alive),
+// including requests that the client sends before the responses to the earlier ones (pipelining).
+// The socket is non-blocking: responses are queued up and written out whenever the socket can take
+// more, and we stop reading new requests until the current response is out.
 class Client final : public Core::Object {
     C_OBJECT(Client);
 
 public:
+    virtual ~Client() override;
+
     void start();
 
 private:
-    Client(NonnullRefPtr<Core::TCPSocket>, const String&, Core::Object* parent);
+    Client(int fd, FileCache&, Core::Object* parent);
 
+    void did_become_readable();
+    void did_become_writable();
+    void handle_next_request();
     void handle_request(ReadonlyBytes);
-    void send_response(InputStream&, const HTTP::HttpRequest&, const String& content_type);
+    void send(ReadonlyBytes);
+    void send(const StringView&);
+    void send_response_headers(unsigned code, const StringView& message, const HTTP::HttpRequest&, const String& content_type, size_t content_length, const StringView& extra_headers = {});
+    void send_response(const String& body, const HTTP::HttpRequest&, const String& content_type);
+    void send_file_response(NonnullRefPtr<Core::File>, size_t size, const HTTP::HttpRequest&, const String& content_type, const StringView& extra_headers);
+    void send_not_modified(const StringView& extra_headers, const HTTP::HttpRequest&);
     void send_redirect(StringView redirect, const HTTP::HttpRequest& request);
     void send_error_response(unsigned code, const StringView& message, const HTTP::HttpRequest&);
+    bool flush_output();
+    bool send_file_contents();
+    void continue_response();
+    void finish_response();
+    void update_notifier();
     void die();
     void log_response(unsigned code, const HTTP::HttpRequest&);
-    void handle_directory_listing(const String& requested_path, const String& real_path, const HTTP::HttpRequest&);
 
-    NonnullRefPtr<Core::TCPSocket> m_socket;
-    String m_root_path;
+    int m_fd { -1 };
+    FileCache& m_file_cache;
+    RefPtr<Core::Notifier> m_notifier;
+    RefPtr<Core::Timer> m_idle_timer;
+
+    // Bytes that were received but don't make up a complete request yet, or belong to requests that
+    // were pipelined behind the one that is being answered.
+    ByteBuffer m_input;
+    // The part of the response that hasn't been written to the socket yet.
+    ByteBuffer m_output;
+    size_t m_output_offset { 0 };
+    // The file whose contents follow once the headers are out.
+    RefPtr<Core::File> m_file;
+    size_t m_file_remaining { 0 };
+
+    bool m_is_responding { false };
+    bool m_keep_alive { false };
+    bool m_peer_closed { false };
+    bool m_dying { false };
 };
 
 }
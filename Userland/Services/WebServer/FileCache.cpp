@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "FileCache.h"
+#include <AK/Base64.h>
+#include <AK/Debug.h>
+#include <AK/LexicalPath.h>
+#include <AK/MappedFile.h>
+#include <AK/StringBuilder.h>
+#include <AK/URL.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/MimeData.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+namespace WebServer {
+
+// Every entry holds a watch or two, so we start over before there are too many of them.
+static constexpr size_t max_entry_count = 4096;
+
+static String folder_image_data()
+{
+    static String cache;
+    if (cache.is_empty()) {
+        auto file_or_error = MappedFile::map("/res/icons/16x16/filetype-folder.png");
+        VERIFY(!file_or_error.is_error());
+        cache = encode_base64(file_or_error.value()->bytes());
+    }
+    return cache;
+}
+
+static String file_image_data()
+{
+    static String cache;
+    if (cache.is_empty()) {
+        auto file_or_error = MappedFile::map("/res/icons/16x16/filetype-unknown.png");
+        VERIFY(!file_or_error.is_error());
+        cache = encode_base64(file_or_error.value()->bytes());
+    }
+    return cache;
+}
+
+static String generate_directory_listing(const String& requested_path, const String& real_path)
+{
+    StringBuilder builder;
+
+    builder.append("<!DOCTYPE html>\n");
+    builder.append("<html>\n");
+    builder.append("<head><title>Index of ");
+    builder.append(escape_html_entities(requested_path));
+    builder.append("</title><style>\n");
+    builder.append(".folder { width: 16px; height: 16px; background-image: url('data:image/png;base64,");
+    builder.append(folder_image_data());
+    builder.append("'); }\n");
+    builder.append(".file { width: 16px; height: 16px; background-image: url('data:image/png;base64,");
+    builder.append(file_image_data());
+    builder.append("'); }\n");
+    builder.append("</style></head><body>\n");
+    builder.append("<h1>Index of ");
+    builder.append(escape_html_entities(requested_path));
+    builder.append("</h1>\n");
+    builder.append("<hr>\n");
+    builder.append("<code><table>\n");
+
+    Core::DirIterator dt(real_path);
+    while (dt.has_next()) {
+        auto name = dt.next_path();
+
+        StringBuilder path_builder;
+        path_builder.append(real_path);
+        path_builder.append('/');
+        path_builder.append(name);
+        struct stat st;
+        memset(&st, 0, sizeof(st));
+        int rc = stat(path_builder.to_string().characters(), &st);
+        if (rc < 0) {
+            perror("stat");
+        }
+
+        bool is_directory = S_ISDIR(st.st_mode) || name.is_one_of(".", "..");
+
+        builder.append("<tr>");
+        builder.appendff("<td><div class=\"{}\"></div></td>", is_directory ? "folder" : "file");
+        builder.append("<td><a href=\"");
+        builder.append(URL::percent_encode(name));
+        builder.append("\">");
+        builder.append(escape_html_entities(name));
+        builder.append("</a></td><td>&nbsp;</td>");
+
+        builder.appendff("<td>{:10}</td><td>&nbsp;</td>", st.st_size);
+        builder.append("<td>");
+        builder.append(Core::DateTime::from_timestamp(st.st_mtime).to_string());
+        builder.append("</td>");
+        builder.append("</tr>\n");
+    }
+
+    builder.append("</table></code>\n");
+    builder.append("<hr>\n");
+    builder.append("<i>Generated by WebServer (SerenityOS)</i>\n");
+    builder.append("</body>\n");
+    builder.append("</html>\n");
+
+    return builder.to_string();
+}
+
+static String format_http_date(time_t timestamp)
+{
+    struct tm tm;
+    gmtime_r(&timestamp, &tm);
+    char buffer[64];
+    auto length = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return String { buffer, length };
+}
+
+// The validator changes whenever the file is replaced or its contents change.
+static String make_etag(const struct stat& st)
+{
+    return String::formatted("\"{:x}-{:x}-{:x}\"", st.st_ino, st.st_size, st.st_mtime);
+}
+
+FileCache::FileCache(String root_path)
+    : m_root_path(move(root_path))
+{
+    auto watcher_or_error = Core::FileWatcher::create();
+    if (watcher_or_error.is_error()) {
+        // We can still serve everything, we just have to look at the file system every time.
+        dbgln("WebServer: Not caching files: {}", watcher_or_error.error());
+        return;
+    }
+    m_watcher = watcher_or_error.release_value();
+    m_watcher->on_change = [this](auto& event) {
+        dbgln_if(WEBSERVER_DEBUG, "File cache: {}", event);
+        invalidate(event.event_path);
+        // Directory listings and the choice between index.html, a listing and a .gz copy depend on
+        // which children a directory has.
+        if (event.type == Core::FileWatcherEvent::Type::ChildCreated || event.type == Core::FileWatcherEvent::Type::ChildDeleted)
+            invalidate(LexicalPath(event.event_path).dirname());
+    };
+}
+
+FileCache::~FileCache()
+{
+}
+
+const FileCache::Entry* FileCache::find(const String& requested_path)
+{
+    auto it = m_entries.find(requested_path);
+    if (it != m_entries.end())
+        return &it->value;
+
+    auto real_path = LexicalPath::join(m_root_path, requested_path).string();
+    auto entry = load(requested_path, real_path);
+    if (!entry.has_value())
+        return nullptr;
+
+    if (!m_watcher) {
+        m_uncached_entry = entry.release_value();
+        return &m_uncached_entry;
+    }
+
+    if (m_entries.size() >= max_entry_count)
+        clear();
+
+    // The directory the file is in tells us about an index.html or a .gz copy that comes or goes.
+    if (entry->is_directory)
+        watch(real_path, requested_path, true);
+    else
+        watch(LexicalPath(real_path).dirname(), requested_path, true);
+    if (!entry->directory_listing.has_value())
+        watch(entry->file.path, requested_path, false);
+    m_entries.set(requested_path, entry.release_value());
+    return &m_entries.find(requested_path)->value;
+}
+
+Optional<FileCache::Entry> FileCache::load(const String& requested_path, const String& real_path)
+{
+    struct stat st;
+    if (stat(real_path.characters(), &st) < 0)
+        return {};
+
+    Entry entry;
+    auto file_path = real_path;
+    if (S_ISDIR(st.st_mode)) {
+        entry.is_directory = true;
+        file_path = LexicalPath::join(real_path, "index.html").string();
+        if (stat(file_path.characters(), &st) < 0 || !S_ISREG(st.st_mode)) {
+            entry.directory_listing = generate_directory_listing(requested_path, real_path);
+            entry.content_type = "text/html";
+            return entry;
+        }
+    } else if (!S_ISREG(st.st_mode)) {
+        return {};
+    }
+
+    entry.file = { file_path, (size_t)st.st_size, make_etag(st) };
+    entry.content_type = Core::guess_mime_type_based_on_filename(file_path);
+    entry.last_modified = format_http_date(st.st_mtime);
+
+    auto gzip_path = String::formatted("{}.gz", file_path);
+    struct stat gzip_st;
+    // A copy that is older than the file itself has not caught up with it yet.
+    if (stat(gzip_path.characters(), &gzip_st) == 0 && S_ISREG(gzip_st.st_mode) && gzip_st.st_mtime >= st.st_mtime)
+        entry.gzip_file = File { gzip_path, (size_t)gzip_st.st_size, make_etag(gzip_st) };
+
+    return entry;
+}
+
+void FileCache::watch(const String& path, const String& requested_path, bool is_directory)
+{
+    auto& dependents = m_dependents.ensure(path);
+    if (!dependents.contains_slow(requested_path))
+        dependents.append(requested_path);
+
+    auto mask = Core::FileWatcherEvent::Type::Deleted | Core::FileWatcherEvent::Type::MetadataModified;
+    if (is_directory)
+        mask |= Core::FileWatcherEvent::Type::ChildCreated | Core::FileWatcherEvent::Type::ChildDeleted;
+    else
+        mask |= Core::FileWatcherEvent::Type::ContentModified;
+
+    // Adding a watch for a path that is already being watched does nothing.
+    auto result = m_watcher->add_watch(path, mask);
+    if (result.is_error())
+        dbgln("WebServer: {}", result.error());
+}
+
+void FileCache::invalidate(const String& path)
+{
+    auto it = m_dependents.find(path);
+    if (it == m_dependents.end())
+        return;
+    for (auto& requested_path : it->value)
+        m_entries.remove(requested_path);
+    m_dependents.remove(it);
+}
+
+void FileCache::clear()
+{
+    for (auto& it : m_dependents)
+        (void)m_watcher->remove_watch(it.key);
+    m_dependents.clear();
+    m_entries.clear();
+}
+
+}
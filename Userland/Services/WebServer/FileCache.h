@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/FileWatcher.h>
+
+namespace WebServer {
+
+// Remembers what the paths under the root are, so that a request only needs to touch the file system
+// to send file contents. Every cached path is watched, and forgotten as soon as it changes.
+class FileCache {
+    AK_MAKE_NONCOPYABLE(FileCache);
+    AK_MAKE_NONMOVABLE(FileCache);
+
+public:
+    struct File {
+        String path;
+        size_t size { 0 };
+        String etag;
+    };
+
+    struct Entry {
+        // Whether the requested path is a directory, which is served from its index.html or a listing.
+        bool is_directory { false };
+        Optional<String> directory_listing;
+
+        File file;
+        // A precompressed copy of the file, the same path with ".gz" appended.
+        Optional<File> gzip_file;
+        String content_type;
+        String last_modified;
+    };
+
+    explicit FileCache(String root_path);
+    ~FileCache();
+
+    const String& root_path() const { return m_root_path; }
+
+    // The entry is valid until the next call. Returns nothing if there is nothing to serve at the path.
+    const Entry* find(const String& requested_path);
+
+private:
+    Optional<Entry> load(const String& requested_path, const String& real_path);
+    void watch(const String& path, const String& requested_path, bool is_directory);
+    void invalidate(const String& path);
+    void clear();
+
+    String m_root_path;
+    RefPtr<Core::FileWatcher> m_watcher;
+    HashMap<String, Entry> m_entries;
+    // The cached requested paths that have to be loaded again when something happens to a real path.
+    HashMap<String, Vector<String>> m_dependents;
+    Entry m_uncached_entry;
+};
+
+}
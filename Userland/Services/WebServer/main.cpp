@@ -5,14 +5,71 @@
  */
 
 #include "Client.h"
-#include <AK/MappedFile.h>
+#include <AK/IPv4Address.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
-#include <LibCore/TCPServer.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/SocketAddress.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+static int create_listening_socket(const IPv4Address& address, u16 port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int option = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+
+    auto socket_address = Core::SocketAddress(address, port);
+    auto in = socket_address.to_sockaddr_in();
+    if (bind(fd, (const sockaddr*)&in, sizeof(in)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, 128) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Every worker waits for connections on the same listening socket, and whichever one the kernel wakes
+// up first gets to accept them.
+static int run_worker(int listen_fd, const String& root_path)
+{
+    Core::EventLoop loop;
+    WebServer::FileCache file_cache(root_path);
+
+    auto notifier = Core::Notifier::construct(listen_fd, Core::Notifier::Event::Read);
+    notifier->on_ready_to_read = [&] {
+        for (;;) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    perror("accept");
+                return;
+            }
+            auto client = WebServer::Client::construct(fd, file_cache, notifier);
+            client->start();
+        }
+    };
+
+    return loop.exec();
+}
+
 int main(int argc, char** argv)
 {
     String default_listen_address = "0.0.0.0";
@@ -21,10 +78,12 @@ int main(int argc, char** argv)
 
     String listen_address = default_listen_address;
     int port = default_port;
+    int worker_count = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
+    args_parser.add_option(worker_count, "Number of worker processes", "workers", 'w', "count");
     args_parser.add_positional_argument(root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -39,6 +98,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (worker_count < 1) {
+        warnln("Invalid number of workers: {}", worker_count);
+        return 1;
+    }
+
     auto real_root_path = Core::File::real_path_for(root_path);
 
     if (!Core::File::exists(real_root_path)) {
@@ -46,28 +110,21 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (pledge("stdio accept rpath inet unix", nullptr) < 0) {
+    if (pledge("stdio accept rpath inet unix proc", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
 
-    Core::EventLoop loop;
-
-    auto server = Core::TCPServer::construct();
-
-    server->on_ready_to_accept = [&] {
-        auto client_socket = server->accept();
-        VERIFY(client_socket);
-        auto client = WebServer::Client::construct(client_socket.release_nonnull(), real_root_path, server);
-        client->start();
-    };
+    // Clients that go away in the middle of a response shouldn't take their worker with them.
+    signal(SIGPIPE, SIG_IGN);
 
-    if (!server->listen(ipv4_address.value(), port)) {
+    int listen_fd = create_listening_socket(ipv4_address.value(), port);
+    if (listen_fd < 0) {
         warnln("Failed to listen on {}:{}", ipv4_address.value(), port);
         return 1;
     }
 
-    outln("Listening on {}:{}", ipv4_address.value(), port);
+    outln("Listening on {}:{} with {} worker(s)", ipv4_address.value(), port, worker_count);
 
     if (unveil("/res/icons", "r") < 0) {
         perror("unveil");
@@ -81,10 +138,48 @@ int main(int argc, char** argv)
 
     unveil(nullptr, nullptr);
 
-    if (pledge("stdio accept rpath", nullptr) < 0) {
+    if (worker_count == 1) {
+        if (pledge("stdio accept rpath", nullptr) < 0) {
+            perror("pledge");
+            return 1;
+        }
+        return run_worker(listen_fd, real_root_path);
+    }
+
+    // The workers are processes rather than threads, since an event loop's state is shared by all
+    // of a process's threads. They are forked before any event loop exists, so each one starts
+    // out with its own.
+    for (int i = 0; i < worker_count; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            if (pledge("stdio accept rpath", nullptr) < 0) {
+                perror("pledge");
+                return 1;
+            }
+            return run_worker(listen_fd, real_root_path);
+        }
+    }
+
+    if (pledge("stdio proc", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
 
-    return loop.exec();
+    for (;;) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != ECHILD)
+                perror("waitpid");
+            break;
+        }
+        warnln("Worker {} exited with status {}", pid, status);
+    }
+    return 1;
 }
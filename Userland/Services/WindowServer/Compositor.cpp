@@ -12,6 +12,7 @@
 #include "Window.h"
 #include "WindowManager.h"
 #include <AK/Debug.h>
+#include <AK/HashMap.h>
 #include <AK/Memory.h>
 #include <AK/ScopeGuard.h>
 #include <LibCore/Timer.h>
@@ -39,25 +40,19 @@ static WallpaperMode mode_to_enum(const String& name)
     return WallpaperMode::Center;
 }
 
+// There's no way to find out the display's refresh rate (or to wait for its vertical blank), so frames are paced
+// as if it was 60 Hz.
+static constexpr int frame_interval_ms = 1000 / 60;
+
+// With FRAME_TIMING_DEBUG, frame statistics are logged this often.
+static constexpr unsigned frames_per_statistics_dump = 600;
+
 Compositor::Compositor()
 {
-    m_display_link_notify_timer = add<Core::Timer>(
-        1000 / 60, [this] {
-            notify_display_links();
-        });
-    m_display_link_notify_timer->stop();
-
     m_compose_timer = Core::Timer::create_single_shot(
-        1000 / 60,
+        frame_interval_ms,
         [this] {
-            compose();
-        },
-        this);
-
-    m_immediate_compose_timer = Core::Timer::create_single_shot(
-        0,
-        [this] {
-            compose();
+            compose_frame();
         },
         this);
 
@@ -116,9 +111,10 @@ void Compositor::compose()
         return;
     }
 
-    if (m_occlusions_dirty) {
-        m_occlusions_dirty = false;
+    if (m_occlusions_dirty || !m_dirty_occlusion_rects.is_empty()) {
         recompute_occlusions();
+        m_occlusions_dirty = false;
+        m_dirty_occlusion_rects.clear();
     }
 
     auto dirty_screen_rects = move(m_dirty_screen_rects);
@@ -496,6 +492,7 @@ void Compositor::compose()
         flush(rect);
     for (auto& rect : flush_special_rects.rects())
         flush(rect);
+    Screen::the().flush_queued_rects();
 }
 
 void Compositor::flush(const Gfx::IntRect& a_rect)
@@ -528,6 +525,7 @@ void Compositor::flush(const Gfx::IntRect& a_rect)
     } else {
         to_ptr = front_ptr;
         from_ptr = back_ptr;
+        Screen::the().queue_flush_rect(rect);
     }
 
     for (int y = 0; y < rect.height(); ++y) {
@@ -566,12 +564,58 @@ void Compositor::invalidate_window()
 
 void Compositor::start_compose_async_timer()
 {
-    // We delay composition by a timer interval, but to not affect latency too
-    // much, if a pending compose is not already scheduled, we also schedule an
-    // immediate compose the next spin of the event loop.
-    if (!m_compose_timer->is_active()) {
-        m_compose_timer->start();
-        m_immediate_compose_timer->start();
+    // We compose at most once per frame, at a steady pace from the last frame. But to not affect
+    // latency too much, if the last frame is already a whole frame ago, we compose on the next
+    // spin of the event loop.
+    if (m_compose_timer->is_active())
+        return;
+    int time_until_next_frame = 0;
+    if (m_frame_timer.is_valid())
+        time_until_next_frame = max(0, frame_interval_ms - m_frame_timer.elapsed());
+    m_compose_timer->start(time_until_next_frame);
+
+    if constexpr (FRAME_TIMING_DEBUG) {
+        m_frame_statistics.time_since_scheduled.start();
+        m_frame_statistics.scheduled_delay_ms = time_until_next_frame;
+    }
+}
+
+void Compositor::compose_frame()
+{
+    if constexpr (FRAME_TIMING_DEBUG) {
+        // A frame is late if the event loop was too busy to get to it before the one after it was due.
+        if (m_frame_statistics.time_since_scheduled.elapsed() > m_frame_statistics.scheduled_delay_ms + frame_interval_ms)
+            ++m_frame_statistics.late_frame_count;
+    }
+    m_frame_timer.start();
+
+    compose();
+
+    if constexpr (FRAME_TIMING_DEBUG) {
+        auto compose_time = m_frame_timer.elapsed();
+        auto& statistics = m_frame_statistics;
+        ++statistics.frame_count;
+        statistics.total_compose_time_ms += compose_time;
+        statistics.max_compose_time_ms = max(statistics.max_compose_time_ms, compose_time);
+        if (compose_time > frame_interval_ms)
+            ++statistics.slow_frame_count;
+        if (statistics.frame_count == frames_per_statistics_dump) {
+            dbgln("Compositor: {} frames, compose time avg {} ms, max {} ms, {} took longer than a frame, {} ticked late",
+                statistics.frame_count, statistics.total_compose_time_ms / statistics.frame_count, statistics.max_compose_time_ms,
+                statistics.slow_frame_count, statistics.late_frame_count);
+            statistics.frame_count = 0;
+            statistics.slow_frame_count = 0;
+            statistics.late_frame_count = 0;
+            statistics.total_compose_time_ms = 0;
+            statistics.max_compose_time_ms = 0;
+        }
+    }
+
+    // Display links are notified right after a frame, so the clients have as much time as possible to
+    // paint the next one. As long as there are any, we keep ticking every frame for them.
+    if (m_display_link_count) {
+        notify_display_links();
+        start_compose_async_timer();
     }
 }
 
@@ -809,15 +853,13 @@ void Compositor::increment_display_link_count(Badge<ClientConnection>)
 {
     ++m_display_link_count;
     if (m_display_link_count == 1)
-        m_display_link_notify_timer->start();
+        start_compose_async_timer();
 }
 
 void Compositor::decrement_display_link_count(Badge<ClientConnection>)
 {
     VERIFY(m_display_link_count);
     --m_display_link_count;
-    if (!m_display_link_count)
-        m_display_link_notify_timer->stop();
 }
 
 bool Compositor::any_opaque_window_above_this_one_contains_rect(const Window& a_window, const Gfx::IntRect& rect)
@@ -849,7 +891,30 @@ bool Compositor::any_opaque_window_above_this_one_contains_rect(const Window& a_
 void Compositor::recompute_occlusions()
 {
     auto& wm = WindowManager::the();
+    auto screen_rect = Screen::the().rect();
+
+    // Most of the time only a few windows have moved, been resized, or changed stacking order, and
+    // only the occlusions within their old and new rects can have changed. Those are recomputed,
+    // and everything outside of them is left alone.
+    // With a fullscreen window, every other window is simply treated as hidden, so leaving that state
+    // (or entering it) needs everything recomputed.
+    bool has_fullscreen_window = wm.active_fullscreen_window() != nullptr;
+    bool is_partial = !m_occlusions_dirty && !wm.m_switcher.is_visible() && !has_fullscreen_window && !m_occlusions_had_fullscreen_window;
+    m_occlusions_had_fullscreen_window = has_fullscreen_window;
+    Gfx::DisjointRectSet region;
+    if (is_partial)
+        region = m_dirty_occlusion_rects.intersected(screen_rect);
+    else
+        region = screen_rect;
+    auto is_affected = [&](Window& window) {
+        return !is_partial || region.intersects(window.frame().render_rect());
+    };
+
+    dbgln_if(OCCLUSIONS_DEBUG, "OCCLUSIONS: recomputing {}", is_partial ? "partially" : "everything");
+
     wm.for_each_visible_window_from_back_to_front([&](Window& window) {
+        if (!is_affected(window))
+            return IterationDecision::Continue;
         if (wm.m_switcher.is_visible()) {
             window.set_occluded(false);
         } else {
@@ -861,10 +926,6 @@ void Compositor::recompute_occlusions()
         return IterationDecision::Continue;
     });
 
-    dbgln_if(OCCLUSIONS_DEBUG, "OCCLUSIONS:");
-
-    auto screen_rect = Screen::the().rect();
-
     if (auto* fullscreen_window = wm.active_fullscreen_window()) {
         WindowManager::the().for_each_visible_window_from_front_to_back([&](Window& w) {
             auto& visible_opaque = w.opaque_rects();
@@ -890,9 +951,22 @@ void Compositor::recompute_occlusions()
 
         m_opaque_wallpaper_rects.clear();
     } else {
-        Gfx::DisjointRectSet visible_rects(screen_rect);
+        // What the affected windows had outside of the region is still correct, and is put back in the end.
+        struct RectsOutsideRegion {
+            Gfx::DisjointRectSet opaque_rects;
+            Gfx::DisjointRectSet transparency_rects;
+            Gfx::DisjointRectSet transparency_wallpaper_rects;
+        };
+        HashMap<Window*, RectsOutsideRegion> rects_outside_region;
+
+        auto visible_rects = region.clone();
         bool have_transparent = false;
         WindowManager::the().for_each_visible_window_from_front_to_back([&](Window& w) {
+            if (!is_affected(w))
+                return IterationDecision::Continue;
+            if (is_partial && !w.is_minimized())
+                rects_outside_region.set(&w, { w.opaque_rects().shatter(region), w.transparency_rects().shatter(region), w.transparency_wallpaper_rects().shatter(region) });
+
             w.transparency_wallpaper_rects().clear();
             auto& visible_opaque = w.opaque_rects();
             auto& transparency_rects = w.transparency_rects();
@@ -902,8 +976,8 @@ void Compositor::recompute_occlusions()
                 return IterationDecision::Continue;
             }
 
-            auto transparent_render_rects = w.frame().transparent_render_rects().intersected(screen_rect);
-            auto opaque_render_rects = w.frame().opaque_render_rects().intersected(screen_rect);
+            auto transparent_render_rects = w.frame().transparent_render_rects().intersected(region);
+            auto opaque_render_rects = w.frame().opaque_render_rects().intersected(region);
             if (transparent_render_rects.is_empty() && opaque_render_rects.is_empty()) {
                 visible_opaque.clear();
                 transparency_rects.clear();
@@ -941,6 +1015,7 @@ void Compositor::recompute_occlusions()
                         // This window (including frame) is entirely covered by another opaque window
                         visible_opaque.clear();
                         transparency_rects.clear();
+                        rects_outside_region.remove(&w);
                         return IterationDecision::Break;
                     }
                     if (!visible_opaque.is_empty()) {
@@ -980,6 +1055,8 @@ void Compositor::recompute_occlusions()
         if (have_transparent) {
             // Determine what transparent window areas need to render the wallpaper first
             WindowManager::the().for_each_visible_window_from_back_to_front([&](Window& w) {
+                if (!is_affected(w))
+                    return IterationDecision::Continue;
                 auto& transparency_wallpaper_rects = w.transparency_wallpaper_rects();
                 if (w.is_minimized()) {
                     transparency_wallpaper_rects.clear();
@@ -999,7 +1076,20 @@ void Compositor::recompute_occlusions()
             });
         }
 
-        m_opaque_wallpaper_rects = move(visible_rects);
+        for (auto& it : rects_outside_region) {
+            auto& w = *it.key;
+            w.opaque_rects().add(it.value.opaque_rects);
+            w.transparency_rects().add(it.value.transparency_rects);
+            w.transparency_wallpaper_rects().add(it.value.transparency_wallpaper_rects);
+        }
+
+        if (is_partial) {
+            auto opaque_wallpaper_rects = m_opaque_wallpaper_rects.shatter(region);
+            opaque_wallpaper_rects.add(visible_rects);
+            m_opaque_wallpaper_rects = move(opaque_wallpaper_rects);
+        } else {
+            m_opaque_wallpaper_rects = move(visible_rects);
+        }
     }
 
     if constexpr (OCCLUSIONS_DEBUG) {
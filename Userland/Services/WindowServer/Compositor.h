@@ -8,6 +8,7 @@
 
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/Object.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
@@ -52,6 +53,8 @@ public:
     void decrement_display_link_count(Badge<ClientConnection>);
 
     void invalidate_occlusions() { m_occlusions_dirty = true; }
+    // Only the occlusions within rect need to be recomputed, e.g. because a window has moved away from there.
+    void invalidate_occlusions(const Gfx::IntRect& rect) { m_dirty_occlusion_rects.add(rect); }
 
     void did_construct_window_manager(Badge<WindowManager>);
 
@@ -65,6 +68,7 @@ private:
     void run_animations(Gfx::DisjointRectSet&);
     void notify_display_links();
     void start_compose_async_timer();
+    void compose_frame();
     void recompute_occlusions();
     bool any_opaque_window_above_this_one_contains_rect(const Window&, const Gfx::IntRect&);
     void change_cursor(const Cursor*);
@@ -73,11 +77,23 @@ private:
     bool draw_geometry_label(Gfx::IntRect&);
 
     RefPtr<Core::Timer> m_compose_timer;
-    RefPtr<Core::Timer> m_immediate_compose_timer;
+    Core::ElapsedTimer m_frame_timer { true };
+
+    struct FrameStatistics {
+        unsigned frame_count { 0 };
+        unsigned slow_frame_count { 0 };
+        unsigned late_frame_count { 0 };
+        int total_compose_time_ms { 0 };
+        int max_compose_time_ms { 0 };
+        Core::ElapsedTimer time_since_scheduled { true };
+        int scheduled_delay_ms { 0 };
+    };
+    FrameStatistics m_frame_statistics;
     bool m_flash_flush { false };
     bool m_buffers_are_flipped { false };
     bool m_screen_can_set_buffer { false };
     bool m_occlusions_dirty { true };
+    bool m_occlusions_had_fullscreen_window { false };
     bool m_invalidated_any { true };
     bool m_invalidated_window { false };
     bool m_invalidated_cursor { false };
@@ -90,6 +106,7 @@ private:
     OwnPtr<Gfx::Painter> m_temp_painter;
 
     Gfx::DisjointRectSet m_dirty_screen_rects;
+    Gfx::DisjointRectSet m_dirty_occlusion_rects;
     Gfx::DisjointRectSet m_opaque_wallpaper_rects;
 
     RefPtr<Gfx::Bitmap> m_cursor_back_bitmap;
@@ -106,7 +123,6 @@ private:
     unsigned m_current_cursor_frame { 0 };
     RefPtr<Core::Timer> m_cursor_timer;
 
-    RefPtr<Core::Timer> m_display_link_notify_timer;
     size_t m_display_link_count { 0 };
 
     Optional<Gfx::Color> m_custom_background_color;
@@ -12,6 +12,7 @@
 #include <AK/Debug.h>
 #include <Kernel/API/FB.h>
 #include <Kernel/API/MousePacket.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/mman.h>
@@ -107,6 +108,28 @@ void Screen::set_buffer(int index)
     VERIFY(rc == 0);
 }
 
+void Screen::queue_flush_rect(const Gfx::IntRect& physical_rect)
+{
+    if (!m_can_flush_rects || physical_rect.is_empty())
+        return;
+    m_queued_flush_rects.append({ (unsigned)physical_rect.x(), (unsigned)physical_rect.y(), (unsigned)physical_rect.width(), (unsigned)physical_rect.height() });
+}
+
+void Screen::flush_queued_rects()
+{
+    if (m_queued_flush_rects.is_empty())
+        return;
+    FBRects rects { (unsigned)m_queued_flush_rects.size(), m_queued_flush_rects.data() };
+    if (fb_flush_rects(m_framebuffer_fd, &rects) < 0) {
+        // NOTE: Most display adapters keep showing the framebuffer by themselves, and don't need this at all.
+        if (errno == ENOTIMPL)
+            m_can_flush_rects = false;
+        else
+            perror("fb_flush_rects");
+    }
+    m_queued_flush_rects.clear_with_capacity();
+}
+
 void Screen::set_acceleration_factor(double factor)
 {
     VERIFY(factor >= mouse_accel_min && factor <= mouse_accel_max);
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/Vector.h>
 #include <Kernel/API/KeyCode.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/Rect.h>
 #include <LibGfx/Size.h>
+#include <sys/ioctl.h>
 
 struct MousePacket;
 
@@ -28,6 +30,10 @@ public:
     bool can_set_buffer() { return m_can_set_buffer; }
     void set_buffer(int index);
 
+    // Some display adapters only show the parts of the framebuffer that they're told have changed.
+    void queue_flush_rect(const Gfx::IntRect& physical_rect);
+    void flush_queued_rects();
+
     int physical_width() const { return width() * scale_factor(); }
     int physical_height() const { return height() * scale_factor(); }
     size_t pitch() const { return m_pitch; }
@@ -65,6 +71,8 @@ private:
 
     Gfx::RGBA32* m_framebuffer { nullptr };
     bool m_can_set_buffer { false };
+    bool m_can_flush_rects { true };
+    Vector<FBRect, 32> m_queued_flush_rects;
 
     int m_pitch { 0 };
     int m_width { 0 };
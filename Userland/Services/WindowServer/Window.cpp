@@ -323,7 +323,7 @@ void Window::set_opacity(float opacity)
     bool was_opaque = is_opaque();
     m_opacity = opacity;
     if (was_opaque != is_opaque())
-        Compositor::the().invalidate_occlusions();
+        Compositor::the().invalidate_occlusions(frame().render_rect());
     invalidate(false);
     WindowManager::the().notify_opacity_changed(*this);
 }
@@ -333,7 +333,7 @@ void Window::set_has_alpha_channel(bool value)
     if (m_has_alpha_channel == value)
         return;
     m_has_alpha_channel = value;
-    Compositor::the().invalidate_occlusions();
+    Compositor::the().invalidate_occlusions(frame().render_rect());
 }
 
 void Window::set_occluded(bool occluded)
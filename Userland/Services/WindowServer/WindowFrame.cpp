@@ -474,7 +474,7 @@ void WindowFrame::set_opacity(float opacity)
     bool was_opaque = is_opaque();
     m_opacity = opacity;
     if (was_opaque != is_opaque())
-        Compositor::the().invalidate_occlusions();
+        Compositor::the().invalidate_occlusions(render_rect());
     Compositor::the().invalidate_screen(render_rect());
     WindowManager::the().notify_opacity_changed(m_window);
 }
@@ -581,7 +581,8 @@ void WindowFrame::notify_window_rect_changed(const Gfx::IntRect& old_rect, const
     if (!m_window.is_opaque())
         compositor.invalidate_screen(new_frame_rect);
 
-    compositor.invalidate_occlusions();
+    compositor.invalidate_occlusions(old_frame_rect);
+    compositor.invalidate_occlusions(new_frame_rect);
 
     WindowManager::the().notify_rect_changed(m_window, old_rect, new_rect);
 }
@@ -222,8 +222,6 @@ void WindowManager::move_to_front_and_make_active(Window& window)
         move_window_to_front(w, is_stack_top, is_stack_top);
         return IterationDecision::Continue;
     });
-
-    Compositor::the().invalidate_occlusions();
 }
 
 void WindowManager::do_move_to_front(Window& window, bool make_active, bool make_input)
@@ -232,6 +230,7 @@ void WindowManager::do_move_to_front(Window& window, bool make_active, bool make
         window.invalidate();
     m_windows_in_order.remove(window);
     m_windows_in_order.append(window);
+    Compositor::the().invalidate_occlusions(window.frame().render_rect());
 
     if (make_active)
         set_active_window(&window, make_input);
@@ -425,9 +424,9 @@ void WindowManager::notify_rect_changed(Window& window, const Gfx::IntRect& old_
     reevaluate_hovered_window(&window);
 }
 
-void WindowManager::notify_opacity_changed(Window&)
+void WindowManager::notify_opacity_changed(Window& window)
 {
-    Compositor::the().invalidate_occlusions();
+    Compositor::the().invalidate_occlusions(window.frame().render_rect());
 }
 
 void WindowManager::notify_minimization_state_changed(Window& window)
@@ -1396,6 +1395,16 @@ void WindowManager::set_active_window(Window* window, bool make_input)
 
     auto* previously_active_window = m_active_window.ptr();
 
+    // Window shapes may change (e.g. shadows for inactive/active windows), so the occlusions
+    // around both windows need to be recomputed, before and after.
+    auto invalidate_occlusions_around = [&] {
+        if (previously_active_window)
+            Compositor::the().invalidate_occlusions(previously_active_window->frame().render_rect());
+        if (window)
+            Compositor::the().invalidate_occlusions(window->frame().render_rect());
+    };
+    invalidate_occlusions_around();
+
     if (previously_active_window) {
         Core::EventLoop::current().post_event(*previously_active_window, make<Event>(Event::WindowDeactivated));
         previously_active_window->invalidate(true, true);
@@ -1411,8 +1420,7 @@ void WindowManager::set_active_window(Window* window, bool make_input)
         tell_wms_window_state_changed(*m_active_window);
     }
 
-    // Window shapes may have changed (e.g. shadows for inactive/active windows)
-    Compositor::the().invalidate_occlusions();
+    invalidate_occlusions_around();
 }
 
 bool WindowManager::set_hovered_window(Window* window)
@@ -1550,6 +1550,29 @@ void Execute::for_each_entry(RefPtr<Shell> shell, Function<IterationDecision(Non
     auto commands = shell->expand_aliases(m_command->run(shell)->resolve_as_commands(shell));
 
     if (m_capture_stdout) {
+        // A builtin that only prints something doesn't need a child process (or an event loop) to capture that from.
+        if (commands.size() == 1) {
+            if (auto output = shell->run_builtin_capturing_output(commands.first()); output.has_value()) {
+                auto ifs = shell->local_variable_or("IFS", "\n");
+                StringView remaining { output->data(), output->size() };
+                while (!remaining.is_empty()) {
+                    auto offset = ifs.is_empty() ? Optional<size_t> {} : remaining.find(ifs);
+                    if (!offset.has_value()) {
+                        callback(create<StringValue>(remaining));
+                        break;
+                    }
+                    if (offset.value() == 0) {
+                        if (shell->options.inline_exec_keep_empty_segments && callback(create<StringValue>("")) == IterationDecision::Break)
+                            return;
+                    } else if (callback(create<StringValue>(remaining.substring_view(0, offset.value()))) == IterationDecision::Break) {
+                        return;
+                    }
+                    remaining = remaining.substring_view(offset.value() + ifs.length());
+                }
+                return;
+            }
+        }
+
         int pipefd[2];
         int rc = pipe(pipefd);
         if (rc < 0) {
@@ -16,6 +16,7 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <signal.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -1113,6 +1114,57 @@ bool Shell::run_builtin(const AST::Command& command, const NonnullRefPtrVector<A
     return false;
 }
 
+// Whether the builtin doesn't change anything about the shell, and so running it right here is no different from
+// running it in a child process (which is what capturing its output would otherwise take).
+static bool only_prints_something(const AST::Command& command)
+{
+    auto& name = command.argv.first();
+    if (name.is_one_of("pwd", "type", "glob", "jobs", "history"))
+        return true;
+    // These only print what's there when they aren't given anything to change.
+    if (name.is_one_of("alias", "export", "umask", "dirs"))
+        return command.argv.size() == 1;
+    return false;
+}
+
+Optional<ByteBuffer> Shell::run_builtin_capturing_output(const AST::Command& command)
+{
+    if (command.argv.is_empty() || command.pipeline || !command.next_chain.is_empty() || !command.redirections.is_empty() || !m_global_redirections.is_empty())
+        return {};
+    if (!has_builtin(command.argv.first()) || !only_prints_something(command))
+        return {};
+
+    // The output goes into a file in /tmp (which lives in memory) rather than a pipe, since nobody would be
+    // reading from a pipe while the builtin runs.
+    char path[] = "/tmp/shell-capture.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return {};
+    unlink(path);
+    ScopeGuard close_fd { [fd] { close(fd); } };
+
+    NonnullRefPtrVector<AST::Rewiring> rewirings;
+    rewirings.append(adopt_ref(*new AST::Rewiring(fd, STDOUT_FILENO)));
+    fflush(stdout);
+    if (!run_builtin(command, rewirings, last_return_code))
+        return {};
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || lseek(fd, 0, SEEK_SET) < 0)
+        return {};
+    auto output = ByteBuffer::create_uninitialized(st.st_size);
+    size_t offset = 0;
+    while (offset < output.size()) {
+        auto nread = read(fd, output.offset_pointer(offset), output.size() - offset);
+        if (nread < 0 && errno == EINTR)
+            continue;
+        if (nread <= 0)
+            return {};
+        offset += nread;
+    }
+    return output;
+}
+
 bool Shell::has_builtin(const StringView& name) const
 {
 #define __ENUMERATE_SHELL_BUILTIN(builtin) \
@@ -545,8 +545,11 @@ int Shell::run_command(const StringView& cmd, Optional<SourcePosition> source_po
     if (cmd.is_empty())
         return 0;
 
-    auto command = Parser(cmd, m_is_interactive).parse();
+    return run_parsed_command(Parser(cmd, m_is_interactive).parse());
+}
 
+int Shell::run_parsed_command(RefPtr<AST::Node> command)
+{
     if (!command)
         return 0;
 
@@ -1032,8 +1035,30 @@ bool Shell::run_file(const String& filename, bool explicitly_invoked)
         return false;
     }
     auto file = file_result.value();
+
+    // Scripts that are sourced over and over (say, from a loop, or every prompt) only get parsed once,
+    // unless they change in the meantime.
+    struct stat st;
+    bool has_stat = fstat(file->fd(), &st) == 0;
+    if (has_stat) {
+        auto cached_script = m_script_cache.get(filename);
+        if (cached_script.has_value() && cached_script->modification_time == st.st_mtime && cached_script->size == st.st_size) {
+            VERIFY(!m_default_constructed);
+            take_error();
+            return run_parsed_command(cached_script->ast) == 0;
+        }
+    }
+
     auto data = file->read_all();
-    return run_command(data) == 0;
+    if (data.is_empty())
+        return true;
+    auto ast = Parser(data, m_is_interactive).parse();
+    if (has_stat)
+        m_script_cache.set(filename, { st.st_mtime, st.st_size, ast });
+
+    VERIFY(!m_default_constructed);
+    take_error();
+    return run_parsed_command(move(ast)) == 0;
 }
 
 bool Shell::is_allowed_to_modify_termios(const AST::Command& command) const
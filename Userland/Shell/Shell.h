@@ -90,6 +90,8 @@ public:
     NonnullRefPtrVector<Job> run_commands(Vector<AST::Command>&);
     bool run_file(const String&, bool explicitly_invoked = true);
     bool run_builtin(const AST::Command&, const NonnullRefPtrVector<AST::Rewiring>&, int& retval);
+    // Runs the command right here with its output captured, if it's a builtin that doesn't need a child process for that.
+    Optional<ByteBuffer> run_builtin_capturing_output(const AST::Command&);
     bool has_builtin(const StringView&) const;
     RefPtr<AST::Node> run_immediate_function(StringView name, AST::ImmediateExpression& invoking_node, const NonnullRefPtrVector<AST::Node>&);
     static bool has_immediate_function(const StringView&);
@@ -280,6 +282,8 @@ private:
 
     bool is_allowed_to_modify_termios(const AST::Command&) const;
 
+    int run_parsed_command(RefPtr<AST::Node>);
+
     // FIXME: Port to Core::Property
     void save_to(JsonObject&);
     void bring_cursor_to_beginning_of_a_line() const;
@@ -336,6 +340,13 @@ private:
     };
 
     HashMap<String, ShellFunction> m_functions;
+
+    struct CachedScript {
+        time_t modification_time { 0 };
+        off_t size { 0 };
+        RefPtr<AST::Node> ast;
+    };
+    HashMap<String, CachedScript> m_script_cache;
     NonnullOwnPtrVector<LocalFrame> m_local_frames;
     NonnullRefPtrVector<AST::Redirection> m_global_redirections;
 
@@ -4,14 +4,80 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Result.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <errno.h>
 #include <stdio.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+struct CopyError {
+    String path;
+    OSError error_code;
+};
+
+// Copies a directory tree, with the directories further down read ahead of time on other threads.
+static Result<void, CopyError> copy_directory(String const& destination, String const& source, Core::File::LinkMode link_mode)
+{
+    if (mkdir(destination.characters(), 0755) < 0)
+        return CopyError { source, OSError(errno) };
+
+    // Don't copy a directory into itself, since that would go on forever.
+    auto source_real_path = String::formatted("{}/", Core::File::real_path_for(source));
+    auto destination_real_path = String::formatted("{}/", Core::File::real_path_for(destination));
+    if (destination_real_path.starts_with(source_real_path))
+        return CopyError { source, OSError(EINVAL) };
+
+    auto my_umask = umask(0);
+    umask(my_umask);
+
+    Optional<CopyError> error;
+    auto destination_for = [&](String const& path) {
+        return String::formatted("{}{}", destination, path.substring_view(source.length()));
+    };
+
+    // Like Core::File::copy_file_or_directory(), this copies what symlinks point to, rather than the links themselves.
+    Threading::DirectoryWalker walker({ .follow_symlinks = true, .follow_root_symlink = true, .stat_entries = Threading::DirectoryWalker::StatEntries::DirectoriesOnly });
+    walker.on_enter = [&](auto& entry) {
+        if (error.has_value())
+            return Threading::DirectoryWalker::Decision::SkipChildren;
+        if (entry.depth == 0)
+            return Threading::DirectoryWalker::Decision::Continue;
+        if (entry.is_directory()) {
+            if (mkdir(destination_for(entry.path).characters(), 0755) < 0) {
+                error = CopyError { entry.path, OSError(errno) };
+                return Threading::DirectoryWalker::Decision::SkipChildren;
+            }
+            return Threading::DirectoryWalker::Decision::Continue;
+        }
+        auto result = Core::File::copy_file_or_directory(destination_for(entry.path), entry.path, Core::File::RecursionMode::Disallowed, link_mode, Core::File::AddDuplicateFileMarker::No);
+        if (result.is_error())
+            error = CopyError { entry.path, result.error().error_code };
+        return Threading::DirectoryWalker::Decision::Continue;
+    };
+    // Directories get their permissions once everything inside them has been copied, in case they aren't writable.
+    walker.on_leave = [&](auto& entry) {
+        if (error.has_value() || !entry.is_directory())
+            return;
+        if (chmod(destination_for(entry.path).characters(), entry.stat->st_mode & ~my_umask) < 0)
+            error = CopyError { entry.path, OSError(errno) };
+    };
+    walker.on_error = [&](auto& path, int error_code) {
+        if (!error.has_value())
+            error = CopyError { path, OSError(error_code) };
+    };
+    walker.walk(source);
+
+    if (error.has_value())
+        return error.release_value();
+    return {};
+}
+
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath wpath cpath fattr", nullptr) < 0) {
+    if (pledge("stdio rpath wpath cpath fattr thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -32,10 +98,22 @@ int main(int argc, char** argv)
     args_parser.parse(argc, argv);
 
     for (auto& source : sources) {
+        auto link_mode = link ? Core::File::LinkMode::Allowed : Core::File::LinkMode::Disallowed;
+        if (recursion_allowed && Core::File::is_directory(source)) {
+            auto result = copy_directory(destination, source, link_mode);
+            if (result.is_error()) {
+                warnln("cp: unable to copy '{}': {}", result.error().path, result.error().error_code);
+                return 1;
+            }
+            if (verbose)
+                outln("'{}' -> '{}'", source, destination);
+            continue;
+        }
+
         auto result = Core::File::copy_file_or_directory(
             destination, source,
             recursion_allowed ? Core::File::RecursionMode::Allowed : Core::File::RecursionMode::Disallowed,
-            link ? Core::File::LinkMode::Allowed : Core::File::LinkMode::Disallowed,
+            link_mode,
             Core::File::AddDuplicateFileMarker::No);
 
         if (result.is_error()) {
@@ -11,9 +11,9 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/Object.h>
+#include <LibThreading/DirectoryWalker.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <math.h>
@@ -125,33 +125,12 @@ int parse_args(int argc, char** argv, Vector<String>& files, DuOption& du_option
     return 0;
 }
 
-int print_space_usage(const String& path, const DuOption& du_option, int max_depth)
+static void print_entry(const String& path, const struct stat& path_stat, const DuOption& du_option)
 {
-    struct stat path_stat;
-    if (lstat(path.characters(), &path_stat) < 0) {
-        perror("lstat");
-        return 1;
-    }
-
-    if (--max_depth >= 0 && S_ISDIR(path_stat.st_mode)) {
-        auto di = Core::DirIterator(path, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error()) {
-            warnln("DirIterator: {}", di.error_string());
-            return 1;
-        }
-        while (di.has_next()) {
-            const auto child_path = di.next_full_path();
-            if (du_option.all || Core::File::is_directory(child_path)) {
-                if (print_space_usage(child_path, du_option, max_depth))
-                    return 1;
-            }
-        }
-    }
-
     const auto basename = LexicalPath(path).basename();
     for (const auto& pattern : du_option.excluded_patterns) {
         if (basename.matches(pattern, CaseSensitivity::CaseSensitive))
-            return 0;
+            return;
     }
 
     off_t size = path_stat.st_size;
@@ -161,7 +140,7 @@ int print_space_usage(const String& path, const DuOption& du_option, int max_dep
     }
 
     if ((du_option.threshold > 0 && size < du_option.threshold) || (du_option.threshold < 0 && size > -du_option.threshold))
-        return 0;
+        return;
 
     const long long block_size = 1024;
     size = size / block_size + (size % block_size != 0);
@@ -183,6 +162,25 @@ int print_space_usage(const String& path, const DuOption& du_option, int max_dep
         const auto formatted_time = Core::DateTime::from_timestamp(time).to_string();
         outln("{}\t{}\t{}", size, formatted_time, path);
     }
+}
 
-    return 0;
+int print_space_usage(const String& path, const DuOption& du_option, int max_depth)
+{
+    // Without --all, only directories get printed, so there's no need to stat anything else.
+    Threading::DirectoryWalker::Options options;
+    options.stat_entries = du_option.all ? Threading::DirectoryWalker::StatEntries::Yes : Threading::DirectoryWalker::StatEntries::DirectoriesOnly;
+    options.max_depth = max(max_depth, 0);
+
+    int exit_code = 0;
+    Threading::DirectoryWalker walker(options);
+    walker.on_leave = [&](auto& entry) {
+        if (entry.stat.has_value())
+            print_entry(entry.path, entry.stat.value(), du_option);
+    };
+    walker.on_error = [&](auto& error_path, int error) {
+        warnln("du: {}: {}", error_path, strerror(error));
+        exit_code = 1;
+    };
+    walker.walk(path);
+    return exit_code;
 }
@@ -10,12 +10,13 @@
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/Vector.h>
-#include <LibCore/DirIterator.h>
+#include <LibThreading/DirectoryWalker.h>
 #include <errno.h>
 #include <getopt.h>
 #include <grp.h>
 #include <pwd.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -447,33 +448,25 @@ static const char* parse_options(int argc, char* argv[])
     }
 }
 
-static void walk_tree(const char* root_path, Command& command)
+static void walk_tree(String const& root_path, Command& command)
 {
-    command.evaluate(root_path);
-
-    Core::DirIterator dir_iterator(root_path, Core::DirIterator::SkipParentAndBaseDir);
-    if (dir_iterator.has_error() && dir_iterator.error() == ENOTDIR)
-        return;
-
-    while (dir_iterator.has_next()) {
-        auto path = dir_iterator.next_full_path();
-        struct stat stat;
-        if (g_follow_symlinks || ::lstat(path.characters(), &stat) < 0 || !S_ISLNK(stat.st_mode))
-            walk_tree(path.characters(), command);
-        else
-            command.evaluate(path.characters());
-    }
-
-    if (dir_iterator.has_error()) {
-        warnln("{}: {}", root_path, dir_iterator.error_string());
+    // The root is walked into even if it's a symlink, like a path that ends in a slash would be.
+    Threading::DirectoryWalker walker({ .follow_symlinks = g_follow_symlinks, .follow_root_symlink = true });
+    walker.on_enter = [&](auto& entry) {
+        command.evaluate(entry.path.characters());
+        return Threading::DirectoryWalker::Decision::Continue;
+    };
+    walker.on_error = [](auto& path, int error) {
+        warnln("{}: {}", path, strerror(error));
         g_there_was_an_error = true;
-    }
+    };
+    walker.walk(root_path);
 }
 
 int main(int argc, char* argv[])
 {
     LexicalPath root_path(parse_options(argc, argv));
     auto command = parse_all_commands(argv);
-    walk_tree(root_path.string().characters(), *command);
+    walk_tree(root_path.string(), *command);
     return g_there_was_an_error ? 1 : 0;
 }
@@ -4,17 +4,22 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/ByteBuffer.h>
+#include <AK/CharacterTypes.h>
+#include <AK/MappedFile.h>
 #include <AK/ScopeGuard.h>
 #include <AK/String.h>
-#include <AK/Utf8View.h>
+#include <AK/StringBuilder.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibRegex/Regex.h>
+#include <LibThreading/Parallel.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 enum class BinaryFileMode {
@@ -32,9 +37,75 @@ void fail(StringView format, Ts... args)
     abort();
 }
 
+// Finds a fixed string with the Boyer-Moore-Horspool algorithm, which skips ahead by up to the length of the
+// string whenever the byte under its last character doesn't fit.
+class LiteralSearcher {
+public:
+    LiteralSearcher(StringView needle, bool case_insensitive)
+        : m_case_insensitive(case_insensitive)
+    {
+        m_needle = case_insensitive ? needle.to_string().to_lowercase() : needle.to_string();
+        m_skip.fill(max<size_t>(m_needle.length(), 1));
+        for (size_t i = 0; i + 1 < m_needle.length(); ++i)
+            m_skip[(u8)m_needle[i]] = m_needle.length() - 1 - i;
+    }
+
+    size_t length() const { return m_needle.length(); }
+
+    Optional<size_t> find(StringView haystack, size_t start) const
+    {
+        auto length = m_needle.length();
+        if (start + length > haystack.length())
+            return {};
+        if (length == 0)
+            return start;
+
+        auto* bytes = (const u8*)haystack.characters_without_null_termination();
+        if (length == 1 && !m_case_insensitive) {
+            auto* found = (const u8*)memchr(bytes + start, m_needle[0], haystack.length() - start);
+            if (!found)
+                return {};
+            return found - bytes;
+        }
+
+        auto* needle = (const u8*)m_needle.characters();
+        u8 last = needle[length - 1];
+        for (size_t i = start; i + length <= haystack.length();) {
+            u8 byte = fold(bytes[i + length - 1]);
+            if (byte == last && matches_at(bytes + i))
+                return i;
+            i += m_skip[byte];
+        }
+        return {};
+    }
+
+private:
+    u8 fold(u8 byte) const { return m_case_insensitive ? to_ascii_lowercase(byte) : byte; }
+
+    bool matches_at(const u8* bytes) const
+    {
+        if (!m_case_insensitive)
+            return memcmp(bytes, m_needle.characters(), m_needle.length()) == 0;
+        for (size_t i = 0; i < m_needle.length(); ++i) {
+            if (to_ascii_lowercase(bytes[i]) != (u8)m_needle[i])
+                return false;
+        }
+        return true;
+    }
+
+    String m_needle;
+    bool m_case_insensitive { false };
+    Array<size_t, 256> m_skip;
+};
+
+struct Match {
+    size_t offset { 0 };
+    size_t length { 0 };
+};
+
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath", nullptr) < 0) {
+    if (pledge("stdio rpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -43,6 +114,7 @@ int main(int argc, char** argv)
 
     bool recursive { false };
     bool use_ere { true };
+    bool fixed_strings { false };
     const char* pattern = nullptr;
     BinaryFileMode binary_mode { BinaryFileMode::Binary };
     bool case_insensitive = false;
@@ -51,6 +123,7 @@ int main(int argc, char** argv)
     Core::ArgsParser args_parser;
     args_parser.add_option(recursive, "Recursively scan files starting in working directory", "recursive", 'r');
     args_parser.add_option(use_ere, "Extended regular expressions (default)", "extended-regexp", 'E');
+    args_parser.add_option(fixed_strings, "Treat the pattern as a fixed string instead of a regular expression", "fixed-strings", 'F');
     args_parser.add_option(pattern, "Pattern", "regexp", 'e', "Pattern");
     args_parser.add_option(case_insensitive, "Make matches case-insensitive", nullptr, 'i');
     args_parser.add_option(invert_match, "Select non-matching lines", "invert-match", 'v');
@@ -93,80 +166,149 @@ int main(int argc, char** argv)
     args_parser.add_positional_argument(files, "File(s) to process", "file", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
-    if (!use_ere)
+    if (!use_ere && !fixed_strings)
         return 0;
 
     // mock grep behaviour: if -e is omitted, use first positional argument as pattern
     if (pattern == nullptr && files.size())
         pattern = files.take_first();
 
+    if (pattern == nullptr) {
+        warnln("No pattern given");
+        return 1;
+    }
+
     PosixOptions options {};
     if (case_insensitive)
         options |= PosixFlags::Insensitive;
 
-    Regex<PosixExtended> re(pattern, options);
-    if (re.parser_result.error != Error::NoError) {
-        return 1;
+    Optional<LiteralSearcher> literal;
+    OwnPtr<Regex<PosixExtended>> re;
+    if (fixed_strings) {
+        literal = LiteralSearcher(pattern, case_insensitive);
+    } else {
+        re = make<Regex<PosixExtended>>(pattern, options);
+        if (re->parser_result.error != Error::NoError)
+            return 1;
     }
 
-    auto matches = [&](StringView str, StringView filename = "", bool print_filename = false, bool is_binary = false) {
-        size_t last_printed_char_pos { 0 };
+    // Finds the matches in a single line. This may run on several threads at once, which is fine, since the
+    // regex's start offset (the only thing that a match changes) is kept on the stack.
+    auto find_matches_in_line = [&](StringView line, Vector<Match>& matches) {
+        matches.clear_with_capacity();
+        if (literal.has_value()) {
+            for (auto offset = literal->find(line, 0); offset.has_value(); offset = literal->find(line, offset.value() + literal->length())) {
+                matches.append({ offset.value(), literal->length() });
+                if (literal->length() == 0)
+                    break;
+            }
+            return;
+        }
+        size_t start_offset = 0;
+        auto result = re->match(line, start_offset, PosixFlags::Global);
+        if (!result.success)
+            return;
+        for (auto& match : result.matches)
+            matches.append({ match.global_offset, match.view.length() });
+        // An empty pattern still matches the line.
+        if (matches.is_empty())
+            matches.append({ 0, 0 });
+    };
+
+    auto print_line = [&](StringBuilder& output, StringView line, Vector<Match> const& matches, StringView filename, bool print_filename) {
+        if (print_filename)
+            output.appendff("\x1B[34m{}:\x1B[0m", filename);
+        size_t last_printed_char_pos = 0;
+        for (auto& match : matches) {
+            if (match.offset < last_printed_char_pos)
+                continue;
+            output.appendff("{}\x1B[32m{}\x1B[0m",
+                line.substring_view(last_printed_char_pos, match.offset - last_printed_char_pos),
+                line.substring_view(match.offset, match.length));
+            last_printed_char_pos = match.offset + match.length;
+        }
+        output.append(line.substring_view(last_printed_char_pos));
+        output.append('\n');
+    };
+
+    // Searches a whole buffer, and returns whether anything matched. Without -v, a fixed string is searched for
+    // in the whole buffer at once, and only the lines that it was found in are split out.
+    auto search_buffer = [&](StringView buffer, StringView filename, bool print_filename, StringBuilder& output) -> bool {
+        bool is_binary = memchr(buffer.characters_without_null_termination(), 0, buffer.length()) != nullptr;
         if (is_binary && binary_mode == BinaryFileMode::Skip)
             return false;
+        bool stop_at_first_match = is_binary && binary_mode == BinaryFileMode::Binary;
 
-        auto result = re.match(str, PosixFlags::Global);
-        if (result.success ^ invert_match) {
-            if (is_binary && binary_mode == BinaryFileMode::Binary) {
-                outln("binary file \x1B[34m{}\x1B[0m matches", filename);
-            } else {
-                if ((result.matches.size() || invert_match) && print_filename) {
-                    out("\x1B[34m{}:\x1B[0m", filename);
-                }
-
-                for (auto& match : result.matches) {
+        auto line_at = [&](size_t start) {
+            auto* end = (const char*)memchr(buffer.characters_without_null_termination() + start, '\n', buffer.length() - start);
+            return buffer.substring_view(start, end ? end - buffer.characters_without_null_termination() - start : buffer.length() - start);
+        };
 
-                    out("{}\x1B[32m{}\x1B[0m",
-                        StringView(&str[last_printed_char_pos], match.global_offset - last_printed_char_pos),
-                        match.view.to_string());
-                    last_printed_char_pos = match.global_offset + match.view.length();
+        bool did_match = false;
+        Vector<Match> matches;
+        if (literal.has_value() && !invert_match && literal->length() > 0) {
+            size_t position = 0;
+            for (auto offset = literal->find(buffer, position); offset.has_value(); offset = literal->find(buffer, position)) {
+                size_t line_start = offset.value();
+                while (line_start > position && buffer[line_start - 1] != '\n')
+                    --line_start;
+                auto line = line_at(line_start);
+                did_match = true;
+                if (stop_at_first_match)
+                    break;
+                find_matches_in_line(line, matches);
+                print_line(output, line, matches, filename, print_filename);
+                position = line_start + line.length() + 1;
+                if (position >= buffer.length())
+                    break;
+            }
+        } else {
+            for (size_t position = 0; position < buffer.length();) {
+                auto line = line_at(position);
+                position += line.length() + 1;
+                find_matches_in_line(line, matches);
+                if (matches.is_empty() == invert_match) {
+                    did_match = true;
+                    if (stop_at_first_match)
+                        break;
+                    if (invert_match)
+                        matches.clear_with_capacity();
+                    print_line(output, line, matches, filename, print_filename);
                 }
-                outln("{}", StringView(&str[last_printed_char_pos], str.length() - last_printed_char_pos));
             }
-
-            return true;
         }
 
-        return false;
+        if (did_match && stop_at_first_match)
+            output.appendff("binary file \x1B[34m{}\x1B[0m matches\n", filename);
+        return did_match;
     };
 
-    auto handle_file = [&matches, binary_mode](StringView filename, bool print_filename) -> bool {
-        auto file = Core::File::construct(filename);
-        if (!file->open(Core::OpenMode::ReadOnly)) {
-            warnln("Failed to open {}: {}", filename, file->error_string());
-            return false;
-        }
-
-        while (file->can_read_line()) {
-            auto line = file->read_line();
-            auto is_binary = memchr(line.characters(), 0, line.length()) != nullptr;
-
-            if (matches(line, filename, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
-                return true;
-        }
-        return true;
+    struct FileResult {
+        String output;
+        bool did_match { false };
+        bool failed { false };
     };
 
-    auto add_directory = [&handle_file](String base, Optional<String> recursive, auto handle_directory) -> void {
-        Core::DirIterator it(recursive.value_or(base), Core::DirIterator::Flags::SkipDots);
-        while (it.has_next()) {
-            auto path = it.next_full_path();
-            if (!Core::File::is_directory(path)) {
-                auto key = path.substring_view(base.length() + 1, path.length() - base.length() - 1);
-                handle_file(key, true);
+    auto search_file = [&](String const& path, StringView filename, bool print_filename) {
+        FileResult result;
+        StringBuilder output;
+        // Regular files are mapped, everything else (like the files in /proc, or pipes) is read in.
+        auto mapped_file_or_error = MappedFile::map(path);
+        if (!mapped_file_or_error.is_error()) {
+            auto& mapped_file = mapped_file_or_error.value();
+            result.did_match = search_buffer({ (const char*)mapped_file->data(), mapped_file->size() }, filename, print_filename, output);
+        } else {
+            auto file = Core::File::construct(path);
+            if (!file->open(Core::OpenMode::ReadOnly)) {
+                output.appendff("Failed to open {}: {}\n", filename, file->error_string());
+                result.failed = true;
             } else {
-                handle_directory(base, path, handle_directory);
+                auto contents = file->read_all();
+                result.did_match = search_buffer({ contents.data(), contents.size() }, filename, print_filename, output);
             }
         }
+        result.output = output.to_string();
+        return result;
     };
 
     bool did_match_something = false;
@@ -178,28 +320,90 @@ int main(int argc, char** argv)
         while ((nread = getline(&line, &line_len, stdin)) != -1) {
             VERIFY(nread > 0);
             StringView line_view(line, nread);
+            if (line_view.ends_with('\n'))
+                line_view = line_view.substring_view(0, line_view.length() - 1);
             bool is_binary = line_view.contains(0);
 
             if (is_binary && binary_mode == BinaryFileMode::Skip)
                 return 1;
 
-            auto matched = matches(line_view, "stdin", false, is_binary);
+            StringBuilder output;
+            auto matched = search_buffer(line_view, "stdin", false, output);
+            out("{}", output.string_view());
             did_match_something = did_match_something || matched;
             if (matched && is_binary && binary_mode == BinaryFileMode::Binary)
                 return 0;
         }
+        return did_match_something ? 0 : 1;
+    }
+
+    struct FileToSearch {
+        String path;
+        // What it is called in the output.
+        String name;
+        FileResult result;
+    };
+    Vector<FileToSearch> files_to_search;
+
+    auto add_directory = [&](String const& base, String const& directory, auto& add_directory) -> void {
+        Core::DirIterator it(directory, Core::DirIterator::Flags::SkipDots);
+        while (it.has_next()) {
+            auto path = it.next_full_path();
+            if (Core::File::is_directory(path)) {
+                add_directory(base, path, add_directory);
+                continue;
+            }
+            // Files under the working directory are named without the leading "./".
+            auto name = base == "." ? path.substring(base.length() + 1) : path;
+            files_to_search.append({ move(path), move(name), {} });
+        }
+    };
+
+    if (recursive) {
+        if (files.is_empty())
+            files.append(".");
+        for (auto* file : files) {
+            if (Core::File::is_directory(file))
+                add_directory(file, file, add_directory);
+            else
+                files_to_search.append({ file, file, {} });
+        }
     } else {
-        if (recursive) {
-            add_directory(".", {}, add_directory);
+        for (auto* file : files)
+            files_to_search.append({ file, file, {} });
+    }
 
+    bool print_filename = recursive || files_to_search.size() > 1;
+    bool did_fail = false;
+
+    // The files are searched in batches on all CPUs, and every batch is printed in order once it's done,
+    // so the output looks just like it would if the files had been searched one after another.
+    // A single file isn't worth starting the threads for.
+    auto batch_size = files_to_search.size() > 1 ? Threading::ThreadPool::the().thread_count() * 8 : 1;
+    for (size_t batch_start = 0; batch_start < files_to_search.size(); batch_start += batch_size) {
+        auto batch = files_to_search.span().slice(batch_start, min(batch_size, files_to_search.size() - batch_start));
+        if (batch.size() == 1) {
+            batch[0].result = search_file(batch[0].path, batch[0].name, print_filename);
         } else {
-            bool print_filename { files.size() > 1 };
-            for (auto& filename : files) {
-                if (!handle_file(filename, print_filename))
-                    return 1;
+            Threading::parallel_for(
+                batch, [&](FileToSearch& file) {
+                    file.result = search_file(file.path, file.name, print_filename);
+                },
+                1);
+        }
+        for (auto& file : batch) {
+            if (file.result.failed) {
+                warn("{}", file.result.output);
+                did_fail = true;
+            } else {
+                out("{}", file.result.output);
             }
+            did_match_something = did_match_something || file.result.did_match;
+            file.result = {};
         }
     }
 
+    if (did_fail)
+        return 1;
     return did_match_something ? 0 : 1;
 }
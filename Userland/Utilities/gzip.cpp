@@ -5,26 +5,96 @@
  */
 
 #include <AK/MappedFile.h>
+#include <AK/MemoryStream.h>
 #include <LibCompress/Gzip.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/FileStream.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/Parallel.h>
 #include <unistd.h>
 
+struct Chunk {
+    ReadonlyBytes dictionary;
+    ReadonlyBytes data;
+    bool is_last { false };
+    bool failed { false };
+    ByteBuffer compressed;
+    u32 crc32 { 0 };
+};
+
+// Compresses the input in chunks on several threads, like pigz does. Every chunk gets the 32 KiB before it as its
+// dictionary, so the splitting doesn't cost much compression, and all but the last one end with a sync flush, so
+// their deflate streams can just be concatenated. The chunks' checksums are combined into the one for the whole input.
+static Optional<ByteBuffer> compress_in_parallel(ReadonlyBytes bytes, size_t thread_count)
+{
+    static constexpr size_t chunk_size = 128 * KiB;
+    static constexpr size_t dictionary_size = 32 * KiB;
+
+    Vector<Chunk> chunks;
+    for (size_t offset = 0; offset < bytes.size() || chunks.is_empty(); offset += chunk_size) {
+        Chunk chunk;
+        auto dictionary_length = min(offset, dictionary_size);
+        chunk.dictionary = bytes.slice(offset - dictionary_length, dictionary_length);
+        chunk.data = bytes.slice(offset, min(chunk_size, bytes.size() - offset));
+        chunks.append(move(chunk));
+    }
+    chunks.last().is_last = true;
+
+    // The calling thread compresses chunks too.
+    Threading::ThreadPool pool { thread_count - 1 };
+    Threading::parallel_for(
+        chunks.span(), [](Chunk& chunk) {
+            DuplexMemoryStream stream;
+            Compress::DeflateCompressor compressor { stream };
+            if (!chunk.dictionary.is_empty())
+                compressor.set_dictionary(chunk.dictionary);
+            compressor.write_or_error(chunk.data);
+            if (chunk.is_last)
+                compressor.final_flush();
+            else
+                compressor.final_sync_flush();
+            chunk.failed = compressor.handle_any_error();
+            chunk.compressed = stream.copy_into_contiguous_buffer();
+            chunk.crc32 = Crypto::Checksum::CRC32 { chunk.data }.digest();
+        },
+        1, pool);
+
+    DuplexMemoryStream output_stream;
+    Compress::GzipCompressor::write_header(output_stream);
+    u32 crc32 = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.failed || !output_stream.write_or_error(chunk.compressed))
+            return {};
+        chunk.compressed.clear();
+        crc32 = Crypto::Checksum::CRC32::combine(crc32, chunk.crc32, chunk.data.size());
+    }
+    Compress::GzipCompressor::write_trailer(output_stream, crc32, bytes.size());
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
 int main(int argc, char** argv)
 {
     Vector<String> filenames;
     bool keep_input_files { false };
     bool write_to_stdout { false };
+    int thread_count { 1 };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
+    args_parser.add_option(thread_count, "Compress in blocks on this many threads", "jobs", 'j', "count");
     args_parser.add_positional_argument(filenames, "File to compress", "FILE");
     args_parser.parse(argc, argv);
 
     if (write_to_stdout)
         keep_input_files = true;
 
+    if (thread_count < 1) {
+        warnln("The number of threads has to be at least 1");
+        return 1;
+    }
+
     for (auto const& input_filename : filenames) {
         auto output_filename = String::formatted("{}.gz", input_filename);
 
@@ -37,7 +107,7 @@ int main(int argc, char** argv)
         }
         auto file = file_or_error.value();
 
-        auto compressed_file = Compress::GzipCompressor::compress_all(file->bytes());
+        auto compressed_file = thread_count > 1 ? compress_in_parallel(file->bytes(), thread_count) : Compress::GzipCompressor::compress_all(file->bytes());
         if (!compressed_file.has_value()) {
             warnln("Failed gzip compressing input file");
             return 1;
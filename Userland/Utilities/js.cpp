@@ -15,10 +15,13 @@
 #include <LibCore/StandardPaths.h>
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Cache.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PassManager.h>
 #include <LibJS/Console.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/Parser.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/ArrayBuffer.h>
@@ -79,6 +82,9 @@ private:
 static bool s_dump_ast = false;
 static bool s_dump_bytecode = false;
 static bool s_run_bytecode = false;
+static bool s_opt_bytecode = false;
+static bool s_jit_bytecode = false;
+static OwnPtr<JS::Bytecode::Cache> s_bytecode_cache;
 static bool s_print_last_result = false;
 static RefPtr<Line::Editor> s_editor;
 static String s_history_path = String::formatted("{}/.js-history", Core::StandardPaths::home_directory());
@@ -506,8 +512,17 @@ static bool write_to_file(const String& path)
 
 static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source)
 {
-    auto parser = JS::Parser(JS::Lexer(source));
-    auto program = parser.parse_program();
+    // NOTE: This is what the lexer calls the source when it isn't given a filename.
+    static constexpr char const* filename = "(unknown)";
+
+    Optional<JS::Bytecode::Executable> cached_unit;
+    if (s_bytecode_cache && s_run_bytecode && !s_dump_ast)
+        cached_unit = s_bytecode_cache->load(source, filename);
+
+    RefPtr<JS::Program> program;
+    auto parser = JS::Parser(JS::Lexer(cached_unit.has_value() ? StringView {} : source, filename));
+    if (!cached_unit.has_value())
+        program = parser.parse_program();
 
     if (s_dump_ast)
         program->dump(0);
@@ -520,7 +535,13 @@ static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source
         vm->throw_exception<JS::SyntaxError>(interpreter.global_object(), error.to_string());
     } else {
         if (s_dump_bytecode || s_run_bytecode) {
-            auto unit = JS::Bytecode::Generator::generate(*program);
+            auto unit = cached_unit.has_value() ? cached_unit.release_value() : JS::Bytecode::Generator::generate(*program);
+            if (program && s_bytecode_cache && s_run_bytecode)
+                s_bytecode_cache->store(source, unit);
+            if (s_opt_bytecode)
+                JS::Bytecode::Interpreter::optimization_pipeline().perform(unit);
+            if (s_jit_bytecode && s_run_bytecode)
+                unit.native_executable = JS::JIT::Compiler::compile(unit);
             if (s_dump_bytecode) {
                 for (auto& block : unit.basic_blocks)
                     block.dump(unit);
@@ -528,10 +549,17 @@ static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source
                     outln();
                     unit.string_table->dump();
                 }
+                if (s_opt_bytecode) {
+                    outln();
+                    for (auto& pass : JS::Bytecode::Interpreter::optimization_pipeline().passes())
+                        outln("{}: {}us", pass.name(), pass.elapsed());
+                }
             }
 
             if (s_run_bytecode) {
                 JS::Bytecode::Interpreter bytecode_interpreter(interpreter.global_object());
+                bytecode_interpreter.set_optimizations_enabled(s_opt_bytecode);
+                bytecode_interpreter.set_jit_enabled(s_jit_bytecode);
                 bytecode_interpreter.run(unit);
             } else {
                 return true;
@@ -781,22 +809,45 @@ int main(int argc, char** argv)
 {
     bool gc_on_every_allocation = false;
     bool disable_syntax_highlight = false;
+    double gc_growth_factor = 0;
+    int gc_min_kib_between_collections = 0;
     const char* script_path = nullptr;
+    const char* bytecode_cache_path = nullptr;
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("This is a JavaScript interpreter.");
     args_parser.add_option(s_dump_ast, "Dump the AST", "dump-ast", 'A');
     args_parser.add_option(s_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
+    args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'O');
+    args_parser.add_option(s_jit_bytecode, "Compile the bytecode to native code where possible", "jit", 'J');
+    args_parser.add_option(bytecode_cache_path, "Cache the bytecode of scripts in this directory", "bytecode-cache", 0, "path");
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(gc_growth_factor, "Let the heap grow by this factor between collections", "gc-growth-factor", 0, "factor");
+    args_parser.add_option(gc_min_kib_between_collections, "Allocate at least this many KiB between collections", "gc-min-kib", 0, "kib");
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
     bool syntax_highlight = !disable_syntax_highlight;
 
+    if (gc_growth_factor != 0 && gc_growth_factor < 1) {
+        warnln("The GC growth factor can't be less than 1");
+        return 1;
+    }
+    if (gc_min_kib_between_collections < 0) {
+        warnln("The minimum amount of allocation between collections can't be negative");
+        return 1;
+    }
+
     vm = JS::VM::create();
+    if (gc_growth_factor != 0)
+        vm->heap().set_gc_growth_factor(gc_growth_factor);
+    if (gc_min_kib_between_collections != 0)
+        vm->heap().set_min_bytes_between_gc(gc_min_kib_between_collections * KiB);
+    if (bytecode_cache_path)
+        s_bytecode_cache = make<JS::Bytecode::Cache>(bytecode_cache_path);
     // NOTE: These will print out both warnings when using something like Promise.reject().catch(...) -
     // which is, as far as I can tell, correct - a promise is created, rejected without handler, and a
     // handler then attached to it. The Node.js REPL doesn't warn in this case, so it's something we
@@ -8,22 +8,23 @@
 
 int main(int, char**)
 {
-    auto document = Video::MatroskaReader::parse_matroska_from_file("/home/anon/Videos/test-webm.webm");
-    if (!document) {
+    auto reader = Video::MatroskaReader::stream_matroska_from_file("/home/anon/Videos/test-webm.webm");
+    if (!reader) {
         outln("Failed to parse :(");
         return 1;
     }
+    auto& document = reader->document();
 
-    outln("DocType is {}", document->header().doc_type.characters());
-    outln("DocTypeVersion is {}", document->header().doc_type_version);
-    auto segment_information = document->segment_information();
+    outln("DocType is {}", document.header().doc_type.characters());
+    outln("DocTypeVersion is {}", document.header().doc_type_version);
+    auto segment_information = document.segment_information();
     if (segment_information.has_value()) {
         outln("Timestamp scale is {}", segment_information.value().timestamp_scale());
         outln("Muxing app is \"{}\"", segment_information.value().muxing_app().as_string().to_string().characters());
         outln("Writing app is \"{}\"", segment_information.value().writing_app().as_string().to_string().characters());
     }
-    outln("Document has {} tracks", document->tracks().size());
-    for (const auto& track_entry : document->tracks()) {
+    outln("Document has {} tracks", document.tracks().size());
+    for (const auto& track_entry : document.tracks()) {
         const auto& track = *track_entry.value;
         outln("\tTrack #{} with TrackID {}", track.track_number(), track.track_uid());
         outln("\tTrack has TrackType {}", static_cast<u8>(track.track_type()));
@@ -39,16 +40,20 @@ int main(int, char**)
         }
     }
 
-    outln("Document has {} clusters", document->clusters().size());
-    for (const auto& cluster : document->clusters()) {
-        outln("\tCluster timestamp is {}", cluster.timestamp());
+    outln("Document has {} cue points", document.cue_points().size());
 
-        outln("\tCluster has {} blocks", cluster.blocks().size());
-        for (const auto& block : cluster.blocks()) {
+    size_t cluster_count = 0;
+    while (auto cluster = reader->read_next_cluster()) {
+        cluster_count++;
+        outln("\tCluster timestamp is {}", cluster->timestamp());
+
+        outln("\tCluster has {} blocks", cluster->blocks().size());
+        for (const auto& block : cluster->blocks()) {
             (void)block;
             outln("\t\tBlock for track #{} has {} frames", block.track_number(), block.frame_count());
             outln("\t\tBlock's timestamp is {}", block.timestamp());
             outln("\t\tBlock has lacing {}", static_cast<u8>(block.lacing()));
         }
     }
+    outln("Document has {} clusters", cluster_count);
 }
@@ -4,12 +4,41 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
+#include <poll.h>
 #include <serenity.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Takes the events that have come in since last time out of /proc/profile, and appends them to the output.
+static bool stream_events(Core::File& output, bool& wrote_first_event, u64& lost_events)
+{
+    auto file_or_error = Core::File::open("/proc/profile", Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error()) {
+        warnln("Failed to open /proc/profile: {}", file_or_error.error());
+        return false;
+    }
+    auto json = JsonValue::from_string(file_or_error.value()->read_all());
+    if (!json.has_value() || !json->is_object()) {
+        warnln("Invalid /proc/profile");
+        return false;
+    }
+    auto& object = json->as_object();
+    lost_events = object.get("lost_events").to_u64();
+    for (auto& event : object.get("events").as_array().values()) {
+        if (wrote_first_event)
+            output.write(",");
+        output.write(event.to_string());
+        wrote_first_event = true;
+    }
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     Core::ArgsParser args_parser;
@@ -21,6 +50,7 @@ int main(int argc, char** argv)
     bool enable = false;
     bool disable = false;
     bool all_processes = false;
+    const char* output_path = nullptr;
     u64 event_mask = PERF_EVENT_MMAP | PERF_EVENT_MUNMAP | PERF_EVENT_PROCESS_CREATE
         | PERF_EVENT_PROCESS_EXEC | PERF_EVENT_PROCESS_EXIT | PERF_EVENT_THREAD_CREATE | PERF_EVENT_THREAD_EXIT;
     bool seen_event_type_arg = false;
@@ -32,6 +62,7 @@ int main(int argc, char** argv)
     args_parser.add_option(free, "Free the profiling buffer for the associated process(es).", nullptr, 'f');
     args_parser.add_option(wait, "Enable profiling and wait for user input to disable.", nullptr, 'w');
     args_parser.add_option(cmd_argument, "Command", nullptr, 'c', "command");
+    args_parser.add_option(output_path, "Keep writing the events of all processes to a file while waiting (with -a -w).", nullptr, 'o', "path");
     args_parser.add_option(Core::ArgsParser::Option {
         true, "Enable tracking specific event type", nullptr, 't', "event_type",
         [&](String event_type) {
@@ -46,6 +77,26 @@ int main(int argc, char** argv)
                 event_mask |= PERF_EVENT_KFREE;
             else if (event_type == "page_fault")
                 event_mask |= PERF_EVENT_PAGE_FAULT;
+            else if (event_type == "thread_block")
+                event_mask |= PERF_EVENT_THREAD_BLOCK;
+            else if (event_type == "thread_wakeup")
+                event_mask |= PERF_EVENT_THREAD_WAKEUP;
+            else if (event_type == "syscall")
+                event_mask |= PERF_EVENT_SYSCALL_ENTER | PERF_EVENT_SYSCALL_EXIT;
+            else if (event_type == "irq")
+                event_mask |= PERF_EVENT_IRQ;
+            else if (event_type == "ipc")
+                event_mask |= PERF_EVENT_IPC_SEND | PERF_EVENT_IPC_RECEIVE;
+            else if (event_type == "event_loop")
+                event_mask |= PERF_EVENT_EVENT_LOOP_DISPATCH;
+            else if (event_type == "cycles")
+                event_mask |= PERF_EVENT_CYCLES;
+            else if (event_type == "instructions")
+                event_mask |= PERF_EVENT_INSTRUCTIONS;
+            else if (event_type == "cache_miss")
+                event_mask |= PERF_EVENT_CACHE_MISS;
+            else if (event_type == "branch_miss")
+                event_mask |= PERF_EVENT_BRANCH_MISS;
             else {
                 warnln("Unknown event type '{}' specified.", event_type);
                 exit(1);
@@ -55,7 +106,9 @@ int main(int argc, char** argv)
 
     auto print_types = [] {
         outln();
-        outln("Event type can be one of: sample, context_switch, page_fault, kmalloc and kfree.");
+        outln("Event type can be one of: sample, context_switch, thread_block, thread_wakeup, page_fault, kmalloc and kfree.");
+        outln("These are counted by the processor itself, where it can: cycles, instructions, cache_miss and branch_miss.");
+        outln("These trace what goes on between processes: syscall, irq, ipc and event_loop (all but syscall only with -a).");
     };
 
     if (!args_parser.parse(argc, argv, Core::ArgsParser::FailureBehavior::PrintUsage)) {
@@ -90,8 +143,29 @@ int main(int argc, char** argv)
                 return 0;
         }
 
+        RefPtr<Core::File> output;
+        bool wrote_first_event = false;
+        u64 lost_events = 0;
+        if (wait && all_processes && output_path) {
+            auto output_or_error = Core::File::open(output_path, Core::OpenMode::WriteOnly);
+            if (output_or_error.is_error()) {
+                warnln("Failed to open {}: {}", output_path, output_or_error.error());
+                return 1;
+            }
+            output = output_or_error.release_value();
+            output->write("{\"events\":[");
+        }
+
         if (wait) {
             outln("Profiling enabled, waiting for user input to disable...");
+            if (output) {
+                // Take the events out every second, so the kernel's buffer never fills up, however long this goes on.
+                pollfd stdin_pollfd { STDIN_FILENO, POLLIN, 0 };
+                while (poll(&stdin_pollfd, 1, 1000) == 0) {
+                    if (!stream_events(*output, wrote_first_event, lost_events))
+                        return 1;
+                }
+            }
             (void)getchar();
         }
 
@@ -103,6 +177,15 @@ int main(int argc, char** argv)
             outln("Profiling disabled.");
         }
 
+        if (output) {
+            if (!stream_events(*output, wrote_first_event, lost_events))
+                return 1;
+            output->write(String::formatted("],\"lost_events\":{}}}", lost_events));
+            if (lost_events)
+                warnln("{} events were lost.", lost_events);
+            outln("Wrote events to {}", output_path);
+        }
+
         if (free && profiling_free_buffer(pid) < 0) {
             perror("profiling_disable");
             return 1;
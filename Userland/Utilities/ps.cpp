@@ -24,7 +24,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (unveil("/proc/all", "r") < 0) {
+    if (unveil("/proc/all_binary", "r") < 0) {
         perror("unveil");
         return 1;
     }
@@ -8,12 +8,40 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <errno.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
+// Everything below a directory is removed before the directory itself, while the directories further down are
+// read ahead of time on other threads.
+static bool remove_recursively(String const& path, bool force)
+{
+    bool success = true;
+    auto report_error = [&](String const& error_path, int error) {
+        if (force)
+            return;
+        warnln("rm: cannot remove '{}': {}", error_path, strerror(error));
+        success = false;
+    };
+
+    Threading::DirectoryWalker walker({});
+    walker.on_leave = [&](auto& entry) {
+        int rc = entry.is_directory() ? rmdir(entry.path.characters()) : unlink(entry.path.characters());
+        if (rc < 0)
+            report_error(entry.path, errno);
+    };
+    walker.on_error = [&](auto& error_path, int error) {
+        report_error(error_path, error);
+    };
+    walker.walk(path);
+    return success;
+}
+
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath cpath", nullptr) < 0) {
+    if (pledge("stdio rpath cpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -37,11 +65,15 @@ int main(int argc, char** argv)
 
     bool had_errors = false;
     for (auto& path : paths) {
-        auto result = Core::File::remove(path, recursive ? Core::File::RecursionMode::Allowed : Core::File::RecursionMode::Disallowed, force);
-
-        if (result.is_error()) {
-            warnln("rm: cannot remove '{}': {}", path, result.error().error_code);
-            had_errors = true;
+        if (recursive) {
+            if (!remove_recursively(path, force))
+                had_errors = true;
+        } else {
+            auto result = Core::File::remove(path, Core::File::RecursionMode::Disallowed, force);
+            if (result.is_error()) {
+                warnln("rm: cannot remove '{}': {}", path, result.error().error_code);
+                had_errors = true;
+            }
         }
 
         if (verbose)
@@ -4,47 +4,453 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/QuickSort.h>
+#include <AK/CharacterTypes.h>
 #include <AK/String.h>
+#include <AK/StringView.h>
 #include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibThreading/Parallel.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+struct SortKey {
+    // Fields are counted from 1, and the end field is included. A start field of 0 means the whole line,
+    // an end field of 0 means the rest of the line.
+    size_t start_field { 0 };
+    size_t end_field { 0 };
+    Optional<char> separator;
+    bool numeric { false };
+    bool reverse { false };
+};
+
+struct Line {
+    String text;
+    // Both of these are worked out once when the line is read, not on every comparison.
+    StringView key;
+    double numeric_key { 0 };
+};
+
+// The most runs that are merged at once, which also limits how many temporary files are open at the same time.
+static constexpr size_t max_merge_width = 16;
+
+static StringView extract_key(StringView line, SortKey const& key)
 {
-    if (pledge("stdio", nullptr) > 0) {
-        perror("pledge");
-        return 1;
+    if (key.start_field == 0)
+        return line;
+
+    size_t key_start = line.length();
+    size_t key_end = line.length();
+    size_t position = 0;
+    for (size_t field = 1; position <= line.length(); ++field) {
+        size_t field_start = position;
+        size_t field_end;
+        if (key.separator.has_value()) {
+            field_end = field_start;
+            while (field_end < line.length() && line[field_end] != key.separator.value())
+                ++field_end;
+            position = field_end + 1;
+        } else {
+            // Without a separator, fields are separated by runs of blanks, which aren't part of the key.
+            while (field_start < line.length() && is_ascii_blank(line[field_start]))
+                ++field_start;
+            field_end = field_start;
+            while (field_end < line.length() && !is_ascii_blank(line[field_end]))
+                ++field_end;
+            position = field_start == line.length() ? line.length() + 1 : field_end;
+        }
+
+        if (field == key.start_field) {
+            key_start = field_start;
+            if (key.end_field == 0)
+                break;
+        }
+        if (field == key.end_field) {
+            key_end = field_end;
+            break;
+        }
+    }
+
+    if (key_start >= key_end)
+        return {};
+    return line.substring_view(key_start, key_end - key_start);
+}
+
+// Parses the number at the start of the key, like strtod() would, except that a key without a number is 0.
+static double parse_number(StringView key)
+{
+    size_t i = 0;
+    while (i < key.length() && is_ascii_blank(key[i]))
+        ++i;
+
+    bool negative = false;
+    if (i < key.length() && (key[i] == '-' || key[i] == '+'))
+        negative = key[i++] == '-';
+
+    double value = 0;
+    for (; i < key.length() && is_ascii_digit(key[i]); ++i)
+        value = value * 10 + (key[i] - '0');
+    if (i < key.length() && key[i] == '.') {
+        double scale = 0.1;
+        for (++i; i < key.length() && is_ascii_digit(key[i]); ++i, scale /= 10)
+            value += (key[i] - '0') * scale;
     }
+    return negative ? -value : value;
+}
+
+static Line make_line(String text, SortKey const& key)
+{
+    Line line { move(text), {}, 0 };
+    line.key = extract_key(line.text.view(), key);
+    if (key.numeric)
+        line.numeric_key = parse_number(line.key);
+    return line;
+}
+
+static int compare_views(StringView a, StringView b)
+{
+    if (int result = memcmp(a.characters_without_null_termination(), b.characters_without_null_termination(), min(a.length(), b.length())))
+        return result;
+    if (a.length() == b.length())
+        return 0;
+    return a.length() < b.length() ? -1 : 1;
+}
 
-    Vector<String> lines;
+static int compare_lines(Line const& a, Line const& b, SortKey const& key)
+{
+    int result;
+    if (key.numeric)
+        result = a.numeric_key < b.numeric_key ? -1 : (a.numeric_key > b.numeric_key ? 1 : 0);
+    else
+        result = compare_views(a.key, b.key);
+    // Lines with equal keys are put in order by the whole line, as a last resort.
+    if (result == 0 && (key.numeric || key.start_field != 0))
+        result = compare_views(a.text.view(), b.text.view());
+    return key.reverse ? -result : result;
+}
 
+// Calls callback for every line in the file, without its newline. Returns false if reading failed.
+template<typename Callback>
+static bool for_each_line(FILE* file, Callback callback)
+{
+    char* buffer = nullptr;
+    size_t buffer_size = 0;
     for (;;) {
-        char* buffer = nullptr;
-        ssize_t buflen = 0;
-        size_t n;
         errno = 0;
-        buflen = getline(&buffer, &n, stdin);
-        if (buflen == -1 && errno != 0) {
-            perror("getline");
-            exit(1);
+        ssize_t length = getline(&buffer, &buffer_size, file);
+        if (length == -1) {
+            free(buffer);
+            return errno == 0;
+        }
+        callback(String { buffer, (size_t)length, Chomp });
+    }
+}
+
+static bool write_line(FILE* file, Line const& line)
+{
+    return fwrite(line.text.characters(), 1, line.text.length(), file) == line.text.length() && fputc('\n', file) != EOF;
+}
+
+// Merges the sorted runs into the output. Lines with equal keys are taken from the earlier run first, so the sort stays stable.
+static bool merge_runs(Vector<String> const& run_paths, FILE* output, SortKey const& key)
+{
+    struct Run {
+        FILE* file { nullptr };
+        char* buffer { nullptr };
+        size_t buffer_size { 0 };
+        Optional<Line> line;
+    };
+
+    bool success = true;
+    Vector<Run> runs;
+    runs.resize(run_paths.size());
+
+    auto advance = [&](Run& run) {
+        errno = 0;
+        ssize_t length = getline(&run.buffer, &run.buffer_size, run.file);
+        if (length == -1) {
+            if (errno != 0) {
+                perror("getline");
+                success = false;
+            }
+            run.line.clear();
+            return;
+        }
+        run.line = make_line(String { run.buffer, (size_t)length, Chomp }, key);
+    };
+
+    for (size_t i = 0; i < run_paths.size(); ++i) {
+        runs[i].file = fopen(run_paths[i].characters(), "r");
+        if (!runs[i].file) {
+            perror("fopen");
+            success = false;
+            continue;
+        }
+        advance(runs[i]);
+    }
+
+    // There are only ever a few runs to merge, so finding the smallest line by looking at all of them is fine.
+    for (;;) {
+        Run* smallest = nullptr;
+        for (auto& run : runs) {
+            if (run.line.has_value() && (!smallest || compare_lines(run.line.value(), smallest->line.value(), key) < 0))
+                smallest = &run;
         }
-        if (buflen == -1)
+        if (!smallest)
             break;
-        lines.append({ buffer, AK::ShouldChomp::Chomp });
+        if (!write_line(output, smallest->line.value())) {
+            perror("write");
+            success = false;
+            break;
+        }
+        advance(*smallest);
     }
 
-    quick_sort(lines, [](auto& a, auto& b) {
-        return strcmp(a.characters(), b.characters()) < 0;
-    });
+    for (auto& run : runs) {
+        if (run.file)
+            fclose(run.file);
+        free(run.buffer);
+    }
+    return success;
+}
+
+static Optional<String> create_temporary_file(StringView directory, FILE*& file)
+{
+    auto path_template = String::formatted("{}/sort.XXXXXX", directory);
+    Vector<char> path;
+    path.append(path_template.characters(), path_template.length() + 1);
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        perror("mkstemp");
+        return {};
+    }
+    file = fdopen(fd, "w");
+    if (!file) {
+        perror("fdopen");
+        close(fd);
+        unlink(path.data());
+        return {};
+    }
+    return String { path.data() };
+}
+
+static bool parse_key(StringView definition, SortKey& key)
+{
+    auto parts = definition.split_view(',', true);
+    if (parts.is_empty() || parts.size() > 2)
+        return false;
+    auto start_field = parts[0].to_uint();
+    if (!start_field.has_value() || start_field.value() == 0)
+        return false;
+    key.start_field = start_field.value();
+    if (parts.size() == 2) {
+        auto end_field = parts[1].to_uint();
+        if (!end_field.has_value() || end_field.value() < key.start_field)
+            return false;
+        key.end_field = end_field.value();
+    }
+    return true;
+}
+
+// Parses a size as a number of KiB, or of bytes, KiB, MiB or GiB with a b, K, M or G suffix.
+static Optional<size_t> parse_size(StringView size)
+{
+    if (size.is_empty())
+        return {};
+    size_t multiplier = KiB;
+    switch (size[size.length() - 1]) {
+    case 'b':
+        multiplier = 1;
+        break;
+    case 'K':
+        multiplier = KiB;
+        break;
+    case 'M':
+        multiplier = MiB;
+        break;
+    case 'G':
+        multiplier = GiB;
+        break;
+    default:
+        if (!is_ascii_digit(size[size.length() - 1]))
+            return {};
+        auto number = size.to_uint();
+        if (!number.has_value())
+            return {};
+        return number.value() * multiplier;
+    }
+    auto number = size.substring_view(0, size.length() - 1).to_uint();
+    if (!number.has_value())
+        return {};
+    return number.value() * multiplier;
+}
+
+int main(int argc, char** argv)
+{
+    if (pledge("stdio rpath wpath cpath thread", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    SortKey key;
+    const char* key_definition = nullptr;
+    const char* separator = nullptr;
+    const char* buffer_size = nullptr;
+    const char* temporary_directory = "/tmp";
+    Vector<const char*> paths;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Sort lines of text, using temporary files for inputs that don't fit in memory.");
+    args_parser.add_option(key_definition, "Sort by fields start to end (counted from 1), or to the end of the line", "key", 'k', "start[,end]");
+    args_parser.add_option(separator, "Separate fields with this character instead of runs of blanks", "field-separator", 't', "separator");
+    args_parser.add_option(key.numeric, "Compare keys as numbers", "numeric-sort", 'n');
+    args_parser.add_option(key.reverse, "Reverse the result of comparisons", "reverse", 'r');
+    args_parser.add_option(buffer_size, "How much memory to use before sorting into temporary files (default 64M)", "buffer-size", 'S', "size");
+    args_parser.add_option(temporary_directory, "Where to put temporary files (default /tmp)", "temporary-directory", 'T', "directory");
+    args_parser.add_positional_argument(paths, "Files to sort (standard input if none are given)", "file", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
 
-    for (auto& line : lines) {
-        fputs(line.characters(), stdout);
-        fputc('\n', stdout);
+    if (key_definition && !parse_key(key_definition, key)) {
+        warnln("sort: Invalid key: {}", key_definition);
+        return 1;
+    }
+    if (separator) {
+        if (strlen(separator) != 1) {
+            warnln("sort: The separator must be a single character");
+            return 1;
+        }
+        key.separator = separator[0];
+    }
+    size_t memory_limit = 64 * MiB;
+    if (buffer_size) {
+        auto size = parse_size(buffer_size);
+        if (!size.has_value() || size.value() == 0) {
+            warnln("sort: Invalid buffer size: {}", buffer_size);
+            return 1;
+        }
+        memory_limit = size.value();
+    }
+
+    int exit_code = 0;
+    Vector<Line> lines;
+    size_t buffered_bytes = 0;
+    Vector<String> run_paths;
+
+    auto sort_lines = [&] {
+        Threading::parallel_sort(lines.span(), [&](Line const& a, Line const& b) {
+            return compare_lines(a, b, key) < 0;
+        });
+    };
+
+    auto remove_runs = [&] {
+        for (auto& path : run_paths)
+            unlink(path.characters());
+    };
+
+    // Sorts what has been read so far, and moves it out of memory into a temporary file.
+    auto write_run = [&] {
+        sort_lines();
+        FILE* file = nullptr;
+        auto path = create_temporary_file(temporary_directory, file);
+        if (!path.has_value())
+            return false;
+        run_paths.append(path.release_value());
+        for (auto& line : lines) {
+            if (!write_line(file, line)) {
+                perror("write");
+                fclose(file);
+                return false;
+            }
+        }
+        if (fclose(file) != 0) {
+            perror("fclose");
+            return false;
+        }
+        lines.clear();
+        buffered_bytes = 0;
+        return true;
+    };
+
+    bool run_failed = false;
+    auto read_lines = [&](FILE* file) {
+        return for_each_line(file, [&](String text) {
+            if (run_failed)
+                return;
+            buffered_bytes += text.length() + sizeof(Line);
+            lines.append(make_line(move(text), key));
+            if (buffered_bytes >= memory_limit && !write_run())
+                run_failed = true;
+        });
+    };
+
+    if (paths.is_empty())
+        paths.append("-");
+    for (auto* path : paths) {
+        bool is_stdin = StringView(path) == "-";
+        FILE* file = is_stdin ? stdin : fopen(path, "r");
+        if (!file) {
+            warnln("sort: {}: {}", path, strerror(errno));
+            exit_code = 1;
+            continue;
+        }
+        if (!read_lines(file)) {
+            warnln("sort: {}: {}", path, strerror(errno));
+            exit_code = 1;
+        }
+        if (!is_stdin)
+            fclose(file);
+        if (run_failed) {
+            remove_runs();
+            return 1;
+        }
+    }
+
+    if (run_paths.is_empty()) {
+        sort_lines();
+        for (auto& line : lines)
+            write_line(stdout, line);
+        return exit_code;
+    }
+
+    if (!lines.is_empty() && !write_run()) {
+        remove_runs();
+        return 1;
+    }
+
+    // Merge the runs a few at a time, until there are few enough left to merge them straight into the output.
+    while (run_paths.size() > max_merge_width) {
+        Vector<String> merged_run_paths;
+        for (size_t first = 0; first < run_paths.size(); first += max_merge_width) {
+            Vector<String> group;
+            for (size_t i = first; i < min(run_paths.size(), first + max_merge_width); ++i)
+                group.append(run_paths[i]);
+
+            FILE* file = nullptr;
+            auto path = create_temporary_file(temporary_directory, file);
+            bool success = path.has_value() && merge_runs(group, file, key);
+            if (file && fclose(file) != 0) {
+                perror("fclose");
+                success = false;
+            }
+            if (path.has_value())
+                merged_run_paths.append(path.release_value());
+            for (auto& group_path : group)
+                unlink(group_path.characters());
+            if (!success) {
+                for (size_t i = first + max_merge_width; i < run_paths.size(); ++i)
+                    unlink(run_paths[i].characters());
+                run_paths = move(merged_run_paths);
+                remove_runs();
+                return 1;
+            }
+        }
+        run_paths = move(merged_run_paths);
     }
 
-    return 0;
+    if (!merge_runs(run_paths, stdout, key))
+        exit_code = 1;
+    remove_runs();
+    return exit_code;
 }
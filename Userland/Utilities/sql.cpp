@@ -4,19 +4,28 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Endian.h>
 #include <AK/Format.h>
+#include <AK/Random.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/StandardPaths.h>
 #include <LibLine/Editor.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Executor.h>
 #include <LibSQL/Lexer.h>
 #include <LibSQL/Parser.h>
 #include <LibSQL/Token.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 namespace {
 
 String s_history_path = String::formatted("{}/.sql-history", Core::StandardPaths::home_directory());
 RefPtr<Line::Editor> s_editor;
+RefPtr<SQL::Database> s_database;
 int s_repl_line_level = 0;
 bool s_keep_running = true;
 
@@ -86,23 +95,114 @@ String read_next_piece()
     return piece.to_string();
 }
 
+void print_pool_statistics(const SQL::BufferPool& pool)
+{
+    outln("    buffer pool: {} hits, {} misses, {} pages written", pool.hit_count(), pool.miss_count(), pool.write_count());
+}
+
+// Fills a table in a scratch database with rows keyed by row ID, then looks rows up at random.
+void run_benchmark(size_t row_count)
+{
+    char path[] = "/tmp/sql-benchmark.XXXXXX";
+    auto fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return;
+    }
+    close(fd);
+
+    auto database_or_error = SQL::Database::open(path);
+    if (database_or_error.is_error()) {
+        outln("\033[33;1mCould not open database:\033[0m {}", database_or_error.error());
+        unlink(path);
+        return;
+    }
+    auto database = database_or_error.release_value();
+    auto table = database->create_table("BENCHMARK").release_value();
+
+    auto key_for = [](u64 row_id) {
+        BigEndian<u64> key = row_id;
+        return ByteBuffer::copy(&key, sizeof(key));
+    };
+    auto row = String::repeated('x', 100);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (u64 row_id = 1; row_id <= row_count; ++row_id)
+        table.insert(key_for(row_id), row.bytes());
+    database->commit();
+    auto insert_time = timer.elapsed();
+    outln("Inserted {} rows in {} ms", row_count, insert_time);
+    print_pool_statistics(database->pool());
+
+    auto hits_before = database->pool().hit_count();
+    auto misses_before = database->pool().miss_count();
+    size_t found = 0;
+    timer.start();
+    for (size_t i = 0; i < row_count; ++i) {
+        if (table.find(key_for(get_random_uniform(row_count) + 1)).has_value())
+            ++found;
+    }
+    auto lookup_time = timer.elapsed();
+    outln("Looked up {} random rows ({} found) in {} ms", row_count, found, lookup_time);
+    outln("    buffer pool: {} hits, {} misses", database->pool().hit_count() - hits_before, database->pool().miss_count() - misses_before);
+
+    unlink(path);
+}
+
 void handle_command(StringView command)
 {
-    if (command == ".exit")
+    if (command == ".exit") {
         s_keep_running = false;
-    else
+    } else if (command == ".tables") {
+        for (auto& name : s_database->table_names())
+            outln("{}", name);
+    } else if (command.starts_with(".benchmark")) {
+        auto row_count = command.substring_view(10).trim_whitespace().to_uint().value_or(100000);
+        run_benchmark(max(row_count, 1u));
+    } else {
         outln("\033[33;1mUnrecognized command:\033[0m {}", command);
+    }
 }
 
 void handle_statement(StringView statement_string)
 {
     auto parser = SQL::Parser(SQL::Lexer(statement_string));
-    [[maybe_unused]] auto statement = parser.next_statement();
+    auto statement = parser.next_statement();
 
     if (parser.has_errors()) {
         auto error = parser.errors()[0];
         outln("\033[33;1mInvalid statement:\033[0m {}", error.to_string());
+        return;
+    }
+
+    SQL::Executor executor(*s_database);
+    auto result_or_error = executor.execute(*statement);
+    if (result_or_error.is_error()) {
+        outln("\033[33;1mError:\033[0m {}", result_or_error.error());
+        return;
+    }
+    if (!s_database->commit())
+        outln("\033[33;1mCould not write the database\033[0m");
+
+    auto& result = result_or_error.value();
+    if (result.column_names.is_empty()) {
+        if (result.changed_row_count > 0)
+            outln("{} row(s) changed", result.changed_row_count);
+        return;
+    }
+
+    outln("\033[1m{}\033[0m", String::join(" | ", result.column_names));
+    for (auto& row : result.rows) {
+        StringBuilder builder;
+        for (size_t i = 0; i < row.size(); ++i) {
+            if (i > 0)
+                builder.append(" | ");
+            builder.appendff("{}", row[i]);
+        }
+        outln("{}", builder.string_view());
     }
+    outln("{} row(s)", result.rows.size());
 }
 
 void repl()
@@ -121,8 +221,21 @@ void repl()
 
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    String database_path = String::formatted("{}/.sql-database", Core::StandardPaths::home_directory());
+
+    Core::ArgsParser args_parser;
+    args_parser.add_positional_argument(database_path, "Path to the database file", "database", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    auto database_or_error = SQL::Database::open(database_path);
+    if (database_or_error.is_error()) {
+        warnln("Could not open database {}: {}", database_path, database_or_error.error());
+        return 1;
+    }
+    s_database = database_or_error.release_value();
+
     s_editor = Line::Editor::construct();
     s_editor->load_history(s_history_path);
 
@@ -175,6 +288,7 @@ int main()
 
     repl();
     s_editor->save_history(s_history_path);
+    s_database->commit();
 
     return 0;
 }
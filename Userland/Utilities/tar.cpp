@@ -13,6 +13,8 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/FileStream.h>
+#include <LibThreading/ThreadPool.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -20,6 +22,72 @@
 
 constexpr size_t buffer_size = 4096;
 
+// Writes extracted files out on a pool of threads, so that reading (and decompressing) the archive carries on
+// while they're being written.
+class FileWriter {
+public:
+    explicit FileWriter(size_t thread_count)
+        : m_pool(thread_count)
+    {
+    }
+
+    void write(String path, mode_t mode, ByteBuffer contents)
+    {
+        // Don't let the archive pile up in memory if writing can't keep up with reading.
+        m_pool.help_until(m_write_done, [this] { return m_bytes_in_flight.load() < max_bytes_in_flight; });
+
+        auto size = contents.size();
+        m_bytes_in_flight += size;
+        m_writes_in_flight++;
+        m_pool.submit([this, path = move(path), mode, contents = move(contents), size] {
+            if (!write_file(path, mode, contents))
+                m_failed = true;
+            m_bytes_in_flight -= size;
+            m_writes_in_flight--;
+            m_write_done.notify_all();
+        });
+    }
+
+    // Waits for all the writes, and returns whether they all went through.
+    bool finish()
+    {
+        m_pool.help_until(m_write_done, [this] { return m_writes_in_flight.load() == 0; });
+        return !m_failed.load();
+    }
+
+private:
+    static constexpr size_t max_bytes_in_flight = 64 * MiB;
+
+    static bool write_file(String const& path, mode_t mode, ReadonlyBytes contents)
+    {
+        int fd = open(path.characters(), O_CREAT | O_WRONLY, mode);
+        if (fd < 0) {
+            perror("open");
+            return false;
+        }
+        while (!contents.is_empty()) {
+            auto nwritten = ::write(fd, contents.data(), contents.size());
+            if (nwritten < 0) {
+                if (errno == EINTR)
+                    continue;
+                perror("write");
+                close(fd);
+                return false;
+            }
+            contents = contents.slice(nwritten);
+        }
+        close(fd);
+        return true;
+    }
+
+    Atomic<size_t> m_bytes_in_flight { 0 };
+    Atomic<size_t> m_writes_in_flight { 0 };
+    Atomic<bool> m_failed { false };
+    Threading::Event m_write_done;
+    // This goes last, so that its workers are gone before anything they use.
+    Threading::ThreadPool m_pool;
+};
+
 int main(int argc, char** argv)
 {
     bool create = false;
@@ -27,6 +95,7 @@ int main(int argc, char** argv)
     bool list = false;
     bool verbose = false;
     bool gzip = false;
+    int thread_count = 1;
     const char* archive_file = nullptr;
     Vector<const char*> paths;
 
@@ -37,6 +106,7 @@ int main(int argc, char** argv)
     args_parser.add_option(verbose, "Print paths", "verbose", 'v');
     args_parser.add_option(gzip, "compress or uncompress file using gzip", "gzip", 'z');
     args_parser.add_option(archive_file, "Archive file", "file", 'f', "FILE");
+    args_parser.add_option(thread_count, "Extract on this many threads (one reads the archive, the rest write files)", "jobs", 0, "count");
     args_parser.add_positional_argument(paths, "Paths", "PATHS", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -45,6 +115,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (thread_count < 1) {
+        warnln("the number of threads has to be at least 1");
+        return 1;
+    }
+
     if (list || extract) {
         auto file = Core::File::standard_input();
 
@@ -67,6 +142,11 @@ int main(int argc, char** argv)
             warnln("the provided file is not a well-formatted ustar file");
             return 1;
         }
+
+        OwnPtr<FileWriter> file_writer;
+        if (extract && thread_count > 1)
+            file_writer = make<FileWriter>(thread_count - 1);
+
         for (; !tar_stream.finished(); tar_stream.advance()) {
             if (list || verbose)
                 outln("{}", tar_stream.header().filename());
@@ -78,6 +158,16 @@ int main(int argc, char** argv)
                 switch (header.type_flag()) {
                 case Archive::TarFileType::NormalFile:
                 case Archive::TarFileType::AlternateNormalFile: {
+                    if (file_writer) {
+                        auto contents = ByteBuffer::create_uninitialized(header.size());
+                        if (!file_stream.read_or_error(contents)) {
+                            warnln("failed reading {} from the archive", header.filename());
+                            return 1;
+                        }
+                        file_writer->write(String(header.filename()), header.mode(), move(contents));
+                        break;
+                    }
+
                     int fd = open(String(header.filename()).characters(), O_CREAT | O_WRONLY, header.mode());
                     if (fd < 0) {
                         perror("open");
@@ -117,6 +207,8 @@ int main(int argc, char** argv)
                 }
             }
         }
+        if (file_writer && !file_writer->finish())
+            return 1;
         file_stream.close();
         return 0;
     }
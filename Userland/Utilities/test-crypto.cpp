@@ -12,12 +12,15 @@
 #include <LibCrypto/ASN1/ASN1.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Authentication/Poly1305.h>
 #include <LibCrypto/BigInt/Algorithms/UnsignedBigIntegerAlgorithms.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
 #include <LibCrypto/Hash/SHA2.h>
@@ -59,6 +62,7 @@ static Vector<Certificate> s_root_ca_certificates;
 static int aes_cbc_tests();
 static int aes_ctr_tests();
 static int aes_gcm_tests();
+static int chacha20_poly1305_tests();
 
 // Hash
 static int md5_tests();
@@ -76,6 +80,7 @@ static int ghash_tests();
 
 // Public-Key
 static int rsa_tests();
+static int x25519_tests();
 
 // TLS
 static int tls_tests();
@@ -417,7 +422,9 @@ auto main(int argc, char** argv) -> int
         return 1;
     }
     if (mode_sv == "pk") {
-        return rsa_tests();
+        rsa_tests();
+        x25519_tests();
+        return g_some_test_failed ? 1 : 0;
     }
     if (mode_sv == "bigint") {
         return bigint_tests();
@@ -449,6 +456,7 @@ auto main(int argc, char** argv) -> int
         aes_cbc_tests();
         aes_ctr_tests();
         aes_gcm_tests();
+        chacha20_poly1305_tests();
 
         encrypting = false;
         aes_cbc_tests();
@@ -469,6 +477,7 @@ auto main(int argc, char** argv) -> int
         ghash_tests();
 
         rsa_tests();
+        x25519_tests();
 
         if (!in_ci) {
             // Do not run these in CI to avoid tests with variables outside our control.
@@ -520,6 +529,11 @@ auto main(int argc, char** argv) -> int
             if (run_tests)
                 return aes_gcm_tests();
 
+            return 1;
+        } else if (StringView(suite) == "CHACHA20_POLY1305") {
+            if (run_tests)
+                return chacha20_poly1305_tests();
+
             return 1;
         } else {
             warnln("Unknown cipher suite '{}'", suite);
@@ -573,6 +587,11 @@ static void aes_ctr_test_decrypt();
 static void aes_gcm_test_name();
 static void aes_gcm_test_encrypt();
 static void aes_gcm_test_decrypt();
+static void chacha20_poly1305_test_name();
+static void chacha20_test_encrypt();
+static void poly1305_test_process();
+static void chacha20_poly1305_test_encrypt();
+static void chacha20_poly1305_test_decrypt();
 
 static void md5_test_name();
 static void md5_test_hash();
@@ -610,6 +629,9 @@ static void rsa_test_der_parse();
 static void rsa_test_encrypt_decrypt();
 static void rsa_emsa_pss_test_create();
 
+static void x25519_test_compute_coordinate();
+static void x25519_test_key_exchange();
+
 static void tls_test_client_hello();
 
 static void bigint_test_fibo500();
@@ -623,6 +645,7 @@ static void bigint_bitwise();
 
 static void bigint_theory_modular_inverse();
 static void bigint_theory_modular_power();
+static void bigint_benchmarks();
 static void bigint_theory_primality();
 static void bigint_theory_random_number();
 
@@ -771,6 +794,25 @@ static void aes_cbc_test_decrypt()
         Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriendsWellHelloFriends"_b, 256, Crypto::Cipher::Intent::Decryption);
         test_it(cipher, result, 48);
     }
+    {
+        I_TEST((AES CBC with 128 bit key | Decrypt in place))
+        auto true_value = "This is a test! This is another test!";
+        u8 result[] {
+            0xb8, 0x06, 0x7c, 0xf2, 0xa9, 0x56, 0x63, 0x58, 0x2d, 0x5c, 0xa1, 0x4b, 0xc5, 0xe3, 0x08,
+            0xcf, 0xb5, 0x93, 0xfb, 0x67, 0xb6, 0xf7, 0xaf, 0x45, 0x34, 0x64, 0x70, 0x9e, 0xc9, 0x1a,
+            0x8b, 0xd3, 0x70, 0x45, 0xf0, 0x79, 0x65, 0xca, 0xb9, 0x03, 0x88, 0x72, 0x1c, 0xdd, 0xab,
+            0x45, 0x6b, 0x1c
+        };
+        Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Decryption);
+        auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size());
+        Bytes span { result, 48 };
+        cipher.decrypt(span, span, iv);
+        if (span.size() != strlen(true_value) || memcmp(span.data(), true_value, strlen(true_value)) != 0) {
+            FAIL(invalid data);
+            print_buffer(span, Crypto::Cipher::AESCipher::block_size());
+        } else
+            PASS;
+    }
     // TODO: Test non-CMS padding options
 }
 
@@ -1232,6 +1274,148 @@ static void aes_gcm_test_decrypt()
     }
 }
 
+static int chacha20_poly1305_tests()
+{
+    chacha20_poly1305_test_name();
+    chacha20_test_encrypt();
+    poly1305_test_process();
+    chacha20_poly1305_test_encrypt();
+    chacha20_poly1305_test_decrypt();
+    return g_some_test_failed ? 1 : 0;
+}
+
+static void chacha20_poly1305_test_name()
+{
+    I_TEST((ChaCha20-Poly1305 class name));
+    u8 key[32] {};
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    if (cipher.class_name() != "ChaCha20-Poly1305")
+        FAIL(Invalid class name);
+    else
+        PASS;
+}
+
+static constexpr char chacha20_test_plaintext[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+static void chacha20_test_encrypt()
+{
+    {
+        I_TEST((ChaCha20 | Encrypt));
+        u8 key[32];
+        for (size_t i = 0; i < sizeof(key); ++i)
+            key[i] = i;
+        u8 nonce[] { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+        u8 result[] { 0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81, 0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57, 0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8, 0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36, 0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42, 0x87, 0x4d };
+        Crypto::Cipher::ChaCha20 cipher({ key, sizeof(key) }, { nonce, sizeof(nonce) }, 1);
+        u8 out[sizeof(result)];
+        // Split the message in the middle of a block, to check that the rest of the key stream is kept.
+        cipher.run({ (const u8*)chacha20_test_plaintext, 50 }, { out, 50 });
+        cipher.run({ (const u8*)chacha20_test_plaintext + 50, sizeof(result) - 50 }, { out + 50, sizeof(result) - 50 });
+        if (memcmp(result, out, sizeof(result)) != 0) {
+            FAIL(Invalid ciphertext);
+            print_buffer({ out, sizeof(out) }, -1);
+        } else
+            PASS;
+    }
+    {
+        I_TEST((ChaCha20 | Many Blocks In Pieces));
+        // Long runs take the vectorized path, and short ones go a block at a time; they must produce the same key stream.
+        u8 key[32] {};
+        u8 nonce[12] {};
+        static u8 in[4099];
+        static u8 whole[sizeof(in)];
+        static u8 pieces[sizeof(in)];
+        Crypto::Cipher::ChaCha20 whole_cipher({ key, sizeof(key) }, { nonce, sizeof(nonce) });
+        whole_cipher.run({ in, sizeof(in) }, { whole, sizeof(whole) });
+        Crypto::Cipher::ChaCha20 pieces_cipher({ key, sizeof(key) }, { nonce, sizeof(nonce) });
+        for (size_t offset = 0; offset < sizeof(in); offset += 61) {
+            auto size = min<size_t>(61, sizeof(in) - offset);
+            pieces_cipher.run({ in + offset, size }, { pieces + offset, size });
+        }
+        if (memcmp(whole, pieces, sizeof(whole)) != 0)
+            FAIL(Key streams differ);
+        else
+            PASS;
+    }
+}
+
+static void poly1305_test_process()
+{
+    I_TEST((Poly1305 | Process));
+    u8 key[] { 0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8, 0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd, 0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b };
+    u8 result[] { 0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9 };
+    Crypto::Authentication::Poly1305 poly1305({ key, sizeof(key) });
+    poly1305.update("Cryptographic Forum Research Group"_b);
+    auto tag = poly1305.digest();
+    if (memcmp(result, tag.data, sizeof(result)) != 0) {
+        FAIL(Invalid tag);
+        print_buffer({ tag.data, sizeof(tag.data) }, -1);
+    } else
+        PASS;
+}
+
+static constexpr u8 chacha20_poly1305_test_key[] { 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f };
+static constexpr u8 chacha20_poly1305_test_nonce[] { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+static constexpr u8 chacha20_poly1305_test_aad[] { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+static constexpr u8 chacha20_poly1305_test_ciphertext[] { 0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b, 0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36, 0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58, 0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc, 0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16 };
+static constexpr u8 chacha20_poly1305_test_tag[] { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+static void chacha20_poly1305_test_encrypt()
+{
+    I_TEST((ChaCha20-Poly1305 | Encrypt));
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ chacha20_poly1305_test_key, sizeof(chacha20_poly1305_test_key) });
+    u8 out[sizeof(chacha20_poly1305_test_ciphertext)];
+    u8 tag[Crypto::Cipher::ChaCha20Poly1305::TagSize];
+    cipher.encrypt({ (const u8*)chacha20_test_plaintext, sizeof(out) }, { out, sizeof(out) },
+        { chacha20_poly1305_test_nonce, sizeof(chacha20_poly1305_test_nonce) },
+        { chacha20_poly1305_test_aad, sizeof(chacha20_poly1305_test_aad) },
+        { tag, sizeof(tag) });
+    if (memcmp(chacha20_poly1305_test_ciphertext, out, sizeof(out)) != 0) {
+        FAIL(Invalid ciphertext);
+        print_buffer({ out, sizeof(out) }, -1);
+    } else if (memcmp(chacha20_poly1305_test_tag, tag, sizeof(tag)) != 0) {
+        FAIL(Invalid auth tag);
+        print_buffer({ tag, sizeof(tag) }, -1);
+    } else
+        PASS;
+}
+
+static void chacha20_poly1305_test_decrypt()
+{
+    {
+        I_TEST((ChaCha20-Poly1305 | Decrypt));
+        Crypto::Cipher::ChaCha20Poly1305 cipher({ chacha20_poly1305_test_key, sizeof(chacha20_poly1305_test_key) });
+        u8 out[sizeof(chacha20_poly1305_test_ciphertext)];
+        auto consistency = cipher.decrypt({ chacha20_poly1305_test_ciphertext, sizeof(chacha20_poly1305_test_ciphertext) }, { out, sizeof(out) },
+            { chacha20_poly1305_test_nonce, sizeof(chacha20_poly1305_test_nonce) },
+            { chacha20_poly1305_test_aad, sizeof(chacha20_poly1305_test_aad) },
+            { chacha20_poly1305_test_tag, sizeof(chacha20_poly1305_test_tag) });
+        if (consistency != Crypto::VerificationConsistency::Consistent) {
+            FAIL(Verification reported failure);
+        } else if (memcmp(chacha20_test_plaintext, out, sizeof(out)) != 0) {
+            FAIL(Invalid plaintext);
+            print_buffer({ out, sizeof(out) }, -1);
+        } else
+            PASS;
+    }
+    {
+        I_TEST((ChaCha20-Poly1305 | Decrypt Tampered));
+        Crypto::Cipher::ChaCha20Poly1305 cipher({ chacha20_poly1305_test_key, sizeof(chacha20_poly1305_test_key) });
+        u8 in[sizeof(chacha20_poly1305_test_ciphertext)];
+        memcpy(in, chacha20_poly1305_test_ciphertext, sizeof(in));
+        in[42] ^= 1;
+        u8 out[sizeof(in)];
+        auto consistency = cipher.decrypt({ in, sizeof(in) }, { out, sizeof(out) },
+            { chacha20_poly1305_test_nonce, sizeof(chacha20_poly1305_test_nonce) },
+            { chacha20_poly1305_test_aad, sizeof(chacha20_poly1305_test_aad) },
+            { chacha20_poly1305_test_tag, sizeof(chacha20_poly1305_test_tag) });
+        if (consistency != Crypto::VerificationConsistency::Inconsistent)
+            FAIL(Verification reported success);
+        else
+            PASS;
+    }
+}
+
 static int md5_tests()
 {
     md5_test_name();
@@ -2008,6 +2192,55 @@ static void rsa_test_encrypt_decrypt()
     }
 }
 
+static int x25519_tests()
+{
+    x25519_test_compute_coordinate();
+    x25519_test_key_exchange();
+    return g_some_test_failed ? 1 : 0;
+}
+
+static void x25519_test_compute_coordinate()
+{
+    I_TEST((X25519 | Compute Coordinate));
+    u8 scalar[] { 0x4b, 0x66, 0xe9, 0xd4, 0xd1, 0xb4, 0x67, 0x3c, 0x5a, 0xd2, 0x26, 0x91, 0x95, 0x7d, 0x6a, 0xf5, 0xc1, 0x1b, 0x64, 0x21, 0xe0, 0xea, 0x01, 0xd4, 0x2c, 0xa4, 0x16, 0x9e, 0x79, 0x18, 0xba, 0x0d };
+    u8 coordinate[] { 0xe5, 0x21, 0x0f, 0x12, 0x78, 0x68, 0x11, 0xd3, 0xf4, 0xb7, 0x95, 0x9d, 0x05, 0x38, 0xae, 0x2c, 0x31, 0xdb, 0xe7, 0x10, 0x6f, 0xc0, 0x3c, 0x3e, 0xfc, 0x4c, 0xd5, 0x49, 0xc7, 0x15, 0xa4, 0x93 };
+    u8 result[] { 0x95, 0xcb, 0xde, 0x94, 0x76, 0xe8, 0x90, 0x7d, 0x7a, 0xad, 0xe4, 0x5c, 0xb4, 0xb8, 0x73, 0xf8, 0x8b, 0x59, 0x5a, 0x68, 0x79, 0x9f, 0xa1, 0x52, 0xe6, 0xf8, 0xf7, 0x64, 0x7a, 0xac, 0x79, 0x57 };
+    u8 out[Crypto::Curves::X25519::KeySize];
+    Crypto::Curves::X25519::compute_coordinate({ scalar, sizeof(scalar) }, { coordinate, sizeof(coordinate) }, { out, sizeof(out) });
+    if (memcmp(result, out, sizeof(out)) != 0) {
+        FAIL(Invalid coordinate);
+        print_buffer({ out, sizeof(out) }, -1);
+    } else
+        PASS;
+}
+
+static void x25519_test_key_exchange()
+{
+    I_TEST((X25519 | Key Exchange));
+    u8 alice_private_key[] { 0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d, 0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45, 0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a, 0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a };
+    u8 alice_public_key[] { 0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54, 0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a, 0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4, 0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a };
+    u8 bob_private_key[] { 0x5d, 0xab, 0x08, 0x7e, 0x62, 0x4a, 0x8a, 0x4b, 0x79, 0xe1, 0x7f, 0x8b, 0x83, 0x80, 0x0e, 0xe6, 0x6f, 0x3b, 0xb1, 0x29, 0x26, 0x18, 0xb6, 0xfd, 0x1c, 0x2f, 0x8b, 0x27, 0xff, 0x88, 0xe0, 0xeb };
+    u8 shared_secret[] { 0x4a, 0x5d, 0x9d, 0x5b, 0xa4, 0xce, 0x2d, 0xe1, 0x72, 0x8e, 0x3b, 0xf4, 0x80, 0x35, 0x0f, 0x25, 0xe0, 0x7e, 0x21, 0xc9, 0x47, 0xd1, 0x9e, 0x33, 0x76, 0xf0, 0x9b, 0x3c, 0x1e, 0x16, 0x17, 0x42 };
+
+    u8 public_key[Crypto::Curves::X25519::KeySize];
+    u8 bob_public_key[Crypto::Curves::X25519::KeySize];
+    u8 alice_secret[Crypto::Curves::X25519::KeySize];
+    u8 bob_secret[Crypto::Curves::X25519::KeySize];
+    Crypto::Curves::X25519::generate_public_key({ alice_private_key, sizeof(alice_private_key) }, { public_key, sizeof(public_key) });
+    Crypto::Curves::X25519::generate_public_key({ bob_private_key, sizeof(bob_private_key) }, { bob_public_key, sizeof(bob_public_key) });
+    Crypto::Curves::X25519::compute_coordinate({ alice_private_key, sizeof(alice_private_key) }, { bob_public_key, sizeof(bob_public_key) }, { alice_secret, sizeof(alice_secret) });
+    Crypto::Curves::X25519::compute_coordinate({ bob_private_key, sizeof(bob_private_key) }, { alice_public_key, sizeof(alice_public_key) }, { bob_secret, sizeof(bob_secret) });
+    if (memcmp(alice_public_key, public_key, sizeof(public_key)) != 0) {
+        FAIL(Invalid public key);
+        print_buffer({ public_key, sizeof(public_key) }, -1);
+    } else if (memcmp(shared_secret, alice_secret, sizeof(alice_secret)) != 0 || memcmp(shared_secret, bob_secret, sizeof(bob_secret)) != 0) {
+        FAIL(Invalid shared secret);
+        print_buffer({ alice_secret, sizeof(alice_secret) }, -1);
+        print_buffer({ bob_secret, sizeof(bob_secret) }, -1);
+    } else
+        PASS;
+}
+
 static int tls_tests()
 {
     tls_test_client_hello();
@@ -2122,6 +2355,7 @@ static int bigint_tests()
 
     bigint_theory_modular_inverse();
     bigint_theory_modular_power();
+    bigint_benchmarks();
     bigint_theory_primality();
     bigint_theory_random_number();
 
@@ -2392,6 +2626,28 @@ static void bigint_multiplication()
             FAIL(Incorrect Result);
         }
     }
+    {
+        I_TEST((BigInteger | Karatsuba Multiplication));
+        // F(2n) = F(n) * (2 * F(n + 1) - F(n)), with numbers long enough to be split several times.
+        auto fibonacci_n = bigint_fibonacci(6000);
+        auto fibonacci_n_plus_1 = bigint_fibonacci(6001);
+        auto result = fibonacci_n.multiplied_by(fibonacci_n_plus_1.shift_left(1).minus(fibonacci_n));
+        if (result == bigint_fibonacci(12000)) {
+            PASS;
+        } else {
+            FAIL(Incorrect Result);
+        }
+    }
+    {
+        I_TEST((BigInteger | Unbalanced Karatsuba Multiplication));
+        // F(m + n) = F(m) * F(n + 1) + F(m - 1) * F(n), with m much larger than n.
+        auto result = bigint_fibonacci(6000).multiplied_by(bigint_fibonacci(1501)).plus(bigint_fibonacci(5999).multiplied_by(bigint_fibonacci(1500)));
+        if (result == bigint_fibonacci(7500)) {
+            PASS;
+        } else {
+            FAIL(Incorrect Result);
+        }
+    }
 }
 static void bigint_division()
 {
@@ -2571,6 +2827,41 @@ static void bigint_theory_modular_power()
     }
 }
 
+static void bigint_benchmarks()
+{
+    {
+        I_TEST((BigInteger | Benchmark | 8192-bit Multiplication x100));
+        // F(2n) = F(n) * (2 * F(n + 1) - F(n)), as above.
+        auto num1 = bigint_fibonacci(11800);
+        auto num2 = bigint_fibonacci(11801).shift_left(1).minus(num1);
+        Crypto::UnsignedBigInteger result;
+        for (size_t i = 0; i < 100; ++i)
+            result = num1.multiplied_by(num2);
+        if (result == bigint_fibonacci(23600)) {
+            PASS;
+        } else {
+            FAIL(Incorrect Result);
+        }
+    }
+    {
+        I_TEST((BigInteger | Benchmark | 2048-bit Modular Power x5));
+        // b^(e1 + e2) = b^e1 * b^e2, with F(2949) + F(2950) = F(2951) being the (odd) modulus.
+        auto base = bigint_fibonacci(2900);
+        auto exponent_1 = bigint_fibonacci(2949);
+        auto exponent_2 = bigint_fibonacci(2950);
+        auto modulo = bigint_fibonacci(2951);
+        Crypto::UnsignedBigInteger result;
+        for (size_t i = 0; i < 5; ++i)
+            result = Crypto::NumberTheory::ModularPower(base, modulo, modulo);
+        auto expected = Crypto::NumberTheory::ModularPower(base, exponent_1, modulo).multiplied_by(Crypto::NumberTheory::ModularPower(base, exponent_2, modulo)).divided_by(modulo).remainder;
+        if (result == expected) {
+            PASS;
+        } else {
+            FAIL(Incorrect Result);
+        }
+    }
+}
+
 static void bigint_theory_primality()
 {
     struct {
@@ -7,13 +7,33 @@
 #include <AK/Assertions.h>
 #include <AK/MappedFile.h>
 #include <AK/NumberFormat.h>
+#include <AK/ScopeGuard.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/File.h>
+#include <LibThreading/Parallel.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+static bool write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = write(fd, bytes.data(), bytes.size());
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        bytes = bytes.slice(nwritten);
+    }
+    return true;
+}
+
+// NOTE: This sticks to plain file descriptors (Core::File is a Core::Object, which can only be used on the main thread),
+//       so that files can be unpacked on several threads at once.
 static bool unpack_zip_member(Archive::ZipMember zip_member)
 {
     if (zip_member.is_directory) {
@@ -24,19 +44,20 @@ static bool unpack_zip_member(Archive::ZipMember zip_member)
         outln(" extracting: {}", zip_member.name);
         return true;
     }
-    auto new_file = Core::File::construct(zip_member.name);
-    if (!new_file->open(Core::OpenMode::WriteOnly)) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
+    int fd = open(zip_member.name.characters(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+    if (fd < 0) {
+        warnln("Can't write file {}: {}", zip_member.name, strerror(errno));
         return false;
     }
+    ScopeGuard close_fd = [fd] { close(fd); };
 
     outln(" extracting: {}", zip_member.name);
 
     // TODO: verify CRC32s match!
     switch (zip_member.compression_method) {
     case Archive::ZipCompressionMethod::Store: {
-        if (!new_file->write(zip_member.compressed_data.data(), zip_member.compressed_data.size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!write_all(fd, zip_member.compressed_data)) {
+            warnln("Can't write file contents in {}: {}", zip_member.name, strerror(errno));
             return false;
         }
         break;
@@ -51,8 +72,8 @@ static bool unpack_zip_member(Archive::ZipMember zip_member)
             warnln("Failed decompressing file {}", zip_member.name);
             return false;
         }
-        if (!new_file->write(decompressed_data.value().data(), decompressed_data.value().size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!write_all(fd, decompressed_data.value())) {
+            warnln("Can't write file contents in {}: {}", zip_member.name, strerror(errno));
             return false;
         }
         break;
@@ -61,12 +82,34 @@ static bool unpack_zip_member(Archive::ZipMember zip_member)
         VERIFY_NOT_REACHED();
     }
 
-    if (!new_file->close()) {
-        warnln("Can't close file {}: {}", zip_member.name, new_file->error_string());
+    return true;
+}
+
+// Creates all the directories up front, in the order the archive has them (so parents come before their children),
+// and then decompresses and writes the files on several threads, straight out of the mapped archive.
+static bool unpack_zip_members_in_parallel(Archive::Zip& zip_file, size_t thread_count)
+{
+    Vector<Archive::ZipMember> files;
+    auto success = zip_file.for_each_member([&](auto& zip_member) {
+        if (!zip_member.is_directory) {
+            files.append(zip_member);
+            return IterationDecision::Continue;
+        }
+        return unpack_zip_member(zip_member) ? IterationDecision::Continue : IterationDecision::Break;
+    });
+    if (!success)
         return false;
-    }
 
-    return true;
+    // The calling thread unpacks files too.
+    Threading::ThreadPool pool { thread_count - 1 };
+    Atomic<bool> failed { false };
+    Threading::parallel_for(
+        files.span(), [&](auto& zip_member) {
+            if (!failed.load(AK::MemoryOrder::memory_order_relaxed) && !unpack_zip_member(zip_member))
+                failed.store(true, AK::MemoryOrder::memory_order_relaxed);
+        },
+        1, pool);
+    return !failed.load();
 }
 
 int main(int argc, char** argv)
@@ -74,13 +117,20 @@ int main(int argc, char** argv)
     const char* path;
     int map_size_limit = 32 * MiB;
     String output_directory_path;
+    int thread_count = 1;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(map_size_limit, "Maximum chunk size to map", "map-size-limit", 0, "size");
+    args_parser.add_option(thread_count, "Unpack files on this many threads", "jobs", 0, "count");
     args_parser.add_option(output_directory_path, "Directory to receive the archive content", "output-directory", 'o', "path");
     args_parser.add_positional_argument(path, "File to unzip", "path", Core::ArgsParser::Required::Yes);
     args_parser.parse(argc, argv);
 
+    if (thread_count < 1) {
+        warnln("The number of threads has to be at least 1");
+        return 1;
+    }
+
     String zip_file_path { path };
 
     struct stat st;
@@ -129,6 +179,9 @@ int main(int argc, char** argv)
         }
     }
 
+    if (thread_count > 1)
+        return unpack_zip_members_in_parallel(zip_file.value(), thread_count) ? 0 : 1;
+
     auto success = zip_file->for_each_member([&](auto zip_member) {
         return unpack_zip_member(zip_member) ? IterationDecision::Continue : IterationDecision::Break;
     });
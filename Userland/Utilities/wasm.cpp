@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/QuickSort.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
 #include <LibCore/FileStream.h>
@@ -21,6 +22,7 @@ static Wasm::Printer g_printer { g_stdout };
 static bool g_continue { false };
 static void (*old_signal)(int);
 static Wasm::DebuggerBytecodeInterpreter g_interpreter;
+static Wasm::ProfilingBytecodeInterpreter g_profiling_interpreter;
 
 static void print_buffer(ReadonlyBytes buffer, int split)
 {
@@ -104,7 +106,7 @@ static bool pre_interpret_hook(Wasm::Configuration& config, Wasm::InstructionPoi
             warnln("- [h]elp                     Print this help");
             warnln();
             warnln("Print:");
-            warnln("- print [s]tack              Print the contents of the stack, including frames and labels");
+            warnln("- print [s]tack              Print the contents of the stack, including frames");
             warnln("- print [[m]em]ory <index>   Print the contents of the memory identified by <index>");
             warnln("- print [[i]nstr]uction      Print the current instruction");
             warnln("- print [[f]unc]tion <index> Print the function identified by <index>");
@@ -283,6 +285,48 @@ static void print_link_error(Wasm::LinkError const& error)
         warnln("Missing import '{}'", missing);
 }
 
+static void print_profile(Wasm::ProfilingBytecodeInterpreter const& interpreter, Wasm::ModuleInstance const& instance, Wasm::Store& store)
+{
+    warnln("Executed {} instructions", interpreter.executed_instructions());
+
+    if (interpreter.count_opcodes) {
+        auto& counts = interpreter.opcode_counts();
+        auto opcodes = counts.keys();
+        quick_sort(opcodes, [&](auto a, auto b) { return counts.get(a).value() > counts.get(b).value(); });
+
+        warnln("{:>14}  opcode", "count");
+        for (auto opcode : opcodes)
+            warnln("{:>14}  {}", counts.get(opcode).value(), Wasm::instruction_name(Wasm::OpCode { opcode }));
+    }
+
+    if (interpreter.profile_functions) {
+        HashMap<Wasm::Expression const*, String> names;
+        for (size_t i = 0; i < instance.functions().size(); ++i) {
+            auto address = instance.functions()[i];
+            auto* function = store.get(address);
+            if (!function || !function->has<Wasm::WasmFunction>())
+                continue;
+            auto name = String::formatted("#{}", i);
+            for (auto& export_ : instance.exports()) {
+                auto* exported_address = export_.value().get_pointer<Wasm::FunctionAddress>();
+                if (exported_address && *exported_address == address)
+                    name = String::formatted("{} ({})", name, export_.name());
+            }
+            names.set(&function->get<Wasm::WasmFunction>().code().body(), move(name));
+        }
+
+        auto& profiles = interpreter.function_profiles();
+        auto functions = profiles.keys();
+        quick_sort(functions, [&](auto a, auto b) { return profiles.get(a)->self_time > profiles.get(b)->self_time; });
+
+        warnln("{:>14}  {:>14}  {:>10}  function", "self time (us)", "instructions", "calls");
+        for (auto function : functions) {
+            auto& profile = *profiles.get(function);
+            warnln("{:>14}  {:>14}  {:>10}  {}", profile.self_time.to_microseconds(), profile.executed_instructions, profile.call_count, names.get(function).value_or("?"));
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     char const* filename = nullptr;
@@ -291,6 +335,8 @@ int main(int argc, char* argv[])
     bool debug = false;
     bool export_all_imports = false;
     bool shell_mode = false;
+    bool count_opcodes = false;
+    bool profile_functions = false;
     String exported_function_to_execute;
     Vector<u64> values_to_push;
     Vector<String> modules_to_link_in;
@@ -303,6 +349,8 @@ int main(int argc, char* argv[])
     parser.add_option(exported_function_to_execute, "Attempt to execute the named exported function from the module (implies -i)", "execute", 'e', "name");
     parser.add_option(export_all_imports, "Export noop functions corresponding to imports", "export-noop", 0);
     parser.add_option(shell_mode, "Launch a REPL in the module's context (implies -i)", "shell", 's');
+    parser.add_option(count_opcodes, "Count how often every opcode is executed (with -e)", "count-opcodes", 0);
+    parser.add_option(profile_functions, "Measure the time and instructions spent in every function (with -e)", "profile-functions", 0);
     parser.add_option(Core::ArgsParser::Option {
         .requires_argument = true,
         .help_string = "Extra modules to link with, use to resolve imports",
@@ -343,6 +391,14 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    bool profile = count_opcodes || profile_functions;
+    if (profile && debug) {
+        warnln("Can't profile while debugging");
+        return 1;
+    }
+    g_profiling_interpreter.count_opcodes = count_opcodes;
+    g_profiling_interpreter.profile_functions = profile_functions;
+
     if (debug || shell_mode) {
         old_signal = signal(SIGINT, sigint_handler);
     }
@@ -525,7 +581,11 @@ int main(int argc, char* argv[])
                 outln();
             }
 
-            auto result = machine.invoke(g_interpreter, run_address.value(), move(values));
+            Wasm::Interpreter& interpreter = profile ? static_cast<Wasm::Interpreter&>(g_profiling_interpreter) : g_interpreter;
+            auto result = machine.invoke(interpreter, run_address.value(), move(values));
+
+            if (profile)
+                print_profile(g_profiling_interpreter, *module_instance, machine.store());
 
             if (debug)
                 launch_repl();